@@ -16,9 +16,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <memory>
 #include <regex>
+#include <string>
+#include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <benchmark/benchmark.h>
+#include "re2/re2.h"
+#include "re2/set.h"
 
 namespace px {
 
@@ -77,10 +83,74 @@ static void BM_Global(benchmark::State& state) {
   }
 }
 
+// RE2 compiled for each value, as opposed to once for all values.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RE2CompilePerValue(benchmark::State& state) {
+  for (auto _ : state) {
+    re2::RE2 rgx(kPodRegex);
+    benchmark::DoNotOptimize(RE2::PartialMatch(kPodNameMatch, rgx));
+    benchmark::DoNotOptimize(RE2::PartialMatch(kPodNameFail, rgx));
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RE2Precompiled(benchmark::State& state) {
+  static re2::RE2 rgx(kPodRegex);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(RE2::PartialMatch(kPodNameMatch, rgx));
+    benchmark::DoNotOptimize(RE2::PartialMatch(kPodNameFail, rgx));
+  }
+}
+
+// Rules shaped like the ones passed to px._match_regex_rule: each is a full match with a
+// leading and trailing wildcard. None of them match, so every rule has to be checked.
+std::vector<std::string> RulePatterns(int num_rules) {
+  std::vector<std::string> patterns;
+  for (int i = 0; i < num_rules; ++i) {
+    patterns.push_back(absl::StrCat("(?i).*rule_", i, "_(onload|onerror|script)=.*"));
+  }
+  return patterns;
+}
+
+const char* kRuleInput =
+    "GET /search?q=select+name+from+users+where+id%3D1&page=2 HTTP/1.1 User-Agent: curl/7.68.0";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexRulesSequential(benchmark::State& state) {
+  std::vector<std::unique_ptr<re2::RE2>> rules;
+  for (const auto& pattern : RulePatterns(state.range(0))) {
+    rules.push_back(std::make_unique<re2::RE2>(pattern));
+  }
+  for (auto _ : state) {
+    for (const auto& rule : rules) {
+      if (RE2::FullMatch(kRuleInput, *rule)) {
+        break;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexRulesSet(benchmark::State& state) {
+  re2::RE2::Set rules(re2::RE2::DefaultOptions, re2::RE2::ANCHOR_BOTH);
+  for (const auto& pattern : RulePatterns(state.range(0))) {
+    rules.Add(pattern, nullptr);
+  }
+  rules.Compile();
+  std::vector<int> matches;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rules.Match(kRuleInput, &matches));
+  }
+}
+
 BENCHMARK(BM_Inline);
 BENCHMARK(BM_StaticInline);
 BENCHMARK(BM_ConstInline);
 BENCHMARK(BM_ConstStaticInline);
 BENCHMARK(BM_Global);
+BENCHMARK(BM_RE2CompilePerValue);
+BENCHMARK(BM_RE2Precompiled);
+BENCHMARK(BM_RegexRulesSequential)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_RegexRulesSet)->RangeMultiplier(4)->Range(1, 64);
 
 }  // namespace px
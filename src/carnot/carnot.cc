@@ -16,9 +16,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 #include "src/carnot/carnot.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -30,11 +34,21 @@
 #include "src/carnot/plan/plan.h"
 #include "src/carnot/planner/compiler/compiler.h"
 #include "src/carnot/planner/distributed/annotate_abortable_sources_for_limits_rule.h"
+#include "src/carnot/query_profile.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/perf/perf.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_query_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_BYTES", 0),
+             "The most memory a single query may use on this agent, counting its row batches, hash "
+             "tables and arenas. Queries that go over it are cancelled. Unlimited if 0.");
+DEFINE_int64(carnot_query_buffer_recycle_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_BUFFER_RECYCLE_BYTES", 16 * 1024 * 1024),
+             "The most bytes of freed arrow buffers a query keeps to reuse for its next row "
+             "batches, instead of going back to the allocator. No recycling if 0.");
+
 namespace px {
 namespace carnot {
 
@@ -170,6 +184,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnSort(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
@@ -265,9 +280,12 @@ Status SendFinalExecutionStatsToOutgoingConns(
         outgoing_servers,
     std::function<void(grpc::ClientContext*)> add_auth_to_grpc_context_func,
     const queryresultspb::AgentExecutionStats& agent_stats,
-    const std::vector<queryresultspb::AgentExecutionStats>& all_agent_stats) {
+    const std::vector<queryresultspb::AgentExecutionStats>& all_agent_stats, bool analyze) {
   ::px::carnotpb::TransferResultChunkRequest req;
   ToProto(query_id, req.mutable_query_id());
+  if (analyze) {
+    req.mutable_execution_and_timing_info()->set_profile(RenderQueryProfile(all_agent_stats));
+  }
 
   int64_t total_bytes_processed = 0;
   int64_t total_records_processed = 0;
@@ -316,6 +334,27 @@ Status InitiateOutgoingConns(
                                                 std::move(req));
 }
 
+namespace {
+
+// Serializes the plan fragment with the given id deterministically, to identify it in the result
+// cache.
+std::string PlanFragmentCacheKey(const planpb::Plan& plan, int64_t id) {
+  std::string key;
+  for (const auto& pf : plan.nodes()) {
+    if (static_cast<int64_t>(pf.id()) != id) {
+      continue;
+    }
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    pf.SerializeToCodedStream(&output);
+    break;
+  }
+  return key;
+}
+
+}  // namespace
+
 Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uuid& query_id,
                                bool analyze) {
   auto timer = ElapsedTimer();
@@ -325,7 +364,9 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
 
   // For each of the plan fragments in the plan, execute the query.
   std::vector<std::string> output_table_strs;
-  auto exec_state = engine_state_->CreateExecState(query_id);
+  auto exec_state =
+      engine_state_->CreateExecState(query_id, FLAGS_carnot_query_memory_limit_bytes,
+                                     FLAGS_carnot_query_buffer_recycle_bytes);
   auto outgoing_conns = GetOutgoingConns(exec_state.get(), logical_plan);
   PL_RETURN_IF_ERROR(InitiateOutgoingConns(query_id, outgoing_conns,
                                            engine_state_->add_auth_to_grpc_context_func()));
@@ -343,6 +384,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   auto plan_state = engine_state_->CreatePlanState();
   int64_t bytes_processed = 0;
   int64_t rows_processed = 0;
+  int64_t memory_peak_bytes = 0;
   queryresultspb::AgentExecutionStats agent_operator_exec_stats;
   ToProto(agent_id_, agent_operator_exec_stats.mutable_agent_id());
   timer.Start();
@@ -356,6 +398,10 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             auto exec_graph = exec::ExecutionGraph();
             PL_RETURN_IF_ERROR(exec_graph.Init(schema.get(), plan_state.get(), exec_state.get(), pf,
                                                /* collect_exec_node_stats */ analyze));
+            if (engine_state_->result_cache() != nullptr) {
+              exec_graph.SetResultCache(engine_state_->result_cache(),
+                                        PlanFragmentCacheKey(logical_plan, pf->id()));
+            }
             PL_RETURN_IF_ERROR(exec_graph.Execute());
 
             // We must get this while exec_graph is alive. ExecutionGraph destructor calls
@@ -365,6 +411,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             auto exec_stats = exec_graph.GetStats();
             bytes_processed += exec_stats.bytes_processed;
             rows_processed += exec_stats.rows_processed;
+            memory_peak_bytes = std::max(memory_peak_bytes, exec_stats.memory_peak_bytes);
 
             if (analyze) {
               for (int64_t node_id : pf->dag().TopologicalSort()) {
@@ -373,6 +420,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                     absl::Substitute("$0 (id=$1)", pf->nodes()[node_id]->DebugString(), node_id);
                 exec::ExecNodeStats* stats = exec_node->stats();
                 stats->AddExtraMetric("batches_output", stats->batches_output);
+                stats->AddDetailedStats();
                 int64_t total_time_ns = stats->TotalExecTime();
                 int64_t self_time_ns = stats->SelfExecTime();
                 LOG(INFO) << absl::Substitute(
@@ -388,6 +436,9 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                 stats_pb->set_records_output(stats->rows_output);
                 stats_pb->set_total_execution_time_ns(total_time_ns);
                 stats_pb->set_self_execution_time_ns(self_time_ns);
+                stats_pb->set_operator_description(node_name);
+                stats_pb->set_wait_time_ns(stats->wait_time_ns);
+                stats_pb->set_memory_peak_bytes(stats->memory_peak_bytes);
 
                 for (const auto& [k, v] : stats->extra_metrics) {
                   (*stats_pb->mutable_extra_metrics())[k] = v;
@@ -401,6 +452,13 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             return Status::OK();
           })
           .Walk(&plan);
+  if (!s.ok() && exec_state->exec_mem_pool()->limit_exceeded()) {
+    // Allocations over the limit fail wherever they happen, so name the cause for the user.
+    s = error::ResourceUnavailable(
+        "Query $0 was cancelled because it went over the per-query memory limit of $1 bytes "
+        "(--carnot_query_memory_limit_bytes): $2",
+        query_id.str(), exec_state->exec_mem_pool()->limit_bytes(), s.msg());
+  }
   if (!s.ok()) {
     PL_RETURN_IF_ERROR(SendErrorToOutgoingConns(query_id, outgoing_conns,
                                                 engine_state_->add_auth_to_grpc_context_func(), s));
@@ -425,6 +483,8 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     incoming_agents.push_back(id);
   }
   timer.Stop();
+  LOG_IF(INFO, analyze) << absl::Substitute("Query $0 peak memory: $1 bytes", query_id.str(),
+                                            memory_peak_bytes);
 
   std::vector<queryresultspb::AgentExecutionStats> input_agent_stats;
   if (HasGRPCServer() && !incoming_agents.empty()) {
@@ -446,6 +506,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   agent_operator_exec_stats.set_execution_time_ns(timer.ElapsedTime_us() * 1000);
   agent_operator_exec_stats.set_bytes_processed(bytes_processed);
   agent_operator_exec_stats.set_records_processed(rows_processed);
+  agent_operator_exec_stats.set_memory_peak_bytes(memory_peak_bytes);
 
   std::vector<queryresultspb::AgentExecutionStats> all_agent_stats;
   if (analyze) {
@@ -456,9 +517,9 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // analyze=true will send per operator stats.
   all_agent_stats.push_back(agent_operator_exec_stats);
 
-  return SendFinalExecutionStatsToOutgoingConns(query_id, outgoing_conns,
-                                                engine_state_->add_auth_to_grpc_context_func(),
-                                                agent_operator_exec_stats, all_agent_stats);
+  return SendFinalExecutionStatsToOutgoingConns(
+      query_id, outgoing_conns, engine_state_->add_auth_to_grpc_context_func(),
+      agent_operator_exec_stats, all_agent_stats, analyze);
 }
 
 CarnotImpl::~CarnotImpl() {
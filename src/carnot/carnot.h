@@ -31,6 +31,8 @@
 #include "src/shared/metadata/metadata_state.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_query_memory_limit_bytes);
+
 namespace px {
 namespace carnot {
 
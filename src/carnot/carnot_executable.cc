@@ -16,9 +16,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <google/protobuf/util/json_util.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <vector>
 
 #include <parser.hpp>
 #include <sole.hpp>
@@ -28,6 +36,7 @@
 #include "src/carnot/exec/local_grpc_result_server.h"
 #include "src/carnot/funcs/funcs.h"
 #include "src/common/base/base.h"
+#include "src/common/perf/memory_tracker.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
@@ -44,11 +53,36 @@ DEFINE_string(table_name, gflags::StringFromEnv("TABLE_NAME", "csv_table"),
               "The name of the table to store the csv data.");
 
 DEFINE_int64(rowbatch_size, gflags::Int64FromEnv("ROWBATCH_SIZE", 100),
-             "The size of the rowbatches.");
+             "The size of the rowbatches. Defaults to 100, or to kBenchmarkRowBatchSize when "
+             "benchmarking.");
+
+DEFINE_int32(benchmark_runs, gflags::Int32FromEnv("BENCHMARK_RUNS", 0),
+             "If positive, the query is run this many times after the warm-up runs, and the "
+             "timings, throughput, per operator exec stats and peak memory are written as JSON "
+             "to --benchmark_output_file instead of writing the results to --output_file.");
+
+DEFINE_int32(benchmark_warmup_runs, gflags::Int32FromEnv("BENCHMARK_WARMUP_RUNS", 1),
+             "The number of runs before the measured ones, when benchmarking.");
+
+DEFINE_string(benchmark_output_file, gflags::StringFromEnv("BENCHMARK_OUTPUT_FILE", ""),
+              "The file to write the benchmark JSON to. Written to stdout if empty.");
+
+DEFINE_int32(input_copies, gflags::Int32FromEnv("INPUT_COPIES", 1),
+             "The number of times the input is loaded into the table, one after the other, with "
+             "the time columns shifted by the input's time span for each copy. Allows scaling a "
+             "small input up to a production-sized table.");
+
+DEFINE_bool(compact_input, gflags::BoolFromEnv("COMPACT_INPUT", false),
+            "If true, the table is compacted into cold batches before the query runs, as most "
+            "of the data of a long-running table is.");
 
 using px::types::DataType;
 
 namespace {
+
+// The table store ingests about this many rows per batch from Stirling under load.
+constexpr int64_t kBenchmarkRowBatchSize = 4096;
+
 /**
  * Gets the corresponding px::DataType from the string type in the csv.
  * @param type the string from the csv.
@@ -101,13 +135,44 @@ void AddStringValueToRow(std::vector<std::string>* row, arrow::Array* arr, int64
   row->push_back(val);
 }
 
+/**
+ * Appends the CSV field to the column.
+ * @param time_offset added to TIME64NS values.
+ */
+void AppendField(DataType type, const std::string& field, int64_t time_offset,
+                 px::types::ColumnWrapper* col) {
+  switch (type) {
+    case DataType::INT64:
+      static_cast<px::types::Int64ValueColumnWrapper*>(col)->Append(std::stoll(field));
+      break;
+    case DataType::FLOAT64:
+      static_cast<px::types::Float64ValueColumnWrapper*>(col)->Append(std::stod(field));
+      break;
+    case DataType::BOOLEAN:
+      static_cast<px::types::BoolValueColumnWrapper*>(col)->Append(field == "true");
+      break;
+    case DataType::STRING:
+      static_cast<px::types::StringValueColumnWrapper*>(col)->Append(std::string(field));
+      break;
+    case DataType::TIME64NS:
+      static_cast<px::types::Time64NSValueColumnWrapper*>(col)->Append(std::stoll(field) +
+                                                                       time_offset);
+      break;
+    default:
+      LOG(ERROR) << "Couldn't convert field to a ValueType.";
+  }
+}
+
 /**
  * Convert the csv at the given filename into a Carnot table.
  * @param filename The filename of the csv to convert.
+ * @param rb_size The number of rows per record batch.
+ * @param copies The number of times the rows are added to the table. The TIME64NS columns of each
+ * copy are shifted past those of the previous one.
  * @return The Carnot table.
  */
 std::shared_ptr<px::table_store::Table> GetTableFromCsv(const std::string& filename,
-                                                        int64_t rb_size) {
+                                                        int64_t rb_size, int copies) {
   std::ifstream f(filename);
   aria::csv::CsvParser parser(f);
 
@@ -136,69 +201,78 @@ std::shared_ptr<px::table_store::Table> GetTableFromCsv(const std::string& filen
     }
   }
 
+  // Read the rows up front, so that they can be added more than once.
+  std::vector<std::vector<std::string>> rows;
+  int64_t min_time = std::numeric_limits<int64_t>::max();
+  int64_t max_time = std::numeric_limits<int64_t>::min();
+  for (auto& row : parser) {
+    rows.emplace_back(row.begin(), row.end());
+    for (size_t col_idx = 0; col_idx < types.size() && col_idx < rows.back().size(); ++col_idx) {
+      if (types[col_idx] == DataType::TIME64NS) {
+        int64_t time = std::stoll(rows.back()[col_idx]);
+        min_time = std::min(min_time, time);
+        max_time = std::max(max_time, time);
+      }
+    }
+  }
+  const int64_t time_span = max_time >= min_time ? max_time - min_time + 1 : 0;
+
   // Construct the table.
   px::table_store::schema::Relation rel(types, names);
   auto table = px::table_store::Table::Create("csv_table", rel);
 
   // Add rowbatches to the table.
-  row_idx = 0;
   std::unique_ptr<std::vector<px::types::SharedColumnWrapper>> batch;
-  for (auto& row : parser) {
-    if (row_idx % rb_size == 0) {
-      if (batch) {
-        auto s = table->TransferRecordBatch(std::move(batch));
-        if (!s.ok()) {
-          LOG(ERROR) << "Couldn't add record batch to table.";
+  auto transfer_batch = [&]() {
+    if (batch && batch->at(0)->Size() > 0) {
+      auto s = table->TransferRecordBatch(std::move(batch));
+      if (!s.ok()) {
+        LOG(ERROR) << "Couldn't add record batch to table.";
+      }
+    }
+    batch.reset();
+  };
+  for (int copy = 0; copy < copies; ++copy) {
+    for (const auto& row : rows) {
+      if (batch == nullptr) {
+        // Create new batch, with vectors for each column.
+        batch = std::make_unique<std::vector<px::types::SharedColumnWrapper>>();
+        for (auto type : types) {
+          auto wrapper = px::types::ColumnWrapper::Make(type, 0);
+          wrapper->Reserve(rb_size);
+          batch->push_back(wrapper);
         }
       }
-
-      // Create new batch.
-      batch = std::make_unique<std::vector<px::types::SharedColumnWrapper>>();
-      // Create vectors for each column.
-      for (auto type : types) {
-        auto wrapper = px::types::ColumnWrapper::Make(type, 0);
-        batch->push_back(wrapper);
+      for (size_t col_idx = 0; col_idx < row.size() && col_idx < types.size(); ++col_idx) {
+        AppendField(types[col_idx], row[col_idx], copy * time_span, batch->at(col_idx).get());
       }
-    }
-    auto col_idx = 0;
-    for (auto& field : row) {
-      switch (types[col_idx]) {
-        case DataType::INT64:
-          static_cast<px::types::Int64ValueColumnWrapper*>(batch->at(col_idx).get())
-              ->Append(std::stoi(field));
-          break;
-        case DataType::FLOAT64:
-          static_cast<px::types::Float64ValueColumnWrapper*>(batch->at(col_idx).get())
-              ->Append(std::stof(field));
-          break;
-        case DataType::BOOLEAN:
-          static_cast<px::types::BoolValueColumnWrapper*>(batch->at(col_idx).get())
-              ->Append(field == "true");
-          break;
-        case DataType::STRING:
-          static_cast<px::types::StringValueColumnWrapper*>(batch->at(col_idx).get())
-              ->Append(std::string(field));
-          break;
-        case DataType::TIME64NS:
-          static_cast<px::types::Time64NSValueColumnWrapper*>(batch->at(col_idx).get())
-              ->Append(std::stoi(field));
-          break;
-        default:
-          LOG(ERROR) << "Couldn't convert field to a ValueType.";
+      if (static_cast<int64_t>(batch->at(0)->Size()) == rb_size) {
+        transfer_batch();
       }
-      col_idx++;
     }
-    row_idx++;
   }
   // Add the final batch to the table.
-  if (batch->at(0)->Size() > 0) {
-    auto s = table->TransferRecordBatch(std::move(batch));
+  transfer_batch();
+
+  return table;
+}
+
+// Compacts all of the table's hot batches into cold batches.
+void CompactTable(px::table_store::Table* table) {
+  int64_t hot_bytes = table->GetTableStats().hot_bytes;
+  while (hot_bytes > 0) {
+    auto s = table->CompactHotToCold();
     if (!s.ok()) {
-      LOG(ERROR) << "Couldn't add record batch to table.";
+      LOG(ERROR) << "Couldn't compact table: " << s.msg();
+      return;
+    }
+    int64_t remaining_hot_bytes = table->GetTableStats().hot_bytes;
+    if (remaining_hot_bytes >= hot_bytes) {
+      // The rest is too small to fill a cold batch.
+      return;
     }
+    hot_bytes = remaining_hot_bytes;
   }
-
-  return table;
 }
 
 /**
@@ -227,6 +301,100 @@ void TableToCsv(const std::string& filename,
   output_csv.close();
 }
 
+/**
+ * Runs the query --benchmark_warmup_runs times, then --benchmark_runs times while measuring, and
+ * writes the wall times, throughput, exec stats of the last run and peak memory as JSON.
+ */
+void RunBenchmark(px::carnot::Carnot* carnot, px::carnot::exec::LocalGRPCResultSinkServer* server,
+                  const std::string& query, const px::table_store::Table& table) {
+  auto run_query = [&]() -> px::carnot::exec::QueryExecStats {
+    server->ResetQueryResults();
+    auto s = carnot->ExecuteQuery(query, sole::uuid4(), px::CurrentTimeNS(), /*analyze*/ true);
+    if (!s.ok()) {
+      LOG(FATAL) << absl::Substitute("Query failed to execute: $0", s.msg());
+    }
+    return server->exec_stats().ConsumeValueOrDie();
+  };
+
+  for (int i = 0; i < FLAGS_benchmark_warmup_runs; ++i) {
+    run_query();
+  }
+
+  px::MemoryTracker memory_tracker;
+  memory_tracker.Start();
+  std::vector<int64_t> wall_times_ns;
+  px::carnot::exec::QueryExecStats exec_stats;
+  for (int i = 0; i < FLAGS_benchmark_runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    exec_stats = run_query();
+    wall_times_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+  }
+  px::MemoryStats memory_stats = memory_tracker.End();
+
+  std::sort(wall_times_ns.begin(), wall_times_ns.end());
+  int64_t total_ns = 0;
+  for (int64_t t : wall_times_ns) {
+    total_ns += t;
+  }
+  const int64_t median_ns = wall_times_ns[wall_times_ns.size() / 2];
+  const auto& query_stats = exec_stats.execution_stats();
+  auto per_s = [median_ns](int64_t n) { return median_ns > 0 ? n * 1e9 / median_ns : 0.0; };
+
+  std::string exec_stats_json;
+  auto json_status = google::protobuf::util::MessageToJsonString(exec_stats, &exec_stats_json);
+  if (!json_status.ok()) {
+    LOG(FATAL) << "Couldn't convert exec stats to JSON: " << json_status.ToString();
+  }
+
+  auto table_stats = table.GetTableStats();
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.Key("query");
+  writer.String(query.c_str());
+  writer.Key("input_batches");
+  writer.Int64(table_stats.num_batches);
+  writer.Key("input_bytes");
+  writer.Int64(table_stats.bytes);
+  writer.Key("rowbatch_size");
+  writer.Int64(FLAGS_rowbatch_size);
+  writer.Key("warmup_runs");
+  writer.Int(FLAGS_benchmark_warmup_runs);
+  writer.Key("runs");
+  writer.Int(FLAGS_benchmark_runs);
+  writer.Key("wall_time_ns");
+  writer.StartObject();
+  writer.Key("min");
+  writer.Int64(wall_times_ns.front());
+  writer.Key("median");
+  writer.Int64(median_ns);
+  writer.Key("max");
+  writer.Int64(wall_times_ns.back());
+  writer.Key("mean");
+  writer.Int64(total_ns / static_cast<int64_t>(wall_times_ns.size()));
+  writer.EndObject();
+  writer.Key("records_processed_per_s");
+  writer.Double(per_s(query_stats.records_processed()));
+  writer.Key("bytes_processed_per_s");
+  writer.Double(per_s(query_stats.bytes_processed()));
+  writer.Key("peak_allocated_bytes");
+  writer.Int64(memory_stats.max.allocated);
+  writer.Key("peak_physical_bytes");
+  writer.Int64(memory_stats.max.physical);
+  writer.Key("exec_stats");
+  writer.RawValue(exec_stats_json.c_str(), exec_stats_json.size(), rapidjson::kObjectType);
+  writer.EndObject();
+
+  if (FLAGS_benchmark_output_file.empty()) {
+    std::cout << sb.GetString() << std::endl;
+    return;
+  }
+  std::ofstream output(FLAGS_benchmark_output_file);
+  output << sb.GetString() << std::endl;
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -235,10 +403,17 @@ int main(int argc, char* argv[]) {
   auto filename = FLAGS_input_file;
   auto output_filename = FLAGS_output_file;
   auto query = FLAGS_query;
-  auto rb_size = FLAGS_rowbatch_size;
   auto table_name = FLAGS_table_name;
+  bool benchmark = FLAGS_benchmark_runs > 0;
+  if (benchmark && gflags::GetCommandLineFlagInfoOrDie("rowbatch_size").is_default) {
+    FLAGS_rowbatch_size = kBenchmarkRowBatchSize;
+  }
+  auto rb_size = FLAGS_rowbatch_size;
 
-  auto table = GetTableFromCsv(filename, rb_size);
+  auto table = GetTableFromCsv(filename, rb_size, FLAGS_input_copies);
+  if (FLAGS_compact_input) {
+    CompactTable(table.get());
+  }
 
   // Execute query.
   auto table_store = std::make_shared<px::table_store::TableStore>();
@@ -260,6 +435,10 @@ int main(int argc, char* argv[]) {
                                            std::move(clients_config), std::move(server_config))
                     .ConsumeValueOrDie();
   table_store->AddTable(table_name, table);
+  if (benchmark) {
+    RunBenchmark(carnot.get(), &result_server, query, *table);
+    return 0;
+  }
   auto exec_status = carnot->ExecuteQuery(query, sole::uuid4(), px::CurrentTimeNS());
   if (!exec_status.ok()) {
     LOG(FATAL) << absl::Substitute("Query failed to execute: $0", exec_status.msg());
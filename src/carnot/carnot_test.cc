@@ -130,6 +130,26 @@ px.display(df, 'test_output')
   EXPECT_TRUE(rb2.ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST_F(CarnotTest, analyze_returns_profile) {
+  auto query = R"pxl(
+import px
+df = px.DataFrame(table='test_table', select=['col1', 'col2'])
+px.display(df, 'test_output')
+)pxl";
+  ASSERT_OK(carnot_->ExecuteQuery(query, sole::uuid4(), 0, /* analyze */ true));
+
+  auto exec_stats = result_server_->exec_stats().ConsumeValueOrDie();
+  ASSERT_EQ(1, exec_stats.agent_execution_stats_size());
+  const auto& agent_stats = exec_stats.agent_execution_stats(0);
+  EXPECT_LT(0, agent_stats.memory_peak_bytes());
+  ASSERT_LT(0, agent_stats.operator_execution_stats_size());
+  EXPECT_THAT(agent_stats.operator_execution_stats(0).operator_description(),
+              ::testing::HasSubstr("Op:MemorySource"));
+  EXPECT_EQ(5, agent_stats.operator_execution_stats(0).records_output());
+  EXPECT_THAT(exec_stats.profile(), ::testing::HasSubstr("Op:MemorySource"));
+  EXPECT_THAT(exec_stats.profile(), ::testing::HasSubstr("self_time"));
+}
+
 TEST_F(CarnotTest, register_metadata) {
   auto callback_calls = 0;
   carnot_->RegisterAgentMetadataCallback(
@@ -388,6 +408,20 @@ px.display(aggDF, 'test_output'))pxl";
                      arrow::default_memory_pool())));
 }
 
+TEST_F(CarnotTest, query_over_memory_limit_is_cancelled) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_carnot_query_memory_limit_bytes = 1024;
+  auto query = R"pxl(
+import px
+queryDF = px.DataFrame(table='big_test_table', select=['time_', 'col3', 'num_groups', 'string_groups'])
+aggDF = queryDF.groupby(['num_groups', 'string_groups']).agg(sum=('col3', px.sum))
+px.display(aggDF, 'test_output'))pxl";
+  auto s = carnot_->ExecuteQuery(query, sole::uuid4(), 0);
+  ASSERT_NOT_OK(s);
+  EXPECT_EQ(statuspb::RESOURCE_UNAVAILABLE, s.code());
+  EXPECT_THAT(s.msg(), ::testing::HasSubstr("per-query memory limit of 1024 bytes"));
+}
+
 TEST_F(CarnotTest, group_by_test) {
   auto query = R"pxl(
 import px
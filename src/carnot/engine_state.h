@@ -24,8 +24,12 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/ml/model_pool.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/funcs/funcs.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -57,7 +61,8 @@ class EngineState : public NotCopyable {
         stub_generator_(stub_generator),
         add_auth_to_grpc_context_func_(add_auth_to_grpc_context_func),
         grpc_router_(grpc_router),
-        model_pool_(std::move(model_pool)) {}
+        model_pool_(std::move(model_pool)),
+        result_cache_(exec::ResultCache::CreateFromFlags()) {}
 
   static StatusOr<std::unique_ptr<EngineState>> CreateDefault(
       std::unique_ptr<udf::Registry> func_registry,
@@ -76,7 +81,9 @@ class EngineState : public NotCopyable {
   }
 
   table_store::TableStore* table_store() { return table_store_.get(); }
-  std::unique_ptr<exec::ExecState> CreateExecState(const sole::uuid& query_id) {
+  std::unique_ptr<exec::ExecState> CreateExecState(const sole::uuid& query_id,
+                                                   int64_t memory_limit_bytes = 0,
+                                                   int64_t buffer_recycle_bytes = 0) {
     return std::make_unique<exec::ExecState>(
         func_registry_.get(), table_store_, stub_generator_,
         [this](const std::string& remote_addr, bool insecure) {
@@ -85,9 +92,17 @@ class EngineState : public NotCopyable {
         [this](const std::string& remote_addr, bool insecure) {
           return TraceStubGenerator(remote_addr, insecure);
         },
-        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_);
+        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_,
+        memory_limit_bytes, buffer_recycle_bytes);
   }
+  // Channels are shared by all queries that export to the same address, so that each query
+  // doesn't pay for a new connection.
   std::shared_ptr<grpc::Channel> CreateChannel(const std::string& remote_addr, bool insecure) {
+    absl::MutexLock lock(&channels_lock_);
+    auto& channel = channels_[std::make_pair(remote_addr, insecure)];
+    if (channel != nullptr) {
+      return channel;
+    }
     grpc::ChannelArguments args;
     args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, 100000);
     args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, 100000);
@@ -98,7 +113,8 @@ class EngineState : public NotCopyable {
 
     auto channel_creds = insecure ? grpc::InsecureChannelCredentials()
                                   : grpc::SslCredentials(grpc::SslCredentialsOptions());
-    return grpc::CreateCustomChannel(remote_addr, channel_creds, args);
+    channel = grpc::CreateCustomChannel(remote_addr, channel_creds, args);
+    return channel;
   }
 
   std::unique_ptr<opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface>
@@ -136,6 +152,8 @@ class EngineState : public NotCopyable {
   }
 
   exec::ml::ModelPool* model_pool() const { return model_pool_.get(); }
+  // nullptr unless --carnot_result_cache_bytes is set.
+  exec::ResultCache* result_cache() const { return result_cache_.get(); }
 
  private:
   std::unique_ptr<udf::Registry> func_registry_;
@@ -145,6 +163,11 @@ class EngineState : public NotCopyable {
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_context_func_;
   exec::GRPCRouter* grpc_router_ = nullptr;
   std::unique_ptr<exec::ml::ModelPool> model_pool_;
+  std::unique_ptr<exec::ResultCache> result_cache_;
+
+  absl::Mutex channels_lock_;
+  absl::flat_hash_map<std::pair<std::string, bool>, std::shared_ptr<grpc::Channel>> channels_
+      ABSL_GUARDED_BY(channels_lock_);
 };
 
 }  // namespace carnot
@@ -23,8 +23,13 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 
+#include <absl/strings/str_cat.h>
 #include <magic_enum.hpp>
+#include <sole.hpp>
 
 #include "src/carnot/exec/expression_evaluator.h"
 #include "src/carnot/plan/scalar_expression.h"
@@ -35,23 +40,52 @@
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 
+DEFINE_int64(carnot_agg_memory_budget_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_AGG_MEMORY_BUDGET_BYTES", 0),
+             "The estimated bytes of groups a blocking aggregate keeps in memory, beyond which the "
+             "input rows of new groups are spilled to disk. Unlimited if 0.");
+DEFINE_string(carnot_agg_spill_dir, gflags::StringFromEnv("PL_CARNOT_AGG_SPILL_DIR", "/tmp"),
+              "The directory aggregates spill input rows to.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
 constexpr int64_t kAggCompactionThreshold = 512;
+// Spilled rows are split by the top bits of their group's hash.
+constexpr int kSpillPartitionBits = 4;
+constexpr size_t kNumSpillPartitions = 1 << kSpillPartitionBits;
+// The number of rows buffered for a spill partition before they are written to a file.
+constexpr int64_t kSpillBatchRows = 8192;
+// A rough estimate of the bytes of a group besides its keys: its hash table entry, value chunks
+// and UDA states, which can't be measured.
+constexpr int64_t kGroupOverheadBytes = 256;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 namespace {
 template <types::DataType DT>
-void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
-  auto num_rows = col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*group_args)[row_idx].rt, col, rt_col_idx, row_idx);
+Status AppendRowsToBuilder(const arrow::Array* col, const std::vector<int64_t>& rows,
+                           arrow::ArrayBuilder* builder) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(rows.size()));
+  for (auto row_idx : rows) {
+    PL_RETURN_IF_ERROR(typed_builder->Append(types::GetValueFromArrowArray<DT>(col, row_idx)));
+  }
+  return Status::OK();
+}
+
+size_t SpillPartitionOf(uint64_t hash) { return hash >> (64 - kSpillPartitionBits); }
+
+int64_t EstimateGroupBytes(const RowTuple& rt) {
+  int64_t bytes = kGroupOverheadBytes + sizeof(types::FixedSizeValueUnion) * rt.fixed_values.size();
+  for (const auto& val : rt.variable_values) {
+    bytes += std::get<types::StringValue>(val).size();
   }
+  return bytes;
 }
 
 template <types::DataType DT>
@@ -65,19 +99,44 @@ void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx)
 }
 
 template <types::DataType DT>
-void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
+void ExtractToColumnWrapper(const std::vector<AggHashValue*>& row_groups,
                             const table_store::schema::RowBatch& rb, size_t col_idx,
                             size_t rb_col_idx) {
   size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
+  DCHECK(num_rows <= row_groups.size());
+  auto arr = rb.ColumnAt(rb_col_idx).get();
   for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
-    auto arr = rb.ColumnAt(rb_col_idx).get();
+    // Spilled rows have no group.
+    if (row_groups[row_idx] == nullptr) {
+      continue;
+    }
+    auto col_wrapper = row_groups[row_idx]->agg_cols[col_idx].get();
     types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
   }
 }
 
+// Divides the values of an INT64 or FLOAT64 array by the sample rate, to estimate the count or sum
+// of all of the rows from that of the sample.
+Status ScaleBySampleRate(double sample_rate, arrow::MemoryPool* mem_pool,
+                         std::shared_ptr<arrow::Array>* arr) {
+  auto dt = types::ArrowToDataType((*arr)->type_id());
+  if (dt != types::DataType::INT64 && dt != types::DataType::FLOAT64) {
+    return Status::OK();
+  }
+  auto builder = types::MakeArrowBuilder(dt, mem_pool);
+  PL_RETURN_IF_ERROR(builder->Reserve((*arr)->length()));
+  for (int64_t i = 0; i < (*arr)->length(); ++i) {
+    if (dt == types::DataType::INT64) {
+      auto v = types::GetValueFromArrowArray<types::DataType::INT64>(arr->get(), i);
+      static_cast<arrow::Int64Builder*>(builder.get())->UnsafeAppend(std::llround(v / sample_rate));
+    } else {
+      auto v = types::GetValueFromArrowArray<types::DataType::FLOAT64>(arr->get(), i);
+      static_cast<arrow::DoubleBuilder*>(builder.get())->UnsafeAppend(v / sample_rate);
+    }
+  }
+  return builder->Finish(arr);
+}
+
 }  // namespace
 
 std::string AggNode::DebugStringImpl() {
@@ -106,10 +165,32 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     }
   }
 
-  size_t output_size = plan_node_->values().size() + plan_node_->groups().size();
+  size_t num_value_cols = IsPartial() ? 1 : plan_node_->values().size();
+  size_t output_size = num_value_cols + plan_node_->groups().size();
   if (output_size != output_descriptor_->size()) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
+  if ((IsPartial() || IsFinalize()) && plan_node_->windowed()) {
+    return error::InvalidArgument("Windowed aggregates can't be split into partial aggregates");
+  }
+  if (IsFinalize() && (input_descriptor_->size() != plan_node_->groups().size() + 1 ||
+                       input_descriptor_->type(SerializedColumnIndex()) != types::STRING)) {
+    return error::InvalidArgument(
+        "Finalize aggregate expects the groups and serialized aggregates as input");
+  }
+
+  sliding_ = plan_node_->windowed() && plan_node_->window_panes() > 1;
+  if (sliding_) {
+    pane_pool_ = std::make_unique<ObjectArena>("agg_pane_pool");
+  }
+
+  // The counts and sums over a sample of the input are scaled up to estimate those of all of it.
+  // The other aggregates, such as means and quantiles, are estimated by those of the sample.
+  if (plan_node_->sampled() && !IsPartial()) {
+    for (const auto& value : plan_node_->values()) {
+      scale_by_sample_rate_.push_back(value->name() == "count" || value->name() == "sum");
+    }
+  }
 
   if (HasNoGroups()) {
     return Status::OK();
@@ -123,18 +204,28 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
   // The case of GroupByNone, there will be no groups.
   auto groups_size = plan_node_->groups().size();
   group_data_types_.reserve(groups_size);
+  group_value_eq_fns_.reserve(groups_size);
   for (const auto& group : plan_node_->groups()) {
     DCHECK(group.idx < input_descriptor_->size());
-    group_data_types_.emplace_back(input_descriptor_->type(group.idx));
+    auto dt = input_descriptor_->type(group.idx);
+    group_data_types_.emplace_back(dt);
+#define TYPE_CASE(_dt_) group_value_eq_fns_.emplace_back(&ColumnValueEq<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
   }
 
-  auto values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
+  for (size_t i = 0; i < num_value_cols; ++i) {
     auto values_idx = i + groups_size;
     DCHECK(values_idx < output_descriptor_->size());
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  spill_enabled_ = FLAGS_carnot_agg_memory_budget_bytes > 0 && !plan_node_->windowed();
+  if (spill_enabled_) {
+    spill_rows_.resize(kNumSpillPartitions);
+    spill_partitions_.resize(kNumSpillPartitions);
+  }
+
   return CreateColumnMapping();
 }
 
@@ -159,114 +250,220 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
 
 Status AggNode::CloseImpl(ExecState*) {
   udas_no_groups_.clear();
-  group_args_chunk_.clear();
+  agg_hash_map_.clear();
+  panes_.clear();
+  window_pool_.Clear();
+  row_groups_.clear();
+  spill_partitions_.clear();
+  partition_pool_.Clear();
   group_args_pool_.Clear();
   udas_pool_.Clear();
 
   return Status::OK();
 }
 
+int64_t AggNode::ExternalMemoryBytes() const {
+  int64_t bytes = agg_hash_map_.memory_bytes() + group_args_pool_.bytes_allocated() +
+                  udas_pool_.bytes_allocated() + partition_pool_.bytes_allocated() +
+                  window_pool_.bytes_allocated();
+  if (pane_pool_ != nullptr) {
+    bytes += pane_pool_->bytes_allocated();
+  }
+  for (const auto& pane : panes_) {
+    bytes += pane.groups.memory_bytes() + pane.pool->bytes_allocated();
+  }
+  return bytes;
+}
+
 bool AggNode::ReadyToEmitBatches(const RowBatch& rb) const {
   return rb.eos() || (rb.eow() && plan_node_->windowed());
 }
 
 Status AggNode::ClearAggState(ExecState* exec_state) {
+  if (sliding_) {
+    AggPane pane;
+    std::swap(pane.groups, agg_hash_map_);
+    pane.udas_no_groups.swap(udas_no_groups_);
+    pane.pool = std::move(pane_pool_);
+    pane_pool_ = std::make_unique<ObjectArena>("agg_pane_pool");
+    panes_.push_back(std::move(pane));
+    // The next result covers the panes still in the window, and the next input window.
+    while (static_cast<int64_t>(panes_.size()) >= plan_node_->window_panes()) {
+      panes_.pop_front();
+    }
+  }
   if (HasNoGroups()) {
     udas_no_groups_.clear();
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
   agg_hash_map_.clear();
+  for (auto& partition : spill_partitions_) {
+    partition.num_buffered_rows = 0;
+    partition.batches.clear();
+  }
+  spilling_ = false;
+  group_bytes_ = 0;
   return Status::OK();
 }
 
 Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb) {
-  auto values = plan_node_->values();
-  for (size_t i = 0; i < values.size(); ++i) {
-    PL_RETURN_IF_ERROR(
-        EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+  if (IsFinalize()) {
+    auto serialized = rb.ColumnAt(SerializedColumnIndex()).get();
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      PL_RETURN_IF_ERROR(MergeSerializedUDAs(exec_state, &udas_no_groups_,
+                                             types::GetStringViewFromArrowArray(serialized, i)));
+    }
+  } else {
+    auto values = plan_node_->values();
+    for (size_t i = 0; i < values.size(); ++i) {
+      PL_RETURN_IF_ERROR(
+          EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+    }
   }
 
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, 1);
-    for (size_t i = 0; i < values.size(); ++i) {
-      const auto& uda_info = udas_no_groups_[i];
+    if (sliding_) {
+      PL_RETURN_IF_ERROR(SendWindowNoGroups(exec_state, rb));
+    } else {
+      PL_RETURN_IF_ERROR(SendNoGroups(exec_state, udas_no_groups_, rb));
+    }
+    PL_RETURN_IF_ERROR(ClearAggState(exec_state));
+  }
+  return Status::OK();
+}
+
+Status AggNode::SendNoGroups(ExecState* exec_state, const std::vector<UDAInfo>& udas,
+                             const RowBatch& rb) {
+  RowBatch output_rb(*output_descriptor_, 1);
+  if (IsPartial()) {
+    types::StringValue serialized;
+    PL_RETURN_IF_ERROR(SerializeUDAs(udas, &serialized));
+    arrow::StringBuilder builder(exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(builder.Append(serialized));
+    SharedArray out_col;
+    PL_RETURN_IF_ERROR(builder.Finish(&out_col));
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
+  } else {
+    for (const auto& [i, uda_info] : Enumerate(udas)) {
       auto builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
                                              exec_state->exec_mem_pool());
       PL_RETURN_IF_ERROR(
           uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
       SharedArray out_col;
       PL_RETURN_IF_ERROR(builder->Finish(&out_col));
+      PL_RETURN_IF_ERROR(ScaleSampledValue(exec_state, i, &out_col));
       PL_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
     }
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PL_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
-  return Status::OK();
+  output_rb.set_eow(rb.eow());
+  output_rb.set_eos(rb.eos());
+  return SendRowBatchToChildren(exec_state, output_rb);
 }
 
-Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
-  // Grow the group_args_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (group_args_chunk_.size() < num_rows) {
-    int prev_size = group_args_chunk_.size();
-    group_args_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
+Status AggNode::ScaleSampledValue(ExecState* exec_state, size_t value_idx,
+                                  std::shared_ptr<arrow::Array>* arr) {
+  if (value_idx >= scale_by_sample_rate_.size() || !scale_by_sample_rate_[value_idx]) {
+    return Status::OK();
+  }
+  return ScaleBySampleRate(plan_node_->sample_rate(), exec_state->exec_mem_pool(), arr);
+}
+
+Status AggNode::SendWindowNoGroups(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<UDAInfo> window;
+  PL_RETURN_IF_ERROR(CreateUDAInfoValues(&window, exec_state));
+  auto merge_pane = [&](const std::vector<UDAInfo>& udas) -> Status {
+    DCHECK_EQ(window.size(), udas.size());
+    for (size_t i = 0; i < window.size(); ++i) {
+      PL_RETURN_IF_ERROR(
+          window[i].def->Merge(window[i].uda.get(), udas[i].uda.get(), function_ctx_.get()));
     }
+    return Status::OK();
+  };
+  for (const auto& pane : panes_) {
+    PL_RETURN_IF_ERROR(merge_pane(pane.udas_no_groups));
   }
+  PL_RETURN_IF_ERROR(merge_pane(udas_no_groups_));
+  return SendNoGroups(exec_state, window, rb);
+}
 
-  // Scan through all the group args in column order and extract the entire column.
+void AggNode::HashGroupColumns(const RowBatch& rb) {
+  row_hashes_.assign(rb.num_rows(), 0);
+  // Hash a column at a time, so each loop runs over a single arrow array of a single type.
   for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
     auto grp = plan_node_->groups()[idx];
     DCHECK(grp.idx < input_descriptor_->size());
     DCHECK(idx < group_data_types_.size());
-    auto dt = group_data_types_[idx];
     auto col = rb.ColumnAt(grp.idx).get();
 
-#define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
-    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#define TYPE_CASE(_dt_) HashColumn<_dt_>(col, &row_hashes_);
+    PL_SWITCH_FOREACH_DATATYPE(group_data_types_[idx], TYPE_CASE);
 #undef TYPE_CASE
   }
-  return Status::OK();
+}
+
+RowTuple* AggNode::ExtractGroupRowTuple(const RowBatch& rb, int64_t row_idx) {
+  auto* rt = CreateGroupArgsRowTuple();
+  for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
+    auto col = rb.ColumnAt(plan_node_->groups()[idx].idx).get();
+#define TYPE_CASE(_dt_) ExtractIntoRowTuple<_dt_>(rt, col, idx, row_idx);
+    PL_SWITCH_FOREACH_DATATYPE(group_data_types_[idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return rt;
 }
 
 Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PL_UNUSED(exec_state);
-  // Loop through all the row and basically store the values into column chunk based on which
-  // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
+  HashGroupColumns(rb);
+
+  std::vector<const arrow::Array*> group_cols;
+  group_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
+    group_cols.push_back(rb.ColumnAt(grp.idx).get());
+  }
+
+  // Find the group of each row, inserting the groups we haven't seen before. Rows outside of the
+  // selection, if any, have no group.
+  row_groups_.assign(rb.num_rows(), nullptr);
+  for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+    int64_t row_idx = rb.has_selection() ? (*rb.selection())[i] : i;
+    auto row_eq = [&](const RowTuple* rt) {
+      for (size_t idx = 0; idx < group_cols.size(); ++idx) {
+        if (!group_value_eq_fns_[idx](group_cols[idx], row_idx, *rt, idx)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    AggHashValue** val = agg_hash_map_.Find(row_hashes_[row_idx], row_eq);
+    if (val == nullptr && spilling_) {
+      spill_rows_[SpillPartitionOf(row_hashes_[row_idx])].push_back(row_idx);
+      continue;
     }
-    ga.av = val;
+    if (val == nullptr) {
+      auto* rt = ExtractGroupRowTuple(rb, row_idx);
+      val = agg_hash_map_.Insert(row_hashes_[row_idx], rt,
+                                 CreateAggHashValue(exec_state, GroupPool(&udas_pool_)));
+      group_bytes_ += EstimateGroupBytes(*rt);
+      spilling_ = spill_enabled_ && !finalizing_partition_ &&
+                  group_bytes_ > FLAGS_carnot_agg_memory_budget_bytes;
+    }
+    row_groups_[row_idx] = *val;
   }
 
-  auto values = plan_node_->values();
   // Now extract the values in the agg hash value.
   for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
     const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
     const auto& dt = input_descriptor_->type(rb_col_idx);
 
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
+#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(row_groups_, rb, i, rb_col_idx);
 
     PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
   }
 
+  if (spilling_) {
+    PL_RETURN_IF_ERROR(SpillRows(exec_state, rb));
+  }
   return Status::OK();
 }
 
@@ -275,31 +472,171 @@ Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_reco
   // TODO(zasgar): This only needs to run for unique groups. We should find
   // a way to optimize this.
   for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
-    auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
-    if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
-      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
+    DCHECK(i < row_groups_.size());
+    auto* av = row_groups_[i];
+    if (av != nullptr && av->agg_cols[0]->Size() > kAggCompactionThreshold) {
+      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, av));
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
-  for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
-    group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
+Status AggNode::SpillRows(ExecState* exec_state, const RowBatch& rb) {
+  for (size_t p = 0; p < kNumSpillPartitions; ++p) {
+    auto& rows = spill_rows_[p];
+    if (rows.empty()) {
+      continue;
+    }
+    auto& partition = spill_partitions_[p];
+    if (partition.builders.empty()) {
+      for (size_t col_idx = 0; col_idx < input_descriptor_->size(); ++col_idx) {
+        partition.builders.push_back(
+            types::MakeArrowBuilder(input_descriptor_->type(col_idx), exec_state->exec_mem_pool()));
+      }
+    }
+    for (size_t col_idx = 0; col_idx < input_descriptor_->size(); ++col_idx) {
+      auto col = rb.ColumnAt(col_idx).get();
+      auto builder = partition.builders[col_idx].get();
+#define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(AppendRowsToBuilder<_dt_>(col, rows, builder));
+      PL_SWITCH_FOREACH_DATATYPE(input_descriptor_->type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    partition.num_buffered_rows += rows.size();
+    rows.clear();
+    if (partition.num_buffered_rows >= kSpillBatchRows) {
+      PL_RETURN_IF_ERROR(FlushSpillPartition(&partition));
     }
   }
   return Status::OK();
 }
 
+Status AggNode::FlushSpillPartition(SpillPartition* partition) {
+  if (partition->num_buffered_rows == 0) {
+    return Status::OK();
+  }
+  std::vector<SharedArray> columns;
+  for (const auto& builder : partition->builders) {
+    SharedArray arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    columns.push_back(std::move(arr));
+  }
+  partition->num_buffered_rows = 0;
+
+  if (spill_file_prefix_.empty()) {
+    std::filesystem::path dir(FLAGS_carnot_agg_spill_dir);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+      return error::Internal("Failed to create aggregate spill directory $0: $1", dir.string(),
+                             ec.message());
+    }
+    spill_file_prefix_ = (dir / absl::StrCat("agg_", sole::uuid4().str())).string();
+  }
+  auto path = absl::StrCat(spill_file_prefix_, "_", num_spill_files_++, ".spill");
+  PL_ASSIGN_OR_RETURN(auto batch, table_store::internal::DiskBatch::Write(path, columns));
+  partition->batches.push_back(std::move(batch));
+  return Status::OK();
+}
+
+bool AggNode::HasSpilled() const {
+  for (const auto& partition : spill_partitions_) {
+    if (partition.num_buffered_rows > 0 || !partition.batches.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status AggNode::SendGroups(ExecState* exec_state, const RowBatch& rb, bool last) {
+  RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
+  PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(last && rb.eow());
+  output_rb.set_eos(last && rb.eos());
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
+Status AggNode::SendSpilledGroups(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<size_t> spilled;
+  for (size_t p = 0; p < spill_partitions_.size(); ++p) {
+    PL_RETURN_IF_ERROR(FlushSpillPartition(&spill_partitions_[p]));
+    if (!spill_partitions_[p].batches.empty()) {
+      spilled.push_back(p);
+    }
+  }
+  DCHECK(!spilled.empty());
+  spilling_ = false;
+
+  // A group in memory can also have rows on disk if it was merged in from another node, so the
+  // groups of spilled partitions are aggregated along with their partition.
+  AggHashMap in_memory;
+  std::swap(in_memory, agg_hash_map_);
+  std::vector<AggHashMap> partition_groups(spill_partitions_.size());
+  for (const auto& entry : in_memory) {
+    auto p = SpillPartitionOf(entry.hash);
+    auto* groups = spill_partitions_[p].batches.empty() ? &agg_hash_map_ : &partition_groups[p];
+    groups->Insert(entry.hash, entry.key, entry.value);
+  }
+  if (!agg_hash_map_.empty()) {
+    PL_RETURN_IF_ERROR(SendGroups(exec_state, rb, /*last*/ false));
+  }
+
+  finalizing_partition_ = true;
+  for (const auto& p : spilled) {
+    std::swap(agg_hash_map_, partition_groups[p]);
+    auto batches = std::move(spill_partitions_[p].batches);
+    for (const auto& batch : batches) {
+      RowBatch spilled_rb(*input_descriptor_, batch.Length());
+      for (const auto& col : batch.columns()) {
+        PL_RETURN_IF_ERROR(spilled_rb.AddColumn(col));
+      }
+      PL_RETURN_IF_ERROR(HashRowBatch(exec_state, spilled_rb));
+      if (plan_node_->values().size() > 0) {
+        PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, spilled_rb.num_rows()));
+      }
+    }
+    // Removes the partition's files.
+    batches.clear();
+    PL_RETURN_IF_ERROR(SendGroups(exec_state, rb, /*last*/ p == spilled.back()));
+    agg_hash_map_.clear();
+    partition_pool_.Clear();
+  }
+  finalizing_partition_ = false;
+  return Status::OK();
+}
+
+Status AggNode::SendWindowGroups(ExecState* exec_state, const RowBatch& rb) {
+  AggHashMap window;
+  auto merge_pane = [&](const AggHashMap& groups) -> Status {
+    for (const auto& entry : groups) {
+      // Fold the values the pane hasn't aggregated yet into its UDAs.
+      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, entry.value));
+      AggHashValue** found =
+          window.Find(entry.hash, [&](const RowTuple* rt) { return *rt == *entry.key; });
+      // The group's row tuple stays owned by the first pane it is in.
+      AggHashValue* val = found != nullptr
+                              ? *found
+                              : *window.Insert(entry.hash, entry.key,
+                                               CreateAggHashValue(exec_state, &window_pool_));
+      for (size_t i = 0; i < val->udas.size(); ++i) {
+        const auto& uda_info = val->udas[i];
+        PL_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(), entry.value->udas[i].uda.get(),
+                                               function_ctx_.get()));
+      }
+    }
+    return Status::OK();
+  };
+  for (const auto& pane : panes_) {
+    PL_RETURN_IF_ERROR(merge_pane(pane.groups));
+  }
+  PL_RETURN_IF_ERROR(merge_pane(agg_hash_map_));
+
+  std::swap(window, agg_hash_map_);
+  auto s = SendGroups(exec_state, rb, /*last*/ true);
+  std::swap(window, agg_hash_map_);
+  window_pool_.Clear();
+  return s;
+}
+
 Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
   PL_UNUSED(exec_state);
   DCHECK(output_rb != nullptr);
@@ -313,9 +650,9 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
   }
 
   // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
+  for (const auto& entry : agg_hash_map_) {
+    auto* groups_rt = entry.key;
+    auto* val = entry.value;
 
     for (size_t i = 0; i < group_data_types_.size(); ++i) {
       DCHECK(i < group_builders.size());
@@ -326,6 +663,13 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     }
     // Actually Finalize the UDA based on the column wrapper chunks.
     PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+    if (IsPartial()) {
+      types::StringValue serialized;
+      PL_RETURN_IF_ERROR(SerializeUDAs(val->udas, &serialized));
+      PL_RETURN_IF_ERROR(
+          static_cast<arrow::StringBuilder*>(value_builders[0].get())->Append(serialized));
+      continue;
+    }
     for (size_t i = 0; i < val->udas.size(); ++i) {
       const auto& uda_info = val->udas[i];
       PL_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
@@ -339,9 +683,10 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
   }
 
-  for (const auto& value_builder : value_builders) {
+  for (const auto& [i, value_builder] : Enumerate(value_builders)) {
     std::shared_ptr<arrow::Array> arr;
     PL_RETURN_IF_ERROR(value_builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(ScaleSampledValue(exec_state, i, &arr));
     PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
   }
 
@@ -349,31 +694,76 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
 }
 
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
-  // Extracts the row tuples (column wise).
-  // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
-  // is large. The process is as follows:
-  // 1. Extract each column into the appropriate part of the row tuple.
-  // 2. Hash row batch and update agg values.
+  // The process is as follows:
+  // 1. Hash the group columns (column wise).
+  // 2. Look up the group of each row, and append its values to the group's agg values.
   // 3. If the agg values are large then run aggregate and compact.
-  // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
-  PL_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
+  // 4. If it's the last batch then emit the values.
   PL_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
   if (plan_node_->values().size() > 0) {
     PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
   }
-  PL_RETURN_IF_ERROR(ResetGroupArgs());
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    if (sliding_) {
+      PL_RETURN_IF_ERROR(SendWindowGroups(exec_state, rb));
+    } else if (HasSpilled()) {
+      PL_RETURN_IF_ERROR(SendSpilledGroups(exec_state, rb));
+    } else {
+      PL_RETURN_IF_ERROR(SendGroups(exec_state, rb, /*last*/ true));
+    }
     PL_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
   return Status::OK();
 }
 
+Status AggNode::MergeFrom(ExecState* exec_state, AggNode* other) {
+  DCHECK(!plan_node_->windowed());
+  if (HasNoGroups()) {
+    DCHECK_EQ(udas_no_groups_.size(), other->udas_no_groups_.size());
+    for (size_t i = 0; i < udas_no_groups_.size(); ++i) {
+      const auto& uda_info = udas_no_groups_[i];
+      PL_RETURN_IF_ERROR(uda_info.def->Merge(
+          uda_info.uda.get(), other->udas_no_groups_[i].uda.get(), function_ctx_.get()));
+    }
+    return Status::OK();
+  }
+
+  for (const auto& entry : other->agg_hash_map_) {
+    auto* other_val = entry.value;
+    // Fold the values the other node hasn't aggregated yet into its UDAs.
+    PL_RETURN_IF_ERROR(other->EvaluateAggHashValue(exec_state, other_val));
+    // Both nodes hash group columns the same way, so the other node's hashes can be reused.
+    AggHashValue** found =
+        agg_hash_map_.Find(entry.hash, [&](const RowTuple* rt) { return *rt == *entry.key; });
+    if (found == nullptr) {
+      // The group's row tuple and value stay owned by the other node's pools.
+      agg_hash_map_.Insert(entry.hash, entry.key, other_val);
+      continue;
+    }
+    auto* val = *found;
+    DCHECK_EQ(val->udas.size(), other_val->udas.size());
+    for (size_t i = 0; i < val->udas.size(); ++i) {
+      const auto& uda_info = val->udas[i];
+      PL_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(), other_val->udas[i].uda.get(),
+                                             function_ctx_.get()));
+    }
+  }
+  other->agg_hash_map_.clear();
+  group_bytes_ += other->group_bytes_;
+
+  // The other node's spilled rows are aggregated with ours at eos.
+  DCHECK_EQ(spill_partitions_.size(), other->spill_partitions_.size());
+  for (size_t p = 0; p < spill_partitions_.size(); ++p) {
+    auto* other_partition = &other->spill_partitions_[p];
+    PL_RETURN_IF_ERROR(other->FlushSpillPartition(other_partition));
+    for (auto& batch : other_partition->batches) {
+      spill_partitions_[p].batches.push_back(std::move(batch));
+    }
+    other_partition->batches.clear();
+  }
+  return Status::OK();
+}
+
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
   // Agg exprs can only be of type col, or  const.
   switch (expr.ExpressionType()) {
@@ -432,6 +822,16 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
 }
 
 Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
+  if (IsFinalize()) {
+    // The only stored column is the serialized one.
+    const auto* serialized = val->agg_cols[0].get();
+    for (size_t i = 0; i < serialized->Size(); ++i) {
+      PL_RETURN_IF_ERROR(MergeSerializedUDAs(exec_state, &val->udas,
+                                             serialized->Get<types::StringValue>(i)));
+    }
+    val->agg_cols[0]->Clear();
+    return Status::OK();
+  }
   size_t values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
     const auto& uda_info = val->udas[i];
@@ -481,6 +881,13 @@ Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
 }
 
 Status AggNode::CreateColumnMapping() {
+  if (IsFinalize()) {
+    // The value expressions refer to the input of the partial aggregates.
+    plan_cols_to_stored_map_[SerializedColumnIndex()] = 0;
+    stored_cols_to_plan_idx_.emplace_back(SerializedColumnIndex());
+    stored_cols_data_types_.emplace_back(types::STRING);
+    return Status::OK();
+  }
   for (const auto& expr : plan_node_->values()) {
     plan::ExpressionWalker<int> walker;
 
@@ -506,8 +913,8 @@ Status AggNode::CreateColumnMapping() {
   return Status::OK();
 }
 
-AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
+AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state, ObjectArena* pool) {
+  auto* val = pool->New<AggHashValue>();
   PL_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
   for (const auto& dt : stored_cols_data_types_) {
     val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
@@ -520,11 +927,11 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
   CHECK_EQ(val->size(), 0ULL);
 
   for (const auto& value : plan_node_->values()) {
-    std::vector<types::DataType> types;
-    types.reserve(value->Deps().size());
-    for (auto* dep : value->Deps()) {
-      PL_ASSIGN_OR_RETURN(auto type, GetTypeOfDep(*dep));
-      types.push_back(type);
+    // The deps of a finalize aggregate's values are columns of the partial aggregates' input.
+    if (!IsFinalize()) {
+      for (auto* dep : value->Deps()) {
+        PL_RETURN_IF_ERROR(GetTypeOfDep(*dep));
+      }
     }
     auto def = exec_state->GetUDADefinition(value->uda_id());
     auto uda = def->Make();
@@ -541,6 +948,44 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
   return Status::OK();
 }
 
+Status AggNode::SerializeUDAs(const std::vector<UDAInfo>& udas, types::StringValue* output) {
+  output->clear();
+  for (const auto& uda_info : udas) {
+    types::StringValue state;
+    PL_RETURN_IF_ERROR(uda_info.def->Serialize(uda_info.uda.get(), function_ctx_.get(), &state));
+    int64_t size = state.size();
+    output->append(reinterpret_cast<const char*>(&size), sizeof(size));
+    output->append(state);
+  }
+  return Status::OK();
+}
+
+Status AggNode::MergeSerializedUDAs(ExecState* exec_state, std::vector<UDAInfo>* udas,
+                                    std::string_view serialized) {
+  std::vector<UDAInfo> partial;
+  PL_RETURN_IF_ERROR(CreateUDAInfoValues(&partial, exec_state));
+  DCHECK_EQ(partial.size(), udas->size());
+  for (size_t i = 0; i < partial.size(); ++i) {
+    int64_t size;
+    if (serialized.size() < sizeof(size)) {
+      return error::InvalidArgument("Truncated serialized aggregate $0", i);
+    }
+    std::memcpy(&size, serialized.data(), sizeof(size));
+    serialized.remove_prefix(sizeof(size));
+    if (size < 0 || static_cast<size_t>(size) > serialized.size()) {
+      return error::InvalidArgument("Truncated serialized aggregate $0", i);
+    }
+    types::StringValue state(std::string(serialized.substr(0, size)));
+    serialized.remove_prefix(size);
+
+    PL_RETURN_IF_ERROR(
+        partial[i].def->Deserialize(partial[i].uda.get(), function_ctx_.get(), state));
+    PL_RETURN_IF_ERROR(
+        (*udas)[i].def->Merge((*udas)[i].uda.get(), partial[i].uda.get(), function_ctx_.get()));
+  }
+  return Status::OK();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -17,16 +17,21 @@
  */
 
 #pragma once
+#include <gflags/gflags.h>
+
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/group_hash_table.h"
 #include "src/carnot/exec/row_tuple.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
@@ -38,8 +43,12 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
+#include "src/table_store/table/internal/disk_batch.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_agg_memory_budget_bytes);
+DECLARE_string(carnot_agg_spill_dir);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -57,19 +66,44 @@ struct AggHashValue {
   std::vector<types::SharedColumnWrapper> agg_cols;
 };
 
-struct GroupArgs {
-  explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
-  RowTuple* rt;
-  AggHashValue* av;
-};
-
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
+  // The keys are owned by the group_args_pool_ and the values by the udas_pool_.
+  using AggHashMap = GroupHashTable<RowTuple*, AggHashValue*>;
+  // The input rows of one hash partition that were spilled to disk.
+  struct SpillPartition {
+    // Rows are buffered here until there are enough for a file.
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+    int64_t num_buffered_rows = 0;
+    // The files are removed when the batches are destroyed.
+    std::vector<table_store::internal::DiskBatch> batches;
+  };
+  // The aggregate state of one closed input window of a sliding window aggregate.
+  struct AggPane {
+    AggHashMap groups;
+    std::vector<UDAInfo> udas_no_groups;
+    // Owns the row tuples and values of the groups.
+    std::unique_ptr<ObjectArena> pool;
+  };
 
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  /**
+   * MergeFrom merges the aggregate state of another node of the same blocking aggregate, which has
+   * seen a different part of the input, into this one. The other node must not be used again, but
+   * must not be closed before this one has emitted its result, since the groups only it has are
+   * moved over without being copied.
+   */
+  Status MergeFrom(ExecState* exec_state, AggNode* other);
+
+  // Only the aggregates with groups skip the rows outside of a selection; the others update
+  // their UDAs with whole columns.
+  bool SupportsSelection() const override { return !HasNoGroups(); }
+
+  // The groups in memory, and the panes of a sliding window.
+  int64_t ExternalMemoryBytes() const override;
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -85,12 +119,18 @@ class AggNode : public ProcessingNode {
  private:
   AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  bool IsPartial() const { return plan_node_->partial_agg(); }
+  bool IsFinalize() const { return plan_node_->finalize_agg(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
   bool ReadyToEmitBatches(const table_store::schema::RowBatch& rb) const;
-  // When we see a new window, we need to be able to clear the aggregate state.
+  // When we see a new window, we need to be able to clear the aggregate state. For a sliding
+  // window aggregate, the state is kept as a pane until the window has moved past it.
   Status ClearAggState(ExecState* exec_state);
+  // Scales the finalized values of a count or sum over a sampled input by the sample rate.
+  Status ScaleSampledValue(ExecState* exec_state, size_t value_idx,
+                           std::shared_ptr<arrow::Array>* arr);
 
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
@@ -121,34 +161,93 @@ class AggNode : public ProcessingNode {
   // 3. The data type of the stored colums, by the index they are stored at.
   std::vector<types::DataType> stored_cols_data_types_;
 
-  ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
+  ObjectArena group_args_pool_{"group_args_pool"};
+  ObjectArena udas_pool_{"udas_pool"};
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
-
-  // We construct row-tuples in a batch, chunked by each column.
-  // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
-
-  std::vector<GroupArgs> group_args_chunk_;
+  // Whether each value is a count or sum to scale by the sample rate of the input.
+  std::vector<bool> scale_by_sample_rate_;
+  // The comparison function of each group column, by group index.
+  std::vector<ColumnValueEqFn> group_value_eq_fns_;
+
+  // Row batches are hashed a column at a time into row_hashes_, then each row is looked up in
+  // the hash table and its group stored in row_groups_. A RowTuple is only created for new groups.
+  std::vector<uint64_t> row_hashes_;
+  std::vector<AggHashValue*> row_groups_;
+
+  // Blocking aggregates with groups keep the estimated size of their groups within
+  // --carnot_agg_memory_budget_bytes, if set. Once over the budget, the groups already in memory
+  // keep being updated, but the input rows of any other group are spilled to disk, split by hash
+  // partition. At eos the groups in memory are emitted first, then each spilled partition is
+  // aggregated and emitted on its own, so that only one partition's groups are in memory at once.
+  bool spill_enabled_ = false;
+  bool spilling_ = false;
+  bool finalizing_partition_ = false;
+  int64_t group_bytes_ = 0;
+  // The rows of the current batch to spill, by partition.
+  std::vector<std::vector<int64_t>> spill_rows_;
+  std::vector<SpillPartition> spill_partitions_;
+  std::string spill_file_prefix_;
+  int64_t num_spill_files_ = 0;
+  // Owns the groups created while aggregating a spilled partition, until it is emitted.
+  ObjectArena partition_pool_{"agg_partition_pool"};
   // END: Variables specific to GroupBy Agg.
 
+  // Windowed aggregates with window_panes > 1 slide the window by one input window at each eow.
+  // Each input window is aggregated on its own into a pane, and a result is the UDA Merge of the
+  // last window_panes panes, so that a pane's input is only aggregated once. The current pane is
+  // in agg_hash_map_ or udas_no_groups_, allocated from pane_pool_, and the closed ones in panes_,
+  // oldest first.
+  bool sliding_ = false;
+  std::unique_ptr<ObjectArena> pane_pool_;
+  std::deque<AggPane> panes_;
+  // Owns the merged values of the window being emitted.
+  ObjectArena window_pool_{"agg_window_pool"};
+
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
-  Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
+  void HashGroupColumns(const table_store::schema::RowBatch& rb);
+  RowTuple* ExtractGroupRowTuple(const table_store::schema::RowBatch& rb, int64_t row_idx);
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
-  Status ResetGroupArgs();
+  Status SpillRows(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status FlushSpillPartition(SpillPartition* partition);
+  bool HasSpilled() const;
+  // Sends the groups in agg_hash_map_. Only the last batch of the result carries rb's eow and eos.
+  Status SendGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb, bool last);
+  Status SendSpilledGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
                                      table_store::schema::RowBatch* output_rb);
 
-  AggHashValue* CreateAggHashValue(ExecState* exec_state);
+  Status SendNoGroups(ExecState* exec_state, const std::vector<UDAInfo>& udas,
+                     const table_store::schema::RowBatch& rb);
+  // Send the result of the sliding window, merged from the closed panes and the current one.
+  Status SendWindowNoGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status SendWindowGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+
+  AggHashValue* CreateAggHashValue(ExecState* exec_state, ObjectArena* pool);
+  // The pool new groups are allocated from, pool unless a partition or a pane owns them.
+  ObjectArena* GroupPool(ObjectArena* pool) {
+    if (finalizing_partition_) {
+      return &partition_pool_;
+    }
+    return sliding_ ? pane_pool_.get() : pool;
+  }
   RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
+    return GroupPool(&group_args_pool_)->New<RowTuple>(&group_data_types_);
   }
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
+
+  // A partial aggregate outputs the state of its UDAs for each group, serialized into a single
+  // string column, which a finalize aggregate downstream deserializes and merges into its own.
+  // The state of each UDA is written as its length followed by its bytes.
+  Status SerializeUDAs(const std::vector<UDAInfo>& udas, types::StringValue* output);
+  Status MergeSerializedUDAs(ExecState* exec_state, std::vector<UDAInfo>* udas,
+                             std::string_view serialized);
+  int64_t SerializedColumnIndex() const { return input_descriptor_->size() - 1; }
 };
 
 }  // namespace exec
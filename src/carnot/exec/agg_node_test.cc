@@ -19,11 +19,16 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
+#include <filesystem>
+#include <vector>
 
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
 #include <sole.hpp>
 
+#include "src/carnot/exec/exec_node_mock.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/carnot/udf/registry.h"
@@ -34,6 +39,7 @@ namespace px {
 namespace carnot {
 namespace exec {
 
+using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 using ::testing::_;
 using types::Int64Value;
@@ -48,6 +54,11 @@ class MinSumUDA : public udf::UDA {
   }
   void Merge(udf::FunctionContext*, const MinSumUDA& other) { sum_ = sum_.val + other.sum_.val; }
   types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+  types::StringValue Serialize(udf::FunctionContext*) { return std::to_string(sum_.val); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    sum_ = std::stol(data);
+    return Status::OK();
+  }
 
  protected:
   types::Int64Value sum_ = 0;
@@ -120,6 +131,53 @@ agg_op {
   value_names: "value1"
 })";
 
+// The plan of a "sum" (which the test registers as minsum) and a minsum, over rows sampled at
+// 1 in 4.
+constexpr char kSampledSingleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  sample_rate: 0.25
+  values {
+    name: "sum"
+    id: 2
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "sum"
+  value_names: "minsum"
+})";
+
 constexpr char kBlockingMultipleGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -201,6 +259,58 @@ agg_op {
   value_names: "value1"
 })";
 
+// Each result covers the last 2 input windows.
+constexpr char kSlidingNoGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: true
+  window_panes: 2
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  value_names: "value1"
+})";
+
+constexpr char kSlidingSingleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: true
+  window_panes: 2
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+})";
+
 constexpr char kSingleGroupNoValues[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -283,17 +393,48 @@ std::unique_ptr<plan::Operator> PlanNodeFromPbtxt(const std::string& pbtxt) {
   return plan::AggregateOperator::FromProto(op_pb, 1);
 }
 
+// Runs a (partial) aggregate over the input batches, and returns its output batches.
+std::vector<RowBatch> RunAggNode(ExecState* exec_state, const plan::Operator& plan_node,
+                                 const RowDescriptor& input_rd, const RowDescriptor& output_rd,
+                                 const std::vector<RowBatch>& inputs) {
+  AggNode node;
+  MockExecNode mock_child;
+  FakePlanNode fake_plan(123);
+  EXPECT_CALL(mock_child, InitImpl(_));
+  EXPECT_CALL(mock_child, PrepareImpl(_));
+  EXPECT_CALL(mock_child, OpenImpl(_));
+  EXPECT_OK(node.Init(plan_node, output_rd, {input_rd}));
+  node.AddChild(&mock_child, 0);
+  EXPECT_OK(node.Prepare(exec_state));
+  EXPECT_OK(node.Open(exec_state));
+  EXPECT_OK(mock_child.Init(fake_plan, RowDescriptor({}), {output_rd}));
+  EXPECT_OK(mock_child.Prepare(exec_state));
+  EXPECT_OK(mock_child.Open(exec_state));
+
+  std::vector<RowBatch> outputs;
+  EXPECT_CALL(mock_child, ConsumeNextImpl(_, _, _))
+      .WillRepeatedly(::testing::DoAll(
+          ::testing::Invoke([&](ExecState*, const RowBatch& rb, size_t) { outputs.push_back(rb); }),
+          ::testing::Return(Status::OK())));
+  for (const auto& rb : inputs) {
+    EXPECT_OK(node.ConsumeNext(exec_state, rb, 0));
+  }
+  return outputs;
+}
+
 class AggNodeTest : public ::testing::Test {
  public:
   AggNodeTest() {
     func_registry_ = std::make_unique<udf::Registry>("test");
     EXPECT_TRUE(func_registry_->Register<MinSumUDA>("minsum").ok());
     EXPECT_TRUE(func_registry_->Register<MinSumWithInitUDA>("minsum_w_init").ok());
+    EXPECT_TRUE(func_registry_->Register<MinSumUDA>("sum").ok());
 
     exec_state_ = MakeTestExecState(func_registry_.get());
     EXPECT_OK(exec_state_->AddUDA(0, "minsum",
                                   std::vector<types::DataType>({types::INT64, types::INT64})));
     EXPECT_OK(exec_state_->AddUDA(1, "minsum_w_init", {types::INT64, types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddUDA(2, "sum", {types::INT64, types::INT64}));
   }
 
  protected:
@@ -383,6 +524,55 @@ TEST_F(AggNodeTest, single_group_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_blocking_with_selection) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Only the selected rows are aggregated.
+  auto input_rb = RowBatchBuilder(input_rd, 5, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Int64Value>({1, 1, 2, 2, 3})
+                      .AddColumn<types::Int64Value>({2, 3, 3, 1, 9})
+                      .get();
+  input_rb.set_selection(std::make_shared<std::vector<int64_t>>(std::vector<int64_t>{1, 2, 4}));
+
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, sampled_input_scales_sums) {
+  auto plan_node = PlanNodeFromPbtxt(kSampledSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  // Only the sum is scaled up by the sample rate.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 1, 2})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({2, 1, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({8, 12})
+                          .AddColumn<types::Int64Value>({2, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_blocking) {
   auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
@@ -530,6 +720,91 @@ TEST_F(AggNodeTest, single_group_windowed) {
       .Close();
 }
 
+TEST_F(AggNodeTest, no_groups_sliding_window) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingNoGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .AddColumn<types::Int64Value>({2, 5, 6, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({Int64Value(10)})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, false)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({Int64Value(23)})
+                          .get(),
+                      false)
+      // The first window has left the window.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, true, true)
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .AddColumn<types::Int64Value>({2, 5})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({Int64Value(16)})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, single_group_sliding_window) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .AddColumn<types::Int64Value>({2, 3})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, true, false)
+                       .AddColumn<types::Int64Value>({2, 3})
+                       .AddColumn<types::Int64Value>({1, 3})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, false)
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .AddColumn<types::Int64Value>({1, 3, 3})
+                          .get(),
+                      false)
+      // Group 1 was only in the first window, which has left the window.
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, true, true)
+                       .AddColumn<types::Int64Value>({3})
+                       .AddColumn<types::Int64Value>({5})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({2, 3})
+                          .AddColumn<types::Int64Value>({1, 6})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, no_aggregate_expressions) {
   auto plan_node = PlanNodeFromPbtxt(kSingleGroupNoValues);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
@@ -611,6 +886,163 @@ TEST_F(AggNodeTest, single_group_blocking_init_args) {
       .Close();
 }
 
+TEST_F(AggNodeTest, blocking_spills_groups_over_memory_budget) {
+  px::testing::TempDir spill_dir;
+  gflags::FlagSaver flag_saver;
+  // Only a few groups fit, the input rows of the others are spilled.
+  FLAGS_carnot_agg_memory_budget_bytes = 1000;
+  FLAGS_carnot_agg_spill_dir = spill_dir.path().string();
+
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  AggNode node;
+  MockExecNode mock_child;
+  FakePlanNode fake_plan(123);
+  EXPECT_CALL(mock_child, InitImpl(_));
+  EXPECT_CALL(mock_child, PrepareImpl(_));
+  EXPECT_CALL(mock_child, OpenImpl(_));
+  ASSERT_OK(node.Init(*plan_node, output_rd, {input_rd}));
+  node.AddChild(&mock_child, 0);
+  ASSERT_OK(node.Prepare(exec_state_.get()));
+  ASSERT_OK(node.Open(exec_state_.get()));
+  ASSERT_OK(mock_child.Init(fake_plan, RowDescriptor({}), {output_rd}));
+  ASSERT_OK(mock_child.Prepare(exec_state_.get()));
+  ASSERT_OK(mock_child.Open(exec_state_.get()));
+
+  std::vector<RowBatch> outputs;
+  EXPECT_CALL(mock_child, ConsumeNextImpl(_, _, _))
+      .WillRepeatedly(::testing::DoAll(
+          ::testing::Invoke([&](ExecState*, const RowBatch& rb, size_t) { outputs.push_back(rb); }),
+          ::testing::Return(Status::OK())));
+
+  // Every batch has each group once, with a value larger than any key, so that each group's
+  // result is its key times the number of batches.
+  constexpr int64_t kNumGroups = 100;
+  constexpr int64_t kNumBatches = 3;
+  std::vector<Int64Value> keys;
+  std::vector<Int64Value> values;
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    keys.push_back(i);
+    values.push_back(kNumGroups);
+  }
+  for (int64_t i = 0; i < kNumBatches; ++i) {
+    bool last = i == kNumBatches - 1;
+    ASSERT_OK(node.ConsumeNext(exec_state_.get(),
+                               RowBatchBuilder(input_rd, kNumGroups, last, last)
+                                   .AddColumn<types::Int64Value>(keys)
+                                   .AddColumn<types::Int64Value>(values)
+                                   .get(),
+                               0));
+  }
+
+  // The groups in memory and each spilled partition are emitted in separate batches.
+  ASSERT_GT(outputs.size(), 1U);
+  absl::flat_hash_map<int64_t, int64_t> results;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const auto& rb = outputs[i];
+    EXPECT_EQ(i == outputs.size() - 1, rb.eos());
+    for (int64_t row = 0; row < rb.num_rows(); ++row) {
+      auto key = types::GetValueFromArrowArray<types::DataType::INT64>(rb.ColumnAt(0).get(), row);
+      auto val = types::GetValueFromArrowArray<types::DataType::INT64>(rb.ColumnAt(1).get(), row);
+      EXPECT_TRUE(results.emplace(key, val).second) << "Group emitted twice: " << key;
+    }
+  }
+  ASSERT_EQ(kNumGroups, static_cast<int64_t>(results.size()));
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    EXPECT_EQ(i * kNumBatches, results[i]);
+  }
+
+  EXPECT_OK(node.Close(exec_state_.get()));
+  EXPECT_TRUE(std::filesystem::is_empty(spill_dir.path()));
+}
+
+TEST_F(AggNodeTest, partial_then_finalize_no_groups) {
+  auto partial_plan =
+      PlanNodeFromPbtxt(absl::StrCat(kBlockingNoGroupAgg, "agg_op { partial_agg: true }"));
+  auto finalize_plan =
+      PlanNodeFromPbtxt(absl::StrCat(kBlockingNoGroupAgg, "agg_op { finalize_results: true }"));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor partial_rd({types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  // Each partial aggregate sees the input of a different agent.
+  auto agent1 = RunAggNode(exec_state_.get(), *partial_plan, input_rd, partial_rd,
+                           {RowBatchBuilder(input_rd, 4, true, true)
+                                .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                                .AddColumn<types::Int64Value>({2, 5, 6, 8})
+                                .get()});
+  auto agent2 = RunAggNode(exec_state_.get(), *partial_plan, input_rd, partial_rd,
+                           {RowBatchBuilder(input_rd, 4, true, true)
+                                .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                                .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                                .get()});
+  ASSERT_EQ(1U, agent1.size());
+  ASSERT_EQ(1U, agent2.size());
+  EXPECT_EQ(1, agent1[0].num_rows());
+  agent1[0].set_eow(false);
+  agent1[0].set_eos(false);
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *finalize_plan, output_rd, {partial_rd}, exec_state_.get());
+  tester.ConsumeNext(agent1[0], 0, 0)
+      .ConsumeNext(agent2[0], 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({Int64Value(23)})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, partial_then_finalize_single_group) {
+  auto partial_plan =
+      PlanNodeFromPbtxt(absl::StrCat(kBlockingSingleGroupAgg, "agg_op { partial_agg: true }"));
+  auto finalize_plan = PlanNodeFromPbtxt(
+      absl::StrCat(kBlockingSingleGroupAgg, "agg_op { finalize_results: true }"));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor partial_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // Groups 2 and 3 are on both agents.
+  auto agent1 = RunAggNode(exec_state_.get(), *partial_plan, input_rd, partial_rd,
+                           {RowBatchBuilder(input_rd, 4, true, true)
+                                .AddColumn<types::Int64Value>({1, 1, 2, 3})
+                                .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                                .get()});
+  auto agent2 = RunAggNode(exec_state_.get(), *partial_plan, input_rd, partial_rd,
+                           {RowBatchBuilder(input_rd, 3, true, true)
+                                .AddColumn<types::Int64Value>({2, 3, 4})
+                                .AddColumn<types::Int64Value>({5, 6, 8})
+                                .get()});
+  ASSERT_EQ(1U, agent1.size());
+  ASSERT_EQ(1U, agent2.size());
+  EXPECT_EQ(3, agent1[0].num_rows());
+  agent1[0].set_eow(false);
+  agent1[0].set_eos(false);
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *finalize_plan, output_rd, {partial_rd}, exec_state_.get());
+  tester.ConsumeNext(agent1[0], 0, 0)
+      .ConsumeNext(agent2[0], 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                          .AddColumn<types::Int64Value>({2, 4, 4, 4})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, partial_rejects_windowed) {
+  auto plan_node =
+      PlanNodeFromPbtxt(absl::StrCat(kWindowedNoGroupAgg, "agg_op { partial_agg: true }"));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::STRING});
+
+  AggNode node;
+  EXPECT_NOT_OK(node.Init(*plan_node, output_rd, {input_rd}));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
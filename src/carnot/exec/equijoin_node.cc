@@ -42,6 +42,10 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+namespace {
+size_t JoinPartitionOf(uint64_t hash) { return hash >> (64 - kJoinPartitionBits); }
+}  // namespace
+
 std::string EquijoinNode::DebugStringImpl() {
   return absl::Substitute("Exec::JoinNode<$0>", absl::StrJoin(plan_node_->column_names(), ","));
 }
@@ -92,7 +96,11 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     int64_t right_index = eq_condition.right_column_index();
 
     CHECK_EQ(input_descriptors_[0].type(left_index), input_descriptors_[1].type(right_index));
-    key_data_types_.emplace_back(input_descriptors_[0].type(left_index));
+    auto dt = input_descriptors_[0].type(left_index);
+    key_data_types_.emplace_back(dt);
+#define TYPE_CASE(_dt_) key_value_eq_fns_.emplace_back(&ColumnValueEq<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
 
     build_spec_.key_indices.emplace_back(
         probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? right_index : left_index);
@@ -111,10 +119,22 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     selected_spec.input_col_types.emplace_back(dt);
     selected_spec.output_col_indices.emplace_back(i);
   }
+  build_partitions_.resize(kNumJoinPartitions);
 
   return Status::OK();
 }
 
+std::shared_ptr<JoinKeyFilter> EquijoinNode::CreateProbeKeyFilter() {
+  DCHECK(plan_node_ != nullptr);
+  if (probe_spec_.emit_unmatched_rows) {
+    return nullptr;
+  }
+  if (probe_key_filter_ == nullptr) {
+    probe_key_filter_ = std::make_shared<JoinKeyFilter>(probe_spec_.key_indices, key_data_types_);
+  }
+  return probe_key_filter_;
+}
+
 Status EquijoinNode::InitializeColumnBuilders() {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     column_builders_[i] =
@@ -134,63 +154,50 @@ Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
 Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
 
 Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
-  join_keys_chunk_.clear();
-  build_buffer_.clear();
-  probed_keys_.clear();
+  for (auto& partition : build_partitions_) {
+    partition.clear();
+  }
+  probe_groups_.clear();
   key_values_pool_.Clear();
+  column_values_pool_.Clear();
+  build_value_bytes_ = 0;
   return Status::OK();
 }
 
-template <types::DataType DT>
-void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
-                          int rt_col_idx) {
-  auto num_rows = input_col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*row_tuples)[row_idx], input_col, rt_col_idx, row_idx);
+int64_t EquijoinNode::ExternalMemoryBytes() const {
+  int64_t bytes = key_values_pool_.bytes_allocated() + column_values_pool_.bytes_allocated() +
+                  build_value_bytes_;
+  for (const auto& partition : build_partitions_) {
+    bytes += partition.memory_bytes();
   }
+  return bytes;
 }
 
-Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb,
-                                             bool is_probe) {
-  // Reset the row tuples
-  for (auto& rt : join_keys_chunk_) {
-    if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
-    } else {
-      rt->Reset();
-    }
+std::vector<arrow::Array*> EquijoinNode::KeyColumns(const RowBatch& rb,
+                                                     const TableSpec& spec) const {
+  std::vector<arrow::Array*> key_cols;
+  key_cols.reserve(spec.key_indices.size());
+  for (auto input_col_idx : spec.key_indices) {
+    key_cols.push_back(rb.ColumnAt(input_col_idx).get());
   }
+  return key_cols;
+}
 
-  // Grow the join_keys_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (join_keys_chunk_.size() < num_rows) {
-    int prev_size = join_keys_chunk_.size();
-    join_keys_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
-      join_keys_chunk_.emplace_back(tuple_ptr);
-    }
-  }
-
-  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
-    auto input_col_idx = spec.key_indices[tuple_col_idx];
-    auto dt = key_data_types_[tuple_col_idx];
-    auto col = rb.ColumnAt(input_col_idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
-    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+RowTuple* EquijoinNode::ExtractKeyRowTuple(const std::vector<arrow::Array*>& key_cols,
+                                           int64_t row_idx) {
+  auto* rt = key_values_pool_.New<RowTuple>(&key_data_types_);
+  for (size_t tuple_col_idx = 0; tuple_col_idx < key_cols.size(); ++tuple_col_idx) {
+#define TYPE_CASE(_dt_) \
+  ExtractIntoRowTuple<_dt_>(rt, key_cols[tuple_col_idx], tuple_col_idx, row_idx);
+    PL_SWITCH_FOREACH_DATATYPE(key_data_types_[tuple_col_idx], TYPE_CASE);
 #undef TYPE_CASE
   }
-
-  return Status::OK();
+  return rt;
 }
 
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
+std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectArena* pool,
                                                        const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
+  auto ptr = pool->New<std::vector<types::SharedColumnWrapper>>(types.size());
   for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
     (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
   }
@@ -198,21 +205,27 @@ std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
 }
 
 Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
-  }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
-  }
+  JoinKeyFilter::HashKeys(rb, build_spec_.key_indices, key_data_types_, &key_hashes_);
+  auto key_cols = KeyColumns(rb, build_spec_);
 
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
+    auto hash = key_hashes_[row_idx];
+    auto& partition = build_partitions_[JoinPartitionOf(hash)];
+    auto key_eq = [&](const RowTuple* rt) {
+      for (size_t i = 0; i < key_cols.size(); ++i) {
+        if (!key_value_eq_fns_[i](key_cols[i], row_idx, *rt, i)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    BuildKeyGroup** found = partition.Find(hash, key_eq);
+    BuildKeyGroup* group = found != nullptr ? *found : nullptr;
+    if (group == nullptr) {
+      group = column_values_pool_.New<BuildKeyGroup>();
+      group->wrappers = CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
+      partition.Insert(hash, ExtractKeyRowTuple(key_cols, row_idx), group);
+    }
 
     // Now extract the values into the corresponding column wrappers.
     for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
@@ -221,23 +234,34 @@ Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
       const auto& dt = build_spec_.input_col_types[i];
 
 #define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
+  types::ExtractValueToColumnWrapper<_dt_>(group->wrappers->at(i).get(), arr, row_idx);
       PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
     }
     // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
+    group->num_rows++;
+  }
 
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
+  for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
+    auto arr = rb.ColumnAt(build_spec_.input_col_indices[i]).get();
+#define TYPE_CASE(_dt_) build_value_bytes_ += types::GetArrowArrayBytes<_dt_>(arr);
+    PL_SWITCH_FOREACH_DATATYPE(build_spec_.input_col_types[i], TYPE_CASE);
+#undef TYPE_CASE
   }
 
   return Status::OK();
 }
 
+Status EquijoinNode::PublishProbeKeyFilter() {
+  std::vector<uint64_t> key_hashes;
+  for (const auto& partition : build_partitions_) {
+    for (const auto& entry : partition) {
+      key_hashes.push_back(entry.hash);
+    }
+  }
+  return probe_key_filter_->Publish(key_hashes);
+}
+
 template <types::DataType DT>
 Status AppendValuesFromWrapper(arrow::ArrayBuilder* output_builder,
                                types::SharedColumnWrapper input_wrapper, size_t start_idx,
@@ -351,19 +375,45 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
+  JoinKeyFilter::HashKeys(rb, probe_spec_.key_indices, key_data_types_, &key_hashes_);
+  auto key_cols = KeyColumns(rb, probe_spec_);
 
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
+  // Group the rows by partition (a counting sort, so rows keep their order within a partition).
+  partition_offsets_.assign(kNumJoinPartitions + 1, 0);
+  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    ++partition_offsets_[JoinPartitionOf(key_hashes_[row_idx]) + 1];
   }
-
+  for (size_t p = 0; p < kNumJoinPartitions; ++p) {
+    partition_offsets_[p + 1] += partition_offsets_[p];
+  }
+  partitioned_rows_.resize(rb.num_rows());
+  std::vector<int64_t> next_row(partition_offsets_.begin(), partition_offsets_.end() - 1);
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
+    partitioned_rows_[next_row[JoinPartitionOf(key_hashes_[row_idx])]++] = row_idx;
+  }
+
+  // Probe a partition at a time.
+  probe_groups_.assign(rb.num_rows(), nullptr);
+  for (size_t p = 0; p < kNumJoinPartitions; ++p) {
+    auto& partition = build_partitions_[p];
+    if (partition.empty()) {
+      continue;
+    }
+    for (auto i = partition_offsets_[p]; i < partition_offsets_[p + 1]; ++i) {
+      auto row_idx = partitioned_rows_[i];
+      auto key_eq = [&](const RowTuple* rt) {
+        for (size_t k = 0; k < key_cols.size(); ++k) {
+          if (!key_value_eq_fns_[k](key_cols[k], row_idx, *rt, k)) {
+            return false;
+          }
+        }
+        return true;
+      };
+      BuildKeyGroup** found = partition.Find(key_hashes_[row_idx], key_eq);
+      if (found != nullptr) {
+        (*found)->probed = true;
+        probe_groups_[row_idx] = *found;
+      }
     }
   }
 
@@ -374,7 +424,8 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       PL_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
     }
 
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
+    auto* group = probe_groups_[row_idx];
+    if (group == nullptr) {
       if (probe_spec_.emit_unmatched_rows) {
         OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
         chunks_.emplace_back(c);
@@ -383,9 +434,8 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       continue;
     }
 
-    PL_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    PL_RETURN_IF_ERROR(
+        MatchBuildValuesAndFlush(exec_state, group->wrappers, rb_ptr, row_idx, group->num_rows));
   }
 
   if (probe_eos_ && queued_rows_ > 0) {
@@ -396,12 +446,15 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
 }
 
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
-      continue;
+  for (const auto& partition : build_partitions_) {
+    for (const auto& entry : partition) {
+      auto* group = entry.value;
+      if (group->probed) {
+        continue;
+      }
+      PL_RETURN_IF_ERROR(
+          MatchBuildValuesAndFlush(exec_state, group->wrappers, nullptr, 0, group->num_rows));
     }
-    PL_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
   }
 
   if (queued_rows_ > 0) {
@@ -416,10 +469,12 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
   PL_RETURN_IF_ERROR(HashRowBatch(rb));
 
   if (build_eos_) {
+    if (probe_key_filter_ != nullptr) {
+      PL_RETURN_IF_ERROR(PublishProbeKeyFilter());
+    }
     while (probe_batches_.size()) {
       PL_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
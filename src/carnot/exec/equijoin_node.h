@@ -30,6 +30,8 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/group_hash_table.h"
+#include "src/carnot/exec/join_key_filter.h"
 #include "src/carnot/exec/row_tuple.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
@@ -44,6 +46,9 @@ namespace carnot {
 namespace exec {
 
 constexpr size_t kDefaultJoinRowBatchSize = 1024;
+// The build side is radix partitioned by the top bits of the key hashes.
+constexpr int kJoinPartitionBits = 4;
+constexpr size_t kNumJoinPartitions = 1 << kJoinPartitionBits;
 
 class EquijoinNode : public ProcessingNode {
   enum class JoinInputTable { kLeftTable, kRightTable };
@@ -60,10 +65,37 @@ class EquijoinNode : public ProcessingNode {
     std::vector<int64_t> output_col_indices;
   };
 
+  // The build rows with the same keys.
+  struct BuildKeyGroup {
+    std::vector<types::SharedColumnWrapper>* wrappers;
+    // The number of rows is kept in addition to the wrappers, in the event that no columns from
+    // the build side are emitted.
+    int64_t num_rows = 0;
+    // For joins that emit the unmatched build rows at the end of the join.
+    bool probed = false;
+  };
+  using BuildHashTable = GroupHashTable<RowTuple*, BuildKeyGroup*>;
+
  public:
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  /**
+   * CreateProbeKeyFilter creates the filter of probe side rows that the join publishes once it has
+   * consumed its build side, so that the probe side can drop non-matching rows early.
+   * Must be called after Init() and before any batch is consumed.
+   * @return the filter, or nullptr if unmatched probe rows are part of the output.
+   */
+  std::shared_ptr<JoinKeyFilter> CreateProbeKeyFilter();
+
+  // The parent index of the probe side.
+  size_t probe_parent_index() const {
+    return probe_table_ == JoinInputTable::kLeftTable ? 0 : 1;
+  }
+
+  // The build side's hash tables, keys and copied values.
+  int64_t ExternalMemoryBytes() const override;
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -77,8 +109,11 @@ class EquijoinNode : public ProcessingNode {
   Status InitializeColumnBuilders();
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
-  Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
+  std::vector<arrow::Array*> KeyColumns(const table_store::schema::RowBatch& rb,
+                                        const TableSpec& spec) const;
+  RowTuple* ExtractKeyRowTuple(const std::vector<arrow::Array*>& key_cols, int64_t row_idx);
   Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  Status PublishProbeKeyFilter();
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status MatchBuildValuesAndFlush(ExecState* exec_state,
@@ -103,6 +138,8 @@ class EquijoinNode : public ProcessingNode {
   TableSpec probe_spec_;
 
   std::vector<types::DataType> key_data_types_;
+  // The comparison function of each key column.
+  std::vector<ColumnValueEqFn> key_value_eq_fns_;
 
   // Example of the above specs:
   // For input table A (build) which has [key_A_1, output_col_0, key_A_0/output_col_2]
@@ -130,26 +167,24 @@ class EquijoinNode : public ProcessingNode {
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
   // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
-
-  // Chunk of data to use when extracting join keys.
-  std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
-
-  // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+  ObjectArena key_values_pool_{"equijoin_kv_pool"};
+  // Manages the BuildKeyGroups and their column wrappers.
+  ObjectArena column_values_pool_{"equijoin_col_vals_pool"};
+
+  // The build side, by partition. The rows of each probe batch are grouped by partition and
+  // probed a partition at a time, so that the table being probed stays in cache.
+  std::vector<BuildHashTable> build_partitions_;
+  // The bytes of the build values copied into the column wrappers of the build key groups.
+  int64_t build_value_bytes_ = 0;
+  // The key hashes of the batch being built or probed, computed a column at a time.
+  std::vector<uint64_t> key_hashes_;
+  // The rows of the probe batch, grouped by partition, and where each partition's rows start.
+  std::vector<int64_t> partitioned_rows_;
+  std::vector<int64_t> partition_offsets_;
+  // The build rows matching each row of the probe batch, or nullptr.
+  std::vector<BuildKeyGroup*> probe_groups_;
+
+  std::shared_ptr<JoinKeyFilter> probe_key_filter_;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
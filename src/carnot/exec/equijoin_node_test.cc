@@ -686,6 +686,92 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, probe_key_filter) {
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:Int64]
+  // Output table: [left_1:Int, right_0:Int64]
+  // Inner join on left_0=right_1
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  // The right table is the probe side.
+  EXPECT_EQ(1U, tester.node()->probe_parent_index());
+  auto filter = tester.node()->CreateProbeKeyFilter();
+  ASSERT_NE(nullptr, filter);
+  EXPECT_FALSE(filter->ready());
+
+  tester.ConsumeNext(RowBatchBuilder(input_rd_0, 3, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>({1, 2, 2})
+                         .AddColumn<types::Int64Value>({10, 20, 21})
+                         .get(),
+                     0, 0);
+  EXPECT_TRUE(filter->ready());
+
+  auto probe_rb = RowBatchBuilder(input_rd_1, 4, true, true)
+                      .AddColumn<types::Int64Value>({100, 300, 200, 400})
+                      .AddColumn<types::Int64Value>({1, 3, 2, 4})
+                      .get();
+  auto filtered_or_s = filter->Filter(probe_rb, arrow::default_memory_pool());
+  ASSERT_OK(filtered_or_s);
+  auto filtered = filtered_or_s.ConsumeValueOrDie();
+  EXPECT_EQ(2, filtered->num_rows());
+  EXPECT_EQ(2, filter->num_rows_dropped());
+
+  tester.ConsumeNext(*filtered, 1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({10, 20, 21})
+                          .AddColumn<types::Int64Value>({100, 200, 200})
+                          .get(),
+                      true)
+      .Close();
+}
+
+TEST_F(JoinNodeTest, no_probe_key_filter_for_outer_join) {
+  const char* proto = R"(
+  type: FULL_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 0
+  }
+  column_names: "left_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, input_rd, {input_rd, input_rd}, exec_state_.get());
+  EXPECT_EQ(nullptr, tester.node()->CreateProbeKeyFilter());
+  tester.Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
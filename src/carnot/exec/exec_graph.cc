@@ -19,9 +19,16 @@
 #include "src/carnot/exec/exec_graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
 
 #include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/empty_source_node.h"
@@ -31,22 +38,38 @@
 #include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/exec/grpc_sink_node.h"
 #include "src/carnot/exec/grpc_source_node.h"
+#include "src/carnot/exec/interval_join_node.h"
 #include "src/carnot/exec/limit_node.h"
 #include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/sort_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/plan_state.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_pipeline_threads, gflags::Int32FromEnv("PL_CARNOT_PIPELINE_THREADS", 1),
+             "The number of threads to run each memory source of a query, and the maps, filters "
+             "and blocking aggregate after it, on. Run on the query's thread if 1.");
+DEFINE_int32(carnot_subgraph_threads, gflags::Int32FromEnv("PL_CARNOT_SUBGRAPH_THREADS", 1),
+             "The most threads to run the independent subgraphs of a plan fragment on, such as "
+             "the separate branches that produce each output table. Run on the query's thread if "
+             "1.");
+DEFINE_int32(carnot_tablet_scan_threads,
+             gflags::Int32FromEnv("PL_CARNOT_TABLET_SCAN_THREADS", 1),
+             "The number of threads to read the tablets of a tabletized table on, ahead of the "
+             "rest of the query. Read on the query's thread as the query runs if 1.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState* plan_state,
@@ -59,10 +82,14 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
   exec_state_ = exec_state;
   collect_exec_node_stats_ = collect_exec_node_stats;
   consecutive_generate_calls_per_source_ = consecutive_generate_calls_per_source;
+  pipeline_threads_ = FLAGS_carnot_pipeline_threads;
+  subgraph_threads_ = FLAGS_carnot_subgraph_threads;
+  tablet_scan_threads_ = FLAGS_carnot_tablet_scan_threads;
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  absl::flat_hash_set<int64_t> memory_sources;
+  PL_RETURN_IF_ERROR(plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -73,7 +100,28 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
-        return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
+        memory_sources.insert(node.id());
+        source_tables_.emplace_back(node.TableName(), node.Tablet());
+        // The results of a source with a cursor depend on the previous queries.
+        if (node.infinite_stream() || !node.cursor_name().empty()) {
+          cacheable_ = false;
+        }
+        if (!node.cursor_name().empty()) {
+          cursor_sources_.push_back(node.id());
+        }
+        if (!node.Tablet().empty() && !node.infinite_stream()) {
+          tablet_sources_.push_back(node.id());
+        }
+        PL_RETURN_IF_ERROR(
+            OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors));
+        // Streaming sources wake up the graph as soon as their table is written to, rather than
+        // waiting for the yield to time out.
+        if (node.infinite_stream()) {
+          streaming_sources_.push_back(node.id());
+          static_cast<MemorySourceNode*>(nodes_[node.id()])
+              ->SetTableWriteCallback(std::bind(&ExecutionGraph::Continue, this));
+        }
+        return Status::OK();
       })
       .OnFilter([&](auto& node) {
         return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
@@ -81,16 +129,34 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnSort([&](auto& node) {
+        return OnOperatorImpl<plan::SortOperator, SortNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
       .OnJoin([&](auto& node) {
-        return OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors);
+        if (node.has_time_condition()) {
+          return OnOperatorImpl<plan::JoinOperator, IntervalJoinNode>(node, &descriptors);
+        }
+        PL_RETURN_IF_ERROR(OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors));
+        // A memory source that only feeds the probe side can drop the rows without a match.
+        auto join = static_cast<EquijoinNode*>(nodes_[node.id()]);
+        auto parents = pf_->dag().ParentsOf(node.id());
+        auto probe = parents[join->probe_parent_index()];
+        if (memory_sources.contains(probe) && pf_->dag().DependenciesOf(probe).size() == 1) {
+          auto filter = join->CreateProbeKeyFilter();
+          if (filter != nullptr) {
+            static_cast<MemorySourceNode*>(nodes_[probe])->SetJoinKeyFilter(std::move(filter));
+          }
+        }
+        return Status::OK();
       })
       .OnGRPCSource([&](auto& node) {
         auto s = OnOperatorImpl<plan::GRPCSourceOperator, GRPCSourceNode>(node, &descriptors);
         PL_RETURN_IF_ERROR(s);
         grpc_sources_.insert(node.id());
+        cacheable_ = false;
         return exec_state->grpc_router()->AddGRPCSourceNode(
             exec_state->query_id(), node.id(), static_cast<GRPCSourceNode*>(nodes_[node.id()]),
             std::bind(&ExecutionGraph::Continue, this));
@@ -100,33 +166,224 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::GRPCSinkOperator, GRPCSinkNode>(node, &descriptors);
       })
       .OnUDTFSource([&](auto& node) {
+        cacheable_ = false;
         return OnOperatorImpl<plan::UDTFSourceOperator, UDTFSourceNode>(node, &descriptors);
       })
       .OnEmptySource([&](auto& node) {
         return OnOperatorImpl<plan::EmptySourceOperator, EmptySourceNode>(node, &descriptors);
       })
       .OnOTelSink([&](auto& node) {
+        cacheable_ = false;
         return OnOperatorImpl<plan::OTelExportSinkOperator, OTelExportSinkNode>(node, &descriptors);
       })
-      .Walk(pf_);
+      .Walk(pf_));
+  SetGRPCSinkAbortableSources();
+  PlanSubgraphs();
+  return PlanParallelPipelines(descriptors);
 }
 
-bool ExecutionGraph::YieldWithTimeout() {
-  std::unique_lock<std::mutex> lock(execution_mutex_);
-  if (continue_) {
-    continue_ = false;
-    return false;
+void ExecutionGraph::PlanSubgraphs() {
+  if (subgraph_threads_ <= 1) {
+    return;
+  }
+  // Union-find over the edges of the fragment, so that each subgraph is a connected component.
+  absl::flat_hash_map<int64_t, int64_t> roots;
+  for (const auto& [id, node] : nodes_) {
+    roots[id] = id;
+  }
+  auto find = [&roots](int64_t id) {
+    while (roots[id] != id) {
+      roots[id] = roots[roots[id]];
+      id = roots[id];
+    }
+    return id;
+  };
+  for (const auto& [id, node] : nodes_) {
+    for (int64_t child : pf_->dag().DependenciesOf(id)) {
+      roots[find(child)] = find(id);
+    }
+  }
+
+  absl::flat_hash_map<int64_t, size_t> root_to_subgraph;
+  std::vector<Subgraph> subgraphs;
+  auto subgraph = [&](int64_t id) -> Subgraph& {
+    auto [it, inserted] = root_to_subgraph.try_emplace(find(id), subgraphs.size());
+    if (inserted) {
+      subgraphs.emplace_back();
+    }
+    return subgraphs[it->second];
+  };
+  for (int64_t id : sources_) {
+    subgraph(id).sources.push_back(id);
+  }
+  for (int64_t id : grpc_sinks_) {
+    subgraph(id).grpc_sinks.push_back(id);
+  }
+  if (subgraphs.size() > 1) {
+    subgraphs_ = std::move(subgraphs);
+  }
+}
+
+void ExecutionGraph::SetGRPCSinkAbortableSources() {
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> sink_to_abortable_srcs;
+  for (int64_t src_id : sources_) {
+    // A source can only stop once all of the sinks it feeds need no more results.
+    std::vector<int64_t> sinks;
+    for (int64_t id : pf_->dag().TransitiveDepsFrom(src_id)) {
+      if (nodes_.at(id)->IsSink()) {
+        sinks.push_back(id);
+      }
+    }
+    if (sinks.size() == 1 && grpc_sinks_.contains(sinks[0])) {
+      sink_to_abortable_srcs[sinks[0]].push_back(src_id);
+    }
+  }
+  for (auto& [sink_id, srcs] : sink_to_abortable_srcs) {
+    static_cast<GRPCSinkNode*>(nodes_.at(sink_id))->set_abortable_srcs(std::move(srcs));
+  }
+}
+
+Status ExecutionGraph::PlanParallelPipelines(const RowDescriptorMap& descriptors) {
+  if (pipeline_threads_ <= 1) {
+    return Status::OK();
+  }
+  auto& dag = pf_->dag();
+  for (int64_t source_id : sources_) {
+    const auto& source_op = *pf_->nodes()[source_id];
+    if (source_op.op_type() != planpb::MEMORY_SOURCE_OPERATOR ||
+        static_cast<const plan::MemorySourceOperator&>(source_op).infinite_stream()) {
+      continue;
+    }
+    // Follow the single path of maps and filters from the source to a blocking aggregate.
+    std::vector<int64_t> path;
+    bool ends_at_agg = false;
+    for (int64_t id = source_id;;) {
+      auto children = dag.DependenciesOf(id);
+      if (children.size() != 1 || dag.ParentsOf(children[0]).size() != 1) {
+        break;
+      }
+      id = children[0];
+      const auto& op = *pf_->nodes()[id];
+      if (op.op_type() == planpb::AGGREGATE_OPERATOR) {
+        path.push_back(id);
+        ends_at_agg = !static_cast<const plan::AggregateOperator&>(op).windowed();
+        break;
+      }
+      if (op.op_type() != planpb::MAP_OPERATOR && op.op_type() != planpb::FILTER_OPERATOR) {
+        break;
+      }
+      path.push_back(id);
+    }
+    if (!ends_at_agg) {
+      continue;
+    }
+
+    ParallelPipeline pipeline;
+    pipeline.source_id = source_id;
+    pipeline.source = static_cast<MemorySourceNode*>(nodes_[source_id]);
+    pipeline.heads.push_back(nodes_[path.front()]);
+    pipeline.aggs.push_back(static_cast<AggNode*>(nodes_[path.back()]));
+    for (int32_t i = 1; i < pipeline_threads_; ++i) {
+      ExecNode* parent = nullptr;
+      for (int64_t id : path) {
+        PL_ASSIGN_OR_RETURN(ExecNode * node, CreateNodeCopy(id, descriptors));
+        pipeline_node_copies_.push_back(node);
+        if (parent == nullptr) {
+          pipeline.heads.push_back(node);
+        } else {
+          parent->AddChild(node, 0);
+        }
+        parent = node;
+      }
+      pipeline.aggs.push_back(static_cast<AggNode*>(parent));
+    }
+    parallel_pipelines_.push_back(std::move(pipeline));
+  }
+  return Status::OK();
+}
+
+StatusOr<ExecNode*> ExecutionGraph::CreateNodeCopy(int64_t id,
+                                                   const RowDescriptorMap& descriptors) {
+  const auto& op = *pf_->nodes()[id];
+  ExecNode* node = nullptr;
+  switch (op.op_type()) {
+    case planpb::MAP_OPERATOR:
+      node = pool_.Add(new MapNode());
+      break;
+    case planpb::FILTER_OPERATOR:
+      node = pool_.Add(new FilterNode());
+      break;
+    case planpb::AGGREGATE_OPERATOR:
+      node = pool_.Add(new AggNode());
+      break;
+    default:
+      return error::Internal("Operator $0 can't be run in a parallel pipeline.", id);
+  }
+  std::vector<RowDescriptor> input_descriptors;
+  for (int64_t parent_id : pf_->dag().ParentsOf(id)) {
+    input_descriptors.push_back(descriptors.at(parent_id));
+  }
+  PL_RETURN_IF_ERROR(
+      node->Init(op, descriptors.at(id), input_descriptors, collect_exec_node_stats_));
+  return node;
+}
+
+Status ExecutionGraph::ExecuteParallelPipeline(const ParallelPipeline& pipeline) {
+  exec_state_->SetCurrentSource(pipeline.source_id);
+  std::atomic<bool> failed{false};
+  std::vector<Status> statuses(pipeline.heads.size());
+  std::vector<std::thread> threads;
+  threads.reserve(pipeline.heads.size());
+  for (size_t i = 0; i < pipeline.heads.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      auto run = [&]() -> Status {
+        while (!failed) {
+          PL_ASSIGN_OR_RETURN(auto rb, pipeline.source->NextMorsel(exec_state_));
+          if (rb == nullptr) {
+            break;
+          }
+          PL_RETURN_IF_ERROR(pipeline.heads[i]->ConsumeNext(exec_state_, *rb, 0));
+        }
+        return Status::OK();
+      };
+      statuses[i] = run();
+      if (!statuses[i].ok()) {
+        failed = true;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& s : statuses) {
+    PL_RETURN_IF_ERROR(s);
+  }
+
+  for (size_t i = 1; i < pipeline.aggs.size(); ++i) {
+    PL_RETURN_IF_ERROR(pipeline.aggs[0]->MergeFrom(exec_state_, pipeline.aggs[i]));
   }
-  auto timed_out = !(execution_cv_.wait_for(lock, yield_timeout_ms_, [this] { return continue_; }));
+  // The end of stream goes through the graph's own operators, so the merged aggregate emits.
+  return pipeline.source->SendEndOfStream(exec_state_);
+}
+
+bool ExecutionGraph::YieldWithTimeout() { return YieldWithTimeout(&continues_seen_); }
+
+bool ExecutionGraph::YieldWithTimeout(uint64_t* continues_seen) {
+  std::unique_lock<std::mutex> lock(execution_mutex_);
+  auto timed_out = !(execution_cv_.wait_for(lock, yield_timeout_ms_, [&] {
+    return continues_ != *continues_seen;
+  }));
+  *continues_seen = continues_;
   return timed_out;
 }
 
 void ExecutionGraph::Continue() {
   {
     std::lock_guard<std::mutex> lock(execution_mutex_);
-    continue_ = true;
+    ++continues_;
   }
-  execution_cv_.notify_one();
+  // Each thread running a subgraph may be waiting for this.
+  execution_cv_.notify_all();
 }
 
 Status ExecutionGraph::CheckUpstreamGRPCConnectionHealth(GRPCSourceNode* source_node) {
@@ -163,7 +420,13 @@ Status ExecutionGraph::CheckUpstreamGRPCConnectionHealth(GRPCSourceNode* source_
 }
 
 Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
-  for (const auto& grpc_sink_id : grpc_sinks_) {
+  return CheckDownstreamGRPCConnectionsHealth(
+      std::vector<int64_t>(grpc_sinks_.begin(), grpc_sinks_.end()));
+}
+
+Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth(
+    const std::vector<int64_t>& grpc_sinks) {
+  for (const auto& grpc_sink_id : grpc_sinks) {
     auto node = nodes_.find(grpc_sink_id);
     if (node == nodes_.end()) {
       return error::NotFound("Could not find GRPCSinkNode $0.", grpc_sink_id);
@@ -174,22 +437,101 @@ Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
   return Status::OK();
 }
 
+Status ExecutionGraph::PrefetchTabletSources() {
+  if (tablet_scan_threads_ <= 1 || tablet_sources_.size() <= 1) {
+    return Status::OK();
+  }
+  // The sources of parallel pipelines are already read on several threads.
+  absl::flat_hash_set<int64_t> pipeline_sources;
+  for (const auto& pipeline : parallel_pipelines_) {
+    pipeline_sources.insert(pipeline.source_id);
+  }
+  std::vector<MemorySourceNode*> sources;
+  for (int64_t id : tablet_sources_) {
+    if (!pipeline_sources.contains(id)) {
+      sources.push_back(static_cast<MemorySourceNode*>(nodes_.at(id)));
+    }
+  }
+  if (sources.size() <= 1) {
+    return Status::OK();
+  }
+
+  // ParallelFor() also runs the scans on the query's thread.
+  ThreadPool scan_pool(std::min<size_t>(tablet_scan_threads_, sources.size()) - 1);
+  std::vector<Status> statuses(sources.size());
+  ParallelFor(&scan_pool, sources.size(),
+              [&](size_t i) { statuses[i] = sources[i]->PrefetchBatches(exec_state_); });
+  for (const auto& s : statuses) {
+    PL_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
 Status ExecutionGraph::ExecuteSources() {
-  absl::flat_hash_set<SourceNode*> running_sources;
+  for (const auto& pipeline : parallel_pipelines_) {
+    PL_RETURN_IF_ERROR(ExecuteParallelPipeline(pipeline));
+  }
+  PL_RETURN_IF_ERROR(PrefetchTabletSources());
+
+  if (subgraphs_.size() <= 1) {
+    std::vector<int64_t> grpc_sinks(grpc_sinks_.begin(), grpc_sinks_.end());
+    return ExecuteSubgraph({sources_, std::move(grpc_sinks)});
+  }
 
+  // Each thread runs every n-th subgraph, and alternates between their sources as usual.
+  size_t num_threads = std::min<size_t>(subgraph_threads_, subgraphs_.size());
+  std::vector<Subgraph> thread_subgraphs(num_threads);
+  for (size_t i = 0; i < subgraphs_.size(); ++i) {
+    auto& merged = thread_subgraphs[i % num_threads];
+    merged.sources.insert(merged.sources.end(), subgraphs_[i].sources.begin(),
+                          subgraphs_[i].sources.end());
+    merged.grpc_sinks.insert(merged.grpc_sinks.end(), subgraphs_[i].grpc_sinks.begin(),
+                             subgraphs_[i].grpc_sinks.end());
+  }
+
+  stop_subgraphs_ = false;
+  std::vector<Status> statuses(num_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = ExecuteSubgraph(thread_subgraphs[i]);
+      if (!statuses[i].ok()) {
+        // Wake up the other threads, so that they stop too.
+        stop_subgraphs_ = true;
+        Continue();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& s : statuses) {
+    PL_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+Status ExecutionGraph::ExecuteSubgraph(const Subgraph& subgraph) {
+  absl::flat_hash_set<SourceNode*> running_sources;
   absl::flat_hash_map<SourceNode*, int64_t> source_to_id;
-  for (auto node_id : sources_) {
+  for (auto node_id : subgraph.sources) {
     auto node = nodes_.find(node_id);
     if (node == nodes_.end()) {
       return error::NotFound("Could not find SourceNode $0.", node_id);
     }
     SourceNode* n = static_cast<SourceNode*>(node->second);
+    // Sources of parallel pipelines have already finished.
+    if (!n->HasBatchesRemaining()) {
+      continue;
+    }
     running_sources.insert(n);
     source_to_id[n] = node_id;
   }
 
+  uint64_t continues_seen = 0;
   // Run all sources to completion, or exit if the query encounters an error.
-  while (running_sources.size()) {
+  while (running_sources.size() && !stop_subgraphs_) {
     absl::flat_hash_set<SourceNode*> completed_sources_execute_loop;
 
     for (SourceNode* source : running_sources) {
@@ -217,12 +559,17 @@ Status ExecutionGraph::ExecuteSources() {
 
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
+      if (!exec_state_->keep_running() && grpc_sources_.contains(source_to_id[source])) {
+        // Let the upstream agents know, so that they stop producing results for this source.
+        exec_state_->grpc_router()->MarkSourceHasSufficientResults(exec_state_->query_id(),
+                                                                   source_to_id[source]);
+      }
       if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
         completed_sources_execute_loop.insert(source);
         break;
       }
     }
-    PL_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
+    PL_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth(subgraph.grpc_sinks));
 
     // Flush all of the completed sources.
     for (SourceNode* source : completed_sources_execute_loop) {
@@ -244,17 +591,20 @@ Status ExecutionGraph::ExecuteSources() {
       }
     }
 
-    while (wait_for_more_data) {
+    while (wait_for_more_data && !stop_subgraphs_) {
       auto timer = ElapsedTimer();
       timer.Start();
-      YieldWithTimeout();
+      YieldWithTimeout(&continues_seen);
       timer.Stop();
+      // None of the running sources had a batch ready, so they all waited.
+      for (SourceNode* source : running_sources) {
+        source->stats()->AddWaitTime(timer.ElapsedTime_us() * 1000);
+      }
 
       absl::flat_hash_set<SourceNode*> completed_sources_wait_loop;
 
-      // This check is used for Memory sources that are waiting on data, because we don't currently
-      // have a mechanism to call Yield() on them while they are waiting.
-      // Once we introduce Carnot ETL, we can have the ingest phase of Carnot ETL call yield.
+      // Streaming memory sources call Continue() when their tables are written to, but the yield
+      // can also end because of another source, or time out, so check them all again.
       for (SourceNode* source : running_sources) {
         if (source->NextBatchReady()) {
           wait_for_more_data = false;
@@ -273,7 +623,7 @@ Status ExecutionGraph::ExecuteSources() {
           }
         }
       }
-      PL_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
+      PL_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth(subgraph.grpc_sinks));
 
       // Flush all of the completed sources after this phase of source deletion.
       for (SourceNode* source : completed_sources_wait_loop) {
@@ -288,6 +638,72 @@ Status ExecutionGraph::ExecuteSources() {
   return Status::OK();
 }
 
+void ExecutionGraph::SetResultCache(ResultCache* cache, std::string_view plan_key) {
+  if (!cacheable_ || cache == nullptr) {
+    return;
+  }
+  // The results only stay the same while no rows are added to or expired from the tables, and
+  // the metadata used by UDFs is the same.
+  std::string key(plan_key);
+  for (const auto& [name, tablet] : source_tables_) {
+    table_store::Table* table = exec_state_->table_store()->GetTable(name, tablet);
+    if (table == nullptr) {
+      return;
+    }
+    absl::StrAppend(&key, "|", name, "/", tablet, ":", table->FirstRowID(), "-",
+                    table->LastRowID());
+  }
+  if (exec_state_->metadata_state() != nullptr) {
+    absl::StrAppend(&key, "|md:", exec_state_->metadata_state()->epoch_id());
+  }
+  result_cache_ = cache;
+  result_cache_key_ = std::move(key);
+}
+
+void ExecutionGraph::ObserveSinkInputs() {
+  for (const auto& [id, node] : nodes_) {
+    if (!node->IsSink()) {
+      continue;
+    }
+    node->set_consume_observer([this, id = id](const RowBatch& rb, size_t parent_index) {
+      absl::MutexLock lock(&sink_inputs_lock_);
+      sink_inputs_.push_back({id, parent_index, rb});
+      if (rb.eos()) {
+        ++sinks_with_eos_;
+      }
+    });
+  }
+}
+
+Status ExecutionGraph::ExecuteCachedResult(const ResultCache::Entry& entry) {
+  std::vector<ExecNode*> sinks;
+  for (const auto& [id, node] : nodes_) {
+    if (node->IsSink()) {
+      sinks.push_back(node);
+    }
+  }
+  for (auto sink : sinks) {
+    PL_RETURN_IF_ERROR(sink->Prepare(exec_state_));
+  }
+  for (auto sink : sinks) {
+    PL_RETURN_IF_ERROR(sink->Open(exec_state_));
+  }
+  Status status = Status::OK();
+  for (const auto& input : entry) {
+    status = nodes_.at(input.sink_id)->ConsumeNext(exec_state_, input.rb, input.parent_index);
+    if (!status.ok()) {
+      break;
+    }
+  }
+  for (auto sink : sinks) {
+    auto s = sink->Close(exec_state_);
+    if (status.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
 /**
  * Execute the graph starting at all of the sources.
  * @return a status of whether execution succeeded.
@@ -295,9 +711,20 @@ Status ExecutionGraph::ExecuteSources() {
 Status ExecutionGraph::Execute() {
   query_start_time_ = std::chrono::system_clock::now();
 
+  if (result_cache_ != nullptr) {
+    auto cached = result_cache_->Get(result_cache_key_);
+    if (cached != nullptr) {
+      VLOG(1) << absl::Substitute("Query $0 reuses the cached results of plan fragment $1",
+                                  exec_state_->query_id().str(), pf_->id());
+      return ExecuteCachedResult(*cached);
+    }
+    ObserveSinkInputs();
+  }
+
   // Get vector of nodes.
   std::vector<ExecNode*> nodes(nodes_.size());
   transform(nodes_.begin(), nodes_.end(), nodes.begin(), [](auto pair) { return pair.second; });
+  nodes.insert(nodes.end(), pipeline_node_copies_.begin(), pipeline_node_copies_.end());
 
   for (auto node : nodes) {
     PL_RETURN_IF_ERROR(node->Prepare(exec_state_));
@@ -327,7 +754,23 @@ Status ExecutionGraph::Execute() {
   if (!source_status.ok()) {
     return source_status;
   }
-  return close_status;
+  PL_RETURN_IF_ERROR(close_status);
+
+  for (int64_t src_id : cursor_sources_) {
+    static_cast<MemorySourceNode*>(nodes_.at(src_id))->CommitCursorPosition(exec_state_);
+  }
+
+  if (result_cache_ != nullptr) {
+    int64_t num_sinks = std::count_if(nodes_.begin(), nodes_.end(),
+                                      [](const auto& pair) { return pair.second->IsSink(); });
+    absl::MutexLock lock(&sink_inputs_lock_);
+    // Only cache complete results, where every sink got its end of stream.
+    if (sinks_with_eos_ == num_sinks) {
+      result_cache_->Put(result_cache_key_, std::move(sink_inputs_));
+    }
+    sink_inputs_.clear();
+  }
+  return Status::OK();
 }
 
 ExecutionStats ExecutionGraph::GetStats() const {
@@ -343,7 +786,9 @@ ExecutionStats ExecutionGraph::GetStats() const {
     bytes_processed += source_node->BytesProcessed();
     rows_processed += source_node->RowsProcessed();
   }
-  return ExecutionStats({bytes_processed, rows_processed});
+  auto mem_pool = exec_state_->exec_mem_pool();
+  return ExecutionStats(
+      {bytes_processed, rows_processed, mem_pool->bytes_allocated(), mem_pool->max_memory()});
 }
 
 }  // namespace exec
@@ -21,6 +21,7 @@
 #include <stddef.h>
 #include <algorithm>
 #include <condition_variable>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -28,10 +29,14 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
+
 #include "src/carnot/dag/dag.h"
+#include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -39,6 +44,10 @@
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int32(carnot_pipeline_threads);
+DECLARE_int32(carnot_subgraph_threads);
+DECLARE_int32(carnot_tablet_scan_threads);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -46,6 +55,9 @@ namespace exec {
 struct ExecutionStats {
   int64_t bytes_processed;
   int64_t rows_processed;
+  // Of the query's memory pool, which is shared by all of its plan fragments.
+  int64_t memory_bytes;
+  int64_t memory_peak_bytes;
 };
 
 constexpr std::chrono::milliseconds kDefaultYieldTimeoutMS{1000};
@@ -55,6 +67,26 @@ using SystemTimePoint = std::chrono::time_point<std::chrono::system_clock>;
 
 /**
  * An Execution Graph defines the structure of execution nodes for a given plan fragment.
+ *
+ * Parallel Pipelines:
+ * With --carnot_pipeline_threads above 1, each finite memory source whose output only goes
+ * through maps and filters into a blocking aggregate is run on that many threads. The threads
+ * take turns reading the next row batch (morsel) of the source, and push it through their own
+ * copies of the maps, filters and aggregate. Once the source is exhausted, the copies of the
+ * aggregate are merged into the original one, which then emits to the rest of the graph as usual.
+ *
+ * Subgraphs:
+ * With --carnot_subgraph_threads above 1, the parts of the graph that aren't connected to each
+ * other, such as the branches that produce separate output tables, are run on up to that many
+ * threads. Each thread alternates between the sources of its subgraphs as the query's thread
+ * otherwise does for all of them.
+ *
+ * Tablet Scans:
+ * With --carnot_tablet_scan_threads above 1, the finite memory sources that read the tablets of a
+ * tabletized table are read on up to that many threads before the rest of the graph runs. The
+ * sources then send the batches they read as usual, so the union of the tablets, which merges
+ * them by time if it is ordered, still runs on the query's thread. The batches of all of the
+ * tablets are held in memory until they are sent.
  */
 class ExecutionGraph {
  public:
@@ -96,6 +128,11 @@ class ExecutionGraph {
   }
 
   ~ExecutionGraph() {
+    // The streaming memory sources call Continue() on writes to their tables, which must stop
+    // before the members it uses are destroyed.
+    for (int64_t src_id : streaming_sources_) {
+      static_cast<MemorySourceNode*>(nodes_.at(src_id))->UnsubscribeFromTableWrites();
+    }
     // We need to remove these GRPC source nodes from the GRPC router because the exec graph
     // gets destructed so that the GRPC router doesn't have stale pointers to those nodes.
     if (exec_state_->grpc_router() != nullptr) {
@@ -121,6 +158,16 @@ class ExecutionGraph {
     return node->second;
   }
 
+  /**
+   * Makes Execute() send the sinks the row batches they consumed in a previous execution of the
+   * same fragment, if the tables it reads haven't changed since, and cache them otherwise. Only
+   * fragments whose sources are all finite memory sources, and that don't export to OTel, are
+   * cached. Must be called after Init() and before Execute().
+   * @param cache The cache, which must outlive the graph.
+   * @param plan_key Identifies the fragment's plan, e.g. the serialized plan fragment.
+   */
+  void SetResultCache(ResultCache* cache, std::string_view plan_key);
+
   /**
    * Executes the current graph until there is no more work that can be done synchronously.
    */
@@ -158,6 +205,7 @@ class ExecutionGraph {
   // Check the downstream GRPC connections for the query.
   // If it is not healthy, we will cancel the query.
   Status CheckDownstreamGRPCConnectionsHealth();
+  Status CheckDownstreamGRPCConnectionsHealth(const std::vector<int64_t>& grpc_sinks);
 
  private:
   /**
@@ -209,6 +257,45 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  // A connected part of the graph, which doesn't exchange row batches with the rest of it.
+  struct Subgraph {
+    std::vector<int64_t> sources;
+    std::vector<int64_t> grpc_sinks;
+  };
+  void PlanSubgraphs();
+  // Runs the sources of the subgraph until they are done, or until another subgraph fails.
+  Status ExecuteSubgraph(const Subgraph& subgraph);
+  // Like YieldWithTimeout(), but for a thread that has seen continues_seen calls to Continue().
+  bool YieldWithTimeout(uint64_t* continues_seen);
+  // Tells each GRPC sink which sources only feed it, so that they can be stopped early when the
+  // destination of the sink has sufficient results.
+  void SetGRPCSinkAbortableSources();
+
+  /**
+   * ParallelPipeline is a memory source, and the maps, filters and blocking aggregate after it,
+   * that are run on several threads.
+   */
+  struct ParallelPipeline {
+    int64_t source_id;
+    MemorySourceNode* source;
+    // The operator after the source, for each thread. The first thread uses the graph's own.
+    std::vector<ExecNode*> heads;
+    // The aggregate at the end of the pipeline, for each thread.
+    std::vector<AggNode*> aggs;
+  };
+
+  using RowDescriptorMap = std::unordered_map<int64_t, table_store::schema::RowDescriptor>;
+  Status PlanParallelPipelines(const RowDescriptorMap& descriptors);
+  StatusOr<ExecNode*> CreateNodeCopy(int64_t id, const RowDescriptorMap& descriptors);
+  Status ExecuteParallelPipeline(const ParallelPipeline& pipeline);
+  // Reads the batches of the tablet sources on several threads, ahead of running the graph.
+  Status PrefetchTabletSources();
+
+  // Sends the cached row batches to the sinks, without running the rest of the graph.
+  Status ExecuteCachedResult(const ResultCache::Entry& entry);
+  // Records the row batches consumed by the sinks, to cache them once execution succeeds.
+  void ObserveSinkInputs();
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
@@ -216,9 +303,28 @@ class ExecutionGraph {
   plan::PlanFragment* pf_;
   std::vector<int64_t> sources_;
   absl::flat_hash_set<int64_t> grpc_sources_;
+  // The memory sources with a named cursor, whose positions are saved once execution succeeds.
+  std::vector<int64_t> cursor_sources_;
+  // The memory sources of infinite streams, which are subscribed to writes to their tables.
+  std::vector<int64_t> streaming_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
+  int32_t pipeline_threads_ = 1;
+  std::vector<ParallelPipeline> parallel_pipelines_;
+  // The copies of the operators of the parallel pipelines, which aren't in nodes_.
+  std::vector<ExecNode*> pipeline_node_copies_;
+
+  int32_t subgraph_threads_ = 1;
+
+  int32_t tablet_scan_threads_ = 1;
+  // The finite memory sources that read a tablet, rather than the default tablet, of a table.
+  std::vector<int64_t> tablet_sources_;
+  // The independent subgraphs, if there is more than one and they are run on separate threads.
+  std::vector<Subgraph> subgraphs_;
+  // Set once a subgraph fails, so that the threads running the others stop.
+  std::atomic<bool> stop_subgraphs_ = false;
+
   SystemTimePoint query_start_time_;
 
   // How long to wait for any upstream result to make the initial connection to this query.
@@ -234,12 +340,24 @@ class ExecutionGraph {
   // (Doesn't apply if there is only one active source.)
   int32_t consecutive_generate_calls_per_source_ = kDefaultConsecutiveGenerateCallsPerSource;
 
-  // Whether or not the graph should continue executing or wait for more work to do.
-  bool continue_ = false;
+  // The number of calls to Continue(), so that each thread running the graph can tell whether
+  // there was one since it last checked.
+  uint64_t continues_ = 0;
+  uint64_t continues_seen_ = 0;
   std::mutex execution_mutex_;
   std::condition_variable execution_cv_;
   // Whether to collect stats on exec nodes.
   bool collect_exec_node_stats_;
+
+  // Whether the results can be cached, see SetResultCache().
+  bool cacheable_ = true;
+  // The tables read by the memory sources.
+  std::vector<std::pair<std::string, types::TabletID>> source_tables_;
+  ResultCache* result_cache_ = nullptr;
+  std::string result_cache_key_;
+  absl::Mutex sink_inputs_lock_;
+  ResultCache::Entry sink_inputs_ ABSL_GUARDED_BY(sink_inputs_lock_);
+  int64_t sinks_with_eos_ ABSL_GUARDED_BY(sink_inputs_lock_) = 0;
 };
 
 }  // namespace exec
@@ -20,6 +20,8 @@
 
 #include <arrow/array.h>
 #include <arrow/memory_pool.h>
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -208,6 +210,450 @@ std::vector<std::tuple<int32_t>> calls_to_execute = {
 INSTANTIATE_TEST_SUITE_P(ExecGraphExecuteTestSuite, ExecGraphExecuteTest,
                          ::testing::ValuesIn(calls_to_execute));
 
+TEST_F(ExecGraphTest, result_cache) {
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kLinearPlanFragment, &pf_pb));
+  auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment->Init(pf_pb));
+
+  table_store::schema::Relation rel(
+      {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64},
+      {"col1", "col2", "col3"});
+  auto table = Table::Create("test", rel);
+  auto write_rows = [&](std::vector<types::Int64Value> col1) {
+    int64_t num_rows = col1.size();
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), num_rows);
+    std::vector<types::BoolValue> col2(num_rows, true);
+    std::vector<types::Float64Value> col3(num_rows, 1.0);
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col3, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  };
+  write_rows({1, 2, 3});
+
+  ResultCache cache(/*max_bytes*/ 1024 * 1024);
+  // Executes the fragment into a new output table, and returns its first column.
+  auto execute = [&]() -> std::shared_ptr<arrow::Array> {
+    auto table_store = std::make_shared<table_store::TableStore>();
+    table_store->AddTable("numbers", table);
+    auto exec_state = std::make_unique<ExecState>(
+        func_registry_.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+        MockTraceStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state->AddScalarUDF(
+        0, "add",
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::FLOAT64})));
+    EXPECT_OK(exec_state->AddScalarUDF(
+        1, "multiply",
+        std::vector<types::DataType>({types::DataType::FLOAT64, types::DataType::INT64})));
+
+    auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+    auto schema = std::make_shared<table_store::schema::Schema>();
+    ExecutionGraph e;
+    EXPECT_OK(e.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment.get(),
+                     /* collect_exec_node_stats */ false));
+    e.SetResultCache(&cache, pf_pb.SerializeAsString());
+    EXPECT_OK(e.Execute());
+
+    table_store::Table::Cursor cursor(table_store->GetTable("output"));
+    return cursor.GetNextRowBatch({0}).ConsumeValueOrDie()->ColumnAt(0);
+  };
+
+  auto expected = types::ToArrow(std::vector<types::Float64Value>({4.0, 6.0, 8.0}),
+                                 arrow::default_memory_pool());
+  EXPECT_TRUE(execute()->Equals(expected));
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.misses(), 1);
+
+  // The table hasn't changed, so the results are reused.
+  EXPECT_TRUE(execute()->Equals(expected));
+  EXPECT_EQ(cache.hits(), 1);
+
+  // New rows change the results.
+  write_rows({4});
+  EXPECT_TRUE(execute()->Equals(expected));
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+constexpr char kSourceFilterAggPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+      sorted_parents: 2
+    }
+    nodes {
+      id: 4
+      sorted_parents: 3
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "group"
+        column_idxs: 1
+        column_types: INT64
+        column_names: "value"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: FILTER_OPERATOR
+      filter_op {
+        expression {
+          func {
+            name: "greater_than"
+            id: 0
+            args {
+              column {
+                node: 1
+                index: 1
+              }
+            }
+            args {
+              constant {
+                data_type: INT64
+                int64_value: 0
+              }
+            }
+            args_data_types: INT64
+            args_data_types: INT64
+          }
+        }
+        columns {
+          node: 1
+          index: 0
+        }
+        columns {
+          node: 1
+          index: 1
+        }
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "sum"
+          id: 0
+          args {
+            column {
+              node: 2
+              index: 1
+            }
+          }
+          args_data_types: INT64
+        }
+        groups {
+          node: 2
+          index: 0
+        }
+        group_names: "group"
+        value_names: "sum"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: INT64
+        column_types: INT64
+        column_names: "group"
+        column_names: "sum"
+      }
+    }
+  }
+)";
+
+class GreaterThanUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(udf::FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val > v2.val;
+  }
+};
+
+class ParallelPipelineTest : public ::testing::TestWithParam<int32_t> {
+ protected:
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    func_registry_->RegisterOrDie<GreaterThanUDF>("greater_than");
+    func_registry_->RegisterOrDie<SumUDA>("sum");
+
+    table_store::schema::Relation rel({types::DataType::INT64, types::DataType::INT64},
+                                      {"group", "value"});
+    auto table = Table::Create("numbers", rel);
+    // Every group gets the values 1 to 100 (and some zeros, which are filtered out), spread over
+    // many row batches.
+    for (int64_t batch = 0; batch < 100; ++batch) {
+      std::vector<types::Int64Value> groups;
+      std::vector<types::Int64Value> values;
+      for (int64_t group = 0; group < kNumGroups; ++group) {
+        groups.push_back(group);
+        values.push_back(batch + 1);
+        groups.push_back(group);
+        values.push_back(0);
+      }
+      auto rb = RowBatch(RowDescriptor(rel.col_types()), groups.size());
+      ASSERT_OK(rb.AddColumn(types::ToArrow(groups, arrow::default_memory_pool())));
+      ASSERT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+      ASSERT_OK(table->WriteRowBatch(rb));
+    }
+
+    auto table_store = std::make_shared<table_store::TableStore>();
+    table_store->AddTable("numbers", table);
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+    ASSERT_OK(exec_state_->AddScalarUDF(0, "greater_than", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddUDA(0, "sum", {types::INT64}));
+
+    planpb::PlanFragment pf_pb;
+    ASSERT_TRUE(TextFormat::MergeFromString(kSourceFilterAggPlanFragment, &pf_pb));
+    ASSERT_OK(plan_fragment_->Init(pf_pb));
+  }
+
+  void TearDown() override { FLAGS_carnot_pipeline_threads = 1; }
+
+  static constexpr int64_t kNumGroups = 5;
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::shared_ptr<plan::PlanFragment> plan_fragment_ = std::make_shared<plan::PlanFragment>(1);
+  std::unique_ptr<ExecState> exec_state_;
+};
+
+TEST_P(ParallelPipelineTest, aggregates_are_merged) {
+  FLAGS_carnot_pipeline_threads = GetParam();
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  ExecutionGraph e;
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false));
+  ASSERT_OK(e.Execute());
+  EXPECT_EQ(e.GetStats().rows_processed, 100 * 2 * kNumGroups);
+
+  auto output_table = exec_state_->table_store()->GetTable("output");
+  table_store::Table::Cursor cursor(output_table);
+  std::map<int64_t, int64_t> sums;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      auto group = types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i);
+      auto sum = types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(1).get(), i);
+      EXPECT_TRUE(sums.emplace(group, sum).second);
+    }
+  }
+  ASSERT_EQ(sums.size(), kNumGroups);
+  for (const auto& [group, sum] : sums) {
+    EXPECT_EQ(sum, 100 * 101 / 2) << group;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelPipelineTestSuite, ParallelPipelineTest,
+                         ::testing::Values(1, 2, 8));
+
+constexpr char kTabletsUnionPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 4
+    }
+    nodes {
+      id: 2
+      sorted_children: 4
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+    }
+    nodes {
+      id: 4
+      sorted_children: 5
+      sorted_parents: 1
+      sorted_parents: 2
+      sorted_parents: 3
+    }
+    nodes {
+      id: 5
+      sorted_parents: 4
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "value"
+        tablet: "1"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "value"
+        tablet: "2"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "value"
+        tablet: "3"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: UNION_OPERATOR
+      union_op {
+        column_names: "value"
+        column_mappings {
+          column_indexes: 0
+        }
+        column_mappings {
+          column_indexes: 0
+        }
+        column_mappings {
+          column_indexes: 0
+        }
+      }
+    }
+  }
+  nodes {
+    id: 5
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: INT64
+        column_names: "value"
+      }
+    }
+  }
+)";
+
+class TabletScanTest : public ::testing::TestWithParam<int32_t> {
+ protected:
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    table_store::schema::Relation rel({types::DataType::INT64}, {"value"});
+    auto table_store = std::make_shared<table_store::TableStore>();
+    // Tablet i has the values 1000 * i + 1 to 1000 * i + 100, over several row batches.
+    for (int64_t tablet = 1; tablet <= kNumTablets; ++tablet) {
+      auto table = Table::Create("numbers", rel);
+      for (int64_t batch = 0; batch < 10; ++batch) {
+        std::vector<types::Int64Value> values;
+        for (int64_t i = 1; i <= 10; ++i) {
+          values.push_back(1000 * tablet + 10 * batch + i);
+        }
+        auto rb = RowBatch(RowDescriptor(rel.col_types()), values.size());
+        ASSERT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+        ASSERT_OK(table->WriteRowBatch(rb));
+      }
+      table_store->AddTable(table, "numbers", /* table_id */ 1, std::to_string(tablet));
+    }
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+    planpb::PlanFragment pf_pb;
+    ASSERT_TRUE(TextFormat::MergeFromString(kTabletsUnionPlanFragment, &pf_pb));
+    ASSERT_OK(plan_fragment_->Init(pf_pb));
+  }
+
+  void TearDown() override { FLAGS_carnot_tablet_scan_threads = 1; }
+
+  static constexpr int64_t kNumTablets = 3;
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::shared_ptr<plan::PlanFragment> plan_fragment_ = std::make_shared<plan::PlanFragment>(1);
+  std::unique_ptr<ExecState> exec_state_;
+};
+
+TEST_P(TabletScanTest, all_tablets_are_read) {
+  FLAGS_carnot_tablet_scan_threads = GetParam();
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  ExecutionGraph e;
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false));
+  ASSERT_OK(e.Execute());
+
+  auto output_table = exec_state_->table_store()->GetTable("output");
+  table_store::Table::Cursor cursor(output_table);
+  std::vector<int64_t> values;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      values.push_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i));
+    }
+  }
+  // The rows of each tablet stay in order.
+  for (int64_t tablet = 1; tablet <= kNumTablets; ++tablet) {
+    std::vector<int64_t> tablet_values;
+    for (int64_t v : values) {
+      if (v / 1000 == tablet) {
+        tablet_values.push_back(v);
+      }
+    }
+    ASSERT_EQ(tablet_values.size(), 100);
+    EXPECT_TRUE(std::is_sorted(tablet_values.begin(), tablet_values.end()));
+  }
+  EXPECT_EQ(values.size(), kNumTablets * 100);
+}
+
+INSTANTIATE_TEST_SUITE_P(TabletScanTestSuite, TabletScanTest, ::testing::Values(1, 2, 8));
+
 TEST_F(ExecGraphTest, execute_time) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kLinearPlanFragment, &pf_pb));
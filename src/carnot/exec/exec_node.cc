@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/exec_node.h"
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+
+DEFINE_bool(carnot_exec_stats_hw_counters,
+            gflags::BoolFromEnv("PL_CARNOT_EXEC_STATS_HW_COUNTERS", false),
+            "Whether to collect CPU cycles, instructions and cache misses for each exec node, "
+            "when collecting exec stats. Requires access to perf events.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+void BatchLatencyHistogram::Add(int64_t latency_ns) {
+  size_t bucket = 0;
+  for (int64_t v = latency_ns; v > 0 && bucket < kNumBuckets - 1; v >>= 1) {
+    ++bucket;
+  }
+  ++counts[bucket];
+  ++num_batches;
+  max_ns = std::max(max_ns, latency_ns);
+}
+
+int64_t BatchLatencyHistogram::Percentile(double quantile) const {
+  int64_t rank = static_cast<int64_t>(quantile * num_batches);
+  int64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen > rank) {
+      return std::min(max_ns, (int64_t{1} << i) - 1);
+    }
+  }
+  return max_ns;
+}
+
+std::string BatchLatencyHistogram::DebugString() const {
+  std::vector<std::string> buckets;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    if (counts[i] > 0) {
+      buckets.push_back(absl::Substitute("<$0ns:$1", int64_t{1} << i, counts[i]));
+    }
+  }
+  return absl::StrJoin(buckets, ", ");
+}
+
+void ExecNodeStats::AddDetailedStats() {
+  if (!collect_exec_stats) {
+    return;
+  }
+  AddExtraMetric("batch_latency_p50_ns", batch_latency.Percentile(0.5));
+  AddExtraMetric("batch_latency_p99_ns", batch_latency.Percentile(0.99));
+  AddExtraMetric("batch_latency_max_ns", batch_latency.max_ns);
+  AddExtraInfo("batch_latency_histogram", batch_latency.DebugString());
+  AddExtraMetric("memory_peak_bytes", memory_peak_bytes);
+  if (collect_hw_counters) {
+    HardwareCounters::Values self = SelfCounters();
+    AddExtraMetric("self_cpu_cycles", self.cycles);
+    AddExtraMetric("self_instructions", self.instructions);
+    AddExtraMetric("self_cache_misses", self.cache_misses);
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
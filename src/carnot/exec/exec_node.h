@@ -18,16 +18,24 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/row_selection.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_exec_stats_hw_counters);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -38,15 +46,35 @@ enum class ExecNodeType : int8_t {
   kProcessingNode = 2,
 };
 
+/**
+ * A histogram of per-batch latencies, with power of two buckets. Bucket i counts latencies
+ * below 2^i ns (and at or above 2^(i-1) ns).
+ */
+struct BatchLatencyHistogram {
+  static constexpr size_t kNumBuckets = 40;
+
+  void Add(int64_t latency_ns);
+  // An upper bound on the given quantile (in [0, 1]) of the latencies.
+  int64_t Percentile(double quantile) const;
+  // The non-empty buckets, e.g. "<1024ns:4, <2048ns:10".
+  std::string DebugString() const;
+
+  std::array<int64_t, kNumBuckets> counts = {};
+  int64_t num_batches = 0;
+  int64_t max_ns = 0;
+};
+
 struct ExecNodeStats {
-  explicit ExecNodeStats(bool collect_stats) : collect_exec_stats(collect_stats) {}
+  explicit ExecNodeStats(bool collect_stats)
+      : collect_exec_stats(collect_stats),
+        collect_hw_counters(collect_stats && FLAGS_carnot_exec_stats_hw_counters) {}
   void AddOutputStats(const table_store::schema::RowBatch& rb) {
     if (!collect_exec_stats) {
       return;
     }
     ++batches_output;
     bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    rows_output += rb.num_selected_rows();
   }
 
   void AddInputStats(const table_store::schema::RowBatch& rb) {
@@ -55,7 +83,7 @@ struct ExecNodeStats {
     }
     ++batches_input;
     bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    rows_input += rb.num_selected_rows();
   }
 
   void ResumeChildTimer() {
@@ -63,24 +91,68 @@ struct ExecNodeStats {
       return;
     }
     children_timer.Resume();
+    if (collect_hw_counters) {
+      children_counters_start = HardwareCounters::ThisThread()->Read();
+    }
   }
   void StopChildTimer() {
     if (!collect_exec_stats) {
       return;
     }
     children_timer.Stop();
+    if (collect_hw_counters) {
+      children_counters += HardwareCounters::ThisThread()->Read() - children_counters_start;
+    }
   }
   void ResumeTotalTimer() {
     if (!collect_exec_stats) {
       return;
     }
     total_timer.Resume();
+    if (collect_hw_counters) {
+      total_counters_start = HardwareCounters::ThisThread()->Read();
+    }
   }
   void StopTotalTimer() {
     if (!collect_exec_stats) {
       return;
     }
     total_timer.Stop();
+    if (collect_hw_counters) {
+      total_counters += HardwareCounters::ThisThread()->Read() - total_counters_start;
+    }
+  }
+
+  // Brackets the processing of a single batch (a call to GenerateNext or ConsumeNext), for the
+  // latency histogram and the memory peak.
+  void StartBatch(const arrow::MemoryPool* pool) {
+    ResumeTotalTimer();
+    if (!collect_exec_stats) {
+      return;
+    }
+    batch_start = std::chrono::steady_clock::now();
+    batch_start_max_memory = pool->max_memory();
+  }
+  void EndBatch(const arrow::MemoryPool* pool) {
+    StopTotalTimer();
+    if (!collect_exec_stats) {
+      return;
+    }
+    batch_latency.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - batch_start)
+                          .count());
+    // If the pool's high water mark rose during this batch, this node was running at the peak.
+    int64_t peak = pool->max_memory() > batch_start_max_memory ? pool->max_memory()
+                                                                 : pool->bytes_allocated();
+    memory_peak_bytes = std::max(memory_peak_bytes, peak);
+  }
+
+  // Adds time that this source node spent waiting for its next batch to become ready.
+  void AddWaitTime(int64_t ns) {
+    if (!collect_exec_stats) {
+      return;
+    }
+    wait_time_ns += ns;
   }
 
   void AddExtraMetric(std::string_view key, double value) {
@@ -102,6 +174,11 @@ struct ExecNodeStats {
   int64_t ChildExecTime() const { return children_timer.ElapsedTime_us() * 1000; }
   int64_t TotalExecTime() const { return total_timer.ElapsedTime_us() * 1000; }
   int64_t SelfExecTime() const { return TotalExecTime() - ChildExecTime(); }
+  HardwareCounters::Values SelfCounters() const { return total_counters - children_counters; }
+
+  // Adds the batch latency histogram, memory peak and hardware counters to the extra metrics
+  // and info, which are returned with the query's execution stats.
+  void AddDetailedStats();
 
   // Total bytes input to this exec node.
   int64_t bytes_input = 0;
@@ -121,6 +198,23 @@ struct ExecNodeStats {
   ElapsedTimer children_timer;
   // Flag to determine whether to collect stats or not.
   bool collect_exec_stats;
+  // Whether to also collect hardware counters, which requires collect_exec_stats.
+  bool collect_hw_counters;
+
+  // Latency of each batch, including the time spent by the children on its output.
+  BatchLatencyHistogram batch_latency;
+  // The highest memory use of the query's pool seen at the end of, or during, this node's batches.
+  int64_t memory_peak_bytes = 0;
+  // The time spent waiting for input, only tracked for source nodes.
+  int64_t wait_time_ns = 0;
+  std::chrono::steady_clock::time_point batch_start;
+  int64_t batch_start_max_memory = 0;
+
+  // Hardware counts of the calling thread, tracked like total_timer and children_timer.
+  HardwareCounters::Values total_counters;
+  HardwareCounters::Values children_counters;
+  HardwareCounters::Values total_counters_start;
+  HardwareCounters::Values children_counters_start;
 
   // Extra metrics to store.
   absl::flat_hash_map<std::string, double> extra_metrics;
@@ -182,7 +276,10 @@ class ExecNode {
    */
   Status Close(ExecState* exec_state) {
     DCHECK(is_initialized_);
-    return CloseImpl(exec_state);
+    PL_RETURN_IF_ERROR(CloseImpl(exec_state));
+    exec_state->exec_mem_pool()->Charge(-charged_memory_bytes_);
+    charged_memory_bytes_ = 0;
+    return Status::OK();
   }
 
   /**
@@ -194,9 +291,10 @@ class ExecNode {
   Status GenerateNext(ExecState* exec_state) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
-    stats_->ResumeTotalTimer();
+    stats_->StartBatch(exec_state->exec_mem_pool());
     PL_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
-    stats_->StopTotalTimer();
+    PL_RETURN_IF_ERROR(ChargeExternalMemory(exec_state));
+    stats_->EndBatch(exec_state->exec_mem_pool());
     return Status::OK();
   }
 
@@ -219,12 +317,45 @@ class ExecNode {
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
     stats_->AddInputStats(rb);
-    stats_->ResumeTotalTimer();
-    PL_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
-    stats_->StopTotalTimer();
+    stats_->StartBatch(exec_state->exec_mem_pool());
+    if (rb.has_selection() && !SupportsSelection()) {
+      PL_ASSIGN_OR_RETURN(auto compacted_rb, CompactSelection(rb, exec_state->exec_mem_pool()));
+      if (consume_observer_) {
+        consume_observer_(*compacted_rb, parent_index);
+      }
+      PL_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, *compacted_rb, parent_index));
+    } else {
+      if (consume_observer_) {
+        consume_observer_(rb, parent_index);
+      }
+      PL_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
+    }
+    PL_RETURN_IF_ERROR(ChargeExternalMemory(exec_state));
+    stats_->EndBatch(exec_state->exec_mem_pool());
     return Status::OK();
   }
 
+  using ConsumeObserver =
+      std::function<void(const table_store::schema::RowBatch& rb, size_t parent_index)>;
+  /**
+   * Sets a function that is called with each row batch this node consumes, as it is passed to
+   * ConsumeNextImpl().
+   */
+  void set_consume_observer(ConsumeObserver observer) { consume_observer_ = std::move(observer); }
+
+  /**
+   * Whether ConsumeNextImpl() handles row batches with a selection, rather than being given the
+   * selected rows copied into a new batch.
+   */
+  virtual bool SupportsSelection() const { return false; }
+
+  /**
+   * The estimated bytes this node holds outside of the query's memory pool, such as its hash
+   * tables and arenas. The change is charged to the pool after every batch, so that it counts
+   * towards the query's peak memory and memory limit.
+   */
+  virtual int64_t ExternalMemoryBytes() const { return 0; }
+
   /**
    * Check if it's a source node.
    */
@@ -321,6 +452,21 @@ class ExecNode {
   bool sent_eos_ = false;
 
  private:
+  Status ChargeExternalMemory(ExecState* exec_state) {
+    int64_t bytes = ExternalMemoryBytes();
+    if (bytes == charged_memory_bytes_) {
+      return Status::OK();
+    }
+    auto* pool = exec_state->exec_mem_pool();
+    if (!pool->Charge(bytes - charged_memory_bytes_)) {
+      return error::ResourceUnavailable(
+          "$0 grew to $1 bytes, which takes the query over its memory limit of $2 bytes",
+          DebugString(), bytes, pool->limit_bytes());
+    }
+    charged_memory_bytes_ = bytes;
+    return Status::OK();
+  }
+
   // The stats of this exec node.
   std::unique_ptr<ExecNodeStats> stats_;
   // Unowned reference to the children. Must remain valid for the duration of query.
@@ -334,6 +480,9 @@ class ExecNode {
   ExecNodeType type_;
   // Whether this node has been initialized.
   bool is_initialized_ = false;
+  ConsumeObserver consume_observer_;
+  // The bytes of ExternalMemoryBytes() currently charged to the query's memory pool.
+  int64_t charged_memory_bytes_ = 0;
 };
 
 /**
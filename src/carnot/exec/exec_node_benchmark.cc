@@ -0,0 +1,411 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/equijoin_node.h"
+#include "src/carnot/exec/exec_node_mock.h"
+#include "src/carnot/exec/filter_node.h"
+#include "src/carnot/exec/limit_node.h"
+#include "src/carnot/exec/map_node.h"
+#include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+// Micro-benchmarks of the exec nodes, each fed the batches of GenerateBenchmarkBatches(). The
+// ordered and unordered union benchmarks are in union_node_benchmark.cc.
+
+using px::carnot::exec::ExecState;
+using px::carnot::exec::FakePlanNode;
+using px::carnot::exec::GenerateBenchmarkBatches;
+using px::carnot::exec::MockExecNode;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::udf::FunctionContext;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using px::types::Int64Value;
+using ::testing::_;
+
+namespace {
+
+constexpr int64_t kNumBatches = 64;
+constexpr int64_t kRowsPerBatch = 1024;
+
+class LessThanUDF : public px::carnot::udf::ScalarUDF {
+ public:
+  px::types::BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) {
+    return v1.val < v2.val;
+  }
+};
+
+class AddUDF : public px::carnot::udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+};
+
+class SumUDA : public px::carnot::udf::UDA {
+ public:
+  void Update(FunctionContext*, Int64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  Int64Value Finalize(FunctionContext*) { return sum_; }
+
+ protected:
+  Int64Value sum_ = 0;
+};
+
+std::unique_ptr<ExecState> MakeExecState(px::carnot::udf::Registry* registry) {
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
+                                     MockMetricsStubGenerator, MockTraceStubGenerator,
+                                     sole::uuid4(), nullptr);
+}
+
+px::carnot::planpb::Operator OperatorFromPbtxt(std::string_view op_type, std::string_view op_field,
+                                               std::string_view contents) {
+  px::carnot::planpb::Operator op;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(px::carnot::planpb::testutils::kOperatorProtoTmpl, op_type, op_field,
+                       contents),
+      &op));
+  return op;
+}
+
+// The child of the benchmarked node, which counts the rows sent to it.
+class CountingChild {
+ public:
+  CountingChild(ExecState* exec_state, const RowDescriptor& rd) {
+    ON_CALL(node_, ConsumeNextImpl(_, _, _))
+        .WillByDefault([this](ExecState*, const RowBatch& rb, size_t) {
+          rows_ += rb.num_rows();
+          return px::Status::OK();
+        });
+    PL_CHECK_OK(node_.Init(fake_plan_, RowDescriptor({}), {rd}));
+    PL_CHECK_OK(node_.Prepare(exec_state));
+    PL_CHECK_OK(node_.Open(exec_state));
+  }
+
+  MockExecNode* node() { return &node_; }
+  int64_t rows() const { return rows_; }
+
+ private:
+  ::testing::NiceMock<MockExecNode> node_;
+  FakePlanNode fake_plan_{123};
+  int64_t rows_ = 0;
+};
+
+template <typename TNode>
+std::unique_ptr<TNode> MakeNode(ExecState* exec_state, const px::carnot::plan::Operator& plan_node,
+                                const RowDescriptor& output_rd,
+                                const std::vector<RowDescriptor>& input_rds,
+                                CountingChild* child) {
+  auto node = std::make_unique<TNode>();
+  node->AddChild(child->node(), 0);
+  PL_CHECK_OK(node->Init(plan_node, output_rd, input_rds));
+  PL_CHECK_OK(node->Prepare(exec_state));
+  PL_CHECK_OK(node->Open(exec_state));
+  return node;
+}
+
+constexpr char kLessThanFilterTmpl[] = R"(
+expression {
+  func {
+    name: "lessThan"
+    args { column { node: 0 index: 0 } }
+    args { constant { data_type: INT64 int64_value: $0 } }
+    args_data_types: INT64
+    args_data_types: INT64
+  }
+}
+columns { node: 0 index: 0 }
+columns { node: 0 index: 1 }
+columns { node: 0 index: 2 })";
+
+constexpr char kSumAggTmpl[] = R"(
+windowed: $0
+values {
+  name: "sum"
+  args { column { node: 0 index: 1 } }
+}
+groups { node: 0 index: 0 }
+group_names: "group"
+value_names: "sum")";
+
+constexpr char kJoinOp[] = R"(
+type: INNER
+equality_conditions { left_column_index: 1 right_column_index: 0 }
+output_columns { parent_index: 0 column_index: 0 }
+output_columns { parent_index: 1 column_index: 1 }
+column_names: "left_value"
+column_names: "right_row"
+rows_per_batch: 1024)";
+
+constexpr char kLimitTmpl[] = R"(
+limit: $0
+columns { node: 0 index: 0 }
+columns { node: 0 index: 1 }
+columns { node: 0 index: 2 })";
+
+constexpr char kMemorySourceOp[] = R"(
+name: "bench"
+column_idxs: 0
+column_idxs: 1
+column_idxs: 2
+column_types: INT64
+column_types: INT64
+column_types: TIME64NS
+column_names: "value"
+column_names: "row"
+column_names: "time_"
+streaming: false)";
+
+// A map with a single expression, of `depth` nested adds.
+std::string AddChainMapPbtxt(int64_t depth) {
+  std::string expr = "column { node: 0 index: 0 }";
+  for (int64_t i = 0; i < depth; ++i) {
+    expr = absl::Substitute(
+        R"(func { name: "add" args { $0 } args { column { node: 0 index: 1 } } )"
+        R"(args_data_types: INT64 args_data_types: INT64 })",
+        expr);
+  }
+  return absl::Substitute(R"(expressions { $0 } column_names: "out")", expr);
+}
+
+}  // namespace
+
+// Filters with a selectivity of state.range(0) percent.
+// NOLINTNEXTLINE : runtime/references.
+void BM_FilterNode(benchmark::State& state) {
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  PL_CHECK_OK(registry->Register<LessThanUDF>("lessThan"));
+  auto exec_state = MakeExecState(registry.get());
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "lessThan", {DataType::INT64, DataType::INT64}));
+  auto plan_node = px::carnot::plan::FilterOperator::FromProto(
+      OperatorFromPbtxt("FILTER_OPERATOR", "filter_op",
+                        absl::Substitute(kLessThanFilterTmpl, state.range(0))),
+      1);
+
+  auto batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, /*value_range*/ 100);
+  RowDescriptor rd = batches[0].desc();
+  CountingChild child(exec_state.get(), rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = MakeNode<px::carnot::exec::FilterNode>(exec_state.get(), *plan_node, rd, {rd},
+                                                       &child);
+    state.ResumeTiming();
+    for (const auto& rb : batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumBatches * kRowsPerBatch);
+  state.counters["OutputRows"] =
+      benchmark::Counter(child.rows(), benchmark::Counter::kAvgIterations);
+}
+
+// Maps with a chain of state.range(0) UDF calls.
+// NOLINTNEXTLINE : runtime/references.
+void BM_MapNode(benchmark::State& state) {
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  PL_CHECK_OK(registry->Register<AddUDF>("add"));
+  auto exec_state = MakeExecState(registry.get());
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "add", {DataType::INT64, DataType::INT64}));
+  auto plan_node = px::carnot::plan::MapOperator::FromProto(
+      OperatorFromPbtxt("MAP_OPERATOR", "map_op", AddChainMapPbtxt(state.range(0))), 1);
+
+  auto batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, /*value_range*/ 100);
+  RowDescriptor input_rd = batches[0].desc();
+  RowDescriptor output_rd({DataType::INT64});
+  CountingChild child(exec_state.get(), output_rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = MakeNode<px::carnot::exec::MapNode>(exec_state.get(), *plan_node, output_rd,
+                                                    {input_rd}, &child);
+    state.ResumeTiming();
+    for (const auto& rb : batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumBatches * kRowsPerBatch);
+}
+
+// Sums over state.range(0) groups. If state.range(1) is set, the aggregate is windowed, with a
+// window per batch.
+// NOLINTNEXTLINE : runtime/references.
+void BM_AggNode(benchmark::State& state) {
+  bool windowed = state.range(1);
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  PL_CHECK_OK(registry->Register<SumUDA>("sum"));
+  auto exec_state = MakeExecState(registry.get());
+  PL_CHECK_OK(exec_state->AddUDA(0, "sum", {DataType::INT64}));
+  auto plan_node = px::carnot::plan::AggregateOperator::FromProto(
+      OperatorFromPbtxt("AGGREGATE_OPERATOR", "agg_op",
+                        absl::Substitute(kSumAggTmpl, windowed ? "true" : "false")),
+      1);
+
+  auto batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, state.range(0));
+  if (windowed) {
+    for (auto& rb : batches) {
+      rb.set_eow(true);
+    }
+  }
+  RowDescriptor input_rd = batches[0].desc();
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64});
+  CountingChild child(exec_state.get(), output_rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = MakeNode<px::carnot::exec::AggNode>(exec_state.get(), *plan_node, output_rd,
+                                                    {input_rd}, &child);
+    state.ResumeTiming();
+    for (const auto& rb : batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumBatches * kRowsPerBatch);
+}
+
+// Joins a build side of state.range(0) rows, with unique keys, to a fixed probe side whose rows
+// each match one build row.
+// NOLINTNEXTLINE : runtime/references.
+void BM_EquijoinNode(benchmark::State& state) {
+  int64_t build_rows = state.range(0);
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  auto exec_state = MakeExecState(registry.get());
+  auto plan_node = px::carnot::plan::JoinOperator::FromProto(
+      OperatorFromPbtxt("JOIN_OPERATOR", "join_op", kJoinOp), 1);
+
+  auto build_batches = GenerateBenchmarkBatches(build_rows / kRowsPerBatch, kRowsPerBatch,
+                                                /*value_range*/ 100);
+  auto probe_batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, build_rows);
+  RowDescriptor input_rd = build_batches[0].desc();
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64});
+  CountingChild child(exec_state.get(), output_rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = MakeNode<px::carnot::exec::EquijoinNode>(exec_state.get(), *plan_node, output_rd,
+                                                         {input_rd, input_rd}, &child);
+    state.ResumeTiming();
+    for (const auto& rb : build_batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 0));
+    }
+    for (const auto& rb : probe_batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 1));
+    }
+  }
+  CHECK_EQ(child.rows(), state.iterations() * kNumBatches * kRowsPerBatch);
+  state.SetItemsProcessed(state.iterations() * (build_rows + kNumBatches * kRowsPerBatch));
+}
+
+// Limits the input to state.range(0) rows.
+// NOLINTNEXTLINE : runtime/references.
+void BM_LimitNode(benchmark::State& state) {
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  auto exec_state = MakeExecState(registry.get());
+  auto plan_node = px::carnot::plan::LimitOperator::FromProto(
+      OperatorFromPbtxt("LIMIT_OPERATOR", "limit_op",
+                        absl::Substitute(kLimitTmpl, state.range(0))),
+      1);
+
+  auto batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, /*value_range*/ 100);
+  RowDescriptor rd = batches[0].desc();
+  CountingChild child(exec_state.get(), rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node =
+        MakeNode<px::carnot::exec::LimitNode>(exec_state.get(), *plan_node, rd, {rd}, &child);
+    state.ResumeTiming();
+    for (const auto& rb : batches) {
+      PL_CHECK_OK(node->ConsumeNext(exec_state.get(), rb, 0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          std::min<int64_t>(state.range(0), kNumBatches * kRowsPerBatch));
+}
+
+// Scans a table, which is compacted into cold batches first if state.range(0) is set.
+// NOLINTNEXTLINE : runtime/references.
+void BM_MemorySourceNode(benchmark::State& state) {
+  auto registry = std::make_unique<px::carnot::udf::Registry>("bench_registry");
+  auto exec_state = MakeExecState(registry.get());
+  exec_state->SetCurrentSource(1);
+  auto plan_node = px::carnot::plan::MemorySourceOperator::FromProto(
+      OperatorFromPbtxt("MEMORY_SOURCE_OPERATOR", "mem_source_op", kMemorySourceOp), 1);
+
+  auto batches = GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, /*value_range*/ 100);
+  RowDescriptor rd = batches[0].desc();
+  px::table_store::schema::Relation rel(rd.types(), {"value", "row", "time_"});
+  // Compacts 16 hot batches into each cold batch.
+  int64_t compacted_batch_size = 16 * kRowsPerBatch * 3 * sizeof(int64_t);
+  auto table = std::make_shared<px::table_store::Table>("bench", rel, 1024 * 1024 * 1024,
+                                                        compacted_batch_size);
+  for (const auto& rb : batches) {
+    PL_CHECK_OK(table->WriteRowBatch(rb));
+  }
+  if (state.range(0)) {
+    PL_CHECK_OK(table->CompactHotToCold());
+  }
+  exec_state->table_store()->AddTable("bench", table);
+
+  CountingChild child(exec_state.get(), rd);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = MakeNode<px::carnot::exec::MemorySourceNode>(exec_state.get(), *plan_node, rd, {},
+                                                             &child);
+    state.ResumeTiming();
+    while (node->HasBatchesRemaining()) {
+      PL_CHECK_OK(node->GenerateNext(exec_state.get()));
+    }
+  }
+  CHECK_EQ(child.rows(), state.iterations() * kNumBatches * kRowsPerBatch);
+  state.SetItemsProcessed(state.iterations() * kNumBatches * kRowsPerBatch);
+}
+
+static void AggNodeArgs(benchmark::internal::Benchmark* b) {
+  for (int windowed : {0, 1}) {
+    for (int num_groups : {10, 1000, 100000}) {
+      b->Args({num_groups, windowed});
+    }
+  }
+}
+
+BENCHMARK(BM_FilterNode)->Arg(1)->Arg(10)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK(BM_MapNode)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_AggNode)->Apply(AggNodeArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EquijoinNode)
+    ->Arg(1024)
+    ->Arg(16 * 1024)
+    ->Arg(256 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LimitNode)->Arg(100)->Arg(kNumBatches * kRowsPerBatch / 2);
+BENCHMARK(BM_MemorySourceNode)->Arg(0)->Arg(1);
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/exec_node.h"
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/memory_pool.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(BatchLatencyHistogramTest, percentiles) {
+  BatchLatencyHistogram histogram;
+  for (int i = 0; i < 98; ++i) {
+    histogram.Add(1000);
+  }
+  histogram.Add(5000);
+  histogram.Add(100000);
+
+  EXPECT_EQ(histogram.num_batches, 100);
+  EXPECT_EQ(histogram.max_ns, 100000);
+  EXPECT_EQ(histogram.counts[10], 98);
+  EXPECT_EQ(histogram.Percentile(0.5), 1023);
+  EXPECT_EQ(histogram.Percentile(0.98), 8191);
+  EXPECT_EQ(histogram.Percentile(1), 100000);
+  EXPECT_EQ(histogram.DebugString(), "<1024ns:98, <8192ns:1, <131072ns:1");
+}
+
+TEST(ExecNodeStatsTest, detailed_stats) {
+  auto pool = types::AccountingMemoryPool::Create();
+  ExecNodeStats stats(/*collect_stats*/ true);
+
+  stats.StartBatch(pool.get());
+  uint8_t* buf;
+  ASSERT_TRUE(pool->Allocate(1024, &buf).ok());
+  stats.EndBatch(pool.get());
+  pool->Free(buf, 1024);
+  stats.StartBatch(pool.get());
+  stats.EndBatch(pool.get());
+
+  EXPECT_EQ(stats.batch_latency.num_batches, 2);
+  EXPECT_EQ(stats.memory_peak_bytes, 1024);
+
+  stats.AddDetailedStats();
+  EXPECT_EQ(stats.extra_metrics["memory_peak_bytes"], 1024);
+  EXPECT_TRUE(stats.extra_metrics.contains("batch_latency_p99_ns"));
+  EXPECT_TRUE(stats.extra_info.contains("batch_latency_histogram"));
+  EXPECT_FALSE(stats.extra_metrics.contains("self_cpu_cycles"));
+}
+
+TEST(ExecNodeStatsTest, disabled) {
+  auto pool = types::AccountingMemoryPool::Create();
+  ExecNodeStats stats(/*collect_stats*/ false);
+  stats.StartBatch(pool.get());
+  stats.EndBatch(pool.get());
+  stats.AddDetailedStats();
+  EXPECT_EQ(stats.batch_latency.num_batches, 0);
+  EXPECT_TRUE(stats.extra_metrics.empty());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -23,9 +23,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -34,6 +36,7 @@
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
+#include "src/shared/types/memory_pool.h"
 #include "src/table_store/table/table_store.h"
 
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
@@ -70,7 +73,8 @@ class ExecState {
       const MetricsStubGenerator& metrics_stub_generator,
       const TraceStubGenerator& trace_stub_generator, const sole::uuid& query_id,
       ml::ModelPool* model_pool, GRPCRouter* grpc_router = nullptr,
-      std::function<void(grpc::ClientContext*)> add_auth_func = [](grpc::ClientContext*) {})
+      std::function<void(grpc::ClientContext*)> add_auth_func = [](grpc::ClientContext*) {},
+      int64_t memory_limit_bytes = 0, int64_t buffer_recycle_bytes = 0)
       : func_registry_(func_registry),
         table_store_(std::move(table_store)),
         stub_generator_(stub_generator),
@@ -79,17 +83,20 @@ class ExecState {
         query_id_(query_id),
         model_pool_(model_pool),
         grpc_router_(grpc_router),
-        add_auth_to_grpc_client_context_func_(add_auth_func) {}
+        add_auth_to_grpc_client_context_func_(add_auth_func),
+        exec_mem_pool_(types::AccountingMemoryPool::Create(
+            memory_limit_bytes, arrow::default_memory_pool(), buffer_recycle_bytes)) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
   }
-  arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
-  }
+  // The pool for the arrow arrays of the query, which accounts for the query's memory. Memory the
+  // operators allocate outside of arrow (e.g. hash tables) is charged to it as well, and the query
+  // fails once the pool goes over its limit. The arrays the operators free are recycled by the pool
+  // for the batches that follow.
+  types::AccountingMemoryPool* exec_mem_pool() { return exec_mem_pool_.get(); }
 
   udf::Registry* func_registry() { return func_registry_; }
 
@@ -116,6 +123,7 @@ class ExecState {
   // Currently, it will either be a Kelvin instance or a query broker.
   carnotpb::ResultSinkService::StubInterface* ResultSinkServiceStub(
       const std::string& remote_address, const std::string& ssl_targetname) {
+    absl::MutexLock lock(&stubs_lock_);
     if (result_sink_stub_map_.contains(remote_address)) {
       return result_sink_stub_map_[remote_address];
     }
@@ -130,6 +138,7 @@ class ExecState {
 
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface* MetricsServiceStub(
       const std::string& remote_address, bool insecure) {
+    absl::MutexLock lock(&stubs_lock_);
     if (metrics_service_stub_map_.contains(remote_address)) {
       return metrics_service_stub_map_[remote_address];
     }
@@ -143,6 +152,7 @@ class ExecState {
   }
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* TraceServiceStub(
       const std::string& remote_address, bool insecure) {
+    absl::MutexLock lock(&stubs_lock_);
     if (trace_service_stub_map_.contains(remote_address)) {
       return trace_service_stub_map_[remote_address];
     }
@@ -155,13 +165,21 @@ class ExecState {
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  // The definitions are looked up without modifying the maps, so that operators running on
+  // different threads (see ExecutionGraph) can share the ExecState.
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) const {
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
   }
 
-  udf::UDADefinition* GetUDADefinition(int64_t id) { return id_to_uda_map_[id]; }
+  udf::UDADefinition* GetUDADefinition(int64_t id) const {
+    auto it = id_to_uda_map_.find(id);
+    return it == id_to_uda_map_.end() ? nullptr : it->second;
+  }
 
   std::unique_ptr<udf::FunctionContext> CreateFunctionContext() {
     auto ctx = std::make_unique<udf::FunctionContext>(metadata_state_, model_pool_);
@@ -170,25 +188,30 @@ class ExecState {
 
   // A node (ie. Limit) can call this method to say no more records will be processed for this
   // source. That node is responsible for setting eos.
-  void StopSource(int64_t src_id) { source_id_to_keep_running_map_[src_id] = false; }
+  void StopSource(int64_t src_id) {
+    absl::MutexLock lock(&sources_lock_);
+    source_id_to_keep_running_map_[src_id] = false;
+  }
 
+  // The current source is per thread, since the independent subgraphs of a plan fragment can run
+  // on separate threads (see ExecutionGraph).
   bool keep_running() {
-    DCHECK(current_source_set_);
-    return source_id_to_keep_running_map_[current_source_];
+    absl::MutexLock lock(&sources_lock_);
+    auto it = current_sources_.find(std::this_thread::get_id());
+    DCHECK(it != current_sources_.end());
+    return it != current_sources_.end() && source_id_to_keep_running_map_[it->second];
   }
 
   void SetCurrentSource(int64_t source_id) {
-    current_source_ = source_id;
-    current_source_set_ = true;
-    if (source_id_to_keep_running_map_.find(current_source_) ==
-        source_id_to_keep_running_map_.end()) {
-      source_id_to_keep_running_map_[current_source_] = true;
-    }
+    absl::MutexLock lock(&sources_lock_);
+    current_sources_[std::this_thread::get_id()] = source_id;
+    source_id_to_keep_running_map_.try_emplace(source_id, true);
   }
 
   void set_metadata_state(std::shared_ptr<const md::AgentMetadataState> metadata_state) {
     metadata_state_ = metadata_state;
   }
+  const md::AgentMetadataState* metadata_state() const { return metadata_state_.get(); }
 
   GRPCRouter* grpc_router() { return grpc_router_; }
 
@@ -210,10 +233,11 @@ class ExecState {
   ml::ModelPool* model_pool_;
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
+  types::AccountingMemoryPool::UPtr exec_mem_pool_;
 
-  int64_t current_source_ = 0;
-  bool current_source_set_ = false;
-  std::map<int64_t, bool> source_id_to_keep_running_map_;
+  absl::Mutex sources_lock_;
+  absl::flat_hash_map<std::thread::id, int64_t> current_sources_ ABSL_GUARDED_BY(sources_lock_);
+  std::map<int64_t, bool> source_id_to_keep_running_map_ ABSL_GUARDED_BY(sources_lock_);
 
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
@@ -26,8 +26,12 @@
 #include <iterator>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include <absl/base/casts.h>
+#include <absl/numeric/int128.h>
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
@@ -172,6 +176,65 @@ Status ScalarExpressionEvaluator::InitFuncsInExpression(
   return Status::OK();
 }
 
+namespace {
+
+std::string ScalarValueKey(const plan::ScalarValue& val) {
+  if (val.IsNull()) {
+    return "n";
+  }
+  switch (val.DataType()) {
+    case types::BOOLEAN:
+      return val.BoolValue() ? "b1" : "b0";
+    case types::INT64:
+      return absl::StrCat("i", val.Int64Value());
+    case types::FLOAT64:
+      return absl::StrCat("d", absl::bit_cast<uint64_t>(val.Float64Value()));
+    case types::STRING: {
+      auto str = val.StringValue();
+      return absl::StrCat("s", str.size(), ":", str);
+    }
+    case types::TIME64NS:
+      return absl::StrCat("t", val.Time64NSValue());
+    case types::UINT128: {
+      auto v = val.UInt128Value();
+      return absl::StrCat("u", absl::Uint128High64(v), ":", absl::Uint128Low64(v));
+    }
+    default:
+      return absl::StrCat("?", reinterpret_cast<uintptr_t>(&val));
+  }
+}
+
+// Returns a key of the expression, which is the same for the expressions that evaluate to the same
+// values, and adds each function call in the expression to the calls with its key.
+std::string ExpressionKey(
+    const plan::ScalarExpression& expr,
+    absl::flat_hash_map<std::string, std::vector<const plan::ScalarExpression*>>* calls_by_key) {
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kConstant:
+      return ScalarValueKey(static_cast<const plan::ScalarValue&>(expr));
+    case plan::Expression::kColumn:
+      return absl::StrCat("c", static_cast<const plan::Column&>(expr).Index());
+    case plan::Expression::kFunc: {
+      const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+      std::string key = absl::StrCat("f", fn.udf_id(), "<");
+      for (const auto& init_arg : fn.init_arguments()) {
+        absl::StrAppend(&key, ScalarValueKey(init_arg), ",");
+      }
+      absl::StrAppend(&key, ">(");
+      for (const auto& arg : fn.arg_deps()) {
+        absl::StrAppend(&key, ExpressionKey(*arg, calls_by_key), ",");
+      }
+      absl::StrAppend(&key, ")");
+      (*calls_by_key)[key].push_back(&expr);
+      return key;
+    }
+    default:
+      return absl::StrCat("?", reinterpret_cast<uintptr_t>(&expr));
+  }
+}
+
+}  // namespace
+
 Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
     auto udf = kv.second->Make();
@@ -180,9 +243,28 @@ Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (auto expr : expressions_) {
     PL_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
   }
+  FindSharedSubexpressions();
   return Status::OK();
 }
 
+void VectorNativeScalarExpressionEvaluator::FindSharedSubexpressions() {
+  absl::flat_hash_map<std::string, std::vector<const plan::ScalarExpression*>> calls_by_key;
+  for (const auto& expr : expressions_) {
+    ExpressionKey(*expr, &calls_by_key);
+  }
+  shared_subexpressions_.clear();
+  num_shared_subexpressions_ = 0;
+  for (const auto& [key, calls] : calls_by_key) {
+    if (calls.size() < 2) {
+      continue;
+    }
+    for (const auto* call : calls) {
+      shared_subexpressions_[call] = num_shared_subexpressions_;
+    }
+    ++num_shared_subexpressions_;
+  }
+}
+
 Status VectorNativeScalarExpressionEvaluator::Close(ExecState*) {
   // Nothing here yet.
   return Status();
@@ -211,7 +293,7 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
       [&](const plan::Column& col,
           const std::vector<types::SharedColumnWrapper>& children) -> types::SharedColumnWrapper {
         DCHECK_EQ(children.size(), 0ULL);
-        return ColumnWrapper::FromArrow(input.ColumnAt(col.Index()));
+        return ColumnWrapper::ViewArrow(input.ColumnAt(col.Index()));
       });
 
   walker.OnScalarFunc(
@@ -240,6 +322,78 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   return walker.Walk(expr);
 }
 
+Status VectorNativeScalarExpressionEvaluator::Evaluate(ExecState* exec_state,
+                                                       const RowBatch& input, RowBatch* output) {
+  subexpression_results_.assign(num_shared_subexpressions_, nullptr);
+  auto s = ScalarExpressionEvaluator::Evaluate(exec_state, input, output);
+  subexpression_results_.clear();
+  return s;
+}
+
+StatusOr<types::SharedColumnWrapper>
+VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
+    ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr) {
+  CHECK(exec_state != nullptr);
+  CHECK_GT(input.num_columns(), 0);
+  // Results are only shared between the expressions of a single call to Evaluate().
+  subexpression_results_.assign(num_shared_subexpressions_, nullptr);
+  auto result = EvaluateExpression(exec_state, input, expr);
+  subexpression_results_.clear();
+  return result;
+}
+
+StatusOr<types::SharedColumnWrapper> VectorNativeScalarExpressionEvaluator::EvaluateExpression(
+    ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr) {
+  size_t num_rows = input.num_rows();
+
+  // The Arrow arrays are converted to type erased column wrappers and then evaluated.
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kConstant:
+      return EvalScalarToColumnWrapper(exec_state, static_cast<const plan::ScalarValue&>(expr),
+                                       num_rows);
+    case plan::Expression::kColumn:
+      // The UDFs only read their inputs, so the column's data is used in place.
+      return ColumnWrapper::ViewArrow(
+          input.ColumnAt(static_cast<const plan::Column&>(expr).Index()));
+    case plan::Expression::kFunc:
+      break;
+    default:
+      return error::Internal("Unsupported expression: $0", expr.DebugString());
+  }
+
+  // A function call that is in more than one place is only evaluated the first time.
+  auto shared = shared_subexpressions_.find(&expr);
+  bool cached = shared != shared_subexpressions_.end() && !subexpression_results_.empty();
+  if (cached && subexpression_results_[shared->second] != nullptr) {
+    return subexpression_results_[shared->second];
+  }
+
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  std::vector<types::SharedColumnWrapper> children;
+  children.reserve(fn.arg_deps().size());
+  for (const auto& arg : fn.arg_deps()) {
+    PL_ASSIGN_OR_RETURN(auto child, EvaluateExpression(exec_state, input, *arg));
+    children.push_back(std::move(child));
+  }
+
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  auto udf = id_to_udf_map_[fn.udf_id()].get();
+
+  std::vector<const types::ColumnWrapper*> raw_children;
+  raw_children.reserve(children.size());
+  for (const auto& child : children) {
+    raw_children.emplace_back(child.get());
+  }
+  auto output = types::ColumnWrapper::Make(def->exec_return_type(), num_rows);
+  // TODO(zasgar): need a better way to handle errors.
+  PL_CHECK_OK(def->ExecBatch(udf, function_ctx_, raw_children, output.get(), num_rows));
+
+  if (cached) {
+    subexpression_results_[shared->second] = output;
+  }
+  return output;
+}
+
 Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr,
     RowBatch* output) {
@@ -268,9 +422,10 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     return Status::OK();
   }
 
-  PL_ASSIGN_OR_RETURN(auto result, VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
-                                       exec_state, input, expr));
-  PL_RETURN_IF_ERROR(output->AddColumn(result->ConvertToArrow(exec_state->exec_mem_pool())));
+  PL_ASSIGN_OR_RETURN(auto result, EvaluateExpression(exec_state, input, expr));
+  // The result is not modified after this, so fixed size results are handed to arrow as they are.
+  PL_RETURN_IF_ERROR(
+      output->AddColumn(ColumnWrapper::ShareAsArrow(result, exec_state->exec_mem_pool())));
   return Status::OK();
 }
 
@@ -320,7 +475,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
         auto udf = id_to_udf_map_[fn.udf_id()].get();
 
-        auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
+        auto output = MakeArrowBuilder(def->exec_return_type(), exec_state->exec_mem_pool());
 
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
@@ -26,6 +26,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -141,14 +143,37 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
   Status Open(ExecState* exec_state) override;
   Status Close(ExecState* exec_state) override;
 
+  /**
+   * Evaluate evaluates each function call that the expressions share, with the same arguments,
+   * only once for the batch.
+   */
+  Status Evaluate(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                  table_store::schema::RowBatch* output) override;
+
   StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
       ExecState* exec_state, const table_store::schema::RowBatch& input,
       const plan::ScalarExpression& expr);
 
+  // The number of distinct function calls that are in more than one place in the expressions.
+  size_t num_shared_subexpressions() const { return num_shared_subexpressions_; }
+
  protected:
   Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
                                   const plan::ScalarExpression& expr,
                                   table_store::schema::RowBatch* output) override;
+
+ private:
+  void FindSharedSubexpressions();
+  StatusOr<types::SharedColumnWrapper> EvaluateExpression(
+      ExecState* exec_state, const table_store::schema::RowBatch& input,
+      const plan::ScalarExpression& expr);
+
+  // The function calls that are in more than one place, mapped to the index of their result, which
+  // is the same for all of the calls of the same function with the same arguments.
+  absl::flat_hash_map<const plan::ScalarExpression*, size_t> shared_subexpressions_;
+  size_t num_shared_subexpressions_ = 0;
+  // The results of the shared function calls for the batch being evaluated, once evaluated.
+  std::vector<types::SharedColumnWrapper> subexpression_results_;
 };
 
 /**
@@ -149,3 +149,59 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+
+// Evaluates several copies of the same expression, as a map that calls the same function in
+// several of its columns does.
+// NOLINTNEXTLINE : runtime/references.
+void BM_ScalarExpressionsShared(benchmark::State& state, const char* pbtxt) {
+  px::carnot::planpb::ScalarExpression se_pb;
+  size_t data_size = state.range(0);
+  size_t num_exprs = state.range(1);
+
+  google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb);
+  px::carnot::plan::ConstScalarExpressionVector exprs;
+  for (size_t i = 0; i < num_exprs; ++i) {
+    auto s_or_se = px::carnot::plan::ScalarExpression::FromProto(se_pb);
+    CHECK(s_or_se.ok());
+    exprs.push_back(s_or_se.ConsumeValueOrDie());
+  }
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  PL_CHECK_OK(func_registry->Register<AddUDF>("add"));
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+  EXPECT_OK(exec_state->AddScalarUDF(
+      0, "add",
+      std::vector<px::types::DataType>({px::types::DataType::INT64, px::types::DataType::INT64})));
+
+  auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
+  auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
+
+  RowDescriptor rd({DataType::INT64, DataType::INT64});
+  auto input_rb = std::make_unique<RowBatch>(rd, in1.size());
+
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+
+  RowDescriptor rd_output(std::vector<DataType>(num_exprs, DataType::INT64));
+  auto function_ctx = std::make_unique<px::carnot::udf::FunctionContext>(nullptr, nullptr);
+  auto evaluator = ScalarExpressionEvaluator::Create(
+      exprs, ScalarExpressionEvaluatorType::kVectorNative, function_ctx.get());
+  PL_CHECK_OK(evaluator->Open(exec_state.get()));
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    RowBatch output_rb(rd_output, input_rb->num_rows());
+    PL_CHECK_OK(evaluator->Evaluate(exec_state.get(), *input_rb, &output_rb));
+
+    benchmark::DoNotOptimize(output_rb);
+    CHECK_EQ(static_cast<size_t>(output_rb.ColumnAt(0)->length()), data_size);
+  }
+  PL_CHECK_OK(evaluator->Close(exec_state.get()));
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * in1.size() * sizeof(int64_t));
+}
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionsShared, add_nested_native, kAddScalarFuncNestedPbtxt)
+    ->RangeMultiplier(2)
+    ->Ranges({{1 << 10, 1 << 16}, {1, 8}});
@@ -218,6 +218,33 @@ TEST_P(ScalarExpressionTest, eval_add_nested) {
   EXPECT_EQ(1345, casted->Value(2));
 }
 
+TEST_P(ScalarExpressionTest, eval_shared_subexpressions) {
+  RowDescriptor rd_output({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64,
+                           types::DataType::INT64});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  // The nested add, and the add within it, are in two of the expressions. The add of a constant
+  // is to a different column than the one within the nested add.
+  auto evaluator = RunEvaluator(
+      {ScalarExpressionOf(kAddScalarFuncNestedPbtxt), ScalarExpressionOf(kAddScalarFuncConstPbtxt),
+       ScalarExpressionOf(kAddScalarFuncNestedPbtxt), AddScalarExpr()},
+      &output_rb);
+  if (GetParam() == ScalarExpressionEvaluatorType::kVectorNative) {
+    EXPECT_EQ(2U, static_cast<VectorNativeScalarExpressionEvaluator*>(evaluator.get())
+                     ->num_shared_subexpressions());
+  }
+
+  std::vector<std::vector<int64_t>> expected = {
+      {1341, 1343, 1345}, {1338, 1339, 1340}, {1341, 1343, 1345}, {4, 6, 8}};
+  for (size_t col_idx = 0; col_idx < expected.size(); ++col_idx) {
+    auto casted = static_cast<arrow::Int64Array*>(output_rb.ColumnAt(col_idx).get());
+    ASSERT_EQ(3, casted->length());
+    for (int64_t row_idx = 0; row_idx < 3; ++row_idx) {
+      EXPECT_EQ(expected[col_idx][row_idx], casted->Value(row_idx));
+    }
+  }
+}
+
 TEST_P(ScalarExpressionTest, eval_uint128_constant) {
   RowDescriptor rd_output({types::DataType::UINT128});
   RowBatch output_rb(rd_output, input_rb_->num_rows());
@@ -22,6 +22,7 @@
 #include <arrow/array/builder_binary.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -29,6 +30,7 @@
 
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/exec/row_selection.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/carnot/udf/udf_wrapper.h"
@@ -39,6 +41,11 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_double(carnot_filter_selection_min_density,
+              gflags::DoubleFromEnv("PL_CARNOT_FILTER_SELECTION_MIN_DENSITY", 0.25),
+              "The fraction of the rows of a batch that must pass a filter for it to pass on the "
+              "input arrays with a selection of the rows, rather than copying them.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -75,60 +82,6 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
-template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-  PL_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
-    }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PL_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
-
-template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  size_t reserved =
-      100;  // This can be an arbritrary number, since we do exponential doubling below.
-  size_t total_size = 0;
-
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-
-  PL_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  PL_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PL_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
-    }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PL_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
-
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
@@ -140,34 +93,46 @@ Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, si
 
   const types::BoolValueColumnWrapper& pred_col_wrapper =
       *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
-  size_t num_pred = pred_col_wrapper.Size();
-
-  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
-
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
-  for (size_t i = 0; i < num_pred; ++i) {
-    if (pred_col_wrapper[i].val) {
-      ++num_output_records;
+  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), pred_col_wrapper.Size());
+
+  // Find the rows that returned true, out of the ones selected by the parent, if any.
+  auto selection = std::make_shared<std::vector<int64_t>>();
+  selection->reserve(rb.num_selected_rows());
+  if (rb.has_selection()) {
+    for (auto row_idx : *rb.selection()) {
+      if (pred_col_wrapper[row_idx].val) {
+        selection->push_back(row_idx);
+      }
+    }
+  } else {
+    for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      if (pred_col_wrapper[row_idx].val) {
+        selection->push_back(row_idx);
+      }
     }
   }
 
-  RowBatch output_rb(*output_descriptor_, num_output_records);
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
-
-  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
-    auto input_col = rb.ColumnAt(input_col_idx);
-    auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PL_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
-    PL_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
-#undef TYPE_CASE
+  RowBatch selected_rb(*output_descriptor_, rb.num_rows());
+  for (auto input_col_idx : plan_node_->selected_cols()) {
+    PL_RETURN_IF_ERROR(selected_rb.AddColumn(rb.ColumnAt(input_col_idx)));
   }
-
-  output_rb.set_eow(rb.eow());
-  output_rb.set_eos(rb.eos());
-  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-  return Status::OK();
+  selected_rb.set_eow(rb.eow());
+  selected_rb.set_eos(rb.eos());
+
+  // Pass on the input arrays when all of their rows pass, or with a selection when enough of them
+  // do. Copying is cheaper than carrying around a selection of only a few rows, though.
+  auto num_output_records = static_cast<int64_t>(selection->size());
+  if (num_output_records == rb.num_rows()) {
+    return SendRowBatchToChildren(exec_state, selected_rb);
+  }
+  if (num_output_records >= FLAGS_carnot_filter_selection_min_density * rb.num_rows()) {
+    selected_rb.set_selection(std::move(selection));
+    return SendRowBatchToChildren(exec_state, selected_rb);
+  }
+  PL_ASSIGN_OR_RETURN(auto output_rb,
+                      TakeRows(selected_rb, *selection, exec_state->exec_mem_pool()));
+  return SendRowBatchToChildren(exec_state, *output_rb);
 }
 
 }  // namespace exec
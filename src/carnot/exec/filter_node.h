@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <gflags/gflags.h>
 #include <stddef.h>
 #include <memory>
 #include <string>
@@ -32,6 +33,8 @@
 #include "src/common/base/status.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_double(carnot_filter_selection_min_density);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -41,6 +44,8 @@ class FilterNode : public ProcessingNode {
   FilterNode() = default;
   virtual ~FilterNode() = default;
 
+  bool SupportsSelection() const override { return true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -111,6 +111,39 @@ TEST_F(FilterNodeTest, basic) {
       .Close();
 }
 
+TEST_F(FilterNodeTest, input_with_selection) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  // The output is the same whether the filter passes on a selection, which the child compacts, or
+  // copies the rows itself.
+  for (double min_density : {0.0, 1.0}) {
+    gflags::FlagSaver flag_saver;
+    FLAGS_carnot_filter_selection_min_density = min_density;
+
+    auto input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                        .AddColumn<types::Int64Value>({1, 1, 1, 4})
+                        .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                        .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                        .get();
+    input_rb.set_selection(std::make_shared<std::vector<int64_t>>(std::vector<int64_t>{1, 2, 3}));
+
+    auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+        *plan_node_, output_rd, {input_rd}, exec_state_.get());
+    tester.ConsumeNext(input_rb, 0)
+        .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                            .AddColumn<types::Int64Value>({1, 1})
+                            .AddColumn<types::Int64Value>({3, 6})
+                            .AddColumn<types::StringValue>({"DEF", "HELLO"})
+                            .get())
+        .Close();
+  }
+}
+
 TEST_F(FilterNodeTest, column_selection) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
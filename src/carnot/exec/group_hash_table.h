@@ -0,0 +1,202 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <farmhash.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/row_tuple.h"
+#include "src/common/base/base.h"
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * HashColumn combines the hash of each value of the column into the hash of its row, so that a
+ * batch is hashed a column at a time. Fixed size values are hashed by their bytes, which matches
+ * the memcmp equality of RowTuples.
+ */
+template <types::DataType DT>
+void HashColumn(const arrow::Array* col, std::vector<uint64_t>* hashes) {
+  auto num_rows = col->length();
+  DCHECK_LE(static_cast<size_t>(num_rows), hashes->size());
+  uint64_t* row_hashes = hashes->data();
+  if constexpr (DT == types::DataType::STRING) {
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      auto val = types::GetStringViewFromArrowArray(col, row_idx);
+      row_hashes[row_idx] =
+          ::px::HashCombine(row_hashes[row_idx], ::util::Hash64(val.data(), val.size()));
+    }
+  } else {
+    using ValueType = typename types::DataTypeTraits<DT>::value_type;
+    using ArrowArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+    auto arr = static_cast<const ArrowArrayType*>(col);
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      ValueType val = types::GetValue(arr, row_idx);
+      row_hashes[row_idx] = ::px::HashCombine(
+          row_hashes[row_idx],
+          ::util::Hash64(reinterpret_cast<const char*>(&val.val), sizeof(val.val)));
+    }
+  }
+}
+
+/**
+ * ColumnValueEq compares the value at a row of a column to the value at an index of a RowTuple.
+ */
+template <types::DataType DT>
+bool ColumnValueEq(const arrow::Array* col, int64_t row_idx, const RowTuple& rt, size_t rt_idx) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  if constexpr (DT == types::DataType::STRING) {
+    return types::GetStringViewFromArrowArray(col, row_idx) == rt.GetValue<ValueType>(rt_idx);
+  } else {
+    using ArrowArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+    ValueType val = types::GetValue(static_cast<const ArrowArrayType*>(col), row_idx);
+    return memcmp(&val.val, &rt.GetValue<ValueType>(rt_idx).val, sizeof(val.val)) == 0;
+  }
+}
+
+// The type of ColumnValueEq<DT>, to pick the comparison of each key column once.
+using ColumnValueEqFn = bool (*)(const arrow::Array* col, int64_t row_idx, const RowTuple& rt,
+                                 size_t rt_idx);
+
+/**
+ * GroupHashTable is an open addressing (linear probing) hash table from group keys to values.
+ *
+ * The table never hashes keys itself: callers compute hashes up front, which lets the aggregate
+ * node hash a whole batch a column at a time, and probe with a key comparison against their own
+ * representation of the key (eg. a row of the input batch), so a key only has to be
+ * materialized when a new group is inserted. Slots hold the hash inline next to the entry index,
+ * so most mismatches are rejected without touching the key.
+ *
+ * Entries are stored densely in insertion order, so iteration cost is proportional to the number
+ * of groups, not the capacity of the table. Pointers to values are only valid until the next
+ * Insert.
+ */
+template <typename TKey, typename TValue>
+class GroupHashTable {
+ public:
+  struct Entry {
+    uint64_t hash;
+    TKey key;
+    TValue value;
+  };
+
+  /**
+   * Finds the value of the key with the given hash.
+   * @param hash The hash of the key.
+   * @param key_eq Called with the stored keys that have the same hash, returns true on a match.
+   * @return The value, or nullptr if the key is not in the table.
+   */
+  template <typename TKeyEq>
+  TValue* Find(uint64_t hash, TKeyEq&& key_eq) {
+    if (slots_.empty()) {
+      return nullptr;
+    }
+    for (size_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+      const Slot& slot = slots_[pos];
+      if (slot.entry == kEmptySlot) {
+        return nullptr;
+      }
+      if (slot.hash == hash) {
+        Entry& entry = entries_[slot.entry];
+        if (key_eq(entry.key)) {
+          return &entry.value;
+        }
+      }
+    }
+  }
+
+  /**
+   * Inserts a key, which must not already be in the table.
+   * @return The inserted value.
+   */
+  TValue* Insert(uint64_t hash, TKey key, TValue value) {
+    if (2 * (entries_.size() + 1) > slots_.size()) {
+      Grow();
+    }
+    InsertSlot(hash, entries_.size());
+    entries_.push_back(Entry{hash, std::move(key), std::move(value)});
+    return &entries_.back().value;
+  }
+
+  /**
+   * Removes all the entries, but keeps the memory of the table for reuse.
+   */
+  void clear() {
+    entries_.clear();
+    for (auto& slot : slots_) {
+      slot.entry = kEmptySlot;
+    }
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  // The bytes of the table itself, not counting memory the keys and values point to.
+  int64_t memory_bytes() const {
+    return slots_.capacity() * sizeof(Slot) + entries_.capacity() * sizeof(Entry);
+  }
+
+  typename std::vector<Entry>::const_iterator begin() const { return entries_.begin(); }
+  typename std::vector<Entry>::const_iterator end() const { return entries_.end(); }
+
+ private:
+  static constexpr int64_t kEmptySlot = -1;
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    uint64_t hash = 0;
+    int64_t entry = kEmptySlot;
+  };
+
+  void InsertSlot(uint64_t hash, int64_t entry) {
+    size_t pos = hash & mask_;
+    while (slots_[pos].entry != kEmptySlot) {
+      pos = (pos + 1) & mask_;
+    }
+    slots_[pos] = Slot{hash, entry};
+  }
+
+  // Doubles the capacity, which is always a power of two, and reinserts the stored hashes.
+  void Grow() {
+    size_t capacity = slots_.empty() ? kMinCapacity : 2 * slots_.size();
+    slots_.assign(capacity, Slot{});
+    mask_ = capacity - 1;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      InsertSlot(entries_[i].hash, i);
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/group_hash_table.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using Table = GroupHashTable<std::string, int64_t>;
+
+int64_t* FindKey(Table* table, uint64_t hash, const std::string& key) {
+  return table->Find(hash, [&](const std::string& stored) { return stored == key; });
+}
+
+TEST(GroupHashTableTest, find_and_insert) {
+  Table table;
+  EXPECT_EQ(nullptr, FindKey(&table, 1, "a"));
+
+  // Use few distinct hashes, so that the table has to probe past collisions and grow.
+  constexpr int64_t kNumKeys = 1000;
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    auto key = std::to_string(i);
+    ASSERT_EQ(nullptr, FindKey(&table, i % 7, key));
+    EXPECT_EQ(i, *table.Insert(i % 7, key, i));
+  }
+  EXPECT_EQ(kNumKeys, static_cast<int64_t>(table.size()));
+
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    auto* val = FindKey(&table, i % 7, std::to_string(i));
+    ASSERT_NE(nullptr, val);
+    EXPECT_EQ(i, *val);
+    // A matching key with a different hash is never compared.
+    EXPECT_EQ(nullptr, FindKey(&table, i % 7 + 7, std::to_string(i)));
+  }
+}
+
+TEST(GroupHashTableTest, iterates_in_insertion_order) {
+  Table table;
+  table.Insert(3, "c", 3);
+  table.Insert(1, "a", 1);
+  table.Insert(2, "b", 2);
+
+  std::vector<std::string> keys;
+  for (const auto& entry : table) {
+    keys.push_back(entry.key);
+    EXPECT_EQ(entry.hash, static_cast<uint64_t>(entry.value));
+  }
+  EXPECT_EQ(std::vector<std::string>({"c", "a", "b"}), keys);
+}
+
+TEST(GroupHashTableTest, clear) {
+  Table table;
+  for (int64_t i = 0; i < 100; ++i) {
+    table.Insert(i, std::to_string(i), i);
+  }
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, FindKey(&table, 5, "5"));
+
+  table.Insert(5, "5", 50);
+  EXPECT_EQ(50, *FindKey(&table, 5, "5"));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include <absl/base/internal/spinlock.h>
@@ -31,10 +32,39 @@
 #include "src/common/base/base.h"
 #include "src/common/uuid/uuid.h"
 
+DEFINE_int64(carnot_grpc_source_buffer_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SOURCE_BUFFER_BYTES", 0),
+             "The bytes of received row batches a GRPC source buffers before the router stops "
+             "reading from its upstream sinks. Unlimited if 0.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+constexpr std::chrono::milliseconds kCreditPollInterval{1};
+
+GRPCSourceQueueMetrics::GRPCSourceQueueMetrics(prometheus::Registry* registry)
+    : queued_batches(prometheus::BuildGauge()
+                         .Name("carnot_grpc_source_queued_batches")
+                         .Help("Row batches received for GRPC sources that have not been read yet")
+                         .Register(*registry)
+                         .Add({})),
+      queued_bytes(prometheus::BuildGauge()
+                       .Name("carnot_grpc_source_queued_bytes")
+                       .Help("Bytes received for GRPC sources that have not been read yet")
+                       .Register(*registry)
+                       .Add({})),
+      credit_waits(prometheus::BuildCounter()
+                       .Name("carnot_grpc_source_credit_waits")
+                       .Help("Times a result stream waited for its GRPC source to have credit")
+                       .Register(*registry)
+                       .Add({})),
+      spilled_bytes(prometheus::BuildCounter()
+                        .Name("carnot_grpc_source_spilled_bytes")
+                        .Help("Bytes received for GRPC sources that were spilled to disk")
+                        .Register(*registry)
+                        .Add({})) {}
+
 GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* query_tracker,
                                                                 int64_t source_id) {
   absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
@@ -58,6 +88,10 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
     // solve this race, We store a backlog of all the pending batches.
     if (snt->source_node == nullptr) {
       snt->connection_initiated_by_sink = true;
+      int64_t num_bytes = req->ByteSizeLong();
+      snt->response_backlog_bytes += num_bytes;
+      queue_metrics_.queued_batches.Increment();
+      queue_metrics_.queued_bytes.Increment(static_cast<double>(num_bytes));
       snt->response_backlog.emplace_back(std::move(req));
       return Status::OK();
     }
@@ -83,6 +117,65 @@ void GRPCRouter::MarkResultStreamClosed(QueryTracker* query_tracker, int64_t sou
   return;
 }
 
+void GRPCRouter::ClearBacklog(SourceNodeTracker* snt) {
+  queue_metrics_.queued_batches.Decrement(static_cast<double>(snt->response_backlog.size()));
+  queue_metrics_.queued_bytes.Decrement(static_cast<double>(snt->response_backlog_bytes));
+  snt->response_backlog.clear();
+  snt->response_backlog_bytes = 0;
+}
+
+bool GRPCRouter::SourceHasCredit(QueryTracker* query_tracker, int64_t source_id) {
+  absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
+  auto it = query_tracker->source_node_trackers.find(source_id);
+  if (it == query_tracker->source_node_trackers.end()) {
+    return true;
+  }
+  auto snt = &it->second;
+  absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+  if (snt->sufficient_results) {
+    return true;
+  }
+  int64_t queued_bytes = snt->source_node == nullptr ? snt->response_backlog_bytes
+                                                     : snt->source_node->queued_bytes();
+  return queued_bytes < FLAGS_carnot_grpc_source_buffer_bytes;
+}
+
+void GRPCRouter::WaitForSourceCredit(QueryTracker* query_tracker, int64_t source_id,
+                                     ::grpc::ServerContext* context) {
+  if (FLAGS_carnot_grpc_source_buffer_bytes <= 0 ||
+      SourceHasCredit(query_tracker, source_id)) {
+    return;
+  }
+  queue_metrics_.credit_waits.Increment();
+  // Deleting the query cancels the context, so this doesn't outlive the source.
+  while (!context->IsCancelled() && !SourceHasCredit(query_tracker, source_id)) {
+    std::this_thread::sleep_for(kCreditPollInterval);
+  }
+}
+
+bool GRPCRouter::SourceHasSufficientResults(QueryTracker* query_tracker, int64_t source_id) {
+  auto snt = GetSourceNodeTracker(query_tracker, source_id);
+  absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+  return snt->sufficient_results;
+}
+
+void GRPCRouter::MarkSourceHasSufficientResults(sole::uuid query_id, int64_t source_id) {
+  std::shared_ptr<QueryTracker> query_tracker;
+  {
+    absl::base_internal::SpinLockHolder lock(&id_to_query_tracker_map_lock_);
+    auto it = id_to_query_tracker_map_.find(query_id);
+    if (it == id_to_query_tracker_map_.end()) {
+      return;
+    }
+    query_tracker = it->second;
+  }
+  auto snt = GetSourceNodeTracker(query_tracker.get(), source_id);
+  absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+  snt->sufficient_results = true;
+  // The source node won't read these anymore.
+  ClearBacklog(snt);
+}
+
 // For all inbound result streams, we want to register the context of the stream,
 // so that if the query gets cancelled, then we can make sure to also cancel the corresponding
 // TransferResultChunk streams for that query.
@@ -141,6 +234,10 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
   if (req->has_query_result() && req->query_result().has_row_batch()) {
     state->stream_has_query_results = true;
     state->source_node_id = req->query_result().grpc_source_id();
+    if (SourceHasSufficientResults(state->query_tracker.get(), state->source_node_id)) {
+      state->sufficient_results = true;
+      return ::grpc::Status::OK;
+    }
     auto s = EnqueueRowBatch(state->query_tracker.get(), std::move(req));
     if (!s.ok()) {
       return ::grpc::Status(grpc::StatusCode::INTERNAL, "failed to enqueue batch");
@@ -176,9 +273,12 @@ std::vector<statuspb::Status> GRPCRouter::GetIncomingWorkerErrors(const sole::uu
   TransferResultChunkState state;
   while (reader->Read(req.get())) {
     result_status = HandleTransferResultChunkMessage(std::move(req), context, &state);
-    if (!result_status.ok()) {
+    if (!result_status.ok() || state.sufficient_results) {
       break;
     }
+    if (state.stream_has_query_results) {
+      WaitForSourceCredit(state.query_tracker.get(), state.source_node_id, context);
+    }
     req = std::make_unique<carnotpb::TransferResultChunkRequest>();
   }
 
@@ -195,6 +295,13 @@ std::vector<statuspb::Status> GRPCRouter::GetIncomingWorkerErrors(const sole::uu
     return ::grpc::Status::OK;
   }
 
+  if (state.sufficient_results) {
+    // The source node has stopped reading, so there is no stream to mark as closed.
+    response->set_success(true);
+    response->set_sufficient_results(true);
+    return ::grpc::Status::OK;
+  }
+
   if (state.stream_has_query_results) {
     MarkResultStreamClosed(state.query_tracker.get(), state.source_node_id);
   }
@@ -224,6 +331,7 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
   snt->source_node = source_node;
+  source_node->set_queue_metrics(&queue_metrics_);
   if (snt->connection_initiated_by_sink) {
     source_node->set_upstream_initiated_connection();
   }
@@ -231,7 +339,7 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
     for (auto& rb : snt->response_backlog) {
       PL_RETURN_IF_ERROR(snt->source_node->EnqueueRowBatch(std::move(rb)));
     }
-    snt->response_backlog.clear();
+    ClearBacklog(snt);
   }
   if (snt->connection_closed_by_sink) {
     source_node->set_upstream_closed_connection();
@@ -275,6 +383,10 @@ Status GRPCRouter::DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id)
     return error::Internal("Query map for query ID $0 does not contain GRPC source $1",
                            query_id.str(), source_id);
   }
+  {
+    absl::base_internal::SpinLockHolder snt_lock(&it->second.node_lock);
+    ClearBacklog(&it->second);
+  }
   query_tracker->source_node_trackers.erase(it);
   return Status::OK();
 }
@@ -295,6 +407,10 @@ void GRPCRouter::DeleteQuery(sole::uuid query_id) {
   }
   absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
   query_tracker->ResetRestartExecutionFunc();
+  for (auto& [source_id, snt] : query_tracker->source_node_trackers) {
+    absl::base_internal::SpinLockHolder snt_lock(&snt.node_lock);
+    ClearBacklog(&snt);
+  }
   // For any active input streams for this query, mark their context as cancelled.
   for (auto ctx : query_tracker->active_agent_contexts) {
     ctx->TryCancel();
@@ -31,14 +31,20 @@
 #include <absl/container/node_hash_map.h>
 #include <absl/hash/hash.h>
 #include <grpcpp/grpcpp.h>
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/common/base/base.h"
 #include "src/common/base/statuspb/status.pb.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/uuid/uuid.h"
 
+DECLARE_int64(carnot_grpc_source_buffer_bytes);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -46,12 +52,27 @@ namespace exec {
 // Forward declaration needed to break circular dependency.
 class GRPCSourceNode;
 
+/**
+ * The depth of the queues of row batches received by the router that have not been read by their
+ * source nodes yet, summed over all queries.
+ */
+struct GRPCSourceQueueMetrics {
+  explicit GRPCSourceQueueMetrics(prometheus::Registry* registry);
+
+  prometheus::Gauge& queued_batches;
+  prometheus::Gauge& queued_bytes;
+  prometheus::Counter& credit_waits;
+  prometheus::Counter& spilled_bytes;
+};
+
 /**
  * GRPCRouter tracks incoming Kelvin connections and routes them to the appropriate Carnot source
  * node.
  */
 class GRPCRouter final : public carnotpb::ResultSinkService::Service {
  public:
+  GRPCRouter() : queue_metrics_(&GetMetricsRegistry()) {}
+
   /**
    * TransferResultChunk implements the RPC method.
    */
@@ -67,6 +88,13 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   Status AddGRPCSourceNode(sole::uuid query_id, int64_t source_id, GRPCSourceNode* source_node,
                            std::function<void()> restart_execution);
 
+  /**
+   * Marks that the specified source node needs no more results, for example because a limit after
+   * it was reached. Streams to the source are closed on their next row batch, and the sender is
+   * told that it can stop producing results.
+   */
+  void MarkSourceHasSufficientResults(sole::uuid query_id, int64_t source_id);
+
   /**
    * Delete all the metadata and backlog data for a query. Deleting a non-existing query is ignored.
    * @param query_id
@@ -103,6 +131,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    */
   size_t NumQueriesTracking() const;
 
+  GRPCSourceQueueMetrics* queue_metrics() { return &queue_metrics_; }
+
  private:
   /**
    * SourceNodeTracker is responsible for tracking a single source node and the backlog of messages
@@ -116,8 +146,11 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     // respectively.
     bool connection_initiated_by_sink GUARDED_BY(node_lock) = false;
     bool connection_closed_by_sink GUARDED_BY(node_lock) = false;
+    // True when the source node doesn't need any more row batches.
+    bool sufficient_results GUARDED_BY(node_lock) = false;
     std::vector<std::unique_ptr<::px::carnotpb::TransferResultChunkRequest>> response_backlog
         GUARDED_BY(node_lock);
+    int64_t response_backlog_bytes GUARDED_BY(node_lock) = 0;
     absl::base_internal::SpinLock node_lock;
   };
 
@@ -165,6 +198,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     // stream_has_query_results informs downstream source nodes about the health of the stream.
     // When true, the particular TransferResultChunk call has initiated the query stream.
     bool stream_has_query_results = false;
+    // True when the destination source node doesn't need any more results from this stream.
+    bool sufficient_results = false;
     std::shared_ptr<QueryTracker> query_tracker = nullptr;
   };
   ::grpc::Status HandleTransferResultChunkMessage(
@@ -172,6 +207,15 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
       ::grpc::ServerContext* context, TransferResultChunkState* state);
 
   void MarkResultStreamClosed(QueryTracker* query_tracker, int64_t source_id);
+  void ClearBacklog(SourceNodeTracker* snt) ABSL_EXCLUSIVE_LOCKS_REQUIRED(snt->node_lock);
+  // Whether the source has room in its buffer for another row batch. Sources without a tracker
+  // or which don't need more results always have credit.
+  bool SourceHasCredit(QueryTracker* query_tracker, int64_t source_id);
+  // Blocks the stream until the source has credit. Not reading the stream applies gRPC flow
+  // control, which in turn blocks the upstream GRPCSinkNode's writes.
+  void WaitForSourceCredit(QueryTracker* query_tracker, int64_t source_id,
+                           ::grpc::ServerContext* context);
+  bool SourceHasSufficientResults(QueryTracker* query_tracker, int64_t source_id);
   void RegisterResultStreamContext(QueryTracker* query_tracker, ::grpc::ServerContext* context);
   void MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                                          ::grpc::ServerContext* context);
@@ -180,6 +224,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   absl::node_hash_map<sole::uuid, std::shared_ptr<QueryTracker>> id_to_query_tracker_map_
       GUARDED_BY(id_to_query_tracker_map_lock_);
   mutable absl::base_internal::SpinLock id_to_query_tracker_map_lock_;
+
+  GRPCSourceQueueMetrics queue_metrics_;
 };
 
 }  // namespace exec
@@ -218,6 +218,50 @@ TEST_F(GRPCRouterTest, basic_router_test) {
   EXPECT_TRUE(source_node.upstream_closed_connection());
 }
 
+TEST_F(GRPCRouterTest, sufficient_results_router_test) {
+  int64_t grpc_source_node_id = 1;
+  auto query_id = sole::uuid4();
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<px::carnot::plan::Operator> plan_node =
+      plan::GRPCSourceOperator::FromProto(op_proto, grpc_source_node_id);
+  auto source_node = FakeGRPCSourceNode();
+  ASSERT_OK(source_node.Init(*plan_node, input_rd, {}));
+  ASSERT_OK(service_->AddGRPCSourceNode(query_id, grpc_source_node_id, &source_node, [] {}));
+
+  // For example, a limit after the source was reached.
+  service_->MarkSourceHasSufficientResults(query_id, grpc_source_node_id);
+
+  carnotpb::TransferResultChunkRequest initiate_stream_req;
+  ToProto(query_id, initiate_stream_req.mutable_query_id());
+  *initiate_stream_req.mutable_initiate_conn() =
+      carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+  auto rb = RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                .AddColumn<types::Int64Value>({1, 2})
+                .get();
+  carnotpb::TransferResultChunkRequest rb_req;
+  EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+  rb_req.mutable_query_result()->set_grpc_source_id(grpc_source_node_id);
+  ToProto(query_id, rb_req.mutable_query_id());
+
+  carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub_->TransferResultChunk(&context, &response);
+  writer->Write(initiate_stream_req);
+  writer->Write(rb_req);
+  writer->WritesDone();
+  auto writer_s = writer->Finish();
+  EXPECT_TRUE(writer_s.ok()) << writer_s.error_message();
+
+  // The stream is closed early, and tells the sender to stop.
+  EXPECT_TRUE(response.success());
+  EXPECT_TRUE(response.sufficient_results());
+  EXPECT_EQ(0, source_node.row_batches.size());
+  EXPECT_FALSE(source_node.upstream_closed_connection());
+}
+
 TEST_F(GRPCRouterTest, router_and_stats_test) {
   int64_t grpc_source_node_id = 1;
   uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
@@ -436,6 +480,91 @@ TEST_F(GRPCRouterTest, threaded_router_test) {
   read_thread.join();
 }
 
+TEST_F(GRPCRouterTest, source_credit_router_test) {
+  gflags::FlagSaver flag_saver;
+  // Any queued batch uses up the credits, so the router reads one batch at a time.
+  FLAGS_carnot_grpc_source_buffer_bytes = 1;
+
+  uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
+  auto query_uuid = sole::rebuild(ab, cd);
+
+  auto func_registry_ = std::make_unique<udf::Registry>("test_registry");
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry_.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  MockExecNode mock_child;
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<px::carnot::plan::Operator> plan_node =
+      plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  auto source_node = GRPCSourceNode();
+  ASSERT_OK(source_node.Init(*plan_node, input_rd, {}));
+  source_node.AddChild(&mock_child, 0);
+  ASSERT_OK(source_node.Open(exec_state.get()));
+  ASSERT_OK(source_node.Prepare(exec_state.get()));
+
+  FakePlanNode fake_plan_node(111);
+  // Silence GMOCK warnings.
+  EXPECT_CALL(mock_child, InitImpl(::testing::_));
+  EXPECT_CALL(mock_child, PrepareImpl(::testing::_));
+  EXPECT_CALL(mock_child, OpenImpl(::testing::_));
+  ASSERT_OK(mock_child.Init(fake_plan_node, RowDescriptor({}), {}));
+  ASSERT_OK(mock_child.Open(exec_state.get()));
+  ASSERT_OK(mock_child.Prepare(exec_state.get()));
+
+  ASSERT_OK(service_->AddGRPCSourceNode(query_uuid, /* source_id */ 0, &source_node, [] {}));
+
+  px::carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub_->TransferResultChunk(&context, &response);
+
+  carnotpb::TransferResultChunkRequest initiate_stream_req0;
+  auto query_id = initiate_stream_req0.mutable_query_id();
+  query_id->set_high_bits(ab);
+  query_id->set_low_bits(cd);
+  *initiate_stream_req0.mutable_initiate_conn() =
+      carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+  constexpr int kNumBatches = 10;
+  std::thread write_thread([&] {
+    writer->Write(initiate_stream_req0);
+    for (int idx = 0; idx < kNumBatches; ++idx) {
+      bool last = idx == kNumBatches - 1;
+      auto rb = RowBatchBuilder(input_rd, /*size*/ 1, /*eow*/ last, /*eos*/ last)
+                    .AddColumn<types::Int64Value>({idx})
+                    .get();
+      carnotpb::TransferResultChunkRequest rb_req;
+      EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+      rb_req.mutable_query_result()->set_grpc_source_id(0);
+      auto query_id = rb_req.mutable_query_id();
+      query_id->set_high_bits(ab);
+      query_id->set_low_bits(cd);
+      writer->Write(rb_req);
+    }
+    writer->WritesDone();
+    writer->Finish();
+  });
+
+  EXPECT_CALL(mock_child, ConsumeNextImpl(::testing::_, ::testing::_, ::testing::_))
+      .Times(kNumBatches)
+      .WillRepeatedly(::testing::Return(Status::OK()));
+  while (source_node.HasBatchesRemaining()) {
+    if (!source_node.NextBatchReady()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    EXPECT_EQ(1, source_node.queued_batches());
+    ASSERT_OK(source_node.GenerateNext(exec_state.get()));
+  }
+  write_thread.join();
+
+  EXPECT_EQ(0, source_node.queued_bytes());
+  EXPECT_TRUE(response.success());
+}
+
 TEST_F(GRPCRouterTest, delete_query_router_test) {
   int64_t grpc_source_node_id = 1;
   uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
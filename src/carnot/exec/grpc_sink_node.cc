@@ -31,6 +31,18 @@
 #include "src/common/uuid/uuid_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_grpc_sink_coalesce_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SINK_COALESCE_BYTES", 0),
+             "Row batches smaller than this are merged into a single TransferResultChunk request "
+             "of up to this many bytes before being sent. Disabled if 0.");
+DEFINE_int64(carnot_grpc_sink_coalesce_ms,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SINK_COALESCE_MS", 100),
+             "The longest a coalesced row batch waits to be sent, in milliseconds.");
+DEFINE_string(carnot_grpc_sink_compression,
+              gflags::StringFromEnv("PL_CARNOT_GRPC_SINK_COMPRESSION", ""),
+              "The message compression (gzip or deflate) used by GRPC sinks that send to another "
+              "Carnot instance. Uncompressed if empty.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -38,6 +50,24 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+namespace {
+
+StatusOr<grpc_compression_algorithm> CompressionAlgorithm(const std::string& name) {
+  if (name.empty()) {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (name == "gzip") {
+    return GRPC_COMPRESS_GZIP;
+  }
+  if (name == "deflate") {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  return error::InvalidArgument("Unknown GRPC sink compression '$0', expected gzip or deflate",
+                                name);
+}
+
+}  // namespace
+
 std::string GRPCSinkNode::DebugStringImpl() {
   std::string destination;
   if (plan_node_->has_table_name()) {
@@ -68,10 +98,16 @@ StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
 }
 
 Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
-  if (sent_eos_ || cancelled_) {
+  if (sent_eos_ || cancelled_ || sufficient_results_) {
     return Status::OK();
   }
 
+  if (coalesced_req_ != nullptr &&
+      std::chrono::steady_clock::now() - coalesced_since_ >=
+          std::chrono::milliseconds(FLAGS_carnot_grpc_sink_coalesce_ms)) {
+    PL_RETURN_IF_ERROR(FlushCoalescedBatches(exec_state));
+  }
+
   auto time_now = std::chrono::system_clock::now();
   auto since_last_flush =
       std::chrono::duration_cast<std::chrono::milliseconds>(time_now - last_send_time_);
@@ -99,6 +135,7 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+  PL_RETURN_IF_ERROR(CompressionAlgorithm(FLAGS_carnot_grpc_sink_compression).status());
   return Status::OK();
 }
 
@@ -126,6 +163,14 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
     // Adding auth to GRPC client.
     exec_state->AddAuthToGRPCClientContext(context_.get());
   }
+  // Only another Carnot instance is known to accept compressed messages. The algorithm was
+  // validated in InitImpl.
+  if (plan_node_->has_grpc_source_id()) {
+    auto algorithm = CompressionAlgorithm(FLAGS_carnot_grpc_sink_compression);
+    if (algorithm.ok() && algorithm.ValueOrDie() != GRPC_COMPRESS_NONE) {
+      context_->set_compression_algorithm(algorithm.ValueOrDie());
+    }
+  }
 
   response_.Clear();
   writer_ = stub_->TransferResultChunk(context_.get(), &response_);
@@ -153,6 +198,17 @@ Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
       plan_node_->id(), exec_state->query_id().str(), plan_node_->address());
 }
 
+void GRPCSinkNode::StopOnSufficientResults(ExecState* exec_state) {
+  VLOG(1) << absl::Substitute(
+      "GRPCSinkNode $0 of query $1: destination $2 has sufficient results, stopping $3 sources",
+      plan_node_->id(), exec_state->query_id().str(), plan_node_->address(),
+      abortable_srcs_.size());
+  sufficient_results_ = true;
+  for (const auto src_id : abortable_srcs_) {
+    exec_state->StopSource(src_id);
+  }
+}
+
 Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
                                      const carnotpb::TransferResultChunkRequest& req) {
   if (writer_->Write(req)) {
@@ -164,6 +220,10 @@ Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
   // connection just died.
   writer_->WritesDone();
   auto s = writer_->Finish();
+  if (s.ok() && response_.sufficient_results()) {
+    StopOnSufficientResults(exec_state);
+    return Status::OK();
+  }
   // If the Finish call was successful, then the server closed the connection and sent a response,
   // in which case we shouldn't try to reconnect. If there's an error from the server side
   // other than a RST_STREAM, we also shouldn't retry.
@@ -200,7 +260,7 @@ Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
 }
 
 Status GRPCSinkNode::CloseImpl(ExecState* exec_state) {
-  if (sent_eos_ || cancelled_) {
+  if (sent_eos_ || cancelled_ || sufficient_results_) {
     return Status::OK();
   }
 
@@ -303,6 +363,12 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
 }
 
 Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
+  if (FLAGS_carnot_grpc_sink_coalesce_bytes > 0 &&
+      rb.NumBytes() < FLAGS_carnot_grpc_sink_coalesce_bytes) {
+    return CoalesceBatch(exec_state, rb);
+  }
+  // Batches that were coalesced before this one must arrive first.
+  PL_RETURN_IF_ERROR(FlushCoalescedBatches(exec_state));
   if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
     return SplitAndSendBatch(exec_state, rb, parent_idx);
   }
@@ -310,13 +376,71 @@ Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
 }
 
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
+  // The destination has stopped reading, so the remaining batches are dropped.
+  if (sufficient_results_) {
+    return Status::OK();
+  }
   PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PL_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  auto rb_proto = req.mutable_query_result()->mutable_row_batch();
+  PL_RETURN_IF_ERROR(plan_node_->arrow_row_batches() ? rb.ToArrowProto(rb_proto)
+                                                     : rb.ToProto(rb_proto));
+  return SendRequest(exec_state, req, rb.eos());
+}
+
+Status GRPCSinkNode::CoalesceBatch(ExecState* exec_state, const RowBatch& rb) {
+  if (sufficient_results_) {
+    return Status::OK();
+  }
+  // Always uses the typed columns, whose values are appended when merged, unlike the bytes of
+  // arrow columns.
+  table_store::schemapb::RowBatchData rb_proto;
+  PL_RETURN_IF_ERROR(rb.ToProto(&rb_proto));
+
+  if (coalesced_req_ == nullptr) {
+    PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
+    coalesced_req_ = std::make_unique<carnotpb::TransferResultChunkRequest>(std::move(req));
+    *coalesced_req_->mutable_query_result()->mutable_row_batch() = std::move(rb_proto);
+    coalesced_bytes_ = 0;
+    coalesced_since_ = std::chrono::steady_clock::now();
+  } else {
+    auto pending = coalesced_req_->mutable_query_result()->mutable_row_batch();
+    DCHECK_EQ(pending->cols_size(), rb_proto.cols_size());
+    // Merging a column appends the values of its repeated data field.
+    for (int i = 0; i < rb_proto.cols_size(); ++i) {
+      pending->mutable_cols(i)->MergeFrom(rb_proto.cols(i));
+    }
+    pending->set_num_rows(pending->num_rows() + rb_proto.num_rows());
+    pending->set_eow(rb_proto.eow());
+    pending->set_eos(rb_proto.eos());
+  }
+  coalesced_bytes_ += rb.NumBytes();
+
+  if (rb.eow() || rb.eos() || coalesced_bytes_ >= FLAGS_carnot_grpc_sink_coalesce_bytes ||
+      std::chrono::steady_clock::now() - coalesced_since_ >=
+          std::chrono::milliseconds(FLAGS_carnot_grpc_sink_coalesce_ms)) {
+    return FlushCoalescedBatches(exec_state);
+  }
+  return Status::OK();
+}
+
+Status GRPCSinkNode::FlushCoalescedBatches(ExecState* exec_state) {
+  if (coalesced_req_ == nullptr) {
+    return Status::OK();
+  }
+  auto req = std::move(coalesced_req_);
+  coalesced_bytes_ = 0;
+  if (sufficient_results_) {
+    return Status::OK();
+  }
+  return SendRequest(exec_state, *req, req->query_result().row_batch().eos());
+}
 
+Status GRPCSinkNode::SendRequest(ExecState* exec_state,
+                                 const carnotpb::TransferResultChunkRequest& req, bool eos) {
   PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
 
-  if (!rb.eos()) {
+  if (!eos || sufficient_results_) {
     return Status::OK();
   }
 
@@ -22,6 +22,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <grpcpp/grpcpp.h>
@@ -35,6 +36,10 @@
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_int64(carnot_grpc_sink_coalesce_bytes);
+DECLARE_int64(carnot_grpc_sink_coalesce_ms);
+DECLARE_string(carnot_grpc_sink_compression);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -61,6 +66,16 @@ class GRPCSinkNode : public SinkNode {
   // Used to check the downstream connection after connection_check_timeout_ has elapsed.
   Status OptionallyCheckConnection(ExecState* exec_state);
 
+  /**
+   * Sets the sources that only feed this sink, which are stopped once the destination of this sink
+   * has sufficient results.
+   */
+  void set_abortable_srcs(std::vector<int64_t> abortable_srcs) {
+    abortable_srcs_ = std::move(abortable_srcs);
+  }
+  // Whether the destination closed the stream because it needs no more results.
+  bool sufficient_results() const { return sufficient_results_; }
+
   void testing_set_connection_check_timeout(const std::chrono::milliseconds& timeout) {
     connection_check_timeout_ = timeout;
   }
@@ -89,9 +104,19 @@ class GRPCSinkNode : public SinkNode {
   Status StartConnection(ExecState* exec_state);
   Status StartConnectionWithRetries(ExecState* exec_state, size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
+  void StopOnSufficientResults(ExecState* exec_state);
   Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  // Writes a request holding a row batch, and closes the stream if the batch is the last one.
+  Status SendRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req,
+                     bool eos);
+  // Appends a small row batch to the pending request, which is flushed once it is big or old
+  // enough, or at the end of a window.
+  Status CoalesceBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status FlushCoalescedBatches(ExecState* exec_state);
 
   bool cancelled_ = false;
+  bool sufficient_results_ = false;
+  std::vector<int64_t> abortable_srcs_;
 
   std::unique_ptr<grpc::ClientContext> context_;
   carnotpb::TransferResultChunkResponse response_;
@@ -107,6 +132,11 @@ class GRPCSinkNode : public SinkNode {
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  // Small row batches that have not been written yet, merged into a single request.
+  std::unique_ptr<carnotpb::TransferResultChunkRequest> coalesced_req_;
+  int64_t coalesced_bytes_ = 0;
+  std::chrono::time_point<std::chrono::steady_clock> coalesced_since_;
 };
 
 }  // namespace exec
@@ -103,4 +103,64 @@ void BM_GRPCSinkNodeSplitting(benchmark::State& state) {
   }
 }
 
+// Sends many small row batches, with coalescing up to state.range(0) bytes (disabled if 0).
+// NOLINTNEXTLINE : runtime/references.
+void BM_GRPCSinkNodeSmallBatches(benchmark::State& state) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_carnot_grpc_sink_coalesce_bytes = state.range(0);
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+
+  auto mock_unique = std::make_unique<::testing::NiceMock<MockResultSinkServiceStub>>();
+  auto mock = mock_unique.get();
+
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store,
+      [&](const std::string&, const std::string&)
+          -> std::unique_ptr<ResultSinkService::StubInterface> { return std::move(mock_unique); },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [&](grpc::ClientContext*) {});
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+  int64_t num_writes = 0;
+  auto writer =
+      new ::testing::NiceMock<grpc::testing::MockClientWriter<TransferResultChunkRequest>>();
+  ON_CALL(*writer, Write(_, _)).WillByDefault(::testing::InvokeWithoutArgs([&num_writes]() {
+    ++num_writes;
+    return true;
+  }));
+  ON_CALL(*writer, WritesDone()).WillByDefault(Return(true));
+  ON_CALL(*writer, Finish()).WillByDefault(Return(grpc::Status::OK));
+  ON_CALL(*mock, TransferResultChunkRaw(_, _))
+      .WillByDefault(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  px::carnot::exec::GRPCSinkNode node;
+  auto op_proto = px::carnot::planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<px::carnot::plan::GRPCSinkOperator>(1);
+  PL_CHECK_OK(plan_node->Init(op_proto.grpc_sink_op()));
+
+  auto num_batches = 1024;
+  auto num_rows = 16;
+  RowDescriptor rd({DataType::INT64, DataType::STRING});
+  PL_CHECK_OK(node.Init(*plan_node, rd, {rd}));
+  PL_CHECK_OK(node.Prepare(exec_state.get()));
+  PL_CHECK_OK(node.Open(exec_state.get()));
+
+  std::vector<px::types::Int64Value> ints(num_rows, 1);
+  std::vector<px::types::StringValue> strings(num_rows, std::string(32, 'X'));
+  auto rb = px::carnot::exec::RowBatchBuilder(rd, num_rows, /*eow*/ false, /*eos*/ false)
+                .AddColumn<px::types::Int64Value>(ints)
+                .AddColumn<px::types::StringValue>(strings)
+                .get();
+
+  for (auto _ : state) {
+    for (int i = 0; i < num_batches; ++i) {
+      PL_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * num_batches * rb.NumBytes());
+  state.counters["Writes"] = benchmark::Counter(num_writes, benchmark::Counter::kAvgIterations);
+}
+
 BENCHMARK(BM_GRPCSinkNodeSplitting)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GRPCSinkNodeSmallBatches)->Arg(0)->Arg(64 * 1024)->Unit(benchmark::kMillisecond);
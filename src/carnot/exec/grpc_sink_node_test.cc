@@ -217,6 +217,94 @@ TEST_F(GRPCSinkNodeTest, internal_result) {
   EXPECT_FALSE(add_metadata_called_);
 }
 
+constexpr char kExpectedCoalescedResult[] = R"proto(
+address: "localhost:1234"
+query_id {
+  high_bits: $0
+  low_bits: $1
+}
+query_result {
+  row_batch {
+    cols {
+      int64_data {
+        data: 1
+        data: 2
+        data: 2
+      }
+    }
+    num_rows: 3
+    eow: true
+    eos: true
+  }
+  grpc_source_id: 0
+}
+)proto";
+
+TEST_F(GRPCSinkNodeTest, coalesced_result) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 1024 * 1024;
+  FLAGS_carnot_grpc_sink_coalesce_ms = 60 * 1000;
+
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  std::vector<std::string> expected_protos = {
+      absl::Substitute(kExpected0RowResult, exec_state_->query_id().ab, exec_state_->query_id().cd),
+      absl::Substitute(kExpectedCoalescedResult, exec_state_->query_id().ab,
+                       exec_state_->query_id().cd),
+  };
+
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+
+  // The stream start, then all three batches in one request.
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  for (auto i = 0; i < 3; ++i) {
+    std::vector<types::Int64Value> data(i, i);
+    auto rb = RowBatchBuilder(output_rd, i, /*eow*/ i == 2, /*eos*/ i == 2)
+                  .AddColumn<types::Int64Value>(data)
+                  .get();
+    tester.ConsumeNext(rb, 5, 0);
+  }
+
+  tester.Close();
+
+  for (auto i = 0; i < 2; ++i) {
+    EXPECT_THAT(actual_protos[i], EqualsProto(expected_protos[i]));
+  }
+}
+
+TEST_F(GRPCSinkNodeTest, unknown_compression) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_carnot_grpc_sink_compression = "lz4";
+
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto.grpc_sink_op()));
+  RowDescriptor input_rd({types::DataType::INT64});
+
+  GRPCSinkNode node;
+  EXPECT_NOT_OK(node.Init(*plan_node, input_rd, {input_rd}));
+}
+
 constexpr char kExpectedExternal0RowResult[] = R"proto(
 address: "localhost:1234"
 query_id {
@@ -763,6 +851,53 @@ TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   tester.Close();
 }
 
+TEST_F(GRPCSinkNodeTest, stop_on_sufficient_results) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+  resp.set_sufficient_results(true);
+
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(Return(true))    // Initiate result sink
+      .WillOnce(Return(false));  // The server closed the stream with sufficient results.
+
+  EXPECT_CALL(*writer, WritesDone()).Times(1).WillOnce(Return(true));
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->set_abortable_srcs({3});
+  tester.node()->testing_set_connection_check_timeout(std::chrono::milliseconds(-1));
+  exec_state_->SetCurrentSource(3);
+
+  std::vector<types::Int64Value> data(1, 1);
+  auto rb1 = RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>(data)
+                 .get();
+  tester.ConsumeNext(rb1, 5, 0);
+  EXPECT_TRUE(tester.node()->sufficient_results());
+  EXPECT_FALSE(exec_state_->keep_running());
+
+  // Later batches, and connection checks, are not written to the closed stream.
+  auto rb2 = RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                 .AddColumn<types::Int64Value>(data)
+                 .get();
+  tester.ConsumeNext(rb2, 5, 0);
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+
+  tester.Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -18,6 +18,11 @@
 
 #include "src/carnot/exec/grpc_source_node.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,12 +31,123 @@
 
 #include "src/carnot/planpb/plan.pb.h"
 
+DEFINE_int64(carnot_grpc_source_spill_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SOURCE_SPILL_BYTES", 256 * 1024 * 1024),
+             "The bytes of received row batches a GRPC source keeps in memory. Batches that "
+             "arrive while it holds more are spilled to disk, until they are read. No spilling "
+             "if 0.");
+DEFINE_string(carnot_grpc_source_spill_dir,
+              gflags::StringFromEnv("PL_CARNOT_GRPC_SOURCE_SPILL_DIR", "/tmp"),
+              "The directory of the files that GRPC sources spill row batches to.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
 using table_store::schema::RowBatch;
 
+//-----------------------------------------------------------------------------
+// ResultSpillFile
+//-----------------------------------------------------------------------------
+
+StatusOr<std::unique_ptr<ResultSpillFile>> ResultSpillFile::Create(
+    const std::filesystem::path& dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    return error::Internal("Failed to create spill directory $0: $1", dir.string(), ec.message());
+  }
+  std::string path = (dir / "grpc_source_XXXXXX.spill").string();
+  int fd = mkostemps(path.data(), /*suffixlen*/ 6, O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to create spill file in $0: $1", dir.string(),
+                           std::strerror(errno));
+  }
+  unlink(path.c_str());
+  return std::unique_ptr<ResultSpillFile>(new ResultSpillFile(fd));
+}
+
+ResultSpillFile::~ResultSpillFile() { close(fd_); }
+
+StatusOr<ResultSpillFile::Chunk> ResultSpillFile::Append(
+    const carnotpb::TransferResultChunkRequest& req) {
+  std::string data;
+  if (!req.SerializeToString(&data)) {
+    return error::Internal("Failed to serialize row batch to spill.");
+  }
+
+  absl::MutexLock lock(&mu_);
+  Chunk chunk{size_, static_cast<int64_t>(data.size())};
+  for (size_t written = 0; written < data.size();) {
+    ssize_t n = pwrite(fd_, data.data() + written, data.size() - written, size_ + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::Internal("Failed to write spill file: $0", std::strerror(errno));
+    }
+    written += n;
+  }
+  size_ += chunk.size;
+  ++num_chunks_;
+  return chunk;
+}
+
+StatusOr<std::unique_ptr<carnotpb::TransferResultChunkRequest>> ResultSpillFile::Take(
+    Chunk chunk) {
+  std::string data(chunk.size, '\0');
+  for (size_t read = 0; read < data.size();) {
+    ssize_t n = pread(fd_, data.data() + read, data.size() - read, chunk.offset + read);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return error::Internal("Failed to read spill file: $0",
+                             n < 0 ? std::strerror(errno) : "unexpected end of file");
+    }
+    read += n;
+  }
+
+  {
+    absl::MutexLock lock(&mu_);
+    // The space of read chunks is only reclaimed once all of them are read, by emptying the file.
+    if (--num_chunks_ == 0) {
+      if (ftruncate(fd_, 0) == 0) {
+        size_ = 0;
+      }
+    }
+  }
+
+  auto req = std::make_unique<carnotpb::TransferResultChunkRequest>();
+  if (!req->ParseFromString(data)) {
+    return error::Internal("Failed to parse spilled row batch.");
+  }
+  return req;
+}
+
+int64_t ResultSpillFile::size() const {
+  absl::MutexLock lock(&mu_);
+  return size_;
+}
+
+//-----------------------------------------------------------------------------
+// GRPCSourceNode
+//-----------------------------------------------------------------------------
+
+GRPCSourceNode::~GRPCSourceNode() {
+  // Batches that were never popped no longer count towards the queue depth.
+  UpdateQueueDepth(-queued_batches_, -queued_bytes_);
+}
+
+void GRPCSourceNode::UpdateQueueDepth(int64_t batches, int64_t bytes) {
+  queued_batches_ += batches;
+  queued_bytes_ += bytes;
+  if (queue_metrics_ != nullptr) {
+    queue_metrics_->queued_batches.Increment(static_cast<double>(batches));
+    queue_metrics_->queued_bytes.Increment(static_cast<double>(bytes));
+  }
+}
+
 std::string GRPCSourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::GRPCSourceNode: <id: $0, output: $1>", plan_node_->id(),
                           output_descriptor_->DebugString());
@@ -55,30 +171,88 @@ Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
+void GRPCSourceNode::MaybeSpill(QueuedBatch* batch) {
+  if (FLAGS_carnot_grpc_source_spill_bytes <= 0 ||
+      queued_bytes_ - spilled_bytes_ + batch->bytes <= FLAGS_carnot_grpc_source_spill_bytes) {
+    return;
+  }
+
+  ResultSpillFile* spill_file = nullptr;
+  {
+    absl::MutexLock lock(&spill_file_lock_);
+    if (spill_failed_) {
+      return;
+    }
+    if (spill_file_ == nullptr) {
+      auto spill_file_or = ResultSpillFile::Create(FLAGS_carnot_grpc_source_spill_dir);
+      if (!spill_file_or.ok()) {
+        LOG(WARNING) << "Keeping row batches in memory: " << spill_file_or.msg();
+        spill_failed_ = true;
+        return;
+      }
+      spill_file_ = spill_file_or.ConsumeValueOrDie();
+    }
+    spill_file = spill_file_.get();
+  }
+
+  auto chunk_or = spill_file->Append(*batch->req);
+  if (!chunk_or.ok()) {
+    LOG(WARNING) << "Keeping row batches in memory: " << chunk_or.msg();
+    absl::MutexLock lock(&spill_file_lock_);
+    spill_failed_ = true;
+    return;
+  }
+  batch->spilled = chunk_or.ConsumeValueOrDie();
+  batch->req.reset();
+  spilled_bytes_ += batch->bytes;
+  if (queue_metrics_ != nullptr) {
+    queue_metrics_->spilled_bytes.Increment(static_cast<double>(batch->bytes));
+  }
+}
+
 Status GRPCSourceNode::EnqueueRowBatch(
     std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch) {
-  if (!row_batch_queue_.enqueue(std::move(row_batch))) {
+  QueuedBatch batch;
+  batch.bytes = row_batch->ByteSizeLong();
+  batch.req = std::move(row_batch);
+  MaybeSpill(&batch);
+  int64_t num_bytes = batch.bytes;
+  if (!row_batch_queue_.enqueue(std::move(batch))) {
     return error::Internal("Failed to enqueue RowBatch");
   }
+  UpdateQueueDepth(1, num_bytes);
   return Status::OK();
 }
 
 Status GRPCSourceNode::PopRowBatch() {
   DCHECK(NextBatchReady());
-  std::unique_ptr<carnotpb::TransferResultChunkRequest> rb_request;
-  bool got_one = row_batch_queue_.try_dequeue(rb_request);
+  QueuedBatch batch;
+  bool got_one = row_batch_queue_.try_dequeue(batch);
   if (!got_one) {
     return error::Internal(
         "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
         "queue.");
   }
+  UpdateQueueDepth(-1, -batch.bytes);
+  std::unique_ptr<carnotpb::TransferResultChunkRequest> rb_request = std::move(batch.req);
+  if (rb_request == nullptr) {
+    spilled_bytes_ -= batch.bytes;
+    ResultSpillFile* spill_file = nullptr;
+    {
+      // Once created, the spill file lives as long as the node.
+      absl::MutexLock lock(&spill_file_lock_);
+      spill_file = spill_file_.get();
+    }
+    PL_ASSIGN_OR_RETURN(rb_request, spill_file->Take(batch.spilled));
+  }
   if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
     return error::Internal(
         "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
         "message.");
   }
 
-  PL_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(rb_request->query_result().row_batch()));
+  PL_ASSIGN_OR_RETURN(rb_, RowBatch::FromProtoAdoptingBuffers(
+                               rb_request->mutable_query_result()->mutable_row_batch()));
   return Status::OK();
 }
 
@@ -18,32 +18,84 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/table_store/table_store.h"
 
 #include "blockingconcurrentqueue.h"
 
+DECLARE_int64(carnot_grpc_source_spill_bytes);
+DECLARE_string(carnot_grpc_source_spill_dir);
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+/**
+ * ResultSpillFile keeps serialized result chunks on local disk, for GRPC sources whose queue is
+ * over its in-memory high-water mark. Chunks are appended by the router's threads, and read back
+ * by the exec thread. The file is unlinked when it is created, so that it goes away with the
+ * source, even if the process dies, and it is emptied whenever no chunk is left in it.
+ */
+class ResultSpillFile {
+ public:
+  struct Chunk {
+    int64_t offset = -1;
+    int64_t size = 0;
+  };
+
+  static StatusOr<std::unique_ptr<ResultSpillFile>> Create(const std::filesystem::path& dir);
+  ~ResultSpillFile();
+
+  StatusOr<Chunk> Append(const carnotpb::TransferResultChunkRequest& req);
+
+  /**
+   * Reads a chunk back, after which its space may be reused.
+   */
+  StatusOr<std::unique_ptr<carnotpb::TransferResultChunkRequest>> Take(Chunk chunk);
+
+  int64_t size() const;
+
+ private:
+  explicit ResultSpillFile(int fd) : fd_(fd) {}
+
+  const int fd_;
+  mutable absl::Mutex mu_;
+  int64_t size_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_chunks_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 class GRPCSourceNode : public SourceNode {
  public:
   GRPCSourceNode() = default;
-  virtual ~GRPCSourceNode() = default;
+  virtual ~GRPCSourceNode();
 
   bool NextBatchReady() override;
   virtual Status EnqueueRowBatch(std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch);
 
+  // The row batches that have been enqueued but not sent to the children yet. The router only
+  // reads more from the upstream sinks while queued_bytes() is within the buffer credits.
+  int64_t queued_batches() const { return queued_batches_; }
+  int64_t queued_bytes() const { return queued_bytes_; }
+  // The part of queued_bytes() that was spilled to disk, because the batches in memory were over
+  // --carnot_grpc_source_spill_bytes when it arrived.
+  int64_t spilled_bytes() const { return spilled_bytes_; }
+  // Sets the metrics that the depth of the queue is added to. Must be set before enqueueing.
+  void set_queue_metrics(GRPCSourceQueueMetrics* queue_metrics) { queue_metrics_ = queue_metrics; }
+
   // Tracks whether the upstream sink node has successfully initiated the connection to
   // this remote source. Used by the exec graph to determine whether or not any sources have
   // taken too long for their connection to be established with the sinks.
@@ -65,15 +117,36 @@ class GRPCSourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  // A queued row batch, which is either in memory or in the spill file.
+  struct QueuedBatch {
+    std::unique_ptr<carnotpb::TransferResultChunkRequest> req;
+    ResultSpillFile::Chunk spilled;
+    int64_t bytes = 0;
+  };
+
   Status PopRowBatch();
+  void UpdateQueueDepth(int64_t batches, int64_t bytes);
+  // Writes the batch to the spill file, unless the batches in memory are within the high-water
+  // mark. Falls back to keeping it in memory if the spill file can't be written.
+  void MaybeSpill(QueuedBatch* batch);
 
   std::unique_ptr<table_store::schema::RowBatch> rb_;
-  moodycamel::BlockingConcurrentQueue<std::unique_ptr<carnotpb::TransferResultChunkRequest>>
-      row_batch_queue_;
+  moodycamel::BlockingConcurrentQueue<QueuedBatch> row_batch_queue_;
 
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
   bool upstream_initiated_connection_ = false;
   bool upstream_closed_connection_ = false;
+
+  // Written by the router's threads on enqueue and by the exec thread on pop.
+  std::atomic<int64_t> queued_batches_ = 0;
+  std::atomic<int64_t> queued_bytes_ = 0;
+  std::atomic<int64_t> spilled_bytes_ = 0;
+  GRPCSourceQueueMetrics* queue_metrics_ = nullptr;
+
+  // Created when the first batch is spilled.
+  absl::Mutex spill_file_lock_;
+  std::unique_ptr<ResultSpillFile> spill_file_ ABSL_GUARDED_BY(spill_file_lock_);
+  bool spill_failed_ ABSL_GUARDED_BY(spill_file_lock_) = false;
 };
 
 }  // namespace exec
@@ -87,6 +87,62 @@ TEST_F(GRPCSourceNodeTest, basic) {
   EXPECT_FALSE(tester.node()->HasBatchesRemaining());
 }
 
+TEST_F(GRPCSourceNodeTest, spills_over_high_water_mark) {
+  gflags::FlagSaver flag_saver;
+  // Only the first batch fits in memory.
+  FLAGS_carnot_grpc_source_spill_bytes = 1;
+  FLAGS_carnot_grpc_source_spill_dir = ::testing::TempDir();
+
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<GRPCSourceNode, plan::GRPCSourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+
+  std::vector<RowBatch> rbs;
+  for (auto i = 0; i < 3; ++i) {
+    std::vector<types::Int64Value> data(i + 1, i);
+    rbs.push_back(RowBatchBuilder(output_rd, i + 1, /*eow*/ i == 2, /*eos*/ i == 2)
+                      .AddColumn<types::Int64Value>(data)
+                      .get());
+    auto rb_wrapper = std::make_unique<carnotpb::TransferResultChunkRequest>();
+    EXPECT_OK(rbs.back().ToProto(rb_wrapper->mutable_query_result()->mutable_row_batch()));
+    EXPECT_OK(tester.node()->EnqueueRowBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_GT(tester.node()->spilled_bytes(), 0);
+  EXPECT_LT(tester.node()->spilled_bytes(), tester.node()->queued_bytes());
+
+  // The spilled batches come back in order.
+  for (const auto& rb : rbs) {
+    ASSERT_TRUE(tester.node()->NextBatchReady());
+    tester.GenerateNextResult().ExpectRowBatch(rb);
+  }
+  EXPECT_EQ(tester.node()->spilled_bytes(), 0);
+  EXPECT_EQ(tester.node()->queued_bytes(), 0);
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+}
+
+TEST(ResultSpillFileTest, append_and_take) {
+  ASSERT_OK_AND_ASSIGN(auto spill_file, ResultSpillFile::Create(::testing::TempDir()));
+
+  carnotpb::TransferResultChunkRequest req1;
+  req1.set_address("a");
+  carnotpb::TransferResultChunkRequest req2;
+  req2.set_address("bb");
+  ASSERT_OK_AND_ASSIGN(auto chunk1, spill_file->Append(req1));
+  ASSERT_OK_AND_ASSIGN(auto chunk2, spill_file->Append(req2));
+  EXPECT_EQ(spill_file->size(), chunk1.size + chunk2.size);
+
+  ASSERT_OK_AND_ASSIGN(auto out2, spill_file->Take(chunk2));
+  EXPECT_EQ(out2->address(), "bb");
+  EXPECT_GT(spill_file->size(), 0);
+  ASSERT_OK_AND_ASSIGN(auto out1, spill_file->Take(chunk1));
+  EXPECT_EQ(out1->address(), "a");
+  // The file is emptied once all of its chunks are read.
+  EXPECT_EQ(spill_file->size(), 0);
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
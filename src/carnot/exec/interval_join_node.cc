@@ -0,0 +1,243 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/interval_join_node.h"
+
+#include <arrow/array.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/exec/join_key_filter.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+std::string IntervalJoinNode::DebugStringImpl() {
+  return absl::Substitute("Exec::IntervalJoinNode<window=$0, $1>", window_ns_,
+                          absl::StrJoin(plan_node_->column_names(), ","));
+}
+
+Status IntervalJoinNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::JOIN_OPERATOR);
+  if (input_descriptors_.size() != 2) {
+    return error::InvalidArgument("Join operator expects a two input relations, got $0",
+                                  input_descriptors_.size());
+  }
+  const auto* join_plan_node = static_cast<const plan::JoinOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::JoinOperator>(*join_plan_node);
+  if (!plan_node_->has_time_condition() || plan_node_->type() != planpb::JoinOperator::INNER) {
+    return error::InvalidArgument("IntervalJoinNode expects an inner join with a time condition");
+  }
+  output_rows_per_batch_ = plan_node_->rows_per_batch() == 0 ? kDefaultIntervalJoinRowBatchSize
+                                                              : plan_node_->rows_per_batch();
+  output_columns_ = plan_node_->output_columns();
+
+  const auto& time_condition = plan_node_->time_condition();
+  window_ns_ = time_condition.window_ns();
+  time_indices_[0] = time_condition.left_column_index();
+  time_indices_[1] = time_condition.right_column_index();
+  for (size_t i = 0; i < 2; ++i) {
+    if (input_descriptors_[i].type(time_indices_[i]) != types::DataType::TIME64NS) {
+      return error::InvalidArgument("Interval join time column $0 of input $1 must be a time",
+                                    time_indices_[i], i);
+    }
+  }
+
+  for (const auto& eq_condition : plan_node_->equality_conditions()) {
+    int64_t left_index = eq_condition.left_column_index();
+    int64_t right_index = eq_condition.right_column_index();
+
+    CHECK_EQ(input_descriptors_[0].type(left_index), input_descriptors_[1].type(right_index));
+    auto dt = input_descriptors_[0].type(left_index);
+    key_data_types_.emplace_back(dt);
+#define TYPE_CASE(_dt_) key_value_eq_fns_.emplace_back(&ColumnValueEq<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+    key_indices_[0].emplace_back(left_index);
+    key_indices_[1].emplace_back(right_index);
+  }
+  return Status::OK();
+}
+
+Status IntervalJoinNode::InitializeColumnBuilders(ExecState* exec_state) {
+  output_rows_ = 0;
+  for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+    column_builders_[i] =
+        MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
+  }
+  return Status::OK();
+}
+
+Status IntervalJoinNode::PrepareImpl(ExecState* exec_state) {
+  column_builders_.resize(output_descriptor_->size());
+  return InitializeColumnBuilders(exec_state);
+}
+
+Status IntervalJoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status IntervalJoinNode::CloseImpl(ExecState* /*exec_state*/) {
+  key_rows_.clear();
+  arrival_order_[0].clear();
+  arrival_order_[1].clear();
+  key_rows_pool_.Clear();
+  key_values_pool_.Clear();
+  return Status::OK();
+}
+
+int64_t IntervalJoinNode::ExternalMemoryBytes() const {
+  return key_values_pool_.bytes_allocated() + key_rows_pool_.bytes_allocated() +
+         key_rows_.memory_bytes() +
+         num_buffered_rows() * (sizeof(BufferedRow) + sizeof(arrival_order_[0].front()));
+}
+
+RowTuple* IntervalJoinNode::ExtractKeyRowTuple(const std::vector<arrow::Array*>& key_cols,
+                                               int64_t row_idx) {
+  auto* rt = key_values_pool_.New<RowTuple>(&key_data_types_);
+  for (size_t tuple_col_idx = 0; tuple_col_idx < key_cols.size(); ++tuple_col_idx) {
+#define TYPE_CASE(_dt_) \
+  ExtractIntoRowTuple<_dt_>(rt, key_cols[tuple_col_idx], tuple_col_idx, row_idx);
+    PL_SWITCH_FOREACH_DATATYPE(key_data_types_[tuple_col_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return rt;
+}
+
+Status IntervalJoinNode::AppendOutputRow(ExecState* exec_state, size_t parent_index,
+                                         const RowBatch& rb, int64_t row_idx,
+                                         const BufferedRow& other) {
+  for (size_t i = 0; i < output_columns_.size(); ++i) {
+    const auto& col = output_columns_[i];
+    bool from_rb = col.parent_index() == parent_index;
+    const arrow::Array* arr = from_rb ? rb.ColumnAt(col.column_index()).get()
+                                      : other.rb->ColumnAt(col.column_index()).get();
+    int64_t idx = from_rb ? row_idx : other.row_idx;
+#define TYPE_CASE(_dt_)                                    \
+  PL_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
+      column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(arr, idx)))
+    PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  if (++output_rows_ == output_rows_per_batch_) {
+    return FlushOutput(exec_state, /* eos */ false);
+  }
+  return Status::OK();
+}
+
+Status IntervalJoinNode::FlushOutput(ExecState* exec_state, bool eos) {
+  PL_ASSIGN_OR_RETURN(auto output_batch,
+                      RowBatch::FromColumnBuilders(*output_descriptor_, /* eow */ eos,
+                                                   /* eos */ eos, &column_builders_));
+  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_batch));
+  return InitializeColumnBuilders(exec_state);
+}
+
+void IntervalJoinNode::EvictRows(size_t parent_index) {
+  size_t other_index = 1 - parent_index;
+  if (!eos_[other_index] && watermarks_[other_index] == std::numeric_limits<int64_t>::min()) {
+    return;
+  }
+  auto& order = arrival_order_[parent_index];
+  while (!order.empty() &&
+         (eos_[other_index] || order.front().first < watermarks_[other_index] - window_ns_)) {
+    auto& rows = order.front().second->rows[parent_index];
+    DCHECK(!rows.empty());
+    rows.pop_front();
+    order.pop_front();
+  }
+}
+
+Status IntervalJoinNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
+                                         size_t parent_index) {
+  DCHECK(!eos_[parent_index]);
+  size_t other_index = 1 - parent_index;
+  if (rb.eos()) {
+    eos_[parent_index] = true;
+  }
+
+  const auto& key_indices = key_indices_[parent_index];
+  JoinKeyFilter::HashKeys(rb, key_indices, key_data_types_, &key_hashes_);
+  std::vector<arrow::Array*> key_cols;
+  key_cols.reserve(key_indices.size());
+  for (auto col_idx : key_indices) {
+    key_cols.push_back(rb.ColumnAt(col_idx).get());
+  }
+  const arrow::Array* time_col = rb.ColumnAt(time_indices_[parent_index]).get();
+  // Once the other input is done, no later row can join the rows of this one, so they aren't
+  // buffered.
+  bool buffer_rows = !eos_[other_index];
+  std::shared_ptr<const RowBatch> rb_ptr;
+
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    auto hash = key_hashes_[row_idx];
+    auto key_eq = [&](const RowTuple* rt) {
+      for (size_t i = 0; i < key_cols.size(); ++i) {
+        if (!key_value_eq_fns_[i](key_cols[i], row_idx, *rt, i)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    KeyRows** found = key_rows_.Find(hash, key_eq);
+    KeyRows* key_rows = found != nullptr ? *found : nullptr;
+    int64_t time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col, row_idx);
+
+    if (key_rows != nullptr) {
+      for (const auto& other : key_rows->rows[other_index]) {
+        if (std::abs(time - other.time) <= window_ns_) {
+          PL_RETURN_IF_ERROR(AppendOutputRow(exec_state, parent_index, rb, row_idx, other));
+        }
+      }
+    }
+    if (buffer_rows) {
+      if (key_rows == nullptr) {
+        key_rows = key_rows_pool_.New<KeyRows>();
+        key_rows_.Insert(hash, ExtractKeyRowTuple(key_cols, row_idx), key_rows);
+      }
+      if (rb_ptr == nullptr) {
+        rb_ptr = std::make_shared<RowBatch>(rb);
+      }
+      key_rows->rows[parent_index].push_back(BufferedRow{rb_ptr, row_idx, time});
+      arrival_order_[parent_index].emplace_back(time, key_rows);
+    }
+    watermarks_[parent_index] = std::max(watermarks_[parent_index], time);
+  }
+
+  // The rows of the other input that are now out of the window of this one can be dropped.
+  EvictRows(other_index);
+
+  if (eos_[0] && eos_[1]) {
+    return FlushOutput(exec_state, /* eos */ true);
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
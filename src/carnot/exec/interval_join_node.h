@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <arrow/array/builder_base.h>
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/group_hash_table.h"
+#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/memory/memory.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr size_t kDefaultIntervalJoinRowBatchSize = 1024;
+
+/**
+ * IntervalJoinNode is an inner join that only joins the rows whose keys are equal and whose times
+ * are at most a window apart, e.g. the http_events of a process with the process_stats samples
+ * taken around them.
+ *
+ * Both inputs are expected to be sorted by time, as memory sources read them. When a row arrives,
+ * it is joined with the buffered rows of the other input and then buffered itself. A buffered row
+ * is dropped once it is older than the latest row of the other input by more than the window,
+ * since no later row of the other input can join it, so the memory of the join is bounded by the
+ * rows within the window rather than by the size of the inputs.
+ */
+class IntervalJoinNode : public ProcessingNode {
+ public:
+  IntervalJoinNode() = default;
+  virtual ~IntervalJoinNode() = default;
+
+  // The number of rows of both inputs that are currently buffered.
+  int64_t num_buffered_rows() const {
+    return static_cast<int64_t>(arrival_order_[0].size() + arrival_order_[1].size());
+  }
+
+  // The keys, the hash table and the bookkeeping of the buffered rows.
+  int64_t ExternalMemoryBytes() const override;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // A buffered row of one of the inputs. The row batch is shared by all its buffered rows.
+  struct BufferedRow {
+    std::shared_ptr<const table_store::schema::RowBatch> rb;
+    int64_t row_idx;
+    int64_t time;
+  };
+  // The buffered rows of each input with the same keys, in arrival order.
+  struct KeyRows {
+    std::deque<BufferedRow> rows[2];
+  };
+  using KeyHashTable = GroupHashTable<RowTuple*, KeyRows*>;
+
+  Status InitializeColumnBuilders(ExecState* exec_state);
+  RowTuple* ExtractKeyRowTuple(const std::vector<arrow::Array*>& key_cols, int64_t row_idx);
+  Status AppendOutputRow(ExecState* exec_state, size_t parent_index,
+                         const table_store::schema::RowBatch& rb, int64_t row_idx,
+                         const BufferedRow& other);
+  Status FlushOutput(ExecState* exec_state, bool eos);
+  // EvictRows drops the buffered rows of the input that no later row of the other input can join.
+  void EvictRows(size_t parent_index);
+
+  std::unique_ptr<plan::JoinOperator> plan_node_;
+  std::vector<planpb::JoinOperator::ParentColumn> output_columns_;
+  int64_t output_rows_per_batch_;
+  int64_t window_ns_;
+
+  // The key columns and the time column of each input.
+  std::vector<int64_t> key_indices_[2];
+  int64_t time_indices_[2];
+  std::vector<types::DataType> key_data_types_;
+  // The comparison function of each key column.
+  std::vector<ColumnValueEqFn> key_value_eq_fns_;
+
+  KeyHashTable key_rows_;
+  // Manages the RowTuples of the keys and their KeyRows.
+  ObjectArena key_values_pool_{"interval_join_kv_pool"};
+  ObjectArena key_rows_pool_{"interval_join_rows_pool"};
+  // The time and the key of the buffered rows of each input, in arrival order, so that the oldest
+  // rows are dropped first.
+  std::deque<std::pair<int64_t, KeyRows*>> arrival_order_[2];
+  // The latest time seen on each input.
+  int64_t watermarks_[2] = {std::numeric_limits<int64_t>::min(),
+                            std::numeric_limits<int64_t>::min()};
+  bool eos_[2] = {false, false};
+
+  // The key hashes of the batch being consumed, computed a column at a time.
+  std::vector<uint64_t> key_hashes_;
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
+  int64_t output_rows_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
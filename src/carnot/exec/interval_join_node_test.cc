@@ -0,0 +1,174 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/interval_join_node.h"
+
+#include <absl/strings/substitute.h>
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+
+class IntervalJoinNodeTest : public ::testing::Test {
+ public:
+  IntervalJoinNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+// Left table input: [time_:Time64Ns, upid:Int, latency:Int]
+// Right table input: [time_:Time64Ns, upid:Int, cpu:Float]
+// Output table: [time_:Time64Ns, latency:Int, cpu:Float]
+// Joins on left.upid=right.upid and |left.time_ - right.time_| <= 5.
+constexpr char kIntervalJoinProto[] = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 1
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 2
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 2
+  }
+  column_names: "time_"
+  column_names: "latency"
+  column_names: "cpu"
+  rows_per_batch: 2
+  time_condition {
+    left_column_index: 0
+    right_column_index: 0
+    window_ns: 5
+  }
+)";
+
+TEST_F(IntervalJoinNodeTest, JoinsRowsWithinWindow) {
+  planpb::Operator op_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(planpb::testutils::kOperatorProtoTmpl, "JOIN_OPERATOR", "join_op",
+                       kIntervalJoinProto),
+      &op_pb));
+  auto plan_node = plan::JoinOperator::FromProto(op_pb, 1);
+
+  RowDescriptor left_rd(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor right_rd(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::FLOAT64});
+  RowDescriptor output_rd(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::FLOAT64});
+  auto tester = exec::ExecNodeTester<IntervalJoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {left_rd, right_rd}, exec_state_.get());
+
+  // Nothing to join with yet, so all the rows are buffered.
+  tester.ConsumeNext(RowBatchBuilder(left_rd, 3, false, false)
+                         .AddColumn<types::Time64NSValue>({10, 20, 30})
+                         .AddColumn<types::Int64Value>({1, 2, 1})
+                         .AddColumn<types::Int64Value>({100, 200, 300})
+                         .get(),
+                     0, 0);
+  EXPECT_EQ(3, tester.node()->num_buffered_rows());
+
+  // The left rows at 10 and 20 are out of the window of the right rows from now on.
+  tester
+      .ConsumeNext(RowBatchBuilder(right_rd, 3, false, false)
+                       .AddColumn<types::Time64NSValue>({12, 25, 28})
+                       .AddColumn<types::Int64Value>({1, 2, 1})
+                       .AddColumn<types::Float64Value>({1.0, 2.0, 3.0})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({10, 20})
+                          .AddColumn<types::Int64Value>({100, 200})
+                          .AddColumn<types::Float64Value>({1.0, 2.0})
+                          .get());
+  EXPECT_EQ(4, tester.node()->num_buffered_rows());
+
+  // At the end of the left input, no more right rows need to be kept.
+  tester
+      .ConsumeNext(RowBatchBuilder(left_rd, 1, true, true)
+                       .AddColumn<types::Time64NSValue>({33})
+                       .AddColumn<types::Int64Value>({1})
+                       .AddColumn<types::Int64Value>({400})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({30, 33})
+                          .AddColumn<types::Int64Value>({300, 400})
+                          .AddColumn<types::Float64Value>({3.0, 3.0})
+                          .get());
+  EXPECT_EQ(2, tester.node()->num_buffered_rows());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(right_rd, 2, true, true)
+                       .AddColumn<types::Time64NSValue>({31, 50})
+                       .AddColumn<types::Int64Value>({1, 1})
+                       .AddColumn<types::Float64Value>({4.0, 5.0})
+                       .get(),
+                   1, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({30, 33})
+                          .AddColumn<types::Int64Value>({300, 400})
+                          .AddColumn<types::Float64Value>({4.0, 4.0})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true)
+                          .AddColumn<types::Time64NSValue>({})
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Float64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(IntervalJoinNodeTest, OnlyInnerJoins) {
+  planpb::Operator op_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(planpb::testutils::kOperatorProtoTmpl, "JOIN_OPERATOR", "join_op",
+                       kIntervalJoinProto),
+      &op_pb));
+  op_pb.mutable_join_op()->set_type(planpb::JoinOperator::LEFT_OUTER);
+  auto join_op = std::make_unique<plan::JoinOperator>(1);
+  EXPECT_NOT_OK(join_op->Init(op_pb.join_op()));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
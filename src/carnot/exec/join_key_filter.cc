@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_key_filter.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "src/carnot/exec/group_hash_table.h"
+#include "src/carnot/exec/row_selection.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+std::string_view HashBytes(const uint64_t& hash) {
+  return std::string_view(reinterpret_cast<const char*>(&hash), sizeof(hash));
+}
+
+}  // namespace
+
+void JoinKeyFilter::HashKeys(const RowBatch& rb, const std::vector<int64_t>& key_indices,
+                             const std::vector<types::DataType>& key_types,
+                             std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(key_indices.size(), key_types.size());
+  hashes->assign(rb.num_rows(), 0);
+  for (size_t i = 0; i < key_indices.size(); ++i) {
+    auto col = rb.ColumnAt(key_indices[i]).get();
+#define TYPE_CASE(_dt_) HashColumn<_dt_>(col, hashes);
+    PL_SWITCH_FOREACH_DATATYPE(key_types[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+Status JoinKeyFilter::Publish(const std::vector<uint64_t>& key_hashes) {
+  DCHECK(!ready());
+  PL_ASSIGN_OR_RETURN(
+      bloom_filter_,
+      bloomfilter::XXHash64BloomFilter::Create(
+          std::max<int64_t>(1, static_cast<int64_t>(key_hashes.size())), kErrorRate));
+  for (const auto& hash : key_hashes) {
+    bloom_filter_->Insert(HashBytes(hash));
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> JoinKeyFilter::Filter(const RowBatch& rb,
+                                                          arrow::MemoryPool* mem_pool) {
+  DCHECK(ready());
+  HashKeys(rb, key_indices_, key_types_, &hashes_);
+  std::vector<int64_t> rows;
+  rows.reserve(rb.num_rows());
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    if (bloom_filter_->Contains(HashBytes(hashes_[row_idx]))) {
+      rows.push_back(row_idx);
+    }
+  }
+  if (static_cast<int64_t>(rows.size()) == rb.num_rows()) {
+    return std::make_unique<RowBatch>(rb);
+  }
+  num_rows_dropped_ += rb.num_rows() - static_cast<int64_t>(rows.size());
+  return TakeRows(rb, rows, mem_pool);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
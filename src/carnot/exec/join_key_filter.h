@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * JoinKeyFilter is a bloom filter of the key hashes of an equijoin's build side. The join publishes
+ * it once it has consumed its build side, and the source of the probe side then drops the rows
+ * that can't have a match, before they are buffered or probed by the join.
+ *
+ * The filter isn't thread safe: it is published and applied from the thread executing the plan.
+ */
+class JoinKeyFilter {
+ public:
+  static constexpr double kErrorRate = 0.01;
+
+  /**
+   * @param key_indices The key columns of batches to filter, in the order of the join's keys.
+   * @param key_types The types of the keys.
+   */
+  JoinKeyFilter(std::vector<int64_t> key_indices, std::vector<types::DataType> key_types)
+      : key_indices_(std::move(key_indices)), key_types_(std::move(key_types)) {}
+
+  /**
+   * HashKeys computes the hash of the keys of each row of the batch, a column at a time. Both sides
+   * of a join hash their keys this way.
+   */
+  static void HashKeys(const table_store::schema::RowBatch& rb,
+                       const std::vector<int64_t>& key_indices,
+                       const std::vector<types::DataType>& key_types,
+                       std::vector<uint64_t>* hashes);
+
+  /**
+   * Publish makes the filter of the given build side key hashes available.
+   */
+  Status Publish(const std::vector<uint64_t>& key_hashes);
+
+  bool ready() const { return bloom_filter_ != nullptr; }
+
+  /**
+   * Filter returns the rows of the batch whose keys may be on the build side, with the same eow and
+   * eos. Must only be called once the filter is ready.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> Filter(
+      const table_store::schema::RowBatch& rb, arrow::MemoryPool* mem_pool);
+
+  int64_t num_rows_dropped() const { return num_rows_dropped_; }
+
+ private:
+  const std::vector<int64_t> key_indices_;
+  const std::vector<types::DataType> key_types_;
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+  std::vector<uint64_t> hashes_;
+  int64_t num_rows_dropped_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/join_key_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+TEST(JoinKeyFilterTest, drops_rows_without_build_keys) {
+  RowDescriptor build_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor probe_rd(
+      {types::DataType::FLOAT64, types::DataType::STRING, types::DataType::INT64});
+  std::vector<types::DataType> key_types({types::DataType::INT64, types::DataType::STRING});
+
+  auto build_rb = RowBatchBuilder(build_rd, 3, true, true)
+                      .AddColumn<types::Int64Value>({1, 2, 2})
+                      .AddColumn<types::StringValue>({"a", "b", "c"})
+                      .get();
+  std::vector<uint64_t> build_hashes;
+  JoinKeyFilter::HashKeys(build_rb, {0, 1}, key_types, &build_hashes);
+
+  JoinKeyFilter filter({2, 1}, key_types);
+  EXPECT_FALSE(filter.ready());
+  ASSERT_OK(filter.Publish(build_hashes));
+  EXPECT_TRUE(filter.ready());
+
+  auto probe_rb = RowBatchBuilder(probe_rd, 4, true, false)
+                      .AddColumn<types::Float64Value>({1.0, 2.0, 3.0, 4.0})
+                      .AddColumn<types::StringValue>({"a", "a", "c", "d"})
+                      .AddColumn<types::Int64Value>({1, 2, 2, 2})
+                      .get();
+  ASSERT_OK_AND_ASSIGN(auto filtered, filter.Filter(probe_rb, arrow::default_memory_pool()));
+
+  auto expected = RowBatchBuilder(probe_rd, 2, true, false)
+                      .AddColumn<types::Float64Value>({1.0, 3.0})
+                      .AddColumn<types::StringValue>({"a", "c"})
+                      .AddColumn<types::Int64Value>({1, 2})
+                      .get();
+  EXPECT_TRUE(filtered->eow());
+  EXPECT_FALSE(filtered->eos());
+  for (int64_t i = 0; i < expected.num_columns(); ++i) {
+    EXPECT_TRUE(filtered->ColumnAt(i)->Equals(expected.ColumnAt(i)));
+  }
+  EXPECT_EQ(2, filter.num_rows_dropped());
+}
+
+TEST(JoinKeyFilterTest, empty_build_side) {
+  RowDescriptor probe_rd({types::DataType::INT64});
+  JoinKeyFilter filter({0}, {types::DataType::INT64});
+  ASSERT_OK(filter.Publish({}));
+
+  auto probe_rb = RowBatchBuilder(probe_rd, 3, true, true)
+                      .AddColumn<types::Int64Value>({1, 2, 3})
+                      .get();
+  ASSERT_OK_AND_ASSIGN(auto filtered, filter.Filter(probe_rb, arrow::default_memory_pool()));
+  EXPECT_EQ(0, filtered->num_rows());
+  EXPECT_TRUE(filtered->eow());
+  EXPECT_TRUE(filtered->eos());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -66,6 +66,7 @@ Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   PL_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, &output_rb));
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
+  output_rb.set_selection(rb.selection());
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
   return Status::OK();
 }
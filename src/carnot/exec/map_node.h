@@ -41,6 +41,9 @@ class MapNode : public ProcessingNode {
   MapNode() = default;
   virtual ~MapNode() = default;
 
+  // The expressions are evaluated for all of the rows, and the output keeps the selection.
+  bool SupportsSelection() const override { return true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
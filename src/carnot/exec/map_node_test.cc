@@ -99,6 +99,25 @@ TEST_F(MapNodeTest, basic) {
       .Close();
 }
 
+TEST_F(MapNodeTest, input_with_selection) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                      .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                      .get();
+  input_rb.set_selection(std::make_shared<std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+
+  // The output keeps the selection, which the child compacts.
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node_, output_rd, {},
+                                                                 exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, true, true).AddColumn<types::Int64Value>({2, 9}).get())
+      .Close();
+}
+
 TEST_F(MapNodeTest, zero_row_row_batch) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64});
@@ -19,22 +19,164 @@
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/table_store/table/table.h"
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/exec/row_selection.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 
+DEFINE_int64(carnot_memory_source_batch_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_MEMORY_SOURCE_BATCH_BYTES", 0),
+             "The target size of the row batches read from tables, e.g. 256KiB to keep them in the "
+             "L2 cache. Smaller batches are merged with the ones after them, and larger ones are "
+             "split. Batches are sent as they are stored if 0.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+using table_store::schema::RowDescriptor;
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
 
+// Batches under 1/kCoalesceDivisor of the target size are merged with the ones after them, and
+// batches over kSplitFactor times the target size are split.
+constexpr int64_t kCoalesceDivisor = 4;
+constexpr int64_t kSplitFactor = 2;
+
+namespace {
+
+// The bytes of the selected rows of a batch, assuming that its rows are of about the same size.
+int64_t SelectedBytes(const RowBatch& rb) {
+  if (!rb.has_selection() || rb.num_rows() == 0) {
+    return rb.NumBytes();
+  }
+  return rb.NumBytes() * rb.num_selected_rows() / rb.num_rows();
+}
+
+// Returns the rows [start, end) of the selection of rb, sharing its columns.
+StatusOr<std::unique_ptr<RowBatch>> SliceSelection(const RowBatch& rb, int64_t start,
+                                                   int64_t end) {
+  auto output_rb = std::make_unique<RowBatch>(rb.desc(), rb.num_rows());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(rb.ColumnAt(col_idx)));
+  }
+  const auto& selection = *rb.selection();
+  output_rb->set_selection(
+      std::make_shared<std::vector<int64_t>>(selection.begin() + start, selection.begin() + end));
+  return output_rb;
+}
+
+// Returns the output column index and the value of `column <op> constant`, in either order.
+// Sets `flipped` if the constant comes first.
+bool GetColumnAndConstant(const plan::ScalarFunc& func, int64_t* col_idx,
+                          const plan::ScalarValue** value, bool* flipped) {
+  const auto& args = func.arg_deps();
+  if (args.size() != 2) {
+    return false;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    if (args[i]->ExpressionType() == plan::Expression::kColumn &&
+        args[1 - i]->ExpressionType() == plan::Expression::kConstant) {
+      *col_idx = static_cast<const plan::Column&>(*args[i]).Index();
+      *value = static_cast<const plan::ScalarValue*>(args[1 - i].get());
+      *flipped = i == 1;
+      return !(*value)->IsNull();
+    }
+  }
+  return false;
+}
+
+// Collects the STRING values of a column that an equality, or an or of equalities of the same
+// column, compares with. Returns false if the expression isn't of that form.
+bool CollectEqualsAnyValues(const plan::ScalarExpression& expr, int64_t* col_idx,
+                            std::vector<std::string>* values) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return false;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  if (func.name() == "logicalOr") {
+    for (const auto& arg : func.arg_deps()) {
+      if (!CollectEqualsAnyValues(*arg, col_idx, values)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  int64_t idx;
+  const plan::ScalarValue* value;
+  bool flipped;
+  if (func.name() != "equal" || !GetColumnAndConstant(func, &idx, &value, &flipped) ||
+      value->DataType() != types::DataType::STRING || (*col_idx != -1 && *col_idx != idx)) {
+    return false;
+  }
+  *col_idx = idx;
+  values->push_back(value->StringValue());
+  return true;
+}
+
+// Adds the column range that all rows satisfying a comparison of an INT64 or TIME64NS column
+// with a constant are in. Returns false if the expression isn't of that form.
+bool AddColumnRange(const plan::ScalarExpression& expr, const RowDescriptor& output_rd,
+                    std::vector<Table::ColumnRange>* ranges) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return false;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  int64_t col_idx;
+  const plan::ScalarValue* value;
+  bool flipped;
+  if (!GetColumnAndConstant(func, &col_idx, &value, &flipped)) {
+    return false;
+  }
+  if (col_idx < 0 || static_cast<size_t>(col_idx) >= output_rd.size()) {
+    return false;
+  }
+  auto col_type = output_rd.type(col_idx);
+  if (col_type != types::DataType::INT64 && col_type != types::DataType::TIME64NS) {
+    return false;
+  }
+  int64_t v;
+  if (value->DataType() == types::DataType::INT64) {
+    v = value->Int64Value();
+  } else if (value->DataType() == types::DataType::TIME64NS) {
+    v = value->Time64NSValue();
+  } else {
+    return false;
+  }
+
+  std::string name = func.name();
+  bool less = name == "lessThan" || name == "lessThanEqual";
+  bool greater = name == "greaterThan" || name == "greaterThanEqual";
+  bool inclusive = name == "lessThanEqual" || name == "greaterThanEqual";
+  // `constant < column` is `column > constant`.
+  if (flipped) {
+    std::swap(less, greater);
+  }
+  Table::ColumnRange range{col_idx};
+  if (name == "equal") {
+    range.min = v;
+    range.max = v;
+  } else if (less && (inclusive || v != std::numeric_limits<int64_t>::min())) {
+    range.max = inclusive ? v : v - 1;
+  } else if (greater && (inclusive || v != std::numeric_limits<int64_t>::max())) {
+    range.min = inclusive ? v : v + 1;
+  } else {
+    return false;
+  }
+  ranges->push_back(range);
+  return true;
+}
+
+}  // namespace
+
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
                           output_descriptor_->DebugString());
@@ -62,7 +204,22 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   }
 
   StartSpec start_spec;
-  if (plan_node_->HasStartTime()) {
+  std::optional<int64_t> cursor_position;
+  if (!plan_node_->cursor_name().empty()) {
+    cursor_position = exec_state->table_store()->GetCursorPosition(
+        plan_node_->cursor_name(), plan_node_->TableName(), plan_node_->Tablet());
+  }
+  if (cursor_position.has_value()) {
+    // Resume after the last row read by the previous query with the cursor, unless the start
+    // time is later.
+    start_spec.type = StartSpec::StartType::AfterRowID;
+    start_spec.row_id = cursor_position.value();
+    if (plan_node_->HasStartTime()) {
+      start_spec.row_id = std::max(
+          start_spec.row_id,
+          table_->FindRowIDFromTimeFirstGreaterThanOrEqual(plan_node_->start_time()) - 1);
+    }
+  } else if (plan_node_->HasStartTime()) {
     start_spec.type = StartSpec::StartType::StartAtTime;
     start_spec.start_time = plan_node_->start_time();
   } else {
@@ -81,15 +238,166 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   }
   cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
 
+  // The predicates pushed down into the source let the cursor skip the batches whose zone maps or
+  // bloom filters show that they have no rows the query needs. The cursor also drops the other
+  // rows of the batches it reads, before reading the rest of their columns, so that wide columns
+  // are only copied for the rows that the filter after the source keeps.
+  std::vector<Table::ColumnRange> ranges;
+  std::vector<Table::ColumnEquals> equals;
+  for (const auto& predicate : plan_node_->predicates()) {
+    int64_t col_idx = -1;
+    std::vector<std::string> values;
+    if (CollectEqualsAnyValues(*predicate, &col_idx, &values) && col_idx >= 0 &&
+        static_cast<size_t>(col_idx) < plan_node_->Columns().size()) {
+      equals.push_back({col_idx, std::move(values)});
+    } else {
+      AddColumnRange(*predicate, *output_descriptor_, &ranges);
+    }
+  }
+  // The predicates refer to the output columns, and the cursor to the columns of the table.
+  for (auto& range : ranges) {
+    range.col_idx = plan_node_->Columns()[range.col_idx];
+  }
+  for (auto& eq : equals) {
+    eq.col_idx = plan_node_->Columns()[eq.col_idx];
+  }
+  num_pushdown_predicates_ = ranges.size() + equals.size();
+  if (!ranges.empty()) {
+    cursor_->SetColumnRanges(std::move(ranges));
+  }
+  if (!equals.empty()) {
+    cursor_->SetColumnEquals(std::move(equals));
+  }
+  cursor_->SetFilterRows(num_pushdown_predicates_ > 0);
+  target_batch_bytes_ = FLAGS_carnot_memory_source_batch_bytes;
+
+  if (infinite_stream_ && on_write_ && !write_subscription_.has_value()) {
+    write_subscription_ = table_->SubscribeToWrites(on_write_);
+  }
   return Status::OK();
 }
 
+void MemorySourceNode::UnsubscribeFromTableWrites() {
+  if (write_subscription_.has_value()) {
+    table_->UnsubscribeFromWrites(write_subscription_.value());
+    write_subscription_.reset();
+  }
+}
+
 Status MemorySourceNode::CloseImpl(ExecState*) {
+  UnsubscribeFromTableWrites();
   stats()->AddExtraInfo("infinite_stream", infinite_stream_ ? "true" : "false");
+  stats()->AddExtraInfo("pushdown_predicates", std::to_string(num_pushdown_predicates_));
+  if (cursor_ != nullptr) {
+    stats()->AddExtraInfo("pushdown_rows_filtered", std::to_string(cursor_->rows_filtered()));
+  }
+  if (plan_node_->sampled()) {
+    stats()->AddExtraInfo("sample_rate", std::to_string(plan_node_->sample_rate()));
+    stats()->AddExtraInfo("sample_batches_skipped", std::to_string(batches_skipped_));
+  }
+  if (target_batch_bytes_ > 0) {
+    stats()->AddExtraInfo("batches_coalesced", std::to_string(batches_coalesced_));
+    stats()->AddExtraInfo("batches_split", std::to_string(batches_split_));
+  }
+  if (join_key_filter_ != nullptr) {
+    stats()->AddExtraInfo("join_key_filter_rows_dropped",
+                          std::to_string(join_key_filter_->num_rows_dropped()));
+  }
   return Status::OK();
 }
 
-StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
+void MemorySourceNode::CommitCursorPosition(ExecState* exec_state) {
+  if (plan_node_->cursor_name().empty() || cursor_ == nullptr) {
+    return;
+  }
+  exec_state->table_store()->SetCursorPosition(plan_node_->cursor_name(), plan_node_->TableName(),
+                                               plan_node_->Tablet(), cursor_->last_read_row_id());
+}
+
+bool MemorySourceNode::BatchReady() {
+  return !pending_batches_.empty() || cursor_->NextBatchReady();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState* exec_state) {
+  std::unique_ptr<RowBatch> row_batch;
+  if (!pending_batches_.empty()) {
+    row_batch = std::move(pending_batches_.front());
+    pending_batches_.pop_front();
+  } else {
+    PL_ASSIGN_OR_RETURN(row_batch, ReadRowBatch());
+  }
+  if (target_batch_bytes_ <= 0 || row_batch->num_selected_rows() == 0) {
+    return row_batch;
+  }
+  int64_t bytes = SelectedBytes(*row_batch);
+  if (bytes < target_batch_bytes_ / kCoalesceDivisor) {
+    return CoalesceRowBatch(exec_state, std::move(row_batch));
+  }
+  if (bytes > target_batch_bytes_ * kSplitFactor && row_batch->num_selected_rows() > 1) {
+    return SplitRowBatch(std::move(row_batch));
+  }
+  return row_batch;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::CoalesceRowBatch(
+    ExecState* exec_state, std::unique_ptr<RowBatch> row_batch) {
+  // Only the batches that are already in the table are merged, so that a stream doesn't wait for
+  // more data to fill a batch.
+  std::vector<std::unique_ptr<RowBatch>> batches;
+  int64_t bytes = SelectedBytes(*row_batch);
+  batches.push_back(std::move(row_batch));
+  while (!batches.back()->eos() && bytes < target_batch_bytes_ && pending_batches_.empty() &&
+         cursor_->NextBatchReady()) {
+    PL_ASSIGN_OR_RETURN(auto next_batch, ReadRowBatch());
+    int64_t next_bytes = SelectedBytes(*next_batch);
+    if (next_bytes >= target_batch_bytes_ / kCoalesceDivisor ||
+        bytes + next_bytes > target_batch_bytes_ * kSplitFactor) {
+      // Keep the batch for the next call rather than copying a batch that is large enough.
+      pending_batches_.push_back(std::move(next_batch));
+      break;
+    }
+    bytes += next_bytes;
+    batches.push_back(std::move(next_batch));
+  }
+  if (batches.size() == 1) {
+    return std::move(batches.front());
+  }
+  for (auto& rb : batches) {
+    if (rb->has_selection()) {
+      PL_ASSIGN_OR_RETURN(rb, CompactSelection(*rb, exec_state->exec_mem_pool()));
+    }
+  }
+  batches_coalesced_ += batches.size();
+  return ConcatenateRows(batches, exec_state->exec_mem_pool());
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::SplitRowBatch(
+    std::unique_ptr<RowBatch> row_batch) {
+  // The slices share the columns of the batch, so splitting it doesn't copy any rows.
+  int64_t num_rows = row_batch->num_selected_rows();
+  int64_t slice_rows =
+      std::max<int64_t>(1, num_rows * target_batch_bytes_ / SelectedBytes(*row_batch));
+  std::vector<std::unique_ptr<RowBatch>> slices;
+  for (int64_t start = 0; start < num_rows; start += slice_rows) {
+    int64_t end = std::min(num_rows, start + slice_rows);
+    std::unique_ptr<RowBatch> slice;
+    if (row_batch->has_selection()) {
+      PL_ASSIGN_OR_RETURN(slice, SliceSelection(*row_batch, start, end));
+    } else {
+      PL_ASSIGN_OR_RETURN(slice, row_batch->Slice(start, end - start));
+    }
+    slices.push_back(std::move(slice));
+  }
+  slices.back()->set_eow(row_batch->eow());
+  slices.back()->set_eos(row_batch->eos());
+  ++batches_split_;
+  for (size_t i = slices.size() - 1; i > 0; --i) {
+    pending_batches_.push_front(std::move(slices[i]));
+  }
+  return std::move(slices.front());
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::ReadRowBatch() {
   DCHECK(table_ != nullptr);
 
   if (!cursor_->NextBatchReady()) {
@@ -102,10 +410,22 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
                                   /* eos */ cursor_->Done());
   }
 
+  if (plan_node_->sampled() && plan_node_->sample_blocks() &&
+      !std::bernoulli_distribution(plan_node_->sample_rate())(rng_)) {
+    // Skip the whole batch without reading any of its columns.
+    PL_RETURN_IF_ERROR(cursor_->GetNextRowBatch({}).status());
+    ++batches_skipped_;
+    bool done = cursor_->Done() && !infinite_stream_;
+    return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ done, /* eos */ done);
+  }
+
   PL_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
 
   rows_processed_ += row_batch->num_rows();
   bytes_processed_ += row_batch->NumBytes();
+  if (plan_node_->sampled() && !plan_node_->sample_blocks()) {
+    SampleRows(row_batch.get());
+  }
 
   // If infinite stream is set, we don't send Eow or Eos. Infinite streams therefore never cause
   // HasBatchesRemaining to be false. Instead the outer loop that calls GenerateNext() is
@@ -117,17 +437,70 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   return row_batch;
 }
 
-Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
+void MemorySourceNode::SampleRows(RowBatch* row_batch) {
+  // The gaps between the kept rows are geometrically distributed, which draws one random number
+  // per kept row rather than one per row.
+  std::geometric_distribution<int64_t> gap(plan_node_->sample_rate());
+  auto selection = std::make_shared<std::vector<int64_t>>();
+  int64_t num_rows = row_batch->num_selected_rows();
+  selection->reserve(static_cast<size_t>(num_rows * plan_node_->sample_rate()) + 1);
+  for (int64_t i = gap(rng_); i < num_rows; i += gap(rng_) + 1) {
+    selection->push_back(row_batch->has_selection() ? (*row_batch->selection())[i] : i);
+  }
+  row_batch->set_selection(std::move(selection));
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::NextMorsel(ExecState* exec_state) {
+  DCHECK(!infinite_stream_);
+  absl::MutexLock lock(&morsel_lock_);
+  if (cursor_->Done() && pending_batches_.empty()) {
+    return std::unique_ptr<RowBatch>(nullptr);
+  }
   PL_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+  row_batch->set_eow(false);
+  row_batch->set_eos(false);
+  return row_batch;
+}
+
+Status MemorySourceNode::PrefetchBatches(ExecState* exec_state) {
+  DCHECK(!infinite_stream_);
+  // A cursor that isn't done, but has no batch ready, has to wait for more data. The rest is then
+  // read by GenerateNext() as usual.
+  do {
+    PL_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+    prefetched_batches_.push_back(std::move(row_batch));
+  } while (!prefetched_batches_.back()->eos() && BatchReady());
+  return Status::OK();
+}
+
+Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
+  std::unique_ptr<RowBatch> row_batch;
+  if (!prefetched_batches_.empty()) {
+    row_batch = std::move(prefetched_batches_.front());
+    prefetched_batches_.pop_front();
+  } else {
+    PL_ASSIGN_OR_RETURN(row_batch, GetNextRowBatch(exec_state));
+  }
+  if (join_key_filter_ != nullptr) {
+    // The join key filter reads all of the rows of the batch.
+    if (row_batch->has_selection()) {
+      PL_ASSIGN_OR_RETURN(row_batch, CompactSelection(*row_batch, exec_state->exec_mem_pool()));
+    }
+    PL_ASSIGN_OR_RETURN(row_batch,
+                        join_key_filter_->Filter(*row_batch, exec_state->exec_mem_pool()));
+  }
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
   return Status::OK();
 }
 
-bool MemorySourceNode::InfiniteStreamNextBatchReady() { return cursor_->NextBatchReady(); }
+bool MemorySourceNode::InfiniteStreamNextBatchReady() { return BatchReady(); }
 
 bool MemorySourceNode::NextBatchReady() {
   // Next batch is ready if we haven't seen an eow and if it's an infinite_stream that has batches
-  // to push.
+  // to push. The probe side of a join also waits for the join's filter of its build side keys.
+  if (join_key_filter_ != nullptr && !join_key_filter_->ready()) {
+    return false;
+  }
   return HasBatchesRemaining() && (!infinite_stream_ || InfiniteStreamNextBatchReady());
 }
 
@@ -19,12 +19,20 @@
 #pragma once
 
 #include <stdint.h>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/join_key_filter.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -32,6 +40,8 @@
 #include "src/table_store/table/table.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_memory_source_batch_bytes);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -42,10 +52,55 @@ using table_store::schema::RowBatch;
 class MemorySourceNode : public SourceNode {
  public:
   MemorySourceNode() = default;
-  virtual ~MemorySourceNode() = default;
+  virtual ~MemorySourceNode() { UnsubscribeFromTableWrites(); }
 
   bool NextBatchReady() override;
 
+  /**
+   * SetJoinKeyFilter makes this source, the probe side of a join, wait until the join has
+   * published the filter of its build side keys, and then drop the rows without a match.
+   */
+  void SetJoinKeyFilter(std::shared_ptr<JoinKeyFilter> filter) {
+    join_key_filter_ = std::move(filter);
+  }
+
+  /**
+   * NextMorsel returns the next row batch of the source for one of several threads that process
+   * its output in parallel, and may be called from any of them. Unlike GenerateNext(), batches
+   * never have eow or eos set, since more batches may still be in flight on other threads: the
+   * caller sends the end of stream once they are all done.
+   * @return the next row batch, or nullptr once there are no more.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> NextMorsel(ExecState* exec_state);
+
+  /**
+   * PrefetchBatches reads the row batches of a finite source ahead of the rest of the query, so
+   * that the scans of several sources, such as the tablets of a table, can run on separate
+   * threads. GenerateNext() then sends the prefetched batches as usual. Called after Open(), and
+   * before the source is first run.
+   */
+  Status PrefetchBatches(ExecState* exec_state);
+
+  /**
+   * CommitCursorPosition saves the last row read by this source to its named cursor, if it has
+   * one, so that the next query with the cursor resumes after it. Called once the query has
+   * succeeded, so that the rows of a failed query are read again.
+   */
+  void CommitCursorPosition(ExecState* exec_state);
+
+  /**
+   * SetTableWriteCallback makes an infinite stream source call on_write after each write to its
+   * table, from the writer's thread, so that the execution graph waiting for the source's next
+   * batch resumes right away. The source subscribes to its table once it is opened.
+   */
+  void SetTableWriteCallback(std::function<void()> on_write) { on_write_ = std::move(on_write); }
+
+  /**
+   * UnsubscribeFromTableWrites stops calling the table write callback. This is done when the
+   * source is closed, and must be done before whatever the callback refers to is destroyed.
+   */
+  void UnsubscribeFromTableWrites();
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -55,13 +110,43 @@ class MemorySourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  // Returns the next batch read from the table, resized to about target_batch_bytes_.
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
+  // Returns the next batch of the cursor, as it is stored in the table.
+  StatusOr<std::unique_ptr<RowBatch>> ReadRowBatch();
+  // Merges a small batch with the batches after it that are ready, up to the target size.
+  StatusOr<std::unique_ptr<RowBatch>> CoalesceRowBatch(ExecState* exec_state,
+                                                       std::unique_ptr<RowBatch> row_batch);
+  // Returns the first slice of the target size of a large batch, and queues the others.
+  StatusOr<std::unique_ptr<RowBatch>> SplitRowBatch(std::unique_ptr<RowBatch> row_batch);
+  // Whether a batch can be returned without waiting for the table.
+  bool BatchReady();
+  // Selects a random sample of the rows of the batch, each kept with the plan's sample rate.
+  void SampleRows(RowBatch* row_batch);
   bool InfiniteStreamNextBatchReady();
   // Whether this memory source will stream infinitely. Can be stopped by the
   // exec_state_->keep_running() call in exec_graph.
   bool infinite_stream_ = false;
 
+  // Serializes reads of the cursor by NextMorsel().
+  absl::Mutex morsel_lock_;
   std::unique_ptr<Table::Cursor> cursor_;
+  // The number of the plan's predicates that the cursor skips batches with.
+  size_t num_pushdown_predicates_ = 0;
+  std::shared_ptr<JoinKeyFilter> join_key_filter_;
+  std::function<void()> on_write_;
+  std::optional<Table::WriteSubscriberID> write_subscription_;
+  // Draws the rows or batches kept by a sampled source. Guarded by morsel_lock_ in NextMorsel().
+  std::mt19937_64 rng_{std::random_device{}()};
+  int64_t batches_skipped_ = 0;
+  // The batches read by PrefetchBatches(), which GenerateNext() sends before reading any more.
+  std::deque<std::unique_ptr<RowBatch>> prefetched_batches_;
+  // The batches read from the cursor that are returned before reading any more: the remaining
+  // slices of a split batch, or the batch that stopped the coalescing of the ones before it.
+  std::deque<std::unique_ptr<RowBatch>> pending_batches_;
+  int64_t target_batch_bytes_ = 0;
+  int64_t batches_coalesced_ = 0;
+  int64_t batches_split_ = 0;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
@@ -105,6 +105,50 @@ TEST_F(MemorySourceNodeTest, basic) {
   EXPECT_EQ(sizeof(int64_t) * 5, tester.node()->BytesProcessed());
 }
 
+TEST_F(MemorySourceNodeTest, coalesce_small_batches) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_carnot_memory_source_batch_bytes = 1024;
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 5, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({1, 2, 3, 5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(5, tester.node()->RowsProcessed());
+}
+
+TEST_F(MemorySourceNodeTest, split_large_batches) {
+  gflags::FlagSaver flag_saver;
+  // The size of one row of the time column.
+  FLAGS_carnot_memory_source_batch_bytes = sizeof(int64_t);
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  for (int64_t time : {1, 2, 3}) {
+    EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+    tester.GenerateNextResult().ExpectRowBatch(
+        RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+            .AddColumn<types::Time64NSValue>({time})
+            .get());
+  }
+  // The second batch is within twice the target size, so it is sent as it is.
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+}
+
 TEST_F(MemorySourceNodeTest, empty_table) {
   auto op_proto = planpb::testutils::CreateTestSource1PB("empty");
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -161,6 +205,199 @@ TEST_F(MemorySourceNodeTest, added_batch) {
   EXPECT_EQ(sizeof(int64_t) * 5, tester.node()->BytesProcessed());
 }
 
+TEST_F(MemorySourceNodeTest, resume_from_cursor) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  op_proto.mutable_mem_source_op()->set_cursor_name("export");
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  {
+    auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+        *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+    tester.GenerateNextResult();
+    tester.GenerateNextResult();
+    EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+    tester.Close();
+    tester.node()->CommitCursorPosition(exec_state_.get());
+    EXPECT_EQ(5, tester.node()->RowsProcessed());
+  }
+
+  auto rb = RowBatch(RowDescriptor(cpu_table_->GetRelation().col_types()), 2);
+  std::vector<types::BoolValue> col1_in = {true, true};
+  std::vector<types::Time64NSValue> col2_in = {7, 8};
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col1_in, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col2_in, arrow::default_memory_pool())));
+  EXPECT_OK(cpu_table_->WriteRowBatch(rb));
+
+  // Only the rows added since the last query with the cursor are read.
+  {
+    auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+        *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+    tester.GenerateNextResult().ExpectRowBatch(
+        RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+            .AddColumn<types::Time64NSValue>({7, 8})
+            .get());
+    tester.Close();
+    tester.node()->CommitCursorPosition(exec_state_.get());
+  }
+
+  {
+    auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+        *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+    tester.GenerateNextResult().ExpectRowBatch(
+        RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+            .AddColumn<types::Time64NSValue>({})
+            .get());
+    tester.Close();
+  }
+
+  // Other cursors, and sources without one, still read the whole table.
+  op_proto.mutable_mem_source_op()->set_cursor_name("other");
+  plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 3, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({1, 2, 3})
+          .get());
+  tester.Close();
+}
+
+TEST_F(MemorySourceNodeTest, pushdown_predicates) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  // 4 <= time_.
+  auto func = op_proto.mutable_mem_source_op()->add_predicates()->mutable_func();
+  func->set_name("lessThanEqual");
+  auto constant = func->add_args()->mutable_constant();
+  constant->set_data_type(types::DataType::TIME64NS);
+  constant->set_time64_ns_value(4);
+  func->add_args()->mutable_column()->set_index(0);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  // The first batch has no rows that satisfy the predicate.
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(2, tester.node()->RowsProcessed());
+}
+
+TEST_F(MemorySourceNodeTest, pushdown_predicates_filter_rows) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  // 1 < time_.
+  auto func = op_proto.mutable_mem_source_op()->add_predicates()->mutable_func();
+  func->set_name("lessThan");
+  auto constant = func->add_args()->mutable_constant();
+  constant->set_data_type(types::DataType::TIME64NS);
+  constant->set_time64_ns_value(1);
+  func->add_args()->mutable_column()->set_index(0);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  // The rows of the first batch that don't satisfy the predicate are dropped by the source.
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({2, 3})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(4, tester.node()->RowsProcessed());
+}
+
+class MemorySourceNodeSampleTest : public MemorySourceNodeTest {
+ protected:
+  void SetUp() override {
+    MemorySourceNodeTest::SetUp();
+    table_store::schema::Relation rel(
+        {types::DataType::INT64, types::DataType::INT64, types::DataType::TIME64NS},
+        {"value", "row", "time_"});
+    auto table = Table::Create("sampled", rel);
+    for (const auto& rb : GenerateBenchmarkBatches(kNumBatches, kRowsPerBatch, 10)) {
+      EXPECT_OK(table->WriteRowBatch(rb));
+    }
+    exec_state_->table_store()->AddTable("sampled", table);
+  }
+
+  // Reads the sampled table with the given sample rate, and returns the row numbers read from
+  // each batch.
+  std::vector<std::vector<int64_t>> ReadSample(double sample_rate, bool sample_blocks) {
+    auto op_proto = planpb::testutils::CreateTestSource1PB("sampled");
+    op_proto.mutable_mem_source_op()->set_column_types(0, types::DataType::INT64);
+    op_proto.mutable_mem_source_op()->set_sample_rate(sample_rate);
+    op_proto.mutable_mem_source_op()->set_sample_blocks(sample_blocks);
+    std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+    RowDescriptor output_rd({types::DataType::INT64});
+
+    auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+        *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+    std::vector<std::vector<int64_t>> batches;
+    while (tester.node()->HasBatchesRemaining()) {
+      auto rb = tester.GenerateNextResult().PopRowBatch();
+      auto& rows = batches.emplace_back();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        rows.push_back(types::GetValueFromArrowArray<types::DataType::INT64>(
+            rb->ColumnAt(0).get(), i));
+      }
+      EXPECT_EQ(rb->eos(), !tester.node()->HasBatchesRemaining());
+    }
+    tester.Close();
+    // Sampled rows are read and then dropped, but skipped blocks aren't read at all.
+    if (!sample_blocks) {
+      EXPECT_EQ(kNumBatches * kRowsPerBatch, tester.node()->RowsProcessed());
+    }
+    return batches;
+  }
+
+  static constexpr int64_t kNumBatches = 100;
+  static constexpr int64_t kRowsPerBatch = 100;
+};
+
+TEST_F(MemorySourceNodeSampleTest, sample_rows) {
+  auto batches = ReadSample(0.1, /* sample_blocks */ false);
+  ASSERT_EQ(kNumBatches, static_cast<int64_t>(batches.size()));
+  int64_t num_rows = 0;
+  int64_t last_row = -1;
+  for (const auto& rows : batches) {
+    for (auto row : rows) {
+      EXPECT_GT(row, last_row);
+      last_row = row;
+    }
+    num_rows += rows.size();
+  }
+  // 1000 rows are expected to be kept, with a standard deviation of 30.
+  EXPECT_GT(num_rows, 700);
+  EXPECT_LT(num_rows, 1300);
+}
+
+TEST_F(MemorySourceNodeSampleTest, sample_blocks) {
+  auto batches = ReadSample(0.5, /* sample_blocks */ true);
+  ASSERT_EQ(kNumBatches, static_cast<int64_t>(batches.size()));
+  int64_t num_kept = 0;
+  for (const auto& [i, rows] : Enumerate(batches)) {
+    // Batches are either kept or skipped as a whole.
+    if (rows.empty()) {
+      continue;
+    }
+    ++num_kept;
+    ASSERT_EQ(kRowsPerBatch, static_cast<int64_t>(rows.size()));
+    EXPECT_EQ(static_cast<int64_t>(i) * kRowsPerBatch, rows[0]);
+  }
+  // 50 batches are expected to be kept, with a standard deviation of 5.
+  EXPECT_GT(num_kept, 20);
+  EXPECT_LT(num_kept, 80);
+}
+
 TEST_F(MemorySourceNodeTest, range) {
   auto op_proto = planpb::testutils::CreateTestSourceRangePB();
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -395,7 +632,7 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   EXPECT_TRUE(tester.node()->HasBatchesRemaining());
 
   // Force a table compaction between MemorySource::Open and MemorySource::Exec.
-  EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(cpu_table_->CompactHotToCold());
 
   tester.GenerateNextResult().ExpectRowBatch(
       RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
@@ -404,7 +641,7 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   EXPECT_TRUE(tester.node()->HasBatchesRemaining());
 
   // Force a second compaction to check between Exec and a subsequent Exec.
-  EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(cpu_table_->CompactHotToCold());
 
   tester.GenerateNextResult().ExpectRowBatch(
       RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
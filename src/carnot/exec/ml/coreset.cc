@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/carnot/exec/ml/distance.h"
 #include "src/carnot/exec/ml/sampling.h"
 
 namespace px {
@@ -28,8 +29,9 @@ namespace ml {
 
 void KMeansCoreset::Construct(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights) {
   auto weight_sum = weights.sum();
-  auto weighted_mean = ((weights.transpose() * points) / weight_sum).eval();
-  auto dists = (points.rowwise() - weighted_mean).rowwise().squaredNorm().eval();
+  Eigen::RowVectorXf weighted_mean = (weights.transpose() * points) / weight_sum;
+  Eigen::VectorXf dists;
+  SquaredDistances(points, weighted_mean, /*pool*/ nullptr, &dists);
   auto weighted_dists = (weights.array() * dists.array()).matrix().eval();
   auto weighted_dists_sum = weighted_dists.sum();
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/ml/distance.h"
+
+#include <algorithm>
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+namespace {
+
+template <typename TFn>
+void ForEachBlock(Eigen::Index num_rows, ThreadPool* pool, const TFn& fn) {
+  size_t num_blocks = (num_rows + kDistanceBlockRows - 1) / kDistanceBlockRows;
+  ParallelFor(pool, num_blocks, [&](size_t block) {
+    Eigen::Index begin = block * kDistanceBlockRows;
+    fn(begin, std::min(kDistanceBlockRows, num_rows - begin));
+  });
+}
+
+}  // namespace
+
+void SquaredDistances(const Eigen::MatrixXf& points, const Eigen::RowVectorXf& point,
+                      ThreadPool* pool, Eigen::VectorXf* dists) {
+  dists->resize(points.rows());
+  ForEachBlock(points.rows(), pool, [&](Eigen::Index begin, Eigen::Index rows) {
+    dists->segment(begin, rows) =
+        (points.middleRows(begin, rows).rowwise() - point).rowwise().squaredNorm();
+  });
+}
+
+void ClosestCentroids(const Eigen::MatrixXf& points, const Eigen::MatrixXf& centroids,
+                      ThreadPool* pool, Eigen::VectorXi* closest, Eigen::VectorXf* min_dists) {
+  closest->resize(points.rows());
+  min_dists->resize(points.rows());
+  Eigen::RowVectorXf centroid_norms = centroids.rowwise().squaredNorm().transpose();
+  ForEachBlock(points.rows(), pool, [&](Eigen::Index begin, Eigen::Index rows) {
+    auto block = points.middleRows(begin, rows);
+    Eigen::MatrixXf dists = block * centroids.transpose();
+    dists *= -2.0f;
+    dists.rowwise() += centroid_norms;
+    dists.colwise() += block.rowwise().squaredNorm();
+    for (Eigen::Index i = 0; i < rows; ++i) {
+      Eigen::Index closest_centroid;
+      float dist = dists.row(i).minCoeff(&closest_centroid);
+      (*closest)(begin + i) = static_cast<int>(closest_centroid);
+      // The expansion can go slightly negative from rounding.
+      (*min_dists)(begin + i) = std::max(dist, 0.0f);
+    }
+  });
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
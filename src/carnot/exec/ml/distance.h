@@ -0,0 +1,53 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "third_party/eigen3/Eigen/Core"
+
+#include "src/common/base/thread_pool.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+/**
+ * The distance kernels work on blocks of this many points, which are spread over the thread pool
+ * when one is given. The blocks are the same for any number of threads, so the results are too.
+ */
+constexpr Eigen::Index kDistanceBlockRows = 256;
+
+/**
+ * Sets (*dists)(i) to the squared distance from row i of points to the given point.
+ */
+void SquaredDistances(const Eigen::MatrixXf& points, const Eigen::RowVectorXf& point,
+                      ThreadPool* pool, Eigen::VectorXf* dists);
+
+/**
+ * Sets (*closest)(i) to the index of the centroid closest to row i of points, and (*min_dists)(i)
+ * to the squared distance to it. Distances are computed as ||p||^2 - 2 p.c + ||c||^2, so the dot
+ * products of a block of points with all centroids are a single (vectorized) matrix product.
+ */
+void ClosestCentroids(const Eigen::MatrixXf& points, const Eigen::MatrixXf& centroids,
+                      ThreadPool* pool, Eigen::VectorXi* closest, Eigen::VectorXf* min_dists);
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "src/carnot/exec/ml/distance.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+TEST(ClosestCentroids, matches_direct_computation) {
+  std::srand(3);
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(3 * kDistanceBlockRows + 17, 12);
+  Eigen::MatrixXf centroids = Eigen::MatrixXf::Random(6, 12);
+
+  ThreadPool pool(3);
+  Eigen::VectorXi closest;
+  Eigen::VectorXf min_dists;
+  ClosestCentroids(points, centroids, &pool, &closest, &min_dists);
+
+  ASSERT_EQ(closest.size(), points.rows());
+  for (Eigen::Index i = 0; i < points.rows(); ++i) {
+    Eigen::VectorXf dists = (centroids.rowwise() - points.row(i)).rowwise().squaredNorm();
+    EXPECT_NEAR(min_dists(i), dists.minCoeff(), 1e-4f);
+    // Ties within rounding error may resolve either way.
+    EXPECT_NEAR(dists(closest(i)), dists.minCoeff(), 1e-4f);
+  }
+}
+
+TEST(SquaredDistances, with_and_without_pool) {
+  std::srand(5);
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(2 * kDistanceBlockRows + 1, 7);
+  Eigen::RowVectorXf point = Eigen::RowVectorXf::Random(7);
+
+  Eigen::VectorXf expected = (points.rowwise() - point).rowwise().squaredNorm();
+
+  Eigen::VectorXf dists;
+  SquaredDistances(points, point, /*pool*/ nullptr, &dists);
+  EXPECT_EQ(dists, expected);
+
+  ThreadPool pool(2);
+  SquaredDistances(points, point, &pool, &dists);
+  EXPECT_EQ(dists, expected);
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -19,6 +19,7 @@
 #include "src/carnot/exec/ml/kmeans.h"
 #include <random>
 
+#include "src/carnot/exec/ml/distance.h"
 #include "src/carnot/exec/ml/sampling.h"
 
 namespace px {
@@ -52,12 +53,13 @@ bool KMeans::LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorX
   Eigen::MatrixXf new_centroids = Eigen::MatrixXf::Zero(centroids_.rows(), centroids_.cols());
   Eigen::ArrayXf centroid_weights = Eigen::ArrayXf::Zero(centroids_.rows());
 
+  Eigen::VectorXi closest;
+  Eigen::VectorXf min_dists;
+  ClosestCentroids(points, centroids_, pool_, &closest, &min_dists);
+
+  // Accumulate sequentially, so that the sums don't depend on how the points were split up.
   for (int i = 0; i < points.rows(); i++) {
-    Eigen::VectorXf::Index closest_centroid;
-    (centroids_.rowwise() - points(i, Eigen::indexing::all))
-        .rowwise()
-        .squaredNorm()
-        .minCoeff(&closest_centroid);
+    int closest_centroid = closest(i);
     new_centroids(closest_centroid, Eigen::indexing::all) +=
         weights(i) * points(i, Eigen::indexing::all);
     centroid_weights(closest_centroid) += weights(i);
@@ -83,20 +85,21 @@ void KMeans::KMeansPlusPlusInit(const Eigen::MatrixXf& points, const Eigen::Vect
   auto firstCentroid = dist(random_gen_);
   centroids_(0, Eigen::indexing::all) = points(firstCentroid, Eigen::indexing::all);
 
+  // minDists holds the distance from each point to its closest chosen centroid, and only needs to
+  // be updated with the distances to the newest centroid after each step.
+  Eigen::VectorXf minDists;
+  Eigen::VectorXf newDists;
+  SquaredDistances(points, centroids_.row(0), pool_, &minDists);
   Eigen::VectorXf probDist(points.rows());
   for (auto i = 1; i < k_; i++) {
-    for (auto j = 0; j < probDist.rows(); j++) {
-      auto point = points(j, Eigen::indexing::all);
-      Eigen::VectorXf::Index closestCentroid;
-      auto dist = (centroids_(Eigen::seq(0, i - 1), Eigen::indexing::all).rowwise() - point)
-                      .rowwise()
-                      .squaredNorm()
-                      .minCoeff(&closestCentroid);
-      probDist(j) = weights(j) * dist;
-    }
+    probDist = weights.cwiseProduct(minDists);
     std::discrete_distribution<> pointDist(probDist.begin(), probDist.end());
     auto ind = pointDist(random_gen_);
     centroids_(i, Eigen::indexing::all) = points(ind, Eigen::indexing::all);
+    if (i + 1 < k_) {
+      SquaredDistances(points, centroids_.row(i), pool_, &newDists);
+      minDists = minDists.cwiseMin(newDists);
+    }
   }
 }
 
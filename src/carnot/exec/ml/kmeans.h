@@ -23,6 +23,7 @@
 #include <string>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/common/base/thread_pool.h"
 
 namespace px {
 namespace carnot {
@@ -53,6 +54,12 @@ class KMeans {
 
   const Eigen::MatrixXf& centroids() const { return centroids_; }
 
+  /**
+   * Spreads the distance computations of Fit over the given pool, which must outlive this object.
+   * The fitted centroids are the same with or without a pool.
+   **/
+  void set_thread_pool(ThreadPool* pool) { pool_ = pool; }
+
   std::string ToJSON();
   void FromJSON(std::string data);
 
@@ -65,6 +72,7 @@ class KMeans {
   KMeansInitType init_type_;
   Eigen::MatrixXf centroids_;
   std::mt19937 random_gen_;
+  ThreadPool* pool_ = nullptr;
 };
 
 }  // namespace ml
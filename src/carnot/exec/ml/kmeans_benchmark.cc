@@ -40,6 +40,25 @@ static void BM_KMeansFit(benchmark::State& state) {
   }
 }
 
+// Args are the number of points, their dimension and the number of threads.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_KMeansFitLarge(benchmark::State& state) {
+  int n = state.range(0);
+  int d = state.range(1);
+  px::ThreadPool pool(state.range(2));
+  KMeans kmeans(/*k*/ 16);
+  kmeans.set_thread_pool(&pool);
+
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(n, d);
+  Eigen::VectorXf weights = Eigen::VectorXf::Random(n).cwiseAbs();
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  for (auto _ : state) {
+    kmeans.Fit(set);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_KMeansTransform(benchmark::State& state) {
   int k = 10;
@@ -59,4 +78,11 @@ static void BM_KMeansTransform(benchmark::State& state) {
 }
 
 BENCHMARK(BM_KMeansFit);
+BENCHMARK(BM_KMeansFitLarge)
+    ->Args({10000, 16, 0})
+    ->Args({10000, 128, 0})
+    ->Args({10000, 128, 4})
+    ->Args({100000, 128, 0})
+    ->Args({100000, 128, 4})
+    ->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_KMeansTransform);
@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <memory>
 #include <set>
 #include <vector>
@@ -97,6 +98,25 @@ TEST(KMeans, trimodal_normal_dist) {
   }
 }
 
+TEST(KMeans, thread_pool_gives_same_centroids) {
+  int k = 8;
+  std::srand(7);
+  // Enough points to be split into several distance blocks.
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(2000, 16);
+  Eigen::VectorXf weights = Eigen::VectorXf::Random(2000).cwiseAbs();
+  auto set = std::make_shared<WeightedPointSet>(points, weights);
+
+  KMeans single_threaded(k);
+  single_threaded.Fit(set);
+
+  ThreadPool pool(4);
+  KMeans multi_threaded(k);
+  multi_threaded.set_thread_pool(&pool);
+  multi_threaded.Fit(set);
+
+  EXPECT_EQ(single_threaded.centroids(), multi_threaded.centroids());
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -36,6 +38,11 @@ enum ModelType {
 class ModelExecutor {
  public:
   virtual ~ModelExecutor() = default;
+
+  /**
+   * The memory held by this executor, which is what the ModelPool counts against its limit.
+   */
+  virtual int64_t MemoryUsageBytes() const { return 0; }
 };
 
 }  // namespace ml
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/ml/model_pool.h"
+
+#include "src/carnot/exec/ml/transformer_executor.h"
+
+DEFINE_int64(carnot_model_pool_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_MODEL_POOL_MEMORY_LIMIT_BYTES", 1024 * 1024 * 1024),
+             "The memory that loaded ML models may use. Models beyond the first executor of each "
+             "are unloaded or not loaded to stay under it.");
+DEFINE_string(carnot_preload_embedding_model,
+              gflags::StringFromEnv("PL_CARNOT_PRELOAD_EMBEDDING_MODEL", ""),
+              "If set, the path of a transformer embedding model to load at startup, eg. "
+              "/embedding.proto for the default model of the transformer UDF.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+namespace ml {
+
+std::unique_ptr<ModelPool> ModelPool::Create() {
+  auto pool = std::make_unique<ModelPool>(FLAGS_carnot_model_pool_memory_limit_bytes);
+  if (!FLAGS_carnot_preload_embedding_model.empty()) {
+    pool->Preload<TransformerExecutor>(FLAGS_carnot_preload_embedding_model);
+  }
+  return pool;
+}
+
+size_t ModelPool::num_executors() {
+  absl::MutexLock lock(&mu_);
+  size_t num_executors = 0;
+  for (const auto& [key, entry] : entries_) {
+    num_executors += entry.num_executors;
+  }
+  return num_executors;
+}
+
+ModelPool::PtrType ModelPool::BorrowOrReserve(const std::string& key, bool* load) {
+  absl::MutexLock lock(&mu_);
+  Entry& entry = entries_[key];
+  entry.last_used = ++clock_;
+  auto ptr = entry.pool->Borrow();
+  if (ptr != nullptr) {
+    return ptr;
+  }
+  if (entry.num_executors == 0) {
+    *load = true;
+  } else if (entry.executor_bytes > 0) {
+    // The size of the first executor isn't known until it is loaded, until then others wait.
+    EvictIdle(key, entry.executor_bytes);
+    *load = memory_usage_bytes_ + entry.executor_bytes <= memory_limit_bytes_;
+  }
+  if (*load) {
+    entry.num_executors++;
+  }
+  return nullptr;
+}
+
+void ModelPool::AddExecutor(const std::string& key, std::unique_ptr<ModelExecutor> executor) {
+  int64_t bytes = executor->MemoryUsageBytes();
+  absl::MutexLock lock(&mu_);
+  Entry& entry = entries_[key];
+  entry.executor_bytes = bytes;
+  memory_usage_bytes_ += bytes;
+  EvictIdle(key, 0);
+  entry.pool->Add(std::move(executor));
+}
+
+void ModelPool::EvictIdle(const std::string& key, int64_t bytes) {
+  while (memory_usage_bytes_ + bytes > memory_limit_bytes_) {
+    Entry* lru = nullptr;
+    for (auto& [entry_key, entry] : entries_) {
+      if (entry_key == key || entry.pool->Size() == 0) {
+        continue;
+      }
+      if (lru == nullptr || entry.last_used < lru->last_used) {
+        lru = &entry;
+      }
+    }
+    if (lru == nullptr) {
+      return;
+    }
+    auto idle = lru->pool->Borrow();
+    if (idle == nullptr) {
+      return;
+    }
+    std::unique_ptr<ModelExecutor> unloaded(idle.release());
+    lru->num_executors--;
+    memory_usage_bytes_ -= lru->executor_bytes;
+  }
+}
+
+}  // namespace ml
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
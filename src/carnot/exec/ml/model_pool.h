@@ -18,36 +18,48 @@
 
 #pragma once
 
-#include <absl/base/internal/spinlock.h>
+#include <gflags/gflags.h>
+
 #include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
-#include <unordered_map>
 #include <utility>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/exec/ml/borrow_pool.h"
 #include "src/carnot/exec/ml/model_executor.h"
 
+DECLARE_int64(carnot_model_pool_memory_limit_bytes);
+DECLARE_string(carnot_preload_embedding_model);
+
 namespace px {
 namespace carnot {
 namespace exec {
 namespace ml {
 
+/**
+ * ModelPool keeps loaded models warm across queries. Each model, identified by its executor type
+ * and constructor args, has a pool of executors. When all of a model's executors are borrowed,
+ * another is loaded if it fits under the memory limit, making room by unloading idle executors of
+ * the least recently used models. A model's first executor is always loaded, so that every query
+ * can make progress.
+ */
 class ModelPool {
  public:
   using PoolType = BorrowPool<ModelExecutor>;
   using PtrType = PoolType::BorrowedPtrType;
 
-  static std::unique_ptr<ModelPool> Create() { return std::make_unique<ModelPool>(); }
+  explicit ModelPool(int64_t memory_limit_bytes) : memory_limit_bytes_(memory_limit_bytes) {}
 
-  template <typename TExecutor, typename... Args>
-  void CreatePool(Args... args) {
-    // TODO(james, PP-2594): currently if you ask for the same type of model with different args the
-    // pool will return the first args asked for.
-    auto pool = std::make_unique<PoolType>();
-    pool->Add(std::make_unique<TExecutor>(args...));
-    pool_map_[TExecutor::Type()] = std::move(pool);
-  }
+  /**
+   * Creates a pool with the memory limit set by the flags, and loads the models they name.
+   */
+  static std::unique_ptr<ModelPool> Create();
 
   template <typename TExecutor>
   struct DerivedDeleter {
@@ -55,21 +67,78 @@ class ModelPool {
     PoolType::ReclaimDeleter deleter_;
   };
 
+  /**
+   * Loads an executor for the model, unless there is one already, so that the first query using
+   * the model doesn't wait for it to load.
+   */
   template <typename TExecutor, typename... Args>
-  std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>> GetModelExecutor(Args... args) {
-    if (pool_map_.find(TExecutor::Type()) == pool_map_.end()) {
-      CreatePool<TExecutor>(args...);
+  void Preload(Args... args) {
+    auto key = Key<TExecutor>(args...);
+    {
+      absl::MutexLock lock(&mu_);
+      Entry& entry = entries_[key];
+      if (entry.num_executors > 0) {
+        return;
+      }
+      entry.num_executors++;
     }
-    auto ptr = pool_map_[TExecutor::Type()]->Borrow();
-    while (ptr == nullptr) {
-      ptr = pool_map_[TExecutor::Type()]->Borrow();
+    AddExecutor(key, std::make_unique<TExecutor>(args...));
+  }
+
+  template <typename TExecutor, typename... Args>
+  std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>> GetModelExecutor(Args... args) {
+    auto key = Key<TExecutor>(args...);
+    while (true) {
+      bool load = false;
+      PtrType ptr = BorrowOrReserve(key, &load);
+      if (ptr != nullptr) {
+        return std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>>(
+            static_cast<TExecutor*>(ptr.release()), DerivedDeleter<TExecutor>{ptr.get_deleter()});
+      }
+      if (load) {
+        // Loading can take a while, so it is done without holding the lock.
+        AddExecutor(key, std::make_unique<TExecutor>(args...));
+        continue;
+      }
       std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-    return std::unique_ptr<TExecutor, DerivedDeleter<TExecutor>>(
-        static_cast<TExecutor*>(ptr.release()), DerivedDeleter<TExecutor>{ptr.get_deleter()});
   }
 
-  std::unordered_map<ModelType, std::unique_ptr<PoolType>> pool_map_;
+  int64_t memory_usage_bytes() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return memory_usage_bytes_;
+  }
+
+  size_t num_executors() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::unique_ptr<PoolType> pool = std::make_unique<PoolType>();
+    // Executors that are loaded or being loaded, whether idle or borrowed.
+    size_t num_executors = 0;
+    int64_t executor_bytes = 0;
+    uint64_t last_used = 0;
+  };
+
+  template <typename TExecutor, typename... Args>
+  static std::string Key(const Args&... args) {
+    return absl::StrCat(static_cast<int>(TExecutor::Type()), ":", args...);
+  }
+
+  // Borrows an idle executor of the model. If there is none, sets load when the caller should
+  // load another one, which is then counted as one of the model's executors.
+  PtrType BorrowOrReserve(const std::string& key, bool* load) ABSL_LOCKS_EXCLUDED(mu_);
+  void AddExecutor(const std::string& key, std::unique_ptr<ModelExecutor> executor)
+      ABSL_LOCKS_EXCLUDED(mu_);
+  // Unloads idle executors of models other than key, least recently used first, until bytes more
+  // fit under the limit or there are none left.
+  void EvictIdle(const std::string& key, int64_t bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t memory_limit_bytes_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  int64_t memory_usage_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  uint64_t clock_ ABSL_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace ml
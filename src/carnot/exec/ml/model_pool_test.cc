@@ -19,6 +19,9 @@
 #include "src/carnot/exec/ml/model_pool.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+
+#include <string>
+
 #include "src/carnot/exec/ml/transformer_executor.h"
 
 DEFINE_string(embedding_dir, "", "Path to embedding.proto");
@@ -34,6 +37,67 @@ TEST(ModelPool, basic) {
   EXPECT_EQ(kTransformer, executor->Type());
 }
 
+class FakeExecutor : public ModelExecutor {
+ public:
+  explicit FakeExecutor(std::string name) : name_(name) { num_loads++; }
+  static constexpr ModelType Type() { return kTransformer; }
+  int64_t MemoryUsageBytes() const override { return 100; }
+  const std::string& name() const { return name_; }
+
+  static inline int num_loads = 0;
+
+ private:
+  std::string name_;
+};
+
+TEST(ModelPool, keeps_executors_warm) {
+  FakeExecutor::num_loads = 0;
+  ModelPool p(/*memory_limit_bytes*/ 1000);
+  p.Preload<FakeExecutor>(std::string("a"));
+  EXPECT_EQ(1, FakeExecutor::num_loads);
+  for (int i = 0; i < 3; ++i) {
+    auto executor = p.GetModelExecutor<FakeExecutor>(std::string("a"));
+    EXPECT_EQ("a", executor->name());
+  }
+  EXPECT_EQ(1, FakeExecutor::num_loads);
+  EXPECT_EQ(100, p.memory_usage_bytes());
+
+  // A different model gets its own executors.
+  EXPECT_EQ("b", p.GetModelExecutor<FakeExecutor>(std::string("b"))->name());
+  EXPECT_EQ(2, FakeExecutor::num_loads);
+  EXPECT_EQ(200, p.memory_usage_bytes());
+}
+
+TEST(ModelPool, loads_more_executors_when_all_are_borrowed) {
+  FakeExecutor::num_loads = 0;
+  ModelPool p(/*memory_limit_bytes*/ 250);
+  auto e1 = p.GetModelExecutor<FakeExecutor>(std::string("a"));
+  auto e2 = p.GetModelExecutor<FakeExecutor>(std::string("a"));
+  EXPECT_NE(e1.get(), e2.get());
+  EXPECT_EQ(2U, p.num_executors());
+  EXPECT_EQ(200, p.memory_usage_bytes());
+}
+
+TEST(ModelPool, unloads_least_recently_used_idle_models) {
+  FakeExecutor::num_loads = 0;
+  ModelPool p(/*memory_limit_bytes*/ 250);
+  p.GetModelExecutor<FakeExecutor>(std::string("a"));
+  p.GetModelExecutor<FakeExecutor>(std::string("b"));
+  p.GetModelExecutor<FakeExecutor>(std::string("a"));
+  EXPECT_EQ(2, FakeExecutor::num_loads);
+
+  // Loading c goes over the limit, so b is unloaded.
+  p.GetModelExecutor<FakeExecutor>(std::string("c"));
+  EXPECT_EQ(3, FakeExecutor::num_loads);
+  EXPECT_EQ(2U, p.num_executors());
+  EXPECT_EQ(200, p.memory_usage_bytes());
+
+  p.GetModelExecutor<FakeExecutor>(std::string("a"));
+  EXPECT_EQ(3, FakeExecutor::num_loads);
+  p.GetModelExecutor<FakeExecutor>(std::string("b"));
+  EXPECT_EQ(4, FakeExecutor::num_loads);
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
@@ -18,12 +18,15 @@
 
 #include "src/carnot/exec/ml/transformer_executor.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace px {
 namespace carnot {
 namespace exec {
 namespace ml {
 
-static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
+static int load_ints_from_json(const std::string& in, int32_t* arr, int max_num) {
   rapidjson::Document d;
   rapidjson::ParseResult ok = d.Parse(in.data());
   // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
@@ -50,56 +53,99 @@ static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
 }
 
 void TransformerExecutor::Execute(std::string doc, std::string* out) {
-  // LOG(INFO) << "inputs: " << tf_interpreter_->inputs().size() << "\n";
-  // LOG(INFO) << "input(0) name: " << tf_interpreter_->GetInputName(0) << "\n";
+  std::vector<std::string> outs;
+  ExecuteBatch({&doc}, &outs);
+  *out = std::move(outs[0]);
+}
 
-  // int t_size = tf_interpreter_->tensors_size();
-  // for (int i = 0; i < t_size; i++) {
-  //   if (tf_interpreter_->tensor(i)->name) {
-  //     LOG(INFO) << i << ": " << tf_interpreter_->tensor(i)->name << ", "
-  //               << tf_interpreter_->tensor(i)->bytes << ", "
-  //               << tf_interpreter_->tensor(i)->type;
-  //   }
-  // }
-  auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
-  if (input == nullptr) {
-    LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
-    *out = "";
-    return;
+bool TransformerExecutor::ResizeBatch(int batch_size) {
+  if (batch_size == batch_size_) {
+    return true;
   }
-
-  auto count = load_ints_from_json(doc, input, max_length_);
-  if (count == 0) {
-    // Either input array was empty or there was an error parsing the json, either way don't
-    // continue.
-    *out = "";
-    return;
+  if (tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0],
+                                         {batch_size, max_length_}) != kTfLiteOk ||
+      tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    return false;
   }
+  batch_size_ = batch_size;
+  const TfLiteTensor* output = tf_interpreter_->tensor(tf_interpreter_->outputs()[0]);
+  return output->dims->size > 0 && output->dims->data[0] == batch_size;
+}
 
-  // Add 1 to each token to account for pad token.
-  for (int i = 0; i < count; i++) {
-    input[i] = input[i] + 1;
+void TransformerExecutor::ExecuteBatch(const std::vector<const std::string*>& docs,
+                                       std::vector<std::string>* outs) {
+  outs->assign(docs.size(), "");
+  if (tf_interpreter_->typed_input_tensor<int32_t>(0) == nullptr) {
+    LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
+    return;
   }
 
-  for (int i = count; i < max_length_; i++) {
-    input[i] = 0;
+  // Tokens of the docs that parsed, padded to max_length_.
+  std::vector<int32_t> tokens;
+  std::vector<size_t> rows;
+  std::vector<int32_t> doc_tokens(max_length_);
+  for (const auto& [i, doc] : Enumerate(docs)) {
+    auto count = load_ints_from_json(*doc, doc_tokens.data(), max_length_);
+    if (count == 0) {
+      // Either input array was empty or there was an error parsing the json, either way don't
+      // run it through the model.
+      continue;
+    }
+    rows.push_back(i);
+    // Add 1 to each token to account for pad token.
+    for (int j = 0; j < count; j++) {
+      tokens.push_back(doc_tokens[j] + 1);
+    }
+    tokens.resize(rows.size() * max_length_, 0);
   }
 
-  const int embedding_size = 256;
+  size_t begin = 0;
+  while (begin < rows.size()) {
+    int batch_size = 1;
+    if (supports_batching_) {
+      batch_size = static_cast<int>(std::min<size_t>(kMaxBatchSize, rows.size() - begin));
+      if (!ResizeBatch(batch_size)) {
+        LOG(INFO) << "Transformer model doesn't support batched inputs, running one row at a time";
+        supports_batching_ = false;
+        batch_size = 1;
+      }
+    }
+    if (!ResizeBatch(batch_size)) {
+      LOG(INFO) << "Failed to allocate tensors";
+      return;
+    }
 
-  tf_interpreter_->Invoke();
+    auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
+    std::copy_n(tokens.begin() + begin * max_length_, batch_size * max_length_, input);
+    tf_interpreter_->Invoke();
+    auto output = tf_interpreter_->typed_output_tensor<float>(0);
 
-  auto output = tf_interpreter_->typed_output_tensor<float>(0);
+    for (int b = 0; b < batch_size; ++b) {
+      // Copy output to json array.
+      rapidjson::StringBuffer sb;
+      rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+      writer.StartArray();
+      for (int i = 0; i < kEmbeddingSize; i++) {
+        writer.Double(output[b * kEmbeddingSize + i]);
+      }
+      writer.EndArray();
+      (*outs)[rows[begin + b]] = sb.GetString();
+    }
+    begin += batch_size;
+  }
+}
 
-  // Copy output to json array.
-  rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (int i = 0; i < embedding_size; i++) {
-    writer.Double(output[i]);
+int64_t TransformerExecutor::MemoryUsageBytes() const {
+  int64_t bytes = 0;
+  if (model_ != nullptr && model_->allocation() != nullptr) {
+    bytes += model_->allocation()->bytes();
+  }
+  if (tf_interpreter_ != nullptr) {
+    for (size_t i = 0; i < tf_interpreter_->tensors_size(); ++i) {
+      bytes += tf_interpreter_->tensor(static_cast<int>(i))->bytes;
+    }
   }
-  writer.EndArray();
-  *out = sb.GetString();
+  return bytes;
 }
 
 }  // namespace ml
@@ -26,6 +26,7 @@
 #include <tensorflow/lite/model.h>
 #include <memory>
 #include <string>
+#include <vector>
 #include "src/carnot/exec/ml/model_executor.h"
 #include "src/common/base/utils.h"
 
@@ -55,10 +56,28 @@ class TransformerExecutor : public ModelExecutor {
 
   void Execute(std::string doc, std::string* out);
 
+  /**
+   * Runs the model on many docs at once, so that each Invoke covers up to kMaxBatchSize rows.
+   * Gives the same outputs as calling Execute on each doc. Docs that are empty or fail to parse
+   * get an empty output, and are left out of the model's input.
+   */
+  void ExecuteBatch(const std::vector<const std::string*>& docs, std::vector<std::string>* outs);
+
+  int64_t MemoryUsageBytes() const override;
+
+  static constexpr int kMaxBatchSize = 32;
+  static constexpr int kEmbeddingSize = 256;
+
  private:
+  // Resizes the input of the model to hold batch_size docs, returning false if the model can't.
+  bool ResizeBatch(int batch_size);
+
   std::unique_ptr<tflite::Interpreter> tf_interpreter_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   int max_length_ = 64;
+  int batch_size_ = 1;
+  // Models exported with a fixed batch dimension only ever run one doc at a time.
+  bool supports_batching_ = true;
 };
 
 }  // namespace ml
@@ -19,6 +19,7 @@
 #include "src/carnot/exec/otel_export_sink_node.h"
 
 #include <rapidjson/document.h>
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <queue>
@@ -37,6 +38,19 @@
 #include "src/shared/types/typespb/types.pb.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_otel_export_batch_rows,
+             gflags::Int64FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_ROWS", 1024),
+             "The number of rows an OTel export sink accumulates before sending them in one "
+             "request.");
+DEFINE_int64(carnot_otel_export_batch_delay_ms,
+             gflags::Int64FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_DELAY_MS", 1000),
+             "How long an OTel export sink accumulates rows before sending them, even if there "
+             "are fewer than carnot_otel_export_batch_rows. Checked as row batches arrive.");
+DEFINE_int32(carnot_otel_export_max_inflight,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_MAX_INFLIGHT", 4),
+             "The number of OTel export requests each sink sends at a time. The query waits "
+             "while that many are in flight. Requests are sent on the query's thread if 0.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -76,6 +90,7 @@ Status OTelExportSinkNode::OpenImpl(ExecState* exec_state) {
   if (plan_node_->spans().size()) {
     trace_service_stub_ = exec_state->TraceServiceStub(plan_node_->url(), plan_node_->insecure());
   }
+  export_pool_ = std::make_unique<ThreadPool>(std::max(FLAGS_carnot_otel_export_max_inflight, 0));
   return Status::OK();
 }
 
@@ -87,9 +102,23 @@ Status OTelExportSinkNode::CloseImpl(ExecState* exec_state) {
   LOG(INFO) << absl::Substitute("Closing OTelExportSinkNode $0 in query $1 before receiving EOS",
                                 plan_node_->id(), exec_state->query_id().str());
 
+  // The rows received so far are still exported.
+  if (export_pool_ != nullptr) {
+    Flush();
+    return WaitForExports();
+  }
   return Status::OK();
 }
 
+std::unique_ptr<grpc::ClientContext> OTelExportSinkNode::CreateClientContext() const {
+  auto context = std::make_unique<grpc::ClientContext>();
+  for (const auto& header : plan_node_->endpoint_headers()) {
+    context->AddMetadata(header.first, header.second);
+  }
+  context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+  return context;
+}
+
 template <typename C>
 void AddAttributes(google::protobuf::RepeatedPtrField<::opentelemetry::proto::common::v1::KeyValue>*
                        mutable_attributes,
@@ -206,16 +235,7 @@ Status FormatOTelStatus(int64_t id, const grpc::Status& status) {
 }
 
 using ::opentelemetry::proto::metrics::v1::ResourceMetrics;
-Status OTelExportSinkNode::ConsumeMetrics(const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
-  }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest request;
-
+void OTelExportSinkNode::ConsumeMetrics(const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     ::opentelemetry::proto::metrics::v1::ResourceMetrics resource_metrics;
     auto resource = resource_metrics.mutable_resource();
@@ -275,17 +295,11 @@ Status OTelExportSinkNode::ConsumeMetrics(const RowBatch& rb) {
     }
     ReplicateData<ResourceMetrics>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceMetrics metrics) {
-          *request.add_resource_metrics() = std::move(metrics);
+        [this](ResourceMetrics metrics) {
+          *pending_metrics_.add_resource_metrics() = std::move(metrics);
         },
         std::move(resource_metrics), rb, row_idx);
   }
-
-  grpc::Status status = metrics_service_stub_->Export(&context, request, &metrics_response_);
-  if (!status.ok()) {
-    return FormatOTelStatus(plan_node_->id(), status);
-  }
-  return Status::OK();
 }
 
 std::string ParseID(const RowBatch& rb, int64_t column_idx, int64_t row_idx) {
@@ -313,16 +327,7 @@ std::string GenerateID(uint64_t num_bytes) {
 }
 
 using ::opentelemetry::proto::trace::v1::ResourceSpans;
-Status OTelExportSinkNode::ConsumeSpans(const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
-  }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest request;
-
+void OTelExportSinkNode::ConsumeSpans(const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     // TODO(philkuz) aggregate spans by resource.
     ::opentelemetry::proto::trace::v1::ResourceSpans resource_spans;
@@ -397,25 +402,97 @@ Status OTelExportSinkNode::ConsumeSpans(const RowBatch& rb) {
 
     ReplicateData<ResourceSpans>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceSpans span) { *request.add_resource_spans() = std::move(span); },
+        [this](ResourceSpans span) { *pending_spans_.add_resource_spans() = std::move(span); },
         std::move(resource_spans), rb, row_idx);
   }
+}
 
-  grpc::Status status = trace_service_stub_->Export(&context, request, &trace_response_);
-  if (!status.ok()) {
-    return FormatOTelStatus(plan_node_->id(), status);
+void OTelExportSinkNode::SendAsync(std::function<Status()> export_fn) {
+  int64_t max_in_flight = std::max(FLAGS_carnot_otel_export_max_inflight, 1);
+  {
+    absl::MutexLock lock(&exports_lock_);
+    auto window_open = [this, max_in_flight]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(exports_lock_) {
+      return exports_in_flight_ < max_in_flight;
+    };
+    exports_lock_.Await(absl::Condition(&window_open));
+    ++exports_in_flight_;
+  }
+  export_pool_->Schedule([this, export_fn = std::move(export_fn)]() {
+    Status s = export_fn();
+    absl::MutexLock lock(&exports_lock_);
+    --exports_in_flight_;
+    if (!s.ok() && export_status_.ok()) {
+      export_status_ = s;
+    }
+  });
+}
+
+Status OTelExportSinkNode::WaitForExports() {
+  absl::MutexLock lock(&exports_lock_);
+  auto done = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(exports_lock_) {
+    return exports_in_flight_ == 0;
+  };
+  exports_lock_.Await(absl::Condition(&done));
+  return export_status_;
+}
+
+Status OTelExportSinkNode::ExportStatus() {
+  absl::MutexLock lock(&exports_lock_);
+  return export_status_;
+}
+
+void OTelExportSinkNode::Flush() {
+  if (pending_rows_ == 0) {
+    return;
+  }
+  pending_rows_ = 0;
+
+  if (plan_node_->metrics().size()) {
+    auto request = std::make_shared<
+        opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest>();
+    request->Swap(&pending_metrics_);
+    SendAsync([this, request]() {
+      auto context = CreateClientContext();
+      opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse response;
+      grpc::Status status = metrics_service_stub_->Export(context.get(), *request, &response);
+      return status.ok() ? Status::OK() : FormatOTelStatus(plan_node_->id(), status);
+    });
+  }
+  if (plan_node_->spans().size()) {
+    auto request =
+        std::make_shared<opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest>();
+    request->Swap(&pending_spans_);
+    SendAsync([this, request]() {
+      auto context = CreateClientContext();
+      opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse response;
+      grpc::Status status = trace_service_stub_->Export(context.get(), *request, &response);
+      return status.ok() ? Status::OK() : FormatOTelStatus(plan_node_->id(), status);
+    });
   }
-  return Status::OK();
 }
 
 Status OTelExportSinkNode::ConsumeNextImpl(ExecState*, const RowBatch& rb, size_t) {
+  // Fail the query as soon as an earlier export has failed.
+  PL_RETURN_IF_ERROR(ExportStatus());
+
+  auto now = std::chrono::steady_clock::now();
+  if (pending_rows_ == 0) {
+    pending_since_ = now;
+  }
   if (plan_node_->metrics().size()) {
-    PL_RETURN_IF_ERROR(ConsumeMetrics(rb));
+    ConsumeMetrics(rb);
   }
   if (plan_node_->spans().size()) {
-    PL_RETURN_IF_ERROR(ConsumeSpans(rb));
+    ConsumeSpans(rb);
+  }
+  pending_rows_ += rb.num_rows();
+
+  if (rb.eos() || pending_rows_ >= FLAGS_carnot_otel_export_batch_rows ||
+      now - pending_since_ >= std::chrono::milliseconds(FLAGS_carnot_otel_export_batch_delay_ms)) {
+    Flush();
   }
   if (rb.eos()) {
+    PL_RETURN_IF_ERROR(WaitForExports());
     sent_eos_ = true;
   }
   return Status::OK();
@@ -18,17 +18,26 @@
 #pragma once
 
 #include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/shared/types/types.h"
 
+DECLARE_int64(carnot_otel_export_batch_rows);
+DECLARE_int64(carnot_otel_export_batch_delay_ms);
+DECLARE_int32(carnot_otel_export_max_inflight);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -37,6 +46,13 @@ struct SpanConfig {
   std::string name;
 };
 
+/**
+ * OTelExportSinkNode exports its input as OTel metrics and spans. Rows are accumulated across
+ * row batches into one request, which is sent once it has enough rows, has waited long enough
+ * or the input ends. Requests are sent on a small pool of threads, so that the query doesn't
+ * wait on the collector, but only a few at a time: the query waits once that many are in flight.
+ * Export errors fail the query at the next row batch.
+ */
 class OTelExportSinkNode : public SinkNode {
  public:
   virtual ~OTelExportSinkNode() = default;
@@ -51,18 +67,36 @@ class OTelExportSinkNode : public SinkNode {
                          size_t parent_index) override;
 
  private:
-  Status ConsumeMetrics(const table_store::schema::RowBatch& rb);
-  Status ConsumeSpans(const table_store::schema::RowBatch& rb);
+  void ConsumeMetrics(const table_store::schema::RowBatch& rb);
+  void ConsumeSpans(const table_store::schema::RowBatch& rb);
+  // Sends the accumulated rows, if any.
+  void Flush();
+  // Runs the export on the pool once fewer than the max number of exports are in flight.
+  void SendAsync(std::function<Status()> export_fn);
+  // Waits for the exports in flight and returns the first error of any export.
+  Status WaitForExports();
+  Status ExportStatus();
+  std::unique_ptr<grpc::ClientContext> CreateClientContext() const;
 
   std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse metrics_response_;
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*
       metrics_service_stub_;
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse trace_response_;
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* trace_service_stub_;
   std::unique_ptr<plan::OTelExportSinkOperator> plan_node_;
 
   std::unique_ptr<SpanConfig> span_config_;
+
+  // The rows accumulated since the last request was sent.
+  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest pending_metrics_;
+  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest pending_spans_;
+  int64_t pending_rows_ = 0;
+  std::chrono::steady_clock::time_point pending_since_;
+
+  absl::Mutex exports_lock_;
+  int64_t exports_in_flight_ ABSL_GUARDED_BY(exports_lock_) = 0;
+  Status export_status_ ABSL_GUARDED_BY(exports_lock_);
+  // Declared last, so that the exports still queued finish before the rest of the node goes.
+  std::unique_ptr<ThreadPool> export_pool_;
 };
 
 }  // namespace exec
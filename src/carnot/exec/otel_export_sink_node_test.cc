@@ -142,10 +142,53 @@ metrics {
                  .AddColumn<types::Float64Value>({1.0})
                  .get();
   tester.ConsumeNext(rb1, 1, 0);
+  // The row is only sent once the node closes, as the batch isn't the last.
+  tester.Close();
 
   EXPECT_EQ(url_, "otlp.px.dev");
 }
 
+TEST_F(OTelExportSinkNodeTest, batches_rows_until_limit) {
+  FLAGS_carnot_otel_export_batch_rows = 2;
+  // One export at a time, so that the requests are recorded in order.
+  FLAGS_carnot_otel_export_max_inflight = 1;
+  std::string operator_pb_txt = R"(
+metrics {
+  name: "http.resp.latency"
+  time_column_index: 0
+  gauge { int_column_index: 1 }
+})";
+  planpb::OTelExportSinkOperator otel_sink_op;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(operator_pb_txt, &otel_sink_op));
+  auto plan_node = std::make_unique<plan::OTelExportSinkOperator>(1);
+  EXPECT_OK(plan_node->Init(otel_sink_op));
+  RowDescriptor input_rd({types::TIME64NS, types::INT64});
+  RowDescriptor output_rd({});
+
+  std::vector<int> request_sizes;
+  EXPECT_CALL(*metrics_mock_, Export(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&request_sizes](const auto&, const auto& proto, const auto&) {
+        request_sizes.push_back(proto.resource_metrics_size());
+        return grpc::Status::OK;
+      }));
+
+  auto tester = exec::ExecNodeTester<OTelExportSinkNode, plan::OTelExportSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  for (int64_t i = 0; i < 3; ++i) {
+    auto rb = RowBatchBuilder(input_rd, 1, /*eow*/ i == 2, /*eos*/ i == 2)
+                  .AddColumn<types::Time64NSValue>({i})
+                  .AddColumn<types::Int64Value>({i})
+                  .get();
+    tester.ConsumeNext(rb, 1, 0);
+  }
+  tester.Close();
+
+  EXPECT_THAT(request_sizes, ::testing::ElementsAre(2, 1));
+  FLAGS_carnot_otel_export_batch_rows = 1024;
+  FLAGS_carnot_otel_export_max_inflight = 4;
+}
+
 struct TestCase {
   std::string name;
   std::string operator_proto;
@@ -529,8 +572,7 @@ resource_metrics {
       }
     }
   }
-})pb",
-                               R"pb(
+}
 resource_metrics {
   resource {}
   instrumentation_library_metrics {
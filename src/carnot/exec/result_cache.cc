@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/result_cache.h"
+
+DEFINE_int64(carnot_result_cache_bytes, gflags::Int64FromEnv("PL_CARNOT_RESULT_CACHE_BYTES", 0),
+             "The bytes of plan fragment results to keep, to reuse when a fragment is executed "
+             "again over unchanged tables. Disabled if 0.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+std::unique_ptr<ResultCache> ResultCache::CreateFromFlags() {
+  if (FLAGS_carnot_result_cache_bytes <= 0) {
+    return nullptr;
+  }
+  return std::make_unique<ResultCache>(FLAGS_carnot_result_cache_bytes);
+}
+
+std::shared_ptr<const ResultCache::Entry> ResultCache::Get(const std::string& key) {
+  absl::MutexLock lock(&lock_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  items_.splice(items_.begin(), items_, it->second);
+  return it->second->entry;
+}
+
+void ResultCache::Put(const std::string& key, Entry entry) {
+  int64_t bytes = key.size();
+  for (const auto& input : entry) {
+    bytes += input.rb.NumBytes();
+  }
+  if (bytes > max_bytes_) {
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    bytes_ -= it->second->bytes;
+    items_.erase(it->second);
+    index_.erase(it);
+  }
+  EvictLocked(bytes);
+  items_.push_front({key, std::make_shared<const Entry>(std::move(entry)), bytes});
+  index_[key] = items_.begin();
+  bytes_ += bytes;
+}
+
+void ResultCache::EvictLocked(int64_t needed_bytes) {
+  while (!items_.empty() && bytes_ + needed_bytes > max_bytes_) {
+    bytes_ -= items_.back().bytes;
+    index_.erase(items_.back().key);
+    items_.pop_back();
+  }
+}
+
+int64_t ResultCache::bytes() const {
+  absl::MutexLock lock(&lock_);
+  return bytes_;
+}
+
+int64_t ResultCache::hits() const {
+  absl::MutexLock lock(&lock_);
+  return hits_;
+}
+
+int64_t ResultCache::misses() const {
+  absl::MutexLock lock(&lock_);
+  return misses_;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
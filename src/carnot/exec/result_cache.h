@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_int64(carnot_result_cache_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * ResultCache keeps the row batches that the sinks of recently executed plan fragments consumed,
+ * so that a repeat of a fragment over unchanged tables (e.g. a live view refreshing every few
+ * seconds while a table gets no new data) can send them again instead of recomputing them.
+ * Entries are keyed by the fragment's plan and the state of the tables it reads, see
+ * ExecutionGraph::SetResultCache(), and are evicted least recently used first.
+ */
+class ResultCache : public NotCopyable {
+ public:
+  struct SinkInput {
+    int64_t sink_id;
+    size_t parent_index;
+    table_store::schema::RowBatch rb;
+  };
+  // The row batches consumed by a fragment's sinks, in the order they were consumed.
+  using Entry = std::vector<SinkInput>;
+
+  explicit ResultCache(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /**
+   * @return the cache if enabled by --carnot_result_cache_bytes, nullptr otherwise.
+   */
+  static std::unique_ptr<ResultCache> CreateFromFlags();
+
+  /**
+   * @return the entry for key, or nullptr if there is none.
+   */
+  std::shared_ptr<const Entry> Get(const std::string& key);
+
+  /**
+   * Adds an entry for key, unless it is larger than the whole cache.
+   */
+  void Put(const std::string& key, Entry entry);
+
+  int64_t bytes() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Item {
+    std::string key;
+    std::shared_ptr<const Entry> entry;
+    int64_t bytes;
+  };
+
+  void EvictLocked(int64_t needed_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const int64_t max_bytes_;
+  mutable absl::Mutex lock_;
+  // Most recently used first.
+  std::list<Item> items_ ABSL_GUARDED_BY(lock_);
+  absl::flat_hash_map<std::string, std::list<Item>::iterator> index_ ABSL_GUARDED_BY(lock_);
+  int64_t bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t hits_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
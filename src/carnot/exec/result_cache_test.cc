@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/result_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+
+class ResultCacheTest : public ::testing::Test {
+ protected:
+  // An entry with one row batch of num_rows int64 values.
+  ResultCache::Entry MakeEntry(int64_t num_rows) {
+    RowDescriptor rd({types::DataType::INT64});
+    std::vector<types::Int64Value> values(num_rows, 1);
+    auto rb = RowBatchBuilder(rd, num_rows, /*eow*/ true, /*eos*/ true)
+                  .AddColumn<types::Int64Value>(values)
+                  .get();
+    ResultCache::Entry entry;
+    entry.push_back({/*sink_id*/ 1, /*parent_index*/ 0, rb});
+    return entry;
+  }
+};
+
+TEST_F(ResultCacheTest, get_and_put) {
+  ResultCache cache(/*max_bytes*/ 4096);
+  EXPECT_EQ(cache.Get("a"), nullptr);
+
+  cache.Put("a", MakeEntry(10));
+  auto entry = cache.Get("a");
+  ASSERT_NE(entry, nullptr);
+  ASSERT_EQ(entry->size(), 1U);
+  EXPECT_EQ((*entry)[0].sink_id, 1);
+  EXPECT_EQ((*entry)[0].rb.num_rows(), 10);
+  EXPECT_TRUE((*entry)[0].rb.eos());
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST_F(ResultCacheTest, evicts_least_recently_used) {
+  // Each entry is 1 byte of key and 800 bytes of values.
+  ResultCache cache(/*max_bytes*/ 2000);
+  cache.Put("a", MakeEntry(100));
+  cache.Put("b", MakeEntry(100));
+  EXPECT_EQ(cache.bytes(), 1602);
+
+  ASSERT_NE(cache.Get("a"), nullptr);
+  cache.Put("c", MakeEntry(100));
+  EXPECT_NE(cache.Get("a"), nullptr);
+  EXPECT_EQ(cache.Get("b"), nullptr);
+  EXPECT_NE(cache.Get("c"), nullptr);
+  EXPECT_EQ(cache.bytes(), 1602);
+}
+
+TEST_F(ResultCacheTest, too_large) {
+  ResultCache cache(/*max_bytes*/ 100);
+  cache.Put("a", MakeEntry(100));
+  EXPECT_EQ(cache.Get("a"), nullptr);
+  EXPECT_EQ(cache.bytes(), 0);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/row_selection.h"
+
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+StatusOr<std::unique_ptr<RowBatch>> TakeRows(const RowBatch& rb, const std::vector<int64_t>& rows,
+                                             arrow::MemoryPool* mem_pool) {
+  auto output_rb = std::make_unique<RowBatch>(rb.desc(), rows.size());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+    auto col = rb.ColumnAt(col_idx).get();
+    std::shared_ptr<arrow::Array> out;
+#define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(TakeRows<_dt_>(col, rows, mem_pool, &out));
+    PL_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(out));
+  }
+  output_rb->set_eow(rb.eow());
+  output_rb->set_eos(rb.eos());
+  return output_rb;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> CompactSelection(const RowBatch& rb,
+                                                     arrow::MemoryPool* mem_pool) {
+  DCHECK(rb.has_selection());
+  return TakeRows(rb, *rb.selection(), mem_pool);
+}
+
+StatusOr<std::unique_ptr<RowBatch>> ConcatenateRows(
+    const std::vector<std::unique_ptr<RowBatch>>& batches, arrow::MemoryPool* mem_pool) {
+  DCHECK(!batches.empty());
+  const auto& desc = batches.front()->desc();
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders(desc.size());
+  for (size_t col_idx = 0; col_idx < desc.size(); ++col_idx) {
+    builders[col_idx] = types::MakeArrowBuilder(desc.type(col_idx), mem_pool);
+  }
+  for (const auto& rb : batches) {
+    DCHECK(!rb->has_selection());
+    for (size_t col_idx = 0; col_idx < desc.size(); ++col_idx) {
+      auto col = rb->ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(AppendRange<_dt_>(col, 0, rb->num_rows(), builders[col_idx].get()));
+      PL_SWITCH_FOREACH_DATATYPE(desc.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    }
+  }
+  return RowBatch::FromColumnBuilders(desc, batches.back()->eow(), batches.back()->eos(),
+                                      &builders);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * TakeRows copies the given rows of the column into a new array.
+ */
+template <types::DataType DT>
+Status TakeRows(const arrow::Array* col, const std::vector<int64_t>& rows,
+                arrow::MemoryPool* mem_pool, std::shared_ptr<arrow::Array>* out) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto builder = types::MakeArrowBuilder(DT, mem_pool);
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder.get());
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(rows.size()));
+  if constexpr (DT == types::DataType::STRING) {
+    const auto* str_col = static_cast<const arrow::StringArray*>(col);
+    int64_t data_size = 0;
+    for (auto row_idx : rows) {
+      data_size += str_col->value_length(row_idx);
+    }
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(data_size));
+    for (auto row_idx : rows) {
+      typed_builder->UnsafeAppend(str_col->GetView(row_idx));
+    }
+  } else {
+    for (auto row_idx : rows) {
+      typed_builder->UnsafeAppend(types::GetValueFromArrowArray<DT>(col, row_idx));
+    }
+  }
+  PL_RETURN_IF_ERROR(builder->Finish(out));
+  return Status::OK();
+}
+
+/**
+ * AppendRange appends rows [start, end) of the column to the builder, copying the values of fixed
+ * width columns in one go.
+ */
+template <types::DataType DT>
+Status AppendRange(const arrow::Array* col, int64_t start, int64_t end,
+                   arrow::ArrayBuilder* builder) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(end - start));
+  if constexpr (DT == types::DataType::INT64 || DT == types::DataType::TIME64NS ||
+                DT == types::DataType::FLOAT64) {
+    using ArrowArray = typename types::DataTypeTraits<DT>::arrow_array_type;
+    const auto* typed_col = static_cast<const ArrowArray*>(col);
+    PL_RETURN_IF_ERROR(typed_builder->AppendValues(typed_col->raw_values() + start, end - start));
+  } else if constexpr (DT == types::DataType::STRING) {
+    const auto* str_col = static_cast<const arrow::StringArray*>(col);
+    PL_RETURN_IF_ERROR(
+        typed_builder->ReserveData(str_col->value_offset(end) - str_col->value_offset(start)));
+    for (auto row_idx = start; row_idx < end; ++row_idx) {
+      typed_builder->UnsafeAppend(str_col->GetView(row_idx));
+    }
+  } else {
+    for (auto row_idx = start; row_idx < end; ++row_idx) {
+      typed_builder->UnsafeAppend(types::GetValueFromArrowArray<DT>(col, row_idx));
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * TakeRows copies the given rows of the batch into a new batch, with the same eow and eos.
+ */
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> TakeRows(
+    const table_store::schema::RowBatch& rb, const std::vector<int64_t>& rows,
+    arrow::MemoryPool* mem_pool);
+
+/**
+ * CompactSelection copies the selected rows of a batch with a selection into a new batch.
+ */
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> CompactSelection(
+    const table_store::schema::RowBatch& rb, arrow::MemoryPool* mem_pool);
+
+/**
+ * ConcatenateRows copies the rows of the batches, which have the same descriptor and no selection,
+ * into a single new batch, with the eow and eos of the last one.
+ */
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> ConcatenateRows(
+    const std::vector<std::unique_ptr<table_store::schema::RowBatch>>& batches,
+    arrow::MemoryPool* mem_pool);
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
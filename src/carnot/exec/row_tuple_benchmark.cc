@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "src/carnot/exec/row_tuple.h"
+#include "src/common/memory/memory.h"
+#include "src/shared/types/types.h"
+
+using px::ObjectArena;
+using px::ObjectPool;
+using px::carnot::exec::RowTuple;
+using px::types::DataType;
+
+namespace {
+
+const std::vector<DataType> kGroupTypes = {DataType::INT64, DataType::STRING, DataType::FLOAT64};
+
+template <typename TPool>
+RowTuple* NewRowTuple(TPool* pool);
+
+template <>
+RowTuple* NewRowTuple<ObjectPool>(ObjectPool* pool) {
+  return pool->Add(new RowTuple(&kGroupTypes));
+}
+
+template <>
+RowTuple* NewRowTuple<ObjectArena>(ObjectArena* pool) {
+  return pool->New<RowTuple>(&kGroupTypes);
+}
+
+}  // namespace
+
+// Creates state.range(0) group row tuples, as an aggregate does for each new group, then frees
+// them all at once as it does at eos.
+template <typename TPool>
+// NOLINTNEXTLINE : runtime/references.
+void BM_CreateGroupRowTuples(benchmark::State& state) {
+  auto num_groups = state.range(0);
+  TPool pool;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < num_groups; ++i) {
+      RowTuple* rt = NewRowTuple<TPool>(&pool);
+      rt->SetValue(0, px::types::Int64Value(i));
+      rt->SetValue(1, px::types::StringValue("svc"));
+      rt->SetValue(2, px::types::Float64Value(1.0));
+      benchmark::DoNotOptimize(rt);
+    }
+    pool.Clear();
+  }
+  state.SetItemsProcessed(state.iterations() * num_groups);
+}
+
+BENCHMARK_TEMPLATE(BM_CreateGroupRowTuples, ObjectPool)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK_TEMPLATE(BM_CreateGroupRowTuples, ObjectArena)->RangeMultiplier(8)->Range(64, 1 << 18);
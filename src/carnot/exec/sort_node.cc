@@ -0,0 +1,350 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/sort_node.h"
+
+#include <arrow/array.h>
+#include <arrow/array/builder_base.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/table/internal/disk_batch.h"
+
+DEFINE_int64(carnot_sort_memory_budget_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_SORT_MEMORY_BUDGET_BYTES", 0),
+             "The bytes of input a sort without a limit buffers in memory, beyond which the "
+             "buffered rows are sorted and spilled to disk. Unlimited if 0.");
+DEFINE_string(carnot_sort_spill_dir, gflags::StringFromEnv("PL_CARNOT_SORT_SPILL_DIR", "/tmp"),
+              "The directory sorts spill runs to.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+// The number of rows of each output batch. A top-k is also compacted when it buffers more than
+// this many rows (and twice its limit).
+constexpr int64_t kSortBatchRows = 8192;
+
+namespace {
+template <types::DataType DT>
+int CompareValues(const arrow::Array* a, int64_t a_row, const arrow::Array* b, int64_t b_row) {
+  if constexpr (DT == types::DataType::STRING) {
+    return types::GetStringViewFromArrowArray(a, a_row)
+        .compare(types::GetStringViewFromArrowArray(b, b_row));
+  } else {
+    auto a_val = types::GetValueFromArrowArray<DT>(a, a_row);
+    auto b_val = types::GetValueFromArrowArray<DT>(b, b_row);
+    if constexpr (DT == types::DataType::FLOAT64) {
+      // NaNs sort after every other value, so that the order stays strict weak.
+      bool a_nan = std::isnan(a_val);
+      bool b_nan = std::isnan(b_val);
+      if (a_nan || b_nan) {
+        return static_cast<int>(a_nan) - static_cast<int>(b_nan);
+      }
+    }
+    return a_val < b_val ? -1 : (b_val < a_val ? 1 : 0);
+  }
+}
+
+template <types::DataType DT, typename TBatches, typename TRows>
+Status AppendRowsToBuilder(const TBatches& batches, int64_t col_idx, const TRows& rows,
+                           size_t begin, size_t end, arrow::ArrayBuilder* builder) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(end - begin));
+  for (size_t i = begin; i < end; ++i) {
+    const auto& row = rows[i];
+    PL_RETURN_IF_ERROR(typed_builder->Append(
+        types::GetValueFromArrowArray<DT>(batches[row.batch][col_idx].get(), row.row)));
+  }
+  return Status::OK();
+}
+}  // namespace
+
+std::string SortNode::DebugStringImpl() {
+  return absl::Substitute("Exec::SortNode<$0>", plan_node_->DebugString());
+}
+
+Status SortNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Sort operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+  if (plan_node_->sort_cols().empty()) {
+    return error::InvalidArgument("Sort operator expects at least one sort key");
+  }
+
+  compare_fns_.clear();
+  for (auto col_idx : plan_node_->sort_cols()) {
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(input_descriptor_->type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+Status SortNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::CloseImpl(ExecState* /*exec_state*/) {
+  if (num_spilled_runs_ > 0) {
+    stats()->AddExtraInfo("sort_spilled_runs", std::to_string(num_spilled_runs_));
+  }
+  ClearState();
+  return Status::OK();
+}
+
+void SortNode::ClearState() {
+  batches_.clear();
+  top_k_.clear();
+  runs_.clear();
+  buffered_rows_ = 0;
+  buffered_bytes_ = 0;
+}
+
+bool SortNode::RowLess(const std::vector<Columns>& batches, const RowRef& a,
+                       const RowRef& b) const {
+  const auto& sort_cols = plan_node_->sort_cols();
+  for (size_t i = 0; i < compare_fns_.size(); ++i) {
+    auto col_idx = sort_cols[i];
+    int cmp = compare_fns_[i](batches[a.batch][col_idx].get(), a.row,
+                              batches[b.batch][col_idx].get(), b.row);
+    if (cmp != 0) {
+      return plan_node_->descending()[i] ? cmp > 0 : cmp < 0;
+    }
+  }
+  return false;
+}
+
+Status SortNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  int64_t limit = plan_node_->limit();
+  if (rb.num_rows() > 0) {
+    batches_.push_back(rb.columns());
+    buffered_rows_ += rb.num_rows();
+    buffered_bytes_ += rb.NumBytes();
+    if (limit > 0) {
+      AddToTopK(rb);
+      if (buffered_rows_ >= std::max(kSortBatchRows, 2 * limit)) {
+        PL_RETURN_IF_ERROR(CompactTopK(exec_state));
+      }
+    } else if (FLAGS_carnot_sort_memory_budget_bytes > 0 &&
+               buffered_bytes_ > FLAGS_carnot_sort_memory_budget_bytes) {
+      PL_RETURN_IF_ERROR(SpillRun(exec_state));
+    }
+  }
+
+  if (!rb.eos()) {
+    return Status::OK();
+  }
+  auto s = runs_.empty() ? SendSorted(exec_state, rb) : SendMerged(exec_state, rb);
+  ClearState();
+  return s;
+}
+
+void SortNode::AddToTopK(const RowBatch& rb) {
+  auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(batches_, a, b); };
+  auto limit = static_cast<size_t>(plan_node_->limit());
+  int64_t batch = batches_.size() - 1;
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    RowRef ref{batch, row};
+    if (top_k_.size() < limit) {
+      top_k_.push_back(ref);
+      std::push_heap(top_k_.begin(), top_k_.end(), less);
+    } else if (less(ref, top_k_.front())) {
+      std::pop_heap(top_k_.begin(), top_k_.end(), less);
+      top_k_.back() = ref;
+      std::push_heap(top_k_.begin(), top_k_.end(), less);
+    }
+  }
+}
+
+Status SortNode::CompactTopK(ExecState* exec_state) {
+  // Copy out the rows of the heap, so that the batches they came from can be released. The heap
+  // order is kept, since it only depends on the values of the rows.
+  PL_ASSIGN_OR_RETURN(auto columns, GatherRows(exec_state, batches_, top_k_, 0, top_k_.size()));
+  for (size_t i = 0; i < top_k_.size(); ++i) {
+    top_k_[i] = RowRef{0, static_cast<int64_t>(i)};
+  }
+  batches_.clear();
+  batches_.push_back(std::move(columns));
+  buffered_rows_ = top_k_.size();
+  buffered_bytes_ = 0;
+  return Status::OK();
+}
+
+StatusOr<SortNode::Columns> SortNode::SortBufferedRows(ExecState* exec_state) {
+  std::vector<RowRef> rows;
+  rows.reserve(buffered_rows_);
+  for (size_t batch = 0; batch < batches_.size(); ++batch) {
+    for (int64_t row = 0; row < batches_[batch][0]->length(); ++row) {
+      rows.push_back(RowRef{static_cast<int64_t>(batch), row});
+    }
+  }
+  std::sort(rows.begin(), rows.end(),
+            [this](const RowRef& a, const RowRef& b) { return RowLess(batches_, a, b); });
+  PL_ASSIGN_OR_RETURN(auto columns, GatherRows(exec_state, batches_, rows, 0, rows.size()));
+  batches_.clear();
+  buffered_rows_ = 0;
+  buffered_bytes_ = 0;
+  return columns;
+}
+
+Status SortNode::SpillRun(ExecState* exec_state) {
+  PL_ASSIGN_OR_RETURN(auto columns, SortBufferedRows(exec_state));
+  if (spill_file_prefix_.empty()) {
+    std::filesystem::path dir(FLAGS_carnot_sort_spill_dir);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+      return error::Internal("Failed to create sort spill directory $0: $1", dir.string(),
+                             ec.message());
+    }
+    spill_file_prefix_ = (dir / absl::StrCat("sort_", sole::uuid4().str())).string();
+  }
+  auto path = absl::StrCat(spill_file_prefix_, "_", num_spilled_runs_++, ".spill");
+  PL_ASSIGN_OR_RETURN(auto batch, table_store::internal::DiskBatch::Write(path, columns));
+  // The columns of the batch keep its memory map, and so its file, alive.
+  runs_.push_back(batch.columns());
+  return Status::OK();
+}
+
+Status SortNode::SendSorted(ExecState* exec_state, const RowBatch& rb) {
+  auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(batches_, a, b); };
+  std::vector<RowRef> rows;
+  if (plan_node_->limit() > 0) {
+    rows = std::move(top_k_);
+    std::sort_heap(rows.begin(), rows.end(), less);
+  } else {
+    rows.reserve(buffered_rows_);
+    for (size_t batch = 0; batch < batches_.size(); ++batch) {
+      for (int64_t row = 0; row < batches_[batch][0]->length(); ++row) {
+        rows.push_back(RowRef{static_cast<int64_t>(batch), row});
+      }
+    }
+    std::sort(rows.begin(), rows.end(), less);
+  }
+  return SendRows(exec_state, batches_, rows, rb);
+}
+
+Status SortNode::SendMerged(ExecState* exec_state, const RowBatch& rb) {
+  // The rows still buffered form the last run, which stays in memory.
+  if (buffered_rows_ > 0) {
+    PL_ASSIGN_OR_RETURN(auto columns, SortBufferedRows(exec_state));
+    runs_.push_back(std::move(columns));
+  }
+
+  // A min-heap of the next row of each run.
+  auto greater = [this](const RowRef& a, const RowRef& b) { return RowLess(runs_, b, a); };
+  std::vector<RowRef> heap;
+  for (size_t run = 0; run < runs_.size(); ++run) {
+    heap.push_back(RowRef{static_cast<int64_t>(run), 0});
+  }
+  std::make_heap(heap.begin(), heap.end(), greater);
+
+  std::vector<RowRef> rows;
+  rows.reserve(kSortBatchRows);
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), greater);
+    RowRef next = heap.back();
+    heap.pop_back();
+    rows.push_back(next);
+    if (next.row + 1 < runs_[next.batch][0]->length()) {
+      heap.push_back(RowRef{next.batch, next.row + 1});
+      std::push_heap(heap.begin(), heap.end(), greater);
+    }
+    if (static_cast<int64_t>(rows.size()) == kSortBatchRows || heap.empty()) {
+      PL_ASSIGN_OR_RETURN(auto columns, GatherRows(exec_state, runs_, rows, 0, rows.size()));
+      PL_RETURN_IF_ERROR(SendOutputBatch(exec_state, columns, rows.size(),
+                                         heap.empty() && rb.eow(), heap.empty() && rb.eos()));
+      rows.clear();
+    }
+  }
+  return Status::OK();
+}
+
+StatusOr<SortNode::Columns> SortNode::GatherRows(ExecState* exec_state,
+                                                 const std::vector<Columns>& batches,
+                                                 const std::vector<RowRef>& rows, size_t begin,
+                                                 size_t end) const {
+  Columns columns;
+  columns.reserve(input_descriptor_->size());
+  for (size_t col_idx = 0; col_idx < input_descriptor_->size(); ++col_idx) {
+    auto type = input_descriptor_->type(col_idx);
+    auto builder = types::MakeArrowBuilder(type, exec_state->exec_mem_pool());
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(       \
+      AppendRowsToBuilder<_dt_>(batches, col_idx, rows, begin, end, builder.get()));
+    PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    columns.push_back(std::move(arr));
+  }
+  return columns;
+}
+
+Status SortNode::SendRows(ExecState* exec_state, const std::vector<Columns>& batches,
+                          const std::vector<RowRef>& rows, const RowBatch& rb) {
+  if (rows.empty()) {
+    PL_ASSIGN_OR_RETURN(auto output_rb,
+                        RowBatch::WithZeroRows(*output_descriptor_, rb.eow(), rb.eos()));
+    return SendRowBatchToChildren(exec_state, *output_rb);
+  }
+  for (size_t begin = 0; begin < rows.size(); begin += kSortBatchRows) {
+    size_t end = std::min(rows.size(), begin + kSortBatchRows);
+    PL_ASSIGN_OR_RETURN(auto columns, GatherRows(exec_state, batches, rows, begin, end));
+    bool last = end == rows.size();
+    PL_RETURN_IF_ERROR(
+        SendOutputBatch(exec_state, columns, end - begin, last && rb.eow(), last && rb.eos()));
+  }
+  return Status::OK();
+}
+
+Status SortNode::SendOutputBatch(ExecState* exec_state, const Columns& columns, int64_t num_rows,
+                                 bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, num_rows);
+  DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
+  for (int64_t input_col_idx : plan_node_->selected_cols()) {
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(columns[input_col_idx]));
+  }
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
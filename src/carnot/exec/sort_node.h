@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <gflags/gflags.h>
+
+#include <arrow/array.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+DECLARE_int64(carnot_sort_memory_budget_bytes);
+DECLARE_string(carnot_sort_spill_dir);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * SortNode orders its input by the sort keys of the plan, and outputs the rows at eos.
+ *
+ * With a limit, it keeps the first limit rows seen so far in a bounded heap (a top-k), so its
+ * memory doesn't grow with the input. Without one, it buffers the input and sorts it at eos. Past
+ * --carnot_sort_memory_budget_bytes, the buffered rows are sorted into a run that is written to
+ * disk, and the runs are merged at eos.
+ */
+class SortNode : public ProcessingNode {
+ public:
+  SortNode() = default;
+  virtual ~SortNode() = default;
+
+  int64_t num_spilled_runs() const { return num_spilled_runs_; }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  using Columns = std::vector<std::shared_ptr<arrow::Array>>;
+  // Compares the value of a row of one array with a row of another array of the same type.
+  using CompareFn = int (*)(const arrow::Array*, int64_t, const arrow::Array*, int64_t);
+
+  // A row of one of the batches (or runs) being sorted.
+  struct RowRef {
+    int64_t batch;
+    int64_t row;
+  };
+
+  // Whether row a of batches comes before row b in the sort order.
+  bool RowLess(const std::vector<Columns>& batches, const RowRef& a, const RowRef& b) const;
+
+  void AddToTopK(const table_store::schema::RowBatch& rb);
+  Status CompactTopK(ExecState* exec_state);
+  // Sorts the buffered batches into a run, and clears them.
+  StatusOr<Columns> SortBufferedRows(ExecState* exec_state);
+  Status SpillRun(ExecState* exec_state);
+  Status SendSorted(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status SendMerged(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Copies the given rows of batches, in order, into a new set of columns.
+  StatusOr<Columns> GatherRows(ExecState* exec_state, const std::vector<Columns>& batches,
+                               const std::vector<RowRef>& rows, size_t begin, size_t end) const;
+  Status SendRows(ExecState* exec_state, const std::vector<Columns>& batches,
+                  const std::vector<RowRef>& rows, const table_store::schema::RowBatch& rb);
+  Status SendOutputBatch(ExecState* exec_state, const Columns& columns, int64_t num_rows,
+                         bool eow, bool eos);
+  void ClearState();
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+  std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
+  std::vector<CompareFn> compare_fns_;
+
+  // The buffered input batches, which the rows of the top-k heap or the next run refer to.
+  std::vector<Columns> batches_;
+  int64_t buffered_rows_ = 0;
+  int64_t buffered_bytes_ = 0;
+  // With a limit, a max-heap of the first rows in the sort order, so the last of them is on top.
+  std::vector<RowRef> top_k_;
+
+  // Sorted runs, the spilled ones backed by a file that is removed with their columns.
+  std::vector<Columns> runs_;
+  std::string spill_file_prefix_;
+  int64_t num_spilled_runs_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
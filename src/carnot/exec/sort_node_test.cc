@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/sort_node.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+using types::StringValue;
+
+// Sorts by column 0 ascending, then column 1 descending.
+constexpr char kSortByTwoKeys[] = R"(
+op_type: SORT_OPERATOR
+sort_op {
+  sort_keys { column { index: 0 } }
+  sort_keys { column { index: 1 } descending: true }
+  columns { index: 0 }
+  columns { index: 1 }
+  columns { index: 2 }
+}
+)";
+
+// The 3 rows with the largest column 1, which isn't output.
+constexpr char kTop3Desc[] = R"(
+op_type: SORT_OPERATOR
+sort_op {
+  sort_keys { column { index: 1 } descending: true }
+  columns { index: 0 }
+  limit: 3
+}
+)";
+
+std::unique_ptr<plan::Operator> PlanNodeFromPbtxt(const std::string& pbtxt) {
+  planpb::Operator op_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &op_pb));
+  return plan::SortOperator::FromProto(op_pb, 1);
+}
+
+class SortNodeTest : public ::testing::Test {
+ public:
+  SortNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(SortNodeTest, multiple_keys) {
+  auto plan_node = PlanNodeFromPbtxt(kSortByTwoKeys);
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  auto tester =
+      exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, rd, {rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({2, 1, 2})
+                       .AddColumn<Int64Value>({1, 5, 7})
+                       .AddColumn<StringValue>({"a", "b", "c"})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({1, 0})
+                       .AddColumn<Int64Value>({9, 3})
+                       .AddColumn<StringValue>({"d", "e"})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(rd, 5, true, true)
+                          .AddColumn<Int64Value>({0, 1, 1, 2, 2})
+                          .AddColumn<Int64Value>({3, 9, 5, 7, 1})
+                          .AddColumn<StringValue>({"e", "d", "b", "c", "a"})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, top_k) {
+  auto plan_node = PlanNodeFromPbtxt(kTop3Desc);
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::FLOAT64});
+  RowDescriptor output_rd({types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd,
+                                                                   {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<StringValue>({"a", "b", "c", "d"})
+                       .AddColumn<types::Float64Value>({1.5, 8.0, 0.5, 3.0})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<StringValue>({"e", "f", "g"})
+                       .AddColumn<types::Float64Value>({9.0, 2.0, 4.0})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<StringValue>({"e", "b", "g"})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, empty_input) {
+  auto plan_node = PlanNodeFromPbtxt(kTop3Desc);
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::FLOAT64});
+  RowDescriptor output_rd({types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd,
+                                                                   {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<StringValue>({})
+                       .AddColumn<types::Float64Value>({})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true).AddColumn<StringValue>({}).get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, spills_runs_over_memory_budget) {
+  px::testing::TempDir spill_dir;
+  gflags::FlagSaver flag_saver;
+  // Every batch is over the budget, so each is spilled as its own run.
+  FLAGS_carnot_sort_memory_budget_bytes = 1;
+  FLAGS_carnot_sort_spill_dir = spill_dir.path().string();
+
+  auto plan_node = PlanNodeFromPbtxt(kSortByTwoKeys);
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  auto tester =
+      exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, rd, {rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({4, 1, 2})
+                       .AddColumn<Int64Value>({0, 0, 0})
+                       .AddColumn<StringValue>({"a", "b", "c"})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({3, 0})
+                       .AddColumn<Int64Value>({0, 0})
+                       .AddColumn<StringValue>({"d", "e"})
+                       .get(),
+                   0, 0);
+  EXPECT_EQ(2, tester.node()->num_spilled_runs());
+  tester
+      .ConsumeNext(RowBatchBuilder(rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({2, 5})
+                       .AddColumn<Int64Value>({1, 0})
+                       .AddColumn<StringValue>({"f", "g"})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(rd, 7, true, true)
+                          .AddColumn<Int64Value>({0, 1, 2, 2, 3, 4, 5})
+                          .AddColumn<Int64Value>({0, 0, 1, 0, 0, 0, 0})
+                          .AddColumn<StringValue>({"e", "b", "f", "c", "d", "a", "g"})
+                          .get())
+      .Close();
+  EXPECT_EQ(3, tester.node()->num_spilled_runs());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
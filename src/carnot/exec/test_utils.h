@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <memory>
 #include <queue>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -292,6 +293,41 @@ class RowBatchBuilder {
   std::unique_ptr<table_store::schema::RowBatch> rb_;
 };
 
+/**
+ * Generates row batches for benchmarks, with the columns:
+ *   0: INT64, uniformly distributed in [0, value_range), from a fixed seed.
+ *   1: INT64, the row number across all of the batches.
+ *   2: TIME64NS, increasing with the row number.
+ * The last batch has eow and eos set.
+ */
+inline std::vector<table_store::schema::RowBatch> GenerateBenchmarkBatches(int64_t num_batches,
+                                                                           int64_t rows_per_batch,
+                                                                           int64_t value_range,
+                                                                           uint32_t seed = 0) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> dist(0, value_range - 1);
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64, types::DataType::TIME64NS});
+  std::vector<table_store::schema::RowBatch> batches;
+  for (int64_t b = 0; b < num_batches; ++b) {
+    std::vector<types::Int64Value> values;
+    std::vector<types::Int64Value> row_numbers;
+    std::vector<types::Time64NSValue> times;
+    for (int64_t i = 0; i < rows_per_batch; ++i) {
+      int64_t row = b * rows_per_batch + i;
+      values.emplace_back(dist(rng));
+      row_numbers.emplace_back(row);
+      times.emplace_back(row * 1000);
+    }
+    bool last = b == num_batches - 1;
+    batches.push_back(RowBatchBuilder(rd, rows_per_batch, /*eow*/ last, /*eos*/ last)
+                          .AddColumn<types::Int64Value>(values)
+                          .AddColumn<types::Int64Value>(row_numbers)
+                          .AddColumn<types::Time64NSValue>(times)
+                          .get());
+  }
+  return batches;
+}
+
 class FakePlanNode : public plan::Operator {
  public:
   explicit FakePlanNode(int64_t id) : Operator(id, planpb::OPERATOR_TYPE_UNKNOWN) {}
@@ -430,6 +466,18 @@ class ExecNodeTester {
     return *this;
   }
 
+  /**
+   * Removes the oldest rowbatch output by ConsumeNext/GenerateNext, for tests whose output isn't
+   * known exactly.
+   * @return the row batch.
+   */
+  std::unique_ptr<table_store::schema::RowBatch> PopRowBatch() {
+    DCHECK(current_row_batches_.size());
+    auto rb = std::move(current_row_batches_.front());
+    current_row_batches_.pop();
+    return rb;
+  }
+
   /**
    * Checks that the row batch matches the last rowbatch output by ConsumeNext/GenerateNext.
    * @param expected_rb Row batch that should match the last rowbatch output by
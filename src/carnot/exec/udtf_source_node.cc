@@ -20,6 +20,7 @@
 
 #include <arrow/array/builder_base.h>
 #include <arrow/memory_pool.h>
+#include <algorithm>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -36,6 +37,10 @@
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_udtf_batch_bytes, gflags::Int64FromEnv("PL_CARNOT_UDTF_BATCH_BYTES", 1 << 20),
+             "The target size of the row batches generated by UDTFs. Batches are also made "
+             "smaller as their query nears its memory limit. No target if 0.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -43,6 +48,27 @@ namespace exec {
 // TODO(zasgar/philkuz): we should put these in the plan.
 // The batch size to use for UDTFs by default.
 constexpr int kUDTFBatchSize = 1024;
+// Under a memory limit, batches are kept to this fraction of the memory the query has left.
+constexpr int64_t kUDTFBatchHeadroomDivisor = 8;
+constexpr int64_t kMinUDTFBatchBytes = 4 * 1024;
+
+namespace {
+
+// Downstream nodes that keep data, such as aggregates and joins, charge it to the query's memory
+// pool. As they fill it, the batches get smaller, so that a large UDTF output is fed to them in
+// bounded steps instead of overshooting the limit with one more big batch.
+int64_t BatchBytesTarget(const types::AccountingMemoryPool& pool) {
+  int64_t target = FLAGS_carnot_udtf_batch_bytes;
+  if (pool.limit_bytes() <= 0) {
+    return target;
+  }
+  int64_t headroom = std::max<int64_t>(pool.limit_bytes() - pool.bytes_allocated(), 0) /
+                     kUDTFBatchHeadroomDivisor;
+  headroom = std::max(headroom, kMinUDTFBatchBytes);
+  return target > 0 ? std::min(target, headroom) : headroom;
+}
+
+}  // namespace
 
 std::string UDTFSourceNode::DebugStringImpl() { return std::string(); }
 
@@ -102,7 +128,7 @@ Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> outputs;
 
   for (const auto& r : udtf_def_->output_relation()) {
-    outputs.emplace_back(types::MakeArrowBuilder(r.type(), arrow::default_memory_pool()));
+    outputs.emplace_back(types::MakeArrowBuilder(r.type(), exec_state->exec_mem_pool()));
   }
 
   // TODO(zasgar): Change Exec to take in unique_ptrs.
@@ -111,8 +137,9 @@ Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
     outputs_raw.emplace_back(out.get());
   }
 
-  auto has_more_batches = udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(),
-                                                     kUDTFBatchSize, &outputs_raw);
+  auto has_more_batches =
+      udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(), kUDTFBatchSize,
+                                 &outputs_raw, BatchBytesTarget(*exec_state->exec_mem_pool()));
 
   DCHECK_GT(outputs.size(), 0);
 
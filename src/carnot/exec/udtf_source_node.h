@@ -33,6 +33,8 @@
 #include "src/common/base/status.h"
 #include "src/table_store/schema/row_descriptor.h"
 
+DECLARE_int64(carnot_udtf_batch_bytes);
+
 namespace px {
 namespace carnot {
 namespace exec {
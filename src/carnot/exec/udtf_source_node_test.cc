@@ -136,6 +136,32 @@ TEST_F(UDTFSourceNodeTest, single_output_batch_test) {
           .get());
 }
 
+TEST_F(UDTFSourceNodeTest, batch_bytes_target) {
+  gflags::FlagSaver flag_saver;
+  // Every record reaches the target, so each gets a batch of its own.
+  FLAGS_carnot_udtf_batch_bytes = 1;
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+  auto tester = exec::ExecNodeTester<UDTFSourceNode, plan::UDTFSourceOperator>(
+      *plan_node_, output_rd, {}, exec_state_.get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Int64Value>({322})
+          .AddColumn<types::StringValue>({"ts11"})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Int64Value>({323})
+          .AddColumn<types::StringValue>({"ts12"})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Int64Value>({})
+          .AddColumn<types::StringValue>({})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
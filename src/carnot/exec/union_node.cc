@@ -22,12 +22,15 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstddef>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/exec/row_selection.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
@@ -76,6 +79,10 @@ Status UnionNode::PrepareImpl(ExecState*) {
     row_cursors_.resize(num_parents_);
     time_columns_.resize(num_parents_);
     data_columns_.resize(num_parents_, std::vector<arrow::Array*>(num_output_cols));
+    last_times_.resize(num_parents_, std::numeric_limits<int64_t>::min());
+    for (size_t parent = 0; parent < num_parents_; ++parent) {
+      frontier_.insert(FrontierKey(parent));
+    }
 
     column_builders_.resize(num_output_cols);
     PL_RETURN_IF_ERROR(InitializeColumnBuilders());
@@ -104,20 +111,19 @@ std::shared_ptr<arrow::Array> UnionNode::GetInputColumn(const RowBatch& rb, size
   return rb.ColumnAt(input_index);
 }
 
-types::Time64NSValue UnionNode::GetTimeAtParentCursor(size_t parent_index) const {
-  DCHECK(!flushed_parent_eoses_[parent_index]);
-  DCHECK(time_columns_[parent_index] != nullptr);
-  return types::GetValueFromArrowArray<types::TIME64NS>(time_columns_[parent_index],
-                                                        row_cursors_[parent_index]);
+std::pair<int64_t, size_t> UnionNode::FrontierKey(size_t parent) const {
+  DCHECK(!flushed_parent_eoses_[parent]);
+  if (parent_row_batches_[parent].empty()) {
+    return {last_times_[parent], parent};
+  }
+  return {time_columns_[parent][row_cursors_[parent]], parent};
 }
 
-Status UnionNode::AppendRow(size_t parent) {
-  auto row = row_cursors_[parent];
+Status UnionNode::AppendRows(size_t parent, int64_t start, int64_t end) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     auto input_col = data_columns_[parent][i];
-#define TYPE_CASE(_dt_)                                    \
-  PL_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
-      column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(input_col, row)));
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(AppendRange<_dt_>(input_col, start, end, column_builders_[i].get()));
     PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
 #undef TYPE_CASE
   }
@@ -171,69 +177,54 @@ Status UnionNode::FlushBatch(ExecState* exec_state) {
 
 Status UnionNode::MergeData(ExecState* exec_state) {
   while (!sent_eos_) {
-    // Get the smallest time out of all of the current streams.
-    std::vector<size_t> parent_streams;
-    parent_streams.reserve(row_cursors_.size());
-
-    for (size_t parent = 0; parent < row_cursors_.size(); ++parent) {
-      if (flushed_parent_eoses_[parent]) {
-        continue;
-      }
-      // If we lack necessary data, we can't merge anymore.
-      if (!parent_row_batches_[parent].size()) {
-        return Status::OK();
-      }
-      parent_streams.push_back(parent);
-    }
-
     // If we have reached end of stream for all of our inputs, flush the queue.
-    if (!parent_streams.size()) {
+    if (frontier_.empty()) {
       return OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state);
     }
 
-    std::sort(parent_streams.begin(), parent_streams.end(),
-              [this](size_t parent_a, size_t parent_b) {
-                auto time_a = GetTimeAtParentCursor(parent_a);
-                auto time_b = GetTimeAtParentCursor(parent_b);
-                return time_a < time_b || (time_a == time_b && parent_a < parent_b);
-              });
-
-    bool has_limit = parent_streams.size() > 1;
-    size_t parent = parent_streams[0];
-
-    while (parent_row_batches_[parent].size()) {
-      if (has_limit) {
-        size_t next_parent = parent_streams[1];
-        // If this time is greater than another parent stream's earliest time,
-        // or if they are the same but the first parent is at a smaller index, stop merging.
-        // This way rows are always stable with respect to input parent index.
-        if (GetTimeAtParentCursor(parent) > GetTimeAtParentCursor(next_parent) ||
-            (GetTimeAtParentCursor(parent) == GetTimeAtParentCursor(next_parent) &&
-             parent > next_parent)) {
-          break;
-        }
-      }
+    // If the earliest parent has no buffered rows, it may still send a row that comes first.
+    auto top = frontier_.begin();
+    size_t parent = top->second;
+    if (parent_row_batches_[parent].empty()) {
+      return Status::OK();
+    }
 
-      PL_RETURN_IF_ERROR(AppendRow(parent));
+    // Merge the parent's rows that come before the next key. Ties go to the smaller parent
+    // index, so that rows are always stable with respect to the input parent index.
+    const auto& rb = parent_row_batches_[parent].front();
+    const int64_t* times = time_columns_[parent];
+    int64_t start = row_cursors_[parent];
+    int64_t end = rb.num_rows();
+    auto next = std::next(top);
+    if (next != frontier_.end()) {
+      auto [next_time, next_parent] = *next;
+      auto bound = parent < next_parent ? std::upper_bound(times + start, times + end, next_time)
+                                        : std::lower_bound(times + start, times + end, next_time);
+      end = bound - times;
+    }
+    end = std::min<int64_t>(end, start + output_rows_per_batch_ - column_builders_[0]->length());
+    DCHECK_GT(end, start);
 
-      // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
-      // popped.
-      const auto& rb = parent_row_batches_[parent][0];
-      bool pop_row_batch = ++row_cursors_[parent] == static_cast<size_t>(rb.num_rows());
-      if (pop_row_batch && rb.eos()) {
-        flushed_parent_eoses_[parent] = true;
-      }
+    PL_RETURN_IF_ERROR(AppendRows(parent, start, end));
+    frontier_.erase(top);
+    row_cursors_[parent] = end;
 
-      if (pop_row_batch) {
-        // Delete the top row batch from our buffer and update the cursor.
-        parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
-        row_cursors_[parent] = 0;
-        CacheNextRowBatch(parent);
+    if (end == rb.num_rows()) {
+      // Delete the top row batch from our buffer and update the cursor.
+      last_times_[parent] = times[end - 1];
+      if (rb.eos()) {
+        flushed_parent_eoses_[parent] = true;
       }
-
-      // Flush the current RowBatch if necessary.
-      PL_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
+      parent_row_batches_[parent].pop_front();
+      row_cursors_[parent] = 0;
+      CacheNextRowBatch(parent);
     }
+    if (!flushed_parent_eoses_[parent]) {
+      frontier_.insert(FrontierKey(parent));
+    }
+
+    // Flush the current RowBatch if necessary.
+    PL_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
   }
   return Status::OK();
 }
@@ -244,13 +235,15 @@ void UnionNode::CacheNextRowBatch(size_t parent) {
     if (parent_row_batches_[parent][0].eos()) {
       flushed_parent_eoses_[parent] = true;
     }
-    parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
+    parent_row_batches_[parent].pop_front();
   }
   if (!parent_row_batches_[parent].size()) {
     return;
   }
   const auto& next_rb = parent_row_batches_[parent][0];
-  time_columns_[parent] = next_rb.ColumnAt(plan_node_->time_column_index(parent)).get();
+  time_columns_[parent] = static_cast<const arrow::Time64Array*>(
+                              next_rb.ColumnAt(plan_node_->time_column_index(parent)).get())
+                              ->raw_values();
 
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     data_columns_[parent][i] = GetInputColumn(next_rb, parent, i).get();
@@ -259,8 +252,16 @@ void UnionNode::CacheNextRowBatch(size_t parent) {
 
 Status UnionNode::ConsumeNextOrdered(ExecState* exec_state, const RowBatch& rb,
                                      size_t parent_index) {
+  // Only the key of a parent without buffered rows changes when it gets a new one.
+  bool rekey = parent_row_batches_[parent_index].empty() && !flushed_parent_eoses_[parent_index];
+  if (rekey) {
+    frontier_.erase(FrontierKey(parent_index));
+  }
   parent_row_batches_[parent_index].push_back(rb);
   CacheNextRowBatch(parent_index);
+  if (rekey && !flushed_parent_eoses_[parent_index]) {
+    frontier_.insert(FrontierKey(parent_index));
+  }
   PL_RETURN_IF_ERROR(MergeData(exec_state));
   return OptionallyFlushRowBatchIfTimeout(exec_state);
 }
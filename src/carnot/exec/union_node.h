@@ -21,7 +21,9 @@
 #include <arrow/array.h>
 #include <arrow/array/builder_base.h>
 #include <stddef.h>
+#include <deque>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,15 +50,6 @@ class UnionNode : public ProcessingNode {
   UnionNode() = default;
   virtual ~UnionNode() = default;
 
-  // For the time ordered case: A MergeRow represents a row in an input row batch.
-  struct MergeRow {
-    size_t parent_index;
-    size_t row_batch_id;
-    size_t row_number;
-    types::Time64NSValue time;
-    bool end_of_row_batch;
-  };
-
   void disable_data_flush_timeout() { enable_data_flush_timeout_ = false; }
   void set_data_flush_timeout(const std::chrono::milliseconds& data_flush_timeout) {
     enable_data_flush_timeout_ = true;
@@ -90,8 +83,8 @@ class UnionNode : public ProcessingNode {
 
   void CacheNextRowBatch(size_t parent);
   Status InitializeColumnBuilders();
-  types::Time64NSValue GetTimeAtParentCursor(size_t parent_index) const;
-  Status AppendRow(size_t parent);
+  std::pair<int64_t, size_t> FrontierKey(size_t parent) const;
+  Status AppendRows(size_t parent, int64_t start, int64_t end);
   Status OptionallyFlushRowBatchIfMaxRowsOrEOS(ExecState* exec_state);
   Status OptionallyFlushRowBatchIfTimeout(ExecState* exec_state);
   Status FlushBatch(ExecState* exec_state);
@@ -105,13 +98,21 @@ class UnionNode : public ProcessingNode {
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
 
   // Hold onto the input row batches for every parent until we copy all of their data.
-  std::vector<std::vector<table_store::schema::RowBatch>> parent_row_batches_;
+  std::vector<std::deque<table_store::schema::RowBatch>> parent_row_batches_;
   // Keep track of where we are in the stream for each parent.
   // The row is always relative to the 'top' row batch that we have for each parent.
-  std::vector<size_t> row_cursors_;
+  std::vector<int64_t> row_cursors_;
   // Cache current working time and data columns for performance reasons.
-  std::vector<arrow::Array*> time_columns_;
+  std::vector<const int64_t*> time_columns_;
   std::vector<std::vector<arrow::Array*>> data_columns_;
+  // The time of the last row of each parent's last popped row batch. Since each parent is ordered
+  // by time, its later rows are no earlier than this.
+  std::vector<int64_t> last_times_;
+  // The merge frontier: a (time, parent) key for every parent that hasn't reached eos, ordered
+  // like the output rows. A parent with buffered rows is keyed by the time at its cursor, and a
+  // parent without by its last time, or the lowest time if it hasn't sent any rows yet. Rows are
+  // merged from the first parent while it has buffered rows, in runs up to the second key.
+  std::set<std::pair<int64_t, size_t>> frontier_;
 
   bool enable_data_flush_timeout_ = true;
   // When enable_data_flush_timeout_ is set to true, use this time to decide if we should
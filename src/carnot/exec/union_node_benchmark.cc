@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+#include <memory>
+#include <vector>
+
+#include <sole.hpp>
+
+#include "src/carnot/exec/exec_node_mock.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/exec/union_node.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+using px::carnot::exec::ExecState;
+using px::carnot::exec::GenerateBenchmarkBatches;
+using px::carnot::exec::MockExecNode;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::carnot::exec::RowBatchBuilder;
+using px::carnot::exec::UnionNode;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using ::testing::_;
+
+// Merges time ordered inputs from state.range(0) parents (e.g. PEMs feeding a Kelvin). Each
+// parent's times interleave with the others in runs of state.range(1) rows.
+// NOLINTNEXTLINE : runtime/references.
+void BM_UnionNodeOrderedMerge(benchmark::State& state) {
+  auto num_parents = state.range(0);
+  auto run_length = state.range(1);
+  auto num_batches = 16;
+  auto rows_per_batch = 1024;
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  px::carnot::planpb::UnionOperator op_proto;
+  op_proto.add_column_names("abc");
+  op_proto.add_column_names("time_");
+  op_proto.set_rows_per_batch(rows_per_batch);
+  for (int64_t p = 0; p < num_parents; ++p) {
+    auto mapping = op_proto.add_column_mappings();
+    mapping->add_column_indexes(0);
+    mapping->add_column_indexes(1);
+  }
+  px::carnot::plan::UnionOperator plan_node(1);
+  PL_CHECK_OK(plan_node.Init(op_proto));
+
+  RowDescriptor rd({DataType::INT64, DataType::TIME64NS});
+  std::vector<std::vector<RowBatch>> batches(num_parents);
+  for (int64_t p = 0; p < num_parents; ++p) {
+    for (int b = 0; b < num_batches; ++b) {
+      std::vector<px::types::Int64Value> values;
+      std::vector<px::types::Time64NSValue> times;
+      for (int64_t i = 0; i < rows_per_batch; ++i) {
+        int64_t row = b * rows_per_batch + i;
+        values.emplace_back(p);
+        times.emplace_back((row / run_length * num_parents + p) * run_length + row % run_length);
+      }
+      bool eos = b == num_batches - 1;
+      batches[p].push_back(RowBatchBuilder(rd, rows_per_batch, /*eow*/ eos, /*eos*/ eos)
+                               .AddColumn<px::types::Int64Value>(values)
+                               .AddColumn<px::types::Time64NSValue>(times)
+                               .get());
+    }
+  }
+
+  int64_t num_output_rows = 0;
+  ::testing::NiceMock<MockExecNode> child;
+  ON_CALL(child, ConsumeNextImpl(_, _, _))
+      .WillByDefault([&num_output_rows](ExecState*, const RowBatch& rb, size_t) {
+        num_output_rows += rb.num_rows();
+        return px::Status::OK();
+      });
+  px::carnot::exec::FakePlanNode fake_plan(123);
+  PL_CHECK_OK(child.Init(fake_plan, RowDescriptor({}), {rd}));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    UnionNode node;
+    node.AddChild(&child, 0);
+    std::vector<RowDescriptor> input_rds(num_parents, rd);
+    PL_CHECK_OK(node.Init(plan_node, rd, input_rds));
+    PL_CHECK_OK(node.Prepare(exec_state.get()));
+    PL_CHECK_OK(node.Open(exec_state.get()));
+    node.disable_data_flush_timeout();
+    state.ResumeTiming();
+
+    for (int b = 0; b < num_batches; ++b) {
+      for (int64_t p = 0; p < num_parents; ++p) {
+        PL_CHECK_OK(node.ConsumeNext(exec_state.get(), batches[p][b], p));
+      }
+    }
+  }
+  CHECK_EQ(num_output_rows, state.iterations() * num_parents * num_batches * rows_per_batch);
+  state.SetItemsProcessed(num_output_rows);
+}
+
+// Passes through the inputs of state.range(0) parents, without a time column to order by.
+// NOLINTNEXTLINE : runtime/references.
+void BM_UnionNodeUnordered(benchmark::State& state) {
+  auto num_parents = state.range(0);
+  auto num_batches = 16;
+  auto rows_per_batch = 1024;
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  px::carnot::planpb::UnionOperator op_proto;
+  op_proto.add_column_names("value");
+  op_proto.add_column_names("row");
+  for (int64_t p = 0; p < num_parents; ++p) {
+    auto mapping = op_proto.add_column_mappings();
+    mapping->add_column_indexes(0);
+    mapping->add_column_indexes(1);
+  }
+  px::carnot::plan::UnionOperator plan_node(1);
+  PL_CHECK_OK(plan_node.Init(op_proto));
+
+  auto batches = GenerateBenchmarkBatches(num_batches, rows_per_batch, /*value_range*/ 100);
+  RowDescriptor input_rd = batches[0].desc();
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64});
+
+  int64_t num_output_rows = 0;
+  ::testing::NiceMock<MockExecNode> child;
+  ON_CALL(child, ConsumeNextImpl(_, _, _))
+      .WillByDefault([&num_output_rows](ExecState*, const RowBatch& rb, size_t) {
+        num_output_rows += rb.num_rows();
+        return px::Status::OK();
+      });
+  px::carnot::exec::FakePlanNode fake_plan(123);
+  PL_CHECK_OK(child.Init(fake_plan, RowDescriptor({}), {output_rd}));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    UnionNode node;
+    node.AddChild(&child, 0);
+    std::vector<RowDescriptor> input_rds(num_parents, input_rd);
+    PL_CHECK_OK(node.Init(plan_node, output_rd, input_rds));
+    PL_CHECK_OK(node.Prepare(exec_state.get()));
+    PL_CHECK_OK(node.Open(exec_state.get()));
+    state.ResumeTiming();
+
+    for (int b = 0; b < num_batches; ++b) {
+      for (int64_t p = 0; p < num_parents; ++p) {
+        PL_CHECK_OK(node.ConsumeNext(exec_state.get(), batches[b], p));
+      }
+    }
+  }
+  CHECK_EQ(num_output_rows, state.iterations() * num_parents * num_batches * rows_per_batch);
+  state.SetItemsProcessed(num_output_rows);
+}
+
+static void UnionNodeArgs(benchmark::internal::Benchmark* b) {
+  for (int run_length : {1, 64}) {
+    for (int num_parents : {10, 50, 100, 500}) {
+      b->Args({num_parents, run_length});
+    }
+  }
+}
+
+BENCHMARK(BM_UnionNodeOrderedMerge)->Apply(UnionNodeArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnionNodeUnordered)->Arg(10)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
@@ -276,6 +276,43 @@ TEST_F(UnionNodeTest, ordered_full_overlap) {
       .Close();
 }
 
+TEST_F(UnionNodeTest, ordered_equal_times_split_across_batches) {
+  auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
+  plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::TIME64NS});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::STRING, types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<UnionNode, plan::UnionOperator>(
+      *plan_node_, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  tester.node()->disable_data_flush_timeout();
+
+  // Rows with equal times come from the parent with the smaller index first, even when that
+  // parent's run of rows fills more than one output batch.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({1, 1, 2})
+                       .AddColumn<types::StringValue>({"Z", "Y", "X"})
+                       .get(),
+                   1, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 7, true, true)
+                       .AddColumn<types::StringValue>({"A", "B", "C", "D", "E", "F", "G"})
+                       .AddColumn<types::Time64NSValue>({0, 1, 1, 1, 1, 1, 3})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"A", "B", "C", "D", "E"})
+                          .AddColumn<types::Time64NSValue>({0, 1, 1, 1, 1})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, true, true)
+                          .AddColumn<types::StringValue>({"F", "Z", "Y", "X", "G"})
+                          .AddColumn<types::Time64NSValue>({1, 1, 1, 2, 3})
+                          .get())
+      .Close();
+}
+
 TEST_F(UnionNodeTest, no_rows_parent) {
   auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
   plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
@@ -17,6 +17,12 @@
  */
 
 #pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include <absl/strings/str_cat.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/shared/types/types.h"
 
@@ -42,12 +48,45 @@ class AnyUDA : public udf::UDA {
     }
   }
 
-  void Merge(FunctionContext*, const AnyUDA&) {
-    // Does nothing.
+  void Merge(FunctionContext*, const AnyUDA& other) {
+    if (!picked && other.picked) {
+      val_ = other.val_;
+      picked = true;
+    }
   }
 
   TArg Finalize(FunctionContext*) { return val_; }
 
+  // The state is empty if no value was picked, otherwise it's the value's bytes.
+  StringValue Serialize(FunctionContext*) {
+    if (!picked) {
+      return "";
+    }
+    if constexpr (std::is_same_v<TArg, StringValue>) {
+      // Strings are prefixed, so that an empty one isn't taken for no value.
+      return absl::StrCat("s", val_);
+    } else {
+      return StringValue(reinterpret_cast<const char*>(&val_.val), sizeof(val_.val));
+    }
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    picked = !data.empty();
+    if (!picked) {
+      return Status::OK();
+    }
+    if constexpr (std::is_same_v<TArg, StringValue>) {
+      val_ = data.substr(1);
+    } else {
+      if (data.size() != sizeof(val_.val)) {
+        return error::InvalidArgument("Expected $0 bytes for any(), got $1", sizeof(val_.val),
+                                      data.size());
+      }
+      std::memcpy(&val_.val, data.data(), sizeof(val_.val));
+    }
+    return Status::OK();
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::InheritTypeFromArgs<AnyUDA>::CreateGeneric()};
   }
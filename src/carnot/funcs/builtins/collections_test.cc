@@ -23,6 +23,7 @@
 
 #include "src/carnot/funcs/builtins/collections.h"
 #include "src/carnot/udf/test_utils.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -41,6 +42,31 @@ TEST(CollectionsTest, AnyUDA) {
   EXPECT_THAT(vals, ::testing::Contains(uda_tester.Result()));
 }
 
+TEST(CollectionsTest, AnyUDAPartial) {
+  auto empty_tester = udf::UDATester<AnyUDA<types::Float64Value>>();
+  auto uda_tester = udf::UDATester<AnyUDA<types::Float64Value>>();
+  uda_tester.ForInput(1.234).ForInput(2.442);
+
+  // A node that saw no values takes the value of the one that did.
+  ASSERT_OK(empty_tester.Deserialize(uda_tester.Serialize()));
+  EXPECT_THAT(std::vector<double>({1.234, 2.442}),
+              ::testing::Contains(empty_tester.Result().val));
+}
+
+TEST(CollectionsTest, AnyUDAPartialString) {
+  auto empty_tester = udf::UDATester<AnyUDA<types::StringValue>>();
+  auto uda_tester = udf::UDATester<AnyUDA<types::StringValue>>();
+  uda_tester.ForInput("");
+
+  ASSERT_OK(empty_tester.Deserialize(udf::UDATester<AnyUDA<types::StringValue>>().Serialize()));
+  ASSERT_OK(empty_tester.Deserialize(uda_tester.Serialize()));
+  ASSERT_OK(empty_tester.Deserialize(udf::UDATester<AnyUDA<types::StringValue>>()
+                                         .ForInput("abc")
+                                         .Serialize()));
+  // The empty string was picked first.
+  EXPECT_EQ("", empty_tester.Result());
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/ddsketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "src/carnot/funcs/builtins/sketch_encoding.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+namespace {
+
+using internal::GetVarint;
+using internal::PutVarint;
+
+void PutDouble(double val, std::string* out) {
+  char buf[sizeof(double)];
+  std::memcpy(buf, &val, sizeof(buf));
+  out->append(buf, sizeof(buf));
+}
+
+Status GetDouble(std::string_view* data, double* val) {
+  if (data->size() < sizeof(double)) {
+    return error::InvalidArgument("Truncated DDSketch.");
+  }
+  std::memcpy(val, data->data(), sizeof(double));
+  data->remove_prefix(sizeof(double));
+  return Status::OK();
+}
+
+// ZigZag encodes bucket offsets, which are negative for values below 1.
+uint64_t ZigZag(int32_t val) {
+  return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(val) >> 63);
+}
+
+int32_t UnZigZag(uint64_t val) {
+  return static_cast<int32_t>((val >> 1) ^ (~(val & 1) + 1));
+}
+
+}  // namespace
+
+void DDSketch::BucketStore::Add(int32_t index, uint64_t count) {
+  if (counts_.empty()) {
+    offset_ = index;
+    counts_.push_back(0);
+  }
+  int32_t max_index = std::max(index, offset_ + static_cast<int32_t>(counts_.size()) - 1);
+  index = std::max(index, max_index - static_cast<int32_t>(max_buckets_) + 1);
+
+  if (index < offset_) {
+    counts_.insert(counts_.begin(), offset_ - index, 0);
+    offset_ = index;
+  } else if (index >= offset_ + static_cast<int32_t>(counts_.size())) {
+    counts_.resize(index - offset_ + 1, 0);
+    if (counts_.size() > max_buckets_) {
+      size_t excess = counts_.size() - max_buckets_;
+      uint64_t collapsed =
+          std::accumulate(counts_.begin(), counts_.begin() + excess + 1, uint64_t{0});
+      counts_.erase(counts_.begin(), counts_.begin() + excess);
+      counts_[0] = collapsed;
+      offset_ += static_cast<int32_t>(excess);
+    }
+  }
+  counts_[index - offset_] += count;
+  count_ += count;
+}
+
+void DDSketch::BucketStore::Merge(const BucketStore& other) {
+  // Adding from the highest bucket down collapses at most once.
+  for (size_t i = other.counts_.size(); i > 0; --i) {
+    if (other.counts_[i - 1] > 0) {
+      Add(other.offset_ + static_cast<int32_t>(i) - 1, other.counts_[i - 1]);
+    }
+  }
+}
+
+void DDSketch::BucketStore::Serialize(std::string* out) const {
+  PutVarint(ZigZag(offset_), out);
+  PutVarint(counts_.size(), out);
+  for (uint64_t count : counts_) {
+    PutVarint(count, out);
+  }
+}
+
+Status DDSketch::BucketStore::Deserialize(std::string_view* data) {
+  uint64_t offset;
+  uint64_t num_buckets;
+  PL_RETURN_IF_ERROR(GetVarint(data, &offset));
+  PL_RETURN_IF_ERROR(GetVarint(data, &num_buckets));
+  if (num_buckets > max_buckets_) {
+    return error::InvalidArgument("DDSketch has $0 buckets, more than the max of $1.", num_buckets,
+                                  max_buckets_);
+  }
+  offset_ = UnZigZag(offset);
+  counts_.resize(num_buckets);
+  count_ = 0;
+  for (uint64_t& count : counts_) {
+    PL_RETURN_IF_ERROR(GetVarint(data, &count));
+    count_ += count;
+  }
+  return Status::OK();
+}
+
+DDSketch::DDSketch(double relative_accuracy, size_t max_buckets)
+    : gamma_((1 + relative_accuracy) / (1 - relative_accuracy)),
+      inv_log_gamma_(1 / std::log(gamma_)),
+      min_indexable_value_(std::numeric_limits<double>::min() * gamma_),
+      negative_(max_buckets),
+      positive_(max_buckets) {}
+
+int32_t DDSketch::Index(double val) const {
+  return static_cast<int32_t>(std::ceil(std::log(val) * inv_log_gamma_));
+}
+
+// Returns the value in the bucket with the least relative error to all the values in it.
+double DDSketch::Value(int32_t index) const {
+  return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+}
+
+void DDSketch::Add(double val) {
+  if (std::isnan(val)) {
+    return;
+  }
+  if (val > min_indexable_value_) {
+    positive_.Add(Index(val), 1);
+  } else if (val < -min_indexable_value_) {
+    negative_.Add(Index(-val), 1);
+  } else {
+    ++zero_count_;
+  }
+  min_ = std::min(min_, val);
+  max_ = std::max(max_, val);
+}
+
+void DDSketch::Merge(const DDSketch& other) {
+  DCHECK_EQ(gamma_, other.gamma_);
+  negative_.Merge(other.negative_);
+  positive_.Merge(other.positive_);
+  zero_count_ += other.zero_count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+double DDSketch::Quantile(double q) const {
+  uint64_t total = count();
+  if (total == 0) {
+    return 0;
+  }
+  // The extremes are tracked exactly.
+  if (q <= 0) {
+    return min_;
+  }
+  if (q >= 1) {
+    return max_;
+  }
+  double rank = q * (total - 1);
+
+  // Walk the buckets in increasing value order, which is decreasing index for negative values.
+  uint64_t seen = 0;
+  const auto& neg_counts = negative_.counts();
+  for (size_t i = neg_counts.size(); i > 0; --i) {
+    seen += neg_counts[i - 1];
+    if (seen > rank) {
+      return std::clamp(-Value(negative_.offset() + static_cast<int32_t>(i) - 1), min_, max_);
+    }
+  }
+  seen += zero_count_;
+  if (seen > rank) {
+    return std::clamp(0.0, min_, max_);
+  }
+  double val = max_;
+  const auto& pos_counts = positive_.counts();
+  for (size_t i = 0; i < pos_counts.size(); ++i) {
+    seen += pos_counts[i];
+    if (seen > rank) {
+      val = Value(positive_.offset() + static_cast<int32_t>(i));
+      break;
+    }
+  }
+  return std::clamp(val, min_, max_);
+}
+
+std::string DDSketch::Serialize() const {
+  std::string out;
+  PutDouble(gamma_, &out);
+  PutDouble(min_, &out);
+  PutDouble(max_, &out);
+  PutVarint(zero_count_, &out);
+  negative_.Serialize(&out);
+  positive_.Serialize(&out);
+  return out;
+}
+
+Status DDSketch::Deserialize(std::string_view data) {
+  double gamma;
+  PL_RETURN_IF_ERROR(GetDouble(&data, &gamma));
+  if (gamma != gamma_) {
+    return error::InvalidArgument("DDSketch has gamma $0, expected $1.", gamma, gamma_);
+  }
+  PL_RETURN_IF_ERROR(GetDouble(&data, &min_));
+  PL_RETURN_IF_ERROR(GetDouble(&data, &max_));
+  PL_RETURN_IF_ERROR(GetVarint(&data, &zero_count_));
+  PL_RETURN_IF_ERROR(negative_.Deserialize(&data));
+  PL_RETURN_IF_ERROR(positive_.Deserialize(&data));
+  if (!data.empty()) {
+    return error::InvalidArgument("DDSketch has $0 trailing bytes.", data.size());
+  }
+  return Status::OK();
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
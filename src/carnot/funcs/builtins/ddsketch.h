@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * DDSketch is a quantile sketch with a bounded relative error, as described in
+ * https://arxiv.org/abs/1908.10693. Values are counted in logarithmically sized buckets, so
+ * merging two sketches just adds their bucket counts, and the serialized sketch is a few hundred
+ * bytes for typical latency distributions.
+ */
+class DDSketch {
+ public:
+  static constexpr double kDefaultRelativeAccuracy = 0.01;
+  static constexpr size_t kDefaultMaxBuckets = 2048;
+
+  explicit DDSketch(double relative_accuracy = kDefaultRelativeAccuracy,
+                    size_t max_buckets = kDefaultMaxBuckets);
+
+  void Add(double val);
+
+  /**
+   * Adds the values of the other sketch to this one. Both sketches must have the same relative
+   * accuracy.
+   */
+  void Merge(const DDSketch& other);
+
+  /**
+   * Returns the value at quantile q, which must be in [0, 1]. Returns 0 for an empty sketch.
+   */
+  double Quantile(double q) const;
+
+  uint64_t count() const { return negative_.count() + zero_count_ + positive_.count(); }
+
+  std::string Serialize() const;
+  Status Deserialize(std::string_view data);
+
+ private:
+  // Counts of values by bucket index. Once there are more than max_buckets buckets, the lowest
+  // buckets are collapsed into one, which only loses accuracy for the smallest magnitudes.
+  class BucketStore {
+   public:
+    explicit BucketStore(size_t max_buckets) : max_buckets_(max_buckets) {}
+
+    void Add(int32_t index, uint64_t count);
+    void Merge(const BucketStore& other);
+
+    uint64_t count() const { return count_; }
+    int32_t offset() const { return offset_; }
+    const std::vector<uint64_t>& counts() const { return counts_; }
+
+    void Serialize(std::string* out) const;
+    Status Deserialize(std::string_view* data);
+
+   private:
+    size_t max_buckets_;
+    int32_t offset_ = 0;
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+  };
+
+  int32_t Index(double val) const;
+  double Value(int32_t index) const;
+
+  double gamma_;
+  double inv_log_gamma_;
+  // Smaller values are counted as zero, so that their indexes don't underflow.
+  double min_indexable_value_;
+
+  BucketStore negative_;
+  BucketStore positive_;
+  uint64_t zero_count_ = 0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/ddsketch.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+constexpr double kQuantiles[] = {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99};
+
+std::vector<double> LatencyLikeValues(int n) {
+  std::mt19937 gen(37);
+  std::lognormal_distribution<double> dist(/*m*/ 10, /*s*/ 1.5);
+  std::vector<double> vals(n);
+  for (double& val : vals) {
+    val = dist(gen);
+  }
+  return vals;
+}
+
+double ExactQuantile(std::vector<double> vals, double q) {
+  std::sort(vals.begin(), vals.end());
+  return vals[static_cast<size_t>(q * (vals.size() - 1))];
+}
+
+TEST(DDSketch, quantiles_within_relative_accuracy) {
+  auto vals = LatencyLikeValues(10000);
+  DDSketch sketch;
+  for (double val : vals) {
+    sketch.Add(val);
+  }
+  EXPECT_EQ(sketch.count(), vals.size());
+  for (double q : kQuantiles) {
+    double exact = ExactQuantile(vals, q);
+    EXPECT_NEAR(sketch.Quantile(q), exact, exact * DDSketch::kDefaultRelativeAccuracy) << q;
+  }
+  EXPECT_EQ(sketch.Quantile(0), *std::min_element(vals.begin(), vals.end()));
+  EXPECT_EQ(sketch.Quantile(1), *std::max_element(vals.begin(), vals.end()));
+}
+
+TEST(DDSketch, negative_and_zero_values) {
+  DDSketch sketch;
+  for (double val : {-100.0, -10.0, 0.0, 0.0, 10.0}) {
+    sketch.Add(val);
+  }
+  EXPECT_NEAR(sketch.Quantile(0.25), -10.0, 0.1);
+  EXPECT_EQ(sketch.Quantile(0.5), 0.0);
+  EXPECT_EQ(sketch.Quantile(0.75), 0.0);
+  EXPECT_EQ(sketch.Quantile(0), -100.0);
+  EXPECT_EQ(sketch.Quantile(1), 10.0);
+}
+
+TEST(DDSketch, merge_matches_single_sketch) {
+  auto vals = LatencyLikeValues(10000);
+  DDSketch all;
+  DDSketch halves[2];
+  for (size_t i = 0; i < vals.size(); ++i) {
+    all.Add(vals[i]);
+    halves[i % 2].Add(vals[i]);
+  }
+  halves[0].Merge(halves[1]);
+  EXPECT_EQ(halves[0].count(), all.count());
+  for (double q : kQuantiles) {
+    EXPECT_EQ(halves[0].Quantile(q), all.Quantile(q)) << q;
+  }
+}
+
+TEST(DDSketch, serialize_round_trip) {
+  DDSketch sketch;
+  for (double val : LatencyLikeValues(10000)) {
+    sketch.Add(val);
+  }
+  sketch.Add(0);
+  sketch.Add(-5);
+  std::string serialized = sketch.Serialize();
+  // A few bytes per bucket, rather than a pair of doubles per centroid.
+  EXPECT_LT(serialized.size(), 2048);
+
+  DDSketch deserialized;
+  ASSERT_OK(deserialized.Deserialize(serialized));
+  EXPECT_EQ(deserialized.count(), sketch.count());
+  for (double q : kQuantiles) {
+    EXPECT_EQ(deserialized.Quantile(q), sketch.Quantile(q)) << q;
+  }
+  EXPECT_EQ(deserialized.Serialize(), serialized);
+
+  EXPECT_NOT_OK(deserialized.Deserialize(serialized.substr(0, serialized.size() - 1)));
+  EXPECT_NOT_OK(deserialized.Deserialize(serialized + "x"));
+  EXPECT_NOT_OK(DDSketch(0.05).Deserialize(serialized));
+}
+
+TEST(DDSketch, collapses_lowest_buckets) {
+  // 64 buckets only span values within a factor of 3.5 of each other.
+  DDSketch sketch(DDSketch::kDefaultRelativeAccuracy, /*max_buckets*/ 64);
+  for (int val = 1; val <= 100; ++val) {
+    sketch.Add(val);
+  }
+  // The highest values keep their accuracy, while the lowest are lumped together.
+  EXPECT_NEAR(sketch.Quantile(0.99), 99, 99 * DDSketch::kDefaultRelativeAccuracy);
+  EXPECT_GT(sketch.Quantile(0.01), 20);
+  EXPECT_LT(sketch.Serialize().size(), 128);
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/hyperloglog.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/carnot/funcs/builtins/sketch_encoding.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+namespace {
+
+using internal::GetVarint;
+using internal::PutVarint;
+
+constexpr uint8_t kSparseFormat = 1;
+constexpr uint8_t kDenseFormat = 2;
+constexpr int kSparseRankBits = 6;
+
+// Returns the position of the first set bit in the low num_bits bits of val, counting from the
+// highest of them. Returns num_bits + 1 if none are set.
+uint8_t Rank(uint64_t val, int num_bits) {
+  uint64_t bits = val << (64 - num_bits);
+  return bits == 0 ? num_bits + 1 : __builtin_clzll(bits) + 1;
+}
+
+}  // namespace
+
+void HyperLogLog::AddHash(uint64_t hash) {
+  uint32_t sparse_index = hash >> (64 - kSparsePrecision);
+  if (is_sparse()) {
+    AddSparse(sparse_index, Rank(hash, 64 - kSparsePrecision));
+    return;
+  }
+  AddDense(hash >> (64 - kPrecision), Rank(hash, 64 - kPrecision));
+}
+
+void HyperLogLog::AddSparse(uint32_t index, uint8_t rank) {
+  auto [it, inserted] = sparse_.try_emplace(index, rank);
+  if (!inserted) {
+    it->second = std::max(it->second, rank);
+  } else if (sparse_.size() > kMaxSparseEntries) {
+    ConvertToDense();
+  }
+}
+
+void HyperLogLog::AddDense(uint32_t index, uint8_t rank) {
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::AddSparseToDense(uint32_t sparse_index, uint8_t sparse_rank) {
+  // The extra index bits of the sparse index are the highest bits of the dense rank's window.
+  constexpr int kExtraIndexBits = kSparsePrecision - kPrecision;
+  uint32_t extra_bits = sparse_index & ((1 << kExtraIndexBits) - 1);
+  uint8_t rank =
+      extra_bits != 0 ? Rank(extra_bits, kExtraIndexBits) : kExtraIndexBits + sparse_rank;
+  AddDense(sparse_index >> kExtraIndexBits, rank);
+}
+
+void HyperLogLog::ConvertToDense() {
+  registers_.assign(kNumRegisters, 0);
+  for (const auto& [sparse_index, sparse_rank] : sparse_) {
+    AddSparseToDense(sparse_index, sparse_rank);
+  }
+  sparse_.clear();
+  sparse_.rehash(0);
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+  if (other.is_sparse()) {
+    for (const auto& [index, rank] : other.sparse_) {
+      if (is_sparse()) {
+        AddSparse(index, rank);
+      } else {
+        AddSparseToDense(index, rank);
+      }
+    }
+    return;
+  }
+  if (is_sparse()) {
+    ConvertToDense();
+  }
+  for (size_t i = 0; i < kNumRegisters; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+  if (is_sparse()) {
+    // Linear counting over the sparse indexes.
+    double m = 1ULL << kSparsePrecision;
+    return static_cast<uint64_t>(std::llround(m * std::log(m / (m - sparse_.size()))));
+  }
+
+  constexpr double m = kNumRegisters;
+  constexpr double alpha = 0.7213 / (1 + 1.079 / m);
+  double sum = 0;
+  int num_zeros = 0;
+  for (uint8_t reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    num_zeros += reg == 0;
+  }
+  double estimate = alpha * m * m / sum;
+  // HyperLogLog over-estimates small cardinalities, which linear counting gets right.
+  if (estimate <= 2.5 * m && num_zeros > 0) {
+    estimate = m * std::log(m / num_zeros);
+  }
+  return static_cast<uint64_t>(std::llround(estimate));
+}
+
+std::string HyperLogLog::Serialize() const {
+  std::string out;
+  if (!is_sparse()) {
+    out.reserve(1 + kNumRegisters);
+    out.push_back(kDenseFormat);
+    out.append(registers_.begin(), registers_.end());
+    return out;
+  }
+  // Sorted entries are delta encoded, so the indexes take a byte or two each.
+  std::vector<uint32_t> entries;
+  entries.reserve(sparse_.size());
+  for (const auto& [index, rank] : sparse_) {
+    entries.push_back(index << kSparseRankBits | rank);
+  }
+  std::sort(entries.begin(), entries.end());
+  out.push_back(kSparseFormat);
+  PutVarint(entries.size(), &out);
+  uint32_t prev = 0;
+  for (uint32_t entry : entries) {
+    PutVarint(entry - prev, &out);
+    prev = entry;
+  }
+  return out;
+}
+
+Status HyperLogLog::Deserialize(std::string_view data) {
+  if (data.empty()) {
+    return error::InvalidArgument("Empty HyperLogLog.");
+  }
+  uint8_t format = data.front();
+  data.remove_prefix(1);
+  sparse_.clear();
+  registers_.clear();
+
+  if (format == kDenseFormat) {
+    if (data.size() != kNumRegisters) {
+      return error::InvalidArgument("HyperLogLog has $0 registers, expected $1.", data.size(),
+                                    kNumRegisters);
+    }
+    registers_.assign(data.begin(), data.end());
+    return Status::OK();
+  }
+  if (format != kSparseFormat) {
+    return error::InvalidArgument("Unknown HyperLogLog format $0.", format);
+  }
+
+  uint64_t num_entries;
+  PL_RETURN_IF_ERROR(GetVarint(&data, &num_entries));
+  if (num_entries > kMaxSparseEntries) {
+    return error::InvalidArgument("HyperLogLog has $0 sparse entries, more than the max of $1.",
+                                  num_entries, kMaxSparseEntries);
+  }
+  uint64_t entry = 0;
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    uint64_t delta;
+    PL_RETURN_IF_ERROR(GetVarint(&data, &delta));
+    entry += delta;
+    if (entry >> kSparseRankBits >= (1 << kSparsePrecision)) {
+      return error::InvalidArgument("HyperLogLog has an out of range sparse index.");
+    }
+    sparse_.emplace(entry >> kSparseRankBits, entry & ((1 << kSparseRankBits) - 1));
+  }
+  if (!data.empty()) {
+    return error::InvalidArgument("HyperLogLog has $0 trailing bytes.", data.size());
+  }
+  return Status::OK();
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
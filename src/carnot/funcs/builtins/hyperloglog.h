@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * HyperLogLog estimates the number of distinct values it has seen in constant memory, following
+ * HLL++ (https://research.google/pubs/pub40671/). Small sets are stored sparsely at a higher
+ * precision, which keeps them compact and nearly exact, and are converted to 2^14 dense registers
+ * once they grow. The estimate of a dense sketch has a standard error of about 0.8%.
+ *
+ * Values are added by 64 bit hash, which must be the same in every process whose sketches are
+ * merged.
+ */
+class HyperLogLog {
+ public:
+  void AddHash(uint64_t hash);
+
+  void Merge(const HyperLogLog& other);
+
+  uint64_t Estimate() const;
+
+  bool is_sparse() const { return registers_.empty(); }
+
+  std::string Serialize() const;
+  Status Deserialize(std::string_view data);
+
+  static constexpr int kPrecision = 14;
+  static constexpr int kSparsePrecision = 25;
+
+ private:
+  static constexpr size_t kNumRegisters = 1 << kPrecision;
+  // The sparse representation takes more memory per entry than a register, so it is converted
+  // once it would be about as large as the registers.
+  static constexpr size_t kMaxSparseEntries = kNumRegisters / 4;
+
+  void AddSparse(uint32_t index, uint8_t rank);
+  void AddDense(uint32_t index, uint8_t rank);
+  void AddSparseToDense(uint32_t sparse_index, uint8_t sparse_rank);
+  void ConvertToDense();
+
+  // Max rank by index at kSparsePrecision, while the sketch is sparse.
+  absl::flat_hash_map<uint32_t, uint8_t> sparse_;
+  // Max rank by index at kPrecision, once the sketch is dense.
+  std::vector<uint8_t> registers_;
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/carnot/funcs/builtins/hyperloglog.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/hash_utils.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+uint64_t Hash(int64_t val) { return types::utils::hash<types::Int64Value>()(val); }
+
+HyperLogLog SketchOfRange(int64_t begin, int64_t end) {
+  HyperLogLog hll;
+  for (int64_t val = begin; val < end; ++val) {
+    hll.AddHash(Hash(val));
+  }
+  return hll;
+}
+
+TEST(HyperLogLog, small_sets_are_sparse_and_near_exact) {
+  HyperLogLog hll = SketchOfRange(0, 1000);
+  for (int64_t val = 0; val < 1000; ++val) {
+    hll.AddHash(Hash(val));
+  }
+  EXPECT_TRUE(hll.is_sparse());
+  EXPECT_NEAR(hll.Estimate(), 1000, 2);
+  EXPECT_EQ(HyperLogLog().Estimate(), 0);
+}
+
+TEST(HyperLogLog, large_sets_within_error) {
+  HyperLogLog hll = SketchOfRange(0, 1000000);
+  EXPECT_FALSE(hll.is_sparse());
+  EXPECT_NEAR(hll.Estimate(), 1000000, 1000000 * 0.03);
+}
+
+TEST(HyperLogLog, estimate_is_continuous_across_conversion) {
+  for (int64_t n : {4000, 5000, 20000, 50000}) {
+    EXPECT_NEAR(SketchOfRange(0, n).Estimate(), n, n * 0.03) << n;
+  }
+}
+
+TEST(HyperLogLog, merge_overlapping_sets) {
+  HyperLogLog dense = SketchOfRange(0, 60000);
+  HyperLogLog sparse = SketchOfRange(50000, 51000);
+  ASSERT_FALSE(dense.is_sparse());
+  ASSERT_TRUE(sparse.is_sparse());
+
+  HyperLogLog merged;
+  merged.Merge(sparse);
+  EXPECT_TRUE(merged.is_sparse());
+  merged.Merge(dense);
+  EXPECT_FALSE(merged.is_sparse());
+  EXPECT_EQ(merged.Estimate(), dense.Estimate());
+
+  // Merging sparse entries into registers gives the same registers as adding their values.
+  HyperLogLog dense_then_sparse = SketchOfRange(0, 60000);
+  dense_then_sparse.Merge(SketchOfRange(60000, 61000));
+  EXPECT_EQ(dense_then_sparse.Serialize(), SketchOfRange(0, 61000).Serialize());
+}
+
+TEST(HyperLogLog, serialize_round_trip) {
+  for (int64_t n : {0, 1000, 100000}) {
+    HyperLogLog hll = SketchOfRange(0, n);
+    std::string serialized = hll.Serialize();
+
+    HyperLogLog deserialized;
+    ASSERT_OK(deserialized.Deserialize(serialized));
+    EXPECT_EQ(deserialized.is_sparse(), hll.is_sparse());
+    EXPECT_EQ(deserialized.Estimate(), hll.Estimate());
+    EXPECT_EQ(deserialized.Serialize(), serialized);
+  }
+  // Sparse sketches take a few bytes per value.
+  EXPECT_LT(SketchOfRange(0, 1000).Serialize().size(), 4000);
+  EXPECT_EQ(SketchOfRange(0, 100000).Serialize().size(), 1 + (1 << HyperLogLog::kPrecision));
+}
+
+TEST(HyperLogLog, deserialize_invalid) {
+  std::string serialized = SketchOfRange(0, 1000).Serialize();
+  HyperLogLog hll;
+  EXPECT_NOT_OK(hll.Deserialize(""));
+  EXPECT_NOT_OK(hll.Deserialize("x"));
+  EXPECT_NOT_OK(hll.Deserialize(serialized.substr(0, serialized.size() - 1)));
+  EXPECT_NOT_OK(hll.Deserialize(serialized + "x"));
+  EXPECT_NOT_OK(hll.Deserialize(SketchOfRange(0, 100000).Serialize().substr(0, 100)));
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -26,6 +26,21 @@ namespace builtins {
 
 using types::StringValue;
 
+const rapidjson::Document& JSONDocumentCache::Get(const std::string& json) {
+  auto it = docs_.find(json);
+  if (it != docs_.end()) {
+    return *it->second;
+  }
+  if (cached_bytes_ + json.size() > kMaxCachedBytes) {
+    docs_.clear();
+    cached_bytes_ = 0;
+  }
+  auto doc = std::make_unique<rapidjson::Document>();
+  doc->Parse(json.data());
+  cached_bytes_ += json.size();
+  return *docs_.emplace(json, std::move(doc)).first->second;
+}
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
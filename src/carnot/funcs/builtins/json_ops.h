@@ -18,10 +18,12 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
@@ -33,15 +35,68 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * JSONDocumentCache holds the documents parsed by the JSON funcs of one exec node, so that
+ * plucking several keys out of the same column parses each string once rather than once per
+ * pluck. It is only used when the node runs more than one JSON func.
+ */
+class JSONDocumentCache {
+ public:
+  void AddFunc() { ++num_funcs_; }
+  bool enabled() const { return num_funcs_ > 1; }
+
+  /**
+   * Returns the parsed document for the json string, parsing it if it isn't cached. The
+   * reference is valid until the next call.
+   */
+  const rapidjson::Document& Get(const std::string& json);
+
+ private:
+  // Bounds the json text cached at a time. Documents from earlier row batches are dropped once
+  // this is reached, which keeps at least a whole batch of typical bodies.
+  static constexpr size_t kMaxCachedBytes = 8 * 1024 * 1024;
+
+  size_t num_funcs_ = 0;
+  size_t cached_bytes_ = 0;
+  absl::flat_hash_map<std::string, std::unique_ptr<rapidjson::Document>> docs_;
+};
+
+/**
+ * JSONFunc is the base of funcs that parse a json string argument.
+ */
+class JSONFunc : public udf::ScalarUDF {
+ public:
+  Status Init(FunctionContext* ctx) {
+    if (ctx != nullptr) {
+      cache_ = ctx->SharedState<JSONDocumentCache>();
+      cache_->AddFunc();
+    }
+    return Status::OK();
+  }
+
+ protected:
+  // Returns the parsed json, from the node's cache if it is enabled, or else parsed into doc.
+  const rapidjson::Document& Parse(const StringValue& json, rapidjson::Document* doc) {
+    if (cache_ != nullptr && cache_->enabled()) {
+      return cache_->Get(json);
+    }
+    doc->Parse(json.data());
+    return *doc;
+  }
+
+ private:
+  JSONDocumentCache* cache_ = nullptr;
+};
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
-class PluckUDF : public udf::ScalarUDF {
+class PluckUDF : public JSONFunc {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    const rapidjson::Document& d = Parse(in, &doc);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d.HasParseError()) {
       return "";
     }
     if (!d.IsObject()) {
@@ -84,13 +139,13 @@ class PluckUDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsInt64UDF : public udf::ScalarUDF {
+class PluckAsInt64UDF : public JSONFunc {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    const rapidjson::Document& d = Parse(in, &doc);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d.HasParseError()) {
       return 0;
     }
     if (!d.IsObject()) {
@@ -128,13 +183,13 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsFloat64UDF : public udf::ScalarUDF {
+class PluckAsFloat64UDF : public JSONFunc {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    const rapidjson::Document& d = Parse(in, &doc);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d.HasParseError()) {
       return 0.0;
     }
     if (!d.IsObject()) {
@@ -175,13 +230,13 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
   }
 };
 
-class PluckArrayUDF : public udf::ScalarUDF {
+class PluckArrayUDF : public JSONFunc {
  public:
   StringValue Exec(FunctionContext*, StringValue in, Int64Value index) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    rapidjson::Document doc;
+    const rapidjson::Document& d = Parse(in, &doc);
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (d.HasParseError()) {
       return "";
     }
     if (!d.IsArray()) {
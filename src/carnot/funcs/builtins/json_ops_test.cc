@@ -20,6 +20,7 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 #include "src/carnot/udf/test_utils.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -111,6 +112,24 @@ TEST(JSONOps, PluckArrayUDF_index_out_of_bound) {
   udf_tester.ForInput(kTestJSONArray, 3).Expect("");
 }
 
+TEST(JSONOps, pluck_funcs_share_parsed_documents) {
+  udf::FunctionContext ctx(nullptr, nullptr);
+  PluckUDF pluck;
+  PluckAsInt64UDF pluck_int64;
+  PluckAsFloat64UDF pluck_float64;
+  ASSERT_OK(pluck.Init(&ctx));
+  ASSERT_OK(pluck_int64.Init(&ctx));
+  ASSERT_OK(pluck_float64.Init(&ctx));
+  EXPECT_TRUE(ctx.SharedState<JSONDocumentCache>()->enabled());
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(pluck.Exec(&ctx, kTestJSONStr, "str_plain"), "abc");
+    EXPECT_EQ(pluck_int64.Exec(&ctx, kTestJSONStr, "int64_key"), 34243242341);
+    EXPECT_EQ(pluck_float64.Exec(&ctx, kTestJSONStr, "float64_key"), 123423.5234);
+    EXPECT_EQ(pluck.Exec(&ctx, "asdad", "str_key"), "");
+  }
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/ddsketch.h"
+#include "tdigest/tdigest.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+std::vector<double> LatencyLikeValues(int n) {
+  std::mt19937 gen(37);
+  std::lognormal_distribution<double> dist(/*m*/ 10, /*s*/ 1.5);
+  std::vector<double> vals(n);
+  for (double& val : vals) {
+    val = dist(gen);
+  }
+  return vals;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TDigestUpdate(benchmark::State& state) {
+  auto vals = LatencyLikeValues(state.range(0));
+  for (auto _ : state) {
+    tdigest::TDigest digest(1000);
+    for (double val : vals) {
+      digest.add(val);
+    }
+    benchmark::DoNotOptimize(digest.quantile(0.99));
+  }
+  state.SetItemsProcessed(state.iterations() * vals.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_DDSketchUpdate(benchmark::State& state) {
+  auto vals = LatencyLikeValues(state.range(0));
+  for (auto _ : state) {
+    DDSketch sketch;
+    for (double val : vals) {
+      sketch.Add(val);
+    }
+    benchmark::DoNotOptimize(sketch.Quantile(0.99));
+  }
+  state.SetItemsProcessed(state.iterations() * vals.size());
+}
+
+constexpr int kValuesPerPartial = 10000;
+
+// Merges range(0) partials, like a Kelvin combining the aggregates of that many PEMs.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TDigestMerge(benchmark::State& state) {
+  auto vals = LatencyLikeValues(kValuesPerPartial);
+  std::vector<std::unique_ptr<tdigest::TDigest>> partials;
+  for (int i = 0; i < state.range(0); ++i) {
+    partials.push_back(std::make_unique<tdigest::TDigest>(1000));
+    for (size_t j = i; j < vals.size(); j += state.range(0)) {
+      partials.back()->add(vals[j]);
+    }
+  }
+  for (auto _ : state) {
+    tdigest::TDigest merged(1000);
+    for (const auto& partial : partials) {
+      merged.merge(partial.get());
+    }
+    benchmark::DoNotOptimize(merged.quantile(0.99));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Also includes deserializing the partials, which the tdigest UDA has no representation for.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_DDSketchMerge(benchmark::State& state) {
+  auto vals = LatencyLikeValues(kValuesPerPartial);
+  std::vector<std::string> partials;
+  size_t serialized_bytes = 0;
+  for (int i = 0; i < state.range(0); ++i) {
+    DDSketch partial;
+    for (size_t j = i; j < vals.size(); j += state.range(0)) {
+      partial.Add(vals[j]);
+    }
+    partials.push_back(partial.Serialize());
+    serialized_bytes += partials.back().size();
+  }
+  for (auto _ : state) {
+    DDSketch merged;
+    for (const auto& serialized : partials) {
+      DDSketch partial;
+      PL_UNUSED(partial.Deserialize(serialized));
+      merged.Merge(partial);
+    }
+    benchmark::DoNotOptimize(merged.Quantile(0.99));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["SerializedBytesPerPartial"] = serialized_bytes / state.range(0);
+}
+
+BENCHMARK(BM_TDigestUpdate)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_DDSketchUpdate)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_TDigestMerge)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_DDSketchMerge)->RangeMultiplier(4)->Range(1, 256);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
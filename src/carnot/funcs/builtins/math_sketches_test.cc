@@ -22,6 +22,7 @@
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -69,6 +70,38 @@ TEST(MathSketches, quantiles_int64) {
   EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6);
 }
 
+TEST(MathSketches, ddsketch_quantiles) {
+  auto uda_tester = udf::UDATester<DDSketchQuantilesUDA<types::Int64Value>>();
+  auto other_tester = udf::UDATester<DDSketchQuantilesUDA<types::Int64Value>>();
+  for (int64_t val = 1; val <= 50; ++val) {
+    uda_tester.ForInput(val);
+    other_tester.ForInput(val + 50);
+  }
+  // Merge the other half as a partial aggregate.
+  ASSERT_OK(uda_tester.Deserialize(other_tester.Serialize()));
+  auto res = uda_tester.Result();
+
+  rapidjson::Document d;
+  d.Parse(res.data());
+  EXPECT_NEAR(d["p01"].GetDouble(), 1, 0.01);
+  EXPECT_NEAR(d["p10"].GetDouble(), 10, 0.1);
+  EXPECT_NEAR(d["p50"].GetDouble(), 50, 0.5);
+  EXPECT_NEAR(d["p90"].GetDouble(), 90, 0.9);
+  EXPECT_NEAR(d["p99"].GetDouble(), 99, 0.99);
+}
+
+TEST(MathSketches, approx_count_distinct) {
+  auto uda_tester = udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>();
+  auto other_tester = udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>();
+  for (int i = 0; i < 100; ++i) {
+    uda_tester.ForInput(absl::StrCat("/api/v1/orders/", i % 50));
+    other_tester.ForInput(absl::StrCat("/api/v1/orders/", i));
+  }
+  // Merge the other values as a partial aggregate.
+  ASSERT_OK(uda_tester.Deserialize(other_tester.Serialize()));
+  EXPECT_EQ(uda_tester.Result(), 100);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
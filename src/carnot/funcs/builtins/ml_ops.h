@@ -24,8 +24,12 @@
 #include <rapidjson/writer.h>
 #include <sentencepiece/sentencepiece_processor.h>
 
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/ml/coreset.h"
@@ -61,6 +65,21 @@ class TransformerUDF : public udf::ScalarUDF {
     return output;
   }
 
+  // Borrows the executor once for the whole batch, and runs the rows through it together.
+  void ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* docs) {
+    auto executor =
+        ctx->model_pool()->GetModelExecutor<exec::ml::TransformerExecutor>(model_proto_path_);
+    std::vector<const std::string*> batch(count);
+    for (size_t i = 0; i < count; ++i) {
+      batch[i] = &docs[i];
+    }
+    std::vector<std::string> outputs;
+    executor->ExecuteBatch(batch, &outputs);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = std::move(outputs[i]);
+    }
+  }
+
  private:
   std::string model_proto_path_;
 };
@@ -175,6 +194,57 @@ class ReservoirSampleUDA : public udf::UDA {
     return reservoir_[0];
   }
 
+  // The state is the count followed by the reservoir, each string prefixed by its length.
+  StringValue Serialize(FunctionContext*) {
+    StringValue data;
+    data.append(reinterpret_cast<const char*>(&count_), sizeof(count_));
+    for (const auto& val : reservoir_) {
+      if constexpr (std::is_same_v<TArg, StringValue>) {
+        uint64_t size = val.size();
+        data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        data.append(val);
+      } else {
+        data.append(reinterpret_cast<const char*>(&val.val), sizeof(val.val));
+      }
+    }
+    return data;
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    std::string_view remaining(data);
+    auto read = [&remaining](auto* out) {
+      if (remaining.size() < sizeof(*out)) {
+        return false;
+      }
+      std::memcpy(out, remaining.data(), sizeof(*out));
+      remaining.remove_prefix(sizeof(*out));
+      return true;
+    };
+    if (!read(&count_)) {
+      return error::InvalidArgument("Truncated sample state");
+    }
+    reservoir_.clear();
+    while (!remaining.empty()) {
+      TArg val;
+      if constexpr (std::is_same_v<TArg, StringValue>) {
+        uint64_t size;
+        if (!read(&size) || size > remaining.size()) {
+          return error::InvalidArgument("Truncated sample state");
+        }
+        val = std::string(remaining.substr(0, size));
+        remaining.remove_prefix(size);
+      } else if (!read(&val.val)) {
+        return error::InvalidArgument("Truncated sample state");
+      }
+      reservoir_.push_back(std::move(val));
+    }
+    if (reservoir_.size() > k_) {
+      return error::InvalidArgument("Sample state has $0 values, expected at most $1",
+                                    reservoir_.size(), k_);
+    }
+    return Status::OK();
+  }
+
  private:
   size_t k_;
   size_t count_;
@@ -28,6 +28,7 @@
 #include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 
 #include "src/carnot/exec/ml/eigen_test_utils.h"
 
@@ -51,6 +52,17 @@ std::string write_vector_to_json(const Eigen::VectorXf& vector) {
   return sb.GetString();
 }
 
+TEST(ReservoirSample, partial) {
+  auto empty_tester = udf::UDATester<ReservoirSampleUDA<types::StringValue>>();
+  auto uda_tester = udf::UDATester<ReservoirSampleUDA<types::StringValue>>();
+  uda_tester.ForInput("a").ForInput("b").ForInput("c");
+
+  ASSERT_OK(empty_tester.Deserialize(uda_tester.Serialize()));
+  EXPECT_THAT(std::vector<std::string>({"a", "b", "c"}),
+              ::testing::Contains(std::string(empty_tester.Result())));
+  EXPECT_NOT_OK(empty_tester.Deserialize("abc"));
+}
+
 TEST(KMeans, basic) {
   int k = 3;
   int d = 2;
@@ -102,6 +114,24 @@ TEST(Transformer, basic) {
   }
 }
 
+TEST(Transformer, batch_matches_single_rows) {
+  auto pool = exec::ml::ModelPool::Create();
+  auto ctx = std::make_unique<FunctionContext>(nullptr, pool.get());
+  TransformerUDF udf(FLAGS_embedding_dir);
+
+  std::vector<types::StringValue> docs = {"[4,197,803,195,16,5001]", "not json", "[7,8,9]",
+                                          "[]", "[4,197,803,195,16,5001]"};
+  std::vector<types::StringValue> out(docs.size());
+  udf.ExecBatch(ctx.get(), docs.size(), out.data(), docs.data());
+
+  for (const auto& [i, doc] : Enumerate(docs)) {
+    EXPECT_EQ(udf.Exec(ctx.get(), doc), out[i]);
+  }
+  EXPECT_EQ("", out[1]);
+  EXPECT_EQ("", out[3]);
+  EXPECT_NE("", out[0]);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
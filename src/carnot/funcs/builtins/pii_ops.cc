@@ -321,7 +321,12 @@ static std::map<Tag::Type, std::string_view> type_to_sub_str_ = {
     SUB_STR(Tag::Type::IMEISV),   SUB_STR(Tag::Type::IBAN),      SUB_STR(Tag::Type::SSN),
 };
 
-Status RedactPIIUDF::Init(FunctionContext*) {
+const PIIScanner& PIIScanner::Get() {
+  static const auto* scanner = new PIIScanner();
+  return *scanner;
+}
+
+PIIScanner::PIIScanner() {
   // Order is important here. For example, IPv6 has to go before IPv4 to support IPv6 addresses with
   // the lowest 32 bits written like IPv4. Also Email has to go before IP since IP addresses can be
   // part of valid emails.
@@ -334,12 +339,51 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::SSN>>());
+
+  re2::RE2::Options opts;
+  opts.set_log_errors(false);
+  // The combined automaton is much larger than that of any one pattern, mostly due to IPv6.
+  opts.set_max_mem(int64_t{64} << 20);
+  prefilter_ = std::make_unique<re2::RE2::Set>(opts, re2::RE2::UNANCHORED);
+  bool added_all = std::all_of(taggers_.begin(), taggers_.end(), [this](const auto& tagger) {
+    return prefilter_->Add(tagger->Pattern(), nullptr) >= 0;
+  });
+  if (!added_all || !prefilter_->Compile()) {
+    LOG(WARNING) << "Failed to compile the PII prefilter, every PII tagger will run on each input.";
+    prefilter_ = nullptr;
+  }
+}
+
+Status PIIScanner::AddTags(const std::string& input, std::vector<Tag>* tags) const {
+  std::vector<int> candidates;
+  if (prefilter_ != nullptr) {
+    re2::RE2::Set::ErrorInfo error_info;
+    if (prefilter_->Match(input, &candidates, &error_info)) {
+      std::sort(candidates.begin(), candidates.end());
+      for (int idx : candidates) {
+        PL_RETURN_IF_ERROR(taggers_[idx]->AddTags(input, tags));
+      }
+      return Status::OK();
+    }
+    if (error_info.kind == re2::RE2::Set::kNoError) {
+      return Status::OK();
+    }
+    // The automaton can run out of memory on large inputs, in which case no PII must be missed.
+  }
+  for (const auto& tagger : taggers_) {
+    PL_RETURN_IF_ERROR(tagger->AddTags(input, tags));
+  }
+  return Status::OK();
+}
+
+Status RedactPIIUDF::Init(FunctionContext*) {
+  scanner_ = &PIIScanner::Get();
   return Status::OK();
 }
 
 // Replace all tagged sequences in the string with the corresponding substitution string. For
 // overlapping tags, we take the longest tag.
-static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag>* tags) {
+static inline std::string ReplaceTagsWithSubs(const std::string& input, std::vector<Tag>* tags) {
   // Sort the tags chronologically.
   std::sort(tags->begin(), tags->end(), [](Tag a, Tag b) { return a.start_idx < b.start_idx; });
 
@@ -350,23 +394,17 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
       it++;
       continue;
     }
-    std::vector<Tag> overlapping_tags;
+    auto max_size_tag = it;
     auto sub_it = it;
     while (sub_it != tags->end() &&
            sub_it->start_idx < (it->start_idx + static_cast<int>(it->size))) {
-      overlapping_tags.push_back(*sub_it);
-      sub_it++;
-    }
-    Tag max_size_tag;
-    size_t max_size = 0;
-    for (const auto& tag : overlapping_tags) {
-      if (tag.size > max_size) {
-        max_size_tag = tag;
-        max_size = tag.size;
+      if (sub_it->size > max_size_tag->size) {
+        max_size_tag = sub_it;
       }
+      sub_it++;
     }
-    non_overlapping_tags.push_back(max_size_tag);
-    it = tags->erase(it, it + overlapping_tags.size());
+    non_overlapping_tags.push_back(*max_size_tag);
+    it = sub_it;
   }
 
   // Calculate new string size.
@@ -374,7 +412,7 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
   for (auto tag : non_overlapping_tags) {
     new_string_size = new_string_size + type_to_sub_str_[tag.tag_type].size() - tag.size;
   }
-  // Build new string from old string and non overlapping tags.
+  // Build new string from old string and non overlapping tags, in a single copy.
   std::string output(new_string_size, 0);
   int input_idx = 0;
   auto data_ptr = output.data();
@@ -394,11 +432,12 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
-    auto s = tagger->AddTags(&input, &tags);
-    if (!s.ok()) {
-      return "Invalid regex: " + s.msg();
-    }
+  auto s = scanner_->AddTags(input, &tags);
+  if (!s.ok()) {
+    return "Invalid regex: " + s.msg();
+  }
+  if (tags.empty()) {
+    return input;
   }
   return ReplaceTagsWithSubs(input, &tags);
 }
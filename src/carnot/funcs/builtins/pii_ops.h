@@ -20,9 +20,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -69,7 +71,30 @@ static std::map<std::string, uint32_t> country_codes{
 class Tagger {
  public:
   virtual ~Tagger() = default;
-  virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // The regex whose matches are tagged, before they are validated.
+  virtual std::string_view Pattern() const = 0;
+  virtual Status AddTags(const std::string& input, std::vector<Tag>* tags) const = 0;
+};
+
+/**
+ * PIIScanner finds the PII in a string. The patterns of all the taggers are also compiled
+ * together into one RE2::Set, which finds in a single pass which kinds of PII a string may
+ * contain. Only those taggers then run, with their validators, so most strings, which contain no
+ * PII at all, are scanned once instead of once per kind of PII.
+ */
+class PIIScanner {
+ public:
+  // The scanner doesn't change once built, so one is shared by all RedactPIIUDF instances.
+  static const PIIScanner& Get();
+
+  Status AddTags(const std::string& input, std::vector<Tag>* tags) const;
+
+ private:
+  PIIScanner();
+
+  std::vector<std::unique_ptr<Tagger>> taggers_;
+  // The set's pattern at index i is the pattern of taggers_[i]. nullptr if it didn't compile.
+  std::unique_ptr<re2::RE2::Set> prefilter_;
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
@@ -93,7 +118,7 @@ class RedactPIIUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::vector<std::unique_ptr<Tagger>> taggers_;
+  const PIIScanner* scanner_ = nullptr;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -106,8 +131,10 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
-    re2::StringPiece input_piece(input->data(), input->length());
+  std::string_view Pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
+  Status AddTags(const std::string& input, std::vector<Tag>* tags) const override {
+    re2::StringPiece input_piece(input.data(), input.length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
     std::string match;
@@ -51,7 +51,32 @@ static void BM_RedactPII(benchmark::State& state) {
                           static_cast<int64_t>(state.iterations()));
 }
 
+// Most bodies contain no PII at all.
+static constexpr std::string_view no_pii_chunk = R"input(
+        {"method": "GET", "path": "/api/v1/orders", "status": "shipped", "items": [
+          {"sku": "ab-cd", "qty": 2, "price": "19.99"}, {"sku": "ef-gh", "qty": 1}],
+        "user_agent": "Mozilla/5.0 (X11; Linux x86_64)", "cache": "miss"},
+)input";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPIINoPII(benchmark::State& state) {
+  RedactPIIUDF udf;
+  PL_UNUSED(udf.Init(nullptr));
+
+  std::string text_chunk(no_pii_chunk);
+  std::string text;
+  for (int i = 0; i < state.range(0); i++) {
+    text += text_chunk;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, text));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(text.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
+BENCHMARK(BM_RedactPIINoPII)->RangeMultiplier(2)->Range(1, 12);
 
 }  // namespace builtins
 }  // namespace carnot
@@ -262,6 +262,20 @@ TEST_P(RedactionTest, basic) {
   udf::UDFTester<RedactPIIUDF>().Init().ForInput(test_case.first).Expect(test_case.second);
 }
 
+TEST(PIIScanner, only_tags_matching_kinds) {
+  const auto& scanner = PIIScanner::Get();
+  std::vector<Tag> tags;
+  ASSERT_OK(scanner.AddTags(R"({"user": "alice", "status": "ok"})", &tags));
+  EXPECT_TRUE(tags.empty());
+
+  ASSERT_OK(scanner.AddTags("from 10.0.0.1 by bob@example.com", &tags));
+  std::vector<Tag::Type> types;
+  for (const auto& tag : tags) {
+    types.push_back(tag.tag_type);
+  }
+  EXPECT_THAT(types, ::testing::UnorderedElementsAre(Tag::Type::EMAIL_ADDR, Tag::Type::IPv4));
+}
+
 INSTANTIATE_TEST_SUITE_P(TemplatedRedactionTest, RedactionTest,
                          ::testing::ValuesIn(TestCaseGen({IBANGen(), IPv4Gen(), IPv6Gen(),
                                                           EmailGen(), CCGen(), IMEIGen(), SSNGen(),
@@ -17,6 +17,10 @@
  */
 
 #include "src/carnot/funcs/builtins/regex_ops.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
@@ -24,6 +28,109 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace {
+
+// Bounds the memory used when patterns come from data rather than constants.
+constexpr size_t kMaxCachedPatterns = 1024;
+
+// A process-wide map of compiled patterns. Patterns are compiled outside of the lock, so two
+// queries may compile the same one, in which case the first to finish is kept.
+template <typename TKey, typename TValue>
+class CompiledCache {
+ public:
+  std::shared_ptr<const TValue> Get(const TKey& key) {
+    absl::MutexLock lock(&mu_);
+    auto it = compiled_.find(key);
+    return it == compiled_.end() ? nullptr : it->second;
+  }
+
+  std::shared_ptr<const TValue> Put(const TKey& key, std::shared_ptr<const TValue> value) {
+    absl::MutexLock lock(&mu_);
+    if (compiled_.size() >= kMaxCachedPatterns) {
+      compiled_.clear();
+    }
+    return compiled_.emplace(key, std::move(value)).first->second;
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<TKey, std::shared_ptr<const TValue>> compiled_ ABSL_GUARDED_BY(mu_);
+};
+
+re2::RE2::Options RegexOptions(bool dot_nl) {
+  re2::RE2::Options opts;
+  opts.set_dot_nl(dot_nl);
+  opts.set_log_errors(false);
+  return opts;
+}
+
+}  // namespace
+
+std::shared_ptr<const re2::RE2> GetCompiledRegex(std::string_view pattern, bool dot_nl) {
+  static auto* cache = new CompiledCache<std::pair<std::string, bool>, re2::RE2>();
+  auto key = std::make_pair(std::string(pattern), dot_nl);
+  if (auto regex = cache->Get(key); regex != nullptr) {
+    return regex;
+  }
+  return cache->Put(key, std::make_shared<const re2::RE2>(key.first, RegexOptions(dot_nl)));
+}
+
+// Rules are full matches across lines, like regex_match.
+RegexRuleSet::RegexRuleSet() : set_(RegexOptions(/*dot_nl*/ true), re2::RE2::ANCHOR_BOTH) {}
+
+StatusOr<std::shared_ptr<const RegexRuleSet>> RegexRuleSet::Get(std::string_view encoded_rules) {
+  static auto* cache = new CompiledCache<std::string, RegexRuleSet>();
+  std::string key(encoded_rules);
+  if (auto rules = cache->Get(key); rules != nullptr) {
+    return rules;
+  }
+
+  rapidjson::Document regex_rules_json;
+  rapidjson::ParseResult parse_result = regex_rules_json.Parse(key.c_str());
+  if (!parse_result || !regex_rules_json.IsObject()) {
+    return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
+  }
+
+  std::shared_ptr<RegexRuleSet> rules(new RegexRuleSet());
+  std::vector<std::string> patterns;
+  for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
+       itr != regex_rules_json.MemberEnd(); ++itr) {
+    std::string pattern = itr->value.GetString();
+    // Like regex_match, a rule that doesn't compile never matches.
+    if (rules->set_.Add(pattern, nullptr) < 0) {
+      continue;
+    }
+    rules->names_.push_back(itr->name.GetString());
+    patterns.push_back(std::move(pattern));
+  }
+  if (!rules->names_.empty() && !rules->set_.Compile()) {
+    for (const auto& pattern : patterns) {
+      rules->fallback_regexes_.push_back(GetCompiledRegex(pattern, /*dot_nl*/ true));
+    }
+  }
+  return cache->Put(key, std::move(rules));
+}
+
+std::string_view RegexRuleSet::Match(std::string_view value) const {
+  re2::StringPiece text(value.data(), value.size());
+  if (!fallback_regexes_.empty()) {
+    for (size_t i = 0; i < fallback_regexes_.size(); ++i) {
+      if (RE2::FullMatch(text, *fallback_regexes_[i])) {
+        return names_[i];
+      }
+    }
+    return "";
+  }
+  if (names_.empty()) {
+    return "";
+  }
+  std::vector<int> matches;
+  if (!set_.Match(text, &matches)) {
+    return "";
+  }
+  return names_[*std::min_element(matches.begin(), matches.end())];
+}
+
 void RegisterRegexOpsOrDie(udf::Registry* registry) {
   CHECK(registry != nullptr);
   /*****************************************
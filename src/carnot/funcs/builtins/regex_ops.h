@@ -26,9 +26,11 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -37,13 +39,46 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * Returns the compiled regex for the pattern, compiling it only the first time it is seen.
+ * Regex UDFs are almost always called with a constant pattern, so the compiled regexes are
+ * shared by all UDF instances, across queries. Patterns that fail to compile are returned too,
+ * with their error code set.
+ */
+std::shared_ptr<const re2::RE2> GetCompiledRegex(std::string_view pattern, bool dot_nl);
+
+/**
+ * RegexRuleSet fully matches a value against a list of named rules in a single pass, instead of
+ * running each rule's regex in turn.
+ */
+class RegexRuleSet {
+ public:
+  /**
+   * Returns the rule set for rules encoded as a json map from rule name to pattern. Like
+   * GetCompiledRegex, rule sets are compiled once and shared.
+   */
+  static StatusOr<std::shared_ptr<const RegexRuleSet>> Get(std::string_view encoded_rules);
+
+  /**
+   * Returns the name of the first rule, in the order of the json map, that fully matches the
+   * value, or an empty string if none does.
+   */
+  std::string_view Match(std::string_view value) const;
+
+ private:
+  RegexRuleSet();
+
+  // The names of the rules that compiled, in the order they were added to the set.
+  std::vector<std::string> names_;
+  re2::RE2::Set set_;
+  // Only used if the set fails to compile, e.g. because it is too large.
+  std::vector<std::shared_ptr<const re2::RE2>> fallback_regexes_;
+};
+
 class RegexMatchUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex) {
-    re2::RE2::Options opts;
-    opts.set_dot_nl(true);
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex, opts);
+    regex_ = GetCompiledRegex(regex, /*dot_nl*/ true);
     return Status::OK();
   }
   BoolValue Exec(FunctionContext*, StringValue input) {
@@ -69,24 +104,28 @@ class RegexMatchUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
 };
 
 class RegexReplaceUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex_pattern) {
-    re2::RE2::Options opts;
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex_pattern, opts);
+    regex_ = GetCompiledRegex(regex_pattern, /*dot_nl*/ false);
     return Status::OK();
   }
   StringValue Exec(FunctionContext*, StringValue input, StringValue sub) {
     if (regex_->error_code() != RE2::NoError) {
       return absl::Substitute("Invalid regex expr: $0", regex_->error());
     }
-    std::string err_str;
-    if (!regex_->CheckRewriteString(sub, &err_str)) {
-      return absl::Substitute("Invalid regex in substitution string: $0", err_str);
+    // The substitution is usually a constant too, so only check it when it changes.
+    if (!sub_checked_ || sub != checked_sub_) {
+      sub_error_.clear();
+      sub_valid_ = regex_->CheckRewriteString(sub, &sub_error_);
+      checked_sub_ = sub;
+      sub_checked_ = true;
+    }
+    if (!sub_valid_) {
+      return absl::Substitute("Invalid regex in substitution string: $0", sub_error_);
     }
     RE2::GlobalReplace(&input, *regex_, sub);
     return input;
@@ -114,38 +153,22 @@ class RegexReplaceUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::unique_ptr<re2::RE2> regex_;
+  std::shared_ptr<const re2::RE2> regex_;
+  std::string checked_sub_;
+  bool sub_checked_ = false;
+  bool sub_valid_ = false;
+  std::string sub_error_;
 };
 
 class MatchRegexRule : public udf::ScalarUDF {
  public:
-  Status Init(FunctionContext* ctx, StringValue encodedRegexRules) {
-    // Parse encodedRegexRules as json.
-    rapidjson::Document regex_rules_json;
-    rapidjson::ParseResult parse_result = regex_rules_json.Parse(encodedRegexRules.data());
-    if (!parse_result) {
-      return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
-    }
-    // Populate the parse regular expressions into self::regex_rules.
-    for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
-         itr != regex_rules_json.MemberEnd(); ++itr) {
-      RegexMatchUDF regex_match_udf;
-      std::string name = itr->name.GetString();
-      std::string regex_pattern = itr->value.GetString();
-      PL_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
-      regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
-      regex_rules_length++;
-    }
+  Status Init(FunctionContext*, StringValue encodedRegexRules) {
+    PL_ASSIGN_OR_RETURN(rules_, RegexRuleSet::Get(encodedRegexRules));
     return Status::OK();
   }
 
-  types::StringValue Exec(FunctionContext* ctx, StringValue value) {
-    for (int i = 0; i < regex_rules_length; i++) {
-      if (regex_rules[i].second.Exec(ctx, value).val) {
-        return regex_rules[i].first;
-      }
-    }
-    return "";
+  types::StringValue Exec(FunctionContext*, StringValue value) {
+    return std::string(rules_->Match(value));
   }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -170,8 +193,7 @@ class MatchRegexRule : public udf::ScalarUDF {
   }
 
  private:
-  int regex_rules_length = 0;
-  std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::shared_ptr<const RegexRuleSet> rules_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
@@ -96,6 +96,26 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, regex_match_rules_returns_first_match) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  constexpr char kRules[] =
+      R"({"invalid": "\K", "xss": ".*<script>.*", "sql": "(?i).*union select.*",)"
+      R"( "tag": ".*<.*>.*"})";
+  udf_tester.Init(kRules).ForInput("a<script>b").Expect("xss");
+  udf_tester.Init(kRules).ForInput("<b>bold</b>").Expect("tag");
+  udf_tester.Init(kRules).ForInput("1 UNION SELECT <x>").Expect("sql");
+  udf_tester.Init(kRules).ForInput("multi\nline <script>").Expect("xss");
+  udf_tester.Init(kRules).ForInput("plain").Expect("");
+}
+
+TEST(RegexOps, compiled_regexes_are_shared) {
+  EXPECT_EQ(GetCompiledRegex("abc.*", true), GetCompiledRegex("abc.*", true));
+  EXPECT_NE(GetCompiledRegex("abc.*", true), GetCompiledRegex("abc.*", false));
+  ASSERT_OK_AND_ASSIGN(auto rules, RegexRuleSet::Get(R"({"rule": "abc.*"})"));
+  ASSERT_OK_AND_ASSIGN(auto same_rules, RegexRuleSet::Get(R"({"rule": "abc.*"})"));
+  EXPECT_EQ(rules, same_rules);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
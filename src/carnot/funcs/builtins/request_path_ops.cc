@@ -210,6 +210,91 @@ void RequestPathCluster::ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writ
   writer->EndObject();
 }
 
+int32_t RequestPathTrie::AddNode(int64_t index) {
+  nodes_.emplace_back();
+  nodes_.back().min_index = index;
+  return nodes_.size() - 1;
+}
+
+void RequestPathTrie::Add(const RequestPath& centroid, int64_t index) {
+  auto [root, inserted] = roots_by_depth_.try_emplace(centroid.depth(), 0);
+  if (inserted) {
+    root->second = AddNode(index);
+  }
+  int32_t node_id = root->second;
+  for (const auto& component : centroid.path_components()) {
+    int32_t child_id;
+    if (component == RequestPath::kAnyToken) {
+      child_id = nodes_[node_id].any_child;
+      if (child_id == -1) {
+        child_id = AddNode(index);
+        nodes_[node_id].any_child = child_id;
+      }
+    } else {
+      auto it = nodes_[node_id].children.find(component);
+      if (it != nodes_[node_id].children.end()) {
+        child_id = it->second;
+      } else {
+        child_id = AddNode(index);
+        nodes_[node_id].children.emplace(component, child_id);
+      }
+    }
+    node_id = child_id;
+  }
+}
+
+int64_t RequestPathTrie::MostSimilar(const RequestPath& request_path) const {
+  auto it = roots_by_depth_.find(request_path.depth());
+  if (it == roots_by_depth_.end()) {
+    return -1;
+  }
+  int64_t best_num_agree = 0;
+  int64_t best_index = -1;
+  Search(it->second, request_path.path_components(), 0, 0, &best_num_agree, &best_index);
+  return best_index;
+}
+
+void RequestPathTrie::Search(int32_t node_id, const std::vector<std::string>& components,
+                             size_t pos, int64_t num_agree, int64_t* best_num_agree,
+                             int64_t* best_index) const {
+  const Node& node = nodes_[node_id];
+  // Skip this subtree if none of its centroids can beat the best one. Centroids that agree on
+  // nothing never do, since best_index starts at -1.
+  int64_t max_num_agree = num_agree + components.size() - pos;
+  if (max_num_agree < *best_num_agree ||
+      (max_num_agree == *best_num_agree && node.min_index > *best_index)) {
+    return;
+  }
+  if (pos == components.size()) {
+    *best_num_agree = num_agree;
+    *best_index = node.min_index;
+    return;
+  }
+
+  const auto& component = components[pos];
+  auto agreeing_child = node.children.end();
+  if (component != RequestPath::kAnyToken) {
+    agreeing_child = node.children.find(component);
+    if (agreeing_child != node.children.end()) {
+      Search(agreeing_child->second, components, pos + 1, num_agree + 1, best_num_agree,
+             best_index);
+    }
+  }
+  if (node.any_child != -1) {
+    Search(node.any_child, components, pos + 1, num_agree, best_num_agree, best_index);
+  }
+  // The other children disagree on this component, but may agree on more of the rest.
+  if (max_num_agree - 1 < *best_num_agree ||
+      (max_num_agree - 1 == *best_num_agree && node.min_index > *best_index)) {
+    return;
+  }
+  for (auto it = node.children.begin(); it != node.children.end(); ++it) {
+    if (it != agreeing_child) {
+      Search(it->second, components, pos + 1, num_agree, best_num_agree, best_index);
+    }
+  }
+}
+
 double RequestPathClustering::MaxSimilarity(const RequestPath& request_path,
                                             int64_t* max_index) const {
   auto it = depth_to_centroid_indices_.find(request_path.depth());
@@ -229,6 +314,7 @@ double RequestPathClustering::MaxSimilarity(const RequestPath& request_path,
 }
 
 void RequestPathClustering::AddNewCluster(const RequestPathCluster& cluster) {
+  predict_trie_.reset();
   auto centroid = cluster.centroid();
   if (depth_to_centroid_indices_.find(centroid.depth()) == depth_to_centroid_indices_.end()) {
     depth_to_centroid_indices_.emplace(centroid.depth(), std::vector<int64_t>());
@@ -239,6 +325,7 @@ void RequestPathClustering::AddNewCluster(const RequestPathCluster& cluster) {
 
 void RequestPathClustering::MergeCluster(int64_t cluster_index,
                                          const RequestPathCluster& other_cluster) {
+  predict_trie_.reset();
   clusters_[cluster_index].Merge(other_cluster);
 }
 
@@ -273,8 +360,14 @@ std::string RequestPathClustering::ToJSON() const {
 }
 
 const RequestPath& RequestPathClustering::Predict(const RequestPath& request_path) {
-  int64_t closest_cluster_index;
-  MaxSimilarity(request_path, &closest_cluster_index);
+  if (predict_trie_ == nullptr) {
+    auto trie = std::make_shared<RequestPathTrie>();
+    for (const auto& [cluster_index, cluster] : Enumerate(clusters_)) {
+      trie->Add(cluster.centroid(), cluster_index);
+    }
+    predict_trie_ = std::move(trie);
+  }
+  int64_t closest_cluster_index = predict_trie_->MostSimilar(request_path);
   if (closest_cluster_index == -1) {
     DCHECK(false) << absl::Substitute("Failed to find cluster close to request path $0",
                                       request_path.ToString());
@@ -307,6 +400,7 @@ void RequestPathClustering::Merge(const RequestPathClustering& other_clustering)
   }
 
   clusters_ = new_clusters;
+  predict_trie_.reset();
   // Rebuild depth_to_cluster_indices mapping.
   depth_to_centroid_indices_.clear();
   for (const auto& [cluster_idx, cluster] : Enumerate(clusters_)) {
@@ -20,6 +20,7 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -174,6 +175,43 @@ class RequestPathCluster {
   absl::flat_hash_set<RequestPath> members_;
 };
 
+/**
+ * RequestPathTrie indexes cluster centroids by their path components, with a separate edge for
+ * kAnyToken components. It finds the centroid most similar to a request path by following the
+ * agreeing edges first, and skips the subtrees that can't beat the best centroid found so far, so
+ * a request path matching a templated endpoint is resolved in O(depth) rather than O(clusters).
+ */
+class RequestPathTrie {
+ public:
+  /**
+   * Adds a centroid with the given cluster index. Centroids must be added in increasing index
+   * order.
+   */
+  void Add(const RequestPath& centroid, int64_t index);
+
+  /**
+   * Returns the index of the centroid most similar to the request path, as defined by
+   * RequestPath::Similarity, with ties going to the lowest index. Returns -1 if no centroid of the
+   * same depth has any component in common with the request path.
+   */
+  int64_t MostSimilar(const RequestPath& request_path) const;
+
+ private:
+  struct Node {
+    absl::flat_hash_map<std::string, int32_t> children;
+    int32_t any_child = -1;
+    // The lowest index of the centroids under this node.
+    int64_t min_index;
+  };
+
+  int32_t AddNode(int64_t index);
+  void Search(int32_t node_id, const std::vector<std::string>& components, size_t pos,
+              int64_t num_agree, int64_t* best_num_agree, int64_t* best_index) const;
+
+  std::vector<Node> nodes_;
+  absl::flat_hash_map<int64_t, int32_t> roots_by_depth_;
+};
+
 class RequestPathClustering {
  public:
   static StatusOr<RequestPathClustering> FromJSON(const std::string& json);
@@ -205,6 +243,9 @@ class RequestPathClustering {
   absl::flat_hash_map<int64_t, std::vector<int64_t>> depth_to_centroid_indices_;
   std::vector<RequestPathCluster> clusters_;
   double thresh_ = 0.5;
+  // Predict finds the most similar cluster with this, rather than comparing against every cluster.
+  // It is built on first use, and dropped when the clusters change.
+  std::shared_ptr<const RequestPathTrie> predict_trie_;
 };
 
 class RequestPathClusteringPredictUDF : public udf::ScalarUDF {
@@ -252,8 +293,19 @@ class RequestPathClusteringFitUDA : public udf::UDA {
 class RequestPathEndpointMatcherUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, StringValue request_path, StringValue endpoint) {
-    return RequestPath(request_path).Matches(RequestPath(endpoint));
+    // The endpoint is usually the same for every row, so it is only parsed when it changes.
+    if (!endpoint_init_ || endpoint != endpoint_str_) {
+      endpoint_ = RequestPath(endpoint);
+      endpoint_str_ = std::move(endpoint);
+      endpoint_init_ = true;
+    }
+    return RequestPath(request_path).Matches(endpoint_);
   }
+
+ private:
+  std::string endpoint_str_;
+  RequestPath endpoint_;
+  bool endpoint_init_ = false;
 };
 
 }  // namespace builtins
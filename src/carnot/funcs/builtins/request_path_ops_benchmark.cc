@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/request_path_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Returns a fitted clustering of templated endpoints, like those of an API gateway.
+std::string EndpointClustering(int num_endpoints) {
+  std::vector<std::string> clusters;
+  for (int i = 0; i < num_endpoints; ++i) {
+    clusters.push_back(
+        absl::Substitute(R"({"c": ["api", "v$0", "svc$1", "*", "action$2"], "m": []})", i % 3, i,
+                         i % 7));
+  }
+  return absl::StrCat("[", absl::StrJoin(clusters, ","), "]");
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RequestPathClusteringPredict(benchmark::State& state) {
+  int num_endpoints = state.range(0);
+  std::string clustering = EndpointClustering(num_endpoints);
+  std::vector<std::string> request_paths;
+  for (int i = 0; i < 1024; ++i) {
+    int endpoint = (i * 37) % num_endpoints;
+    request_paths.push_back(
+        absl::Substitute("/api/v$0/svc$1/$2/action$3", endpoint % 3, endpoint, i, endpoint % 7));
+  }
+
+  RequestPathClusteringPredictUDF udf;
+  for (auto _ : state) {
+    for (const auto& request_path : request_paths) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, request_path, clustering));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * request_paths.size());
+}
+
+BENCHMARK(BM_RequestPathClusteringPredict)->RangeMultiplier(4)->Range(16, 4096);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -90,11 +90,34 @@ TEST(RequestPathClusteringPredict, basic_low_cardinality) {
   udf_tester.ForInput("/a/b/c", serialized_clustering).Expect("/a/b/c");
 }
 
+TEST(RequestPathClusteringPredict, most_similar_of_many_clusters) {
+  auto clustering_or_s = RequestPathClustering::FromJSON(R"([
+      {"c": ["users", "*", "orders"], "m": []},
+      {"c": ["users", "*", "*"], "m": []},
+      {"c": ["items", "*", "orders"], "m": []},
+      {"c": ["users", "abc", "*"], "m": []},
+      {"c": ["users", "*"], "m": []}
+  ])");
+  ASSERT_OK(clustering_or_s);
+  auto clustering = clustering_or_s.ConsumeValueOrDie();
+
+  // Ties between equally similar clusters go to the first one.
+  EXPECT_EQ("/users/*/orders", clustering.Predict(RequestPath("/users/abc/orders")).ToString());
+  EXPECT_EQ("/users/abc/*", clustering.Predict(RequestPath("/users/abc/items")).ToString());
+  EXPECT_EQ("/items/*/orders", clustering.Predict(RequestPath("/items/abc/x")).ToString());
+  EXPECT_EQ("/users/*", clustering.Predict(RequestPath("/users/abc")).ToString());
+
+  // Clusters added after predicting are also predicted.
+  clustering.Update(RequestPathCluster(RequestPath("/x/y/z")));
+  EXPECT_EQ("/x/y/z", clustering.Predict(RequestPath("/x/y/z")).ToString());
+}
+
 TEST(RequestPathEndpointMatcher, basic) {
   auto udf_tester = udf::UDFTester<RequestPathEndpointMatcherUDF>();
   udf_tester.ForInput("/a/b/c", "/a/b/*").Expect(true);
   udf_tester.ForInput("/a/b/*", "/a/b/c").Expect(false);
   udf_tester.ForInput("/a/c/c", "/a/b/*").Expect(false);
+  udf_tester.ForInput("/a/c/c", "/a/c/*").Expect(true);
 }
 
 // This tests the case where different PEMs have different clusterings of their own data, such that
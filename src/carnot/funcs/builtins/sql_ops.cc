@@ -15,12 +15,23 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
+#include <string>
 #include <vector>
 
+#define TBB_PREVIEW_CONCURRENT_LRU_CACHE 1
+#include "tbb/concurrent_lru_cache.h"
+
 #include "src/carnot/funcs/builtins/sql_ops.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
+DEFINE_int64(carnot_sql_normalization_cache_size,
+             gflags::Int64FromEnv("PL_CARNOT_SQL_NORMALIZATION_CACHE_SIZE", 4096),
+             "The number of normalized sql statements cached for reuse by all queries. Tables "
+             "usually hold a few distinct statements issued repeatedly, so this saves most of "
+             "the parsing. 0 disables the cache.");
+
 namespace {
 static inline px::Status ParseExecuteCommand(std::string execute, std::string* query,
                                              std::vector<std::string>* param_values) {
@@ -42,31 +53,20 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
-void RegisterSQLOpsOrDie(udf::Registry* registry) {
-  CHECK(registry != nullptr);
-  /*****************************************
-   * Scalar UDFs.
-   *****************************************/
-  registry->RegisterOrDie<NormalizePostgresSQLUDF>("normalize_pgsql");
-  registry->RegisterOrDie<NormalizeMySQLUDF>("normalize_mysql");
-  /*****************************************
-   * Aggregate UDFs.
-   *****************************************/
-}
+namespace {
 
-types::StringValue NormalizePostgresSQLUDF::Exec(FunctionContext*, StringValue sql_str,
-                                                 StringValue cmd_code) {
+std::string NormalizePostgresSQL(std::string_view cmd_code, const std::string& sql_str) {
   std::string query;
   std::vector<std::string> param_values;
 
-  if (cmd_code.compare(kPgExecCmdCode) == 0) {
+  if (cmd_code == kPgExecCmdCode) {
     auto status = ParseExecuteCommand(sql_str, &query, &param_values);
     if (!status.ok()) {
       sql_parsing::NormalizeResult result;
       result.errmsg = status.msg();
       return result.ToJSON();
     }
-  } else if (cmd_code.compare(kPgQueryCmdCode) == 0) {
+  } else if (cmd_code == kPgQueryCmdCode) {
     query = sql_str;
   } else {
     sql_parsing::NormalizeResult result;
@@ -84,8 +84,7 @@ types::StringValue NormalizePostgresSQLUDF::Exec(FunctionContext*, StringValue s
   return result_or_s.ConsumeValueOrDie().ToJSON();
 }
 
-types::StringValue NormalizeMySQLUDF::Exec(FunctionContext*, StringValue sql_str,
-                                           Int64Value cmd_code) {
+std::string NormalizeMySQL(int64_t cmd_code, const std::string& sql_str) {
   std::string query;
   std::vector<std::string> param_values;
 
@@ -114,6 +113,82 @@ types::StringValue NormalizeMySQLUDF::Exec(FunctionContext*, StringValue sql_str
   return result_or_s.ConsumeValueOrDie().ToJSON();
 }
 
+// Longer statements are normalized without caching, so that they don't pin much memory.
+constexpr size_t kMaxCachedSQLSize = 4096;
+constexpr char kPgSQLDialect = 'p';
+constexpr char kMySQLDialect = 'm';
+
+/**
+ * NormalizationCache is an LRU cache of normalized statements shared by all queries of the
+ * process. Entries are keyed by "<dialect><cmd_code>\n<sql>", since the tbb cache computes values
+ * from the key alone.
+ */
+class NormalizationCache {
+ public:
+  static NormalizationCache* Get() {
+    static auto* cache = new NormalizationCache(FLAGS_carnot_sql_normalization_cache_size);
+    return cache->enabled_ ? cache : nullptr;
+  }
+
+  std::string Normalize(char dialect, std::string_view cmd_code, std::string_view sql_str) {
+    return cache_[absl::StrCat(std::string_view(&dialect, 1), cmd_code, "\n", sql_str)].value();
+  }
+
+ private:
+  explicit NormalizationCache(int64_t size)
+      : enabled_(size > 0),
+        cache_(&NormalizeKey, static_cast<size_t>(std::max<int64_t>(size, 1))) {}
+
+  static std::string NormalizeKey(std::string key) {
+    size_t sep = key.find('\n');
+    std::string_view cmd_code = std::string_view(key).substr(1, sep - 1);
+    std::string sql_str = key.substr(sep + 1);
+    if (key[0] == kPgSQLDialect) {
+      return NormalizePostgresSQL(cmd_code, sql_str);
+    }
+    int64_t mysql_cmd_code = 0;
+    CHECK(absl::SimpleAtoi(cmd_code, &mysql_cmd_code));
+    return NormalizeMySQL(mysql_cmd_code, sql_str);
+  }
+
+  const bool enabled_;
+  tbb::concurrent_lru_cache<std::string, std::string> cache_;
+};
+
+}  // namespace
+
+void RegisterSQLOpsOrDie(udf::Registry* registry) {
+  CHECK(registry != nullptr);
+  /*****************************************
+   * Scalar UDFs.
+   *****************************************/
+  registry->RegisterOrDie<NormalizePostgresSQLUDF>("normalize_pgsql");
+  registry->RegisterOrDie<NormalizeMySQLUDF>("normalize_mysql");
+  /*****************************************
+   * Aggregate UDFs.
+   *****************************************/
+}
+
+types::StringValue NormalizePostgresSQLUDF::Exec(FunctionContext*, StringValue sql_str,
+                                                 StringValue cmd_code) {
+  // Invalid cmd codes are cheap to reject, and could otherwise break the cache's key encoding.
+  bool valid_cmd_code = cmd_code == kPgQueryCmdCode || cmd_code == kPgExecCmdCode;
+  auto* cache = NormalizationCache::Get();
+  if (cache != nullptr && valid_cmd_code && sql_str.size() <= kMaxCachedSQLSize) {
+    return cache->Normalize(kPgSQLDialect, cmd_code, sql_str);
+  }
+  return NormalizePostgresSQL(cmd_code, sql_str);
+}
+
+types::StringValue NormalizeMySQLUDF::Exec(FunctionContext*, StringValue sql_str,
+                                           Int64Value cmd_code) {
+  auto* cache = NormalizationCache::Get();
+  if (cache != nullptr && sql_str.size() <= kMaxCachedSQLSize) {
+    return cache->Normalize(kMySQLDialect, absl::StrCat(cmd_code.val), sql_str);
+  }
+  return NormalizeMySQL(cmd_code.val, sql_str);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
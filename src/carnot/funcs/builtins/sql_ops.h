@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <gflags/gflags.h>
+
 #include <absl/strings/strip.h>
 #include <regex>
 #include <string>
@@ -27,6 +29,8 @@
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
 
+DECLARE_int64(carnot_sql_normalization_cache_size);
+
 namespace px {
 namespace carnot {
 namespace builtins {
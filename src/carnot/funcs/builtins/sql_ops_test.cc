@@ -199,6 +199,23 @@ TEST(NormMySQL, invalid_utf8) {
   udf_tester.ForInput(invalid, kMySQLQueryCmdCode).Expect(expected_result.ToJSON());
 }
 
+// Normalized statements are cached by dialect and cmd code, so the same sql string must not share
+// a result across them.
+TEST(NormSQL, repeated_statements_keep_dialect_and_cmd_code) {
+  NormalizePostgresSQLUDF pgsql;
+  NormalizeMySQLUDF mysql;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(pgsql.Exec(nullptr, "SELECT 1", kPgQueryCmdCode),
+              (NormalizeResult{"SELECT $1", {"1"}}.ToJSON()));
+    EXPECT_EQ(mysql.Exec(nullptr, "SELECT 1", kMySQLQueryCmdCode),
+              (NormalizeResult{"SELECT ?", {"1"}}.ToJSON()));
+    sql_parsing::NormalizeResult invalid_cmd_code;
+    invalid_cmd_code.errmsg = absl::Substitute("cmd_code must be one of '$0' or '$1'",
+                                               kMySQLQueryCmdCode, kMySQLExecuteCmdCode);
+    EXPECT_EQ(mysql.Exec(nullptr, "SELECT 1", 0), invalid_cmd_code.ToJSON());
+  }
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
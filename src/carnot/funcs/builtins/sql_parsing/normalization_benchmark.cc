@@ -18,7 +18,12 @@
 
 #include <gflags/gflags.h>
 
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
 #include <benchmark/benchmark.h>
+#include "src/carnot/funcs/builtins/sql_ops.h"
 #include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
 #include "src/common/perf/perf.h"
 
@@ -72,3 +77,44 @@ BENCHMARK_CAPTURE(BM_NormalizeMySQL, sock_shop,
                   "JOIN sock_tag ON sock.sock_id=sock_tag.sock_id JOIN tag ON "
                   "sock_tag.tag_id=tag.tag_id "
                   "WHERE sock.sock_id =abcde GROUP BY sock.sock_id;");
+
+// Builds a column of statements where each of the distinct statements repeats, as in a
+// pgsql_events table filled by a few services issuing the same queries.
+std::vector<std::string> RepeatedStatements(int num_rows, int num_distinct) {
+  std::vector<std::string> statements;
+  statements.reserve(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    statements.push_back(absl::Substitute(
+        "SELECT * FROM test WHERE property=$0 AND property2='abcd'", i % num_distinct));
+  }
+  return statements;
+}
+
+constexpr int kNumRows = 8192;
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizePgSQLRepeated(benchmark::State& state) {
+  auto statements = RepeatedStatements(kNumRows, state.range(0));
+  for (auto _ : state) {
+    for (const auto& sql : statements) {
+      benchmark::DoNotOptimize(px::carnot::builtins::sql_parsing::normalize_pgsql(sql, {}));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizePgSQLUDFRepeated(benchmark::State& state) {
+  auto statements = RepeatedStatements(kNumRows, state.range(0));
+  px::carnot::builtins::NormalizePostgresSQLUDF udf;
+  for (auto _ : state) {
+    for (const auto& sql : statements) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, sql, px::carnot::builtins::kPgQueryCmdCode));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRows);
+}
+
+// The number of distinct statements out of kNumRows. A busy node usually sees a few hundred.
+BENCHMARK(BM_NormalizePgSQLRepeated)->Arg(16)->Arg(256)->Arg(kNumRows);
+BENCHMARK(BM_NormalizePgSQLUDFRepeated)->Arg(16)->Arg(256)->Arg(kNumRows);
@@ -25,9 +25,12 @@
 #include <rapidjson/writer.h>
 #include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/type_inference.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -54,6 +57,10 @@ inline StatusOr<K8sNameIdentView> K8sName(std::string_view name) {
   return std::make_pair(name_parts[0], name_parts[1]);
 }
 
+// The key a MemoizedMetadataUDF stores for each argument type.
+inline absl::uint128 CacheKey(const types::UInt128Value& v) { return v.val; }
+inline const std::string& CacheKey(const types::StringValue& v) { return v; }
+
 }  // namespace internal
 
 inline const px::md::AgentMetadataState* GetMetadataState(px::carnot::udf::FunctionContext* ctx) {
@@ -63,6 +70,83 @@ inline const px::md::AgentMetadataState* GetMetadataState(px::carnot::udf::Funct
   return md;
 }
 
+/**
+ * MemoizedMetadataUDF is the base of metadata UDFs that map a single key to a value. The derived
+ * class implements:
+ *     static TReturn Resolve(const px::md::AgentMetadataState* md, const TArg& key)
+ * The results are memoized per UDF instance, and dropped whenever the metadata state or its epoch
+ * changes, so each distinct key is resolved once instead of on every row. The resolved strings
+ * are kept in the StringInterner of the function context, so the metadata UDFs of a node share a
+ * single copy of each pod, service or namespace name, and ExecView can return views of them.
+ */
+template <typename TUDF, typename TReturn, typename TArg>
+class MemoizedMetadataUDF : public ScalarUDF {
+  static_assert(std::is_same_v<TReturn, types::StringValue>,
+                "memoized metadata UDFs must return strings");
+
+ public:
+  TReturn Exec(FunctionContext* ctx, TArg key) { return ToValue(Get(ctx, key)); }
+
+  std::string_view ExecView(FunctionContext* ctx, TArg key) { return Get(ctx, key); }
+
+  void ExecBatch(FunctionContext* ctx, size_t count, TReturn* out, const TArg* keys) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      // Rows of the same process or pod usually arrive together.
+      if (idx > 0 && internal::CacheKey(keys[idx]) == internal::CacheKey(keys[idx - 1])) {
+        out[idx] = out[idx - 1];
+        continue;
+      }
+      out[idx] = ToValue(Get(ctx, keys[idx]));
+    }
+  }
+
+ private:
+  // Bounds the memory used for inputs that aren't metadata keys, such as arbitrary strings.
+  static constexpr size_t kMaxEntries = 64 * 1024;
+
+  static TReturn ToValue(std::string_view v) { return TReturn(v.data(), v.size()); }
+
+  std::string_view Get(FunctionContext* ctx, const TArg& key) {
+    auto md = GetMetadataState(ctx);
+    if (ctx != ctx_) {
+      ctx_ = ctx;
+      interner_ = ctx->SharedState<udf::StringInterner>();
+      md_ = nullptr;
+    }
+    if (md != md_ || md->epoch_id() != epoch_id_ || interner_->generation() != generation_) {
+      values_.clear();
+      md_ = md;
+      epoch_id_ = md->epoch_id();
+      generation_ = interner_->generation();
+    }
+    const auto& cache_key = internal::CacheKey(key);
+    auto it = values_.find(cache_key);
+    if (it != values_.end()) {
+      return it->second;
+    }
+    if (values_.size() >= kMaxEntries) {
+      values_.clear();
+    }
+    auto value = interner_->Intern(TUDF::Resolve(md, key));
+    // Interning the value can reset the interner, which leaves the other memoized views dangling.
+    if (interner_->generation() != generation_) {
+      values_.clear();
+      generation_ = interner_->generation();
+    }
+    values_.emplace(cache_key, value);
+    return value;
+  }
+
+  FunctionContext* ctx_ = nullptr;
+  udf::StringInterner* interner_ = nullptr;
+  const px::md::AgentMetadataState* md_ = nullptr;
+  uint64_t epoch_id_ = 0;
+  uint64_t generation_ = 0;
+  absl::flat_hash_map<std::decay_t<decltype(internal::CacheKey(std::declval<TArg>()))>,
+                      std::string_view>
+      values_;
+};
+
 class ASIDUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext* ctx) {
@@ -98,11 +182,9 @@ class UPIDToASIDUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodNameUDF : public ScalarUDF {
+class PodIDToPodNameUDF : public MemoizedMetadataUDF<PodIDToPodNameUDF, StringValue, StringValue> {
  public:
-  StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
-    auto md = GetMetadataState(ctx);
-
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const StringValue& pod_id) {
     const auto* pod_info = md->k8s_metadata_state().PodInfoByID(pod_id);
     if (pod_info != nullptr) {
       return absl::Substitute("$0/$1", pod_info->ns(), pod_info->name());
@@ -233,11 +315,10 @@ class PodNameToNamespaceUDF : public ScalarUDF {
   }
 };
 
-class UPIDToContainerIDUDF : public ScalarUDF {
+class UPIDToContainerIDUDF
+    : public MemoizedMetadataUDF<UPIDToContainerIDUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
-
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto upid_uint128 = absl::MakeUint128(upid_value.High64(), upid_value.Low64());
     auto upid = md::UPID(upid_uint128);
     auto pid = md->GetPIDByUPID(upid);
@@ -274,10 +355,10 @@ inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState
   return md->k8s_metadata_state().ContainerInfoByID(pid->cid());
 }
 
-class UPIDToContainerNameUDF : public ScalarUDF {
+class UPIDToContainerNameUDF
+    : public MemoizedMetadataUDF<UPIDToContainerNameUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto container_info = UPIDToContainer(md, upid_value);
     if (container_info == nullptr) {
       return "";
@@ -339,10 +420,10 @@ inline types::StringValue StringifyVector(const std::vector<std::string>& vec) {
   return "";
 }
 
-class UPIDToNamespaceUDF : public ScalarUDF {
+class UPIDToNamespaceUDF
+    : public MemoizedMetadataUDF<UPIDToNamespaceUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto pod_info = UPIDtoPod(md, upid_value);
     if (pod_info == nullptr) {
       return "";
@@ -371,10 +452,9 @@ class UPIDToNamespaceUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodIDUDF : public ScalarUDF {
+class UPIDToPodIDUDF : public MemoizedMetadataUDF<UPIDToPodIDUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto container_info = UPIDToContainer(md, upid_value);
     if (container_info == nullptr) {
       return "";
@@ -398,10 +478,9 @@ class UPIDToPodIDUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodNameUDF : public ScalarUDF {
+class UPIDToPodNameUDF : public MemoizedMetadataUDF<UPIDToPodNameUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto pod_info = UPIDtoPod(md, upid_value);
     if (pod_info == nullptr) {
       return "";
@@ -429,11 +508,10 @@ class UPIDToPodNameUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class ServiceIDToServiceNameUDF : public ScalarUDF {
+class ServiceIDToServiceNameUDF
+    : public MemoizedMetadataUDF<ServiceIDToServiceNameUDF, StringValue, StringValue> {
  public:
-  StringValue Exec(FunctionContext* ctx, StringValue service_id) {
-    auto md = GetMetadataState(ctx);
-
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const StringValue& service_id) {
     const auto* service_info = md->k8s_metadata_state().ServiceInfoByID(service_id);
     if (service_info != nullptr) {
       return absl::Substitute("$0/$1", service_info->ns(), service_info->name());
@@ -557,10 +635,10 @@ class ServiceNameToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for services that are currently running.
  */
-class UPIDToServiceIDUDF : public ScalarUDF {
+class UPIDToServiceIDUDF
+    : public MemoizedMetadataUDF<UPIDToServiceIDUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto pod_info = UPIDtoPod(md, upid_value);
     if (pod_info == nullptr || pod_info->services().size() == 0) {
       return "";
@@ -599,10 +677,10 @@ class UPIDToServiceIDUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for services that are currently running.
  */
-class UPIDToServiceNameUDF : public ScalarUDF {
+class UPIDToServiceNameUDF
+    : public MemoizedMetadataUDF<UPIDToServiceNameUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto pod_info = UPIDtoPod(md, upid_value);
     if (pod_info == nullptr || pod_info->services().size() == 0) {
       return "";
@@ -645,10 +723,9 @@ class UPIDToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the node name for the pod associated with the input upid.
  */
-class UPIDToNodeNameUDF : public ScalarUDF {
+class UPIDToNodeNameUDF : public MemoizedMetadataUDF<UPIDToNodeNameUDF, StringValue, UInt128Value> {
  public:
-  StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const UInt128Value& upid_value) {
     auto pod_info = UPIDtoPod(md, upid_value);
     if (pod_info == nullptr) {
       return "";
@@ -3008,13 +3085,12 @@ class HostNumCPUsUDF : public ScalarUDF {
   }
 };
 
-class IPToPodIDUDF : public ScalarUDF {
+class IPToPodIDUDF : public MemoizedMetadataUDF<IPToPodIDUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the pod id of pod with given pod_ip
    */
-  StringValue Exec(FunctionContext* ctx, StringValue pod_ip) {
-    auto md = GetMetadataState(ctx);
+  static StringValue Resolve(const px::md::AgentMetadataState* md, const StringValue& pod_ip) {
     return md->k8s_metadata_state().PodIDByIP(pod_ip);
   }
   static udf::ScalarUDFDocBuilder Doc() {
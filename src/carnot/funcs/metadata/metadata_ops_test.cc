@@ -44,6 +44,7 @@ using ::px::carnot::udf::FunctionContext;
 
 using ResourceUpdate = px::shared::k8s::metadatapb::ResourceUpdate;
 using ::testing::AnyOf;
+using ::testing::ElementsAre;
 
 class MetadataOpsTest : public ::testing::Test {
  protected:
@@ -147,6 +148,39 @@ TEST_F(MetadataOpsTest, upid_to_pod_name_test) {
   udf_tester.ForInput(upid3).Expect("");
 }
 
+TEST_F(MetadataOpsTest, memoized_udfs_share_interned_values) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  UPIDToPodNameUDF upid_to_pod_name;
+  PodIDToPodNameUDF pod_id_to_pod_name;
+  auto upid = types::UInt128Value(528280977975, 89101);
+  auto v1 = upid_to_pod_name.ExecView(function_ctx.get(), upid);
+  auto v2 = pod_id_to_pod_name.ExecView(function_ctx.get(), "1_uid");
+  EXPECT_EQ(v1, "pl/running_pod");
+  EXPECT_EQ(v1.data(), v2.data());
+  EXPECT_EQ(upid_to_pod_name.Exec(function_ctx.get(), upid), "pl/running_pod");
+  EXPECT_EQ(function_ctx->SharedState<udf::StringInterner>()->size(), 1);
+}
+
+TEST_F(MetadataOpsTest, upid_to_node_name_batch_test) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  UPIDToNodeNameUDF udf;
+  std::vector<types::UInt128Value> upids{
+      types::UInt128Value(528280977975, 89101), types::UInt128Value(528280977975, 89101),
+      types::UInt128Value(528280977975, 468), types::UInt128Value(528280977975, 123),
+      types::UInt128Value(528280977975, 89101)};
+  std::vector<types::StringValue> out(upids.size());
+  udf.ExecBatch(function_ctx.get(), upids.size(), out.data(), upids.data());
+  EXPECT_THAT(out,
+              ElementsAre("test_node", "test_node", "test_node_tbt", "", "test_node"));
+
+  // A new epoch drops the memoized node names.
+  updates_->enqueue(px::metadatapb::testutils::CreateTerminatedPodUpdatePB());
+  EXPECT_OK(px::md::ApplyK8sUpdates(11, metadata_state_.get(), &md_filter_, updates_.get()));
+  metadata_state_->set_epoch_id(metadata_state_->epoch_id() + 1);
+  udf.ExecBatch(function_ctx.get(), upids.size(), out.data(), upids.data());
+  EXPECT_THAT(out, ElementsAre("test_node", "test_node", "", "", "test_node"));
+}
+
 TEST_F(MetadataOpsTest, upid_to_namespace_test) {
   auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
   auto udf_tester = px::carnot::udf::UDFTester<UPIDToNamespaceUDF>(std::move(function_ctx));
@@ -193,6 +227,8 @@ TEST_F(MetadataOpsTest, upid_to_service_id_test) {
   // Terminate a service, and make sure that the upid no longer associates with that service.
   updates_->enqueue(px::metadatapb::testutils::CreateTerminatedServiceUpdatePB());
   EXPECT_OK(px::md::ApplyK8sUpdates(11, metadata_state_.get(), &md_filter_, updates_.get()));
+  // Memoized results are only dropped when the epoch changes.
+  metadata_state_->set_epoch_id(metadata_state_->epoch_id() + 1);
   // upid2 previously was connected to 4_uid.
   udf_tester.ForInput(upid2).Expect("");
 }
@@ -209,6 +245,8 @@ TEST_F(MetadataOpsTest, upid_to_service_name_test) {
 
   updates_->enqueue(px::metadatapb::testutils::CreateTerminatedServiceUpdatePB());
   EXPECT_OK(px::md::ApplyK8sUpdates(11, metadata_state_.get(), &md_filter_, updates_.get()));
+  // Memoized results are only dropped when the epoch changes.
+  metadata_state_->set_epoch_id(metadata_state_->epoch_id() + 1);
   // upid2 previously was connected to pl/terminating_service.
   udf_tester.ForInput(upid2).Expect("");
 }
@@ -292,6 +330,8 @@ TEST_F(MetadataOpsTest, upid_to_node_name_test) {
 
   updates_->enqueue(px::metadatapb::testutils::CreateTerminatedPodUpdatePB());
   EXPECT_OK(px::md::ApplyK8sUpdates(11, metadata_state_.get(), &md_filter_, updates_.get()));
+  // Memoized results are only dropped when the epoch changes.
+  metadata_state_->set_epoch_id(metadata_state_->epoch_id() + 1);
   // upid2 previously was connected to pl/terminating_pod.
   udf_tester.ForInput(upid2).Expect("");
 }
@@ -30,6 +30,7 @@
 #include "src/carnot/funcs/net/dns.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/type_inference.h"
+#include "src/common/base/cidr_trie.h"
 #include "src/common/base/inet_utils.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
@@ -73,15 +74,15 @@ class CIDRsContainIPUDF : public ScalarUDF {
       if (!doc.IsArray()) {
         return false;
       }
-      cidrs_.clear();
+      cidrs_ = px::CIDRTrie<bool>();
       for (rapidjson::Value::ConstValueIterator itr = doc.Begin(); itr != doc.End(); ++itr) {
         if (!itr->IsString()) {
           return false;
         }
-        cidrs_.emplace_back();
-        auto s = px::ParseCIDRBlock(itr->GetString(), &cidrs_.back());
-        if (!s.ok()) {
-          cidrs_.pop_back();
+        px::CIDRBlock cidr;
+        auto s = px::ParseCIDRBlock(itr->GetString(), &cidr);
+        if (s.ok()) {
+          cidrs_.Insert(cidr, true);
         }
       }
     }
@@ -91,12 +92,8 @@ class CIDRsContainIPUDF : public ScalarUDF {
     if (!s.ok()) {
       return false;
     }
-    for (const auto& cidr : cidrs_) {
-      if (px::CIDRContainsIPAddr(cidr, addr)) {
-        return true;
-      }
-    }
-    return false;
+    // The trie makes this a single walk over the address bits, however many CIDRs there are.
+    return cidrs_.Contains(addr);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Determine whether an IP is contained in a set of CIDR ranges.")
@@ -116,7 +113,7 @@ class CIDRsContainIPUDF : public ScalarUDF {
 
  private:
   std::string parsed_cidr_str_ = "";
-  std::vector<px::CIDRBlock> cidrs_;
+  px::CIDRTrie<bool> cidrs_;
 };
 
 void RegisterNetOpsOrDie(px::carnot::udf::Registry* registry);
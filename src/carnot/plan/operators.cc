@@ -76,6 +76,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<LimitOperator>(id, pb.limit_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
+    case planpb::SORT_OPERATOR:
+      return CreateOperator<SortOperator>(id, pb.sort_op());
     case planpb::JOIN_OPERATOR:
       return CreateOperator<JoinOperator>(id, pb.join_op());
     case planpb::UDTF_SOURCE_OPERATOR:
@@ -102,6 +104,10 @@ Status MemorySourceOperator::Init(const planpb::MemorySourceOperator& pb) {
   for (int i = 0; i < pb_.column_idxs_size(); ++i) {
     column_idxs_.emplace_back(pb_.column_idxs(i));
   }
+  for (const auto& predicate : pb_.predicates()) {
+    PL_ASSIGN_OR_RETURN(auto expr, ScalarExpression::FromProto(predicate));
+    predicates_.push_back(expr);
+  }
   is_initialized_ = true;
   return Status::OK();
 }
@@ -203,6 +209,10 @@ Status AggregateOperator::Init(const planpb::AggregateOperator& pb) {
   if (pb_.values_size() != pb_.value_names_size()) {
     return error::InvalidArgument("values names/exp size mismatch");
   }
+  if (pb_.window_panes() < 0 || (pb_.window_panes() > 1 && !pb_.windowed())) {
+    return error::InvalidArgument("window_panes of $0 is only valid for windowed aggregates",
+                                  pb_.window_panes());
+  }
   values_.reserve(static_cast<size_t>(pb_.values_size()));
   for (int i = 0; i < pb_.values_size(); ++i) {
     auto ae = std::make_unique<AggregateExpression>();
@@ -450,6 +460,67 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * Sort Operator Implementation.
+ */
+std::string SortOperator::DebugString() const {
+  std::vector<std::string> keys;
+  for (const auto& [i, col] : Enumerate(sort_cols_)) {
+    keys.push_back(absl::Substitute("$0$1", col, descending_[i] ? " desc" : ""));
+  }
+  return absl::Substitute("Op:Sort(keys: [$0], limit: $1, cols: [$2])", absl::StrJoin(keys, ","),
+                          pb_.limit(), absl::StrJoin(selected_cols_, ","));
+}
+
+Status SortOperator::Init(const planpb::SortOperator& pb) {
+  pb_ = pb;
+  if (pb_.limit() < 0) {
+    return error::InvalidArgument("Sort limit must not be negative, got $0", pb_.limit());
+  }
+  for (const auto& key : pb_.sort_keys()) {
+    sort_cols_.push_back(key.column().index());
+    descending_.push_back(key.descending());
+  }
+  selected_cols_.reserve(pb_.columns_size());
+  for (const auto& col : pb_.columns()) {
+    selected_cols_.push_back(col.index());
+  }
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> SortOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Sort operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of SortOperator", input_ids[0]);
+  }
+  PL_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  auto num_cols = static_cast<int64_t>(input_relation.NumColumns());
+  for (auto col_idx : sort_cols_) {
+    if (col_idx < 0 || col_idx >= num_cols) {
+      return error::InvalidArgument("Sort column index $0 is out of bounds, $1 columns", col_idx,
+                                    num_cols);
+    }
+  }
+  table_store::schema::Relation output_relation;
+  for (auto col_idx : selected_cols_) {
+    if (col_idx < 0 || col_idx >= num_cols) {
+      return error::InvalidArgument("Column index $0 is out of bounds, $1 columns", col_idx,
+                                    num_cols);
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(col_idx),
+                              input_relation.GetColumnName(col_idx),
+                              input_relation.GetColumnDesc(col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
@@ -590,6 +661,15 @@ Status JoinOperator::Init(const planpb::JoinOperator& pb) {
     equality_conditions_.emplace_back(pb_.equality_conditions(i));
   }
 
+  if (has_time_condition()) {
+    if (type() != planpb::JoinOperator::INNER) {
+      return error::InvalidArgument("Interval joins only support inner joins.");
+    }
+    if (time_condition().window_ns() < 0) {
+      return error::InvalidArgument("Interval join window must not be negative, got $0.",
+                                    time_condition().window_ns());
+    }
+  }
   if (order_by_time()) {
     // Only support inner joins and left joins where the time_ column comes from the left table.
     // We need a time_ value for every output row in the ordered case to preserve time ordering.
@@ -97,10 +97,19 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool infinite_stream() const { return pb_.streaming(); }
+  const std::string& cursor_name() const { return pb_.cursor_name(); }
+  // Whether the source only returns a sample of sample_rate() of its rows.
+  bool sampled() const { return pb_.sample_rate() > 0 && pb_.sample_rate() < 1; }
+  double sample_rate() const { return pb_.sample_rate(); }
+  bool sample_blocks() const { return pb_.sample_blocks(); }
+  const std::vector<std::shared_ptr<const ScalarExpression>>& predicates() const {
+    return predicates_;
+  }
 
  private:
   planpb::MemorySourceOperator pb_;
   std::vector<int64_t> column_idxs_;
+  std::vector<std::shared_ptr<const ScalarExpression>> predicates_;
 };
 
 class MapOperator : public Operator {
@@ -144,6 +153,15 @@ class AggregateOperator : public Operator {
   const std::vector<GroupInfo>& groups() const { return groups_; }
   const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
   bool windowed() const { return pb_.windowed(); }
+  // The number of input windows each result of a windowed aggregate covers.
+  int64_t window_panes() const { return pb_.window_panes(); }
+  // A partial aggregate outputs the serialized state of its UDAs instead of their results.
+  bool partial_agg() const { return pb_.partial_agg() && !pb_.finalize_results(); }
+  // A finalize aggregate merges the serialized UDA states output by partial aggregates.
+  bool finalize_agg() const { return pb_.finalize_results() && !pb_.partial_agg(); }
+  // Whether the input rows were sampled at sample_rate() by their memory source.
+  bool sampled() const { return pb_.sample_rate() > 0 && pb_.sample_rate() < 1; }
+  double sample_rate() const { return pb_.sample_rate(); }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -214,6 +232,7 @@ class GRPCSinkOperator : public Operator {
     return pb_.destination_case() == planpb::GRPCSinkOperator::kOutputTable;
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
+  bool arrow_row_batches() const { return pb_.arrow_row_batches(); }
 
  private:
   planpb::GRPCSinkOperator pb_;
@@ -262,6 +281,31 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class SortOperator : public Operator {
+ public:
+  explicit SortOperator(int64_t id) : Operator(id, planpb::SORT_OPERATOR) {}
+  ~SortOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::SortOperator& pb);
+  std::string DebugString() const override;
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+
+  // The input column indexes to sort by, most significant first.
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& descending() const { return descending_; }
+  // The number of rows to output, or 0 if unlimited.
+  int64_t limit() const { return pb_.limit(); }
+
+ private:
+  std::vector<int64_t> selected_cols_;
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> descending_;
+  planpb::SortOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
@@ -317,6 +361,12 @@ class JoinOperator : public Operator {
   bool order_by_time() const;
   planpb::JoinOperator::ParentColumn time_column() const;
 
+  // Whether the join is an interval join, which only joins rows whose times are close.
+  bool has_time_condition() const { return pb_.has_time_condition(); }
+  const planpb::JoinOperator::TimeCondition& time_condition() const {
+    return pb_.time_condition();
+  }
+
  private:
   std::vector<std::string> column_names_;
   std::vector<planpb::JoinOperator::EqualityCondition> equality_conditions_;
@@ -60,7 +60,8 @@ class Analyzer : public RuleExecutor<IR> {
   }
 
  private:
-  explicit Analyzer(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+  explicit Analyzer(CompilerState* compiler_state)
+      : RuleExecutor(compiler_state), compiler_state_(compiler_state) {}
 
   void CreateSourceAndMetadataResolutionBatch() {
     RuleBatch* source_and_metadata_resolution_batch =
@@ -85,7 +85,12 @@ StatusOr<std::shared_ptr<IR>> Compiler::QueryToIR(const std::string& query,
                                                   const ExecFuncs& exec_funcs) {
   Parser parser;
   PL_ASSIGN_OR_RETURN(pypa::AstModulePtr ast, parser.Parse(query));
+  return ASTToIR(ast, compiler_state, exec_funcs);
+}
 
+StatusOr<std::shared_ptr<IR>> Compiler::ASTToIR(const pypa::AstModulePtr& ast,
+                                                CompilerState* compiler_state,
+                                                const ExecFuncs& exec_funcs) {
   std::shared_ptr<IR> ir = std::make_shared<IR>();
   bool func_based_exec = exec_funcs.size() > 0;
   absl::flat_hash_set<std::string> reserved_names;
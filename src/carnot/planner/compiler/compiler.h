@@ -65,12 +65,16 @@ class Compiler {
                                                       CompilerState* compiler_state,
                                                       const ExecFuncs& exec_funcs);
 
+  // The phases CompileToIR runs after parsing the query, so that they can be timed on their own.
+  StatusOr<std::shared_ptr<IR>> ASTToIR(const pypa::AstModulePtr& ast,
+                                        CompilerState* compiler_state, const ExecFuncs& exec_funcs);
+  Status Analyze(IR* ir, CompilerState* compiler_state);
+  Status Optimize(IR* ir, CompilerState* compiler_state);
+
  private:
   StatusOr<std::shared_ptr<IR>> QueryToIR(const std::string& query, CompilerState* compiler_state,
                                           const ExecFuncs& exec_funcs);
 
-  Status Analyze(IR* ir, CompilerState* compiler_state);
-  Status Optimize(IR* ir, CompilerState* compiler_state);
   Status VerifyGraphHasResultSink(IR* ir);
 };
 
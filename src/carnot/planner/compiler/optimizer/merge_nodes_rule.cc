@@ -193,6 +193,15 @@ bool MergeNodesRule::CanMerge(OperatorIR* a, OperatorIR* b) {
     if (!EqualStringVector(join_a->suffix_strs(), join_b->suffix_strs())) {
       return false;
     }
+    if (join_a->has_time_condition() != join_b->has_time_condition()) {
+      return false;
+    }
+    if (join_a->has_time_condition() &&
+        (join_a->time_window_ns() != join_b->time_window_ns() ||
+         !CompareColumns({join_a->left_time_column()}, {join_b->left_time_column()}) ||
+         !CompareColumns({join_a->right_time_column()}, {join_b->right_time_column()}))) {
+      return false;
+    }
     return true;
   } else if (Match(a, Filter())) {
     auto filter_a = static_cast<FilterIR*>(a);
@@ -45,7 +45,8 @@ class Optimizer : public RuleExecutor<IR> {
   }
 
  private:
-  explicit Optimizer(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+  explicit Optimizer(CompilerState* compiler_state)
+      : RuleExecutor(compiler_state), compiler_state_(compiler_state) {}
 
   void CreatePruneUnconnectedOpsBatch() {
     RuleBatch* prune_ops_batch = CreateRuleBatch<FailOnMax>("PruneUnconnectedOps", 2);
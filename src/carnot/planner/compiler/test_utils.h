@@ -561,6 +561,12 @@ class OperatorTests : public ::testing::Test {
     return limit;
   }
 
+  SortIR* MakeSort(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+                   const std::vector<bool>& descending, int64_t limit) {
+    return graph->CreateNode<SortIR>(ast, parent, sort_cols, descending, limit)
+        .ConsumeValueOrDie();
+  }
+
   BlockingAggIR* MakeBlockingAgg(OperatorIR* parent, const std::vector<ColumnIR*>& columns,
                                  const ColExpressionVector& col_agg) {
     BlockingAggIR* agg =
@@ -1396,6 +1402,9 @@ void CompareCloneNode(MemorySourceIR* new_ir, MemorySourceIR* old_ir,
   EXPECT_EQ(new_ir->column_names(), old_ir->column_names()) << err_string;
   EXPECT_EQ(new_ir->column_index_map_set(), old_ir->column_index_map_set()) << err_string;
   EXPECT_EQ(new_ir->streaming(), old_ir->streaming()) << err_string;
+  EXPECT_EQ(new_ir->cursor_name(), old_ir->cursor_name()) << err_string;
+  EXPECT_EQ(new_ir->sample_rate(), old_ir->sample_rate()) << err_string;
+  EXPECT_EQ(new_ir->sample_blocks(), old_ir->sample_blocks()) << err_string;
 }
 
 template <>
@@ -1426,6 +1435,8 @@ void CompareCloneNode(GRPCSourceGroupIR* new_ir, GRPCSourceGroupIR* old_ir,
   EXPECT_EQ(new_ir->source_id(), old_ir->source_id()) << err_string;
   EXPECT_EQ(new_ir->grpc_address(), old_ir->grpc_address()) << err_string;
   EXPECT_EQ(new_ir->GRPCAddressSet(), old_ir->GRPCAddressSet()) << err_string;
+  EXPECT_EQ(new_ir->accepts_arrow_row_batches(), old_ir->accepts_arrow_row_batches())
+      << err_string;
 }
 
 template <>
@@ -1438,6 +1449,9 @@ void CompareCloneNode(GRPCSinkIR* new_ir, GRPCSinkIR* old_ir, const std::string&
   EXPECT_EQ(new_ir->destination_address(), old_ir->destination_address()) << err_string;
   EXPECT_EQ(new_ir->destination_ssl_targetname(), old_ir->destination_ssl_targetname())
       << err_string;
+  EXPECT_EQ(new_ir->destination_accepts_arrow_row_batches(),
+            old_ir->destination_accepts_arrow_row_batches())
+      << err_string;
   EXPECT_EQ(new_ir->destination_id(), old_ir->destination_id()) << err_string;
   EXPECT_EQ(new_ir->has_destination_id(), old_ir->has_destination_id()) << err_string;
   EXPECT_EQ(new_ir->has_output_table(), old_ir->has_output_table()) << err_string;
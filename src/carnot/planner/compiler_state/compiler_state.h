@@ -34,6 +34,16 @@ namespace px {
 namespace carnot {
 namespace planner {
 
+/**
+ * Counters for the executions of one rule, see CompilerState::rule_stats().
+ */
+struct RuleStats {
+  int64_t num_executions = 0;
+  // Executions that changed the graph.
+  int64_t num_changes = 0;
+  int64_t total_ns = 0;
+};
+
 /**
  * IDRegistryKey is the class used to uniquely refer to a UDF or UDA in the ID registry.
  * Distinct from the normal RegistryKey since that registry only cares about types, whereas the ID
@@ -139,7 +149,12 @@ class CompilerState : public NotCopyable {
     return &table_names_to_sensitive_columns_;
   }
   RegistryInfo* registry_info() const { return registry_info_; }
-  types::Time64NSValue time_now() const { return time_now_; }
+  types::Time64NSValue time_now() const {
+    time_now_read_ = true;
+    return time_now_;
+  }
+  // Whether the plan depends on the time it was compiled at, which keeps it from being cached.
+  bool time_now_read() const { return time_now_read_; }
   const std::string& result_address() const { return result_address_; }
   const std::string& result_ssl_targetname() const { return result_ssl_targetname_; }
 
@@ -176,11 +191,18 @@ class CompilerState : public NotCopyable {
   PluginConfig* plugin_config() { return plugin_config_.get(); }
   const DebugInfo& debug_info() { return debug_info_; }
 
+  /**
+   * The executions of each rule while compiling, keyed by "<rule batch>/<rule>", for diagnosing
+   * slow compiles.
+   */
+  std::map<std::string, RuleStats>* rule_stats() { return &rule_stats_; }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
   RegistryInfo* registry_info_;
   types::Time64NSValue time_now_;
+  mutable bool time_now_read_ = false;
   std::map<IDRegistryKey, int64_t> udf_to_id_map_;
   std::map<IDRegistryKey, int64_t> uda_to_id_map_;
 
@@ -191,6 +213,7 @@ class CompilerState : public NotCopyable {
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
   DebugInfo debug_info_;
+  std::map<std::string, RuleStats> rule_stats_;
 };
 
 }  // namespace planner
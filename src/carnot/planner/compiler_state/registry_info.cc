@@ -79,6 +79,7 @@ Status RegistryInfo::Init(const udfspb::UDFInfo& info) {
       DCHECK(UDFExecType::kUDA == type);
     }
     funcs_[uda.name()] = UDFExecType::kUDA;
+    func_names_.insert(uda.name());
   }
 
   for (const auto& udf : info.scalar_udfs()) {
@@ -103,6 +104,7 @@ Status RegistryInfo::Init(const udfspb::UDFInfo& info) {
       DCHECK(UDFExecType::kUDF == type);
     }
     funcs_[udf.name()] = UDFExecType::kUDF;
+    func_names_.insert(udf.name());
   }
 
   for (const auto& udtf : info.udtfs()) {
@@ -123,14 +125,6 @@ StatusOr<UDFExecType> RegistryInfo::GetUDFExecType(std::string_view name) {
   return funcs_[name];
 }
 
-absl::flat_hash_set<std::string> RegistryInfo::func_names() const {
-  absl::flat_hash_set<std::string> func_names;
-  for (const auto& pair : funcs_) {
-    func_names.insert(pair.first);
-  }
-  return func_names;
-}
-
 StatusOr<types::DataType> RegistryInfo::GetUDADataType(
     std::string name, std::vector<types::DataType> update_arg_types) {
   auto uda = uda_map_.find(RegistryKey(name, update_arg_types));
@@ -133,9 +133,10 @@ class RegistryInfo {
   StatusOr<bool> DoesUDASupportPartial(std::string name, std::vector<types::DataType> arg_types);
 
   StatusOr<UDFExecType> GetUDFExecType(std::string_view name);
-  absl::flat_hash_set<std::string> func_names() const;
+  // The names are kept alongside funcs_ so that every compile can share them without a copy.
+  const absl::flat_hash_set<std::string>& func_names() const { return func_names_; }
 
-  std::vector<udfspb::UDTFSourceSpec> udtfs() const { return udtfs_; }
+  const std::vector<udfspb::UDTFSourceSpec>& udtfs() const { return udtfs_; }
 
   // TODO(philkuz) move this function to protected when udtfs are finally supported.
   void AddUDTF(const udfspb::UDTFSourceSpec& source_spec) { udtfs_.push_back(source_spec); }
@@ -172,6 +173,7 @@ class RegistryInfo {
   std::map<RegistryKey, bool> uda_supports_partial_map_;
   // Union of udf and uda names.
   absl::flat_hash_map<std::string, UDFExecType> funcs_;
+  absl::flat_hash_set<std::string> func_names_;
   // The vector containing udtfs.
   std::vector<udfspb::UDTFSourceSpec> udtfs_;
 
@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <gflags/gflags.h>
+
 #include <algorithm>
 #include <memory>
 #include <queue>
@@ -34,6 +36,11 @@
 #include "src/common/uuid/uuid.h"
 #include "src/shared/upid/upid.h"
 
+DEFINE_bool(planner_cost_based_partial_agg,
+            gflags::BoolFromEnv("PL_PLANNER_COST_BASED_PARTIAL_AGG", true),
+            "Whether to split aggregates into partial aggregates on the PEMs where the agents' "
+            "table stats estimate that it sends less data to Kelvin.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -63,6 +70,7 @@ Status CoordinatorImpl::InitImpl(CompilerState* compiler_state,
                                  const distributedpb::DistributedState& distributed_state) {
   compiler_state_ = compiler_state;
   distributed_state_ = &distributed_state;
+  cost_model_ = std::make_unique<CostModel>(compiler_state->relation_map());
   for (int64_t i = 0; i < distributed_state.carnot_info_size(); ++i) {
     PL_RETURN_IF_ERROR(ProcessConfig(distributed_state.carnot_info()[i]));
   }
@@ -82,6 +90,7 @@ Status CoordinatorImpl::InitImpl(CompilerState* compiler_state,
 Status CoordinatorImpl::ProcessConfigImpl(const CarnotInfo& carnot_info) {
   if (carnot_info.has_data_store() && carnot_info.processes_data()) {
     data_store_nodes_.push_back(carnot_info);
+    cost_model_->AddCarnotInfo(carnot_info);
   }
   if (carnot_info.processes_data() && carnot_info.accepts_remote_sources()) {
     remote_processor_nodes_.push_back(carnot_info);
@@ -237,9 +246,12 @@ StatusOr<SchemaToAgentsMap> LoadSchemaMap(
 }
 
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
-  // TODO(zasgar) set support_partial_agg to true to enable partial aggs.
+  // Without table stats there's no way to tell whether a partial agg sends less data than the
+  // rows it aggregates, so aggregates then run whole on Kelvin.
+  const CostModel* cost_model = cost_model_->has_stats() ? cost_model_.get() : nullptr;
+  bool support_partial_agg = FLAGS_planner_cost_based_partial_agg && cost_model != nullptr;
   PL_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
-                      Splitter::Create(compiler_state_, /* support_partial_agg */ false));
+                      Splitter::Create(compiler_state_, support_partial_agg, cost_model));
   PL_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
   auto distributed_plan = std::make_unique<DistributedPlan>();
@@ -24,6 +24,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
+#include "src/carnot/planner/distributed/splitter/cost_model.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
@@ -129,6 +130,8 @@ class CoordinatorImpl : public Coordinator {
   const distributedpb::DistributedState* distributed_state_ = nullptr;
   // The compiler state.
   CompilerState* compiler_state_ = nullptr;
+  // Estimates data sizes from the table stats of the data store nodes.
+  std::unique_ptr<CostModel> cost_model_;
 };
 
 /**
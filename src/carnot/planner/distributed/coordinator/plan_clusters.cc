@@ -35,6 +35,31 @@ namespace carnot {
 namespace planner {
 namespace distributed {
 
+namespace {
+// Deletes the subtree rooted at op, then every ancestor that is left without children.
+Status DeleteSubtreeAndUnusedAncestors(IR* ir, OperatorIR* op) {
+  std::queue<OperatorIR*> ancestor_to_maybe_delete_q;
+  for (const auto& p : op->parents()) {
+    ancestor_to_maybe_delete_q.push(p);
+  }
+
+  PL_RETURN_IF_ERROR(ir->DeleteSubtree(op->id()));
+  while (!ancestor_to_maybe_delete_q.empty()) {
+    OperatorIR* ancestor = ancestor_to_maybe_delete_q.front();
+    ancestor_to_maybe_delete_q.pop();
+    // If all the children have been deleted, clean up the ancestor.
+    if (ancestor->Children().size() != 0) {
+      continue;
+    }
+    for (const auto& p : ancestor->parents()) {
+      ancestor_to_maybe_delete_q.push(p);
+    }
+    PL_RETURN_IF_ERROR(ir->DeleteSubtree(ancestor->id()));
+  }
+  return Status::OK();
+}
+}  // namespace
+
 StatusOr<std::unique_ptr<IR>> PlanCluster::CreatePlan(const IR* base_query) const {
   // TODO(philkuz) invert this so we don't clone everything.
   PL_ASSIGN_OR_RETURN(std::unique_ptr<IR> new_ir, base_query->Clone());
@@ -46,23 +71,23 @@ StatusOr<std::unique_ptr<IR>> PlanCluster::CreatePlan(const IR* base_query) cons
     auto cur_op = new_ir->Get(op->id());
     CHECK(cur_op != nullptr);
     CHECK(Match(cur_op, Operator()));
-    std::queue<OperatorIR*> ancestor_to_maybe_delete_q;
-    for (const auto& p : static_cast<OperatorIR*>(new_ir->Get(op->id()))->parents()) {
-      ancestor_to_maybe_delete_q.push(p);
-    }
+    PL_RETURN_IF_ERROR(
+        DeleteSubtreeAndUnusedAncestors(new_ir.get(), static_cast<OperatorIR*>(cur_op)));
+  }
 
-    PL_RETURN_IF_ERROR(new_ir->DeleteSubtree(op->id()));
-    while (!ancestor_to_maybe_delete_q.empty()) {
-      OperatorIR* ancestor = ancestor_to_maybe_delete_q.front();
-      ancestor_to_maybe_delete_q.pop();
-      // If all the children have been deleted, clean up the ancestor.
-      if (ancestor->Children().size() != 0) {
+  // The splitter only keeps inner joins of agent-local data on PEMs, so a join that lost one
+  // of its sides can't produce any rows on these agents.
+  bool deleted_join = true;
+  while (deleted_join) {
+    deleted_join = false;
+    for (IRNode* node : new_ir->FindNodesThatMatch(Join())) {
+      auto join = static_cast<JoinIR*>(node);
+      if (join->parents().size() == 2) {
         continue;
       }
-      for (const auto& p : ancestor->parents()) {
-        ancestor_to_maybe_delete_q.push(p);
-      }
-      PL_RETURN_IF_ERROR(new_ir->DeleteSubtree(ancestor->id()));
+      PL_RETURN_IF_ERROR(DeleteSubtreeAndUnusedAncestors(new_ir.get(), join));
+      deleted_join = true;
+      break;
     }
   }
   return new_ir;
@@ -64,6 +64,30 @@ TEST_F(PlanClustersTest, create_plan) {
             pem_plan->FindNodesThatMatch(Operator()).size());
 }
 
+constexpr char kColocatedJoinQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events')
+t2 = px.DataFrame(table='http_events')
+t2 = t2[t2.ctx['pod_id'] == 'agent1_pod']
+df = t1.merge(t2, how='inner', left_on=['upid'], right_on=['upid'], suffixes=['', '_x'])
+px.display(df, 'df')
+)pxl";
+
+TEST_F(PlanClustersTest, create_plan_removes_join_missing_a_side) {
+  auto logical_plan = CompileSingleNodePlan(kColocatedJoinQuery);
+  auto split_plan = SplitPlan(logical_plan.get());
+  auto pem_plan = split_plan->before_blocking.get();
+  ASSERT_EQ(pem_plan->FindNodesThatMatch(Join()).size(), 1);
+
+  auto filters = pem_plan->FindNodesThatMatch(Filter());
+  ASSERT_EQ(filters.size(), 1);
+
+  // Without the filtered side the join has no output, so the other side goes with it.
+  PlanCluster filter_cluster({1}, {static_cast<FilterIR*>(filters[0])});
+  ASSERT_OK_AND_ASSIGN(auto filter_plan, filter_cluster.CreatePlan(pem_plan));
+  EXPECT_TRUE(filter_plan->FindNodesThatMatch(Operator()).empty());
+}
+
 TEST_F(PlanClustersTest, cluster_operators) {
   auto mem_src = MakeMemSource();
   auto filter = MakeFilter(MakeMemSource(), MakeEqualsFunc(MakeColumn("cpu", 0), MakeInt(10)));
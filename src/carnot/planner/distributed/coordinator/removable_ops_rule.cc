@@ -109,7 +109,8 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
   static bool MatchExpr(ExpressionIR* expr) {
     auto string_equality = Match(expr, Equals(MetadataExpression(), String()));
     auto service_matcher = Match(expr, ServiceMatcher());
-    return string_equality || service_matcher;
+    auto has_value_matcher = Match(expr, MetadataHasValueMatcher());
+    return string_equality || service_matcher || has_value_matcher;
   }
 
   static std::unique_ptr<FilterExpressionMatcher> Create() {
@@ -128,6 +129,7 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
 
     // For cases like the following,
     // df.ctx['service'] == '["pl/svc1", "pl/svc2"]',
+    // px.has_value('["ns1", "ns2"]', df.ctx['namespace']),
     // We would still like the expression to work.
     // However, the metadata filters will only store individual services,
     // not the JSON array. As a result, in the planner we will check for the
@@ -168,6 +170,55 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
   MetadataType md_type_;
 };
 
+// Pod IPs have no ctx[] property, so they are matched through the UDFs that resolve them:
+// px.pod_name_to_pod_ip(df.ctx['pod']) == '10.0.0.1' and
+// px.ip_to_pod_id('10.0.0.1') == df.ctx['pod_id']. Either way only the agent hosting the pod
+// with that IP can produce data.
+class PodIPMatcher : public FilterExpressionMatcher {
+ public:
+  static bool MatchExpr(ExpressionIR* expr) {
+    auto ip_of_pod = Match(
+        expr, Equals(Func("pod_name_to_pod_ip", MetadataExpression(MetadataType::POD_NAME)),
+                     String()));
+    auto pod_of_ip = Match(
+        expr, Equals(Func("ip_to_pod_id", String()), MetadataExpression(MetadataType::POD_ID)));
+    return ip_of_pod || pod_of_ip;
+  }
+
+  static std::unique_ptr<FilterExpressionMatcher> Create() {
+    return std::make_unique<PodIPMatcher>();
+  }
+
+  bool CanAgentRun(CarnotInstance* carnot) const override {
+    auto* md_filter = carnot->metadata_filter();
+    if (md_filter == nullptr) {
+      return false;
+    }
+    // The filter is kept if the agent doesn't track pod IPs.
+    if (!md_filter->metadata_types().contains(MetadataType::POD_IP)) {
+      return true;
+    }
+    return md_filter->ContainsEntity(MetadataType::POD_IP, pod_ip_);
+  }
+
+  void ParseExpression(ExpressionIR* expr) override {
+    auto func = static_cast<FuncIR*>(expr);
+    for (ExpressionIR* arg : func->args()) {
+      if (Match(arg, String())) {
+        pod_ip_ = static_cast<StringIR*>(arg)->str();
+        return;
+      }
+      if (Match(arg, Func("ip_to_pod_id"))) {
+        pod_ip_ = static_cast<StringIR*>(static_cast<FuncIR*>(arg)->all_args()[0])->str();
+        return;
+      }
+    }
+  }
+
+ private:
+  std::string pod_ip_;
+};
+
 MapRemovableOperatorsRule::MapRemovableOperatorsRule(
     DistributedPlan* plan, const absl::flat_hash_set<int64_t>& pem_instances,
     const SchemaToAgentsMap& schema_map)
@@ -177,6 +228,7 @@ MapRemovableOperatorsRule::MapRemovableOperatorsRule(
       schema_map_(schema_map) {
   matchers_factory_.Add<ASIDMatcher>();
   matchers_factory_.Add<StringBloomFilterMatcher>();
+  matchers_factory_.Add<PodIPMatcher>();
 }
 
 StatusOr<AgentSet> MapRemovableOperatorsRule::FilterExpressionMayProduceData(ExpressionIR* expr) {
@@ -342,6 +342,87 @@ TEST_F(RemovableOpsRuleTest, asid_filter_does_not_work_on_column) {
   EXPECT_EQ(removable_ops_to_agents.size(), 0);
 }
 
+class PodPlacementPruningTest : public RemovableOpsRuleTest {
+ protected:
+  // Each PEM hosts one pod, on its own node, in namespace ns<i>. pem3 predates pod placement
+  // in the metadata filter and only tracks pod IDs.
+  distributedpb::DistributedState ThreeAgentsWithPodPlacement() {
+    auto ps = LoadDistributedStatePb(kThreePEMsOneKelvinDistributedState);
+    absl::flat_hash_map<std::string, distributedpb::MetadataInfo> mds;
+    for (int i = 1; i <= 2; ++i) {
+      auto filter = AgentMetadataFilter::Create(100, 0.01, md::kMetadataFilterEntities)
+                        .ConsumeValueOrDie();
+      PL_CHECK_OK(filter->InsertEntity(MetadataType::NAMESPACE, absl::StrCat("ns", i)));
+      PL_CHECK_OK(filter->InsertEntity(MetadataType::NODE_NAME, absl::StrCat("node", i)));
+      PL_CHECK_OK(filter->InsertEntity(MetadataType::POD_IP, absl::StrCat("10.0.0.", i)));
+      mds[absl::StrCat("pem", i)] = filter->ToProto();
+    }
+    mds["pem3"] = AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_ID})
+                      .ConsumeValueOrDie()
+                      ->ToProto();
+
+    for (auto i = 0; i < ps.carnot_info_size(); ++i) {
+      if (ps.carnot_info(i).query_broker_address() == "kelvin") {
+        continue;
+      }
+      *(ps.mutable_carnot_info(i)->mutable_metadata_info()) =
+          mds.at(ps.carnot_info(i).query_broker_address());
+    }
+    return ps;
+  }
+
+  // Returns the agents that drop the single filter in the query.
+  absl::flat_hash_set<int64_t> AgentsThatRemoveFilter(std::string_view filter_expr) {
+    auto distributed_state = ThreeAgentsWithPodPlacement();
+    auto logical_plan = CompileSingleNodePlan(absl::Substitute(kPodPlacementFilter, filter_expr));
+    auto distributed_plan = AssembleDistributedPlan(distributed_state);
+    auto split_plan = SplitPlan(logical_plan.get());
+    auto agent_schema_map =
+        LoadSchemaMap(distributed_state, distributed_plan->uuid_to_id_map()).ConsumeValueOrDie();
+    auto removable_ops_to_agents =
+        MapRemovableOperatorsRule::GetRemovableOperators(
+            distributed_plan.get(), agent_schema_map, SourceNodeIds(distributed_plan.get()),
+            split_plan->before_blocking.get())
+            .ConsumeValueOrDie();
+    for (const auto& [op, agents] : removable_ops_to_agents) {
+      if (Match(op, Filter())) {
+        return agents;
+      }
+    }
+    return {};
+  }
+
+  static constexpr char kPodPlacementFilter[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events')
+df = df[$0]
+px.display(df, 'df')
+)pxl";
+};
+
+TEST_F(PodPlacementPruningTest, namespace_filter) {
+  EXPECT_THAT(AgentsThatRemoveFilter("df.ctx['namespace'] == 'ns1'"), UnorderedElementsAre(1));
+}
+
+TEST_F(PodPlacementPruningTest, node_filter) {
+  EXPECT_THAT(AgentsThatRemoveFilter("df.ctx['node'] == 'node2'"), UnorderedElementsAre(0));
+  EXPECT_THAT(AgentsThatRemoveFilter("df.ctx['node'] == 'node3'"), UnorderedElementsAre(0, 1));
+}
+
+TEST_F(PodPlacementPruningTest, has_value_list) {
+  EXPECT_THAT(AgentsThatRemoveFilter("px.has_value('[\"ns2\", \"ns3\"]', df.ctx['namespace'])"),
+              UnorderedElementsAre(0));
+  EXPECT_THAT(AgentsThatRemoveFilter("px.has_value(df.ctx['namespace'], 'ns1')"),
+              UnorderedElementsAre(1));
+}
+
+TEST_F(PodPlacementPruningTest, pod_ip_filter) {
+  EXPECT_THAT(AgentsThatRemoveFilter("px.pod_name_to_pod_ip(df.ctx['pod']) == '10.0.0.2'"),
+              UnorderedElementsAre(0));
+  EXPECT_THAT(AgentsThatRemoveFilter("px.ip_to_pod_id('10.0.0.1') == df.ctx['pod_id']"),
+              UnorderedElementsAre(1));
+}
+
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
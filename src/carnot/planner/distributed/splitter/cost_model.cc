@@ -0,0 +1,195 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/splitter/cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "src/carnot/planner/ir/pattern_match.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+double ValueBytes(types::DataType data_type) {
+  switch (data_type) {
+    case types::DataType::BOOLEAN:
+      return 1;
+    case types::DataType::UINT128:
+      return 16;
+    case types::DataType::STRING:
+      return CostModel::kStringBytes;
+    default:
+      return 8;
+  }
+}
+
+}  // namespace
+
+void CostModel::AddCarnotInfo(const distributedpb::CarnotInfo& carnot_info) {
+  for (const auto& [table_name, stats] : carnot_info.table_stats()) {
+    TableTotals& totals = table_totals_[table_name];
+    totals.num_bytes += stats.num_bytes();
+    ++totals.num_agents;
+    // Empty tables report no time range.
+    if (stats.min_time() <= 0) {
+      continue;
+    }
+    if (totals.min_time <= 0 || stats.min_time() < totals.min_time) {
+      totals.min_time = stats.min_time();
+    }
+    totals.max_time = std::max(totals.max_time, stats.max_time());
+  }
+}
+
+double CostModel::RowBytes(const OperatorIR* op) {
+  if (!op->is_type_resolved()) {
+    return 0;
+  }
+  double row_bytes = 0;
+  for (const auto& [name, type] : *op->resolved_table_type()) {
+    if (type->IsValueType()) {
+      row_bytes += ValueBytes(std::static_pointer_cast<ValueType>(type)->data_type());
+    }
+  }
+  return row_bytes;
+}
+
+double CostModel::EstimateGroups(BlockingAggIR* agg, double input_rows) {
+  if (agg->group_by_all()) {
+    return std::min(input_rows, 1.0);
+  }
+  return std::min(input_rows,
+                  std::pow(kDistinctValuesPerGroup, static_cast<double>(agg->groups().size())));
+}
+
+std::optional<CardinalityEstimate> CostModel::EstimateMemorySource(MemorySourceIR* src) const {
+  auto totals_it = table_totals_.find(src->table_name());
+  if (totals_it == table_totals_.end()) {
+    return std::nullopt;
+  }
+  const TableTotals& totals = totals_it->second;
+
+  // The stats measure every column of the table, not just the ones the source selects.
+  double stored_row_bytes = RowBytes(src);
+  if (relation_map_ != nullptr) {
+    auto relation_it = relation_map_->find(src->table_name());
+    if (relation_it != relation_map_->end()) {
+      stored_row_bytes = 0;
+      for (types::DataType data_type : relation_it->second.col_types()) {
+        stored_row_bytes += ValueBytes(data_type);
+      }
+    }
+  }
+
+  CardinalityEstimate estimate;
+  estimate.rows = totals.num_bytes / std::max(stored_row_bytes, 1.0);
+  estimate.row_bytes = RowBytes(src);
+  estimate.num_agents = std::max<int64_t>(totals.num_agents, 1);
+  // Scale by the part of the table's time range that the source reads.
+  if (src->IsTimeSet() && totals.min_time > 0 && totals.max_time > totals.min_time) {
+    double start = std::max(src->time_start_ns(), totals.min_time);
+    double stop = std::min(src->time_stop_ns(), totals.max_time);
+    double fraction = (stop - start) / (totals.max_time - totals.min_time);
+    estimate.rows *= std::clamp(fraction, 0.0, 1.0);
+  }
+  return estimate;
+}
+
+std::optional<CardinalityEstimate> CostModel::Estimate(OperatorIR* op) const {
+  if (Match(op, MemorySource())) {
+    return EstimateMemorySource(static_cast<MemorySourceIR*>(op));
+  }
+  // Other sources, such as UDTFs and GRPCSourceGroups, have nothing to estimate from.
+  if (op->parents().empty()) {
+    return std::nullopt;
+  }
+
+  CardinalityEstimate estimate;
+  estimate.row_bytes = RowBytes(op);
+  double max_parent_rows = 0;
+  for (OperatorIR* parent : op->parents()) {
+    auto parent_estimate = Estimate(parent);
+    if (!parent_estimate.has_value()) {
+      return std::nullopt;
+    }
+    estimate.rows += parent_estimate->rows;
+    estimate.num_agents = std::max(estimate.num_agents, parent_estimate->num_agents);
+    max_parent_rows = std::max(max_parent_rows, parent_estimate->rows);
+  }
+
+  if (Match(op, Filter())) {
+    estimate.rows *= kFilterSelectivity;
+  } else if (Match(op, Limit())) {
+    auto limit = static_cast<LimitIR*>(op);
+    if (limit->limit_value_set()) {
+      estimate.rows = std::min(estimate.rows, static_cast<double>(limit->limit_value()));
+    }
+  } else if (Match(op, BlockingAgg())) {
+    estimate.rows = EstimateGroups(static_cast<BlockingAggIR*>(op), estimate.rows);
+  } else if (Match(op, Join())) {
+    // Assume the joins are on keys, so each row of the larger side matches at most once.
+    estimate.rows = max_parent_rows;
+  }
+  return estimate;
+}
+
+std::optional<CardinalityEstimate> CostModel::EstimatePartial(OperatorIR* op) const {
+  if (op->parents().size() != 1) {
+    return std::nullopt;
+  }
+  auto input = Estimate(op->parents()[0]);
+  if (!input.has_value()) {
+    return std::nullopt;
+  }
+
+  CardinalityEstimate estimate = input.value();
+  estimate.row_bytes = RowBytes(op);
+  // Each agent computes the operator over only its own rows.
+  double rows_per_agent = input->rows / input->num_agents;
+  if (Match(op, BlockingAgg())) {
+    auto agg = static_cast<BlockingAggIR*>(op);
+    double groups = EstimateGroups(agg, input->rows);
+    estimate.rows = input->num_agents * std::min(rows_per_agent, groups);
+    // Partial aggregates send the groups and the serialized state of the aggregate expressions.
+    estimate.row_bytes = kStringBytes;
+    for (ColumnIR* group : agg->groups()) {
+      if (group->is_type_resolved() && group->resolved_type()->IsValueType()) {
+        estimate.row_bytes +=
+            ValueBytes(std::static_pointer_cast<ValueType>(group->resolved_type())->data_type());
+      }
+    }
+  } else if (Match(op, Limit())) {
+    auto limit = static_cast<LimitIR*>(op);
+    if (limit->limit_value_set()) {
+      estimate.rows = input->num_agents *
+                      std::min(rows_per_agent, static_cast<double>(limit->limit_value()));
+    }
+  }
+  return estimate;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
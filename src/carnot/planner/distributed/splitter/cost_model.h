@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/ir/ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief The estimated size of an operator's output, summed over every agent that runs it.
+ */
+struct CardinalityEstimate {
+  double rows = 0;
+  double row_bytes = 0;
+  // The number of agents the rows are spread over.
+  int64_t num_agents = 1;
+
+  double bytes() const { return rows * row_bytes; }
+};
+
+/**
+ * @brief CostModel estimates how much data operators produce, from the table sizes that the agents
+ * report in their heartbeats. The Splitter uses it to decide where to put the GRPCBridges, so
+ * that plans send as few bytes from PEMs to Kelvin as it can.
+ *
+ * The estimates are rough: agents report table bytes, so rows are derived from the width of the
+ * table's relation, and filters and aggregates use fixed reduction factors. They are only used
+ * to compare placements of the same plan against each other.
+ */
+class CostModel : public NotCopyable {
+ public:
+  explicit CostModel(const RelationMap* relation_map) : relation_map_(relation_map) {}
+
+  /**
+   * @brief Adds the table stats of a Carnot instance that holds data.
+   */
+  void AddCarnotInfo(const distributedpb::CarnotInfo& carnot_info);
+
+  /**
+   * @brief Whether any agent has reported table stats. Without them, nothing can be estimated.
+   */
+  bool has_stats() const { return !table_totals_.empty(); }
+
+  /**
+   * @brief Estimates the output of the operator across all agents, or nullopt if it reads from
+   * tables without stats or from sources that the model doesn't know about.
+   */
+  std::optional<CardinalityEstimate> Estimate(OperatorIR* op) const;
+
+  /**
+   * @brief Estimates the output of the partial, per agent half of a blocking operator, which is
+   * what gets sent to Kelvin when the operator is split. Returns nullopt if the operator can't be
+   * estimated.
+   */
+  std::optional<CardinalityEstimate> EstimatePartial(OperatorIR* op) const;
+
+  // Fraction of rows that a filter keeps.
+  static constexpr double kFilterSelectivity = 0.25;
+  // Distinct values assumed for each group by column.
+  static constexpr double kDistinctValuesPerGroup = 1000;
+  // Width assumed for string values, which the stats don't break down by column.
+  static constexpr double kStringBytes = 32;
+
+ private:
+  struct TableTotals {
+    int64_t num_bytes = 0;
+    int64_t min_time = 0;
+    int64_t max_time = 0;
+    int64_t num_agents = 0;
+  };
+
+  std::optional<CardinalityEstimate> EstimateMemorySource(MemorySourceIR* src) const;
+  // The number of groups that an aggregate over `input` produces in total.
+  static double EstimateGroups(BlockingAggIR* agg, double input_rows);
+  static double RowBytes(const OperatorIR* op);
+
+  const RelationMap* relation_map_;
+  absl::flat_hash_map<std::string, TableTotals> table_totals_;
+};
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/distributed/splitter/cost_model.h"
+#include "src/carnot/planner/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+using compiler::ResolveTypesRule;
+
+class CostModelTest : public ASTVisitorTest {
+ protected:
+  void SetUp() override {
+    ASTVisitorTest::SetUp();
+    // 32 bytes per row.
+    cpu_relation = table_store::schema::Relation(
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::FLOAT64,
+                                      types::DataType::FLOAT64, types::DataType::FLOAT64}),
+        std::vector<std::string>({"count", "cpu0", "cpu1", "cpu2"}));
+    compiler_state_->relation_map()->erase("cpu");
+    compiler_state_->relation_map()->emplace("cpu", cpu_relation);
+
+    PL_CHECK_OK(compiler_state_->registry_info()->Init(testutils::UDFInfoWithTestUDTF()));
+    cost_model_ = std::make_unique<CostModel>(compiler_state_->relation_map());
+  }
+
+  void AddAgent(int64_t num_bytes, int64_t min_time = 0, int64_t max_time = 0) {
+    distributedpb::CarnotInfo carnot_info;
+    auto& stats = (*carnot_info.mutable_table_stats())["cpu"];
+    stats.set_num_bytes(num_bytes);
+    stats.set_min_time(min_time);
+    stats.set_max_time(max_time);
+    cost_model_->AddCarnotInfo(carnot_info);
+  }
+
+  void ResolveTypes() {
+    ResolveTypesRule type_rule(compiler_state_.get());
+    ASSERT_OK(type_rule.Execute(graph.get()));
+  }
+
+  table_store::schema::Relation cpu_relation;
+  std::unique_ptr<CostModel> cost_model_;
+};
+
+TEST_F(CostModelTest, no_stats) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  MakeMemSink(mem_src, "out");
+  ResolveTypes();
+
+  EXPECT_FALSE(cost_model_->has_stats());
+  EXPECT_FALSE(cost_model_->Estimate(mem_src).has_value());
+}
+
+TEST_F(CostModelTest, rows_from_table_bytes) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation, {"count"});
+  auto count_col = MakeColumn("count", 0, types::DataType::INT64);
+  auto filter = MakeFilter(mem_src, MakeEqualsFunc(count_col, MakeInt(10)));
+  auto limit = MakeLimit(filter, 100);
+  MakeMemSink(limit, "out");
+  ResolveTypes();
+
+  AddAgent(32 * 1000);
+  AddAgent(32 * 1000);
+  ASSERT_TRUE(cost_model_->has_stats());
+
+  // Rows are counted with the whole relation, but only the selected column is output.
+  auto src_estimate = cost_model_->Estimate(mem_src);
+  ASSERT_TRUE(src_estimate.has_value());
+  EXPECT_DOUBLE_EQ(2000, src_estimate->rows);
+  EXPECT_DOUBLE_EQ(8, src_estimate->row_bytes);
+  EXPECT_EQ(2, src_estimate->num_agents);
+
+  auto filter_estimate = cost_model_->Estimate(filter);
+  ASSERT_TRUE(filter_estimate.has_value());
+  EXPECT_DOUBLE_EQ(2000 * CostModel::kFilterSelectivity, filter_estimate->rows);
+
+  auto limit_estimate = cost_model_->Estimate(limit);
+  ASSERT_TRUE(limit_estimate.has_value());
+  EXPECT_DOUBLE_EQ(100, limit_estimate->rows);
+  // Each agent sends up to the limit.
+  auto partial_limit = cost_model_->EstimatePartial(limit);
+  ASSERT_TRUE(partial_limit.has_value());
+  EXPECT_DOUBLE_EQ(200, partial_limit->rows);
+}
+
+TEST_F(CostModelTest, time_range_scales_rows) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  mem_src->SetTimeValuesNS(1500, 3000);
+  MakeMemSink(mem_src, "out");
+  ResolveTypes();
+
+  AddAgent(32 * 1000, /* min_time */ 1000, /* max_time */ 2000);
+
+  auto estimate = cost_model_->Estimate(mem_src);
+  ASSERT_TRUE(estimate.has_value());
+  EXPECT_DOUBLE_EQ(500, estimate->rows);
+}
+
+TEST_F(CostModelTest, partial_agg) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto count_col = MakeColumn("count", 0, types::DataType::INT64);
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("cpu0", 0, types::DataType::FLOAT64));
+  auto agg = MakeBlockingAgg(mem_src, {count_col}, {{"mean", mean_func}});
+  MakeMemSink(agg, "out");
+  ResolveTypes();
+
+  AddAgent(32 * 1000 * 1000);
+  AddAgent(32 * 1000 * 1000);
+
+  auto estimate = cost_model_->Estimate(agg);
+  ASSERT_TRUE(estimate.has_value());
+  EXPECT_DOUBLE_EQ(CostModel::kDistinctValuesPerGroup, estimate->rows);
+
+  // Each agent sends every group it has, along with the serialized aggregate state.
+  auto partial = cost_model_->EstimatePartial(agg);
+  ASSERT_TRUE(partial.has_value());
+  EXPECT_DOUBLE_EQ(2 * CostModel::kDistinctValuesPerGroup, partial->rows);
+  EXPECT_DOUBLE_EQ(8 + CostModel::kStringBytes, partial->row_bytes);
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -68,6 +68,39 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, sort_test) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto sort = MakeSort(mem_src, {"count"}, {true}, 10);
+  MakeMemSink(sort, "out");
+
+  SortOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(sort));
+  auto prepare_sort_or_s = mgr.CreatePrepareOperator(graph.get(), sort);
+  ASSERT_OK(prepare_sort_or_s);
+  OperatorIR* prepare_sort_uncasted = prepare_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_sort_uncasted, Sort());
+  SortIR* prepare_sort = static_cast<SortIR*>(prepare_sort_uncasted);
+  EXPECT_EQ(prepare_sort->limit(), sort->limit());
+  EXPECT_EQ(prepare_sort->sort_cols(), sort->sort_cols());
+  EXPECT_EQ(prepare_sort->descending(), sort->descending());
+  EXPECT_EQ(prepare_sort->parents(), sort->parents());
+  EXPECT_NE(prepare_sort, sort);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_sort_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, sort);
+  ASSERT_OK(merge_sort_or_s);
+  OperatorIR* merge_sort_uncasted = merge_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_sort_uncasted, Sort());
+  SortIR* merge_sort = static_cast<SortIR*>(merge_sort_uncasted);
+  EXPECT_EQ(merge_sort->limit(), sort->limit());
+  EXPECT_EQ(merge_sort->parents()[0], mem_src2);
+  EXPECT_NE(merge_sort, sort);
+
+  // Without a limit, the whole sort runs after the boundary.
+  auto full_sort = MakeSort(mem_src, {"count"}, {false}, 0);
+  EXPECT_FALSE(mgr.Matches(full_sort));
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
@@ -45,7 +45,8 @@ class PreSplitAnalyzer : public RuleExecutor<IR> {
   }
 
  private:
-  explicit PreSplitAnalyzer(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+  explicit PreSplitAnalyzer(CompilerState* compiler_state)
+      : RuleExecutor(compiler_state), compiler_state_(compiler_state) {}
 
   void CreateSplitPEMOnlyUDFsBatch() {
     RuleBatch* split_pem_and_kelvin_udfs = CreateRuleBatch<TryUntilMax>("SplitPEMOnlyUDFs", 1);
@@ -44,7 +44,8 @@ class PreSplitOptimizer : public RuleExecutor<IR> {
   }
 
  private:
-  explicit PreSplitOptimizer(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+  explicit PreSplitOptimizer(CompilerState* compiler_state)
+      : RuleExecutor(compiler_state), compiler_state_(compiler_state) {}
 
   void CreateLimitPushdownBatch() {
     // We only run limit pushdown once as it should find all limits that need to be pushed down in a single pass.
@@ -33,12 +33,76 @@ namespace carnot {
 namespace planner {
 namespace distributed {
 
+// Returns true if col_name in the output of op is the upid column of a memory source, passed
+// through unchanged. Each PEM only stores the processes that run on it, so rows with the same
+// upid in two of its tables are always on the same PEM.
+StatusOr<bool> IsSourceUPIDColumn(OperatorIR* op, const std::string& col_name) {
+  if (Match(op, MemorySource())) {
+    auto table_type = op->resolved_table_type();
+    if (!table_type->HasColumn(col_name)) {
+      return false;
+    }
+    PL_ASSIGN_OR_RETURN(auto col_type, table_type->GetColumnType(col_name));
+    return std::static_pointer_cast<ValueType>(col_type)->semantic_type() == types::ST_UPID;
+  }
+  if (Match(op, Filter())) {
+    return IsSourceUPIDColumn(op->parents()[0], col_name);
+  }
+  if (Match(op, Map())) {
+    for (const auto& col_expr : static_cast<MapIR*>(op)->col_exprs()) {
+      if (col_expr.name != col_name) {
+        continue;
+      }
+      if (!Match(col_expr.node, ColumnNode())) {
+        return false;
+      }
+      auto input_col = static_cast<ColumnIR*>(col_expr.node);
+      return IsSourceUPIDColumn(op->parents()[0], input_col->col_name());
+    }
+  }
+  return false;
+}
+
+// An inner join on the upids of two memory sources only matches rows that are on the same PEM,
+// so it can run on every PEM before the data is sent to Kelvin. Outer joins can't, because a
+// PEM can't tell whether another PEM has a match for a row.
+StatusOr<bool> IsColocatedJoin(OperatorIR* op) {
+  if (!Match(op, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(op);
+  if (join->join_type() != JoinIR::JoinType::kInner || join->parents().size() != 2) {
+    return false;
+  }
+  for (const auto& [i, left_col] : Enumerate(join->left_on_columns())) {
+    ColumnIR* right_col = join->right_on_columns()[i];
+    PL_ASSIGN_OR_RETURN(OperatorIR * left_parent, left_col->ReferencedOperator());
+    PL_ASSIGN_OR_RETURN(OperatorIR * right_parent, right_col->ReferencedOperator());
+    PL_ASSIGN_OR_RETURN(bool left_upid, IsSourceUPIDColumn(left_parent, left_col->col_name()));
+    PL_ASSIGN_OR_RETURN(bool right_upid, IsSourceUPIDColumn(right_parent, right_col->col_name()));
+    if (left_upid && right_upid) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether op is blocking and so needs all of its input on one node.
+StatusOr<bool> OperatorNeedsAllAgents(OperatorIR* op) {
+  if (!op->IsBlocking()) {
+    return false;
+  }
+  PL_ASSIGN_OR_RETURN(bool colocated_join, IsColocatedJoin(op));
+  return !colocated_join;
+}
+
 StatusOr<bool> OperatorMustRunOnKelvin(CompilerState* compiler_state, OperatorIR* op) {
   // If the operator can't run on a PEM, or is a blocking operator, we should
   // schedule this node to run on a Kelvin.
   PL_ASSIGN_OR_RETURN(bool runs_on_pem,
                       ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return !runs_on_pem || op->IsBlocking();
+  PL_ASSIGN_OR_RETURN(bool needs_all_agents, OperatorNeedsAllAgents(op));
+  return !runs_on_pem || needs_all_agents;
 }
 
 StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op) {
@@ -46,7 +110,8 @@ StatusOr<bool> OperatorCanRunOnPEM(CompilerState* compiler_state, OperatorIR* op
   // schedule this node to run on a PEM.
   PL_ASSIGN_OR_RETURN(bool runs_on_pem,
                       ScalarUDFsRunOnPEMRule::OperatorUDFsRunOnPEM(compiler_state, op));
-  return runs_on_pem && !op->IsBlocking();
+  PL_ASSIGN_OR_RETURN(bool needs_all_agents, OperatorNeedsAllAgents(op));
+  return runs_on_pem && !needs_all_agents;
 }
 
 BlockingSplitNodeIDGroups Splitter::GetSplitGroups(
@@ -296,6 +361,7 @@ Status Splitter::ExtractBridgesFromGRPCBridgeTree(
     // We insert the bridge before the first blocking node or branching of the source
     // subgraph.
     auto op = bridge_node.starting_op;
+    std::vector<OperatorIR*> chain{op};
 
     while (op->Children().size() == 1) {
       PL_ASSIGN_OR_RETURN(bool on_pem, OperatorCanRunOnPEM(compiler_state_, op->Children()[0]));
@@ -303,8 +369,10 @@ Status Splitter::ExtractBridgesFromGRPCBridgeTree(
         break;
       }
       op = op->Children()[0];
+      chain.push_back(op);
     }
 
+    PL_ASSIGN_OR_RETURN(op, CheapestBridgePoint(chain));
     (*new_grpc_bridges)[op] = op->Children();
     return Status::OK();
   }
@@ -322,6 +390,40 @@ Status Splitter::ExtractBridgesFromGRPCBridgeTree(
   return Status::OK();
 }
 
+StatusOr<OperatorIR*> Splitter::CheapestBridgePoint(const std::vector<OperatorIR*>& chain) const {
+  DCHECK(!chain.empty());
+  OperatorIR* cheapest = chain.back();
+  if (cost_model_ == nullptr) {
+    return cheapest;
+  }
+  auto cheapest_estimate = cost_model_->Estimate(cheapest);
+  if (!cheapest_estimate.has_value()) {
+    return cheapest;
+  }
+  double cheapest_bytes = cheapest_estimate->bytes();
+  // Moving the bridge up over an operator means that operator runs on Kelvin instead.
+  for (int64_t i = static_cast<int64_t>(chain.size()) - 2; i >= 0; --i) {
+    OperatorIR* moved = chain[i + 1];
+    PL_ASSIGN_OR_RETURN(bool on_kelvin,
+                        ScalarUDFsRunOnKelvinRule::OperatorUDFsRunOnKelvin(compiler_state_, moved));
+    bool pem_only_limit = Match(moved, Limit()) && static_cast<LimitIR*>(moved)->pem_only();
+    // A join on the PEMs is fed by two chains, so moving the bridge above it on one of them
+    // would leave it with one parent on each side of the bridge.
+    if (!on_kelvin || MustBeOnPem(moved) || pem_only_limit || Match(moved, Join())) {
+      break;
+    }
+    auto estimate = cost_model_->Estimate(chain[i]);
+    if (!estimate.has_value()) {
+      break;
+    }
+    if (estimate->bytes() < cheapest_bytes) {
+      cheapest = chain[i];
+      cheapest_bytes = estimate->bytes();
+    }
+  }
+  return cheapest;
+}
+
 StatusOr<absl::flat_hash_map<OperatorIR*, std::vector<OperatorIR*>>> Splitter::ConsolidateEdges(
     const IR* logical_plan,
     const absl::flat_hash_map<OperatorIR*, std::vector<OperatorIR*>>& grpc_bridges) {
@@ -390,6 +492,26 @@ PartialOperatorMgr* Splitter::GetPartialOperatorMgr(OperatorIR* op) const {
   return nullptr;
 }
 
+bool Splitter::PartialBridgesAreCheaper(OperatorIR* parent,
+                                        const std::vector<OperatorIR*>& blocking_children) const {
+  if (cost_model_ == nullptr) {
+    return true;
+  }
+  auto parent_estimate = cost_model_->Estimate(parent);
+  if (!parent_estimate.has_value()) {
+    return true;
+  }
+  double partial_bytes = 0;
+  for (OperatorIR* child : blocking_children) {
+    auto child_estimate = cost_model_->EstimatePartial(child);
+    if (!child_estimate.has_value()) {
+      return true;
+    }
+    partial_bytes += child_estimate->bytes();
+  }
+  return partial_bytes <= parent_estimate->bytes();
+}
+
 bool Splitter::AllHavePartialMgr(std::vector<OperatorIR*> children) const {
   for (OperatorIR* c : children) {
     PartialOperatorMgr* mgr = GetPartialOperatorMgr(c);
@@ -407,13 +529,14 @@ Status Splitter::InsertGRPCBridge(IR* plan, OperatorIR* parent,
   // 1. Some of the blocking_children do not have a partial implementation and we output 1 bridge.
   // 2. All of the blocking_children have partial implementations and we output one bridge per.
   // 3. All of the blocking nodes have partial implementations but the sum cost of GRPC Bridge per
-  // operator is greater than outputting a single Bridge for the parent as in case #1 (NOTE: not
-  // implemented yet).
-
-  // Handle case where some of the blocking_children dont have partial implementations. This
-  // assumes that network costs are greater than processing costs, so we just minimize network
-  // costs here.
-  if (!AllHavePartialMgr(blocking_children)) {
+  // operator is greater than outputting a single Bridge for the parent as in case #1. This is
+  // only known when there's a cost model.
+
+  // Handle case where some of the blocking_children dont have partial implementations, or where
+  // their partial results are estimated to be larger than the parent's output. This assumes that
+  // network costs are greater than processing costs, so we just minimize network costs here.
+  if (!AllHavePartialMgr(blocking_children) ||
+      !PartialBridgesAreCheaper(parent, blocking_children)) {
     PL_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink, CreateGRPCSink(parent, grpc_id_counter_));
     PL_ASSIGN_OR_RETURN(GRPCSourceGroupIR * grpc_source_group,
                         CreateGRPCSourceGroup(parent, grpc_id_counter_));
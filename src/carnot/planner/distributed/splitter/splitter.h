@@ -27,6 +27,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
+#include "src/carnot/planner/distributed/splitter/cost_model.h"
 #include "src/carnot/planner/distributed/splitter/partial_op_mgr/partial_op_mgr.h"
 #include "src/carnot/planner/ir/grpc_sink_ir.h"
 #include "src/carnot/planner/ir/grpc_source_group_ir.h"
@@ -110,20 +111,32 @@ class Splitter : public NotCopyable {
    */
   StatusOr<std::unique_ptr<BlockingSplitPlan>> SplitKelvinAndAgents(const IR* logical_plan);
 
+  /**
+   * @brief Creates a Splitter.
+   *
+   * @param support_partial_agg: whether aggregates may be split into partial aggregates on the
+   * PEMs and a merge on Kelvin.
+   * @param cost_model: if set, the estimated bytes sent to Kelvin decide where bridges go and
+   * whether blocking operators are split. Must outlive the Splitter.
+   */
   static StatusOr<std::unique_ptr<Splitter>> Create(CompilerState* compiler_state,
-                                                    bool support_partial_agg) {
-    std::unique_ptr<Splitter> splitter = std::unique_ptr<Splitter>(new Splitter(compiler_state));
+                                                    bool support_partial_agg,
+                                                    const CostModel* cost_model = nullptr) {
+    std::unique_ptr<Splitter> splitter =
+        std::unique_ptr<Splitter>(new Splitter(compiler_state, cost_model));
     PL_RETURN_IF_ERROR(splitter->Init(support_partial_agg));
     return splitter;
   }
 
  private:
-  explicit Splitter(CompilerState* compiler_state) : compiler_state_(compiler_state) {}
+  Splitter(CompilerState* compiler_state, const CostModel* cost_model)
+      : compiler_state_(compiler_state), cost_model_(cost_model) {}
   Status Init(bool support_partial_agg) {
     if (support_partial_agg) {
       partial_operator_mgrs_.push_back(std::make_unique<AggOperatorMgr>());
     }
     partial_operator_mgrs_.push_back(std::make_unique<LimitOperatorMgr>());
+    partial_operator_mgrs_.push_back(std::make_unique<SortOperatorMgr>());
     return Status::OK();
   }
   /**
@@ -153,6 +166,18 @@ class Splitter : public NotCopyable {
   StatusOr<GRPCSourceGroupIR*> CreateGRPCSourceGroup(OperatorIR* parent_op, int64_t grpc_id);
   Status InsertGRPCBridge(IR* plan, OperatorIR* parent, const std::vector<OperatorIR*>& parents);
   PartialOperatorMgr* GetPartialOperatorMgr(OperatorIR* op) const;
+  /**
+   * @brief Returns whether sending the partial results of each of the blocking children is
+   * estimated to cost no more than sending the parent's output once. True if there's no estimate.
+   */
+  bool PartialBridgesAreCheaper(OperatorIR* parent,
+                                const std::vector<OperatorIR*>& blocking_children) const;
+  /**
+   * @brief Picks the operator to put a bridge after, from a chain of operators that each can run
+   * on PEM. The last one is picked unless the cost model estimates that an earlier one sends fewer
+   * bytes and the operators after it can run on Kelvin.
+   */
+  StatusOr<OperatorIR*> CheapestBridgePoint(const std::vector<OperatorIR*>& chain) const;
   StatusOr<absl::flat_hash_map<OperatorIR*, std::vector<OperatorIR*>>> ConsolidateEdges(
       const IR* logical_plan,
       const absl::flat_hash_map<OperatorIR*, std::vector<OperatorIR*>>& edges);
@@ -313,6 +338,7 @@ class Splitter : public NotCopyable {
   int64_t grpc_id_counter_ = 0;
   std::vector<std::unique_ptr<PartialOperatorMgr>> partial_operator_mgrs_;
   CompilerState* compiler_state_ = nullptr;
+  const CostModel* cost_model_ = nullptr;
 };
 
 }  // namespace distributed
@@ -85,6 +85,15 @@ class SplitterTest : public ASTVisitorTest {
     return static_cast<TIR*>(new_node);
   }
 
+  // A cost model where one agent has num_bytes of the cpu table.
+  std::unique_ptr<CostModel> MakeCostModel(int64_t num_bytes) {
+    auto cost_model = std::make_unique<CostModel>(compiler_state_->relation_map());
+    distributedpb::CarnotInfo carnot_info;
+    (*carnot_info.mutable_table_stats())["cpu"].set_num_bytes(num_bytes);
+    cost_model->AddCarnotInfo(carnot_info);
+    return cost_model;
+  }
+
   int64_t time_now = 1552607213931245000;
   table_store::schema::Relation cpu_relation;
 };
@@ -195,6 +204,72 @@ TEST_F(SplitterTest, partial_agg_test) {
   }
 }
 
+TEST_F(SplitterTest, cost_model_decides_partial_agg) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto count_col = MakeColumn("count", 0, types::DataType::INT64);
+  EXPECT_OK(count_col->SetResolvedType(ValueType::Create(types::INT64, types::ST_NONE)));
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
+  ASSERT_OK(AddUDAToRegistry("mean", types::FLOAT64, {types::INT64}, /*supports_partial*/ true));
+  auto agg = MakeBlockingAgg(mem_src, {count_col}, {{"mean", mean_func}});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  // With a million rows, sending a thousand partial aggregates is cheaper.
+  auto large_cost_model = MakeCostModel(32 * 1000 * 1000);
+  auto splitter = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ true,
+                                   large_cost_model.get())
+                      .ConsumeValueOrDie();
+  auto split_plan = splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  auto new_mem_src = GetEquivalentInNewPlan(split_plan->before_blocking.get(), mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL);
+  EXPECT_MATCH(new_mem_src->Children()[0], PartialAgg());
+
+  // With ten rows, the partial aggregates would be larger than the rows themselves.
+  auto small_cost_model = MakeCostModel(32 * 10);
+  splitter = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ true,
+                              small_cost_model.get())
+                 .ConsumeValueOrDie();
+  split_plan = splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  new_mem_src = GetEquivalentInNewPlan(split_plan->before_blocking.get(), mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL);
+  EXPECT_MATCH(new_mem_src->Children()[0], GRPCSink());
+  auto new_agg = GetEquivalentInNewPlan(split_plan->after_blocking.get(), agg);
+  EXPECT_FALSE(new_agg->partial_agg());
+  EXPECT_MATCH(new_agg->parents()[0], GRPCSourceGroup());
+}
+
+TEST_F(SplitterTest, cost_model_bridges_before_growing_map) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto map = MakeMap(mem_src,
+                     {{"count", MakeColumn("count", 0)},
+                      {"label1", MakeString("a")},
+                      {"label2", MakeString("b")}});
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
+  auto label_col = MakeColumn("label1", 0, types::DataType::STRING);
+  auto agg = MakeBlockingAgg(map, {label_col}, {{"mean", mean_func}});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  // Without a cost model, everything that can run on PEM does.
+  auto splitter =
+      Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false).ConsumeValueOrDie();
+  auto split_plan = splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  HasGRPCSinkChild(map->id(), split_plan->before_blocking.get(), "map");
+
+  // The map outputs wider rows than it reads, so it's cheaper to send its input.
+  auto cost_model = MakeCostModel(32 * 1000);
+  splitter =
+      Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false, cost_model.get())
+          .ConsumeValueOrDie();
+  split_plan = splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  HasGRPCSinkChild(mem_src->id(), split_plan->before_blocking.get(), "mem_src");
+  HasGRPCSourceGroupParent(map->id(), split_plan->after_blocking.get(), "map");
+}
+
 TEST_F(SplitterTest, limit_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto limit = MakeLimit(mem_src, 10);
@@ -569,6 +644,68 @@ TEST_F(SplitterTest, agg_join_children) {
   EXPECT_EQ(join_parent->source_id(), grpc_sink->destination_id());
 }
 
+class ColocatedJoinTest : public SplitterTest {
+ protected:
+  void SetUp() override {
+    SplitterTest::SetUp();
+    upid_relation = table_store::schema::Relation({types::UINT128, types::INT64}, {"upid", "count"},
+                                                  {types::ST_UPID, types::ST_NONE});
+    compiler_state_->relation_map()->emplace("process_stats", upid_relation);
+    compiler_state_->relation_map()->emplace("network_stats", upid_relation);
+  }
+
+  // process_stats JOIN network_stats on the given columns -> Sink.
+  JoinIR* MakeStatsJoin(const std::string& join_type, const std::string& left_on,
+                        const std::string& right_on) {
+    auto left = MakeMemSource("process_stats", upid_relation);
+    auto right = MakeMemSource("network_stats", upid_relation);
+    auto join = MakeJoin({left, right}, join_type, upid_relation, upid_relation, {left_on},
+                         {right_on}, {"_x", "_y"});
+    MakeMemSink(join, "out");
+    return join;
+  }
+
+  std::unique_ptr<BlockingSplitPlan> Split() {
+    ResolveTypesRule type_rule(compiler_state_.get());
+    PL_CHECK_OK(type_rule.Execute(graph.get()));
+    auto splitter = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false)
+                        .ConsumeValueOrDie();
+    return splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+  }
+
+  table_store::schema::Relation upid_relation;
+};
+
+TEST_F(ColocatedJoinTest, inner_upid_join_runs_on_pem) {
+  auto join = MakeStatsJoin("inner", "upid", "upid");
+  auto split_plan = Split();
+
+  auto pem_join = GetEquivalentInNewPlan(split_plan->before_blocking.get(), join);
+  EXPECT_MATCH(pem_join->parents()[0], MemorySource());
+  EXPECT_MATCH(pem_join->parents()[1], MemorySource());
+  ASSERT_EQ(pem_join->Children().size(), 1);
+  EXPECT_MATCH(pem_join->Children()[0], GRPCSink());
+  EXPECT_FALSE(HasEquivalentInNewPlan(split_plan->after_blocking.get(), join));
+}
+
+TEST_F(ColocatedJoinTest, join_on_non_upid_column_runs_on_kelvin) {
+  auto join = MakeStatsJoin("inner", "count", "count");
+  auto split_plan = Split();
+
+  EXPECT_FALSE(HasEquivalentInNewPlan(split_plan->before_blocking.get(), join));
+  auto kelvin_join = GetEquivalentInNewPlan(split_plan->after_blocking.get(), join);
+  EXPECT_MATCH(kelvin_join->parents()[0], GRPCSourceGroup());
+  EXPECT_MATCH(kelvin_join->parents()[1], GRPCSourceGroup());
+}
+
+TEST_F(ColocatedJoinTest, outer_upid_join_runs_on_kelvin) {
+  auto join = MakeStatsJoin("left", "upid", "upid");
+  auto split_plan = Split();
+
+  EXPECT_FALSE(HasEquivalentInNewPlan(split_plan->before_blocking.get(), join));
+  EXPECT_TRUE(HasEquivalentInNewPlan(split_plan->after_blocking.get(), join));
+}
+
 TEST_F(SplitterTest, simple_split_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto map1 = MakeMap(mem_src, {{"cpu0", MakeColumn("cpu0", 0)}, {"cpu1", MakeColumn("cpu1", 0)}});
@@ -19,11 +19,28 @@
 #include "src/carnot/planner/ir/blocking_agg_ir.h"
 #include "src/carnot/planner/ir/func_ir.h"
 #include "src/carnot/planner/ir/ir.h"
+#include "src/carnot/planner/ir/memory_source_ir.h"
 
 namespace px {
 namespace carnot {
 namespace planner {
 
+namespace {
+
+// Returns the sample rate of the memory source whose rows the operator outputs, if there is one
+// and the rows only went through row-wise operators, or else 1.
+double InputSampleRate(const OperatorIR* op) {
+  while (op->parents().size() == 1 && !op->IsBlocking()) {
+    op = op->parents()[0];
+  }
+  if (op->type() == IRNodeType::kMemorySource) {
+    return static_cast<const MemorySourceIR*>(op)->sample_rate();
+  }
+  return 1;
+}
+
+}  // namespace
+
 std::string BlockingAggIR::DebugString() const {
   return absl::Substitute(
       "$0(id=$1, groups=[$2], aggs={\n$3\n})", type_string(), id(),
@@ -39,6 +56,7 @@ Status BlockingAggIR::Init(OperatorIR* parent, const std::vector<ColumnIR*>& gro
                            const ColExpressionVector& agg_expr) {
   PL_RETURN_IF_ERROR(AddParent(parent));
   PL_RETURN_IF_ERROR(SetGroups(groups));
+  sample_rate_ = InputSampleRate(parent);
   return SetAggExprs(agg_expr);
 }
 
@@ -138,6 +156,9 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_windowed(false);
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
+  if (sample_rate_ < 1) {
+    pb->set_sample_rate(sample_rate_);
+  }
 
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
@@ -166,6 +187,7 @@ Status BlockingAggIR::CopyFromNodeImpl(
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
+  sample_rate_ = blocking_agg->sample_rate_;
 
   return Status::OK();
 }
@@ -71,6 +71,9 @@ class BlockingAggIR : public GroupAcceptorIR {
 
   bool partial_agg() const { return partial_agg_; }
   bool finalize_results() const { return finalize_results_; }
+  // The rate that the input rows were sampled at, if they all come from one sampled memory source
+  // through row-wise operators, or else 1.
+  double sample_rate() const { return sample_rate_; }
   void SetPreSplitProto(const planpb::AggregateOperator& pre_split_proto) {
     pre_split_proto_ = pre_split_proto;
   }
@@ -87,6 +90,8 @@ class BlockingAggIR : public GroupAcceptorIR {
   bool partial_agg_ = true;
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
+  // Set when the aggregate is created, so that the aggregates it is split into keep it.
+  double sample_rate_ = 1;
   planpb::AggregateOperator pre_split_proto_;
 };
 }  // namespace planner
@@ -113,6 +113,13 @@ class GRPCSinkIR : public OperatorIR {
   const std::string& destination_address() const { return destination_address_; }
   bool DestinationAddressSet() const { return destination_address_ != ""; }
   const std::string& destination_ssl_targetname() const { return destination_ssl_targetname_; }
+  // Whether the destination accepts row batches as arrow buffers.
+  void SetDestinationAcceptsArrowRowBatches(bool accepts) {
+    destination_accepts_arrow_row_batches_ = accepts;
+  }
+  bool destination_accepts_arrow_row_batches() const {
+    return destination_accepts_arrow_row_batches_;
+  }
 
   bool has_output_table() const { return sink_type_ == GRPCSinkType::kExternal; }
   std::string name() const { return name_; }
@@ -149,6 +156,7 @@ class GRPCSinkIR : public OperatorIR {
  private:
   std::string destination_address_ = "";
   std::string destination_ssl_targetname_ = "";
+  bool destination_accepts_arrow_row_batches_ = false;
   GRPCSinkType sink_type_ = GRPCSinkType::kTypeNotSet;
   // Used when GRPCSinkType = kInternal.
   int64_t destination_id_ = -1;
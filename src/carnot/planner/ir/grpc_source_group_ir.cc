@@ -27,6 +27,7 @@ Status GRPCSourceGroupIR::CopyFromNodeImpl(const IRNode* node,
   const GRPCSourceGroupIR* grpc_source_group = static_cast<const GRPCSourceGroupIR*>(node);
   source_id_ = grpc_source_group->source_id_;
   grpc_address_ = grpc_source_group->grpc_address_;
+  accepts_arrow_row_batches_ = grpc_source_group->accepts_arrow_row_batches_;
   if (grpc_source_group->dependent_sinks_.size()) {
     return error::Unimplemented("Cannot clone GRPCSourceGroupIR with dependent_sinks_");
   }
@@ -60,6 +61,7 @@ Status GRPCSourceGroupIR::AddGRPCSink(GRPCSinkIR* sink_op,
   }
   sink_op->SetDestinationAddress(grpc_address_);
   sink_op->SetDestinationSSLTargetName(ssl_targetname_);
+  sink_op->SetDestinationAcceptsArrowRowBatches(accepts_arrow_row_batches_);
   dependent_sinks_.emplace_back(sink_op, agents);
   return Status::OK();
 }
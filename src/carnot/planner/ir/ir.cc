@@ -30,6 +30,8 @@ namespace planner {
 
 Status IR::AddEdge(int64_t from_node, int64_t to_node) {
   dag_.AddEdge(from_node, to_node);
+  MarkChanged(from_node);
+  MarkChanged(to_node);
   return Status::OK();
 }
 
@@ -54,6 +56,8 @@ Status IR::DeleteEdge(int64_t from_node, int64_t to_node) {
     return error::InvalidArgument("No edge ($0, $1) exists.", from_node, to_node);
   }
   dag_.DeleteEdge(from_node, to_node);
+  MarkChanged(from_node);
+  MarkChanged(to_node);
   return Status::OK();
 }
 
@@ -78,6 +82,7 @@ Status IR::DeleteOrphansInSubtree(int64_t id) {
 Status IR::DeleteSubtree(int64_t id) {
   for (const auto& p : dag_.ParentsOf(id)) {
     dag_.DeleteEdge(p, id);
+    MarkChanged(p);
   }
   return DeleteOrphansInSubtree(id);
 }
@@ -86,6 +91,14 @@ Status IR::DeleteNode(int64_t node) {
   if (!dag_.HasNode(node)) {
     return error::InvalidArgument("No node $0 exists in graph.", node);
   }
+  if (changed_nodes_ != nullptr) {
+    for (int64_t parent : dag_.ParentsOf(node)) {
+      MarkChanged(parent);
+    }
+    for (int64_t child : dag_.DependenciesOf(node)) {
+      MarkChanged(child);
+    }
+  }
   dag_.DeleteNode(node);
   id_node_map_.erase(node);
   return Status::OK();
@@ -28,6 +28,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
 #include <pypa/ast/ast.hh>
 
 #include "src/carnot/dag/dag.h"
@@ -79,6 +80,7 @@ class IR {
     id_node_counter = std::max(id + 1, id_node_counter);
     auto node = std::make_unique<TOperator>(id);
     dag_.AddNode(node->id());
+    MarkChanged(node->id());
     node->set_graph(this);
     if (ast != nullptr) {
       node->SetLineCol(ast);
@@ -173,6 +175,20 @@ class IR {
 
   plan::DAG& dag() { return dag_; }
   const plan::DAG& dag() const { return dag_; }
+
+  /**
+   * While set, the ids of nodes that are created, deleted or gain or lose an edge are added to
+   * changed_nodes. Deleting a node marks its neighbors instead. The rule executor uses this to
+   * only revisit the parts of the graph that changed.
+   */
+  void set_changed_nodes(absl::flat_hash_set<int64_t>* changed_nodes) {
+    changed_nodes_ = changed_nodes;
+  }
+  void MarkChanged(int64_t node) {
+    if (changed_nodes_ != nullptr) {
+      changed_nodes_->insert(node);
+    }
+  }
   std::string DebugString() const;
   std::string OperatorsDebugString();
 
@@ -268,6 +284,7 @@ class IR {
   Status CopySelectedNodesAndDeps(const IR* src, const absl::flat_hash_set<int64_t>& selected_ids);
 
   plan::DAG dag_;
+  absl::flat_hash_set<int64_t>* changed_nodes_ = nullptr;
   std::unordered_map<int64_t, IRNodePtr> id_node_map_;
   int64_t id_node_counter = 0;
 };
@@ -400,6 +400,28 @@ TEST_F(ToProtoTest, filter_to_proto) {
   EXPECT_THAT(pb, EqualsProto(kExpectedFilterPb)) << pb.DebugString();
 }
 
+TEST_F(ToProtoTest, memory_source_with_filter_pushes_down_predicates) {
+  auto rel = MakeRelation();
+  auto mem_src = MakeMemSource("table", rel);
+  compiler_state_->relation_map()->emplace("table", rel);
+  // Only `count == 5` can be evaluated with the zone maps of the table.
+  auto count_equals = MakeEqualsFunc(MakeColumn("count", 0), MakeInt(5));
+  auto cpu_equals = MakeEqualsFunc(MakeColumn("cpu0", 0), MakeColumn("cpu2", 0));
+  MakeFilter(mem_src, MakeAndFunc(count_equals, cpu_equals));
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  planpb::Operator pb;
+  ASSERT_OK(mem_src->ToProto(&pb));
+  ASSERT_EQ(1, pb.mem_source_op().predicates_size()) << pb.DebugString();
+  const auto& func = pb.mem_source_op().predicates(0).func();
+  EXPECT_EQ("equal", func.name());
+  ASSERT_EQ(2, func.args_size());
+  EXPECT_EQ(0, func.args(0).column().index());
+  EXPECT_EQ(5, func.args(1).constant().int64_value());
+}
+
 constexpr char kExpectedAggPb[] = R"(
   op_type: AGGREGATE_OPERATOR
   agg_op {
@@ -467,6 +489,25 @@ TEST_F(ToProtoTest, agg_ir) {
   EXPECT_THAT(pb, EqualsProto(kExpectedAggPb));
 }
 
+TEST_F(ToProtoTest, agg_after_sampled_source_has_sample_rate) {
+  auto mem_src = MakeMemSource("table", MakeRelation());
+  mem_src->set_sample(0.01, /* sample_blocks */ false);
+  auto filter = MakeFilter(mem_src, MakeEqualsFunc(MakeColumn("count", 0), MakeInt(5)));
+  auto agg = MakeBlockingAgg(filter, {MakeColumn("count", 0)},
+                             {{"mean", MakeMeanFunc(MakeColumn("cpu0", 0))}});
+  EXPECT_EQ(agg->sample_rate(), 0.01);
+  // The copies that an aggregate is split into keep the sample rate.
+  ASSERT_OK_AND_ASSIGN(BlockingAggIR * agg_copy, graph->CopyNode(agg));
+  EXPECT_EQ(agg_copy->sample_rate(), 0.01);
+  // The rows out of an aggregate are not a sample.
+  auto agg_of_agg = MakeBlockingAgg(agg, {}, {{"mean", MakeMeanFunc(MakeColumn("mean", 0))}});
+  EXPECT_EQ(agg_of_agg->sample_rate(), 1);
+  // Nor is the sample of an unsampled source.
+  EXPECT_EQ(MakeBlockingAgg(MakeMemSource(), {}, {{"mean", MakeMeanFunc(MakeColumn("cpu0", 0))}})
+                ->sample_rate(),
+            1);
+}
+
 TEST_F(ToProtoTest, agg_ir_with_presplit_proto) {
   auto mem_src = graph
                      ->CreateNode<MemorySourceIR>(
@@ -554,6 +595,61 @@ TEST_F(ToProtoTest, limit_ir) {
   EXPECT_THAT(pb, EqualsProto(kExpectedLimitPb));
 }
 
+constexpr char kExpectedSortPb[] = R"(
+  op_type: SORT_OPERATOR
+  sort_op {
+    sort_keys {
+      column {
+        node: 0
+        index: 2
+      }
+      descending: true
+    }
+    sort_keys {
+      column {
+        node: 0
+        index: 0
+      }
+    }
+    columns {
+      node: 0
+      index: 0
+    }
+    columns {
+      node: 0
+      index: 1
+    }
+    columns {
+      node: 0
+      index: 2
+    }
+    limit: 10
+  }
+)";
+
+TEST_F(ToProtoTest, sort_ir) {
+  auto mem_src = graph
+                     ->CreateNode<MemorySourceIR>(
+                         ast, "source", std::vector<std::string>{"col1", "group1", "column"})
+                     .ValueOrDie();
+  table_store::schema::Relation src_rel({types::INT64, types::INT64, types::INT64},
+                                        {"col1", "group1", "column"});
+  compiler_state_->relation_map()->emplace("source", src_rel);
+
+  auto sort = graph
+                  ->CreateNode<SortIR>(ast, mem_src, std::vector<std::string>{"column", "col1"},
+                                       std::vector<bool>{true, false}, 10)
+                  .ValueOrDie();
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  planpb::Operator pb;
+  ASSERT_OK(sort->ToProto(&pb));
+
+  EXPECT_THAT(pb, EqualsProto(kExpectedSortPb));
+}
+
 constexpr char kInt64PbTxt[] = R"proto(
 constant {
   data_type: INT64
@@ -983,6 +1079,7 @@ TEST_F(CloneTests, internal_grpc_sink) {
   GRPCSinkIR* grpc_sink = MakeGRPCSink(mem_source, 123);
   grpc_sink->SetDestinationAddress("1111");
   grpc_sink->SetDestinationSSLTargetName("kelvin.pl.svc");
+  grpc_sink->SetDestinationAcceptsArrowRowBatches(true);
 
   ResolveTypesRule type_rule(compiler_state_.get());
   ASSERT_OK(type_rule.Execute(graph.get()));
@@ -1230,6 +1327,20 @@ TEST_F(ToProtoTests, internal_grpc_sink_ir) {
                                                destination_id + 1, ssl_targetname)));
 }
 
+TEST_F(ToProtoTests, internal_grpc_sink_ir_arrow_row_batches) {
+  int64_t destination_id = 123;
+  auto mem_src = MakeMemSource();
+  auto grpc_sink = MakeGRPCSink(mem_src, destination_id);
+  grpc_sink->SetDestinationAddress("1111");
+  grpc_sink->SetDestinationAcceptsArrowRowBatches(true);
+  int64_t agent_id = 0;
+  grpc_sink->AddDestinationIDMap(destination_id + 1, agent_id);
+
+  planpb::Operator pb;
+  ASSERT_OK(grpc_sink->ToProto(&pb, agent_id));
+  EXPECT_TRUE(pb.grpc_sink_op().arrow_row_batches());
+}
+
 constexpr char kExpectedExternalGRPCSinkPb[] = R"proto(
   op_type: GRPC_SINK_OPERATOR
   grpc_sink_op {
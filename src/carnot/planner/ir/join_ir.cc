@@ -52,6 +52,15 @@ Status JoinIR::CopyFromNodeImpl(const IRNode* node,
 
   PL_RETURN_IF_ERROR(SetJoinColumns(new_left_columns, new_right_columns));
   suffix_strs_ = join_node->suffix_strs_;
+
+  if (join_node->has_time_condition()) {
+    PL_ASSIGN_OR_RETURN(ColumnIR * new_left_time,
+                        graph()->CopyNode(join_node->left_time_column_, copied_nodes_map));
+    PL_ASSIGN_OR_RETURN(ColumnIR * new_right_time,
+                        graph()->CopyNode(join_node->right_time_column_, copied_nodes_map));
+    PL_RETURN_IF_ERROR(
+        SetTimeCondition(new_left_time, new_right_time, join_node->time_window_ns_));
+  }
   return Status::OK();
 }
 
@@ -99,6 +108,15 @@ Status JoinIR::ToProto(planpb::Operator* op) const {
     eq_condition->set_right_column_index(right_index);
   }
 
+  if (has_time_condition()) {
+    auto time_condition = pb->mutable_time_condition();
+    PL_ASSIGN_OR_RETURN(auto left_index, left_time_column_->GetColumnIndex());
+    PL_ASSIGN_OR_RETURN(auto right_index, right_time_column_->GetColumnIndex());
+    time_condition->set_left_column_index(left_index);
+    time_condition->set_right_column_index(right_index);
+    time_condition->set_window_ns(time_window_ns_);
+  }
+
   for (ColumnIR* col : output_columns_) {
     auto* parent_col = pb->add_output_columns();
     int64_t parent_idx = col->container_op_parent_idx();
@@ -157,6 +175,21 @@ Status JoinIR::SetJoinColumns(const std::vector<ColumnIR*>& left_columns,
   return Status::OK();
 }
 
+Status JoinIR::SetTimeCondition(ColumnIR* left_time_col, ColumnIR* right_time_col,
+                                int64_t window_ns) {
+  if (join_type_ != JoinType::kInner) {
+    return CreateIRNodeError("Joins on a time window only support 'inner' joins.");
+  }
+  if (window_ns < 0) {
+    return CreateIRNodeError("Join time window must not be negative, got $0.", window_ns);
+  }
+  DCHECK(left_time_column_ == nullptr);
+  PL_ASSIGN_OR_RETURN(left_time_column_, graph()->OptionallyCloneWithEdge(this, left_time_col));
+  PL_ASSIGN_OR_RETURN(right_time_column_, graph()->OptionallyCloneWithEdge(this, right_time_col));
+  time_window_ns_ = window_ns;
+  return Status::OK();
+}
+
 StatusOr<std::vector<absl::flat_hash_set<std::string>>> JoinIR::RequiredInputColumns() const {
   DCHECK(key_columns_set_);
   DCHECK(!output_columns_.empty());
@@ -175,6 +208,10 @@ StatusOr<std::vector<absl::flat_hash_set<std::string>>> JoinIR::RequiredInputCol
     DCHECK(col->container_op_parent_idx_set());
     ret[col->container_op_parent_idx()].insert(col->col_name());
   }
+  if (has_time_condition()) {
+    ret[left_time_column_->container_op_parent_idx()].insert(left_time_column_->col_name());
+    ret[right_time_column_->container_op_parent_idx()].insert(right_time_column_->col_name());
+  }
 
   return ret;
 }
@@ -325,6 +362,18 @@ Status JoinIR::ResolveType(CompilerState* compiler_state) {
     }
   }
 
+  if (has_time_condition()) {
+    for (ColumnIR* time_col : {left_time_column_, right_time_column_}) {
+      PL_RETURN_IF_ERROR(ResolveExpressionType(time_col, compiler_state, parent_types()));
+      auto time_col_dt =
+          std::static_pointer_cast<ValueType>(time_col->resolved_type())->data_type();
+      if (time_col_dt != types::TIME64NS) {
+        return CreateIRNodeError("join time column \"$0\" must be a time, got $1",
+                                 time_col->col_name(), magic_enum::enum_name(time_col_dt));
+      }
+    }
+  }
+
   auto new_table = TableType::Create();
   for (const auto& [idx, col] : Enumerate(output_columns_)) {
     PL_RETURN_IF_ERROR(ResolveExpressionType(col, compiler_state, parent_types()));
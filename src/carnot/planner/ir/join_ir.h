@@ -90,6 +90,21 @@ class JoinIR : public OperatorIR {
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
 
+  /**
+   * @brief Makes the join an interval join, which only joins rows whose times are at most
+   * window_ns apart.
+   *
+   * @param left_time_col the time column of the left parent.
+   * @param right_time_col the time column of the right parent.
+   * @param window_ns
+   * @return Status
+   */
+  Status SetTimeCondition(ColumnIR* left_time_col, ColumnIR* right_time_col, int64_t window_ns);
+  bool has_time_condition() const { return left_time_column_ != nullptr; }
+  ColumnIR* left_time_column() const { return left_time_column_; }
+  ColumnIR* right_time_column() const { return right_time_column_; }
+  int64_t time_window_ns() const { return time_window_ns_; }
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
   const std::tuple<std::shared_ptr<TableType>, std::shared_ptr<TableType>> left_right_table_types()
@@ -158,6 +173,11 @@ class JoinIR : public OperatorIR {
   // The suffixes to add to the left columns and to the right columns.
   std::vector<std::string> suffix_strs_;
 
+  // The time columns and the window of an interval join, or nullptr if it isn't one.
+  ColumnIR* left_time_column_ = nullptr;
+  ColumnIR* right_time_column_ = nullptr;
+  int64_t time_window_ns_ = 0;
+
   // Whether this join was originally specified as a right join.
   // Used because we transform left joins into right joins but need to do some back transform.
   bool specified_as_right_ = false;
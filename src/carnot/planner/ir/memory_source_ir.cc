@@ -18,11 +18,101 @@
 
 #include "src/carnot/planner/ir/memory_source_ir.h"
 #include "src/carnot/planner/ir/ir.h"
+#include "src/carnot/planner/ir/pattern_match.h"
 
 namespace px {
 namespace carnot {
 namespace planner {
 
+namespace {
+
+bool IsRangeType(types::DataType type) {
+  return type == types::DataType::INT64 || type == types::DataType::TIME64NS;
+}
+
+// Returns the column of `column <op> literal` (in either order) if the table can skip batches
+// with it: INT64 and TIME64NS columns have zone maps, and STRING columns have bloom filters for
+// equalities.
+const ColumnIR* PushableColumn(const FuncIR* func) {
+  if (func->args().size() != 2) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    const ExpressionIR* col = func->args()[i];
+    const ExpressionIR* literal = func->args()[1 - i];
+    if (!col->IsColumn() || !literal->IsData()) {
+      continue;
+    }
+    auto col_type = col->EvaluatedDataType();
+    auto literal_type = literal->EvaluatedDataType();
+    if (IsRangeType(col_type) && IsRangeType(literal_type)) {
+      return static_cast<const ColumnIR*>(col);
+    }
+    if (func->opcode() == FuncIR::eq && col_type == types::DataType::STRING &&
+        literal_type == types::DataType::STRING) {
+      return static_cast<const ColumnIR*>(col);
+    }
+  }
+  return nullptr;
+}
+
+// Whether the expression is an equality of the STRING column with a literal, or an or of such
+// equalities, e.g. from px.equals_any().
+bool IsStringEqualsAny(const ExpressionIR* expr, const std::string& col_name) {
+  if (!expr->IsFunction()) {
+    return false;
+  }
+  const auto* func = static_cast<const FuncIR*>(expr);
+  if (func->opcode() == FuncIR::logor) {
+    return std::all_of(func->args().begin(), func->args().end(),
+                       [&](const ExpressionIR* arg) { return IsStringEqualsAny(arg, col_name); });
+  }
+  const ColumnIR* col = PushableColumn(func);
+  return func->opcode() == FuncIR::eq && col != nullptr && col->col_name() == col_name &&
+         col->EvaluatedDataType() == types::DataType::STRING;
+}
+
+// Collects the terms of the filter expression that the memory source can skip batches with.
+void CollectPushdownPredicates(const ExpressionIR* expr, std::vector<const ExpressionIR*>* preds) {
+  if (!expr->IsFunction()) {
+    return;
+  }
+  const auto* func = static_cast<const FuncIR*>(expr);
+  switch (func->opcode()) {
+    case FuncIR::logand:
+      for (const ExpressionIR* arg : func->args()) {
+        CollectPushdownPredicates(arg, preds);
+      }
+      return;
+    case FuncIR::eq:
+    case FuncIR::lt:
+    case FuncIR::lteq:
+    case FuncIR::gt:
+    case FuncIR::gteq:
+      if (PushableColumn(func) != nullptr) {
+        preds->push_back(expr);
+      }
+      return;
+    case FuncIR::logor: {
+      // All of the or's equalities must be on the column of the first one.
+      const ExpressionIR* first = func;
+      while (first->IsFunction() && static_cast<const FuncIR*>(first)->opcode() == FuncIR::logor) {
+        first = static_cast<const FuncIR*>(first)->args()[0];
+      }
+      const ColumnIR* col =
+          first->IsFunction() ? PushableColumn(static_cast<const FuncIR*>(first)) : nullptr;
+      if (col != nullptr && IsStringEqualsAny(func, col->col_name())) {
+        preds->push_back(expr);
+      }
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+}  // namespace
+
 std::string MemorySourceIR::DebugString() const {
   return absl::Substitute("$0(id=$1, table=$2, streaming=$3)", type_string(), id(), table_name_,
                           streaming_);
@@ -61,6 +151,22 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+  pb->set_cursor_name(cursor_name_);
+  if (sample_rate_ < 1) {
+    pb->set_sample_rate(sample_rate_);
+    pb->set_sample_blocks(sample_blocks_);
+  }
+
+  // Push the simple predicates of a filter right after the source into it, so that it can skip
+  // the batches that the filter would drop entirely. The filter still runs on the rows read.
+  auto children = Children();
+  if (children.size() == 1 && Match(children[0], Filter())) {
+    std::vector<const ExpressionIR*> predicates;
+    CollectPushdownPredicates(static_cast<FilterIR*>(children[0])->filter_expr(), &predicates);
+    for (const ExpressionIR* predicate : predicates) {
+      PL_RETURN_IF_ERROR(predicate->ToProto(pb->add_predicates()));
+    }
+  }
   return Status::OK();
 }
 
@@ -135,6 +241,9 @@ Status MemorySourceIR::CopyFromNodeImpl(
   column_index_map_ = source_ir->column_index_map_;
   has_time_expressions_ = source_ir->has_time_expressions_;
   streaming_ = source_ir->streaming_;
+  cursor_name_ = source_ir->cursor_name_;
+  sample_rate_ = source_ir->sample_rate_;
+  sample_blocks_ = source_ir->sample_blocks_;
 
   if (has_time_expressions_) {
     PL_ASSIGN_OR_RETURN(ExpressionIR * new_start_expr,
@@ -61,6 +61,19 @@ class MemorySourceIR : public OperatorIR {
   bool streaming() const { return streaming_; }
   void set_streaming(bool streaming) { streaming_ = streaming; }
 
+  // The name of the table store cursor to resume reading from, if any.
+  const std::string& cursor_name() const { return cursor_name_; }
+  void set_cursor_name(const std::string& cursor_name) { cursor_name_ = cursor_name; }
+
+  // The fraction of the rows to sample, for approximate queries. 1 reads all rows.
+  double sample_rate() const { return sample_rate_; }
+  // Whether whole batches are sampled rather than single rows.
+  bool sample_blocks() const { return sample_blocks_; }
+  void set_sample(double sample_rate, bool sample_blocks) {
+    sample_rate_ = sample_rate;
+    sample_blocks_ = sample_blocks;
+  }
+
   Status SetTimeExpressions(ExpressionIR* start_time_expr, ExpressionIR* end_time_expr);
 
   // Sets the time expressions that eventually get converted
@@ -128,6 +141,9 @@ class MemorySourceIR : public OperatorIR {
  private:
   std::string table_name_;
   bool streaming_ = false;
+  std::string cursor_name_;
+  double sample_rate_ = 1;
+  bool sample_blocks_ = false;
 
   bool has_time_expressions_ = false;
   ExpressionIR* start_time_expr_ = nullptr;
@@ -51,6 +51,9 @@ Status OperatorIR::ReplaceParent(OperatorIR* old_parent, OperatorIR* new_parent)
     if (parents_[i] == old_parent) {
       parents_[i] = new_parent;
       graph()->dag().ReplaceParentEdge(id(), old_parent->id(), new_parent->id());
+      graph()->MarkChanged(id());
+      graph()->MarkChanged(old_parent->id());
+      graph()->MarkChanged(new_parent->id());
       return Status::OK();
     }
   }
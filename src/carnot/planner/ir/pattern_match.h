@@ -158,6 +158,7 @@ inline ClassMatch<IRNodeType::kEmptySource> EmptySource() {
   return ClassMatch<IRNodeType::kEmptySource>();
 }
 inline ClassMatch<IRNodeType::kLimit> Limit() { return ClassMatch<IRNodeType::kLimit>(); }
+inline ClassMatch<IRNodeType::kSort> Sort() { return ClassMatch<IRNodeType::kSort>(); }
 
 inline ClassMatch<IRNodeType::kGRPCSource> GRPCSource() {
   return ClassMatch<IRNodeType::kGRPCSource>();
@@ -1140,6 +1141,29 @@ struct ServiceMatcher : public ParentMatch {
   }
 };
 
+/**
+ * @brief Match a has_value expression between a metadata expression and a string, in either
+ * order. The string can be a single value or a JSON array of values, which makes it the
+ * equivalent of an IN-list on the metadata expression.
+ */
+struct MetadataHasValueMatcher : public ParentMatch {
+  MetadataHasValueMatcher() : ParentMatch(IRNodeType::kAny) {}
+
+  bool Match(const IRNode* node) const override {
+    if (!Func("has_value").Match(node)) {
+      return false;
+    }
+    auto func = static_cast<const FuncIR*>(node);
+    if (func->all_args().size() != 2) {
+      return false;
+    }
+    auto lhs = func->all_args()[0];
+    auto rhs = func->all_args()[1];
+    return (MetadataExpression().Match(lhs) && String().Match(rhs)) ||
+           (String().Match(lhs) && MetadataExpression().Match(rhs));
+  }
+};
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
@@ -116,12 +116,48 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
   PL_RETURN_IF_ERROR(registry_info_->Init(udf_info));
 
   PL_ASSIGN_OR_RETURN(distributed_planner_, distributed::DistributedPlanner::Create());
+  // Cached plans refer to the UDFs of the old registry.
+  plan_cache_ = PlanCache::CreateFromFlags();
   return Status::OK();
 }
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const distributedpb::LogicalPlannerState& logical_state,
     const plannerpb::QueryRequest& query_request) {
+  bool read_clock = false;
+  return PlanImpl(logical_state, query_request, &read_clock);
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProto(
+    const distributedpb::LogicalPlannerState& logical_state,
+    const plannerpb::QueryRequest& query_request) {
+  std::string key;
+  int64_t now = px::CurrentTimeNS();
+  if (plan_cache_ != nullptr) {
+    key = PlanCache::Key(logical_state, query_request);
+    auto cached = plan_cache_->Get(key, now);
+    if (cached != nullptr) {
+      return *cached;
+    }
+  }
+
+  bool read_clock = false;
+  PL_ASSIGN_OR_RETURN(auto distributed_plan, PlanImpl(logical_state, query_request, &read_clock));
+  // In the future, if we actually have plan options that will actually determine how the plan is
+  // constructed, we may want to pass the planOptions to planner.Plan. However, this
+  // will need to go through many more layers (such as the coordinator), so this is fine for now.
+  distributed_plan->SetPlanOptions(logical_state.plan_options());
+  PL_ASSIGN_OR_RETURN(distributedpb::DistributedPlan plan_pb, distributed_plan->ToProto());
+
+  if (plan_cache_ != nullptr) {
+    plan_cache_->Put(key, plan_pb, read_clock, now);
+  }
+  return plan_pb;
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::PlanImpl(
+    const distributedpb::LogicalPlannerState& logical_state,
+    const plannerpb::QueryRequest& query_request, bool* read_clock) {
   // Compile into the IR.
   auto ms = logical_state.plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
@@ -139,6 +175,7 @@ StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
                                                  compiler_state.get(), single_node_plan.get()));
   distributed_plan->SetExecutionCompleteAddress(logical_state.result_address(),
                                                 logical_state.result_ssl_targetname());
+  *read_clock = compiler_state->time_now_read();
   return distributed_plan;
 }
 
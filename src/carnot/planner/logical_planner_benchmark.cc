@@ -42,7 +42,24 @@ void BM_Query(benchmark::State& state) {
   }
 }
 
+// Plans the same query against the same state every iteration, as refreshing a dashboard does.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryCached(benchmark::State& state) {
+  // The query has a relative start time, which makes its plan depend on the clock.
+  FLAGS_planner_plan_cache_max_clock_skew_ms = 60 * 1000;
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto planner_state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanToProto(planner_state, query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
 BENCHMARK(BM_Query);
+BENCHMARK(BM_QueryCached);
 
 }  // namespace logical_planner
 }  // namespace planner
@@ -104,6 +104,12 @@ StatusOr<QLObjectPtr> DataFrameConstructor(IR* graph, const pypa::AstPtr& ast,
                       ParseAsListOfStrings(args.GetArg("select"), "select"));
   PL_ASSIGN_OR_RETURN(ExpressionIR * start_time, GetArgAs<ExpressionIR>(ast, args, "start_time"));
   PL_ASSIGN_OR_RETURN(ExpressionIR * end_time, GetArgAs<ExpressionIR>(ast, args, "end_time"));
+  PL_ASSIGN_OR_RETURN(StringIR * cursor, GetArgAs<StringIR>(ast, args, "cursor"));
+  PL_ASSIGN_OR_RETURN(FloatIR * sample, GetArgAs<FloatIR>(ast, args, "sample"));
+  PL_ASSIGN_OR_RETURN(BoolIR * sample_blocks, GetArgAs<BoolIR>(ast, args, "sample_blocks"));
+  if (sample->val() <= 0 || sample->val() > 1) {
+    return CreateAstError(ast, "'sample' must be in (0, 1], got $0.", sample->val());
+  }
 
   std::string table_name = table->str();
   PL_ASSIGN_OR_RETURN(MemorySourceIR * mem_source_op,
@@ -113,6 +119,8 @@ StatusOr<QLObjectPtr> DataFrameConstructor(IR* graph, const pypa::AstPtr& ast,
         args.default_subbed_args().contains("end_time"))) {
     PL_RETURN_IF_ERROR(mem_source_op->SetTimeExpressions(start_time, end_time));
   }
+  mem_source_op->set_cursor_name(cursor->str());
+  mem_source_op->set_sample(sample->val(), sample_blocks->val());
   return Dataframe::Create(mem_source_op, visitor);
 }
 
@@ -162,6 +170,31 @@ StatusOr<QLObjectPtr> JoinHandler(IR* graph, OperatorIR* op, const pypa::AstPtr&
   PL_ASSIGN_OR_RETURN(JoinIR * join_op,
                       graph->CreateNode<JoinIR>(ast, std::vector<OperatorIR*>{op, right}, how_type,
                                                 left_on_cols, right_on_cols, suffix_strs));
+
+  if (!args.default_subbed_args().contains("time_window")) {
+    PL_ASSIGN_OR_RETURN(ExpressionIR * time_window,
+                        GetArgAs<ExpressionIR>(ast, args, "time_window"));
+    int64_t window_ns;
+    if (Match(time_window, Int())) {
+      window_ns = static_cast<IntIR*>(time_window)->val();
+    } else if (Match(time_window, String())) {
+      auto window_or_s = StringToTimeInt(static_cast<StringIR*>(time_window)->str());
+      if (!window_or_s.ok()) {
+        return WrapAstError(time_window->ast(), window_or_s.status());
+      }
+      window_ns = window_or_s.ConsumeValueOrDie();
+    } else {
+      return time_window->CreateIRNodeError(
+          "'time_window' must be a duration in nanoseconds or a string like '5s'");
+    }
+    PL_ASSIGN_OR_RETURN(StringIR * left_time, GetArgAs<StringIR>(ast, args, "left_time"));
+    PL_ASSIGN_OR_RETURN(StringIR * right_time, GetArgAs<StringIR>(ast, args, "right_time"));
+    PL_ASSIGN_OR_RETURN(ColumnIR * left_time_col,
+                        graph->CreateNode<ColumnIR>(ast, left_time->str(), /* parent_idx */ 0));
+    PL_ASSIGN_OR_RETURN(ColumnIR * right_time_col,
+                        graph->CreateNode<ColumnIR>(ast, right_time->str(), /* parent_idx */ 1));
+    PL_RETURN_IF_ERROR(join_op->SetTimeCondition(left_time_col, right_time_col, window_ns));
+  }
   return Dataframe::Create(join_op, visitor);
 }
 
@@ -255,6 +288,35 @@ StatusOr<QLObjectPtr> LimitHandler(IR* graph, OperatorIR* op, const pypa::AstPtr
   return Dataframe::Create(limit_op, visitor);
 }
 
+// Handles the sort() DataFrame method.
+StatusOr<QLObjectPtr> SortHandler(IR* graph, OperatorIR* op, const pypa::AstPtr& ast,
+                                  const ParsedArgs& args, ASTVisitor* visitor) {
+  PL_ASSIGN_OR_RETURN(std::vector<std::string> sort_cols,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  PL_ASSIGN_OR_RETURN(std::vector<BoolIR*> ascending,
+                      ParseAsListOf<BoolIR>(args.GetArg("ascending"), "ascending"));
+  PL_ASSIGN_OR_RETURN(IntIR * n, GetArgAs<IntIR>(ast, args, "n"));
+  if (sort_cols.empty()) {
+    return CreateAstError(ast, "'by' must have at least one column.");
+  }
+  if (ascending.size() != 1 && ascending.size() != sort_cols.size()) {
+    return CreateAstError(ast, "'ascending' has $0 values, expected 1 or $1.", ascending.size(),
+                          sort_cols.size());
+  }
+  if (n->val() < 0) {
+    return CreateAstError(ast, "'n' must not be negative, got $0.", n->val());
+  }
+
+  std::vector<bool> descending;
+  descending.reserve(sort_cols.size());
+  for (size_t i = 0; i < sort_cols.size(); ++i) {
+    descending.push_back(!ascending[ascending.size() == 1 ? 0 : i]->val());
+  }
+  PL_ASSIGN_OR_RETURN(SortIR * sort_op,
+                      graph->CreateNode<SortIR>(ast, op, sort_cols, descending, n->val()));
+  return Dataframe::Create(sort_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -392,9 +454,14 @@ StatusOr<QLObjectPtr> StreamHandler(IR* graph, OperatorIR* op, const pypa::AstPt
 Status Dataframe::Init() {
   PL_ASSIGN_OR_RETURN(
       std::shared_ptr<FuncObject> constructor_fn,
-      FuncObject::Create(name(), {"table", "select", "start_time", "end_time"},
+      FuncObject::Create(name(),
+                         {"table", "select", "start_time", "end_time", "cursor", "sample",
+                          "sample_blocks"},
                          {{"select", "[]"},
                           {"start_time", "0"},
+                          {"cursor", "\"\""},
+                          {"sample", "1.0"},
+                          {"sample_blocks", "False"},
                           {"end_time", absl::Substitute("$0.$1()", PixieModule::kPixieModuleObjName,
                                                         PixieModule::kNowOpID)}},
                          /* has_variable_len_args */ false,
@@ -411,13 +478,19 @@ Status Dataframe::Init() {
 
   /**
    * # Equivalent to the python method method syntax:
-   * def merge(self, right, how, left_on, right_on, suffixes=['_x', '_y']):
+   * def merge(self, right, how, left_on, right_on, suffixes=['_x', '_y'], time_window=0,
+   *           left_time='time_', right_time='time_'):
    *     ...
    */
   PL_ASSIGN_OR_RETURN(
       std::shared_ptr<FuncObject> mergefn,
-      FuncObject::Create(kMergeOpID, {"right", "how", "left_on", "right_on", "suffixes"},
-                         {{"suffixes", "['_x', '_y']"}},
+      FuncObject::Create(kMergeOpID,
+                         {"right", "how", "left_on", "right_on", "suffixes", "time_window",
+                          "left_time", "right_time"},
+                         {{"suffixes", "['_x', '_y']"},
+                          {"time_window", "0"},
+                          {"left_time", "'time_'"},
+                          {"right_time", "'time_'"}},
                          /* has_variable_len_args */ false,
                          /* has_variable_len_kwargs */ false,
                          std::bind(&JoinHandler, graph(), op(), std::placeholders::_1,
@@ -484,6 +557,22 @@ Status Dataframe::Init() {
   PL_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort(self, by, ascending=True, n=0):
+   *     ...
+   */
+  PL_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(kSortOpID, {"by", "ascending", "n"}, {{"ascending", "True"}, {"n", "0"}},
+                         /* has_variable_len_args */ false,
+                         /* has_variable_len_kwargs */ false,
+                         std::bind(&SortHandler, graph(), op(), std::placeholders::_1,
+                                   std::placeholders::_2, std::placeholders::_3),
+                         ast_visitor()));
+  PL_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
@@ -92,6 +92,14 @@ class Dataframe : public QLObject {
     # Absolute time sepecification (nanoseconds). Note this format only works for PxL scripts;
     # The Live UI's `start_time` argument does not support this format.
     df = px.DataFrame('http_events', start_time=1646157769000000000)
+  Examples:
+    # Only read the rows added since the last run of the script with this cursor, e.g. for a
+    # periodic export.
+    df = px.DataFrame('http_events', cursor='http_export')
+  Examples:
+    # Estimate the request counts of the last day from a 1% sample of the rows.
+    df = px.DataFrame('http_events', start_time='-24h', sample=0.01)
+    df = df.groupby('service').agg(count=('latency', px.count))
 
   Args:
     table (string): The table name to load.
@@ -103,6 +111,15 @@ class Dataframe : public QLObject {
     end_time (px.Time): The last timestamp of data to load. The format can be one of the following:
       (1) relative time with format "-5m" or "-3h", (2) absolute time with format "2020-07-13 18:02:5.00 +0000",
       or (3) absolute time in nanoseconds.
+    cursor (string): If set, only load the rows added to the table since the last successful
+      run of a script with the same cursor, e.g. the ID of a periodic script. Rows are still
+      restricted to the time period.
+    sample (float): The fraction of the rows to load, for approximate queries over large
+      tables. Counts and sums aggregated from the sampled rows are scaled up to estimate those
+      of all rows, means are unchanged, and quantiles are those of the sampled rows.
+    sample_blocks (bool): If true, sample whole batches of rows rather than single rows. This
+      skips reading the batches that are left out, so it is faster, but less accurate for rows
+      that arrive in bursts.
 
   Returns:
     px.DataFrame: DataFrame loaded from the table with the specified columns and time period.
@@ -274,6 +291,31 @@ class Dataframe : public QLObject {
   Returns:
     px.DataFrame: DataFrame with the first n rows.
   )doc";
+  inline static constexpr char kSortOpID[] = "sort";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sorts the rows by the passed in columns.
+
+  Returns a DataFrame with the rows ordered by the values of the `by` columns, the first column
+  being the most significant. With n set, only the first n rows of that order are returned,
+  which the PEMs compute locally so that only n rows per PEM are sent to Kelvin.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 10 slowest http requests.
+    df = df.sort('latency', ascending=False, n=10)
+
+  Args:
+    by (Union[str,List[str]]): DataFrame columns to sort by, either as a string or a list.
+    ascending (Union[bool,List[bool]]): Whether to sort in ascending order, either for all of
+      the columns or as a list with a value for each column. If not set, default is True.
+    n (int): The number of rows to return. If not set, or 0, all of the rows are returned.
+
+  Returns:
+    px.DataFrame: DataFrame with the sorted rows.
+  )doc";
 
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
@@ -302,6 +344,11 @@ class Dataframe : public QLObject {
     right_df = right_df.groupby(['service', 'node']).agg(count=('resp_body', px.count))
     df = left_df.merge(right_df, how='inner', left_on=['service', 'node'], right_on=['service', 'node'], suffixes=['', '_x'])
     # Output relation: ['service', 'node', 'cpu_utime', 'service_x', 'node_x', 'count']
+    # Time window: Join each HTTP request with the CPU samples of its process taken within 10s.
+    reqs = px.DataFrame('http_events', start_time='-1h')
+    cpu = px.DataFrame('process_stats', start_time='-1h')
+    df = reqs.merge(cpu, how='inner', left_on='upid', right_on='upid', suffixes=['', '_cpu'],
+                    time_window='10s')
 
   :topic: dataframe_ops
   :opname: Join
@@ -316,6 +363,9 @@ class Dataframe : public QLObject {
     left_on (Union[string, List[string]]): Column name from this DataFrame, either as a string or a list of strings.
     right_on (Union[string, List[string]]): Column name from the right DataFarme to join on. Must be the same type as the `left_on` column.
     suffixes (Tuple[string, string], default ['_x', '_y']): The suffixes to apply to duplicate columns.
+    time_window (Union[int, string], default 0): If set, only join rows whose times are at most this far apart, either in nanoseconds or as a string like '5s'. The inputs are buffered only as far back as the window, so this is much cheaper than joining on the keys and filtering on the times. Only supported for 'inner' merges of inputs sorted by time.
+    left_time (string, default 'time_'): The time column of this DataFrame for `time_window`.
+    right_time (string, default 'time_'): The time column of the right DataFrame for `time_window`.
 
   Returns:
     px.DataFrame: Merged DataFrame with the relation
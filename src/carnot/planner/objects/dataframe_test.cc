@@ -138,6 +138,38 @@ TEST_F(DataframeTest, Merge_NonListKeys) {
   EXPECT_THAT(join->suffix_strs(), ElementsAre("_x", "_y"));
 }
 
+TEST_F(DataframeTest, Merge_TimeWindow) {
+  MemorySourceIR* src2 = MakeMemSource();
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<QLObject> df2, Dataframe::Create(src2, ast_visitor.get()));
+  var_table->Add("df2", df2);
+
+  std::string script = R"pxl(join = df.merge(
+    df2,
+    how='inner',
+    left_on='a',
+    right_on='b',
+    time_window='5s',
+    right_time='t',
+  ))pxl";
+  ASSERT_OK(ParseScript(var_table, script));
+  auto var = var_table->Lookup("join");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  OperatorIR* op = static_cast<Dataframe*>(var.get())->op();
+  ASSERT_MATCH(op, Join());
+
+  JoinIR* join = static_cast<JoinIR*>(op);
+  ASSERT_TRUE(join->has_time_condition());
+  EXPECT_MATCH(join->left_time_column(), ColumnNode("time_", 0));
+  EXPECT_MATCH(join->right_time_column(), ColumnNode("t", 1));
+  EXPECT_EQ(5000000000, join->time_window_ns());
+
+  // Only inner joins can be on a time window.
+  EXPECT_THAT(
+      ParseScript(var_table,
+                  "join = df.merge(df2, how='left', left_on='a', right_on='b', time_window=10)"),
+      HasCompilerError("only support 'inner' joins"));
+}
+
 TEST_F(DataframeTest, Drop_WithList) {
   ASSERT_OK(ParseScript(var_table, "drop = df.drop(['foo', 'bar'])"));
   auto var = var_table->Lookup("drop");
@@ -360,6 +392,46 @@ TEST_F(DataframeTest, ConstructorTest) {
   ASSERT_MATCH(df_obj->op(), MemorySource());
   MemorySourceIR* mem_src = static_cast<MemorySourceIR*>(df_obj->op());
   EXPECT_EQ(mem_src->table_name(), "http_events");
+  EXPECT_EQ(mem_src->cursor_name(), "");
+}
+
+TEST_F(DataframeTest, ConstructorWithCursor) {
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Dataframe> df,
+                       Dataframe::Create(graph.get(), ast_visitor.get()));
+  var_table->Add("DataFrame", df);
+  ASSERT_OK(ParseScript(var_table, "http = DataFrame('http_events', cursor='http_export')"));
+  auto var = var_table->Lookup("http");
+
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto df_obj = static_cast<Dataframe*>(var.get());
+  ASSERT_MATCH(df_obj->op(), MemorySource());
+  MemorySourceIR* mem_src = static_cast<MemorySourceIR*>(df_obj->op());
+  EXPECT_EQ(mem_src->cursor_name(), "http_export");
+}
+
+TEST_F(DataframeTest, ConstructorWithSample) {
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Dataframe> df,
+                       Dataframe::Create(graph.get(), ast_visitor.get()));
+  var_table->Add("DataFrame", df);
+  ASSERT_OK(ParseScript(var_table, "http = DataFrame('http_events', sample=0.01)"));
+  auto var = var_table->Lookup("http");
+
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto df_obj = static_cast<Dataframe*>(var.get());
+  ASSERT_MATCH(df_obj->op(), MemorySource());
+  MemorySourceIR* mem_src = static_cast<MemorySourceIR*>(df_obj->op());
+  EXPECT_EQ(mem_src->sample_rate(), 0.01);
+  EXPECT_FALSE(mem_src->sample_blocks());
+
+  ASSERT_OK(
+      ParseScript(var_table, "http = DataFrame('http_events', sample=0.5, sample_blocks=True)"));
+  df_obj = static_cast<Dataframe*>(var_table->Lookup("http").get());
+  mem_src = static_cast<MemorySourceIR*>(df_obj->op());
+  EXPECT_EQ(mem_src->sample_rate(), 0.5);
+  EXPECT_TRUE(mem_src->sample_blocks());
+
+  EXPECT_THAT(ParseScript(var_table, "http = DataFrame('http_events', sample=1.5)"),
+              HasCompilerError("'sample' must be in \\(0, 1\\]"));
 }
 
 TEST_F(DataframeTest, StreamTest) {
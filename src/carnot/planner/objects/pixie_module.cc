@@ -64,18 +64,17 @@ StatusOr<QLObjectPtr> UDFHandler(IR* graph, std::string name, const pypa::AstPtr
 }
 
 Status PixieModule::RegisterUDFFuncs() {
-  auto func_names = compiler_state_->registry_info()->func_names();
-  for (const auto& name : func_names) {
-    PL_ASSIGN_OR_RETURN(
-        std::shared_ptr<FuncObject> fn_obj,
-        FuncObject::Create(name, {}, {},
-                           /* has_variable_len_args */ true,
-                           /* has_variable_len_kwargs */ false,
-                           std::bind(&UDFHandler, graph_, std::string(name), std::placeholders::_1,
-                                     std::placeholders::_2, std::placeholders::_3),
-                           ast_visitor()));
-
-    AddMethod(std::string(name), fn_obj);
+  // Scripts only use a handful of the registered functions, so each FuncObject is only created
+  // once the script looks it up.
+  for (const auto& name : compiler_state_->registry_info()->func_names()) {
+    AddLazyMethod(name, [this, name]() {
+      return FuncObject::Create(name, {}, {},
+                                /* has_variable_len_args */ true,
+                                /* has_variable_len_kwargs */ false,
+                                std::bind(&UDFHandler, graph_, name, std::placeholders::_1,
+                                          std::placeholders::_2, std::placeholders::_3),
+                                ast_visitor());
+    });
   }
   return Status::OK();
 }
@@ -173,28 +172,29 @@ StatusOr<QLObjectPtr> UDTFSourceHandler(IR* graph, const udfspb::UDTFSourceSpec&
   return Dataframe::Create(udtf_source, visitor);
 }
 
-Status PixieModule::RegisterUDTFs() {
-  for (const auto& udtf : compiler_state_->registry_info()->udtfs()) {
-    std::vector<std::string> argument_names;
-    absl::flat_hash_map<std::string, std::string> default_values;
-    for (const auto& arg : udtf.args()) {
-      argument_names.push_back(arg.name());
-      if (arg.has_default_value()) {
-        DCHECK_EQ(arg.default_value().data_type(), arg.arg_type());
-        PL_ASSIGN_OR_RETURN(default_values[arg.name()], PrepareDefaultUDTFArg(arg.default_value()));
-      }
+StatusOr<std::shared_ptr<FuncObject>> PixieModule::CreateUDTFFunc(
+    const udfspb::UDTFSourceSpec& udtf) {
+  std::vector<std::string> argument_names;
+  absl::flat_hash_map<std::string, std::string> default_values;
+  for (const auto& arg : udtf.args()) {
+    argument_names.push_back(arg.name());
+    if (arg.has_default_value()) {
+      DCHECK_EQ(arg.default_value().data_type(), arg.arg_type());
+      PL_ASSIGN_OR_RETURN(default_values[arg.name()], PrepareDefaultUDTFArg(arg.default_value()));
     }
+  }
 
-    PL_ASSIGN_OR_RETURN(
-        std::shared_ptr<FuncObject> fn_obj,
-        FuncObject::Create(udtf.name(), argument_names, default_values,
-                           /* has_variable_len_args */ false,
-                           /* has_variable_len_kwargs */ false,
-                           std::bind(&UDTFSourceHandler, graph_, udtf, std::placeholders::_1,
-                                     std::placeholders::_2, std::placeholders::_3),
-                           ast_visitor()));
+  return FuncObject::Create(udtf.name(), argument_names, default_values,
+                            /* has_variable_len_args */ false,
+                            /* has_variable_len_kwargs */ false,
+                            std::bind(&UDTFSourceHandler, graph_, udtf, std::placeholders::_1,
+                                      std::placeholders::_2, std::placeholders::_3),
+                            ast_visitor());
+}
 
-    AddMethod(udtf.name(), fn_obj);
+Status PixieModule::RegisterUDTFs() {
+  for (const auto& udtf : compiler_state_->registry_info()->udtfs()) {
+    AddLazyMethod(udtf.name(), [this, udtf]() { return CreateUDTFFunc(udtf); });
   }
   return Status::OK();
 }
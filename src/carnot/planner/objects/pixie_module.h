@@ -291,6 +291,7 @@ class PixieModule : public QLObject {
   Status Init();
   Status RegisterUDFFuncs();
   Status RegisterUDTFs();
+  StatusOr<std::shared_ptr<FuncObject>> CreateUDTFFunc(const udfspb::UDTFSourceSpec& udtf);
   Status RegisterCompileTimeFuncs();
   Status RegisterTypeObjs();
 
@@ -50,6 +50,14 @@ class TestQLObject : public QLObject {
                            visitor)
             .ConsumeValueOrDie();
     AddMethod("func", func_obj);
+    AddLazyMethod("lazy_func", [this, visitor]() {
+      ++num_lazy_creates;
+      return FuncObject::Create("lazy_func", {}, {}, /* has_variable_len_args */ false,
+                                /* has_variable_len_kwargs */ false,
+                                std::bind(&TestQLObject::SimpleFunc, this, std::placeholders::_1,
+                                          std::placeholders::_2, std::placeholders::_3),
+                                visitor);
+    });
   }
 
   StatusOr<QLObjectPtr> SimpleFunc(const pypa::AstPtr& ast, const ParsedArgs&,
@@ -57,6 +65,8 @@ class TestQLObject : public QLObject {
     auto out_obj = std::make_shared<TestQLObject>(ast, visitor);
     return StatusOr<QLObjectPtr>(out_obj);
   }
+
+  int64_t num_lazy_creates = 0;
 };
 
 TEST_F(QLObjectTest, GetMethod) {
@@ -74,6 +84,21 @@ TEST_F(QLObjectTest, GetMethod) {
   ASSERT_TRUE(out_object->type_descriptor().name() == TestQLObject::TestQLObjectType.name());
 }
 
+TEST_F(QLObjectTest, LazyMethodCreatedOnce) {
+  auto test_object = std::make_shared<TestQLObject>(ast, ast_visitor.get());
+  EXPECT_TRUE(test_object->HasMethod("lazy_func"));
+  EXPECT_EQ(test_object->num_lazy_creates, 0);
+
+  ASSERT_OK_AND_ASSIGN(auto first, test_object->GetMethod("lazy_func"));
+  ASSERT_OK_AND_ASSIGN(auto second, test_object->GetAttribute(ast, "lazy_func"));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(test_object->num_lazy_creates, 1);
+
+  // Listing every method creates the lazy ones, so docs see them all.
+  EXPECT_TRUE(test_object->methods().contains("lazy_func"));
+  EXPECT_EQ(test_object->num_lazy_creates, 1);
+}
+
 // Gets the method via an attribute.
 TEST_F(QLObjectTest, GetMethodAsAttribute) {
   auto test_object = std::make_shared<TestQLObject>(ast, ast_visitor.get());
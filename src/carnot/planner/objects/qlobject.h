@@ -17,6 +17,7 @@
  */
 
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -97,9 +98,10 @@ class QLObject {
    * @return ptr to the method. nullptr if not found.
    */
   StatusOr<std::shared_ptr<FuncObject>> GetMethod(std::string_view name) const {
-    if (!methods_.contains(name)) {
+    if (!methods_.contains(name) && !lazy_methods_.contains(name)) {
       return CreateError("'$0' object has no attribute '$1'", type_descriptor_.name(), name);
     }
+    PL_RETURN_IF_ERROR(MaterializeMethod(name));
     return methods_.find(name)->second;
   }
 
@@ -144,7 +146,9 @@ class QLObject {
    * @param name the string name of the method.
    * @return whether the object has the method.
    */
-  bool HasMethod(std::string_view name) const { return methods_.find(name) != methods_.end(); }
+  bool HasMethod(std::string_view name) const {
+    return methods_.contains(name) || lazy_methods_.contains(name);
+  }
 
   bool HasSubscriptMethod() const { return HasMethod(kSubscriptMethodName); }
   bool HasCallMethod() const { return HasMethod(kCallMethodName); }
@@ -212,8 +216,16 @@ class QLObject {
 
   const std::string& doc_string() const { return doc_string_; }
 
-  // Methods are all of the methods available. Exposed to make testing easier.
+  // Methods are all of the methods available. Exposed to make testing easier. Creates any lazy
+  // methods that haven't been looked up yet.
   const absl::flat_hash_map<std::string, std::shared_ptr<FuncObject>>& methods() const {
+    while (!lazy_methods_.empty()) {
+      std::string name = lazy_methods_.begin()->first;
+      auto s = MaterializeMethod(name);
+      DCHECK(s.ok()) << s.msg();
+      // Drop methods that fail to build so that this loop always terminates.
+      lazy_methods_.erase(name);
+    }
     return methods_;
   }
 
@@ -247,6 +259,21 @@ class QLObject {
     methods_[name] = func_object;
   }
 
+  using MethodFactory = std::function<StatusOr<std::shared_ptr<FuncObject>>()>;
+
+  /**
+   * @brief Adds a method that's only created the first time it's looked up. Objects with many
+   * methods, such as the px module with one per UDF, use this so that each compile only builds
+   * the methods that its script actually references.
+   *
+   * @param name name to reference for the method.
+   * @param factory creates the function object that represents the Method.
+   */
+  void AddLazyMethod(const std::string& name, MethodFactory factory) {
+    DCHECK(!HasMethod(name)) << "already exists.";
+    lazy_methods_[name] = std::move(factory);
+  }
+
   /**
    * @brief Defines a call method for the object.
    *
@@ -300,7 +327,21 @@ class QLObject {
   StatusOr<std::shared_ptr<QLObject>> GetAttributeInternal(const pypa::AstPtr& ast,
                                                            std::string_view attr_name) const;
 
-  absl::flat_hash_map<std::string, std::shared_ptr<FuncObject>> methods_;
+  // Moves the named lazy method, if there is one, into methods_.
+  Status MaterializeMethod(std::string_view name) const {
+    auto it = lazy_methods_.find(name);
+    if (it == lazy_methods_.end()) {
+      return Status::OK();
+    }
+    PL_ASSIGN_OR_RETURN(auto func_object, it->second());
+    methods_[name] = std::move(func_object);
+    lazy_methods_.erase(it);
+    return Status::OK();
+  }
+
+  // Both are mutable because lazy methods are created by the const lookup functions.
+  mutable absl::flat_hash_map<std::string, std::shared_ptr<FuncObject>> methods_;
+  mutable absl::flat_hash_map<std::string, MethodFactory> lazy_methods_;
   absl::flat_hash_map<std::string, QLObjectPtr> attributes_;
 
   TypeDescriptor type_descriptor_;
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <farmhash.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_format.h>
+
+DEFINE_int64(planner_plan_cache_bytes,
+             gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_BYTES", 64 * 1024 * 1024),
+             "The bytes of compiled plans to keep, to reuse when the same query is planned again "
+             "against the same state. Disabled if 0.");
+DEFINE_int64(planner_plan_cache_max_clock_skew_ms,
+             gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_MAX_CLOCK_SKEW_MS", 0),
+             "How long a cached plan that depends on the current time (eg. has a relative start "
+             "time) may be reused for. Such plans are not cached if 0.");
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+namespace {
+
+std::string DeterministicSerialize(const google::protobuf::Message& msg) {
+  std::string out;
+  {
+    google::protobuf::io::StringOutputStream stream(&out);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    // Maps would otherwise serialize in an arbitrary order.
+    coded.SetSerializationDeterministic(true);
+    msg.SerializeToCodedStream(&coded);
+  }
+  return out;
+}
+
+std::string Fingerprint(const std::string& data) {
+  auto fp = ::util::Fingerprint128(data.data(), data.size());
+  return absl::StrFormat("%016x%016x", ::util::Uint128High64(fp), ::util::Uint128Low64(fp));
+}
+
+}  // namespace
+
+std::unique_ptr<PlanCache> PlanCache::CreateFromFlags() {
+  if (FLAGS_planner_plan_cache_bytes <= 0) {
+    return nullptr;
+  }
+  return std::make_unique<PlanCache>(FLAGS_planner_plan_cache_bytes,
+                                     FLAGS_planner_plan_cache_max_clock_skew_ms * 1000 * 1000);
+}
+
+std::string PlanCache::Key(const distributedpb::LogicalPlannerState& logical_state,
+                           const plannerpb::QueryRequest& query) {
+  // Table stats change with every heartbeat, but they only steer where operators are placed, and
+  // a plan compiled against older stats is still correct. So they are left out of the key.
+  bool has_table_stats = false;
+  for (const auto& carnot_info : logical_state.distributed_state().carnot_info()) {
+    has_table_stats |= carnot_info.table_stats_size() > 0;
+  }
+  if (!has_table_stats) {
+    return absl::StrCat(Fingerprint(DeterministicSerialize(logical_state)),
+                        Fingerprint(DeterministicSerialize(query)));
+  }
+  distributedpb::LogicalPlannerState stripped_state = logical_state;
+  for (auto& carnot_info : *stripped_state.mutable_distributed_state()->mutable_carnot_info()) {
+    carnot_info.clear_table_stats();
+  }
+  return absl::StrCat(Fingerprint(DeterministicSerialize(stripped_state)),
+                      Fingerprint(DeterministicSerialize(query)));
+}
+
+std::shared_ptr<const distributedpb::DistributedPlan> PlanCache::Get(const std::string& key,
+                                                                     int64_t now_ns) {
+  absl::MutexLock lock(&lock_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  const Item& item = *it->second;
+  if (item.read_clock && now_ns - item.compiled_at_ns > max_clock_skew_ns_) {
+    EraseLocked(it->second);
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  items_.splice(items_.begin(), items_, it->second);
+  return it->second->plan;
+}
+
+void PlanCache::Put(const std::string& key, distributedpb::DistributedPlan plan, bool read_clock,
+                    int64_t compiled_at_ns) {
+  if (read_clock && max_clock_skew_ns_ <= 0) {
+    return;
+  }
+  int64_t bytes = key.size() + plan.SpaceUsedLong();
+  if (bytes > max_bytes_) {
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    EraseLocked(it->second);
+  }
+  EvictLocked(bytes);
+  items_.push_front({key, std::make_shared<const distributedpb::DistributedPlan>(std::move(plan)),
+                     bytes, read_clock, compiled_at_ns});
+  index_[key] = items_.begin();
+  bytes_ += bytes;
+}
+
+void PlanCache::EraseLocked(std::list<Item>::iterator it) {
+  bytes_ -= it->bytes;
+  index_.erase(it->key);
+  items_.erase(it);
+}
+
+void PlanCache::EvictLocked(int64_t needed_bytes) {
+  while (!items_.empty() && bytes_ + needed_bytes > max_bytes_) {
+    EraseLocked(std::prev(items_.end()));
+  }
+}
+
+int64_t PlanCache::bytes() const {
+  absl::MutexLock lock(&lock_);
+  return bytes_;
+}
+
+int64_t PlanCache::hits() const {
+  absl::MutexLock lock(&lock_);
+  return hits_;
+}
+
+int64_t PlanCache::misses() const {
+  absl::MutexLock lock(&lock_);
+  return misses_;
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/func_args.pb.h"
+#include "src/common/base/base.h"
+
+DECLARE_int64(planner_plan_cache_bytes);
+DECLARE_int64(planner_plan_cache_max_clock_skew_ms);
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * PlanCache keeps recently compiled distributed plans, so that a script that is planned again
+ * against the same state (e.g. a dashboard refreshing) skips compilation. Entries are keyed by
+ * the query request and the whole logical planner state, which covers the schemas, the agent
+ * topology and the plan options, and are evicted least recently used first.
+ *
+ * Plans that read the current time while compiling (i.e. any relative time) have it baked in, so
+ * they are only reused within --planner_plan_cache_max_clock_skew_ms of being compiled.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  PlanCache(int64_t max_bytes, int64_t max_clock_skew_ns)
+      : max_bytes_(max_bytes), max_clock_skew_ns_(max_clock_skew_ns) {}
+
+  /**
+   * @return the cache if enabled by --planner_plan_cache_bytes, nullptr otherwise.
+   */
+  static std::unique_ptr<PlanCache> CreateFromFlags();
+
+  /**
+   * @return a fingerprint of everything that the plan for the query depends on.
+   */
+  static std::string Key(const distributedpb::LogicalPlannerState& logical_state,
+                         const plannerpb::QueryRequest& query);
+
+  /**
+   * @return the plan for key, or nullptr if there is none that is still valid at now_ns.
+   */
+  std::shared_ptr<const distributedpb::DistributedPlan> Get(const std::string& key,
+                                                            int64_t now_ns);
+
+  /**
+   * Adds the plan for key, which was compiled at compiled_at_ns. Plans that did not read the
+   * clock don't expire.
+   */
+  void Put(const std::string& key, distributedpb::DistributedPlan plan, bool read_clock,
+           int64_t compiled_at_ns);
+
+  int64_t bytes() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Item {
+    std::string key;
+    std::shared_ptr<const distributedpb::DistributedPlan> plan;
+    int64_t bytes;
+    bool read_clock;
+    int64_t compiled_at_ns;
+  };
+
+  void EraseLocked(std::list<Item>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void EvictLocked(int64_t needed_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const int64_t max_bytes_;
+  const int64_t max_clock_skew_ns_;
+  mutable absl::Mutex lock_;
+  // Most recently used first.
+  std::list<Item> items_ ABSL_GUARDED_BY(lock_);
+  absl::flat_hash_map<std::string, std::list<Item>::iterator> index_ ABSL_GUARDED_BY(lock_);
+  int64_t bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t hits_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
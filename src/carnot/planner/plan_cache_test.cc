@@ -0,0 +1,174 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/plan_cache.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/status.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using ::px::testing::proto::EqualsProto;
+
+distributedpb::DistributedPlan PlanWithAddress(const std::string& address) {
+  distributedpb::DistributedPlan plan;
+  (*plan.mutable_qb_address_to_plan())[address];
+  return plan;
+}
+
+TEST(PlanCache, get_and_put) {
+  PlanCache cache(/*max_bytes*/ 1024 * 1024, /*max_clock_skew_ns*/ 0);
+  EXPECT_EQ(nullptr, cache.Get("a", 0));
+  cache.Put("a", PlanWithAddress("pem"), /*read_clock*/ false, /*compiled_at_ns*/ 0);
+
+  auto plan = cache.Get("a", 1000000000000);
+  ASSERT_NE(nullptr, plan);
+  EXPECT_THAT(*plan, EqualsProto(PlanWithAddress("pem").DebugString()));
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+}
+
+TEST(PlanCache, clock_dependent_plans_expire) {
+  PlanCache no_skew(/*max_bytes*/ 1024 * 1024, /*max_clock_skew_ns*/ 0);
+  no_skew.Put("a", PlanWithAddress("pem"), /*read_clock*/ true, /*compiled_at_ns*/ 100);
+  EXPECT_EQ(nullptr, no_skew.Get("a", 100));
+  EXPECT_EQ(0, no_skew.bytes());
+
+  PlanCache cache(/*max_bytes*/ 1024 * 1024, /*max_clock_skew_ns*/ 50);
+  cache.Put("a", PlanWithAddress("pem"), /*read_clock*/ true, /*compiled_at_ns*/ 100);
+  EXPECT_NE(nullptr, cache.Get("a", 150));
+  EXPECT_EQ(nullptr, cache.Get("a", 151));
+  EXPECT_EQ(0, cache.bytes());
+}
+
+TEST(PlanCache, evicts_least_recently_used) {
+  int64_t plan_bytes = 1 + PlanWithAddress("pem").SpaceUsedLong();
+  PlanCache cache(/*max_bytes*/ 2 * plan_bytes, /*max_clock_skew_ns*/ 0);
+  cache.Put("a", PlanWithAddress("pem"), false, 0);
+  cache.Put("b", PlanWithAddress("pem"), false, 0);
+  EXPECT_NE(nullptr, cache.Get("a", 0));
+  cache.Put("c", PlanWithAddress("pem"), false, 0);
+
+  EXPECT_NE(nullptr, cache.Get("a", 0));
+  EXPECT_EQ(nullptr, cache.Get("b", 0));
+  EXPECT_NE(nullptr, cache.Get("c", 0));
+}
+
+TEST(PlanCache, key_covers_state_and_query) {
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  plannerpb::QueryRequest query;
+  query.set_query_str("import px");
+
+  auto key = PlanCache::Key(state, query);
+  EXPECT_EQ(key, PlanCache::Key(state, query));
+
+  auto other_query = query;
+  other_query.set_query_str("import px\n");
+  EXPECT_NE(key, PlanCache::Key(state, other_query));
+
+  auto other_state = state;
+  other_state.mutable_plan_options()->set_max_output_rows_per_table(1);
+  EXPECT_NE(key, PlanCache::Key(other_state, query));
+
+  other_state = state;
+  other_state.mutable_distributed_state()->mutable_carnot_info(0)->set_query_broker_address("x");
+  EXPECT_NE(key, PlanCache::Key(other_state, query));
+}
+
+TEST(PlanCache, key_ignores_table_stats) {
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  plannerpb::QueryRequest query;
+  query.set_query_str("import px");
+
+  auto other_state = state;
+  auto carnot_info = other_state.mutable_distributed_state()->mutable_carnot_info(0);
+  (*carnot_info->mutable_table_stats())["http_events"].set_num_bytes(1024);
+  EXPECT_EQ(PlanCache::Key(state, query), PlanCache::Key(other_state, query));
+}
+
+constexpr char kQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_'])
+px.display(t1)
+)pxl";
+
+constexpr char kRelativeTimeQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', start_time='-120s', select=['time_'])
+px.display(t1)
+)pxl";
+
+class PlanCacheLogicalPlannerTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    info_ = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+    planner_ = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+    state_ = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  }
+  plannerpb::QueryRequest MakeQueryRequest(const std::string& query) {
+    plannerpb::QueryRequest query_request;
+    query_request.set_query_str(query);
+    return query_request;
+  }
+
+  udfspb::UDFInfo info_;
+  std::unique_ptr<LogicalPlanner> planner_;
+  distributedpb::LogicalPlannerState state_;
+};
+
+TEST_F(PlanCacheLogicalPlannerTest, reuses_plans) {
+  ASSERT_NE(nullptr, planner_->plan_cache());
+  ASSERT_OK_AND_ASSIGN(auto first, planner_->PlanToProto(state_, MakeQueryRequest(kQuery)));
+  ASSERT_OK_AND_ASSIGN(auto second, planner_->PlanToProto(state_, MakeQueryRequest(kQuery)));
+  EXPECT_EQ(1, planner_->plan_cache()->hits());
+  EXPECT_THAT(second, EqualsProto(first.DebugString()));
+
+  // The cached plan is the same as one planned from scratch.
+  ASSERT_OK_AND_ASSIGN(auto plan, planner_->Plan(state_, MakeQueryRequest(kQuery)));
+  plan->SetPlanOptions(state_.plan_options());
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, plan->ToProto());
+  EXPECT_THAT(second, EqualsProto(plan_pb.DebugString()));
+}
+
+TEST_F(PlanCacheLogicalPlannerTest, replans_when_state_changes) {
+  ASSERT_OK(planner_->PlanToProto(state_, MakeQueryRequest(kQuery)));
+  state_.mutable_plan_options()->set_max_output_rows_per_table(10);
+  ASSERT_OK(planner_->PlanToProto(state_, MakeQueryRequest(kQuery)));
+  EXPECT_EQ(0, planner_->plan_cache()->hits());
+  EXPECT_EQ(2, planner_->plan_cache()->misses());
+}
+
+TEST_F(PlanCacheLogicalPlannerTest, doesnt_reuse_plans_with_relative_times) {
+  ASSERT_OK(planner_->PlanToProto(state_, MakeQueryRequest(kRelativeTimeQuery)));
+  ASSERT_OK(planner_->PlanToProto(state_, MakeQueryRequest(kRelativeTimeQuery)));
+  EXPECT_EQ(0, planner_->plan_cache()->hits());
+  EXPECT_EQ(0, planner_->plan_cache()->bytes());
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -17,12 +17,20 @@
  */
 
 #pragma once
+#include <cxxabi.h>
+
+#include <chrono>
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_cat.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/rules/rules.h"
@@ -123,31 +131,50 @@ class RuleExecutor {
 
  public:
   virtual ~RuleExecutor() = default;
-  // TODO(philkuz) figure out how to collect stats on the execution.
+
+  /**
+   * Runs each rule batch until it reaches a fixed point, or its strategy stops it.
+   *
+   * The first pass over a batch applies every rule to every node. After a pass that changed the
+   * graph, the next one only visits the nodes the rules changed and their neighbors, unless a rule
+   * changed the graph without saying where (eg. it overrides Execute()) or most of the graph
+   * changed. Rules may depend on more than a node's neighbors, so a batch is only done once a
+   * pass over the whole graph changes nothing, as it would be without the tracking.
+   */
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
-      bool can_continue = true;
       int64_t iteration = 0;
+      // The nodes to visit in the next pass, or null to visit all of them.
+      std::unique_ptr<absl::flat_hash_set<int64_t>> dirty;
       // We continue executing a batch until a stop condition is met.
-      while (can_continue) {
+      while (true) {
         iteration += 1;
         bool graph_is_updated = false;
+        bool changes_untracked = false;
+        absl::flat_hash_set<int64_t> changed;
         for (const auto& rule : rb->rules()) {
-          PL_ASSIGN_OR_RETURN(bool rule_updates_graph, rule->Execute(ir_graph));
+          absl::flat_hash_set<int64_t> rule_changed;
+          PL_ASSIGN_OR_RETURN(bool rule_updates_graph,
+                              ExecuteRule(rb->name(), rule.get(), ir_graph, dirty.get(),
+                                          &rule_changed));
           graph_is_updated = graph_is_updated || rule_updates_graph;
+          changes_untracked = changes_untracked || (rule_updates_graph && rule_changed.empty());
+          changed.merge(rule_changed);
         }
         if (iteration >= rb->max_iterations() && graph_is_updated) {
           PL_RETURN_IF_ERROR(rb->MaxIterationsHandler());
           // TODO(philkuz) Reviewer: should this be a failure somehow?
-          can_continue = false;
+          break;
         }
-        // TODO(philkuz) in the future we might have a fast way to check whether the graph has
-        // changed. For now let's be lazy and leave it up to the user to make sure rules properly
-        // update.
-        // (graph_is_updated == false) => the graph has reached a fixed point and is done
         if (!graph_is_updated) {
-          can_continue = false;
+          // (graph_is_updated == false) on a full pass => the graph has reached a fixed point.
+          if (dirty == nullptr) {
+            break;
+          }
+          dirty.reset();
+          continue;
         }
+        dirty = changes_untracked ? nullptr : NodesToRevisit(ir_graph, changed);
       }
     }
     return Status::OK();
@@ -160,8 +187,70 @@ class RuleExecutor {
     return out_ptr;
   }
 
+ protected:
+  RuleExecutor() = default;
+  // Rule executions are recorded in the rule_stats() of compiler_state, if it is set.
+  explicit RuleExecutor(CompilerState* compiler_state) : stats_state_(compiler_state) {}
+
  private:
+  StatusOr<bool> ExecuteRule(const std::string& batch_name, TRule* rule, TPlan* ir_graph,
+                             const absl::flat_hash_set<int64_t>* node_filter,
+                             absl::flat_hash_set<int64_t>* changed) {
+    rule->set_node_filter(node_filter);
+    rule->set_changed_nodes(changed);
+    ir_graph->set_changed_nodes(changed);
+    auto start = std::chrono::steady_clock::now();
+    DEFER({
+      rule->set_node_filter(nullptr);
+      rule->set_changed_nodes(nullptr);
+      ir_graph->set_changed_nodes(nullptr);
+    });
+
+    auto rule_updates_graph = rule->Execute(ir_graph);
+    if (stats_state_ != nullptr) {
+      auto& stats =
+          (*stats_state_->rule_stats())[absl::StrCat(batch_name, "/", RuleName(*rule))];
+      stats.num_executions++;
+      stats.num_changes += rule_updates_graph.ok() && rule_updates_graph.ValueOrDie();
+      stats.total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    }
+    return rule_updates_graph;
+  }
+
+  // Returns the changed nodes and their neighbors, or null if that is most of the graph anyway.
+  static std::unique_ptr<absl::flat_hash_set<int64_t>> NodesToRevisit(
+      TPlan* ir_graph, const absl::flat_hash_set<int64_t>& changed) {
+    auto nodes = std::make_unique<absl::flat_hash_set<int64_t>>();
+    for (int64_t node : changed) {
+      if (!ir_graph->HasNode(node)) {
+        continue;
+      }
+      nodes->insert(node);
+      for (int64_t parent : ir_graph->dag().ParentsOf(node)) {
+        nodes->insert(parent);
+      }
+      for (int64_t child : ir_graph->dag().DependenciesOf(node)) {
+        nodes->insert(child);
+      }
+    }
+    if (2 * nodes->size() >= ir_graph->dag().nodes().size()) {
+      return nullptr;
+    }
+    return nodes;
+  }
+
+  static std::string RuleName(const TRule& rule) {
+    const char* mangled = typeid(rule).name();
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(
+        abi::__cxa_demangle(mangled, nullptr, nullptr, &status), std::free);
+    return status == 0 ? demangled.get() : mangled;
+  }
+
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
+  CompilerState* stats_state_ = nullptr;
 };
 
 }  // namespace planner
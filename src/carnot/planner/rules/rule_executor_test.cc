@@ -182,6 +182,56 @@ TEST_F(RuleExecutorTest, exit_early) {
   EXPECT_NOT_OK(executor->Execute(graph.get()));
 }
 
+// Changes the given node the first time it is visited, and counts the nodes it visits.
+class ChangeOnceRule : public Rule {
+ public:
+  ChangeOnceRule(CompilerState* compiler_state, int64_t node_to_change)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false),
+        node_to_change_(node_to_change) {}
+
+  int64_t num_visits() const { return num_visits_; }
+
+ protected:
+  StatusOr<bool> Apply(IRNode* node) override {
+    num_visits_++;
+    if (node->id() == node_to_change_ && !changed_) {
+      changed_ = true;
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  int64_t node_to_change_;
+  bool changed_ = false;
+  int64_t num_visits_ = 0;
+};
+
+class StatsExecutor : public RuleExecutor<IR> {
+ public:
+  explicit StatsExecutor(CompilerState* compiler_state) : RuleExecutor(compiler_state) {}
+};
+
+// Tests that after a pass only the changed nodes and their neighbors are revisited, until a final
+// pass over the whole graph.
+TEST_F(RuleExecutorTest, revisits_changed_nodes) {
+  StatsExecutor executor(compiler_state_.get());
+  RuleBatch* rule_batch = executor.CreateRuleBatch<FailOnMax>("resolve", 10);
+  auto rule = rule_batch->AddRule<ChangeOnceRule>(compiler_state_.get(), int_constant->id());
+  ASSERT_OK(executor.Execute(graph.get()));
+
+  // The constant and the func that uses it are revisited.
+  int64_t num_nodes = graph->dag().nodes().size();
+  EXPECT_EQ(rule->num_visits(), 2 * num_nodes + 2);
+
+  auto stats = compiler_state_->rule_stats();
+  ASSERT_EQ(1, stats->size());
+  EXPECT_EQ(3, stats->begin()->second.num_executions);
+  EXPECT_EQ(1, stats->begin()->second.num_changes);
+  EXPECT_THAT(stats->begin()->first, ::testing::StartsWith("resolve/"));
+  EXPECT_THAT(stats->begin()->first, ::testing::HasSubstr("ChangeOnceRule"));
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
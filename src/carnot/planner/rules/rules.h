@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -65,7 +66,30 @@ class BaseRule {
     return any_changed;
   }
 
+  /**
+   * While set, the default Execute() only applies the rule to these nodes. Rules that override
+   * Execute() may ignore it and visit the whole graph, which is always correct.
+   */
+  void set_node_filter(const absl::flat_hash_set<int64_t>* node_filter) {
+    node_filter_ = node_filter;
+  }
+  /**
+   * While set, the default Execute() adds the nodes that Apply() changes to changed_nodes.
+   */
+  void set_changed_nodes(absl::flat_hash_set<int64_t>* changed_nodes) {
+    changed_nodes_ = changed_nodes;
+  }
+
  protected:
+  bool ShouldVisit(int64_t node) const {
+    return node_filter_ == nullptr || node_filter_->contains(node);
+  }
+  void MarkChanged(int64_t node) {
+    if (changed_nodes_ != nullptr) {
+      changed_nodes_->insert(node);
+    }
+  }
+
   StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
     bool any_changed = false;
     std::vector<int64_t> topo_graph = graph->dag().TopologicalSort();
@@ -74,10 +98,13 @@ class BaseRule {
     }
     for (int64_t node_i : topo_graph) {
       // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
+      if (!graph->HasNode(node_i) || !ShouldVisit(node_i)) {
         continue;
       }
       PL_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        MarkChanged(node_i);
+      }
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
@@ -90,10 +117,13 @@ class BaseRule {
     auto nodes = graph->dag().nodes();
     for (int64_t node_i : nodes) {
       // The node may have been deleted by a prior call to Apply on a parent or child node.
-      if (!graph->HasNode(node_i)) {
+      if (!graph->HasNode(node_i) || !ShouldVisit(node_i)) {
         continue;
       }
       PL_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        MarkChanged(node_i);
+      }
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
@@ -125,6 +155,8 @@ class BaseRule {
   CompilerState* compiler_state_;
   bool use_topo_;
   bool reverse_topological_execution_;
+  const absl::flat_hash_set<int64_t>* node_filter_ = nullptr;
+  absl::flat_hash_set<int64_t>* changed_nodes_ = nullptr;
 };
 
 using Rule = BaseRule<IR>;
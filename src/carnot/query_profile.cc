@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/query_profile.h"
+
+#include <absl/strings/str_format.h>
+
+#include "src/common/base/base.h"
+#include "src/common/uuid/uuid_utils.h"
+
+namespace px {
+namespace carnot {
+
+std::string RenderQueryProfile(const std::vector<queryresultspb::AgentExecutionStats>& agents) {
+  std::string out;
+  for (const auto& agent : agents) {
+    auto agent_id = ParseUUID(agent.agent_id());
+    absl::StrAppendFormat(&out, "Agent %s: %s, %d records and %d bytes processed, peak memory %d\n",
+                          agent_id.ok() ? agent_id.ConsumeValueOrDie().str() : "<unknown>",
+                          PrettyDuration(agent.execution_time_ns()), agent.records_processed(),
+                          agent.bytes_processed(), agent.memory_peak_bytes());
+    if (agent.operator_execution_stats().empty()) {
+      continue;
+    }
+    absl::StrAppendFormat(&out, "  %-8s %-6s %-12s %-12s %-12s %-12s %-12s %-12s %s\n",
+                          "fragment", "node", "self_time", "total_time", "wait_time", "records",
+                          "bytes", "memory_peak", "operator");
+    for (const auto& op : agent.operator_execution_stats()) {
+      absl::StrAppendFormat(&out, "  %-8d %-6d %-12s %-12s %-12s %-12d %-12d %-12d %s\n",
+                            op.plan_fragment_id(), op.node_id(),
+                            PrettyDuration(op.self_execution_time_ns()),
+                            PrettyDuration(op.total_execution_time_ns()),
+                            PrettyDuration(op.wait_time_ns()), op.records_output(),
+                            op.bytes_output(), op.memory_peak_bytes(), op.operator_description());
+    }
+  }
+  return out;
+}
+
+}  // namespace carnot
+}  // namespace px
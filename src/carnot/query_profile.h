@@ -0,0 +1,36 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/queryresultspb/query_results.pb.h"
+
+namespace px {
+namespace carnot {
+
+/**
+ * Renders the per operator stats of the agents of an analyzed query, as one table per agent with
+ * the operators in the order that they were run.
+ */
+std::string RenderQueryProfile(const std::vector<queryresultspb::AgentExecutionStats>& agents);
+
+}  // namespace carnot
+}  // namespace px
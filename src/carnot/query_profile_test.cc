@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <google/protobuf/text_format.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/query_profile.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+
+using ::testing::HasSubstr;
+
+TEST(RenderQueryProfileTest, one_row_per_operator) {
+  std::vector<queryresultspb::AgentExecutionStats> agents(2);
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(R"(
+    agent_id { high_bits: 1 low_bits: 2 }
+    execution_time_ns: 2000000
+    records_processed: 10
+    memory_peak_bytes: 4096
+    operator_execution_stats {
+      plan_fragment_id: 0
+      node_id: 1
+      records_output: 10
+      self_execution_time_ns: 1000
+      total_execution_time_ns: 3000
+      operator_description: "Op:MemorySource (id=1)"
+    }
+    operator_execution_stats {
+      plan_fragment_id: 0
+      node_id: 2
+      operator_description: "Op:GRPCSink (id=2)"
+    })",
+                                                            &agents[0]));
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(R"(
+    execution_time_ns: 5000000
+    operator_execution_stats {
+      plan_fragment_id: 1
+      node_id: 3
+      wait_time_ns: 4000000
+      operator_description: "Op:GRPCSource (id=3)"
+    })",
+                                                            &agents[1]));
+
+  std::string profile = RenderQueryProfile(agents);
+  EXPECT_THAT(profile, HasSubstr("2.00 ms, 10 records and 0 bytes processed, peak memory 4096"));
+  EXPECT_THAT(profile, HasSubstr("Op:MemorySource (id=1)"));
+  EXPECT_THAT(profile, HasSubstr("Op:GRPCSink (id=2)"));
+  EXPECT_THAT(profile, HasSubstr("4.00 ms"));
+  EXPECT_THAT(profile, HasSubstr("Op:GRPCSource (id=3)"));
+  EXPECT_LT(profile.find("Op:GRPCSink"), profile.find("Op:GRPCSource"));
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -19,8 +19,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <typeindex>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_set.h>
+
 #include "src/carnot/exec/ml/model_pool.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
@@ -29,6 +35,45 @@ namespace px {
 namespace carnot {
 namespace udf {
 
+/**
+ * StringInterner keeps a single copy of each distinct string given to it. Funcs whose outputs
+ * repeat heavily, such as the metadata UDFs, use it to hand out views of shared strings instead
+ * of building a new string for every row. The funcs of an exec node share one interner, through
+ * FunctionContext::SharedState<StringInterner>(), for the lifetime of the query.
+ */
+class StringInterner {
+ public:
+  /**
+   * Returns a view of the stored copy of s. The views stay valid until the interner outgrows
+   * kMaxBytes and is reset, which bumps generation(), so holders of views must check it.
+   */
+  std::string_view Intern(std::string_view s) {
+    auto it = values_.find(s);
+    if (it != values_.end()) {
+      return *it;
+    }
+    if (bytes_ + static_cast<int64_t>(s.size()) > kMaxBytes) {
+      values_.clear();
+      bytes_ = 0;
+      ++generation_;
+    }
+    bytes_ += s.size();
+    return *values_.emplace(s).first;
+  }
+
+  uint64_t generation() const { return generation_; }
+  size_t size() const { return values_.size(); }
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  static constexpr int64_t kMaxBytes = 16 * 1024 * 1024;
+
+  // Node based, so that the stored strings don't move when the set grows.
+  absl::node_hash_set<std::string> values_;
+  int64_t bytes_ = 0;
+  uint64_t generation_ = 0;
+};
+
 /**
  * Function context contains contextual resources such as mempools that functions
  * can use while executing.
@@ -41,9 +86,24 @@ class FunctionContext {
   const px::md::AgentMetadataState* metadata_state() const { return metadata_state_.get(); }
   exec::ml::ModelPool* model_pool() { return model_pool_; }
 
+  /**
+   * Returns the state of type T shared by all the functions that run with this context, creating
+   * it on first use. Each exec node has its own context, so funcs can use this to share work,
+   * such as parsed inputs, with the other funcs of the node.
+   */
+  template <typename T>
+  T* SharedState() {
+    auto& state = shared_state_[std::type_index(typeid(T))];
+    if (state == nullptr) {
+      state = std::make_shared<T>();
+    }
+    return static_cast<T*>(state.get());
+  }
+
  private:
   std::shared_ptr<const px::md::AgentMetadataState> metadata_state_;
   exec::ml::ModelPool* model_pool_;
+  absl::flat_hash_map<std::type_index, std::shared_ptr<void>> shared_state_;
 };
 
 /**
@@ -74,6 +74,17 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * UDFs can also implement:
+ *      void ExecBatch(FunctionContext *ctx, size_t count, UDFValue* out, const UDFValue*... args)
+ *  This is called instead of Exec for batches of column data, and produces the same results as
+ *  calling Exec on each row. Arithmetic UDFs should implement it with ExecBatchKernel, while
+ *  lookups can use it to resolve repeated inputs once.
+ *
+ * UDFs that return strings can also implement:
+ *      std::string_view ExecView(FunctionContext *ctx, UDFValue... args)
+ *  This is called instead of Exec when writing arrow arrays. It returns the same value as Exec,
+ *  as a view that must stay valid until the next call, such as one of a StringInterner.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -167,6 +178,20 @@ struct has_udf_executor_fn<T, std::void_t<decltype(&T::Executor)>> : std::true_t
       "If an executor function exists, it must have the form: UDFSourceExecutor Executor()");
 };
 
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
+// SFINAE test for ExecView fn.
+template <typename T, typename = void>
+struct has_udf_exec_view_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_view_fn<T, std::void_t<decltype(&T::ExecView)>> : std::true_type {};
+
 template <typename T, typename = void>
 struct check_executor_fn {};
 
@@ -228,6 +253,18 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has an ExecBatch function.
+   * @return true if it has an ExecBatch function.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
+  /**
+   * Checks if the UDF has an ExecView function.
+   * @return true if it has an ExecView function.
+   */
+  static constexpr bool HasExecView() { return has_udf_exec_view_fn<T>::value; }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
@@ -250,6 +287,25 @@ class ScalarUDFTraits {
   } check_;
 };
 
+/**
+ * Runs a UDF's Exec over a batch of rows. The output and inputs are raw column data that
+ * never alias each other, so when Exec inlines to simple arithmetic or a comparison the
+ * compiler is free to vectorize the loop.
+ *
+ * @param udf the UDF whose Exec is called on each row.
+ * @param ctx The function context.
+ * @param count The number of rows in out and each of args.
+ * @param out Pointer to the start of the output.
+ * @param args Pointers to the start of each input column.
+ */
+template <typename TUDF, typename TReturn, typename... TArgs>
+inline void ExecBatchKernel(TUDF* udf, FunctionContext* ctx, size_t count,
+                            TReturn* __restrict out, const TArgs* __restrict... args) {
+  for (size_t idx = 0; idx < count; ++idx) {
+    out[idx] = udf->Exec(ctx, args[idx]...);
+  }
+}
+
 /**
  * These are function type checkers for UDAs. Ideally these would all be pure
  * SFINAE templates, but the overload makes the code a bit easier to read.
@@ -51,6 +51,20 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class BatchAddUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  void ExecBatch(FunctionContext* ctx, size_t count, types::Int64Value* out,
+                 const types::Int64Value* v1, const types::Int64Value* v2) {
+    ++exec_batch_calls;
+    ExecBatchKernel(this, ctx, count, out, v1, v2);
+  }
+
+  int exec_batch_calls = 0;
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -99,6 +113,23 @@ TEST(UDFDefinition, two_args) {
   EXPECT_EQ(8, out[2].val);
 }
 
+TEST(UDFDefinition, exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("add");
+  EXPECT_OK(def.Init<BatchAddUDF>());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({3, 4, 5});
+
+  types::Int64ValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_TRUE(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()).ok());
+  EXPECT_EQ(1, static_cast<BatchAddUDF*>(u.get())->exec_batch_calls);
+  EXPECT_EQ(4, out[0].val);
+  EXPECT_EQ(6, out[1].val);
+  EXPECT_EQ(8, out[2].val);
+}
+
 TEST(UDFDefinition, str_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("substr");
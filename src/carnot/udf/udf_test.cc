@@ -247,6 +247,32 @@ TEST(StringValue, value_tests) {
   EXPECT_TRUE(base_type_check);
 }
 
+TEST(StringInterner, returns_shared_copies) {
+  StringInterner interner;
+  std::string s1 = "pl/vizier-query-broker";
+  std::string s2 = "pl/vizier-query-broker";
+  auto v1 = interner.Intern(s1);
+  auto v2 = interner.Intern(s2);
+  EXPECT_EQ(v1, "pl/vizier-query-broker");
+  EXPECT_EQ(v1.data(), v2.data());
+  EXPECT_NE(v1.data(), s1.data());
+  EXPECT_NE(interner.Intern("pl/kelvin"), v1);
+  EXPECT_EQ(interner.size(), 2);
+  EXPECT_EQ(interner.bytes(), s1.size() + std::string_view("pl/kelvin").size());
+  EXPECT_EQ(interner.generation(), 0);
+}
+
+class ScalarUDFWithExecView : ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::Int64Value) { return ""; }
+  std::string_view ExecView(FunctionContext*, types::Int64Value) { return ""; }
+};
+
+TEST(ScalarUDF, exec_view) {
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasExecView());
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDFWithExecView>::HasExecView());
+}
+
 }  // namespace udf
 }  // namespace carnot
 }  // namespace px
@@ -68,6 +68,21 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
   return Status::OK();
 }
 
+/**
+ * This is the inner wrapper for UDFs that implement ExecBatch. It casts each input once and
+ * passes the whole batch to the UDF, instead of calling Exec for each row.
+ *
+ * @return Status of execution.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                        const std::vector<const types::BaseValueType*>& args,
+                        std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  udf->ExecBatch(ctx, count, out, CastToUDFValueType<exec_argument_types[I]>(args[I])...);
+  return Status::OK();
+}
+
 template <typename TUDF, std::size_t... I>
 Status InitWrapper(TUDF* udf, FunctionContext* ctx,
                    const std::vector<std::shared_ptr<types::BaseValueType>>& args,
@@ -104,6 +119,9 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
                         const std::vector<arrow::Array*>& args, std::index_sequence<I...>) {
   [[maybe_unused]] static constexpr auto exec_argument_types =
       ScalarUDFTraits<TUDF>::ExecArguments();
+  static_assert(!ScalarUDFTraits<TUDF>::HasExecView() ||
+                    std::is_same_v<arrow::StringBuilder, TOutput>,
+                "ExecView is only supported by UDFs that return strings");
   CHECK(out->Reserve(count).ok());
   size_t reserved = count * kStringAssumedSizeHeuristic;
   size_t total_size = 0;
@@ -114,8 +132,16 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
     CHECK(out->ReserveData(reserved).ok());
   }
   for (size_t idx = 0; idx < count; ++idx) {
-    auto res = UnWrap(
-        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+    auto res = [&]() {
+      // ExecView saves building a string for every row, when the UDF already holds its outputs.
+      if constexpr (ScalarUDFTraits<TUDF>::HasExecView()) {
+        return udf->ExecView(
+            ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...);
+      } else {
+        return UnWrap(udf->Exec(
+            ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+      }
+    }();
 
     // We use doubling to make sure we minimize the number of allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
@@ -127,7 +153,11 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
       }
     }
     // This function is "safe" now because we manually allocated memory.
-    out->UnsafeAppend(res);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecView()) {
+      out->UnsafeAppend(res.data(), static_cast<int32_t>(res.size()));
+    } else {
+      out->UnsafeAppend(res);
+    }
   }
   return Status::OK();
 }
@@ -241,6 +271,11 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                    input_as_base_value,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    }
     return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
                              input_as_base_value,
                              std::make_index_sequence<exec_argument_types.size()>{});
@@ -405,6 +440,44 @@ struct UDAWrapper {
     return Status::OK();
   }
 
+  /**
+   * Serializes the partial state of the UDA, so it can be merged on another node.
+   * @return Status of the serialize.
+   */
+  template <typename Q = TUDA, std::enable_if_t<UDATraits<Q>::SupportsPartial(), void>* = nullptr>
+  static Status SerializeImpl(UDA* uda, FunctionContext* ctx, types::StringValue* output) {
+    *output = static_cast<TUDA*>(uda)->Serialize(ctx);
+    return Status::OK();
+  }
+
+  template <typename Q = TUDA, std::enable_if_t<!UDATraits<Q>::SupportsPartial(), void>* = nullptr>
+  static Status SerializeImpl(UDA*, FunctionContext*, types::StringValue*) {
+    return error::Unimplemented("UDA does not support partial aggregation");
+  }
+
+  static Status Serialize(UDA* uda, FunctionContext* ctx, types::StringValue* output) {
+    DCHECK(output != nullptr);
+    return SerializeImpl(uda, ctx, output);
+  }
+
+  /**
+   * Restores the partial state of the UDA from the output of Serialize.
+   * @return Status of the deserialize.
+   */
+  template <typename Q = TUDA, std::enable_if_t<UDATraits<Q>::SupportsPartial(), void>* = nullptr>
+  static Status DeserializeImpl(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    return static_cast<TUDA*>(uda)->Deserialize(ctx, data);
+  }
+
+  template <typename Q = TUDA, std::enable_if_t<!UDATraits<Q>::SupportsPartial(), void>* = nullptr>
+  static Status DeserializeImpl(UDA*, FunctionContext*, const types::StringValue&) {
+    return error::Unimplemented("UDA does not support partial aggregation");
+  }
+
+  static Status Deserialize(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    return DeserializeImpl(uda, ctx, data);
+  }
+
   /**
    * Finalize the UDA into an arrow builder. The arrow builder needs to be correct type
    * for the finalize return type.
@@ -467,8 +540,14 @@ struct UDTFWrapper {
     return Status::OK();
   }
 
+  /**
+   * Generates a batch of up to max_gen_records records, which ends early once max_gen_bytes of
+   * output have been written, if max_gen_bytes is not 0.
+   * @return true if the UDTF has more records.
+   */
   static bool ExecBatchUpdate(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
-                              std::vector<arrow::ArrayBuilder*>* outputs) {
+                              std::vector<arrow::ArrayBuilder*>* outputs,
+                              int64_t max_gen_bytes = 0) {
     if (max_gen_records == 0) {
       return false;
     }
@@ -479,12 +558,24 @@ struct UDTFWrapper {
     }
 
     auto* u = static_cast<TUDTF*>(udtf);
-    int count = 0;
     bool more = true;
-    RecordWriterProxy<TUDTF> rw(outputs);
-    while (count < max_gen_records && more) {
-      more = u->NextRecord(ctx, &rw);
-      ++count;
+    RecordWriterProxy<TUDTF> rw(outputs, max_gen_records, max_gen_bytes);
+    if constexpr (UDTFTraits<TUDTF>::HasNextBatchFn()) {
+      while (more && !rw.BatchFull()) {
+        int64_t records_before = rw.records_written();
+        more = u->NextBatch(ctx, &rw);
+        // Leave the UDTF to be called again with the next batch, rather than spin on it here.
+        if (rw.records_written() == records_before) {
+          break;
+        }
+      }
+    } else {
+      int count = 0;
+      while (count < max_gen_records && more &&
+             (max_gen_bytes == 0 || rw.bytes_written() < max_gen_bytes)) {
+        more = u->NextRecord(ctx, &rw);
+        ++count;
+      }
     }
     return more;
   }
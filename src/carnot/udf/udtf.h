@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -254,6 +255,11 @@ class UDTFTraits {
    */
   static constexpr bool HasNextRecordFn() { return NextRecordFnHelper<TUDTF>::value; }
 
+  /**
+   * Checks to see if NextBatch() exists.
+   */
+  static constexpr bool HasNextBatchFn() { return NextBatchFnHelper<TUDTF>::value; }
+
   template <typename Q = TUDTF, std::enable_if_t<UDTFTraits<Q>::HasInitArgsFn(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return Q::InitArgs();
@@ -373,16 +379,33 @@ class UDTFTraits {
   struct NextRecordFnHelper<
       T, std::void_t<decltype (&T::NextRecord)(FunctionContext*, typename T::RecordWriter*)>>
       : std::true_type {};
+
+  template <typename T, typename = void>
+  struct NextBatchFnHelper : std::false_type {};
+
+  template <typename T>
+  struct NextBatchFnHelper<
+      T, std::void_t<decltype (&T::NextBatch)(FunctionContext*, typename T::RecordWriter*)>>
+      : std::true_type {};
 };
 
 /**
  * RecordWriterProxy is used to write output records for the UDTF.
+ *
+ * The writer carries the size target of the batch being generated: UDTFs that write many records
+ * per call (see NextBatch()) should stop once BatchFull() is true.
  * @tparam TUDTF The UDTF class.
  */
 template <typename TUDTF>
 class RecordWriterProxy final {
  public:
-  explicit RecordWriterProxy(std::vector<arrow::ArrayBuilder*>* outputs) : outputs_(outputs) {
+  /**
+   * @param max_records The target number of records of the batch, or no target if 0.
+   * @param max_bytes The target number of output bytes of the batch, or no target if 0.
+   */
+  explicit RecordWriterProxy(std::vector<arrow::ArrayBuilder*>* outputs, int64_t max_records = 0,
+                             int64_t max_bytes = 0)
+      : outputs_(outputs), max_records_(max_records), max_bytes_(max_bytes) {
     CHECK(outputs != nullptr);
   }
 
@@ -408,6 +431,24 @@ class RecordWriterProxy final {
         val);
   }
 
+  /**
+   * The number of records written so far.
+   */
+  int64_t records_written() const { return outputs_->empty() ? 0 : (*outputs_)[0]->length(); }
+
+  /**
+   * The approximate number of bytes written so far, counting the data of strings.
+   */
+  int64_t bytes_written() const { return bytes_written_; }
+
+  /**
+   * Whether the batch has reached its size target.
+   */
+  bool BatchFull() const {
+    return (max_records_ > 0 && records_written() >= max_records_) ||
+           (max_bytes_ > 0 && bytes_written_ >= max_bytes_);
+  }
+
   // Compile time function to get the index for a column with the specified name.
   static constexpr size_t ColIdx(std::string_view col_name) {
     constexpr auto col_names = UDTFTraits<TUDTF>::OutputRelationNames();
@@ -425,7 +466,11 @@ class RecordWriterProxy final {
  private:
   template <typename T, typename ValueType>
   void AppendToBuilder(T* builder, ValueType v) {
-    DCHECK(builder->length() < builder->capacity());
+    // Space is reserved for the target number of records up front, but UDTFs that write batches
+    // may overshoot it.
+    if (builder->length() >= builder->capacity()) {
+      CHECK(builder->Reserve(std::max<int64_t>(builder->capacity(), 1)).ok());
+    }
     // If it's a string type we also need to allocate memory for the data.
     // This actually applies to all non-fixed data allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
@@ -433,8 +478,10 @@ class RecordWriterProxy final {
       [[maybe_unused]] bool res = builder->ReserveData(v.size()).ok();
       DCHECK(res);
       builder->UnsafeAppend(v);
+      bytes_written_ += v.size();
     } else {
       builder->UnsafeAppend(v.val);
+      bytes_written_ += sizeof(v.val);
     }
   }
   // Returns true if all cols have the same length.
@@ -456,6 +503,9 @@ class RecordWriterProxy final {
   }
 
   std::vector<arrow::ArrayBuilder*>* outputs_;
+  const int64_t max_records_;
+  const int64_t max_bytes_;
+  int64_t bytes_written_ = 0;
 };
 
 template <typename T>
@@ -483,10 +533,10 @@ struct UDTFChecker {
   // Check that Executor exists and returns the executor type.
   static_assert(TR::HasExecutorFn(), "UDTF must have an Executor() func");
   static_assert(TR::HasCorrectExectorFnReturnType(), "Executor() must return UDTFSourceExecutor");
-  // Check that NextRecord exists and is well formed.
-  static_assert(
-      TR::HasNextRecordFn(),
-      "UDTF must have NextRecord func of form NextRecord(FunctionContext, RecordWriterProxy*)");
+  // Check that NextRecord or NextBatch exists and is well formed.
+  static_assert(TR::HasNextRecordFn() || TR::HasNextBatchFn(),
+                "UDTF must have NextRecord or NextBatch func of form "
+                "NextRecord(FunctionContext, RecordWriterProxy*)");
 };
 
 /**
@@ -531,6 +581,17 @@ struct UDTFChecker {
  *     int64_t count_ = 0;
  *   }
  *
+ * UDTFs that produce many records can instead write a whole batch per call, which saves a call
+ * per record. NextBatch is called until it returns false, and should return once the writer is
+ * full:
+ *
+ *     bool NextBatch(FunctionContext *, RecordWriter *rw) {
+ *       for (; count_ < max_count_ && !rw->BatchFull(); ++count_) {
+ *         rw->Append<IndexOf("out")>(outstr_);
+ *       }
+ *       return count_ < max_count_;
+ *     }
+ *
  * @tparam Derived The name of the derived class.
  */
 template <typename Derived>
@@ -184,6 +184,72 @@ TEST(BasicUDTFOneCol, can_run) {
   EXPECT_EQ(out->GetString(1), "abc 2");
 }
 
+class BatchUDTF : public UDTF<BatchUDTF> {
+ public:
+  static constexpr auto Executor() { return udfspb::UDTFSourceExecutor::UDTF_ALL_AGENTS; }
+
+  static constexpr auto OutputRelation() {
+    return MakeArray(
+        ColInfo("out_str", types::DataType::STRING, types::PatternType::GENERAL, "string result"));
+  }
+
+  bool NextBatch(FunctionContext*, RecordWriter* rw) {
+    for (; idx_ < kNumRecords && !rw->BatchFull(); ++idx_) {
+      rw->Append<IndexOf("out_str")>(std::string(10, 'a'));
+    }
+    return idx_ < kNumRecords;
+  }
+
+  static constexpr int kNumRecords = 25;
+
+ private:
+  int idx_ = 0;
+};
+
+TEST(BatchUDTF, batches_by_records_and_bytes) {
+  constexpr BatchUDTF::Checker check;
+  PL_UNUSED(check);
+  EXPECT_TRUE(UDTFTraits<BatchUDTF>::HasNextBatchFn());
+  EXPECT_FALSE(UDTFTraits<BatchUDTF>::HasNextRecordFn());
+
+  UDTFWrapper<BatchUDTF> wrapper;
+  auto u = wrapper.Make();
+  ASSERT_NE(u, nullptr);
+  EXPECT_OK(wrapper.Init(u.get(), nullptr, {}));
+
+  auto batch_size = [&](int max_records, int64_t max_bytes, bool* more) {
+    arrow::StringBuilder string_builder(0);
+    std::vector<arrow::ArrayBuilder*> outs{&string_builder};
+    *more = wrapper.ExecBatchUpdate(u.get(), nullptr, max_records, &outs, max_bytes);
+    return string_builder.length();
+  };
+
+  bool more = false;
+  // Limited by the record target.
+  EXPECT_EQ(batch_size(8, 0, &more), 8);
+  EXPECT_TRUE(more);
+  // Limited by the byte target, of 10 bytes per record.
+  EXPECT_EQ(batch_size(100, 45, &more), 5);
+  EXPECT_TRUE(more);
+  // The rest.
+  EXPECT_EQ(batch_size(100, 0, &more), 12);
+  EXPECT_FALSE(more);
+}
+
+TEST(BasicUDTFOneCol, byte_target) {
+  UDTFWrapper<BasicUDTFOneCol> wrapper;
+  types::Int64Value init1 = 1337;
+  types::StringValue init2 = "abc";
+  auto u = wrapper.Make();
+  EXPECT_OK(wrapper.Init(u.get(), nullptr, {&init1, &init2}));
+
+  arrow::StringBuilder string_builder(0);
+  std::vector<arrow::ArrayBuilder*> outs{&string_builder};
+  // The first record alone reaches the byte target.
+  EXPECT_TRUE(wrapper.ExecBatchUpdate(u.get(), nullptr, 100, &outs, 1));
+  EXPECT_EQ(string_builder.length(), 1);
+}
+
 class BasicUDTFTwoColBad : public UDTF<BasicUDTFTwoColBad> {
  public:
   static constexpr auto Executor() { return udfspb::UDTFSourceExecutor::UDTF_ALL_AGENTS; }
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/base/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace px {
+
+void* Arena::Allocate(size_t bytes, size_t alignment) {
+  void* ptr = blocks_.empty() ? nullptr : TryAllocate(bytes, alignment);
+  if (ptr == nullptr) {
+    // Reserve enough for the worst-case alignment padding, so the new block always fits.
+    AddBlock(bytes + alignment);
+    ptr = TryAllocate(bytes, alignment);
+  }
+  bytes_used_ += bytes;
+  return ptr;
+}
+
+void* Arena::TryAllocate(size_t bytes, size_t alignment) {
+  const Block& block = blocks_.back();
+  auto base = reinterpret_cast<uintptr_t>(block.data.get());
+  uintptr_t addr = (base + offset_ + alignment - 1) & ~(alignment - 1);
+  if (addr + bytes > base + block.size) {
+    return nullptr;
+  }
+  offset_ = (addr - base) + bytes;
+  return reinterpret_cast<void*>(addr);
+}
+
+void Arena::AddBlock(size_t min_size) {
+  // Grow geometrically, so that a burst of allocations needs few blocks.
+  size_t size = std::max(min_size, blocks_.empty() ? block_size_ : 2 * blocks_.back().size);
+  blocks_.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+  bytes_reserved_ += size;
+  offset_ = 0;
+}
+
+void Arena::Reset() {
+  if (blocks_.size() > 1) {
+    // Keep only the first block, so that memory from an occasional burst is returned.
+    Block first = std::move(blocks_.front());
+    blocks_.clear();
+    bytes_reserved_ = first.size;
+    blocks_.push_back(std::move(first));
+  }
+  offset_ = 0;
+  bytes_used_ = 0;
+}
+
+}  // namespace px
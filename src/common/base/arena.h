@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "src/common/base/mixins.h"
+
+namespace px {
+
+/**
+ * A bump allocator for objects that share a lifetime.
+ *
+ * Individual allocations are never freed. Instead, all of them are released at once by Reset(),
+ * which keeps the first block around so that steady-state use does not touch the heap at all.
+ * Not thread-safe.
+ */
+class Arena : public NotCopyMoveable {
+ public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+  /**
+   * Returns memory for `bytes` bytes, aligned to `alignment`, which must be a power of 2.
+   */
+  void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * Releases all allocations. Any memory previously returned by Allocate() must no longer be used.
+   */
+  void Reset();
+
+  /**
+   * Bytes handed out by Allocate() since the last Reset().
+   */
+  size_t bytes_used() const { return bytes_used_; }
+
+  /**
+   * Bytes currently held from the heap, whether used or not.
+   */
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  // Allocates from the last block, or returns nullptr if it doesn't have enough space.
+  void* TryAllocate(size_t bytes, size_t alignment);
+  void AddBlock(size_t min_size);
+
+  const size_t block_size_;
+  std::vector<Block> blocks_;
+  // Offset of the next free byte in the last block.
+  size_t offset_ = 0;
+  size_t bytes_used_ = 0;
+  size_t bytes_reserved_ = 0;
+};
+
+/**
+ * An STL allocator backed by an Arena. Deallocation is a no-op; memory is reclaimed by
+ * Arena::Reset().
+ *
+ * A default-constructed ArenaAllocator has no arena and falls back to the heap, so containers
+ * using it behave like regular containers unless an arena is explicitly provided.
+ * Copies of containers are always placed on the heap, since they may outlive the arena.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() = default;
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT: runtime/explicit
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == nullptr) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (arena_ == nullptr) {
+      std::allocator<T>().deallocate(p, n);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return !(a == b);
+}
+
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/common/base/arena.h"
+
+namespace px {
+
+TEST(ArenaTest, AllocateAndReset) {
+  Arena arena(64);
+  EXPECT_EQ(arena.bytes_reserved(), 0);
+
+  void* a = arena.Allocate(10, 1);
+  void* b = arena.Allocate(8, 8);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0);
+  EXPECT_EQ(arena.bytes_used(), 18);
+
+  // Larger than a block.
+  void* c = arena.Allocate(1000);
+  EXPECT_NE(c, nullptr);
+  EXPECT_GT(arena.bytes_reserved(), 1000);
+
+  arena.Reset();
+  EXPECT_EQ(arena.bytes_used(), 0);
+  EXPECT_LT(arena.bytes_reserved(), 1000);
+
+  // The retained block is reused.
+  size_t reserved = arena.bytes_reserved();
+  arena.Allocate(10, 1);
+  EXPECT_EQ(arena.bytes_reserved(), reserved);
+}
+
+TEST(ArenaTest, Alignment) {
+  Arena arena(256);
+  for (size_t alignment : {1, 2, 4, 8, 16, 32, 64}) {
+    arena.Allocate(1, 1);
+    void* p = arena.Allocate(3, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignment, 0) << alignment;
+  }
+}
+
+TEST(ArenaAllocatorTest, Containers) {
+  using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+  Arena arena;
+  std::vector<ArenaString, ArenaAllocator<ArenaString>> v{ArenaAllocator<ArenaString>(&arena)};
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(std::string(100, 'a' + i % 26), ArenaAllocator<char>(&arena));
+  }
+  EXPECT_GE(arena.bytes_used(), 100 * 100);
+  EXPECT_EQ(std::string_view(v[27]), std::string(100, 'b'));
+
+  // Copies are not placed on the arena.
+  size_t used = arena.bytes_used();
+  auto copy = v;
+  EXPECT_EQ(copy.get_allocator().arena(), nullptr);
+  EXPECT_EQ(arena.bytes_used(), used);
+  EXPECT_EQ(copy, v);
+}
+
+TEST(ArenaAllocatorTest, NullArenaUsesHeap) {
+  std::map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int>>> m;
+  m[1] = 2;
+  m[3] = 4;
+  EXPECT_EQ(m.size(), 2);
+  m.erase(1);
+  EXPECT_EQ(m.at(3), 4);
+}
+
+}  // namespace px
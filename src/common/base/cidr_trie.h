@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include "src/common/base/inet_utils.h"
+#include "src/common/base/logging.h"
+
+namespace px {
+
+/**
+ * A binary trie keyed by IP address bits, which maps CIDR blocks to values. A single address is
+ * a /32 (or /128) block, so the same trie answers both exact and longest prefix match lookups,
+ * without formatting or parsing addresses as strings.
+ *
+ * IPv4 and IPv4-mapped IPv6 addresses are treated alike, as CIDRContainsIPAddr does.
+ */
+template <typename TValue>
+class CIDRTrie {
+ public:
+  /**
+   * Inserts the block, replacing its value if it's already in the trie.
+   */
+  void Insert(const CIDRBlock& block, TValue value) {
+    Key key = BlockKey(block);
+    std::vector<Node>* nodes = key.ipv4 ? &ipv4_nodes_ : &ipv6_nodes_;
+    uint32_t idx = 0;
+    for (size_t i = 0; i < key.prefix_length; ++i) {
+      uint32_t child = (*nodes)[idx].children[Bit(key.bytes, i)];
+      if (child == 0) {
+        child = static_cast<uint32_t>(nodes->size());
+        (*nodes)[idx].children[Bit(key.bytes, i)] = child;
+        nodes->emplace_back();
+      }
+      idx = child;
+    }
+    if (!(*nodes)[idx].value.has_value()) {
+      ++size_;
+    }
+    (*nodes)[idx].value = std::move(value);
+  }
+
+  /**
+   * Returns the value of exactly this block, or nullptr if it's not in the trie.
+   */
+  const TValue* Find(const CIDRBlock& block) const {
+    Key key = BlockKey(block);
+    const std::vector<Node>& nodes = key.ipv4 ? ipv4_nodes_ : ipv6_nodes_;
+    uint32_t idx = 0;
+    for (size_t i = 0; i < key.prefix_length; ++i) {
+      idx = nodes[idx].children[Bit(key.bytes, i)];
+      if (idx == 0) {
+        return nullptr;
+      }
+    }
+    return nodes[idx].value.has_value() ? &nodes[idx].value.value() : nullptr;
+  }
+
+  /**
+   * Returns the value of the most specific block that contains the address, or nullptr if no
+   * block does.
+   */
+  const TValue* LongestPrefixMatch(const InetAddr& addr) const {
+    if (addr.family == InetAddrFamily::kUnspecified) {
+      return nullptr;
+    }
+    Key key = AddrKey(addr);
+    if (!key.ipv4) {
+      return Match(ipv6_nodes_, key.bytes, key.prefix_length);
+    }
+    if (const TValue* match = Match(ipv4_nodes_, key.bytes, key.prefix_length); match != nullptr) {
+      return match;
+    }
+    // IPv6 blocks shorter than /96 can still contain the IPv4-mapped form of the address.
+    std::array<uint8_t, 16> mapped = {};
+    mapped[10] = 0xff;
+    mapped[11] = 0xff;
+    std::memcpy(&mapped[12], key.bytes.data(), 4);
+    return Match(ipv6_nodes_, mapped, kIPv6Bits);
+  }
+
+  bool Contains(const InetAddr& addr) const { return LongestPrefixMatch(addr) != nullptr; }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr size_t kIPv4Bits = 32;
+  static constexpr size_t kIPv6Bits = 128;
+  static constexpr size_t kIPv4MappedPrefixBits = 96;
+
+  struct Node {
+    // Index 0 is the root, so it doubles as "no child".
+    uint32_t children[2] = {0, 0};
+    std::optional<TValue> value;
+  };
+
+  // The bits of an address or block, most significant first, and which trie they belong to.
+  struct Key {
+    bool ipv4 = false;
+    std::array<uint8_t, 16> bytes = {};
+    size_t prefix_length = 0;
+  };
+
+  static bool Bit(const std::array<uint8_t, 16>& bytes, size_t i) {
+    return (bytes[i / 8] >> (7 - i % 8)) & 1;
+  }
+
+  static Key AddrKey(const InetAddr& addr) {
+    Key key;
+    if (addr.family == InetAddrFamily::kIPv4) {
+      key.ipv4 = true;
+      key.prefix_length = kIPv4Bits;
+      std::memcpy(key.bytes.data(), &std::get<struct in_addr>(addr.addr).s_addr, 4);
+      return key;
+    }
+    const auto& in6_addr = std::get<struct in6_addr>(addr.addr);
+    if (IsIPv4Mapped(in6_addr)) {
+      key.ipv4 = true;
+      key.prefix_length = kIPv4Bits;
+      std::memcpy(key.bytes.data(), &in6_addr.s6_addr[12], 4);
+      return key;
+    }
+    key.prefix_length = kIPv6Bits;
+    std::memcpy(key.bytes.data(), in6_addr.s6_addr, 16);
+    return key;
+  }
+
+  static Key BlockKey(const CIDRBlock& block) {
+    DCHECK(block.ip_addr.family != InetAddrFamily::kUnspecified);
+    Key key = AddrKey(block.ip_addr);
+    if (block.ip_addr.family == InetAddrFamily::kIPv4) {
+      key.prefix_length = block.prefix_length;
+    } else if (key.ipv4 && block.prefix_length >= kIPv4MappedPrefixBits) {
+      key.prefix_length = block.prefix_length - kIPv4MappedPrefixBits;
+    } else {
+      // An IPv4-mapped address with a short prefix also covers non-mapped IPv6 addresses.
+      key.ipv4 = false;
+      key.prefix_length = block.prefix_length;
+      std::memcpy(key.bytes.data(), std::get<struct in6_addr>(block.ip_addr.addr).s6_addr, 16);
+    }
+    return key;
+  }
+
+  static const TValue* Match(const std::vector<Node>& nodes, const std::array<uint8_t, 16>& bytes,
+                             size_t num_bits) {
+    const TValue* match = nullptr;
+    uint32_t idx = 0;
+    for (size_t i = 0;; ++i) {
+      if (nodes[idx].value.has_value()) {
+        match = &nodes[idx].value.value();
+      }
+      if (i == num_bits) {
+        return match;
+      }
+      idx = nodes[idx].children[Bit(bytes, i)];
+      if (idx == 0) {
+        return match;
+      }
+    }
+  }
+
+  // Each trie starts with just its root, which holds the value of the /0 block.
+  std::vector<Node> ipv4_nodes_ = std::vector<Node>(1);
+  std::vector<Node> ipv6_nodes_ = std::vector<Node>(1);
+  size_t size_ = 0;
+};
+
+}  // namespace px
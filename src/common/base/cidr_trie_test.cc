@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/base/cidr_trie.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+
+namespace {
+
+CIDRBlock Block(std::string_view cidr_str) {
+  CIDRBlock block;
+  PL_CHECK_OK(ParseCIDRBlock(cidr_str, &block));
+  return block;
+}
+
+InetAddr Addr(std::string_view addr_str) {
+  InetAddr addr;
+  PL_CHECK_OK(ParseIPAddress(addr_str, &addr));
+  return addr;
+}
+
+}  // namespace
+
+TEST(CIDRTrie, LongestPrefixMatchIPv4) {
+  CIDRTrie<int> trie;
+  EXPECT_TRUE(trie.empty());
+  trie.Insert(Block("10.0.0.0/8"), 1);
+  trie.Insert(Block("10.1.0.0/16"), 2);
+  trie.Insert(Block("10.1.2.3/32"), 3);
+  EXPECT_EQ(trie.size(), 3);
+
+  ASSERT_NE(trie.LongestPrefixMatch(Addr("10.9.9.9")), nullptr);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("10.9.9.9")), 1);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("10.1.9.9")), 2);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("10.1.2.3")), 3);
+  EXPECT_EQ(trie.LongestPrefixMatch(Addr("11.0.0.1")), nullptr);
+  EXPECT_FALSE(trie.Contains(InetAddr{}));
+}
+
+TEST(CIDRTrie, FindIsExact) {
+  CIDRTrie<int> trie;
+  trie.Insert(Block("10.1.0.0/16"), 2);
+  trie.Insert(Block("10.1.2.3/32"), 3);
+  trie.Insert(Block("10.1.2.3/32"), 4);
+  EXPECT_EQ(trie.size(), 2);
+
+  ASSERT_NE(trie.Find(Block("10.1.2.3/32")), nullptr);
+  EXPECT_EQ(*trie.Find(Block("10.1.2.3/32")), 4);
+  // Host bits past the prefix don't matter.
+  EXPECT_EQ(*trie.Find(Block("10.1.255.255/16")), 2);
+  EXPECT_EQ(trie.Find(Block("10.1.2.0/24")), nullptr);
+}
+
+TEST(CIDRTrie, IPv6) {
+  CIDRTrie<int> trie;
+  trie.Insert(Block("2001:db8::/32"), 1);
+  trie.Insert(Block("2001:db8:1::/48"), 2);
+
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("2001:db8::1")), 1);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("2001:db8:1::1")), 2);
+  EXPECT_FALSE(trie.Contains(Addr("2001:db9::1")));
+  EXPECT_FALSE(trie.Contains(Addr("10.0.0.1")));
+}
+
+// Mixed families follow CIDRContainsIPAddr.
+TEST(CIDRTrie, IPv4MappedAddresses) {
+  CIDRTrie<int> trie;
+  trie.Insert(Block("10.0.0.0/8"), 1);
+  trie.Insert(Block("::ffff:192.168.0.0/112"), 2);
+  trie.Insert(Block("::/64"), 3);
+
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("::ffff:10.1.2.3")), 1);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("192.168.1.1")), 2);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("172.16.0.1")), 3);
+  EXPECT_EQ(*trie.LongestPrefixMatch(Addr("::1")), 3);
+
+  for (std::string_view block : {"10.0.0.0/8", "::ffff:192.168.0.0/112", "::/64"}) {
+    for (std::string_view addr : {"::ffff:10.1.2.3", "192.168.1.1", "172.16.0.1", "::1"}) {
+      CIDRTrie<bool> single;
+      single.Insert(Block(block), true);
+      EXPECT_EQ(single.Contains(Addr(addr)), CIDRContainsIPAddr(Block(block), Addr(addr)))
+          << block << " " << addr;
+    }
+  }
+}
+
+}  // namespace px
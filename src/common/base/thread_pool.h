@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/mixins.h"
+
+namespace px {
+
+/**
+ * A fixed-size pool of worker threads that execute scheduled closures in FIFO order.
+ *
+ * The pool is intentionally minimal: there are no futures or priorities. Callers that need to
+ * wait for a group of tasks should use ParallelFor() or their own synchronization.
+ */
+class ThreadPool : public NotCopyMoveable {
+ public:
+  /**
+   * Creates a pool with the specified number of threads. A pool of zero threads is allowed,
+   * in which case Schedule() runs the closure inline on the calling thread.
+   */
+  explicit ThreadPool(size_t num_threads);
+
+  /**
+   * Drains all pending tasks and joins the worker threads.
+   */
+  ~ThreadPool();
+
+  /**
+   * Queues a closure for execution on one of the worker threads.
+   */
+  void Schedule(std::function<void()> fn);
+
+  size_t num_threads() const { return threads_.size(); }
+
+ private:
+  void WorkerLoop();
+
+  absl::Mutex mu_;
+  std::deque<std::function<void()>> queue_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::vector<std::thread> threads_;
+};
+
+/**
+ * Runs fn(i) for every i in [0, n) on the pool, and blocks until all invocations complete.
+ * The calling thread participates in the work, so this is safe to call with a null or empty pool.
+ */
+void ParallelFor(ThreadPool* pool, size_t n, const std::function<void(size_t)>& fn);
+
+}  // namespace px
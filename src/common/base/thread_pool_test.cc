@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include <absl/synchronization/blocking_counter.h>
+
+#include "src/common/base/thread_pool.h"
+
+namespace px {
+
+TEST(ThreadPoolTest, ScheduleRunsAllTasks) {
+  constexpr int kNumTasks = 1000;
+  std::atomic<int> count{0};
+  absl::BlockingCounter done(kNumTasks);
+  {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.num_threads(), 4);
+    for (int i = 0; i < kNumTasks; ++i) {
+      pool.Schedule([&]() {
+        count.fetch_add(1);
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  EXPECT_EQ(count.load(), kNumTasks);
+}
+
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+  std::atomic<int> count{0};
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&]() { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(ThreadPoolTest, ZeroThreadsRunsInline) {
+  ThreadPool pool(0);
+  int x = 0;
+  pool.Schedule([&]() { x = 1; });
+  EXPECT_EQ(x, 1);
+}
+
+TEST(ParallelForTest, VisitsEachIndexOnce) {
+  constexpr size_t kN = 10000;
+  std::vector<std::atomic<int>> visits(kN);
+
+  ThreadPool pool(8);
+  ParallelFor(&pool, kN, [&](size_t i) { visits[i].fetch_add(1); });
+
+  for (size_t i = 0; i < kN; ++i) {
+    EXPECT_EQ(visits[i].load(), 1) << i;
+  }
+}
+
+TEST(ParallelForTest, NullPool) {
+  std::vector<int> out(10, 0);
+  ParallelFor(nullptr, out.size(), [&](size_t i) { out[i] = static_cast<int>(i); });
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(out[i], i);
+  }
+}
+
+TEST(ParallelForTest, Empty) {
+  ThreadPool pool(2);
+  ParallelFor(&pool, 0, [&](size_t) { FAIL(); });
+}
+
+}  // namespace px
@@ -42,5 +42,9 @@ uint64_t DefaultMonoToRealtimeConverter::Convert(uint64_t monotonic_time) const
   return mono_to_realtime_.Get(monotonic_time);
 }
 
+void DefaultMonoToRealtimeConverter::ConvertInPlace(absl::Span<uint64_t> monotonic_times) const {
+  mono_to_realtime_.Get(monotonic_times);
+}
+
 }  // namespace clock
 }  // namespace px
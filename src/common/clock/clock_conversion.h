@@ -21,6 +21,7 @@
 #include <unistd.h>
 
 #include <absl/synchronization/mutex.h>
+#include <absl/types/span.h>
 #include <atomic>
 #include <memory>
 #include <thread>
@@ -38,6 +39,13 @@ class ClockConverter {
  public:
   virtual ~ClockConverter() = default;
   virtual uint64_t Convert(uint64_t monotonic_time) const = 0;
+  // Converts a batch of times in place. Converters should override this when they can do better
+  // than one Convert() call per time.
+  virtual void ConvertInPlace(absl::Span<uint64_t> monotonic_times) const {
+    for (uint64_t& t : monotonic_times) {
+      t = Convert(t);
+    }
+  }
   virtual void Update() = 0;
   virtual std::chrono::milliseconds UpdatePeriod() const = 0;
   // The max history is chosen as an even multiple of the default polling period, and longer than 5
@@ -69,6 +77,7 @@ class DefaultMonoToRealtimeConverter : public ClockConverter {
   DefaultMonoToRealtimeConverter();
 
   uint64_t Convert(uint64_t monotonic_time) const override;
+  void ConvertInPlace(absl::Span<uint64_t> monotonic_times) const override;
   void Update() override;
   std::chrono::milliseconds UpdatePeriod() const override { return kUpdatePeriod; }
 
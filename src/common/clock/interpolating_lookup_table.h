@@ -20,6 +20,7 @@
 #include <deque>
 #include <utility>
 #include "absl/base/internal/spinlock.h"
+#include "absl/types/span.h"
 
 #include "src/common/base/base.h"
 
@@ -64,6 +65,39 @@ class InterpolatingLookupTable {
     return key + LinearInterpolate(a.first, b.first, a.second, b.second, key);
   }
 
+  /**
+   * Converts each key in place, with the same result as Get(). The lock is taken once for the
+   * whole batch, and the search for each key starts from where the previous key was found, so
+   * keys that arrive mostly in order (e.g. record timestamps) only cost a comparison or two each
+   * instead of a binary search. Keys in any order are still converted correctly.
+   */
+  void Get(absl::Span<uint64_t> keys) const {
+    absl::base_internal::SpinLockHolder lock(&buffer_lock_);
+    const size_t n = buffer_.size();
+    if (n == 0) {
+      return;
+    }
+    // idx is the index of the first entry whose key is >= the current key, as lower_bound returns.
+    size_t idx = 0;
+    for (uint64_t& key : keys) {
+      while (idx < n && buffer_[idx].first < key) {
+        ++idx;
+      }
+      while (idx > 0 && buffer_[idx - 1].first >= key) {
+        --idx;
+      }
+      if (idx == n) {
+        key += buffer_[n - 1].second;
+      } else if (idx == 0 || buffer_[idx].first == key) {
+        key += buffer_[idx].second;
+      } else {
+        const MapPairType& a = buffer_[idx - 1];
+        const MapPairType& b = buffer_[idx];
+        key += LinearInterpolate(a.first, b.first, a.second, b.second, key);
+      }
+    }
+  }
+
   size_t size() const {
     absl::base_internal::SpinLockHolder lock(&buffer_lock_);
     return buffer_.size();
@@ -18,6 +18,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 #include "src/common/clock/clock_conversion.h"
 
 namespace {
@@ -58,7 +60,36 @@ void BM_InterpolatingLookupTableEmplace(benchmark::State& state) {
   }
 }
 
+// Converts a batch of sorted keys spread across the table, one Get() at a time or all at once.
+template <bool batch>
+void BM_InterpolatingLookupTableGetSorted(benchmark::State& state) {  // NOLINT
+  constexpr size_t capacity =
+      ClockConverter::BufferCapacity(DefaultMonoToRealtimeConverter::kUpdatePeriod);
+  uint64_t base_val = 1640000000271885073;
+  auto table = InitTable<capacity>(base_val);
+
+  std::vector<uint64_t> keys(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = base_val + 100 * capacity * i / keys.size();
+    }
+    state.ResumeTiming();
+    if (batch) {
+      table->Get(absl::MakeSpan(keys));
+    } else {
+      for (auto& key : keys) {
+        key = table->Get(key);
+      }
+    }
+    benchmark::DoNotOptimize(keys.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 BENCHMARK(BM_InterpolatingLookupTableGet);
+BENCHMARK_TEMPLATE(BM_InterpolatingLookupTableGetSorted, false)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_InterpolatingLookupTableGetSorted, true)->Arg(1024);
 BENCHMARK(BM_InterpolatingLookupTableEmplace);
 
 }  // namespace clock
@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <vector>
+
 #include "src/common/testing/testing.h"
 
 #include "src/common/clock/clock_conversion.h"
@@ -66,6 +68,32 @@ TEST(InterpolatingLookupTable, nonmonotonic) {
   EXPECT_EQ(350, table.Get(350));
 }
 
+TEST(InterpolatingLookupTable, batch_matches_get) {
+  InterpolatingLookupTable<64> table;
+  // An empty table leaves the keys as they are.
+  std::vector<uint64_t> keys = {0, 100};
+  table.Get(absl::MakeSpan(keys));
+  EXPECT_THAT(keys, ::testing::ElementsAre(0, 100));
+
+  table.Emplace(100, 100);
+  keys = {0, 100, 200};
+  table.Get(absl::MakeSpan(keys));
+  EXPECT_THAT(keys, ::testing::ElementsAre(0, 100, 200));
+
+  table.Emplace(150, 200);
+  table.Emplace(250, 350);
+  table.Emplace(300, 300);
+
+  // Keys mostly in order, with some going backwards, repeated and outside the table.
+  keys = {0, 50, 100, 100, 150, 120, 200, 250, 260, 90, 300, 310, 1000, 5};
+  std::vector<uint64_t> expected;
+  for (uint64_t key : keys) {
+    expected.push_back(table.Get(key));
+  }
+  table.Get(absl::MakeSpan(keys));
+  EXPECT_EQ(expected, keys);
+}
+
 TEST(InterpolatingLookupTable, mono_and_realtime) {
   InterpolatingLookupTable<64> table;
   uint64_t start_mono = 1000000000000000;
@@ -23,6 +23,7 @@
 #include "src/common/event/deferred_delete.h"   // IWYU pragma: export
 #include "src/common/event/dispatcher.h"        // IWYU pragma: export
 #include "src/common/event/libuv.h"             // IWYU pragma: export
+#include "src/common/event/loop_group.h"        // IWYU pragma: export
 #include "src/common/event/real_time_system.h"  // IWYU pragma: export
 #include "src/common/event/time_system.h"       // IWYU pragma: export
 #include "src/common/event/timer.h"             // IWYU pragma: export
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/event/loop_group.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <utility>
+
+namespace px {
+namespace event {
+
+LoopGroup::LoopGroup(API* api, prometheus::Registry* registry)
+    : api_(api),
+      lag_family_(prometheus::BuildGauge()
+                      .Name("event_loop_lag_seconds")
+                      .Help("The time by which the last lag probe timer of the loop fired late.")
+                      .Register(*registry)) {}
+
+LoopGroup::~LoopGroup() { Stop(); }
+
+StatusOr<Dispatcher*> LoopGroup::AddLoop(std::string_view name, int cpu) {
+  if (started_) {
+    return error::FailedPrecondition("Can not add loop $0 to a running loop group.", name);
+  }
+  auto [it, inserted] = loops_.try_emplace(std::string(name), std::make_unique<Loop>());
+  if (!inserted) {
+    return error::AlreadyExists("Loop $0 already exists.", name);
+  }
+  Loop* loop = it->second.get();
+  loop->dispatcher = api_->AllocateDispatcher(name);
+  loop->cpu = cpu;
+  loop->probe.dispatcher = loop->dispatcher.get();
+  loop->probe.lag = &lag_family_.Add({{"loop", std::string(name)}});
+  return loop->dispatcher.get();
+}
+
+Dispatcher* LoopGroup::GetLoop(std::string_view name) const {
+  auto it = loops_.find(name);
+  return it == loops_.end() ? nullptr : it->second->dispatcher.get();
+}
+
+Status LoopGroup::Post(std::string_view name, PostCB cb) {
+  if (stopping_) {
+    return error::Cancelled("Loop group is stopping.");
+  }
+  Dispatcher* dispatcher = GetLoop(name);
+  if (dispatcher == nullptr) {
+    return error::NotFound("Loop $0 does not exist.", name);
+  }
+  dispatcher->Post(std::move(cb));
+  return Status::OK();
+}
+
+void LoopGroup::MonitorLag(std::string_view name, Dispatcher* dispatcher) {
+  auto probe = std::make_unique<LagProbe>();
+  probe->dispatcher = dispatcher;
+  probe->lag = &lag_family_.Add({{"loop", std::string(name)}});
+  StartLagProbe(probe.get());
+  external_probes_.push_back(std::move(probe));
+}
+
+void LoopGroup::StartLagProbe(LagProbe* probe) {
+  probe->timer = probe->dispatcher->CreateTimer([probe]() {
+    auto now = probe->dispatcher->GetTimeSource().MonotonicTime();
+    probe->lag->Set(std::chrono::duration<double>(now - probe->expected_time).count());
+    probe->expected_time = now + kLagProbePeriod;
+    probe->timer->EnableTimer(kLagProbePeriod);
+  });
+  probe->expected_time = probe->dispatcher->GetTimeSource().MonotonicTime() + kLagProbePeriod;
+  probe->timer->EnableTimer(kLagProbePeriod);
+}
+
+void LoopGroup::Start() {
+  if (started_) {
+    return;
+  }
+  started_ = true;
+  for (auto& [name, loop] : loops_) {
+    Loop* l = loop.get();
+    l->thread = std::thread([this, l]() { RunLoop(l); });
+  }
+}
+
+void LoopGroup::RunLoop(Loop* loop) {
+  if (loop->cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(loop->cpu, &cpus);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    LOG_IF(WARNING, rc != 0) << absl::Substitute("Failed to pin event loop to CPU $0, rc=$1",
+                                                 loop->cpu, rc);
+  }
+  // The probe timer also keeps the loop from running out of events before it is stopped.
+  StartLagProbe(&loop->probe);
+  while (!stopping_) {
+    loop->dispatcher->Run(Dispatcher::RunType::RunUntilExit);
+  }
+  loop->probe.timer.reset();
+  loop->dispatcher->Stop();
+  loop->dispatcher->Run(Dispatcher::RunType::NonBlock);
+}
+
+void LoopGroup::Stop() {
+  if (!started_ || stopping_.exchange(true)) {
+    return;
+  }
+  for (auto& [name, loop] : loops_) {
+    // Wake the loop up, so that it sees that it is stopping.
+    loop->dispatcher->Post([]() {});
+  }
+  for (auto& [name, loop] : loops_) {
+    if (loop->thread.joinable()) {
+      loop->thread.join();
+    }
+  }
+}
+
+}  // namespace event
+}  // namespace px
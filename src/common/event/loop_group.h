@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <prometheus/family.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
+
+#include "src/common/base/base.h"
+#include "src/common/event/api.h"
+#include "src/common/event/dispatcher.h"
+
+namespace px {
+namespace event {
+
+/**
+ * LoopGroup runs a set of named event loops, each on its own thread, so that slow work on one
+ * loop does not hold up the timers and callbacks of the others.
+ *
+ * Work is moved between loops with Post, which is safe from any thread. The lag of each loop,
+ * the time by which a periodic probe timer fires late, is exported as the
+ * event_loop_lag_seconds gauge.
+ */
+class LoopGroup : public NotCopyMoveable {
+ public:
+  LoopGroup(API* api, prometheus::Registry* registry);
+  ~LoopGroup();
+
+  /**
+   * Allocates a loop, which runs on its own thread once Start is called. If cpu is not negative,
+   * the thread is pinned to that CPU.
+   */
+  StatusOr<Dispatcher*> AddLoop(std::string_view name, int cpu = -1);
+
+  /**
+   * Returns the named loop, or nullptr if there is none.
+   */
+  Dispatcher* GetLoop(std::string_view name) const;
+
+  /**
+   * Runs the callback on the named loop. Safe to call from any thread.
+   */
+  Status Post(std::string_view name, PostCB cb);
+
+  /**
+   * Measures the lag of a loop that is run elsewhere, such as the main loop of a process.
+   * Must be called before that loop is run, or from its thread.
+   */
+  void MonitorLag(std::string_view name, Dispatcher* dispatcher);
+
+  /**
+   * Starts the threads of the loops. Loops can not be added afterwards.
+   */
+  void Start();
+
+  /**
+   * Stops the loops and waits for their threads to exit.
+   */
+  void Stop();
+
+ private:
+  struct LagProbe {
+    Dispatcher* dispatcher = nullptr;
+    TimerUPtr timer;
+    std::chrono::steady_clock::time_point expected_time;
+    prometheus::Gauge* lag = nullptr;
+  };
+
+  struct Loop {
+    DispatcherUPtr dispatcher;
+    int cpu = -1;
+    std::thread thread;
+    LagProbe probe;
+  };
+
+  void StartLagProbe(LagProbe* probe);
+  void RunLoop(Loop* loop);
+
+  static constexpr std::chrono::milliseconds kLagProbePeriod{1000};
+
+  API* api_;
+  prometheus::Family<prometheus::Gauge>& lag_family_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Loop>> loops_;
+  // Probes for loops that are run outside of the group.
+  std::vector<std::unique_ptr<LagProbe>> external_probes_;
+  bool started_ = false;
+  std::atomic<bool> stopping_ = false;
+};
+
+}  // namespace event
+}  // namespace px
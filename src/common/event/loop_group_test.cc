@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+
+#include <prometheus/registry.h>
+
+#include "src/common/event/api_impl.h"
+#include "src/common/event/loop_group.h"
+#include "src/common/event/real_time_system.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace event {
+
+class LoopGroupTest : public ::testing::Test {
+ public:
+  LoopGroupTest()
+      : api_(std::make_unique<APIImpl>(&time_system_)),
+        loops_(std::make_unique<LoopGroup>(api_.get(), &registry_)) {}
+
+ protected:
+  RealTimeSystem time_system_;
+  std::unique_ptr<API> api_;
+  prometheus::Registry registry_;
+  std::unique_ptr<LoopGroup> loops_;
+};
+
+TEST_F(LoopGroupTest, post_across_loops) {
+  ASSERT_OK(loops_->AddLoop("a"));
+  ASSERT_OK(loops_->AddLoop("b"));
+  loops_->Start();
+
+  std::promise<std::pair<std::thread::id, std::thread::id>> done;
+  ASSERT_OK(loops_->Post("a", [this, &done]() {
+    auto a_tid = std::this_thread::get_id();
+    ASSERT_OK(loops_->Post("b", [a_tid, &done]() {
+      done.set_value({a_tid, std::this_thread::get_id()});
+    }));
+  }));
+  auto [a_tid, b_tid] = done.get_future().get();
+  EXPECT_NE(a_tid, b_tid);
+  EXPECT_NE(a_tid, std::this_thread::get_id());
+  EXPECT_NE(b_tid, std::this_thread::get_id());
+
+  loops_->Stop();
+  EXPECT_NOT_OK(loops_->Post("a", []() {}));
+}
+
+TEST_F(LoopGroupTest, errors) {
+  ASSERT_OK(loops_->AddLoop("a"));
+  EXPECT_NOT_OK(loops_->AddLoop("a"));
+  EXPECT_EQ(nullptr, loops_->GetLoop("b"));
+  EXPECT_NOT_OK(loops_->Post("b", []() {}));
+
+  loops_->Start();
+  EXPECT_NOT_OK(loops_->AddLoop("b"));
+}
+
+}  // namespace event
+}  // namespace px
@@ -22,4 +22,5 @@
  * importing them everywhere.
  */
 
-#include "src/common/memory/object_pool.h"  // IWYU pragma: export
+#include "src/common/memory/object_arena.h"  // IWYU pragma: export
+#include "src/common/memory/object_pool.h"   // IWYU pragma: export
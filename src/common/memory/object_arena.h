@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+
+/**
+ * ObjectArena allocates objects from large blocks with a bump pointer, and destroys all of them
+ * at once in Clear or on destruction. Objects that are trivially destructible are not tracked at
+ * all, so clearing them only rewinds the pointer.
+ *
+ * Unlike ObjectPool, which takes ownership of separately allocated objects, this avoids an
+ * allocation per object. It is not thread-safe.
+ */
+class ObjectArena final : public px::NotCopyable {
+ public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024;
+  static constexpr size_t kMaxBlockSize = 1024 * 1024;
+
+  explicit ObjectArena(std::string_view name = "", size_t block_size = kDefaultBlockSize)
+      : name_(name), next_block_size_(block_size) {
+    VLOG_IF(1, !name_.empty()) << "Creating Object Arena: " << name_;
+  }
+
+  ~ObjectArena() {
+    Clear();
+    VLOG_IF(1, !name_.empty()) << "Deleting Object Arena: " << name_;
+  }
+
+  /**
+   * Constructs an object in the arena.
+   *
+   * @tparam T The type of the object.
+   * @param args The arguments to the constructor of T.
+   * @return The pointer to the object, which is valid until the arena is cleared.
+   */
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned type.");
+    T* obj = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.push_back(Destructor{obj, [](void* o) { static_cast<T*>(o)->~T(); }});
+    }
+    return obj;
+  }
+
+  /**
+   * Destroys all of the objects, in the reverse order of their construction. The newest block,
+   * which is the largest unless an oversized object got a block for itself, is kept for reuse.
+   */
+  void Clear() {
+    for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+      it->destroy_fn(it->obj);
+    }
+    destructors_.clear();
+    if (blocks_.size() > 1) {
+      blocks_.front() = std::move(blocks_.back());
+      blocks_.resize(1);
+    }
+    if (!blocks_.empty()) {
+      cur_ = blocks_.front().data.get();
+      end_ = cur_ + blocks_.front().size;
+    }
+    bytes_allocated_ = 0;
+  }
+
+  // The number of bytes handed out since the last Clear.
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+ private:
+  // A generic destruction function pointer. Destroys its first argument without freeing it.
+  using DestroyFn = void (*)(void*);
+
+  struct Destructor {
+    void* obj;
+    DestroyFn destroy_fn;
+  };
+
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  void* Allocate(size_t size, size_t align) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+    if (cur_ == nullptr || p + size > reinterpret_cast<uintptr_t>(end_)) {
+      // Objects bigger than a block get a block of their own.
+      size_t block_size = std::max(next_block_size_, size);
+      next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+      // Not make_unique, which would zero the block.
+      blocks_.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[block_size]), block_size});
+      cur_ = blocks_.back().data.get();
+      end_ = cur_ + block_size;
+      p = reinterpret_cast<uintptr_t>(cur_);
+    }
+    cur_ = reinterpret_cast<uint8_t*>(p + size);
+    bytes_allocated_ += size;
+    return reinterpret_cast<void*>(p);
+  }
+
+  const std::string name_;
+  size_t next_block_size_;
+  std::vector<Block> blocks_;
+  uint8_t* cur_ = nullptr;
+  uint8_t* end_ = nullptr;
+  size_t bytes_allocated_ = 0;
+  std::vector<Destructor> destructors_;
+};
+
+}  // namespace px
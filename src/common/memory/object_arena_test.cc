@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/memory/object_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace px {
+
+class DestroyCounter {
+ public:
+  explicit DestroyCounter(std::vector<int>* destroyed, int id) : destroyed_(destroyed), id_(id) {}
+  ~DestroyCounter() { destroyed_->push_back(id_); }
+
+ private:
+  std::vector<int>* destroyed_;
+  int id_;
+};
+
+TEST(object_arena_test, destroys_in_reverse_order) {
+  std::vector<int> destroyed;
+  {
+    ObjectArena arena;
+    arena.New<DestroyCounter>(&destroyed, 1);
+    arena.New<int64_t>(2);
+    arena.New<DestroyCounter>(&destroyed, 3);
+    EXPECT_TRUE(destroyed.empty());
+  }
+  EXPECT_EQ(destroyed, std::vector<int>({3, 1}));
+}
+
+TEST(object_arena_test, clear_reuses_memory) {
+  std::vector<int> destroyed;
+  ObjectArena arena("test", /*block_size*/ 64);
+  for (int i = 0; i < 100; ++i) {
+    arena.New<DestroyCounter>(&destroyed, i);
+  }
+  EXPECT_EQ(100 * sizeof(DestroyCounter), arena.bytes_allocated());
+  arena.Clear();
+  EXPECT_EQ(100, destroyed.size());
+  EXPECT_EQ(0, arena.bytes_allocated());
+
+  auto* s = arena.New<std::string>(1000, 'a');
+  EXPECT_EQ(1000, s->size());
+}
+
+TEST(object_arena_test, aligns_objects) {
+  ObjectArena arena("test", /*block_size*/ 64);
+  arena.New<char>('a');
+  auto* d = arena.New<double>(1.0);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(d) % alignof(double));
+  // Bigger than a block.
+  auto* big = arena.New<std::array<int64_t, 32>>();
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(big) % alignof(int64_t));
+  EXPECT_EQ(0, (*big)[31]);
+}
+
+}  // namespace px
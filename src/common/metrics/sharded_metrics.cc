@@ -0,0 +1,154 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/metrics/sharded_metrics.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+
+namespace px {
+namespace metrics {
+
+namespace {
+
+absl::Mutex g_sharded_metrics_mu;
+absl::flat_hash_set<internal::ShardedMetric*>& ShardedMetrics()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(g_sharded_metrics_mu) {
+  static auto* metrics = new absl::flat_hash_set<internal::ShardedMetric*>();
+  return *metrics;
+}
+
+std::atomic<size_t> g_next_shard{0};
+
+double BitsToDouble(uint64_t bits) {
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+uint64_t DoubleToBits(double d) {
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+namespace internal {
+
+size_t ThreadShard() {
+  thread_local const size_t shard =
+      g_next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+void ShardedMetric::Register() {
+  absl::MutexLock lock(&g_sharded_metrics_mu);
+  ShardedMetrics().insert(this);
+}
+
+void ShardedMetric::Unregister() {
+  absl::MutexLock lock(&g_sharded_metrics_mu);
+  ShardedMetrics().erase(this);
+}
+
+}  // namespace internal
+
+void FlushShardedMetrics() {
+  absl::MutexLock lock(&g_sharded_metrics_mu);
+  for (internal::ShardedMetric* metric : ShardedMetrics()) {
+    metric->Flush();
+  }
+}
+
+uint64_t ShardedCounter::Value() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void ShardedCounter::Flush() {
+  uint64_t total = Value();
+  uint64_t flushed = flushed_.exchange(total, std::memory_order_relaxed);
+  if (total > flushed) {
+    counter_->Increment(static_cast<double>(total - flushed));
+  }
+}
+
+ShardedHistogram::ShardedHistogram(prometheus::Family<prometheus::Histogram>* family,
+                                   const std::map<std::string, std::string>& labels,
+                                   prometheus::Histogram::BucketBoundaries buckets)
+    : histogram_(&family->Add(labels, buckets)),
+      buckets_(std::move(buckets)),
+      flushed_counts_(buckets_.size() + 1, 0) {
+  constexpr size_t kWordsPerLine = sizeof(Line) / sizeof(std::atomic<uint64_t>);
+  // The bucket counts, the +Inf bucket and the sum.
+  size_t words = buckets_.size() + 2;
+  lines_per_shard_ = (words + kWordsPerLine - 1) / kWordsPerLine;
+  lines_ = std::make_unique<Line[]>(lines_per_shard_ * internal::kNumShards);
+  for (size_t i = 0; i < lines_per_shard_ * internal::kNumShards; ++i) {
+    for (auto& word : lines_[i].words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+  Register();
+}
+
+void ShardedHistogram::Observe(double value) {
+  std::atomic<uint64_t>* row = Row(internal::ThreadShard());
+  // Prometheus buckets count the values less than or equal to their upper bound.
+  size_t bucket = std::lower_bound(buckets_.begin(), buckets_.end(), value) - buckets_.begin();
+  row[bucket].fetch_add(1, std::memory_order_relaxed);
+
+  // There is no atomic add for doubles, but the shard is rarely shared so this seldom retries.
+  std::atomic<uint64_t>& sum = row[sum_index()];
+  uint64_t old_bits = sum.load(std::memory_order_relaxed);
+  while (!sum.compare_exchange_weak(old_bits, DoubleToBits(BitsToDouble(old_bits) + value),
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+void ShardedHistogram::Flush() {
+  std::vector<uint64_t> counts(buckets_.size() + 1, 0);
+  double sum = 0;
+  for (size_t shard = 0; shard < internal::kNumShards; ++shard) {
+    std::atomic<uint64_t>* row = Row(shard);
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += row[i].load(std::memory_order_relaxed);
+    }
+    sum += BitsToDouble(row[sum_index()].load(std::memory_order_relaxed));
+  }
+
+  std::vector<double> increments(counts.size());
+  for (size_t i = 0; i < counts.size(); ++i) {
+    increments[i] = static_cast<double>(counts[i] - flushed_counts_[i]);
+  }
+  histogram_->ObserveMultiple(increments, sum - flushed_sum_);
+  flushed_counts_ = std::move(counts);
+  flushed_sum_ = sum;
+}
+
+}  // namespace metrics
+}  // namespace px
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <prometheus/counter.h>
+#include <prometheus/histogram.h>
+#include <prometheus/registry.h>
+
+#include "src/common/metrics/metrics.h"
+
+namespace px {
+namespace metrics {
+
+namespace internal {
+
+// Threads are spread over this many shards. Threads only share a shard once there are more of
+// them than shards, so an update nearly always hits a cache line no other thread is writing.
+constexpr size_t kNumShards = 32;
+
+// Returns the shard of the calling thread, assigned round robin on the thread's first update.
+size_t ThreadShard();
+
+// Base for metrics whose updates are buffered in shards and added to a prometheus metric when
+// FlushShardedMetrics() is called. Subclasses register once they are fully constructed and
+// unregister in their destructor, so a concurrent flush never sees a partial object.
+class ShardedMetric {
+ public:
+  virtual ~ShardedMetric() { Unregister(); }
+  virtual void Flush() = 0;
+
+ protected:
+  void Register();
+  void Unregister();
+};
+
+}  // namespace internal
+
+/**
+ * Adds the updates of all sharded metrics to their prometheus metrics. Call this before
+ * collecting from the registry, so that the collected values are current.
+ */
+void FlushShardedMetrics();
+
+/**
+ * ShardedCounter is a counter for per-event use on hot paths. Increments go to a per-thread shard
+ * with a relaxed atomic add, instead of to the prometheus counter, whose value is shared by every
+ * thread. The shards are summed into the prometheus counter by FlushShardedMetrics().
+ *
+ * The prometheus counter must outlive the ShardedCounter.
+ */
+class ShardedCounter : public internal::ShardedMetric {
+ public:
+  explicit ShardedCounter(prometheus::Counter* counter) : counter_(counter) { Register(); }
+  ~ShardedCounter() override { Unregister(); }
+
+  void Increment(uint64_t value = 1) {
+    shards_[internal::ThreadShard()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // The total of all increments, including those not flushed yet.
+  uint64_t Value() const;
+
+  void Flush() override;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+
+  prometheus::Counter* counter_;
+  Shard shards_[internal::kNumShards];
+  std::atomic<uint64_t> flushed_{0};
+};
+
+/**
+ * ShardedHistogram is the histogram counterpart of ShardedCounter. Each shard keeps its own
+ * bucket counts and sum, which FlushShardedMetrics() adds to a prometheus histogram with the same
+ * buckets.
+ */
+class ShardedHistogram : public internal::ShardedMetric {
+ public:
+  ShardedHistogram(prometheus::Family<prometheus::Histogram>* family,
+                   const std::map<std::string, std::string>& labels,
+                   prometheus::Histogram::BucketBoundaries buckets);
+  ~ShardedHistogram() override { Unregister(); }
+
+  void Observe(double value);
+
+  void Flush() override;
+
+ private:
+  // Each shard is a row of words: the count of each bucket, including the +Inf bucket, followed
+  // by the bits of the double sum. Rows are padded to whole cache lines.
+  struct alignas(64) Line {
+    std::atomic<uint64_t> words[8];
+  };
+  std::atomic<uint64_t>* Row(size_t shard) const {
+    return lines_[shard * lines_per_shard_].words;
+  }
+  size_t sum_index() const { return buckets_.size() + 1; }
+
+  prometheus::Histogram* histogram_;
+  const prometheus::Histogram::BucketBoundaries buckets_;
+  size_t lines_per_shard_;
+  std::unique_ptr<Line[]> lines_;
+
+  // The totals last added to the histogram, only used by Flush().
+  std::vector<uint64_t> flushed_counts_;
+  double flushed_sum_ = 0;
+};
+
+}  // namespace metrics
+}  // namespace px
+
+// Increments a sharded counter named `name`, built on first use and kept for the life of the
+// process. Meant for per-event counting, where each call site keeps its own counter.
+#define PL_METRIC_COUNTER_ADD(name, help, value)                                  \
+  do {                                                                            \
+    static auto* _pl_sharded_counter =                                            \
+        new ::px::metrics::ShardedCounter(&BuildCounter(name, help));             \
+    _pl_sharded_counter->Increment(value);                                        \
+  } while (false)
+
+#define PL_METRIC_COUNTER_INC(name, help) PL_METRIC_COUNTER_ADD(name, help, 1)
+
+// Records `value` in a sharded histogram named `name` with the given bucket boundaries, built on
+// first use and kept for the life of the process.
+#define PL_METRIC_HISTOGRAM_OBSERVE(name, help, buckets, value)                                \
+  do {                                                                                         \
+    static auto* _pl_sharded_histogram = new ::px::metrics::ShardedHistogram(                  \
+        &prometheus::BuildHistogram().Name(name).Help(help).Register(GetMetricsRegistry()),    \
+        {{"name", name}}, buckets);                                                            \
+    _pl_sharded_histogram->Observe(value);                                                     \
+  } while (false)
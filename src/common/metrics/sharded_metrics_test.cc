@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "src/common/metrics/sharded_metrics.h"
+
+namespace px {
+namespace metrics {
+
+class ShardedMetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { TestOnlyResetMetricsRegistry(); }
+};
+
+TEST_F(ShardedMetricsTest, CounterAggregatesThreadsOnFlush) {
+  auto& counter = BuildCounter("sharded_test_counter", "help");
+  ShardedCounter sharded(&counter);
+
+  constexpr int kThreads = 8;
+  constexpr int kIncrements = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kIncrements; ++j) {
+        sharded.Increment();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(kThreads * kIncrements, sharded.Value());
+  // Nothing reaches the prometheus counter until it is flushed.
+  EXPECT_EQ(0, counter.Value());
+  FlushShardedMetrics();
+  EXPECT_EQ(kThreads * kIncrements, counter.Value());
+
+  // Only the increments since the last flush are added.
+  sharded.Increment(5);
+  FlushShardedMetrics();
+  FlushShardedMetrics();
+  EXPECT_EQ(kThreads * kIncrements + 5, counter.Value());
+}
+
+TEST_F(ShardedMetricsTest, Histogram) {
+  auto& family = prometheus::BuildHistogram()
+                     .Name("sharded_test_histogram")
+                     .Help("help")
+                     .Register(GetMetricsRegistry());
+  ShardedHistogram sharded(&family, {}, {1, 10, 100});
+
+  std::thread t([&]() {
+    sharded.Observe(0.5);
+    sharded.Observe(10);
+  });
+  t.join();
+  sharded.Observe(50);
+  sharded.Observe(1000);
+  FlushShardedMetrics();
+  sharded.Observe(5);
+  FlushShardedMetrics();
+
+  auto families = GetMetricsRegistry().Collect();
+  ASSERT_EQ(1, families.size());
+  ASSERT_EQ(1, families[0].metric.size());
+  const auto& histogram = families[0].metric[0].histogram;
+  EXPECT_EQ(5, histogram.sample_count);
+  EXPECT_DOUBLE_EQ(1065.5, histogram.sample_sum);
+  // Buckets are cumulative.
+  ASSERT_EQ(4, histogram.bucket.size());
+  EXPECT_EQ(1, histogram.bucket[0].cumulative_count);
+  EXPECT_EQ(3, histogram.bucket[1].cumulative_count);
+  EXPECT_EQ(4, histogram.bucket[2].cumulative_count);
+  EXPECT_EQ(5, histogram.bucket[3].cumulative_count);
+}
+
+TEST_F(ShardedMetricsTest, Macros) {
+  for (int i = 0; i < 3; ++i) {
+    PL_METRIC_COUNTER_INC("sharded_test_macro_counter", "help");
+  }
+  PL_METRIC_COUNTER_ADD("sharded_test_macro_counter", "help", 2);
+  PL_METRIC_HISTOGRAM_OBSERVE("sharded_test_macro_histogram", "help",
+                              prometheus::Histogram::BucketBoundaries({1, 2}), 1.5);
+  FlushShardedMetrics();
+
+  auto families = GetMetricsRegistry().Collect();
+  ASSERT_EQ(2, families.size());
+  for (const auto& family : families) {
+    ASSERT_EQ(1, family.metric.size());
+    if (family.name == "sharded_test_macro_counter") {
+      // The two call sites use separate sharded counters for the same prometheus counter.
+      EXPECT_EQ(5, family.metric[0].counter.value);
+    } else {
+      EXPECT_EQ(1, family.metric[0].histogram.sample_count);
+    }
+  }
+}
+
+}  // namespace metrics
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/perf/hw_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace px {
+
+namespace {
+
+// The order of the counters in the group, which is also the order in which they are read.
+constexpr uint64_t kCounterConfigs[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+};
+constexpr size_t kNumCounters = sizeof(kCounterConfigs) / sizeof(kCounterConfigs[0]);
+
+int PerfEventOpen(uint64_t config, int group_fd) {
+  struct perf_event_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // Count the calling thread, on any CPU.
+  return syscall(__NR_perf_event_open, &attr, /*pid*/ 0, /*cpu*/ -1, group_fd, /*flags*/ 0);
+}
+
+}  // namespace
+
+HardwareCounters::~HardwareCounters() { Close(); }
+
+void HardwareCounters::Close() {
+  for (int fd : fds_) {
+    close(fd);
+  }
+  fds_.clear();
+}
+
+Status HardwareCounters::Open() {
+  if (is_open()) {
+    return Status::OK();
+  }
+  for (uint64_t config : kCounterConfigs) {
+    int fd = PerfEventOpen(config, fds_.empty() ? -1 : fds_[0]);
+    if (fd < 0) {
+      int err = errno;
+      Close();
+      return error::ResourceUnavailable("Failed to open perf event counter: $0",
+                                        std::strerror(err));
+    }
+    fds_.push_back(fd);
+  }
+  return Status::OK();
+}
+
+HardwareCounters::Values HardwareCounters::Read() const {
+  if (!is_open()) {
+    return {};
+  }
+  // With PERF_FORMAT_GROUP, a read of the leader returns the number of counters followed by
+  // the value of each.
+  uint64_t buf[kNumCounters + 1] = {};
+  if (read(fds_[0], buf, sizeof(buf)) != sizeof(buf) || buf[0] != kNumCounters) {
+    return {};
+  }
+  return {buf[1], buf[2], buf[3]};
+}
+
+HardwareCounters* HardwareCounters::ThisThread() {
+  static thread_local HardwareCounters counters;
+  static thread_local bool opened = false;
+  if (!opened) {
+    opened = true;
+    Status s = counters.Open();
+    if (!s.ok()) {
+      LOG_FIRST_N(WARNING, 1) << s.msg();
+    }
+  }
+  return &counters;
+}
+
+}  // namespace px
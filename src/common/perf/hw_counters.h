@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+
+/**
+ * HardwareCounters counts CPU cycles, instructions and cache misses of the calling thread, using
+ * a perf_event group. The counters may be unavailable, e.g. when perf_event_paranoid forbids it,
+ * in which case Open() fails and Read() returns zeros.
+ */
+class HardwareCounters : public NotCopyable {
+ public:
+  struct Values {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+
+    Values& operator+=(const Values& other) {
+      cycles += other.cycles;
+      instructions += other.instructions;
+      cache_misses += other.cache_misses;
+      return *this;
+    }
+    Values operator-(const Values& other) const {
+      return {cycles - other.cycles, instructions - other.instructions,
+              cache_misses - other.cache_misses};
+    }
+  };
+
+  HardwareCounters() = default;
+  ~HardwareCounters();
+
+  /**
+   * Opens the counters for the calling thread. They only count while that thread runs.
+   */
+  Status Open();
+  bool is_open() const { return !fds_.empty(); }
+
+  /**
+   * @return the counts since Open().
+   */
+  Values Read() const;
+
+  /**
+   * @return counters for the calling thread, opened on first use. Check is_open() before
+   * relying on them.
+   */
+  static HardwareCounters* ThisThread();
+
+ private:
+  void Close();
+
+  // The first fd is the group leader.
+  std::vector<int> fds_;
+};
+
+}  // namespace px
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/perf/hw_counters.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+
+TEST(HardwareCountersTest, read_without_open) {
+  HardwareCounters counters;
+  EXPECT_FALSE(counters.is_open());
+  HardwareCounters::Values values = counters.Read();
+  EXPECT_EQ(values.cycles, 0U);
+  EXPECT_EQ(values.instructions, 0U);
+  EXPECT_EQ(values.cache_misses, 0U);
+}
+
+TEST(HardwareCountersTest, counts_instructions) {
+  HardwareCounters counters;
+  if (!counters.Open().ok()) {
+    GTEST_SKIP() << "perf events are not available.";
+  }
+  HardwareCounters::Values start = counters.Read();
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) {
+    sum = sum + i;
+  }
+  HardwareCounters::Values delta = counters.Read() - start;
+  EXPECT_GT(delta.instructions, 100000U);
+  EXPECT_GT(delta.cycles, 0U);
+}
+
+}  // namespace px
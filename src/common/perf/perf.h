@@ -23,6 +23,7 @@
  */
 
 #include "src/common/perf/elapsed_timer.h"    // IWYU pragma: export
+#include "src/common/perf/hw_counters.h"      // IWYU pragma: export
 #include "src/common/perf/profiler.h"         // IWYU pragma: export
 #include "src/common/perf/scoped_profiler.h"  // IWYU pragma: export
 #include "src/common/perf/scoped_timer.h"     // IWYU pragma: export
@@ -72,6 +72,12 @@ class Config : public NotCopyable {
    */
   uint64_t ConvertToRealTime(uint64_t monotonic_time) const;
 
+  /**
+   * Converts a batch of monotonic times to realtime, in place. Cheaper than converting the times
+   * one at a time, particularly when they are mostly sorted.
+   */
+  void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const;
+
   /**
    * Converts a path to host relative path, for when this binary is running inside a container.
    */
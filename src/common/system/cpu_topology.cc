@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/cpu_topology.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <string>
+#include <utility>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+
+#include "src/common/base/file.h"
+#include "src/common/system/config.h"
+
+namespace px {
+namespace system {
+
+StatusOr<std::vector<int>> ParseCPUList(std::string_view cpu_list) {
+  std::vector<int> cpus;
+  for (std::string_view range : absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                                               absl::SkipEmpty())) {
+    std::vector<std::string_view> bounds = absl::StrSplit(range, '-');
+    int first = 0;
+    int last = 0;
+    if (bounds.size() > 2 || !absl::SimpleAtoi(bounds.front(), &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 || last < first) {
+      return error::InvalidArgument("Invalid CPU range '$0' in CPU list '$1'.", range, cpu_list);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+StatusOr<CPUTopology> CPUTopology::Read(const std::filesystem::path& sysfs_path) {
+  const std::filesystem::path node_path = sysfs_path / "devices/system/node";
+  std::error_code ec;
+  std::filesystem::directory_iterator iter(node_path, ec);
+  if (ec) {
+    return error::NotFound("Could not list NUMA nodes in $0: $1", node_path.string(),
+                           ec.message());
+  }
+
+  std::map<int, std::vector<int>> node_cpus;
+  for (const auto& entry : iter) {
+    std::string_view name = entry.path().filename().native();
+    int node = 0;
+    if (!absl::ConsumePrefix(&name, "node") || !absl::SimpleAtoi(name, &node)) {
+      continue;
+    }
+    PL_ASSIGN_OR_RETURN(std::string cpu_list,
+                        ReadFileToString((entry.path() / "cpulist").string()));
+    PL_ASSIGN_OR_RETURN(std::vector<int> cpus, ParseCPUList(cpu_list));
+    // Nodes without CPUs hold only memory, and are not useful for placing threads.
+    if (!cpus.empty()) {
+      node_cpus[node] = std::move(cpus);
+    }
+  }
+  return CPUTopology(std::move(node_cpus));
+}
+
+const CPUTopology& CPUTopology::Host() {
+  static const CPUTopology kHost = [] {
+    auto topology_or = Read(Config::GetInstance().sysfs_path());
+    if (!topology_or.ok()) {
+      LOG(WARNING) << "Could not read the NUMA topology, threads will not be pinned: "
+                   << topology_or.msg();
+      return CPUTopology({});
+    }
+    return topology_or.ConsumeValueOrDie();
+  }();
+  return kHost;
+}
+
+StatusOr<int> CPUTopology::ResolveNode(std::string_view placement) const {
+  if (placement == "none") {
+    return -1;
+  }
+  if (placement == "auto") {
+    return num_nodes() > 1 ? node_cpus_.begin()->first : -1;
+  }
+  int node = 0;
+  if (!absl::SimpleAtoi(placement, &node)) {
+    return error::InvalidArgument("Invalid NUMA placement '$0', expected none, auto or a node.",
+                                  placement);
+  }
+  if (!node_cpus_.contains(node)) {
+    return error::InvalidArgument("NUMA node $0 does not exist or has no CPUs.", node);
+  }
+  return node;
+}
+
+Status CPUTopology::PinCurrentThread(int node) const {
+  if (node < 0) {
+    return Status::OK();
+  }
+  auto iter = node_cpus_.find(node);
+  if (iter == node_cpus_.end()) {
+    return error::InvalidArgument("NUMA node $0 does not exist or has no CPUs.", node);
+  }
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int cpu : iter->second) {
+    CPU_SET(cpu, &cpus);
+  }
+  int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  if (rc != 0) {
+    return error::Internal("Failed to pin thread to the CPUs of NUMA node $0, rc=$1", node, rc);
+  }
+  return Status::OK();
+}
+
+Status PinCurrentThreadToNUMANode(std::string_view placement) {
+  const CPUTopology& host = CPUTopology::Host();
+  PL_ASSIGN_OR_RETURN(int node, host.ResolveNode(placement));
+  return host.PinCurrentThread(node);
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace system {
+
+/**
+ * Parses a kernel CPU list, such as "0-3,8,10-11", into the list of CPUs.
+ */
+StatusOr<std::vector<int>> ParseCPUList(std::string_view cpu_list);
+
+/**
+ * CPUTopology is the layout of the host's CPUs into NUMA nodes, as reported by sysfs.
+ *
+ * It is used to keep threads that share data on one node, so that their memory is allocated on,
+ * and read from, that node.
+ */
+class CPUTopology {
+ public:
+  /**
+   * Reads the topology from <sysfs_path>/devices/system/node.
+   */
+  static StatusOr<CPUTopology> Read(const std::filesystem::path& sysfs_path);
+
+  /**
+   * The topology of the host, read once. A host whose topology can't be read is treated as
+   * having no NUMA nodes, so that nothing gets pinned.
+   */
+  static const CPUTopology& Host();
+
+  explicit CPUTopology(std::map<int, std::vector<int>> node_cpus)
+      : node_cpus_(std::move(node_cpus)) {}
+
+  size_t num_nodes() const { return node_cpus_.size(); }
+  const std::map<int, std::vector<int>>& node_cpus() const { return node_cpus_; }
+
+  /**
+   * Resolves a placement setting to a node:
+   *   "none" leaves threads unpinned;
+   *   "auto" picks the node that holds the agent's data, which is the first node, but only on
+   *          hosts with more than one node;
+   *   a number picks that node.
+   *
+   * @return The node, or -1 to leave threads unpinned.
+   */
+  StatusOr<int> ResolveNode(std::string_view placement) const;
+
+  /**
+   * Restricts the calling thread to the CPUs of the node. Does nothing if node is negative.
+   */
+  Status PinCurrentThread(int node) const;
+
+ private:
+  std::map<int, std::vector<int>> node_cpus_;
+};
+
+/**
+ * Pins the calling thread to the host NUMA node chosen by a placement setting, as resolved by
+ * CPUTopology::ResolveNode().
+ */
+Status PinCurrentThreadToNUMANode(std::string_view placement);
+
+}  // namespace system
+}  // namespace px
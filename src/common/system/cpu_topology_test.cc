@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "src/common/system/cpu_topology.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace system {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+TEST(ParseCPUListTest, RangesAndSingles) {
+  EXPECT_OK_AND_THAT(ParseCPUList("0-3,8,10-11\n"), ElementsAre(0, 1, 2, 3, 8, 10, 11));
+  EXPECT_OK_AND_THAT(ParseCPUList("\n"), IsEmpty());
+  EXPECT_NOT_OK(ParseCPUList("3-1"));
+  EXPECT_NOT_OK(ParseCPUList("0-1-2"));
+  EXPECT_NOT_OK(ParseCPUList("a"));
+}
+
+class CPUTopologyTest : public ::testing::Test {
+ protected:
+  void AddNode(std::string_view name, std::string_view cpu_list) {
+    std::filesystem::path node_path = temp_dir_.path() / "devices/system/node" / name;
+    std::filesystem::create_directories(node_path);
+    ASSERT_OK(WriteFileFromString((node_path / "cpulist").string(), cpu_list));
+  }
+
+  px::testing::TempDir temp_dir_;
+};
+
+TEST_F(CPUTopologyTest, TwoNodes) {
+  AddNode("node0", "0-1,4-5\n");
+  AddNode("node1", "2-3,6-7\n");
+  // A memory-only node.
+  AddNode("node2", "\n");
+  std::filesystem::create_directories(temp_dir_.path() / "devices/system/node/power");
+
+  ASSERT_OK_AND_ASSIGN(CPUTopology topology, CPUTopology::Read(temp_dir_.path()));
+  EXPECT_THAT(topology.node_cpus(),
+              ElementsAre(Pair(0, ElementsAre(0, 1, 4, 5)), Pair(1, ElementsAre(2, 3, 6, 7))));
+
+  EXPECT_OK_AND_EQ(topology.ResolveNode("auto"), 0);
+  EXPECT_OK_AND_EQ(topology.ResolveNode("none"), -1);
+  EXPECT_OK_AND_EQ(topology.ResolveNode("1"), 1);
+  EXPECT_NOT_OK(topology.ResolveNode("2"));
+  EXPECT_NOT_OK(topology.ResolveNode("first"));
+}
+
+TEST_F(CPUTopologyTest, SingleNodeIsNotPinned) {
+  AddNode("node0", "0-7\n");
+
+  ASSERT_OK_AND_ASSIGN(CPUTopology topology, CPUTopology::Read(temp_dir_.path()));
+  EXPECT_OK_AND_EQ(topology.ResolveNode("auto"), -1);
+  EXPECT_OK_AND_EQ(topology.ResolveNode("0"), 0);
+}
+
+TEST_F(CPUTopologyTest, MissingTopology) { EXPECT_NOT_OK(CPUTopology::Read(temp_dir_.path())); }
+
+TEST_F(CPUTopologyTest, PinCurrentThread) {
+  AddNode("node0", "0\n");
+
+  ASSERT_OK_AND_ASSIGN(CPUTopology topology, CPUTopology::Read(temp_dir_.path()));
+  // Unpinned threads are left alone.
+  EXPECT_OK(topology.PinCurrentThread(-1));
+  EXPECT_NOT_OK(topology.PinCurrentThread(1));
+}
+
+}  // namespace system
+}  // namespace px
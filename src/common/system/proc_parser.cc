@@ -16,6 +16,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <limits>
 #include <string>
@@ -26,6 +33,8 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_split.h>
 #include <absl/strings/substitute.h>
 
 #include "src/common/fs/fs_wrapper.h"
@@ -273,6 +282,172 @@ Status ProcParser::ParseProcPIDStat(int32_t pid, int64_t page_size_bytes,
   return Status::OK();
 }
 
+namespace {
+
+// Large enough for /proc/<pid>/stat and /proc/<pid>/io, which are a few hundred bytes.
+constexpr size_t kSmallProcFileBufSize = 4096;
+
+// Reads all of a small file, such as /proc/<pid>/stat, into buf.
+StatusOr<std::string_view> ReadSmallFile(const char* fpath, char* buf, size_t buf_size) {
+  int fd = open(fpath, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open file $0", fpath);
+  }
+  size_t len = 0;
+  while (len < buf_size) {
+    ssize_t retval = read(fd, buf + len, buf_size - len);
+    if (retval < 0 && errno == EINTR) {
+      continue;
+    }
+    if (retval < 0) {
+      close(fd);
+      return error::Internal("Failed to read file $0 [errno=$1]", fpath, errno);
+    }
+    if (retval == 0) {
+      break;
+    }
+    len += retval;
+  }
+  close(fd);
+  if (len == buf_size) {
+    return error::Internal("File $0 is larger than $1 bytes", fpath, buf_size);
+  }
+  return std::string_view(buf, len);
+}
+
+// The in-place equivalent of the parsing in ParseProcPIDStat().
+Status ParseStatContents(std::string_view contents, int64_t page_size_bytes,
+                         int64_t kernel_tick_time_ns, ProcParser::ProcessStats* out) {
+  // The name is surrounded by (), and may contain spaces and parentheses itself.
+  size_t open_paren_idx = contents.find('(');
+  size_t close_paren_idx = contents.rfind(')');
+  if (open_paren_idx == std::string_view::npos || close_paren_idx == std::string_view::npos ||
+      close_paren_idx < open_paren_idx) {
+    return error::Internal("Invalid command name");
+  }
+  out->process_name.assign(contents.substr(open_paren_idx + 1,
+                                           close_paren_idx - open_paren_idx - 1));
+
+  bool ok = absl::SimpleAtoi(contents.substr(0, open_paren_idx), &out->pid);
+
+  // Fields after the name are numbered as if the name had no spaces, starting with the state.
+  int field = kProcStatPIDField + 2;
+  for (std::string_view token : absl::StrSplit(contents.substr(close_paren_idx + 1),
+                                               absl::ByAnyChar(" \n"), absl::SkipEmpty())) {
+    switch (field) {
+      case kProcStatMinorFaultsField:
+        ok &= absl::SimpleAtoi(token, &out->minor_faults);
+        break;
+      case kProcStatMajorFaultsField:
+        ok &= absl::SimpleAtoi(token, &out->major_faults);
+        break;
+      case kProcStatUTimeField:
+        ok &= absl::SimpleAtoi(token, &out->utime_ns);
+        break;
+      case kProcStatKTimeField:
+        ok &= absl::SimpleAtoi(token, &out->ktime_ns);
+        break;
+      case kProcStatNumThreadsField:
+        ok &= absl::SimpleAtoi(token, &out->num_threads);
+        break;
+      case kProcStatVSizeField:
+        ok &= absl::SimpleAtoi(token, &out->vsize_bytes);
+        break;
+      case kProcStatRSSField:
+        ok &= absl::SimpleAtoi(token, &out->rss_bytes);
+        break;
+      default:
+        break;
+    }
+    if (++field > kProcStatRSSField) {
+      break;
+    }
+  }
+  if (field <= kProcStatRSSField) {
+    return error::Unknown("Incorrect number of fields in stat file");
+  }
+  if (!ok) {
+    return error::Internal("Failed to parse stat file. ATOI failed.");
+  }
+
+  // The kernel tracks utime and ktime in kernel ticks, and RSS in pages.
+  out->utime_ns *= kernel_tick_time_ns;
+  out->ktime_ns *= kernel_tick_time_ns;
+  out->rss_bytes *= page_size_bytes;
+  return Status::OK();
+}
+
+// The in-place equivalent of the parsing in ParseProcPIDStatIO().
+void ParseIOContents(std::string_view contents, ProcParser::ProcessStats* out) {
+  out->rchar_bytes = 0;
+  out->wchar_bytes = 0;
+  out->read_bytes = 0;
+  out->write_bytes = 0;
+  for (std::string_view line : absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    size_t colon_idx = line.find(':');
+    if (colon_idx == std::string_view::npos) {
+      continue;
+    }
+    std::string_view key = line.substr(0, colon_idx);
+    std::string_view val = line.substr(colon_idx + 1);
+
+    int64_t* val_ptr = nullptr;
+    if (key == "rchar") {
+      val_ptr = &out->rchar_bytes;
+    } else if (key == "wchar") {
+      val_ptr = &out->wchar_bytes;
+    } else if (key == "read_bytes") {
+      val_ptr = &out->read_bytes;
+    } else if (key == "write_bytes") {
+      val_ptr = &out->write_bytes;
+    } else {
+      continue;
+    }
+    if (!absl::SimpleAtoi(val, val_ptr)) {
+      *val_ptr = -1;
+    }
+  }
+}
+
+}  // namespace
+
+void ProcParser::ParseProcPIDStats(const std::vector<int32_t>& pids, int64_t page_size_bytes,
+                                   int64_t kernel_tick_time_ns, std::vector<PIDStats>* out) const {
+  DCHECK(out != nullptr);
+  out->resize(pids.size());
+
+  char buf[kSmallProcFileBufSize];
+  std::string fpath;
+  for (size_t i = 0; i < pids.size(); ++i) {
+    PIDStats& entry = (*out)[i];
+    entry.pid = pids[i];
+
+    // Reuses the capacity of fpath, rather than building each path with Substitute().
+    fpath.assign(proc_base_path_);
+    absl::StrAppend(&fpath, "/", pids[i], "/stat");
+    auto contents_or = ReadSmallFile(fpath.c_str(), buf, sizeof(buf));
+    if (!contents_or.ok()) {
+      entry.status = contents_or.status();
+      continue;
+    }
+    entry.status =
+        ParseStatContents(contents_or.ValueOrDie(), page_size_bytes, kernel_tick_time_ns,
+                          &entry.stats);
+    if (!entry.status.ok()) {
+      continue;
+    }
+
+    fpath.resize(fpath.size() - std::string_view("stat").size());
+    fpath.append("io");
+    contents_or = ReadSmallFile(fpath.c_str(), buf, sizeof(buf));
+    if (!contents_or.ok()) {
+      entry.status = contents_or.status();
+      continue;
+    }
+    ParseIOContents(contents_or.ValueOrDie(), &entry.stats);
+  }
+}
+
 Status ProcParser::ParseProcPIDStatIO(int32_t pid, ProcessStats* out) const {
   /**
    * Sample file:
@@ -656,6 +831,42 @@ Status ProcParser::ReadProcPIDFDLink(int32_t pid, int32_t fd, std::string* out)
   return Status::OK();
 }
 
+StatusOr<int> ProcParser::OpenProcPIDFDDir(int32_t pid, std::vector<int32_t>* fds) const {
+  std::string fpath = ProcPidPath(pid) / "fd";
+  int dir_fd = open(fpath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd < 0) {
+    return error::Internal("Could not open $0: $1", fpath, std::strerror(errno));
+  }
+  // fdopendir() takes over the FD it is given, so it lists a duplicate of the returned one.
+  int list_fd = dup(dir_fd);
+  DIR* dir = list_fd < 0 ? nullptr : fdopendir(list_fd);
+  if (dir == nullptr) {
+    if (list_fd >= 0) {
+      close(list_fd);
+    }
+    close(dir_fd);
+    return error::Internal("Could not list $0: $1", fpath, std::strerror(errno));
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    int32_t fd;
+    if (absl::SimpleAtoi(entry->d_name, &fd)) {
+      fds->push_back(fd);
+    }
+  }
+  closedir(dir);
+  return dir_fd;
+}
+
+Status ProcParser::ReadProcPIDFDLinkAt(int dir_fd, int32_t fd, std::string* out) {
+  char buf[PATH_MAX];
+  ssize_t len = readlinkat(dir_fd, std::to_string(fd).c_str(), buf, sizeof(buf));
+  if (len < 0) {
+    return error::Internal("Could not read the link of FD $0: $1", fd, std::strerror(errno));
+  }
+  out->assign(buf, len);
+  return Status::OK();
+}
+
 std::string_view LineWithPrefix(std::string_view content, std::string_view prefix) {
   const std::vector<std::string_view> lines = absl::StrSplit(content, "\n");
   for (const auto& line : lines) {
@@ -197,6 +197,29 @@ class ProcParser {
   Status ParseProcPIDStat(int32_t pid, int64_t page_size_bytes, int64_t kernel_tick_time_ns,
                           ProcessStats* out) const;
 
+  /**
+   * The stats of one process, as returned by ParseProcPIDStats().
+   */
+  struct PIDStats {
+    int32_t pid = 0;
+    Status status;
+    ProcessStats stats;
+  };
+
+  /**
+   * Batched equivalent of ParseProcPIDStat() and ParseProcPIDStatIO(), for when the stats of
+   * many processes are needed. Each file is read with a single read(2), into a buffer shared by
+   * the whole batch, and parsed in place rather than through std::ifstream and line splitting.
+   * @param pids the processes for which we want stats.
+   * @param page_size_bytes The size of memory page in bytes.
+   * @param kernel_tick_time_ns The time of each kernel tick in nanoseconds.
+   * @param out Resized to one entry per pid, in the same order. Entries are overwritten in place,
+   * so a vector that is reused across calls does not need to allocate. Processes whose files could
+   * not be read (eg. because they exited) or parsed have an error status.
+   */
+  void ParseProcPIDStats(const std::vector<int32_t>& pids, int64_t page_size_bytes,
+                         int64_t kernel_tick_time_ns, std::vector<PIDStats>* out) const;
+
   /**
    * Specialization of ParseProcPIDStat to just extract the start time.
    * @param pid is the pid for which we want the start time.
@@ -295,6 +318,21 @@ class ProcParser {
    */
   Status ReadProcPIDFDLink(int32_t pid, int32_t fd, std::string* out) const;
 
+  /**
+   * Opens the /proc/<pid>/fd directory and lists the FDs in it, so that the links of many of them
+   * can be read with ReadProcPIDFDLinkAt() without resolving the directory for each.
+   *
+   * @param pid is the pid whose FDs we want.
+   * @param fds A valid pointer to the output FDs.
+   * @return the file descriptor of the directory, which the caller must close.
+   */
+  StatusOr<int> OpenProcPIDFDDir(int32_t pid, std::vector<int32_t>* fds) const;
+
+  /**
+   * Reads the link of a FD in a directory opened by OpenProcPIDFDDir().
+   */
+  static Status ReadProcPIDFDLinkAt(int dir_fd, int32_t fd, std::string* out);
+
   /**
    * UIDs associated with a process.
    */
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Compares parsing process stats one pid at a time against the batched ParseProcPIDStats(),
+// over a synthetic /proc tree with the given number of pids.
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+
+using ::px::system::ProcParser;
+
+namespace {
+
+constexpr int64_t kPageSizeBytes = 4096;
+constexpr int64_t kKernelTickTimeNS = 10000000;
+
+// Copies the stat and io files of the test pid to num_pids pid directories under the temp dir.
+std::vector<int32_t> CreateProcTree(const std::filesystem::path& proc_path, int num_pids) {
+  const std::filesystem::path src_dir =
+      px::testing::BazelRunfilePath("src/common/system/testdata/proc/123");
+  std::vector<int32_t> pids;
+  for (int i = 0; i < num_pids; ++i) {
+    const int32_t pid = 1000 + i;
+    const std::filesystem::path pid_dir = proc_path / std::to_string(pid);
+    std::filesystem::create_directory(pid_dir);
+    std::filesystem::copy_file(src_dir / "stat", pid_dir / "stat");
+    std::filesystem::copy_file(src_dir / "io", pid_dir / "io");
+    pids.push_back(pid);
+  }
+  return pids;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_ProcParserPerPID(benchmark::State& state) {
+  px::testing::TempDir tmp_dir;
+  std::vector<int32_t> pids = CreateProcTree(tmp_dir.path(), state.range(0));
+  ProcParser parser(tmp_dir.path().string());
+
+  for (auto _ : state) {
+    for (int32_t pid : pids) {
+      ProcParser::ProcessStats stats;
+      PL_UNUSED(parser.ParseProcPIDStat(pid, kPageSizeBytes, kKernelTickTimeNS, &stats));
+      PL_UNUSED(parser.ParseProcPIDStatIO(pid, &stats));
+      benchmark::DoNotOptimize(stats);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * pids.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_ProcParserBatched(benchmark::State& state) {
+  px::testing::TempDir tmp_dir;
+  std::vector<int32_t> pids = CreateProcTree(tmp_dir.path(), state.range(0));
+  ProcParser parser(tmp_dir.path().string());
+
+  std::vector<ProcParser::PIDStats> pid_stats;
+  for (auto _ : state) {
+    parser.ParseProcPIDStats(pids, kPageSizeBytes, kKernelTickTimeNS, &pid_stats);
+    benchmark::DoNotOptimize(pid_stats.data());
+  }
+  state.SetItemsProcessed(state.iterations() * pids.size());
+}
+
+BENCHMARK(BM_ProcParserPerPID)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_ProcParserBatched)->RangeMultiplier(4)->Range(64, 4096);
+
+}  // namespace
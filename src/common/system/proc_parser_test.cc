@@ -20,10 +20,12 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 #include <istream>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/testing/test_environment.h"
@@ -108,6 +110,42 @@ TEST_F(ProcParserTest, ParsePidStat) {
   EXPECT_EQ(2577 * bytes_per_page_, stats.rss_bytes);
 }
 
+TEST_F(ProcParserTest, ParsePidStats) {
+  std::vector<ProcParser::PIDStats> pid_stats;
+  parser_->ParseProcPIDStats({123, 456, 999}, bytes_per_page_, kernel_tick_time_ns_, &pid_stats);
+  ASSERT_EQ(pid_stats.size(), 3U);
+
+  // The expected values are the same as from ParseProcPIDStat() and ParseProcPIDStatIO().
+  ASSERT_OK(pid_stats[0].status);
+  const ProcParser::ProcessStats& stats = pid_stats[0].stats;
+  EXPECT_EQ(123, pid_stats[0].pid);
+  EXPECT_EQ(4602, stats.pid);
+  EXPECT_EQ("npm (start)", stats.process_name);
+  EXPECT_EQ(800, stats.utime_ns);
+  EXPECT_EQ(2300, stats.ktime_ns);
+  EXPECT_EQ(13, stats.num_threads);
+  EXPECT_EQ(55, stats.major_faults);
+  EXPECT_EQ(1799, stats.minor_faults);
+  EXPECT_EQ(114384896, stats.vsize_bytes);
+  EXPECT_EQ(2577 * bytes_per_page_, stats.rss_bytes);
+  EXPECT_EQ(5405203, stats.rchar_bytes);
+  EXPECT_EQ(1239158, stats.wchar_bytes);
+  EXPECT_EQ(17838080, stats.read_bytes);
+  EXPECT_EQ(634880, stats.write_bytes);
+
+  // 456 has no io file, and 999 does not exist.
+  EXPECT_EQ(456, pid_stats[1].pid);
+  EXPECT_NOT_OK(pid_stats[1].status);
+  EXPECT_EQ(999, pid_stats[2].pid);
+  EXPECT_NOT_OK(pid_stats[2].status);
+
+  // A reused output vector is resized to the new batch.
+  parser_->ParseProcPIDStats({123}, bytes_per_page_, kernel_tick_time_ns_, &pid_stats);
+  ASSERT_EQ(pid_stats.size(), 1U);
+  ASSERT_OK(pid_stats[0].status);
+  EXPECT_EQ("npm (start)", pid_stats[0].stats.process_name);
+}
+
 TEST_F(ProcParserTest, ParsePidStatLargePageSize) {
   int64_t large_page_size = 2147483648;  // 2.1 GB (INT_MAX + 1)
   ProcParser::ProcessStats stats;
@@ -304,6 +342,15 @@ TEST_F(ProcParserTest, read_proc_fd_link) {
 
   s = parser_->ReadProcPIDFDLink(123, 3, &out);
   EXPECT_NOT_OK(s);
+
+  // The links can also be read from the listed FD directory.
+  std::vector<int32_t> fds;
+  ASSERT_OK_AND_ASSIGN(int dir_fd, parser_->OpenProcPIDFDDir(123, &fds));
+  EXPECT_THAT(fds, ::testing::IsSupersetOf({0, 1, 2}));
+  EXPECT_OK(ProcParser::ReadProcPIDFDLinkAt(dir_fd, 2, &out));
+  EXPECT_EQ("socket:[12345]", out);
+  EXPECT_NOT_OK(ProcParser::ReadProcPIDFDLinkAt(dir_fd, 3, &out));
+  close(dir_fd);
 }
 
 TEST_F(ProcParserTest, ReadUIDs) {
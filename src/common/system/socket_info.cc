@@ -117,7 +117,7 @@ Status NetlinkSocketProber::SendDiagReq(const TDiagReqType& msg_req) {
 namespace {
 
 Status ProcessDiagMsg(const struct inet_diag_msg& diag_msg, unsigned int len,
-                      std::map<int, SocketInfo>* socket_info_entries) {
+                      SocketInfoMap* socket_info_entries) {
   if (len < NLMSG_LENGTH(sizeof(diag_msg))) {
     return error::Internal("Not enough bytes");
   }
@@ -160,7 +160,7 @@ Status ProcessDiagMsg(const struct inet_diag_msg& diag_msg, unsigned int len,
 }
 
 Status ProcessDiagMsg(const struct unix_diag_msg& diag_msg, unsigned int len,
-                      std::map<int, SocketInfo>* socket_info_entries) {
+                      SocketInfoMap* socket_info_entries) {
   if (len < NLMSG_LENGTH(sizeof(diag_msg))) {
     return error::Internal("Not enough bytes");
   }
@@ -211,7 +211,7 @@ Status ProcessDiagMsg(const struct unix_diag_msg& diag_msg, unsigned int len,
 }  // namespace
 
 template <typename TDiagMsgType>
-Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_entries) {
+Status NetlinkSocketProber::RecvDiagResp(SocketInfoMap* socket_info_entries) {
   static constexpr int kBufSize = 8192;
   uint8_t buf[kBufSize];
 
@@ -250,7 +250,7 @@ Status NetlinkSocketProber::RecvDiagResp(std::map<int, SocketInfo>* socket_info_
 }
 
 namespace {
-void ClassifySocketRoles(std::map<int, SocketInfo>* socket_info_entries) {
+void ClassifySocketRoles(SocketInfoMap* socket_info_entries) {
   absl::flat_hash_set<SockAddrIPv4, SockAddrIPv4HashFn, SockAddrIPv4EqFn> ipv4_listening_sockets;
   absl::flat_hash_set<SockAddrIPv6, SockAddrIPv6HashFn, SockAddrIPv6EqFn> ipv6_listening_sockets;
 
@@ -302,8 +302,7 @@ void ClassifySocketRoles(std::map<int, SocketInfo>* socket_info_entries) {
 }
 }  // namespace
 
-Status NetlinkSocketProber::InetConnections(std::map<int, SocketInfo>* socket_info_entries,
-                                            int conn_states) {
+Status NetlinkSocketProber::InetConnections(SocketInfoMap* socket_info_entries, int conn_states) {
   struct inet_diag_req_v2 msg_req = {};
   msg_req.sdiag_protocol = IPPROTO_TCP;
   msg_req.idiag_states = conn_states;
@@ -326,8 +325,7 @@ Status NetlinkSocketProber::InetConnections(std::map<int, SocketInfo>* socket_in
   return Status::OK();
 }
 
-Status NetlinkSocketProber::UnixConnections(std::map<int, SocketInfo>* socket_info_entries,
-                                            int conn_states) {
+Status NetlinkSocketProber::UnixConnections(SocketInfoMap* socket_info_entries, int conn_states) {
   struct unix_diag_req msg_req = {};
   msg_req.sdiag_family = AF_UNIX;
   msg_req.udiag_states = conn_states;
@@ -338,6 +336,23 @@ Status NetlinkSocketProber::UnixConnections(std::map<int, SocketInfo>* socket_in
   return Status::OK();
 }
 
+Status NetlinkSocketProber::UDPConnections(SocketInfoMap* socket_info_entries) {
+  struct inet_diag_req_v2 msg_req = {};
+  msg_req.sdiag_protocol = IPPROTO_UDP;
+  // The kernel reports connected UDP sockets as established.
+  msg_req.idiag_states = kTCPEstablishedState;
+
+  msg_req.sdiag_family = AF_INET;
+  PL_RETURN_IF_ERROR(SendDiagReq(msg_req));
+  PL_RETURN_IF_ERROR(RecvDiagResp<struct inet_diag_msg>(socket_info_entries));
+
+  msg_req.sdiag_family = AF_INET6;
+  PL_RETURN_IF_ERROR(SendDiagReq(msg_req));
+  PL_RETURN_IF_ERROR(RecvDiagResp<struct inet_diag_msg>(socket_info_entries));
+
+  return Status::OK();
+}
+
 //-----------------------------------------------------------------------------
 // PIDsByNetNamespace
 //-----------------------------------------------------------------------------
@@ -468,38 +483,59 @@ StatusOr<std::unique_ptr<SocketInfoManager>> SocketInfoManager::Create(
   return socket_info_db_ptr;
 }
 
-StatusOr<std::map<int, SocketInfo>*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
+StatusOr<uint32_t> SocketInfoManager::PIDNetNamespace(uint32_t pid) {
+  auto iter = net_ns_by_pid_.find(pid);
+  if (iter != net_ns_by_pid_.end()) {
+    return iter->second;
+  }
   PL_ASSIGN_OR_RETURN(uint32_t net_ns, NetNamespace(cfg_proc_path_, pid));
+  net_ns_by_pid_[pid] = net_ns;
+  return net_ns;
+}
+
+StatusOr<SocketInfoMap*> SocketInfoManager::GetNamespaceConns(uint32_t pid) {
+  PL_ASSIGN_OR_RETURN(uint32_t net_ns, PIDNetNamespace(pid));
 
   // Step 1: Get the map of connections for this network namespace.
   // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
-
   auto ns_iter = connections_.find(net_ns);
   if (ns_iter != connections_.end()) {
     // Found a map of connections for this network namespace, so use it.
-    namespace_conns = &ns_iter->second;
-  } else {
-    // No map of connections for this network namespace, so use a socker prober to populate one.
-    PL_ASSIGN_OR_RETURN(NetlinkSocketProber * socket_prober,
-                        socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)}));
-    DCHECK(socket_prober != nullptr);
+    return &ns_iter->second;
+  }
 
-    ns_iter = connections_.insert(ns_iter, {net_ns, {}});
-    namespace_conns = &ns_iter->second;
+  if (failed_namespaces_.contains(net_ns)) {
+    return error::Internal("Could not probe network namespace $0 in this iteration.", net_ns);
+  }
 
-    Status s;
+  // No map of connections for this network namespace, so use a socket prober to populate one.
+  StatusOr<NetlinkSocketProber*> socket_prober_or =
+      socket_probers_->GetOrCreateSocketProber(net_ns, {static_cast<int>(pid)});
+  if (!socket_prober_or.ok()) {
+    failed_namespaces_.insert(net_ns);
+    return socket_prober_or.status();
+  }
+  NetlinkSocketProber* socket_prober = socket_prober_or.ValueOrDie();
+  DCHECK(socket_prober != nullptr);
 
-    s = socket_prober->InetConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  SocketInfoMap* namespace_conns = &connections_[net_ns];
 
-    s = socket_prober->UnixConnections(namespace_conns, cfg_conn_states_);
-    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UnixConnections [net_ns=$0 msg=$1]",
-                                               net_ns, s.msg());
+  Status s;
 
-    ++num_socket_prober_calls_;
-  }
+  // TCP must be probed first, since its role classification expects only TCP sockets.
+  s = socket_prober->InetConnections(namespace_conns, cfg_conn_states_);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe InetConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
+
+  s = socket_prober->UDPConnections(namespace_conns);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UDPConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
+
+  s = socket_prober->UnixConnections(namespace_conns, cfg_conn_states_);
+  LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to probe UnixConnections [net_ns=$0 msg=$1]",
+                                             net_ns, s.msg());
+
+  ++num_socket_prober_calls_;
 
   return namespace_conns;
 }
@@ -507,16 +543,16 @@ StatusOr<std::map<int, SocketInfo>*> SocketInfoManager::GetNamespaceConns(uint32
 StatusOr<SocketInfo*> SocketInfoManager::Lookup(uint32_t pid, uint32_t inode_num) {
   // Step 1: Get the map of connections for this network namespace.
   // Create the map if it doesn't already exist.
-  std::map<int, SocketInfo>* namespace_conns;
+  SocketInfoMap* namespace_conns;
   PL_ASSIGN_OR_RETURN(namespace_conns, GetNamespaceConns(pid));
 
   // Step 2: Lookup the inode.
   auto iter = namespace_conns->find(inode_num);
   if (iter == namespace_conns->end()) {
     return error::NotFound(
-        "Likely not a TCP/Unix connection (might be some other socket type). Alternatively, might "
-        "be looking in the wrong net namespace, which can happen if the target PID has connections "
-        "in multiple namespaces.");
+        "Likely not a TCP/UDP/Unix connection (might be some other socket type). Alternatively, "
+        "might be looking in the wrong net namespace, which can happen if the target PID has "
+        "connections in multiple namespaces.");
   }
 
   return &iter->second;
@@ -524,7 +560,10 @@ StatusOr<SocketInfo*> SocketInfoManager::Lookup(uint32_t pid, uint32_t inode_num
 
 void SocketInfoManager::Flush() {
   socket_probers_->Update();
+
   connections_.clear();
+  net_ns_by_pid_.clear();
+  failed_namespaces_.clear();
   num_socket_prober_calls_ = 0;
 }
 
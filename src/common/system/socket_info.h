@@ -27,6 +27,9 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/fs/inode_utils.h"
 
@@ -83,6 +86,9 @@ struct SocketInfo {
   ClientServerRole role = ClientServerRole::kUnknown;
 };
 
+// Socket information keyed by socket inode number.
+using SocketInfoMap = absl::flat_hash_map<uint32_t, SocketInfo>;
+
 /**
  * The NetlinkSocketProber class uses NetLink to probe the Linux kernel about active connections.
  */
@@ -114,7 +120,7 @@ class NetlinkSocketProber {
    *
    * @return error if connection information could not be obtained from kernel.
    */
-  Status InetConnections(std::map<int, SocketInfo>* socket_info_entries,
+  Status InetConnections(SocketInfoMap* socket_info_entries,
                          int conn_states = kTCPEstablishedState);
 
   /**
@@ -126,9 +132,20 @@ class NetlinkSocketProber {
    *
    * @return error if connection information could not be obtained from kernel.
    */
-  Status UnixConnections(std::map<int, SocketInfo>* socket_info_entries,
+  Status UnixConnections(SocketInfoMap* socket_info_entries,
                          int conn_states = kTCPEstablishedState);
 
+  /**
+   * Finds connected IPv4 or IPv6 UDP sockets. Unconnected UDP sockets have no remote endpoint,
+   * so they are not returned.
+   *
+   * @param socket_info_entries map of inode to SocketInfoEntry that will be populated with
+   * connected sockets.
+   *
+   * @return error if connection information could not be obtained from kernel.
+   */
+  Status UDPConnections(SocketInfoMap* socket_info_entries);
+
  private:
   NetlinkSocketProber() = default;
 
@@ -138,7 +155,7 @@ class NetlinkSocketProber {
   Status SendDiagReq(const TDiagReqType& msg_req);
 
   template <typename TDiagMsgType>
-  Status RecvDiagResp(std::map<int, SocketInfo>* socket_info_entries);
+  Status RecvDiagResp(SocketInfoMap* socket_info_entries);
 
   int fd_ = -1;
 };
@@ -251,6 +268,11 @@ class SocketProberManager {
  * network namespace, the information is gathered and then cached. Future queries will operate off
  * that snapshot of the known connections, for efficiency.
  *
+ * A snapshot holds the TCP, connected UDP and Unix domain sockets of the namespace, gathered with
+ * one batch of netlink dumps, so that any number of lookups within an iteration cost one hash
+ * lookup each. The network namespace of each PID, and any namespace that could not be probed,
+ * are also cached until the next Flush().
+ *
  * Note that no attempt is made to check if new connections have been created after the snapshot is
  * established. This responsibility is on the user, who must explicitly call Flush(), so that new
  * connections can be discovered.
@@ -275,7 +297,7 @@ class SocketInfoManager {
    * @return A map with inode number as key, and socket information as value. Returns error if
    * information could not be queried.
    */
-  StatusOr<std::map<int, system::SocketInfo>*> GetNamespaceConns(uint32_t pid);
+  StatusOr<SocketInfoMap*> GetNamespaceConns(uint32_t pid);
 
   /**
    * Search for the socket info of a given inode number.
@@ -310,9 +332,18 @@ class SocketInfoManager {
   // See connection states at the top of this file.
   const int cfg_conn_states_;
 
+  StatusOr<uint32_t> PIDNetNamespace(uint32_t pid);
+
   // Two-level to socket information:
   // First key is namespace inode; second key is socket inode.
-  std::map<int, std::map<int, SocketInfo>> connections_;
+  absl::flat_hash_map<uint32_t, SocketInfoMap> connections_;
+
+  // Network namespace of each PID looked up since the last Flush().
+  absl::flat_hash_map<uint32_t, uint32_t> net_ns_by_pid_;
+
+  // Namespaces that could not be probed since the last Flush(), so they are not retried on every
+  // lookup.
+  absl::flat_hash_set<uint32_t> failed_namespaces_;
 
   // Portal through which new connection information is gathered,
   // and populated into connections_.
@@ -49,7 +49,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
@@ -63,7 +63,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create(container_.process_pid()));
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
@@ -75,7 +75,7 @@ TEST_F(NetNamespaceTest, NetlinkSocketProber) {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
 
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     int num_conns = socket_info_entries.size();
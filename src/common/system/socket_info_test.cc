@@ -31,6 +31,7 @@
 #include "src/common/system/proc_parser.h"
 #include "src/common/system/socket_info.h"
 #include "src/common/system/tcp_socket.h"
+#include "src/common/system/udp_socket.h"
 #include "src/common/testing/testing.h"
 
 namespace px {
@@ -86,7 +87,7 @@ TEST(NetlinkSocketProberTest, EstablishedInetConnection) {
 
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoMap socket_info_entries;
   ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
 
   EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(client_endpoint)));
@@ -137,7 +138,7 @@ TEST(NetlinkSocketProberTest, EstablishedUnixConnection) {
   // Now begin the test of NetlinkSocketProber.
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoMap socket_info_entries;
   ASSERT_OK(socket_prober->UnixConnections(&socket_info_entries));
 
   EXPECT_THAT(socket_info_entries, Contains(HasLocalUnixEndpoint(client_socket_id)));
@@ -158,7 +159,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
     EXPECT_THAT(socket_info_entries, Not(Contains(HasLocalIPEndpoint(server_endpoint))));
   }
@@ -167,7 +168,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPListeningState));
     EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(server_endpoint)));
   }
@@ -176,7 +177,7 @@ TEST(NetlinkSocketProberTest, ListeningInetConnection) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
     EXPECT_THAT(socket_info_entries, Contains(HasLocalIPEndpoint(server_endpoint)));
@@ -195,7 +196,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
 
@@ -224,7 +225,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries,
                                              kTCPEstablishedState | kTCPListeningState));
 
@@ -250,7 +251,7 @@ TEST(NetlinkSocketProberTest, DetectRole) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                          NetlinkSocketProber::Create());
-    std::map<int, SocketInfo> socket_info_entries;
+    SocketInfoMap socket_info_entries;
     ASSERT_OK(socket_prober->InetConnections(&socket_info_entries, kTCPEstablishedState));
 
     int server_socket_count = 0;
@@ -290,12 +291,50 @@ TEST(NetlinkSocketProberTest, ClosedInetConnection) {
 
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
                        NetlinkSocketProber::Create());
-  std::map<int, SocketInfo> socket_info_entries;
+  SocketInfoMap socket_info_entries;
   ASSERT_OK(socket_prober->InetConnections(&socket_info_entries));
 
   EXPECT_THAT(socket_info_entries, Not(Contains(HasLocalIPEndpoint(client_endpoint))));
 }
 
+TEST(NetlinkSocketProberTest, ConnectedUDPSocket) {
+  UDPSocket server;
+  UDPSocket client;
+  UDPSocket unconnected;
+  server.BindAndListen();
+  client.BindAndListen();
+  unconnected.BindAndListen();
+
+  // Connecting a UDP socket only sets its default destination.
+  struct sockaddr_in server_addr = server.sockaddr();
+  ASSERT_EQ(connect(client.sockfd(), reinterpret_cast<struct sockaddr*>(&server_addr),
+                    sizeof(server_addr)),
+            0)
+      << absl::Substitute("connect() failed with errno=$0", errno);
+
+  auto proc_parser = std::make_unique<system::ProcParser>(system::Config::GetInstance());
+  std::string client_fd_link;
+  ASSERT_OK(proc_parser->ReadProcPIDFDLink(getpid(), client.sockfd(), &client_fd_link));
+  ASSERT_OK_AND_ASSIGN(uint32_t client_inode,
+                       fs::ExtractInodeNum(fs::kSocketInodePrefix, client_fd_link));
+  std::string unconnected_fd_link;
+  ASSERT_OK(proc_parser->ReadProcPIDFDLink(getpid(), unconnected.sockfd(), &unconnected_fd_link));
+  ASSERT_OK_AND_ASSIGN(uint32_t unconnected_inode,
+                       fs::ExtractInodeNum(fs::kSocketInodePrefix, unconnected_fd_link));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlinkSocketProber> socket_prober,
+                       NetlinkSocketProber::Create());
+  SocketInfoMap socket_info_entries;
+  ASSERT_OK(socket_prober->UDPConnections(&socket_info_entries));
+
+  auto iter = socket_info_entries.find(client_inode);
+  ASSERT_NE(iter, socket_info_entries.end());
+  EXPECT_EQ(iter->second.family, AF_INET);
+  EXPECT_EQ(iter->second.remote_port, server.port());
+  EXPECT_EQ(iter->second.role, ClientServerRole::kUnknown);
+  EXPECT_FALSE(socket_info_entries.contains(unconnected_inode));
+}
+
 class NetNamespaceTest : public ::testing::Test {
  protected:
   void SetUp() override {
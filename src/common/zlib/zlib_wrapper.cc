@@ -16,47 +16,261 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+
+#include "src/common/zlib/zlib_wrapper.h"
+
 #include <zlib.h>
+#include <algorithm>
+#include <memory>
 #include <string>
 
 #include "src/common/base/base.h"
-#include "src/common/zlib/zlib_wrapper.h"
 
 namespace px {
 namespace zlib {
 
-StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
-  z_stream zs = {};
+namespace {
 
-  if (inflateInit2(&zs, MAX_WBITS + 16) != Z_OK) {
-    return error::Internal("inflateInit2 failed while decompressing.");
+int WindowBits(Format format) {
+  switch (format) {
+    case Format::kGzip:
+      return MAX_WBITS + 16;
+    case Format::kZlib:
+      return MAX_WBITS;
+    case Format::kAuto:
+      return MAX_WBITS + 32;
+  }
+  return MAX_WBITS;
+}
+
+const char* ZlibMessage(const z_stream& zs, const char* fallback) {
+  return zs.msg != nullptr ? zs.msg : fallback;
+}
+
+// The streams used by the one-shot functions are kept per thread, since HTTP bodies may be
+// decompressed by the parallel transfer workers.
+Inflater* ThreadInflater(Format format) {
+  thread_local Inflater inflater;
+  return inflater.Reset(format).ok() ? &inflater : nullptr;
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+// Inflater
+//-----------------------------------------------------------------------------
+
+Inflater::~Inflater() {
+  if (initialized_) {
+    inflateEnd(&zs_);
+  }
+}
+
+Status Inflater::Init() {
+  zs_ = {};
+  if (inflateInit2(&zs_, WindowBits(format_)) != Z_OK) {
+    return error::Internal("inflateInit2 failed.");
+  }
+  initialized_ = true;
+  return Status::OK();
+}
+
+Status Inflater::Reset(Format format) {
+  format_ = format;
+  if (!initialized_) {
+    return Init();
+  }
+  if (inflateReset2(&zs_, WindowBits(format_)) != Z_OK) {
+    return error::Internal("inflateReset2 failed.");
+  }
+  return Status::OK();
+}
+
+StatusOr<StreamProgress> Inflater::Inflate(std::string_view in, absl::Span<char> out) {
+  if (!initialized_) {
+    PL_RETURN_IF_ERROR(Init());
+  }
+
+  zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs_.avail_in = in.size();
+  zs_.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs_.avail_out = out.size();
+
+  int ret = inflate(&zs_, Z_SYNC_FLUSH);
+
+  StreamProgress progress;
+  progress.bytes_read = in.size() - zs_.avail_in;
+  progress.bytes_written = out.size() - zs_.avail_out;
+  progress.stream_end = ret == Z_STREAM_END;
+
+  // Z_BUF_ERROR only means no progress was possible with the buffers given.
+  if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+    return error::Internal("Exception during zlib decompression: $0",
+                           ZlibMessage(zs_, "unknown error"));
+  }
+  return progress;
+}
+
+//-----------------------------------------------------------------------------
+// Deflater
+//-----------------------------------------------------------------------------
+
+Deflater::~Deflater() {
+  if (initialized_) {
+    deflateEnd(&zs_);
+  }
+}
+
+Status Deflater::Init() {
+  if (format_ == Format::kAuto) {
+    return error::InvalidArgument("Compression needs an explicit format.");
   }
+  zs_ = {};
+  if (deflateInit2(&zs_, level_, Z_DEFLATED, WindowBits(format_), /* memLevel */ 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return error::Internal("deflateInit2 failed.");
+  }
+  initialized_ = true;
+  return Status::OK();
+}
+
+Status Deflater::Reset() {
+  if (!initialized_) {
+    return Init();
+  }
+  if (deflateReset(&zs_) != Z_OK) {
+    return error::Internal("deflateReset failed.");
+  }
+  return Status::OK();
+}
+
+StatusOr<size_t> Deflater::Bound(size_t in_size) {
+  if (!initialized_) {
+    PL_RETURN_IF_ERROR(Init());
+  }
+  return deflateBound(&zs_, in_size);
+}
+
+StatusOr<StreamProgress> Deflater::Deflate(std::string_view in, absl::Span<char> out,
+                                           bool finish) {
+  if (!initialized_) {
+    PL_RETURN_IF_ERROR(Init());
+  }
+
+  zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs_.avail_in = in.size();
+  zs_.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs_.avail_out = out.size();
+
+  int ret = deflate(&zs_, finish ? Z_FINISH : Z_NO_FLUSH);
+
+  StreamProgress progress;
+  progress.bytes_read = in.size() - zs_.avail_in;
+  progress.bytes_written = out.size() - zs_.avail_out;
+  progress.stream_end = ret == Z_STREAM_END;
+
+  if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+    return error::Internal("Exception during zlib compression: $0",
+                           ZlibMessage(zs_, "unknown error"));
+  }
+  return progress;
+}
+
+//-----------------------------------------------------------------------------
+// One-shot functions
+//-----------------------------------------------------------------------------
 
-  // Setup input buffer.
-  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
-  zs.avail_in = in.size();
+StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size,
+                              size_t max_output_bytes) {
+  Inflater* inflater = ThreadInflater(Format::kGzip);
+  if (inflater == nullptr) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
 
-  int ret;
   std::string out;
+  size_t out_size = 0;
 
   // Get the decompressed bytes blockwise using repeated calls to inflate.
-  do {
-    out.resize(out.size() + output_block_size);
-    zs.next_out = reinterpret_cast<Bytef*>(out.data() + zs.total_out);
-    zs.avail_out = out.size() - zs.total_out;
+  while (true) {
+    if (out_size == out.size()) {
+      if (out_size >= max_output_bytes) {
+        return error::ResourceUnavailable(
+            "Exception during zlib decompression: output exceeds $0 bytes", max_output_bytes);
+      }
+      out.resize(std::min(out.size() + output_block_size, max_output_bytes));
+    }
+    PL_ASSIGN_OR_RETURN(StreamProgress progress,
+                        inflater->Inflate(in, absl::MakeSpan(out).subspan(out_size)));
+    in.remove_prefix(progress.bytes_read);
+    out_size += progress.bytes_written;
+    if (progress.stream_end) {
+      break;
+    }
+    if (progress.bytes_read == 0 && progress.bytes_written == 0 && out_size < out.size()) {
+      return error::Internal("Exception during zlib decompression: truncated input");
+    }
+  }
+
+  out.resize(out_size);
+  return out;
+}
+
+StatusOr<size_t> InflateInto(std::string_view in, absl::Span<char> out) {
+  Inflater* inflater = ThreadInflater(Format::kAuto);
+  if (inflater == nullptr) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
 
-    ret = inflate(&zs, 0);
-  } while (ret == Z_OK);
+  // With all the input and the whole output buffer available, a single call either reaches the
+  // end of the stream, fills the output, or runs out of input.
+  PL_ASSIGN_OR_RETURN(StreamProgress progress, inflater->Inflate(in, out));
+  if (!progress.stream_end) {
+    return error::ResourceUnavailable(
+        "Exception during zlib decompression: $0",
+        progress.bytes_written == out.size() ? "output buffer too small" : "truncated input");
+  }
+  return progress.bytes_written;
+}
 
-  out.resize(zs.total_out);
+StatusOr<std::string> InflatePrefix(std::string_view in, size_t max_output_bytes) {
+  Inflater* inflater = ThreadInflater(Format::kAuto);
+  if (inflater == nullptr) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
 
-  inflateEnd(&zs);
+  std::string out(max_output_bytes, '\0');
 
-  if (ret != Z_STREAM_END) {
-    // An error occurred that was not EOF.
-    return error::Internal("Exception during zlib decompression: $0", zs.msg);
+  // With all the input and the whole output buffer available, a single call either fills the
+  // output, reaches the end of the stream, or runs out of input, which is not an error here.
+  PL_ASSIGN_OR_RETURN(StreamProgress progress, inflater->Inflate(in, absl::MakeSpan(out)));
+  out.resize(progress.bytes_written);
+  return out;
+}
+
+StatusOr<std::string> Deflate(std::string_view in, int level) {
+  // zlib fixes the level when the deflate state is set up, so only the default level is pooled;
+  // the others are rarely used.
+  std::unique_ptr<Deflater> owned;
+  Deflater* deflater;
+  if (level == Z_DEFAULT_COMPRESSION) {
+    thread_local Deflater default_deflater;
+    deflater = &default_deflater;
+  } else {
+    owned = std::make_unique<Deflater>(Format::kGzip, level);
+    deflater = owned.get();
   }
+  PL_RETURN_IF_ERROR(deflater->Reset());
 
+  PL_ASSIGN_OR_RETURN(size_t bound, deflater->Bound(in.size()));
+  std::string out(bound, '\0');
+
+  // The output buffer is sized by Bound(), so a single call compresses all of the input.
+  PL_ASSIGN_OR_RETURN(StreamProgress progress,
+                      deflater->Deflate(in, absl::MakeSpan(out), /* finish */ true));
+  if (!progress.stream_end) {
+    return error::Internal("Exception during zlib compression: output buffer too small");
+  }
+  out.resize(progress.bytes_written);
   return out;
 }
 
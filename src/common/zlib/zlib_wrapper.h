@@ -16,24 +16,163 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+
 #pragma once
 
+#include <zlib.h>
+
+#include <limits>
 #include <string>
 
+#include <absl/types/span.h>
+
+#include "src/common/base/base.h"
 #include "src/common/base/statusor.h"
 
 namespace px {
 namespace zlib {
 
+/**
+ * The framing around deflate-compressed data.
+ */
+enum class Format {
+  // gzip, as used by HTTP "Content-Encoding: gzip" and .gz files.
+  kGzip,
+  // zlib, as used by HTTP "Content-Encoding: deflate".
+  kZlib,
+  // Either of the above, detected from the header. Only valid for decompression.
+  kAuto,
+};
+
+/**
+ * The progress made by one call to a streaming compressor or decompressor.
+ */
+struct StreamProgress {
+  // How many bytes of the input were consumed, and how many were written to the output.
+  size_t bytes_read = 0;
+  size_t bytes_written = 0;
+  // Whether the end of the compressed stream was reached.
+  bool stream_end = false;
+};
+
+/**
+ * Inflater decompresses a stream incrementally, into buffers provided by the caller.
+ *
+ * Setting up zlib's inflate state allocates about 40KB, so an Inflater should be kept and Reset()
+ * between streams rather than created per stream. Not thread-safe.
+ */
+class Inflater : public NotCopyMoveable {
+ public:
+  explicit Inflater(Format format = Format::kAuto) : format_(format) {}
+  ~Inflater();
+
+  /**
+   * Decompresses as much of `in` as fits into `out`. Call repeatedly with the unconsumed input,
+   * and more input as it arrives, until stream_end is set. A call that can make no progress,
+   * because the input is exhausted or the output is full, returns zero bytes read and written.
+   */
+  StatusOr<StreamProgress> Inflate(std::string_view in, absl::Span<char> out);
+
+  /**
+   * Prepares for a new stream, reusing the existing zlib state.
+   */
+  Status Reset() { return Reset(format_); }
+  Status Reset(Format format);
+
+ private:
+  Status Init();
+
+  Format format_;
+  z_stream zs_ = {};
+  bool initialized_ = false;
+};
+
+/**
+ * Deflater compresses a stream incrementally, into buffers provided by the caller.
+ *
+ * zlib's deflate state is about 256KB at the default memory level, so a Deflater should be kept
+ * and Reset() between streams rather than created per stream. Not thread-safe.
+ */
+class Deflater : public NotCopyMoveable {
+ public:
+  /**
+   * @param format kGzip or kZlib.
+   * @param level The zlib compression level, from 1 (fastest) to 9 (smallest). -1 is zlib's
+   *        default.
+   */
+  explicit Deflater(Format format = Format::kGzip, int level = Z_DEFAULT_COMPRESSION)
+      : format_(format), level_(level) {}
+  ~Deflater();
+
+  /**
+   * Compresses as much of `in` as fits into `out`. Once all the input has been passed in, call
+   * with finish set, until stream_end is set. An output buffer of Bound() bytes always holds the
+   * whole stream.
+   */
+  StatusOr<StreamProgress> Deflate(std::string_view in, absl::Span<char> out, bool finish);
+
+  /**
+   * The most bytes that compressing `in_size` bytes in one call can produce.
+   */
+  StatusOr<size_t> Bound(size_t in_size);
+
+  /**
+   * Prepares for a new stream, reusing the existing zlib state.
+   */
+  Status Reset();
+
+ private:
+  Status Init();
+
+  const Format format_;
+  const int level_;
+  z_stream zs_ = {};
+  bool initialized_ = false;
+};
+
 /**
  * @brief Inflates (gunzip) a source buffer and returns the decompressed content as a string.
  *
  * @param in A view into the source buffer.
  * @param output_block_size How many bytes to decompress into the output buffer at a time.
  *        For small strings, best to keep this only slightly larger than the expected output size.
+ * @param max_output_bytes Fails rather than decompress more than this many bytes, to bound the
+ *        memory used by untrusted input.
  * @return Status or the decompressed content as a string.
  */
-StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
+StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384,
+                              size_t max_output_bytes = std::numeric_limits<size_t>::max());
+
+/**
+ * @brief Inflates a whole gzip or zlib source buffer into a caller-provided buffer.
+ *
+ * @param in A view into the source buffer.
+ * @param out The output buffer. Fails if the decompressed content does not fit.
+ * @return Status or the number of bytes written to out.
+ */
+StatusOr<size_t> InflateInto(std::string_view in, absl::Span<char> out);
+
+/**
+ * @brief Inflates the beginning of a gzip or zlib (HTTP deflate) source buffer.
+ *
+ * Decompression stops once max_output_bytes have been produced, so the cost is bounded by the
+ * output limit rather than by the size of the source. A source cut short, as bodies truncated
+ * before decompression are, is not an error: whatever could be decompressed is returned.
+ *
+ * @param in A view into the source buffer.
+ * @param max_output_bytes The maximum number of bytes to return.
+ * @return Status or the first (up to) max_output_bytes of the decompressed content.
+ */
+StatusOr<std::string> InflatePrefix(std::string_view in, size_t max_output_bytes);
+
+/**
+ * @brief Deflates (gzip) a source buffer, in a format that Inflate() decompresses.
+ *
+ * @param in A view into the source buffer.
+ * @param level The zlib compression level, from 1 (fastest) to 9 (smallest). -1 is zlib's default.
+ * @return Status or the compressed content as a string.
+ */
+StatusOr<std::string> Deflate(std::string_view in, int level = -1);
 
 }  // namespace zlib
 }  // namespace px
@@ -20,6 +20,8 @@
 #include <zlib.h>
 #include <string>
 
+#include <absl/strings/str_cat.h>
+
 #include "src/common/testing/testing.h"
 
 namespace px {
@@ -46,4 +48,150 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+namespace {
+
+std::string Compress(std::string_view in, int window_bits) {
+  z_stream zs = {};
+  CHECK_EQ(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8,
+                        Z_DEFAULT_STRATEGY),
+           Z_OK);
+  std::string out(deflateBound(&zs, in.size()), '\0');
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+  CHECK_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return out;
+}
+
+std::string TestContent() {
+  std::string content;
+  for (int i = 0; content.size() < 100000; ++i) {
+    content += absl::StrCat("{\"id\": ", i, ", \"name\": \"item-", i * 7, "\"}, ");
+  }
+  return content;
+}
+
+}  // namespace
+
+TEST_F(ZlibTest, inflate_prefix_test) {
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 1024), GetExpectedResult());
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 4), "This");
+}
+
+TEST_F(ZlibTest, inflate_prefix_stops_at_limit) {
+  const std::string content = TestContent();
+  const std::string compressed = Compress(content, MAX_WBITS + 16);
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(compressed, 512), content.substr(0, 512));
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(compressed, content.size() * 2), content);
+}
+
+TEST_F(ZlibTest, inflate_prefix_of_truncated_input) {
+  const std::string content = TestContent();
+  const std::string compressed = Compress(content, MAX_WBITS + 16);
+  ASSERT_OK_AND_ASSIGN(std::string out,
+                       px::zlib::InflatePrefix(compressed.substr(0, 1024), content.size()));
+  EXPECT_GT(out.size(), 1024);
+  EXPECT_EQ(out, content.substr(0, out.size()));
+
+  // The full Inflate() requires the whole stream.
+  EXPECT_NOT_OK(px::zlib::Inflate(compressed.substr(0, 1024)));
+}
+
+TEST_F(ZlibTest, inflate_prefix_of_zlib_format) {
+  const std::string content = TestContent();
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(Compress(content, MAX_WBITS), 100),
+                   content.substr(0, 100));
+}
+
+TEST_F(ZlibTest, inflate_prefix_of_invalid_input) {
+  EXPECT_NOT_OK(px::zlib::InflatePrefix("definitely not compressed", 100));
+  // The pooled stream is still usable after an error.
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 1024), GetExpectedResult());
+}
+
+TEST_F(ZlibTest, deflate_round_trip) {
+  const std::string content = TestContent();
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Deflate(content));
+  EXPECT_LT(compressed.size(), content.size());
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), content);
+
+  ASSERT_OK_AND_ASSIGN(std::string compressed_empty, px::zlib::Deflate(""));
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed_empty), "");
+}
+
+TEST_F(ZlibTest, inflate_max_output_bytes) {
+  const std::string content = TestContent();
+  const std::string compressed = Compress(content, MAX_WBITS + 16);
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed, 16384, content.size()), content);
+  EXPECT_NOT_OK(px::zlib::Inflate(compressed, 16384, content.size() - 1));
+}
+
+TEST_F(ZlibTest, inflate_into) {
+  const std::string content = TestContent();
+  const std::string compressed = Compress(content, MAX_WBITS);
+  std::string out(content.size(), '\0');
+  EXPECT_OK_AND_EQ(px::zlib::InflateInto(compressed, absl::MakeSpan(out)), content.size());
+  EXPECT_EQ(out, content);
+
+  std::string small(content.size() - 1, '\0');
+  EXPECT_NOT_OK(px::zlib::InflateInto(compressed, absl::MakeSpan(small)));
+  EXPECT_NOT_OK(px::zlib::InflateInto(compressed.substr(0, 100), absl::MakeSpan(out)));
+}
+
+TEST_F(ZlibTest, streaming_round_trip) {
+  const std::string content = TestContent();
+
+  // Compress in small pieces into a small buffer, as a caller streaming data would.
+  px::zlib::Deflater deflater(px::zlib::Format::kZlib, /* level */ 1);
+  std::string compressed;
+  char buf[1000];
+  std::string_view in = content;
+  bool done = false;
+  while (!done) {
+    std::string_view piece = in.substr(0, 777);
+    ASSERT_OK_AND_ASSIGN(px::zlib::StreamProgress progress,
+                         deflater.Deflate(piece, absl::MakeSpan(buf), piece.size() == in.size()));
+    in.remove_prefix(progress.bytes_read);
+    compressed.append(buf, progress.bytes_written);
+    done = progress.stream_end;
+  }
+
+  // Decompress it in small pieces, twice, to check the inflater can be reused.
+  px::zlib::Inflater inflater;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK(inflater.Reset());
+    std::string out;
+    std::string_view compressed_in = compressed;
+    done = false;
+    while (!done) {
+      ASSERT_OK_AND_ASSIGN(px::zlib::StreamProgress progress,
+                           inflater.Inflate(compressed_in.substr(0, 100), absl::MakeSpan(buf)));
+      compressed_in.remove_prefix(progress.bytes_read);
+      out.append(buf, progress.bytes_written);
+      done = progress.stream_end;
+      ASSERT_TRUE(done || progress.bytes_read > 0 || progress.bytes_written > 0);
+    }
+    EXPECT_EQ(out, content);
+  }
+
+  // A reset deflater produces the same stream again.
+  ASSERT_OK(deflater.Reset());
+  ASSERT_OK_AND_ASSIGN(size_t bound, deflater.Bound(content.size()));
+  std::string out(bound, '\0');
+  ASSERT_OK_AND_ASSIGN(px::zlib::StreamProgress progress,
+                       deflater.Deflate(content, absl::MakeSpan(out), /* finish */ true));
+  EXPECT_TRUE(progress.stream_end);
+  out.resize(progress.bytes_written);
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(out, content.size()), content);
+}
+
+TEST_F(ZlibTest, deflate_auto_format_fails) {
+  px::zlib::Deflater deflater(px::zlib::Format::kAuto);
+  char buf[100];
+  EXPECT_NOT_OK(deflater.Deflate("abc", absl::MakeSpan(buf), true));
+}
+
 }  // namespace px
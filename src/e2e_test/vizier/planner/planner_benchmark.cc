@@ -0,0 +1,418 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Plans every bundled script in src/pxl_scripts, and synthetic stress scripts, against a
+// topology of N PEMs and one Kelvin. Each benchmark reports the average time of each planner
+// phase, and the peak memory of its first iteration, so that planner regressions can be tracked
+// as the script library grows:
+//
+//   bazel run -c opt //src/e2e_test/vizier/planner:planner_benchmark -- \
+//     --benchmark_filter='BM_PlanScript/px/http_data/.*'
+
+#include <gflags/gflags.h>
+#include <rapidjson/document.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/match.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <benchmark/benchmark.h>
+#include <sole.hpp>
+
+#include "src/carnot/planner/compiler/compiler.h"
+#include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/parser/parser.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/base/base.h"
+#include "src/common/base/file.h"
+#include "src/common/perf/elapsed_timer.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/common/testing/testing.h"
+#include "src/common/uuid/uuid_utils.h"
+
+DEFINE_string(scripts_dir, "src/pxl_scripts", "The directory of the scripts, in the runfiles.");
+DEFINE_string(schemas_path, "src/e2e_test/vizier/planner/dump_schemas/all_schemas.bin",
+              "The schemas of all tables, as written by dump_schemas, in the runfiles.");
+
+using ::benchmark::Counter;
+using ::px::ElapsedTimer;
+using ::px::MemoryStats;
+using ::px::MemoryTracker;
+using ::px::Status;
+using ::px::StatusOr;
+using ::px::carnot::planner::CreateCompilerState;
+using ::px::carnot::planner::Parser;
+using ::px::carnot::planner::RegistryInfo;
+using ::px::carnot::planner::compiler::Compiler;
+using ::px::carnot::planner::distributed::DistributedPlanner;
+using ::px::carnot::planner::distributedpb::LogicalPlannerState;
+using ::px::carnot::planner::plannerpb::FuncToExecute;
+
+namespace {
+
+struct Script {
+  std::string query;
+  std::vector<FuncToExecute> exec_funcs;
+};
+
+// The total time spent in each planner phase, over all iterations.
+struct PhaseTimes {
+  uint64_t parse_us = 0;
+  uint64_t ast_visitor_us = 0;
+  uint64_t analyzer_us = 0;
+  uint64_t optimizer_us = 0;
+  uint64_t distributed_us = 0;
+};
+
+// The same defaults the script compile test uses for variables without one.
+std::string DefaultForType(std::string_view px_type) {
+  if (px_type == "PX_BOOLEAN") {
+    return "True";
+  }
+  if (px_type == "PX_INT64") {
+    return "1";
+  }
+  if (px_type == "PX_FLOAT64") {
+    return "1.0";
+  }
+  if (px_type == "PX_SERVICE" || px_type == "PX_POD" || px_type == "PX_CONTAINER" ||
+      px_type == "PX_NAMESPACE" || px_type == "PX_NODE") {
+    return "pl";
+  }
+  if (px_type == "PX_LIST") {
+    return "[]";
+  }
+  if (px_type == "PX_STRING_LIST") {
+    return "[\"\"]";
+  }
+  return "";
+}
+
+// Only the funcs of the vis spec are parsed, its display specs can't be resolved in C++.
+StatusOr<std::vector<FuncToExecute>> ExecFuncsFromVis(const std::string& vis_json) {
+  rapidjson::Document vis;
+  vis.Parse(vis_json.data(), vis_json.size());
+  if (vis.HasParseError() || !vis.IsObject()) {
+    return px::error::InvalidArgument("Malformed vis spec");
+  }
+
+  std::map<std::string, std::string> variable_values;
+  if (vis.HasMember("variables")) {
+    for (const auto& var : vis["variables"].GetArray()) {
+      std::string value;
+      if (var.HasMember("defaultValue") && var["defaultValue"].GetStringLength() > 0) {
+        value = var["defaultValue"].GetString();
+      } else if (var.HasMember("validValues") && !var["validValues"].Empty()) {
+        value = var["validValues"][0].GetString();
+      } else if (var.HasMember("type")) {
+        value = DefaultForType(var["type"].GetString());
+      }
+      variable_values[var["name"].GetString()] = value;
+    }
+  }
+
+  std::vector<FuncToExecute> exec_funcs;
+  auto add_func = [&](const rapidjson::Value& func) {
+    FuncToExecute exec_func;
+    exec_func.set_func_name(func["name"].GetString());
+    exec_func.set_output_table_prefix(func["name"].GetString());
+    if (func.HasMember("args")) {
+      for (const auto& arg : func["args"].GetArray()) {
+        auto* arg_value = exec_func.add_arg_values();
+        arg_value->set_name(arg["name"].GetString());
+        if (arg.HasMember("variable")) {
+          arg_value->set_value(variable_values[arg["variable"].GetString()]);
+        } else if (arg.HasMember("value")) {
+          arg_value->set_value(arg["value"].GetString());
+        }
+      }
+    }
+    exec_funcs.push_back(std::move(exec_func));
+  };
+  for (const auto& key : {"globalFuncs", "widgets"}) {
+    if (!vis.HasMember(key)) {
+      continue;
+    }
+    for (const auto& entry : vis[key].GetArray()) {
+      if (entry.HasMember("func")) {
+        add_func(entry["func"]);
+      }
+    }
+  }
+  return exec_funcs;
+}
+
+// Returns the scripts by name, which is their directory relative to the scripts dir.
+StatusOr<std::map<std::string, Script>> LoadBundledScripts(const std::filesystem::path& dir) {
+  std::map<std::string, Script> scripts;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+    if (entry.path().extension() != ".pxl") {
+      continue;
+    }
+    Script script;
+    PL_ASSIGN_OR_RETURN(script.query, px::ReadFileToString(entry.path().string()));
+    // Mutations are deployed rather than planned.
+    if (absl::StrContains(script.query, "pxtrace")) {
+      continue;
+    }
+    auto vis_path = entry.path().parent_path() / "vis.json";
+    if (std::filesystem::exists(vis_path)) {
+      PL_ASSIGN_OR_RETURN(std::string vis_json, px::ReadFileToString(vis_path.string()));
+      PL_ASSIGN_OR_RETURN(script.exec_funcs, ExecFuncsFromVis(vis_json));
+    }
+    scripts[std::filesystem::relative(entry.path().parent_path(), dir).string()] =
+        std::move(script);
+  }
+  return scripts;
+}
+
+// Joins n aggregates of the table on their key, one after the other.
+Script DeepJoinsScript(int64_t n) {
+  std::string query = R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m')
+df = df.groupby(['req_path']).agg(count=('latency', px.count))
+)pxl";
+  for (int64_t i = 0; i < n; ++i) {
+    absl::StrAppend(&query, absl::Substitute(R"pxl(
+r$0 = px.DataFrame(table='http_events', start_time='-5m')
+r$0 = r$0.groupby(['req_path']).agg(latency_$0=('latency', px.mean))
+r$0.path_$0 = r$0.req_path
+r$0 = r$0.drop(['req_path'])
+df = df.merge(r$0, how='inner', left_on=['req_path'], right_on=['path_$0'])
+df = df.drop(['path_$0'])
+)pxl",
+                                                 i));
+  }
+  absl::StrAppend(&query, "px.display(df)\n");
+  return {query, {}};
+}
+
+// Assigns n computed columns, each depending on the previous one.
+Script WideMapScript(int64_t n) {
+  std::string query = R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m')
+df.col_0 = df.latency
+)pxl";
+  for (int64_t i = 1; i <= n; ++i) {
+    absl::StrAppend(&query,
+                    absl::Substitute("df.col_$0 = df.col_$1 * $0 + df.latency\n", i, i - 1));
+  }
+  absl::StrAppend(&query, "px.display(df)\n");
+  return {query, {}};
+}
+
+// Unions n filtered copies of the table.
+Script ManyUnionsScript(int64_t n) {
+  std::string query = R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m', select=['time_', 'req_path', 'latency'])
+)pxl";
+  for (int64_t i = 0; i < n; ++i) {
+    absl::StrAppend(&query, absl::Substitute(R"pxl(
+u$0 = px.DataFrame(table='http_events', start_time='-5m', select=['time_', 'req_path', 'latency'])
+df = df.append(u$0[u$0.latency > $0])
+)pxl",
+                                                 i));
+  }
+  absl::StrAppend(&query, "px.display(df)\n");
+  return {query, {}};
+}
+
+LogicalPlannerState MakeLogicalPlannerState(const px::table_store::schemapb::Schema& schema,
+                                            int64_t num_pems) {
+  LogicalPlannerState state;
+  state.set_result_address("result_addr");
+  state.set_result_ssl_targetname("result_ssl_targetname");
+  auto* distributed_state = state.mutable_distributed_state();
+  std::vector<sole::uuid> pem_ids;
+  for (int64_t i = 0; i < num_pems; ++i) {
+    auto* pem = distributed_state->add_carnot_info();
+    pem_ids.push_back(sole::uuid4());
+    px::ToProto(pem_ids.back(), pem->mutable_agent_id());
+    pem->set_query_broker_address(absl::StrCat("pem", i));
+    pem->set_has_data_store(true);
+    pem->set_processes_data(true);
+    pem->set_asid(i + 1);
+  }
+  auto* kelvin = distributed_state->add_carnot_info();
+  px::ToProto(sole::uuid4(), kelvin->mutable_agent_id());
+  kelvin->set_query_broker_address("kelvin");
+  kelvin->set_grpc_address("1.1.1.1");
+  kelvin->set_ssl_targetname("kelvin.pl.svc");
+  kelvin->set_has_grpc_server(true);
+  kelvin->set_processes_data(true);
+  kelvin->set_accepts_remote_sources(true);
+  kelvin->set_asid(num_pems + 1);
+
+  for (const auto& [name, relation] : schema.relation_map()) {
+    auto* schema_info = distributed_state->add_schema_info();
+    schema_info->set_name(name);
+    *schema_info->mutable_relation() = relation;
+    for (const auto& id : pem_ids) {
+      px::ToProto(id, schema_info->add_agent_list());
+    }
+  }
+  return state;
+}
+
+// Runs each phase of LogicalPlanner::Plan on its own, so that it can be timed.
+Status PlanScript(const Script& script, const LogicalPlannerState& logical_state,
+                  RegistryInfo* registry_info, Compiler* compiler,
+                  DistributedPlanner* distributed_planner, PhaseTimes* times) {
+  auto max_output_rows = logical_state.plan_options().max_output_rows_per_table();
+  PL_ASSIGN_OR_RETURN(auto compiler_state,
+                      CreateCompilerState(logical_state, registry_info, max_output_rows));
+  ElapsedTimer timer;
+
+  timer.Start();
+  Parser parser;
+  PL_ASSIGN_OR_RETURN(auto ast, parser.Parse(script.query));
+  times->parse_us += timer.ElapsedTime_us();
+
+  timer.Start();
+  PL_ASSIGN_OR_RETURN(auto ir, compiler->ASTToIR(ast, compiler_state.get(), script.exec_funcs));
+  times->ast_visitor_us += timer.ElapsedTime_us();
+
+  timer.Start();
+  PL_RETURN_IF_ERROR(compiler->Analyze(ir.get(), compiler_state.get()));
+  times->analyzer_us += timer.ElapsedTime_us();
+
+  timer.Start();
+  PL_RETURN_IF_ERROR(compiler->Optimize(ir.get(), compiler_state.get()));
+  times->optimizer_us += timer.ElapsedTime_us();
+
+  timer.Start();
+  PL_ASSIGN_OR_RETURN(auto distributed_plan,
+                      distributed_planner->Plan(logical_state.distributed_state(),
+                                                compiler_state.get(), ir.get()));
+  times->distributed_us += timer.ElapsedTime_us();
+  benchmark::DoNotOptimize(distributed_plan);
+  return Status::OK();
+}
+
+struct BenchmarkEnv {
+  px::carnot::udfspb::UDFInfo udf_info;
+  px::table_store::schemapb::Schema schema;
+};
+
+// NOLINTNEXTLINE: runtime/references.
+void BM_Plan(benchmark::State& state, const BenchmarkEnv* env, const Script& script) {
+  RegistryInfo registry_info;
+  PL_CHECK_OK(registry_info.Init(env->udf_info));
+  auto logical_state = MakeLogicalPlannerState(env->schema, state.range(0));
+  Compiler compiler;
+  auto distributed_planner = DistributedPlanner::Create().ConsumeValueOrDie();
+
+  PhaseTimes times;
+  MemoryStats mem_stats;
+  bool is_first_iter = true;
+  for (auto _ : state) {
+    MemoryTracker mem_tracker(is_first_iter);
+    if (is_first_iter) {
+      mem_tracker.Start();
+    }
+    auto s = PlanScript(script, logical_state, &registry_info, &compiler,
+                        distributed_planner.get(), &times);
+    if (is_first_iter) {
+      mem_stats = mem_tracker.End();
+      is_first_iter = false;
+    }
+    if (!s.ok()) {
+      state.SkipWithError(s.msg().c_str());
+      return;
+    }
+  }
+
+#define PHASE_COUNTER(x) Counter(x, Counter::kAvgIterations)
+#define MEM_COUNTER(x) Counter(x, Counter::kDefaults, Counter::OneK::kIs1024)
+  state.counters["ParseUs"] = PHASE_COUNTER(times.parse_us);
+  state.counters["ASTVisitorUs"] = PHASE_COUNTER(times.ast_visitor_us);
+  state.counters["AnalyzerUs"] = PHASE_COUNTER(times.analyzer_us);
+  state.counters["OptimizerUs"] = PHASE_COUNTER(times.optimizer_us);
+  state.counters["DistributedUs"] = PHASE_COUNTER(times.distributed_us);
+  state.counters["AllocPeak"] = MEM_COUNTER(mem_stats.max.allocated - mem_stats.start.allocated);
+#undef MEM_COUNTER
+#undef PHASE_COUNTER
+}
+
+// NOLINTNEXTLINE: runtime/references.
+void BM_PlanScript(benchmark::State& state, const BenchmarkEnv* env, const Script* script) {
+  BM_Plan(state, env, *script);
+}
+
+// The synthetic script size is the second range, the number of PEMs the first.
+template <Script (*TMakeScript)(int64_t)>
+// NOLINTNEXTLINE: runtime/references.
+void BM_PlanSynthetic(benchmark::State& state, const BenchmarkEnv* env) {
+  BM_Plan(state, env, TMakeScript(state.range(1)));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  BenchmarkEnv env;
+  env.udf_info = px::carnot::udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  std::string schema_str =
+      px::ReadFileToString(px::testing::BazelRunfilePath(FLAGS_schemas_path).string())
+          .ConsumeValueOrDie();
+  CHECK(env.schema.ParseFromString(schema_str)) << "Malformed schemas in " << FLAGS_schemas_path;
+
+  // Registered benchmarks refer to these, so they must live until the benchmarks have run.
+  auto scripts =
+      LoadBundledScripts(px::testing::BazelRunfilePath(FLAGS_scripts_dir)).ConsumeValueOrDie();
+  LOG(INFO) << absl::Substitute("Loaded $0 scripts from $1.", scripts.size(), FLAGS_scripts_dir);
+
+  const std::vector<int64_t> kNumPEMs = {1, 10, 100};
+  for (const auto& [name, script] : scripts) {
+    auto* bm = benchmark::RegisterBenchmark(absl::StrCat("BM_PlanScript/", name).c_str(),
+                                            BM_PlanScript, &env, &script);
+    for (auto num_pems : kNumPEMs) {
+      bm->Arg(num_pems);
+    }
+    bm->Unit(benchmark::kMillisecond);
+  }
+  const std::vector<int64_t> kSyntheticSizes = {1, 8, 32};
+  std::vector<benchmark::internal::Benchmark*> synthetic = {
+      benchmark::RegisterBenchmark("BM_PlanDeepJoins", BM_PlanSynthetic<DeepJoinsScript>, &env),
+      benchmark::RegisterBenchmark("BM_PlanWideMap", BM_PlanSynthetic<WideMapScript>, &env),
+      benchmark::RegisterBenchmark("BM_PlanManyUnions", BM_PlanSynthetic<ManyUnionsScript>, &env),
+  };
+  for (auto* bm : synthetic) {
+    for (auto num_pems : kNumPEMs) {
+      for (auto size : kSyntheticSizes) {
+        bm->Args({num_pems, size});
+      }
+    }
+    bm->Unit(benchmark::kMillisecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
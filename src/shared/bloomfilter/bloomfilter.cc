@@ -16,7 +16,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include <math.h>
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <utility>
 
@@ -116,5 +122,160 @@ bool XXHash64BloomFilter::Contains(std::string_view item) const {
   return true;
 }
 
+namespace {
+
+// Multipliers that pick a bit in each word of a block from the 32-bit key, as in the split block
+// bloom filters of Impala and Parquet.
+constexpr uint32_t kSalts[SplitBlockBloomFilter::kNumHashes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+#if defined(__AVX2__)
+// One bit set in each 32-bit lane, chosen by the top 5 bits of key * salt.
+__m256i BlockMask(uint32_t key) {
+  const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kSalts));
+  __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salts), 27);
+  return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+}
+#endif
+
+// The false positive rate of a split block filter with the given average number of items per
+// block. The number of items in a block follows a Poisson distribution, and a block holding k
+// items has each bit of a word set with probability 1 - (1 - 1/32)^k.
+double FalsePositiveRate(double items_per_block) {
+  double rate = 0;
+  // Probability of a block holding k items, starting from k = 0.
+  double p_k = std::exp(-items_per_block);
+  int64_t max_k = static_cast<int64_t>(items_per_block + 10 * std::sqrt(items_per_block) + 10);
+  for (int64_t k = 0; k <= max_k; ++k) {
+    double bit_set = 1 - std::pow(1 - 1.0 / 32, k);
+    rate += p_k * std::pow(bit_set, SplitBlockBloomFilter::kNumHashes);
+    p_k *= items_per_block / (k + 1);
+  }
+  return rate;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::Create(int64_t max_entries,
+                                                                             double error_rate) {
+  if (error_rate <= 0.0 || error_rate >= 1.0) {
+    return error::Internal(
+        "Bloom filter error rate must be greater than 0 and less than 1, received $0", error_rate);
+  }
+  if (max_entries <= 0) {
+    return error::Internal("Bloom filter must have a maximum of at least 1 entry, received $0",
+                           max_entries);
+  }
+
+  // An item is a false positive when all 8 of its bits are set in its block. Ignoring the
+  // variance in how many items land in each block, that gives:
+  // bits per entry = -8 / ln(1 - error_rate^(1/8))
+  // Blocks with more than their share of items raise the error rate noticeably though, so the
+  // estimate is grown until the rate over the actual distribution of block loads is low enough.
+  double bpe = -kNumHashes / std::log(1 - std::pow(error_rate, 1.0 / kNumHashes));
+  constexpr int64_t kBlockBits = sizeof(Block) * 8;
+  int64_t num_blocks = 0;
+  while (true) {
+    int64_t num_bits = static_cast<int64_t>(std::ceil(max_entries * bpe));
+    num_blocks = std::max<int64_t>(1, (num_bits + kBlockBits - 1) / kBlockBits);
+    if (FalsePositiveRate(static_cast<double>(max_entries) / num_blocks) <= error_rate) {
+      break;
+    }
+    bpe *= 1.02;
+  }
+
+  return std::unique_ptr<SplitBlockBloomFilter>(new SplitBlockBloomFilter(num_blocks));
+}
+
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::FromProto(
+    const SplitBlockBloomFilterPB& pb) {
+  const std::string& bytes_str = pb.data();
+  if (bytes_str.empty() || bytes_str.size() % sizeof(Block) != 0) {
+    return error::Internal("BloomFilter data must be a non-zero multiple of $0 bytes, received $1",
+                           sizeof(Block), bytes_str.size());
+  }
+
+  auto bf = std::unique_ptr<SplitBlockBloomFilter>(
+      new SplitBlockBloomFilter(bytes_str.size() / sizeof(Block)));
+  // Agents and the planner all run on little endian machines, so the words are copied directly.
+  std::memcpy(bf->blocks_.data(), bytes_str.data(), bytes_str.size());
+  return bf;
+}
+
+SplitBlockBloomFilterPB SplitBlockBloomFilter::ToProto() const {
+  SplitBlockBloomFilterPB output;
+  output.set_data(std::string(reinterpret_cast<const char*>(blocks_.data()), buffer_size_bytes()));
+  return output;
+}
+
+uint64_t SplitBlockBloomFilter::Hash(std::string_view item) const {
+  return XXH64(item.data(), item.size(), kSeed);
+}
+
+// The upper half of the hash picks the block, and the lower half picks the bits within it.
+const SplitBlockBloomFilter::Block& SplitBlockBloomFilter::BlockFor(uint64_t hash) const {
+  return blocks_[((hash >> 32) * blocks_.size()) >> 32];
+}
+
+SplitBlockBloomFilter::Block& SplitBlockBloomFilter::BlockFor(uint64_t hash) {
+  return blocks_[((hash >> 32) * blocks_.size()) >> 32];
+}
+
+void SplitBlockBloomFilter::SetBits(uint32_t key, Block* block) {
+#if defined(__AVX2__)
+  auto* p = reinterpret_cast<__m256i*>(block->words);
+  _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), BlockMask(key)));
+#else
+  for (int i = 0; i < kNumHashes; ++i) {
+    block->words[i] |= 1U << ((key * kSalts[i]) >> 27);
+  }
+#endif
+}
+
+bool SplitBlockBloomFilter::HasBitsSet(uint32_t key, const Block& block) {
+#if defined(__AVX2__)
+  // testc is true when every bit of the mask is also set in the block.
+  return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block.words)),
+                            BlockMask(key));
+#else
+  // Check all words without branching, which the compiler can vectorize.
+  uint32_t missing = 0;
+  for (int i = 0; i < kNumHashes; ++i) {
+    missing |= ~block.words[i] & (1U << ((key * kSalts[i]) >> 27));
+  }
+  return missing == 0;
+#endif
+}
+
+void SplitBlockBloomFilter::Insert(std::string_view item) {
+  uint64_t hash = Hash(item);
+  SetBits(static_cast<uint32_t>(hash), &BlockFor(hash));
+}
+
+bool SplitBlockBloomFilter::Contains(std::string_view item) const {
+  uint64_t hash = Hash(item);
+  return HasBitsSet(static_cast<uint32_t>(hash), BlockFor(hash));
+}
+
+void SplitBlockBloomFilter::ContainsBatch(absl::Span<const std::string_view> items,
+                                          std::vector<bool>* results) const {
+  // Items are hashed a chunk at a time, and each block is prefetched as soon as its hash is known.
+  constexpr size_t kChunkSize = 16;
+  uint64_t hashes[kChunkSize];
+
+  results->resize(items.size());
+  for (size_t start = 0; start < items.size(); start += kChunkSize) {
+    size_t n = std::min(kChunkSize, items.size() - start);
+    for (size_t i = 0; i < n; ++i) {
+      hashes[i] = Hash(items[start + i]);
+      __builtin_prefetch(&BlockFor(hashes[i]));
+    }
+    for (size_t i = 0; i < n; ++i) {
+      (*results)[start + i] = HasBitsSet(static_cast<uint32_t>(hashes[i]), BlockFor(hashes[i]));
+    }
+  }
+}
+
 }  // namespace bloomfilter
 }  // namespace px
@@ -30,13 +30,15 @@
 namespace px {
 namespace bloomfilter {
 
+template <typename TBloomFilter>
 class BloomFilterBenchmark : public benchmark::Fixture {
+ public:
   void SetUp(const ::benchmark::State& state) {
     auto num_items = state.range(0);
     auto error_rate = 1.0 / state.range(1);
     auto strlen = state.range(2);
-    insert_bf_ = XXHash64BloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
-    lookup_bf_ = XXHash64BloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    insert_bf_ = TBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    lookup_bf_ = TBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
     random_strs_.reserve(num_items);
     for (auto i = 0; i < num_items; ++i) {
       random_strs_.push_back(datagen::RandomString(strlen));
@@ -44,32 +46,60 @@ class BloomFilterBenchmark : public benchmark::Fixture {
     }
   }
 
+  void TearDown(const ::benchmark::State&) { random_strs_.clear(); }
+
+  // NOLINTNEXTLINE : runtime/references.
+  void InsertTest(benchmark::State& state) {
+    for (auto _ : state) {
+      for (const auto& random_str : random_strs_) {
+        insert_bf_->Insert(random_str);
+      }
+    }
+    state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+    state.SetItemsProcessed(state.iterations() * random_strs_.size());
+  }
+
+  // NOLINTNEXTLINE : runtime/references.
+  void LookupTest(benchmark::State& state) {
+    bool result = false;
+    for (auto _ : state) {
+      for (const auto& random_str : random_strs_) {
+        result = lookup_bf_->Contains(random_str);
+        benchmark::DoNotOptimize(result);
+      }
+    }
+    state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+    state.SetItemsProcessed(state.iterations() * random_strs_.size());
+  }
+
  protected:
   std::vector<std::string> random_strs_;
-  std::unique_ptr<XXHash64BloomFilter> insert_bf_;
-  std::unique_ptr<XXHash64BloomFilter> lookup_bf_;
+  std::unique_ptr<TBloomFilter> insert_bf_;
+  std::unique_ptr<TBloomFilter> lookup_bf_;
 };
 
 // NOLINTNEXTLINE : runtime/references.
-BENCHMARK_DEFINE_F(BloomFilterBenchmark, InsertTest)(benchmark::State& state) {
-  for (auto _ : state) {
-    for (const auto& random_str : random_strs_) {
-      insert_bf_->Insert(random_str);
-    }
-  }
-  state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
-  state.SetItemsProcessed(state.iterations() * random_strs_.size());
-}
+BENCHMARK_TEMPLATE_DEFINE_F(BloomFilterBenchmark, InsertTest, XXHash64BloomFilter)
+(benchmark::State& state) { InsertTest(state); }
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_TEMPLATE_DEFINE_F(BloomFilterBenchmark, LookupTest, XXHash64BloomFilter)
+(benchmark::State& state) { LookupTest(state); }
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_TEMPLATE_DEFINE_F(BloomFilterBenchmark, SplitBlockInsertTest, SplitBlockBloomFilter)
+(benchmark::State& state) { InsertTest(state); }
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_TEMPLATE_DEFINE_F(BloomFilterBenchmark, SplitBlockLookupTest, SplitBlockBloomFilter)
+(benchmark::State& state) { LookupTest(state); }
 
 // NOLINTNEXTLINE : runtime/references.
-BENCHMARK_DEFINE_F(BloomFilterBenchmark, LookupTest)(benchmark::State& state) {
-  bool result = false;
+BENCHMARK_TEMPLATE_DEFINE_F(BloomFilterBenchmark, SplitBlockBatchLookupTest, SplitBlockBloomFilter)
+(benchmark::State& state) {
+  std::vector<std::string_view> items(random_strs_.begin(), random_strs_.end());
+  std::vector<bool> results;
   for (auto _ : state) {
-    for (const auto& random_str : random_strs_) {
-      result = lookup_bf_->Contains(random_str);
-    }
+    lookup_bf_->ContainsBatch(items, &results);
+    benchmark::DoNotOptimize(results);
   }
-  PL_UNUSED(result);
   state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
   state.SetItemsProcessed(state.iterations() * random_strs_.size());
 }
@@ -78,6 +108,12 @@ BENCHMARK_REGISTER_F(BloomFilterBenchmark, InsertTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
 BENCHMARK_REGISTER_F(BloomFilterBenchmark, LookupTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(BloomFilterBenchmark, SplitBlockInsertTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(BloomFilterBenchmark, SplitBlockLookupTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(BloomFilterBenchmark, SplitBlockBatchLookupTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
 
 }  // namespace bloomfilter
 }  // namespace px
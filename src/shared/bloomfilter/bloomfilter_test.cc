@@ -16,8 +16,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/strings/str_cat.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include "src/shared/bloomfilter/bloomfilter.h"
 
 namespace px {
@@ -113,5 +117,86 @@ TEST(XXHash64BloomFilter, test_create_from_proto) {
   }
 }
 
+TEST(SplitBlockBloomFilter, test_create) {
+  EXPECT_FALSE(SplitBlockBloomFilter::Create(10, 0).ok());
+  EXPECT_FALSE(SplitBlockBloomFilter::Create(0, 0.1).ok());
+
+  auto bf1 = SplitBlockBloomFilter::Create(1, 0.999999999999).ConsumeValueOrDie();
+  EXPECT_EQ(bf1->buffer_size_bytes(), 32);
+
+  auto bf2 = SplitBlockBloomFilter::Create(100000, 0.01).ConsumeValueOrDie();
+  EXPECT_EQ(bf2->buffer_size_bytes() % 32, 0);
+  EXPECT_GT(bf2->buffer_size_bytes(), XXHash64BloomFilter::Create(100000, 0.01)
+                                          .ConsumeValueOrDie()
+                                          ->buffer_size_bytes());
+}
+
+TEST(SplitBlockBloomFilter, test_insert_contains) {
+  auto bf = SplitBlockBloomFilter::Create(10, 0.01).ConsumeValueOrDie();
+  EXPECT_FALSE(bf->Contains("foo"));
+  bf->Insert("foo");
+  bf->Insert("bar");
+  EXPECT_TRUE(bf->Contains("foo"));
+  EXPECT_TRUE(bf->Contains("bar"));
+  EXPECT_FALSE(bf->Contains("not_present"));
+  EXPECT_FALSE(bf->Contains(""));
+}
+
+TEST(SplitBlockBloomFilter, test_error_rate) {
+  constexpr int kNumItems = 10000;
+  constexpr double kErrorRate = 0.01;
+  auto bf = SplitBlockBloomFilter::Create(kNumItems, kErrorRate).ConsumeValueOrDie();
+  for (int i = 0; i < kNumItems; ++i) {
+    bf->Insert(absl::StrCat("in", i));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_TRUE(bf->Contains(absl::StrCat("in", i)));
+    false_positives += bf->Contains(absl::StrCat("out", i));
+  }
+  // Allow some slack, since the rate is only met on average.
+  EXPECT_LT(false_positives, 1.5 * kErrorRate * kNumItems);
+}
+
+TEST(SplitBlockBloomFilter, test_contains_batch) {
+  auto bf = SplitBlockBloomFilter::Create(100, 0.001).ConsumeValueOrDie();
+  std::vector<std::string> strs;
+  for (int i = 0; i < 100; ++i) {
+    strs.push_back(absl::StrCat("str", i));
+    if (i % 2 == 0) {
+      bf->Insert(strs.back());
+    }
+  }
+  std::vector<std::string_view> items(strs.begin(), strs.end());
+  std::vector<bool> results;
+  bf->ContainsBatch(items, &results);
+  ASSERT_EQ(results.size(), items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(results[i], bf->Contains(items[i]));
+    if (i % 2 == 0) {
+      EXPECT_TRUE(results[i]);
+    }
+  }
+}
+
+TEST(SplitBlockBloomFilter, test_create_from_proto) {
+  auto bf = SplitBlockBloomFilter::Create(1000, 0.01).ConsumeValueOrDie();
+  bf->Insert("foo");
+  bf->Insert("bar");
+
+  auto proto = bf->ToProto();
+  EXPECT_EQ(proto.data().size(), bf->buffer_size_bytes());
+  auto reconstructed = SplitBlockBloomFilter::FromProto(proto).ConsumeValueOrDie();
+  EXPECT_EQ(reconstructed->buffer_size_bytes(), bf->buffer_size_bytes());
+  EXPECT_TRUE(reconstructed->Contains("foo"));
+  EXPECT_TRUE(reconstructed->Contains("bar"));
+  EXPECT_FALSE(reconstructed->Contains("abc"));
+
+  SplitBlockBloomFilterPB bad;
+  EXPECT_FALSE(SplitBlockBloomFilter::FromProto(bad).ok());
+  bad.set_data("abc");
+  EXPECT_FALSE(SplitBlockBloomFilter::FromProto(bad).ok());
+}
+
 }  // namespace bloomfilter
 }  // namespace px
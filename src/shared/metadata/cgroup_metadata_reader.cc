@@ -16,8 +16,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
-#include <fstream>
 #include <memory>
 #include <string>
 
@@ -82,24 +84,46 @@ Status CGroupMetadataReader::ReadPIDs(PodQOSClass qos_class, std::string_view po
 
   PL_ASSIGN_OR_RETURN(std::string fpath, PodPath(qos_class, pod_id, container_id, container_type));
 
-  std::ifstream ifs(fpath);
-  if (!ifs) {
+  int fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
     // This might not be a real error since the pod could have disappeared.
     return error::NotFound("Failed to open file $0", fpath);
   }
-
-  std::string line;
-  while (std::getline(ifs, line)) {
-    if (line.empty()) {
-      continue;
-    }
-    int64_t pid;
-    if (!absl::SimpleAtoi(line, &pid)) {
+  DEFER(close(fd));
+
+  // This runs for every container on each metadata update, so the PIDs are parsed straight out
+  // of the read buffer instead of going through an ifstream and a string per line.
+  constexpr int kMaxPIDDigits = 10;
+  char buf[4096];
+  uint64_t pid = 0;
+  int num_digits = 0;
+  bool malformed_line = false;
+  auto end_line = [&]() {
+    if (malformed_line) {
       LOG(WARNING) << absl::Substitute("Failed to parse pid file: $0", fpath);
-      continue;
+    } else if (num_digits > 0) {
+      pid_set->emplace(pid);
+    }
+    pid = 0;
+    num_digits = 0;
+    malformed_line = false;
+  };
+
+  ssize_t bytes_read;
+  while ((bytes_read = read(fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < bytes_read; ++i) {
+      char c = buf[i];
+      if (c == '\n') {
+        end_line();
+      } else if (c >= '0' && c <= '9' && num_digits < kMaxPIDDigits) {
+        pid = pid * 10 + (c - '0');
+        ++num_digits;
+      } else {
+        malformed_line = true;
+      }
     }
-    pid_set->emplace(pid);
   }
+  end_line();
   return Status::OK();
 }
 
@@ -39,8 +39,10 @@ using shared::metadatapb::MetadataType;
 using shared::metadatapb::MetadataType_Name;
 
 const absl::flat_hash_set<MetadataType> kMetadataFilterEntities = {
-    MetadataType::SERVICE_ID, MetadataType::SERVICE_NAME, MetadataType::POD_ID,
-    MetadataType::POD_NAME, MetadataType::CONTAINER_ID};
+    MetadataType::SERVICE_ID,     MetadataType::SERVICE_NAME, MetadataType::POD_ID,
+    MetadataType::POD_NAME,       MetadataType::POD_IP,       MetadataType::CONTAINER_ID,
+    MetadataType::CONTAINER_NAME, MetadataType::NAMESPACE,    MetadataType::NODE_NAME,
+    MetadataType::HOSTNAME};
 
 /**
  * An abstract class that keeps track of the various entities in this metadata state.
@@ -16,9 +16,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_set.h>
 
@@ -68,6 +71,16 @@ const DeploymentInfo* K8sMetadataState::DeploymentInfoByID(UIDView deployment_id
   return static_cast<const DeploymentInfo*>(K8sMetadataObjectByID(deployment_id, type));
 }
 
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  auto it = containers_by_id_.find(id);
+
+  if (it == containers_by_id_.end()) {
+    return nullptr;
+  }
+
+  return UnshareForWrite(&it->second);
+}
+
 const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
   auto it = containers_by_id_.find(id);
 
@@ -124,15 +137,9 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
+  // The objects themselves are shared, and only copied once they're modified.
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
 
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
@@ -188,7 +195,7 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     VLOG(1) << "Adding Pod: " << pod->DebugString();
     it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = static_cast<PodInfo*>(UnshareForWrite(&it->second));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -197,7 +204,8 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // state might be periodically inconsistent.
 
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    auto container_it = containers_by_id_.find(cid);
+    if (container_it == containers_by_id_.end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -206,7 +214,9 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    if (container_it->second->pod_id() != object_uid) {
+      UnshareForWrite(&container_it->second)->set_pod_id(object_uid);
+    }
   }
 
   for (const auto& owner_ref : update.owner_references()) {
@@ -244,7 +254,7 @@ Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = UnshareForWrite(&it->second);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
@@ -266,20 +276,23 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     VLOG(1) << "Adding Service: " << service->DebugString();
     it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
   }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info = static_cast<ServiceInfo*>(UnshareForWrite(&it->second));
 
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
+    auto pod_it = k8s_objects_by_id_.find(uid);
+    if (pod_it == k8s_objects_by_id_.end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
+    ECHECK(pod_it->second->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
-    pod_info->AddService(service_uid);
+    const auto* pod_info = static_cast<const PodInfo*>(pod_it->second.get());
+    if (!pod_info->services().contains(service_uid)) {
+      static_cast<PodInfo*>(UnshareForWrite(&pod_it->second))->AddService(service_uid);
+    }
   }
   if (update.start_timestamp_ns() != 0) {
     service_info->set_start_time_ns(update.start_timestamp_ns());
@@ -313,7 +326,7 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
     it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = static_cast<NamespaceInfo*>(UnshareForWrite(&it->second));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -342,7 +355,7 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
     VLOG(1) << "Adding ReplicaSet: " << replica_set->DebugString();
     it = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
   }
-  auto replica_set_info = static_cast<ReplicaSetInfo*>(it->second.get());
+  auto replica_set_info = static_cast<ReplicaSetInfo*>(UnshareForWrite(&it->second));
 
   for (const auto& owner_ref : update.owner_references()) {
     replica_set_info->AddOwnerReference(owner_ref.uid(), owner_ref.name(), owner_ref.kind());
@@ -375,7 +388,7 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
     VLOG(1) << "Adding Deployment: " << deployment->DebugString();
     it = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
   }
-  auto deployment_info = static_cast<DeploymentInfo*>(it->second.get());
+  auto deployment_info = static_cast<DeploymentInfo*>(UnshareForWrite(&it->second));
 
   deployment_info->set_start_time_ns(update.start_timestamp_ns());
   deployment_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -470,14 +483,74 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->last_update_ts_ns_ = last_update_ts_ns_;
   state->epoch_id_ = epoch_id_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
+  state->archived_pids_ = archived_pids_;
   return state;
 }
 
+const PIDInfo* AgentMetadataState::GetArchivedPIDByUPID(UPID upid) const {
+  if (archived_pids_ == nullptr) {
+    return nullptr;
+  }
+  auto it = std::lower_bound(
+      archived_pids_->begin(), archived_pids_->end(), upid,
+      [](const PIDInfoSPtr& pid_info, const UPID& upid) { return pid_info->upid() < upid; });
+  if (it != archived_pids_->end() && (*it)->upid() == upid) {
+    return it->get();
+  }
+  return nullptr;
+}
+
+void AgentMetadataState::ArchiveStoppedUPIDs(int64_t archive_before_ns, int64_t drop_before_ns) {
+  auto stopped_before = [](const PIDInfo& pid_info, int64_t ts) {
+    return pid_info.stop_time_ns() != 0 && pid_info.stop_time_ns() < ts;
+  };
+
+  std::vector<PIDInfoSPtr> newly_archived;
+  for (auto it = pids_by_upid_.begin(); it != pids_by_upid_.end();) {
+    const auto& pid_info = it->second;
+    if (pid_info == nullptr || !stopped_before(*pid_info, archive_before_ns)) {
+      ++it;
+      continue;
+    }
+    if (!stopped_before(*pid_info, drop_before_ns)) {
+      newly_archived.push_back(pid_info);
+    }
+    pids_by_upid_.erase(it++);
+  }
+
+  size_t num_dropped = 0;
+  if (archived_pids_ != nullptr) {
+    for (const auto& pid_info : *archived_pids_) {
+      num_dropped += stopped_before(*pid_info, drop_before_ns);
+    }
+  }
+  if (newly_archived.empty() && num_dropped == 0) {
+    // Leave the archive shared with the previous states.
+    return;
+  }
+
+  auto upid_lt = [](const PIDInfoSPtr& a, const PIDInfoSPtr& b) { return a->upid() < b->upid(); };
+  std::sort(newly_archived.begin(), newly_archived.end(), upid_lt);
+  auto archived_pids = std::make_shared<std::vector<PIDInfoSPtr>>();
+  archived_pids->reserve(num_archived_upids() - num_dropped + newly_archived.size());
+  if (archived_pids_ == nullptr) {
+    *archived_pids = std::move(newly_archived);
+  } else {
+    std::vector<PIDInfoSPtr> kept;
+    kept.reserve(archived_pids_->size() - num_dropped);
+    for (const auto& pid_info : *archived_pids_) {
+      if (!stopped_before(*pid_info, drop_before_ns)) {
+        kept.push_back(pid_info);
+      }
+    }
+    std::merge(kept.begin(), kept.end(), newly_archived.begin(), newly_archived.end(),
+               std::back_inserter(*archived_pids), upid_lt);
+  }
+  archived_pids_ = std::move(archived_pids);
+}
+
 std::string AgentMetadataState::DebugString(int indent_level) const {
   std::string str;
   std::string prefix = Indent(indent_level);
@@ -488,7 +561,8 @@ std::string AgentMetadataState::DebugString(int indent_level) const {
   str += prefix + absl::Substitute("EpochID: $0\n", epoch_id_);
   str += prefix + absl::Substitute("LastUpdateTS: $0\n", last_update_ts_ns_);
   str += prefix + k8s_metadata_state_->DebugString(indent_level);
-  str += prefix + absl::Substitute("PIDS($0)\n", pids_by_upid_.size());
+  str += prefix + absl::Substitute("PIDS($0, archived $1)\n", pids_by_upid_.size(),
+                                   num_archived_upids());
   for (const auto& [upid, upid_info] : pids_by_upid_) {
     str += prefix + absl::Substitute("$0\n", upid_info->DebugString());
   }
@@ -36,11 +36,27 @@
 namespace px {
 namespace md {
 
-using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
-using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
-using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
+using PIDInfoSPtr = std::shared_ptr<PIDInfo>;
 using AgentID = sole::uuid;
 
+/**
+ * Metadata states share every object that hasn't changed since they were cloned, so that a
+ * clone only costs as much as copying the maps of pointers. An object must be unshared, by
+ * copying it, before it's modified.
+ *
+ * Only the state being updated can hold the sole reference to an object, so a use count of one
+ * means no other snapshot can see the modification.
+ */
+template <typename T>
+T* UnshareForWrite(std::shared_ptr<T>* obj) {
+  if (obj->use_count() > 1) {
+    *obj = (*obj)->Clone();
+  }
+  return obj->get();
+}
+
 /**
  * This class contains all kubernetes relate metadata.
  */
@@ -223,6 +239,10 @@ class K8sMetadataState : NotCopyable {
    */
   UID DeploymentIDByName(K8sNameIdentView deployment_name) const;
 
+  /**
+   * Clone returns a copy of this state. The copy shares all of the metadata objects with this
+   * state until either one modifies them.
+   */
   std::unique_ptr<K8sMetadataState> Clone() const;
 
   Status HandlePodUpdate(const PodUpdate& update);
@@ -235,7 +255,18 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const absl::flat_hash_map<CID, ContainerInfoSPtr>& containers_by_id() const {
+    return containers_by_id_;
+  }
+
+  /**
+   * MutableContainerInfoByID returns the container info by ID so that it can be modified. This
+   * unshares it from other snapshots, so only call it when the container actually changes.
+   * @param id The ID of the container.
+   * @return ContainerInfo or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -248,10 +279,10 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  absl::flat_hash_map<UID, K8sMetadataObjectSPtr> k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  absl::flat_hash_map<CID, ContainerInfoSPtr> containers_by_id_;
 
   /**
    * Mapping of pods by name.
@@ -333,12 +364,12 @@ class AgentMetadataState : NotCopyable {
 
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
     auto it = pids_by_upid_.find(upid);
     if (it != pids_by_upid_.end()) {
       return it->second.get();
     }
-    return nullptr;
+    return GetArchivedPIDByUPID(upid);
   }
 
   void AddUPID(UPID upid, std::unique_ptr<PIDInfo> pid_info) {
@@ -350,22 +381,36 @@ class AgentMetadataState : NotCopyable {
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
-    if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+    auto it = pids_by_upid_.find(upid);
+    if (it != pids_by_upid_.end()) {
+      UnshareForWrite(&it->second)->set_stop_time_ns(ts);
       upids_.erase(upid);
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  // The PIDs of the running and recently stopped UPIDs. Archived UPIDs are not included.
+  const UPIDMap<PIDInfoSPtr>& pids_by_upid() const { return pids_by_upid_; }
+
+  /**
+   * ArchiveStoppedUPIDs moves the UPIDs that stopped before archive_before_ns out of
+   * pids_by_upid_ into the archive, and drops the stopped UPIDs, archived or not, that stopped
+   * before drop_before_ns, since no data can refer to them anymore. Archived UPIDs can still be
+   * looked up by GetPIDByUPID().
+   */
+  void ArchiveStoppedUPIDs(int64_t archive_before_ns, int64_t drop_before_ns);
+  size_t num_archived_upids() const {
+    return archived_pids_ == nullptr ? 0 : archived_pids_->size();
+  }
 
-  const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
+  const md::UPIDSet& upids() const { return upids_; }
 
   std::string DebugString(int indent_level = 0) const;
 
  private:
+  const PIDInfo* GetArchivedPIDByUPID(UPID upid) const;
+
   /**
    * Tracks the time that this K8s metadata object was created. The object should be periodically
    * refreshed to get the latest version.
@@ -393,14 +438,21 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  UPIDMap<PIDInfoSPtr> pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
    * While this set could be reconstructed from pids_by_upid_,
    * it is tracked separately as a performance optimization.
    */
-  absl::flat_hash_set<md::UPID> upids_;
+  md::UPIDSet upids_;
+
+  /**
+   * The PIDs of the UPIDs that stopped a while ago, sorted by UPID. Process churn can leave many
+   * of them around until their data expires, so they are kept out of pids_by_upid_, and the
+   * archive is immutable so that all clones of the state share it instead of copying it.
+   */
+  std::shared_ptr<const std::vector<PIDInfoSPtr>> archived_pids_;
 };
 
 }  // namespace md
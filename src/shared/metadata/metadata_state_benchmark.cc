@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include <absl/strings/substitute.h>
+
+#include "src/shared/metadata/metadata_state.h"
+
+using px::md::AgentMetadataState;
+using px::md::K8sMetadataState;
+using px::md::PIDInfo;
+using px::md::UPID;
+
+namespace {
+
+// Creates a state with a container, a pod and a PID for each of num_pods pods.
+std::shared_ptr<AgentMetadataState> CreateState(int64_t num_pods) {
+  auto state = std::make_shared<AgentMetadataState>(/* asid */ 1, /* pid */ 1);
+  auto* k8s_state = state->k8s_metadata_state();
+  for (int64_t i = 0; i < num_pods; ++i) {
+    K8sMetadataState::ContainerUpdate container_update;
+    container_update.set_cid(absl::Substitute("container$0", i));
+    container_update.set_name(absl::Substitute("container$0", i));
+    container_update.set_start_timestamp_ns(1);
+    PL_CHECK_OK(k8s_state->HandleContainerUpdate(container_update));
+
+    K8sMetadataState::PodUpdate pod_update;
+    pod_update.set_uid(absl::Substitute("pod$0_uid", i));
+    pod_update.set_name(absl::Substitute("pod$0", i));
+    pod_update.set_namespace_("ns");
+    pod_update.set_labels(R"({"app":"benchmark","tier":"backend"})");
+    pod_update.set_start_timestamp_ns(1);
+    pod_update.add_container_ids(container_update.cid());
+    pod_update.add_container_names(container_update.name());
+    pod_update.set_pod_ip(absl::Substitute("10.0.$0.$1", i / 256, i % 256));
+    PL_CHECK_OK(k8s_state->HandlePodUpdate(pod_update));
+
+    UPID upid(/* asid */ 1, /* pid */ static_cast<uint32_t>(i), /* ts_ns */ 1);
+    state->AddUPID(upid, std::make_unique<PIDInfo>(upid, "/usr/bin/server",
+                                                    "/usr/bin/server --port=8080",
+                                                    container_update.cid()));
+  }
+  return state;
+}
+
+// Measures the cost of creating a snapshot, as each metadata state update does.
+// NOLINTNEXTLINE : runtime/references.
+void BM_CloneToShared(benchmark::State& state) {
+  auto md_state = CreateState(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(md_state->CloneToShared());
+  }
+}
+
+// Measures a snapshot followed by updates to a few of its pods, which are the only objects
+// that end up being copied.
+// NOLINTNEXTLINE : runtime/references.
+void BM_CloneToSharedAndUpdatePods(benchmark::State& state) {
+  constexpr int64_t kNumUpdatedPods = 10;
+  auto md_state = CreateState(state.range(0));
+  for (auto _ : state) {
+    auto snapshot = md_state->CloneToShared();
+    for (int64_t i = 0; i < kNumUpdatedPods; ++i) {
+      K8sMetadataState::PodUpdate pod_update;
+      pod_update.set_uid(absl::Substitute("pod$0_uid", i));
+      pod_update.set_name(absl::Substitute("pod$0", i));
+      pod_update.set_namespace_("ns");
+      pod_update.set_stop_timestamp_ns(2);
+      PL_CHECK_OK(snapshot->k8s_metadata_state()->HandlePodUpdate(pod_update));
+    }
+    benchmark::DoNotOptimize(snapshot);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_CloneToShared)->RangeMultiplier(10)->Range(100, 50000);
+BENCHMARK(BM_CloneToSharedAndUpdatePods)->RangeMultiplier(10)->Range(100, 50000);
@@ -278,6 +278,35 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+TEST(K8sMetadataStateTest, CloneSharesObjectsUntilModified) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update));
+  K8sMetadataState::PodUpdate pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod_update));
+  ASSERT_OK(state.HandleContainerUpdate(container_update));
+  ASSERT_OK(state.HandlePodUpdate(pod_update));
+
+  auto state_copy = state.Clone();
+  EXPECT_EQ(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  // Updating the pod in the copy leaves the original, and the unchanged container, alone.
+  pod_update.set_stop_timestamp_ns(1000);
+  ASSERT_OK(state_copy->HandlePodUpdate(pod_update));
+  EXPECT_NE(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(103, state.PodInfoByID("pod0_uid")->stop_time_ns());
+  EXPECT_EQ(1000, state_copy->PodInfoByID("pod0_uid")->stop_time_ns());
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  state_copy->MutableContainerInfoByID("container0_uid")->set_stop_time_ns(2000);
+  EXPECT_NE(2000, state.ContainerInfoByID("container0_uid")->stop_time_ns());
+  EXPECT_EQ(2000, state_copy->ContainerInfoByID("container0_uid")->stop_time_ns());
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
@@ -635,5 +664,42 @@ TEST(K8sMetadataStateTest, CleanupExpiredMetadata) {
   }
 }
 
+TEST(AgentMetadataStateTest, ArchiveStoppedUPIDs) {
+  AgentMetadataState state(/* asid */ 1, /* pid */ 123);
+  for (uint32_t pid = 1; pid <= 4; ++pid) {
+    UPID upid(/* asid */ 1, pid, /* ts_ns */ 100);
+    state.AddUPID(upid, std::make_unique<PIDInfo>(upid, "/bin/exe", "exe", "cid"));
+  }
+  state.MarkUPIDAsStopped(UPID(1, 1, 100), 1000);
+  state.MarkUPIDAsStopped(UPID(1, 2, 100), 2000);
+  state.MarkUPIDAsStopped(UPID(1, 3, 100), 3000);
+
+  state.ArchiveStoppedUPIDs(/* archive_before_ns */ 2500, /* drop_before_ns */ 1500);
+  EXPECT_EQ(2, state.pids_by_upid().size());
+  EXPECT_EQ(1, state.num_archived_upids());
+  EXPECT_EQ(nullptr, state.GetPIDByUPID(UPID(1, 1, 100)));
+  const PIDInfo* archived = state.GetPIDByUPID(UPID(1, 2, 100));
+  ASSERT_NE(nullptr, archived);
+  EXPECT_EQ(2000, archived->stop_time_ns());
+  EXPECT_NE(nullptr, state.GetPIDByUPID(UPID(1, 3, 100)));
+
+  // Clones share the archive.
+  auto clone = state.CloneToShared();
+  EXPECT_EQ(archived, clone->GetPIDByUPID(UPID(1, 2, 100)));
+
+  clone->ArchiveStoppedUPIDs(/* archive_before_ns */ 3500, /* drop_before_ns */ 1500);
+  EXPECT_EQ(1, clone->pids_by_upid().size());
+  EXPECT_EQ(2, clone->num_archived_upids());
+  EXPECT_NE(nullptr, clone->GetPIDByUPID(UPID(1, 2, 100)));
+  EXPECT_NE(nullptr, clone->GetPIDByUPID(UPID(1, 3, 100)));
+  EXPECT_NE(nullptr, clone->GetPIDByUPID(UPID(1, 4, 100)));
+  EXPECT_EQ(1, state.num_archived_upids());
+
+  clone->ArchiveStoppedUPIDs(/* archive_before_ns */ 3500, /* drop_before_ns */ 2500);
+  EXPECT_EQ(1, clone->num_archived_upids());
+  EXPECT_EQ(nullptr, clone->GetPIDByUPID(UPID(1, 2, 100)));
+  EXPECT_NE(nullptr, clone->GetPIDByUPID(UPID(1, 3, 100)));
+}
+
 }  // namespace md
 }  // namespace px
@@ -16,11 +16,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_map.h>
 #include "src/shared/metadata/state_manager.h"
 
 namespace px {
@@ -38,6 +42,18 @@ constexpr uint64_t kEpochsBetweenObjectDeletion = 100;
  */
 constexpr uint64_t kMinObjectRetentionAfterDeathNS = 24ULL * 3600ULL * 1'000'000'000ULL;
 
+/**
+ * kEpochsBetweenUPIDArchival is the interval between when stopped UPIDs are archived. Processes
+ * churn much faster than K8s objects, so this runs more often than the object deletion.
+ */
+constexpr uint64_t kEpochsBetweenUPIDArchival = 12;
+
+/**
+ * kStoppedUPIDArchiveDelayNS is how long stopped UPIDs stay with the running ones, e.g. for the
+ * connectors that look up the processes that just exited, before they are archived.
+ */
+constexpr int64_t kStoppedUPIDArchiveDelayNS = 2LL * 60LL * 1'000'000'000LL;
+
 std::shared_ptr<const AgentMetadataState>
 AgentMetadataStateManagerImpl::CurrentAgentMetadataState() {
   absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
@@ -112,6 +128,14 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
         DeleteMetadataForDeadObjects(shadow_state.get(), kMinObjectRetentionAfterDeathNS));
   }
 
+  if (epoch_id % kEpochsBetweenUPIDArchival == 0) {
+    // Without a store to check, stopped UPIDs are kept as long as the other dead objects.
+    int64_t oldest_data_time_ns = oldest_data_time_fn_ != nullptr
+                                      ? oldest_data_time_fn_()
+                                      : ts - static_cast<int64_t>(kMinObjectRetentionAfterDeathNS);
+    ArchiveStoppedUPIDs(ts, oldest_data_time_ns, shadow_state.get());
+  }
+
   // Increment epoch and update ts.
   ++epoch_id;
   shadow_state->set_epoch_id(epoch_id);
@@ -128,45 +152,118 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
   return Status::OK();
 }
 
+namespace {
+
+// Coalesced updates are applied in this order, so that the objects an update refers to, such as
+// a pod's containers or a service's pods, are already in the state.
+constexpr ResourceUpdate::UpdateCase kUpdateApplyOrder[] = {
+    ResourceUpdate::kNamespaceUpdate,  ResourceUpdate::kContainerUpdate,
+    ResourceUpdate::kPodUpdate,        ResourceUpdate::kServiceUpdate,
+    ResourceUpdate::kReplicaSetUpdate, ResourceUpdate::kDeploymentUpdate,
+    ResourceUpdate::kNodeUpdate,
+};
+
+// Returns the ID of the object that the update is for, or nullopt for unknown updates.
+std::optional<std::string_view> UpdateObjectID(const ResourceUpdate& update) {
+  switch (update.update_case()) {
+    case ResourceUpdate::kPodUpdate:
+      return update.pod_update().uid();
+    case ResourceUpdate::kContainerUpdate:
+      return update.container_update().cid();
+    case ResourceUpdate::kServiceUpdate:
+      return update.service_update().uid();
+    case ResourceUpdate::kNamespaceUpdate:
+      return update.namespace_update().uid();
+    case ResourceUpdate::kNodeUpdate:
+      return update.node_update().uid();
+    case ResourceUpdate::kReplicaSetUpdate:
+      return update.replica_set_update().uid();
+    case ResourceUpdate::kDeploymentUpdate:
+      return update.deployment_update().uid();
+    default:
+      return std::nullopt;
+  }
+}
+
+Status ApplyK8sUpdate(const ResourceUpdate& update, AgentMetadataState* state,
+                      AgentMetadataFilter* metadata_filter) {
+  switch (update.update_case()) {
+    case ResourceUpdate::kPodUpdate:
+      return HandlePodUpdate(update.pod_update(), state, metadata_filter);
+    case ResourceUpdate::kContainerUpdate:
+      return HandleContainerUpdate(update.container_update(), state, metadata_filter);
+    case ResourceUpdate::kServiceUpdate:
+      return HandleServiceUpdate(update.service_update(), state, metadata_filter);
+    case ResourceUpdate::kNamespaceUpdate:
+      return HandleNamespaceUpdate(update.namespace_update(), state, metadata_filter);
+    case ResourceUpdate::kNodeUpdate:
+      return HandleNodeUpdate(update.node_update(), state, metadata_filter);
+    case ResourceUpdate::kReplicaSetUpdate:
+      return HandleReplicaSetUpdate(update.replica_set_update(), state, metadata_filter);
+    case ResourceUpdate::kDeploymentUpdate:
+      return HandleDeploymentUpdate(update.deployment_update(), state, metadata_filter);
+    default:
+      LOG(ERROR) << "Unhandled Update Type: " << update.update_case() << " (ignoring)";
+      return Status::OK();
+  }
+}
+
+// The latest update for each object of one type, in the order the objects were first updated.
+struct CoalescedUpdates {
+  std::vector<std::unique_ptr<ResourceUpdate>> updates;
+  absl::flat_hash_map<std::string, size_t> index_by_id;
+};
+
+}  // namespace
+
 Status ApplyK8sUpdates(
     int64_t ts, AgentMetadataState* state, AgentMetadataFilter* metadata_filter,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>>* updates) {
   std::unique_ptr<ResourceUpdate> update(nullptr);
   PL_UNUSED(ts);
 
+  // During rollouts the same object is often updated many times between two state updates.
+  // Each update carries the full state of its object, so only the latest one needs to be applied.
+  absl::flat_hash_map<ResourceUpdate::UpdateCase, CoalescedUpdates> updates_by_case;
+  int64_t num_updates = 0;
+
   // Returns false when no more items.
   while (updates->try_dequeue(update)) {
-    switch (update->update_case()) {
-      case ResourceUpdate::kPodUpdate:
-        PL_RETURN_IF_ERROR(HandlePodUpdate(update->pod_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kContainerUpdate:
-        PL_RETURN_IF_ERROR(
-            HandleContainerUpdate(update->container_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kServiceUpdate:
-        PL_RETURN_IF_ERROR(HandleServiceUpdate(update->service_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kNamespaceUpdate:
-        PL_RETURN_IF_ERROR(
-            HandleNamespaceUpdate(update->namespace_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kNodeUpdate:
-        PL_RETURN_IF_ERROR(HandleNodeUpdate(update->node_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kReplicaSetUpdate:
-        PL_RETURN_IF_ERROR(
-            HandleReplicaSetUpdate(update->replica_set_update(), state, metadata_filter));
-        break;
-      case ResourceUpdate::kDeploymentUpdate:
-        PL_RETURN_IF_ERROR(
-            HandleDeploymentUpdate(update->deployment_update(), state, metadata_filter));
-        break;
-      default:
-        LOG(ERROR) << "Unhandled Update Type: " << update->update_case() << " (ignoring)";
+    ++num_updates;
+    std::optional<std::string_view> id = UpdateObjectID(*update);
+    if (!id.has_value()) {
+      LOG(ERROR) << "Unhandled Update Type: " << update->update_case() << " (ignoring)";
+      continue;
+    }
+
+    CoalescedUpdates& coalesced = updates_by_case[update->update_case()];
+    auto [it, inserted] = coalesced.index_by_id.try_emplace(std::string(id.value()),
+                                                          coalesced.updates.size());
+    if (inserted) {
+      coalesced.updates.push_back(std::move(update));
+      continue;
+    }
+    // Don't let an update that was delivered late replace a newer one.
+    std::unique_ptr<ResourceUpdate>& prev = coalesced.updates[it->second];
+    if (update->update_version() >= prev->update_version()) {
+      prev = std::move(update);
     }
   }
 
+  int64_t num_applied = 0;
+  for (ResourceUpdate::UpdateCase update_case : kUpdateApplyOrder) {
+    auto it = updates_by_case.find(update_case);
+    if (it == updates_by_case.end()) {
+      continue;
+    }
+    for (const auto& coalesced_update : it->second.updates) {
+      PL_RETURN_IF_ERROR(ApplyK8sUpdate(*coalesced_update, state, metadata_filter));
+      ++num_applied;
+    }
+  }
+  VLOG(1) << absl::Substitute("Applied $0 of $1 K8s updates after coalescing", num_applied,
+                              num_updates);
+
   return Status::OK();
 }
 
@@ -177,6 +274,20 @@ StatusOr<UPID> InitUPID(const system::ProcParser& proc_parser, uint32_t asid, ui
   return UPID(asid, pid, pid_start_time);
 }
 
+// Returns true if the PIDs in the container's cgroups differ from the ones we're tracking.
+bool ContainerPIDsChanged(const StartTimeOrderedUPIDSet& upids,
+                          const absl::flat_hash_set<uint32_t>& cgroups_pids) {
+  if (upids.size() != cgroups_pids.size()) {
+    return true;
+  }
+  for (const auto& upid : upids) {
+    if (!cgroups_pids.contains(upid.pid())) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 void ProcessContainerPIDUpdates(
@@ -264,7 +375,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -282,16 +393,23 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->mutable_active_upids()->clear();
+        mutable_cinfo->mutable_active_upids()->clear();
       }
       continue;
     }
 
-    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
+    // Most containers don't change between updates, and they should stay shared with the
+    // previous metadata state.
+    if (!ContainerPIDsChanged(cinfo->active_upids(), cgroups_active_pids)) {
+      continue;
+    }
+    ProcessContainerPIDUpdates(cid, ts, proc_parser, md,
+                               k8s_md_state->MutableContainerInfoByID(cid)->mutable_active_upids(),
                                &cgroups_active_pids, pid_updates);
   }
 
@@ -303,6 +421,20 @@ Status DeleteMetadataForDeadObjects(AgentMetadataState* state, int64_t retention
   return Status::OK();
 }
 
+void ArchiveStoppedUPIDs(int64_t ts, int64_t oldest_data_time_ns, AgentMetadataState* state) {
+  int64_t archive_before_ns = ts - kStoppedUPIDArchiveDelayNS;
+  // With no data left, no data can refer to any of the archived UPIDs.
+  int64_t drop_before_ns = oldest_data_time_ns < 0
+                               ? archive_before_ns
+                               : std::min(oldest_data_time_ns, archive_before_ns);
+  size_t num_pids = state->pids_by_upid().size() + state->num_archived_upids();
+  state->ArchiveStoppedUPIDs(archive_before_ns, drop_before_ns);
+  VLOG(1) << absl::Substitute("Archived stopped UPIDs: $0 live, $1 archived, $2 dropped",
+                              state->pids_by_upid().size(), state->num_archived_upids(),
+                              num_pids - state->pids_by_upid().size() -
+                                  state->num_archived_upids());
+}
+
 std::string PrependK8sNamespace(std::string_view ns, std::string_view name) {
   return absl::Substitute("$0/$1", ns, name);
 }
@@ -314,6 +446,21 @@ Status HandlePodUpdate(const PodUpdate& update, AgentMetadataState* state,
   PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::POD_NAME, update.name()));
   PL_RETURN_IF_ERROR(md_filter->InsertEntity(
       MetadataType::POD_NAME, PrependK8sNamespace(update.namespace_(), update.name())));
+  // The MDS only sends an agent the pods on its node, so the namespace, node and host of those
+  // pods let the planner prune agents by the same filters.
+  PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::NAMESPACE, update.namespace_()));
+  if (!update.node_name().empty()) {
+    PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::NODE_NAME, update.node_name()));
+  }
+  if (!update.hostname().empty()) {
+    PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::HOSTNAME, update.hostname()));
+  }
+  if (!update.pod_ip().empty()) {
+    PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::POD_IP, update.pod_ip()));
+  }
+  for (const auto& container_name : update.container_names()) {
+    PL_RETURN_IF_ERROR(md_filter->InsertEntity(MetadataType::CONTAINER_NAME, container_name));
+  }
   return state->k8s_metadata_state()->HandlePodUpdate(update);
 }
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -109,6 +110,12 @@ class AgentMetadataStateManager {
    * @return unique_ptr with the PIDStatusEvent or nullptr.
    */
   virtual std::unique_ptr<PIDStatusEvent> GetNextPIDStatusEvent() = 0;
+
+  /**
+   * Sets the function that returns the time of the oldest data the agent stores, or -1 if it has
+   * none. Stopped UPIDs are dropped from the metadata once they stopped before that time.
+   */
+  virtual void SetOldestDataTimeFn(std::function<int64_t()> fn) = 0;
 };
 
 /**
@@ -152,6 +159,11 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
 
   std::unique_ptr<PIDStatusEvent> GetNextPIDStatusEvent() override;
 
+  void SetOldestDataTimeFn(std::function<int64_t()> fn) override {
+    std::lock_guard<std::mutex> state_update_lock(metadata_state_update_lock_);
+    oldest_data_time_fn_ = std::move(fn);
+  }
+
  private:
   /**
    * The number of PID events to send upstream.
@@ -172,6 +184,7 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
   bool collects_data_;
 
   std::mutex metadata_state_update_lock_;
+  std::function<int64_t()> oldest_data_time_fn_;
 
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> incoming_k8s_updates_;
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>> pid_updates_;
@@ -184,7 +197,8 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
 };
 
 /**
- * Applies K8s updates to the current state.
+ * Applies K8s updates to the current state. Only the latest queued update of each object is
+ * applied, and updates are applied in dependency order (e.g. containers before their pods).
  */
 Status ApplyK8sUpdates(
     int64_t ts, AgentMetadataState* state, AgentMetadataFilter* metadata_filter,
@@ -207,6 +221,12 @@ Status ProcessPIDUpdates(
  */
 Status DeleteMetadataForDeadObjects(AgentMetadataState*, int64_t ttl);
 
+/**
+ * Archives the UPIDs that have been stopped for a while, and drops the ones that stopped before
+ * the oldest data (-1 if there is no data).
+ */
+void ArchiveStoppedUPIDs(int64_t ts, int64_t oldest_data_time_ns, AgentMetadataState* state);
+
 /**
  * Handlers for K8s update types.
  */
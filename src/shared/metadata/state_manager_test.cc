@@ -392,11 +392,75 @@ TEST_F(AgentMetadataStateTest, insert_into_filter) {
   EXPECT_THAT(md_filter_.metadata_types(),
               UnorderedElementsAre(MetadataType::SERVICE_ID, MetadataType::SERVICE_NAME,
                                    MetadataType::POD_ID, MetadataType::POD_NAME,
-                                   MetadataType::CONTAINER_ID));
+                                   MetadataType::POD_IP, MetadataType::CONTAINER_ID,
+                                   MetadataType::CONTAINER_NAME, MetadataType::NAMESPACE,
+                                   MetadataType::NODE_NAME, MetadataType::HOSTNAME));
   EXPECT_THAT(md_filter_.inserted_entities(),
               ElementsAre("CONTAINER_ID=container_id1", "POD_ID=pod_id1", "POD_NAME=pod1",
-                          "POD_NAME=pl/pod1", "SERVICE_ID=service_id1", "SERVICE_NAME=service1",
-                          "SERVICE_NAME=pl/service1"));
+                          "POD_NAME=pl/pod1", "NAMESPACE=pl", "SERVICE_ID=service_id1",
+                          "SERVICE_NAME=service1", "SERVICE_NAME=pl/service1"));
+}
+
+constexpr char kScheduledPodUpdatePbtxt[] = R"(
+  pod_update {
+    name: "pod4"
+    namespace: "ns1"
+    uid: "pod_id4"
+    start_timestamp_ns: 1300
+    container_ids: "container_id4"
+    container_names: "container_name4"
+    node_name: "node1"
+    hostname: "pod4-host"
+    pod_ip: "10.0.0.4"
+    phase: RUNNING
+  }
+)";
+
+TEST_F(AgentMetadataStateTest, insert_pod_placement_into_filter) {
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
+  auto update = std::make_unique<ResourceUpdate>();
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kScheduledPodUpdatePbtxt,
+                                                            update.get()));
+  updates.enqueue(std::move(update));
+
+  EXPECT_OK(ApplyK8sUpdates(2000 /*ts*/, &metadata_state_, &md_filter_, &updates));
+  EXPECT_THAT(md_filter_.inserted_entities(),
+              ElementsAre("POD_ID=pod_id4", "POD_NAME=pod4", "POD_NAME=ns1/pod4", "NAMESPACE=ns1",
+                          "NODE_NAME=node1", "HOSTNAME=pod4-host", "POD_IP=10.0.0.4",
+                          "CONTAINER_NAME=container_name4"));
+}
+
+TEST_F(AgentMetadataStateTest, coalesce_updates_per_object) {
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
+  auto enqueue_update = [&](std::string_view pbtxt, int64_t update_version,
+                            std::string_view pod_message = "") {
+    auto update = std::make_unique<ResourceUpdate>();
+    CHECK(google::protobuf::TextFormat::MergeFromString(std::string(pbtxt), update.get()));
+    update->set_update_version(update_version);
+    if (!pod_message.empty()) {
+      update->mutable_pod_update()->set_message(std::string(pod_message));
+    }
+    updates.enqueue(std::move(update));
+  };
+  // The pod arrives before its container, and a stale pod update arrives after the latest one.
+  enqueue_update(kUpdate1_1Pbtxt, 1, "first message");
+  enqueue_update(kUpdate1_1Pbtxt, 4);
+  enqueue_update(kUpdate1_0Pbtxt, 2);
+  enqueue_update(kUpdate1_1Pbtxt, 3, "stale message");
+
+  EXPECT_OK(ApplyK8sUpdates(2000 /*ts*/, &metadata_state_, &md_filter_, &updates));
+  EXPECT_EQ(0, updates.size_approx());
+
+  const K8sMetadataState& state = metadata_state_.k8s_metadata_state();
+  const PodInfo* pod_info = state.PodInfoByID("pod_id1");
+  ASSERT_NE(nullptr, pod_info);
+  EXPECT_EQ("running message", pod_info->phase_message());
+  EXPECT_THAT(pod_info->containers(), UnorderedElementsAre("container_id1"));
+  ASSERT_NE(nullptr, state.ContainerInfoByID("container_id1"));
+  EXPECT_EQ("pod_id1", state.ContainerInfoByID("container_id1")->pod_id());
+  EXPECT_THAT(md_filter_.inserted_entities(),
+              ElementsAre("CONTAINER_ID=container_id1", "POD_ID=pod_id1", "POD_NAME=pod1",
+                          "POD_NAME=pl/pod1", "NAMESPACE=pl"));
 }
 
 TEST_F(AgentMetadataStateTest, cidr_test) {
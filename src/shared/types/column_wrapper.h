@@ -59,6 +59,17 @@ class ColumnWrapper {
   static SharedColumnWrapper FromArrow(DataType data_type,
                                        const std::shared_ptr<arrow::Array>& arr);
 
+  // Like ConvertToArrow(), but the arrow arrays of INT64, FLOAT64 and TIME64NS columns refer to
+  // the data of the column, instead of a copy of it, and keep the column alive. The column must
+  // not be modified afterwards. Other columns are converted with ConvertToArrow().
+  static std::shared_ptr<arrow::Array> ShareAsArrow(const SharedColumnWrapper& col,
+                                                    arrow::MemoryPool* mem_pool);
+  // The reverse of ShareAsArrow(): like FromArrow(), but INT64, FLOAT64 and TIME64NS columns refer
+  // to the data of the arrow array, instead of a copy of it, and keep the array alive. These
+  // columns are read-only, and may only be used through the virtual functions, so not with
+  // Get() or Append(). Other columns are converted with FromArrow().
+  static SharedColumnWrapper ViewArrow(const std::shared_ptr<arrow::Array>& arr);
+
   virtual BaseValueType* UnsafeRawData() = 0;
   virtual const BaseValueType* UnsafeRawData() const = 0;
   virtual DataType data_type() const = 0;
@@ -111,6 +122,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
   explicit ColumnWrapperTmpl(size_t size) : data_(size) {}
   explicit ColumnWrapperTmpl(size_t size, const T& val) : data_(size, val) {}
   explicit ColumnWrapperTmpl(const std::vector<T>& vals) : data_(vals) {}
+  explicit ColumnWrapperTmpl(std::vector<T>&& vals) : data_(std::move(vals)) {}
 
   ~ColumnWrapperTmpl() override = default;
 
@@ -129,7 +141,8 @@ class ColumnWrapperTmpl : public ColumnWrapper {
 
   T& operator[](size_t idx) { return data_[idx]; }
 
-  void Append(T val) { data_.push_back(val); }
+  // Values are moved in, so that appending a string doesn't copy it again.
+  void Append(T val) { data_.push_back(std::move(val)); }
 
   void Reserve(size_t size) override { data_.reserve(size); }
 
@@ -227,7 +240,9 @@ inline SharedColumnWrapper FromArrowImpl<StringValueColumnWrapper, DataType::STR
   auto arr_casted = static_cast<arrow::StringArray*>(arr.get());
   StringValue* out_data = static_cast<StringValueColumnWrapper*>(wrapper.get())->UnsafeRawData();
   for (size_t i = 0; i < size; ++i) {
-    out_data[i] = arr_casted->GetString(i);
+    // Assigned from the view, rather than through a temporary string.
+    auto view = arr_casted->GetView(i);
+    out_data[i].assign(view.data(), view.size());
   }
   return wrapper;
 }
@@ -270,12 +285,120 @@ inline SharedColumnWrapper ColumnWrapper::Make(DataType data_type, size_t size)
 #undef TYPE_CASE
 }
 
+namespace internal {
+
+// An arrow::Buffer over the data of a fixed size column, that holds a reference to the column.
+class ColumnWrapperBuffer : public arrow::Buffer {
+ public:
+  ColumnWrapperBuffer(SharedColumnWrapper col, int64_t value_size)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(col->UnsafeRawData()),
+                      static_cast<int64_t>(col->Size()) * value_size),
+        col_(std::move(col)) {}
+
+ private:
+  SharedColumnWrapper col_;
+};
+
+template <typename TValueType, typename TArrowArray>
+inline std::shared_ptr<arrow::Array> ShareFixedSizeAsArrow(
+    const SharedColumnWrapper& col, const std::shared_ptr<arrow::DataType>& arrow_type) {
+  // The value types are laid out as their native types, which is how arrow lays out its values.
+  static_assert(sizeof(TValueType) == sizeof(typename ValueTypeTraits<TValueType>::native_type));
+  auto buffer = std::make_shared<ColumnWrapperBuffer>(col, sizeof(TValueType));
+  auto data = arrow::ArrayData::Make(arrow_type, col->Size(), {nullptr, std::move(buffer)},
+                                     /*null_count*/ 0);
+  return std::make_shared<TArrowArray>(data);
+}
+
+}  // namespace internal
+
+namespace internal {
+
+// A read-only column over the values of a fixed size arrow array, that holds a reference to it.
+template <typename T>
+class ArrowViewColumnWrapper : public ColumnWrapper {
+ public:
+  // The value types are laid out as their native types, which is how arrow lays out its values.
+  static_assert(sizeof(T) == sizeof(typename ValueTypeTraits<T>::native_type));
+
+  explicit ArrowViewColumnWrapper(std::shared_ptr<arrow::Array> arr)
+      : arr_(std::move(arr)),
+        data_(reinterpret_cast<const T*>(
+            arr_->data()->GetValues<typename ValueTypeTraits<T>::native_type>(1))) {}
+
+  // The data must not be written through this, since it belongs to the arrow array.
+  T* UnsafeRawData() override { return const_cast<T*>(data_); }
+  const T* UnsafeRawData() const override { return data_; }
+  DataType data_type() const override { return ValueTypeTraits<T>::data_type; }
+  size_t Size() const override { return arr_->length(); }
+  bool Empty() const override { return arr_->length() == 0; }
+  int64_t Bytes() const override { return Size() * sizeof(T); }
+
+  void Reserve(size_t) override { LOG(DFATAL) << "Arrow views are read-only."; }
+  void Clear() override { LOG(DFATAL) << "Arrow views are read-only."; }
+  void ShrinkToFit() override {}
+  std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool*) override { return arr_; }
+  std::string_view GetView(size_t) const override { return {}; }
+
+  SharedColumnWrapper CopyIndexes(const std::vector<size_t>& indexes) const override {
+    auto copy = std::make_shared<ColumnWrapperTmpl<T>>(indexes.size());
+    T* out = copy->UnsafeRawData();
+    for (size_t i = 0; i < indexes.size(); ++i) {
+      out[i] = data_[indexes[i]];
+    }
+    return copy;
+  }
+  SharedColumnWrapper MoveIndexes(const std::vector<size_t>& indexes) override {
+    return CopyIndexes(indexes);
+  }
+
+ private:
+  std::shared_ptr<arrow::Array> arr_;
+  const T* data_;
+};
+
+}  // namespace internal
+
+inline SharedColumnWrapper ColumnWrapper::ViewArrow(const std::shared_ptr<arrow::Array>& arr) {
+  // The arrow types match those produced by ToArrow() and ShareAsArrow().
+  switch (arr->type_id()) {
+    case arrow::Type::INT64:
+      return std::make_shared<internal::ArrowViewColumnWrapper<Int64Value>>(arr);
+    case arrow::Type::DOUBLE:
+      return std::make_shared<internal::ArrowViewColumnWrapper<Float64Value>>(arr);
+    case arrow::Type::TIME64:
+      return std::make_shared<internal::ArrowViewColumnWrapper<Time64NSValue>>(arr);
+    default:
+      return FromArrow(arr);
+  }
+}
+
+inline std::shared_ptr<arrow::Array> ColumnWrapper::ShareAsArrow(const SharedColumnWrapper& col,
+                                                                 arrow::MemoryPool* mem_pool) {
+  if (col->Empty()) {
+    return col->ConvertToArrow(mem_pool);
+  }
+  // The arrow types match those produced by ToArrow().
+  switch (col->data_type()) {
+    case DataType::INT64:
+      return internal::ShareFixedSizeAsArrow<Int64Value, arrow::Int64Array>(col, arrow::int64());
+    case DataType::FLOAT64:
+      return internal::ShareFixedSizeAsArrow<Float64Value, arrow::DoubleArray>(col,
+                                                                               arrow::float64());
+    case DataType::TIME64NS:
+      return internal::ShareFixedSizeAsArrow<Time64NSValue, arrow::Time64Array>(
+          col, arrow::time64(arrow::TimeUnit::NANO));
+    default:
+      return col->ConvertToArrow(mem_pool);
+  }
+}
+
 template <class TValueType>
 inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
       << "Expect " << ToString(data_type()) << " got "
       << ToString(ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(std::move(val));
 }
 
 template <class TValueType>
@@ -293,7 +416,7 @@ inline TValueType ColumnWrapper::Get(size_t idx) const {
 template <class TValueType>
 inline void ColumnWrapper::AppendNoTypeCheck(TValueType val) {
   DCHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(std::move(val));
 }
 
 template <class TValueType>
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
@@ -151,6 +152,79 @@ TEST(ColumnWrapper, FromArrowString) {
   EXPECT_TRUE(converted_to_arrow->Equals(arr));
 }
 
+TEST(ColumnWrapper, AppendMovesStrings) {
+  auto col = ColumnWrapper::Make(DataType::STRING, 0);
+  // Longer than the small string buffer, so that a copy would allocate new data.
+  std::string value(100, 'a');
+  const char* data = value.data();
+  col->Append<StringValue>(std::move(value));
+  EXPECT_EQ(data, col->Get<StringValue>(0).data());
+
+  std::string value2(100, 'b');
+  const char* data2 = value2.data();
+  col->AppendNoTypeCheck<StringValue>(std::move(value2));
+  EXPECT_EQ(data2, col->Get<StringValue>(1).data());
+}
+
+TEST(ColumnWrapper, ShareAsArrow) {
+  auto int_col = ColumnWrapper::Make(DataType::INT64, 0);
+  auto time_col = ColumnWrapper::Make(DataType::TIME64NS, 0);
+  auto str_col = ColumnWrapper::Make(DataType::STRING, 0);
+  for (int i = 0; i < 3; ++i) {
+    int_col->Append<Int64Value>(i);
+    time_col->Append<Time64NSValue>(10 * i);
+    str_col->Append<StringValue>(std::to_string(i));
+  }
+
+  auto int_arr = ColumnWrapper::ShareAsArrow(int_col, arrow::default_memory_pool());
+  EXPECT_TRUE(int_arr->Equals(int_col->ConvertToArrow(arrow::default_memory_pool())));
+  // The array refers to the data of the column.
+  EXPECT_EQ(static_cast<arrow::Int64Array*>(int_arr.get())->raw_values(),
+            reinterpret_cast<const int64_t*>(int_col->UnsafeRawData()));
+
+  auto time_arr = ColumnWrapper::ShareAsArrow(time_col, arrow::default_memory_pool());
+  EXPECT_TRUE(time_arr->Equals(time_col->ConvertToArrow(arrow::default_memory_pool())));
+
+  auto str_arr = ColumnWrapper::ShareAsArrow(str_col, arrow::default_memory_pool());
+  EXPECT_TRUE(str_arr->Equals(str_col->ConvertToArrow(arrow::default_memory_pool())));
+
+  // The array keeps the column alive.
+  int_col.reset();
+  EXPECT_EQ(static_cast<arrow::Int64Array*>(int_arr.get())->Value(2), 2);
+}
+
+TEST(ColumnWrapper, ViewArrow) {
+  arrow::Int64Builder builder;
+  for (int i = 0; i < 4; ++i) {
+    PL_CHECK_OK(builder.Append(i));
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_CHECK_OK(builder.Finish(&arr));
+  // Views respect the offset of a sliced array.
+  auto sliced = arr->Slice(1);
+
+  auto col = ColumnWrapper::ViewArrow(sliced);
+  EXPECT_EQ(DataType::INT64, col->data_type());
+  EXPECT_EQ(3, col->Size());
+  const auto* data = static_cast<const Int64Value*>(col->UnsafeRawData());
+  EXPECT_EQ(reinterpret_cast<const int64_t*>(data),
+            static_cast<arrow::Int64Array*>(sliced.get())->raw_values());
+  EXPECT_EQ(1, data[0].val);
+  EXPECT_EQ(3, data[2].val);
+  EXPECT_EQ(sliced, col->ConvertToArrow(arrow::default_memory_pool()));
+
+  auto copy = col->CopyIndexes({2, 0});
+  EXPECT_EQ(3, copy->Get<Int64Value>(0).val);
+  EXPECT_EQ(1, copy->Get<Int64Value>(1).val);
+
+  // Other types are copied.
+  arrow::StringBuilder str_builder;
+  PL_CHECK_OK(str_builder.Append("abc"));
+  PL_CHECK_OK(str_builder.Finish(&arr));
+  auto str_col = ColumnWrapper::ViewArrow(arr);
+  EXPECT_EQ("abc", str_col->Get<StringValue>(0));
+}
+
 TEST(ColumnWrapperDeathTest, AppendTypeMismatches) {
   auto wrapper = ColumnWrapper::Make(DataType::BOOLEAN, 1);
   ASSERT_EQ(1, wrapper->Size());
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/shared/types/huge_page_memory_pool.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+
+#include "src/common/base/file.h"
+
+namespace px {
+namespace types {
+
+namespace {
+
+constexpr int64_t kDefaultHugePageSize = 2 * 1024 * 1024;
+constexpr char kMemInfoPath[] = "/proc/meminfo";
+constexpr char kTransparentHugePagesPath[] = "/sys/kernel/mm/transparent_hugepage/enabled";
+
+int64_t RoundUp(int64_t size, int64_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+// Maps length bytes at an address aligned to alignment, so that the kernel can back the mapping
+// with huge pages from its start.
+void* MapAligned(int64_t length, int64_t alignment) {
+  int64_t padded_length = length + alignment;
+  void* p = mmap(nullptr, padded_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                 0);
+  if (p == MAP_FAILED) {
+    return p;
+  }
+  auto start = reinterpret_cast<uintptr_t>(p);
+  uintptr_t aligned = RoundUp(start, alignment);
+  if (aligned > start) {
+    munmap(p, aligned - start);
+  }
+  uintptr_t end = start + padded_length;
+  if (end > aligned + length) {
+    munmap(reinterpret_cast<void*>(aligned + length), end - aligned - length);
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+}  // namespace
+
+HugePageMemoryPool::HugePageMemoryPool(Mode mode, int64_t min_mapping_bytes,
+                                       arrow::MemoryPool* parent)
+    : mode_(mode),
+      min_mapping_bytes_(std::max<int64_t>(min_mapping_bytes, 1)),
+      huge_page_size_(HugePageSize()),
+      transparent_enabled_(TransparentHugePagesEnabled()),
+      parent_(parent) {}
+
+HugePageMemoryPool::~HugePageMemoryPool() {
+  absl::MutexLock lock(&mappings_lock_);
+  DCHECK(mappings_.empty()) << "HugePageMemoryPool destroyed with live allocations";
+}
+
+bool HugePageMemoryPool::TransparentHugePagesEnabled() {
+  auto enabled = ReadFileToString(kTransparentHugePagesPath);
+  // The current setting is in brackets, e.g. "always [madvise] never".
+  return enabled.ok() && enabled.ValueOrDie().find("[never]") == std::string::npos;
+}
+
+int64_t HugePageMemoryPool::HugePageSize() {
+  auto meminfo = ReadFileToString(kMemInfoPath);
+  if (!meminfo.ok()) {
+    return kDefaultHugePageSize;
+  }
+  for (std::string_view line : absl::StrSplit(meminfo.ValueOrDie(), '\n')) {
+    // Hugepagesize:       2048 kB
+    if (!absl::ConsumePrefix(&line, "Hugepagesize:")) {
+      continue;
+    }
+    int64_t size_kb;
+    if (absl::ConsumeSuffix(&line, "kB") &&
+        absl::SimpleAtoi(absl::StripAsciiWhitespace(line), &size_kb) && size_kb > 0) {
+      return size_kb * 1024;
+    }
+  }
+  return kDefaultHugePageSize;
+}
+
+void HugePageMemoryPool::UpdateBytesAllocated(int64_t delta) {
+  int64_t bytes_allocated = bytes_allocated_.fetch_add(delta) + delta;
+  int64_t max_memory = max_memory_.load();
+  while (bytes_allocated > max_memory &&
+         !max_memory_.compare_exchange_weak(max_memory, bytes_allocated)) {
+  }
+}
+
+arrow::Status HugePageMemoryPool::Map(int64_t size, uint8_t** out) {
+  Mapping mapping{RoundUp(size, huge_page_size_)};
+  void* p = MAP_FAILED;
+  if (mode_ == Mode::kExplicit) {
+    p = mmap(nullptr, mapping.length, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    mapping.explicit_huge = p != MAP_FAILED;
+    mapping.huge = mapping.explicit_huge;
+  }
+  if (p == MAP_FAILED) {
+    p = MapAligned(mapping.length, huge_page_size_);
+    if (p == MAP_FAILED) {
+      // Leave it to the parent pool, which may have memory left to hand out.
+      ++num_fallbacks_;
+      return parent_->Allocate(size, out);
+    }
+    mapping.huge = transparent_enabled_ && madvise(p, mapping.length, MADV_HUGEPAGE) == 0;
+  }
+  if (!mapping.huge || (mode_ == Mode::kExplicit && !mapping.explicit_huge)) {
+    ++num_fallbacks_;
+  }
+
+  mapped_bytes_ += mapping.length;
+  if (mapping.huge) {
+    huge_page_bytes_ += mapping.length;
+  }
+  if (mapping.explicit_huge) {
+    explicit_huge_page_bytes_ += mapping.length;
+  }
+  *out = static_cast<uint8_t*>(p);
+  absl::MutexLock lock(&mappings_lock_);
+  mappings_[*out] = mapping;
+  return arrow::Status::OK();
+}
+
+bool HugePageMemoryPool::Unmap(uint8_t* buffer) {
+  Mapping mapping;
+  {
+    absl::MutexLock lock(&mappings_lock_);
+    auto it = mappings_.find(buffer);
+    if (it == mappings_.end()) {
+      return false;
+    }
+    mapping = it->second;
+    mappings_.erase(it);
+  }
+  munmap(buffer, mapping.length);
+  mapped_bytes_ -= mapping.length;
+  if (mapping.huge) {
+    huge_page_bytes_ -= mapping.length;
+  }
+  if (mapping.explicit_huge) {
+    explicit_huge_page_bytes_ -= mapping.length;
+  }
+  return true;
+}
+
+arrow::Status HugePageMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  auto s = IsMapped(size) ? Map(size, out) : parent_->Allocate(size, out);
+  if (s.ok()) {
+    UpdateBytesAllocated(size);
+  }
+  return s;
+}
+
+arrow::Status HugePageMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  if (!IsMapped(old_size) && !IsMapped(new_size)) {
+    auto s = parent_->Reallocate(old_size, new_size, ptr);
+    if (s.ok()) {
+      UpdateBytesAllocated(new_size - old_size);
+    }
+    return s;
+  }
+  uint8_t* out;
+  auto s = Allocate(new_size, &out);
+  if (!s.ok()) {
+    return s;
+  }
+  std::memcpy(out, *ptr, std::min(old_size, new_size));
+  Free(*ptr, old_size);
+  *ptr = out;
+  return arrow::Status::OK();
+}
+
+void HugePageMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  // Large allocations are only forwarded to the parent pool if mapping them failed.
+  if (!IsMapped(size) || !Unmap(buffer)) {
+    parent_->Free(buffer, size);
+  }
+  UpdateBytesAllocated(-size);
+}
+
+}  // namespace types
+}  // namespace px
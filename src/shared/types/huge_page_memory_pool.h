@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <atomic>
+#include <memory>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace types {
+
+/**
+ * HugePageMemoryPool is an arrow::MemoryPool that maps its large allocations directly, aligned to
+ * and in multiples of the huge page size, and asks the kernel to back them with huge pages. This
+ * cuts the TLB misses of scans over large buffers. Small allocations, which would waste most of a
+ * huge page, are forwarded to a parent pool.
+ *
+ * Explicit huge pages come from the hugetlbfs pool reserved by vm.nr_hugepages. Allocations that
+ * don't get one fall back to transparent huge pages, which the kernel may or may not provide.
+ */
+class HugePageMemoryPool final : public arrow::MemoryPool {
+ public:
+  enum class Mode {
+    // madvise(MADV_HUGEPAGE) the mappings.
+    kTransparent,
+    // Map from the explicit huge page pool, falling back to transparent huge pages.
+    kExplicit,
+  };
+
+  // Allocations smaller than this are forwarded to the parent pool.
+  static constexpr int64_t kDefaultMinMappingBytes = 1024 * 1024;
+
+  /**
+   * Create returns a new pool.
+   * @param mode how to back the mappings with huge pages.
+   * @param min_mapping_bytes allocations of at least this many bytes are mapped by the pool.
+   * @param parent the pool that smaller allocations are forwarded to.
+   */
+  static std::unique_ptr<HugePageMemoryPool> Create(
+      Mode mode, int64_t min_mapping_bytes = kDefaultMinMappingBytes,
+      arrow::MemoryPool* parent = arrow::default_memory_pool()) {
+    return std::unique_ptr<HugePageMemoryPool>(
+        new HugePageMemoryPool(mode, min_mapping_bytes, parent));
+  }
+
+  ~HugePageMemoryPool() override;
+
+  /**
+   * TransparentHugePagesEnabled returns false if the kernel doesn't support transparent huge pages
+   * or has them disabled, in which case madvise() has no effect.
+   */
+  static bool TransparentHugePagesEnabled();
+
+  /**
+   * HugePageSize returns the size of the kernel's huge pages, or of the default 2MB ones if it
+   * can't be read.
+   */
+  static int64_t HugePageSize();
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  int64_t bytes_allocated() const override { return bytes_allocated_; }
+  int64_t max_memory() const override { return max_memory_; }
+
+  int64_t huge_page_size() const { return huge_page_size_; }
+  // The bytes mapped by the pool, including the rounding up to whole huge pages.
+  int64_t mapped_bytes() const { return mapped_bytes_; }
+  // The mapped bytes that are explicit huge pages, or that the kernel was asked to back with
+  // transparent ones.
+  int64_t huge_page_bytes() const { return huge_page_bytes_; }
+  int64_t explicit_huge_page_bytes() const { return explicit_huge_page_bytes_; }
+  // The number of mappings that didn't get the huge pages asked for.
+  int64_t num_fallbacks() const { return num_fallbacks_; }
+
+ private:
+  struct Mapping {
+    int64_t length;
+    bool huge = false;
+    bool explicit_huge = false;
+  };
+
+  HugePageMemoryPool(Mode mode, int64_t min_mapping_bytes, arrow::MemoryPool* parent);
+
+  bool IsMapped(int64_t size) const { return size >= min_mapping_bytes_; }
+  arrow::Status Map(int64_t size, uint8_t** out);
+  // Returns false if the buffer wasn't mapped by the pool.
+  bool Unmap(uint8_t* buffer);
+  void UpdateBytesAllocated(int64_t delta);
+
+  const Mode mode_;
+  const int64_t min_mapping_bytes_;
+  const int64_t huge_page_size_;
+  const bool transparent_enabled_;
+  arrow::MemoryPool* const parent_;
+
+  absl::Mutex mappings_lock_;
+  // The large allocations that the pool mapped itself, rather than forwarded to its parent when
+  // mapping failed.
+  absl::flat_hash_map<uint8_t*, Mapping> mappings_ ABSL_GUARDED_BY(mappings_lock_);
+
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> max_memory_ = 0;
+  std::atomic<int64_t> mapped_bytes_ = 0;
+  std::atomic<int64_t> huge_page_bytes_ = 0;
+  std::atomic<int64_t> explicit_huge_page_bytes_ = 0;
+  std::atomic<int64_t> num_fallbacks_ = 0;
+};
+
+}  // namespace types
+}  // namespace px
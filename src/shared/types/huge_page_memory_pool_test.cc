@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "src/shared/types/huge_page_memory_pool.h"
+
+namespace px {
+namespace types {
+
+constexpr int64_t kMinMappingBytes = 64 * 1024;
+
+TEST(HugePageMemoryPoolTest, ForwardsSmallAllocations) {
+  auto pool = HugePageMemoryPool::Create(HugePageMemoryPool::Mode::kTransparent, kMinMappingBytes);
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  EXPECT_EQ(100, pool->bytes_allocated());
+  EXPECT_EQ(0, pool->mapped_bytes());
+  pool->Free(a, 100);
+  EXPECT_EQ(0, pool->bytes_allocated());
+}
+
+TEST(HugePageMemoryPoolTest, MapsLargeAllocationsInWholeHugePages) {
+  auto pool = HugePageMemoryPool::Create(HugePageMemoryPool::Mode::kTransparent, kMinMappingBytes);
+  int64_t huge_page_size = pool->huge_page_size();
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(huge_page_size + 1, &a).ok());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % huge_page_size);
+  EXPECT_EQ(2 * huge_page_size, pool->mapped_bytes());
+  EXPECT_EQ(huge_page_size + 1, pool->bytes_allocated());
+  if (HugePageMemoryPool::TransparentHugePagesEnabled()) {
+    EXPECT_EQ(2 * huge_page_size, pool->huge_page_bytes());
+  }
+  std::memset(a, 1, huge_page_size + 1);
+
+  pool->Free(a, huge_page_size + 1);
+  EXPECT_EQ(0, pool->mapped_bytes());
+  EXPECT_EQ(0, pool->huge_page_bytes());
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(huge_page_size + 1, pool->max_memory());
+}
+
+TEST(HugePageMemoryPoolTest, ReallocateAcrossMinMappingBytes) {
+  auto pool = HugePageMemoryPool::Create(HugePageMemoryPool::Mode::kTransparent, kMinMappingBytes);
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  std::memset(a, 7, 100);
+
+  ASSERT_TRUE(pool->Reallocate(100, kMinMappingBytes, &a).ok());
+  EXPECT_GT(pool->mapped_bytes(), 0);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(7, a[i]);
+  }
+
+  ASSERT_TRUE(pool->Reallocate(kMinMappingBytes, 50, &a).ok());
+  EXPECT_EQ(0, pool->mapped_bytes());
+  EXPECT_EQ(50, pool->bytes_allocated());
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_EQ(7, a[i]);
+  }
+  pool->Free(a, 50);
+  EXPECT_EQ(0, pool->bytes_allocated());
+}
+
+TEST(HugePageMemoryPoolTest, ExplicitFallsBackToTransparent) {
+  auto pool = HugePageMemoryPool::Create(HugePageMemoryPool::Mode::kExplicit, kMinMappingBytes);
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(kMinMappingBytes, &a).ok());
+  // Whether or not explicit huge pages are reserved on the host, the allocation is usable.
+  std::memset(a, 1, kMinMappingBytes);
+  EXPECT_EQ(pool->huge_page_size(), pool->mapped_bytes());
+  if (pool->explicit_huge_page_bytes() == 0) {
+    EXPECT_EQ(1, pool->num_fallbacks());
+  }
+  pool->Free(a, kMinMappingBytes);
+  EXPECT_EQ(0, pool->mapped_bytes());
+  EXPECT_EQ(0, pool->explicit_huge_page_bytes());
+}
+
+}  // namespace types
+}  // namespace px
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/shared/types/memory_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace px {
+namespace types {
+
+bool AccountingMemoryPool::Reserve(int64_t size) {
+  int64_t bytes_allocated = bytes_allocated_.fetch_add(size) + size;
+  if (limit_bytes_ > 0 && size > 0 && bytes_allocated > limit_bytes_) {
+    bytes_allocated_.fetch_sub(size);
+    limit_exceeded_ = true;
+    return false;
+  }
+  int64_t max_memory = max_memory_.load();
+  while (bytes_allocated > max_memory &&
+         !max_memory_.compare_exchange_weak(max_memory, bytes_allocated)) {
+  }
+  return true;
+}
+
+int AccountingMemoryPool::SizeClass(int64_t size) {
+  int size_class = 0;
+  for (int64_t class_size = kMinRecycledBufferSize; class_size < size; class_size <<= 1) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+arrow::Status AccountingMemoryPool::AllocateBuffer(int64_t size, uint8_t** out) {
+  if (!Recyclable(size)) {
+    return parent_->Allocate(size, out);
+  }
+  int size_class = SizeClass(size);
+  {
+    absl::MutexLock lock(&cache_lock_);
+    auto& buffers = cached_buffers_[size_class];
+    if (!buffers.empty()) {
+      *out = buffers.back();
+      buffers.pop_back();
+      cached_bytes_ -= kMinRecycledBufferSize << size_class;
+      return arrow::Status::OK();
+    }
+  }
+  return parent_->Allocate(kMinRecycledBufferSize << size_class, out);
+}
+
+void AccountingMemoryPool::FreeBuffer(uint8_t* buffer, int64_t size) {
+  if (!Recyclable(size)) {
+    parent_->Free(buffer, size);
+    return;
+  }
+  int size_class = SizeClass(size);
+  int64_t class_size = kMinRecycledBufferSize << size_class;
+  {
+    absl::MutexLock lock(&cache_lock_);
+    if (!released_ && cached_bytes_ + class_size <= recycle_bytes_) {
+      cached_buffers_[size_class].push_back(buffer);
+      cached_bytes_ += class_size;
+      return;
+    }
+  }
+  parent_->Free(buffer, class_size);
+}
+
+arrow::Status AccountingMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  if (!Reserve(size)) {
+    return arrow::Status::OutOfMemory("Allocation of ", size, " bytes is over the pool limit of ",
+                                      limit_bytes_, " bytes");
+  }
+  auto s = AllocateBuffer(size, out);
+  if (!s.ok()) {
+    bytes_allocated_.fetch_sub(size);
+    return s;
+  }
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  return s;
+}
+
+arrow::Status AccountingMemoryPool::Reallocate(int64_t old_size, int64_t new_size,
+                                               uint8_t** ptr) {
+  if (!Reserve(new_size - old_size)) {
+    return arrow::Status::OutOfMemory("Reallocation to ", new_size,
+                                      " bytes is over the pool limit of ", limit_bytes_, " bytes");
+  }
+  if (!Recyclable(old_size) && !Recyclable(new_size)) {
+    auto s = parent_->Reallocate(old_size, new_size, ptr);
+    if (!s.ok()) {
+      bytes_allocated_.fetch_sub(new_size - old_size);
+    }
+    return s;
+  }
+  // A recycled buffer already has the room of its whole size class.
+  if (Recyclable(old_size) && Recyclable(new_size) && SizeClass(old_size) == SizeClass(new_size)) {
+    return arrow::Status::OK();
+  }
+  uint8_t* out;
+  auto s = AllocateBuffer(new_size, &out);
+  if (!s.ok()) {
+    bytes_allocated_.fetch_sub(new_size - old_size);
+    return s;
+  }
+  std::memcpy(out, *ptr, std::min(old_size, new_size));
+  FreeBuffer(*ptr, old_size);
+  *ptr = out;
+  return s;
+}
+
+void AccountingMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  FreeBuffer(buffer, size);
+  bytes_allocated_.fetch_sub(size);
+  Unref();
+}
+
+void AccountingMemoryPool::Release() {
+  std::vector<uint8_t*> cached_buffers[kNumSizeClasses];
+  {
+    absl::MutexLock lock(&cache_lock_);
+    released_ = true;
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      cached_buffers[i].swap(cached_buffers_[i]);
+    }
+    cached_bytes_ = 0;
+  }
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    for (uint8_t* buffer : cached_buffers[i]) {
+      parent_->Free(buffer, kMinRecycledBufferSize << i);
+    }
+  }
+  Unref();
+}
+
+void AccountingMemoryPool::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace types
+}  // namespace px
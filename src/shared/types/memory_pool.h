@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <absl/synchronization/mutex.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace types {
+
+/**
+ * AccountingMemoryPool is an arrow::MemoryPool that tracks the current and peak bytes allocated
+ * through it, and optionally caps them, so that the memory of each table or query can be told
+ * apart. Allocations are forwarded to a parent pool.
+ *
+ * Arrow buffers can outlive their owner (e.g. a slice of a table's batch held by a query after the
+ * table is dropped), so the pool is only deleted once both its owner has released it and all its
+ * allocations are freed.
+ *
+ * The pool can also recycle the buffers freed through it: buffers of up to kMaxRecycledBufferSize
+ * are rounded up to a power of two, and freed buffers are kept per size class, up to a cap on the
+ * cached bytes, to serve later allocations of the same class without going to the parent. A query
+ * allocates and frees the same few buffer sizes for every batch, so most of its allocations are
+ * served from the cache. The cache is emptied when the owner releases the pool.
+ */
+class AccountingMemoryPool final : public arrow::MemoryPool {
+ public:
+  struct Releaser {
+    void operator()(AccountingMemoryPool* pool) const { pool->Release(); }
+  };
+  using UPtr = std::unique_ptr<AccountingMemoryPool, Releaser>;
+
+  /**
+   * Create returns a new pool.
+   * @param limit_bytes allocations that would take the pool past this many bytes fail with an out
+   * of memory error. No limit if 0.
+   * @param parent the pool that allocations are forwarded to.
+   * @param recycle_bytes the most bytes of freed buffers the pool keeps for reuse. Buffers aren't
+   * recycled if 0.
+   */
+  static UPtr Create(int64_t limit_bytes = 0,
+                     arrow::MemoryPool* parent = arrow::default_memory_pool(),
+                     int64_t recycle_bytes = 0) {
+    return UPtr(new AccountingMemoryPool(limit_bytes, parent, recycle_bytes));
+  }
+
+  static constexpr int64_t kMinRecycledBufferSize = 64;
+  static constexpr int64_t kMaxRecycledBufferSize = 16 * 1024 * 1024;
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  /**
+   * Charge accounts for memory that was allocated outside of the pool (e.g. hash tables), so that
+   * it counts towards the limit. A negative size releases memory that was charged before.
+   * @return false if the charge would take the pool past its limit, in which case it isn't made.
+   */
+  bool Charge(int64_t size) { return Reserve(size); }
+
+  int64_t bytes_allocated() const override { return bytes_allocated_; }
+  int64_t max_memory() const override { return max_memory_; }
+  int64_t limit_bytes() const { return limit_bytes_; }
+  // Whether an allocation or charge has ever failed because of the limit.
+  bool limit_exceeded() const { return limit_exceeded_; }
+  // The bytes of freed buffers currently kept for reuse. They don't count as allocated.
+  int64_t cached_bytes() const {
+    absl::MutexLock lock(&cache_lock_);
+    return cached_bytes_;
+  }
+
+ private:
+  // The number of power of two size classes from kMinRecycledBufferSize to kMaxRecycledBufferSize.
+  static constexpr int kNumSizeClasses = 19;
+
+  AccountingMemoryPool(int64_t limit_bytes, arrow::MemoryPool* parent, int64_t recycle_bytes)
+      : limit_bytes_(limit_bytes), parent_(parent), recycle_bytes_(recycle_bytes) {}
+  ~AccountingMemoryPool() override = default;
+
+  // Reserve adds to the bytes allocated, unless that would go past the limit.
+  bool Reserve(int64_t size);
+
+  // Whether buffers of the given requested size are rounded up to their size class and recycled.
+  bool Recyclable(int64_t size) const {
+    return recycle_bytes_ > 0 && size > 0 && size <= kMaxRecycledBufferSize;
+  }
+  static int SizeClass(int64_t size);
+  // AllocateBuffer and FreeBuffer get buffers from and return them to the cache or the parent,
+  // without any accounting.
+  arrow::Status AllocateBuffer(int64_t size, uint8_t** out);
+  void FreeBuffer(uint8_t* buffer, int64_t size);
+
+  // Release empties the cache and drops the owner's reference.
+  void Release();
+  void Unref();
+
+  const int64_t limit_bytes_;
+  arrow::MemoryPool* const parent_;
+  const int64_t recycle_bytes_;
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> max_memory_ = 0;
+  std::atomic<bool> limit_exceeded_ = false;
+  // One reference for the owner, and one for each allocation that hasn't been freed.
+  std::atomic<int64_t> refs_ = 1;
+
+  mutable absl::Mutex cache_lock_;
+  // The freed buffers of each size class.
+  std::vector<uint8_t*> cached_buffers_[kNumSizeClasses] ABSL_GUARDED_BY(cache_lock_);
+  int64_t cached_bytes_ ABSL_GUARDED_BY(cache_lock_) = 0;
+  // Set once the owner released the pool, after which freed buffers go back to the parent.
+  bool released_ ABSL_GUARDED_BY(cache_lock_) = false;
+};
+
+}  // namespace types
+}  // namespace px
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/shared/types/memory_pool.h"
+
+namespace px {
+namespace types {
+
+TEST(AccountingMemoryPoolTest, TracksCurrentAndPeakBytes) {
+  auto pool = AccountingMemoryPool::Create();
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  ASSERT_TRUE(pool->Allocate(50, &b).ok());
+  EXPECT_EQ(150, pool->bytes_allocated());
+
+  ASSERT_TRUE(pool->Reallocate(100, 200, &a).ok());
+  EXPECT_EQ(250, pool->bytes_allocated());
+  pool->Free(b, 50);
+  EXPECT_EQ(200, pool->bytes_allocated());
+  pool->Free(a, 200);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(250, pool->max_memory());
+}
+
+TEST(AccountingMemoryPoolTest, Limit) {
+  auto pool = AccountingMemoryPool::Create(/*limit_bytes*/ 100);
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(80, &a).ok());
+  EXPECT_TRUE(pool->Allocate(30, &b).IsOutOfMemory());
+  EXPECT_TRUE(pool->Reallocate(80, 120, &a).IsOutOfMemory());
+  EXPECT_EQ(80, pool->bytes_allocated());
+
+  // Shrinking is always allowed.
+  ASSERT_TRUE(pool->Reallocate(80, 10, &a).ok());
+  ASSERT_TRUE(pool->Allocate(30, &b).ok());
+  pool->Free(a, 10);
+  pool->Free(b, 30);
+  EXPECT_EQ(0, pool->bytes_allocated());
+}
+
+TEST(AccountingMemoryPoolTest, Charge) {
+  auto pool = AccountingMemoryPool::Create(/*limit_bytes*/ 100);
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(40, &a).ok());
+  EXPECT_TRUE(pool->Charge(50));
+  EXPECT_EQ(90, pool->bytes_allocated());
+  EXPECT_FALSE(pool->limit_exceeded());
+
+  EXPECT_FALSE(pool->Charge(20));
+  EXPECT_TRUE(pool->limit_exceeded());
+  EXPECT_EQ(90, pool->bytes_allocated());
+
+  EXPECT_TRUE(pool->Charge(-50));
+  pool->Free(a, 40);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(90, pool->max_memory());
+}
+
+TEST(AccountingMemoryPoolTest, AllocationsOutliveOwner) {
+  auto pool = AccountingMemoryPool::Create();
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  AccountingMemoryPool* raw_pool = pool.get();
+  pool.reset();
+  // The pool is deleted with its last allocation.
+  raw_pool->Free(a, 100);
+}
+
+TEST(AccountingMemoryPoolTest, RecyclesFreedBuffers) {
+  auto pool = AccountingMemoryPool::Create(/*limit_bytes*/ 0, arrow::default_memory_pool(),
+                                           /*recycle_bytes*/ 1024);
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  pool->Free(a, 100);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(128, pool->cached_bytes());
+
+  // Any size of the same class gets the freed buffer back.
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(120, &b).ok());
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(0, pool->cached_bytes());
+  EXPECT_EQ(120, pool->bytes_allocated());
+
+  // Growing within the size class keeps the buffer, growing past it moves to a bigger one.
+  ASSERT_TRUE(pool->Reallocate(120, 128, &b).ok());
+  EXPECT_EQ(a, b);
+  b[0] = 42;
+  ASSERT_TRUE(pool->Reallocate(128, 500, &b).ok());
+  EXPECT_EQ(42, b[0]);
+  EXPECT_EQ(128, pool->cached_bytes());
+  EXPECT_EQ(500, pool->bytes_allocated());
+
+  // Freed buffers past the cap go back to the parent.
+  pool->Free(b, 500);
+  uint8_t* c;
+  ASSERT_TRUE(pool->Allocate(1000, &c).ok());
+  pool->Free(c, 1000);
+  EXPECT_EQ(128 + 512, pool->cached_bytes());
+  EXPECT_EQ(0, pool->bytes_allocated());
+}
+
+TEST(AccountingMemoryPoolTest, BuffersFreedAfterReleaseAreNotRecycled) {
+  auto pool = AccountingMemoryPool::Create(/*limit_bytes*/ 0, arrow::default_memory_pool(),
+                                           /*recycle_bytes*/ 1024);
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(100, &a).ok());
+  ASSERT_TRUE(pool->Allocate(100, &b).ok());
+  pool->Free(a, 100);
+  AccountingMemoryPool* raw_pool = pool.get();
+  pool.reset();
+  EXPECT_EQ(0, raw_pool->cached_bytes());
+  raw_pool->Free(b, 100);
+}
+
+}  // namespace types
+}  // namespace px
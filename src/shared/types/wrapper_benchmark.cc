@@ -18,12 +18,17 @@
 
 #include <benchmark/benchmark.h>
 
+#include <arrow/builder.h>
+
 #include <random>
 #include <vector>
 #include "src/common/benchmark/benchmark.h"
 #include "src/datagen/datagen.h"
+#include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 
+using px::types::ColumnWrapper;
+using px::types::DataType;
 using px::types::Int64Value;
 
 // This is just a dummy function that does some work so we can use it in the benchmark.
@@ -65,3 +70,38 @@ static void BM_Int64Vector(benchmark::State& state) {  // NOLINT
 
 BENCHMARK_TEMPLATE(BM_Int64Vector, int64_t)->Arg(10000);
 BENCHMARK_TEMPLATE(BM_Int64Vector, Int64Value)->Arg(10000);
+
+// Converts an arrow array to a column, as UDF evaluation does with its input columns.
+template <bool share>
+static void BM_ArrowToWrapper(benchmark::State& state) {  // NOLINT
+  arrow::Int64Builder builder;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    PL_CHECK_OK(builder.Append(i));
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_CHECK_OK(builder.Finish(&arr));
+
+  for (auto _ : state) {
+    auto col = share ? ColumnWrapper::ViewArrow(arr) : ColumnWrapper::FromArrow(arr);
+    benchmark::DoNotOptimize(col->UnsafeRawData());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * sizeof(int64_t));
+}
+
+// Converts a column to an arrow array, as UDF evaluation does with its results.
+template <bool share>
+static void BM_WrapperToArrow(benchmark::State& state) {  // NOLINT
+  auto col = ColumnWrapper::Make(DataType::INT64, state.range(0));
+
+  for (auto _ : state) {
+    auto arr = share ? ColumnWrapper::ShareAsArrow(col, arrow::default_memory_pool())
+                     : col->ConvertToArrow(arrow::default_memory_pool());
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * sizeof(int64_t));
+}
+
+BENCHMARK_TEMPLATE(BM_ArrowToWrapper, false)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_ArrowToWrapper, true)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_WrapperToArrow, false)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_WrapperToArrow, true)->Arg(1024)->Arg(65536);
@@ -21,8 +21,11 @@
 #include <string>
 #include <utility>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/hash/hash.h>
 #include <absl/numeric/int128.h>
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 #include <sole.hpp>
 
@@ -81,7 +84,8 @@ class UPID {
     return sole::rebuild(absl::Uint128High64(value_), absl::Uint128Low64(value_));
   }
 
-  std::string String() const { return absl::Substitute("$0:$1:$2", asid(), pid(), start_ts()); }
+  // Formats as asid:pid:start_ts. StrCat avoids parsing a format string on every call.
+  std::string String() const { return absl::StrCat(asid(), ":", pid(), ":", start_ts()); }
 
   bool operator==(const UPID& rhs) const { return this->value_ == rhs.value_; }
 
@@ -106,6 +110,32 @@ class UPID {
   absl::uint128 value_ = 0;
 };
 
+/**
+ * Hash for UPID keyed containers. absl::Hash mixes each 64-bit half of the value separately;
+ * here the halves are folded together first so a key costs a single finalizer round. The pid
+ * and the start time carry nearly all the entropy, and the finalizer spreads it to the high
+ * bits the swiss tables use for their control bytes.
+ */
+struct UPIDHash {
+  size_t operator()(const UPID& upid) const {
+    uint64_t h = absl::Uint128High64(upid.value()) * 0x9e3779b97f4a7c15ULL;
+    h ^= absl::Uint128Low64(upid.value());
+    // Murmur3 fmix64.
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+};
+
+// Containers keyed by UPID. Use these rather than the absl containers directly, so all UPID
+// lookups share UPIDHash and the containers can be passed between modules.
+using UPIDSet = absl::flat_hash_set<UPID, UPIDHash>;
+template <typename TValue>
+using UPIDMap = absl::flat_hash_map<UPID, TValue, UPIDHash>;
+
 // Needed for gtest to print UPID.
 inline std::ostream& operator<<(std::ostream& os, const md::UPID& upid) {
   os << upid.String();
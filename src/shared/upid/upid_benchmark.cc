@@ -19,11 +19,15 @@
 #include <absl/container/flat_hash_set.h>
 #include <benchmark/benchmark.h>
 #include <random>
+#include <set>
+#include <vector>
 
 #include "src/common/benchmark/benchmark.h"
 #include "src/shared/upid/upid.h"
 
 using ::px::md::UPID;
+using ::px::md::UPIDHash;
+using ::px::md::UPIDSet;
 
 template <typename UpidSetType>
 static void BM_set_insertion(benchmark::State& state) {  // NOLINT
@@ -37,3 +41,55 @@ static void BM_set_insertion(benchmark::State& state) {  // NOLINT
 
 BENCHMARK_TEMPLATE(BM_set_insertion, std::set<UPID>)->DenseRange(100, 1000, 100);
 BENCHMARK_TEMPLATE(BM_set_insertion, absl::flat_hash_set<UPID>)->DenseRange(100, 1000, 100);
+BENCHMARK_TEMPLATE(BM_set_insertion, UPIDSet)->DenseRange(100, 1000, 100);
+
+// Looks up live UPIDs, as the metadata UDFs do for every row.
+template <typename UpidSetType>
+static void BM_set_lookup(benchmark::State& state) {  // NOLINT
+  UpidSetType upid_set;
+  std::vector<UPID> upids;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    upids.emplace_back(1, static_cast<uint32_t>(i), 1000000 * i);
+    upid_set.insert(upids.back());
+  }
+  size_t found = 0;
+  for (auto _ : state) {
+    for (const auto& upid : upids) {
+      found += upid_set.contains(upid);
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_set_lookup, absl::flat_hash_set<UPID>)->Arg(1000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_set_lookup, UPIDSet)->Arg(1000)->Arg(100000);
+
+template <typename Hash>
+static void BM_hash(benchmark::State& state) {  // NOLINT
+  UPID upid(1, 12345, 1643000000000000000);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Hash()(upid));
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_hash, absl::Hash<UPID>);
+BENCHMARK_TEMPLATE(BM_hash, UPIDHash);
+
+static void BM_substitute_string(benchmark::State& state) {  // NOLINT
+  UPID upid(1, 12345, 1643000000000000000);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        absl::Substitute("$0:$1:$2", upid.asid(), upid.pid(), upid.start_ts()));
+  }
+}
+
+static void BM_string(benchmark::State& state) {  // NOLINT
+  UPID upid(1, 12345, 1643000000000000000);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(upid.String());
+  }
+}
+
+BENCHMARK(BM_substitute_string);
+BENCHMARK(BM_string);
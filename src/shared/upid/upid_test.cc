@@ -52,6 +52,22 @@ TEST(UPID, hash_func) {
   }));
 }
 
+TEST(UPID, upid_hash) {
+  UPIDHash hash;
+  EXPECT_EQ(hash(UPID(123, 456, 789)), hash(UPID(123, 456, 789)));
+  EXPECT_NE(hash(UPID(123, 456, 789)), hash(UPID(123, 457, 789)));
+  EXPECT_NE(hash(UPID(123, 456, 789)), hash(UPID(124, 456, 789)));
+  EXPECT_NE(hash(UPID(123, 456, 789)), hash(UPID(123, 456, 790)));
+
+  UPIDMap<int> map;
+  for (uint32_t pid = 0; pid < 1000; ++pid) {
+    map[UPID(1, pid, 100 + pid)] = pid;
+  }
+  ASSERT_EQ(1000, map.size());
+  EXPECT_EQ(42, map.at(UPID(1, 42, 142)));
+  EXPECT_FALSE(map.contains(UPID(2, 42, 142)));
+}
+
 TEST(UPID, string) {
   EXPECT_EQ("123:456:3420030816657", UPID(123, 456, 3420030816657ULL).String());
   EXPECT_EQ("12:456:3420030816657", UPID(12, 456, 3420030816657ULL).String());
@@ -76,7 +76,10 @@ Status StirlingWrapperCallback(uint64_t table_id, TabletID /* tablet_id */,
   auto iter = g_table_info_map.find(table_id);
   CHECK(iter != g_table_info_map.end());
   const InfoClass& table_info = iter->second;
-  CHECK_EQ(table_info.schema().name(), "stack_traces.beta");
+  if (table_info.schema().name() != "stack_traces.beta") {
+    // The pprof profiles table is not printed.
+    return Status::OK();
+  }
 
   auto& upid_col = (*record_batch)[px::stirling::kStackTraceUPIDIdx];
   auto& stack_trace_str_col = (*record_batch)[px::stirling::kStackTraceStackTraceStrIdx];
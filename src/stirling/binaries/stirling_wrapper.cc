@@ -30,6 +30,7 @@
 #include "src/common/signal/signal.h"
 #include "src/stirling/core/output.h"
 #include "src/stirling/core/pub_sub_manager.h"
+#include "src/stirling/core/record_capture.h"
 #include "src/stirling/core/source_registry.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/dynamic_tracer.h"
 #include "src/stirling/stirling.h"
@@ -46,6 +47,7 @@ using ::px::StatusOr;
 
 using ::px::stirling::CreateSourceRegistryFromFlag;
 using ::px::stirling::IndexPublication;
+using ::px::stirling::RecordCaptureWriter;
 using ::px::stirling::SourceConnectorGroup;
 using ::px::stirling::SourceRegistry;
 using ::px::stirling::Stirling;
@@ -64,6 +66,9 @@ DEFINE_string(trace, "",
 DEFINE_string(print_record_batches,
               "http_events,mysql_events,pgsql_events,redis_events,cql_events,dns_events",
               "Comma-separated list of tables to print.");
+DEFINE_string(capture_file, "",
+              "If set, all pushed records are also written to this file, which the replay source "
+              "can replay with --stirling_sources=replay --stirling_replay_capture_file.");
 DEFINE_bool(init_only, false, "If true, only runs the init phase and exits. For testing.");
 DEFINE_int32(timeout_secs, -1,
              "If non-negative, only runs for the specified amount of time and exits.");
@@ -82,6 +87,7 @@ absl::flat_hash_set<std::string> g_table_print_enables;
 
 absl::flat_hash_map<uint64_t, InfoClass> g_table_info_map;
 absl::base_internal::SpinLock g_callback_state_lock;
+std::unique_ptr<RecordCaptureWriter> g_capture_writer;
 
 Status StirlingWrapperCallback(uint64_t table_id, TabletID /* tablet_id */,
                                std::unique_ptr<ColumnWrapperRecordBatch> record_batch) {
@@ -99,6 +105,11 @@ Status StirlingWrapperCallback(uint64_t table_id, TabletID /* tablet_id */,
     std::cout << ToString(table_info.schema().name(), table_info.schema(), *record_batch);
   }
 
+  if (g_capture_writer != nullptr) {
+    PL_RETURN_IF_ERROR(
+        g_capture_writer->Write(table_info.schema(), px::CurrentTimeNS(), *record_batch));
+  }
+
   return Status::OK();
 }
 
@@ -283,6 +294,10 @@ int main(int argc, char** argv) {
     g_table_print_enables = absl::StrSplit(FLAGS_print_record_batches, ",", absl::SkipWhitespace());
   }
 
+  if (!FLAGS_capture_file.empty()) {
+    PL_ASSIGN_OR_EXIT(g_capture_writer, RecordCaptureWriter::Create(FLAGS_capture_file));
+  }
+
   // Make Stirling.
   std::unique_ptr<Stirling> stirling = Stirling::Create(CreateSourceRegistryFromFlag());
   g_stirling = stirling.get();
@@ -18,11 +18,20 @@
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 
+#include <fcntl.h>
 #include <linux/perf_event.h>
 #include <sys/mount.h>
+#include <unistd.h>
+
+#include <bcc/bcc_syms.h>
+#include <bcc/libbpf.h>
 
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/ascii.h>
 
 #include <magic_enum.hpp>
 
@@ -216,6 +225,123 @@ Status BCCWrapper::AttachUProbe(const UProbeSpec& probe) {
   return Status::OK();
 }
 
+namespace {
+
+// A uprobe, resolved to the object file and offset that the kernel attaches it to.
+struct ResolvedUProbe {
+  std::string module;
+  uint64_t offset = 0;
+  int prog_fd = -1;
+  std::string event_name;
+};
+
+// Resolves the probe as ebpf::BPF::attach_uprobe() does.
+Status ResolveUProbe(const UProbeSpec& probe, ResolvedUProbe* resolved) {
+  bcc_symbol_option option = {};
+  option.use_debug_file = 1;
+  option.check_debug_file_crc = 1;
+  option.use_symbol_type = BCC_SYM_ALL_TYPES;
+
+  bcc_symbol sym = {};
+  if (bcc_resolve_symname(probe.binary_path.c_str(), probe.symbol.c_str(), probe.address,
+                          probe.pid, &option, &sym) < 0) {
+    return error::Internal("Unable to find offset for binary $0 symbol $1 address $2",
+                           probe.binary_path.string(), probe.symbol, probe.address);
+  }
+  if (sym.module != nullptr) {
+    resolved->module = sym.module;
+    ::free(const_cast<char*>(sym.module));
+  }
+  resolved->offset = sym.offset;
+
+  // Same as the name ebpf::BPF gives the event, which is only used if tracefs is.
+  std::string module = resolved->module;
+  for (char& c : module) {
+    if (!absl::ascii_isalnum(c) && c != '_') {
+      c = '_';
+    }
+  }
+  resolved->event_name =
+      absl::StrCat(probe.attach_type == BPFProbeAttachType::kEntry ? "p_" : "r_", module, "_0x",
+                   absl::Hex(resolved->offset));
+  if (probe.pid != UProbeSpec::kDefaultPID) {
+    absl::StrAppend(&resolved->event_name, "_", probe.pid);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+std::vector<Status> BCCWrapper::AttachUProbesParallel(const ArrayView<UProbeSpec>& probes,
+                                                      ThreadPool* pool) {
+  static HotPathStat* resolve_stat = StirlingMonitor::GetInstance()->GetHotPathStat(
+      HotPathStat::Type::kDurationNS, "uprobe", "resolve_ns");
+  static HotPathStat* attach_stat = StirlingMonitor::GetInstance()->GetHotPathStat(
+      HotPathStat::Type::kDurationNS, "uprobe", "attach_ns");
+
+  std::vector<Status> statuses(probes.size());
+  std::vector<ResolvedUProbe> resolved(probes.size());
+
+  // Loading the probe functions goes through bpf_, so it is done here, up front.
+  for (size_t i = 0; i < probes.size(); ++i) {
+    const UProbeSpec& probe = probes[i];
+    VLOG(1) << "Deploying uprobe: " << probe.ToString();
+    DCHECK(probe.attach_type != BPFProbeAttachType::kReturnInsts);
+    DCHECK((probe.symbol.empty() && probe.address != 0) ||
+           (!probe.symbol.empty() && probe.address == 0))
+        << "Exactly one of 'symbol' and 'address' must be specified.";
+    statuses[i] = StatusAdapter(
+        bpf_.load_func(std::string(probe.probe_fn), BPF_PROG_TYPE_KPROBE, resolved[i].prog_fd));
+  }
+
+  ParallelFor(pool, probes.size(), [&](size_t i) {
+    if (!statuses[i].ok()) {
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    statuses[i] = ResolveUProbe(probes[i], &resolved[i]);
+    resolve_stat->RecordDuration(std::chrono::steady_clock::now() - start);
+  });
+
+  // A probe must not be attached twice, which would also clash in tracefs.
+  absl::flat_hash_set<std::string> event_names;
+  for (const auto& p : direct_uprobes_) {
+    event_names.insert(p.event_name);
+  }
+  for (size_t i = 0; i < probes.size(); ++i) {
+    if (statuses[i].ok() && !event_names.insert(resolved[i].event_name).second) {
+      statuses[i] = error::AlreadyExists("Uprobe $0 is already attached", resolved[i].event_name);
+    }
+  }
+
+  std::vector<int> perf_event_fds(probes.size(), -1);
+  ParallelFor(pool, probes.size(), [&](size_t i) {
+    if (!statuses[i].ok()) {
+      return;
+    }
+    const UProbeSpec& probe = probes[i];
+    auto start = std::chrono::steady_clock::now();
+    perf_event_fds[i] = bpf_attach_uprobe(
+        resolved[i].prog_fd, static_cast<bpf_probe_attach_type>(probe.attach_type),
+        resolved[i].event_name.c_str(), probe.binary_path.c_str(), resolved[i].offset, probe.pid,
+        /*ref_ctr_offset*/ 0);
+    if (perf_event_fds[i] < 0) {
+      statuses[i] = error::Internal("Unable to attach uprobe for binary $0 symbol $1 address $2",
+                                    probe.binary_path.string(), probe.symbol, probe.address);
+      return;
+    }
+    attach_stat->RecordDuration(std::chrono::steady_clock::now() - start);
+  });
+
+  for (size_t i = 0; i < probes.size(); ++i) {
+    if (perf_event_fds[i] >= 0) {
+      direct_uprobes_.push_back({std::move(resolved[i].event_name), perf_event_fds[i]});
+      ++num_attached_uprobes_;
+    }
+  }
+  return statuses;
+}
+
 Status BCCWrapper::AttachSamplingProbe(const SamplingProbeSpec& probe) {
   constexpr uint64_t kNanosPerMilli = 1000 * 1000;
   const uint64_t sample_period = probe.period_millis * kNanosPerMilli;
@@ -281,6 +407,33 @@ Status BCCWrapper::AttachXDP(const std::string& dev_name, const std::string& fn_
   return Status::OK();
 }
 
+Status BCCWrapper::AttachCGroupSKB(const std::string& cgroup_path,
+                                   enum bpf_attach_type attach_type, const std::string& fn_name) {
+  int fn_fd = -1;
+  ebpf::StatusTuple load_status = bpf_.load_func(fn_name, BPF_PROG_TYPE_CGROUP_SKB, fn_fd);
+
+  if (!load_status.ok()) {
+    return StatusAdapter(load_status);
+  }
+
+  int cgroup_fd = open(cgroup_path.c_str(), O_RDONLY | O_DIRECTORY);
+  if (cgroup_fd < 0) {
+    bpf_.unload_func(fn_name);
+    return error::Internal("Unable to open cgroup $0, errno: $1", cgroup_path, errno);
+  }
+
+  if (bpf_prog_attach(fn_fd, cgroup_fd, attach_type, BPF_F_ALLOW_MULTI) != 0) {
+    int err = errno;
+    close(cgroup_fd);
+    bpf_.unload_func(fn_name);
+    return error::Internal("Unable to attach cgroup program to $0 using $1, errno: $2",
+                           cgroup_path, fn_name, err);
+  }
+
+  cgroup_programs_.push_back({fn_fd, cgroup_fd, attach_type});
+  return Status::OK();
+}
+
 // TODO(PL-1294): This can fail in rare cases. See the cited issue. Find the root cause.
 Status BCCWrapper::DetachKProbe(const KProbeSpec& probe) {
   VLOG(1) << "Detaching kprobe: " << probe.ToString();
@@ -325,6 +478,17 @@ void BCCWrapper::DetachUProbes() {
     LOG_IF(ERROR, !res.ok()) << res.msg();
   }
   uprobes_.clear();
+
+  for (const auto& p : direct_uprobes_) {
+    VLOG(1) << "Detaching uprobe " << p.event_name;
+    bpf_close_perf_event_fd(p.perf_event_fd);
+    // Only removes the tracefs event, if the probe was created through tracefs.
+    if (bpf_detach_uprobe(p.event_name.c_str()) < 0) {
+      LOG(ERROR) << absl::Substitute("Failed to detach uprobe $0", p.event_name);
+    }
+    --num_attached_uprobes_;
+  }
+  direct_uprobes_.clear();
 }
 
 void BCCWrapper::DetachTracepoints() {
@@ -335,6 +499,19 @@ void BCCWrapper::DetachTracepoints() {
   tracepoints_.clear();
 }
 
+void BCCWrapper::HandlePerfBufferOutput(void* ctx, void* data, int size) {
+  auto* callback = static_cast<PerfBufferCallback*>(ctx);
+  callback->output_fn(callback->cb_cookie, data, size);
+}
+
+void BCCWrapper::HandlePerfBufferLoss(void* ctx, uint64_t lost) {
+  auto* callback = static_cast<PerfBufferCallback*>(ctx);
+  callback->lost_stat->Record(lost);
+  if (callback->loss_fn != nullptr) {
+    callback->loss_fn(callback->cb_cookie, lost);
+  }
+}
+
 Status BCCWrapper::OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie) {
   const int kPageSizeBytes = system::Config::GetInstance().PageSizeBytes();
   int num_pages = IntRoundUpDivide(perf_buffer.size_bytes, kPageSizeBytes);
@@ -345,10 +522,20 @@ Status BCCWrapper::OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_co
   LOG(INFO) << absl::Substitute(
       "Opening perf buffer: $0 [requested_size=$1 num_pages=$2 size=$3] (per cpu)",
       perf_buffer.name, perf_buffer.size_bytes, num_pages, num_pages * kPageSizeBytes);
+
+  StirlingMonitor& monitor = *StirlingMonitor::GetInstance();
+  auto callback = std::make_unique<PerfBufferCallback>(PerfBufferCallback{
+      perf_buffer.probe_output_fn, perf_buffer.probe_loss_fn, cb_cookie,
+      monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, "perf_buffer",
+                             absl::StrCat(perf_buffer.name, ".poll_ns")),
+      monitor.GetHotPathStat(HotPathStat::Type::kCount, "perf_buffer",
+                             absl::StrCat(perf_buffer.name, ".lost_events"))});
   PL_RETURN_IF_ERROR(bpf_.open_perf_buffer(std::string(perf_buffer.name),
-                                           perf_buffer.probe_output_fn, perf_buffer.probe_loss_fn,
-                                           cb_cookie, num_pages));
+                                           &BCCWrapper::HandlePerfBufferOutput,
+                                           &BCCWrapper::HandlePerfBufferLoss, callback.get(),
+                                           num_pages));
   perf_buffers_.push_back(perf_buffer);
+  perf_buffer_callbacks_.push_back(std::move(callback));
   ++num_open_perf_buffers_;
   return Status::OK();
 }
@@ -373,6 +560,81 @@ void BCCWrapper::ClosePerfBuffers() {
     LOG_IF(ERROR, !res.ok()) << res.msg();
   }
   perf_buffers_.clear();
+  perf_buffer_callbacks_.clear();
+}
+
+int BCCWrapper::LookupBatch(int fd, bool clear, uint32_t* in_batch, uint32_t* out_batch,
+                            void* keys, void* values, uint32_t* count) {
+  int ret = clear ? bpf_lookup_and_delete_batch(fd, in_batch, out_batch, keys, values, count)
+                  : bpf_lookup_batch(fd, in_batch, out_batch, keys, values, count);
+  return ret < 0 ? errno : 0;
+}
+
+int BCCWrapper::DeleteBatch(int fd, void* keys, uint32_t* count) {
+  return bpf_delete_batch(fd, keys, count) < 0 ? errno : 0;
+}
+
+int BCCWrapper::DeleteElem(int fd, void* key) { return bpf_delete_elem(fd, key) < 0 ? errno : 0; }
+
+int BCCWrapper::HandleRingBufferRecord(void* ctx, void* data, size_t size) {
+  auto* callback = static_cast<RingBufferCallback*>(ctx);
+  callback->fn(callback->cb_cookie, data, static_cast<int>(size));
+  return 0;
+}
+
+Status BCCWrapper::OpenRingBuffer(const RingBufferSpec& ring_buffer, void* cb_cookie) {
+  LOG(INFO) << absl::Substitute("Opening ring buffer: $0", ring_buffer.name);
+
+  int map_fd = bpf_.get_mod()->table_fd(ring_buffer.name);
+  if (map_fd < 0) {
+    return error::Internal("Could not find ring buffer map $0.", ring_buffer.name);
+  }
+
+  auto callback = std::make_unique<RingBufferCallback>(
+      RingBufferCallback{ring_buffer.probe_output_fn, cb_cookie});
+
+  // The first ring buffer creates the manager; subsequent ones are added to it,
+  // so that all of them are consumed with a single call.
+  if (ring_buffer_mgr_ == nullptr) {
+    ring_buffer_mgr_ = bpf_new_ringbuf(map_fd, &BCCWrapper::HandleRingBufferRecord, callback.get());
+    if (ring_buffer_mgr_ == nullptr) {
+      return error::Internal("Failed to open ring buffer $0: $1", ring_buffer.name,
+                             strerror(errno));
+    }
+  } else {
+    int status = bpf_add_ringbuf(ring_buffer_mgr_, map_fd, &BCCWrapper::HandleRingBufferRecord,
+                                 callback.get());
+    if (status < 0) {
+      return error::Internal("Failed to open ring buffer $0: $1", ring_buffer.name,
+                             strerror(-status));
+    }
+  }
+
+  ring_buffer_callbacks_.push_back(std::move(callback));
+  ring_buffers_.push_back(ring_buffer);
+  ++num_open_ring_buffers_;
+  return Status::OK();
+}
+
+Status BCCWrapper::OpenRingBuffers(const ArrayView<RingBufferSpec>& ring_buffers,
+                                   void* cb_cookie) {
+  for (const RingBufferSpec& r : ring_buffers) {
+    PL_RETURN_IF_ERROR(OpenRingBuffer(r, cb_cookie));
+  }
+  return Status::OK();
+}
+
+void BCCWrapper::CloseRingBuffers() {
+  for (const RingBufferSpec& r : ring_buffers_) {
+    VLOG(1) << "Closing ring buffer: " << r.name;
+    --num_open_ring_buffers_;
+  }
+  if (ring_buffer_mgr_ != nullptr) {
+    bpf_free_ringbuf(ring_buffer_mgr_);
+    ring_buffer_mgr_ = nullptr;
+  }
+  ring_buffer_callbacks_.clear();
+  ring_buffers_.clear();
 }
 
 Status BCCWrapper::AttachPerfEvent(const PerfEventSpec& perf_event) {
@@ -424,15 +686,40 @@ void BCCWrapper::PollPerfBuffer(std::string_view perf_buffer_name, int timeout_m
   }
 }
 
+void BCCWrapper::PollRingBuffers() {
+  if (ring_buffer_mgr_ == nullptr) {
+    return;
+  }
+  // Consumes all records that are currently available across all the ring buffers.
+  int num_consumed = bpf_consume_ringbuf(ring_buffer_mgr_);
+  LOG_IF(ERROR, num_consumed < 0) << absl::Substitute("Failed to consume ring buffers: $0",
+                                                     strerror(-num_consumed));
+}
+
 void BCCWrapper::PollPerfBuffers(int timeout_ms) {
-  for (const auto& spec : perf_buffers_) {
-    PollPerfBuffer(spec.name, timeout_ms);
+  for (size_t i = 0; i < perf_buffers_.size(); ++i) {
+    auto start = std::chrono::steady_clock::now();
+    PollPerfBuffer(perf_buffers_[i].name, timeout_ms);
+    perf_buffer_callbacks_[i]->poll_stat->RecordDuration(std::chrono::steady_clock::now() - start);
+  }
+  PollRingBuffers();
+}
+
+void BCCWrapper::DetachCGroupPrograms() {
+  for (const auto& p : cgroup_programs_) {
+    if (bpf_prog_detach2(p.prog_fd, p.cgroup_fd, p.attach_type) != 0) {
+      LOG(WARNING) << absl::Substitute("Failed to detach cgroup program, errno=$0", errno);
+    }
+    close(p.cgroup_fd);
   }
+  cgroup_programs_.clear();
 }
 
 void BCCWrapper::Close() {
+  DetachCGroupPrograms();
   DetachPerfEvents();
   ClosePerfBuffers();
+  CloseRingBuffers();
   DetachKProbes();
   DetachUProbes();
   DetachTracepoints();
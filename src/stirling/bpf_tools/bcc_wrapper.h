@@ -34,6 +34,8 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <atomic>
+#include <cerrno>
 #include <filesystem>
 #include <map>
 #include <memory>
@@ -43,9 +45,11 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/json/json.h"
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
 #include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/utils/monitor.h"
 
 namespace px {
 /*
@@ -196,6 +200,21 @@ struct PerfBufferSpec {
   PerfBufferSizeCategory size_category = PerfBufferSizeCategory::kUncategorized;
 };
 
+/**
+ * Describes a BPF ring buffer (BPF_MAP_TYPE_RINGBUF), through which data is returned to user-space.
+ * Unlike a perf buffer, a single ring buffer is shared by all CPUs. Requires Linux 5.8+.
+ * The size of the ring buffer is fixed in the probe code, by the BPF_RINGBUF_OUTPUT declaration.
+ */
+struct RingBufferSpec {
+  // Name of the ring buffer.
+  // Must be the same as the ring buffer name declared in the probe code with BPF_RINGBUF_OUTPUT.
+  std::string name;
+
+  // Function that will be called for every record in the ring buffer, when a read is triggered.
+  // Same signature as for perf buffers, so that the same handlers can serve both transports.
+  perf_reader_raw_cb probe_output_fn;
+};
+
 /**
  * Describes a perf event to attach.
  * This can be run stand-alone and is not dependent on kProbes.
@@ -295,6 +314,15 @@ class BCCWrapper {
    */
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie = nullptr);
 
+  /**
+   * Open a ring buffer for reading events.
+   * All ring buffers share a single epoll set, and are drained together by PollPerfBuffers().
+   * @param ring_buffer The ring buffer to open.
+   * @param cb_cookie The pointer that is passed to the callback function.
+   * @return Error if ring buffer cannot be opened (e.g. kernels older than 5.8).
+   */
+  Status OpenRingBuffer(const RingBufferSpec& ring_buffer, void* cb_cookie = nullptr);
+
   /**
    * Attach a perf event, which runs a probe every time a perf counter reaches a threshold
    * condition.
@@ -324,6 +352,22 @@ class BCCWrapper {
    */
   Status AttachUProbes(const ArrayView<UProbeSpec>& uprobes);
 
+  /**
+   * Attaches a batch of uprobes, spreading the work over the threads of pool, which may be null.
+   * Unlike AttachUProbes(), a probe that fails to attach does not stop the others.
+   *
+   * Resolving the symbol of a probe and opening its perf event do not depend on other probes, so
+   * these run concurrently. The kernel creates the probes with the uprobe PMU where it is
+   * available, and through tracefs otherwise. The duration of each attachment is reported as the
+   * "attach_ns" hot path stat of the "uprobe" source.
+   *
+   * @param probes Vector of probes.
+   * @param pool The threads to attach the probes on, besides the calling thread.
+   * @return The result of attaching each of the probes, in the same order.
+   */
+  std::vector<Status> AttachUProbesParallel(const ArrayView<UProbeSpec>& probes,
+                                            ThreadPool* pool);
+
   /**
    * Convenience function that attaches multiple uprobes.
    * @param probes Vector of probes.
@@ -336,6 +380,16 @@ class BCCWrapper {
    */
   Status AttachXDP(const std::string& dev_name, const std::string& fn_name);
 
+  /**
+   * Attaches a cgroup-skb program to the cgroup v2 directory at cgroup_path, which then sees the
+   * packets of all sockets in that cgroup and its descendants. The program is attached with
+   * BPF_F_ALLOW_MULTI, so it runs alongside the programs others have attached to the same cgroup.
+   * Unlike other probes, such attachments outlive the process, so they are detached in Close().
+   * @param attach_type BPF_CGROUP_INET_INGRESS or BPF_CGROUP_INET_EGRESS.
+   */
+  Status AttachCGroupSKB(const std::string& cgroup_path, enum bpf_attach_type attach_type,
+                         const std::string& fn_name);
+
   /**
    * Convenience function that opens multiple perf buffers.
    * @param probes Vector of perf buffer descriptors.
@@ -344,6 +398,11 @@ class BCCWrapper {
    */
   Status OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buffers, void* cb_cookie);
 
+  /**
+   * Convenience function that opens multiple ring buffers.
+   */
+  Status OpenRingBuffers(const ArrayView<RingBufferSpec>& ring_buffers, void* cb_cookie);
+
   /**
    * Convenience function that opens multiple perf events.
    * @param probes Vector of perf event descriptors.
@@ -375,6 +434,11 @@ class BCCWrapper {
    *                   amount of time to wait for an event to arrive before returning.
    *                   Default is 0, because if nothing is ready, then we want to go back to sleep
    *                   and catch new events in the next iteration.
+   *
+   * Any open ring buffers are drained as well, in a single batch after the perf buffers.
+   *
+   * The poll time and lost events of each perf buffer are reported as hot path stats of the
+   * "perf_buffer" source, named after the perf buffer.
    */
   void PollPerfBuffers(int timeout_ms = 0);
 
@@ -388,6 +452,24 @@ class BCCWrapper {
     return bpf_.get_hash_table<TKeyType, TValueType>(table_name);
   }
 
+  /**
+   * Returns all the entries of a BPF hash table, and removes them from the table if clear is true.
+   *
+   * The entries are read many at a time with BPF_MAP_LOOKUP_BATCH (or
+   * BPF_MAP_LOOKUP_AND_DELETE_BATCH), rather than with a syscall or two per entry. Kernels without
+   * the batch operations (before 5.6) fall back to ebpf::BPFHashTable::get_table_offline().
+   */
+  template <typename TKeyType, typename TValueType>
+  std::vector<std::pair<TKeyType, TValueType>> GetHashTableEntries(const std::string& table_name,
+                                                                   bool clear = false);
+
+  /**
+   * Removes the keys from a BPF hash table with BPF_MAP_DELETE_BATCH, falling back to one
+   * BPF_MAP_DELETE_ELEM per key on older kernels. Keys that are not in the table are ignored.
+   */
+  template <typename TKeyType>
+  void RemoveHashTableKeys(const std::string& table_name, std::vector<TKeyType> keys);
+
   template <typename TValueType>
   ebpf::BPFArrayTable<TValueType> GetArrayTable(const std::string& table_name) {
     return bpf_.get_array_table<TValueType>(table_name);
@@ -411,10 +493,16 @@ class BCCWrapper {
     return bpf_.get_percpu_array_table<TValueType>(table_name);
   }
 
+  template <typename TKeyType, typename TValueType>
+  ebpf::BPFPercpuHashTable<TKeyType, TValueType> GetPerCPUHashTable(const std::string& table_name) {
+    return bpf_.get_percpu_hash_table<TKeyType, TValueType>(table_name);
+  }
+
   // These are static counters of attached/open probes across all instances.
   // It is meant for verification that we have cleaned-up all resources in tests.
   static size_t num_attached_probes() { return num_attached_kprobes_ + num_attached_uprobes_; }
   static size_t num_open_perf_buffers() { return num_open_perf_buffers_; }
+  static size_t num_open_ring_buffers() { return num_open_ring_buffers_; }
   static size_t num_attached_perf_events() { return num_attached_perf_events_; }
 
  private:
@@ -426,6 +514,7 @@ class BCCWrapper {
   Status ClosePerfBuffer(const PerfBufferSpec& perf_buffer);
   Status DetachPerfEvent(const PerfEventSpec& perf_event);
   void PollPerfBuffer(std::string_view perf_buffer_name, int timeout_ms);
+  void PollRingBuffers();
 
   // Detaches all kprobes/uprobes/perf buffers/perf events that were attached by the wrapper.
   // If any fails to detach, an error is logged, and the function continues.
@@ -433,15 +522,34 @@ class BCCWrapper {
   void DetachUProbes();
   void DetachTracepoints();
   void ClosePerfBuffers();
+  void CloseRingBuffers();
   void DetachPerfEvents();
+  void DetachCGroupPrograms();
 
   // Returns the name that identifies the target to attach this k-probe.
   std::string GetKProbeTargetName(const KProbeSpec& probe);
 
   std::vector<KProbeSpec> kprobes_;
   std::vector<UProbeSpec> uprobes_;
+
+  // The uprobes attached by AttachUProbesParallel(). These are attached with libbpf directly,
+  // because ebpf::BPF is not thread-safe, so they are not known to bpf_.
+  struct DirectUProbe {
+    std::string event_name;
+    int perf_event_fd;
+  };
+  std::vector<DirectUProbe> direct_uprobes_;
+
+  // The programs attached by AttachCGroupSKB().
+  struct CGroupProgram {
+    int prog_fd;
+    int cgroup_fd;
+    enum bpf_attach_type attach_type;
+  };
+  std::vector<CGroupProgram> cgroup_programs_;
   std::vector<TracepointSpec> tracepoints_;
   std::vector<PerfBufferSpec> perf_buffers_;
+  std::vector<RingBufferSpec> ring_buffers_;
   std::vector<PerfEventSpec> perf_events_;
 
   std::string system_headers_include_dir_;
@@ -458,6 +566,43 @@ class BCCWrapper {
   //   DEBUG_BTF = 0x20,
   ebpf::BPF bpf_;
 
+  // Wraps the callbacks of a perf buffer, so that its lost events can be counted.
+  struct PerfBufferCallback {
+    perf_reader_raw_cb output_fn;
+    perf_reader_lost_cb loss_fn;
+    void* cb_cookie;
+    HotPathStat* poll_stat;
+    HotPathStat* lost_stat;
+  };
+  static void HandlePerfBufferOutput(void* ctx, void* data, int size);
+  static void HandlePerfBufferLoss(void* ctx, uint64_t lost);
+
+  // One for each of perf_buffers_, in the same order.
+  std::vector<std::unique_ptr<PerfBufferCallback>> perf_buffer_callbacks_;
+
+  // Adapts the libbpf ring buffer callback to the perf buffer callback signature.
+  struct RingBufferCallback {
+    perf_reader_raw_cb fn;
+    void* cb_cookie;
+  };
+  static int HandleRingBufferRecord(void* ctx, void* data, size_t size);
+
+  // Thin wrappers around the BCC batch map calls, which return 0 or the errno of the failure.
+  static int LookupBatch(int fd, bool clear, uint32_t* in_batch, uint32_t* out_batch, void* keys,
+                         void* values, uint32_t* count);
+  static int DeleteBatch(int fd, void* keys, uint32_t* count);
+  static int DeleteElem(int fd, void* key);
+
+  // The number of entries read by one BPF_MAP_LOOKUP_BATCH call.
+  static constexpr uint32_t kMapBatchSize = 1024;
+
+  // Cleared the first time that the kernel rejects a batch map command as unknown.
+  std::atomic<bool> map_batch_ops_supported_ = true;
+
+  // The libbpf ring buffer manager that all ring buffers are added to. Null if none are open.
+  void* ring_buffer_mgr_ = nullptr;
+  std::vector<std::unique_ptr<RingBufferCallback>> ring_buffer_callbacks_;
+
   // These are static counters across all instances, because:
   // 1) We want to ensure we have cleaned all BPF resources up across *all* instances (no leaks).
   // 2) It is for verification only, and it doesn't make sense to create accessors from stirling to
@@ -466,6 +611,7 @@ class BCCWrapper {
   inline static size_t num_attached_uprobes_;
   inline static size_t num_attached_tracepoints_;
   inline static size_t num_open_perf_buffers_;
+  inline static size_t num_open_ring_buffers_;
   inline static size_t num_attached_perf_events_;
 
  private:
@@ -473,6 +619,87 @@ class BCCWrapper {
   inline static std::optional<utils::TaskStructOffsets> task_struct_offsets_opt_;
 };
 
+template <typename TKeyType, typename TValueType>
+std::vector<std::pair<TKeyType, TValueType>> BCCWrapper::GetHashTableEntries(
+    const std::string& table_name, bool clear) {
+  std::vector<std::pair<TKeyType, TValueType>> entries;
+
+  int fd = bpf_.get_mod()->table_fd(table_name);
+  if (fd >= 0 && map_batch_ops_supported_) {
+    std::vector<TKeyType> keys(kMapBatchSize);
+    std::vector<TValueType> values(kMapBatchSize);
+    uint32_t in_batch = 0;
+    uint32_t out_batch = 0;
+    bool first_batch = true;
+    while (true) {
+      uint32_t count = kMapBatchSize;
+      int err = LookupBatch(fd, clear, first_batch ? nullptr : &in_batch, &out_batch, keys.data(),
+                            values.data(), &count);
+      if (err == 0 || err == ENOENT) {
+        for (uint32_t i = 0; i < count; ++i) {
+          entries.emplace_back(keys[i], values[i]);
+        }
+      }
+      if (err == 0) {
+        in_batch = out_batch;
+        first_batch = false;
+        continue;
+      }
+      if (err == ENOENT) {
+        // The end of the table was reached.
+        return entries;
+      }
+      if (!first_batch) {
+        LOG(WARNING) << absl::Substitute("Batch lookup of BPF table $0 failed, errno=$1.",
+                                         table_name, err);
+        return entries;
+      }
+      // Nothing was read (or removed) yet, so it is safe to fall back to the per-entry path.
+      // Kernels that predate the batch commands reject them with EINVAL.
+      if (err == EINVAL) {
+        VLOG(1) << "Batch map operations are not supported by the kernel.";
+        map_batch_ops_supported_ = false;
+      }
+      break;
+    }
+  }
+
+  return GetHashTable<TKeyType, TValueType>(table_name).get_table_offline(clear);
+}
+
+template <typename TKeyType>
+void BCCWrapper::RemoveHashTableKeys(const std::string& table_name, std::vector<TKeyType> keys) {
+  int fd = bpf_.get_mod()->table_fd(table_name);
+  if (fd < 0) {
+    return;
+  }
+
+  size_t i = 0;
+  if (map_batch_ops_supported_) {
+    while (i < keys.size()) {
+      uint32_t count = keys.size() - i;
+      int err = DeleteBatch(fd, &keys[i], &count);
+      if (err == 0) {
+        return;
+      }
+      // The batch stops at the first key that could not be removed; count is the number removed.
+      i += count;
+      if (err != ENOENT) {
+        if (err == EINVAL && i == 0) {
+          map_batch_ops_supported_ = false;
+        }
+        break;
+      }
+      // Skip the key that was not in the table.
+      ++i;
+    }
+  }
+
+  for (; i < keys.size(); ++i) {
+    DeleteElem(fd, &keys[i]);
+  }
+}
+
 }  // namespace bpf_tools
 }  // namespace stirling
 }  // namespace px
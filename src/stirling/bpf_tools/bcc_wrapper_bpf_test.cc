@@ -23,6 +23,7 @@
 #include "src/common/testing/testing.h"
 #include "src/stirling/bpf_tools/macros.h"
 #include "src/stirling/obj_tools/testdata/cc/test_exe_fixture.h"
+#include "src/stirling/utils/linux_headers.h"
 
 // A function which we will uprobe on, to trigger our BPF code.
 // The function itself is irrelevant, but it must not be optimized away.
@@ -120,6 +121,42 @@ TEST(BCCWrapperTest, DetachUProbe) {
   }
 }
 
+TEST(BCCWrapperTest, AttachUProbesParallel) {
+  TestExeWrapper test_exe;
+
+  BCCWrapper bcc_wrapper;
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(kBCCProgram));
+
+  UProbeSpec entry_spec = {
+      .binary_path = test_exe.path(),
+      .symbol = "CanYouFindThis",
+      .probe_fn = "foo",
+  };
+  UProbeSpec return_spec = entry_spec;
+  return_spec.attach_type = BPFProbeAttachType::kReturn;
+  UProbeSpec bogus_spec = entry_spec;
+  bogus_spec.symbol = "NoSuchSymbol";
+
+  ThreadPool pool(2);
+  std::vector<UProbeSpec> specs = {entry_spec, bogus_spec, return_spec};
+  std::vector<Status> statuses = bcc_wrapper.AttachUProbesParallel(ToArrayView(specs), &pool);
+  ASSERT_EQ(statuses.size(), 3);
+  EXPECT_OK(statuses[0]);
+  EXPECT_NOT_OK(statuses[1]);
+  EXPECT_OK(statuses[2]);
+  EXPECT_EQ(2, bcc_wrapper.num_attached_probes());
+
+  // Probes that are already attached are not attached again.
+  std::vector<UProbeSpec> duplicate_specs = {entry_spec};
+  statuses = bcc_wrapper.AttachUProbesParallel(ToArrayView(duplicate_specs), &pool);
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_NOT_OK(statuses[0]);
+  EXPECT_EQ(2, bcc_wrapper.num_attached_probes());
+
+  bcc_wrapper.Close();
+  EXPECT_EQ(0, bcc_wrapper.num_attached_probes());
+}
+
 TEST(BCCWrapperTest, GetTGIDStartTime) {
   // Force the TaskStructResolver to run,
   // since we're trying to check that it correctly gets the task_struct offsets.
@@ -159,6 +196,52 @@ TEST(BCCWrapperTest, GetTGIDStartTime) {
   EXPECT_EQ(proc_pid_start_time, expected_proc_pid_start_time);
 }
 
+TEST(BCCWrapperTest, RingBuffer) {
+  constexpr uint32_t kLinux5p8VersionCode = 329728;
+  if (utils::GetCachedKernelVersion().code() < kLinux5p8VersionCode) {
+    GTEST_SKIP() << "Ring buffers require Linux 5.8+.";
+  }
+
+  constexpr std::string_view kProgram = R"BCC(
+    BPF_RINGBUF_OUTPUT(ring_events, 8);
+    int push_event(struct pt_regs* ctx) {
+      uint32_t value = 42;
+      ring_events.ringbuf_output(&value, sizeof(value), 0);
+      return 0;
+    }
+  )BCC";
+
+  BCCWrapper bcc_wrapper;
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(kProgram));
+
+  ASSERT_OK_AND_ASSIGN(std::filesystem::path self_path, fs::ReadSymlink("/proc/self/exe"));
+  UProbeSpec uprobe{.binary_path = self_path,
+                    .symbol = {},  // Keep GCC happy.
+                    .address = reinterpret_cast<uint64_t>(&BCCWrapperTestProbeTrigger),
+                    .attach_type = BPFProbeAttachType::kEntry,
+                    .probe_fn = "push_event"};
+  ASSERT_OK(bcc_wrapper.AttachUProbe(uprobe));
+
+  std::vector<uint32_t> values;
+  auto handle_event = [](void* cb_cookie, void* data, int data_size) {
+    ASSERT_EQ(data_size, sizeof(uint32_t));
+    static_cast<std::vector<uint32_t>*>(cb_cookie)->push_back(*static_cast<uint32_t*>(data));
+  };
+  RingBufferSpec spec{"ring_events", handle_event};
+  ASSERT_OK(bcc_wrapper.OpenRingBuffer(spec, &values));
+  EXPECT_EQ(1, bcc_wrapper.num_open_ring_buffers());
+
+  BCCWrapperTestProbeTrigger();
+  BCCWrapperTestProbeTrigger();
+  BCCWrapperTestProbeTrigger();
+
+  bcc_wrapper.PollPerfBuffers();
+  EXPECT_EQ(values, std::vector<uint32_t>({42, 42, 42}));
+
+  bcc_wrapper.Close();
+  EXPECT_EQ(0, bcc_wrapper.num_open_ring_buffers());
+}
+
 TEST(BCCWrapperTest, TestMapClearingAPIs) {
   // Test to show that get_table_offline() with clear_table=true actually clears the table.
   bpf_tools::BCCWrapper bcc_wrapper;
@@ -191,6 +274,43 @@ TEST(BCCWrapperTest, TestMapClearingAPIs) {
   ASSERT_THAT(alphabet.get_table_offline(), IsEmpty());
 }
 
+// Tests the batched hash table reads and removals, with more entries than fit in one batch.
+TEST(BCCWrapperTest, HashTableBatchAPIs) {
+  bpf_tools::BCCWrapper bcc_wrapper;
+  std::string_view kProgram = "BPF_HASH(squares, uint32_t, uint64_t, 4096);";
+  ASSERT_OK(bcc_wrapper.InitBPFProgram(kProgram));
+  ebpf::BPFHashTable squares = bcc_wrapper.GetHashTable<uint32_t, uint64_t>("squares");
+
+  constexpr uint32_t kNumEntries = 3000;
+  std::vector<std::pair<uint32_t, uint64_t>> expected;
+  for (uint32_t i = 0; i < kNumEntries; ++i) {
+    ASSERT_TRUE(squares.update_value(i, i * i).ok());
+    expected.emplace_back(i, i * i);
+  }
+
+  using ::testing::IsEmpty;
+  using ::testing::UnorderedElementsAreArray;
+
+  ASSERT_THAT((bcc_wrapper.GetHashTableEntries<uint32_t, uint64_t>("squares")),
+              UnorderedElementsAreArray(expected));
+
+  // Remove the even keys, along with some keys that are not in the table.
+  std::vector<uint32_t> keys_to_remove;
+  for (uint32_t i = 0; i < kNumEntries + 100; i += 2) {
+    keys_to_remove.push_back(i);
+  }
+  bcc_wrapper.RemoveHashTableKeys("squares", keys_to_remove);
+
+  std::vector<std::pair<uint32_t, uint64_t>> expected_odd;
+  for (uint32_t i = 1; i < kNumEntries; i += 2) {
+    expected_odd.emplace_back(i, i * i);
+  }
+  constexpr bool kClearTable = true;
+  ASSERT_THAT((bcc_wrapper.GetHashTableEntries<uint32_t, uint64_t>("squares", kClearTable)),
+              UnorderedElementsAreArray(expected_odd));
+  ASSERT_THAT((bcc_wrapper.GetHashTableEntries<uint32_t, uint64_t>("squares")), IsEmpty());
+}
+
 // Tests that BCCWrapper can load XDP program.
 TEST(BCCWrapperTest, LoadXDP) {
   bpf_tools::BCCWrapper bcc_wrapper;
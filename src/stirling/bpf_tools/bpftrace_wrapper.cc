@@ -32,14 +32,25 @@
 #include <driver.h>
 #include <tracepoint_format_parser.h>
 
+#include <sys/utsname.h>
+
 #include <limits>
+#include <list>
 #include <sstream>
 #include <utility>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/common/base/base.h"
 #include "src/common/system/config.h"
 #include "src/stirling/utils/linux_headers.h"
 
+DEFINE_uint32(stirling_bpftrace_program_cache_size,
+              gflags::Uint32FromEnv("PL_STIRLING_BPFTRACE_PROGRAM_CACHE_SIZE", 16),
+              "The number of compiled bpftrace programs to keep for reuse. 0 disables reuse.");
+
 namespace px {
 namespace stirling {
 namespace bpf_tools {
@@ -47,6 +58,79 @@ namespace bpf_tools {
 using ::bpftrace::Driver;
 using ::bpftrace::ast::Printer;
 
+namespace {
+
+// Keeps the output of compiling bpftrace programs, so that deploying a program again (e.g. a
+// tracepoint that is redeployed when its TTL runs out) skips the parsing, clang and LLVM passes.
+// Like bpftrace's AOT mode, this relies on the bytecode and the required resources being all that
+// the deploy step needs.
+class CompiledProgramCache {
+ public:
+  explicit CompiledProgramCache(size_t capacity) : capacity_(capacity) {}
+
+  bool Lookup(const std::string& key, bpftrace::RequiredResources* resources,
+              bpftrace::BpfBytecode* bytecode) {
+    absl::MutexLock lock(&mu_);
+    auto iter = entries_.find(key);
+    if (iter == entries_.end()) {
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, iter->second.lru_iter);
+    *resources = iter->second.resources;
+    *bytecode = iter->second.bytecode;
+    return true;
+  }
+
+  void Insert(const std::string& key, const bpftrace::RequiredResources& resources,
+              const bpftrace::BpfBytecode& bytecode) {
+    if (capacity_ == 0) {
+      return;
+    }
+
+    absl::MutexLock lock(&mu_);
+    if (entries_.contains(key)) {
+      return;
+    }
+    if (entries_.size() >= capacity_) {
+      entries_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{resources, bytecode, lru_.begin()});
+  }
+
+ private:
+  struct Entry {
+    bpftrace::RequiredResources resources;
+    bpftrace::BpfBytecode bytecode;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  const size_t capacity_;
+
+  absl::Mutex mu_;
+  // Most recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+};
+
+CompiledProgramCache& GlobalCompiledProgramCache() {
+  static auto* cache = new CompiledProgramCache(FLAGS_stirling_bpftrace_program_cache_size);
+  return *cache;
+}
+
+// The generated code depends on the kernel (through its headers and BTF), as well as on the
+// script and its parameters.
+std::string CompiledProgramCacheKey(std::string_view script, const std::vector<std::string>& params,
+                                    bool has_btf) {
+  struct utsname utsname;
+  uname(&utsname);
+  return absl::StrCat(utsname.release, "\n", has_btf, "\n", absl::StrJoin(params, "\t"), "\n",
+                      script);
+}
+
+}  // namespace
+
 std::string DumpDriver(const Driver& driver) {
   std::ostringstream oss;
 
@@ -147,8 +231,6 @@ class CerrRedirect {
   std::streambuf* old_;
 };
 
-// This compile function is inspired from the bpftrace project's main.cpp.
-// Changes to bpftrace may need to be reflected back to this function on a bpftrace update.
 Status BPFTraceWrapper::Compile(std::string_view script, const std::vector<std::string>& params) {
   // Because BPFTrace uses global state (related to clear_struct_list()),
   // multiple simultaneous compiles may not be safe. For now, introduce a lock for safety.
@@ -156,6 +238,26 @@ Status BPFTraceWrapper::Compile(std::string_view script, const std::vector<std::
 
   const std::lock_guard<std::mutex> lock(compilation_mutex_);
 
+  // Use this to pass parameters to bpftrace script ($1, $2 in the script)
+  for (const auto& param : params) {
+    bpftrace_.add_param(param);
+  }
+
+  const std::string cache_key =
+      CompiledProgramCacheKey(script, params, bpftrace_.feature_->has_btf());
+  if (GlobalCompiledProgramCache().Lookup(cache_key, &bpftrace_.resources, &bytecode_)) {
+    compiled_ = true;
+    return Status::OK();
+  }
+
+  PL_RETURN_IF_ERROR(CompileFromSource(script));
+  GlobalCompiledProgramCache().Insert(cache_key, bpftrace_.resources, bytecode_);
+  return Status::OK();
+}
+
+// This compile function is inspired from the bpftrace project's main.cpp.
+// Changes to bpftrace may need to be reflected back to this function on a bpftrace update.
+Status BPFTraceWrapper::CompileFromSource(std::string_view script) {
   // Some functions below return errors, while others success as positive numbers.
   // For readability, use two separate variables for the two models.
   int err;
@@ -170,11 +272,6 @@ Status BPFTraceWrapper::Compile(std::string_view script, const std::vector<std::
   // Reset some BPFTrace global state, which may be dirty because of a previous compile.
   bpftrace::TracepointFormatParser::clear_struct_list();
 
-  // Use this to pass parameters to bpftrace script ($1, $2 in the script)
-  for (const auto& param : params) {
-    bpftrace_.add_param(param);
-  }
-
 #define ERR_MSG "Could not compile bpftrace script, "
 
   // Script from string (command line argument)
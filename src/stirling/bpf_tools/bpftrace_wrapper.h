@@ -106,7 +106,10 @@ class BPFTraceWrapper {
   bpftrace::BPFtrace* mutable_bpftrace() { return &bpftrace_; }
 
  private:
+  // Compiles the program, or reuses the result of compiling the same program earlier in the
+  // process. See --stirling_bpftrace_program_cache_size.
   Status Compile(std::string_view script, const std::vector<std::string>& params);
+  Status CompileFromSource(std::string_view script);
 
   // Checks the output for dynamic tracing:
   //  1) There must be at least one printf.
@@ -46,6 +46,28 @@ TEST(BPFTracerWrapperTest, MapRead) {
   bpftrace_wrapper.Stop();
 }
 
+// The second compile of the same script reuses the first one's output, which must deploy the
+// same way.
+TEST(BPFTracerWrapperTest, RecompileAndDeploy) {
+  constexpr std::string_view kScript = R"(
+  interval:ms:100 {
+      @retval[0] = nsecs;
+  }
+  )";
+
+  for (int i = 0; i < 2; ++i) {
+    BPFTraceWrapper bpftrace_wrapper;
+    ASSERT_OK(bpftrace_wrapper.CompileForMapOutput(kScript));
+    ASSERT_OK(bpftrace_wrapper.Deploy());
+    sleep(1);
+
+    bpftrace::BPFTraceMap entries = bpftrace_wrapper.GetBPFMap("@retval");
+    EXPECT_FALSE(entries.empty());
+
+    bpftrace_wrapper.Stop();
+  }
+}
+
 TEST(BPFTracerWrapperTest, PerfBufferPoll) {
   constexpr std::string_view kScript = R"(
     interval:ms:100 {
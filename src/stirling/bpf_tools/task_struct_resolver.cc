@@ -20,14 +20,21 @@
 
 #include <linux/sched.h>
 #include <poll.h>
+#include <sys/utsname.h>
 #include <sys/wait.h>
 
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
 #include "src/common/base/base.h"
 #include "src/common/exec/subprocess.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/system/config.h"
 #include "src/common/system/proc_parser.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/bpf_tools/macros.h"
@@ -45,6 +52,12 @@ extern "C" {
 NO_OPT_ATTR void StirlingProbeTrigger() { return; }
 }
 
+DEFINE_string(stirling_task_struct_offsets_cache_dir,
+              gflags::StringFromEnv("PL_TASK_STRUCT_OFFSETS_CACHE_DIR", ""),
+              "Directory in which the resolved task_struct offsets are kept, keyed by kernel "
+              "build, so that later starts on the same kernel skip resolving them. "
+              "Not used if empty.");
+
 namespace px {
 namespace stirling {
 namespace utils {
@@ -363,12 +376,127 @@ StatusOr<uint64_t> ResolveTaskStructExitCodeOffset() {
 }  // namespace
 
 StatusOr<TaskStructOffsets> ResolveTaskStructOffsets() {
+  // The offsets only depend on the kernel build, so the resolution (which runs BPF probes on
+  // short-lived child processes) is only needed once per kernel.
+  const std::filesystem::path cache_file = TaskStructOffsetsCacheFile();
+  if (!cache_file.empty()) {
+    StatusOr<TaskStructOffsets> cached = ReadTaskStructOffsets(cache_file);
+    if (cached.ok()) {
+      LOG(INFO) << absl::Substitute("Using task_struct offsets cached at $0.", cache_file.string());
+      return cached;
+    }
+  }
+
   PL_ASSIGN_OR_RETURN(TaskStructOffsets res, ResolveTaskStructStartTimeOffsets());
   PL_ASSIGN_OR_RETURN(uint64_t exit_code_offset, ResolveTaskStructExitCodeOffset());
   res.exit_code_offset = exit_code_offset;
+
+  if (!cache_file.empty()) {
+    Status s = WriteTaskStructOffsets(cache_file, res);
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to cache task_struct offsets at $0: $1",
+                                                 cache_file.string(), s.ToString());
+  }
   return res;
 }
 
+namespace {
+struct LowercaseHex {
+  static inline constexpr std::string_view kCharFormat = "%02x";
+  static inline constexpr int kSizePerByte = 2;
+  static inline constexpr bool kKeepPrintableChars = false;
+};
+}  // namespace
+
+std::string KernelBuildIDFromNotes(std::string_view notes) {
+  // The notes are a sequence of ELF notes, each of which is:
+  //    namesz :   32-bit, size of "name" field
+  //    descsz :   32-bit, size of "desc" field
+  //    type   :   32-bit, vendor specific "type"
+  //    name   :   "namesz" bytes, null-terminated string, padded to 4 bytes
+  //    desc   :   "descsz" bytes, binary data, padded to 4 bytes
+  constexpr uint32_t kNTGNUBuildID = 3;
+  constexpr std::string_view kGNUNoteName("GNU\0", 4);
+  constexpr size_t kHeaderSize = 3 * sizeof(uint32_t);
+  auto align4 = [](size_t n) { return (n + 3) & ~static_cast<size_t>(3); };
+
+  while (notes.size() >= kHeaderSize) {
+    uint32_t name_size = ::px::utils::LEndianBytesToInt<uint32_t>(notes.substr(0, 4));
+    uint32_t desc_size = ::px::utils::LEndianBytesToInt<uint32_t>(notes.substr(4, 4));
+    uint32_t type = ::px::utils::LEndianBytesToInt<uint32_t>(notes.substr(8, 4));
+    size_t desc_pos = kHeaderSize + align4(name_size);
+    size_t note_size = desc_pos + align4(desc_size);
+    if (note_size > notes.size()) {
+      break;
+    }
+    if (type == kNTGNUBuildID && notes.substr(kHeaderSize, name_size) == kGNUNoteName) {
+      return BytesToString<LowercaseHex>(notes.substr(desc_pos, desc_size));
+    }
+    notes.remove_prefix(note_size);
+  }
+  return "";
+}
+
+std::filesystem::path TaskStructOffsetsCacheFile() {
+  if (FLAGS_stirling_task_struct_offsets_cache_dir.empty()) {
+    return {};
+  }
+
+  const auto& sysfs_path = system::Config::GetInstance().sysfs_path();
+  StatusOr<std::string> notes = ReadFileToString(sysfs_path / "kernel/notes");
+  std::string build_id = notes.ok() ? KernelBuildIDFromNotes(notes.ValueOrDie()) : "";
+
+  std::string name;
+  if (!build_id.empty()) {
+    name = absl::StrCat("task_struct_offsets-", build_id);
+  } else {
+    // The version string carries the build number and time, so it tells builds of the same
+    // release apart.
+    struct utsname buf;
+    if (uname(&buf) != 0) {
+      return {};
+    }
+    // FNV-1a, since the name must be the same in every process that computes it.
+    uint64_t version_hash = 14695981039346656037ULL;
+    for (const char* c = buf.version; *c != '\0'; ++c) {
+      version_hash = (version_hash ^ static_cast<uint8_t>(*c)) * 1099511628211ULL;
+    }
+    name = absl::StrCat("task_struct_offsets-", buf.release, "-",
+                        absl::Hex(version_hash, absl::kZeroPad16));
+  }
+  return std::filesystem::path(FLAGS_stirling_task_struct_offsets_cache_dir) / name;
+}
+
+StatusOr<TaskStructOffsets> ReadTaskStructOffsets(const std::filesystem::path& file) {
+  PL_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(file));
+  std::vector<std::string_view> fields =
+      absl::StrSplit(absl::StripAsciiWhitespace(contents), ' ', absl::SkipEmpty());
+  TaskStructOffsets offsets;
+  if (fields.size() != 3 || !absl::SimpleAtoi(fields[0], &offsets.real_start_time_offset) ||
+      !absl::SimpleAtoi(fields[1], &offsets.group_leader_offset) ||
+      !absl::SimpleAtoi(fields[2], &offsets.exit_code_offset)) {
+    return error::Internal("Malformed task_struct offsets in $0: $1", file.string(), contents);
+  }
+  return offsets;
+}
+
+Status WriteTaskStructOffsets(const std::filesystem::path& file, const TaskStructOffsets& offsets) {
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(file.parent_path()));
+
+  std::filesystem::path tmp_path = file;
+  tmp_path += absl::StrCat(".", getpid(), ".tmp");
+  PL_RETURN_IF_ERROR(WriteFileFromString(
+      tmp_path, absl::StrCat(offsets.real_start_time_offset, " ", offsets.group_leader_offset, " ",
+                             offsets.exit_code_offset, "\n")));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, file, ec);
+  if (ec) {
+    return error::Internal("Could not move $0 to $1: $2", tmp_path.string(), file.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
 }  // namespace utils
 }  // namespace stirling
 }  // namespace px
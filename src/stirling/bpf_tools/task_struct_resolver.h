@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include <filesystem>
 #include <string>
 
 #include "src/common/base/base.h"
 
+DECLARE_string(stirling_task_struct_offsets_cache_dir);
+
 namespace px {
 namespace stirling {
 namespace utils {
@@ -63,6 +66,22 @@ struct TaskStructOffsets {
  */
 StatusOr<TaskStructOffsets> ResolveTaskStructOffsets();
 
+/**
+ * Returns the GNU build ID found in the contents of /sys/kernel/notes, hex encoded,
+ * or an empty string if there is none.
+ */
+std::string KernelBuildIDFromNotes(std::string_view notes);
+
+/**
+ * Returns the file in which the task struct offsets of the running kernel are kept across
+ * restarts, or an empty path if --stirling_task_struct_offsets_cache_dir is not set.
+ * The file is named after the kernel's build ID, or its release and version when it has none.
+ */
+std::filesystem::path TaskStructOffsetsCacheFile();
+
+StatusOr<TaskStructOffsets> ReadTaskStructOffsets(const std::filesystem::path& file);
+Status WriteTaskStructOffsets(const std::filesystem::path& file, const TaskStructOffsets& offsets);
+
 /**
  * The core logic for ResolveTaskStructOffsets.
  * This is exposed for testing purposes only.
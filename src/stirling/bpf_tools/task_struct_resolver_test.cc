@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/bpf_tools/task_struct_resolver.h"
+
+#include <string>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace utils {
+
+TEST(TaskStructResolverTest, KernelBuildIDFromNotes) {
+  using namespace std::string_literals;  // NOLINT(build/namespaces)
+
+  // A Xen note, followed by the GNU build ID note, as in /sys/kernel/notes.
+  const std::string notes =
+      "\x04\x00\x00\x00\x04\x00\x00\x00\x06\x00\x00\x00Xen\x00\x0a\x0b\x0c\x0d"s
+      "\x04\x00\x00\x00\x05\x00\x00\x00\x03\x00\x00\x00GNU\x00\xde\xad\xbe\xef\x01\x00\x00\x00"s;
+  EXPECT_EQ(KernelBuildIDFromNotes(notes), "deadbeef01");
+
+  EXPECT_EQ(KernelBuildIDFromNotes(""), "");
+  // Truncated notes are ignored.
+  EXPECT_EQ(KernelBuildIDFromNotes(notes.substr(0, 30)), "");
+}
+
+TEST(TaskStructResolverTest, WriteAndReadOffsets) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path file = tmp_dir.path() / "cache" / "task_struct_offsets-abc";
+
+  EXPECT_NOT_OK(ReadTaskStructOffsets(file));
+
+  TaskStructOffsets offsets;
+  offsets.real_start_time_offset = 1584;
+  offsets.group_leader_offset = 1488;
+  offsets.exit_code_offset = 1324;
+  ASSERT_OK(WriteTaskStructOffsets(file, offsets));
+  EXPECT_OK_AND_EQ(ReadTaskStructOffsets(file), offsets);
+
+  ASSERT_OK(WriteFileFromString(file, "1584 1488\n"));
+  EXPECT_NOT_OK(ReadTaskStructOffsets(file));
+}
+
+}  // namespace utils
+}  // namespace stirling
+}  // namespace px
@@ -57,7 +57,7 @@ Status StandaloneContext::SetClusterCIDR(std::string_view cidr_str) {
   return Status::OK();
 }
 
-StandaloneContext::StandaloneContext(absl::flat_hash_set<md::UPID> upids,
+StandaloneContext::StandaloneContext(md::UPIDSet upids,
                                      const std::filesystem::path& proc_path)
     : upids_(std::move(upids)) {
   // Cannot be empty, otherwise stirling will wait indefinitely. Since StandaloneContext is used
@@ -77,8 +77,8 @@ StandaloneContext::StandaloneContext(absl::flat_hash_set<md::UPID> upids,
 }
 
 // Returns the list of processes from the proc filesystem. Used by StandaloneContext.
-absl::flat_hash_set<md::UPID> ListUPIDs(const std::filesystem::path& proc_path, uint32_t asid) {
-  absl::flat_hash_set<md::UPID> pids;
+md::UPIDSet ListUPIDs(const std::filesystem::path& proc_path, uint32_t asid) {
+  md::UPIDSet pids;
   for (const auto& p : std::filesystem::directory_iterator(proc_path)) {
     uint32_t pid = 0;
     if (!absl::SimpleAtoi(p.path().filename().string(), &pid)) {
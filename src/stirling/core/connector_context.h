@@ -47,12 +47,12 @@ class ConnectorContext {
   /**
    * Return current set of active UPIDs.
    */
-  virtual const absl::flat_hash_set<md::UPID>& GetUPIDs() const = 0;
+  virtual const md::UPIDSet& GetUPIDs() const = 0;
 
   /**
    * Return detailed information on UPIDs.
    */
-  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const = 0;
+  virtual const md::UPIDMap<md::PIDInfoSPtr>& GetPIDInfoMap() const = 0;
 
   /**
    * Return K8s information (Pod and container information)
@@ -85,11 +85,11 @@ class AgentContext : public ConnectorContext {
 
   uint32_t GetASID() const override { return agent_metadata_state_->asid(); }
 
-  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override {
+  const md::UPIDSet& GetUPIDs() const override {
     return agent_metadata_state_->upids();
   }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const md::UPIDMap<md::PIDInfoSPtr>& GetPIDInfoMap() const override {
     return agent_metadata_state_->pids_by_upid();
   }
 
@@ -110,14 +110,14 @@ class AgentContext : public ConnectorContext {
 class StandaloneContext : public ConnectorContext {
  public:
   explicit StandaloneContext(
-      absl::flat_hash_set<md::UPID> upids,
+      md::UPIDSet upids,
       const std::filesystem::path& proc_path = system::Config::GetInstance().proc_path());
 
   uint32_t GetASID() const override { return 0; }
 
-  const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return upids_; }
+  const md::UPIDSet& GetUPIDs() const override { return upids_; }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const md::UPIDMap<md::PIDInfoSPtr>& GetPIDInfoMap() const override {
     return upid_pidinfo_map_;
   }
 
@@ -131,8 +131,8 @@ class StandaloneContext : public ConnectorContext {
   Status SetClusterCIDR(std::string_view cidr_str);
 
  protected:
-  absl::flat_hash_set<md::UPID> upids_;
-  absl::flat_hash_map<md::UPID, md::PIDInfoUPtr> upid_pidinfo_map_;
+  md::UPIDSet upids_;
+  md::UPIDMap<md::PIDInfoSPtr> upid_pidinfo_map_;
 
  private:
   std::vector<CIDRBlock> cidrs_;
@@ -44,7 +44,7 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
 
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
-  col->Reserve(kTargetCapacity);                  \
+  col->Reserve(reserve_capacity_);                \
   record_batch_ptr->push_back(col);
     PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
 #undef TYPE_CASE
@@ -59,12 +59,28 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+namespace {
+
+bool IsIdentity(const std::vector<size_t>& indexes) {
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    if (indexes[i] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
+  size_t max_tablet_size = 0;
 
   for (auto& [tablet_id, tablet] : tablets_) {
+    max_tablet_size = std::max(max_tablet_size, tablet.times.size());
+
     // Sort based on times.
     std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
 
@@ -93,20 +109,30 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
 
     // Case 2: Pushable records. Copy to output.
     if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
+      uint64_t last_time = tablet.times[sort_indexes[positions[1] - 1]];
+      next_start_time = std::max(next_start_time, last_time);
+
       types::ColumnWrapperRecordBatch pushable_records;
-      for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
+      if (num_expired == 0 && num_carryover == 0 && IsIdentity(sort_indexes)) {
+        // The common case, of all records being pushed, in the order they were appended.
+        // The columns are handed out as they are, instead of being copied.
+        pushable_records = std::move(tablet.records);
+      } else {
+        // TODO(oazizi): Consider VectorView to avoid copying.
+        std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
+                                         sort_indexes.end() - num_carryover);
+        for (auto& col : tablet.records) {
+          pushable_records.push_back(col->MoveIndexes(push_indexes));
+        }
       }
-      uint64_t last_time = tablet.times[push_indexes.back()];
-      next_start_time = std::max(next_start_time, last_time);
       tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
 
     // Case 3: Carryover records.
-    if (num_carryover > 0) {
+    if (num_carryover > 0 && num_carryover == static_cast<int>(tablet.times.size())) {
+      // Nothing was pushed or expired, so the tablet is carried over as it is.
+      carryover_tablets[tablet_id] = std::move(tablet);
+    } else if (num_carryover > 0) {
       // TODO(oazizi): Consider VectorView to avoid copying.
       std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
                                             sort_indexes.end());
@@ -125,6 +151,12 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   }
   tablets_ = std::move(carryover_tablets);
 
+  // Size the buffers of new tablets from recent record counts, so that they rarely need to grow,
+  // but do not hold on to much more than is needed. Pushed columns are owned by the table store
+  // from then on, so each push interval starts with new buffers.
+  reserve_capacity_ = std::clamp(std::max(max_tablet_size, reserve_capacity_ / 2),
+                                 kMinReserveCapacity, kMaxReserveCapacity);
+
   start_time_ = next_start_time;
 
   return tablets_out;
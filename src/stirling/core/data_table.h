@@ -265,6 +265,12 @@ class DataTable : public NotCopyable {
   // ColumnWrapper specific members
   static constexpr size_t kTargetCapacity = 1024;
 
+  // Bounds on the capacity reserved for the columns of new tablets. Within them, the capacity
+  // follows the number of records recently consumed out of a tablet.
+  static constexpr size_t kMinReserveCapacity = 16;
+  static constexpr size_t kMaxReserveCapacity = 16 * kTargetCapacity;
+  size_t reserve_capacity_ = kTargetCapacity;
+
   // Unique ID set by InfoClassManager.
   const uint64_t id_;
 
@@ -314,6 +314,46 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+// Records appended in time order, and all carried over, or all pushed, take the paths that do
+// not copy the columns.
+TEST_F(DataTableTest, InOrderCarryoverThenPush) {
+  for (int i = 0; i < 3; ++i) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), 10 * (i + 1));
+    r.Append<r.ColIndex("time_")>(10 * (i + 1));
+    r.Append<r.ColIndex("x")>(i);
+    r.Append<r.ColIndex("s")>(std::string(1, 'a' + i));
+  }
+
+  data_table_->SetConsumeRecordsCutoffTime(5);
+  EXPECT_TRUE(data_table_->ConsumeRecords().empty());
+  EXPECT_EQ(data_table_->Occupancy(), 3);
+
+  data_table_->SetConsumeRecordsCutoffTime(30);
+  std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  const types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+  ASSERT_EQ(rb[0]->Size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * (i + 1));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), i);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+  EXPECT_EQ(data_table_->Occupancy(), 0);
+
+  // The table takes new records, in new buffers, after its columns were handed out.
+  {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), 40);
+    r.Append<r.ColIndex("time_")>(40);
+    r.Append<r.ColIndex("x")>(3);
+    r.Append<r.ColIndex("s")>("d");
+  }
+  data_table_->SetConsumeRecordsCutoffTime(40);
+  tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  ASSERT_EQ(tablets[0].records[0]->Size(), 1);
+  EXPECT_EQ(tablets[0].records[2]->Get<types::StringValue>(0), "d");
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
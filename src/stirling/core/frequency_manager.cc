@@ -18,12 +18,46 @@
 
 #include "src/stirling/core/frequency_manager.h"
 
+#include <random>
+
 namespace px {
 namespace stirling {
 
-void FrequencyManager::Reset() {
-  next_ = px::chrono::coarse_steady_clock::now() + period_;
+std::chrono::milliseconds FrequencyManager::Lateness() const {
+  auto now = px::chrono::coarse_steady_clock::now();
+  if (count_ == 0 || now <= next_) {
+    return std::chrono::milliseconds::zero();
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now - next_);
+}
+
+uint32_t FrequencyManager::Reset() {
+  auto now = px::chrono::coarse_steady_clock::now();
+  uint32_t missed = 0;
+
+  if (count_ == 0 || now < next_) {
+    // The first cycle, or one that was ended early (eg. a push because the tables filled up).
+    RestartGrid(now);
+  } else {
+    next_ += period_;
+    if (next_ <= now) {
+      missed = static_cast<uint32_t>((now - next_) / period_) + 1;
+      overruns_ += missed;
+      RestartGrid(now);
+    }
+  }
+
   ++count_;
+  return missed;
+}
+
+void FrequencyManager::RestartGrid(px::chrono::coarse_steady_clock::time_point now) {
+  next_ = now + period_;
+  if (max_jitter_ > 0) {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    std::uniform_real_distribution<double> dist(0, max_jitter_);
+    next_ += std::chrono::duration_cast<std::chrono::milliseconds>(period_ * dist(rng));
+  }
 }
 
 }  // namespace stirling
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 #include "src/common/system/clock.h"
 
@@ -27,6 +28,10 @@ namespace stirling {
 
 /**
  * Manages the frequency of periodical action.
+ *
+ * Deadlines are kept on a fixed grid of periods, so that time spent acting on a deadline does not
+ * push back the ones after it. A cycle that overruns the next deadline entirely restarts the grid,
+ * and the deadlines it missed are counted as overruns.
  */
 class FrequencyManager {
  public:
@@ -35,17 +40,35 @@ class FrequencyManager {
    */
   bool Expired() const { return px::chrono::coarse_steady_clock::now() >= next_; }
 
+  /**
+   * Returns how long ago the current cycle expired, or zero if it has not.
+   * The first cycle, which expires immediately, is never late.
+   */
+  std::chrono::milliseconds Lateness() const;
+
   /**
    * Ends the current cycle, and starts the next one.
+   * @return the number of deadlines that were missed entirely, because the current cycle ran
+   * past them.
    */
-  void Reset();
+  uint32_t Reset();
 
   void set_period(std::chrono::milliseconds period) { period_ = period; }
   const auto& period() const { return period_; }
   const auto& next() const { return next_; }
   uint32_t count() const { return count_; }
+  uint64_t overruns() const { return overruns_; }
+
+  /**
+   * Delays the deadline by a random fraction of the period, up to max_jitter (eg. 0.1 for 10%)
+   * of it, whenever the grid restarts. This spreads out actions with the same period.
+   */
+  void set_max_jitter(double max_jitter) { max_jitter_ = max_jitter; }
 
  private:
+  // Starts a new grid of deadlines, with the next one a period away from now.
+  void RestartGrid(px::chrono::coarse_steady_clock::time_point now);
+
   // The cycle's period.
   std::chrono::milliseconds period_ = {};
 
@@ -54,6 +77,11 @@ class FrequencyManager {
 
   // The count of expired cycle so far.
   uint32_t count_ = 0;
+
+  // The count of deadlines missed entirely so far.
+  uint64_t overruns_ = 0;
+
+  double max_jitter_ = 0;
 };
 
 }  // namespace stirling
@@ -19,6 +19,7 @@
 #include "src/stirling/core/frequency_manager.h"
 
 #include <chrono>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -49,5 +50,47 @@ TEST(FrequencyManagerTest, SetPeriodEndAndCheck) {
   EXPECT_GE(computed_period, std::chrono::milliseconds{9990});
 }
 
+// Tests that deadlines stay on the grid when a cycle is acted on late, but within its period.
+TEST(FrequencyManagerTest, DeadlinesStayOnGrid) {
+  FrequencyManager mgr;
+  mgr.set_period(std::chrono::milliseconds{100});
+  mgr.Reset();
+  auto first_deadline = mgr.next();
+
+  std::this_thread::sleep_until(std::chrono::steady_clock::now() + std::chrono::milliseconds{130});
+  EXPECT_TRUE(mgr.Expired());
+  EXPECT_GE(mgr.Lateness(), std::chrono::milliseconds{10});
+
+  EXPECT_EQ(mgr.Reset(), 0U);
+  EXPECT_EQ(mgr.next(), first_deadline + std::chrono::milliseconds{100});
+  EXPECT_EQ(mgr.overruns(), 0U);
+}
+
+// Tests that deadlines missed entirely are counted, and that the grid then restarts.
+TEST(FrequencyManagerTest, Overruns) {
+  FrequencyManager mgr;
+  mgr.set_period(std::chrono::milliseconds{20});
+  mgr.Reset();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{75});
+  uint32_t missed = mgr.Reset();
+  EXPECT_GE(missed, 2U);
+  EXPECT_EQ(mgr.overruns(), missed);
+  EXPECT_FALSE(mgr.Expired());
+  EXPECT_EQ(mgr.Lateness(), std::chrono::milliseconds::zero());
+}
+
+// Tests that jitter only ever delays the deadline, by at most the max jitter.
+TEST(FrequencyManagerTest, Jitter) {
+  FrequencyManager mgr;
+  mgr.set_period(std::chrono::milliseconds{10000});
+  mgr.set_max_jitter(0.5);
+
+  mgr.Reset();
+  auto computed_period = mgr.next() - px::chrono::coarse_steady_clock::now();
+  EXPECT_LE(computed_period, std::chrono::milliseconds{15000});
+  EXPECT_GE(computed_period, std::chrono::milliseconds{9990});
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/record_capture.h"
+
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::types::BoolValue;
+using ::px::types::ColumnWrapper;
+using ::px::types::ColumnWrapperRecordBatch;
+using ::px::types::DataType;
+using ::px::types::Float64Value;
+using ::px::types::Int64Value;
+using ::px::types::StringValue;
+using ::px::types::Time64NSValue;
+using ::px::types::UInt128Value;
+
+void ToCapturedRecordBatch(const stirlingpb::TableSchema& schema,
+                           const ColumnWrapperRecordBatch& record_batch,
+                           stirlingpb::CapturedRecordBatch* captured) {
+  DCHECK_EQ(static_cast<size_t>(schema.elements_size()), record_batch.size());
+
+  size_t num_rows = record_batch.empty() ? 0 : record_batch[0]->Size();
+  captured->set_table_name(schema.name());
+  captured->set_num_rows(num_rows);
+
+  for (int i = 0; i < schema.elements_size(); ++i) {
+    const auto& col = record_batch[i];
+    auto* captured_col = captured->add_columns();
+    switch (schema.elements(i).type()) {
+      case DataType::BOOLEAN:
+        for (size_t j = 0; j < num_rows; ++j) {
+          captured_col->add_int64_data(col->Get<BoolValue>(j).val);
+        }
+        break;
+      case DataType::INT64:
+        for (size_t j = 0; j < num_rows; ++j) {
+          captured_col->add_int64_data(col->Get<Int64Value>(j).val);
+        }
+        break;
+      case DataType::TIME64NS:
+        for (size_t j = 0; j < num_rows; ++j) {
+          captured_col->add_int64_data(col->Get<Time64NSValue>(j).val);
+        }
+        break;
+      case DataType::FLOAT64:
+        for (size_t j = 0; j < num_rows; ++j) {
+          captured_col->add_float64_data(col->Get<Float64Value>(j).val);
+        }
+        break;
+      case DataType::UINT128:
+        for (size_t j = 0; j < num_rows; ++j) {
+          const auto& val = col->Get<UInt128Value>(j);
+          captured_col->add_uint128_high_data(val.High64());
+          captured_col->add_uint128_low_data(val.Low64());
+        }
+        break;
+      case DataType::STRING:
+        for (size_t j = 0; j < num_rows; ++j) {
+          captured_col->add_string_data(col->Get<StringValue>(j));
+        }
+        break;
+      default:
+        LOG(DFATAL) << absl::Substitute("Unrecognized type: $0",
+                                        ToString(schema.elements(i).type()));
+    }
+  }
+}
+
+StatusOr<ColumnWrapperRecordBatch> FromCapturedRecordBatch(
+    const stirlingpb::TableSchema& schema, const stirlingpb::CapturedRecordBatch& captured) {
+  if (captured.columns_size() != schema.elements_size()) {
+    return error::InvalidArgument("Table $0 has $1 columns, but the captured batch has $2.",
+                                  schema.name(), schema.elements_size(), captured.columns_size());
+  }
+
+  const int num_rows = captured.num_rows();
+  ColumnWrapperRecordBatch record_batch;
+  for (int i = 0; i < schema.elements_size(); ++i) {
+    const auto& captured_col = captured.columns(i);
+    DataType type = schema.elements(i).type();
+
+    int size = 0;
+    switch (type) {
+      case DataType::BOOLEAN:
+      case DataType::INT64:
+      case DataType::TIME64NS:
+        size = captured_col.int64_data_size();
+        break;
+      case DataType::FLOAT64:
+        size = captured_col.float64_data_size();
+        break;
+      case DataType::UINT128:
+        size = std::min(captured_col.uint128_high_data_size(),
+                        captured_col.uint128_low_data_size());
+        break;
+      case DataType::STRING:
+        size = captured_col.string_data_size();
+        break;
+      default:
+        return error::InvalidArgument("Column $0 of table $1 has unrecognized type $2.",
+                                      schema.elements(i).name(), schema.name(), ToString(type));
+    }
+    if (size != num_rows) {
+      return error::InvalidArgument("Column $0 of table $1 has $2 values, but expected $3.",
+                                    schema.elements(i).name(), schema.name(), size, num_rows);
+    }
+
+    auto col = ColumnWrapper::Make(type, 0);
+    col->Reserve(num_rows);
+    for (int j = 0; j < num_rows; ++j) {
+      switch (type) {
+        case DataType::BOOLEAN:
+          col->Append<BoolValue>(captured_col.int64_data(j) != 0);
+          break;
+        case DataType::INT64:
+          col->Append<Int64Value>(captured_col.int64_data(j));
+          break;
+        case DataType::TIME64NS:
+          col->Append<Time64NSValue>(captured_col.int64_data(j));
+          break;
+        case DataType::FLOAT64:
+          col->Append<Float64Value>(captured_col.float64_data(j));
+          break;
+        case DataType::UINT128:
+          col->Append<UInt128Value>(
+              UInt128Value(captured_col.uint128_high_data(j), captured_col.uint128_low_data(j)));
+          break;
+        case DataType::STRING:
+          col->Append<StringValue>(captured_col.string_data(j));
+          break;
+        default:
+          break;
+      }
+    }
+    record_batch.push_back(std::move(col));
+  }
+  return record_batch;
+}
+
+StatusOr<std::unique_ptr<RecordCaptureWriter>> RecordCaptureWriter::Create(
+    const std::filesystem::path& path) {
+  auto writer = std::unique_ptr<RecordCaptureWriter>(new RecordCaptureWriter);
+  writer->out_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!writer->out_.is_open()) {
+    return error::Internal("Failed to open $0 for writing.", path.string());
+  }
+  return writer;
+}
+
+Status RecordCaptureWriter::Write(const stirlingpb::TableSchema& schema, int64_t push_time_ns,
+                                  const ColumnWrapperRecordBatch& record_batch) {
+  stirlingpb::CapturedRecordBatch captured;
+  ToCapturedRecordBatch(schema, record_batch, &captured);
+  captured.set_push_time_ns(push_time_ns);
+  if (tables_written_.insert(schema.name()).second) {
+    *captured.mutable_schema() = schema;
+  }
+
+  if (!google::protobuf::util::SerializeDelimitedToOstream(captured, &out_)) {
+    return error::Internal("Failed to write a batch of table $0.", schema.name());
+  }
+  // The capture is usually ended by killing the process, so flush it batch by batch.
+  out_.flush();
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RecordCaptureReader>> RecordCaptureReader::Create(
+    const std::filesystem::path& path) {
+  auto reader = std::unique_ptr<RecordCaptureReader>(new RecordCaptureReader);
+  reader->in_.open(path, std::ios::in | std::ios::binary);
+  if (!reader->in_.is_open()) {
+    return error::Internal("Failed to open $0 for reading.", path.string());
+  }
+  reader->input_ = std::make_unique<google::protobuf::io::IstreamInputStream>(&reader->in_);
+  return reader;
+}
+
+StatusOr<bool> RecordCaptureReader::Next(stirlingpb::CapturedRecordBatch* captured) {
+  bool clean_eof = false;
+  if (google::protobuf::util::ParseDelimitedFromZeroCopyStream(captured, input_.get(),
+                                                               &clean_eof)) {
+    ++num_batches_read_;
+    return true;
+  }
+  if (!clean_eof) {
+    return error::InvalidArgument("Truncated or malformed batch after $0 batches.",
+                                  num_batches_read_);
+  }
+  return false;
+}
+
+StatusOr<std::vector<stirlingpb::TableSchema>> ReadCaptureSchemas(
+    const std::filesystem::path& path) {
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<RecordCaptureReader> reader,
+                      RecordCaptureReader::Create(path));
+
+  std::vector<stirlingpb::TableSchema> schemas;
+  stirlingpb::CapturedRecordBatch captured;
+  while (true) {
+    PL_ASSIGN_OR_RETURN(bool has_batch, reader->Next(&captured));
+    if (!has_batch) {
+      break;
+    }
+    if (captured.has_schema()) {
+      schemas.push_back(std::move(*captured.mutable_schema()));
+    }
+  }
+  return schemas;
+}
+
+}  // namespace stirling
+}  // namespace px
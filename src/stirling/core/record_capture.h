@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/stirling/proto/stirling.pb.h"
+
+namespace px {
+namespace stirling {
+
+// A capture is a file of the record batches pushed out of Stirling's data tables, which the
+// replay source connector can feed back in, without any of the original sources running.
+// It is a sequence of length-delimited stirlingpb::CapturedRecordBatch messages, in push order.
+// The records are stored column by column; the first batch of each table carries its schema.
+
+/**
+ * Converts a record batch to its captured form. The schema and push time are not set.
+ */
+void ToCapturedRecordBatch(const stirlingpb::TableSchema& schema,
+                           const types::ColumnWrapperRecordBatch& record_batch,
+                           stirlingpb::CapturedRecordBatch* captured);
+
+/**
+ * Converts a captured record batch back, checking that its columns match the schema.
+ */
+StatusOr<types::ColumnWrapperRecordBatch> FromCapturedRecordBatch(
+    const stirlingpb::TableSchema& schema, const stirlingpb::CapturedRecordBatch& captured);
+
+class RecordCaptureWriter : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<RecordCaptureWriter>> Create(const std::filesystem::path& path);
+
+  Status Write(const stirlingpb::TableSchema& schema, int64_t push_time_ns,
+               const types::ColumnWrapperRecordBatch& record_batch);
+
+ private:
+  RecordCaptureWriter() = default;
+
+  std::ofstream out_;
+  absl::flat_hash_set<std::string> tables_written_;
+};
+
+class RecordCaptureReader : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<RecordCaptureReader>> Create(const std::filesystem::path& path);
+
+  /**
+   * Reads the next batch of the capture into captured.
+   * @return false at the end of the capture.
+   */
+  StatusOr<bool> Next(stirlingpb::CapturedRecordBatch* captured);
+
+ private:
+  RecordCaptureReader() = default;
+
+  std::ifstream in_;
+  std::unique_ptr<google::protobuf::io::IstreamInputStream> input_;
+  int num_batches_read_ = 0;
+};
+
+/**
+ * Returns the schemas of the tables in a capture, in the order they first appear.
+ */
+StatusOr<std::vector<stirlingpb::TableSchema>> ReadCaptureSchemas(
+    const std::filesystem::path& path);
+
+}  // namespace stirling
+}  // namespace px
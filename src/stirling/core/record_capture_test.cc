@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/core/record_capture.h"
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/core/types.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::types::ColumnWrapper;
+using ::px::types::ColumnWrapperRecordBatch;
+using ::px::types::DataType;
+
+// clang-format off
+constexpr DataElement kElements[] = {
+    {"time_", "", DataType::TIME64NS,
+     types::SemanticType::ST_NONE, types::PatternType::METRIC_COUNTER},
+    {"upid", "", DataType::UINT128,
+     types::SemanticType::ST_UPID, types::PatternType::GENERAL},
+    {"flag", "", DataType::BOOLEAN,
+     types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"count", "", DataType::INT64,
+     types::SemanticType::ST_NONE, types::PatternType::METRIC_COUNTER},
+    {"ratio", "", DataType::FLOAT64,
+     types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+    {"msg", "", DataType::STRING,
+     types::SemanticType::ST_NONE, types::PatternType::STRUCTURED},
+};
+// clang-format on
+
+constexpr auto kCaptureTable = DataTableSchema("capture", "A table for testing", kElements);
+
+ColumnWrapperRecordBatch MakeRecordBatch(int64_t time) {
+  ColumnWrapperRecordBatch record_batch;
+  for (const auto& element : kElements) {
+    record_batch.push_back(ColumnWrapper::Make(element.type(), 0));
+  }
+  for (int i = 0; i < 2; ++i) {
+    record_batch[0]->Append<types::Time64NSValue>(time + i);
+    record_batch[1]->Append<types::UInt128Value>(types::UInt128Value(i, 123));
+    record_batch[2]->Append<types::BoolValue>(i == 1);
+    record_batch[3]->Append<types::Int64Value>(-i);
+    record_batch[4]->Append<types::Float64Value>(0.5 * i);
+    record_batch[5]->Append<types::StringValue>(absl::StrCat("msg", i));
+  }
+  return record_batch;
+}
+
+TEST(RecordCaptureTest, RoundTrip) {
+  const stirlingpb::TableSchema schema = kCaptureTable.ToProto();
+
+  stirlingpb::CapturedRecordBatch captured;
+  ToCapturedRecordBatch(schema, MakeRecordBatch(100), &captured);
+  EXPECT_EQ(captured.num_rows(), 2U);
+
+  ASSERT_OK_AND_ASSIGN(ColumnWrapperRecordBatch record_batch,
+                       FromCapturedRecordBatch(schema, captured));
+  ASSERT_EQ(record_batch.size(), kCaptureTable.elements().size());
+  EXPECT_EQ(record_batch[0]->Get<types::Time64NSValue>(1).val, 101);
+  EXPECT_EQ(record_batch[1]->Get<types::UInt128Value>(1), types::UInt128Value(1, 123));
+  EXPECT_TRUE(record_batch[2]->Get<types::BoolValue>(1).val);
+  EXPECT_EQ(record_batch[3]->Get<types::Int64Value>(1).val, -1);
+  EXPECT_EQ(record_batch[4]->Get<types::Float64Value>(1).val, 0.5);
+  EXPECT_EQ(record_batch[5]->Get<types::StringValue>(1), "msg1");
+}
+
+TEST(RecordCaptureTest, RejectsMismatchedColumns) {
+  const stirlingpb::TableSchema schema = kCaptureTable.ToProto();
+
+  stirlingpb::CapturedRecordBatch captured;
+  ToCapturedRecordBatch(schema, MakeRecordBatch(100), &captured);
+  captured.mutable_columns(3)->add_int64_data(0);
+  EXPECT_NOT_OK(FromCapturedRecordBatch(schema, captured));
+
+  captured.mutable_columns()->RemoveLast();
+  EXPECT_NOT_OK(FromCapturedRecordBatch(schema, captured));
+}
+
+TEST(RecordCaptureTest, WriteAndRead) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "capture.bin";
+  const stirlingpb::TableSchema schema = kCaptureTable.ToProto();
+
+  {
+    ASSERT_OK_AND_ASSIGN(auto writer, RecordCaptureWriter::Create(path));
+    ASSERT_OK(writer->Write(schema, 1000, MakeRecordBatch(100)));
+    ASSERT_OK(writer->Write(schema, 2000, MakeRecordBatch(200)));
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto reader, RecordCaptureReader::Create(path));
+  stirlingpb::CapturedRecordBatch captured;
+
+  ASSERT_OK_AND_EQ(reader->Next(&captured), true);
+  EXPECT_EQ(captured.table_name(), "capture");
+  EXPECT_EQ(captured.push_time_ns(), 1000);
+  // Only the first batch of the table carries the schema.
+  EXPECT_TRUE(captured.has_schema());
+
+  ASSERT_OK_AND_EQ(reader->Next(&captured), true);
+  EXPECT_EQ(captured.push_time_ns(), 2000);
+  EXPECT_FALSE(captured.has_schema());
+  EXPECT_EQ(captured.columns(0).int64_data(0), 200);
+
+  ASSERT_OK_AND_EQ(reader->Next(&captured), false);
+
+  ASSERT_OK_AND_ASSIGN(std::vector<stirlingpb::TableSchema> schemas, ReadCaptureSchemas(path));
+  ASSERT_EQ(schemas.size(), 1);
+  EXPECT_EQ(schemas[0].name(), "capture");
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -16,18 +16,95 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
 #include <memory>
+#include <string>
 #include <utility>
 
+#include <absl/strings/str_cat.h>
 #include <magic_enum.hpp>
 
+#include "src/common/metrics/metrics.h"
 #include "src/stirling/core/source_connector.h"
 
+DEFINE_double(stirling_source_max_jitter,
+              gflags::DoubleFromEnv("PL_STIRLING_SOURCE_MAX_JITTER", 0.05),
+              "Each time a source connector's schedule restarts (eg. at startup, or after it "
+              "overran a period), its next deadline is delayed by a random fraction of the "
+              "period, up to this one. Spreads out connectors with the same period.");
+
 namespace px {
 namespace stirling {
 
+namespace {
+const prometheus::Histogram::BucketBoundaries kPushLatencyBuckets = {
+    0.01, 0.1, 0.5, 1, 2, 5, 10, 30, 60, 300};
+}  // namespace
+
+SourceConnector::ScheduleMetrics::ScheduleMetrics(std::string_view source_name,
+                                                  std::string_view cycle)
+    : late_cycles(prometheus::BuildCounter()
+                      .Name("stirling_source_late_cycles")
+                      .Help("Cycles of a source connector that started after their deadline.")
+                      .Register(GetMetricsRegistry())
+                      .Add({{"source", std::string(source_name)}, {"cycle", std::string(cycle)}})),
+      late_seconds(prometheus::BuildCounter()
+                       .Name("stirling_source_late_seconds")
+                       .Help("Total time by which cycles of a source connector started late.")
+                       .Register(GetMetricsRegistry())
+                       .Add({{"source", std::string(source_name)}, {"cycle", std::string(cycle)}})),
+      overrun_cycles(
+          prometheus::BuildCounter()
+              .Name("stirling_source_overrun_cycles")
+              .Help("Deadlines of a source connector that were missed entirely, because the "
+                    "previous cycle ran past them.")
+              .Register(GetMetricsRegistry())
+              .Add({{"source", std::string(source_name)}, {"cycle", std::string(cycle)}})) {}
+
+void SourceConnector::ScheduleMetrics::Update(std::chrono::milliseconds lateness,
+                                              uint32_t overruns) {
+  if (lateness > std::chrono::milliseconds::zero()) {
+    late_cycles.Increment();
+    late_seconds.Increment(std::chrono::duration<double>(lateness).count());
+  }
+  if (overruns > 0) {
+    overrun_cycles.Increment(overruns);
+  }
+}
+
+SourceConnector::TransferStats::TransferStats(std::string_view source_name,
+                                              const ArrayView<DataTableSchema>& table_schemas) {
+  StirlingMonitor& monitor = *StirlingMonitor::GetInstance();
+  transfer_data =
+      monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, source_name, "transfer_data_ns");
+  auto& push_latency_family =
+      prometheus::BuildHistogram()
+          .Name("stirling_record_push_latency_seconds")
+          .Help("Time from the event time of the first record of each batch pushed by a source "
+                "connector (eg. the syscall traced in BPF) to the push into the table store.")
+          .Register(GetMetricsRegistry());
+  for (const DataTableSchema& schema : table_schemas) {
+    push_latency.push_back(&push_latency_family.Add(
+        {{"source", std::string(source_name)}, {"table", std::string(schema.name())}},
+        kPushLatencyBuckets));
+    int time_idx = -1;
+    for (size_t i = 0; i < schema.elements().size(); ++i) {
+      if (schema.elements()[i].name() == "time_" &&
+          schema.elements()[i].type() == types::DataType::TIME64NS) {
+        time_idx = i;
+        break;
+      }
+    }
+    time_col_idx.push_back(time_idx);
+    records_pushed.push_back(monitor.GetHotPathStat(
+        HotPathStat::Type::kCount, source_name, absl::StrCat("records_pushed.", schema.name())));
+    bytes_pushed.push_back(monitor.GetHotPathStat(
+        HotPathStat::Type::kCount, source_name, absl::StrCat("bytes_pushed.", schema.name())));
+  }
+}
+
 Status SourceConnector::Init() {
   if (state_ != State::kUninitialized) {
     return error::Internal("Cannot re-initialize a connector [current state = $0].",
@@ -37,6 +114,9 @@ Status SourceConnector::Init() {
   Status s = InitImpl();
   state_ = s.ok() ? State::kActive : State::kErrors;
 
+  sampling_freq_mgr_.set_max_jitter(FLAGS_stirling_source_max_jitter);
+  push_freq_mgr_.set_max_jitter(FLAGS_stirling_source_max_jitter);
+
   DCHECK_NE(sampling_freq_mgr_.period().count(), 0) << "Sampling period has not been initialized";
   DCHECK_NE(push_freq_mgr_.period().count(), 0) << "Push period has not been initialized";
 
@@ -50,25 +130,54 @@ void SourceConnector::TransferData(ConnectorContext* ctx,
   DCHECK(ctx != nullptr);
   DCHECK_EQ(data_tables.size(), table_schemas().size())
       << "DataTable objects must all be specified.";
+  auto lateness = sampling_freq_mgr_.Lateness();
+  auto start = std::chrono::steady_clock::now();
   TransferDataImpl(ctx, data_tables);
-  sampling_freq_mgr_.Reset();
+  transfer_stats_.transfer_data->RecordDuration(std::chrono::steady_clock::now() - start);
+  sampling_metrics_.Update(lateness, sampling_freq_mgr_.Reset());
+}
+
+void SourceConnector::Poll() {
+  PollImpl();
+  poll_freq_mgr_.Reset();
 }
 
 void SourceConnector::PushData(DataPushCallback agent_callback,
                                const std::vector<DataTable*>& data_tables) {
-  for (auto* data_table : data_tables) {
+  auto lateness = push_freq_mgr_.Lateness();
+  for (size_t i = 0; i < data_tables.size(); ++i) {
+    DataTable* data_table = data_tables[i];
+    uint64_t num_records = 0;
+    uint64_t num_bytes = 0;
     auto record_batches = data_table->ConsumeRecords();
     for (auto& record_batch : record_batches) {
       if (record_batch.records.empty()) {
         continue;
       }
+      num_records += record_batch.records[0]->Size();
+      for (const auto& col : record_batch.records) {
+        num_bytes += col->Bytes();
+      }
+      // Pushed batches are sorted by time, so the first record is the oldest one.
+      if (i < transfer_stats_.time_col_idx.size() && transfer_stats_.time_col_idx[i] != -1 &&
+          record_batch.records[0]->Size() > 0) {
+        int64_t event_time = record_batch.records[transfer_stats_.time_col_idx[i]]
+                                 ->Get<types::Time64NSValue>(0)
+                                 .val;
+        transfer_stats_.push_latency[i]->Observe(
+            std::max<int64_t>(CurrentTimeNS() - event_time, 0) / 1e9);
+      }
       Status s = agent_callback(
           data_table->id(), record_batch.tablet_id,
           std::make_unique<types::ColumnWrapperRecordBatch>(std::move(record_batch.records)));
       LOG_IF(DFATAL, !s.ok()) << absl::Substitute("Failed to push data. Message = $0", s.msg());
     }
+    if (num_records > 0 && i < transfer_stats_.records_pushed.size()) {
+      transfer_stats_.records_pushed[i]->Record(num_records);
+      transfer_stats_.bytes_pushed[i]->Record(num_bytes);
+    }
   }
-  push_freq_mgr_.Reset();
+  push_metrics_.Update(lateness, push_freq_mgr_.Reset());
 }
 
 Status SourceConnector::Stop() {
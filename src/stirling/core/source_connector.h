@@ -18,15 +18,21 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <prometheus/counter.h>
+#include <prometheus/histogram.h>
+
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 #include "src/shared/types/types.h"
 #include "src/stirling/core/connector_context.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/frequency_manager.h"
+#include "src/stirling/utils/monitor.h"
 
 /**
  * These are the steps to follow to add a new data source connector.
@@ -64,6 +70,13 @@ class SourceConnector : public NotCopyable {
    */
   void TransferData(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables);
 
+  /**
+   * Drains the input that the source buffers between transfers, e.g. its perf buffers, so that
+   * it doesn't overflow before the next TransferData(). Called between transfers whenever the
+   * poll cycle expires, for sources that set a poll period.
+   */
+  void Poll();
+
   /**
    * Pushes data in data tables into table store.
    */
@@ -104,6 +117,9 @@ class SourceConnector : public NotCopyable {
   uint64_t ConvertToRealTime(uint64_t monotonic_time) const {
     return sysconfig_.ConvertToRealTime(monotonic_time);
   }
+  void ConvertToRealTime(absl::Span<uint64_t> monotonic_times) const {
+    sysconfig_.ConvertToRealTime(monotonic_times);
+  }
 
   // Use this version of the clock, instead of CurrentTimeNS(), when generating a timestamp
   // for comparison against BPF event timestamps. This is to make sure the clocks are generated
@@ -114,13 +130,31 @@ class SourceConnector : public NotCopyable {
   virtual void EnablePIDTrace(int pid) { pids_to_trace_.insert(pid); }
   virtual void DisablePIDTrace(int pid) { pids_to_trace_.erase(pid); }
 
+  /**
+   * Asks the source to keep less data buffered, at the cost of losing some of it, e.g. while the
+   * node is short on memory. May be called from any thread.
+   */
+  virtual void SetShedLoad(bool /*shed_load*/) {}
+
+  /**
+   * Tells the source whether anything reads the given table of its, so that it can stop
+   * collecting the data of tables nobody reads. May be called from any thread.
+   */
+  virtual void SetTableActive(std::string_view /*table_name*/, bool /*active*/) {}
+
   const FrequencyManager& sampling_freq_mgr() const { return sampling_freq_mgr_; }
   const FrequencyManager& push_freq_mgr() const { return push_freq_mgr_; }
+  const FrequencyManager& poll_freq_mgr() const { return poll_freq_mgr_; }
+  bool polls_between_transfers() const { return poll_freq_mgr_.period().count() > 0; }
 
  protected:
   explicit SourceConnector(std::string_view source_name,
                            const ArrayView<DataTableSchema>& table_schemas)
-      : source_name_(source_name), table_schemas_(table_schemas) {}
+      : source_name_(source_name),
+        table_schemas_(table_schemas),
+        sampling_metrics_(source_name, "sampling"),
+        push_metrics_(source_name, "push"),
+        transfer_stats_(source_name, table_schemas) {}
 
   virtual Status InitImpl() = 0;
 
@@ -130,6 +164,9 @@ class SourceConnector : public NotCopyable {
 
   virtual void TransferDataImpl(ConnectorContext*, const std::vector<DataTable*>&) = 0;
 
+  // Sources that set a poll period drain their buffered input here.
+  virtual void PollImpl() {}
+
   virtual Status StopImpl() = 0;
 
  protected:
@@ -148,6 +185,9 @@ class SourceConnector : public NotCopyable {
 
   FrequencyManager sampling_freq_mgr_;
   FrequencyManager push_freq_mgr_;
+  // Unset, unless the source polls its input between transfers. The source may change the period
+  // as it goes, e.g. with how fast its input arrives.
+  FrequencyManager poll_freq_mgr_;
 
   // Debug members.
   int debug_level_ = 0;
@@ -158,6 +198,33 @@ class SourceConnector : public NotCopyable {
 
   const std::string source_name_;
   const ArrayView<DataTableSchema> table_schemas_;
+
+  // Tracks how well the connector keeps to the schedule of one of its frequency managers.
+  struct ScheduleMetrics {
+    ScheduleMetrics(std::string_view source_name, std::string_view cycle);
+    void Update(std::chrono::milliseconds lateness, uint32_t overruns);
+
+    prometheus::Counter& late_cycles;
+    prometheus::Counter& late_seconds;
+    prometheus::Counter& overrun_cycles;
+  };
+  ScheduleMetrics sampling_metrics_;
+  ScheduleMetrics push_metrics_;
+
+  // Hot path stats of TransferData() and PushData().
+  struct TransferStats {
+    TransferStats(std::string_view source_name, const ArrayView<DataTableSchema>& table_schemas);
+
+    HotPathStat* transfer_data;
+    // Indexed by table number.
+    std::vector<HotPathStat*> records_pushed;
+    std::vector<HotPathStat*> bytes_pushed;
+    // The time from the event time of the first record of each pushed batch to the push, and the
+    // index of the time_ column that it is read from, or -1 if the table has none.
+    std::vector<prometheus::Histogram*> push_latency;
+    std::vector<int> time_col_idx;
+  };
+  TransferStats transfer_stats_;
 };
 
 }  // namespace stirling
@@ -80,5 +80,29 @@ TEST_F(StirlingBPFTest, CleanupTest) {
   EXPECT_EQ(SocketTraceConnector::num_open_perf_buffers(), 0);
 }
 
+class StirlingSourceThreadsBPFTest : public StirlingBPFTest {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_source_threads = SocketTraceConnector::kName;
+    StirlingBPFTest::SetUp();
+  }
+
+  void TearDown() override { FLAGS_stirling_source_threads = ""; }
+};
+
+TEST_F(StirlingSourceThreadsBPFTest, CleanupTest) {
+  ASSERT_OK(stirling_->RunAsThread());
+  ASSERT_OK(stirling_->WaitUntilRunning(/* timeout */ std::chrono::seconds(5)));
+
+  EXPECT_GT(SocketTraceConnector::num_attached_probes(), 0);
+
+  // Stopping must also join the thread that runs the socket tracer.
+  stirling_->Stop();
+  EXPECT_FALSE(stirling_->IsRunning());
+
+  EXPECT_EQ(SocketTraceConnector::num_attached_probes(), 0);
+  EXPECT_EQ(SocketTraceConnector::num_open_perf_buffers(), 0);
+}
+
 }  // namespace stirling
 }  // namespace px
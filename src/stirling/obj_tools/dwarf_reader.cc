@@ -22,16 +22,26 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
 #include <absl/container/flat_hash_set.h>
+#include <absl/strings/escaping.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/strip.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cstring>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
 
+#include "src/common/base/file.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 #include "src/stirling/obj_tools/abi_model.h"
 #include "src/stirling/obj_tools/dwarf_utils.h"
 #include "src/stirling/obj_tools/init.h"
 
+DEFINE_string(stirling_dwarf_index_dir, gflags::StringFromEnv("PL_DWARF_INDEX_DIR", ""),
+              "Directory in which DwarfReader keeps the DIE indexes of binaries, keyed by "
+              "build-id, so that they persist across restarts. Not used if empty.");
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -52,6 +62,44 @@ std::vector<DWARFDie> GetParamDIEs(const DWARFDie& function_die) {
   return dies;
 }
 
+// Returns the build-id of the object file, as lowercase hex, or an empty string if it has none.
+std::string ReadBuildID(const llvm::object::ObjectFile& obj_file) {
+  for (const llvm::object::SectionRef& section : obj_file.sections()) {
+    llvm::Expected<llvm::StringRef> name = section.getName();
+    if (!name) {
+      llvm::consumeError(name.takeError());
+      continue;
+    }
+    if (*name != ".note.gnu.build-id") {
+      continue;
+    }
+
+    llvm::Expected<llvm::StringRef> contents = section.getContents();
+    if (!contents) {
+      llvm::consumeError(contents.takeError());
+      return "";
+    }
+
+    // The note holds namesz, descsz and type as 32-bit words, then the name and the desc,
+    // each padded to 4 bytes. The desc is the build-id.
+    constexpr size_t kNoteHeaderSize = 3 * sizeof(uint32_t);
+    std::string_view note(contents->data(), contents->size());
+    if (note.size() < kNoteHeaderSize) {
+      return "";
+    }
+    uint32_t name_size;
+    uint32_t desc_size;
+    std::memcpy(&name_size, note.data(), sizeof(uint32_t));
+    std::memcpy(&desc_size, note.data() + sizeof(uint32_t), sizeof(uint32_t));
+    const size_t desc_pos = kNoteHeaderSize + ((static_cast<size_t>(name_size) + 3) & ~3UL);
+    if (desc_pos + desc_size > note.size()) {
+      return "";
+    }
+    return absl::BytesToHexString(note.substr(desc_pos, desc_size));
+  }
+  return "";
+}
+
 }  // namespace
 
 // This will break on 32-bit binaries.
@@ -89,6 +137,7 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithoutIndexing(
 
   auto dwarf_reader = std::unique_ptr<DwarfReader>(
       new DwarfReader(std::move(buffer), DWARFContext::create(*obj_file)));
+  dwarf_reader->build_id_ = ReadBuildID(*obj_file);
 
   PL_RETURN_IF_ERROR(dwarf_reader->DetectSourceLanguage());
 
@@ -98,14 +147,15 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithoutIndexing(
 StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateIndexingAll(
     const std::filesystem::path& path) {
   PL_ASSIGN_OR_RETURN(auto dwarf_reader, CreateWithoutIndexing(path));
-  dwarf_reader->IndexDIEs(std::nullopt);
+  dwarf_reader->indexing_ = true;
   return dwarf_reader;
 }
 
 StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithSelectiveIndexing(
     const std::filesystem::path& path, const std::vector<SymbolSearchPattern>& symbol_patterns) {
   PL_ASSIGN_OR_RETURN(auto dwarf_reader, CreateWithoutIndexing(path));
-  dwarf_reader->IndexDIEs(symbol_patterns);
+  dwarf_reader->indexing_ = true;
+  dwarf_reader->index_patterns_ = symbol_patterns;
   return dwarf_reader;
 }
 
@@ -184,13 +234,117 @@ Status DwarfReader::DetectSourceLanguage() {
       "any compilation unit.");
 }
 
+void DwarfReader::EnsureIndexed() {
+  if (index_built_) {
+    return;
+  }
+  index_built_ = true;
+
+  // Only full indexes are kept on disk, since a selective index depends on its patterns.
+  std::filesystem::path index_path;
+  if (!index_patterns_.has_value() && !build_id_.empty() &&
+      !FLAGS_stirling_dwarf_index_dir.empty()) {
+    index_path = std::filesystem::path(FLAGS_stirling_dwarf_index_dir) /
+                 absl::StrCat(build_id_, ".dwidx");
+    Status s = ReadIndex(index_path);
+    if (s.ok()) {
+      return;
+    }
+    VLOG(1) << absl::Substitute("No usable DWARF index at $0 [error=$1]", index_path.string(),
+                                s.ToString());
+    die_map_.clear();
+  }
+
+  IndexDIEs(index_patterns_);
+
+  if (!index_path.empty()) {
+    std::error_code ec;
+    std::filesystem::create_directories(index_path.parent_path(), ec);
+    Status s = WriteIndex(index_path);
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to write DWARF index to $0: $1",
+                                                 index_path.string(), s.ToString());
+  }
+}
+
+namespace {
+
+// An index file is the magic, followed by one record per indexed DIE:
+//   tag (uint16_t), DIE offset (uint64_t), name size (uint32_t), name.
+// Integers are in host byte order, since the files never leave the node.
+constexpr std::string_view kIndexMagic = "PXDWIDX1";
+
+template <typename T>
+void AppendInt(T val, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <typename T>
+bool ConsumeInt(std::string_view* data, T* val) {
+  if (data->size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(val, data->data(), sizeof(T));
+  data->remove_prefix(sizeof(T));
+  return true;
+}
+
+}  // namespace
+
+Status DwarfReader::ReadIndex(const std::filesystem::path& path) {
+  PL_ASSIGN_OR_RETURN(std::string contents,
+                      ReadFileToString(path, std::ios_base::in | std::ios_base::binary));
+
+  std::string_view data = contents;
+  if (!absl::ConsumePrefix(&data, kIndexMagic)) {
+    return error::InvalidArgument("$0 is not a DWARF index.", path.string());
+  }
+  while (!data.empty()) {
+    uint16_t tag;
+    uint64_t offset;
+    uint32_t name_size;
+    if (!ConsumeInt(&data, &tag) || !ConsumeInt(&data, &offset) ||
+        !ConsumeInt(&data, &name_size) || data.size() < name_size) {
+      return error::InvalidArgument("$0 is truncated.", path.string());
+    }
+    InsertToDIEMap(std::string(data.substr(0, name_size)), static_cast<llvm::dwarf::Tag>(tag),
+                   offset);
+    data.remove_prefix(name_size);
+  }
+  return Status::OK();
+}
+
+Status DwarfReader::WriteIndex(const std::filesystem::path& path) const {
+  std::string contents(kIndexMagic);
+  for (const auto& [tag, die_type_map] : die_map_) {
+    for (const auto& [name, offset] : die_type_map) {
+      AppendInt<uint16_t>(tag, &contents);
+      AppendInt<uint64_t>(offset, &contents);
+      AppendInt<uint32_t>(name.size(), &contents);
+      contents.append(name);
+    }
+  }
+
+  // Write to a temporary file and rename it into place, so that readers never see a partial
+  // index.
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp.", getpid());
+  PL_RETURN_IF_ERROR(
+      WriteFileFromString(tmp_path, contents, std::ios_base::out | std::ios_base::binary));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+    return error::Internal("Could not rename $0 to $1.", tmp_path.string(), path.string());
+  }
+  return Status::OK();
+}
+
 void DwarfReader::IndexDIEs(
     const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
   absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
 
-  // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
-  // Also only applies to CPP binaries.
-  absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
+  // Map from DW_AT_specification to the offset of the DIE. Only DW_TAG_subprogram can have this
+  // attribute. Also only applies to CPP binaries.
+  absl::flat_hash_map<uint64_t, uint64_t> fn_spec_offsets;
 
   DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
   for (const std::unique_ptr<llvm::DWARFUnit>& unit : units) {
@@ -202,7 +356,7 @@ void DwarfReader::IndexDIEs(
             AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
                               "Could not find attribute DW_AT_specification");
         if (spec_or.ok()) {
-          fn_spec_offsets[spec_or.ValueOrDie()] = die;
+          fn_spec_offsets[spec_or.ValueOrDie()] = die.getOffset();
         }
       }
 
@@ -243,7 +397,7 @@ void DwarfReader::IndexDIEs(
         }
 
         if (IsIndexedType(tag)) {
-          InsertToDIEMap(std::move(name), tag, die);
+          InsertToDIEMap(std::move(name), tag, die.getOffset());
         }
       }
     }
@@ -252,8 +406,7 @@ void DwarfReader::IndexDIEs(
   auto& fn_dies = die_map_[llvm::dwarf::DW_TAG_subprogram];
 
   for (auto iter = fn_dies.begin(); iter != fn_dies.end(); ++iter) {
-    uint64_t offset = iter->second.getOffset();
-    auto spec_iter = fn_spec_offsets.find(offset);
+    auto spec_iter = fn_spec_offsets.find(iter->second);
     if (spec_iter == fn_spec_offsets.end()) {
       continue;
     }
@@ -267,7 +420,8 @@ StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(
   DCHECK(dwarf_context_ != nullptr);
 
   // Special case for types that are indexed.
-  if (type_opt.has_value() && IsIndexedType(type_opt.value()) && !die_map_.empty()) {
+  if (type_opt.has_value() && IsIndexedType(type_opt.value()) && indexing_) {
+    EnsureIndexed();
     auto die_opt = FindInDIEMap(std::string(name), type_opt.value());
     if (die_opt.has_value()) {
       return std::vector<DWARFDie>{die_opt.value()};
@@ -632,6 +786,14 @@ bool IsDeclaration(const llvm::DWARFDie& die) {
   return value_or.ok();
 }
 
+StatusOr<StructMemberInfo> GetMemberInfo(const DWARFDie& die) {
+  StructMemberInfo member_info;
+  PL_ASSIGN_OR_RETURN(member_info.offset, GetMemberOffset(die));
+  PL_ASSIGN_OR_RETURN(DWARFDie type_die, GetTypeDie(die));
+  PL_ASSIGN_OR_RETURN(member_info.type_info, GetTypeInfo(die, type_die));
+  return member_info;
+}
+
 }  // namespace
 
 StatusOr<uint64_t> DwarfReader::GetStructByteSize(std::string_view struct_name) {
@@ -641,11 +803,13 @@ StatusOr<uint64_t> DwarfReader::GetStructByteSize(std::string_view struct_name)
   return GetTypeByteSize(struct_die);
 }
 
-StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfo(std::string_view struct_name,
-                                                            llvm::dwarf::Tag tag,
-                                                            std::string_view member_name,
-                                                            llvm::dwarf::Tag member_tag) {
-  StructMemberInfo member_info;
+StatusOr<const DwarfReader::StructMembers*> DwarfReader::GetStructMembers(
+    std::string_view struct_name, llvm::dwarf::Tag tag, llvm::dwarf::Tag member_tag) {
+  auto key = std::make_tuple(std::string(struct_name), tag, member_tag);
+  auto iter = struct_members_.find(key);
+  if (iter != struct_members_.end()) {
+    return &iter->second;
+  }
 
   PL_ASSIGN_OR_RETURN(std::vector<DWARFDie> dies, GetMatchingDIEs(struct_name, {tag}));
 
@@ -664,24 +828,57 @@ StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfo(std::string_view str
                            magic_enum::enum_name(tag));
   }
 
+  // Resolve all the members in one pass over the struct. If members share a name, the first wins.
+  StructMembers members;
   for (const auto& die : GetChildDIEs(*struct_def_die, member_tag)) {
     PL_ASSIGN_OR(std::string die_name, GetDieName(die), continue);
-
-    if (die_name != member_name) {
+    if (members.contains(die_name)) {
       continue;
     }
+    members.emplace(std::move(die_name), GetMemberInfo(die));
+  }
+
+  return &struct_members_.emplace(std::move(key), std::move(members)).first->second;
+}
+
+StatusOr<StructMemberInfo> DwarfReader::GetStructMemberInfo(std::string_view struct_name,
+                                                            llvm::dwarf::Tag tag,
+                                                            std::string_view member_name,
+                                                            llvm::dwarf::Tag member_tag) {
+  PL_ASSIGN_OR_RETURN(const StructMembers* members,
+                      GetStructMembers(struct_name, tag, member_tag));
 
-    PL_ASSIGN_OR_RETURN(member_info.offset, GetMemberOffset(die));
-    PL_ASSIGN_OR_RETURN(DWARFDie type_die, GetTypeDie(die));
-    PL_ASSIGN_OR_RETURN(member_info.type_info, GetTypeInfo(die, type_die));
-    return member_info;
+  auto iter = members->find(member_name);
+  if (iter == members->end()) {
+    return error::Internal("Could not find member $0 in struct $1.", member_name, struct_name);
   }
+  return iter->second;
+}
 
-  return error::Internal("Could not find member $0 in struct $1.", member_name, struct_name);
+StatusOr<std::vector<StructMemberInfo>> DwarfReader::GetStructMemberInfos(
+    std::string_view struct_name, llvm::dwarf::Tag tag,
+    const std::vector<std::string_view>& member_names, llvm::dwarf::Tag member_tag) {
+  PL_ASSIGN_OR_RETURN(const StructMembers* members,
+                      GetStructMembers(struct_name, tag, member_tag));
+
+  std::vector<StructMemberInfo> member_infos;
+  member_infos.reserve(member_names.size());
+  for (std::string_view member_name : member_names) {
+    auto iter = members->find(member_name);
+    if (iter == members->end()) {
+      return error::Internal("Could not find member $0 in struct $1.", member_name, struct_name);
+    }
+    PL_ASSIGN_OR_RETURN(StructMemberInfo member_info, iter->second);
+    member_infos.push_back(std::move(member_info));
+  }
+  return member_infos;
 }
 
 StatusOr<std::vector<StructSpecEntry>> DwarfReader::GetStructSpec(std::string_view struct_name) {
-  StructMemberInfo member_info;
+  auto iter = struct_specs_.find(struct_name);
+  if (iter != struct_specs_.end()) {
+    return iter->second;
+  }
 
   PL_ASSIGN_OR_RETURN(const DWARFDie& struct_die,
                       GetMatchingDIE(struct_name, llvm::dwarf::DW_TAG_structure_type));
@@ -692,6 +889,7 @@ StatusOr<std::vector<StructSpecEntry>> DwarfReader::GetStructSpec(std::string_vi
   int offset = 0;
   PL_RETURN_IF_ERROR(FlattenedStructSpec(struct_die, &output, path_prefix, offset));
 
+  struct_specs_.emplace(struct_name, output);
   return output;
 }
 
@@ -729,7 +927,7 @@ Status DwarfReader::FlattenedStructSpec(const llvm::DWARFDie& struct_die,
   return Status::OK();
 }
 
-void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::DWARFDie die) {
+void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, uint64_t die_offset) {
   auto& die_type_map = die_map_[tag];
   // TODO(oazizi): What's the right way to deal with duplicate names?
   // Only appears to happen with structs like the following:
@@ -738,7 +936,7 @@ void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::D
   if (die_type_map.find(name) != die_type_map.end()) {
     return;
   }
-  die_type_map[name] = die;
+  die_type_map[name] = die_offset;
 }
 
 std::optional<llvm::DWARFDie> DwarfReader::FindInDIEMap(const std::string& name,
@@ -752,7 +950,12 @@ std::optional<llvm::DWARFDie> DwarfReader::FindInDIEMap(const std::string& name,
   if (die_iter == die_type_map.end()) {
     return std::nullopt;
   }
-  return die_iter->second;
+  // An index read from disk may be stale or corrupt, so check that the offset holds a DIE.
+  DWARFDie die = dwarf_context_->getDIEForOffset(die_iter->second);
+  if (!die.isValid() || die.getTag() != tag) {
+    return std::nullopt;
+  }
+  return die;
 }
 
 StatusOr<TypeInfo> DwarfReader::DereferencePointerType(std::string type_name) {
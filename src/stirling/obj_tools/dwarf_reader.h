@@ -28,6 +28,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,8 @@
 #include "src/stirling/obj_tools/abi_model.h"
 #include "src/stirling/obj_tools/utils.h"
 
+DECLARE_string(stirling_dwarf_index_dir);
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -150,7 +153,10 @@ class DwarfReader {
   /**
    * Creates a DwarfReader that provides access to DWARF Debugging information entries (DIEs).
    * @param obj_filename The object file from which to read DWARF information.
-   * @param index If true, creates an index to speed up accesses when called more than once.
+   *
+   * The indexing variants index DIEs by name, to speed up accesses when called more than once.
+   * The index is built on the first indexed lookup, not at creation. A full index is kept in
+   * --stirling_dwarf_index_dir, keyed by build-id, so that it is built once per binary.
    * @return error if file does not exist or is not a valid object file. Otherwise returns
    * a unique pointer to a DwarfReader.
    */
@@ -193,6 +199,14 @@ class DwarfReader {
                                                  std::string_view member_name,
                                                  llvm::dwarf::Tag member_tag);
 
+  /**
+   * Like GetStructMemberInfo, for several members of the same struct, returned in the order of
+   * member_names. Returns an error if any of the members is not found.
+   */
+  StatusOr<std::vector<StructMemberInfo>> GetStructMemberInfos(
+      std::string_view struct_name, llvm::dwarf::Tag tag,
+      const std::vector<std::string_view>& member_names, llvm::dwarf::Tag member_tag);
+
   /**
    * Returns the offset of a member within a struct.
    * @param struct_name Full name of the struct.
@@ -301,6 +315,9 @@ class DwarfReader {
   // Detects the source language of the dwarf content being read.
   Status DetectSourceLanguage();
 
+  // Builds the index on first use, or reads it from --stirling_dwarf_index_dir.
+  void EnsureIndexed();
+
   // Builds an index for certain commonly used DIE types (e.g. structs and functions).
   // When making multiple DwarfReader calls, this speeds up the process at the cost of some memory.
   //
@@ -308,13 +325,26 @@ class DwarfReader {
   // Otherwise, only the ones whose names match are indexed.
   void IndexDIEs(const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt);
 
+  // Reads or writes die_map_ in the file format of --stirling_dwarf_index_dir.
+  Status ReadIndex(const std::filesystem::path& path);
+  Status WriteIndex(const std::filesystem::path& path) const;
+
   // Walks the struct_die for all members, recursively visiting any members which are also structs,
   // to capture information of all base type members of the struct in a flattened form.
   // See GetStructSpec() for the public interface, and the output format.
   Status FlattenedStructSpec(const llvm::DWARFDie& struct_die, std::vector<StructSpecEntry>* output,
                              const std::string& path_prefix, int offset);
 
-  void InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::DWARFDie die);
+  // The members of a struct DIE, by name.
+  using StructMembers = absl::flat_hash_map<std::string, StatusOr<StructMemberInfo>>;
+
+  // Returns all the members of a struct. The struct's DIE is walked on the first call, and the
+  // result is kept for later calls.
+  StatusOr<const StructMembers*> GetStructMembers(std::string_view struct_name,
+                                                  llvm::dwarf::Tag tag,
+                                                  llvm::dwarf::Tag member_tag);
+
+  void InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, uint64_t die_offset);
   std::optional<llvm::DWARFDie> FindInDIEMap(const std::string& name, llvm::dwarf::Tag tag) const;
 
   // Records the source language of the DWARF information.
@@ -326,8 +356,24 @@ class DwarfReader {
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer_;
   std::unique_ptr<llvm::DWARFContext> dwarf_context_;
 
-  // Nested map: [tag][symbol_name] -> DWARFDie
-  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+  std::string build_id_;
+
+  // Whether lookups go through die_map_, and which names it holds, if not all of them.
+  bool indexing_ = false;
+  std::optional<std::vector<SymbolSearchPattern>> index_patterns_;
+  bool index_built_ = false;
+
+  // Nested map: [tag][symbol_name] -> DIE offset in .debug_info.
+  // DIEs are looked up by offset, which only parses the compile unit that holds them.
+  // Empty until the first indexed lookup.
+  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, uint64_t>> die_map_;
+
+  // Type lookups already answered. A tracepoint program looks up the same structs many times:
+  // once for each field accessed through them, in each of its probes.
+  // Key for struct_members_: [struct_name, tag, member_tag].
+  absl::flat_hash_map<std::tuple<std::string, llvm::dwarf::Tag, llvm::dwarf::Tag>, StructMembers>
+      struct_members_;
+  absl::flat_hash_map<std::string, std::vector<StructSpecEntry>> struct_specs_;
 };
 
 }  // namespace obj_tools
@@ -19,6 +19,7 @@
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
@@ -105,5 +106,35 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
+// Like BM_indexed, but with the index read from --stirling_dwarf_index_dir, as it is after the
+// first time a binary is seen.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_indexed_persisted(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+
+  px::testing::TempDir index_dir;
+  FLAGS_stirling_dwarf_index_dir = index_dir.path().string();
+  DEFER(FLAGS_stirling_dwarf_index_dir = "");
+  {
+    SymAddrs symaddrs;
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateIndexingAll(kBinary));
+    GetSymAddrs(dwarf_reader.get(), &symaddrs);
+  }
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateIndexingAll(kBinary));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+  }
+}
+
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_indexed_persisted)->RangeMultiplier(2)->Range(1, 16);
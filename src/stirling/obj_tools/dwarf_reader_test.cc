@@ -18,6 +18,7 @@
 
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
+#include "src/common/base/file.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
 
@@ -87,6 +88,52 @@ TEST_F(DwarfReaderTest, NonExistentPath) {
   ASSERT_NOT_OK(s);
 }
 
+TEST_F(DwarfReaderTest, PersistedIndex) {
+  px::testing::TempDir index_dir;
+  const std::string orig_index_dir = FLAGS_stirling_dwarf_index_dir;
+  DEFER(FLAGS_stirling_dwarf_index_dir = orig_index_dir);
+  FLAGS_stirling_dwarf_index_dir = index_dir.path().string();
+
+  auto index_files = [&index_dir]() {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(index_dir.path())) {
+      files.push_back(entry.path());
+    }
+    return files;
+  };
+
+  // The first indexed lookup builds the index and writes it out.
+  {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::CreateIndexingAll(kCppBinaryPath));
+    EXPECT_THAT(index_files(), IsEmpty());
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("ABCStruct32"), 12);
+  }
+  ASSERT_THAT(index_files(), SizeIs(1));
+  const std::filesystem::path index_path = index_files().front();
+  EXPECT_EQ(index_path.extension(), ".dwidx");
+
+  // Later readers use the index from disk.
+  {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::CreateIndexingAll(kCppBinaryPath));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("ABCStruct64"), 24);
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructMemberOffset("ABCStruct32", "b"), 4);
+    EXPECT_OK_AND_THAT(dwarf_reader->GetFunctionArgInfo("CanYouFindThis"), SizeIs(2));
+    EXPECT_NOT_OK(dwarf_reader->GetStructByteSize("Bogus"));
+  }
+
+  // A corrupt index is rebuilt.
+  ASSERT_OK(WriteFileFromString(index_path, "PXDWIDX1garbage"));
+  {
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                         DwarfReader::CreateIndexingAll(kCppBinaryPath));
+    EXPECT_OK_AND_EQ(dwarf_reader->GetStructByteSize("ABCStruct32"), 12);
+  }
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(index_path));
+  EXPECT_NE(contents, "PXDWIDX1garbage");
+}
+
 TEST_F(DwarfReaderTest, SourceLanguage) {
   {
     ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
@@ -193,6 +240,30 @@ TEST_P(DwarfReaderTest, CppGetStructMemberInfo) {
                                                   "bogus", llvm::dwarf::DW_TAG_member));
 }
 
+TEST_P(DwarfReaderTest, CppGetStructMemberInfos) {
+  DwarfReaderTestParam p = GetParam();
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
+                       CreateDwarfReader(kCppBinaryPath, p.index));
+
+  EXPECT_OK_AND_THAT(
+      dwarf_reader->GetStructMemberInfos("ABCStruct32", llvm::dwarf::DW_TAG_structure_type,
+                                         {"c", "a", "b"}, llvm::dwarf::DW_TAG_member),
+      ElementsAre(StructMemberInfo{8, TypeInfo{VarType::kBaseType, "int"}},
+                  StructMemberInfo{0, TypeInfo{VarType::kBaseType, "int"}},
+                  StructMemberInfo{4, TypeInfo{VarType::kBaseType, "int"}}));
+  EXPECT_NOT_OK(dwarf_reader->GetStructMemberInfos("ABCStruct32",
+                                                   llvm::dwarf::DW_TAG_structure_type,
+                                                   {"a", "bogus"}, llvm::dwarf::DW_TAG_member));
+
+  // Later lookups are answered from the members resolved above, and must agree with them.
+  EXPECT_OK_AND_EQ(
+      dwarf_reader->GetStructMemberInfo("ABCStruct32", llvm::dwarf::DW_TAG_structure_type, "b",
+                                        llvm::dwarf::DW_TAG_member),
+      (StructMemberInfo{4, TypeInfo{VarType::kBaseType, "int"}}));
+  EXPECT_NOT_OK(dwarf_reader->GetStructMemberInfo("ABCStruct32", llvm::dwarf::DW_TAG_structure_type,
+                                                  "bogus", llvm::dwarf::DW_TAG_member));
+}
+
 TEST_P(DwarfReaderTest, Go1_16GetStructMemberInfo) {
   DwarfReaderTestParam p = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
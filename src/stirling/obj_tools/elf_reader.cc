@@ -44,8 +44,54 @@ struct LowercaseHex {
   static inline constexpr int kSizePerByte = 2;
   static inline constexpr bool kKeepPrintableChars = false;
 };
+
+// Returns the build-id in a .note.gnu.build-id section.
+std::string ReadBuildID(const ELFIO::section* psec) {
+  // Structure of this section:
+  //    namesz :   32-bit, size of "name" field
+  //    descsz :   32-bit, size of "desc" field
+  //    type   :   32-bit, vendor specific "type"
+  //    name   :   "namesz" bytes, null-terminated string
+  //    desc   :   "descsz" bytes, binary data
+  int32_t name_size =
+      utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
+  int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
+      std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
+
+  int32_t desc_pos = 3 * sizeof(int32_t) + name_size;
+  std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
+
+  return BytesToString<LowercaseHex>(desc);
+}
+
+constexpr std::string_view kBuildIDSectionName = ".note.gnu.build-id";
+constexpr std::string_view kGoBuildIDSectionName = ".note.go.buildid";
+
 }  // namespace
 
+std::string ElfReader::BuildID() {
+  ELFIO::Elf_Half sec_num = elf_reader_.sections.size();
+  for (int i = 0; i < sec_num; ++i) {
+    const ELFIO::section* psec = elf_reader_.sections[i];
+    if (psec->get_name() == kBuildIDSectionName) {
+      return ReadBuildID(psec);
+    }
+  }
+  return "";
+}
+
+std::string ElfReader::GoBuildID() {
+  ELFIO::Elf_Half sec_num = elf_reader_.sections.size();
+  for (int i = 0; i < sec_num; ++i) {
+    const ELFIO::section* psec = elf_reader_.sections[i];
+    // The Go note has the same layout as the GNU build-id note.
+    if (psec->get_name() == kGoBuildIDSectionName) {
+      return ReadBuildID(psec);
+    }
+  }
+  return "";
+}
+
 Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir) {
   std::string build_id;
   std::string debug_link;
@@ -65,22 +111,8 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
     // For more details: https://sourceware.org/gdb/onlinedocs/gdb/Separate-Debug-Files.html
 
     // Method 1: build-id.
-    if (psec->get_name() == ".note.gnu.build-id") {
-      // Structure of this section:
-      //    namesz :   32-bit, size of "name" field
-      //    descsz :   32-bit, size of "desc" field
-      //    type   :   32-bit, vendor specific "type"
-      //    name   :   "namesz" bytes, null-terminated string
-      //    desc   :   "descsz" bytes, binary data
-      int32_t name_size =
-          utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
-      int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
-          std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
-
-      int32_t desc_pos = 3 * sizeof(int32_t) + name_size;
-      std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
-
-      build_id = BytesToString<LowercaseHex>(desc);
+    if (psec->get_name() == kBuildIDSectionName) {
+      build_id = ReadBuildID(psec);
       VLOG(1) << absl::Substitute("Found build-id: $0", build_id);
     }
 
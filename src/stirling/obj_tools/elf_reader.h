@@ -50,6 +50,18 @@ class ElfReader {
 
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
+  /**
+   * Returns the build-id of the binary, as a lowercase hex string,
+   * or an empty string if the binary has no .note.gnu.build-id section.
+   */
+  std::string BuildID();
+
+  /**
+   * Returns the Go build ID of the binary, hex encoded,
+   * or an empty string if the binary has no .note.go.buildid section.
+   */
+  std::string GoBuildID();
+
   struct SymbolInfo {
     std::string name;
     int type = -1;
@@ -131,12 +143,15 @@ class ElfReader {
      */
     std::string_view Lookup(uintptr_t addr) const;
 
-   private:
     struct SymbolAddrInfo {
       size_t size;
       std::string name;
     };
 
+    // Returns the entries, keyed and sorted by address.
+    const absl::btree_map<uintptr_t, SymbolAddrInfo>& entries() const { return symbols_; }
+
+   private:
     // Key is an address.
     absl::btree_map<uintptr_t, SymbolAddrInfo> symbols_;
   };
@@ -34,6 +34,7 @@ using ::px::stirling::obj_tools::SymbolMatchType;
 using ::testing::ElementsAre;
 using ::testing::Field;
 using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::Pair;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
@@ -201,6 +202,28 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, BuildID) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(stripped_bin));
+
+  // Matches the path of the debug symbols in testdata/cc/usr/lib/debug/.build-id.
+  EXPECT_EQ(elf_reader->BuildID(), "7deb0e3f89deba61");
+}
+
+TEST(ElfReaderTest, GoBuildID) {
+  const std::string go_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/go/test_go_1_16_binary");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> go_elf_reader, ElfReader::Create(go_bin));
+  EXPECT_THAT(go_elf_reader->GoBuildID(), Not(IsEmpty()));
+
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(stripped_bin));
+  EXPECT_EQ(elf_reader->GoBuildID(), "");
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
@@ -23,7 +23,10 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <algorithm>
+#include <iterator>
 #include <map>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
@@ -173,12 +176,28 @@ Status DynamicTraceConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
 
-  PL_RETURN_IF_ERROR(InitBPFProgram(bcc_program_.code));
+  std::vector<std::string> cflags;
+  if (bcc_program_.uses_shared_perf_buffer) {
+    // The shared perf buffer must exist before the program that declares it as extern is compiled.
+    PL_ASSIGN_OR_RETURN(shared_perf_buffer_, SharedPerfBuffer::Get());
+    shared_perf_buffer_tag_ = shared_perf_buffer_->Register([this](std::string data) {
+      absl::MutexLock lock(&shared_data_items_lock_);
+      shared_data_items_.push_back(std::move(data));
+    });
+    cflags.push_back(absl::Substitute("-D$0=$1ULL", dynamic_tracing::kTracepointTagMacro,
+                                      shared_perf_buffer_tag_));
+  }
+
+  PL_RETURN_IF_ERROR(InitBPFProgram(bcc_program_.code, std::move(cflags)));
 
   for (const auto& uprobe_spec : bcc_program_.uprobe_specs) {
     PL_RETURN_IF_ERROR(AttachUProbe(uprobe_spec));
   }
 
+  if (shared_perf_buffer_ != nullptr) {
+    return Status::OK();
+  }
+
   // TODO(yzhao/oazizi): Might need to change this if we need to support multiple perf buffers.
   bpf_tools::PerfBufferSpec spec = {
       .name = bcc_program_.perf_buffer_specs.front().name,
@@ -191,6 +210,13 @@ Status DynamicTraceConnector::InitImpl() {
   return Status::OK();
 }
 
+void DynamicTraceConnector::UnregisterFromSharedPerfBuffer() {
+  if (shared_perf_buffer_ != nullptr) {
+    shared_perf_buffer_->Unregister(shared_perf_buffer_tag_);
+    shared_perf_buffer_ = nullptr;
+  }
+}
+
 namespace {
 
 // Parses the content of the input bytes based on the schema in the StructSpec,
@@ -495,7 +521,15 @@ void DynamicTraceConnector::TransferDataImpl(ConnectorContext* ctx,
     return;
   }
 
-  PollPerfBuffers();
+  if (shared_perf_buffer_ != nullptr) {
+    shared_perf_buffer_->Poll();
+    absl::MutexLock lock(&shared_data_items_lock_);
+    std::move(shared_data_items_.begin(), shared_data_items_.end(),
+              std::back_inserter(data_items_));
+    shared_data_items_.clear();
+  } else {
+    PollPerfBuffers();
+  }
 
   for (const auto& item : data_items_) {
     // TODO(yzhao): Right now only support scalar types. We should replace type with ScalarType
@@ -24,10 +24,13 @@
 #include <utility>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/common/base/base.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/dynamic_tracer.h"
+#include "src/stirling/source_connectors/dynamic_tracer/shared_perf_buffer.h"
 
 namespace px {
 namespace stirling {
@@ -37,7 +40,7 @@ class DynamicTraceConnector : public SourceConnector, public bpf_tools::BCCWrapp
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{100};
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
 
-  ~DynamicTraceConnector() override = default;
+  ~DynamicTraceConnector() override { UnregisterFromSharedPerfBuffer(); }
 
   static StatusOr<std::unique_ptr<SourceConnector>> Create(
       std::string_view name, dynamic_tracing::ir::logical::TracepointDeployment* program);
@@ -59,9 +62,14 @@ class DynamicTraceConnector : public SourceConnector, public bpf_tools::BCCWrapp
 
   void TransferDataImpl(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables) override;
 
-  Status StopImpl() override { return Status::OK(); }
+  Status StopImpl() override {
+    UnregisterFromSharedPerfBuffer();
+    return Status::OK();
+  }
 
  private:
+  void UnregisterFromSharedPerfBuffer();
+
   Status AppendRecord(const ::px::stirling::dynamic_tracing::ir::physical::Struct& st,
                       uint32_t asid, std::string_view buf, DataTable* data_table);
 
@@ -73,6 +81,13 @@ class DynamicTraceConnector : public SourceConnector, public bpf_tools::BCCWrapp
 
   // A buffer to hold raw data items from the perf buffer.
   std::deque<std::string> data_items_;
+
+  // Set if the program writes to the shared perf buffer. Its events may be read by the connector
+  // of another tracepoint, on another thread, so they are queued in shared_data_items_ first.
+  SharedPerfBuffer* shared_perf_buffer_ = nullptr;
+  uint64_t shared_perf_buffer_tag_ = 0;
+  absl::Mutex shared_data_items_lock_;
+  std::deque<std::string> shared_data_items_ ABSL_GUARDED_BY(shared_data_items_lock_);
 };
 
 // Converts proto specification of columns into the form that is used by TableSchema.
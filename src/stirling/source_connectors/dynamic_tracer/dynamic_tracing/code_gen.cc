@@ -579,13 +579,19 @@ std::string GenMapDeleteAction(const MapDeleteAction& action) {
 }
 
 std::string GenPerfBufferOutput(const PerfBufferOutput& output) {
+  if (!output.shared_perf_buffer_name().empty()) {
+    // Refers to the perf buffer exported by the program that owns it.
+    return absl::Substitute("BPF_TABLE(\"extern\", int, u32, $0, 0);",
+                            output.shared_perf_buffer_name());
+  }
   return absl::Substitute("BPF_PERF_OUTPUT($0);", output.name());
 }
 
 namespace {
 
 StatusOr<std::vector<std::string>> GenPerfBufferOutputAction(
-    const ir::physical::Struct& output_struct, const PerfBufferOutputAction& action) {
+    const ir::physical::Struct& output_struct, const PerfBufferOutputAction& action,
+    std::string_view shared_perf_buffer_name) {
   std::string output_var_name = absl::StrCat(action.perf_buffer_name(), "_value");
 
   std::vector<std::string> code_lines;
@@ -604,8 +610,15 @@ StatusOr<std::vector<std::string>> GenPerfBufferOutputAction(
                                           output_struct.fields(struct_field_index++).name(), f));
   }
 
-  code_lines.push_back(absl::Substitute("$0.perf_submit(ctx, $1, sizeof(*$1));",
-                                        action.perf_buffer_name(), output_var_name));
+  if (!shared_perf_buffer_name.empty()) {
+    // An extern table has no perf_submit(), so the helper is called with the table directly.
+    code_lines.push_back(absl::Substitute(
+        "bpf_perf_event_output(ctx, &$0, BPF_F_CURRENT_CPU, $1, sizeof(*$1));",
+        shared_perf_buffer_name, output_var_name));
+  } else {
+    code_lines.push_back(absl::Substitute("$0.perf_submit(ctx, $1, sizeof(*$1));",
+                                          action.perf_buffer_name(), output_var_name));
+  }
 
   return code_lines;
 }
@@ -857,7 +870,14 @@ StatusOr<std::vector<std::string>> BCCCodeGenerator::GenerateProbe(const Probe&
     if (iter == structs_.end()) {
       return error::InvalidArgument("Output struct '$0' is undefined", action.output_struct_name());
     }
-    MOVE_BACK_STR_VEC(GenPerfBufferOutputAction(*iter->second, action), &code_lines);
+    std::string_view shared_perf_buffer_name;
+    for (const auto& output : program_.outputs()) {
+      if (output.name() == action.perf_buffer_name()) {
+        shared_perf_buffer_name = output.shared_perf_buffer_name();
+      }
+    }
+    MOVE_BACK_STR_VEC(GenPerfBufferOutputAction(*iter->second, action, shared_perf_buffer_name),
+                      &code_lines);
   }
 
   for (const auto& printk : probe.printks()) {
@@ -1026,7 +1046,13 @@ StatusOr<std::vector<std::string>> BCCCodeGenerator::GenerateCodeLines() {
     MoveBackStrVec(GenGOID(), &code_lines);
   }
 
+  absl::flat_hash_set<std::string_view> shared_perf_buffers;
   for (const auto& output : program_.outputs()) {
+    // Several outputs may write to the same shared perf buffer, which is only declared once.
+    if (!output.shared_perf_buffer_name().empty() &&
+        !shared_perf_buffers.insert(output.shared_perf_buffer_name()).second) {
+      continue;
+    }
     code_lines.push_back(GenPerfBufferOutput(output));
   }
 
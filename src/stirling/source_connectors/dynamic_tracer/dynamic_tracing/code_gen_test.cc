@@ -18,6 +18,8 @@
 
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/code_gen.h"
 
+#include <algorithm>
+
 #include <google/protobuf/text_format.h>
 
 #include "src/common/testing/testing.h"
@@ -38,8 +40,11 @@ using ::px::stirling::dynamic_tracing::ir::physical::Struct;
 using ::px::stirling::dynamic_tracing::ir::physical::StructVariable;
 using ::px::stirling::dynamic_tracing::ir::shared::BPFHelper;
 using ::px::stirling::dynamic_tracing::ir::shared::ScalarType;
+using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+using ::testing::Not;
 using ::testing::StrEq;
 
 TEST(GenStructTest, Output) {
@@ -475,6 +480,69 @@ TEST(GenProgramTest, SpecsAndCode) {
   EXPECT_THAT(bcc_code_lines, ElementsAreArray(expected_code_lines));
 }
 
+TEST(GenProgramTest, SharedPerfBuffer) {
+  const std::string program_protobuf = R"proto(
+                                       deployment_spec {
+                                         path: "target_binary_path"
+                                       }
+                                       structs {
+                                         name: "out_t"
+                                         fields {
+                                           name: "i32"
+                                           type: INT32
+                                         }
+                                       }
+                                       arrays {
+                                         name: "out_array"
+                                         type { struct_type: "out_t" }
+                                         capacity: 1
+                                       }
+                                       outputs {
+                                          name: "out"
+                                          struct_type: "out_t"
+                                          shared_perf_buffer_name: "shared"
+                                       }
+                                       outputs {
+                                          name: "out2"
+                                          struct_type: "out_t"
+                                          shared_perf_buffer_name: "shared"
+                                       }
+                                       probes {
+                                         name: "probe_entry"
+                                         tracepoint {
+                                           symbol: "target_symbol"
+                                           type: ENTRY
+                                         }
+                                         vars {
+                                           scalar_var {
+                                             name: "var"
+                                             type: INT32
+                                             reg: SP
+                                           }
+                                         }
+                                         output_actions {
+                                           perf_buffer_name: "out"
+                                           data_buffer_array_name: "out_array"
+                                           output_struct_name: "out_t"
+                                           variable_names: "var"
+                                         }
+                                       }
+                                       )proto";
+
+  ir::physical::Program program;
+  ASSERT_TRUE(TextFormat::ParseFromString(program_protobuf, &program));
+
+  ASSERT_OK_AND_ASSIGN(const std::string bcc_code, GenBCCProgram(program));
+  std::vector<std::string> bcc_code_lines = absl::StrSplit(bcc_code, "\n");
+  // The shared perf buffer is only declared once.
+  EXPECT_EQ(std::count(bcc_code_lines.begin(), bcc_code_lines.end(),
+                       R"(BPF_TABLE("extern", int, u32, shared, 0);)"),
+            1);
+  EXPECT_THAT(bcc_code_lines, Contains("bpf_perf_event_output(ctx, &shared, BPF_F_CURRENT_CPU, "
+                                       "out_value, sizeof(*out_value));"));
+  EXPECT_THAT(bcc_code_lines, Not(Contains(HasSubstr("perf_submit"))));
+}
+
 }  // namespace dynamic_tracing
 }  // namespace stirling
 }  // namespace px
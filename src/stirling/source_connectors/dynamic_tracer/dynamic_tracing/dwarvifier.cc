@@ -650,11 +650,14 @@ Status Dwarvifier::ProcessGolangInterfaceExpr(const std::string& base, uint64_t
   constexpr char kIfaceTabSuffix[] = "_intf_tab";
   constexpr char kIfaceDataSuffix[] = "_intf_data";
 
+  PL_ASSIGN_OR_RETURN(std::vector<StructMemberInfo> iface_mem_infos,
+                      dwarf_reader_->GetStructMemberInfos(kGolangInterfaceTypeName,
+                                                          llvm::dwarf::DW_TAG_structure_type,
+                                                          {"tab", "data"},
+                                                          llvm::dwarf::DW_TAG_member));
+
   // Used to determine the implementation type.
-  PL_ASSIGN_OR_RETURN(const StructMemberInfo tab_mem_info,
-                      dwarf_reader_->GetStructMemberInfo(kGolangInterfaceTypeName,
-                                                         llvm::dwarf::DW_TAG_structure_type, "tab",
-                                                         llvm::dwarf::DW_TAG_member));
+  const StructMemberInfo& tab_mem_info = iface_mem_infos[0];
 
   std::string iface_tab_var_name = absl::StrCat(var_name, kIfaceTabSuffix);
   ir::physical::ScalarVariable* iface_tab_var =
@@ -664,10 +667,7 @@ Status Dwarvifier::ProcessGolangInterfaceExpr(const std::string& base, uint64_t
   iface_tab_var->mutable_memory()->set_offset(offset + tab_mem_info.offset);
 
   // Used to copy the content of the implementation variable.
-  PL_ASSIGN_OR_RETURN(const StructMemberInfo data_mem_info,
-                      dwarf_reader_->GetStructMemberInfo(kGolangInterfaceTypeName,
-                                                         llvm::dwarf::DW_TAG_structure_type, "data",
-                                                         llvm::dwarf::DW_TAG_member));
+  const StructMemberInfo& data_mem_info = iface_mem_infos[1];
 
   std::string iface_data_var_name = absl::StrCat(var_name, kIfaceDataSuffix);
   ir::physical::ScalarVariable* iface_data_var = AddVariable<ScalarVariable>(
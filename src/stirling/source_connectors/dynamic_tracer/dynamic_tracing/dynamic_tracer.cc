@@ -20,11 +20,15 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/system.h"
 
@@ -39,9 +43,14 @@
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/dwarvifier.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/ir/sharedpb/shared.pb.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/probe_transformer.h"
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/program_cache.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
 DEFINE_bool(debug_dt_pipeline, false, "Enable logging of the Dynamic Tracing pipeline IR graphs.");
+DEFINE_bool(stirling_dynamic_trace_shared_perf_buffer,
+            gflags::BoolFromEnv("PL_STIRLING_DYNAMIC_TRACE_SHARED_PERF_BUFFER", false),
+            "If true, the BPF programs of all dynamic tracepoints write their events to one shared "
+            "perf buffer, rather than each opening perf buffers of its own.");
 
 namespace px {
 namespace stirling {
@@ -95,22 +104,71 @@ StatusOr<BCCProgram::PerfBufferSpec> GetPerfBufferSpec(
   return pf_spec;
 }
 
+// Makes the outputs of the program write to kSharedPerfBufferName. The tracepoint tag is added as
+// the first field of their structs, which are packed, so the rest of an event is laid out as it
+// would be without the tag.
+void UseSharedPerfBuffer(ir::physical::Program* program) {
+  constexpr char kTagVarName[] = "tracepoint_tag";
+
+  absl::flat_hash_set<std::string> output_names;
+  absl::flat_hash_set<std::string> struct_names;
+  for (auto& output : *program->mutable_outputs()) {
+    output.set_shared_perf_buffer_name(kSharedPerfBufferName);
+    output_names.insert(output.name());
+    struct_names.insert(output.struct_type());
+  }
+
+  for (auto& st : *program->mutable_structs()) {
+    if (!struct_names.contains(st.name())) {
+      continue;
+    }
+    auto* fields = st.mutable_fields();
+    auto* tag = fields->Add();
+    tag->set_name(kTagVarName);
+    tag->set_type(ir::shared::ScalarType::UINT64);
+    // Move the tag to the front.
+    for (int i = fields->size() - 1; i > 0; --i) {
+      fields->SwapElements(i, i - 1);
+    }
+  }
+
+  for (auto& probe : *program->mutable_probes()) {
+    bool outputs = false;
+    for (auto& action : *probe.mutable_output_actions()) {
+      if (!output_names.contains(action.perf_buffer_name())) {
+        continue;
+      }
+      outputs = true;
+      auto* names = action.mutable_variable_names();
+      names->Add(kTagVarName);
+      for (int i = names->size() - 1; i > 0; --i) {
+        names->SwapElements(i, i - 1);
+      }
+    }
+    if (!outputs) {
+      continue;
+    }
+    auto* vars = probe.mutable_vars();
+    auto* tag = vars->Add()->mutable_scalar_var();
+    tag->set_name(kTagVarName);
+    tag->set_type(ir::shared::ScalarType::UINT64);
+    tag->set_constant(kTracepointTagMacro);
+    for (int i = vars->size() - 1; i > 0; --i) {
+      vars->SwapElements(i, i - 1);
+    }
+  }
+}
+
 // Return value for Prepare(), so we can return multiple pointers.
 struct ObjInfo {
   std::unique_ptr<ElfReader> elf_reader;
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
-// Prepares the input program for compilation by:
-// 1) Resolving the tracepoint target specification into an object path (e.g. UPID->path).
-// 2) Preparing the Elf and Dwarf info for the binary.
-StatusOr<ObjInfo> Prepare(const ir::logical::TracepointDeployment& input_program) {
+// Prepares the Dwarf info for the binary, to go with its already opened Elf info.
+ObjInfo Prepare(std::unique_ptr<ElfReader> elf_reader) {
   ObjInfo obj_info;
-
-  const auto& binary_path = input_program.deployment_spec().path();
-  LOG(INFO) << absl::Substitute("Tracepoint binary: $0", binary_path);
-
-  PL_ASSIGN_OR_RETURN(obj_info.elf_reader, ElfReader::Create(binary_path));
+  obj_info.elf_reader = std::move(elf_reader);
 
   const auto& debug_symbols_path = obj_info.elf_reader->debug_symbols_path().string();
 
@@ -132,8 +190,25 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
                                   input_program->tracepoints_size());
   }
 
+  const auto& binary_path = input_program->deployment_spec().path();
+  LOG(INFO) << absl::Substitute("Tracepoint binary: $0", binary_path);
+
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary_path));
+
+  // Reuse an earlier compilation of this program for the same binary, if there is one. Indexing
+  // the DWARF info below is the bulk of the cost of compiling.
+  const std::string cache_key = ProgramCache::Key(elf_reader->BuildID(), *input_program);
+  if (!cache_key.empty()) {
+    std::optional<BCCProgram> cached = GlobalProgramCache().Lookup(cache_key, input_program);
+    if (cached.has_value()) {
+      LOG(INFO) << absl::Substitute("Reusing compiled tracepoint program for binary: $0",
+                                    binary_path);
+      return std::move(cached.value());
+    }
+  }
+
   // Get the ELF and DWARF readers for the program.
-  PL_ASSIGN_OR_RETURN(ObjInfo obj_info, Prepare(*input_program));
+  ObjInfo obj_info = Prepare(std::move(elf_reader));
 
   // --------------------------
   // Pre-processing pipeline
@@ -167,8 +242,6 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
 
   LOG_IF(INFO, FLAGS_debug_dt_pipeline) << physical_program.DebugString();
 
-  PL_ASSIGN_OR_RETURN(std::string bcc_code, GenBCCProgram(physical_program));
-
   // --------------------------
   // Generate BCC Program Object
   // --------------------------
@@ -176,10 +249,28 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
   // TODO(oazizi): Move the code below into its own function.
 
   BCCProgram bcc_program;
-  bcc_program.code = std::move(bcc_code);
+
+  // The perf buffer specs describe the events as they are handed to the connector, which is
+  // without the tag of a shared perf buffer.
+  absl::flat_hash_map<std::string_view, const ir::physical::Struct*> structs;
+  for (const auto& st : physical_program.structs()) {
+    structs[st.name()] = &st;
+  }
+
+  for (const auto& output : physical_program.outputs()) {
+    PL_ASSIGN_OR_RETURN(BCCProgram::PerfBufferSpec pf_spec, GetPerfBufferSpec(structs, output));
+    bcc_program.perf_buffer_specs.push_back(std::move(pf_spec));
+  }
+
+  if (FLAGS_stirling_dynamic_trace_shared_perf_buffer) {
+    UseSharedPerfBuffer(&physical_program);
+    bcc_program.uses_shared_perf_buffer = true;
+    LOG_IF(INFO, FLAGS_debug_dt_pipeline) << physical_program.DebugString();
+  }
+
+  PL_ASSIGN_OR_RETURN(bcc_program.code, GenBCCProgram(physical_program));
 
   const ir::shared::Language& language = physical_program.language();
-  const std::string& binary_path = physical_program.deployment_spec().path();
 
   // TODO(yzhao): deployment_spec.upid will be lost after calling ResolveTargetObjPath().
   // Consider adjust data structure such that both can be preserved.
@@ -192,14 +283,8 @@ StatusOr<BCCProgram> CompileProgram(ir::logical::TracepointDeployment* input_pro
     }
   }
 
-  absl::flat_hash_map<std::string_view, const ir::physical::Struct*> structs;
-  for (const auto& st : physical_program.structs()) {
-    structs[st.name()] = &st;
-  }
-
-  for (const auto& output : physical_program.outputs()) {
-    PL_ASSIGN_OR_RETURN(BCCProgram::PerfBufferSpec pf_spec, GetPerfBufferSpec(structs, output));
-    bcc_program.perf_buffer_specs.push_back(std::move(pf_spec));
+  if (!cache_key.empty()) {
+    GlobalProgramCache().Insert(cache_key, *input_program, bcc_program);
   }
 
   return bcc_program;
@@ -24,6 +24,8 @@
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/ir/physicalpb/physical.pb.h"
 #include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/types.h"
 
+DECLARE_bool(stirling_dynamic_trace_shared_perf_buffer);
+
 namespace px {
 namespace stirling {
 namespace dynamic_tracing {
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/program_cache.h"
+
+#include <utility>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+DEFINE_uint32(stirling_dt_program_cache_size,
+              gflags::Uint32FromEnv("PL_STIRLING_DT_PROGRAM_CACHE_SIZE", 64),
+              "The number of compiled dynamic tracing programs to keep for reuse. "
+              "0 disables reuse.");
+
+namespace px {
+namespace stirling {
+namespace dynamic_tracing {
+
+std::string ProgramCache::Key(std::string_view build_id,
+                              const ir::logical::TracepointDeployment& program) {
+  if (build_id.empty()) {
+    return "";
+  }
+
+  ir::logical::TracepointDeployment keyed_program = program;
+  keyed_program.clear_deployment_spec();
+  keyed_program.clear_ttl();
+
+  // Deterministic, so that equal programs with maps always serialize the same way.
+  std::string key = absl::StrCat(build_id, "/");
+  {
+    google::protobuf::io::StringOutputStream string_stream(&key);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    keyed_program.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+std::optional<BCCProgram> ProgramCache::Lookup(const std::string& key,
+                                               ir::logical::TracepointDeployment* program) {
+  absl::MutexLock lock(&mu_);
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return std::nullopt;
+  }
+  Entry& entry = iter->second;
+  lru_.splice(lru_.begin(), lru_, entry.lru_iter);
+
+  ir::shared::DeploymentSpec deployment_spec = std::move(*program->mutable_deployment_spec());
+  google::protobuf::Duration ttl = std::move(*program->mutable_ttl());
+  *program = entry.program;
+  *program->mutable_deployment_spec() = std::move(deployment_spec);
+  *program->mutable_ttl() = std::move(ttl);
+
+  BCCProgram bcc_program = entry.bcc_program;
+  for (auto& spec : bcc_program.uprobe_specs) {
+    spec.binary_path = program->deployment_spec().path();
+  }
+  return bcc_program;
+}
+
+void ProgramCache::Insert(const std::string& key,
+                          const ir::logical::TracepointDeployment& compiled_program,
+                          const BCCProgram& bcc_program) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  absl::MutexLock lock(&mu_);
+  if (entries_.contains(key)) {
+    return;
+  }
+  if (entries_.size() >= capacity_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{compiled_program, bcc_program, lru_.begin()});
+}
+
+size_t ProgramCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+ProgramCache& GlobalProgramCache() {
+  static auto* cache = new ProgramCache(FLAGS_stirling_dt_program_cache_size);
+  return *cache;
+}
+
+}  // namespace dynamic_tracing
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/ir/logicalpb/logical.pb.h"
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/types.h"
+
+namespace px {
+namespace stirling {
+namespace dynamic_tracing {
+
+/**
+ * ProgramCache keeps the output of CompileProgram(), so that deploying a tracepoint to a binary it
+ * was already compiled for skips indexing the binary's DWARF info and generating the BPF code.
+ * This is common: a tracepoint on a deployment is compiled for each of its pods, which mostly run
+ * the same binary.
+ *
+ * Entries are keyed by the binary's build-id and the tracepoint program, without its deployment
+ * spec. The generated code does not depend on where the binary is or which process runs it, so a
+ * cached program only needs its probes pointed at the new binary's path.
+ *
+ * The cache lives in the tracer process, so all the programs in it were compiled on this kernel.
+ */
+class ProgramCache {
+ public:
+  explicit ProgramCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Returns the cache key for a program targeting a binary with the given build-id, or an empty
+   * string if the program should not be cached because the binary has no build-id. The program's
+   * deployment spec and TTL do not affect how it compiles, so they are not part of the key.
+   */
+  static std::string Key(std::string_view build_id,
+                         const ir::logical::TracepointDeployment& program);
+
+  /**
+   * On a hit, replaces *program with the cached compiled form of the program, keeping program's
+   * deployment spec and TTL, and returns the BCC program with its probes attached to program's
+   * binary.
+   */
+  std::optional<BCCProgram> Lookup(const std::string& key,
+                                   ir::logical::TracepointDeployment* program);
+
+  /**
+   * Adds a compiled program, evicting the least recently used one if the cache is full.
+   */
+  void Insert(const std::string& key, const ir::logical::TracepointDeployment& compiled_program,
+              const BCCProgram& bcc_program);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    ir::logical::TracepointDeployment program;
+    BCCProgram bcc_program;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  const size_t capacity_;
+
+  mutable absl::Mutex mu_;
+  // Most recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+};
+
+/**
+ * The cache used by CompileProgram(), sized by --stirling_dt_program_cache_size.
+ */
+ProgramCache& GlobalProgramCache();
+
+}  // namespace dynamic_tracing
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/program_cache.h"
+
+#include <string>
+
+#include <google/protobuf/text_format.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace dynamic_tracing {
+
+using ::px::testing::proto::EqualsProto;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+constexpr char kProgram[] = R"proto(
+  deployment_spec {
+    path: "/proc/123/root/app"
+  }
+  tracepoints {
+    program {
+      probes {
+        name: "probe0"
+        tracepoint {
+          symbol: "main.MustBeCached"
+          type: ENTRY
+        }
+      }
+    }
+  }
+)proto";
+
+ir::logical::TracepointDeployment Program(std::string_view path) {
+  ir::logical::TracepointDeployment program;
+  CHECK(google::protobuf::TextFormat::ParseFromString(kProgram, &program));
+  program.mutable_deployment_spec()->set_path(std::string(path));
+  return program;
+}
+
+BCCProgram CompiledProgram(std::string_view path) {
+  BCCProgram bcc_program;
+  bcc_program.code = "int probe0(struct pt_regs* ctx) { return 0; }";
+  bpf_tools::UProbeSpec spec;
+  spec.binary_path = path;
+  spec.symbol = "main.MustBeCached";
+  spec.probe_fn = "probe0";
+  bcc_program.uprobe_specs.push_back(spec);
+  return bcc_program;
+}
+
+TEST(ProgramCacheTest, KeyIgnoresDeploymentSpec) {
+  std::string key = ProgramCache::Key("build-id", Program("/proc/123/root/app"));
+  EXPECT_THAT(key, Not(IsEmpty()));
+  EXPECT_EQ(key, ProgramCache::Key("build-id", Program("/proc/456/root/app")));
+  EXPECT_NE(key, ProgramCache::Key("other-build-id", Program("/proc/123/root/app")));
+
+  ir::logical::TracepointDeployment program_with_ttl = Program("/proc/123/root/app");
+  program_with_ttl.mutable_ttl()->set_seconds(30);
+  EXPECT_EQ(key, ProgramCache::Key("build-id", program_with_ttl));
+
+  ir::logical::TracepointDeployment other_program = Program("/proc/123/root/app");
+  other_program.mutable_tracepoints(0)->mutable_program()->mutable_probes(0)->set_name("probe1");
+  EXPECT_NE(key, ProgramCache::Key("build-id", other_program));
+}
+
+TEST(ProgramCacheTest, NoKeyWithoutBuildID) {
+  EXPECT_THAT(ProgramCache::Key("", Program("/proc/123/root/app")), IsEmpty());
+}
+
+TEST(ProgramCacheTest, HitTargetsNewBinary) {
+  ProgramCache cache(4);
+
+  ir::logical::TracepointDeployment compiled_program = Program("/proc/123/root/app");
+  compiled_program.mutable_tracepoints(0)->mutable_program()->set_language(ir::shared::GOLANG);
+  const std::string key = ProgramCache::Key("build-id", compiled_program);
+  cache.Insert(key, compiled_program, CompiledProgram("/proc/123/root/app"));
+
+  ir::logical::TracepointDeployment program = Program("/proc/456/root/app");
+  EXPECT_FALSE(cache.Lookup("missing", &program).has_value());
+
+  std::optional<BCCProgram> bcc_program = cache.Lookup(key, &program);
+  ASSERT_TRUE(bcc_program.has_value());
+  EXPECT_EQ(bcc_program->code, CompiledProgram("").code);
+  ASSERT_EQ(bcc_program->uprobe_specs.size(), 1);
+  EXPECT_EQ(bcc_program->uprobe_specs[0].binary_path, "/proc/456/root/app");
+
+  // The program takes its compiled form, but keeps its own deployment spec.
+  EXPECT_EQ(program.tracepoints(0).program().language(), ir::shared::GOLANG);
+  EXPECT_THAT(program.deployment_spec(), EqualsProto(R"proto(path: "/proc/456/root/app")proto"));
+}
+
+TEST(ProgramCacheTest, EvictsLeastRecentlyUsed) {
+  ProgramCache cache(2);
+
+  ir::logical::TracepointDeployment program = Program("/app");
+  const std::string key0 = ProgramCache::Key("build-id-0", program);
+  const std::string key1 = ProgramCache::Key("build-id-1", program);
+  const std::string key2 = ProgramCache::Key("build-id-2", program);
+
+  cache.Insert(key0, program, CompiledProgram("/app"));
+  cache.Insert(key1, program, CompiledProgram("/app"));
+  // Using key0 leaves key1 as the least recently used.
+  ASSERT_TRUE(cache.Lookup(key0, &program).has_value());
+  cache.Insert(key2, program, CompiledProgram("/app"));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup(key0, &program).has_value());
+  EXPECT_FALSE(cache.Lookup(key1, &program).has_value());
+  EXPECT_TRUE(cache.Lookup(key2, &program).has_value());
+}
+
+TEST(ProgramCacheTest, ZeroCapacityDisablesCache) {
+  ProgramCache cache(0);
+
+  ir::logical::TracepointDeployment program = Program("/app");
+  const std::string key = ProgramCache::Key("build-id", program);
+  cache.Insert(key, program, CompiledProgram("/app"));
+
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.Lookup(key, &program).has_value());
+}
+
+}  // namespace dynamic_tracing
+}  // namespace stirling
+}  // namespace px
@@ -53,6 +53,13 @@ constexpr size_t kStructByteArraySize = 64;
 // generated types.
 constexpr size_t kStructBlobSize = 64;
 
+// The perf buffer that the programs of all tracepoints write their events to, when they share one.
+constexpr char kSharedPerfBufferName[] = "px_dt_shared_perf_buffer";
+
+// Each event written to the shared perf buffer starts with a uint64_t tag of the tracepoint, which
+// is defined by this macro when the program is compiled.
+constexpr char kTracepointTagMacro[] = "PX_DT_TRACEPOINT_TAG";
+
 struct BCCProgram {
   struct PerfBufferSpec {
     std::string name;
@@ -67,6 +74,10 @@ struct BCCProgram {
   std::vector<PerfBufferSpec> perf_buffer_specs;
   std::string code;
 
+  // Whether the program writes its tagged events to kSharedPerfBufferName, rather than to the perf
+  // buffers of perf_buffer_specs. The output structs of perf_buffer_specs leave out the tag.
+  bool uses_shared_perf_buffer = false;
+
   std::string ToString() const {
     std::string txt;
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/source_connectors/dynamic_tracer/shared_perf_buffer.h"
+
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <absl/strings/substitute.h>
+
+#include "src/stirling/source_connectors/dynamic_tracer/dynamic_tracing/types.h"
+
+DEFINE_uint32(stirling_dynamic_trace_shared_perf_buffer_bytes,
+              gflags::Uint32FromEnv("PL_STIRLING_DYNAMIC_TRACE_SHARED_PERF_BUFFER_BYTES",
+                                    4 * 1024 * 1024),
+              "The size of the perf buffer, on each CPU, that the dynamic tracepoints share when "
+              "--stirling_dynamic_trace_shared_perf_buffer is set.");
+
+namespace px {
+namespace stirling {
+
+using ::px::stirling::dynamic_tracing::kSharedPerfBufferName;
+
+StatusOr<SharedPerfBuffer*> SharedPerfBuffer::Get() {
+  static absl::Mutex create_lock(absl::kConstInit);
+  static SharedPerfBuffer* shared_perf_buffer = nullptr;
+
+  absl::MutexLock lock(&create_lock);
+  if (shared_perf_buffer == nullptr) {
+    auto buffer = std::unique_ptr<SharedPerfBuffer>(new SharedPerfBuffer());
+    PL_RETURN_IF_ERROR(buffer->Init());
+    // The loaded programs of the tracepoints refer to the perf buffer, so it is never destroyed.
+    shared_perf_buffer = buffer.release();
+  }
+  return shared_perf_buffer;
+}
+
+Status SharedPerfBuffer::Init() {
+  // BCC sizes a perf_output table to the number of CPUs. BPF_TABLE_PUBLIC exports it to the other
+  // BPF programs of the process.
+  const std::string code = absl::Substitute(R"(BPF_TABLE_PUBLIC("perf_output", int, u32, $0, 0);)",
+                                            kSharedPerfBufferName);
+  PL_RETURN_IF_ERROR(InitBPFProgram(code, /* cflags */ {}, /* requires_linux_headers */ false));
+
+  bpf_tools::PerfBufferSpec spec = {
+      .name = kSharedPerfBufferName,
+      .probe_output_fn = &HandleEvent,
+      .probe_loss_fn = &HandleEventLoss,
+      .size_bytes = static_cast<int>(FLAGS_stirling_dynamic_trace_shared_perf_buffer_bytes),
+  };
+  return OpenPerfBuffer(spec, this);
+}
+
+uint64_t SharedPerfBuffer::Register(EventFn on_event) {
+  absl::MutexLock lock(&mu_);
+  uint64_t tag = next_tag_++;
+  consumers_[tag] = std::move(on_event);
+  return tag;
+}
+
+void SharedPerfBuffer::Unregister(uint64_t tag) {
+  absl::MutexLock lock(&mu_);
+  consumers_.erase(tag);
+}
+
+void SharedPerfBuffer::Poll() {
+  absl::MutexLock lock(&mu_);
+  PollPerfBuffers();
+}
+
+void SharedPerfBuffer::HandleEvent(void* cb_cookie, void* data, int data_size) {
+  DCHECK_NE(cb_cookie, nullptr);
+  auto* buffer = static_cast<SharedPerfBuffer*>(cb_cookie);
+  // Only called from PollPerfBuffers(), in Poll().
+  buffer->mu_.AssertHeld();
+
+  uint64_t tag;
+  if (data_size < static_cast<int>(sizeof(tag))) {
+    LOG(DFATAL) << absl::Substitute("Event of $0 bytes has no tracepoint tag.", data_size);
+    return;
+  }
+  std::memcpy(&tag, data, sizeof(tag));
+
+  auto iter = buffer->consumers_.find(tag);
+  if (iter == buffer->consumers_.end()) {
+    // The tracepoint was removed after writing the event.
+    return;
+  }
+  iter->second(std::string(static_cast<const char*>(data) + sizeof(tag), data_size - sizeof(tag)));
+}
+
+void SharedPerfBuffer::HandleEventLoss(void* /*cb_cookie*/, uint64_t lost) {
+  VLOG(1) << absl::Substitute("Lost $0 events of the dynamic tracepoints", lost);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/bcc_wrapper.h"
+
+DECLARE_uint32(stirling_dynamic_trace_shared_perf_buffer_bytes);
+
+namespace px {
+namespace stirling {
+
+/**
+ * SharedPerfBuffer owns the perf buffer that the BPF programs of all dynamic tracepoints write
+ * their events to, when --stirling_dynamic_trace_shared_perf_buffer is set. This keeps the locked
+ * memory and the polling of the perf buffers fixed, however many tracepoints are deployed.
+ *
+ * The perf buffer is exported by a BPF program of its own, and declared as an extern table by the
+ * programs of the tracepoints. Each event starts with the tag that the tracepoint's program was
+ * compiled with, by which Poll() hands the rest of the event to the tracepoint's connector.
+ */
+class SharedPerfBuffer : public bpf_tools::BCCWrapper {
+ public:
+  using EventFn = std::function<void(std::string)>;
+
+  /**
+   * Returns the shared perf buffer of the process, which is created on first use, and then kept
+   * until the process exits.
+   */
+  static StatusOr<SharedPerfBuffer*> Get();
+
+  /**
+   * Registers the tracepoint that on_event is called with the events of, from Poll().
+   * The tracepoint's program must be compiled with the returned tag.
+   */
+  uint64_t Register(EventFn on_event);
+
+  /**
+   * Unregisters a tracepoint. Its events that are still in the perf buffer are dropped.
+   */
+  void Unregister(uint64_t tag);
+
+  /**
+   * Reads the events of all tracepoints, and hands each to the tracepoint that wrote it.
+   * Called by each tracepoint's connector; the connectors called after the first one in a
+   * transfer cycle find no more events.
+   */
+  void Poll();
+
+ private:
+  SharedPerfBuffer() = default;
+
+  Status Init();
+
+  static void HandleEvent(void* cb_cookie, void* data, int data_size);
+  static void HandleEventLoss(void* cb_cookie, uint64_t lost);
+
+  absl::Mutex mu_;
+  uint64_t next_tag_ ABSL_GUARDED_BY(mu_) = 1;
+  absl::flat_hash_map<uint64_t, EventFn> consumers_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace stirling
+}  // namespace px
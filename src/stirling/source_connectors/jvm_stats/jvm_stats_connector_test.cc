@@ -84,14 +84,14 @@ class JVMStatsConnectorTest : public ::testing::Test {
 //
 // Tests that java processes are detected and data is collected.
 TEST_F(JVMStatsConnectorTest, CaptureData) {
-  absl::flat_hash_set<md::UPID> upids;
+  md::UPIDSet upids;
 
   JavaHelloWorld hello_world1;
   ASSERT_OK(hello_world1.Start());
   upids.insert(PIDToUPID(hello_world1.child_pid()));
 
   {
-    absl::flat_hash_set<md::UPID> upids = {PIDToUPID(hello_world1.child_pid())};
+    md::UPIDSet upids = {PIDToUPID(hello_world1.child_pid())};
     auto ctx = std::make_unique<StandaloneContext>(upids);
     connector_->TransferData(ctx.get(), data_tables_.tables());
     std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
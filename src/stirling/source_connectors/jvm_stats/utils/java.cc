@@ -18,13 +18,20 @@
 
 #include "src/stirling/source_connectors/jvm_stats/utils/java.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <absl/strings/match.h>
 
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "src/common/base/base.h"
 #include "src/common/base/byte_utils.h"
 #include "src/common/base/statusor.h"
 #include "src/common/fs/fs_wrapper.h"
@@ -41,6 +48,38 @@ using ::px::stirling::java::hsperf::ParseHsperfData;
 using ::px::system::ProcParser;
 using ::px::utils::LEndianBytesToInt;
 
+namespace {
+
+constexpr std::string_view kYoungGCTimeSuffix = "gc.collector.0.time";
+constexpr std::string_view kFullGCTimeSuffix = "gc.collector.1.time";
+constexpr std::string_view kUsedHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.used",
+    "gc.generation.0.space.1.used",
+    "gc.generation.0.space.2.used",
+    "gc.generation.1.space.0.used",
+};
+constexpr std::string_view kTotalHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.capacity",
+    "gc.generation.0.space.1.capacity",
+    "gc.generation.0.space.2.capacity",
+    "gc.generation.1.space.0.capacity",
+};
+constexpr std::string_view kMaxHeapSizeSuffixes[] = {
+    "gc.generation.0.maxCapacity",
+    "gc.generation.1.maxCapacity",
+};
+
+bool EndsWithAny(std::string_view name, ArrayView<std::string_view> suffixes) {
+  for (const auto& suffix : suffixes) {
+    if (absl::EndsWith(name, suffix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 Stats::Stats(std::vector<Stat> stats) : stats_(std::move(stats)) {}
 
 Stats::Stats(std::string hsperf_data_str) : hsperf_data_(std::move(hsperf_data_str)) {}
@@ -58,34 +97,21 @@ Status Stats::Parse() {
   return Status::OK();
 }
 
-uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix("gc.collector.0.time"); }
+bool Stats::IsUsed(std::string_view name) {
+  return absl::EndsWith(name, kYoungGCTimeSuffix) || absl::EndsWith(name, kFullGCTimeSuffix) ||
+         EndsWithAny(name, kUsedHeapSizeSuffixes) || EndsWithAny(name, kTotalHeapSizeSuffixes) ||
+         EndsWithAny(name, kMaxHeapSizeSuffixes);
+}
 
-uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix("gc.collector.1.time"); }
+uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix(kYoungGCTimeSuffix); }
 
-uint64_t Stats::UsedHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.used",
-      "gc.generation.0.space.1.used",
-      "gc.generation.0.space.2.used",
-      "gc.generation.1.space.0.used",
-  });
-}
+uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix(kFullGCTimeSuffix); }
 
-uint64_t Stats::TotalHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.capacity",
-      "gc.generation.0.space.1.capacity",
-      "gc.generation.0.space.2.capacity",
-      "gc.generation.1.space.0.capacity",
-  });
-}
+uint64_t Stats::UsedHeapSizeBytes() const { return SumStatsForSuffixes(kUsedHeapSizeSuffixes); }
 
-uint64_t Stats::MaxHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.maxCapacity",
-      "gc.generation.1.maxCapacity",
-  });
-}
+uint64_t Stats::TotalHeapSizeBytes() const { return SumStatsForSuffixes(kTotalHeapSizeSuffixes); }
+
+uint64_t Stats::MaxHeapSizeBytes() const { return SumStatsForSuffixes(kMaxHeapSizeSuffixes); }
 
 uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   for (const auto& stat : stats_) {
@@ -96,7 +122,7 @@ uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   return 0;
 }
 
-uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const {
+uint64_t Stats::SumStatsForSuffixes(ArrayView<std::string_view> suffixes) const {
   uint64_t sum = 0;
   for (const auto& suffix : suffixes) {
     sum += StatForSuffix(suffix);
@@ -104,6 +130,73 @@ uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixe
   return sum;
 }
 
+StatusOr<std::unique_ptr<HsperfdataReader>> HsperfdataReader::Open(
+    const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Could not open $0: $1", path.string(), std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Could not stat $0: $1", path.string(), std::strerror(errno));
+  }
+  // The JVM sizes the file when it creates it, and never resizes it.
+  const size_t size = st.st_size;
+  if (size < sizeof(hsperf::Prologue)) {
+    return error::InvalidArgument("$0 is not a hsperfdata file.", path.string());
+  }
+
+  // Shared, so that the values the JVM writes are visible.
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Could not mmap $0: $1", path.string(), std::strerror(errno));
+  }
+
+  auto reader = std::unique_ptr<HsperfdataReader>(new HsperfdataReader());
+  reader->data_ = std::string_view(static_cast<const char*>(addr), size);
+  PL_RETURN_IF_ERROR(reader->ParseLayout());
+  return reader;
+}
+
+HsperfdataReader::~HsperfdataReader() {
+  if (!data_.empty()) {
+    munmap(const_cast<char*>(data_.data()), data_.size());
+  }
+}
+
+Status HsperfdataReader::ParseLayout() {
+  hsperf::HsperfData hsperf_data = {};
+  PL_RETURN_IF_ERROR(ParseHsperfData(data_, &hsperf_data));
+
+  counters_.clear();
+  for (const auto& entry : hsperf_data.data_entries) {
+    if (entry.header->data_type != static_cast<uint8_t>(hsperf::DataType::kLong) ||
+        entry.data.size() != sizeof(uint64_t) || !Stats::IsUsed(entry.name)) {
+      continue;
+    }
+    counters_.push_back({entry.name, static_cast<size_t>(entry.data.data() - data_.data())});
+  }
+  num_entries_ = hsperf_data.prologue->num_entries;
+  return Status::OK();
+}
+
+StatusOr<Stats> HsperfdataReader::ReadStats() {
+  const auto* prologue = reinterpret_cast<const hsperf::Prologue*>(data_.data());
+  if (prologue->num_entries != num_entries_) {
+    PL_RETURN_IF_ERROR(ParseLayout());
+  }
+
+  std::vector<Stats::Stat> stats;
+  stats.reserve(counters_.size());
+  for (const auto& counter : counters_) {
+    std::string_view value = data_.substr(counter.offset, sizeof(uint64_t));
+    stats.push_back({counter.name, LEndianBytesToInt<uint64_t>(value)});
+  }
+  return Stats(std::move(stats));
+}
+
 StatusOr<std::filesystem::path> HsperfdataPath(pid_t pid) {
   const system::Config& sysconfig = system::Config::GetInstance();
   const std::filesystem::path& host_path = sysconfig.host_path();
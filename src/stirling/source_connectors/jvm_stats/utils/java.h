@@ -19,12 +19,14 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "src/common/base/statusor.h"
+#include "src/common/base/types.h"
 
 namespace px {
 namespace stirling {
@@ -45,6 +47,11 @@ class Stats {
   explicit Stats(std::vector<Stat> stats);
   explicit Stats(std::string hsperf_data);
 
+  /**
+   * Returns true if the stat with the given name is used to compute any of the stats below.
+   */
+  static bool IsUsed(std::string_view name);
+
   /**
    * Parses the held hsperf data into structured stats.
    */
@@ -58,12 +65,46 @@ class Stats {
 
  private:
   uint64_t StatForSuffix(std::string_view suffix) const;
-  uint64_t SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const;
+  uint64_t SumStatsForSuffixes(ArrayView<std::string_view> suffixes) const;
 
   std::string hsperf_data_;
   std::vector<Stat> stats_;
 };
 
+/**
+ * HsperfdataReader reads the stats of a JVM straight out of its memory-mapped hsperfdata file.
+ *
+ * The JVM only ever appends counters to the file, and updates their values in place. So the file
+ * is parsed once, to find the counters that Stats uses, and each sample then only reads those.
+ * The file is parsed again if the JVM has added counters since.
+ */
+class HsperfdataReader {
+ public:
+  static StatusOr<std::unique_ptr<HsperfdataReader>> Open(const std::filesystem::path& path);
+
+  ~HsperfdataReader();
+
+  /**
+   * Returns the current values of the counters used by Stats.
+   */
+  StatusOr<Stats> ReadStats();
+
+ private:
+  HsperfdataReader() = default;
+
+  Status ParseLayout();
+
+  struct Counter {
+    std::string_view name;
+    size_t offset;
+  };
+
+  std::string_view data_;
+  // The number of entries in the file when it was last parsed, and the counters found then.
+  uint32_t num_entries_ = 0;
+  std::vector<Counter> counters_;
+};
+
 /**
  * Returns the path of the hsperfdata for a JVM process.
  */
@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -59,6 +60,29 @@ TEST(StatsTest, CommonValues) {
   EXPECT_EQ(2, stats.MaxHeapSizeBytes());
 }
 
+// Tests that reading the mapped file gives the same stats as parsing all of it.
+TEST(HsperfdataReaderTest, MatchesFullParse) {
+  const std::string path = px::testing::BazelRunfilePath(
+      "src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata");
+
+  ASSERT_OK_AND_ASSIGN(std::string hsperf_data, ReadFileToString(path));
+  Stats expected(std::move(hsperf_data));
+  ASSERT_OK(expected.Parse());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<HsperfdataReader> reader, HsperfdataReader::Open(path));
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(Stats stats, reader->ReadStats());
+    EXPECT_EQ(stats.YoungGCTimeNanos(), expected.YoungGCTimeNanos());
+    EXPECT_EQ(stats.FullGCTimeNanos(), expected.FullGCTimeNanos());
+    EXPECT_EQ(stats.UsedHeapSizeBytes(), expected.UsedHeapSizeBytes());
+    EXPECT_EQ(stats.TotalHeapSizeBytes(), expected.TotalHeapSizeBytes());
+    EXPECT_EQ(stats.MaxHeapSizeBytes(), expected.MaxHeapSizeBytes());
+  }
+  EXPECT_GT(expected.TotalHeapSizeBytes(), 0);
+
+  EXPECT_NOT_OK(HsperfdataReader::Open("/dev/null"));
+}
+
 TEST(HsperfdataPathTest, ResultIsAsExpected) {
   const char kClassPath[] = "src/stirling/source_connectors/jvm_stats/testing/HelloWorld.jar";
   const std::string class_path = testing::BazelRunfilePath(kClassPath);
@@ -0,0 +1,53 @@
+/*
+ * This code runs using bpf in the Linux kernel.
+ * Copyright 2018- The Pixie Authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * SPDX-License-Identifier: GPL-2.0
+ */
+
+// LINT_C_FILE: Do not remove this line. It ensures cpplint treats this as a C file.
+
+#include "src/stirling/source_connectors/network_stats/bcc_bpf_intf/network_stats.h"
+
+// Keyed by the ID of the cgroup of the socket the packet belongs to.
+// Entries of cgroups that are gone are removed from user-space.
+BPF_HASH(cgroup_net_stats, uint64_t, struct cgroup_net_stats_t, 16384);
+
+static __inline struct cgroup_net_stats_t* get_cgroup_net_stats(struct __sk_buff* skb) {
+  uint64_t cgroup_id = bpf_skb_cgroup_id(skb);
+  struct cgroup_net_stats_t zero = {};
+  return cgroup_net_stats.lookup_or_try_init(&cgroup_id, &zero);
+}
+
+// The return values tell the kernel to let the packets through; these programs only count them.
+int cgroup_skb_ingress(struct __sk_buff* skb) {
+  struct cgroup_net_stats_t* stats = get_cgroup_net_stats(skb);
+  if (stats != NULL) {
+    __sync_fetch_and_add(&stats->rx_bytes, skb->len);
+    __sync_fetch_and_add(&stats->rx_packets, 1);
+  }
+  return 1;
+}
+
+int cgroup_skb_egress(struct __sk_buff* skb) {
+  struct cgroup_net_stats_t* stats = get_cgroup_net_stats(skb);
+  if (stats != NULL) {
+    __sync_fetch_and_add(&stats->tx_bytes, skb->len);
+    __sync_fetch_and_add(&stats->tx_packets, 1);
+  }
+  return 1;
+}
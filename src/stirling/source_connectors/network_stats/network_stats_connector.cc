@@ -18,27 +18,114 @@
 
 #include "src/stirling/source_connectors/network_stats/network_stats_connector.h"
 
+#include <fcntl.h>
+
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
 
 #include "src/common/base/base.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/proc_parser.h"
 #include "src/shared/metadata/metadata.h"
+#include "src/stirling/bpf_tools/macros.h"
+
+DEFINE_bool(stirling_network_stats_use_cgroup_bpf,
+            gflags::BoolFromEnv("PL_STIRLING_NETWORK_STATS_USE_CGROUP_BPF", false),
+            "If true, network_stats counts the traffic of each pod's cgroups with cgroup-skb BPF "
+            "programs, instead of reading /proc/<pid>/net/dev in the pod's network namespace. "
+            "This attributes traffic correctly to pods that share a network namespace, "
+            "but does not report errors and drops. Falls back to /proc if the programs fail to "
+            "attach.");
+
+BPF_SRC_STRVIEW(network_stats_bcc_script, network_stats);
 
 namespace px {
 namespace stirling {
 
 using system::ProcParser;
 
+namespace {
+
+// cgroup-skb programs can only be attached to cgroup v2, which is either the only hierarchy
+// (unified mode), or is mounted next to the v1 controllers (hybrid mode).
+StatusOr<std::filesystem::path> CGroup2Path(const std::filesystem::path& sysfs_path) {
+  for (const auto& path : {sysfs_path / "fs/cgroup", sysfs_path / "fs/cgroup/unified"}) {
+    if (fs::Exists(path / "cgroup.controllers")) {
+      return path;
+    }
+  }
+  return error::NotFound("Could not find the cgroup v2 hierarchy under $0", sysfs_path.string());
+}
+
+// Returns the ID that bpf_skb_cgroup_id() reports for the cgroup at path. This is the kernfs
+// file handle of the cgroup directory; its inode number only matches on kernels since 5.5.
+StatusOr<uint64_t> CGroupID(const std::filesystem::path& path) {
+  alignas(struct file_handle) char buf[sizeof(struct file_handle) + sizeof(uint64_t)] = {};
+  auto* handle = reinterpret_cast<struct file_handle*>(buf);
+  handle->handle_bytes = sizeof(uint64_t);
+  int mount_id = 0;
+  if (name_to_handle_at(AT_FDCWD, path.c_str(), handle, &mount_id, 0) != 0) {
+    return error::Internal("Could not get the handle of $0: $1", path.string(),
+                           std::strerror(errno));
+  }
+  uint64_t cgroup_id = 0;
+  std::memcpy(&cgroup_id, handle->f_handle, sizeof(cgroup_id));
+  return cgroup_id;
+}
+
+// Returns the cgroup v2 path of the process, relative to the root of the hierarchy.
+StatusOr<std::string> ProcCGroup2Path(const std::filesystem::path& proc_pid_path) {
+  PL_ASSIGN_OR_RETURN(std::string content, ReadFileToString(proc_pid_path / "cgroup"));
+  for (std::string_view line : absl::StrSplit(content, '\n')) {
+    if (absl::ConsumePrefix(&line, "0::/")) {
+      return std::string(line);
+    }
+  }
+  return error::NotFound("No cgroup v2 entry in $0/cgroup", proc_pid_path.string());
+}
+
+}  // namespace
+
 Status NetworkStatsConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
+
+  if (FLAGS_stirling_network_stats_use_cgroup_bpf) {
+    Status s = InitCGroupBPF();
+    if (!s.ok()) {
+      LOG(WARNING) << absl::Substitute(
+          "Could not attach the network_stats cgroup programs, reading /proc instead: $0",
+          s.msg());
+      bcc_.reset();
+    }
+  }
   return Status::OK();
 }
 
-Status NetworkStatsConnector::StopImpl() { return Status::OK(); }
+Status NetworkStatsConnector::InitCGroupBPF() {
+  PL_ASSIGN_OR_RETURN(cgroup2_path_, CGroup2Path(sysconfig_.sysfs_path()));
+
+  // The programs are attached to the root, so they see the packets of every cgroup on the host.
+  bcc_ = std::make_unique<bpf_tools::BCCWrapper>();
+  PL_RETURN_IF_ERROR(bcc_->InitBPFProgram(network_stats_bcc_script));
+  PL_RETURN_IF_ERROR(
+      bcc_->AttachCGroupSKB(cgroup2_path_.string(), BPF_CGROUP_INET_INGRESS, "cgroup_skb_ingress"));
+  PL_RETURN_IF_ERROR(
+      bcc_->AttachCGroupSKB(cgroup2_path_.string(), BPF_CGROUP_INET_EGRESS, "cgroup_skb_egress"));
+  return Status::OK();
+}
+
+Status NetworkStatsConnector::StopImpl() {
+  bcc_.reset();
+  return Status::OK();
+}
 
 void NetworkStatsConnector::TransferDataImpl(ConnectorContext* ctx,
                                              const std::vector<DataTable*>& data_tables) {
@@ -55,6 +142,16 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  // In cgroup BPF mode, all the counters are read in one batch per sample.
+  absl::flat_hash_map<uint64_t, struct cgroup_net_stats_t> cgroup_stats;
+  if (bcc_ != nullptr) {
+    for (const auto& [cgroup_id, stats] :
+         bcc_->GetHashTableEntries<uint64_t, struct cgroup_net_stats_t>(
+             kCGroupNetStatsTableName)) {
+      cgroup_stats[cgroup_id] = stats;
+    }
+  }
+
   for (const auto& [pod_name, pod_id] : k8s_md.pods_by_name()) {
     PL_UNUSED(pod_name);
 
@@ -65,7 +162,9 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     }
 
     ProcParser::NetworkStats stats;
-    auto s = GetNetworkStatsForPod(*proc_parser_, *pod_info, k8s_md, &stats);
+    auto s = bcc_ != nullptr
+                 ? GetCGroupNetworkStatsForPod(*pod_info, k8s_md, cgroup_stats, &stats)
+                 : GetNetworkStatsForPod(*proc_parser_, *pod_info, k8s_md, &stats);
 
     if (!s.ok()) {
       VLOG(1) << absl::StrCat("Failed to get Pod network stats: ", s.msg());
@@ -85,6 +184,10 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     r.Append<r.ColIndex("tx_errors")>(stats.tx_errs);
     r.Append<r.ColIndex("tx_drops")>(stats.tx_drops);
   }
+
+  if (bcc_ != nullptr) {
+    RemoveStoppedContainerCGroups(k8s_md);
+  }
 }
 
 Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& proc_parser,
@@ -132,5 +235,77 @@ Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& pr
   return error::Internal("Failed to get networks stats for pod_id=$0", pod_info.uid());
 }
 
+StatusOr<uint64_t> NetworkStatsConnector::ContainerCGroupID(
+    std::string_view container_id, const md::ContainerInfo& container_info) {
+  auto it = container_cgroup_ids_.find(container_id);
+  if (it != container_cgroup_ids_.end()) {
+    return it->second;
+  }
+
+  // The processes of a container stay in its cgroup, so any of them will do, and the result is
+  // kept for the lifetime of the container.
+  for (const auto& upid : container_info.active_upids()) {
+    auto path_or = ProcCGroup2Path(sysconfig_.proc_path() / std::to_string(upid.pid()));
+    if (!path_or.ok()) {
+      continue;
+    }
+    PL_ASSIGN_OR_RETURN(uint64_t cgroup_id, CGroupID(cgroup2_path_ / path_or.ValueOrDie()));
+    container_cgroup_ids_[std::string(container_id)] = cgroup_id;
+    return cgroup_id;
+  }
+  return error::NotFound("Could not find the cgroup of container $0", container_id);
+}
+
+Status NetworkStatsConnector::GetCGroupNetworkStatsForPod(
+    const md::PodInfo& pod_info, const md::K8sMetadataState& k8s_metadata_state,
+    const absl::flat_hash_map<uint64_t, struct cgroup_net_stats_t>& cgroup_stats,
+    system::ProcParser::NetworkStats* stats) {
+  DCHECK(stats != nullptr);
+  bool found = false;
+  for (const auto& container_id : pod_info.containers()) {
+    auto* container_info = k8s_metadata_state.ContainerInfoByID(container_id);
+    if (container_info == nullptr || container_info->stop_time_ns() > 0) {
+      continue;
+    }
+    auto cgroup_id_or = ContainerCGroupID(container_id, *container_info);
+    if (!cgroup_id_or.ok()) {
+      VLOG(1) << cgroup_id_or.msg();
+      continue;
+    }
+    found = true;
+    // A cgroup that has not sent or received anything yet has no entry.
+    auto it = cgroup_stats.find(cgroup_id_or.ValueOrDie());
+    if (it == cgroup_stats.end()) {
+      continue;
+    }
+    stats->rx_bytes += it->second.rx_bytes;
+    stats->rx_packets += it->second.rx_packets;
+    stats->tx_bytes += it->second.tx_bytes;
+    stats->tx_packets += it->second.tx_packets;
+  }
+
+  if (!found) {
+    return error::Internal("Failed to get the cgroups of pod_id=$0", pod_info.uid());
+  }
+  return Status::OK();
+}
+
+void NetworkStatsConnector::RemoveStoppedContainerCGroups(
+    const md::K8sMetadataState& k8s_metadata_state) {
+  std::vector<uint64_t> stopped_cgroup_ids;
+  for (auto it = container_cgroup_ids_.begin(); it != container_cgroup_ids_.end();) {
+    auto* container_info = k8s_metadata_state.ContainerInfoByID(it->first);
+    if (container_info == nullptr || container_info->stop_time_ns() > 0) {
+      stopped_cgroup_ids.push_back(it->second);
+      container_cgroup_ids_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  if (!stopped_cgroup_ids.empty()) {
+    bcc_->RemoveHashTableKeys(kCGroupNetStatsTableName, std::move(stopped_cgroup_ids));
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
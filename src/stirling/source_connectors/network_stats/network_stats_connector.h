@@ -18,19 +18,26 @@
 
 #pragma once
 
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
+#include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/core/canonical_types.h"
 #include "src/stirling/core/source_connector.h"
+#include "src/stirling/source_connectors/network_stats/bcc_bpf_intf/network_stats.h"
 #include "src/stirling/source_connectors/network_stats/network_stats_table.h"
 
+DECLARE_bool(stirling_network_stats_use_cgroup_bpf);
+
 namespace px {
 namespace stirling {
 
@@ -69,7 +76,26 @@ class NetworkStatsConnector : public SourceConnector {
                                       const md::K8sMetadataState& k8s_metadata_state,
                                       system::ProcParser::NetworkStats* stats);
 
+  // In cgroup BPF mode, sums the counters of the cgroups of the pod's containers.
+  // The errors and drops are not visible to cgroup-skb programs, and are left at zero.
+  Status GetCGroupNetworkStatsForPod(
+      const md::PodInfo& pod_info, const md::K8sMetadataState& k8s_metadata_state,
+      const absl::flat_hash_map<uint64_t, struct cgroup_net_stats_t>& cgroup_stats,
+      system::ProcParser::NetworkStats* stats);
+
+  Status InitCGroupBPF();
+  StatusOr<uint64_t> ContainerCGroupID(std::string_view container_id,
+                                       const md::ContainerInfo& container_info);
+  // Forgets the cgroups of the containers that have stopped, and removes their BPF counters.
+  void RemoveStoppedContainerCGroups(const md::K8sMetadataState& k8s_metadata_state);
+
   std::unique_ptr<system::ProcParser> proc_parser_;
+
+  // Only set in cgroup BPF mode; otherwise the stats are read from /proc/<pid>/net/dev, which
+  // reports the whole network namespace of the pod.
+  std::unique_ptr<bpf_tools::BCCWrapper> bcc_;
+  std::filesystem::path cgroup2_path_;
+  absl::flat_hash_map<std::string, uint64_t> container_cgroup_ids_;
 };
 
 }  // namespace stirling
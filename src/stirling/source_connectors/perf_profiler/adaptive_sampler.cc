@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/adaptive_sampler.h"
+
+#include <algorithm>
+
+namespace px {
+namespace stirling {
+
+AdaptiveSampler::AdaptiveSampler(double cpu_budget, uint32_t max_stride)
+    : cpu_budget_(cpu_budget), max_stride_(std::max(max_stride, 1U)) {}
+
+uint32_t AdaptiveSampler::Update(std::chrono::nanoseconds cpu_time,
+                                 std::chrono::nanoseconds wall_time, uint64_t num_lost) {
+  if (wall_time.count() <= 0) {
+    return stride_;
+  }
+  const double overhead = static_cast<double>(cpu_time.count()) / wall_time.count();
+
+  if (num_lost > 0 || overhead > cpu_budget_) {
+    stride_ = std::min(2 * stride_, max_stride_);
+  } else if (stride_ > 1) {
+    // The cost of the profiler is mostly proportional to the number of samples, so lowering the
+    // stride is expected to raise the overhead by stride / (stride - 1). The stride is only
+    // lowered with some headroom left, so that it does not oscillate around the budget.
+    constexpr double kHeadroom = 0.8;
+    const double expected_overhead = overhead * stride_ / (stride_ - 1);
+    if (expected_overhead < kHeadroom * cpu_budget_) {
+      --stride_;
+    }
+  }
+  return stride_;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace px {
+namespace stirling {
+
+/**
+ * AdaptiveSampler chooses the sample stride of the profiler, to keep its CPU cost within a budget.
+ * The BPF program keeps one in every stride samples on each CPU, so the effective sampling period
+ * is stride times the configured period; the output counts are scaled by the stride, so that
+ * they stay in units of the configured period.
+ *
+ * The stride is doubled when the profiler is over budget or loses samples, and lowered by one
+ * when the profiler is expected to stay within budget at the lower stride.
+ */
+class AdaptiveSampler {
+ public:
+  /**
+   * @param cpu_budget The target fraction of one CPU for the profiler to use.
+   * @param max_stride The highest stride, to bound the loss of profile resolution.
+   */
+  AdaptiveSampler(double cpu_budget, uint32_t max_stride);
+
+  /**
+   * Updates the stride, given the CPU time the profiler spent over wall_time, and the number of
+   * samples lost over that time. Returns the new stride.
+   */
+  uint32_t Update(std::chrono::nanoseconds cpu_time, std::chrono::nanoseconds wall_time,
+                  uint64_t num_lost);
+
+  uint32_t stride() const { return stride_; }
+
+ private:
+  const double cpu_budget_;
+  const uint32_t max_stride_;
+  uint32_t stride_ = 1;
+};
+
+}  // namespace stirling
+}  // namespace px
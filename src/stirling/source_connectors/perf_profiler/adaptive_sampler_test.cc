@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/stirling/source_connectors/perf_profiler/adaptive_sampler.h"
+
+namespace px {
+namespace stirling {
+
+using std::chrono::milliseconds;
+
+constexpr milliseconds kWallTime{1000};
+
+TEST(AdaptiveSamplerTest, RaisesStrideOverBudget) {
+  AdaptiveSampler sampler(/*cpu_budget*/ 0.01, /*max_stride*/ 8);
+  EXPECT_EQ(sampler.stride(), 1);
+
+  // 2% of a CPU, over a budget of 1%.
+  EXPECT_EQ(sampler.Update(milliseconds{20}, kWallTime, 0), 2);
+  EXPECT_EQ(sampler.Update(milliseconds{20}, kWallTime, 0), 4);
+  EXPECT_EQ(sampler.Update(milliseconds{20}, kWallTime, 0), 8);
+  // Capped at the max stride.
+  EXPECT_EQ(sampler.Update(milliseconds{20}, kWallTime, 0), 8);
+}
+
+TEST(AdaptiveSamplerTest, RaisesStrideOnLoss) {
+  AdaptiveSampler sampler(0.01, 8);
+  EXPECT_EQ(sampler.Update(milliseconds{1}, kWallTime, /*num_lost*/ 10), 2);
+}
+
+TEST(AdaptiveSamplerTest, LowersStrideWithinBudget) {
+  AdaptiveSampler sampler(0.01, 8);
+  EXPECT_EQ(sampler.Update(milliseconds{20}, kWallTime, 0), 2);
+
+  // At stride 1, the overhead would be 1%; not enough headroom to lower the stride.
+  EXPECT_EQ(sampler.Update(milliseconds{5}, kWallTime, 0), 2);
+
+  // At stride 1, the overhead would be 0.6%.
+  EXPECT_EQ(sampler.Update(milliseconds{3}, kWallTime, 0), 1);
+  EXPECT_EQ(sampler.Update(milliseconds{0}, kWallTime, 0), 1);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -59,7 +59,37 @@ BPF_STACK_TRACE(stack_traces_b, CFG_STACK_TRACE_ENTRIES);
 // See comments in shared header file "stack_event.h".
 BPF_ARRAY(profiler_state, uint64_t, kProfilerStateVectorSize);
 
+// The number of samples skipped on each CPU since the last one that was kept.
+BPF_PERCPU_ARRAY(skipped_samples, uint64_t, 1);
+
+// Keeps one in every sample stride samples (in profiler_state) on each CPU, which lets user space
+// reduce the cost of profiling without re-attaching the perf events. A stride of 0 or 1 keeps
+// every sample.
+static __inline int skip_sample() {
+  int sample_stride_idx = kSampleStrideIdx;
+  uint64_t* sample_stride_ptr = profiler_state.lookup(&sample_stride_idx);
+  if (sample_stride_ptr == NULL || *sample_stride_ptr <= 1) {
+    return 0;
+  }
+
+  int kZero = 0;
+  uint64_t* skipped_ptr = skipped_samples.lookup(&kZero);
+  if (skipped_ptr == NULL) {
+    return 0;
+  }
+  if (*skipped_ptr + 1 < *sample_stride_ptr) {
+    *skipped_ptr += 1;
+    return 1;
+  }
+  *skipped_ptr = 0;
+  return 0;
+}
+
 int sample_call_stack(struct bpf_perf_event_data* ctx) {
+  if (skip_sample()) {
+    return 0;
+  }
+
   int transfer_count_idx = kTransferCountIdx;
   int sample_count_a_idx = kSampleCountAIdx;
   int sample_count_b_idx = kSampleCountAIdx;
@@ -115,3 +145,101 @@ int sample_call_stack(struct bpf_perf_event_data* ctx) {
 
   return 0;
 }
+
+#if CFG_OFFCPU
+// Off-CPU profiling attributes the time that threads spend blocked to the stack traces they block
+// in. On sched_switch, the thread switched out is still current, so its stack is walked then,
+// and kept with the time, until the thread is switched back in. The blocked time is summed per
+// stack trace in BPF, so user space reads one entry per stack trace, not one per switch.
+//
+// Like the on-CPU maps, the off-CPU maps are double buffered, based on the transfer count.
+// Blocks that span a switch of map sets are dropped, because user space has since read out,
+// and cleared, the stack traces of the old set.
+
+struct offcpu_start_t {
+  uint64_t timestamp_ns;
+  uint64_t transfer_count;
+  struct stack_trace_key_t key;
+};
+
+// Threads that are switched out, by thread ID. An LRU, so that the entries of threads that exit
+// while blocked are evicted.
+BPF_TABLE("lru_hash", uint32_t, struct offcpu_start_t, offcpu_start, CFG_OFFCPU_MAX_THREADS);
+
+// Maps from stack trace key to the total time blocked in it, in nanoseconds.
+BPF_HASH(offcpu_histogram_a, struct stack_trace_key_t, uint64_t, CFG_OFFCPU_STACK_TRACE_ENTRIES);
+BPF_HASH(offcpu_histogram_b, struct stack_trace_key_t, uint64_t, CFG_OFFCPU_STACK_TRACE_ENTRIES);
+BPF_STACK_TRACE(offcpu_stack_traces_a, CFG_OFFCPU_STACK_TRACE_ENTRIES);
+BPF_STACK_TRACE(offcpu_stack_traces_b, CFG_OFFCPU_STACK_TRACE_ENTRIES);
+
+static __inline void count_offcpu_drop() {
+  int drop_count_idx = kOffCPUDropCountIdx;
+  uint64_t* drop_count_ptr = profiler_state.lookup(&drop_count_idx);
+  if (drop_count_ptr != NULL) {
+    __sync_fetch_and_add(drop_count_ptr, 1);
+  }
+}
+
+TRACEPOINT_PROBE(sched, sched_switch) {
+  int transfer_count_idx = kTransferCountIdx;
+  uint64_t* transfer_count_ptr = profiler_state.lookup(&transfer_count_idx);
+  if (transfer_count_ptr == NULL) {
+    return 0;
+  }
+  const uint64_t transfer_count = *transfer_count_ptr;
+  const uint64_t now = bpf_ktime_get_ns();
+
+  // Only threads that block are tracked; a prev_state of 0 (TASK_RUNNING) means the thread was
+  // preempted, and is still runnable. Thread 0 is the idle task.
+  const uint32_t prev_tid = args->prev_pid;
+  if (prev_tid != 0 && args->prev_state != 0) {
+    struct offcpu_start_t start = {};
+    start.timestamp_ns = now;
+    start.transfer_count = transfer_count;
+    start.key.upid.tgid = bpf_get_current_pid_tgid() >> 32;
+    start.key.upid.start_time_ticks = get_tgid_start_time();
+    if (transfer_count % 2 == 0) {
+      start.key.user_stack_id = offcpu_stack_traces_a.get_stackid(args, BPF_F_USER_STACK);
+      start.key.kernel_stack_id = offcpu_stack_traces_a.get_stackid(args, 0);
+    } else {
+      start.key.user_stack_id = offcpu_stack_traces_b.get_stackid(args, BPF_F_USER_STACK);
+      start.key.kernel_stack_id = offcpu_stack_traces_b.get_stackid(args, 0);
+    }
+    offcpu_start.update(&prev_tid, &start);
+  }
+
+  const uint32_t next_tid = args->next_pid;
+  struct offcpu_start_t* start_ptr = offcpu_start.lookup(&next_tid);
+  if (start_ptr == NULL) {
+    return 0;
+  }
+  struct offcpu_start_t start = *start_ptr;
+  offcpu_start.delete(&next_tid);
+
+  // Short blocks are not worth their cost to user space.
+  const uint64_t blocked_ns = now - start.timestamp_ns;
+  if (blocked_ns < CFG_OFFCPU_MIN_BLOCK_NS) {
+    return 0;
+  }
+  if (start.transfer_count != transfer_count) {
+    count_offcpu_drop();
+    return 0;
+  }
+
+  uint64_t zero = 0;
+  uint64_t* total_ns_ptr = NULL;
+  if (transfer_count % 2 == 0) {
+    total_ns_ptr = offcpu_histogram_a.lookup_or_init(&start.key, &zero);
+  } else {
+    total_ns_ptr = offcpu_histogram_b.lookup_or_init(&start.key, &zero);
+  }
+  if (total_ns_ptr == NULL) {
+    // The histogram is full.
+    count_offcpu_drop();
+    return 0;
+  }
+  __sync_fetch_and_add(total_ns_ptr, blocked_ns);
+
+  return 0;
+}
+#endif
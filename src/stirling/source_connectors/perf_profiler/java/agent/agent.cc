@@ -17,9 +17,9 @@
  */
 
 // This file is compiled into agent.so, a shared library that will be injected into the target
-// Java process. Once injected, it creates a symbol log file into which it writes every
-// symbol compiled by the JVM along with the symbol address and code size. This symbol file
-// is then used by the Stirling data collector inside of the PEM (Pixie Edge Module) to
+// Java process. Once injected, it creates a shared memory symbol ring buffer (or, failing that,
+// a symbol log file) into which it writes every symbol compiled by the JVM along with the
+// symbol address and code size. The ring buffer is then used by the Stirling data collector inside of the PEM (Pixie Edge Module) to
 // populate Java symbols that cannot be found by inspecting binaries (i.e. cannot be found
 // by the "normal" means used to find symbols in compiled binaries from C, C++, Go, and Rust).
 
@@ -34,6 +34,9 @@
 // NOLINTNEXTLINE: build/include_subdir
 #include "raw_symbol_update.h"
 
+// NOLINTNEXTLINE: build/include_subdir
+#include "symbol_ring_buffer.h"
+
 // NOLINTNEXTLINE: build/include_subdir
 #include "agent_hash.h"
 
@@ -46,11 +49,13 @@
 namespace {
 constexpr bool kUsingTxtLogFile = false;
 constexpr bool kUsingBinLogFile = true;
+constexpr bool kUsingSymbolRing = true;
 
 std::mutex g_mtx;
 bool g_callbacks_attached = false;
 FILE* g_log_file_ptr = nullptr;
 FILE* g_bin_file_ptr = nullptr;
+px::stirling::java::SymbolRingBuffer* g_symbol_ring = nullptr;
 
 }  // namespace
 
@@ -137,7 +142,11 @@ void WriteSymbol(const uint64_t addr, const uint32_t code_size, const bool metho
   } else {
     LogF("WriteSymbol|0x%016llx|%u|%s|%s|%s", addr, code_size, symbol, fn_sig, class_sig);
   }
-  if (g_bin_file_ptr != nullptr) {
+  if (g_symbol_ring != nullptr) {
+    if (!g_symbol_ring->Write(symbol_metadata, symbol, fn_sig, class_sig)) {
+      LogF("[error] WriteSymbol() symbol ring buffer full, dropped 0x%016llx.", addr);
+    }
+  } else if (g_bin_file_ptr != nullptr) {
     FWriteRetryOnErr(g_bin_file_ptr, &symbol_metadata, sizeof(symbol_metadata));
     FWriteRetryOnErr(g_bin_file_ptr, symbol, symbol_metadata.symbol_size);
     FWriteRetryOnErr(g_bin_file_ptr, fn_sig, symbol_metadata.fn_sig_size);
@@ -348,6 +357,7 @@ jint OpenLogFiles(const char* options) {
 
   g_log_file_ptr = nullptr;
   g_bin_file_ptr = nullptr;
+  g_symbol_ring = nullptr;
 
   if (kUsingTxtLogFile) {
     // TODO(jps): remove the txt based log file once we finalize java symbolization.
@@ -356,7 +366,15 @@ jint OpenLogFiles(const char* options) {
       return JNI_ERR;
     }
   }
-  if (kUsingBinLogFile) {
+  if (kUsingSymbolRing) {
+    const std::string ring_path = artifacts_path + "/" + px::stirling::java::kSymbolRingFileName;
+    g_symbol_ring = px::stirling::java::SymbolRingBuffer::Create(ring_path.c_str());
+    if (g_symbol_ring == nullptr) {
+      LogF("[error] OpenLogFiles() Unable to create: %s.", ring_path.c_str());
+    }
+  }
+  if (kUsingBinLogFile && g_symbol_ring == nullptr) {
+    // Falls back to the symbol file if the ring buffer cannot be created.
     g_bin_file_ptr = FOpenLogFile(artifacts_path + "/" + px::stirling::java::kBinSymbolFileName);
     if (g_bin_file_ptr == nullptr) {
       return JNI_ERR;
@@ -16,12 +16,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <memory>
 #include <string>
 
 #include "src/common/exec/subprocess.h"
 #include "src/common/fs/fs_wrapper.h"
 #include "src/stirling/source_connectors/perf_profiler/java/agent/agent_hash.h"
 #include "src/stirling/source_connectors/perf_profiler/java/agent/raw_symbol_update.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/symbol_ring_buffer.h"
 #include "src/stirling/testing/common.h"
 
 namespace px {
@@ -40,11 +42,11 @@ TEST(JavaAgentTest, ExpectedSymbolsTest) {
   ASSERT_TRUE(fs::Exists(kBazelAppPath));
 
   const fs_path artifacts_path = absl::Substitute("java-agent-test-$0", PX_JVMTI_AGENT_HASH);
-  const fs_path symbol_file_path = artifacts_path / java::kBinSymbolFileName;
+  const fs_path symbol_ring_path = artifacts_path / java::kSymbolRingFileName;
 
   if (fs::Exists(artifacts_path)) {
-    // The symbol file is created by the Java process when the agent is attached.
-    // A left over stale symbol file can cause this test to pass when it should fail.
+    // The symbol ring buffer is created by the Java process when the agent is attached.
+    // A left over stale symbol ring buffer can cause this test to pass when it should fail.
     // Here, we prevent that from happening.
     char const* const stale_path_msg = "Removing stale symbolization artifacts path: $0.";
     LOG(WARNING) << absl::Substitute(stale_path_msg, artifacts_path.string());
@@ -57,9 +59,16 @@ TEST(JavaAgentTest, ExpectedSymbolsTest) {
   ASSERT_OK(sub_process.Start({kBazelAppPath})) << "Could not start Java app: " << kJavaAppName;
   std::this_thread::sleep_for(std::chrono::seconds(5));
 
-  const auto r = ReadFileToString(std::string(symbol_file_path), std::ios_base::binary);
-  ASSERT_OK(r);
-  const auto s = r.ValueOrDie();
+  std::unique_ptr<java::SymbolRingBuffer> symbol_ring(
+      java::SymbolRingBuffer::Open(symbol_ring_path.c_str()));
+  ASSERT_NE(symbol_ring, nullptr);
+
+  // The symbol strings of all updates, which the expected symbols are searched for.
+  std::string s;
+  ASSERT_TRUE(symbol_ring->Consume(
+      [&s](const java::RawSymbolUpdate& /*update*/, const std::string& buffer) {
+        s.append(buffer);
+      }));
 
   const absl::flat_hash_set<std::string> expected_symbols = {
       "()J",
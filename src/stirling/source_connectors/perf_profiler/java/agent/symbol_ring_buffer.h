@@ -0,0 +1,251 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+
+// NOLINTNEXTLINE: build/include_subdir
+#include "raw_symbol_update.h"
+
+// This file is shared by the JVMTI agent, which writes symbol updates into the ring buffer, and
+// by Stirling, which consumes them. It is compiled into the agent, so it must only depend on the
+// standard library and on raw_symbol_update.h.
+
+namespace px {
+namespace stirling {
+namespace java {
+
+char const* const kSymbolRingFileName = "java-symbols.ring";
+
+// The ring buffer is a file that the agent and Stirling both map, so symbol updates are passed
+// through memory rather than written to, and read back from, the symbol file.
+// The agent is the only writer, and Stirling the only reader.
+struct SymbolRingHeader {
+  static constexpr uint64_t kMagic = 0x50585253594d0001;  // "PXRSYM" and a version.
+
+  uint64_t magic;
+  // The size of the data area, after the header; a power of 2.
+  uint64_t capacity;
+
+  // Positions are byte counts since the ring was created, so they only ever increase.
+  // Each is on its own cache line, because they are written by different processes.
+  alignas(64) std::atomic<uint64_t> write_pos;
+  alignas(64) std::atomic<uint64_t> read_pos;
+
+  // Updates dropped by the agent because the ring was full.
+  alignas(64) std::atomic<uint64_t> num_dropped;
+};
+
+// The positions are shared across processes, which requires lock-free atomics.
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+// Symbol updates are written as a RawSymbolUpdate followed by its strings, padded to 8 bytes.
+inline uint64_t SymbolRingRecordSize(const RawSymbolUpdate& update) {
+  const uint64_t size = sizeof(RawSymbolUpdate) + update.TotalNumSymbolBytes();
+  return (size + 7) & ~uint64_t{7};
+}
+
+class SymbolRingBuffer {
+ public:
+  static constexpr uint64_t kDefaultCapacity = 16 * 1024 * 1024;
+
+  // Maps an existing ring buffer file. Returns nullptr if it cannot be mapped, or is not a
+  // ring buffer.
+  static SymbolRingBuffer* Open(const char* path) {
+    const int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st;
+    void* mem = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > sizeof(SymbolRingHeader)) {
+      mem = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mem == MAP_FAILED) {
+      return nullptr;
+    }
+    auto* header = static_cast<SymbolRingHeader*>(mem);
+    const uint64_t capacity = header->capacity;
+    if (header->magic != SymbolRingHeader::kMagic || (capacity & (capacity - 1)) != 0 ||
+        sizeof(SymbolRingHeader) + capacity != static_cast<uint64_t>(st.st_size)) {
+      munmap(mem, st.st_size);
+      return nullptr;
+    }
+    return new SymbolRingBuffer(header, capacity);
+  }
+
+  // Creates the ring buffer file, with the given capacity (a power of 2), and maps it.
+  // The file is initialized under a temporary name, so a reader never sees it half initialized.
+  static SymbolRingBuffer* Create(const char* path, uint64_t capacity = kDefaultCapacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+      return nullptr;
+    }
+    const std::string tmp_path = std::string(path) + ".tmp";
+    const uint64_t size = sizeof(SymbolRingHeader) + capacity;
+
+    const int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      return nullptr;
+    }
+    void* mem = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+      mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mem == MAP_FAILED) {
+      unlink(tmp_path.c_str());
+      return nullptr;
+    }
+
+    auto* header = new (mem) SymbolRingHeader();
+    header->capacity = capacity;
+    header->write_pos.store(0);
+    header->read_pos.store(0);
+    header->num_dropped.store(0);
+    header->magic = SymbolRingHeader::kMagic;
+
+    if (rename(tmp_path.c_str(), path) != 0) {
+      munmap(mem, size);
+      unlink(tmp_path.c_str());
+      return nullptr;
+    }
+    return new SymbolRingBuffer(header, capacity);
+  }
+
+  ~SymbolRingBuffer() { munmap(header_, sizeof(SymbolRingHeader) + capacity_); }
+
+  SymbolRingBuffer(const SymbolRingBuffer&) = delete;
+  SymbolRingBuffer& operator=(const SymbolRingBuffer&) = delete;
+
+  // Writer side. Returns false, and counts the update as dropped, if the ring is full;
+  // the writer never blocks, because it runs inside of JVM callbacks.
+  bool Write(const RawSymbolUpdate& update, const char* symbol, const char* fn_sig,
+             const char* class_sig) {
+    const uint64_t record_size = SymbolRingRecordSize(update);
+    const uint64_t write_pos = header_->write_pos.load(std::memory_order_relaxed);
+    const uint64_t read_pos = header_->read_pos.load(std::memory_order_acquire);
+    if (capacity_ - (write_pos - read_pos) < record_size) {
+      header_->num_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    uint64_t pos = write_pos;
+    pos = CopyIn(pos, &update, sizeof(update));
+    pos = CopyIn(pos, symbol, update.symbol_size);
+    pos = CopyIn(pos, fn_sig, update.fn_sig_size);
+    CopyIn(pos, class_sig, update.class_sig_size);
+
+    // Publishes the record, once all of it is written.
+    header_->write_pos.store(write_pos + record_size, std::memory_order_release);
+    return true;
+  }
+
+  // Reader side. Calls fn(update, symbol_bytes) for each record written since the last call,
+  // where symbol_bytes holds the update's strings, at the offsets given by RawSymbolUpdate.
+  // Returns false if the ring holds a malformed record, after which nothing more is read.
+  // The ring is writable by the target process, so nothing read from it is trusted.
+  template <typename TFn>
+  bool Consume(TFn fn) {
+    uint64_t read_pos = header_->read_pos.load(std::memory_order_relaxed);
+    const uint64_t write_pos = header_->write_pos.load(std::memory_order_acquire);
+    if (write_pos < read_pos || write_pos - read_pos > capacity_) {
+      return false;
+    }
+
+    RawSymbolUpdate update;
+    while (read_pos < write_pos) {
+      const uint64_t available = write_pos - read_pos;
+      if (available < sizeof(update)) {
+        return false;
+      }
+      CopyOut(read_pos, &update, sizeof(update));
+      if (!IsValid(update, available)) {
+        return false;
+      }
+      const uint64_t record_size = SymbolRingRecordSize(update);
+      buffer_.resize(update.TotalNumSymbolBytes());
+      CopyOut(read_pos + sizeof(update), buffer_.data(), buffer_.size());
+      fn(update, buffer_);
+      read_pos += record_size;
+      // Frees up the space as records are consumed, so the writer can reuse it.
+      header_->read_pos.store(read_pos, std::memory_order_release);
+    }
+    return true;
+  }
+
+  uint64_t num_dropped() const { return header_->num_dropped.load(std::memory_order_relaxed); }
+
+ private:
+  SymbolRingBuffer(SymbolRingHeader* header, uint64_t capacity)
+      : header_(header),
+        data_(reinterpret_cast<char*>(header) + sizeof(SymbolRingHeader)),
+        capacity_(capacity) {}
+
+  // Checks the sizes of each string, so that they cannot overflow or run past the record.
+  static bool IsValid(const RawSymbolUpdate& update, uint64_t available) {
+    const uint64_t sizes[] = {update.symbol_size, update.fn_sig_size, update.class_sig_size};
+    for (const uint64_t size : sizes) {
+      // Each string includes its null terminator.
+      if (size == 0 || size > available) {
+        return false;
+      }
+    }
+    return SymbolRingRecordSize(update) <= available;
+  }
+
+  // Copies n bytes into the ring at pos, wrapping around its end. Returns the position after.
+  uint64_t CopyIn(uint64_t pos, const void* src, uint64_t n) {
+    const uint64_t offset = pos & (capacity_ - 1);
+    const uint64_t first = std::min(n, capacity_ - offset);
+    memcpy(data_ + offset, src, first);
+    memcpy(data_, static_cast<const char*>(src) + first, n - first);
+    return pos + n;
+  }
+
+  void CopyOut(uint64_t pos, void* dst, uint64_t n) const {
+    const uint64_t offset = pos & (capacity_ - 1);
+    const uint64_t first = std::min(n, capacity_ - offset);
+    memcpy(dst, data_ + offset, first);
+    memcpy(static_cast<char*>(dst) + first, data_, n - first);
+  }
+
+  SymbolRingHeader* const header_;
+  char* const data_;
+  // Copied out of the header when mapped, so that the target process cannot change it.
+  const uint64_t capacity_;
+
+  // Holds the strings of the record being consumed.
+  std::string buffer_;
+};
+
+}  // namespace java
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/symbol_ring_buffer.h"
+
+namespace px {
+namespace stirling {
+namespace java {
+
+namespace {
+
+struct Symbol {
+  uint64_t addr;
+  std::string symbol;
+  std::string fn_sig;
+  std::string class_sig;
+};
+
+bool WriteSymbol(SymbolRingBuffer* ring, const Symbol& s) {
+  const RawSymbolUpdate update = {.addr = s.addr,
+                                  .code_size = 16,
+                                  .symbol_size = 1 + s.symbol.size(),
+                                  .fn_sig_size = 1 + s.fn_sig.size(),
+                                  .class_sig_size = 1 + s.class_sig.size(),
+                                  .method_unload = false};
+  return ring->Write(update, s.symbol.c_str(), s.fn_sig.c_str(), s.class_sig.c_str());
+}
+
+std::vector<Symbol> ConsumeSymbols(SymbolRingBuffer* ring) {
+  std::vector<Symbol> symbols;
+  const bool ok = ring->Consume([&](const RawSymbolUpdate& update, const std::string& buffer) {
+    symbols.push_back({update.addr,
+                       std::string(buffer.data() + update.SymbolOffset(), update.symbol_size - 1),
+                       std::string(buffer.data() + update.FnSigOffset(), update.fn_sig_size - 1),
+                       std::string(buffer.data() + update.ClassSigOffset(),
+                                   update.class_sig_size - 1)});
+  });
+  EXPECT_TRUE(ok);
+  return symbols;
+}
+
+}  // namespace
+
+TEST(SymbolRingBufferTest, WriteAndConsume) {
+  px::testing::TempDir tmp_dir;
+  const std::string path = tmp_dir.path() / kSymbolRingFileName;
+
+  std::unique_ptr<SymbolRingBuffer> writer(SymbolRingBuffer::Create(path.c_str(), 1024));
+  ASSERT_NE(writer, nullptr);
+  std::unique_ptr<SymbolRingBuffer> reader(SymbolRingBuffer::Open(path.c_str()));
+  ASSERT_NE(reader, nullptr);
+
+  EXPECT_TRUE(ConsumeSymbols(reader.get()).empty());
+
+  ASSERT_TRUE(WriteSymbol(writer.get(), {0x1000, "foo", "()V", "LFoo;"}));
+  ASSERT_TRUE(WriteSymbol(writer.get(), {0x2000, "bar", "(I)J", "LBar;"}));
+
+  std::vector<Symbol> symbols = ConsumeSymbols(reader.get());
+  ASSERT_EQ(symbols.size(), 2);
+  EXPECT_EQ(symbols[0].addr, 0x1000);
+  EXPECT_EQ(symbols[0].symbol, "foo");
+  EXPECT_EQ(symbols[0].fn_sig, "()V");
+  EXPECT_EQ(symbols[0].class_sig, "LFoo;");
+  EXPECT_EQ(symbols[1].addr, 0x2000);
+  EXPECT_EQ(symbols[1].class_sig, "LBar;");
+
+  // Only new updates are consumed.
+  ASSERT_TRUE(WriteSymbol(writer.get(), {0x3000, "baz", "()V", "LBaz;"}));
+  symbols = ConsumeSymbols(reader.get());
+  ASSERT_EQ(symbols.size(), 1);
+  EXPECT_EQ(symbols[0].symbol, "baz");
+}
+
+TEST(SymbolRingBufferTest, WrapsAround) {
+  px::testing::TempDir tmp_dir;
+  const std::string path = tmp_dir.path() / kSymbolRingFileName;
+
+  std::unique_ptr<SymbolRingBuffer> writer(SymbolRingBuffer::Create(path.c_str(), 256));
+  ASSERT_NE(writer, nullptr);
+  std::unique_ptr<SymbolRingBuffer> reader(SymbolRingBuffer::Open(path.c_str()));
+  ASSERT_NE(reader, nullptr);
+
+  for (uint64_t i = 0; i < 50; ++i) {
+    const std::string symbol = absl::StrCat("method", i);
+    ASSERT_TRUE(WriteSymbol(writer.get(), {i, symbol, "()V", "LFoo;"}));
+    std::vector<Symbol> symbols = ConsumeSymbols(reader.get());
+    ASSERT_EQ(symbols.size(), 1);
+    EXPECT_EQ(symbols[0].addr, i);
+    EXPECT_EQ(symbols[0].symbol, symbol);
+  }
+  EXPECT_EQ(reader->num_dropped(), 0);
+}
+
+TEST(SymbolRingBufferTest, DropsWhenFull) {
+  px::testing::TempDir tmp_dir;
+  const std::string path = tmp_dir.path() / kSymbolRingFileName;
+
+  std::unique_ptr<SymbolRingBuffer> writer(SymbolRingBuffer::Create(path.c_str(), 256));
+  ASSERT_NE(writer, nullptr);
+  std::unique_ptr<SymbolRingBuffer> reader(SymbolRingBuffer::Open(path.c_str()));
+  ASSERT_NE(reader, nullptr);
+
+  int num_written = 0;
+  while (WriteSymbol(writer.get(), {0x1000, "foo", "()V", "LFoo;"})) {
+    ++num_written;
+  }
+  EXPECT_GT(num_written, 0);
+  EXPECT_EQ(reader->num_dropped(), 1);
+
+  EXPECT_EQ(ConsumeSymbols(reader.get()).size(), num_written);
+  EXPECT_TRUE(WriteSymbol(writer.get(), {0x1000, "foo", "()V", "LFoo;"}));
+}
+
+TEST(SymbolRingBufferTest, OpenInvalid) {
+  px::testing::TempDir tmp_dir;
+  const std::string path = tmp_dir.path() / kSymbolRingFileName;
+
+  EXPECT_EQ(SymbolRingBuffer::Open(path.c_str()), nullptr);
+
+  ASSERT_OK(WriteFileFromString(path, std::string(4096, 'x')));
+  EXPECT_EQ(SymbolRingBuffer::Open(path.c_str()), nullptr);
+
+  // The capacity must be a power of 2.
+  EXPECT_EQ(SymbolRingBuffer::Create(path.c_str(), 1000), nullptr);
+}
+
+}  // namespace java
+}  // namespace stirling
+}  // namespace px
@@ -33,6 +33,7 @@
 #include "src/common/system/scoped_namespace.h"
 #include "src/stirling/source_connectors/perf_profiler/java/agent/agent_hash.h"
 #include "src/stirling/source_connectors/perf_profiler/java/agent/raw_symbol_update.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/symbol_ring_buffer.h"
 #include "src/stirling/source_connectors/perf_profiler/java/attach.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
@@ -59,6 +60,10 @@ std::filesystem::path StirlingSymbolFilePath(const struct upid_t& upid) {
   return StirlingArtifactsPath(upid) / kBinSymbolFileName;
 }
 
+std::filesystem::path StirlingSymbolRingPath(const struct upid_t& upid) {
+  return StirlingArtifactsPath(upid) / kSymbolRingFileName;
+}
+
 StatusOr<std::filesystem::path> ResolveHostArtifactsPath(const struct upid_t& upid) {
   // TODO(jps): To avoid repeated accesses to /proc, investigate if we can reuse the
   // results of this call into ResolvePath. e.g., if we need to resolve the /tmp mount
@@ -17,11 +17,13 @@
  */
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "src/common/exec/subprocess.h"
 #include "src/common/fs/fs_wrapper.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/symbol_ring_buffer.h"
 #include "src/stirling/source_connectors/perf_profiler/java/attach.h"
 #include "src/stirling/source_connectors/perf_profiler/testing/testing.h"
 #include "src/stirling/testing/common.h"
@@ -86,12 +88,12 @@ TEST(JavaAgentTest, ExpectedSymbolsTest) {
   LOG(INFO) << absl::StrFormat("Started Java app: %s, pid: %d.", kJavaAppName, child_pid);
 
   // Construct struct upid_t for our child process,
-  // use that to construct the symbol file path.
+  // use that to construct the symbol ring buffer path.
   using ::px::system::GetPIDStartTimeTicks;
   const std::string proc_pid_path = std::string("/proc/") + std::to_string(child_pid);
   ASSERT_OK_AND_ASSIGN(const uint64_t start_time, GetPIDStartTimeTicks(proc_pid_path));
   const struct upid_t child_upid = {{child_pid}, start_time};
-  const fs_path symbol_file_path = java::StirlingSymbolFilePath(child_upid);
+  const fs_path symbol_ring_path = java::StirlingSymbolRingPath(child_upid);
 
   // Invoke the attach process by creating an attach object.
   auto attacher = java::AgentAttacher(child_upid, libs_arg);
@@ -112,14 +114,18 @@ TEST(JavaAgentTest, ExpectedSymbolsTest) {
   LOG(INFO) << absl::StrFormat("Java attach required waiting for %d milliseconds.",
                                time_spent_waiting.count());
 
-  // After attach is complete, wait a little more for the symbol file to materialize fully.
+  // After attach is complete, wait a little more for the symbols to be written.
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  auto SymbolFileOrStatus = [&]() {
-    return ReadFileToString(symbol_file_path.string(), std::ios_base::binary);
-  };
-  ASSERT_OK_AND_ASSIGN(const auto file_contents, SymbolFileOrStatus());
-
-  // Check to see if the symbol file has some symbols.
+  std::unique_ptr<java::SymbolRingBuffer> symbol_ring(
+      java::SymbolRingBuffer::Open(symbol_ring_path.c_str()));
+  ASSERT_NE(symbol_ring, nullptr);
+  std::string symbol_contents;
+  ASSERT_TRUE(symbol_ring->Consume(
+      [&](const java::RawSymbolUpdate& /*update*/, const std::string& buffer) {
+        symbol_contents.append(buffer);
+      }));
+
+  // Check to see if the symbol ring buffer has some symbols.
   const absl::flat_hash_set<std::string> expected_symbols = {
       "()J",
       "fibs1x",
@@ -134,7 +140,7 @@ TEST(JavaAgentTest, ExpectedSymbolsTest) {
       "(Ljava/lang/Object;)I",
   };
   for (const auto& expected_symbol : expected_symbols) {
-    EXPECT_THAT(file_contents, HasSubstr(expected_symbol));
+    EXPECT_THAT(symbol_contents, HasSubstr(expected_symbol));
   }
 
   // Cleanup.
@@ -27,12 +27,36 @@
 #include <vector>
 
 #include "src/stirling/bpf_tools/macros.h"
+#include "src/stirling/source_connectors/perf_profiler/pprof_builder.h"
 
 BPF_SRC_STRVIEW(profiler_bcc_script, profiler);
 
 DEFINE_string(stirling_profiler_symbolizer, "bcc",
               "Choice of which symbolizer to use. Options: bcc, elf");
 DEFINE_bool(stirling_profiler_cache_symbols, true, "Whether to cache symbols");
+DEFINE_bool(stirling_profiler_async_symbolization, true,
+            "Whether to symbolize stack traces on a background thread. If so, the stack traces of "
+            "an iteration are pushed to the table on a later iteration.");
+DEFINE_bool(stirling_profiler_pprof_output, false,
+            "If true, also output a pprof format profile of each process, for each batch of "
+            "symbolized stack traces, to the stack_trace_profiles.beta table.");
+DEFINE_bool(stirling_profiler_adaptive_sampling, false,
+            "If true, the stack trace sampling rate is lowered, down to 1/max_sample_stride of the "
+            "configured rate, to keep the CPU cost of the profiler within its budget.");
+DEFINE_double(stirling_profiler_cpu_budget_percent, 1.0,
+              "With adaptive sampling, the target CPU cost of the profiler, in percent of one "
+              "CPU.");
+DEFINE_uint32(stirling_profiler_max_sample_stride, 16,
+              "With adaptive sampling, at least one in this many samples is kept.");
+DEFINE_bool(stirling_profiler_offcpu, false,
+            "If true, also profile the time that threads spend blocked, by the stack traces they "
+            "block in, to the offcpu_stack_traces.beta table.");
+DEFINE_uint32(stirling_profiler_offcpu_min_block_us, 100,
+              "Off-CPU time is only counted for blocks of at least this many microseconds, which "
+              "limits the cost of off-CPU profiling.");
+DEFINE_uint32(stirling_profiler_offcpu_max_stack_traces, 16384,
+              "The number of distinct off-CPU stack traces kept in BPF per table update period. "
+              "Off-CPU time in further stack traces is dropped.");
 DEFINE_uint32(stirling_profiler_log_period_minutes, 10,
               "Number of minutes between profiler stats log printouts.");
 DEFINE_uint32(stirling_profiler_table_update_period_seconds,
@@ -71,6 +95,7 @@ PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
 Status PerfProfileConnector::InitImpl() {
   sampling_freq_mgr_.set_period(sampling_period_);
   push_freq_mgr_.set_period(push_period_);
+  proc_tracker_.EnableProcEvents();
 
   const size_t ncpus = get_nprocs_conf();
 
@@ -117,9 +142,18 @@ Status PerfProfileConnector::InitImpl() {
       sizeof(struct perf_event_header) + sizeof(uint32_t) + sizeof(stack_trace_key_t);
   const int32_t perf_buffer_size = perf_buffer_entry_size * num_perf_buffer_entries;
 
+  // The threads that can be switched out at once, for off-CPU profiling.
+  constexpr int32_t kOffCPUMaxThreads = 65536;
+
   const std::vector<std::string> defines = {
       absl::Substitute("-DCFG_STACK_TRACE_ENTRIES=$0", provisioned_stack_traces),
       absl::Substitute("-DCFG_OVERRUN_THRESHOLD=$0", overrun_threshold),
+      absl::Substitute("-DCFG_OFFCPU=$0", FLAGS_stirling_profiler_offcpu ? 1 : 0),
+      absl::Substitute("-DCFG_OFFCPU_MAX_THREADS=$0", kOffCPUMaxThreads),
+      absl::Substitute("-DCFG_OFFCPU_STACK_TRACE_ENTRIES=$0",
+                       FLAGS_stirling_profiler_offcpu_max_stack_traces),
+      absl::Substitute("-DCFG_OFFCPU_MIN_BLOCK_NS=$0ULL",
+                       1000ULL * FLAGS_stirling_profiler_offcpu_min_block_us),
   };
 
   const auto probe_specs = MakeArray<bpf_tools::SamplingProbeSpec>(
@@ -144,6 +178,30 @@ Status PerfProfileConnector::InitImpl() {
 
   LOG(INFO) << "PerfProfiler: Stack trace profiling sampling probe successfully deployed.";
 
+  if (FLAGS_stirling_profiler_adaptive_sampling) {
+    adaptive_sampler_ = std::make_unique<AdaptiveSampler>(
+        FLAGS_stirling_profiler_cpu_budget_percent / 100.0,
+        FLAGS_stirling_profiler_max_sample_stride);
+    last_stride_update_time_ = std::chrono::steady_clock::now();
+  }
+
+  if (FLAGS_stirling_profiler_offcpu) {
+    const auto tracepoint_specs = MakeArray<bpf_tools::TracepointSpec>(
+        {{std::string("sched:sched_switch"), std::string("tracepoint__sched__sched_switch")}});
+    PL_RETURN_IF_ERROR(AttachTracepoints(tracepoint_specs));
+
+    offcpu_stack_traces_a_ =
+        std::make_unique<ebpf::BPFStackTable>(GetStackTable("offcpu_stack_traces_a"));
+    offcpu_stack_traces_b_ =
+        std::make_unique<ebpf::BPFStackTable>(GetStackTable("offcpu_stack_traces_b"));
+
+    LOG(INFO) << "PerfProfiler: Off-CPU profiling tracepoint successfully deployed.";
+  }
+
+  return InitSymbolizers();
+}
+
+Status PerfProfileConnector::InitSymbolizers() {
   // Create a symbolizer for user symbols.
   if (FLAGS_stirling_profiler_symbolizer == "bcc") {
     PL_ASSIGN_OR_RETURN(u_symbolizer_, BCCSymbolizer::Create());
@@ -174,6 +232,10 @@ Status PerfProfileConnector::InitImpl() {
 }
 
 Status PerfProfileConnector::StopImpl() {
+  if (symbolization_thread_.joinable()) {
+    symbolization_thread_.join();
+  }
+
   // Must call Close() after attach_uprobes_thread_ has joined,
   // otherwise the two threads will cause concurrent accesses to BCC,
   // that will cause races and undefined behavior.
@@ -198,7 +260,7 @@ void PerfProfileConnector::HandleHistoLoss(void* cb_cookie, uint64_t lost) {
   connector->stats_.Increment(StatKey::kLossHistoEvent, lost);
 }
 
-void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids) {
+void PerfProfileConnector::CleanupSymbolizers(const md::UPIDSet& deleted_upids) {
   for (const auto& md_upid : deleted_upids) {
     // Clean-up caches.
     struct upid_t upid;
@@ -219,117 +281,249 @@ void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID
   }
 }
 
-PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
-    ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces) {
-  // TODO(jps): switch from using get_table_offline() to directly stepping through
-  // the histogram data structure. Inline populating our own data structures with this.
-  // Avoid an unnecessary copy of the information in local stack_trace_keys_and_counts.
-  StackTraceHisto symbolic_histogram;
-  uint64_t cum_sum_count = 0;
+void PerfProfileConnector::ReadStackTraces(
+    ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces,
+    const std::vector<std::pair<stack_trace_key_t, uint64_t>>& weighted_keys,
+    WeightedStackTraces* output) {
+  // A destructive read, which clears the stack-id out of the BPF stack traces table.
+  auto read_stack_fn = [stack_traces](int stack_id) {
+    constexpr bool kClearStackId = true;
+    return stack_traces->get_stack_addr(stack_id, kClearStackId);
+  };
+  auto clear_stack_fn = [stack_traces](int stack_id) { stack_traces->clear_stack_id(stack_id); };
+  ReadStackTraces(ctx, read_stack_fn, clear_stack_fn, weighted_keys, output);
+}
 
+void PerfProfileConnector::ReadStackTraces(
+    ConnectorContext* ctx, const Stringifier::StackAddrsFn& read_stack_fn,
+    const std::function<void(int)>& clear_stack_fn,
+    const std::vector<std::pair<stack_trace_key_t, uint64_t>>& weighted_keys,
+    WeightedStackTraces* output) {
   const uint32_t asid = ctx->GetASID();
-  const absl::flat_hash_set<md::UPID>& upids_for_symbolization = ctx->GetUPIDs();
-
-  // Cause symbolizers to perform any necessary updates before we put them to work.
-  u_symbolizer_->IterationPreTick();
-  k_symbolizer_->IterationPreTick();
-
-  // Create a new stringifier for this iteration of the continuous perf profiler.
-  Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), stack_traces);
-
-  absl::flat_hash_set<int> k_stack_ids_to_remove;
+  const md::UPIDSet& upids_for_symbolization = ctx->GetUPIDs();
+
+  // Stack-ids are only unique within one BPF map, for one iteration, but a batch can hold the
+  // stack traces of several iterations, so each stack-id is given a new id within the batch.
+  absl::flat_hash_map<int, int> batch_stack_ids;
+  auto read_stack = [&](int* stack_id) {
+    if (*stack_id < 0) {
+      return;
+    }
+    auto [iter, inserted] = batch_stack_ids.try_emplace(*stack_id, 0);
+    if (inserted) {
+      iter->second = static_cast<int>(pending_batch_.stack_addrs.size());
+      pending_batch_.stack_addrs[iter->second] = read_stack_fn(*stack_id);
+    }
+    *stack_id = iter->second;
+  };
 
-  for (const auto& stack_trace_key : raw_histo_data_) {
-    std::string stack_trace_str;
+  absl::flat_hash_set<int> stack_ids_to_remove;
 
+  for (auto [stack_trace_key, weight] : weighted_keys) {
     const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
-    const bool symbolize = upids_for_symbolization.contains(upid);
-
-    if (symbolize) {
-      // The stringifier clears stack-ids out of the stack traces table when it
-      // first encounters them. If a stack-id is reused by a different stack-trace-key,
-      // the stringifier returns its memoized stack trace string. Because the stack-ids
-      // are not stable across profiler iterations, we create and destroy a stringifer
-      // on each profiler iteration.
-      stack_trace_str = stringifier.FoldedStackTraceString(stack_trace_key);
+
+    if (upids_for_symbolization.contains(upid)) {
+      read_stack(&stack_trace_key.user_stack_id);
+      read_stack(&stack_trace_key.kernel_stack_id);
+      output->keys.emplace_back(upid, stack_trace_key, weight);
     } else {
-      // If we do not stringifiy this stack trace, we still need to clear
-      // its entry from the stack traces table. It is safe to do so immediately
-      // for the user stack-id, but we need to allow the kernel stack-id to remain
-      // in the stack-traces table in case it gets used by a stack trace that we
-      // have not yet encountered on this iteration, but will need to symbolize.
+      // If we do not stringifiy this stack trace, we still need to clear its entries from the
+      // stack traces table. That is deferred, because a stack trace that we have not yet
+      // encountered on this iteration, but will need to symbolize, may use the same stack-ids.
       if (stack_trace_key.user_stack_id >= 0) {
-        stack_traces->clear_stack_id(stack_trace_key.user_stack_id);
+        stack_ids_to_remove.insert(stack_trace_key.user_stack_id);
       }
       if (stack_trace_key.kernel_stack_id >= 0) {
-        k_stack_ids_to_remove.insert(stack_trace_key.kernel_stack_id);
+        stack_ids_to_remove.insert(stack_trace_key.kernel_stack_id);
       }
-      stack_trace_str = std::string(profiler::kNotSymbolizedMessage);
+      output->not_symbolized_weights[upid] += weight;
     }
+  }
+
+  // Clear any stack-ids, that were not already cleared, out of the stack traces table.
+  for (const int stack_id : stack_ids_to_remove) {
+    if (!batch_stack_ids.contains(stack_id)) {
+      clear_stack_fn(stack_id);
+    }
+  }
+}
+
+void PerfProfileConnector::ReadOffCPUStackTraces(ConnectorContext* ctx, bool using_map_set_a) {
+  const std::string histogram = using_map_set_a ? "offcpu_histogram_a" : "offcpu_histogram_b";
+  auto& stack_traces = using_map_set_a ? offcpu_stack_traces_a_ : offcpu_stack_traces_b_;
 
-    profiler::SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
+  constexpr bool kClearTable = true;
+  ReadStackTraces(ctx, stack_traces.get(),
+                  GetHashTableEntries<stack_trace_key_t, uint64_t>(histogram, kClearTable),
+                  &pending_batch_.off_cpu);
 
-    ++symbolic_histogram[symbolic_stack_trace];
-    ++cum_sum_count;
+  // Stacks are walked when threads block, but blocks that are too short, or that span a switch
+  // of map sets, do not make it into the histogram, so the rest of their stacks are cleared here.
+  stack_traces->clear_table_non_atomic();
 
-    // TODO(jps): If we see a perf. issue with having two maps keyed by symbolic-stack-trace,
-    // refactor such that creating/finding symoblic-stack-trace-id and count aggregation
-    // are both done here, in AggregateStackTraces().
-    // One possible implementation:
-    // make the histogram a map from "symbolic-track-trace" => "count & stack-trace-id"
-    // e.g.:
-    // ... auto& count_and_id = symbolic_histogram[symbolic_stack_trace];
-    // ... count_and_id.id = id;
-    // ... count_and_id.count += count;
-    // alternate impl. is a map from "stack-trace-id" => "count & symbolic-stack-trace"
+  uint64_t num_dropped = 0;
+  profiler_state_->get_value(kOffCPUDropCountIdx, num_dropped);
+  if (num_dropped > 0) {
+    profiler_state_->update_value(kOffCPUDropCountIdx, 0);
+    stats_.Increment(StatKey::kOffCPUDropEvent, num_dropped);
   }
+}
+
+PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
+    const WeightedStackTraces& stack_traces, Stringifier* stringifier) {
+  StackTraceHisto symbolic_histogram;
 
-  // Clear any kernel stack-ids, that were potentially not already cleared,
-  // out of the stack traces table.
-  for (const int k_stack_id : k_stack_ids_to_remove) {
-    stack_traces->clear_stack_id(k_stack_id);
+  for (const auto& [upid, stack_trace_key, weight] : stack_traces.keys) {
+    profiler::SymbolicStackTrace symbolic_stack_trace = {
+        upid, stringifier->FoldedStackTrace(stack_trace_key)};
+    symbolic_histogram[symbolic_stack_trace] += weight;
   }
 
-  raw_histo_data_.clear();
+  const uint32_t not_symbolized_stack =
+      stack_trace_ids_.interner()->InternFoldedString(profiler::kNotSymbolizedMessage);
+  for (const auto& [upid, weight] : stack_traces.not_symbolized_weights) {
+    profiler::SymbolicStackTrace symbolic_stack_trace = {upid, not_symbolized_stack};
+    symbolic_histogram[symbolic_stack_trace] += weight;
+  }
 
-  VLOG(1) << "PerfProfileConnector::AggregateStackTraces(): cum_sum_count: " << cum_sum_count;
-  stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, cum_sum_count);
   return symbolic_histogram;
 }
 
-void PerfProfileConnector::CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
-                                         DataTable* data_table) {
-  constexpr size_t kMaxSymbolSize = 512;
-  constexpr size_t kMaxStackDepth = 64;
-  constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
-
-  const uint64_t timestamp_ns = AdjustedSteadyClockNowNS();
+std::vector<PerfProfileConnector::StackTraceRecord> PerfProfileConnector::CreateStackTraceRecords(
+    const StackTraceHisto& histogram) {
+  // The folded stack trace strings are only materialized here, for the output.
+  std::vector<StackTraceRecord> records;
+  records.reserve(histogram.size());
+  for (const auto& [key, count] : histogram) {
+    records.push_back({key.upid, stack_trace_ids_.Lookup(key),
+                       stack_trace_ids_.interner()->FoldedString(key.interned_stack), count});
+  }
+  return records;
+}
 
+PerfProfileConnector::SymbolizedBatch PerfProfileConnector::SymbolizeStackTraces(
+    const StackTraceBatch& batch) {
   // Stack traces from kernel/BPF are ordered lists of instruction pointers (addresses).
   // AggregateStackTraces() will collapse some of those into identical symbolic stack traces;
   // for example, consider the following two stack traces from BPF:
   // p0, p1, p2 => main;qux;baz   # both p2 & p3 point into baz.
   // p0, p1, p3 => main;qux;baz
 
-  StackTraceHisto stack_trace_histogram = AggregateStackTraces(ctx, stack_traces);
-
-  constexpr auto age_tick_period = std::chrono::minutes(5);
-  if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
+  // Aging compacts the interner, which invalidates interned stacks, so it happens first.
+  for (uint64_t i = 0; i < batch.num_age_ticks; ++i) {
     stack_trace_ids_.AgeTick();
   }
 
-  for (const auto& [key, count] : stack_trace_histogram) {
-    DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
+  // Cause symbolizers to perform any necessary updates before we put them to work.
+  u_symbolizer_->IterationPreTick();
+  k_symbolizer_->IterationPreTick();
+
+  // The stringifier memoizes the stack trace of each stack-id, which are unique within
+  // the batch; so a new stringifier is created for each batch. Stack traces are interned in the
+  // stack trace ID cache's interner, which they are then looked up in, so on-CPU and off-CPU
+  // stack traces share their IDs.
+  Stringifier stringifier(
+      u_symbolizer_.get(), k_symbolizer_.get(),
+      [&batch](int stack_id) {
+        auto iter = batch.stack_addrs.find(stack_id);
+        return iter == batch.stack_addrs.end() ? std::vector<uintptr_t>{} : iter->second;
+      },
+      stack_trace_ids_.interner());
+
+  StackTraceHisto stack_trace_histogram = AggregateStackTraces(batch.on_cpu, &stringifier);
+  StackTraceHisto offcpu_histogram = AggregateStackTraces(batch.off_cpu, &stringifier);
+
+  SymbolizedBatch symbolized_batch;
+  symbolized_batch.stack_traces = CreateStackTraceRecords(stack_trace_histogram);
+  symbolized_batch.offcpu_stack_traces = CreateStackTraceRecords(offcpu_histogram);
+
+  // The profiles refer to frames by their interned IDs, so they too are built before the
+  // interner can be compacted again.
+  if (FLAGS_stirling_profiler_pprof_output) {
+    symbolized_batch.profiles = BuildProfiles(stack_trace_histogram, batch);
+  }
+
+  // Cleanup the symbolizer so we don't leak memory.
+  CleanupSymbolizers(batch.deleted_upids);
+
+  if (batch.print_symbolizer_stats) {
+    PrintSymbolizerStats();
+  }
+
+  return symbolized_batch;
+}
+
+std::vector<PerfProfileConnector::StackTraceProfileRecord> PerfProfileConnector::BuildProfiles(
+    const StackTraceHisto& histogram, const StackTraceBatch& batch) {
+  const int64_t period_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(stack_trace_sampling_period_).count();
+
+  md::UPIDMap<PProfBuilder> builders;
+  for (const auto& [key, count] : histogram) {
+    auto iter = builders.try_emplace(key.upid, stack_trace_ids_.interner(), period_ns).first;
+    iter->second.AddStackTrace(key.interned_stack, count);
+  }
+
+  std::vector<StackTraceProfileRecord> profiles;
+  profiles.reserve(builders.size());
+  for (auto& [upid, builder] : builders) {
+    profilerpb::Profile profile =
+        builder.Build(batch.start_time_ns, batch.end_time_ns - batch.start_time_ns);
+    profiles.push_back({upid, profile.SerializeAsString()});
+  }
+  return profiles;
+}
 
-    r.Append<r.ColIndex("time_")>(timestamp_ns);
-    r.Append<r.ColIndex("upid")>(key.upid.value());
-    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
-    r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
-    r.Append<r.ColIndex("count")>(count);
+void PerfProfileConnector::CreateRecords(const SymbolizedBatch& symbolized_batch,
+                                         const std::vector<DataTable*>& data_tables) {
+  constexpr size_t kMaxSymbolSize = 512;
+  constexpr size_t kMaxStackDepth = 64;
+  constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
+
+  // Profiles are only useful when whole, so they are not truncated like stack traces are.
+  constexpr size_t kMaxProfileSize = 64 * 1024 * 1024;
+
+  const uint64_t timestamp_ns = AdjustedSteadyClockNowNS();
+
+  DataTable* stack_traces_table = data_tables[kPerfProfileTableNum];
+  if (stack_traces_table != nullptr) {
+    for (const auto& record : symbolized_batch.stack_traces) {
+      DataTable::RecordBuilder<&kStackTraceTable> r(stack_traces_table, timestamp_ns);
+
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(record.upid.value());
+      r.Append<r.ColIndex("stack_trace_id")>(record.stack_trace_id);
+      r.Append<r.ColIndex("stack_trace")>(record.stack_trace_str, kMaxStackTraceSize);
+      r.Append<r.ColIndex("count")>(record.count);
+    }
+  }
+
+  DataTable* profiles_table = data_tables[kStackTraceProfileTableNum];
+  if (profiles_table != nullptr) {
+    for (const auto& record : symbolized_batch.profiles) {
+      DataTable::RecordBuilder<&kStackTraceProfileTable> r(profiles_table, timestamp_ns);
+
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(record.upid.value());
+      r.Append<r.ColIndex("profile")>(record.profile, kMaxProfileSize);
+    }
+  }
+
+  DataTable* offcpu_table = data_tables[kOffCPUStackTraceTableNum];
+  if (offcpu_table != nullptr) {
+    for (const auto& record : symbolized_batch.offcpu_stack_traces) {
+      DataTable::RecordBuilder<&kOffCPUStackTraceTable> r(offcpu_table, timestamp_ns);
+
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(record.upid.value());
+      r.Append<r.ColIndex("stack_trace_id")>(record.stack_trace_id);
+      r.Append<r.ColIndex("stack_trace")>(record.stack_trace_str, kMaxStackTraceSize);
+      r.Append<r.ColIndex("off_cpu_time")>(record.count);
+    }
   }
 }
 
-void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table) {
+void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx) {
   // Choose the maps to consume.
   const bool using_map_set_a = transfer_count_ % 2 == 0;
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
@@ -347,38 +541,147 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   const ebpf::StatusTuple s = profiler_state_->update_value(kTransferCountIdx, transfer_count_);
   LOG_IF(ERROR, !s.ok()) << "Error writing transfer_count_";
 
-  // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  // The maps just switched away from were written at the current stride, while the new stride
+  // applies to the maps that BPF now writes to. Samples taken while BPF switches maps may be
+  // weighed by the wrong stride, which is negligible.
+  const uint64_t sample_weight = sample_stride_;
+  UpdateSampleStride();
+
+  // Read BPF stack traces & histogram, to be symbolized later.
+  std::vector<std::pair<stack_trace_key_t, uint64_t>> weighted_keys;
+  weighted_keys.reserve(raw_histo_data_.size());
+  for (const stack_trace_key_t& key : raw_histo_data_) {
+    weighted_keys.emplace_back(key, sample_weight);
+  }
+  raw_histo_data_.clear();
+  ReadStackTraces(ctx, stack_traces.get(), weighted_keys, &pending_batch_.on_cpu);
+
+  VLOG(1) << "PerfProfileConnector::ProcessBPFStackTraces(): cum_sum_count: "
+          << weighted_keys.size();
+  stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, weighted_keys.size());
+
+  if (FLAGS_stirling_profiler_offcpu) {
+    ReadOffCPUStackTraces(ctx, using_map_set_a);
+  }
 
   // Now that we've consumed the data, reset the sample count in BPF.
   profiler_state_->update_value(sample_count_idx, 0);
 }
 
+void PerfProfileConnector::ConsumeSymbolizedBatch(const std::vector<DataTable*>& data_tables) {
+  symbolization_thread_.join();
+  if (FLAGS_stirling_profiler_async_symbolization) {
+    // Otherwise, the time spent symbolizing is already part of TransferDataImpl().
+    profiler_cpu_time_ += symbolized_batch_.symbolization_time;
+  }
+  CreateRecords(symbolized_batch_, data_tables);
+  symbolized_batch_ = SymbolizedBatch{};
+}
+
+void PerfProfileConnector::DispatchSymbolization(const std::vector<DataTable*>& data_tables) {
+  if (symbolization_thread_.joinable()) {
+    if (!symbolization_done_) {
+      // Keep adding to the pending batch, rather than block the Stirling thread.
+      return;
+    }
+    ConsumeSymbolizedBatch(data_tables);
+  }
+
+  symbolization_done_ = false;
+  symbolization_thread_ = std::thread([this, batch = std::move(pending_batch_)]() {
+    const auto start_time = std::chrono::steady_clock::now();
+    symbolized_batch_ = SymbolizeStackTraces(batch);
+    symbolized_batch_.symbolization_time = std::chrono::steady_clock::now() - start_time;
+    symbolization_done_ = true;
+  });
+  pending_batch_ = StackTraceBatch{};
+
+  if (!FLAGS_stirling_profiler_async_symbolization) {
+    ConsumeSymbolizedBatch(data_tables);
+  }
+}
+
+void PerfProfileConnector::UpdateSampleStride() {
+  if (adaptive_sampler_ == nullptr) {
+    return;
+  }
+
+  // The time spent in BPF is not measured here, but when it is too high, samples get lost.
+  const auto now = std::chrono::steady_clock::now();
+  const int64_t num_lost = stats_.Get(StatKey::kLossHistoEvent);
+  const uint32_t stride =
+      adaptive_sampler_->Update(profiler_cpu_time_, now - last_stride_update_time_,
+                                num_lost - last_stride_update_num_lost_);
+  profiler_cpu_time_ = std::chrono::nanoseconds{0};
+  last_stride_update_time_ = now;
+  last_stride_update_num_lost_ = num_lost;
+
+  if (stride == sample_stride_) {
+    return;
+  }
+  const ebpf::StatusTuple s = profiler_state_->update_value(kSampleStrideIdx, stride);
+  if (!s.ok()) {
+    LOG(ERROR) << "Error writing the sample stride.";
+    return;
+  }
+  LOG(INFO) << absl::Substitute("PerfProfiler: Sample stride changed from $0 to $1.",
+                                sample_stride_, stride);
+  sample_stride_ = stride;
+}
+
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx,
                                             const std::vector<DataTable*>& data_tables) {
-  DCHECK_EQ(data_tables.size(), 1);
+  DCHECK_EQ(data_tables.size(), kTables.size());
 
-  auto* data_table = data_tables[0];
+  const auto start_time = std::chrono::steady_clock::now();
 
-  if (data_table == nullptr) {
+  if (data_tables[kPerfProfileTableNum] == nullptr &&
+      data_tables[kStackTraceProfileTableNum] == nullptr &&
+      data_tables[kOffCPUStackTraceTableNum] == nullptr) {
     return;
   }
 
-  ProcessBPFStackTraces(ctx, data_table);
+  ProcessBPFStackTraces(ctx);
+  PushStackTraces(ctx, data_tables);
 
-  // Cleanup the symbolizer so we don't leak memory.
+  profiler_cpu_time_ += std::chrono::steady_clock::now() - start_time;
+}
+
+void PerfProfileConnector::PushStackTraces(ConnectorContext* ctx,
+                                           const std::vector<DataTable*>& data_tables) {
+  const uint64_t now_ns = AdjustedSteadyClockNowNS();
+  if (pending_batch_.start_time_ns == 0) {
+    // The maps just read were written to over the last sampling period.
+    pending_batch_.start_time_ns =
+        now_ns - std::chrono::duration_cast<std::chrono::nanoseconds>(sampling_period_).count();
+  }
+  pending_batch_.end_time_ns = now_ns;
+
+  constexpr auto age_tick_period = std::chrono::minutes(5);
+  if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
+    ++pending_batch_.num_age_ticks;
+  }
+
+  // The symbolizers are cleaned up, so we don't leak memory, after the batch is symbolized.
   proc_tracker_.Update(ctx->GetUPIDs());
-  CleanupSymbolizers(proc_tracker_.deleted_upids());
+  const auto& deleted_upids = proc_tracker_.deleted_upids();
+  pending_batch_.deleted_upids.insert(deleted_upids.begin(), deleted_upids.end());
 
   stats_.Increment(StatKey::kBPFMapSwitchoverEvent, 1);
 
   if (sampling_freq_mgr_.count() % stats_log_interval_ == 0) {
     PrintStats();
+    pending_batch_.print_symbolizer_stats = true;
   }
+
+  DispatchSymbolization(data_tables);
 }
 
 void PerfProfileConnector::PrintStats() const {
   LOG(INFO) << "PerfProfileConnector statistics: " << stats_.Print();
+}
+
+void PerfProfileConnector::PrintSymbolizerStats() const {
   if (FLAGS_stirling_profiler_cache_symbols) {
     auto u_symbolizer = static_cast<CachingSymbolizer*>(u_symbolizer_.get());
     auto k_symbolizer = static_cast<CachingSymbolizer*>(k_symbolizer_.get());
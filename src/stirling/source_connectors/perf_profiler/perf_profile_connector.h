@@ -18,8 +18,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -28,6 +33,7 @@
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/types.h"
+#include "src/stirling/source_connectors/perf_profiler/adaptive_sampler.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
 #include "src/stirling/source_connectors/perf_profiler/shared/types.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_trace_id_cache.h"
@@ -38,6 +44,11 @@
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
 #include "src/stirling/utils/stat_counter.h"
 
+DECLARE_bool(stirling_profiler_async_symbolization);
+DECLARE_bool(stirling_profiler_pprof_output);
+DECLARE_bool(stirling_profiler_adaptive_sampling);
+DECLARE_bool(stirling_profiler_offcpu);
+
 namespace px {
 namespace stirling {
 
@@ -48,8 +59,12 @@ static constexpr std::string_view kNotSymbolizedMessage = "<not symbolized>";
 class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrapper {
  public:
   static constexpr std::string_view kName = "perf_profiler";
-  static constexpr auto kTables = MakeArray(kStackTraceTable);
+  static constexpr auto kTables =
+      MakeArray(kStackTraceTable, kStackTraceProfileTable, kOffCPUStackTraceTable);
   static constexpr uint32_t kPerfProfileTableNum = TableNum(kTables, kStackTraceTable);
+  static constexpr uint32_t kStackTraceProfileTableNum =
+      TableNum(kTables, kStackTraceProfileTable);
+  static constexpr uint32_t kOffCPUStackTraceTableNum = TableNum(kTables, kOffCPUStackTraceTable);
 
   static std::unique_ptr<PerfProfileConnector> Create(std::string_view name) {
     return std::unique_ptr<PerfProfileConnector>(new PerfProfileConnector(name));
@@ -68,11 +83,15 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
     kBPFMapSwitchoverEvent,
     kCumulativeSumOfAllStackTraces,
     kLossHistoEvent,
+    kOffCPUDropEvent,
   };
 
   utils::StatCounter<StatKey> stats() const { return stats_; }
 
  private:
+  // For benchmarking the profiler without BPF.
+  friend class PerfProfileConnectorFriend;
+
   // The time interval between stack trace samples, i.e. the sample rate used inside of BPF.
   const std::chrono::milliseconds stack_trace_sampling_period_;
 
@@ -88,19 +107,119 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // RawHistoData: a list of stack trace keys that will need to be histogrammed.
   using RawHistoData = std::vector<stack_trace_key_t>;
 
+  // Stack trace keys, each with a weight: for on-CPU samples, the sample stride they were sampled
+  // at, and for off-CPU stack traces, the nanoseconds blocked in them.
+  struct WeightedStackTraces {
+    // Stack trace keys whose UPIDs are to be symbolized.
+    std::vector<std::tuple<md::UPID, stack_trace_key_t, uint64_t>> keys;
+
+    // Stack traces that are reported without symbols, and their weights.
+    md::UPIDMap<uint64_t> not_symbolized_weights;
+  };
+
+  // Stack traces read out of BPF, waiting to be symbolized. Reading them out is cheap, and lets
+  // BPF reuse its maps, while symbolization (ELF/DWARF reads, Java agents) can take seconds.
+  struct StackTraceBatch {
+    WeightedStackTraces on_cpu;
+    // Only populated with --stirling_profiler_offcpu.
+    WeightedStackTraces off_cpu;
+
+    // The addresses of the stack-ids of both on_cpu and off_cpu.
+    absl::flat_hash_map<int, std::vector<uintptr_t>> stack_addrs;
+
+    // UPIDs whose symbolizer state is to be deleted, once the stack traces above are symbolized.
+    md::UPIDSet deleted_upids;
+
+    uint64_t num_age_ticks = 0;
+    bool print_symbolizer_stats = false;
+
+    // The time window over which the stack traces were sampled.
+    uint64_t start_time_ns = 0;
+    uint64_t end_time_ns = 0;
+  };
+
+  struct StackTraceRecord {
+    md::UPID upid;
+    uint64_t stack_trace_id;
+    std::string stack_trace_str;
+    uint64_t count;
+  };
+
+  struct StackTraceProfileRecord {
+    md::UPID upid;
+    // A serialized profilerpb::Profile.
+    std::string profile;
+  };
+
+  struct SymbolizedBatch {
+    std::vector<StackTraceRecord> stack_traces;
+    // The count of these records is the time blocked, in nanoseconds.
+    std::vector<StackTraceRecord> offcpu_stack_traces;
+    // Only populated with --stirling_profiler_pprof_output.
+    std::vector<StackTraceProfileRecord> profiles;
+
+    // The time spent symbolizing, which counts towards the cost of the profiler.
+    std::chrono::nanoseconds symbolization_time{0};
+  };
+
   explicit PerfProfileConnector(std::string_view source_name);
 
-  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
+  // Creates the user and kernel symbolizers, as configured by the flags.
+  Status InitSymbolizers();
+
+  // Reads the stack traces out of the current BPF maps, and adds them to pending_batch_.
+  void ProcessBPFStackTraces(ConnectorContext* ctx);
+
+  // Closes out pending_batch_, with the stack traces read so far, and dispatches it for
+  // symbolization.
+  void PushStackTraces(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables);
+
+  // Reads the stacks of the given stack trace keys out of stack_traces, into pending_batch_, and
+  // adds the keys to output with their weights.
+  void ReadStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces,
+                       const std::vector<std::pair<stack_trace_key_t, uint64_t>>& weighted_keys,
+                       WeightedStackTraces* output);
+  // As above, with stacks read by read_stack_fn. Stack-ids whose stacks are not read are passed
+  // to clear_stack_fn.
+  void ReadStackTraces(ConnectorContext* ctx, const Stringifier::StackAddrsFn& read_stack_fn,
+                       const std::function<void(int)>& clear_stack_fn,
+                       const std::vector<std::pair<stack_trace_key_t, uint64_t>>& weighted_keys,
+                       WeightedStackTraces* output);
+
+  // Reads the off-CPU stack traces out of the map set that BPF just switched away from.
+  void ReadOffCPUStackTraces(ConnectorContext* ctx, bool using_map_set_a);
+
+  // With --stirling_profiler_adaptive_sampling, updates the sample stride in BPF, based on the
+  // cost of the profiler since the last update.
+  void UpdateSampleStride();
+
+  // Hands pending_batch_ to the symbolization thread once the previous batch is done, and
+  // appends the records of the previous batch to the tables.
+  void DispatchSymbolization(const std::vector<DataTable*>& data_tables);
+
+  // Runs on the symbolization thread.
+  SymbolizedBatch SymbolizeStackTraces(const StackTraceBatch& batch);
+
+  StackTraceHisto AggregateStackTraces(const WeightedStackTraces& stack_traces,
+                                       Stringifier* stringifier);
 
-  // Read BPF data structures, build & incorporate records to the table.
-  void CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+  // Materializes the folded stack trace strings of the histogram.
+  std::vector<StackTraceRecord> CreateStackTraceRecords(const StackTraceHisto& histogram);
 
-  StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces);
+  // Builds a pprof profile for each UPID in the histogram.
+  std::vector<StackTraceProfileRecord> BuildProfiles(const StackTraceHisto& histogram,
+                                                     const StackTraceBatch& batch);
 
-  void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
+  void CreateRecords(const SymbolizedBatch& symbolized_batch,
+                     const std::vector<DataTable*>& data_tables);
+
+  // Appends the records of symbolized_batch_, once the symbolization thread is done with it.
+  void ConsumeSymbolizedBatch(const std::vector<DataTable*>& data_tables);
+
+  void CleanupSymbolizers(const md::UPIDSet& deleted_upids);
 
   void PrintStats() const;
+  void PrintSymbolizerStats() const;
 
   // data structures shared with BPF:
   std::unique_ptr<ebpf::BPFStackTable> stack_traces_a_;
@@ -108,6 +227,10 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   std::unique_ptr<ebpf::BPFArrayTable<uint64_t>> profiler_state_;
 
+  // Only set with --stirling_profiler_offcpu.
+  std::unique_ptr<ebpf::BPFStackTable> offcpu_stack_traces_a_;
+  std::unique_ptr<ebpf::BPFStackTable> offcpu_stack_traces_b_;
+
   // Number of iterations, where each iteration is drains the information collectid in BPF.
   uint64_t transfer_count_ = 0;
 
@@ -117,10 +240,30 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // The raw histogram from BPF; it is populated on each iteration by a call to PollPerfBuffer().
   RawHistoData raw_histo_data_;
 
+  // Stack traces read out of BPF since the last batch was handed to the symbolization thread.
+  StackTraceBatch pending_batch_;
+
+  // The symbolizers, and stack_trace_ids_, are only used by the symbolization thread while it
+  // runs. symbolization_done_ is set by the thread when its records are ready.
+  std::thread symbolization_thread_;
+  std::atomic<bool> symbolization_done_ = false;
+  SymbolizedBatch symbolized_batch_;
+
   // For converting stack trace addresses to symbols.
   std::unique_ptr<Symbolizer> k_symbolizer_;
   std::unique_ptr<Symbolizer> u_symbolizer_;
 
+  // Only set with --stirling_profiler_adaptive_sampling.
+  std::unique_ptr<AdaptiveSampler> adaptive_sampler_;
+
+  // The sample stride currently in BPF.
+  uint32_t sample_stride_ = 1;
+
+  // The cost of the profiler, and the number of lost samples, since the last stride update.
+  std::chrono::nanoseconds profiler_cpu_time_{0};
+  std::chrono::steady_clock::time_point last_stride_update_time_;
+  int64_t last_stride_update_num_lost_ = 0;
+
   // Keeps track of processes. Used to find destroyed processes on which to perform clean-up.
   // TODO(oazizi): Investigate ways of sharing across source_connectors.
   ProcTracker proc_tracker_;
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Measures the user space cost of the profiler: symbolizing, aggregating and writing out the
+// records of stack traces, as TransferDataImpl() does after reading the BPF maps. The stack traces
+// are synthetic, so BPF is not needed, but they sample the functions of real processes:
+//
+//   perf_profiler_benchmark --benchmark_filter=go_elf
+//
+// The cc binary is a fork of the benchmark itself, and the go binary a stopped Go test app.
+
+#include <link.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <benchmark/benchmark.h>
+
+#include "src/common/base/base.h"
+#include "src/common/exec/subprocess.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/common/system/proc_parser.h"
+#include "src/common/testing/test_environment.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/source_connectors/perf_profiler/perf_profile_connector.h"
+#include "src/stirling/source_connectors/perf_profiler/testing/perf_profile_connector_friend.h"
+#include "src/stirling/testing/common.h"
+
+DECLARE_string(stirling_profiler_symbolizer);
+DECLARE_bool(stirling_profiler_async_symbolization);
+DECLARE_bool(stirling_profiler_java_symbols);
+
+using ::benchmark::Counter;
+using ::px::MemoryStats;
+using ::px::MemoryTracker;
+using ::px::SubProcess;
+using ::px::stirling::PerfProfileConnector;
+using ::px::stirling::PerfProfileConnectorFriend;
+using ::px::stirling::StandaloneContext;
+using ::px::stirling::obj_tools::ElfReader;
+using ::px::stirling::obj_tools::SymbolMatchType;
+using ::px::stirling::testing::DataTables;
+
+namespace {
+
+enum class BinaryType { kCC, kGo };
+
+// The number of distinct stack traces, and samples, of each process in each iteration.
+constexpr int kStackTracesPerProcess = 64;
+constexpr int kSamplesPerProcess = 1024;
+
+constexpr std::string_view kGoAppPath =
+    "src/stirling/source_connectors/perf_profiler/testing/go/profiler_test_app_sqrt_go_/"
+    "profiler_test_app_sqrt_go";
+
+// Processes to sample, which all run the same binary.
+struct SampledProcesses {
+  std::vector<std::unique_ptr<SubProcess>> sub_processes;
+  px::md::UPIDSet upids;
+
+  // Addresses inside of the functions of the binary, as mapped into the processes.
+  std::vector<uintptr_t> func_addrs;
+
+  ~SampledProcesses() {
+    for (auto& sub_process : sub_processes) {
+      sub_process->Kill();
+      sub_process->Wait();
+    }
+  }
+};
+
+int GetLoadBias(struct dl_phdr_info* info, size_t /*size*/, void* data) {
+  // The first object is the executable itself.
+  *static_cast<uintptr_t*>(data) = info->dlpi_addr;
+  return 1;
+}
+
+px::Status StartProcesses(BinaryType binary_type, int num_processes, SampledProcesses* procs) {
+  std::filesystem::path binary_path;
+  uintptr_t load_bias = 0;
+  if (binary_type == BinaryType::kCC) {
+    binary_path = "/proc/self/exe";
+    dl_iterate_phdr(GetLoadBias, &load_bias);
+  } else {
+    // The Go test app is not position independent, so its symbols need no load bias.
+    binary_path = px::testing::BazelRunfilePath(kGoAppPath);
+  }
+
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary_path));
+  PL_ASSIGN_OR_RETURN(std::vector<ElfReader::SymbolInfo> symbols,
+                      elf_reader->ListFuncSymbols("", SymbolMatchType::kSubstr));
+  for (const auto& symbol : symbols) {
+    if (symbol.size > 1) {
+      procs->func_addrs.push_back(load_bias + symbol.address + symbol.size / 2);
+    }
+  }
+  if (procs->func_addrs.empty()) {
+    return px::error::Internal("No function symbols in $0.", binary_path.string());
+  }
+
+  px::system::ProcParser proc_parser(px::system::Config::GetInstance());
+  for (int i = 0; i < num_processes; ++i) {
+    auto sub_process = std::make_unique<SubProcess>();
+    if (binary_type == BinaryType::kCC) {
+      // A fork has the same mappings, so the addresses above are valid in it too.
+      PL_RETURN_IF_ERROR(sub_process->Start(
+          []() {
+            while (true) {
+              pause();
+            }
+            return 0;
+          },
+          {}));
+    } else {
+      PL_RETURN_IF_ERROR(sub_process->Start({binary_path.string()}));
+    }
+    procs->sub_processes.push_back(std::move(sub_process));
+  }
+
+  // Give the Go apps time to exec, then stop them, so they do not compete with the benchmark.
+  if (binary_type == BinaryType::kGo) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+  for (auto& sub_process : procs->sub_processes) {
+    if (binary_type == BinaryType::kGo) {
+      sub_process->Signal(SIGSTOP);
+    }
+    const int pid = sub_process->child_pid();
+    PL_ASSIGN_OR_RETURN(const int64_t start_time_ticks, proc_parser.GetPIDStartTimeTicks(pid));
+    procs->upids.emplace(/*asid*/ 0, pid, start_time_ticks);
+  }
+  return px::Status::OK();
+}
+
+// Stack traces as they would be read out of the BPF maps: the keys of the samples, and the stacks
+// of their stack-ids. Each process samples its own set of stacks of the given depth.
+struct SyntheticStackTraces {
+  std::vector<stack_trace_key_t> keys;
+  absl::flat_hash_map<int, std::vector<uintptr_t>> stacks;
+};
+
+SyntheticStackTraces MakeStackTraces(const SampledProcesses& procs, int depth) {
+  std::mt19937 rng(37);
+  std::uniform_int_distribution<size_t> func_dist(0, procs.func_addrs.size() - 1);
+  std::uniform_int_distribution<int> stack_dist(0, kStackTracesPerProcess - 1);
+
+  SyntheticStackTraces stack_traces;
+  int first_stack_id = 0;
+  for (const px::md::UPID& upid : procs.upids) {
+    for (int i = 0; i < kStackTracesPerProcess; ++i) {
+      std::vector<uintptr_t>& stack = stack_traces.stacks[first_stack_id + i];
+      for (int j = 0; j < depth; ++j) {
+        stack.push_back(procs.func_addrs[func_dist(rng)]);
+      }
+    }
+    for (int i = 0; i < kSamplesPerProcess; ++i) {
+      stack_trace_key_t key = {};
+      key.upid.pid = upid.pid();
+      key.upid.start_time_ticks = upid.start_ts();
+      key.user_stack_id = first_stack_id + stack_dist(rng);
+      key.kernel_stack_id = -1;
+      stack_traces.keys.push_back(key);
+    }
+    first_stack_id += kStackTracesPerProcess;
+  }
+  return stack_traces;
+}
+
+uint64_t CountOutputRecords(DataTables* tables) {
+  uint64_t num_records = 0;
+  for (auto tbl : tables->tables()) {
+    for (const auto& tagged_record : tbl->ConsumeRecords()) {
+      if (!tagged_record.records.empty()) {
+        num_records += tagged_record.records[0]->Size();
+      }
+    }
+  }
+  return num_records;
+}
+
+// Arguments are the depth of the stacks, and the number of processes.
+// NOLINTNEXTLINE: runtime/references.
+void BM_PerfProfilerTransfer(benchmark::State& state, BinaryType binary_type,
+                             std::string_view symbolizer) {
+  const int depth = state.range(0);
+  const int num_processes = state.range(1);
+
+  SampledProcesses procs;
+  const px::Status s = StartProcesses(binary_type, num_processes, &procs);
+  if (!s.ok()) {
+    state.SkipWithError(s.msg().c_str());
+    return;
+  }
+  const SyntheticStackTraces stack_traces = MakeStackTraces(procs, depth);
+  StandaloneContext ctx(procs.upids);
+
+  FLAGS_stirling_profiler_symbolizer = std::string(symbolizer);
+  auto connector = PerfProfileConnectorFriend::Create("perf_profiler");
+  PL_CHECK_OK(connector->InitSymbolizers());
+  DataTables tables(PerfProfileConnector::kTables);
+
+  uint64_t total_output_records = 0;
+  MemoryTracker mem_tracker(/*enable*/ true);
+  mem_tracker.Start();
+
+  for (auto _ : state) {
+    connector->AcceptStackTraces(&ctx, stack_traces.keys, stack_traces.stacks);
+    connector->PushStackTraces(&ctx, tables.tables());
+
+    state.PauseTiming();
+    total_output_records += CountOutputRecords(&tables);
+    state.ResumeTiming();
+  }
+
+  const MemoryStats mem_stats = mem_tracker.End();
+
+#define MEM_COUNTER(x) Counter(x, Counter::kDefaults, Counter::OneK::kIs1024)
+  state.counters["TimePerSample"] =
+      Counter(stack_traces.keys.size() * state.iterations(), Counter::kIsRate | Counter::kInvert);
+  state.counters["Records"] = Counter(total_output_records, Counter::kIsRate);
+  state.counters["AllocPeak"] = MEM_COUNTER(mem_stats.max.allocated - mem_stats.start.allocated);
+  state.counters["AllocEnd"] = MEM_COUNTER(mem_stats.end.allocated - mem_stats.start.allocated);
+#undef MEM_COUNTER
+}
+
+void StackTraceArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"depth", "processes"})
+      ->RangeMultiplier(4)
+      ->Ranges({{8, 128}, {1, 16}})
+      ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_PerfProfilerTransfer, cc_elf, BinaryType::kCC, "elf")->Apply(StackTraceArgs);
+BENCHMARK_CAPTURE(BM_PerfProfilerTransfer, cc_bcc, BinaryType::kCC, "bcc")->Apply(StackTraceArgs);
+BENCHMARK_CAPTURE(BM_PerfProfilerTransfer, go_elf, BinaryType::kGo, "elf")->Apply(StackTraceArgs);
+BENCHMARK_CAPTURE(BM_PerfProfilerTransfer, go_bcc, BinaryType::kGo, "bcc")->Apply(StackTraceArgs);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  // Symbolize on the benchmark thread, so that all of the work is timed.
+  FLAGS_stirling_profiler_async_symbolization = false;
+  FLAGS_stirling_profiler_java_symbols = false;
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
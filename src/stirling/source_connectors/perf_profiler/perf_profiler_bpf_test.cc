@@ -43,6 +43,7 @@ DECLARE_bool(stirling_profiler_java_symbols);
 DECLARE_string(stirling_profiler_java_agent_libs);
 DECLARE_uint32(stirling_profiler_table_update_period_seconds);
 DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
+DECLARE_bool(stirling_profiler_offcpu);
 
 namespace px {
 namespace stirling {
@@ -93,14 +94,14 @@ class PerfProfilerTestSubProcesses {
   virtual void KillAll() = 0;
   const std::vector<int>& pids() const { return pids_; }
   const std::vector<struct upid_t>& struct_upids() const { return struct_upids_; }
-  const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
+  const md::UPIDSet& upids() const { return upids_; }
   static constexpr size_t kNumSubProcesses = 4;
   virtual ~PerfProfilerTestSubProcesses() = default;
 
  protected:
   std::vector<int> pids_;
   std::vector<struct upid_t> struct_upids_;
-  absl::flat_hash_set<md::UPID> upids_;
+  md::UPIDSet upids_;
 };
 
 class CPUPinnedSubProcesses final : public PerfProfilerTestSubProcesses {
@@ -145,6 +146,40 @@ class CPUPinnedSubProcesses final : public PerfProfilerTestSubProcesses {
   const std::string binary_path_;
 };
 
+// Runs a command, that need not be pinned to a CPU, in each sub-process.
+class CommandSubProcesses final : public PerfProfilerTestSubProcesses {
+ public:
+  explicit CommandSubProcesses(std::vector<std::string> args) : args_(std::move(args)) {}
+
+  ~CommandSubProcesses() { KillAll(); }
+
+  void StartAll() override {
+    system::ProcParser proc_parser(system::Config::GetInstance());
+
+    for (size_t i = 0; i < kNumSubProcesses; ++i) {
+      sub_processes_.push_back(std::make_unique<SubProcess>());
+      ASSERT_OK(sub_processes_[i]->Start(args_));
+
+      const int pid = sub_processes_[i]->child_pid();
+      ASSERT_OK_AND_ASSIGN(const uint64_t ts, proc_parser.GetPIDStartTimeTicks(pid));
+      pids_.push_back(pid);
+      struct_upids_.push_back({{static_cast<uint32_t>(pid)}, ts});
+      upids_.emplace(0, pid, ts);
+    }
+  }
+
+  void KillAll() override {
+    for (auto& sub_process : sub_processes_) {
+      sub_process->Kill();
+    }
+    sub_processes_.clear();
+  }
+
+ private:
+  const std::vector<std::string> args_;
+  std::vector<std::unique_ptr<SubProcess>> sub_processes_;
+};
+
 class ContainerSubProcesses final : public PerfProfilerTestSubProcesses {
  public:
   ContainerSubProcesses(const std::filesystem::path image_tar_path,
@@ -189,7 +224,9 @@ class ContainerSubProcesses final : public PerfProfilerTestSubProcesses {
 class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path> {
  public:
   PerfProfileBPFTest()
-      : test_run_time_(FLAGS_test_run_time), data_table_(/*id*/ 0, kStackTraceTable) {}
+      : test_run_time_(FLAGS_test_run_time),
+        data_table_(/*id*/ 0, kStackTraceTable),
+        offcpu_data_table_(/*id*/ 2, kOffCPUStackTraceTable) {}
 
  protected:
   void SetUp() override {
@@ -197,6 +234,9 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
     FLAGS_number_attach_attempts_per_iteration = kNumSubProcesses;
     FLAGS_stirling_profiler_table_update_period_seconds = 5;
     FLAGS_stirling_profiler_stack_trace_sample_period_ms = 7;
+    // Symbolize on each TransferData() call, so that its records and clean-up are observable
+    // as soon as it returns.
+    FLAGS_stirling_profiler_async_symbolization = false;
 
     source_ = PerfProfileConnector::Create("perf_profile_connector");
     ASSERT_OK(source_->Init());
@@ -320,7 +360,7 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
     column_ptrs_populated_ = true;
   }
 
-  void RefreshContext(const absl::flat_hash_set<md::UPID>& upids) {
+  void RefreshContext(const md::UPIDSet& upids) {
     absl::base_internal::SpinLockHolder lock(&perf_profiler_state_lock_);
     ctx_ = std::make_unique<StandaloneContext>(upids);
   }
@@ -332,7 +372,7 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
     ASSERT_LT(sampling_period_, test_run_time_);
 
     // Create an initial empty context for use by the transfer data thread.
-    const absl::flat_hash_set<md::UPID> empty_upid_set;
+    const md::UPIDSet empty_upid_set;
     ctx_ = std::make_unique<StandaloneContext>(empty_upid_set);
 
     transfer_data_thread_ = std::thread([this]() {
@@ -376,7 +416,9 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
   std::unique_ptr<PerfProfilerTestSubProcesses> sub_processes_;
   std::unique_ptr<StandaloneContext> ctx_;
   DataTable data_table_;
-  const std::vector<DataTable*> data_tables_{&data_table_};
+  DataTable offcpu_data_table_;
+  // The pprof profiles table is off by default, so it is not populated here.
+  const std::vector<DataTable*> data_tables_{&data_table_, nullptr, &offcpu_data_table_};
 
   bool column_ptrs_populated_ = false;
   std::shared_ptr<types::ColumnWrapper> trace_ids_column_;
@@ -517,7 +559,7 @@ TEST_P(PerfProfileBPFTest, PerfProfilerJavaTest) {
   // The ProcTracker (inside of PerfProfileConnector) will take the difference
   // between the previous list of upids (our subprocs) and the current list of upids (empty)
   // to find a list of deleted upids.
-  const absl::flat_hash_set<md::UPID> empty_upid_set;
+  const md::UPIDSet empty_upid_set;
   RefreshContext(empty_upid_set);
 
   // Run transfer data so that cleanup is kicked off in the perf profile source connector.
@@ -537,7 +579,7 @@ TEST_F(PerfProfileBPFTest, TestOutOfContext) {
   ASSERT_NO_FATAL_FAILURE(sub_processes_->StartAll());
 
   // Use an empty connector context.
-  ctx_ = std::make_unique<StandaloneContext>(absl::flat_hash_set<md::UPID>());
+  ctx_ = std::make_unique<StandaloneContext>(md::UPIDSet());
 
   // Allow target apps to run, and periodically call transfer data on perf profile connector.
   RunTest();
@@ -546,6 +588,52 @@ TEST_F(PerfProfileBPFTest, TestOutOfContext) {
   ASSERT_NO_FATAL_FAILURE(ConsumeRecords());
 }
 
+class PerfProfileOffCPUBPFTest : public PerfProfileBPFTest {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_profiler_offcpu = true;
+    PerfProfileBPFTest::SetUp();
+  }
+
+  void TearDown() override {
+    PerfProfileBPFTest::TearDown();
+    FLAGS_stirling_profiler_offcpu = false;
+  }
+};
+
+TEST_F(PerfProfileOffCPUBPFTest, BlockedProcesses) {
+  // Each shell spends nearly all of its time blocked, waiting for its sleep to exit. Each block
+  // lasts (a bit more than) 100ms, so few of them span a switch of BPF map sets, and are dropped.
+  sub_processes_ = std::make_unique<CommandSubProcesses>(
+      std::vector<std::string>{"/bin/sh", "-c", "while true; do sleep 0.1; done"});
+  ASSERT_NO_FATAL_FAILURE(sub_processes_->StartAll());
+  RefreshContext(sub_processes_->upids());
+
+  const std::chrono::duration<double> elapsed_time = RunTest();
+
+  const std::vector<TaggedRecordBatch> tablets = offcpu_data_table_.ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(const types::ColumnWrapperRecordBatch records, tablets);
+  const std::vector<size_t> row_idxs =
+      FindRecordIdxMatchesPIDs(records, kOffCPUStackTraceUPIDIdx, sub_processes_->pids());
+  ASSERT_THAT(row_idxs, Not(SizeIs(0)));
+
+  absl::flat_hash_map<uint32_t, int64_t> off_cpu_ns_by_pid;
+  for (const size_t row_idx : row_idxs) {
+    const md::UPID upid(records[kOffCPUStackTraceUPIDIdx]->Get<types::UInt128Value>(row_idx).val);
+    off_cpu_ns_by_pid[upid.pid()] +=
+        records[kOffCPUStackTraceOffCPUTimeIdx]->Get<types::Int64Value>(row_idx).val;
+    VLOG(1) << records[kOffCPUStackTraceStackTraceStrIdx]->Get<types::StringValue>(row_idx);
+  }
+
+  const double elapsed_ns = std::chrono::duration<double, std::nano>(elapsed_time).count();
+  ASSERT_THAT(off_cpu_ns_by_pid, SizeIs(kNumSubProcesses));
+  for (const auto& [pid, off_cpu_ns] : off_cpu_ns_by_pid) {
+    EXPECT_GT(off_cpu_ns, 0.5 * elapsed_ns) << pid;
+    EXPECT_LT(off_cpu_ns, 1.1 * elapsed_ns) << pid;
+  }
+  EXPECT_EQ(source_->stats().Get(PerfProfileConnector::StatKey::kLossHistoEvent), 0);
+}
+
 std::vector<std::filesystem::path> GetJavaImagePaths() {
   const std::vector<std::string_view> image_names =
       absl::StrSplit(FLAGS_test_java_image_names, ",");
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/pprof_builder.h"
+
+#include <utility>
+#include <vector>
+
+namespace px {
+namespace stirling {
+
+PProfBuilder::PProfBuilder(const StackTraceInterner* interner, int64_t period_ns)
+    : interner_(interner), period_ns_(period_ns) {
+  // The string table starts with "", as required by the format.
+  StringIndex("");
+
+  auto* samples_type = profile_.add_sample_type();
+  samples_type->set_type(StringIndex("samples"));
+  samples_type->set_unit(StringIndex("count"));
+  auto* cpu_type = profile_.add_sample_type();
+  cpu_type->set_type(StringIndex("cpu"));
+  cpu_type->set_unit(StringIndex("nanoseconds"));
+
+  profile_.mutable_period_type()->set_type(StringIndex("cpu"));
+  profile_.mutable_period_type()->set_unit(StringIndex("nanoseconds"));
+  profile_.set_period(period_ns_);
+}
+
+int64_t PProfBuilder::StringIndex(std::string_view str) {
+  auto [iter, inserted] = string_indexes_.try_emplace(str, profile_.string_table_size());
+  if (inserted) {
+    profile_.add_string_table(std::string(str));
+  }
+  return iter->second;
+}
+
+uint64_t PProfBuilder::LocationID(uint32_t frame) {
+  auto [iter, inserted] = location_ids_.try_emplace(frame, location_ids_.size() + 1);
+  const uint64_t id = iter->second;
+  if (inserted) {
+    // The frame is a symbol, so it serves as the function's name and system name.
+    const int64_t name = StringIndex(interner_->frame(frame));
+
+    auto* function = profile_.add_function();
+    function->set_id(id);
+    function->set_name(name);
+    function->set_system_name(name);
+
+    auto* location = profile_.add_location();
+    location->set_id(id);
+    location->add_line()->set_function_id(id);
+  }
+  return id;
+}
+
+void PProfBuilder::AddStackTrace(uint32_t interned_stack, uint64_t count) {
+  const std::vector<uint32_t> frames = interner_->Frames(interned_stack);
+
+  auto* sample = profile_.add_sample();
+  // The interner lists frames from the root, while pprof lists the leaf first.
+  for (auto iter = frames.rbegin(); iter != frames.rend(); ++iter) {
+    sample->add_location_id(LocationID(*iter));
+  }
+  sample->add_value(count);
+  sample->add_value(count * period_ns_);
+}
+
+profilerpb::Profile PProfBuilder::Build(int64_t time_ns, int64_t duration_ns) {
+  profile_.set_time_nanos(time_ns);
+  profile_.set_duration_nanos(duration_ns);
+  string_indexes_.clear();
+  return std::move(profile_);
+}
+
+}  // namespace stirling
+}  // namespace px
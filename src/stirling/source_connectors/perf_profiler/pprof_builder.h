@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/stirling/source_connectors/perf_profiler/proto/profile.pb.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
+
+namespace px {
+namespace stirling {
+
+// Builds a pprof format profile from the interned stack traces sampled in one process.
+// Functions, locations and strings are deduplicated as the stack traces are added,
+// so consumers get the profile ready to use, without parsing folded stack trace strings.
+//
+// The profiler only keeps the symbol of each frame, so each distinct frame becomes one function
+// with one location, and the profile has no mappings or addresses.
+class PProfBuilder {
+ public:
+  /**
+   * @param interner The interner of the stack traces; it must outlive the builder.
+   * @param period_ns The time between stack trace samples.
+   */
+  PProfBuilder(const StackTraceInterner* interner, int64_t period_ns);
+
+  // Adds a stack trace that was sampled count times.
+  void AddStackTrace(uint32_t interned_stack, uint64_t count);
+
+  // Returns the profile, covering [time_ns, time_ns + duration_ns); the builder must not be
+  // used afterwards.
+  profilerpb::Profile Build(int64_t time_ns, int64_t duration_ns);
+
+ private:
+  int64_t StringIndex(std::string_view str);
+  uint64_t LocationID(uint32_t frame);
+
+  const StackTraceInterner* const interner_;
+  const int64_t period_ns_;
+
+  profilerpb::Profile profile_;
+
+  // Keys are views of string literals, or of the frames in the interner.
+  absl::flat_hash_map<std::string_view, int64_t> string_indexes_;
+  absl::flat_hash_map<uint32_t, uint64_t> location_ids_;
+};
+
+}  // namespace stirling
+}  // namespace px
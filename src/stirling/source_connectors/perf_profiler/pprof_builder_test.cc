@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/stirling/source_connectors/perf_profiler/pprof_builder.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+
+namespace {
+
+// Returns the function names of the sample's locations, leaf first.
+std::vector<std::string> SampleFunctionNames(const profilerpb::Profile& profile,
+                                             const profilerpb::Sample& sample) {
+  std::vector<std::string> names;
+  for (const uint64_t location_id : sample.location_id()) {
+    const profilerpb::Location& location = profile.location(location_id - 1);
+    EXPECT_EQ(location.id(), location_id);
+    const profilerpb::Function& function = profile.function(location.line(0).function_id() - 1);
+    names.push_back(profile.string_table(function.name()));
+  }
+  return names;
+}
+
+}  // namespace
+
+TEST(PProfBuilderTest, BuildsProfile) {
+  constexpr int64_t kPeriodNS = 10'000'000;
+
+  StackTraceInterner interner;
+  PProfBuilder builder(&interner, kPeriodNS);
+  builder.AddStackTrace(interner.InternFoldedString("main;run;foo"), 2);
+  builder.AddStackTrace(interner.InternFoldedString("main;run;bar"), 1);
+
+  const profilerpb::Profile profile = builder.Build(1000, 500);
+
+  ASSERT_GT(profile.string_table_size(), 0);
+  EXPECT_EQ(profile.string_table(0), "");
+  EXPECT_EQ(profile.time_nanos(), 1000);
+  EXPECT_EQ(profile.duration_nanos(), 500);
+  EXPECT_EQ(profile.period(), kPeriodNS);
+  EXPECT_EQ(profile.string_table(profile.period_type().type()), "cpu");
+  EXPECT_EQ(profile.string_table(profile.period_type().unit()), "nanoseconds");
+
+  ASSERT_EQ(profile.sample_type_size(), 2);
+  EXPECT_EQ(profile.string_table(profile.sample_type(0).type()), "samples");
+  EXPECT_EQ(profile.string_table(profile.sample_type(1).unit()), "nanoseconds");
+
+  // The frames main and run are shared by both samples.
+  EXPECT_EQ(profile.function_size(), 4);
+  EXPECT_EQ(profile.location_size(), 4);
+
+  ASSERT_EQ(profile.sample_size(), 2);
+  EXPECT_THAT(SampleFunctionNames(profile, profile.sample(0)), ElementsAre("foo", "run", "main"));
+  EXPECT_THAT(profile.sample(0).value(), ElementsAre(2, 2 * kPeriodNS));
+  EXPECT_THAT(SampleFunctionNames(profile, profile.sample(1)), ElementsAre("bar", "run", "main"));
+  EXPECT_THAT(profile.sample(1).value(), ElementsAre(1, kPeriodNS));
+}
+
+}  // namespace stirling
+}  // namespace px
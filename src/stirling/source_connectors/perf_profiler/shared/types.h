@@ -38,7 +38,7 @@ using SymbolizerFn = std::function<std::string_view(const uintptr_t addr)>;
 
 // SymbolicStackTrace identifies a particular stack trace by:
 // * upid
-// * "folded" stack trace string
+// * "folded" stack trace string, as interned by a StackTraceInterner
 // The stack traces (in kernel & in BPF) are ordered lists of instruction pointers (addresses).
 // Stirling uses BPF to recover the symbols associated with each address, and then
 // uses the "symbolic stack trace" as the histogram key. Some of the stack traces that are
@@ -50,18 +50,16 @@ using SymbolizerFn = std::function<std::string_view(const uintptr_t addr)>;
 // SymbolicStackTrace will serve as a key to the unique stack-trace-id (an integer) in Stirling.
 struct SymbolicStackTrace {
   const md::UPID upid;
-  const std::string stack_trace_str;
+  // The ID of the folded stack trace string in the StackTraceInterner that produced it.
+  const uint32_t interned_stack;
 
   template <typename H>
   friend H AbslHashValue(H h, const SymbolicStackTrace& s) {
-    return H::combine(std::move(h), s.upid, s.stack_trace_str);
+    return H::combine(std::move(h), s.upid, s.interned_stack);
   }
 
   friend bool operator==(const SymbolicStackTrace& lhs, const SymbolicStackTrace& rhs) {
-    if (lhs.upid != rhs.upid) {
-      return false;
-    }
-    return lhs.stack_trace_str == rhs.stack_trace_str;
+    return lhs.upid == rhs.upid && lhs.interned_stack == rhs.interned_stack;
   }
 };
 
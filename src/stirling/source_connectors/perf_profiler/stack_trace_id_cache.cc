@@ -47,7 +47,17 @@ uint64_t StackTraceIDCache::Lookup(const profiler::SymbolicStackTrace& stack_tra
 }
 
 void StackTraceIDCache::AgeTick() {
-  prev_stack_trace_ids_ = std::move(stack_trace_ids_);
+  // Only the stack traces of the current generation survive into the previous generation,
+  // so only they are copied into the new interner; the stack traces of the old previous
+  // generation are dropped with the old interner.
+  StackTraceInterner interner;
+  prev_stack_trace_ids_.clear();
+  for (const auto& [stack_trace, stack_trace_id] : stack_trace_ids_) {
+    const uint32_t interned_stack = interner.CopyStack(interner_, stack_trace.interned_stack);
+    prev_stack_trace_ids_.emplace(profiler::SymbolicStackTrace{stack_trace.upid, interned_stack},
+                                  stack_trace_id);
+  }
+  interner_ = std::move(interner);
   stack_trace_ids_.clear();
 }
 
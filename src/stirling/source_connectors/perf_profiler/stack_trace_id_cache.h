@@ -23,6 +23,7 @@
 #include <absl/container/flat_hash_map.h>
 
 #include "src/stirling/source_connectors/perf_profiler/shared/types.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
 
 namespace px {
 namespace stirling {
@@ -44,12 +45,21 @@ namespace stirling {
 //
 // For cases where the same stack trace ID shows up with different IDs,
 // the UI will aggregate the identical stack traces for us in the visualization.
+//
+// Stack traces are keyed by their ID in interner(), which holds the frames of the stack traces
+// of both generations. AgeTick() compacts the interner down to the stack traces that are still
+// tracked, so any interned stack IDs obtained before AgeTick() must not be used after it.
 class StackTraceIDCache {
  public:
   uint64_t Lookup(const profiler::SymbolicStackTrace& stack_trace);
   void AgeTick();
 
+  StackTraceInterner* interner() { return &interner_; }
+  const StackTraceInterner& interner() const { return interner_; }
+
  private:
+  StackTraceInterner interner_;
+
   absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> stack_trace_ids_;
   absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> prev_stack_trace_ids_;
 
@@ -27,28 +27,56 @@ TEST(StackTraceIDCache, Basic) {
   StackTraceIDCache stack_trace_ids;
 
   const md::UPID kUPID(1, 1, 1);
-  const profiler::SymbolicStackTrace kStackTrace1{kUPID, "a();b();c();"};
-  const profiler::SymbolicStackTrace kStackTrace2{kUPID, "d();e();f();"};
 
-  uint64_t id1 = stack_trace_ids.Lookup(kStackTrace1);
-  uint64_t id2 = stack_trace_ids.Lookup(kStackTrace2);
+  // Interned stacks are invalidated by AgeTick(), so they are re-interned after each one.
+  auto stack_trace1 = [&]() {
+    return profiler::SymbolicStackTrace{
+        kUPID, stack_trace_ids.interner()->InternFoldedString("a();b();c();")};
+  };
+  auto stack_trace2 = [&]() {
+    return profiler::SymbolicStackTrace{
+        kUPID, stack_trace_ids.interner()->InternFoldedString("d();e();f();")};
+  };
+
+  uint64_t id1 = stack_trace_ids.Lookup(stack_trace1());
+  uint64_t id2 = stack_trace_ids.Lookup(stack_trace2());
 
   // Check for consistency.
-  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace1), id1);
-  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace2), id2);
+  EXPECT_EQ(stack_trace_ids.Lookup(stack_trace1()), id1);
+  EXPECT_EQ(stack_trace_ids.Lookup(stack_trace2()), id2);
 
   stack_trace_ids.AgeTick();
 
   // Maintain IDs across one generation.
-  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace1), id1);
-  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace2), id2);
+  EXPECT_EQ(stack_trace_ids.Lookup(stack_trace1()), id1);
+  EXPECT_EQ(stack_trace_ids.Lookup(stack_trace2()), id2);
 
   stack_trace_ids.AgeTick();
   stack_trace_ids.AgeTick();
 
   // Expect new IDs if too many generations have passed since last use.
-  EXPECT_NE(stack_trace_ids.Lookup(kStackTrace1), id1);
-  EXPECT_NE(stack_trace_ids.Lookup(kStackTrace2), id2);
+  EXPECT_NE(stack_trace_ids.Lookup(stack_trace1()), id1);
+  EXPECT_NE(stack_trace_ids.Lookup(stack_trace2()), id2);
+}
+
+TEST(StackTraceIDCache, AgeTickDropsUnusedFrames) {
+  StackTraceIDCache stack_trace_ids;
+  StackTraceInterner* interner = stack_trace_ids.interner();
+
+  const md::UPID kUPID(1, 1, 1);
+  stack_trace_ids.Lookup({kUPID, interner->InternFoldedString("main;foo")});
+  stack_trace_ids.Lookup({kUPID, interner->InternFoldedString("main;bar")});
+  EXPECT_EQ(interner->num_frames(), 3);
+
+  stack_trace_ids.AgeTick();
+  stack_trace_ids.Lookup({kUPID, interner->InternFoldedString("main;foo")});
+  EXPECT_EQ(interner->num_frames(), 3);
+
+  // Only main;foo was used in the last generation.
+  stack_trace_ids.AgeTick();
+  EXPECT_EQ(interner->num_frames(), 2);
+  EXPECT_EQ(interner->FoldedString(interner->InternFoldedString("main;foo")), "main;foo");
+  EXPECT_EQ(interner->num_frames(), 2);
 }
 
 }  // namespace stirling
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
+
+#include <algorithm>
+
+#include <absl/strings/str_split.h>
+
+#include "src/stirling/source_connectors/perf_profiler/shared/symbolization.h"
+
+namespace px {
+namespace stirling {
+
+uint32_t StackTraceInterner::InternFrame(std::string_view frame) {
+  auto iter = frame_ids_.find(frame);
+  if (iter != frame_ids_.end()) {
+    return iter->second;
+  }
+  const auto frame_id = static_cast<uint32_t>(frames_.size());
+  frames_.emplace_back(frame);
+  frame_ids_.emplace(frames_.back(), frame_id);
+  return frame_id;
+}
+
+uint32_t StackTraceInterner::Append(uint32_t stack, absl::Span<const uint32_t> frames) {
+  for (const uint32_t frame : frames) {
+    const uint64_t key = (static_cast<uint64_t>(stack) << 32) | frame;
+    auto [iter, inserted] = children_.try_emplace(key, 0);
+    if (inserted) {
+      iter->second = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back(Node{stack, frame});
+    }
+    stack = iter->second;
+  }
+  return stack;
+}
+
+uint32_t StackTraceInterner::InternFoldedString(std::string_view folded) {
+  uint32_t stack = kEmptyStack;
+  if (folded.empty()) {
+    return stack;
+  }
+  for (std::string_view frame : absl::StrSplit(folded, symbolization::kSeparator)) {
+    const uint32_t frame_id = InternFrame(frame);
+    stack = Append(stack, {&frame_id, 1});
+  }
+  return stack;
+}
+
+std::vector<uint32_t> StackTraceInterner::Frames(uint32_t stack) const {
+  std::vector<uint32_t> frames;
+  for (; stack != kEmptyStack; stack = nodes_[stack].parent) {
+    frames.push_back(nodes_[stack].frame);
+  }
+  std::reverse(frames.begin(), frames.end());
+  return frames;
+}
+
+std::string StackTraceInterner::FoldedString(uint32_t stack) const {
+  const std::vector<uint32_t> frames = Frames(stack);
+
+  size_t size = frames.empty() ? 0 : frames.size() - 1;
+  for (const uint32_t frame : frames) {
+    size += frames_[frame].size();
+  }
+
+  std::string folded;
+  folded.reserve(size);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    if (i > 0) {
+      folded.append(symbolization::kSeparator);
+    }
+    folded.append(frames_[frames[i]]);
+  }
+  return folded;
+}
+
+uint32_t StackTraceInterner::CopyStack(const StackTraceInterner& other, uint32_t stack) {
+  std::vector<uint32_t> frames = other.Frames(stack);
+  for (uint32_t& frame : frames) {
+    frame = InternFrame(other.frames_[frame]);
+  }
+  return Append(kEmptyStack, frames);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
+namespace px {
+namespace stirling {
+
+// StackTraceInterner stores stack traces as paths in a trie of interned frames (symbols).
+// Most stack traces share long common prefixes (e.g. everything below main() or the thread
+// entry point), so each distinct frame string is stored once, and each stack trace costs one
+// trie node per frame that is not shared with another stack trace. A stack trace is then
+// identified by the ID of its last node, which is cheap to hash and compare; the folded stack
+// trace string is only materialized, by FoldedString(), when it is output.
+//
+// IDs are only meaningful for the interner that returned them.
+class StackTraceInterner {
+ public:
+  // The ID of the stack trace with no frames, i.e. the root of the trie.
+  static constexpr uint32_t kEmptyStack = 0;
+
+  StackTraceInterner() = default;
+
+  // Not copyable, because frame_ids_ refers to the strings of frames_; moving keeps them valid.
+  StackTraceInterner(const StackTraceInterner&) = delete;
+  StackTraceInterner& operator=(const StackTraceInterner&) = delete;
+  StackTraceInterner(StackTraceInterner&&) = default;
+  StackTraceInterner& operator=(StackTraceInterner&&) = default;
+
+  // Returns the ID of the frame string, interning it if it is new.
+  uint32_t InternFrame(std::string_view frame);
+
+  // Returns the ID of the stack trace made of `stack`, followed by `frames`.
+  uint32_t Append(uint32_t stack, absl::Span<const uint32_t> frames);
+
+  // Interns a folded stack trace string, e.g. "main;foo;bar", splitting it into frames.
+  uint32_t InternFoldedString(std::string_view folded);
+
+  // Returns the folded stack trace string, with the frames of the stack separated by ';'.
+  std::string FoldedString(uint32_t stack) const;
+
+  // Interns the stack trace `stack` of another interner into this one, and returns its ID here.
+  uint32_t CopyStack(const StackTraceInterner& other, uint32_t stack);
+
+  // Returns the frame IDs of the stack trace, from the root.
+  std::vector<uint32_t> Frames(uint32_t stack) const;
+
+  std::string_view frame(uint32_t frame_id) const { return frames_[frame_id]; }
+
+  size_t num_frames() const { return frames_.size(); }
+  size_t num_stacks() const { return nodes_.size(); }
+
+ private:
+  struct Node {
+    uint32_t parent;
+    uint32_t frame;
+  };
+
+  // A deque, so that the string_views in frame_ids_ stay valid as frames are added.
+  std::deque<std::string> frames_;
+  absl::flat_hash_map<std::string_view, uint32_t> frame_ids_;
+
+  std::vector<Node> nodes_ = {Node{kEmptyStack, 0}};
+  // Key is the parent node ID in the upper 32 bits, and the frame ID in the lower 32 bits.
+  absl::flat_hash_map<uint64_t, uint32_t> children_;
+};
+
+}  // namespace stirling
+}  // namespace px
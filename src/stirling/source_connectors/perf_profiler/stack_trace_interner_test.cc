@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
+
+namespace px {
+namespace stirling {
+
+TEST(StackTraceInternerTest, SharesPrefixes) {
+  StackTraceInterner interner;
+
+  const uint32_t foo = interner.InternFoldedString("main;run;foo");
+  const uint32_t bar = interner.InternFoldedString("main;run;bar");
+  const uint32_t run = interner.InternFoldedString("main;run");
+
+  EXPECT_NE(foo, bar);
+  EXPECT_EQ(interner.InternFoldedString("main;run;foo"), foo);
+  EXPECT_EQ(interner.FoldedString(foo), "main;run;foo");
+  EXPECT_EQ(interner.FoldedString(bar), "main;run;bar");
+  EXPECT_EQ(interner.FoldedString(run), "main;run");
+
+  // The frames main and run, and their trie nodes, are shared.
+  EXPECT_EQ(interner.num_frames(), 4);
+  EXPECT_EQ(interner.num_stacks(), 1 + 4);
+}
+
+TEST(StackTraceInternerTest, Append) {
+  StackTraceInterner interner;
+
+  const std::vector<uint32_t> frames = {interner.InternFrame("main"), interner.InternFrame("foo")};
+  const uint32_t stack = interner.Append(StackTraceInterner::kEmptyStack, frames);
+  EXPECT_EQ(stack, interner.InternFoldedString("main;foo"));
+
+  const uint32_t k_frame = interner.InternFrame("[k] read");
+  EXPECT_EQ(interner.FoldedString(interner.Append(stack, {&k_frame, 1})), "main;foo;[k] read");
+}
+
+TEST(StackTraceInternerTest, EmptyFrames) {
+  StackTraceInterner interner;
+
+  EXPECT_EQ(interner.InternFoldedString(""), StackTraceInterner::kEmptyStack);
+  EXPECT_EQ(interner.FoldedString(StackTraceInterner::kEmptyStack), "");
+  EXPECT_EQ(interner.FoldedString(interner.InternFoldedString(";a;;")), ";a;;");
+}
+
+TEST(StackTraceInternerTest, CopyStack) {
+  StackTraceInterner interner;
+  interner.InternFoldedString("main;unused");
+  const uint32_t stack = interner.InternFoldedString("main;foo");
+
+  StackTraceInterner other;
+  const uint32_t copied = other.CopyStack(interner, stack);
+  EXPECT_EQ(other.FoldedString(copied), "main;foo");
+  EXPECT_EQ(other.num_frames(), 2);
+}
+
+}  // namespace stirling
+}  // namespace px
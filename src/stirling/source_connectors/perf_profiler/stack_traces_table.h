@@ -41,7 +41,8 @@ static constexpr DataElement kElements[] = {
      "If symbols cannot be resolved, addresses are populated instead.",
      types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
-     "Number of times the stack trace has been sampled.",
+     "Number of times the stack trace has been sampled. With adaptive sampling, each sample "
+     "counts as many times as the samples it stands for.",
      types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE}
 };
 
@@ -60,5 +61,53 @@ constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trac
 constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
 
+// clang-format off
+static constexpr DataElement kProfileElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"profile",
+     "The stack traces sampled in the process, as a serialized pprof format profile.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackTraceProfileTable = DataTableSchema(
+        "stack_trace_profiles.beta",
+        "Profiles, in pprof format, of the stack traces sampled in each process over a window "
+        "of time. Only populated with --stirling_profiler_pprof_output.",
+        kProfileElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(StackTraceProfile)
+
+// clang-format off
+static constexpr DataElement kOffCPUElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"stack_trace_id",
+     "A unique identifier of the stack trace, for script-writing convenience. "
+     "String representation is in the `stack_trace` column. The same stack trace has the same "
+     "identifier as in the stack_traces.beta table.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"stack_trace",
+     "A stack trace, in folded format, in which threads of the process were blocked.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"off_cpu_time",
+     "Total time that threads of the process were blocked in the stack trace.",
+     types::DataType::INT64, types::SemanticType::ST_DURATION_NS, types::PatternType::METRIC_GAUGE}
+};
+
+constexpr auto kOffCPUStackTraceTable = DataTableSchema(
+        "offcpu_stack_traces.beta",
+        "Stack traces in which application threads block, e.g. on I/O or on locks, and for how "
+        "long. Only populated with --stirling_profiler_offcpu.",
+        kOffCPUElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(OffCPUStackTrace)
+
+constexpr int kOffCPUStackTraceUPIDIdx = kOffCPUStackTraceTable.ColIndex("upid");
+constexpr int kOffCPUStackTraceStackTraceStrIdx = kOffCPUStackTraceTable.ColIndex("stack_trace");
+constexpr int kOffCPUStackTraceOffCPUTimeIdx = kOffCPUStackTraceTable.ColIndex("off_cpu_time");
+
 }  // namespace stirling
 }  // namespace px
@@ -24,24 +24,38 @@
 #include <utility>
 #include <vector>
 
-#include <absl/functional/bind_front.h>
+#include <absl/strings/str_cat.h>
 
 namespace px {
 namespace stirling {
 
 Stringifier::Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
-                         ebpf::BPFStackTable* stack_traces)
-    : u_symbolizer_(u_symbolizer), k_symbolizer_(k_symbolizer), stack_traces_(stack_traces) {}
+                         ebpf::BPFStackTable* stack_traces, StackTraceInterner* interner)
+    : Stringifier(
+          u_symbolizer, k_symbolizer,
+          [stack_traces](int stack_id) {
+            // Clear the stack-traces map as we go along here; this has lower overhead
+            // compared to first reading the stack-traces map, then using
+            // clear_table_non_atomic().
+            constexpr bool kClearStackId = true;
+            return stack_traces->get_stack_addr(stack_id, kClearStackId);
+          },
+          interner) {}
 
-std::string Stringifier::BuildStackTraceString(const std::vector<uintptr_t>& addrs,
-                                               profiler::SymbolizerFn symbolize_fn,
-                                               const std::string_view& prefix) {
+Stringifier::Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
+                         StackAddrsFn stack_addrs_fn, StackTraceInterner* interner)
+    : interner_(interner),
+      u_symbolizer_(u_symbolizer),
+      k_symbolizer_(k_symbolizer),
+      stack_addrs_fn_(std::move(stack_addrs_fn)) {}
+
+std::vector<uint32_t> Stringifier::BuildStackTraceFrames(const std::vector<uintptr_t>& addrs,
+                                                         profiler::SymbolizerFn symbolize_fn,
+                                                         const std::string_view& prefix) {
   using symbolization::kJavaInterpreter;
-  using symbolization::kSeparator;
 
-  // TODO(jps): re-evaluate the correct amount to reserve here.
-  std::string stack_trace_str;
-  stack_trace_str.reserve(128);
+  std::vector<uint32_t> frames;
+  frames.reserve(addrs.size());
 
   // Some stack-traces have the address 0xcccccccccccccccc where one might
   // otherwise expect to find "main" or "start_thread". Given that this address
@@ -49,7 +63,13 @@ std::string Stringifier::BuildStackTraceString(const std::vector<uintptr_t>& add
   constexpr uint64_t kSentinelAddr = 0xcccccccccccccccc;
   uint64_t num_collapsed = 0;
 
-  // Build the folded stack trace string.
+  auto add_collapsed_frame = [&]() {
+    frame_buf_ = absl::StrCat(kJavaInterpreter, " [", num_collapsed, "x]");
+    frames.push_back(interner_->InternFrame(frame_buf_));
+    num_collapsed = 0;
+  };
+
+  // Build the folded stack trace, from the root.
   for (auto iter = addrs.rbegin(); iter != addrs.rend(); ++iter) {
     const auto& addr = *iter;
     if (addr == kSentinelAddr && iter == addrs.rbegin()) {
@@ -62,46 +82,35 @@ std::string Stringifier::BuildStackTraceString(const std::vector<uintptr_t>& add
       ++num_collapsed;
       continue;
     } else if (num_collapsed > 0) {
-      stack_trace_str =
-          absl::StrCat(stack_trace_str, kJavaInterpreter, " [", num_collapsed, "x]", kSeparator);
-      num_collapsed = 0;
+      add_collapsed_frame();
     }
-    stack_trace_str = absl::StrCat(stack_trace_str, prefix, symbol, kSeparator);
+    frame_buf_.assign(prefix);
+    frame_buf_.append(symbol);
+    frames.push_back(interner_->InternFrame(frame_buf_));
   }
   if (num_collapsed) {
-    stack_trace_str =
-        absl::StrCat(stack_trace_str, kJavaInterpreter, " [", num_collapsed, "x]", kSeparator);
+    add_collapsed_frame();
   }
 
-  if (!stack_trace_str.empty()) {
-    // Remove trailing separator.
-    stack_trace_str.pop_back();
-  }
-
-  return stack_trace_str;
+  return frames;
 }
 
-std::string Stringifier::FindOrBuildStackTraceString(const int stack_id,
-                                                     profiler::SymbolizerFn symbolize_fn,
-                                                     const std::string_view& prefix) {
-  // First try to find the memoized result in the stack_trace_strs_ map,
-  // if no memoized result is available, build the folded stack trace string.
-  auto [iter, inserted] = stack_trace_strs_.try_emplace(stack_id, "");
+const std::vector<uint32_t>& Stringifier::FindOrBuildStackTraceFrames(
+    const int stack_id, profiler::SymbolizerFn symbolize_fn, const std::string_view& prefix) {
+  // First try to find the memoized result in the stack_trace_frames_ map,
+  // if no memoized result is available, build the stack trace.
+  auto [iter, inserted] = stack_trace_frames_.try_emplace(stack_id);
   if (inserted) {
-    // Clear the stack-traces map as we go along here; this has lower overhead
-    // compared to first reading the stack-traces map, then using clear_table_non_atomic().
-    constexpr bool kClearStackId = true;
-
-    // Get the stack trace (as a vector of addresses) from the shared BPF stack trace table.
-    const std::vector<uintptr_t> addrs = stack_traces_->get_stack_addr(stack_id, kClearStackId);
+    // Get the stack trace (as a vector of addresses), e.g. from the shared BPF stack trace table.
+    const std::vector<uintptr_t> addrs = stack_addrs_fn_(stack_id);
     VLOG_IF(1, addrs.empty()) << absl::Substitute("[empty_stack_trace] stack_id: $0", stack_id);
 
-    iter->second = BuildStackTraceString(addrs, symbolize_fn, prefix);
+    iter->second = BuildStackTraceFrames(addrs, symbolize_fn, prefix);
   }
   return iter->second;
 }
 
-std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
+uint32_t Stringifier::FoldedStackTrace(const stack_trace_key_t& key) {
   using symbolization::kKernelPrefix;
   using symbolization::kUserPrefix;
 
@@ -114,44 +123,45 @@ std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
   auto u_symbolizer_fn = u_symbolizer_->GetSymbolizerFn(u_upid);
   auto k_symbolizer_fn = k_symbolizer_->GetSymbolizerFn(k_upid);
 
-  // Using bind because it helps reduce redundant information in the if/else chain below.
-  // Also, it is easier to read, e.g.:
-  // stack_trace_str = u_stack_str_fn() + ";" + k_stack_str_fn();
-  auto fn_addr = &Stringifier::FindOrBuildStackTraceString;
-  auto u_stack_str_fn = absl::bind_front(fn_addr, this, u_stack_id, u_symbolizer_fn, kUserPrefix);
-  auto k_stack_str_fn = absl::bind_front(fn_addr, this, k_stack_id, k_symbolizer_fn, kKernelPrefix);
+  auto u_stack_frames = [&]() -> const std::vector<uint32_t>& {
+    return FindOrBuildStackTraceFrames(u_stack_id, u_symbolizer_fn, kUserPrefix);
+  };
+  auto k_stack_frames = [&]() -> const std::vector<uint32_t>& {
+    return FindOrBuildStackTraceFrames(k_stack_id, k_symbolizer_fn, kKernelPrefix);
+  };
 
-  std::string stack_trace_str;
-  stack_trace_str.reserve(128);
+  constexpr uint32_t kEmptyStack = StackTraceInterner::kEmptyStack;
 
   // TODO(jps/oazizi): question... should we use the "drop message" for -EEXIST,
   // if only one of two stack-ids indicates a hash table collision?
   // vs. the current logic which shows the "drop message" only if both stack-ids are -EEXIST.
 
   if (u_stack_id >= 0 && k_stack_id >= 0) {
-    stack_trace_str = u_stack_str_fn();
-    stack_trace_str += symbolization::kSeparator;
-    stack_trace_str += k_stack_str_fn();
+    const uint32_t u_stack = interner_->Append(kEmptyStack, u_stack_frames());
+    return interner_->Append(u_stack, k_stack_frames());
   } else if (u_stack_id >= 0) {
-    stack_trace_str = u_stack_str_fn();
     DCHECK(k_stack_id == -EEXIST || k_stack_id == -EFAULT) << "ustack_id: " << u_stack_id;
+    return interner_->Append(kEmptyStack, u_stack_frames());
   } else if (k_stack_id >= 0) {
-    stack_trace_str = k_stack_str_fn();
     DCHECK(u_stack_id == -EEXIST || u_stack_id == -EFAULT) << "kstack_id: " << k_stack_id;
-  } else {
-    // The kernel can indicate "not valid" for a stack-id in two different ways:
-    // 1. -EFAULT: the stack trace was not available
-    // e.g. stack trace is in user space only and kstack_id is invalid.
-    // 2. -EEXIST: hash bucket collision in the stack traces table
-    // We can reach this branch if one, or both, of the stack-ids had a hash table collision,
-    // but we should not get here with both stack-ids set to "invalid" i.e. -EFAULT.
-    stack_trace_str = symbolization::kDropMessage;
-    DCHECK(u_stack_id == -EEXIST || u_stack_id == -EFAULT) << "u_stack_id: " << u_stack_id;
-    DCHECK(k_stack_id == -EEXIST || k_stack_id == -EFAULT) << "k_stack_id: " << k_stack_id;
-    DCHECK(!(k_stack_id == -EFAULT && u_stack_id == -EFAULT)) << "both invalid.";
+    return interner_->Append(kEmptyStack, k_stack_frames());
   }
 
-  return stack_trace_str;
+  // The kernel can indicate "not valid" for a stack-id in two different ways:
+  // 1. -EFAULT: the stack trace was not available
+  // e.g. stack trace is in user space only and kstack_id is invalid.
+  // 2. -EEXIST: hash bucket collision in the stack traces table
+  // We can reach this branch if one, or both, of the stack-ids had a hash table collision,
+  // but we should not get here with both stack-ids set to "invalid" i.e. -EFAULT.
+  DCHECK(u_stack_id == -EEXIST || u_stack_id == -EFAULT) << "u_stack_id: " << u_stack_id;
+  DCHECK(k_stack_id == -EEXIST || k_stack_id == -EFAULT) << "k_stack_id: " << k_stack_id;
+  DCHECK(!(k_stack_id == -EFAULT && u_stack_id == -EFAULT)) << "both invalid.";
+  const uint32_t drop_frame = interner_->InternFrame(symbolization::kDropMessage);
+  return interner_->Append(kEmptyStack, {&drop_frame, 1});
+}
+
+std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
+  return interner_->FoldedString(FoldedStackTrace(key));
 }
 
 }  // namespace stirling
@@ -18,11 +18,13 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "src/stirling/bpf_tools/bcc_bpf_intf/upid.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
+#include "src/stirling/source_connectors/perf_profiler/stack_trace_interner.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
 namespace px {
@@ -47,8 +49,11 @@ namespace stirling {
 // When the stringifier reads the shared BPF map of stack trace addresses, it does so using
 // a destructive read (it reads one stack trace, and clears it, from the table).
 // Because of stack-trace-id reuse and the destructive read, the stringifier memoizes
-// its stringified results. A new stringifier is created (and destroyed) on each iteration
+// its results. A new stringifier is created (and destroyed) on each iteration
 // of the continuous perf. profiler.
+//
+// The symbols are interned in a StackTraceInterner, so stack traces are built as sequences of
+// frame IDs, and the folded string is only materialized if it is asked for.
 class Stringifier {
  public:
   /**
@@ -57,36 +62,56 @@ class Stringifier {
    * @param u_symbolizer A symbolizer for user-space addresses.
    * @param k_symbolizer A symbolizer for kernel-space addresses.
    * @param stack_traces Pointer to the BCC collected stack traces.
+   * @param interner Interns the symbols and stack traces; it must outlive the stringifier.
    */
   Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
-              ebpf::BPFStackTable* stack_traces);
+              ebpf::BPFStackTable* stack_traces, StackTraceInterner* interner);
+
+  // Returns the addresses of a stack trace, given its stack-id.
+  using StackAddrsFn = std::function<std::vector<uintptr_t>(int stack_id)>;
+
+  /**
+   * Construct a stack trace stringifier that reads stack traces through stack_addrs_fn,
+   * e.g. from a copy of the BPF stack traces table.
+   */
+  Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer, StackAddrsFn stack_addrs_fn,
+              StackTraceInterner* interner);
 
-  // Returns a folded stack trace string based on the stack trace histogram key.
+  // Returns the interned folded stack trace, based on the stack trace histogram key.
   // The key contains both a user & kernel stack-trace-id, which are subsequently
-  // passed into FindOrBuildStackTraceString().
+  // passed into FindOrBuildStackTraceFrames().
+  uint32_t FoldedStackTrace(const stack_trace_key_t& key);
+
+  // Like FoldedStackTrace(), but returns the folded stack trace string.
   std::string FoldedStackTraceString(const stack_trace_key_t& key);
 
  private:
-  std::string BuildStackTraceString(const std::vector<uintptr_t>& addrs,
-                                    profiler::SymbolizerFn symbolize_fn,
-                                    const std::string_view& prefix);
-  std::string FindOrBuildStackTraceString(const int stack_id, profiler::SymbolizerFn symbolize_fn,
-                                          const std::string_view& prefix);
+  std::vector<uint32_t> BuildStackTraceFrames(const std::vector<uintptr_t>& addrs,
+                                              profiler::SymbolizerFn symbolize_fn,
+                                              const std::string_view& prefix);
+  const std::vector<uint32_t>& FindOrBuildStackTraceFrames(const int stack_id,
+                                                           profiler::SymbolizerFn symbolize_fn,
+                                                           const std::string_view& prefix);
+
+  // Memoized results of previous calls to FindOrBuildStackTraceFrames():
+  // a map from stack-trace-id to the interned frames of the stack trace.
+  absl::flat_hash_map<int, std::vector<uint32_t>> stack_trace_frames_;
+
+  StackTraceInterner* const interner_;
 
-  // Memoized results of previous calls to FindOrBuildStackTraceString():
-  // a map from stack-trace-id to folded stack trace string.
-  absl::flat_hash_map<int, std::string> stack_trace_strs_;
+  // Reused to build each frame string before it is interned.
+  std::string frame_buf_;
 
   // The symbolizer is used to look up a symbol that corresponds to a stack trace address.
   Symbolizer* const u_symbolizer_;
   Symbolizer* const k_symbolizer_;
 
-  // The shared BPF stack trace table provides a stack trace, as a list of addresses,
-  // based on the stack-trace-id (an integer). When read, a given stack trace is consumed by
+  // Provides a stack trace, as a list of addresses, based on the stack-trace-id (an integer).
+  // When reading from the shared BPF stack trace table, a given stack trace is consumed by
   // a destructive read, i.e. such that the BPF stack trace table does not need
   // to be explicitly cleared (by re-iterating the histogram) after an iteration
   // of the continuous perf. profiler is completed.
-  ebpf::BPFStackTable* const stack_traces_;
+  const StackAddrsFn stack_addrs_fn_;
 };
 
 }  // namespace stirling
@@ -118,8 +118,8 @@ class StringifierTest : public ::testing::Test {
 
     // Create our device under test, the stringifier.
     // It needs a symbolizer and a shared BPF stack traces map.
-    stringifier_ =
-        std::make_unique<Stringifier>(symbolizer_.get(), symbolizer_.get(), stack_traces_.get());
+    stringifier_ = std::make_unique<Stringifier>(symbolizer_.get(), symbolizer_.get(),
+                                                 stack_traces_.get(), &interner_);
   }
 
   void TearDown() override {}
@@ -166,6 +166,7 @@ class StringifierTest : public ::testing::Test {
   std::unique_ptr<Histogram> histogram_;
 
   std::unique_ptr<Symbolizer> symbolizer_;
+  StackTraceInterner interner_;
   std::unique_ptr<Stringifier> stringifier_;
 
   // Sets of observed stack-ids for user, kernel, and their union.
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include <absl/strings/str_format.h>
+
+#include "src/common/base/file.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'X', 'S', 'Y', 'M', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t num_entries;
+  uint64_t names_size;
+};
+
+struct PackedEntry {
+  uint64_t addr;
+  uint64_t size;
+  uint64_t name_offset;
+  uint64_t name_size;
+};
+
+const Header& GetHeader(std::string_view data) {
+  return *reinterpret_cast<const Header*>(data.data());
+}
+
+const PackedEntry* GetEntries(std::string_view data) {
+  return reinterpret_cast<const PackedEntry*>(data.data() + sizeof(Header));
+}
+
+std::string_view GetNames(std::string_view data) {
+  const Header& header = GetHeader(data);
+  return data.substr(sizeof(Header) + header.num_entries * sizeof(PackedEntry));
+}
+
+}  // namespace
+
+std::unique_ptr<SymbolIndex> SymbolIndex::Create(std::vector<Entry> entries) {
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.addr < b.addr; });
+
+  size_t names_size = 0;
+  for (const auto& e : entries) {
+    names_size += e.name.size();
+  }
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_entries = entries.size();
+  header.names_size = names_size;
+
+  auto index = std::unique_ptr<SymbolIndex>(new SymbolIndex());
+  std::string& data = index->owned_data_;
+  data.reserve(sizeof(Header) + entries.size() * sizeof(PackedEntry) + names_size);
+  data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  uint64_t name_offset = 0;
+  for (const auto& e : entries) {
+    PackedEntry packed = {e.addr, e.size, name_offset, e.name.size()};
+    data.append(reinterpret_cast<const char*>(&packed), sizeof(packed));
+    name_offset += e.name.size();
+  }
+  for (const auto& e : entries) {
+    data.append(e.name);
+  }
+
+  index->data_ = index->owned_data_;
+  index->BuildEytzingerLayout();
+  return index;
+}
+
+bool SymbolIndex::IsValid(std::string_view data) {
+  if (data.size() < sizeof(Header)) {
+    return false;
+  }
+  const Header& header = GetHeader(data);
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+    return false;
+  }
+  if (header.num_entries > (data.size() - sizeof(Header)) / sizeof(PackedEntry) ||
+      header.num_entries >= std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  if (data.size() != sizeof(Header) + header.num_entries * sizeof(PackedEntry) +
+                          header.names_size) {
+    return false;
+  }
+  const PackedEntry* entries = GetEntries(data);
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    if (entries[i].name_offset > header.names_size ||
+        entries[i].name_size > header.names_size - entries[i].name_offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+StatusOr<std::unique_ptr<SymbolIndex>> SymbolIndex::Open(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Could not open $0: $1", path.string(), std::strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Could not stat $0: $1", path.string(), std::strerror(errno));
+  }
+  const size_t size = st.st_size;
+  if (size < sizeof(Header)) {
+    return error::InvalidArgument("$0 is not a symbol index.", path.string());
+  }
+
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Could not mmap $0: $1", path.string(), std::strerror(errno));
+  }
+
+  auto index = std::unique_ptr<SymbolIndex>(new SymbolIndex());
+  index->data_ = std::string_view(static_cast<const char*>(addr), size);
+  index->mapped_ = true;
+
+  if (!IsValid(index->data_)) {
+    return error::InvalidArgument("$0 is not a valid symbol index.", path.string());
+  }
+  index->BuildEytzingerLayout();
+  return index;
+}
+
+SymbolIndex::~SymbolIndex() {
+  if (mapped_) {
+    munmap(const_cast<char*>(data_.data()), data_.size());
+  }
+}
+
+Status SymbolIndex::WriteToFile(const std::filesystem::path& path) const {
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp.", getpid());
+  PL_RETURN_IF_ERROR(
+      WriteFileFromString(tmp_path, data_, std::ios_base::out | std::ios_base::binary));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+    return error::Internal("Could not rename $0 to $1.", tmp_path.string(), path.string());
+  }
+  return Status::OK();
+}
+
+size_t SymbolIndex::num_entries() const { return GetHeader(data_).num_entries; }
+
+void SymbolIndex::BuildEytzingerLayout() {
+  const size_t n = num_entries();
+  const PackedEntry* entries = GetEntries(data_);
+  eytzinger_addrs_.resize(n + 1);
+  eytzinger_positions_.resize(n + 1);
+
+  // An in-order traversal of the implicit tree, where the children of node k are 2k and 2k+1,
+  // visits the nodes in sorted order.
+  size_t pos = 0;
+  std::function<void(size_t)> fill = [&](size_t k) {
+    if (k > n) {
+      return;
+    }
+    fill(2 * k);
+    eytzinger_addrs_[k] = entries[pos].addr;
+    eytzinger_positions_[k] = pos;
+    ++pos;
+    fill(2 * k + 1);
+  };
+  fill(1);
+}
+
+size_t SymbolIndex::UpperBound(uintptr_t addr) const {
+  const size_t n = eytzinger_addrs_.size() - 1;
+  const uint64_t* addrs = eytzinger_addrs_.data();
+
+  size_t k = 1;
+  while (k <= n) {
+    // The 16 descendants, 4 levels down, share 2 cache lines.
+    __builtin_prefetch(addrs + std::min(16 * k, n));
+    k = 2 * k + (addrs[k] <= addr);
+  }
+  // Undo the right turns after the last left turn, and that left turn; k is then the first node
+  // after addr, or 0 if there is none.
+  k >>= __builtin_ffsll(~k);
+  return k == 0 ? n : eytzinger_positions_[k];
+}
+
+std::optional<std::string_view> SymbolIndex::SymbolBefore(size_t upper_bound,
+                                                          uintptr_t addr) const {
+  if (upper_bound == 0) {
+    return std::nullopt;
+  }
+  const PackedEntry& entry = GetEntries(data_)[upper_bound - 1];
+  if (addr >= entry.addr && addr < entry.addr + entry.size) {
+    return GetNames(data_).substr(entry.name_offset, entry.name_size);
+  }
+  return std::nullopt;
+}
+
+std::string_view SymbolIndex::Lookup(uintptr_t addr) const {
+  std::optional<std::string_view> symbol = SymbolBefore(UpperBound(addr), addr);
+  if (symbol.has_value()) {
+    return symbol.value();
+  }
+
+  // Couldn't find the address.
+  unknown_symbol_ = absl::StrFormat("0x%016llx", addr);
+  return unknown_symbol_;
+}
+
+void SymbolIndex::Lookup(absl::Span<const uintptr_t> addrs,
+                         absl::Span<std::string_view> symbols) const {
+  DCHECK_EQ(addrs.size(), symbols.size());
+  unknown_symbols_.clear();
+
+  const size_t n = eytzinger_addrs_.size() - 1;
+  const uint64_t* tree = eytzinger_addrs_.data();
+
+  constexpr size_t kNumInterleaved = 8;
+  for (size_t begin = 0; begin < addrs.size(); begin += kNumInterleaved) {
+    const size_t num = std::min(kNumInterleaved, addrs.size() - begin);
+
+    // Advances each search by one level at a time, so the loads of the searches are independent.
+    size_t ks[kNumInterleaved];
+    std::fill_n(ks, num, 1);
+    bool searching = n > 0;
+    while (searching) {
+      searching = false;
+      for (size_t i = 0; i < num; ++i) {
+        size_t& k = ks[i];
+        if (k <= n) {
+          __builtin_prefetch(tree + std::min(16 * k, n));
+          k = 2 * k + (tree[k] <= addrs[begin + i]);
+          searching |= k <= n;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < num; ++i) {
+      const uintptr_t addr = addrs[begin + i];
+      const size_t k = ks[i] >> __builtin_ffsll(~ks[i]);
+      const size_t upper_bound = k == 0 ? n : eytzinger_positions_[k];
+      std::optional<std::string_view> symbol = SymbolBefore(upper_bound, addr);
+      if (symbol.has_value()) {
+        symbols[begin + i] = symbol.value();
+      } else {
+        symbols[begin + i] = unknown_symbols_.emplace_back(absl::StrFormat("0x%016llx", addr));
+      }
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
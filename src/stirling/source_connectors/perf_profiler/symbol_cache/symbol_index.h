@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/types/span.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * SymbolIndex is a read-only table of the function symbols of one binary, in a flat format that
+ * can be written to disk and mmap'd back in. Because binaries are identified by their build-id,
+ * an index can be shared by all processes that map the same binary, and reused across restarts.
+ *
+ * The format is a header, followed by the entries sorted by address, followed by the names.
+ * Lookups search a copy of the addresses in Eytzinger (breadth-first) order, built in memory
+ * when the index is created or opened, so that the first levels of the search share a few
+ * cache lines and the next levels can be prefetched.
+ */
+class SymbolIndex : public NotCopyMoveable {
+ public:
+  struct Entry {
+    uintptr_t addr;
+    size_t size;
+    std::string_view name;
+  };
+
+  /**
+   * Creates an in-memory index of the entries, which must not overlap.
+   */
+  static std::unique_ptr<SymbolIndex> Create(std::vector<Entry> entries);
+
+  /**
+   * Maps in an index that was previously written with WriteToFile().
+   * Returns an error if the file is not a complete index of the current format.
+   */
+  static StatusOr<std::unique_ptr<SymbolIndex>> Open(const std::filesystem::path& path);
+
+  ~SymbolIndex();
+
+  /**
+   * Writes the index to path. The file is written to a temporary path and then renamed, so that
+   * readers never see a partially written index.
+   */
+  Status WriteToFile(const std::filesystem::path& path) const;
+
+  /**
+   * Lookup the symbol for the specified address; returns the address in hex if it is not in the
+   * index. Like ElfReader::Symbolizer::Lookup(), the whole range of each symbol is covered.
+   */
+  std::string_view Lookup(uintptr_t addr) const;
+
+  /**
+   * Looks up the symbols of a batch of addresses, into symbols (of the same size). Several
+   * searches are interleaved, so that their cache misses overlap. The symbols of addresses that
+   * are not in the index remain valid until the next call.
+   */
+  void Lookup(absl::Span<const uintptr_t> addrs, absl::Span<std::string_view> symbols) const;
+
+  size_t num_entries() const;
+
+ private:
+  SymbolIndex() = default;
+
+  static bool IsValid(std::string_view data);
+
+  void BuildEytzingerLayout();
+
+  // Returns the position, in the sorted entries, of the first entry after addr.
+  size_t UpperBound(uintptr_t addr) const;
+
+  // Returns the symbol of the entry before upper_bound, if it covers addr.
+  std::optional<std::string_view> SymbolBefore(size_t upper_bound, uintptr_t addr) const;
+
+  // Either points into owned_data_, or into a read-only mapping of a file.
+  std::string_view data_;
+  std::string owned_data_;
+  bool mapped_ = false;
+
+  // The addresses of the entries in Eytzinger order, from index 1, and their positions in the
+  // sorted entries.
+  std::vector<uint64_t> eytzinger_addrs_;
+  std::vector<uint32_t> eytzinger_positions_;
+
+  // Holds the string returned by Lookup(), for addresses that are not in the index.
+  mutable std::string unknown_symbol_;
+  mutable std::deque<std::string> unknown_symbols_;
+};
+
+}  // namespace stirling
+}  // namespace px
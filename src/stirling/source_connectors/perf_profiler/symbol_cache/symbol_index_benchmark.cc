@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Compares symbol lookups in ElfReader::Symbolizer, which keeps its symbols in a btree, with
+// lookups in SymbolIndex, for a large Go binary and for libc:
+//
+//   symbol_index_benchmark --benchmark_filter=go
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/match.h>
+#include <absl/strings/substitute.h>
+#include <absl/types/span.h>
+#include <benchmark/benchmark.h>
+
+#include "src/common/base/base.h"
+#include "src/common/testing/test_environment.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_index.h"
+
+using px::stirling::SymbolIndex;
+using px::stirling::obj_tools::ElfReader;
+using px::testing::BazelRunfilePath;
+
+// A statically linked Go binary with tens of thousands of symbols. Stripped binaries have no
+// symbol table, so there would be nothing to index.
+constexpr std::string_view kGoBinary =
+    "src/stirling/obj_tools/testdata/go/sockshop_payments_service";
+constexpr std::string_view kLibc = "/lib/x86_64-linux-gnu/libc.so.6";
+
+constexpr size_t kNumAddrs = 1 << 16;
+
+struct TestBinary {
+  std::unique_ptr<ElfReader::Symbolizer> elf_symbolizer;
+  std::unique_ptr<SymbolIndex> index;
+  // Random addresses across the range of the symbols, some of which are not in any symbol.
+  std::vector<uintptr_t> addrs;
+};
+
+const TestBinary& GetTestBinary(std::string_view path) {
+  static absl::flat_hash_map<std::string, std::unique_ptr<TestBinary>> binaries;
+
+  std::unique_ptr<TestBinary>& binary = binaries[std::string(path)];
+  if (binary != nullptr) {
+    return *binary;
+  }
+  binary = std::make_unique<TestBinary>();
+
+  const std::filesystem::path binary_path =
+      absl::StartsWith(path, "/") ? std::filesystem::path(path) : BazelRunfilePath(path);
+  PL_ASSIGN_OR_EXIT(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary_path));
+  PL_ASSIGN_OR_EXIT(binary->elf_symbolizer, elf_reader->GetSymbolizer());
+
+  std::vector<SymbolIndex::Entry> entries;
+  for (const auto& [addr, info] : binary->elf_symbolizer->entries()) {
+    entries.push_back({addr, info.size, info.name});
+  }
+  binary->index = SymbolIndex::Create(std::move(entries));
+
+  const auto& symbols = binary->elf_symbolizer->entries();
+  if (!symbols.empty()) {
+    const uintptr_t begin = symbols.begin()->first;
+    const uintptr_t end = symbols.rbegin()->first + symbols.rbegin()->second.size;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uintptr_t> dist(begin, end - 1);
+    for (size_t i = 0; i < kNumAddrs; ++i) {
+      binary->addrs.push_back(dist(rng));
+    }
+  }
+  LOG(INFO) << absl::Substitute("$0: $1 symbols.", path, binary->index->num_entries());
+  return *binary;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ElfSymbolizerLookup(benchmark::State& state, std::string_view path) {
+  const TestBinary& binary = GetTestBinary(path);
+  for (auto _ : state) {
+    for (const uintptr_t addr : binary.addrs) {
+      benchmark::DoNotOptimize(binary.elf_symbolizer->Lookup(addr));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * binary.addrs.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_SymbolIndexLookup(benchmark::State& state, std::string_view path) {
+  const TestBinary& binary = GetTestBinary(path);
+  for (auto _ : state) {
+    for (const uintptr_t addr : binary.addrs) {
+      benchmark::DoNotOptimize(binary.index->Lookup(addr));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * binary.addrs.size());
+}
+
+// Looks up the addresses in batches of state.range(0), as the addresses of a stack trace are.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_SymbolIndexBatchLookup(benchmark::State& state, std::string_view path) {
+  const TestBinary& binary = GetTestBinary(path);
+  const size_t batch_size = state.range(0);
+  std::vector<std::string_view> symbols(batch_size);
+  for (auto _ : state) {
+    for (size_t i = 0; i < binary.addrs.size(); i += batch_size) {
+      const size_t n = std::min(batch_size, binary.addrs.size() - i);
+      binary.index->Lookup(absl::MakeConstSpan(binary.addrs).subspan(i, n),
+                           absl::MakeSpan(symbols).subspan(0, n));
+      benchmark::DoNotOptimize(symbols.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * binary.addrs.size());
+}
+
+BENCHMARK_CAPTURE(BM_ElfSymbolizerLookup, go, kGoBinary);
+BENCHMARK_CAPTURE(BM_SymbolIndexLookup, go, kGoBinary);
+BENCHMARK_CAPTURE(BM_SymbolIndexBatchLookup, go, kGoBinary)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK_CAPTURE(BM_ElfSymbolizerLookup, libc, kLibc);
+BENCHMARK_CAPTURE(BM_SymbolIndexLookup, libc, kLibc);
+BENCHMARK_CAPTURE(BM_SymbolIndexBatchLookup, libc, kLibc)->Arg(8)->Arg(32)->Arg(128);
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_format.h>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_index.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+
+std::unique_ptr<SymbolIndex> CreateTestIndex() {
+  // Out of order, to check that the entries get sorted.
+  std::vector<SymbolIndex::Entry> entries = {
+      {0x2000, 0x10, "bar"},
+      {0x1000, 0x100, "foo"},
+      {0x3000, 0x1, "baz"},
+  };
+  return SymbolIndex::Create(std::move(entries));
+}
+
+void ExpectTestIndexLookups(const SymbolIndex& index) {
+  EXPECT_EQ(index.num_entries(), 3);
+  EXPECT_EQ(index.Lookup(0x1000), "foo");
+  EXPECT_EQ(index.Lookup(0x10ff), "foo");
+  EXPECT_EQ(index.Lookup(0x2008), "bar");
+  EXPECT_EQ(index.Lookup(0x3000), "baz");
+
+  // Before the first symbol, in between symbols, and after the last symbol.
+  EXPECT_EQ(index.Lookup(0xfff), "0x0000000000000fff");
+  EXPECT_EQ(index.Lookup(0x1100), "0x0000000000001100");
+  EXPECT_EQ(index.Lookup(0x3001), "0x0000000000003001");
+}
+
+TEST(SymbolIndexTest, Lookup) {
+  std::unique_ptr<SymbolIndex> index = CreateTestIndex();
+  ExpectTestIndexLookups(*index);
+}
+
+TEST(SymbolIndexTest, BatchLookup) {
+  std::unique_ptr<SymbolIndex> index = CreateTestIndex();
+
+  const std::vector<uintptr_t> addrs = {0x10ff, 0xfff, 0x2008, 0x3001, 0x1000, 0x3000};
+  std::vector<std::string_view> symbols(addrs.size());
+  index->Lookup(addrs, absl::MakeSpan(symbols));
+  EXPECT_THAT(symbols, ElementsAre("foo", "0x0000000000000fff", "bar", "0x0000000000003001", "foo",
+                                   "baz"));
+}
+
+// Checks the lookups of an index large enough to have several levels, and an incomplete last
+// level, against those of the entries.
+TEST(SymbolIndexTest, ManyEntries) {
+  constexpr int kNumEntries = 1000;
+  std::vector<std::string> names;
+  std::vector<SymbolIndex::Entry> entries;
+  for (int i = 0; i < kNumEntries; ++i) {
+    names.push_back(absl::StrCat("fn", i));
+  }
+  for (int i = 0; i < kNumEntries; ++i) {
+    // Every other range of 0x10 bytes is not covered by a symbol.
+    entries.push_back({static_cast<uintptr_t>(0x1000 + 0x20 * i), 0x10, names[i]});
+  }
+  std::unique_ptr<SymbolIndex> index = SymbolIndex::Create(entries);
+
+  std::vector<uintptr_t> addrs;
+  std::vector<std::string> expected_symbols;
+  for (uintptr_t addr = 0xff0; addr < 0x1000 + 0x20 * kNumEntries + 0x10; addr += 0x8) {
+    addrs.push_back(addr);
+    const bool covered = addr >= 0x1000 && (addr - 0x1000) % 0x20 < 0x10 &&
+                         addr < 0x1000 + 0x20 * kNumEntries;
+    expected_symbols.push_back(covered ? names[(addr - 0x1000) / 0x20]
+                                       : absl::StrFormat("0x%016llx", addr));
+  }
+
+  std::vector<std::string_view> symbols(addrs.size());
+  index->Lookup(addrs, absl::MakeSpan(symbols));
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    EXPECT_EQ(index->Lookup(addrs[i]), expected_symbols[i]);
+    EXPECT_EQ(symbols[i], expected_symbols[i]);
+  }
+}
+
+TEST(SymbolIndexTest, Empty) {
+  std::unique_ptr<SymbolIndex> index = SymbolIndex::Create({});
+  EXPECT_EQ(index->num_entries(), 0);
+  EXPECT_EQ(index->Lookup(0x1000), "0x0000000000001000");
+}
+
+TEST(SymbolIndexTest, WriteAndOpen) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "test.symidx";
+
+  ASSERT_OK(CreateTestIndex()->WriteToFile(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<SymbolIndex> index, SymbolIndex::Open(path));
+  ExpectTestIndexLookups(*index);
+}
+
+TEST(SymbolIndexTest, OpenInvalid) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "test.symidx";
+
+  ASSERT_OK(WriteFileFromString(path, "not a symbol index, but long enough to have a header"));
+  EXPECT_NOT_OK(SymbolIndex::Open(path));
+
+  // A truncated index.
+  std::unique_ptr<SymbolIndex> index = CreateTestIndex();
+  ASSERT_OK(index->WriteToFile(path));
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(path));
+  ASSERT_OK(WriteFileFromString(path, contents.substr(0, contents.size() - 1)));
+  EXPECT_NOT_OK(SymbolIndex::Open(path));
+
+  EXPECT_NOT_OK(SymbolIndex::Open(path.string() + ".does_not_exist"));
+}
+
+}  // namespace stirling
+}  // namespace px
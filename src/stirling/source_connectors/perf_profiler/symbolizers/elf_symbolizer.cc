@@ -17,6 +17,9 @@
  */
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <absl/functional/bind_front.h>
 
@@ -24,6 +27,11 @@
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
+DEFINE_string(stirling_profiler_symbol_index_dir,
+              gflags::StringFromEnv("PL_PROFILER_SYMBOL_INDEX_DIR", ""),
+              "Directory in which the ELF symbolizer keeps symbol indexes, keyed by build-id, "
+              "so that they persist across restarts. Not used if empty.");
+
 using ::px::stirling::obj_tools::ElfReader;
 
 namespace px {
@@ -35,9 +43,36 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  const std::string build_id = std::move(iter->second.build_id);
+  symbolizers_.erase(iter);
+
+  // Forget the index once the last process that runs its binary is gone.
+  auto index_iter = indexes_by_build_id_.find(build_id);
+  if (index_iter != indexes_by_build_id_.end() && index_iter->second.expired()) {
+    indexes_by_build_id_.erase(index_iter);
+  }
+}
+
+namespace {
 
-StatusOr<std::unique_ptr<ElfReader::Symbolizer>> CreateUPIDSymbolizer(const struct upid_t& upid) {
+std::unique_ptr<SymbolIndex> CreateSymbolIndex(const ElfReader::Symbolizer& elf_symbolizer) {
+  std::vector<SymbolIndex::Entry> entries;
+  entries.reserve(elf_symbolizer.entries().size());
+  for (const auto& [addr, info] : elf_symbolizer.entries()) {
+    entries.push_back({addr, info.size, info.name});
+  }
+  return SymbolIndex::Create(std::move(entries));
+}
+
+}  // namespace
+
+StatusOr<ElfSymbolizer::UPIDSymbolizer> ElfSymbolizer::CreateUPIDSymbolizer(
+    const struct upid_t& upid) {
   PL_ASSIGN_OR_RETURN(std::unique_ptr<FilePathResolver> fp_resolver,
                       FilePathResolver::Create(upid.pid));
   // TODO(yzhao): Might need to check the start time.
@@ -46,8 +81,54 @@ StatusOr<std::unique_ptr<ElfReader::Symbolizer>> CreateUPIDSymbolizer(const stru
   PL_ASSIGN_OR_RETURN(std::filesystem::path host_proc_exe, fp_resolver->ResolvePath(proc_exe));
   host_proc_exe = system::Config::GetInstance().ToHostPath(host_proc_exe);
   PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(host_proc_exe));
-  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader::Symbolizer> upid_symbolizer,
-                      elf_reader->GetSymbolizer());
+
+  UPIDSymbolizer upid_symbolizer;
+  upid_symbolizer.build_id = elf_reader->BuildID();
+  const std::string& build_id = upid_symbolizer.build_id;
+
+  // First, share the index of another process running the same binary.
+  if (!build_id.empty()) {
+    auto iter = indexes_by_build_id_.find(build_id);
+    if (iter != indexes_by_build_id_.end()) {
+      upid_symbolizer.index = iter->second.lock();
+      if (upid_symbolizer.index != nullptr) {
+        return upid_symbolizer;
+      }
+    }
+  }
+
+  // Next, look for an index written before a restart.
+  std::filesystem::path index_path;
+  if (!build_id.empty() && !FLAGS_stirling_profiler_symbol_index_dir.empty()) {
+    index_path = std::filesystem::path(FLAGS_stirling_profiler_symbol_index_dir) /
+                 absl::StrCat(build_id, ".symidx");
+    StatusOr<std::unique_ptr<SymbolIndex>> index_status = SymbolIndex::Open(index_path);
+    if (index_status.ok()) {
+      upid_symbolizer.index = index_status.ConsumeValueOrDie();
+    } else {
+      VLOG(1) << absl::Substitute("No usable symbol index for $0 [error=$1]",
+                                  host_proc_exe.string(), index_status.ToString());
+    }
+  }
+
+  // Otherwise, read the symbols from the binary.
+  if (upid_symbolizer.index == nullptr) {
+    PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader::Symbolizer> elf_symbolizer,
+                        elf_reader->GetSymbolizer());
+    upid_symbolizer.index = CreateSymbolIndex(*elf_symbolizer);
+
+    if (!index_path.empty()) {
+      std::error_code ec;
+      std::filesystem::create_directories(index_path.parent_path(), ec);
+      Status s = upid_symbolizer.index->WriteToFile(index_path);
+      LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to write symbol index for $0: $1",
+                                                   host_proc_exe.string(), s.ToString());
+    }
+  }
+
+  if (!build_id.empty()) {
+    indexes_by_build_id_[build_id] = upid_symbolizer.index;
+  }
   return upid_symbolizer;
 }
 
@@ -65,20 +146,19 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
     return profiler::SymbolizerFn(&(BogusKernelSymbolizerFn));
   }
 
-  std::unique_ptr<ElfReader::Symbolizer>& upid_symbolizer = symbolizers_[upid];
-  if (upid_symbolizer == nullptr) {
-    StatusOr<std::unique_ptr<ElfReader::Symbolizer>> upid_symbolizer_status =
-        CreateUPIDSymbolizer(upid);
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    StatusOr<UPIDSymbolizer> upid_symbolizer_status = CreateUPIDSymbolizer(upid);
     if (!upid_symbolizer_status.ok()) {
       VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
                                   upid.pid, upid_symbolizer_status.ToString());
       return profiler::SymbolizerFn(&(EmptySymbolizerFn));
     }
 
-    upid_symbolizer = upid_symbolizer_status.ConsumeValueOrDie();
+    iter = symbolizers_.emplace(upid, upid_symbolizer_status.ConsumeValueOrDie()).first;
   }
 
-  return absl::bind_front(&ElfReader::Symbolizer::Lookup, upid_symbolizer.get());
+  return absl::bind_front(&SymbolIndex::Lookup, iter->second.index.get());
 }
 
 }  // namespace stirling
@@ -19,14 +19,22 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_index.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
+DECLARE_string(stirling_profiler_symbol_index_dir);
+
 namespace px {
 namespace stirling {
 
 /**
  * A Symbolizer using the ElfReader symbolization core.
+ *
+ * The symbols of a binary are held in a SymbolIndex, which is shared by all processes that run
+ * the same binary, as identified by its build-id. If --stirling_profiler_symbol_index_dir is set,
+ * indexes are also written there, so that they are reused instead of rebuilt after a restart.
  */
 class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  public:
@@ -40,10 +48,19 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  private:
   ElfSymbolizer() = default;
 
+  struct UPIDSymbolizer {
+    // Empty if the binary has no build-id, in which case the index is not shared.
+    std::string build_id;
+    std::shared_ptr<SymbolIndex> index;
+  };
+
+  StatusOr<UPIDSymbolizer> CreateUPIDSymbolizer(const struct upid_t& upid);
+
   // A symbolizer per UPID.
-  absl::flat_hash_map<struct upid_t,
-                      std::unique_ptr<px::stirling::obj_tools::ElfReader::Symbolizer>>
-      symbolizers_;
+  absl::flat_hash_map<struct upid_t, UPIDSymbolizer> symbolizers_;
+
+  // The indexes in use, keyed by build-id.
+  absl::flat_hash_map<std::string, std::weak_ptr<SymbolIndex>> indexes_by_build_id_;
 };
 
 }  // namespace stirling
@@ -78,7 +78,33 @@ void JavaSymbolizationContext::RemoveArtifacts() const {
   }
 }
 
-void JavaSymbolizationContext::UpdateSymbolMap() {
+void JavaSymbolizationContext::ApplySymbolUpdate(const java::RawSymbolUpdate& update,
+                                                 const std::string& buffer) {
+  // We either put a new symbol into the symbol map (common case) or remove a symbol.
+  if (update.method_unload) {
+    // Handle remove symbol scenario.
+    // NB: if we go back to caching Java symbols, we will need to invalidate
+    // any cached instances of this symbol.
+    symbol_map_.erase(update.addr);
+    return;
+  }
+
+  // TODO(jps): Make the interface to the demangler consume string_view only, then
+  // convert symbol, fn_sig, and class_sig to string_view (reduces copying).
+  // TODO(jps): Remove null terminating character from java::RawSymbolUpdate.
+  symbol_.assign(buffer.data() + update.SymbolOffset(), update.symbol_size - 1);
+  fn_sig_.assign(buffer.data() + update.FnSigOffset(), update.fn_sig_size - 1);
+  class_sig_.assign(buffer.data() + update.ClassSigOffset(), update.class_sig_size - 1);
+
+  using symbolization::kJavaPrefix;
+  const auto demangled = absl::StrCat(kJavaPrefix, java::Demangle(symbol_, class_sig_, fn_sig_));
+
+  // TODO(jps): Change to uint32_t in java::RawSymbolUpdate.
+  const uint32_t code_size = static_cast<uint32_t>(update.code_size);
+  symbol_map_.try_emplace(update.addr, demangled, code_size);
+}
+
+void JavaSymbolizationContext::UpdateSymbolMapFromFile() {
   auto reset_symbol_file = [&](const auto pos) {
     symbol_file_->seekg(pos);
     symbol_file_->clear();
@@ -88,14 +114,7 @@ void JavaSymbolizationContext::UpdateSymbolMap() {
   java::RawSymbolUpdate update;
 
   std::string buffer;
-  std::string symbol;
-  std::string fn_sig;
-  std::string class_sig;
-
   buffer.reserve(300);
-  symbol.reserve(100);
-  fn_sig.reserve(100);
-  class_sig.reserve(100);
 
   while (true) {
     const auto pos = symbol_file_->tellg();
@@ -110,7 +129,7 @@ void JavaSymbolizationContext::UpdateSymbolMap() {
 
     const uint64_t n = update.TotalNumSymbolBytes();
 
-    if (buffer.capacity() < n) {
+    if (buffer.size() < n) {
       buffer.resize(n);
     }
 
@@ -123,39 +142,48 @@ void JavaSymbolizationContext::UpdateSymbolMap() {
     }
 
     // At this point, we have consumed an entire udpate from the symbol file.
-    // We either put a new symbol into the symbol map (common case) or remove a symbol.
-
-    if (update.method_unload) {
-      // Handle remove symbol scenario.
-      // NB: if we go back to caching Java symbols, we will need to invalidate
-      // any cached instances of this symbol.
-      symbol_map_.erase(update.addr);
-      continue;
-    }
+    ApplySymbolUpdate(update, buffer);
+  }
+  DCHECK(symbol_file_->good());
+}
 
-    // TODO(jps): Make the interface to the demangler consume string_view only, then
-    // convert symbol, fn_sig, and class_sig to string_view (reduces copying).
-    // TODO(jps): Remove null terminating character from java::RawSymbolUpdate.
-    symbol.assign(buffer.data() + update.SymbolOffset(), update.symbol_size - 1);
-    fn_sig.assign(buffer.data() + update.FnSigOffset(), update.fn_sig_size - 1);
-    class_sig.assign(buffer.data() + update.ClassSigOffset(), update.class_sig_size - 1);
+void JavaSymbolizationContext::UpdateSymbolMapFromRing() {
+  // Only the updates written since the last call are consumed, straight out of shared memory;
+  // nothing is re-read or re-parsed.
+  const bool ok = symbol_ring_->Consume(
+      [this](const java::RawSymbolUpdate& update, const std::string& buffer) {
+        ApplySymbolUpdate(update, buffer);
+      });
+  if (!ok) {
+    // The ring is only written by the agent, so this should not happen; stop reading from it,
+    // and keep the symbols read so far.
+    LOG(WARNING) << "Malformed Java symbol ring buffer; no longer reading Java symbol updates.";
+    symbol_ring_.reset();
+    return;
+  }
 
-    using symbolization::kJavaPrefix;
-    const auto demangled = absl::StrCat(kJavaPrefix, java::Demangle(symbol, class_sig, fn_sig));
+  const uint64_t num_dropped = symbol_ring_->num_dropped();
+  if (num_dropped > symbol_ring_num_dropped_) {
+    LOG(WARNING) << absl::Substitute("Java symbol ring buffer was full; $0 updates were dropped.",
+                                     num_dropped - symbol_ring_num_dropped_);
+    symbol_ring_num_dropped_ = num_dropped;
+  }
+}
 
-    // TODO(jps): Change to uint32_t in java::RawSymbolUpdate.
-    const uint32_t code_size = static_cast<uint32_t>(update.code_size);
-    symbol_map_.try_emplace(update.addr, demangled, code_size);
+void JavaSymbolizationContext::UpdateSymbolMap() {
+  if (symbol_file_ != nullptr) {
+    UpdateSymbolMapFromFile();
+  } else if (symbol_ring_ != nullptr) {
+    UpdateSymbolMapFromRing();
   }
-  DCHECK(symbol_file_->good());
 }
 
 JavaSymbolizationContext::JavaSymbolizationContext(const struct upid_t& target_upid,
-                                                   profiler::SymbolizerFn native_symbolizer_fn,
-                                                   std::unique_ptr<std::ifstream> symbol_file)
-    : native_symbolizer_fn_(native_symbolizer_fn), symbol_file_(std::move(symbol_file)) {
-  DCHECK(symbol_file_->good());
-  UpdateSymbolMap();
+                                                   profiler::SymbolizerFn native_symbolizer_fn)
+    : native_symbolizer_fn_(native_symbolizer_fn) {
+  symbol_.reserve(100);
+  fn_sig_.reserve(100);
+  class_sig_.reserve(100);
 
   auto status_or_host_artifacts_path = java::ResolveHostArtifactsPath(target_upid);
 
@@ -168,7 +196,28 @@ JavaSymbolizationContext::JavaSymbolizationContext(const struct upid_t& target_u
   host_artifacts_path_resolved_ = true;
 }
 
-JavaSymbolizationContext::~JavaSymbolizationContext() { symbol_file_->close(); }
+JavaSymbolizationContext::JavaSymbolizationContext(const struct upid_t& target_upid,
+                                                   profiler::SymbolizerFn native_symbolizer_fn,
+                                                   std::unique_ptr<std::ifstream> symbol_file)
+    : JavaSymbolizationContext(target_upid, native_symbolizer_fn) {
+  symbol_file_ = std::move(symbol_file);
+  DCHECK(symbol_file_->good());
+  UpdateSymbolMap();
+}
+
+JavaSymbolizationContext::JavaSymbolizationContext(
+    const struct upid_t& target_upid, profiler::SymbolizerFn native_symbolizer_fn,
+    std::unique_ptr<java::SymbolRingBuffer> symbol_ring)
+    : JavaSymbolizationContext(target_upid, native_symbolizer_fn) {
+  symbol_ring_ = std::move(symbol_ring);
+  UpdateSymbolMap();
+}
+
+JavaSymbolizationContext::~JavaSymbolizationContext() {
+  if (symbol_file_ != nullptr) {
+    symbol_file_->close();
+  }
+}
 
 std::string_view JavaSymbolizationContext::Symbolize(const uintptr_t addr) {
   if (requires_refresh_) {
@@ -255,13 +304,27 @@ std::string_view JavaSymbolizer::Symbolize(JavaSymbolizationContext* ctx, const
 }
 
 Status JavaSymbolizer::CreateNewJavaSymbolizationContext(const struct upid_t& upid) {
-  constexpr auto kIOFlags = std::ios::in | std::ios::binary;
-  const std::filesystem::path symbol_file_path = java::StirlingSymbolFilePath(upid);
-  auto symbol_file = std::make_unique<std::ifstream>(symbol_file_path, kIOFlags);
-
-  if (symbol_file->fail()) {
-    char const* const fmt = "Java attacher [pid=$0]: Could not open symbol file: $1.";
-    return error::Internal(fmt, upid.pid, symbol_file_path.string());
+  // The agent writes to its shared memory ring buffer, unless it could not create one,
+  // in which case it falls back to the symbol file.
+  const std::filesystem::path symbol_ring_path = java::StirlingSymbolRingPath(upid);
+  std::unique_ptr<java::SymbolRingBuffer> symbol_ring;
+  std::unique_ptr<std::ifstream> symbol_file;
+
+  if (fs::Exists(symbol_ring_path)) {
+    symbol_ring.reset(java::SymbolRingBuffer::Open(symbol_ring_path.c_str()));
+    if (symbol_ring == nullptr) {
+      char const* const fmt = "Java attacher [pid=$0]: Could not map symbol ring buffer: $1.";
+      return error::Internal(fmt, upid.pid, symbol_ring_path.string());
+    }
+  } else {
+    constexpr auto kIOFlags = std::ios::in | std::ios::binary;
+    const std::filesystem::path symbol_file_path = java::StirlingSymbolFilePath(upid);
+    symbol_file = std::make_unique<std::ifstream>(symbol_file_path, kIOFlags);
+
+    if (symbol_file->fail()) {
+      char const* const fmt = "Java attacher [pid=$0]: Could not open symbol file: $1.";
+      return error::Internal(fmt, upid.pid, symbol_file_path.string());
+    }
   }
 
   DCHECK(symbolization_contexts_.find(upid) == symbolization_contexts_.end());
@@ -270,8 +333,13 @@ Status JavaSymbolizer::CreateNewJavaSymbolizationContext(const struct upid_t& up
   DCHECK(inserted);
   if (inserted) {
     auto native_symbolizer_fn = native_symbolizer_->GetSymbolizerFn(upid);
-    iter->second = std::make_unique<JavaSymbolizationContext>(upid, native_symbolizer_fn,
-                                                              std::move(symbol_file));
+    if (symbol_ring != nullptr) {
+      iter->second = std::make_unique<JavaSymbolizationContext>(upid, native_symbolizer_fn,
+                                                                std::move(symbol_ring));
+    } else {
+      iter->second = std::make_unique<JavaSymbolizationContext>(upid, native_symbolizer_fn,
+                                                                std::move(symbol_file));
+    }
   }
   auto& ctx = iter->second;
 
@@ -390,8 +458,9 @@ profiler::SymbolizerFn JavaSymbolizer::GetSymbolizerFn(const struct upid_t& upid
   g_java_proc_counter.Increment();
 
   const std::filesystem::path symbol_file_path = java::StirlingSymbolFilePath(upid);
+  const std::filesystem::path symbol_ring_path = java::StirlingSymbolRingPath(upid);
 
-  if (fs::Exists(symbol_file_path)) {
+  if (fs::Exists(symbol_ring_path) || fs::Exists(symbol_file_path)) {
     LOG(INFO) << absl::Substitute("Found a pre-existing symbol file for pid: $0", upid.pid);
     // Found a pre-existing symbol file. Attempt to use it.
     const Status new_ctx_status = CreateNewJavaSymbolizationContext(upid);
@@ -22,6 +22,8 @@
 #include <string>
 #include <vector>
 
+#include "src/stirling/source_connectors/perf_profiler/java/agent/raw_symbol_update.h"
+#include "src/stirling/source_connectors/perf_profiler/java/agent/symbol_ring_buffer.h"
 #include "src/stirling/source_connectors/perf_profiler/java/attach.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 #include "src/stirling/utils/monitor.h"
@@ -47,6 +49,11 @@ class JavaSymbolizationContext {
   JavaSymbolizationContext(const struct upid_t& target_upid,
                            profiler::SymbolizerFn native_symbolizer_fn,
                            std::unique_ptr<std::ifstream> symbol_file);
+
+  // Consumes symbol updates from the agent's shared memory ring buffer, instead of its file.
+  JavaSymbolizationContext(const struct upid_t& target_upid,
+                           profiler::SymbolizerFn native_symbolizer_fn,
+                           std::unique_ptr<java::SymbolRingBuffer> symbol_ring);
   ~JavaSymbolizationContext();
 
   std::string_view Symbolize(const uintptr_t addr);
@@ -56,12 +63,28 @@ class JavaSymbolizationContext {
   void set_requires_refresh() { requires_refresh_ = true; }
 
  private:
+  JavaSymbolizationContext(const struct upid_t& target_upid,
+                           profiler::SymbolizerFn native_symbolizer_fn);
+
+  // Applies the symbol updates written by the agent since the last call.
   void UpdateSymbolMap();
+  void UpdateSymbolMapFromFile();
+  void UpdateSymbolMapFromRing();
+  void ApplySymbolUpdate(const java::RawSymbolUpdate& update, const std::string& buffer);
 
   bool requires_refresh_ = false;
   SymbolMapType symbol_map_;
   profiler::SymbolizerFn native_symbolizer_fn_;
+
+  // Exactly one of these is set.
   std::unique_ptr<std::ifstream> symbol_file_;
+  std::unique_ptr<java::SymbolRingBuffer> symbol_ring_;
+  uint64_t symbol_ring_num_dropped_ = 0;
+
+  // Reused across symbol updates, to avoid reallocating them.
+  std::string symbol_;
+  std::string fn_sig_;
+  std::string class_sig_;
   bool host_artifacts_path_resolved_ = false;
   std::filesystem::path host_artifacts_path_;
 };
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/source_connectors/perf_profiler/perf_profile_connector.h"
+
+namespace px {
+namespace stirling {
+// Note that this has to be in the same namespace as `PerfProfileConnector` for the friend class
+// to work. Hence why its not in the testing namespace.
+
+// A wrapper around PerfProfileConnector that takes stack traces directly, instead of reading them
+// out of the BPF maps. Useful for measuring the cost of the profiler in user space, without BPF.
+class PerfProfileConnectorFriend : public PerfProfileConnector {
+ public:
+  static std::unique_ptr<PerfProfileConnectorFriend> Create(std::string_view name) {
+    return std::unique_ptr<PerfProfileConnectorFriend>(new PerfProfileConnectorFriend(name));
+  }
+  explicit PerfProfileConnectorFriend(std::string_view name) : PerfProfileConnector(name) {}
+
+  // Normally called by InitImpl(), which also deploys the BPF probes.
+  Status InitSymbolizers() { return PerfProfileConnector::InitSymbolizers(); }
+
+  // Adds the stack traces to the pending batch, as if they were read out of the BPF maps, with
+  // one sample each. The stack-ids of the keys index into stacks.
+  void AcceptStackTraces(ConnectorContext* ctx, const std::vector<stack_trace_key_t>& keys,
+                         const absl::flat_hash_map<int, std::vector<uintptr_t>>& stacks) {
+    std::vector<std::pair<stack_trace_key_t, uint64_t>> weighted_keys;
+    weighted_keys.reserve(keys.size());
+    for (const auto& key : keys) {
+      weighted_keys.emplace_back(key, 1);
+    }
+    auto read_stack_fn = [&stacks](int stack_id) { return stacks.at(stack_id); };
+    auto clear_stack_fn = [](int /*stack_id*/) {};
+    ReadStackTraces(ctx, read_stack_fn, clear_stack_fn, weighted_keys, &pending_batch_.on_cpu);
+  }
+
+  // Does the work of TransferDataImpl() that follows reading the BPF maps. With
+  // --stirling_profiler_async_symbolization=false, the records are appended before it returns.
+  void PushStackTraces(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables) {
+    // Normally advanced by SourceConnector::TransferData().
+    sampling_freq_mgr_.Reset();
+    PerfProfileConnector::PushStackTraces(ctx, data_tables);
+  }
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -51,7 +51,7 @@ void PIDRuntimeConnector::TransferDataImpl(ConnectorContext* /* ctx */,
   }
 
   std::vector<std::pair<uint16_t, pidruntime_val_t>> items =
-      GetHashTable<uint16_t, pidruntime_val_t>("pid_cpu_time").get_table_offline();
+      GetHashTableEntries<uint16_t, pidruntime_val_t>("pid_cpu_time");
 
   for (auto& item : items) {
     // TODO(kgandhi): PL-460 Consider using other types of BPF tables to avoid a searching through
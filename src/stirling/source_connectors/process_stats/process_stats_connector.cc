@@ -42,34 +42,36 @@ Status ProcessStatsConnector::StopImpl() { return Status::OK(); }
 
 void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
                                                       DataTable* data_table) {
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const md::UPIDMap<md::PIDInfoSPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  upids_.clear();
+  pids_.clear();
   for (const auto& [upid, pid_info] : pid_info_by_upid) {
     // TODO(zasgar): Fix condition for dead pids after helper function is added.
     if (pid_info == nullptr || pid_info->stop_time_ns() > 0) {
       // PID has been stopped.
       continue;
     }
+    upids_.push_back(upid);
+    pids_.push_back(upid.pid());
+  }
 
-    ProcParser::ProcessStats stats;
-    int32_t pid = upid.pid();
-    // TODO(zasgar): We should double check the process start time to make sure it still the same
-    // PID.
-    auto s1 =
-        proc_parser_->ParseProcPIDStat(pid, system::Config::GetInstance().PageSizeBytes(),
-                                       system::Config::GetInstance().KernelTickTimeNS(), &stats);
-    if (!s1.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
-      continue;
-    }
-
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
-    if (!s2.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
+  // TODO(zasgar): We should double check the process start time to make sure it still the same
+  // PID.
+  // Note that netlink taskstats can't replace these reads: a TGID query only sums the delay
+  // accounting and context switches of the live threads (CPU, fault and IO counters cover the
+  // exited threads only), and no query reports the RSS, virtual size or thread count.
+  proc_parser_->ParseProcPIDStats(pids_, system::Config::GetInstance().PageSizeBytes(),
+                                  system::Config::GetInstance().KernelTickTimeNS(), &pid_stats_);
+
+  for (size_t i = 0; i < upids_.size(); ++i) {
+    const md::UPID& upid = upids_[i];
+    const auto& [pid, status, stats] = pid_stats_[i];
+    if (!status.ok()) {
+      VLOG(1) << absl::Substitute("Failed to fetch stat info for PID ($0). Error=\"$1\" skipping.",
+                                  pid, status.msg());
       continue;
     }
 
@@ -65,6 +65,11 @@ class ProcessStatsConnector : public SourceConnector {
   void TransferProcessStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
   std::unique_ptr<system::ProcParser> proc_parser_;
+
+  // Reused across iterations, so that the batch of processes parsed doesn't allocate.
+  std::vector<md::UPID> upids_;
+  std::vector<int32_t> pids_;
+  std::vector<system::ProcParser::PIDStats> pid_stats_;
 };
 
 }  // namespace stirling
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/replay/replay_connector.h"
+
+#include <limits>
+#include <utility>
+
+DEFINE_string(stirling_replay_capture_file,
+              gflags::StringFromEnv("PL_STIRLING_REPLAY_CAPTURE_FILE", ""),
+              "The capture replayed by the replay source, as written by stirling_wrapper's "
+              "--capture_file.");
+DEFINE_double(stirling_replay_speed, 1.0,
+              "How much faster than real time the replay source replays its capture. "
+              "Values below 1 slow it down.");
+
+namespace px {
+namespace stirling {
+
+using ::px::types::BoolValue;
+using ::px::types::ColumnWrapperRecordBatch;
+using ::px::types::DataType;
+using ::px::types::Float64Value;
+using ::px::types::Int64Value;
+using ::px::types::StringValue;
+using ::px::types::Time64NSValue;
+using ::px::types::UInt128Value;
+
+namespace {
+
+std::unique_ptr<DynamicDataTableSchema> ToDynamicDataTableSchema(
+    const stirlingpb::TableSchema& schema) {
+  BackedDataElements elements(schema.elements_size());
+  for (const auto& element : schema.elements()) {
+    elements.emplace_back(element.name(), element.desc(), element.type(), element.stype(),
+                          element.ptype());
+  }
+  return DynamicDataTableSchema::Create(schema.name(), schema.desc(), std::move(elements));
+}
+
+}  // namespace
+
+std::unique_ptr<SourceConnector> ReplayConnector::Create(std::string_view name) {
+  auto tables = std::make_unique<ReplayTables>();
+
+  auto schemas_or = ReadCaptureSchemas(FLAGS_stirling_replay_capture_file);
+  if (schemas_or.ok()) {
+    tables->schema_protos = schemas_or.ConsumeValueOrDie();
+    for (const auto& schema : tables->schema_protos) {
+      tables->dynamic_schemas.push_back(ToDynamicDataTableSchema(schema));
+      tables->schemas.push_back(tables->dynamic_schemas.back()->Get());
+    }
+  } else {
+    tables->status = schemas_or.status();
+  }
+
+  return std::unique_ptr<SourceConnector>(new ReplayConnector(name, std::move(tables)));
+}
+
+ReplayConnector::ReplayConnector(std::string_view name, std::unique_ptr<ReplayTables> tables)
+    : SourceConnector(name, ToArrayView(tables->schemas)), tables_(std::move(tables)) {
+  for (size_t i = 0; i < tables_->schema_protos.size(); ++i) {
+    table_nums_[tables_->schema_protos[i].name()] = i;
+  }
+}
+
+Status ReplayConnector::InitImpl() {
+  sampling_freq_mgr_.set_period(kSamplingPeriod);
+  push_freq_mgr_.set_period(kPushPeriod);
+
+  PL_RETURN_IF_ERROR(tables_->status);
+  if (FLAGS_stirling_replay_speed <= 0) {
+    return error::InvalidArgument("--stirling_replay_speed must be positive, got $0.",
+                                  FLAGS_stirling_replay_speed);
+  }
+  PL_ASSIGN_OR_RETURN(reader_, RecordCaptureReader::Create(FLAGS_stirling_replay_capture_file));
+  return Status::OK();
+}
+
+void ReplayConnector::TransferDataImpl(ConnectorContext* /* ctx */,
+                                       const std::vector<DataTable*>& data_tables) {
+  const int64_t now_ns = CurrentTimeNS();
+  if (replay_start_ns_ == 0) {
+    replay_start_ns_ = now_ns;
+  }
+
+  while (!done_) {
+    if (!has_next_batch_) {
+      auto has_batch_or = reader_->Next(&next_batch_);
+      if (!has_batch_or.ok() || !has_batch_or.ValueOrDie()) {
+        LOG_IF(ERROR, !has_batch_or.ok()) << has_batch_or.msg();
+        LOG(INFO) << absl::Substitute("Replayed $0 batches of $1.", num_batches_replayed_,
+                                      FLAGS_stirling_replay_capture_file);
+        done_ = true;
+        break;
+      }
+      has_next_batch_ = true;
+      if (num_batches_replayed_ == 0) {
+        capture_start_ns_ = next_batch_.push_time_ns();
+      }
+    }
+
+    const int64_t due_ns =
+        replay_start_ns_ + static_cast<int64_t>((next_batch_.push_time_ns() - capture_start_ns_) /
+                                                FLAGS_stirling_replay_speed);
+    if (due_ns > now_ns) {
+      break;
+    }
+
+    ReplayBatch(next_batch_, now_ns, data_tables);
+    has_next_batch_ = false;
+    ++num_batches_replayed_;
+  }
+}
+
+void ReplayConnector::ReplayBatch(const stirlingpb::CapturedRecordBatch& captured,
+                                  int64_t now_ns, const std::vector<DataTable*>& data_tables) {
+  auto iter = table_nums_.find(captured.table_name());
+  if (iter == table_nums_.end()) {
+    LOG_FIRST_N(WARNING, 10) << absl::Substitute(
+        "Batch of table $0 precedes the table's schema in the capture.", captured.table_name());
+    return;
+  }
+  DataTable* data_table = data_tables[iter->second];
+  if (data_table == nullptr) {
+    // The table is not subscribed to.
+    return;
+  }
+  const stirlingpb::TableSchema& schema = tables_->schema_protos[iter->second];
+
+  auto record_batch_or = FromCapturedRecordBatch(schema, captured);
+  if (!record_batch_or.ok()) {
+    LOG_FIRST_N(WARNING, 10) << record_batch_or.msg();
+    return;
+  }
+  const ColumnWrapperRecordBatch& record_batch = record_batch_or.ValueOrDie();
+
+  // Shift the timestamps, so that the records look as recent as they were when captured.
+  const int64_t time_offset_ns = now_ns - captured.push_time_ns();
+  std::optional<int> time_col;
+  for (int j = 0; j < schema.elements_size(); ++j) {
+    if (schema.elements(j).name() == "time_") {
+      time_col = j;
+    }
+  }
+
+  for (size_t i = 0; i < captured.num_rows(); ++i) {
+    uint64_t time = 0;
+    if (time_col.has_value()) {
+      time = record_batch[*time_col]->Get<Time64NSValue>(i).val + time_offset_ns;
+    }
+    DataTable::DynamicRecordBuilder r(data_table, time);
+    for (int j = 0; j < schema.elements_size(); ++j) {
+      const auto& col = record_batch[j];
+      switch (schema.elements(j).type()) {
+        case DataType::BOOLEAN:
+          r.Append(j, col->Get<BoolValue>(i));
+          break;
+        case DataType::INT64:
+          r.Append(j, col->Get<Int64Value>(i));
+          break;
+        case DataType::TIME64NS:
+          r.Append(j, Time64NSValue(col->Get<Time64NSValue>(i).val + time_offset_ns));
+          break;
+        case DataType::FLOAT64:
+          r.Append(j, col->Get<Float64Value>(i));
+          break;
+        case DataType::UINT128:
+          r.Append(j, col->Get<UInt128Value>(i));
+          break;
+        case DataType::STRING:
+          // The strings were already truncated when they were captured.
+          r.Append(j, col->Get<StringValue>(i), std::numeric_limits<size_t>::max());
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/record_capture.h"
+#include "src/stirling/core/source_connector.h"
+
+DECLARE_string(stirling_replay_capture_file);
+DECLARE_double(stirling_replay_speed);
+
+namespace px {
+namespace stirling {
+
+/**
+ * Feeds the tables of a capture written by RecordCaptureWriter back into Stirling, at the pace
+ * they were captured, scaled by --stirling_replay_speed. This allows benchmarking scripts and the
+ * table store against real data without running the original sources.
+ *
+ * The tables keep their captured names, so this connector should run on its own,
+ * i.e. with --stirling_sources=replay. The timestamp columns are shifted to the replay time.
+ */
+class ReplayConnector : public SourceConnector {
+ public:
+  static constexpr std::string_view kName = "replay";
+  static constexpr auto kSamplingPeriod = std::chrono::milliseconds{100};
+  static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
+
+  // The tables are those of the capture, so they are only known once it is read by Create().
+  static constexpr ArrayView<DataTableSchema> kTables = {};
+
+  static std::unique_ptr<SourceConnector> Create(std::string_view name);
+
+  ReplayConnector() = delete;
+  ~ReplayConnector() override = default;
+
+ protected:
+  // The schemas of the captured tables, which must outlive the SourceConnector base.
+  struct ReplayTables {
+    std::vector<stirlingpb::TableSchema> schema_protos;
+    std::vector<std::unique_ptr<DynamicDataTableSchema>> dynamic_schemas;
+    std::vector<DataTableSchema> schemas;
+    // Set if the capture could not be read; reported by Init().
+    Status status;
+  };
+
+  ReplayConnector(std::string_view name, std::unique_ptr<ReplayTables> tables);
+
+  Status InitImpl() override;
+  void TransferDataImpl(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables) override;
+  Status StopImpl() override { return Status::OK(); }
+
+ private:
+  void ReplayBatch(const stirlingpb::CapturedRecordBatch& captured, int64_t now_ns,
+                   const std::vector<DataTable*>& data_tables);
+
+  std::unique_ptr<ReplayTables> tables_;
+  absl::flat_hash_map<std::string, uint32_t> table_nums_;
+
+  std::unique_ptr<RecordCaptureReader> reader_;
+  bool done_ = false;
+
+  // The next batch to replay, once it is due.
+  stirlingpb::CapturedRecordBatch next_batch_;
+  bool has_next_batch_ = false;
+
+  // The replay maps the push time of the first captured batch to the time the replay started.
+  int64_t capture_start_ns_ = 0;
+  int64_t replay_start_ns_ = 0;
+  int num_batches_replayed_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
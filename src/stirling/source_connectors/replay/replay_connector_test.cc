@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/replay/replay_connector.h"
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/testing/common.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::stirling::testing::AccessRecordBatch;
+using ::px::stirling::testing::RecordBatchSizeIs;
+using ::px::types::ColumnWrapper;
+using ::px::types::ColumnWrapperRecordBatch;
+using ::px::types::DataType;
+
+// clang-format off
+constexpr DataElement kElements[] = {
+    {"time_", "", DataType::TIME64NS,
+     types::SemanticType::ST_NONE, types::PatternType::METRIC_COUNTER},
+    {"value", "", DataType::INT64,
+     types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+// clang-format on
+
+constexpr auto kReplayTable = DataTableSchema("replayed", "A table for testing", kElements);
+
+ColumnWrapperRecordBatch MakeRecordBatch(int64_t time, int64_t value) {
+  ColumnWrapperRecordBatch record_batch;
+  record_batch.push_back(ColumnWrapper::Make(DataType::TIME64NS, 0));
+  record_batch.push_back(ColumnWrapper::Make(DataType::INT64, 0));
+  record_batch[0]->Append<types::Time64NSValue>(time);
+  record_batch[1]->Append<types::Int64Value>(value);
+  return record_batch;
+}
+
+TEST(ReplayConnectorTest, ReplaysCaptureAtCapturedPace) {
+  constexpr int64_t kPushTimeNS = 1'000'000'000;
+  constexpr int64_t kHourNS = 3600'000'000'000;
+
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "capture.bin";
+  {
+    ASSERT_OK_AND_ASSIGN(auto writer, RecordCaptureWriter::Create(path));
+    ASSERT_OK(writer->Write(kReplayTable.ToProto(), kPushTimeNS,
+                            MakeRecordBatch(kPushTimeNS - 100, 1)));
+    ASSERT_OK(writer->Write(kReplayTable.ToProto(), kPushTimeNS + kHourNS,
+                            MakeRecordBatch(kPushTimeNS + kHourNS - 100, 2)));
+  }
+
+  FLAGS_stirling_replay_capture_file = path.string();
+  std::unique_ptr<SourceConnector> connector = ReplayConnector::Create("replay");
+  ASSERT_EQ(connector->table_schemas().size(), 1);
+  EXPECT_EQ(connector->table_schemas()[0].name(), "replayed");
+  ASSERT_OK(connector->Init());
+
+  DataTable data_table(/*id*/ 0, connector->table_schemas()[0]);
+  auto ctx = std::make_unique<StandaloneContext>(md::UPIDSet{});
+  const int64_t start_ns = CurrentTimeNS();
+  connector->TransferData(ctx.get(), {&data_table});
+
+  // Only the first batch is due; the second was pushed an hour later.
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(const ColumnWrapperRecordBatch& records, tablets);
+  ASSERT_THAT(records, RecordBatchSizeIs(1));
+  EXPECT_EQ(AccessRecordBatch<types::Int64Value>(records, 1, 0), 1);
+  // The timestamps are shifted to the replay time.
+  EXPECT_GE(AccessRecordBatch<types::Time64NSValue>(records, 0, 0), start_ns - 100);
+
+  EXPECT_OK(connector->Stop());
+}
+
+TEST(ReplayConnectorTest, MissingCaptureFailsInit) {
+  FLAGS_stirling_replay_capture_file = "/does/not/exist";
+  std::unique_ptr<SourceConnector> connector = ReplayConnector::Create("replay");
+  EXPECT_EQ(connector->table_schemas().size(), 0);
+  EXPECT_NOT_OK(connector->Init());
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Measures how fast the agent ingests data, by running the load_gen source through the same path
+// as the PEM: Stirling pushes to TableStore::AppendData(), and the table store is compacted
+// periodically. The load is described by the --stirling_load_gen flags, so that PEM ingest
+// capacity can be sized on any machine by raising the rate until the achieved rate falls behind:
+//
+//   ingest_benchmark --stirling_load_gen_rows_per_s=500000 --stirling_load_gen_string_bytes=256
+
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/base/base.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/shared/schema/utils.h"
+#include "src/stirling/source_connectors/seq_gen/load_gen_connector.h"
+#include "src/stirling/stirling.h"
+#include "src/table_store/table_store.h"
+
+DEFINE_int32(duration_s, 60, "How long to run the load for.");
+DEFINE_int32(report_period_s, 10, "How often to report the ingest rate.");
+DEFINE_int32(compaction_period_s, 60,
+             "How often to compact the table store, which the agent does every minute.");
+DEFINE_int32(table_size_mb, 1024, "The maximum size of the load_gen table in the table store.");
+
+using ::px::MemoryStats;
+using ::px::MemoryTracker;
+using ::px::stirling::LoadGenConnector;
+using ::px::stirling::SourceRegistry;
+using ::px::stirling::Stirling;
+using ::px::table_store::Table;
+using ::px::table_store::TableStats;
+using ::px::table_store::TableStore;
+
+namespace {
+
+constexpr double kMiB = 1024.0 * 1024.0;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  auto registry = std::make_unique<SourceRegistry>();
+  registry->RegisterOrDie<LoadGenConnector>();
+  std::unique_ptr<Stirling> stirling = Stirling::Create(std::move(registry));
+
+  px::stirling::stirlingpb::Publish publish_pb;
+  stirling->GetPublishProto(&publish_pb);
+  TableStore table_store;
+  std::shared_ptr<Table> load_gen_table;
+  for (const auto& relation_info : px::ConvertPublishPBToRelationInfo(publish_pb)) {
+    auto table = std::make_shared<Table>(relation_info.name, relation_info.relation,
+                                         int64_t{FLAGS_table_size_mb} * 1024 * 1024);
+    if (relation_info.name == LoadGenConnector::kTableName) {
+      load_gen_table = table;
+    }
+    table_store.AddTable(std::move(table), relation_info.name, relation_info.id);
+  }
+  CHECK(load_gen_table != nullptr);
+
+  std::atomic<int64_t> num_rows_ingested = 0;
+  stirling->RegisterDataPushCallback(
+      [&](uint32_t table_id, px::types::TabletID tablet_id,
+          std::unique_ptr<px::types::ColumnWrapperRecordBatch> record_batch) {
+        int64_t num_rows = record_batch->empty() ? 0 : (*record_batch)[0]->Size();
+        PL_RETURN_IF_ERROR(table_store.AppendData(table_id, tablet_id, std::move(record_batch)));
+        num_rows_ingested += num_rows;
+        return px::Status::OK();
+      });
+
+  MemoryTracker mem_tracker(/*enable*/ true);
+  mem_tracker.Start();
+  PL_CHECK_OK(stirling->RunAsThread());
+  PL_CHECK_OK(stirling->WaitUntilRunning(/* timeout */ std::chrono::seconds(5)));
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto end = start + std::chrono::seconds(FLAGS_duration_s);
+  auto last_report = start;
+  auto last_compaction = start;
+  int64_t last_num_rows = 0;
+  int64_t last_bytes_added = 0;
+  std::chrono::duration<double> compaction_time{0};
+
+  while (std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::seconds(FLAGS_report_period_s));
+    auto now = std::chrono::steady_clock::now();
+
+    if (now - last_compaction >= std::chrono::seconds(FLAGS_compaction_period_s)) {
+      PL_CHECK_OK(table_store.RunCompaction());
+      compaction_time += std::chrono::steady_clock::now() - now;
+      last_compaction = now;
+    }
+
+    const double period_s = std::chrono::duration<double>(now - last_report).count();
+    const int64_t num_rows = num_rows_ingested;
+    const TableStats stats = load_gen_table->GetTableStats();
+    LOG(INFO) << absl::Substitute(
+        "t=$0s rows/s=$1 MiB/s=$2 table_MiB=$3 (hot=$4 cold=$5)",
+        static_cast<int>(std::chrono::duration<double>(now - start).count()),
+        static_cast<int64_t>((num_rows - last_num_rows) / period_s),
+        (stats.bytes_added - last_bytes_added) / kMiB / period_s, stats.bytes / kMiB,
+        stats.hot_bytes / kMiB, stats.cold_bytes / kMiB);
+    last_report = now;
+    last_num_rows = num_rows;
+    last_bytes_added = stats.bytes_added;
+  }
+
+  stirling->Stop();
+  const MemoryStats mem_stats = mem_tracker.End();
+
+  const double elapsed_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const TableStats stats = load_gen_table->GetTableStats();
+  const double achieved_rate = num_rows_ingested / elapsed_s;
+  LOG(INFO) << absl::Substitute(
+      "Ingested $0 rows in $1s: $2 rows/s of the $3 rows/s generated ($4%), $5 MiB/s. "
+      "Compaction took $6s. Peak allocated: $7 MiB, peak physical: $8 MiB.",
+      num_rows_ingested.load(), elapsed_s, static_cast<int64_t>(achieved_rate),
+      FLAGS_stirling_load_gen_rows_per_s,
+      static_cast<int>(100 * achieved_rate / FLAGS_stirling_load_gen_rows_per_s),
+      stats.bytes_added / kMiB / elapsed_s, compaction_time.count(),
+      (mem_stats.max.allocated - mem_stats.start.allocated) / kMiB,
+      (mem_stats.max.physical - mem_stats.start.physical) / kMiB);
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/seq_gen/load_gen_connector.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+
+DEFINE_int32(stirling_load_gen_rows_per_s, 100000,
+             "The number of rows per second that the load_gen source generates.");
+DEFINE_int32(stirling_load_gen_int_columns, 4,
+             "The number of INT64 columns of the load_gen table, besides time_.");
+DEFINE_int32(stirling_load_gen_string_columns, 2,
+             "The number of STRING columns of the load_gen table.");
+DEFINE_int32(stirling_load_gen_string_bytes, 64,
+             "The size of each value of the STRING columns of the load_gen table.");
+DEFINE_int32(stirling_load_gen_string_cardinality, 1000,
+             "The number of distinct values each STRING column of the load_gen table cycles "
+             "through.");
+
+namespace px {
+namespace stirling {
+
+using ::px::types::DataType;
+using ::px::types::Int64Value;
+using ::px::types::StringValue;
+using ::px::types::Time64NSValue;
+
+std::unique_ptr<SourceConnector> LoadGenConnector::Create(std::string_view name) {
+  const int num_int_columns = std::max(FLAGS_stirling_load_gen_int_columns, 0);
+  const int num_string_columns = std::max(FLAGS_stirling_load_gen_string_columns, 0);
+
+  BackedDataElements elements(1 + num_int_columns + num_string_columns);
+  elements.emplace_back("time_", "Timestamp when the data record was generated.",
+                        DataType::TIME64NS, types::SemanticType::ST_NONE,
+                        types::PatternType::METRIC_COUNTER);
+  for (int i = 0; i < num_int_columns; ++i) {
+    elements.emplace_back(absl::StrCat("i", i), absl::StrCat("The row number times ", i + 1, "."),
+                          DataType::INT64, types::SemanticType::ST_NONE,
+                          types::PatternType::GENERAL);
+  }
+  for (int i = 0; i < num_string_columns; ++i) {
+    elements.emplace_back(absl::StrCat("s", i), "One of a fixed set of padded strings.",
+                          DataType::STRING, types::SemanticType::ST_NONE,
+                          types::PatternType::GENERAL);
+  }
+
+  auto table = std::make_unique<LoadGenTable>();
+  table->dynamic_schema = DynamicDataTableSchema::Create(
+      kTableName, "A table of generated rows, for load testing.", std::move(elements));
+  table->schemas.push_back(table->dynamic_schema->Get());
+  return std::unique_ptr<SourceConnector>(new LoadGenConnector(name, std::move(table)));
+}
+
+LoadGenConnector::LoadGenConnector(std::string_view name, std::unique_ptr<LoadGenTable> table)
+    : SourceConnector(name, ToArrayView(table->schemas)), table_(std::move(table)) {}
+
+Status LoadGenConnector::InitImpl() {
+  sampling_freq_mgr_.set_period(kSamplingPeriod);
+  push_freq_mgr_.set_period(kPushPeriod);
+
+  if (FLAGS_stirling_load_gen_rows_per_s <= 0) {
+    return error::InvalidArgument("--stirling_load_gen_rows_per_s must be positive, got $0.",
+                                  FLAGS_stirling_load_gen_rows_per_s);
+  }
+  if (FLAGS_stirling_load_gen_string_bytes <= 0 ||
+      FLAGS_stirling_load_gen_string_cardinality <= 0) {
+    return error::InvalidArgument(
+        "--stirling_load_gen_string_bytes and --stirling_load_gen_string_cardinality must be "
+        "positive.");
+  }
+
+  // The strings are the value index padded to the width, so they stay distinct unless the width
+  // is too small to hold the index.
+  string_values_.reserve(FLAGS_stirling_load_gen_string_cardinality);
+  for (int i = 0; i < FLAGS_stirling_load_gen_string_cardinality; ++i) {
+    std::string value = absl::StrCat(i);
+    value.resize(FLAGS_stirling_load_gen_string_bytes, '.');
+    string_values_.push_back(std::move(value));
+  }
+  return Status::OK();
+}
+
+void LoadGenConnector::TransferDataImpl(ConnectorContext* /* ctx */,
+                                        const std::vector<DataTable*>& data_tables) {
+  DCHECK_EQ(data_tables.size(), 1U);
+  DataTable* data_table = data_tables[0];
+  if (data_table == nullptr) {
+    return;
+  }
+
+  const int64_t now_ns = CurrentTimeNS();
+  if (start_ns_ == 0) {
+    start_ns_ = now_ns;
+    last_transfer_ns_ = now_ns;
+    return;
+  }
+
+  const int64_t num_rows_due = static_cast<int64_t>(
+      static_cast<double>(now_ns - start_ns_) * FLAGS_stirling_load_gen_rows_per_s / 1e9);
+  const int64_t num_rows = num_rows_due - num_rows_generated_;
+  const size_t num_columns = table_->schemas[0].elements().size();
+  const size_t first_string_col = 1 + std::max(FLAGS_stirling_load_gen_int_columns, 0);
+
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t row = num_rows_generated_ + i;
+    // Spread the rows over the time since the last transfer, as a real source would see them.
+    const int64_t time_ns = last_transfer_ns_ + (now_ns - last_transfer_ns_) * (i + 1) / num_rows;
+
+    DataTable::DynamicRecordBuilder r(data_table, time_ns);
+    r.Append(0, Time64NSValue(time_ns));
+    for (size_t col = 1; col < first_string_col; ++col) {
+      r.Append(col, Int64Value(row * static_cast<int64_t>(col)));
+    }
+    const std::string& str = string_values_[row % string_values_.size()];
+    for (size_t col = first_string_col; col < num_columns; ++col) {
+      r.Append(col, StringValue(str), str.size());
+    }
+  }
+
+  num_rows_generated_ += std::max<int64_t>(num_rows, 0);
+  last_transfer_ns_ = now_ns;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/source_connector.h"
+
+DECLARE_int32(stirling_load_gen_rows_per_s);
+DECLARE_int32(stirling_load_gen_int_columns);
+DECLARE_int32(stirling_load_gen_string_columns);
+DECLARE_int32(stirling_load_gen_string_bytes);
+DECLARE_int32(stirling_load_gen_string_cardinality);
+
+namespace px {
+namespace stirling {
+
+/**
+ * Generates a deterministic load_gen table at a fixed number of rows per second, for sizing
+ * how much the agent can ingest independently of the traffic and hardware at hand. The shape of
+ * the rows is set by the --stirling_load_gen flags: the number of INT64 and STRING columns, the
+ * width of the strings and how many distinct strings each column cycles through.
+ *
+ * Not part of any source group, so it only runs when named, i.e. --stirling_sources=load_gen.
+ */
+class LoadGenConnector : public SourceConnector {
+ public:
+  static constexpr std::string_view kName = "load_gen";
+  static constexpr auto kSamplingPeriod = std::chrono::milliseconds{100};
+  static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
+  static constexpr std::string_view kTableName = "load_gen";
+
+  // The columns are set by the flags, so the table is only known once Create() reads them.
+  static constexpr ArrayView<DataTableSchema> kTables = {};
+
+  static std::unique_ptr<SourceConnector> Create(std::string_view name);
+
+  LoadGenConnector() = delete;
+  ~LoadGenConnector() override = default;
+
+  int64_t num_rows_generated() const { return num_rows_generated_; }
+
+ protected:
+  // The schema of the table, which must outlive the SourceConnector base.
+  struct LoadGenTable {
+    std::unique_ptr<DynamicDataTableSchema> dynamic_schema;
+    std::vector<DataTableSchema> schemas;
+  };
+
+  LoadGenConnector(std::string_view name, std::unique_ptr<LoadGenTable> table);
+
+  Status InitImpl() override;
+  void TransferDataImpl(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables) override;
+  Status StopImpl() override { return Status::OK(); }
+
+ private:
+  std::unique_ptr<LoadGenTable> table_;
+
+  // The distinct values of the STRING columns, which row i takes value i % size() of.
+  std::vector<std::string> string_values_;
+
+  // The rows due at any time are those for the time since the first transfer, so that the rate
+  // holds regardless of how regularly TransferData() is called.
+  int64_t start_ns_ = 0;
+  int64_t last_transfer_ns_ = 0;
+  int64_t num_rows_generated_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/seq_gen/load_gen_connector.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/testing/common.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::stirling::testing::AccessRecordBatch;
+using ::px::types::ColumnWrapperRecordBatch;
+
+TEST(LoadGenConnectorTest, GeneratesConfiguredRowsAtRate) {
+  FLAGS_stirling_load_gen_rows_per_s = 1000;
+  FLAGS_stirling_load_gen_int_columns = 1;
+  FLAGS_stirling_load_gen_string_columns = 2;
+  FLAGS_stirling_load_gen_string_bytes = 4;
+  FLAGS_stirling_load_gen_string_cardinality = 3;
+
+  std::unique_ptr<SourceConnector> connector = LoadGenConnector::Create("load_gen");
+  ASSERT_EQ(connector->table_schemas().size(), 1);
+  const DataTableSchema& schema = connector->table_schemas()[0];
+  EXPECT_EQ(schema.name(), "load_gen");
+  ASSERT_EQ(schema.elements().size(), 4);
+  EXPECT_EQ(schema.elements()[1].name(), "i0");
+  EXPECT_EQ(schema.elements()[3].name(), "s1");
+  ASSERT_OK(connector->Init());
+
+  DataTable data_table(/*id*/ 0, schema);
+  auto ctx = std::make_unique<StandaloneContext>(md::UPIDSet{});
+  connector->TransferData(ctx.get(), {&data_table});
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  connector->TransferData(ctx.get(), {&data_table});
+
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(const ColumnWrapperRecordBatch& records, tablets);
+  const int64_t num_rows = static_cast<int64_t>(records[0]->Size());
+  EXPECT_GE(num_rows, 100);
+  EXPECT_EQ(num_rows, static_cast<LoadGenConnector*>(connector.get())->num_rows_generated());
+
+  EXPECT_EQ(AccessRecordBatch<types::Int64Value>(records, 1, 2), 2);
+  EXPECT_EQ(AccessRecordBatch<types::StringValue>(records, 2, 0), "0...");
+  EXPECT_EQ(AccessRecordBatch<types::StringValue>(records, 3, 4), "1...");
+
+  EXPECT_OK(connector->Stop());
+}
+
+}  // namespace stirling
+}  // namespace px
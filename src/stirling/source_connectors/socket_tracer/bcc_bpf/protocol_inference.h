@@ -607,8 +607,16 @@ static __inline enum message_type_t infer_nats_message(const char* buf, size_t c
   return kUnknown;
 }
 
+// Whether the check of a protocol should run, given the protocol hint of infer_protocol().
+static __inline bool should_infer(enum traffic_protocol_t hint, enum traffic_protocol_t protocol) {
+  return hint == kProtocolUnknown || hint == protocol;
+}
+
+// If hint is not kProtocolUnknown, only the check of that protocol runs. This avoids running all
+// the checks when the protocol is already known, or expected from past connections.
 static __inline struct protocol_message_t infer_protocol(const char* buf, size_t count,
-                                                         struct conn_info_t* conn_info) {
+                                                         struct conn_info_t* conn_info,
+                                                         enum traffic_protocol_t hint) {
   struct protocol_message_t inferred_message;
   inferred_message.protocol = kProtocolUnknown;
   inferred_message.type = kUnknown;
@@ -623,34 +631,36 @@ static __inline struct protocol_message_t infer_protocol(const char* buf, size_t
   //               role by considering which side called accept() vs connect(). Once the clean-up
   //               above is done, the code below can be turned into a chained ternary.
   // PROTOCOL_LIST: Requires update on new protocols.
-  if (ENABLE_HTTP_TRACING && (inferred_message.type = infer_http_message(buf, count)) != kUnknown) {
+  if (ENABLE_HTTP_TRACING && should_infer(hint, kProtocolHTTP) &&
+      (inferred_message.type = infer_http_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolHTTP;
-  } else if (ENABLE_CQL_TRACING &&
+  } else if (ENABLE_CQL_TRACING && should_infer(hint, kProtocolCQL) &&
              (inferred_message.type = infer_cql_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolCQL;
-  } else if (ENABLE_MONGO_TRACING &&
+  } else if (ENABLE_MONGO_TRACING && should_infer(hint, kProtocolMongo) &&
              (inferred_message.type = infer_mongo_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolMongo;
-  } else if (ENABLE_PGSQL_TRACING &&
+  } else if (ENABLE_PGSQL_TRACING && should_infer(hint, kProtocolPGSQL) &&
              (inferred_message.type = infer_pgsql_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolPGSQL;
-  } else if (ENABLE_MYSQL_TRACING &&
+  } else if (ENABLE_MYSQL_TRACING && should_infer(hint, kProtocolMySQL) &&
              (inferred_message.type = infer_mysql_message(buf, count, conn_info)) != kUnknown) {
     inferred_message.protocol = kProtocolMySQL;
-  } else if (ENABLE_MUX_TRACING &&
+  } else if (ENABLE_MUX_TRACING && should_infer(hint, kProtocolMux) &&
              (inferred_message.type = infer_mux_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolMux;
-  } else if (ENABLE_KAFKA_TRACING &&
+  } else if (ENABLE_KAFKA_TRACING && should_infer(hint, kProtocolKafka) &&
              (inferred_message.type = infer_kafka_message(buf, count, conn_info)) != kUnknown) {
     inferred_message.protocol = kProtocolKafka;
-  } else if (ENABLE_DNS_TRACING &&
+  } else if (ENABLE_DNS_TRACING && should_infer(hint, kProtocolDNS) &&
              (inferred_message.type = infer_dns_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolDNS;
-  } else if (ENABLE_REDIS_TRACING && is_redis_message(buf, count)) {
+  } else if (ENABLE_REDIS_TRACING && should_infer(hint, kProtocolRedis) &&
+             is_redis_message(buf, count)) {
     // For Redis, the message type is left to be kUnknown.
     // The message types are then inferred via traffic direction and client/server role.
     inferred_message.protocol = kProtocolRedis;
-  } else if (ENABLE_NATS_TRACING &&
+  } else if (ENABLE_NATS_TRACING && should_infer(hint, kProtocolNATS) &&
              (inferred_message.type = infer_nats_message(buf, count)) != kUnknown) {
     inferred_message.protocol = kProtocolNATS;
   }
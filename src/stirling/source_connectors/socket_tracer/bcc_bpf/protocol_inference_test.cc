@@ -89,7 +89,8 @@ TEST(ProtocolInferenceTest, MySQL) {
     conn_info_t conn_info = {};
     conn_info.prev_count = 5;
     constexpr char kQueryMessage[] = "\x24\x00\x00\x00\x16SELECT name FROM users WHERE id = ?";
-    auto protocol_message = infer_protocol(kQueryMessage, sizeof(kQueryMessage), &conn_info);
+    auto protocol_message =
+        infer_protocol(kQueryMessage, sizeof(kQueryMessage), &conn_info, kProtocolUnknown);
     EXPECT_EQ(kProtocolMySQL, protocol_message.protocol);
   }
 
@@ -101,13 +102,28 @@ TEST(ProtocolInferenceTest, MySQL) {
     kQueryBody[35] = '?';
 
     conn_info_t conn_info = {};
-    auto header_protocol_message = infer_protocol(kQueryHeader, sizeof(kQueryHeader), &conn_info);
+    auto header_protocol_message =
+        infer_protocol(kQueryHeader, sizeof(kQueryHeader), &conn_info, kProtocolUnknown);
     EXPECT_EQ(kUnknown, header_protocol_message.protocol);
-    auto body_protocol_message = infer_protocol(kQueryBody, sizeof(kQueryBody), &conn_info);
+    auto body_protocol_message =
+        infer_protocol(kQueryBody, sizeof(kQueryBody), &conn_info, kProtocolUnknown);
     EXPECT_EQ(kProtocolMySQL, body_protocol_message.protocol);
   }
 }
 
+TEST(ProtocolInferenceTest, HintRestrictsChecks) {
+  constexpr char kQueryMessage[] = "\x24\x00\x00\x00\x16SELECT name FROM users WHERE id = ?";
+
+  conn_info_t conn_info = {};
+  conn_info.prev_count = 5;
+  EXPECT_EQ(kProtocolMySQL,
+            infer_protocol(kQueryMessage, sizeof(kQueryMessage), &conn_info, kProtocolMySQL)
+                .protocol);
+  EXPECT_EQ(kProtocolUnknown,
+            infer_protocol(kQueryMessage, sizeof(kQueryMessage), &conn_info, kProtocolHTTP)
+                .protocol);
+}
+
 TEST(ProtocolInferenceTest, DNS) {
   // A query captured via WireShark:
   //   Domain Name System (query)
@@ -306,7 +322,8 @@ TEST(ProtocolInferenceTest, Kafka) {
       0x6e, 0x74, 0x00, 0x00, 0x00, 0x00};
 
   auto protocol_message =
-      infer_protocol(reinterpret_cast<const char*>(kReqFrame), sizeof(kReqFrame), &conn_info);
+      infer_protocol(reinterpret_cast<const char*>(kReqFrame), sizeof(kReqFrame), &conn_info,
+                     kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolKafka);
 
   // The Length Header is read first. And then the request body is read.
@@ -325,11 +342,11 @@ TEST(ProtocolInferenceTest, Kafka) {
       0x73, 0x74, 0x20, 0x65, 0x76, 0x65, 0x6e, 0x74, 0x00, 0x00, 0x00, 0x00};
 
   protocol_message = infer_protocol(reinterpret_cast<const char*>(kReqHeaderFrame),
-                                    sizeof(kReqHeaderFrame), &conn_info);
+                                    sizeof(kReqHeaderFrame), &conn_info, kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolUnknown);
 
   protocol_message = infer_protocol(reinterpret_cast<const char*>(kReqBodyFrame),
-                                    sizeof(kReqBodyFrame), &conn_info);
+                                    sizeof(kReqBodyFrame), &conn_info, kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolKafka);
 }
 
@@ -432,22 +449,24 @@ TEST(ProtocolInferenceTest, Mux) {
   // clang-format on
 
   auto protocol_message = infer_protocol(reinterpret_cast<const char*>(kRerrReqFrame),
-                                         sizeof(kRerrReqFrame), &conn_info);
+                                         sizeof(kRerrReqFrame), &conn_info, kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolMux);
   EXPECT_EQ(protocol_message.type, kRequest);
 
   protocol_message =
-      infer_protocol(reinterpret_cast<const char*>(kRerrResp), sizeof(kRerrResp), &conn_info);
+      infer_protocol(reinterpret_cast<const char*>(kRerrResp), sizeof(kRerrResp), &conn_info,
+                     kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolMux);
   EXPECT_EQ(protocol_message.type, kResponse);
 
   protocol_message = infer_protocol(reinterpret_cast<const char*>(kTinitReqFrame),
-                                    sizeof(kTinitReqFrame), &conn_info);
+                                    sizeof(kTinitReqFrame), &conn_info, kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolMux);
   EXPECT_EQ(protocol_message.type, kRequest);
 
   protocol_message =
-      infer_protocol(reinterpret_cast<const char*>(kRinitResp), sizeof(kRinitResp), &conn_info);
+      infer_protocol(reinterpret_cast<const char*>(kRinitResp), sizeof(kRinitResp), &conn_info,
+                     kProtocolUnknown);
   EXPECT_EQ(protocol_message.protocol, kProtocolMux);
   EXPECT_EQ(protocol_message.type, kResponse);
 }
@@ -45,7 +45,14 @@ const int32_t kInvalidFD = -1;
 const int kConnStatsDataThreshold = 65536;
 
 // This is the perf buffer for BPF program to export data from kernel to user space.
+// On kernels with BPF ring buffer support (5.8+), user-space may instead request a single ring
+// buffer shared by all CPUs, by defining SOCKET_DATA_EVENTS_RINGBUF_PAGES.
+// Note that BCC cannot rewrite map functions inside macros, so call sites need their own #ifdef.
+#ifdef SOCKET_DATA_EVENTS_RINGBUF_PAGES
+BPF_RINGBUF_OUTPUT(socket_data_events, SOCKET_DATA_EVENTS_RINGBUF_PAGES);
+#else
 BPF_PERF_OUTPUT(socket_data_events);
+#endif
 BPF_PERF_OUTPUT(socket_control_events);
 BPF_PERF_OUTPUT(conn_stats_events);
 
@@ -110,6 +117,30 @@ BPF_PERCPU_ARRAY(conn_stats_event_buffer_heap, struct conn_stats_event_t, 1);
 // number of arrays with only 1 element.
 BPF_PERCPU_ARRAY(control_values, int64_t, kNumControlValues);
 
+// Protocols inferred on past client connections, so that a new connection of the same process to
+// the same remote port only needs to run the check of that protocol. Entries are removed when the
+// check fails, after which all protocols are checked again.
+// Key is {tgid, remote port}. Value is a traffic_protocol_t.
+BPF_TABLE("lru_hash", uint64_t, uint32_t, protocol_inference_cache, 16384);
+
+// Tables of the in-kernel HTTP filter. See match_http_filter().
+// These maps are only written from user-space, and only read from BPF.
+// Value is an http_filter_action_t.
+// Key is tgid.
+BPF_HASH(http_filter_tgid_map, uint32_t, uint32_t, 1024);
+// Key is the port of the remote endpoint, in host byte order.
+BPF_HASH(http_filter_port_map, uint16_t, uint32_t, 1024);
+// Key is a request method, optionally followed by the first path segment.
+BPF_HASH(http_filter_request_map, struct http_filter_key_t, uint32_t, 1024);
+
+#if ENABLE_CONN_STATS_AGGREGATION
+// The conn stats summed up per local process, remote endpoint and role; see
+// conn_stats_agg_key_t. Per-CPU, so that the sums need no atomics.
+// User-space reads it on each conn_stats transfer and removes the keys of processes that exited.
+BPF_PERCPU_HASH(conn_stats_agg_map, struct conn_stats_agg_key_t, struct conn_stats_agg_value_t,
+                65536);
+#endif
+
 /***********************************************************
  * General helper functions
  ***********************************************************/
@@ -254,6 +285,105 @@ static __inline enum target_tgid_match_result_t match_trace_tgid(const uint32_t
   return TARGET_TGID_UNMATCHED;
 }
 
+// Returns the HTTP filter action configured for a request with the given start.
+// Filters are matched by tgid first, then by remote port, and then by request line.
+static __inline enum http_filter_action_t match_http_filter(uint32_t tgid,
+                                                            const struct conn_info_t* conn_info,
+                                                            const char* buf, size_t count) {
+  uint32_t* action = http_filter_tgid_map.lookup(&tgid);
+  if (action != NULL) {
+    return *action;
+  }
+
+  // sin_port and sin6_port are at the same offset.
+  uint16_t port = bpf_ntohs(conn_info->addr.in4.sin_port);
+  action = http_filter_port_map.lookup(&port);
+  if (action != NULL) {
+    return *action;
+  }
+
+  struct http_filter_key_t key = {};
+  if (count >= HTTP_FILTER_KEY_SIZE) {
+    bpf_probe_read(&key.data, HTTP_FILTER_KEY_SIZE, buf);
+  } else {
+    // infer_http_message() only accepts requests of at least 16 bytes.
+    bpf_probe_read(&key.data, 16, buf);
+  }
+
+  // Find the end of the method, and the end of the first path segment.
+  int method_end = 0;
+  int segment_end = 0;
+#pragma unroll
+  for (int i = 1; i < HTTP_FILTER_KEY_SIZE; ++i) {
+    char c = key.data[i];
+    if (method_end == 0) {
+      if (c == ' ') {
+        method_end = i;
+      }
+    } else if (i > method_end + 1 && (c == ' ' || c == '/' || c == '?')) {
+      segment_end = i;
+      break;
+    }
+  }
+
+  if (method_end == 0) {
+    return kHTTPFilterActionNone;
+  }
+
+  if (segment_end != 0) {
+#pragma unroll
+    for (int i = 0; i < HTTP_FILTER_KEY_SIZE; ++i) {
+      if (i >= segment_end) {
+        key.data[i] = 0;
+      }
+    }
+    action = http_filter_request_map.lookup(&key);
+    if (action != NULL) {
+      return *action;
+    }
+  }
+
+#pragma unroll
+  for (int i = 0; i < HTTP_FILTER_KEY_SIZE; ++i) {
+    if (i >= method_end) {
+      key.data[i] = 0;
+    }
+  }
+  action = http_filter_request_map.lookup(&key);
+  return (action != NULL) ? *action : kHTTPFilterActionNone;
+}
+
+// Returns the HTTP filter action for data on an HTTP connection.
+// The action is decided at the start of each request, and applies to all data until the next
+// request, including the response. buf may be NULL if the data is not known to start a message.
+static __inline enum http_filter_action_t get_http_filter_action(uint32_t tgid,
+                                                                 struct conn_info_t* conn_info,
+                                                                 const char* buf, size_t count) {
+  enum message_type_t type = (buf == NULL) ? kUnknown : infer_http_message(buf, count);
+  if (type == kRequest) {
+    conn_info->http_filter_action = match_http_filter(tgid, conn_info, buf, count);
+  }
+  // When truncating, only the start of each request and response is kept.
+  if (conn_info->http_filter_action == kHTTPFilterActionTruncate && type == kUnknown) {
+    return kHTTPFilterActionDrop;
+  }
+  return conn_info->http_filter_action;
+}
+
+// Returns the key of the connection in protocol_inference_cache, or 0 if it should not be cached.
+// Only client connections are cached, since the remote port of a server connection is ephemeral.
+static __inline uint64_t get_protocol_inference_cache_key(const struct conn_info_t* conn_info) {
+  if (conn_info->role != kRoleClient) {
+    return 0;
+  }
+  if (conn_info->addr.sa.sa_family != AF_INET && conn_info->addr.sa.sa_family != AF_INET6) {
+    return 0;
+  }
+  // sin_port and sin6_port are at the same offset.
+  uint16_t port = bpf_ntohs(conn_info->addr.in4.sin_port);
+  return ((uint64_t)conn_info->conn_id.upid.tgid << 32) | port;
+}
+
 static __inline void update_traffic_class(struct conn_info_t* conn_info,
                                           enum traffic_direction_t direction, const char* buf,
                                           size_t count) {
@@ -262,17 +392,43 @@ static __inline void update_traffic_class(struct conn_info_t* conn_info,
   }
   conn_info->protocol_total_count += 1;
 
+  // Once the protocol is known, only its check needs to run, for the role and length headers.
+  // Before that, try the protocol of past connections to the same endpoint.
+  enum traffic_protocol_t hint = conn_info->protocol;
+  uint64_t cache_key = 0;
+  if (hint == kProtocolUnknown) {
+    cache_key = get_protocol_inference_cache_key(conn_info);
+    uint32_t* cached_protocol = NULL;
+    if (cache_key != 0) {
+      cached_protocol = protocol_inference_cache.lookup(&cache_key);
+    }
+    if (cached_protocol != NULL) {
+      hint = *cached_protocol;
+    }
+  }
+
   // Try to infer connection type (protocol) based on data.
-  struct protocol_message_t inferred_protocol = infer_protocol(buf, count, conn_info);
+  struct protocol_message_t inferred_protocol = infer_protocol(buf, count, conn_info, hint);
 
   // Could not infer the traffic.
-  if (inferred_protocol.protocol == kProtocolUnknown || conn_info->protocol == kProtocolMongo) {
+  if (inferred_protocol.protocol == kProtocolUnknown) {
+    if (hint != conn_info->protocol) {
+      // The endpoint no longer serves the cached protocol.
+      protocol_inference_cache.delete(&cache_key);
+    }
+    return;
+  }
+  if (conn_info->protocol == kProtocolMongo) {
     return;
   }
 
   // Update protocol if not set.
   if (conn_info->protocol == kProtocolUnknown) {
     conn_info->protocol = inferred_protocol.protocol;
+    if (cache_key != 0 && hint == kProtocolUnknown) {
+      uint32_t protocol = inferred_protocol.protocol;
+      protocol_inference_cache.update(&cache_key, &protocol);
+    }
   }
 
   // Update role if not set.
@@ -437,7 +593,11 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
+#ifdef SOCKET_DATA_EVENTS_RINGBUF_PAGES
+    socket_data_events.ringbuf_output(event, sizeof(event->attr) + amount_copied, /* flags */ 0);
+#else
     socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+#endif
   }
 }
 
@@ -517,6 +677,9 @@ int conn_cleanup_uprobe(struct pt_regs* ctx) {
 
     struct conn_info_t* conn_info = conn_info_map.lookup(&tgid_fd);
     if (conn_info != NULL && conn_info->conn_id.tsid == conn_id.tsid) {
+#if ENABLE_CONN_STATS_AGGREGATION
+      aggregate_conn_stats(conn_info, /*close*/ true);
+#endif
       conn_info_map.delete(&tgid_fd);
     }
 
@@ -653,6 +816,51 @@ static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid
   return (force_trace_tgid || should_trace_protocol_data(conn_info));
 }
 
+#if ENABLE_CONN_STATS_AGGREGATION
+// Adds the bytes of the connection since the last call to its aggregate in conn_stats_agg_map.
+// Like user-space, only connections with a known role to an IP endpoint are aggregated.
+static __inline void aggregate_conn_stats(struct conn_info_t* conn_info, bool close) {
+  sa_family_t sa_family = conn_info->addr.sa.sa_family;
+  if ((sa_family != AF_INET && sa_family != AF_INET6) || conn_info->role == kRoleUnknown) {
+    return;
+  }
+
+  struct conn_stats_agg_key_t key;
+  __builtin_memset(&key, 0, sizeof(key));
+  key.upid = conn_info->conn_id.upid;
+  key.addr = conn_info->addr;
+  key.role = conn_info->role;
+  // Collapse the connections from the changing ports of clients, as BuildAggKey() does.
+  if (key.role == kRoleServer) {
+    if (sa_family == AF_INET) {
+      key.addr.in4.sin_port = 0;
+    } else {
+      key.addr.in6.sin6_port = 0;
+    }
+  }
+
+  struct conn_stats_agg_value_t zero = {};
+  struct conn_stats_agg_value_t* value = conn_stats_agg_map.lookup_or_try_init(&key, &zero);
+  if (value == NULL) {
+    return;
+  }
+  value->wr_bytes += conn_info->wr_bytes - conn_info->agg_wr_bytes;
+  value->rd_bytes += conn_info->rd_bytes - conn_info->agg_rd_bytes;
+  if (!conn_info->agg_opened) {
+    value->conn_open += 1;
+    conn_info->agg_opened = true;
+  }
+  if (close) {
+    value->conn_close += 1;
+  }
+  value->protocol = conn_info->protocol;
+  value->ssl = conn_info->ssl;
+
+  conn_info->agg_wr_bytes = conn_info->wr_bytes;
+  conn_info->agg_rd_bytes = conn_info->rd_bytes;
+}
+#endif
+
 static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t* conn_info,
                                        enum traffic_direction_t direction, ssize_t bytes_count) {
   // Update state of the connection.
@@ -665,6 +873,11 @@ static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t*
       break;
   }
 
+#if ENABLE_CONN_STATS_AGGREGATION
+  aggregate_conn_stats(conn_info, /*close*/ false);
+  return;
+#endif
+
   // Only send event if there's been enough of a change.
   // TODO(oazizi): Add elapsed time since last send as a triggering condition too.
   uint64_t total_bytes = conn_info->wr_bytes + conn_info->rd_bytes;
@@ -723,6 +936,10 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
 
   // Only process plaintext data.
   if (conn_info->ssl == ssl) {
+    // The first non-empty buffer of the data, which is used to classify it.
+    const char* first_buf = vecs ? NULL : args->buf;
+    size_t first_buf_size = bytes_count;
+
     // TODO(yzhao): Split the interface such that the singular buf case and multiple bufs in msghdr
     // are handled separately without mixed interface. The plan is to factor out helper functions
     // for lower-level functionalities, and call them separately for each case.
@@ -739,13 +956,32 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
         BPF_PROBE_READ_VAR(iov_cpy, &args->iov[i]);
         buf_size = min_size_t(iov_cpy.iov_len, bytes_count);
         if (buf_size != 0) {
+          first_buf = iov_cpy.iov_base;
+          first_buf_size = buf_size;
           update_traffic_class(conn_info, direction, iov_cpy.iov_base, buf_size);
           break;
         }
       }
     }
 
-    if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info)) {
+    bool send_data = should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info);
+    size_t send_size = bytes_count;
+#if ENABLE_HTTP_KERNEL_FILTER
+    if (send_data && conn_info->protocol == kProtocolHTTP) {
+      switch (get_http_filter_action(tgid, conn_info, first_buf, first_buf_size)) {
+        case kHTTPFilterActionDrop:
+          send_data = false;
+          break;
+        case kHTTPFilterActionTruncate:
+          send_size = min_size_t(bytes_count, HTTP_FILTER_TRUNCATE_SIZE);
+          break;
+        default:
+          break;
+      }
+    }
+#endif
+
+    if (send_data) {
       struct socket_data_event_t* event =
           fill_socket_data_event(args->source_fn, direction, conn_info);
       if (event == NULL) {
@@ -755,12 +991,12 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
 
       // TODO(yzhao): Same TODO for split the interface.
       if (!vecs) {
-        perf_submit_wrapper(ctx, direction, args->buf, bytes_count, conn_info, event);
+        perf_submit_wrapper(ctx, direction, args->buf, send_size, conn_info, event);
       } else {
         // TODO(yzhao): iov[0] is copied twice, once in calling update_traffic_class(), and here.
         // This happens to the write probes as well, but the calls are placed in the entry and
         // return probes respectively. Consider remove one copy.
-        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, bytes_count, conn_info, event);
+        perf_submit_iovecs(ctx, direction, args->iov, args->iovlen, send_size, conn_info, event);
       }
     }
   }
@@ -843,7 +1079,11 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
+#ifdef SOCKET_DATA_EVENTS_RINGBUF_PAGES
+    socket_data_events.ringbuf_output(event, sizeof(event->attr), /* flags */ 0);
+#else
     socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+#endif
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
@@ -881,12 +1121,16 @@ static __inline void process_syscall_close(struct pt_regs* ctx, uint64_t id,
       conn_info->rd_bytes != 0) {
     submit_close_event(ctx, conn_info, kSyscallClose);
 
+#if ENABLE_CONN_STATS_AGGREGATION
+    aggregate_conn_stats(conn_info, /*close*/ true);
+#else
     // Report final conn stats event for this connection.
     struct conn_stats_event_t* event = fill_conn_stats_event(conn_info);
     if (event != NULL) {
       event->conn_events = event->conn_events | CONN_CLOSE;
       conn_stats_events.perf_submit(ctx, event, sizeof(struct conn_stats_event_t));
     }
+#endif
   }
 
   conn_info_map.delete(&tgid_fd);
@@ -28,6 +28,10 @@
 
 const char kControlMapName[] = "control_map";
 const char kControlValuesArrayName[] = "control_values";
+const char kHTTPFilterTGIDMapName[] = "http_filter_tgid_map";
+const char kHTTPFilterPortMapName[] = "http_filter_port_map";
+const char kHTTPFilterRequestMapName[] = "http_filter_request_map";
+const char kConnStatsAggMapName[] = "conn_stats_agg_map";
 
 const int64_t kTraceAllTGIDs = -1;
 
@@ -35,6 +39,26 @@ const int64_t kTraceAllTGIDs = -1;
 #define CONN_CLEANUP_ITERS 85
 const int kMaxConnMapCleanupItems = CONN_CLEANUP_ITERS;
 
+// Actions of the in-kernel HTTP filter, which apply to the data of a request and its response.
+enum http_filter_action_t {
+  kHTTPFilterActionNone = 0,
+  // The data is not sent to user-space.
+  kHTTPFilterActionDrop,
+  // Only the first HTTP_FILTER_TRUNCATE_SIZE bytes of the request and response are sent to
+  // user-space; the rest is dropped.
+  kHTTPFilterActionTruncate,
+};
+
+// The in-kernel HTTP filter matches requests by method and first path segment (e.g.
+// "GET /healthz"), or by method alone (e.g. "OPTIONS"). The key holds the match, zero-padded.
+// Only the first HTTP_FILTER_KEY_SIZE bytes of a request are considered.
+#define HTTP_FILTER_KEY_SIZE 32
+struct http_filter_key_t {
+  char data[HTTP_FILTER_KEY_SIZE];
+};
+
+#define HTTP_FILTER_TRUNCATE_SIZE 256
+
 union sockaddr_t {
   struct sockaddr sa;
   struct sockaddr_in in4;
@@ -85,6 +109,16 @@ struct conn_info_t {
   size_t prev_count;
   char prev_buf[4];
   bool prepend_length_header;
+
+  // The in-kernel HTTP filter action for the current request and its response.
+  // Only used for HTTP connections, when the filter is enabled.
+  enum http_filter_action_t http_filter_action;
+
+  // The bytes written/read that have been added to conn_stats_agg_map, and whether the connection
+  // has been counted as opened there. Only used when conn stats are aggregated in BPF.
+  int64_t agg_wr_bytes;
+  int64_t agg_rd_bytes;
+  bool agg_opened;
 };
 
 // This struct is a subset of conn_info_t. It is used to communicate connect/accept events.
@@ -233,6 +267,25 @@ struct conn_stats_event_t {
   uint32_t conn_events;
 };
 
+// When conn stats are aggregated in BPF, conn_stats_event_t are not sent. Instead, the stats of
+// all connections are summed up in conn_stats_agg_map, with the same key as ConnStats::AggKey:
+// the local process, the remote endpoint, with the port zeroed for servers, and the role.
+struct conn_stats_agg_key_t {
+  struct upid_t upid;
+  union sockaddr_t addr;
+  enum endpoint_role_t role;
+};
+
+// The totals of the connections of a conn_stats_agg_key_t since it was first seen, on one CPU.
+struct conn_stats_agg_value_t {
+  int64_t wr_bytes;
+  int64_t rd_bytes;
+  int64_t conn_open;
+  int64_t conn_close;
+  enum traffic_protocol_t protocol;
+  bool ssl;
+};
+
 enum control_event_type_t {
   kConnOpen,
   kConnClose,
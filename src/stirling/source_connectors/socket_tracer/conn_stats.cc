@@ -21,6 +21,7 @@
 #include <absl/strings/substitute.h>
 
 #include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/metrics.h"
 
 namespace px {
 namespace stirling {
@@ -83,5 +84,66 @@ absl::flat_hash_map<ConnStats::AggKey, ConnStats::Stats>& ConnStats::UpdateStats
   return agg_stats_;
 }
 
+absl::flat_hash_map<ConnStats::AggKey, ConnStats::Stats>& ConnStats::UpdateStatsFromBPF(
+    const BPFAggregates& aggregates) {
+  ++update_counter_;
+
+  // The trackers do not get conn stats from BPF in this mode, but still wait for their final
+  // stats to be reported before they can be destroyed.
+  if (conn_trackers_mgr_ != nullptr) {
+    for (const auto& tracker : conn_trackers_mgr_->active_trackers()) {
+      if (tracker->IsZombie()) {
+        tracker->MarkFinalConnStatsReported();
+      }
+    }
+  }
+
+  for (const auto& [bpf_key, per_cpu_values] : aggregates) {
+    SockAddr remote_endpoint;
+    PopulateSockAddr(&bpf_key.addr.sa, &remote_endpoint);
+    if (!(remote_endpoint.family == SockAddrFamily::kIPv4 ||
+          remote_endpoint.family == SockAddrFamily::kIPv6) ||
+        bpf_key.role == kRoleUnknown) {
+      continue;
+    }
+
+    Stats totals;
+    for (const auto& value : per_cpu_values) {
+      totals.conn_open += value.conn_open;
+      totals.conn_close += value.conn_close;
+      totals.bytes_sent += value.wr_bytes;
+      totals.bytes_recv += value.rd_bytes;
+      if (value.protocol != kProtocolUnknown) {
+        totals.protocol = value.protocol;
+      }
+      totals.ssl = totals.ssl || value.ssl;
+    }
+
+    // BPF keeps the totals since the key was first seen; only changes count as activity.
+    auto& stats = agg_stats_[BuildAggKey(bpf_key.upid, bpf_key.role, remote_endpoint)];
+    if (totals.conn_open == stats.conn_open && totals.conn_close == stats.conn_close &&
+        totals.bytes_sent == stats.bytes_sent && totals.bytes_recv == stats.bytes_recv) {
+      continue;
+    }
+
+    SocketTracerMetrics::GetProtocolMetrics(totals.protocol)
+        .conn_stats_bytes.Increment(totals.bytes_sent + totals.bytes_recv - stats.bytes_sent -
+                                    stats.bytes_recv);
+
+    stats.addr_family = remote_endpoint.family;
+    stats.role = bpf_key.role;
+    stats.protocol = totals.protocol;
+    stats.ssl = totals.ssl;
+    stats.conn_open = totals.conn_open;
+    stats.conn_close = totals.conn_close;
+    stats.bytes_sent = totals.bytes_sent;
+    stats.bytes_recv = totals.bytes_recv;
+
+    stats.last_update = update_counter_;
+  }
+
+  return agg_stats_;
+}
+
 }  // namespace stirling
 }  // namespace px
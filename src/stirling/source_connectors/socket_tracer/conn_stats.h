@@ -20,6 +20,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
@@ -102,6 +103,16 @@ class ConnStats {
    */
   absl::flat_hash_map<AggKey, Stats>& UpdateStats();
 
+  // The entries of conn_stats_agg_map, with the value of each CPU.
+  using BPFAggregates =
+      std::vector<std::pair<conn_stats_agg_key_t, std::vector<conn_stats_agg_value_t>>>;
+
+  /**
+   * Like UpdateStats(), but from the totals that BPF aggregated itself, when the connector runs
+   * with --stirling_conn_stats_bpf_aggregation. The trackers are not consulted.
+   */
+  absl::flat_hash_map<AggKey, Stats>& UpdateStatsFromBPF(const BPFAggregates& aggregates);
+
   bool Active(const Stats& stats) { return update_counter_ == stats.last_update; }
 
  private:
@@ -396,5 +396,41 @@ TEST_F(ConnStatsTest, DisabledConnTracker) {
               ElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 1, 200, 100))));
 }
 
+// Tests that the per-CPU totals aggregated in BPF are summed up, and only count as activity when
+// they change.
+TEST_F(ConnStatsTest, UpdateStatsFromBPF) {
+  conn_stats_agg_key_t key = {};
+  key.upid = {.pid = 12345, .start_time_ticks = 1000};
+  key.role = kRoleServer;
+  key.addr.in4.sin_family = AF_INET;
+  key.addr.in4.sin_port = 0;
+  key.addr.in4.sin_addr.s_addr = 0x01010101;  // 1.1.1.1
+
+  conn_stats_agg_value_t cpu0 = {};
+  cpu0.conn_open = 2;
+  cpu0.wr_bytes = 30;
+  cpu0.protocol = kProtocolHTTP;
+  conn_stats_agg_value_t cpu1 = {};
+  cpu1.conn_close = 1;
+  cpu1.rd_bytes = 50;
+
+  ConnStats::BPFAggregates aggregates = {{key, {cpu0, cpu1}}};
+  auto& agg_stats = conn_stats_.UpdateStatsFromBPF(aggregates);
+  ASSERT_THAT(agg_stats,
+              ElementsAre(Pair(AggKeyIs(12345, "1.1.1.1", 0), StatsIs(2, 1, 30, 50))));
+  EXPECT_EQ(agg_stats.begin()->second.protocol, kProtocolHTTP);
+  EXPECT_TRUE(conn_stats_.Active(agg_stats.begin()->second));
+
+  // Unchanged totals are not activity.
+  conn_stats_.UpdateStatsFromBPF(aggregates);
+  EXPECT_FALSE(conn_stats_.Active(agg_stats.begin()->second));
+
+  aggregates[0].second[1].rd_bytes += 10;
+  conn_stats_.UpdateStatsFromBPF(aggregates);
+  EXPECT_THAT(agg_stats,
+              ElementsAre(Pair(AggKeyIs(12345, "1.1.1.1", 0), StatsIs(2, 1, 30, 60))));
+  EXPECT_TRUE(conn_stats_.Active(agg_stats.begin()->second));
+}
+
 }  // namespace stirling
 }  // namespace px
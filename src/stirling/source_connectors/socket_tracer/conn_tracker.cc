@@ -54,6 +54,9 @@ DEFINE_bool(
 DEFINE_int64(
     stirling_check_proc_for_conn_close, true,
     "If enabled, Stirling will check Linux /proc on idle connections to see if they are closed.");
+DEFINE_int64(stirling_conn_frame_arena_max_bytes, 1024 * 1024,
+             "The maximum number of bytes of parsed frames a connection tracker places on its "
+             "frame arena between resets. Frames beyond that are allocated on the heap.");
 DEFINE_int64(stirling_untracked_upid_threshold_seconds, 0,
              "If non-zero, Stirling will disable data tracking of processes that are outside the "
              "list of PIDs tracked by the context after the specified time period.");
@@ -76,6 +79,57 @@ ConnTracker::~ConnTracker() {
   if (conn_info_map_mgr_ != nullptr) {
     conn_info_map_mgr_->ReleaseResources(conn_id_);
   }
+  if (reported_frame_arena_bytes_ != 0) {
+    SocketTracerMetrics::GetProtocolMetrics(kProtocolHTTP)
+        .frame_arena_bytes.Decrement(reported_frame_arena_bytes_);
+  }
+  if (reported_http2_streams_bytes_ != 0) {
+    SocketTracerMetrics::GetProtocolMetrics(kProtocolHTTP2)
+        .http2_streams_bytes.Decrement(reported_http2_streams_bytes_);
+  }
+}
+
+void ConnTracker::UpdateFrameArenaMetrics() {
+  size_t reserved = frame_arena_.bytes_reserved();
+  if (reserved == reported_frame_arena_bytes_) {
+    return;
+  }
+  // Only HTTP/1.x frames use the arena, so the usage is attributed to HTTP.
+  SocketTracerMetrics::GetProtocolMetrics(kProtocolHTTP)
+      .frame_arena_bytes.Increment(static_cast<double>(reserved) -
+                                   static_cast<double>(reported_frame_arena_bytes_));
+  reported_frame_arena_bytes_ = reserved;
+}
+
+void ConnTracker::UpdateHTTP2StreamsMetrics(const HTTP2StreamsContainer::CleanupStats& stats) {
+  if (stats.num_expired == 0 && stats.num_evicted == 0 &&
+      stats.remaining_bytes == reported_http2_streams_bytes_) {
+    return;
+  }
+  SocketTracerMetrics& metrics = SocketTracerMetrics::GetProtocolMetrics(kProtocolHTTP2);
+  metrics.http2_streams_expired.Increment(stats.num_expired);
+  metrics.http2_streams_evicted.Increment(stats.num_evicted);
+  metrics.http2_streams_bytes.Increment(static_cast<double>(stats.remaining_bytes) -
+                                        static_cast<double>(reported_http2_streams_bytes_));
+  reported_http2_streams_bytes_ = stats.remaining_bytes;
+}
+
+void ConnTracker::UpdateDNSCacheMetrics(protocols::dns::State* state) {
+  if (state->cache_hits == 0 && state->cache_misses == 0) {
+    return;
+  }
+  SocketTracerMetrics& metrics = SocketTracerMetrics::GetProtocolMetrics(kProtocolDNS);
+  metrics.dns_json_cache_hits.Increment(state->cache_hits);
+  metrics.dns_json_cache_misses.Increment(state->cache_misses);
+  state->cache_hits = 0;
+  state->cache_misses = 0;
+}
+
+void ConnTracker::RecordProcessingTime(std::chrono::nanoseconds parse_time,
+                                       std::chrono::nanoseconds stitch_time) {
+  SocketTracerMetrics& metrics = SocketTracerMetrics::GetProtocolMetrics(protocol_);
+  metrics.parse_ns.fetch_add(parse_time.count(), std::memory_order_relaxed);
+  metrics.stitch_ns.fetch_add(stitch_time.count(), std::memory_order_relaxed);
 }
 
 void ConnTracker::AddControlEvent(const socket_control_event_t& event) {
@@ -762,7 +816,7 @@ void ConnTracker::UpdateDataStats(const SocketDataEvent& event) {
 void ConnTracker::IterationPreTick(
     const std::chrono::time_point<std::chrono::steady_clock>& iteration_time,
     const std::vector<CIDRBlock>& cluster_cidrs, system::ProcParser* proc_parser,
-    system::SocketInfoManager* socket_info_mgr) {
+    system::SocketInfoManager* socket_info_mgr, FDLinkSnapshots* fd_link_snapshots) {
   set_current_time(iteration_time);
 
   // Assume no activity. This flag will be flipped if there is any activity during the iteration.
@@ -777,7 +831,7 @@ void ConnTracker::IterationPreTick(
   // If remote_addr is missing, it means the connect/accept was not traced.
   // Attempt to infer the connection information, to populate remote_addr.
   if (open_info_.remote_addr.family == SockAddrFamily::kUnspecified && socket_info_mgr != nullptr) {
-    InferConnInfo(proc_parser, socket_info_mgr);
+    InferConnInfo(proc_parser, socket_info_mgr, fd_link_snapshots);
 
     // TODO(oazizi): If connection resolves to SockAddr type "Other",
     //               we should mark the state in BPF to Other too, so BPF stops tracing.
@@ -919,7 +973,8 @@ endpoint_role_t TranslateRole(system::ClientServerRole role) {
 }  // namespace
 
 void ConnTracker::InferConnInfo(system::ProcParser* proc_parser,
-                                system::SocketInfoManager* socket_info_mgr) {
+                                system::SocketInfoManager* socket_info_mgr,
+                                FDLinkSnapshots* fd_link_snapshots) {
   DCHECK(proc_parser != nullptr);
   DCHECK(socket_info_mgr != nullptr);
 
@@ -932,7 +987,12 @@ void ConnTracker::InferConnInfo(system::ProcParser* proc_parser,
   }
 
   if (conn_resolver_ == nullptr) {
-    conn_resolver_ = std::make_unique<FDResolver>(proc_parser, conn_id_.upid.pid, conn_id_.fd);
+    if (fd_link_snapshots != nullptr) {
+      conn_resolver_ =
+          std::make_unique<FDResolver>(fd_link_snapshots, conn_id_.upid.pid, conn_id_.fd);
+    } else {
+      conn_resolver_ = std::make_unique<FDResolver>(proc_parser, conn_id_.upid.pid, conn_id_.fd);
+    }
     bool success = conn_resolver_->Setup();
     if (!success) {
       conn_resolver_.reset();
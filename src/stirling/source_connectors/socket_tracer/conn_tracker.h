@@ -19,6 +19,7 @@
 #pragma once
 
 #include <any>
+#include <chrono>
 #include <deque>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@
 
 #include <magic_enum.hpp>
 
+#include "src/common/base/arena.h"
 #include "src/common/system/proc_parser.h"
 #include "src/common/system/socket_info.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
@@ -48,6 +50,7 @@ constexpr int64_t kUnsetPIDFD = -1;
 DECLARE_int64(stirling_conn_trace_pid);
 DECLARE_int64(stirling_conn_trace_fd);
 DECLARE_bool(stirling_conn_disable_to_bpf);
+DECLARE_int64(stirling_conn_frame_arena_max_bytes);
 DECLARE_int64(stirling_check_proc_for_conn_close);
 DECLARE_int64(stirling_untracked_upid_threshold_seconds);
 
@@ -244,8 +247,10 @@ class ConnTracker : NotCopyMoveable {
    *
    * @param proc_parser Pointer to a proc_parser for access to /proc filesystem.
    * @param connections A map of inodes to endpoint information.
+   * @param fd_link_snapshots If set, the FD links are read through the iteration's snapshots.
    */
-  void InferConnInfo(system::ProcParser* proc_parser, system::SocketInfoManager* socket_info_mgr);
+  void InferConnInfo(system::ProcParser* proc_parser, system::SocketInfoManager* socket_info_mgr,
+                     FDLinkSnapshots* fd_link_snapshots = nullptr);
 
   /**
    * Processes the connection tracker, parsing raw events into frames,
@@ -261,8 +266,11 @@ class ConnTracker : NotCopyMoveable {
     using TStateType = typename TProtocolTraits::state_type;
 
     InitProtocolState<TStateType>();
+    PrepareFrameArena<TFrameType, TStateType>();
 
+    const auto parse_start = std::chrono::steady_clock::now();
     DataStreamsToFrames<TFrameType, TStateType>();
+    const auto stitch_start = std::chrono::steady_clock::now();
 
     auto& req_frames = req_data()->Frames<TFrameType>();
     auto& resp_frames = resp_data()->Frames<TFrameType>();
@@ -274,10 +282,15 @@ class ConnTracker : NotCopyMoveable {
     protocols::RecordsWithErrorCount<TRecordType> result =
         protocols::StitchFrames<TRecordType, TFrameType, TStateType>(&req_frames, &resp_frames,
                                                                      state_ptr);
+    RecordProcessingTime(stitch_start - parse_start,
+                         std::chrono::steady_clock::now() - stitch_start);
 
     CONN_TRACE(2) << absl::Substitute("records=$0", result.records.size());
 
     UpdateResultStats(result);
+    if constexpr (std::is_same_v<TStateType, protocols::dns::StateWrapper>) {
+      UpdateDNSCacheMetrics(&state_ptr->global);
+    }
 
     return std::move(result.records);
   }
@@ -451,11 +464,13 @@ class ConnTracker : NotCopyMoveable {
    *
    * @param proc_parser Pointer to a proc_parser for access to /proc filesystem.
    * @param connections A map of inodes to endpoint information.
+   * @param fd_link_snapshots If set, the FD links are read through the iteration's snapshots.
    */
   void IterationPreTick(const std::chrono::time_point<std::chrono::steady_clock>& iteration_time,
                         const std::vector<CIDRBlock>& cluster_cidrs,
                         system::ProcParser* proc_parser,
-                        system::SocketInfoManager* socket_info_mgr);
+                        system::SocketInfoManager* socket_info_mgr,
+                        FDLinkSnapshots* fd_link_snapshots = nullptr);
 
   /**
    * Updates the any state that changes per iteration on this connection tracker.
@@ -495,6 +510,12 @@ class ConnTracker : NotCopyMoveable {
 
   int64_t GetStat(StatKey key) const { return stats_.Get(key); }
 
+  /**
+   * The number of connections this tracker stands for, when heavy-hitter sampling is on.
+   * A tracker kept with a sampling rate of 1/N has a weight of N; otherwise the weight is 1.
+   */
+  int sampling_weight() const { return 1 << sampling_shift_; }
+
   /**
    * Initializes protocol state for a protocol.
    */
@@ -535,8 +556,10 @@ class ConnTracker : NotCopyMoveable {
     using TStateType = typename TProtocolTraits::state_type;
 
     if constexpr (std::is_same_v<TFrameType, protocols::http2::Stream>) {
-      http2_client_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
-      http2_server_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
+      HTTP2StreamsContainer::CleanupStats stats =
+          http2_client_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
+      stats += http2_server_streams_.Cleanup(frame_size_limit_bytes, frame_expiry_timestamp);
+      UpdateHTTP2StreamsMetrics(stats);
     } else {
       send_data_.CleanupFrames<TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
       recv_data_.CleanupFrames<TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
@@ -648,6 +671,38 @@ class ConnTracker : NotCopyMoveable {
 
   void UpdateDataStats(const SocketDataEvent& event);
 
+  // Recycles the frame arena if nothing refers to it anymore, and makes it available to the
+  // protocol parser. Only HTTP/1.x messages are currently placed on the arena.
+  template <typename TFrameType, typename TStateType>
+  void PrepareFrameArena() {
+    if constexpr (std::is_same_v<TStateType, protocols::http::StateWrapper>) {
+      // Records stitched from the arena in the previous iteration have been consumed by now,
+      // so the arena is free once no frames from earlier iterations remain.
+      if (req_data()->Frames<TFrameType>().empty() && resp_data()->Frames<TFrameType>().empty()) {
+        frame_arena_.Reset();
+      }
+      // Long-lived frames keep the arena from being reset, so stop using the arena beyond a limit,
+      // rather than letting it grow without bound.
+      bool use_arena = frame_arena_.bytes_used() <
+                       static_cast<size_t>(FLAGS_stirling_conn_frame_arena_max_bytes);
+      protocol_state<TStateType>()->global.frame_arena = use_arena ? &frame_arena_ : nullptr;
+      UpdateFrameArenaMetrics();
+    }
+  }
+
+  // Exports the memory held by the frame arena.
+  void UpdateFrameArenaMetrics();
+
+  // Exports the outcome of a cleanup of the HTTP2 streams.
+  void UpdateHTTP2StreamsMetrics(const HTTP2StreamsContainer::CleanupStats& stats);
+
+  // Exports, and then resets, the DNS JSON cache hit and miss counts.
+  void UpdateDNSCacheMetrics(protocols::dns::State* state);
+
+  // Adds to the parse and stitch time of the protocol, for its hot path stats.
+  void RecordProcessingTime(std::chrono::nanoseconds parse_time,
+                            std::chrono::nanoseconds stitch_time);
+
   template <typename TFrameType, typename TStateType>
   void DataStreamsToFrames() {
     auto state_ptr = protocol_state<TStateType>();
@@ -690,6 +745,12 @@ class ConnTracker : NotCopyMoveable {
   uint64_t last_conn_stats_update_ = 0;
   bool final_conn_stats_reported_ = false;
 
+  // Backing memory for parsed frames; See PrepareFrameArena().
+  // Declared before the data streams and protocol state, so that it outlives the frames.
+  Arena frame_arena_;
+  // The frame arena size last reported to the metrics.
+  size_t reported_frame_arena_bytes_ = 0;
+
   // The data collected by the stream, one per direction.
   DataStream send_data_;
   DataStream recv_data_;
@@ -698,6 +759,8 @@ class ConnTracker : NotCopyMoveable {
   // instead of send and recv messages. As such, we create aliases for HTTP2.
   HTTP2StreamsContainer http2_client_streams_;
   HTTP2StreamsContainer http2_server_streams_;
+  // The HTTP2 streams size last reported to the metrics.
+  size_t reported_http2_streams_bytes_ = 0;
 
   // Access the appropriate HalfStream object for the given stream ID.
   protocols::http2::HalfStream* HalfStreamPtr(uint32_t stream_id, bool write_event);
@@ -761,6 +824,12 @@ class ConnTracker : NotCopyMoveable {
   // A pointer to the conn trackers manager, used for notifying a protocol change.
   ConnTrackersManager* manager_ = nullptr;
 
+  // Heavy-hitter sampling state, owned by ConnTrackersManager::UpdateHeavyHitterSampling().
+  // The data bytes already accounted towards the tracker's flow.
+  int64_t sampling_accounted_bytes_ = 0;
+  // The tracker is kept with a sampling rate of 2^-sampling_shift_.
+  int sampling_shift_ = 0;
+
   friend class ConnTrackersManager;
   // A subclass expose private member as public.
   friend class ConnTrackerTestDouble;
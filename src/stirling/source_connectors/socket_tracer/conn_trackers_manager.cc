@@ -18,13 +18,92 @@
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
 
+#include <algorithm>
+
+#include <absl/hash/hash.h>
+#include <absl/strings/str_cat.h>
+
+#include "src/stirling/source_connectors/socket_tracer/metrics.h"
+
 DEFINE_double(
     stirling_conn_tracker_cleanup_threshold, 0.2,
     "Percentage of trackers that are ready for destruction that will trigger a memory cleanup");
+DEFINE_double(stirling_heavy_hitter_bw_share,
+              gflags::DoubleFromEnv("PL_STIRLING_HEAVY_HITTER_BW_SHARE", 0),
+              "If positive, flows (a process and a remote address) whose share of the traced bytes "
+              "exceeds this fraction are progressively sampled, and eventually disabled.");
+DEFINE_uint32(stirling_heavy_hitter_window_iters, 25,
+              "The number of iterations over which the traced bytes of flows are compared, "
+              "before heavy-hitter sampling rates are updated.");
+DEFINE_uint32(stirling_heavy_hitter_top_n, 8,
+              "The maximum number of heavy-hitter flows that are sampled at a time.");
+DEFINE_uint64(stirling_conn_tracker_pool_buffer_bytes,
+              gflags::Uint64FromEnv("PL_STIRLING_CONN_TRACKER_POOL_BUFFER_BYTES", 64 * 1024),
+              "Data stream buffers of recycled connection trackers up to this size are kept for "
+              "reuse by new trackers. Larger ones are released.");
+DEFINE_uint64(stirling_conn_tracker_pool_max_bytes,
+              gflags::Uint64FromEnv("PL_STIRLING_CONN_TRACKER_POOL_MAX_BYTES", 32 * 1024 * 1024),
+              "The maximum total size of the data stream buffers kept for reuse by new connection "
+              "trackers.");
 
 namespace px {
 namespace stirling {
 
+//-----------------------------------------------------------------------------
+// ConnTrackerPool
+//-----------------------------------------------------------------------------
+
+ConnTrackerPool::ConnTrackerPool(size_t capacity, size_t max_buffer_bytes,
+                                 size_t max_retained_bytes)
+    : trackers_(capacity),
+      max_buffer_bytes_(max_buffer_bytes),
+      max_retained_bytes_(max_retained_bytes) {}
+
+std::unique_ptr<ConnTracker> ConnTrackerPool::Pop() {
+  std::unique_ptr<ConnTracker> tracker = trackers_.Pop();
+  ReuseBuffer(&tracker->send_data().data_buffer());
+  ReuseBuffer(&tracker->recv_data().data_buffer());
+  return tracker;
+}
+
+void ConnTrackerPool::Recycle(std::unique_ptr<ConnTracker> tracker) {
+  // The buffers are moved out before the tracker is destroyed, which leaves it with data streams
+  // that must not be used again; Nothing does, since the tracker is destroyed right after.
+  RetainBuffer(&tracker->send_data().data_buffer());
+  RetainBuffer(&tracker->recv_data().data_buffer());
+  trackers_.Recycle(std::move(tracker));
+}
+
+void ConnTrackerPool::RetainBuffer(protocols::DataStreamBuffer* buffer) {
+  buffer->Clear();
+  const size_t capacity = buffer->capacity();
+  if (capacity == 0 || capacity > max_buffer_bytes_ ||
+      retained_bytes_ + capacity > max_retained_bytes_) {
+    // Released along with the tracker.
+    return;
+  }
+  retained_bytes_ += capacity;
+  buffers_.push_back(std::move(*buffer));
+}
+
+void ConnTrackerPool::ReuseBuffer(protocols::DataStreamBuffer* buffer) {
+  if (buffers_.empty()) {
+    return;
+  }
+  retained_bytes_ -= buffers_.back().capacity();
+  *buffer = std::move(buffers_.back());
+  buffers_.pop_back();
+  min_buffers_since_shrink_ = std::min(min_buffers_since_shrink_, buffers_.size());
+}
+
+void ConnTrackerPool::Shrink() {
+  for (size_t i = 0; i < min_buffers_since_shrink_; ++i) {
+    retained_bytes_ -= buffers_.back().capacity();
+    buffers_.pop_back();
+  }
+  min_buffers_since_shrink_ = buffers_.size();
+}
+
 //-----------------------------------------------------------------------------
 // ConnTrackerGenerations
 //-----------------------------------------------------------------------------
@@ -103,13 +182,33 @@ int ConnTrackerGenerations::CleanupGenerations(ConnTrackerPool* tracker_pool) {
 
 namespace {
 
-constexpr size_t kMaxConnTrackerPoolSize = 2048;
+// How often the tracker pool releases the buffers it kept but did not need.
+constexpr int kConnTrackerPoolShrinkIters = 100;
+
+// Any flow with more than 1/kFlowBytesSketchCapacity of the traced bytes is guaranteed to be found.
+constexpr size_t kFlowBytesSketchCapacity = 128;
 
 uint64_t GetConnMapKey(uint32_t pid, int32_t fd) { return (static_cast<uint64_t>(pid) << 32) | fd; }
 
+std::string FlowKey(const ConnTracker& tracker) {
+  return absl::StrCat(tracker.conn_id().upid.pid, "/", tracker.remote_endpoint().AddrStr());
+}
+
+// Decides whether a tracker is kept at sampling rate 2^-shift.
+// The decision is a deterministic function of the conn_id, so that trackers kept at a lower rate
+// are also kept at any higher rate.
+bool KeepSampled(const ConnTracker& tracker, int shift) {
+  if (shift > ConnTrackersManager::kMaxSamplingShift) {
+    return false;
+  }
+  const uint64_t mask = (uint64_t{1} << shift) - 1;
+  return (absl::Hash<conn_id_t>{}(tracker.conn_id()) & mask) == 0;
+}
+
 }  // namespace
 
-ConnTrackersManager::ConnTrackersManager() : trackers_pool_(kMaxConnTrackerPoolSize) {}
+ConnTrackersManager::ConnTrackersManager()
+    : flow_bytes_sketch_(kFlowBytesSketchCapacity) {}
 
 ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_id) {
   const uint64_t conn_map_key = GetConnMapKey(conn_id.upid.pid, conn_id.fd);
@@ -191,9 +290,87 @@ void ConnTrackersManager::CleanupTrackers() {
     }
   }
 
+  if (++pool_shrink_iter_ >= kConnTrackerPoolShrinkIters) {
+    trackers_pool_.Shrink();
+    pool_shrink_iter_ = 0;
+  }
+
   DebugChecks();
 }
 
+void ConnTrackersManager::UpdateHeavyHitterSampling() {
+  if (FLAGS_stirling_heavy_hitter_bw_share <= 0) {
+    return;
+  }
+
+  for (ConnTracker* tracker : active_trackers_) {
+    if (tracker->state() == ConnTracker::State::kDisabled) {
+      continue;
+    }
+
+    int64_t bytes = tracker->GetStat(ConnTracker::StatKey::kBytesSent) +
+                    tracker->GetStat(ConnTracker::StatKey::kBytesRecv);
+    int64_t new_bytes = bytes - tracker->sampling_accounted_bytes_;
+    if (new_bytes <= 0) {
+      continue;
+    }
+    tracker->sampling_accounted_bytes_ = bytes;
+
+    std::string flow = FlowKey(*tracker);
+    flow_bytes_sketch_.Add(flow, new_bytes);
+
+    auto iter = flow_sampling_shifts_.find(flow);
+    int shift = (iter == flow_sampling_shifts_.end()) ? 0 : iter->second;
+    // Trackers are only ever sampled further. When the flow backs off, trackers that were kept
+    // at a lower rate keep standing for more connections.
+    if (shift <= tracker->sampling_shift_) {
+      continue;
+    }
+
+    SocketTracerMetrics& metrics = SocketTracerMetrics::GetProtocolMetrics(tracker->protocol());
+    if (KeepSampled(*tracker, shift)) {
+      if (tracker->sampling_shift_ == 0) {
+        stats_.Increment(StatKey::kHeavyHitterSampledIn);
+        metrics.heavy_hitter_sampled_in_conns.Increment();
+      }
+      tracker->sampling_shift_ = shift;
+    } else {
+      stats_.Increment(StatKey::kHeavyHitterSampledOut);
+      metrics.heavy_hitter_sampled_out_conns.Increment();
+      tracker->Disable("Sampled out as part of a heavy-hitter flow");
+    }
+  }
+
+  if (++heavy_hitter_window_iter_ < static_cast<int>(FLAGS_stirling_heavy_hitter_window_iters)) {
+    return;
+  }
+  heavy_hitter_window_iter_ = 0;
+
+  const double threshold = FLAGS_stirling_heavy_hitter_bw_share * flow_bytes_sketch_.total();
+  absl::flat_hash_map<std::string, int> shifts;
+  for (const auto& entry : flow_bytes_sketch_.TopK(FLAGS_stirling_heavy_hitter_top_n)) {
+    auto iter = flow_sampling_shifts_.find(entry.key);
+    int shift = (iter == flow_sampling_shifts_.end()) ? 0 : iter->second;
+    // Only sample further if the flow is certainly above the threshold.
+    if (entry.count - entry.error > threshold) {
+      shift = std::min(shift + 1, kMaxSamplingShift + 1);
+    } else if (entry.count < threshold / 2) {
+      shift = std::max(shift - 1, 0);
+    }
+    if (shift > 0) {
+      shifts[entry.key] = shift;
+    }
+  }
+  // Flows that are no longer among the heaviest back off as well.
+  for (const auto& [flow, shift] : flow_sampling_shifts_) {
+    if (!shifts.contains(flow) && shift > 1) {
+      shifts[flow] = shift - 1;
+    }
+  }
+  flow_sampling_shifts_ = std::move(shifts);
+  flow_bytes_sketch_.Reset();
+}
+
 void ConnTrackersManager::DebugChecks() const {
   DCHECK_EQ(stats_.Get(StatKey::kTotal),
             active_trackers_.size() + stats_.Get(StatKey::kReadyForDestruction));
@@ -28,14 +28,67 @@
 
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/utils/obj_pool.h"
+#include "src/stirling/utils/space_saving.h"
 #include "src/stirling/utils/stat_counter.h"
 
 DECLARE_double(stirling_conn_tracker_cleanup_threshold);
+DECLARE_double(stirling_heavy_hitter_bw_share);
+DECLARE_uint32(stirling_heavy_hitter_window_iters);
+DECLARE_uint32(stirling_heavy_hitter_top_n);
+DECLARE_uint64(stirling_conn_tracker_pool_buffer_bytes);
+DECLARE_uint64(stirling_conn_tracker_pool_max_bytes);
 
 namespace px {
 namespace stirling {
 
-using ConnTrackerPool = ObjPool<ConnTracker>;
+/**
+ * ConnTrackerPool recycles ConnTrackers, as well as the allocations of their data stream buffers,
+ * so that short-lived connections don't make every new tracker grow its buffers from scratch.
+ *
+ * A recycled tracker's buffers are cleared and kept, unless one is larger than max_buffer_bytes,
+ * or keeping it would put the pool over max_retained_bytes; those are released.
+ */
+class ConnTrackerPool {
+ public:
+  static constexpr size_t kDefaultCapacity = 2048;
+
+  explicit ConnTrackerPool(size_t capacity = kDefaultCapacity,
+                           size_t max_buffer_bytes = FLAGS_stirling_conn_tracker_pool_buffer_bytes,
+                           size_t max_retained_bytes = FLAGS_stirling_conn_tracker_pool_max_bytes);
+
+  /**
+   * Returns a new or recycled tracker, whose data streams reuse retained buffers if there are any.
+   */
+  std::unique_ptr<ConnTracker> Pop();
+
+  /**
+   * Submits a tracker for recycling.
+   */
+  void Recycle(std::unique_ptr<ConnTracker> tracker);
+
+  /**
+   * Releases the retained buffers that were not needed since the previous call, so that the pool
+   * gives memory back after a burst of connections.
+   */
+  void Shrink();
+
+  size_t num_retained_buffers() const { return buffers_.size(); }
+  size_t retained_bytes() const { return retained_bytes_; }
+
+ private:
+  void RetainBuffer(protocols::DataStreamBuffer* buffer);
+  void ReuseBuffer(protocols::DataStreamBuffer* buffer);
+
+  ObjPool<ConnTracker> trackers_;
+
+  const size_t max_buffer_bytes_;
+  const size_t max_retained_bytes_;
+
+  std::vector<protocols::DataStreamBuffer> buffers_;
+  size_t retained_bytes_ = 0;
+  // The fewest retained buffers since the last Shrink(); Those were never needed.
+  size_t min_buffers_since_shrink_ = 0;
+};
 
 /**
  * ConnTrackersGenerations is a container of tracker generations,
@@ -95,8 +148,14 @@ class ConnTrackersManager {
     kCreated,
     kDestroyed,
     kDestroyedGens,
+
+    kHeavyHitterSampledIn,
+    kHeavyHitterSampledOut,
   };
 
+  // Heavy-hitter sampling never goes below this rate, short of disabling the whole flow.
+  static constexpr int kMaxSamplingShift = 4;
+
   ConnTrackersManager();
 
   /**
@@ -120,6 +179,24 @@ class ConnTrackersManager {
    */
   void CleanupTrackers();
 
+  /**
+   * Detects heavy-hitter flows, and samples their connections. Call once per iteration.
+   *
+   * A flow is the traffic between a process and a remote address. Flows whose share of the traced
+   * bytes over a window exceeds --stirling_heavy_hitter_bw_share are progressively sampled:
+   * each window, the sampling rate of their new and existing connections is halved, down to
+   * 2^-kMaxSamplingShift, after which the whole flow is disabled. Sampling backs off one step each
+   * window the flow stays below half the share. Sampled out trackers are disabled.
+   */
+  void UpdateHeavyHitterSampling();
+
+  /**
+   * Returns the current sampling shift of each flow that is sampled.
+   */
+  const absl::flat_hash_map<std::string, int>& flow_sampling_shifts() const {
+    return flow_sampling_shifts_;
+  }
+
   /**
    * Returns extensive debug information about the connection trackers.
    */
@@ -149,6 +226,13 @@ class ConnTrackersManager {
   // A pool of unused trackers that can be recycled.
   // This is useful for avoiding memory reallocations.
   ConnTrackerPool trackers_pool_;
+  int pool_shrink_iter_ = 0;
+
+  // Weighs flows by their traced bytes over the current heavy-hitter window.
+  SpaceSavingSketch<std::string> flow_bytes_sketch_;
+  int heavy_hitter_window_iter_ = 0;
+  // Sampling shifts of flows that are sampled; Flows not in the map are not sampled.
+  absl::flat_hash_map<std::string, int> flow_sampling_shifts_;
 
   // Records statistics of ConnTracker for reporting and consistency check.
   utils::StatCounter<StatKey> stats_;
@@ -20,6 +20,8 @@
 
 #include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/event_generator.h"
+#include "src/stirling/testing/common.h"
 
 namespace px {
 namespace stirling {
@@ -112,6 +114,78 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+// Tests that the trackers of a flow with most of the traffic are progressively sampled out,
+// while other flows are left alone.
+TEST_F(ConnTrackersManagerTest, HeavyHitterSampling) {
+  PL_SET_FOR_SCOPE(FLAGS_stirling_heavy_hitter_bw_share, 0.5);
+  PL_SET_FOR_SCOPE(FLAGS_stirling_heavy_hitter_window_iters, 1);
+
+  constexpr uint32_t kHeavyPID = 1;
+  constexpr uint32_t kLightPID = 2;
+  constexpr int kNumHeavyConns = 32;
+
+  testing::MockClock mock_clock;
+  std::vector<std::unique_ptr<testing::EventGenerator>> event_gens;
+  std::vector<ConnTracker*> heavy_trackers;
+  ConnTracker* light_tracker = nullptr;
+  for (int fd = 0; fd <= kNumHeavyConns; ++fd) {
+    uint32_t pid = (fd == kNumHeavyConns) ? kLightPID : kHeavyPID;
+    auto& event_gen = event_gens.emplace_back(
+        std::make_unique<testing::EventGenerator>(&mock_clock, pid, fd));
+    struct socket_control_event_t conn = event_gen->InitConn();
+    ConnTracker& tracker = trackers_mgr_.GetOrCreateConnTracker(conn.conn_id);
+    tracker.AddControlEvent(conn);
+    if (pid == kHeavyPID) {
+      heavy_trackers.push_back(&tracker);
+    } else {
+      light_tracker = &tracker;
+    }
+  }
+
+  auto iterate = [&](int heavy_msg_size, int light_msg_size) {
+    for (int fd = 0; fd <= kNumHeavyConns; ++fd) {
+      int msg_size = (fd == kNumHeavyConns) ? light_msg_size : heavy_msg_size;
+      ConnTracker* tracker = (fd == kNumHeavyConns) ? light_tracker : heavy_trackers[fd];
+      tracker->AddDataEvent(
+          event_gens[fd]->InitSendEvent<kProtocolHTTP>(std::string(msg_size, 'x')));
+    }
+    trackers_mgr_.UpdateHeavyHitterSampling();
+  };
+
+  auto num_disabled = [&]() {
+    return std::count_if(heavy_trackers.begin(), heavy_trackers.end(), [](ConnTracker* tracker) {
+      return tracker->state() == ConnTracker::State::kDisabled;
+    });
+  };
+
+  // The first window detects the heavy hitter, but doesn't sample anything yet.
+  iterate(1000, 10);
+  EXPECT_EQ(num_disabled(), 0);
+  ASSERT_EQ(trackers_mgr_.flow_sampling_shifts().size(), 1);
+  EXPECT_EQ(trackers_mgr_.flow_sampling_shifts().begin()->second, 1);
+
+  // Roughly half of the heavy trackers are now sampled out.
+  iterate(1000, 10);
+  EXPECT_GT(num_disabled(), 0);
+  EXPECT_LT(num_disabled(), kNumHeavyConns);
+  EXPECT_EQ(trackers_mgr_.flow_sampling_shifts().begin()->second, 2);
+  for (ConnTracker* tracker : heavy_trackers) {
+    if (tracker->state() != ConnTracker::State::kDisabled) {
+      EXPECT_EQ(tracker->sampling_weight(), 2);
+    }
+  }
+  EXPECT_NE(light_tracker->state(), ConnTracker::State::kDisabled);
+  EXPECT_EQ(light_tracker->sampling_weight(), 1);
+
+  // Once the flow is no longer heavy, its sampling rate backs off.
+  const std::string heavy_flow =
+      absl::StrCat(kHeavyPID, "/", heavy_trackers[0]->remote_endpoint().AddrStr());
+  iterate(1, 1000);
+  EXPECT_EQ(trackers_mgr_.flow_sampling_shifts().at(heavy_flow), 1);
+  iterate(1, 1000);
+  EXPECT_FALSE(trackers_mgr_.flow_sampling_shifts().contains(heavy_flow));
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
@@ -219,5 +293,36 @@ TEST_F(ConnTrackerGenerationsTest, Basic) {
   ASSERT_NOT_OK(tracker_gens_.GetActive());
 }
 
+TEST(ConnTrackerPoolTest, RecyclesBuffers) {
+  ConnTrackerPool pool(/* capacity */ 4, /* max_buffer_bytes */ 4096,
+                       /* max_retained_bytes */ 8192);
+
+  std::unique_ptr<ConnTracker> tracker = pool.Pop();
+  tracker->send_data().data_buffer().Add(0, std::string(1000, 'a'), 0);
+  // Too large to be kept.
+  tracker->recv_data().data_buffer().Add(0, std::string(5000, 'b'), 0);
+  const size_t send_capacity = tracker->send_data().data_buffer().capacity();
+
+  pool.Recycle(std::move(tracker));
+  EXPECT_EQ(pool.num_retained_buffers(), 1);
+  EXPECT_EQ(pool.retained_bytes(), send_capacity);
+
+  tracker = pool.Pop();
+  EXPECT_EQ(pool.num_retained_buffers(), 0);
+  EXPECT_EQ(pool.retained_bytes(), 0);
+  // The recycled tracker starts out empty, but reuses the kept allocation.
+  EXPECT_TRUE(tracker->send_data().data_buffer().empty());
+  EXPECT_EQ(tracker->send_data().data_buffer().capacity(), send_capacity);
+  EXPECT_EQ(tracker->recv_data().data_buffer().capacity(), 0);
+
+  // Buffers that are not needed between two shrinks are released.
+  pool.Recycle(std::move(tracker));
+  pool.Shrink();
+  EXPECT_EQ(pool.num_retained_buffers(), 1);
+  pool.Shrink();
+  EXPECT_EQ(pool.num_retained_buffers(), 0);
+  EXPECT_EQ(pool.retained_bytes(), 0);
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -21,6 +21,9 @@
 
 #include "src/stirling/source_connectors/socket_tracer/data_stream.h"
 #include "src/stirling/source_connectors/socket_tracer/metrics.h"
+// For the specializations of protocols::PendingFrameSize().
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/kafka/parse.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/types.h"
 
 DEFINE_uint32(datastream_buffer_spike_size,
@@ -103,19 +106,45 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
 
   bool keep_processing = has_new_events_ || attempt_sync || conn_closed();
 
+  // The frame at the head is still incomplete, so parsing it again would only re-scan the bytes
+  // it already has. Gaps are left to the loop below, which drops the incomplete frame.
+  if (keep_processing && pending_frame_end_ != 0 && !attempt_sync && !conn_closed() &&
+      data_buffer_.position() == pending_frame_pos_ &&
+      data_buffer_.ContiguousHeadSize() == data_buffer_.size() &&
+      data_buffer_.position() + data_buffer_.size() < pending_frame_end_) {
+    has_new_events_ = false;
+    return;
+  }
+  pending_frame_pos_ = 0;
+  pending_frame_end_ = 0;
+
   protocols::ParseResult parse_result;
   parse_result.state = ParseState::kNeedsMoreData;
   parse_result.end_position = 0;
 
   size_t frame_bytes = 0;
 
+  // Resync only applies to the start of a contiguous run, not to chunks that continue it.
+  bool continuing_contiguous_data = false;
+
   while (keep_processing && !data_buffer_.empty()) {
-    size_t contiguous_bytes = data_buffer_.Head().size();
+    size_t contiguous_bytes = data_buffer_.ContiguousHeadSize();
 
     // Now parse the raw data.
     parse_result =
-        protocols::ParseFrames(type, &data_buffer_, &typed_messages, IsSyncRequired(), state);
-    if (contiguous_bytes != data_buffer_.size()) {
+        protocols::ParseFrames(type, &data_buffer_, &typed_messages,
+                               IsSyncRequired() && !continuing_contiguous_data, state);
+    // With a chunked DataStreamBuffer, ParseFrames() may stop on a frame boundary before reaching
+    // the end of the contiguous data. Consume what was parsed, and continue with the next chunk.
+    bool more_contiguous_data = (parse_result.state == ParseState::kSuccess ||
+                                 parse_result.state == ParseState::kIgnored) &&
+                                parse_result.end_position != 0 &&
+                                parse_result.end_position < contiguous_bytes;
+    continuing_contiguous_data = more_contiguous_data;
+    if (more_contiguous_data) {
+      data_buffer_.RemovePrefix(parse_result.end_position);
+      keep_processing = true;
+    } else if (contiguous_bytes != data_buffer_.size()) {
       // We weren't able to submit all bytes, which means we ran into a missing event.
       // We don't expect missing events to arrive in the future, so just cut our losses.
       // Drop all events up to this point, and then try to resume.
@@ -123,6 +152,7 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
       data_buffer_.Trim();
 
       keep_processing = (parse_result.state != ParseState::kEOS);
+      stat_raw_data_gaps_ += keep_processing;
     } else {
       // We had a contiguous stream, with no missing events.
       // Erase bytes that have been fully processed.
@@ -136,11 +166,20 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
 
     stat_valid_frames_ += parse_result.frame_positions.size();
     stat_invalid_frames_ += parse_result.invalid_frames;
-    stat_raw_data_gaps_ += keep_processing;
 
     frame_bytes += parse_result.frame_bytes;
   }
 
+  if (parse_result.state == ParseState::kNeedsMoreData && !data_buffer_.empty() &&
+      data_buffer_.ContiguousHeadSize() == data_buffer_.size()) {
+    size_t frame_size =
+        protocols::PendingFrameSize<TFrameType, TStateType>(type, data_buffer_.HeadChunk(), state);
+    if (frame_size > data_buffer_.size()) {
+      pending_frame_pos_ = data_buffer_.position();
+      pending_frame_end_ = pending_frame_pos_ + frame_size;
+    }
+  }
+
   // Check to see if we are blocked on parsing.
   // Note that missing events is handled separately (not considered stuck).
   bool made_progress = data_buffer_.empty() || (data_buffer_.position() != orig_pos);
@@ -192,8 +231,9 @@ template void DataStream::ProcessBytesToFrames<protocols::cass::Frame, protocols
 template void
 DataStream::ProcessBytesToFrames<protocols::pgsql::RegularMessage, protocols::pgsql::StateWrapper>(
     message_type_t type, protocols::pgsql::StateWrapper* state);
-template void DataStream::ProcessBytesToFrames<protocols::dns::Frame, protocols::NoState>(
-    message_type_t type, protocols::NoState* state);
+template void
+DataStream::ProcessBytesToFrames<protocols::dns::Frame, protocols::dns::StateWrapper>(
+    message_type_t type, protocols::dns::StateWrapper* state);
 template void DataStream::ProcessBytesToFrames<protocols::redis::Message, protocols::NoState>(
     message_type_t type, protocols::NoState* state);
 template void
@@ -206,6 +246,8 @@ template void DataStream::ProcessBytesToFrames<protocols::amqp::Frame, protocols
 void DataStream::Reset() {
   data_buffer_.Reset();
   has_new_events_ = false;
+  pending_frame_pos_ = 0;
+  pending_frame_end_ = 0;
   UpdateLastProgressTime();
 
   frames_ = std::monostate();
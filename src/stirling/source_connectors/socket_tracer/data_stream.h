@@ -310,6 +310,12 @@ class DataStream : NotCopyMoveable {
   // A copy of the parse state from the last call to ProcessToRecords().
   ParseState last_parse_state_ = ParseState::kInvalid;
 
+  // When the frame at the head of data_buffer_ is incomplete and its size is known (see
+  // protocols::PendingFrameSize()), the byte positions where it starts and ends. It isn't parsed
+  // again until data_buffer_ reaches its end.
+  size_t pending_frame_pos_ = 0;
+  size_t pending_frame_end_ = 0;
+
   // Keep track of the byte position after the last processed position, in order to measure data
   // loss.
   size_t last_processed_pos_ = 0;
@@ -20,9 +20,12 @@
 
 #include <algorithm>
 #include <random>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
+
 #include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/metrics.h"
 #include "src/stirling/source_connectors/socket_tracer/testing/event_generator.h"
@@ -129,6 +132,37 @@ TEST_F(DataStreamTest, StuckTemporarily) {
   EXPECT_EQ(0, SocketTracerMetrics::GetProtocolMetrics(kProtocolHTTP).data_loss_bytes.Value());
 }
 
+TEST_F(DataStreamTest, PendingFrameCompletedIncrementally) {
+  std::string body(1000, 'x');
+  std::string resp = absl::StrCat("HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n", body);
+  std::unique_ptr<SocketDataEvent> resp0a =
+      event_gen_.InitRecvEvent<kProtocolHTTP>(resp.substr(0, 100));
+  std::unique_ptr<SocketDataEvent> resp0b =
+      event_gen_.InitRecvEvent<kProtocolHTTP>(resp.substr(100, 500));
+  std::unique_ptr<SocketDataEvent> resp0c =
+      event_gen_.InitRecvEvent<kProtocolHTTP>(resp.substr(600));
+  protocols::http::StateWrapper state{};
+
+  DataStream stream;
+  stream.set_protocol(kProtocolHTTP);
+
+  stream.AddData(std::move(resp0a));
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kResponse, &state);
+  EXPECT_THAT(stream.Frames<http::Message>(), IsEmpty());
+
+  // The response is still incomplete, so the buffered bytes are left alone.
+  stream.AddData(std::move(resp0b));
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kResponse, &state);
+  EXPECT_THAT(stream.Frames<http::Message>(), IsEmpty());
+
+  stream.AddData(std::move(resp0c));
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kResponse, &state);
+  const auto& responses = stream.Frames<http::Message>();
+  ASSERT_THAT(responses, SizeIs(1));
+  EXPECT_EQ(responses[0].body, body);
+  EXPECT_TRUE(stream.data_buffer().empty());
+}
+
 TEST_F(DataStreamTest, StuckTooLong) {
   std::unique_ptr<SocketDataEvent> req0a =
       event_gen_.InitSendEvent<kProtocolHTTP>(kHTTPReq0.substr(0, kHTTPReq0.length() - 10));
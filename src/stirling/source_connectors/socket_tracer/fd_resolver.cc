@@ -18,7 +18,10 @@
 
 #include "src/stirling/source_connectors/socket_tracer/fd_resolver.h"
 
+#include <unistd.h>
+
 #include <chrono>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/common/fs/inode_utils.h"
@@ -26,9 +29,60 @@
 namespace px {
 namespace stirling {
 
+FDLinkSnapshots::FDLinkSnapshots(system::ProcParser* proc_parser, int min_lookups_for_snapshot)
+    : proc_parser_(proc_parser), min_lookups_for_snapshot_(min_lookups_for_snapshot) {}
+
+void FDLinkSnapshots::NewIteration() {
+  for (const auto& [pid, snapshot] : pids_) {
+    if (snapshot.dir_fd >= 0) {
+      close(snapshot.dir_fd);
+    }
+  }
+  pids_.clear();
+}
+
+Status FDLinkSnapshots::ReadFDLink(int pid, int fd, std::string* out,
+                                   std::chrono::time_point<std::chrono::steady_clock>* read_time) {
+  PIDSnapshot& snapshot = pids_[pid];
+  ++snapshot.num_lookups;
+  if (snapshot.dir_fd < 0 && snapshot.num_lookups == min_lookups_for_snapshot_) {
+    snapshot.list_time = std::chrono::steady_clock::now();
+    std::vector<int32_t> fds;
+    auto dir_fd_or = proc_parser_->OpenProcPIDFDDir(pid, &fds);
+    if (dir_fd_or.ok()) {
+      snapshot.dir_fd = dir_fd_or.ValueOrDie();
+      snapshot.fds.insert(fds.begin(), fds.end());
+      ++num_snapshots_;
+    }
+  }
+
+  if (snapshot.dir_fd < 0) {
+    *read_time = std::chrono::steady_clock::now();
+    return proc_parser_->ReadProcPIDFDLink(pid, fd, out);
+  }
+  // The FD is looked up as of the listing, so that is the earliest time it is known to be open.
+  *read_time = snapshot.list_time;
+  if (!snapshot.fds.contains(fd)) {
+    return error::NotFound("FD $0 of PID $1 is not open.", fd, pid);
+  }
+  return system::ProcParser::ReadProcPIDFDLinkAt(snapshot.dir_fd, fd, out);
+}
+
 FDResolver::FDResolver(system::ProcParser* proc_parser, int pid, int fd)
     : proc_parser_(proc_parser), pid_(pid), fd_(fd) {}
 
+FDResolver::FDResolver(FDLinkSnapshots* snapshots, int pid, int fd)
+    : proc_parser_(snapshots->proc_parser()), snapshots_(snapshots), pid_(pid), fd_(fd) {}
+
+Status FDResolver::ReadFDLink(std::string* out,
+                              std::chrono::time_point<std::chrono::steady_clock>* read_time) {
+  if (snapshots_ != nullptr) {
+    return snapshots_->ReadFDLink(pid_, fd_, out, read_time);
+  }
+  *read_time = std::chrono::steady_clock::now();
+  return proc_parser_->ReadProcPIDFDLink(pid_, fd_, out);
+}
+
 bool FDResolver::Setup() {
   // Record some information about the FD.
   // This marks the starting point at which we reliably know the connection.
@@ -36,7 +90,9 @@ bool FDResolver::Setup() {
   // the hope is that we can recover the socket information on the next iteration,
   // if the connection appears to be stable.
 
-  Status s = proc_parser_->ReadProcPIDFDLink(pid_, fd_, &fd_link_);
+  // The window starts after the read below, rather than at read_time.
+  std::chrono::time_point<std::chrono::steady_clock> read_time;
+  Status s = ReadFDLink(&fd_link_, &read_time);
   if (!s.ok()) {
     VLOG(2) << absl::Substitute("Can't set-up connection inference [msg=$0].", s.msg());
     active_ = false;
@@ -55,14 +111,14 @@ bool FDResolver::Update() {
   ECHECK(active_) << "FDResolver must be in active state.";
   ECHECK(!fd_link_.empty()) << "Candidate FD link should not be empty";
 
-  // Record the timestamp. Must be done before reading /proc,
+  // The timestamp is recorded before reading /proc,
   // to avoid a race where we find the /proc FD entry, then the FD closes, then we grab the
   // timestamp. This would result in having an incorrect window of time during which the FD was
   // valid.
-  std::chrono::time_point<std::chrono::steady_clock> timestamp = std::chrono::steady_clock::now();
+  std::chrono::time_point<std::chrono::steady_clock> timestamp;
 
   std::string current_fd_link;
-  Status s = proc_parser_->ReadProcPIDFDLink(pid_, fd_, &current_fd_link);
+  Status s = ReadFDLink(&current_fd_link, &timestamp);
   if (!s.ok()) {
     VLOG(2) << "Can't infer remote endpoint. FD is not accessible.";
     active_ = false;
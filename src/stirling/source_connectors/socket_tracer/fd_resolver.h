@@ -24,12 +24,70 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/system/proc_parser.h"
 #include "src/common/system/socket_info.h"
 
 namespace px {
 namespace stirling {
 
+/**
+ * FDLinkSnapshots reads the /proc/<pid>/fd links for the FDResolvers of an iteration.
+ *
+ * Once a process has had a few of its FDs looked up in an iteration, its FD directory is opened
+ * and listed once, and shared by the rest of its lookups in the iteration: FDs that are no longer
+ * open are answered from the listing without a syscall, and the links of open ones are read
+ * relative to the open directory. A burst of connections in one process then costs one directory
+ * listing, rather than a full /proc path walk per connection, most of which fail for connections
+ * that have already closed.
+ *
+ * The snapshots only live for one iteration, during which no BPF open or close events are
+ * processed, so they never go stale.
+ */
+class FDLinkSnapshots {
+ public:
+  /**
+   * @param proc_parser Pointer to a /proc parser which is used to read the FD info.
+   * @param min_lookups_for_snapshot The number of lookups of a process's FDs within an iteration
+   * after which its FD directory is snapshotted.
+   */
+  FDLinkSnapshots(system::ProcParser* proc_parser, int min_lookups_for_snapshot);
+  ~FDLinkSnapshots() { NewIteration(); }
+
+  /**
+   * Drops the snapshots of the previous iteration. Must be called after the BPF events of the
+   * iteration have been processed, and before its FDs are looked up.
+   */
+  void NewIteration();
+
+  /**
+   * Reads the link of a FD, from the snapshot of its process if there is one.
+   *
+   * @param read_time Set to a time before the FD was found to be open.
+   */
+  Status ReadFDLink(int pid, int fd, std::string* out,
+                    std::chrono::time_point<std::chrono::steady_clock>* read_time);
+
+  system::ProcParser* proc_parser() const { return proc_parser_; }
+  int64_t num_snapshots() const { return num_snapshots_; }
+
+ private:
+  struct PIDSnapshot {
+    int num_lookups = 0;
+    // The directory of the process's FDs, or -1 if it hasn't been snapshotted (or failed to).
+    int dir_fd = -1;
+    absl::flat_hash_set<int> fds;
+    std::chrono::time_point<std::chrono::steady_clock> list_time;
+  };
+
+  system::ProcParser* proc_parser_;
+  const int min_lookups_for_snapshot_;
+  absl::flat_hash_map<int, PIDSnapshot> pids_;
+  int64_t num_snapshots_ = 0;
+};
+
 /**
  * SocketResolver tries to determine the socket inode number of a given a PID and FD.
  *
@@ -51,6 +109,12 @@ class FDResolver {
    */
   FDResolver(system::ProcParser* proc_parser, int pid, int fd);
 
+  /**
+   * Creates a SocketResolver for the PID and FD, that reads the FD info through the snapshots of
+   * the current iteration.
+   */
+  FDResolver(FDLinkSnapshots* snapshots, int pid, int fd);
+
   /**
    * Collects the first sample from Linux, to begin the tracking process.
    */
@@ -85,7 +149,12 @@ class FDResolver {
   }
 
  private:
+  // Reads the FD link, and sets read_time to a time before it was read.
+  Status ReadFDLink(std::string* out,
+                    std::chrono::time_point<std::chrono::steady_clock>* read_time);
+
   system::ProcParser* proc_parser_;
+  FDLinkSnapshots* snapshots_ = nullptr;
   int pid_;
   int fd_;
 
@@ -187,5 +187,35 @@ TEST_F(FDResolverTest, NewSocketSameFD) {
   EXPECT_FALSE(fd_link.has_value());
 }
 
+TEST_F(FDResolverTest, SharedSnapshots) {
+  system::TCPSocket socket;
+  system::TCPSocket socket2;
+  int pid = getpid();
+
+  FDLinkSnapshots snapshots(proc_parser_.get(), /* min_lookups_for_snapshot */ 1);
+  snapshots.NewIteration();
+
+  auto resolver = FDResolver(&snapshots, pid, socket.sockfd());
+  auto resolver2 = FDResolver(&snapshots, pid, socket2.sockfd());
+  ASSERT_TRUE(resolver.Setup());
+  ASSERT_TRUE(resolver2.Setup());
+  // Both lookups are answered from one listing of the process's FD directory.
+  EXPECT_EQ(snapshots.num_snapshots(), 1);
+
+  auto t = std::chrono::steady_clock::now();
+  socket2.Close();
+
+  // The snapshot is only valid within an iteration.
+  snapshots.NewIteration();
+  EXPECT_TRUE(resolver.Update());
+  EXPECT_FALSE(resolver2.Update());
+  EXPECT_EQ(snapshots.num_snapshots(), 2);
+
+  EXPECT_TRUE(resolver.InferFDLink(t).has_value());
+  EXPECT_FALSE(resolver2.InferFDLink(t).has_value());
+
+  socket.Close();
+}
+
 }  // namespace stirling
 }  // namespace px
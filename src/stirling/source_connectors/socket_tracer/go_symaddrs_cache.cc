@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_symaddrs_cache.h"
+
+#include <unistd.h>
+
+#include <cstring>
+
+#include "src/common/fs/fs_wrapper.h"
+
+DEFINE_string(stirling_go_symaddrs_cache_dir,
+              gflags::StringFromEnv("PL_GO_SYMADDRS_CACHE_DIR", ""),
+              "Directory in which the symbol addresses of Go binaries are kept, keyed by build ID, "
+              "so that they are not resolved from DWARF again after a restart. "
+              "Not used if empty.");
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Bump this whenever the meaning of any of the symaddrs structs changes without their size
+// changing, so that entries written by older versions are ignored.
+constexpr uint32_t kCacheVersion = 1;
+
+// The on-disk layout of an entry. It is only ever read back by the same build architecture.
+struct CacheEntry {
+  uint32_t version = kCacheVersion;
+  uint32_t common_size = sizeof(struct go_common_symaddrs_t);
+  uint32_t tls_size = sizeof(struct go_tls_symaddrs_t);
+  uint32_t http2_size = sizeof(struct go_http2_symaddrs_t);
+
+  uint8_t probeable = 0;
+  uint8_t has_tls = 0;
+  uint8_t has_http2 = 0;
+  uint8_t http2_resolved = 0;
+
+  struct go_common_symaddrs_t common = {};
+  struct go_tls_symaddrs_t tls = {};
+  struct go_http2_symaddrs_t http2 = {};
+};
+
+}  // namespace
+
+std::string GoSymAddrsCacheKey(obj_tools::ElfReader* elf_reader) {
+  // Go only writes a GNU build-id when linking externally, but always writes its own build ID.
+  std::string build_id = elf_reader->GoBuildID();
+  if (!build_id.empty()) {
+    return absl::StrCat("go-", build_id);
+  }
+  build_id = elf_reader->BuildID();
+  if (!build_id.empty()) {
+    return absl::StrCat("gnu-", build_id);
+  }
+  return "";
+}
+
+std::optional<GoBinarySymAddrs> LookupGoSymAddrs(const std::filesystem::path& cache_dir,
+                                                 const std::string& key) {
+  StatusOr<std::string> contents_or = ReadFileToString(cache_dir / key);
+  if (!contents_or.ok()) {
+    return std::nullopt;
+  }
+  const std::string& contents = contents_or.ValueOrDie();
+  if (contents.size() != sizeof(CacheEntry)) {
+    return std::nullopt;
+  }
+
+  CacheEntry entry;
+  std::memcpy(&entry, contents.data(), sizeof(CacheEntry));
+  const CacheEntry expected;
+  if (entry.version != expected.version || entry.common_size != expected.common_size ||
+      entry.tls_size != expected.tls_size || entry.http2_size != expected.http2_size) {
+    return std::nullopt;
+  }
+
+  GoBinarySymAddrs symaddrs;
+  symaddrs.probeable = entry.probeable;
+  symaddrs.common_symaddrs = entry.common;
+  if (entry.has_tls) {
+    symaddrs.tls_symaddrs = entry.tls;
+  }
+  if (entry.has_http2) {
+    symaddrs.http2_symaddrs = entry.http2;
+  }
+  symaddrs.http2_resolved = entry.http2_resolved;
+  return symaddrs;
+}
+
+Status StoreGoSymAddrs(const std::filesystem::path& cache_dir, const std::string& key,
+                       const GoBinarySymAddrs& symaddrs) {
+  CacheEntry entry;
+  entry.probeable = symaddrs.probeable;
+  entry.common = symaddrs.common_symaddrs;
+  if (symaddrs.tls_symaddrs.has_value()) {
+    entry.has_tls = 1;
+    entry.tls = symaddrs.tls_symaddrs.value();
+  }
+  if (symaddrs.http2_symaddrs.has_value()) {
+    entry.has_http2 = 1;
+    entry.http2 = symaddrs.http2_symaddrs.value();
+  }
+  entry.http2_resolved = symaddrs.http2_resolved;
+
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(cache_dir));
+
+  // Binaries are scanned in parallel, so the temporary file must be unique to this writer.
+  const std::filesystem::path path = cache_dir / key;
+  std::filesystem::path tmp_path = path;
+  tmp_path += absl::StrCat(".", getpid(), ".", gettid(), ".tmp");
+  PL_RETURN_IF_ERROR(WriteFileFromString(
+      tmp_path, std::string_view(reinterpret_cast<const char*>(&entry), sizeof(entry))));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Could not move $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace stirling
+}  // namespace px
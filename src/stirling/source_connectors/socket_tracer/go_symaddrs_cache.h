@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+
+DECLARE_string(stirling_go_symaddrs_cache_dir);
+
+namespace px {
+namespace stirling {
+
+/**
+ * The symbol addresses of a Go binary, as resolved from its DWARF information.
+ */
+struct GoBinarySymAddrs {
+  // False if the binary lacks the symbols required for Go tracing.
+  bool probeable = false;
+
+  struct go_common_symaddrs_t common_symaddrs = {};
+  std::optional<struct go_tls_symaddrs_t> tls_symaddrs;
+  std::optional<struct go_http2_symaddrs_t> http2_symaddrs;
+
+  // Whether http2_symaddrs was resolved at all, since that only happens with HTTP2 tracing.
+  bool http2_resolved = false;
+};
+
+/**
+ * Returns the key under which the symbol addresses of the binary are cached. The key is derived
+ * from the build ID of the binary, so that all processes (and containers) running the same build
+ * share it. Returns an empty string if the binary has no build ID, and so cannot be cached.
+ */
+std::string GoSymAddrsCacheKey(obj_tools::ElfReader* elf_reader);
+
+/**
+ * Reads the symbol addresses cached under the key in cache_dir.
+ * Returns std::nullopt if there are none, or if they were written by an incompatible version.
+ */
+std::optional<GoBinarySymAddrs> LookupGoSymAddrs(const std::filesystem::path& cache_dir,
+                                                 const std::string& key);
+
+/**
+ * Caches the symbol addresses under the key in cache_dir. The entry is written to a temporary
+ * file, and then renamed, so concurrent readers and writers never see a partial entry.
+ */
+Status StoreGoSymAddrs(const std::filesystem::path& cache_dir, const std::string& key,
+                       const GoBinarySymAddrs& symaddrs);
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_symaddrs_cache.h"
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+TEST(GoSymAddrsCacheTest, StoreAndLookup) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path cache_dir = tmp_dir.path() / "go_symaddrs";
+
+  EXPECT_FALSE(LookupGoSymAddrs(cache_dir, "go-1234").has_value());
+
+  GoBinarySymAddrs symaddrs;
+  symaddrs.probeable = true;
+  symaddrs.common_symaddrs.net_TCPConn = 0x1234;
+  symaddrs.common_symaddrs.FD_Sysfd_offset = 16;
+  symaddrs.tls_symaddrs = go_tls_symaddrs_t{};
+  symaddrs.tls_symaddrs->Write_b_loc.offset = 16;
+  symaddrs.http2_resolved = true;
+  ASSERT_OK(StoreGoSymAddrs(cache_dir, "go-1234", symaddrs));
+
+  std::optional<GoBinarySymAddrs> cached = LookupGoSymAddrs(cache_dir, "go-1234");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_TRUE(cached->probeable);
+  EXPECT_EQ(cached->common_symaddrs.net_TCPConn, 0x1234);
+  EXPECT_EQ(cached->common_symaddrs.FD_Sysfd_offset, 16);
+  ASSERT_TRUE(cached->tls_symaddrs.has_value());
+  EXPECT_EQ(cached->tls_symaddrs->Write_b_loc.offset, 16);
+  EXPECT_FALSE(cached->http2_symaddrs.has_value());
+  EXPECT_TRUE(cached->http2_resolved);
+
+  // Other builds are not affected.
+  EXPECT_FALSE(LookupGoSymAddrs(cache_dir, "go-5678").has_value());
+}
+
+TEST(GoSymAddrsCacheTest, IgnoresCorruptEntries) {
+  px::testing::TempDir tmp_dir;
+  ASSERT_OK(WriteFileFromString(tmp_dir.path() / "go-1234", "not a cache entry"));
+  EXPECT_FALSE(LookupGoSymAddrs(tmp_dir.path(), "go-1234").has_value());
+}
+
+}  // namespace stirling
+}  // namespace px
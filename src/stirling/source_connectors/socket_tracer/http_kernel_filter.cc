@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/http_kernel_filter.h"
+
+#include <limits>
+#include <utility>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+
+namespace px {
+namespace stirling {
+
+Status ValidateHTTPFilterRequest(std::string_view request) {
+  // BPF zero-terminates the key after the match, so the match itself must be shorter than the key.
+  if (request.empty() || request.size() >= HTTP_FILTER_KEY_SIZE) {
+    return error::InvalidArgument("HTTP filter request must have 1 to $0 characters, got '$1'.",
+                                  HTTP_FILTER_KEY_SIZE - 1, request);
+  }
+
+  std::string_view::size_type method_end = request.find(' ');
+  if (method_end == 0) {
+    return error::InvalidArgument("HTTP filter request '$0' has no method.", request);
+  }
+  if (method_end == std::string_view::npos) {
+    return Status::OK();
+  }
+
+  std::string_view path = request.substr(method_end + 1);
+  if (path.empty() || path[0] != '/' || path.substr(1).find_first_of(" /?") != path.npos) {
+    return error::InvalidArgument(
+        "HTTP filter request '$0' must have a path with a single segment, like '/healthz'.",
+        request);
+  }
+  return Status::OK();
+}
+
+namespace {
+
+StatusOr<http_filter_action_t> ParseAction(std::string_view action) {
+  if (action == "drop") {
+    return kHTTPFilterActionDrop;
+  }
+  if (action == "truncate") {
+    return kHTTPFilterActionTruncate;
+  }
+  return error::InvalidArgument("Unknown HTTP filter action '$0'.", action);
+}
+
+StatusOr<uint32_t> ParseID(std::string_view value, uint32_t max) {
+  uint32_t id;
+  if (!absl::SimpleAtoi(value, &id) || id > max) {
+    return error::InvalidArgument("Invalid HTTP filter value '$0'.", value);
+  }
+  return id;
+}
+
+}  // namespace
+
+StatusOr<std::vector<HTTPKernelFilter>> ParseHTTPKernelFilters(std::string_view spec) {
+  std::vector<HTTPKernelFilter> filters;
+
+  for (std::string_view entry : absl::StrSplit(spec, ';', absl::SkipWhitespace())) {
+    entry = absl::StripAsciiWhitespace(entry);
+    std::vector<std::string_view> action_and_filter = absl::StrSplit(entry, absl::MaxSplits(':', 1));
+    std::vector<std::string_view> type_and_value =
+        absl::StrSplit(action_and_filter.back(), absl::MaxSplits('=', 1));
+    if (action_and_filter.size() != 2 || type_and_value.size() != 2) {
+      return error::InvalidArgument("HTTP filter '$0' is not of the form <action>:<type>=<value>.",
+                                    entry);
+    }
+
+    HTTPKernelFilter filter;
+    PL_ASSIGN_OR_RETURN(filter.action, ParseAction(action_and_filter[0]));
+
+    std::string_view type = type_and_value[0];
+    std::string_view value = type_and_value[1];
+    if (type == "pid") {
+      filter.type = HTTPKernelFilter::Type::kTGID;
+      PL_ASSIGN_OR_RETURN(filter.id, ParseID(value, std::numeric_limits<uint32_t>::max()));
+    } else if (type == "port") {
+      filter.type = HTTPKernelFilter::Type::kPort;
+      PL_ASSIGN_OR_RETURN(filter.id, ParseID(value, std::numeric_limits<uint16_t>::max()));
+    } else if (type == "request") {
+      filter.type = HTTPKernelFilter::Type::kRequest;
+      PL_RETURN_IF_ERROR(ValidateHTTPFilterRequest(value));
+      filter.request = std::string(value);
+    } else {
+      return error::InvalidArgument("Unknown HTTP filter type '$0'.", type);
+    }
+
+    filters.push_back(std::move(filter));
+  }
+
+  return filters;
+}
+
+}  // namespace stirling
+}  // namespace px
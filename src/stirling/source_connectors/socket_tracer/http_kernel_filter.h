@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
+
+namespace px {
+namespace stirling {
+
+/**
+ * A filter of the in-kernel HTTP filter tables.
+ */
+struct HTTPKernelFilter {
+  enum class Type {
+    kTGID,
+    kPort,
+    kRequest,
+  };
+
+  Type type;
+  http_filter_action_t action;
+
+  // The tgid or port, for kTGID and kPort filters.
+  uint32_t id = 0;
+
+  // The request method and optional first path segment, for kRequest filters.
+  std::string request;
+};
+
+/**
+ * Checks that a request filter can be matched by BPF: a method, optionally followed by a space and
+ * a single path segment, e.g. "GET /healthz", which fits in HTTP_FILTER_KEY_SIZE bytes.
+ */
+Status ValidateHTTPFilterRequest(std::string_view request);
+
+/**
+ * Parses a list of filters of the form <action>:<type>=<value>, separated by ';'.
+ * The action is one of drop or truncate, and the type is one of pid, port or request.
+ * For example: "drop:port=9090;truncate:request=GET /metrics".
+ */
+StatusOr<std::vector<HTTPKernelFilter>> ParseHTTPKernelFilters(std::string_view spec);
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/http_kernel_filter.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::AllOf;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+auto FilterIs(HTTPKernelFilter::Type type, http_filter_action_t action) {
+  return AllOf(Field(&HTTPKernelFilter::type, type), Field(&HTTPKernelFilter::action, action));
+}
+
+TEST(ValidateHTTPFilterRequestTest, AcceptsMethodAndSingleSegment) {
+  EXPECT_OK(ValidateHTTPFilterRequest("OPTIONS"));
+  EXPECT_OK(ValidateHTTPFilterRequest("GET /"));
+  EXPECT_OK(ValidateHTTPFilterRequest("GET /healthz"));
+
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest(""));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest(" /healthz"));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest("GET "));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest("GET healthz"));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest("GET /api/v1"));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest("GET /healthz?verbose"));
+  EXPECT_NOT_OK(ValidateHTTPFilterRequest("GET /abcdefghijklmnopqrstuvwxyz0123"));
+}
+
+TEST(ParseHTTPKernelFiltersTest, Empty) {
+  ASSERT_OK_AND_ASSIGN(std::vector<HTTPKernelFilter> filters, ParseHTTPKernelFilters(""));
+  EXPECT_THAT(filters, IsEmpty());
+}
+
+TEST(ParseHTTPKernelFiltersTest, AllTypes) {
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<HTTPKernelFilter> filters,
+      ParseHTTPKernelFilters("drop:pid=1234; truncate:port=9090;drop:request=GET /healthz"));
+  EXPECT_THAT(filters,
+              ElementsAre(FilterIs(HTTPKernelFilter::Type::kTGID, kHTTPFilterActionDrop),
+                          FilterIs(HTTPKernelFilter::Type::kPort, kHTTPFilterActionTruncate),
+                          FilterIs(HTTPKernelFilter::Type::kRequest, kHTTPFilterActionDrop)));
+  EXPECT_EQ(filters[0].id, 1234);
+  EXPECT_EQ(filters[1].id, 9090);
+  EXPECT_EQ(filters[2].request, "GET /healthz");
+}
+
+TEST(ParseHTTPKernelFiltersTest, InvalidFilters) {
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop:port"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("sample:port=80"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop:cgroup=80"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop:port=65536"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop:pid=-1"));
+  EXPECT_NOT_OK(ParseHTTPKernelFilters("drop:request=GET /api/v1"));
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -146,6 +146,58 @@ TEST_F(GoHTTPTraceTest, LargePostMessage) {
               131096);
 }
 
+class HTTPKernelFilterTest : public GoHTTPTraceTest {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_enable_http_kernel_filter = true;
+    GoHTTPTraceTest::SetUp();
+  }
+
+  void TearDown() override {
+    GoHTTPTraceTest::TearDown();
+    FLAGS_stirling_enable_http_kernel_filter = false;
+  }
+
+  // Returns the number of HTTP records traced for the server after a GET request.
+  size_t NumServerRecordsForGet() {
+    StartTransferDataThread();
+    go_http_fixture_.LaunchGetClient();
+    StopTransferDataThread();
+
+    std::vector<TaggedRecordBatch> tablets = ConsumeRecords(kHTTPTableNum);
+    if (tablets.empty()) {
+      return 0;
+    }
+    return testing::FindRecordIdxMatchesPID(tablets[0].records, kHTTPUPIDIdx,
+                                            go_http_fixture_.server_pid())
+        .size();
+  }
+
+  SocketTraceConnector* connector() { return static_cast<SocketTraceConnector*>(source_.get()); }
+};
+
+TEST_F(HTTPKernelFilterTest, NoMatchingFilter) {
+  ASSERT_OK(connector()->UpdateBPFHTTPFilterRequest("POST", kHTTPFilterActionDrop));
+  EXPECT_EQ(NumServerRecordsForGet(), 1);
+}
+
+TEST_F(HTTPKernelFilterTest, DropByTGID) {
+  ASSERT_OK(
+      connector()->UpdateBPFHTTPFilterTGID(go_http_fixture_.server_pid(), kHTTPFilterActionDrop));
+  EXPECT_EQ(NumServerRecordsForGet(), 0);
+}
+
+TEST_F(HTTPKernelFilterTest, DropByRequest) {
+  ASSERT_OK(connector()->UpdateBPFHTTPFilterRequest("GET", kHTTPFilterActionDrop));
+  EXPECT_EQ(NumServerRecordsForGet(), 0);
+}
+
+TEST_F(HTTPKernelFilterTest, RemovedFilter) {
+  ASSERT_OK(connector()->UpdateBPFHTTPFilterRequest("GET", kHTTPFilterActionDrop));
+  ASSERT_OK(connector()->UpdateBPFHTTPFilterRequest("GET", kHTTPFilterActionNone));
+  EXPECT_EQ(NumServerRecordsForGet(), 1);
+}
+
 struct TraceRoleTestParam {
   endpoint_role_t role;
   size_t client_records_count;
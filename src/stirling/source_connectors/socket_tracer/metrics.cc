@@ -20,6 +20,8 @@
 #include <string>
 #include <unordered_map>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
 #include <magic_enum.hpp>
 
 #include "src/stirling/source_connectors/socket_tracer/metrics.h"
@@ -36,22 +38,77 @@ SocketTracerMetrics::SocketTracerMetrics(prometheus::Registry* registry,
                     "successfully parsed.")
               .Register(*registry)
               .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
-      conn_stats_bytes(prometheus::BuildCounter()
-                           .Name("conn_stats_bytes")
-                           .Help("Total bytes of data tracked by conn stats for this protocol.")
-                           .Register(*registry)
-                           .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})) {}
+      conn_stats_bytes(&prometheus::BuildCounter()
+                            .Name("conn_stats_bytes")
+                            .Help("Total bytes of data tracked by conn stats for this protocol.")
+                            .Register(*registry)
+                            .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      frame_arena_bytes(
+          prometheus::BuildGauge()
+              .Name("frame_arena_bytes")
+              .Help("Bytes of memory held by connection tracker frame arenas for this protocol.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      heavy_hitter_sampled_in_conns(
+          prometheus::BuildCounter()
+              .Name("heavy_hitter_sampled_in_conns")
+              .Help("Connections of heavy-hitter flows that were kept by sampling, "
+                    "for this protocol.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      heavy_hitter_sampled_out_conns(
+          prometheus::BuildCounter()
+              .Name("heavy_hitter_sampled_out_conns")
+              .Help("Connections of heavy-hitter flows that were disabled by sampling, "
+                    "for this protocol.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      http2_streams_expired(
+          prometheus::BuildCounter()
+              .Name("http2_streams_expired")
+              .Help("HTTP2 streams dropped for having no activity within the expiry duration.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      http2_streams_evicted(
+          prometheus::BuildCounter()
+              .Name("http2_streams_evicted")
+              .Help("Least recently active HTTP2 streams dropped to stay within the memory budget.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      http2_streams_bytes(
+          prometheus::BuildGauge()
+              .Name("http2_streams_bytes")
+              .Help("Bytes of HTTP2 stream state held by connection trackers.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      dns_json_cache_hits(
+          prometheus::BuildCounter()
+              .Name("dns_json_cache_hits")
+              .Help("DNS queries and answers whose JSON was found in the connection's cache.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})),
+      dns_json_cache_misses(
+          prometheus::BuildCounter()
+              .Name("dns_json_cache_misses")
+              .Help("DNS queries and answers whose JSON had to be built.")
+              .Register(*registry)
+              .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})) {}
 
 namespace {
-std::unordered_map<traffic_protocol_t, std::unique_ptr<SocketTracerMetrics>> g_protocol_metrics;
+// Metrics are looked up from the socket tracer transfer threads, so access is guarded.
+absl::Mutex g_protocol_metrics_mu;
+std::unordered_map<traffic_protocol_t, std::unique_ptr<SocketTracerMetrics>> g_protocol_metrics
+    ABSL_GUARDED_BY(g_protocol_metrics_mu);
 
-void ResetProtocolMetrics(traffic_protocol_t protocol) {
+void ResetProtocolMetrics(traffic_protocol_t protocol)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(g_protocol_metrics_mu) {
   g_protocol_metrics.insert_or_assign(
       protocol, std::make_unique<SocketTracerMetrics>(&GetMetricsRegistry(), protocol));
 }
 }  // namespace
 
 SocketTracerMetrics& SocketTracerMetrics::GetProtocolMetrics(traffic_protocol_t protocol) {
+  absl::MutexLock lock(&g_protocol_metrics_mu);
   if (g_protocol_metrics.find(protocol) == g_protocol_metrics.end()) {
     ResetProtocolMetrics(protocol);
   }
@@ -59,6 +116,7 @@ SocketTracerMetrics& SocketTracerMetrics::GetProtocolMetrics(traffic_protocol_t
 }
 
 void SocketTracerMetrics::TestOnlyResetProtocolMetrics(traffic_protocol_t protocol) {
+  absl::MutexLock lock(&g_protocol_metrics_mu);
   ResetProtocolMetrics(protocol);
 }
 
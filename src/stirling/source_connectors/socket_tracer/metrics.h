@@ -19,9 +19,13 @@
 #pragma once
 
 #include <prometheus/counter.h>
+#include <prometheus/gauge.h>
 #include <prometheus/registry.h>
 
+#include <atomic>
+
 #include "src/common/metrics/metrics.h"
+#include "src/common/metrics/sharded_metrics.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
 
 namespace px {
@@ -30,7 +34,22 @@ namespace stirling {
 struct SocketTracerMetrics {
   SocketTracerMetrics(prometheus::Registry* registry, traffic_protocol_t protocol);
   prometheus::Counter& data_loss_bytes;
-  prometheus::Counter& conn_stats_bytes;
+  // Incremented for every conn stats event, so it is sharded to keep the transfer threads from
+  // contending on it.
+  metrics::ShardedCounter conn_stats_bytes;
+  prometheus::Gauge& frame_arena_bytes;
+  prometheus::Counter& heavy_hitter_sampled_in_conns;
+  prometheus::Counter& heavy_hitter_sampled_out_conns;
+  prometheus::Counter& http2_streams_expired;
+  prometheus::Counter& http2_streams_evicted;
+  prometheus::Gauge& http2_streams_bytes;
+  prometheus::Counter& dns_json_cache_hits;
+  prometheus::Counter& dns_json_cache_misses;
+
+  // Time spent parsing frames and stitching them into records, since the socket tracer last
+  // reported them as hot path stats.
+  std::atomic<uint64_t> parse_ns{0};
+  std::atomic<uint64_t> stitch_ns{0};
 
   static SocketTracerMetrics& GetProtocolMetrics(traffic_protocol_t protocol);
 
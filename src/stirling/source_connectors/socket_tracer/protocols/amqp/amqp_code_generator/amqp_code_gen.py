@@ -56,9 +56,9 @@ class FieldType(Enum):
             FieldType.short: "uint16_t",
             FieldType.long: "uint32_t",
             FieldType.longlong: "uint64_t",
-            FieldType.shortstr: "std::string",
-            FieldType.longstr: "std::string",
-            FieldType.table: "std::string",
+            FieldType.shortstr: "std::string_view",
+            FieldType.longstr: "std::string_view",
+            FieldType.table: "std::string_view",
             FieldType.timestamp: "time_t",
         }
 
@@ -21,6 +21,7 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -33,13 +34,13 @@ namespace stirling {
 namespace protocols {
 namespace amqp {
 
-StatusOr<std::string> ExtractShortString(BinaryDecoder* decoder) {
+StatusOr<std::string_view> ExtractShortString(BinaryDecoder* decoder) {
   // Short string defined as 2*OCTET(short-uint)
   PL_ASSIGN_OR_RETURN(uint8_t len, decoder->ExtractInt<uint8_t>());
   return decoder->ExtractString(len);
 }
 
-StatusOr<std::string> ExtractLongString(BinaryDecoder* decoder) {
+StatusOr<std::string_view> ExtractLongString(BinaryDecoder* decoder) {
   // Long string defined as 4*OCTET(short-uint)
   PL_ASSIGN_OR_RETURN(uint32_t len, decoder->ExtractInt<uint32_t>());
   return decoder->ExtractString(len);
@@ -39,11 +39,15 @@ typename TMapType::const_iterator MapLE(const TMapType& map, size_t key) {
 }  // namespace
 
 void AlwaysContiguousDataStreamBufferImpl::Reset() {
+  Clear();
+  ShrinkToFit();
+}
+
+void AlwaysContiguousDataStreamBufferImpl::Clear() {
   buffer_.clear();
   chunks_.clear();
   timestamps_.clear();
   position_ = 0;
-  ShrinkToFit();
 }
 
 bool AlwaysContiguousDataStreamBufferImpl::CheckOverlap(size_t pos, size_t size) {
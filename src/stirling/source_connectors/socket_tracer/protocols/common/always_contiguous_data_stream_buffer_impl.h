@@ -57,6 +57,8 @@ class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
 
   void Reset() override;
 
+  void Clear() override;
+
   void ShrinkToFit() override { buffer_.shrink_to_fit(); }
 
  private:
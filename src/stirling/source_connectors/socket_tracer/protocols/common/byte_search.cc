@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_search.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// The AVX2 and SSE2 implementations follow the same scheme, so the search is written once against
+// a small wrapper around the underlying intrinsics.
+namespace {
+
+#if defined(__AVX2__)
+struct Vec {
+  static constexpr size_t kWidth = 32;
+  __m256i v;
+
+  static Vec Load(const char* p) {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+  }
+  static Vec Splat(char c) { return {_mm256_set1_epi8(c)}; }
+  static Vec Zero() { return {_mm256_setzero_si256()}; }
+  Vec Eq(Vec o) const { return {_mm256_cmpeq_epi8(v, o.v)}; }
+  Vec Or(Vec o) const { return {_mm256_or_si256(v, o.v)}; }
+  uint32_t Mask() const { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+};
+#elif defined(__SSE2__)
+struct Vec {
+  static constexpr size_t kWidth = 16;
+  __m128i v;
+
+  static Vec Load(const char* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+  static Vec Splat(char c) { return {_mm_set1_epi8(c)}; }
+  static Vec Zero() { return {_mm_setzero_si128()}; }
+  Vec Eq(Vec o) const { return {_mm_cmpeq_epi8(v, o.v)}; }
+  Vec Or(Vec o) const { return {_mm_or_si128(v, o.v)}; }
+  uint32_t Mask() const { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+};
+#endif
+
+}  // namespace
+
+size_t FindFirstOf(std::string_view buf, std::string_view chars, size_t start_pos) {
+  DCHECK_LE(chars.size(), kMaxFindFirstOfChars);
+
+  const char* data = buf.data();
+  const size_t size = buf.size();
+  size_t pos = start_pos;
+
+  if (pos >= size || chars.empty()) {
+    return std::string_view::npos;
+  }
+
+#if defined(__AVX2__) || defined(__SSE2__)
+  Vec needles[kMaxFindFirstOfChars];
+  const size_t num_needles = std::min(chars.size(), kMaxFindFirstOfChars);
+  for (size_t i = 0; i < num_needles; ++i) {
+    needles[i] = Vec::Splat(chars[i]);
+  }
+
+  for (; pos + Vec::kWidth <= size; pos += Vec::kWidth) {
+    Vec block = Vec::Load(data + pos);
+    Vec matches = Vec::Zero();
+    for (size_t i = 0; i < num_needles; ++i) {
+      matches = matches.Or(block.Eq(needles[i]));
+    }
+    uint32_t mask = matches.Mask();
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; pos < size; ++pos) {
+    if (std::memchr(chars.data(), data[pos], chars.size()) != nullptr) {
+      return pos;
+    }
+  }
+  return std::string_view::npos;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string_view>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// Search primitives for FindFrameBoundary() implementations of text protocols.
+// They scan 32 (AVX2) or 16 (SSE2) bytes at a time when the target supports it,
+// and fall back to a scalar loop otherwise.
+//
+// Note that there is intentionally no substring search: std::string_view::find() is built on
+// memchr(), which is already vectorized by libc and is faster for markers like "\r\n\r\n".
+
+// The maximum number of distinct bytes accepted by FindFirstOf().
+inline constexpr size_t kMaxFindFirstOfChars = 8;
+
+/**
+ * Returns the position of the first byte at or after start_pos that is one of chars,
+ * or std::string_view::npos if there is none.
+ *
+ * Equivalent to buf.find_first_of(chars, start_pos), but chars must contain at most
+ * kMaxFindFirstOfChars bytes.
+ */
+size_t FindFirstOf(std::string_view buf, std::string_view chars, size_t start_pos = 0);
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_search.h"
+
+using px::stirling::protocols::FindFirstOf;
+
+// Creates what a tracer typically sees when it has to resync mid-stream: the tail of a message
+// body (a mix of compressed binary and markup, with the occasional lone CRLF), followed by the
+// start of the next message.
+std::string CreateMidStreamGarbage(size_t size) {
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  std::uniform_int_distribution<int> kind_dist(0, 2);
+
+  constexpr std::string_view kMarkup =
+      "<html><body><p>Lorem ipsum dolor sit amet, consectetur adipiscing elit</p></body></html>";
+
+  std::string s;
+  while (s.size() < size) {
+    switch (kind_dist(rng)) {
+      case 0:
+        for (int i = 0; i < 256; ++i) {
+          char c = static_cast<char>(byte_dist(rng));
+          // Keep the message type markers out of the garbage.
+          s.push_back((c == '\r' || c == '+' || c == '-' || c == ':' || c == '$' || c == '*')
+                          ? 'x'
+                          : c);
+        }
+        break;
+      case 1:
+        s.append(kMarkup);
+        break;
+      case 2:
+        s.append("\r\n");
+        s.append(kMarkup);
+        break;
+    }
+  }
+  s.resize(size);
+  s.append("*3\r\n");
+  return s;
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_FindFirstOf_scalar(benchmark::State& state) {
+  std::string data = CreateMidStreamGarbage(state.range(0));
+  std::string_view buf(data);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buf.find_first_of("+-:$*"));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_FindFirstOf(benchmark::State& state) {
+  std::string data = CreateMidStreamGarbage(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindFirstOf(data, "+-:$*"));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_FindFirstOf_scalar)->Range(1024, 1024 * 1024);
+BENCHMARK(BM_FindFirstOf)->Range(1024, 1024 * 1024);
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_search.h"
+
+#include <random>
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+TEST(FindFirstOfTest, Basic) {
+  EXPECT_EQ(FindFirstOf("abcdef", "dx"), 3);
+  EXPECT_EQ(FindFirstOf("abcdef", "xyz"), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf("abcdef", "a", 1), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf("abcdef", "f", 6), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf("", "a"), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf("abc", ""), std::string_view::npos);
+}
+
+// Compare against the standard library on inputs long enough to exercise the vector loop,
+// with matches at every offset relative to the vector width.
+TEST(FindFirstOfTest, MatchesStdLib) {
+  std::default_random_engine rng(37);
+  // A small alphabet makes matches at every offset likely.
+  std::uniform_int_distribution<int> dist(0, 3);
+  constexpr char kAlphabet[] = {'\r', '\n', 'a', '+'};
+
+  for (int iter = 0; iter < 200; ++iter) {
+    std::string buf(iter, ' ');
+    for (auto& c : buf) {
+      c = kAlphabet[dist(rng)];
+    }
+    for (size_t start = 0; start <= buf.size(); start += 7) {
+      EXPECT_EQ(FindFirstOf(buf, "+", start), buf.find_first_of("+", start));
+      EXPECT_EQ(FindFirstOf(buf, "a+", start), buf.find_first_of("a+", start));
+    }
+  }
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
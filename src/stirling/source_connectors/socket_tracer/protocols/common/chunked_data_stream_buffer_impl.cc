@@ -0,0 +1,230 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/strings/substitute.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "src/common/base/utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/chunked_data_stream_buffer_impl.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+void ChunkedDataStreamBufferImpl::Add(size_t pos, std::string_view data, uint64_t timestamp) {
+  // Drop any part of the event that has already been consumed.
+  if (pos < head_position_) {
+    size_t stale = std::min(head_position_ - pos, data.size());
+    pos += stale;
+    data.remove_prefix(stale);
+  }
+  if (data.empty()) {
+    return;
+  }
+  if (data.size() > capacity_) {
+    pos += data.size() - capacity_;
+    data.remove_prefix(data.size() - capacity_);
+  }
+  if (size_ + data.size() > capacity_) {
+    EvictBytes(size_ + data.size() - capacity_);
+  }
+
+  auto [it, inserted] = chunks_.try_emplace(pos, Chunk{std::string(data), 0});
+  if (!inserted) {
+    // Duplicate event.
+    return;
+  }
+  size_ += data.size();
+  allocated_ += data.size();
+  timestamps_.emplace(pos, timestamp);
+}
+
+std::map<size_t, ChunkedDataStreamBufferImpl::Chunk>::iterator
+ChunkedDataStreamBufferImpl::EraseChunk(std::map<size_t, Chunk>::iterator it) {
+  size_t begin = it->first;
+  size_t end = begin + it->second.size();
+  timestamps_.erase(timestamps_.lower_bound(begin), timestamps_.lower_bound(end));
+  size_ -= it->second.size();
+  allocated_ -= it->second.data.size();
+  return chunks_.erase(it);
+}
+
+void ChunkedDataStreamBufferImpl::EvictBytes(size_t n_bytes) {
+  size_t evicted = 0;
+  auto it = chunks_.begin();
+  while (it != chunks_.end() && evicted < n_bytes) {
+    evicted += it->second.size();
+    it = EraseChunk(it);
+  }
+}
+
+std::map<size_t, ChunkedDataStreamBufferImpl::Chunk>::iterator
+ChunkedDataStreamBufferImpl::SyncHead() {
+  auto it = chunks_.begin();
+  if (it != chunks_.end()) {
+    head_position_ = it->first;
+  }
+  return it;
+}
+
+std::string_view ChunkedDataStreamBufferImpl::HeadChunk() {
+  auto it = SyncHead();
+  if (it == chunks_.end()) {
+    return {};
+  }
+  return it->second.view();
+}
+
+bool ChunkedDataStreamBufferImpl::MergeHeadChunk() {
+  auto head_it = SyncHead();
+  if (head_it == chunks_.end()) {
+    return false;
+  }
+
+  // Pull in following contiguous chunks until the head at least doubles in size. Growing
+  // geometrically keeps the cost of repeated merges linear for frames that span many chunks,
+  // while still leaving the rest of the contiguous data uncopied.
+  size_t head_size = head_it->second.size();
+  size_t merged_size = head_size;
+  auto end_it = std::next(head_it);
+  while (end_it != chunks_.end() && end_it->first == head_it->first + merged_size &&
+         merged_size < 2 * head_size) {
+    merged_size += end_it->second.size();
+    ++end_it;
+  }
+  if (merged_size == head_size) {
+    return false;
+  }
+
+  std::string merged;
+  merged.reserve(merged_size);
+  size_t released = 0;
+  for (auto it = head_it; it != end_it; ++it) {
+    merged.append(it->second.view());
+    released += it->second.data.size();
+  }
+
+  size_t head_pos = head_it->first;
+  chunks_.erase(head_it, end_it);
+  chunks_.emplace(head_pos, Chunk{std::move(merged), 0});
+  allocated_ = allocated_ - released + merged_size;
+  return true;
+}
+
+size_t ChunkedDataStreamBufferImpl::ContiguousHeadSize() {
+  auto it = SyncHead();
+  if (it == chunks_.end()) {
+    return 0;
+  }
+  size_t contiguous_size = 0;
+  for (; it != chunks_.end() && it->first == head_position_ + contiguous_size; ++it) {
+    contiguous_size += it->second.size();
+  }
+  return contiguous_size;
+}
+
+std::string_view ChunkedDataStreamBufferImpl::Head() {
+  while (MergeHeadChunk()) {
+  }
+  return HeadChunk();
+}
+
+StatusOr<uint64_t> ChunkedDataStreamBufferImpl::GetTimestamp(size_t pos) const {
+  auto chunk_it = Floor(chunks_, pos);
+  if (chunk_it == chunks_.end() || pos >= chunk_it->first + chunk_it->second.size()) {
+    return error::Internal("Specified position not found");
+  }
+  auto it = Floor(timestamps_, pos);
+  if (it == timestamps_.end()) {
+    return error::Internal("Specified position not found");
+  }
+  return it->second;
+}
+
+void ChunkedDataStreamBufferImpl::RemovePrefix(ssize_t n) {
+  DCHECK_GE(n, 0);
+  if (n <= 0) {
+    return;
+  }
+  size_t remaining = n;
+
+  auto it = chunks_.begin();
+  while (remaining > 0 && it != chunks_.end() && it->second.size() <= remaining) {
+    remaining -= it->second.size();
+    it = EraseChunk(it);
+  }
+
+  // Handle remaining bytes that need to be removed from the first chunk.
+  if (remaining > 0 && it != chunks_.end()) {
+    size_t old_pos = it->first;
+    size_t new_pos = old_pos + remaining;
+
+    auto nh = chunks_.extract(it);
+    nh.key() = new_pos;
+    nh.mapped().offset += remaining;
+    chunks_.insert(std::move(nh));
+    size_ -= remaining;
+
+    // Keep the timestamp covering new_pos, re-keyed to the new start of the chunk.
+    auto ts_it = timestamps_.upper_bound(new_pos);
+    if (ts_it != timestamps_.begin()) {
+      --ts_it;
+      if (ts_it->first >= old_pos && ts_it->first < new_pos) {
+        timestamps_.erase(timestamps_.lower_bound(old_pos), ts_it);
+        auto ts_nh = timestamps_.extract(ts_it);
+        ts_nh.key() = new_pos;
+        timestamps_.insert(std::move(ts_nh));
+      }
+    }
+  }
+
+  // As in the LazyContiguousDataStreamBufferImpl, position() is only guaranteed to be accurate
+  // after the next call to Head() or HeadChunk().
+  head_position_ += n;
+}
+
+void ChunkedDataStreamBufferImpl::Trim() { SyncHead(); }
+
+void ChunkedDataStreamBufferImpl::Reset() {
+  chunks_.clear();
+  timestamps_.clear();
+  size_ = 0;
+  allocated_ = 0;
+}
+
+void ChunkedDataStreamBufferImpl::ShrinkToFit() {
+  for (auto& [pos, chunk] : chunks_) {
+    if (chunk.offset == 0) {
+      continue;
+    }
+    allocated_ -= chunk.offset;
+    chunk.data = chunk.data.substr(chunk.offset);
+    chunk.offset = 0;
+  }
+}
+
+std::string ChunkedDataStreamBufferImpl::DebugInfo() const {
+  return absl::Substitute("chunks=$0 size=$1 allocated=$2", chunks_.size(), size_, allocated_);
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * This version of the DataStreamBuffer keeps each event payload as its own chunk, and
+ * never copies data into a contiguous buffer unless it has to.
+ *
+ * HeadChunk() returns a view directly into the first chunk. Parsers only ask for the following
+ * contiguous chunks to be merged in (MergeHeadChunk()) when a frame crosses the end of the first
+ * chunk, so the common case of frames that fit within one event does not copy at all.
+ * Head() keeps its original contract of returning all the contiguous data, and merges eagerly.
+ */
+class ChunkedDataStreamBufferImpl : public DataStreamBufferImpl {
+ public:
+  // Support the same constructor signature as the AlwaysContiguousDataStreamBufferImpl.
+  ChunkedDataStreamBufferImpl(size_t max_capacity, size_t, size_t) : capacity_(max_capacity) {}
+  explicit ChunkedDataStreamBufferImpl(size_t max_capacity)
+      : ChunkedDataStreamBufferImpl(max_capacity, 0, 0) {}
+
+  void Add(size_t pos, std::string_view data, uint64_t timestamp) override;
+
+  std::string_view Head() override;
+  std::string_view HeadChunk() override;
+  bool MergeHeadChunk() override;
+  size_t ContiguousHeadSize() override;
+
+  StatusOr<uint64_t> GetTimestamp(size_t pos) const override;
+
+  void RemovePrefix(ssize_t n) override;
+
+  void Trim() override;
+
+  size_t size() const override { return size_; }
+  size_t capacity() const override { return allocated_; }
+  bool empty() const override { return size_ == 0; }
+  size_t position() const override { return head_position_; }
+
+  std::string DebugInfo() const override;
+
+  void Reset() override;
+
+  void ShrinkToFit() override;
+
+ private:
+  struct Chunk {
+    // The event payload. Consumed bytes are skipped over via offset, rather than removed, so that
+    // trimming the front of a chunk never copies.
+    std::string data;
+    size_t offset = 0;
+
+    std::string_view view() const { return std::string_view(data).substr(offset); }
+    size_t size() const { return data.size() - offset; }
+  };
+
+  // Moves head_position_ to the first chunk, if the head is in a gap. Returns the first chunk,
+  // or chunks_.end() if there are none.
+  std::map<size_t, Chunk>::iterator SyncHead();
+
+  // Removes the chunk pointed to by it, and returns the iterator to the following chunk.
+  std::map<size_t, Chunk>::iterator EraseChunk(std::map<size_t, Chunk>::iterator it);
+
+  // Evict whole chunks from the front of the buffer, until at least n_bytes have been freed.
+  void EvictBytes(size_t n_bytes);
+
+  const size_t capacity_;
+
+  size_t head_position_ = 0;
+
+  // Chunks keyed by the logical position of their first unconsumed byte.
+  std::map<size_t, Chunk> chunks_;
+
+  // Timestamps keyed by the logical position of the event they came from.
+  // Kept separately from chunks_, since a merged chunk contains many events.
+  std::map<size_t, uint64_t> timestamps_;
+
+  // Sum of unconsumed chunk bytes.
+  size_t size_ = 0;
+
+  // Sum of chunk payload sizes, including consumed bytes that have not been released yet.
+  size_t allocated_ = 0;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -27,6 +27,7 @@
 #include "src/common/base/base.h"
 
 DECLARE_bool(stirling_data_stream_buffer_always_contiguous_buffer);
+DECLARE_bool(stirling_data_stream_buffer_chunked);
 
 namespace px {
 namespace stirling {
@@ -39,6 +40,11 @@ class DataStreamBufferImpl {
   virtual ~DataStreamBufferImpl() = default;
   virtual void Add(size_t pos, std::string_view data, uint64_t timestamp) = 0;
   virtual std::string_view Head() = 0;
+  // Implementations that don't store data in chunks can rely on the defaults, which treat all the
+  // contiguous head data as a single chunk.
+  virtual std::string_view HeadChunk() { return Head(); }
+  virtual bool MergeHeadChunk() { return false; }
+  virtual size_t ContiguousHeadSize() { return Head().size(); }
   virtual StatusOr<uint64_t> GetTimestamp(size_t pos) const = 0;
   virtual void RemovePrefix(ssize_t n) = 0;
   virtual void Trim() = 0;
@@ -48,6 +54,8 @@ class DataStreamBufferImpl {
   virtual size_t position() const = 0;
   virtual std::string DebugInfo() const = 0;
   virtual void Reset() = 0;
+  // Implementations that can't reuse their allocation simply reset.
+  virtual void Clear() { Reset(); }
   virtual void ShrinkToFit() = 0;
 };
 
@@ -90,6 +98,27 @@ class DataStreamBuffer {
    */
   std::string_view Head() { return impl_->Head(); }
 
+  /**
+   * Get the first chunk of contiguous data at the head of the buffer, without merging it with any
+   * chunks that follow it. This is a prefix of Head(), and avoids copying for implementations
+   * that store events separately.
+   * @return A string_view to the data.
+   */
+  std::string_view HeadChunk() { return impl_->HeadChunk(); }
+
+  /**
+   * Grow the chunk returned by HeadChunk() by merging in contiguous chunks that follow it.
+   * Intended for when a frame spans more than the head chunk.
+   * @return false if there was no contiguous data to merge.
+   */
+  bool MergeHeadChunk() { return impl_->MergeHeadChunk(); }
+
+  /**
+   * Size of all the contiguous data at the head of the buffer; Equivalent to Head().size(), but
+   * without merging chunks.
+   */
+  size_t ContiguousHeadSize() { return impl_->ContiguousHeadSize(); }
+
   /**
    * Get timestamp recorded for the data at the specified position.
    * @param pos The logical position of the data.
@@ -139,6 +168,12 @@ class DataStreamBuffer {
    */
   void Reset() { impl_->Reset(); }
 
+  /**
+   * Like Reset(), but keeps the allocated memory where the implementation allows it, so that it
+   * can be reused by new data. Intended for recycling buffers across connections.
+   */
+  void Clear() { impl_->Clear(); }
+
   /**
    * Shrink the internal buffer, so that the allocated memory matches its size.
    * Note this has to be an external API, because `RemovePrefix` is called in situations where it
@@ -19,23 +19,31 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
 
 #include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/chunked_data_stream_buffer_impl.h"
 
 namespace px {
 namespace stirling {
 namespace protocols {
 
-class DataStreamBufferTest : public ::testing::TestWithParam<bool> {
+enum class Impl { kAlwaysContiguous, kLazyContiguous, kChunked };
+
+class DataStreamBufferTest : public ::testing::TestWithParam<Impl> {
  protected:
   void SetUp() override {
-    old_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = GetParam();
+    old_always_contiguous_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
+    old_chunked_flag_val_ = FLAGS_stirling_data_stream_buffer_chunked;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer =
+        (GetParam() == Impl::kAlwaysContiguous);
+    FLAGS_stirling_data_stream_buffer_chunked = (GetParam() == Impl::kChunked);
   }
   void TearDown() override {
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_flag_val_;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_always_contiguous_flag_val_;
+    FLAGS_stirling_data_stream_buffer_chunked = old_chunked_flag_val_;
   }
 
  private:
-  bool old_flag_val_;
+  bool old_always_contiguous_flag_val_;
+  bool old_chunked_flag_val_;
 };
 
 TEST_P(DataStreamBufferTest, AddAndGet) {
@@ -268,14 +276,94 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   }
 }
 
+TEST_P(DataStreamBufferTest, HeadChunk) {
+  DataStreamBuffer stream_buffer(15, 15, 15);
+
+  stream_buffer.Add(0, "0123", 0);
+  stream_buffer.Add(4, "4567", 4);
+  stream_buffer.Add(10, "abcd", 10);
+
+  EXPECT_EQ(stream_buffer.ContiguousHeadSize(), 8);
+
+  // The head chunk is always a prefix of the contiguous head data, and merging can only grow it
+  // up to the next gap.
+  while (stream_buffer.HeadChunk() != "01234567") {
+    EXPECT_EQ(std::string_view("01234567").substr(0, stream_buffer.HeadChunk().size()),
+              stream_buffer.HeadChunk());
+    ASSERT_TRUE(stream_buffer.MergeHeadChunk());
+  }
+  EXPECT_FALSE(stream_buffer.MergeHeadChunk());
+  EXPECT_EQ(stream_buffer.Head(), "01234567");
+  EXPECT_EQ(stream_buffer.ContiguousHeadSize(), 8);
+
+  stream_buffer.RemovePrefix(6);
+  EXPECT_EQ(stream_buffer.HeadChunk(), "67");
+  EXPECT_EQ(stream_buffer.ContiguousHeadSize(), 2);
+}
+
+TEST_P(DataStreamBufferTest, Clear) {
+  DataStreamBuffer stream_buffer(15, 15, 15);
+
+  stream_buffer.Add(0, "0123", 0);
+  stream_buffer.Add(10, "abcd", 10);
+  stream_buffer.Clear();
+
+  EXPECT_TRUE(stream_buffer.empty());
+  EXPECT_EQ(stream_buffer.Head(), "");
+  EXPECT_EQ(stream_buffer.position(), 0);
+
+  // A cleared buffer is usable as though it were new.
+  stream_buffer.Add(0, "4567", 4);
+  EXPECT_EQ(stream_buffer.Head(), "4567");
+  ASSERT_OK_AND_EQ(stream_buffer.GetTimestamp(0), 4);
+}
+
+TEST(ChunkedDataStreamBufferTest, HeadChunkDoesNotMerge) {
+  ChunkedDataStreamBufferImpl stream_buffer(1024);
+
+  stream_buffer.Add(0, "0123", 0);
+  stream_buffer.Add(4, "4567", 4);
+  stream_buffer.Add(8, "89", 8);
+
+  EXPECT_EQ(stream_buffer.HeadChunk(), "0123");
+  EXPECT_EQ(stream_buffer.ContiguousHeadSize(), 10);
+
+  // Merging at least doubles the head chunk, but leaves the rest alone.
+  EXPECT_TRUE(stream_buffer.MergeHeadChunk());
+  EXPECT_EQ(stream_buffer.HeadChunk(), "01234567");
+  EXPECT_TRUE(stream_buffer.MergeHeadChunk());
+  EXPECT_EQ(stream_buffer.HeadChunk(), "0123456789");
+  EXPECT_FALSE(stream_buffer.MergeHeadChunk());
+
+  // Timestamps of the merged events are preserved.
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(3), 0);
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(5), 4);
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(9), 8);
+
+  // Consuming part of a chunk does not release its memory until ShrinkToFit().
+  stream_buffer.RemovePrefix(5);
+  EXPECT_EQ(stream_buffer.HeadChunk(), "56789");
+  EXPECT_EQ(stream_buffer.size(), 5);
+  EXPECT_EQ(stream_buffer.capacity(), 10);
+  stream_buffer.ShrinkToFit();
+  EXPECT_EQ(stream_buffer.capacity(), 5);
+  EXPECT_EQ(stream_buffer.HeadChunk(), "56789");
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(5), 4);
+}
+
 INSTANTIATE_TEST_SUITE_P(DataStreamBufferImplTest, DataStreamBufferTest,
-                         ::testing::Values(true, false),
+                         ::testing::Values(Impl::kAlwaysContiguous, Impl::kLazyContiguous,
+                                           Impl::kChunked),
                          [](const ::testing::TestParamInfo<DataStreamBufferTest::ParamType>& info) {
-                           if (info.param) {
-                             return "AlwaysContiguousImpl";
-                           } else {
-                             return "LazyContiguousImpl";
+                           switch (info.param) {
+                             case Impl::kAlwaysContiguous:
+                               return "AlwaysContiguousImpl";
+                             case Impl::kLazyContiguous:
+                               return "LazyContiguousImpl";
+                             case Impl::kChunked:
+                               return "ChunkedImpl";
                            }
+                           return "Unknown";
                          });
 
 }  // namespace protocols
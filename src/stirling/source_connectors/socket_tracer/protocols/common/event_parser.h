@@ -100,7 +100,9 @@ template <typename TFrameType, typename TStateType = NoState>
 ParseResult ParseFrames(message_type_t type, DataStreamBuffer* data_stream_buffer,
                         std::deque<TFrameType>* frames, bool resync = false,
                         TStateType* state = nullptr) {
-  std::string_view buf = data_stream_buffer->Head();
+  // Only the first chunk is requested up-front, so that no data is copied unless a frame spans
+  // multiple chunks (see MergeHeadChunk() below).
+  std::string_view buf = data_stream_buffer->HeadChunk();
 
   size_t start_pos = 0;
   if (resync) {
@@ -109,6 +111,10 @@ ParseResult ParseFrames(message_type_t type, DataStreamBuffer* data_stream_buffe
     // Don't want to stay at the same position.
     constexpr int kStartPos = 1;
     start_pos = FindFrameBoundary<TFrameType, TStateType>(type, buf, kStartPos, state);
+    while (start_pos == std::string::npos && data_stream_buffer->MergeHeadChunk()) {
+      buf = data_stream_buffer->HeadChunk();
+      start_pos = FindFrameBoundary<TFrameType, TStateType>(type, buf, kStartPos, state);
+    }
 
     // Couldn't find a boundary, so stay where we are.
     // Chances are we won't be able to parse, but we have no other option.
@@ -126,6 +132,29 @@ ParseResult ParseFrames(message_type_t type, DataStreamBuffer* data_stream_buffe
   // Parse and append new frames to the frames vector.
   ParseResult result = ParseFramesLoop(type, buf, frames, state);
 
+  // If parsing stopped at a frame that runs past the end of the head chunk, grow the chunk and
+  // resume parsing from where we left off.
+  while ((result.state == ParseState::kNeedsMoreData || result.state == ParseState::kInvalid) &&
+         data_stream_buffer->MergeHeadChunk()) {
+    const size_t resume_pos = result.end_position;
+    if (result.state == ParseState::kInvalid) {
+      // The invalid frame is parsed again below, and will be re-counted if it is still invalid.
+      --result.invalid_frames;
+    }
+
+    buf = data_stream_buffer->HeadChunk();
+    buf.remove_prefix(start_pos + resume_pos);
+    ParseResult more = ParseFramesLoop(type, buf, frames, state);
+
+    for (auto& f : more.frame_positions) {
+      result.frame_positions.push_back({f.start + resume_pos, f.end + resume_pos});
+    }
+    result.end_position += more.end_position;
+    result.state = more.state;
+    result.invalid_frames += more.invalid_frames;
+    result.frame_bytes += more.frame_bytes;
+  }
+
   VLOG(1) << absl::Substitute("Parsed $0 new frames", frames->size() - prev_size);
 
   // Match timestamps with the parsed frames.
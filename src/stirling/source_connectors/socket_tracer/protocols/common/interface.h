@@ -103,6 +103,22 @@ template <typename TFrameType, typename TStateType = NoState>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, TFrameType* frame,
                       TStateType* state = nullptr);
 
+/**
+ * Returns how many bytes the frame at the start of buf needs before ParseFrame() can complete
+ * it, for a frame that ParseFrame() reported as kNeedsMoreData. Protocols that know the size of
+ * their frames up-front, from a length prefix or a Content-Length, can specialize this, so that
+ * DataStream doesn't parse a large frame again on every iteration while its bytes come in.
+ * Specializations must be declared where DataStream::ProcessBytesToFrames() is instantiated.
+ *
+ * @return The number of bytes needed, which must not be more than ParseFrame() needs, or 0 if
+ * it isn't known.
+ */
+template <typename TFrameType, typename TStateType = NoState>
+size_t PendingFrameSize(message_type_t /*type*/, std::string_view /*buf*/,
+                        TStateType* /*state*/ = nullptr) {
+  return 0;
+}
+
 /**
  * StitchFrames is the entry point of stitcher for all protocols. It loops through the responses,
  * matches them with the corresponding requests, and returns stitched request & response pairs.
@@ -18,11 +18,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <limits>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/substitute.h>
+
+#include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
 
 namespace px {
@@ -47,6 +51,8 @@ template <typename TRecordType, typename TMessageType>
 RecordsWithErrorCount<TRecordType> StitchMessagesWithTimestampOrder(
     std::deque<TMessageType>* req_messages, std::deque<TMessageType>* resp_messages) {
   std::vector<TRecordType> records;
+  // Each response produces at most one record.
+  records.reserve(resp_messages->size());
 
   TRecordType record;
   record.req.timestamp_ns = 0;
@@ -91,6 +97,100 @@ RecordsWithErrorCount<TRecordType> StitchMessagesWithTimestampOrder(
   return {std::move(records), 0};
 }
 
+// Stitches each response to the oldest unconsumed request before it that matches, for protocols
+// whose responses identify their request (e.g. by a transaction ID) and may come out of order.
+//
+// match(const TReqType&, const TRespType&) returns whether the response belongs to the request.
+// emit(TReqType*, TRespType*) is called for each matched pair, and returns false if no record
+// could be made from it. Those pairs, and responses without a matching request, are counted as
+// errors. All responses are consumed.
+//
+// TReqType must have a `consumed` member. Matched requests are only marked as consumed until they
+// reach the head of the deque, which avoids erasing from the middle of it. Requests after all the
+// responses remain, in case their responses arrive later.
+template <typename TReqType, typename TRespType, typename TMatchFn, typename TEmitFn>
+int StitchResponsesToRequests(std::deque<TReqType>* reqs, std::deque<TRespType>* resps,
+                              TMatchFn match, TEmitFn emit) {
+  int error_count = 0;
+
+  auto reqs_begin = reqs->begin();
+  for (TRespType& resp : *resps) {
+    bool found_match = false;
+    // Requests after the response can't be its match.
+    for (auto req_iter = reqs_begin;
+         req_iter != reqs->end() && req_iter->timestamp_ns <= resp.timestamp_ns; ++req_iter) {
+      if (req_iter->consumed || !match(*req_iter, resp)) {
+        continue;
+      }
+      req_iter->consumed = true;
+      found_match = true;
+      if (!emit(&*req_iter, &resp)) {
+        ++error_count;
+      }
+      break;
+    }
+
+    if (!found_match) {
+      VLOG(1) << absl::Substitute("Did not find a request matching the response. timestamp_ns=$0",
+                                  resp.timestamp_ns);
+      ++error_count;
+    }
+
+    // Skip the consumed requests at the head, so that the next search does not scan them.
+    while (reqs_begin != reqs->end() && reqs_begin->consumed) {
+      ++reqs_begin;
+    }
+  }
+
+  reqs->erase(reqs->begin(), reqs_begin);
+  resps->clear();
+
+  return error_count;
+}
+
+// Advances the iterator to the first frame at or after the timestamp.
+template <typename TIter>
+void AdvanceIterBeyondTimestamp(TIter* iter, const TIter& end, uint64_t timestamp_ns) {
+  while (*iter != end && (*iter)->timestamp_ns < timestamp_ns) {
+    ++(*iter);
+  }
+}
+
+// Finds the next frame that matches a predicate, for stitchers that look for the response of each
+// request from a response iterator that only moves forward.
+//
+// The result of the last search is remembered: a search that starts between the start and the
+// result of the previous search returns the same result without rescanning. Otherwise, a run of
+// requests whose responses were not captured (e.g. a burst of pipelined requests) rescans all the
+// remaining responses once per request, which is quadratic.
+//
+// TIter must be a random access iterator, and the searched range must not change while the
+// ForwardFinder is in use.
+template <typename TIter, typename TPredicate>
+class ForwardFinder {
+ public:
+  ForwardFinder(TIter end, TPredicate pred) : end_(end), pred_(std::move(pred)) {}
+
+  TIter Find(TIter begin) {
+    if (!has_result_ || begin < last_begin_ || begin > last_result_) {
+      last_result_ = std::find_if(begin, end_, pred_);
+      last_begin_ = begin;
+      has_result_ = true;
+    }
+    return last_result_;
+  }
+
+  const TIter& end() const { return end_; }
+
+ private:
+  TIter end_;
+  TPredicate pred_;
+
+  bool has_result_ = false;
+  TIter last_begin_;
+  TIter last_result_;
+};
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -18,6 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <deque>
+#include <utility>
+#include <vector>
+
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/timestamp_stitcher.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/types.h"
 
@@ -185,6 +189,64 @@ TEST_F(TimestampStitcherTest, MissingOneReqFollowedByOneResp) {
   EXPECT_EQ(records.records.size(), 99);
 }
 
+TEST(ForwardFinderTest, FindsNextMatch) {
+  std::deque<int> frames = {1, 2, 10, 3, 4, 20, 5};
+  int num_calls = 0;
+  auto is_large = [&num_calls](int x) {
+    ++num_calls;
+    return x >= 10;
+  };
+  ForwardFinder finder(frames.end(), is_large);
+
+  EXPECT_EQ(finder.Find(frames.begin()), frames.begin() + 2);
+  EXPECT_EQ(num_calls, 3);
+
+  // Searches that start before the previous result are answered without rescanning.
+  EXPECT_EQ(finder.Find(frames.begin() + 1), frames.begin() + 2);
+  EXPECT_EQ(finder.Find(frames.begin() + 2), frames.begin() + 2);
+  EXPECT_EQ(num_calls, 3);
+
+  EXPECT_EQ(finder.Find(frames.begin() + 3), frames.begin() + 5);
+  EXPECT_EQ(num_calls, 6);
+
+  EXPECT_EQ(finder.Find(frames.begin() + 6), frames.end());
+  EXPECT_EQ(finder.Find(frames.end()), frames.end());
+  EXPECT_EQ(num_calls, 7);
+
+  // Searching backwards still works, but has to rescan.
+  EXPECT_EQ(finder.Find(frames.begin()), frames.begin() + 2);
+  EXPECT_EQ(num_calls, 10);
+}
+
+struct TaggedFrame {
+  uint64_t timestamp_ns;
+  int tag;
+  bool consumed = false;
+};
+
+TEST(StitchResponsesToRequestsTest, MatchesOutOfOrderResponses) {
+  std::deque<TaggedFrame> reqs = {{1, 0}, {2, 1}, {3, 2}, {6, 3}};
+  std::deque<TaggedFrame> resps = {{4, 1}, {5, 0}, {7, 9}, {8, 2}};
+
+  std::vector<std::pair<int, int>> pairs;
+  int error_count = StitchResponsesToRequests(
+      &reqs, &resps,
+      [](const TaggedFrame& req, const TaggedFrame& resp) { return req.tag == resp.tag; },
+      [&pairs](TaggedFrame* req, TaggedFrame* resp) {
+        pairs.emplace_back(req->tag, resp->tag);
+        return resp->timestamp_ns != 8;
+      });
+
+  EXPECT_EQ(pairs, (std::vector<std::pair<int, int>>{{1, 1}, {0, 0}, {2, 2}}));
+  // The response without a request, and the pair that emit() rejected.
+  EXPECT_EQ(error_count, 2);
+  EXPECT_TRUE(resps.empty());
+  // The last request has not been answered yet.
+  ASSERT_EQ(reqs.size(), 1);
+  EXPECT_EQ(reqs[0].tag, 3);
+  EXPECT_FALSE(reqs[0].consumed);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
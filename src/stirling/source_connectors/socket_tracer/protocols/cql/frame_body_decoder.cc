@@ -633,6 +633,19 @@ StatusOr<ResultResp> ParseResultResp(Frame* frame) {
   return r;
 }
 
+size_t ResultRespDecodedLength(std::string_view body, uint8_t version) {
+  FrameBodyDecoder decoder(body, version);
+  StatusOr<int32_t> kind = decoder.ExtractInt();
+  if (!kind.ok() || kind.ValueOrDie() != static_cast<int32_t>(ResultRespKind::kRows)) {
+    return body.size();
+  }
+  // Keep the whole body on failure, so that ParseResultResp() reports the error.
+  if (!decoder.ExtractResultMetadata().ok() || !decoder.ExtractInt().ok()) {
+    return body.size();
+  }
+  return body.size() - decoder.BufSize();
+}
+
 StatusOr<EventResp> ParseEventResp(Frame* frame) {
   EventResp r;
   FrameBodyDecoder decoder(*frame);
@@ -387,6 +387,11 @@ class FrameBodyDecoder {
    */
   bool eof() { return binary_decoder_.eof(); }
 
+  /**
+   * Number of bytes not yet processed.
+   */
+  size_t BufSize() const { return binary_decoder_.BufSize(); }
+
   Status ExpectEOF() {
     if (!eof()) {
       return error::Internal("There are still $0 bytes left", binary_decoder_.BufSize());
@@ -418,6 +423,13 @@ StatusOr<OptionsReq> ParseOptionsReq(Frame* frame);
 StatusOr<SupportedResp> ParseSupportedResp(Frame* frame);
 StatusOr<QueryReq> ParseQueryReq(Frame* frame);
 StatusOr<ResultResp> ParseResultResp(Frame* frame);
+
+/**
+ * Returns the length of the leading part of a RESULT frame body that ParseResultResp() decodes.
+ * For a Rows result, this stops before the row content, which is never decoded.
+ * For other kinds, or if the body does not decode, it is the whole body.
+ */
+size_t ResultRespDecodedLength(std::string_view body, uint8_t version);
 StatusOr<PrepareReq> ParsePrepareReq(Frame* frame);
 StatusOr<ExecuteReq> ParseExecuteReq(Frame* frame);
 StatusOr<RegisterReq> ParseRegisterReq(Frame* frame);
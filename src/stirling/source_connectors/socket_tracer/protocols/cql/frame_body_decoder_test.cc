@@ -802,6 +802,45 @@ TEST(ParseResultResp, RowsResult) {
   EXPECT_EQ(resp, expected_resp);
 }
 
+TEST(ResultRespDecodedLength, RowsResultStopsBeforeRowContent) {
+  constexpr uint8_t kProtocolVersion = 4;
+  ResultResp resp;
+  resp.kind = ResultRespKind::kRows;
+  ResultRowsResp rows_resp;
+  rows_resp.metadata.flags = 0;
+  rows_resp.metadata.columns_count = 1;
+  ColSpec col_spec;
+  col_spec.ks_name = "keyspace";
+  col_spec.table_name = "table";
+  col_spec.name = "col1";
+  col_spec.type = {
+      .type = protocols::cass::DataType::kVarchar,
+      .value = "",
+  };
+  rows_resp.metadata.col_specs.push_back(col_spec);
+  rows_resp.rows_count = 2;
+  resp.resp = rows_resp;
+
+  std::string body = testutils::ResultRespToByteString(resp);
+  const size_t decoded_length = body.size();
+  // Two rows of a single [bytes] value each.
+  body.append(ConstStringView("\x00\x00\x00\x03" "abc" "\x00\x00\x00\x03" "def"));
+
+  EXPECT_EQ(ResultRespDecodedLength(body, kProtocolVersion), decoded_length);
+}
+
+TEST(ResultRespDecodedLength, OtherResultsAreWhole) {
+  constexpr uint8_t kProtocolVersion = 4;
+  ResultResp resp;
+  resp.kind = ResultRespKind::kSetKeyspace;
+  resp.resp = ResultSetKeyspaceResp{"keyspace"};
+
+  std::string body = testutils::ResultRespToByteString(resp);
+  EXPECT_EQ(ResultRespDecodedLength(body, kProtocolVersion), body.size());
+  // Truncated bodies are left to ParseResultResp() to reject.
+  EXPECT_EQ(ResultRespDecodedLength(body.substr(0, 6), kProtocolVersion), 6U);
+}
+
 TEST(ParseResultResp, VoidResult) {
   ResultResp expected_resp;
   expected_resp.kind = ResultRespKind::kVoid;
@@ -25,6 +25,7 @@
 
 #include "src/common/base/byte_utils.h"
 #include "src/common/base/types.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/cql/frame_body_decoder.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/cql/types.h"
 #include "src/stirling/utils/parse_state.h"
 
@@ -76,7 +77,13 @@ ParseState ParseFrame(message_type_t type, std::string_view* buf, Frame* result)
     return ParseState::kNeedsMoreData;
   }
 
-  result->msg = buf->substr(kFrameHeaderLength, result->hdr.length);
+  std::string_view body = buf->substr(kFrameHeaderLength, result->hdr.length);
+  // The row content of RESULT frames is never decoded, so don't copy it. With wide rows, it can be
+  // almost all of the frame.
+  if (result->hdr.opcode == Opcode::kResult && !(result->hdr.flags & kCompressionFlag)) {
+    body.remove_suffix(body.size() - ResultRespDecodedLength(body, result->hdr.version));
+  }
+  result->msg = body;
   buf->remove_prefix(kFrameHeaderLength + result->hdr.length);
 
   return ParseState::kSuccess;
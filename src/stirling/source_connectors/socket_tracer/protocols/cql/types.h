@@ -116,6 +116,9 @@ constexpr int kMaxFrameLength = 256 * 1024 * 1024;
 constexpr uint8_t kVersionMask = 0x7f;
 constexpr uint8_t kDirectionMask = 0x80;
 
+// FrameHeader::flags bit set when the frame body is compressed. See section 2.2 of the spec.
+constexpr uint8_t kCompressionFlag = 0x01;
+
 // Currently only support version 3 and 4 of the protocol,
 // which appear to be the most popular versions.
 constexpr uint8_t kMinSupportedProtocolVersion = 3;
@@ -87,13 +87,13 @@ ParseState ParseFrame(message_type_t type, std::string_view* buf, Frame* result)
 
 template <>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, dns::Frame* result,
-                      NoState* /*state*/) {
+                      dns::StateWrapper* /*state*/) {
   return dns::ParseFrame(type, buf, result);
 }
 
 template <>
 size_t FindFrameBoundary<dns::Frame>(message_type_t /*type*/, std::string_view /*buf*/,
-                                     size_t /*start_pos*/, NoState* /*state*/) {
+                                     size_t /*start_pos*/, dns::StateWrapper* /*state*/) {
   // Not implemented.
   // Search for magic string that we should insert between UDP packets.
   return std::string::npos;
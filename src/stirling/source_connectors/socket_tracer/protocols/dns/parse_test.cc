@@ -245,13 +245,16 @@ constexpr uint8_t kRespFrame3[] = {
     0x65, 0x81, 0x8c, 0xc0, 0x2c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x04, 0x97,
     0x65, 0xc1, 0x8c, 0x00, 0x00, 0x29, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-class DNSParserTest : public ::testing::Test {};
+class DNSParserTest : public ::testing::Test {
+ protected:
+  StateWrapper state_;
+};
 
 TEST_F(DNSParserTest, BasicReq) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kQueryFrame));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   ASSERT_EQ(frames.size(), 1);
@@ -272,7 +275,7 @@ TEST_F(DNSParserTest, BasicResp) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kRespFrame));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   ASSERT_EQ(frames.size(), 1);
@@ -293,7 +296,7 @@ TEST_F(DNSParserTest, BasicReq2) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kReqFrame2));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   ASSERT_EQ(frames.size(), 1);
@@ -314,7 +317,7 @@ TEST_F(DNSParserTest, CNameAndMultipleResponses) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kRespFrame2));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   ASSERT_EQ(frames.size(), 1);
@@ -356,7 +359,7 @@ TEST_F(DNSParserTest, CNameAndMultipleResponses2) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kRespFrame3));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kResponse, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   ASSERT_EQ(frames.size(), 1);
@@ -399,7 +402,7 @@ TEST_F(DNSParserTest, IncompleteHeader) {
   auto frame_view = CreateStringView<char>(CharArrayStringView<uint8_t>(kIncompleteHeader));
 
   std::deque<Frame> frames;
-  ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames);
+  ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames, &state_);
 
   ASSERT_EQ(parse_result.state, ParseState::kInvalid);
 }
@@ -412,7 +415,7 @@ TEST_F(DNSParserTest, PartialRecords) {
     frame_view.remove_suffix(10);
 
     std::deque<Frame> frames;
-    ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames);
+    ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames, &state_);
 
     ASSERT_EQ(parse_result.state, ParseState::kSuccess);
   }
@@ -422,7 +425,7 @@ TEST_F(DNSParserTest, PartialRecords) {
     frame_view.remove_suffix(20);
 
     std::deque<Frame> frames;
-    ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames);
+    ParseResult parse_result = ParseFramesLoop(message_type_t::kRequest, frame_view, &frames, &state_);
 
     ASSERT_EQ(parse_result.state, ParseState::kInvalid);
   }
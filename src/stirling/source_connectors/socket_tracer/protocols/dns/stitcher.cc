@@ -25,8 +25,12 @@
 #include <deque>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
 
 #include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/timestamp_stitcher.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/dns/types.h"
 
 namespace px {
@@ -34,9 +38,8 @@ namespace stirling {
 namespace protocols {
 namespace dns {
 
+// Built by hand, since this runs for every message, and the fields are all numbers.
 std::string HeaderToJSONString(const DNSHeader& header) {
-  rapidjson::Document d(rapidjson::kObjectType);
-
   int qr = EXTRACT_DNS_FLAG(header.flags, kQRPos, kQRWidth);
   int opcode = EXTRACT_DNS_FLAG(header.flags, kOpcodePos, kOpcodeWidth);
   int aa = EXTRACT_DNS_FLAG(header.flags, kAAPos, kAAWidth);
@@ -47,25 +50,12 @@ std::string HeaderToJSONString(const DNSHeader& header) {
   int cd = EXTRACT_DNS_FLAG(header.flags, kCDPos, kCDWidth);
   int rcode = EXTRACT_DNS_FLAG(header.flags, kRcodePos, kRcodeWidth);
 
-  d.AddMember("txid", header.txid, d.GetAllocator());
-  d.AddMember("qr", qr, d.GetAllocator());
-  d.AddMember("opcode", opcode, d.GetAllocator());
-  d.AddMember("aa", aa, d.GetAllocator());
-  d.AddMember("tc", tc, d.GetAllocator());
-  d.AddMember("rd", rd, d.GetAllocator());
-  d.AddMember("ra", ra, d.GetAllocator());
-  d.AddMember("ad", ad, d.GetAllocator());
-  d.AddMember("cd", cd, d.GetAllocator());
-  d.AddMember("rcode", rcode, d.GetAllocator());
-  d.AddMember("num_queries", header.num_queries, d.GetAllocator());
-  d.AddMember("num_answers", header.num_answers, d.GetAllocator());
-  d.AddMember("num_auth", header.num_auth, d.GetAllocator());
-  d.AddMember("num_addl", header.num_addl, d.GetAllocator());
-
-  rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  d.Accept(writer);
-  return std::string(sb.GetString());
+  return absl::StrCat(R"({"txid":)", header.txid, R"(,"qr":)", qr, R"(,"opcode":)", opcode,
+                      R"(,"aa":)", aa, R"(,"tc":)", tc, R"(,"rd":)", rd, R"(,"ra":)", ra,
+                      R"(,"ad":)", ad, R"(,"cd":)", cd, R"(,"rcode":)", rcode,
+                      R"(,"num_queries":)", header.num_queries, R"(,"num_answers":)",
+                      header.num_answers, R"(,"num_auth":)", header.num_auth,
+                      R"(,"num_addl":)", header.num_addl, "}");
 }
 
 std::string_view DNSRecordTypeName(InetAddrFamily addr_family) {
@@ -88,15 +78,12 @@ std::string_view DNSRecordTypeName(InetAddrFamily addr_family) {
   return type_name;
 }
 
-void ProcessReq(const Frame& req_frame, Request* req) {
-  req->timestamp_ns = req_frame.timestamp_ns;
-  req->header = HeaderToJSONString(req_frame.header);
-
+std::string QueriesToJSONString(const std::vector<DNSRecord>& records) {
   rapidjson::Document d;
   d.SetObject();
 
   rapidjson::Value queries(rapidjson::kArrayType);
-  for (const auto& r : req_frame.records()) {
+  for (const auto& r : records) {
     const std::string& name = r.name;
     std::string_view type_name = DNSRecordTypeName(r.addr.family);
 
@@ -113,13 +100,10 @@ void ProcessReq(const Frame& req_frame, Request* req) {
   rapidjson::StringBuffer sb;
   rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
   d.Accept(writer);
-  req->query = std::string(sb.GetString());
+  return std::string(sb.GetString());
 }
 
-void ProcessResp(const Frame& resp_frame, Response* resp) {
-  resp->timestamp_ns = resp_frame.timestamp_ns;
-  resp->header = HeaderToJSONString(resp_frame.header);
-
+std::string AnswersToJSONString(const std::vector<DNSRecord>& records) {
   rapidjson::Document d;
   d.SetObject();
 
@@ -128,7 +112,7 @@ void ProcessResp(const Frame& resp_frame, Response* resp) {
   std::vector<std::string> addr_strs;
 
   rapidjson::Value answers(rapidjson::kArrayType);
-  for (const auto& r : resp_frame.records()) {
+  for (const auto& r : records) {
     const std::string& name = r.name;
     std::string_view type_name;
 
@@ -159,15 +143,69 @@ void ProcessResp(const Frame& resp_frame, Response* resp) {
   rapidjson::StringBuffer sb;
   rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
   d.Accept(writer);
-  resp->msg = std::string(sb.GetString());
+  return std::string(sb.GetString());
+}
+
+// Appends everything the JSON of a record depends on. Strings are length-prefixed and the
+// address is appended as raw bytes, so that distinct records never produce the same key.
+void AppendRecordKey(const DNSRecord& r, std::string* key) {
+  absl::StrAppend(key, r.name.size(), ":", r.name, r.cname.size(), ":", r.cname);
+  key->push_back(static_cast<char>(r.addr.family));
+  if (r.addr.family == InetAddrFamily::kIPv4) {
+    const auto& addr = std::get<struct in_addr>(r.addr.addr);
+    key->append(reinterpret_cast<const char*>(&addr), sizeof(addr));
+  } else if (r.addr.family == InetAddrFamily::kIPv6) {
+    const auto& addr = std::get<struct in6_addr>(r.addr.addr);
+    key->append(reinterpret_cast<const char*>(&addr), sizeof(addr));
+  }
+}
+
+// Returns the cached JSON for the records, or builds it with make_json and caches it.
+template <typename TMakeJSONFn>
+std::string GetCachedJSON(const std::vector<DNSRecord>& records,
+                          absl::flat_hash_map<std::string, std::string>* cache, State* state,
+                          TMakeJSONFn make_json) {
+  state->key_buf.clear();
+  for (const auto& r : records) {
+    AppendRecordKey(r, &state->key_buf);
+  }
+
+  auto iter = cache->find(state->key_buf);
+  if (iter != cache->end()) {
+    ++state->cache_hits;
+    return iter->second;
+  }
+
+  ++state->cache_misses;
+  if (cache->size() >= State::kMaxCacheEntries) {
+    cache->clear();
+  }
+  std::string json = make_json(records);
+  cache->emplace(state->key_buf, json);
+  return json;
 }
 
-StatusOr<Record> ProcessReqRespPair(const Frame& req_frame, const Frame& resp_frame) {
+void ProcessReq(const Frame& req_frame, Request* req, State* state) {
+  req->timestamp_ns = req_frame.timestamp_ns;
+  req->header = HeaderToJSONString(req_frame.header);
+  req->query = GetCachedJSON(req_frame.records(), &state->query_json_cache, state,
+                             QueriesToJSONString);
+}
+
+void ProcessResp(const Frame& resp_frame, Response* resp, State* state) {
+  resp->timestamp_ns = resp_frame.timestamp_ns;
+  resp->header = HeaderToJSONString(resp_frame.header);
+  resp->msg = GetCachedJSON(resp_frame.records(), &state->answer_json_cache, state,
+                            AnswersToJSONString);
+}
+
+StatusOr<Record> ProcessReqRespPair(const Frame& req_frame, const Frame& resp_frame,
+                                    State* state) {
   ECHECK_LT(req_frame.timestamp_ns, resp_frame.timestamp_ns);
 
   Record r;
-  ProcessReq(req_frame, &r.req);
-  ProcessResp(resp_frame, &r.resp);
+  ProcessReq(req_frame, &r.req, state);
+  ProcessResp(resp_frame, &r.resp, state);
 
   return r;
 }
@@ -176,68 +214,29 @@ StatusOr<Record> ProcessReqRespPair(const Frame& req_frame, const Frame& resp_fr
 // For each response that is at the head of the deque, there should exist a previous request with
 // the same txid. Find it, and consume both frames.
 RecordsWithErrorCount<Record> StitchFrames(std::deque<Frame>* req_frames,
-                                           std::deque<Frame>* resp_frames) {
+                                           std::deque<Frame>* resp_frames, State* state) {
   std::vector<Record> entries;
-  int error_count = 0;
-
-  for (auto& resp_frame : *resp_frames) {
-    bool found_match = false;
-
-    // Search for matching req frame
-    for (auto& req_frame : *req_frames) {
-      // If the request timestamp is after the response, then it can't be the match.
-      // Nor can any subsequent requests either, so stop searching.
-      if (req_frame.timestamp_ns > resp_frame.timestamp_ns) {
-        break;
-      }
-
-      if (resp_frame.header.txid == req_frame.header.txid) {
-        StatusOr<Record> record_status = ProcessReqRespPair(req_frame, resp_frame);
-        if (record_status.ok()) {
-          entries.push_back(record_status.ConsumeValueOrDie());
-        } else {
+  entries.reserve(resp_frames->size());
+
+  // TODO(oazizi): Consider removing requests that are too old, otherwise a lost response can mean
+  // the are never processed. This would result in a memory leak until the more drastic connection
+  // tracker clean-up mechanisms kick in.
+  int error_count = StitchResponsesToRequests(
+      req_frames, resp_frames,
+      [](const Frame& req_frame, const Frame& resp_frame) {
+        return req_frame.header.txid == resp_frame.header.txid;
+      },
+      [&entries, state](Frame* req_frame, Frame* resp_frame) {
+        StatusOr<Record> record_status = ProcessReqRespPair(*req_frame, *resp_frame, state);
+        if (!record_status.ok()) {
           VLOG(1) << record_status.ToString();
-          ++error_count;
+          return false;
         }
+        entries.push_back(record_status.ConsumeValueOrDie());
+        return true;
+      });
 
-        // Found a match, so remove both request and response.
-        // We don't remove request frames on the fly, however,
-        // because it could otherwise cause unnecessary churn/copying in the deque.
-        // This is due to the fact that responses can come out-of-order.
-        // Just mark the request as consumed, and clean-up when they reach the head of the queue.
-        // Note that responses are always head-processed, so they don't require this optimization.
-        found_match = true;
-        req_frame.consumed = true;
-        break;
-      }
-    }
-
-    if (!found_match) {
-      VLOG(1) << absl::Substitute("Did not find a request matching the response. TXID = $0",
-                                  resp_frame.header.txid);
-      ++error_count;
-    }
-
-    // Clean-up consumed frames at the head.
-    // Do this inside the resp loop to aggressively clean-out req_frames whenever a frame consumed.
-    // Should speed up the req_frames search for the next iteration.
-    auto it = req_frames->begin();
-    while (it != req_frames->end()) {
-      if (!(*it).consumed) {
-        break;
-      }
-      it++;
-    }
-    req_frames->erase(req_frames->begin(), it);
-
-    // TODO(oazizi): Consider removing requests that are too old, otherwise a lost response can mean
-    // the are never processed. This would result in a memory leak until the more drastic connection
-    // tracker clean-up mechanisms kick in.
-  }
-
-  resp_frames->clear();
-
-  return {entries, error_count};
+  return {std::move(entries), error_count};
 }
 
 }  // namespace dns
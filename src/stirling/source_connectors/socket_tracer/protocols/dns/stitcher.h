@@ -36,18 +36,19 @@ namespace dns {
  *
  * @param req_packets: deque of all request frames.
  * @param resp_packets: deque of all response frames.
+ * @param state: per-connection cache of query and answer JSON.
  * @return A vector of entries to be appended to table store.
  */
 RecordsWithErrorCount<Record> StitchFrames(std::deque<Frame>* req_packets,
-                                           std::deque<Frame>* resp_packets);
+                                           std::deque<Frame>* resp_packets, State* state);
 
 }  // namespace dns
 
 template <>
 inline RecordsWithErrorCount<dns::Record> StitchFrames(std::deque<dns::Frame>* req_packets,
                                                        std::deque<dns::Frame>* resp_packets,
-                                                       NoState* /* state */) {
-  return dns::StitchFrames(req_packets, resp_packets);
+                                                       dns::StateWrapper* state) {
+  return dns::StitchFrames(req_packets, resp_packets, &state->global);
 }
 
 }  // namespace protocols
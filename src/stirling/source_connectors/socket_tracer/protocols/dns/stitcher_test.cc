@@ -73,6 +73,7 @@ TEST(DnsStitcherTest, RecordOutput) {
   std::deque<Frame> req_frames;
   std::deque<Frame> resp_frames;
   RecordsWithErrorCount<Record> result;
+  State state;
 
   InetAddr ip_addr;
   ip_addr.family = InetAddrFamily::kIPv4;
@@ -90,7 +91,7 @@ TEST(DnsStitcherTest, RecordOutput) {
   req_frames.push_back(req0_frame);
   resp_frames.push_back(resp0_frame);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(req_frames.size(), 0);
   EXPECT_EQ(result.error_count, 0);
@@ -115,6 +116,7 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
   std::deque<Frame> req_frames;
   std::deque<Frame> resp_frames;
   RecordsWithErrorCount<Record> result;
+  State state;
 
   int t = 0;
 
@@ -125,7 +127,7 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
   Frame req2_frame = CreateReqFrame(++t, 2);
   Frame resp2_frame = CreateRespFrame(++t, 2, std::vector<DNSRecord>());
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(req_frames.size(), 0);
   EXPECT_EQ(result.error_count, 0);
@@ -134,7 +136,7 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
   req_frames.push_back(req0_frame);
   req_frames.push_back(req1_frame);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(req_frames.size(), 2);
   EXPECT_EQ(result.error_count, 0);
@@ -142,7 +144,7 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
 
   resp_frames.push_back(resp1_frame);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(req_frames.size(), 2);
   EXPECT_EQ(result.error_count, 0);
@@ -151,7 +153,7 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
   req_frames.push_back(req2_frame);
   resp_frames.push_back(resp0_frame);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(req_frames.size(), 1);
   EXPECT_EQ(result.error_count, 0);
@@ -159,19 +161,58 @@ TEST(DnsStitcherTest, OutOfOrderMatching) {
 
   resp_frames.push_back(resp2_frame);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(resp_frames.size(), 0);
   EXPECT_EQ(result.error_count, 0);
   EXPECT_EQ(result.records.size(), 1);
 
-  result = StitchFrames(&req_frames, &resp_frames);
+  result = StitchFrames(&req_frames, &resp_frames, &state);
   EXPECT_TRUE(resp_frames.empty());
   EXPECT_EQ(resp_frames.size(), 0);
   EXPECT_EQ(result.error_count, 0);
   EXPECT_EQ(result.records.size(), 0);
 }
 
+TEST(DnsStitcherTest, RepeatedAnswersUseCache) {
+  std::deque<Frame> req_frames;
+  std::deque<Frame> resp_frames;
+  State state;
+
+  InetAddr ip_addr;
+  ip_addr.family = InetAddrFamily::kIPv4;
+  struct in_addr addr_tmp;
+  PL_CHECK_OK(ParseIPv4Addr("1.2.3.4", &addr_tmp));
+  ip_addr.addr = addr_tmp;
+
+  InetAddr other_ip_addr = ip_addr;
+  PL_CHECK_OK(ParseIPv4Addr("1.2.3.5", &addr_tmp));
+  other_ip_addr.addr = addr_tmp;
+
+  int t = 0;
+  for (int i = 0; i < 3; ++i) {
+    req_frames.push_back(CreateReqFrame(++t, i));
+    resp_frames.push_back(CreateRespFrame(++t, i, {DNSRecord{"pixie.ai", "", ip_addr}}));
+  }
+  req_frames.push_back(CreateReqFrame(++t, 3));
+  resp_frames.push_back(CreateRespFrame(++t, 3, {DNSRecord{"pixie.ai", "", other_ip_addr}}));
+
+  RecordsWithErrorCount<Record> result = StitchFrames(&req_frames, &resp_frames, &state);
+  EXPECT_EQ(result.error_count, 0);
+  ASSERT_EQ(result.records.size(), 4);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(result.records[i].resp.msg,
+              R"({"answers":[{"name":"pixie.ai","type":"A","addr":"1.2.3.4"}]})");
+  }
+  EXPECT_EQ(result.records[3].resp.msg,
+            R"({"answers":[{"name":"pixie.ai","type":"A","addr":"1.2.3.5"}]})");
+
+  // The queries are all the same, and so are the first three answers.
+  EXPECT_EQ(state.cache_hits, 3 + 2);
+  EXPECT_EQ(state.cache_misses, 1 + 2);
+}
+
 }  // namespace dns
 }  // namespace protocols
 }  // namespace stirling
@@ -22,8 +22,10 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <magic_enum.hpp>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"  // For FrameBase.
@@ -158,10 +160,37 @@ struct Record {
   }
 };
 
+//-----------------------------------------------------------------------------
+// State
+//-----------------------------------------------------------------------------
+
+// DNS servers see the same lookups over and over, so the JSON of queries and answers is cached per
+// connection, keyed by the records it is made from.
+struct State {
+  // A cache is cleared when it reaches this size, which bounds its memory.
+  static constexpr size_t kMaxCacheEntries = 1024;
+
+  absl::flat_hash_map<std::string, std::string> query_json_cache;
+  absl::flat_hash_map<std::string, std::string> answer_json_cache;
+
+  // Reused to build the cache keys, so that a cache hit does not allocate.
+  std::string key_buf;
+
+  // Lookups since the last time these were reported.
+  uint64_t cache_hits = 0;
+  uint64_t cache_misses = 0;
+};
+
+struct StateWrapper {
+  State global;
+  std::monostate send;
+  std::monostate recv;
+};
+
 struct ProtocolTraits : public BaseProtocolTraits<Record> {
   using frame_type = Frame;
   using record_type = Record;
-  using state_type = NoState;
+  using state_type = StateWrapper;
 };
 
 }  // namespace dns
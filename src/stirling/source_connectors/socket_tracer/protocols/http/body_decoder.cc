@@ -194,6 +194,27 @@ ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_byte
   return ParseState::kSuccess;
 }
 
+size_t ChunkedBodyMinSize(std::string_view data) {
+  size_t pos = 0;
+  while (true) {
+    std::string_view chunk = data.substr(pos);
+    size_t chunk_len = 0;
+    ParseState s = ExtractChunkLength(&chunk, &chunk_len);
+    if (s == ParseState::kInvalid) {
+      return 0;
+    }
+    // The chunk header, or the trailers after the last chunk, are still incomplete.
+    if (s == ParseState::kNeedsMoreData || chunk_len == 0) {
+      return data.size() + 1;
+    }
+    size_t chunk_end = (data.size() - chunk.size()) + chunk_len + kDelimiterLen;
+    if (chunk_end > data.size()) {
+      return chunk_end;
+    }
+    pos = chunk_end;
+  }
+}
+
 // Parse an HTTP chunked body using pico's parser. This implementation
 // has the disadvantage that it incurs a potentially expensive copy even when
 // the final result is kNeedsMoreData.
@@ -43,6 +43,15 @@ namespace http {
 ParseState ParseChunked(std::string_view* buf, size_t body_size_limit_bytes, std::string* result,
                         size_t* body_size);
 
+/**
+ * Returns the number of bytes an incomplete HTTP chunked body needs, at least, before it can be
+ * parsed: up to the end of its first incomplete chunk. Only the chunk headers are looked at.
+ *
+ * @param data The data buffer, starting at the chunked body.
+ * @return The number of bytes needed, or 0 if the body is malformed.
+ */
+size_t ChunkedBodyMinSize(std::string_view data);
+
 /**
  * Parse an HTTP body based on Content-Length.
  *
@@ -24,9 +24,22 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/stitcher.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 
 DEFINE_int32(http_body_limit_bytes, 1024,
              "The amount of an HTTP body that will be returned on a parse");
+DEFINE_bool(stirling_http_parse_all_headers,
+            gflags::BoolFromEnv("PL_STIRLING_HTTP_PARSE_ALL_HEADERS", false),
+            "If true, all the headers of HTTP messages are parsed into a map. Otherwise only the "
+            "headers the tracer inspects are, and the headers columns are built from the "
+            "message head when the record is written.");
+DEFINE_bool(stirling_http_record_headers,
+            gflags::BoolFromEnv("PL_STIRLING_HTTP_RECORD_HEADERS", true),
+            "If false, the req_headers and resp_headers columns of the HTTP table are left empty, "
+            "and HTTP messages only keep the headers the tracer inspects.");
 
 namespace px {
 namespace stirling {
@@ -74,14 +87,69 @@ int ParseResponse(std::string_view buf, HTTPResponse* result) {
                             /*last_len*/ 0);
 }
 
-HeadersMap GetHTTPHeadersMap(const phr_header* headers, size_t num_headers) {
-  HeadersMap result;
+// Returns true for headers that the parser, the stitcher or the HTTP table look at.
+bool IsInspectedHeader(std::string_view name) {
+  static constexpr std::string_view kInspectedHeaders[] = {
+      kContentEncoding, kContentLength, kContentType, kTransferEncoding, kUpgrade};
+  // The header filters can name any header. Parse the flags on the first time only.
+  static const std::vector<std::string> kFilterHeaders = [] {
+    std::vector<std::string> names;
+    HTTPHeaderFilter filter = ParseHTTPHeaderFilters(FLAGS_http_response_header_filters);
+    for (const auto& [header, substr] : filter.inclusions) {
+      names.emplace_back(header);
+    }
+    for (const auto& [header, substr] : filter.exclusions) {
+      names.emplace_back(header);
+    }
+    return names;
+  }();
+
+  for (std::string_view header : kInspectedHeaders) {
+    if (absl::EqualsIgnoreCase(name, header)) {
+      return true;
+    }
+  }
+  for (std::string_view header : kFilterHeaders) {
+    if (absl::EqualsIgnoreCase(name, header)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Fills in the headers of result from the ones pico parsed out of head, the message up to and
+// including the empty line that ends the headers.
+void GetHTTPHeaders(std::string_view head, const phr_header* headers, size_t num_headers,
+                    Arena* arena, Message* result) {
+  result->headers = HeadersMap{HeadersMap::allocator_type(ArenaAllocator<char>(arena))};
+  const bool parse_all = FLAGS_stirling_http_parse_all_headers;
+  for (size_t i = 0; i < num_headers; i++) {
+    std::string_view name(headers[i].name, headers[i].name_len);
+    if (parse_all || IsInspectedHeader(name)) {
+      result->headers.emplace(name, std::string_view(headers[i].value, headers[i].value_len));
+    }
+  }
+  if (parse_all || !FLAGS_stirling_http_record_headers) {
+    return;
+  }
+
+  // Keep the head as a whole, so the headers columns can be built when the record is written,
+  // without allocating every header on the way.
+  result->raw_headers = HeaderString(head, ArenaAllocator<char>(arena));
+  result->header_fields =
+      std::vector<HeaderField, ArenaAllocator<HeaderField>>(ArenaAllocator<HeaderField>(arena));
+  result->header_fields.reserve(num_headers);
   for (size_t i = 0; i < num_headers; i++) {
-    std::string name(headers[i].name, headers[i].name_len);
-    std::string value(headers[i].value, headers[i].value_len);
-    result.emplace(std::move(name), std::move(value));
+    HeaderField field;
+    // Pico leaves the name of continuation lines of multi-line headers null.
+    if (headers[i].name != nullptr) {
+      field.name_pos = headers[i].name - head.data();
+      field.name_len = headers[i].name_len;
+    }
+    field.value_pos = headers[i].value - head.data();
+    field.value_len = headers[i].value_len;
+    result->header_fields.push_back(field);
   }
-  return result;
 }
 
 }  // namespace pico_wrapper
@@ -210,16 +278,17 @@ ParseState ParseResponseBody(std::string_view* buf, Message* result, State* stat
   return ParseState::kNeedsMoreData;
 }
 
-ParseState ParseRequest(std::string_view* buf, Message* result) {
+ParseState ParseRequest(std::string_view* buf, Message* result, State* state) {
   pico_wrapper::HTTPRequest req;
   int retval = pico_wrapper::ParseRequest(*buf, &req);
 
   if (retval >= 0) {
+    pico_wrapper::GetHTTPHeaders(buf->substr(0, retval), req.headers, req.num_headers,
+                                 state->frame_arena, result);
     buf->remove_prefix(retval);
 
     result->type = message_type_t::kRequest;
     result->minor_version = req.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(req.headers, req.num_headers);
     result->req_method = std::string(req.method, req.method_len);
     result->req_path = std::string(req.path, req.path_len);
     result->headers_byte_size = retval;
@@ -237,11 +306,12 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
   int retval = pico_wrapper::ParseResponse(*buf, &resp);
 
   if (retval >= 0) {
+    pico_wrapper::GetHTTPHeaders(buf->substr(0, retval), resp.headers, resp.num_headers,
+                                 state->frame_arena, result);
     buf->remove_prefix(retval);
 
     result->type = message_type_t::kResponse;
     result->minor_version = resp.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(resp.headers, resp.num_headers);
     result->resp_status = resp.status;
     result->resp_message = std::string(resp.msg, resp.msg_len);
     result->headers_byte_size = retval;
@@ -254,6 +324,53 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
   return ParseState::kInvalid;
 }
 
+size_t PendingFrameSize(message_type_t type, std::string_view buf) {
+  const phr_header* headers = nullptr;
+  size_t num_headers = 0;
+  int retval = -1;
+  pico_wrapper::HTTPRequest req;
+  pico_wrapper::HTTPResponse resp;
+  if (type == message_type_t::kRequest) {
+    retval = pico_wrapper::ParseRequest(buf, &req);
+    headers = req.headers;
+    num_headers = req.num_headers;
+  } else if (type == message_type_t::kResponse) {
+    retval = pico_wrapper::ParseResponse(buf, &resp);
+    headers = resp.headers;
+    num_headers = resp.num_headers;
+  }
+  if (retval < 0) {
+    return 0;
+  }
+  std::string_view body = buf.substr(retval);
+
+  if (type == message_type_t::kResponse) {
+    // A response to a HEAD request has no body, which ParseResponseBody() only tells from the
+    // next response following it. So the size is only known once some of the body is in.
+    if (body.size() < 4 || absl::StartsWith(body, "HTTP")) {
+      return 0;
+    }
+  }
+
+  for (size_t i = 0; i < num_headers; ++i) {
+    std::string_view name(headers[i].name, headers[i].name_len);
+    std::string_view value(headers[i].value, headers[i].value_len);
+    if (absl::EqualsIgnoreCase(name, kContentLength)) {
+      size_t len = 0;
+      return absl::SimpleAtoi(value, &len) ? retval + len : 0;
+    }
+  }
+  for (size_t i = 0; i < num_headers; ++i) {
+    std::string_view name(headers[i].name, headers[i].name_len);
+    std::string_view value(headers[i].value, headers[i].value_len);
+    if (absl::EqualsIgnoreCase(name, kTransferEncoding) && value == "chunked") {
+      size_t body_size = ChunkedBodyMinSize(body);
+      return body_size == 0 ? 0 : retval + body_size;
+    }
+  }
+  return 0;
+}
+
 /**
  * Parses a raw input buffer for HTTP messages.
  * HTTP headers are parsed by pico. Body is extracted separately.
@@ -267,7 +384,7 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
 ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* result, State* state) {
   switch (type) {
     case message_type_t::kRequest:
-      return ParseRequest(buf, result);
+      return ParseRequest(buf, result, state);
     case message_type_t::kResponse:
       return ParseResponse(buf, result, state);
     default:
@@ -366,6 +483,12 @@ size_t FindFrameBoundary<http::Message>(message_type_t type, std::string_view bu
   return http::FindFrameBoundary(type, buf, start_pos);
 }
 
+template <>
+size_t PendingFrameSize<http::Message>(message_type_t type, std::string_view buf,
+                                       http::StateWrapper* /*state*/) {
+  return http::PendingFrameSize(type, buf);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -25,10 +25,21 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/types.h"
 
 DECLARE_int32(http_body_limit_bytes);
+DECLARE_bool(stirling_http_parse_all_headers);
+DECLARE_bool(stirling_http_record_headers);
 
 namespace px {
 namespace stirling {
 namespace protocols {
+namespace http {
+
+/**
+ * Returns the size of the incomplete message at the start of buf, or 0 if it isn't known yet.
+ * For chunked bodies, the size only runs to the end of the first incomplete chunk.
+ */
+size_t PendingFrameSize(message_type_t type, std::string_view buf);
+
+}  // namespace http
 
 /**
  * Parses a single HTTP message from the input string.
@@ -41,6 +52,10 @@ template <>
 size_t FindFrameBoundary<http::Message>(message_type_t type, std::string_view buf, size_t start_pos,
                                         http::StateWrapper* state);
 
+template <>
+size_t PendingFrameSize<http::Message>(message_type_t type, std::string_view buf,
+                                       http::StateWrapper* state);
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -25,7 +25,9 @@
 #include <vector>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/test_utils.h"
+#include "src/common/json/json.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 
 namespace px {
 namespace stirling {
@@ -273,7 +275,11 @@ struct TestParam {
 
 class HTTPParserTest : public DataStreamBufferTestWrapper,
                        public ::testing::TestWithParam<TestParam> {
-  void SetUp() { FLAGS_http_body_limit_bytes = 256; }
+  void SetUp() {
+    FLAGS_http_body_limit_bytes = 256;
+    // Most tests check all of the parsed headers.
+    FLAGS_stirling_http_parse_all_headers = true;
+  }
 };
 
 //=============================================================================
@@ -741,6 +747,68 @@ TEST_F(HTTPParserTest, PartialMessageInTheMiddleOfStream) {
   EXPECT_THAT(parsed_messages, ElementsAre(HasBody("foobar"), HasBody("pixielabs rocks!")));
 }
 
+TEST_F(HTTPParserTest, HeadersOnFrameArena) {
+  Arena arena;
+  StateWrapper state{};
+  state.global.frame_arena = &arena;
+  std::deque<Message> parsed_messages;
+  ParseResult result =
+      ParseFramesLoop(message_type_t::kRequest, kHTTPGetReq0, &parsed_messages, &state);
+
+  EXPECT_EQ(ParseState::kSuccess, result.state);
+  EXPECT_THAT(parsed_messages, ElementsAre(HTTPGetReq0ExpectedMessage()));
+  EXPECT_EQ(parsed_messages[0].headers.get_allocator().arena(), &arena);
+  EXPECT_GT(arena.bytes_used(), 0);
+}
+
+TEST_F(HTTPParserTest, OnlyInspectedHeadersParsed) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_stirling_http_parse_all_headers = false;
+  const std::string_view resp =
+      "HTTP/1.1 200 OK\r\n"
+      "X-B: 1\r\n"
+      "content-type: json\r\n"
+      "x-a: 2\r\n"
+      "Content-Length: 0\r\n"
+      "X-B: 3\r\n"
+      "\r\n";
+
+  StateWrapper state{};
+  std::deque<Message> parsed_messages;
+  ParseResult result = ParseFramesLoop(message_type_t::kResponse, resp, &parsed_messages, &state);
+  EXPECT_EQ(ParseState::kSuccess, result.state);
+  ASSERT_EQ(parsed_messages.size(), 1);
+
+  HeadersMap expected_headers = {{"content-type", "json"}, {"Content-Length", "0"}};
+  EXPECT_EQ(parsed_messages[0].headers, expected_headers);
+
+  // The headers columns still get all of the headers, in the same order as the map would have.
+  HeadersMap all_headers = {{"X-B", "1"},
+                            {"content-type", "json"},
+                            {"x-a", "2"},
+                            {"Content-Length", "0"},
+                            {"X-B", "3"}};
+  EXPECT_EQ(HeadersJSONString(parsed_messages[0]), ::px::utils::ToJSONString(all_headers));
+}
+
+TEST_F(HTTPParserTest, HeadersNotRecorded) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_stirling_http_parse_all_headers = false;
+  FLAGS_stirling_http_record_headers = false;
+
+  StateWrapper state{};
+  std::deque<Message> parsed_messages;
+  ParseResult result =
+      ParseFramesLoop(message_type_t::kRequest, kHTTPPostReq0, &parsed_messages, &state);
+  EXPECT_EQ(ParseState::kSuccess, result.state);
+  ASSERT_EQ(parsed_messages.size(), 1);
+  HeadersMap expected_headers = {{"content-type", "application/x-www-form-urlencoded"},
+                                 {"content-length", "27"}};
+  EXPECT_EQ(parsed_messages[0].headers, expected_headers);
+  EXPECT_TRUE(parsed_messages[0].raw_headers.empty());
+  EXPECT_EQ(parsed_messages[0].body, "field1=value1&field2=value2");
+}
+
 //=============================================================================
 // HTTP Parsing Stress Tests
 //=============================================================================
@@ -1190,6 +1258,30 @@ TEST_F(HTTPParserTest, ParseRespWithPartialFirstMessageWithSync) {
   EXPECT_THAT(parsed_messages, ElementsAre(HTTPResp1ExpectedMessage(), HTTPResp2ExpectedMessage()));
 }
 
+TEST(PendingFrameSizeTest, ContentLength) {
+  const std::string_view kHead = "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n";
+  EXPECT_EQ(PendingFrameSize(message_type_t::kResponse, absl::StrCat(kHead, "pixie")),
+            kHead.size() + 100);
+  // Too little of the body to tell it apart from a HEAD response.
+  EXPECT_EQ(PendingFrameSize(message_type_t::kResponse, absl::StrCat(kHead, "px")), 0);
+  // Incomplete headers.
+  EXPECT_EQ(PendingFrameSize(message_type_t::kResponse, kHead.substr(0, 20)), 0);
+
+  const std::string_view kReq = "POST /foo HTTP/1.1\r\nContent-Length: 10\r\n\r\npixie";
+  EXPECT_EQ(PendingFrameSize(message_type_t::kRequest, kReq), kReq.size() + 5);
+}
+
+TEST(PendingFrameSizeTest, Chunked) {
+  const std::string_view kHead = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+  // The first chunk is complete, so the size runs to the end of the second one.
+  const std::string kResp = absl::StrCat(kHead, "5\r\npixie\r\n10\r\nabc");
+  EXPECT_EQ(PendingFrameSize(message_type_t::kResponse, kResp),
+            kHead.size() + 10 + 4 + 16 + 2);
+  // Only the trailer is missing, which has no known size.
+  const std::string kTrailer = absl::StrCat(kHead, "5\r\npixie\r\n0\r\n");
+  EXPECT_EQ(PendingFrameSize(message_type_t::kResponse, kTrailer), kTrailer.size() + 1);
+}
+
 }  // namespace http
 }  // namespace protocols
 }  // namespace stirling
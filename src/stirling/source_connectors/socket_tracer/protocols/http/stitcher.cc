@@ -26,6 +26,7 @@
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
 #include "src/common/zlib/zlib_wrapper.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/types.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 
@@ -70,8 +71,12 @@ void PreProcessMessage(Message* message) {
 
   auto content_encoding_iter = message->headers.find(kContentEncoding);
   // Replace body with decompressed version, if required.
-  if (content_encoding_iter != message->headers.end() && content_encoding_iter->second == "gzip") {
-    message->body = px::zlib::Inflate(message->body).ConsumeValueOr("<Failed to gunzip body>");
+  // The body may have been truncated to http_body_limit_bytes before getting here, and only as
+  // much is kept after decompression, so only the beginning of the body is decompressed.
+  if (content_encoding_iter != message->headers.end() &&
+      (content_encoding_iter->second == "gzip" || content_encoding_iter->second == "deflate")) {
+    message->body = px::zlib::InflatePrefix(message->body, FLAGS_http_body_limit_bytes)
+                        .ConsumeValueOr("<Failed to decompress body>");
   }
 }
 
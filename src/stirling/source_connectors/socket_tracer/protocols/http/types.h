@@ -19,8 +19,13 @@
 #pragma once
 
 #include <chrono>
+#include <map>
+#include <scoped_allocator>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "src/common/base/arena.h"
 #include "src/common/base/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"  // For FrameBase
 
@@ -38,7 +43,15 @@ using ::px::operator<<;
 
 // HTTP1.x headers can have multiple values for the same name, and field names are case-insensitive:
 // https://www.w3.org/Protocols/rfc2616/rfc2616-sec4.html#sec4.2
-using HeadersMap = std::multimap<std::string, std::string, CaseInsensitiveLess>;
+//
+// Headers account for most of the allocations of a parsed message, so the map and its strings
+// can be placed on the ConnTracker's frame arena (see State::frame_arena). A default-constructed
+// HeadersMap uses the heap.
+using HeaderString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+using HeadersMap =
+    std::multimap<HeaderString, HeaderString, CaseInsensitiveLess,
+                  std::scoped_allocator_adaptor<
+                      ArenaAllocator<std::pair<const HeaderString, HeaderString>>>>;
 
 inline constexpr char kContentEncoding[] = "Content-Encoding";
 inline constexpr char kContentLength[] = "Content-Length";
@@ -46,11 +59,24 @@ inline constexpr char kContentType[] = "Content-Type";
 inline constexpr char kTransferEncoding[] = "Transfer-Encoding";
 inline constexpr char kUpgrade[] = "Upgrade";
 
+// The position of the name and value of a header in Message::raw_headers.
+struct HeaderField {
+  uint32_t name_pos = 0;
+  uint32_t name_len = 0;
+  uint32_t value_pos = 0;
+  uint32_t value_len = 0;
+};
+
 struct Message : public FrameBase {
   message_type_t type = message_type_t::kUnknown;
 
   int minor_version = -1;
+  // Unless --stirling_http_parse_all_headers is set, the parser only puts the headers the tracer
+  // inspects in the map. The headers columns are then built from the message head as received,
+  // and the positions of all of its headers.
   HeadersMap headers = {};
+  HeaderString raw_headers = {};
+  std::vector<HeaderField, ArenaAllocator<HeaderField>> header_fields = {};
 
   std::string req_method = "-";
   std::string req_path = "-";
@@ -102,6 +128,10 @@ struct Record {
 
 struct State {
   bool conn_closed = false;
+
+  // Arena for the headers of parsed messages. Owned by the ConnTracker, which resets it once
+  // all the messages it holds have been consumed. If null, headers are allocated on the heap.
+  Arena* frame_arena = nullptr;
 };
 
 struct StateWrapper {
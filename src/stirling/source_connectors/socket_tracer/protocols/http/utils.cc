@@ -18,7 +18,12 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
+#include <vector>
+
+#include "src/common/json/json.h"
 
 namespace px {
 namespace stirling {
@@ -29,7 +34,7 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
   if (!filter.inclusions.empty()) {
     bool included = false;
     for (auto [http_header, substr] : filter.inclusions) {
-      auto http_header_iter = http_headers.find(std::string(http_header));
+      auto http_header_iter = http_headers.find(HeaderString(http_header));
       if (http_header_iter != http_headers.end() &&
           absl::StrContains(http_header_iter->second, substr)) {
         included = true;
@@ -45,7 +50,7 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
   if (!filter.exclusions.empty()) {
     bool excluded = false;
     for (auto [http_header, substr] : filter.exclusions) {
-      auto http_header_iter = http_headers.find(std::string(http_header));
+      auto http_header_iter = http_headers.find(HeaderString(http_header));
       if (http_header_iter != http_headers.end() &&
           absl::StrContains(http_header_iter->second, substr)) {
         excluded = true;
@@ -74,6 +79,28 @@ HTTPHeaderFilter ParseHTTPHeaderFilters(std::string_view filters) {
   return result;
 }
 
+std::string HeadersJSONString(const Message& message) {
+  if (message.header_fields.empty()) {
+    return ::px::utils::ToJSONString(message.headers);
+  }
+  std::string_view head = message.raw_headers;
+  std::vector<std::pair<std::string_view, std::string_view>> headers;
+  headers.reserve(message.header_fields.size());
+  for (const auto& field : message.header_fields) {
+    headers.emplace_back(head.substr(field.name_pos, field.name_len),
+                         head.substr(field.value_pos, field.value_len));
+  }
+  // Same order as the headers map: by name, and then in order of arrival.
+  std::stable_sort(headers.begin(), headers.end(), [](const auto& lhs, const auto& rhs) {
+    return CaseInsensitiveLess()(lhs.first, rhs.first);
+  });
+  ::px::utils::JSONObjectBuilder builder;
+  for (const auto& [name, value] : headers) {
+    builder.WriteKV(name, value);
+  }
+  return builder.GetString();
+}
+
 bool IsJSONContent(const Message& message) {
   auto content_type_iter = message.headers.find(kContentType);
   if (content_type_iter == message.headers.end()) {
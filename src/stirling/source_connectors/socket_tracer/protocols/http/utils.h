@@ -64,6 +64,12 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
  */
 bool IsJSONContent(const Message& message);
 
+/**
+ * Returns the headers of an HTTP message as a JSON object, with the headers ordered by name.
+ * Uses the message head kept by the parser if there is one, and the headers map otherwise.
+ */
+std::string HeadersJSONString(const Message& message);
+
 }  // namespace http
 }  // namespace protocols
 }  // namespace stirling
@@ -19,29 +19,12 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/http2_streams_container.h"
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace px {
 namespace stirling {
 
-namespace {
-
-void EraseExpiredStreams(std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp,
-                         absl::flat_hash_map<uint32_t, protocols::http2::Stream>* streams) {
-  auto iter = streams->begin();
-  while (iter != streams->end()) {
-    const auto& stream = iter->second;
-    uint64_t timestamp_ns = std::max(stream.send.timestamp_ns, stream.recv.timestamp_ns);
-    auto last_activity =
-        std::chrono::time_point<std::chrono::steady_clock>(std::chrono::nanoseconds(timestamp_ns));
-
-    if (expiry_timestamp < last_activity) {
-      break;
-    }
-    streams->erase(iter++);
-  }
-}
-}  // namespace
-
 size_t HTTP2StreamsContainer::StreamsSize() const {
   size_t size = 0;
   for (const auto& [id, stream] : streams_) {
@@ -50,16 +33,46 @@ size_t HTTP2StreamsContainer::StreamsSize() const {
   return size;
 }
 
-void HTTP2StreamsContainer::Cleanup(
+HTTP2StreamsContainer::CleanupStats HTTP2StreamsContainer::Cleanup(
     size_t size_limit_bytes, std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp) {
+  CleanupStats stats;
+
+  const auto expiry_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(expiry_timestamp.time_since_epoch())
+          .count());
+  for (auto iter = streams_.begin(); iter != streams_.end();) {
+    if (iter->second.last_activity_ns() <= expiry_ns) {
+      streams_.erase(iter++);
+      ++stats.num_expired;
+    } else {
+      ++iter;
+    }
+  }
+
   size_t size = StreamsSize();
   if (size > size_limit_bytes) {
-    VLOG(1) << absl::Substitute("HTTP2 streams cleared due to size limit ($0 > $1).", size,
-                                size_limit_bytes);
-    streams_.clear();
+    std::vector<std::pair<uint64_t, uint32_t>> activity_and_ids;
+    activity_and_ids.reserve(streams_.size());
+    for (const auto& [id, stream] : streams_) {
+      activity_and_ids.emplace_back(stream.last_activity_ns(), id);
+    }
+    std::sort(activity_and_ids.begin(), activity_and_ids.end());
+
+    for (const auto& [last_activity_ns, id] : activity_and_ids) {
+      if (size <= size_limit_bytes) {
+        break;
+      }
+      auto iter = streams_.find(id);
+      size -= iter->second.ByteSize();
+      streams_.erase(iter);
+      ++stats.num_evicted;
+    }
+    VLOG(1) << absl::Substitute("Evicted $0 HTTP2 streams due to size limit ($1).",
+                                stats.num_evicted, size_limit_bytes);
   }
 
-  EraseExpiredStreams(expiry_timestamp, &streams_);
+  stats.remaining_bytes = size;
+  return stats;
 }
 
 protocols::http2::HalfStream* HTTP2StreamsContainer::HalfStreamPtr(uint32_t stream_id,
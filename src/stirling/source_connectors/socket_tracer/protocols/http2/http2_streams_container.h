@@ -53,17 +53,27 @@ class HTTP2StreamsContainer : NotCopyMoveable {
    */
   size_t StreamsSize() const;
 
-  /**
-   * Cleans up the HTTP2 events from BPF uprobes that are too old,
-   * either because they are too far back in time, or too far back in bytes.
-   */
-  void Cleanup(size_t size_limit_bytes,
-               std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp);
+  struct CleanupStats {
+    size_t num_expired = 0;
+    size_t num_evicted = 0;
+    // Approximate memory consumption after the cleanup.
+    size_t remaining_bytes = 0;
+
+    CleanupStats& operator+=(const CleanupStats& other) {
+      num_expired += other.num_expired;
+      num_evicted += other.num_evicted;
+      remaining_bytes += other.remaining_bytes;
+      return *this;
+    }
+  };
 
   /**
-   * Erase n stream IDs from the head of the streams container.
+   * Cleans up the HTTP2 streams that have been idle since before expiry_timestamp. Then, if the
+   * streams still use more than size_limit_bytes, evicts the least recently active streams until
+   * they fit, so that a few long-lived streaming RPCs cannot hold the memory budget.
    */
-  void EraseHead(size_t n);
+  CleanupStats Cleanup(size_t size_limit_bytes,
+                       std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp);
 
   std::string DebugString(std::string_view prefix) const;
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/http2_streams_container.h"
+
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+class HTTP2StreamsContainerTest : public ::testing::Test {
+ protected:
+  void AddHeader(uint32_t stream_id, uint64_t timestamp_ns) {
+    protocols::http2::HalfStream* half_stream = container_.HalfStreamPtr(stream_id, true);
+    half_stream->AddHeader(":path", "/greeter.Greeter/SayHello");
+    half_stream->UpdateTimestamp(timestamp_ns);
+  }
+
+  std::vector<uint32_t> StreamIDs() const {
+    std::vector<uint32_t> ids;
+    for (const auto& [id, stream] : container_.streams()) {
+      ids.push_back(id);
+    }
+    return ids;
+  }
+
+  static std::chrono::time_point<std::chrono::steady_clock> TimePoint(uint64_t ns) {
+    return std::chrono::time_point<std::chrono::steady_clock>(std::chrono::nanoseconds(ns));
+  }
+
+  HTTP2StreamsContainer container_;
+};
+
+// A stream that started long ago, but is still active, must not be expired.
+TEST_F(HTTP2StreamsContainerTest, ExpiresByLastActivity) {
+  AddHeader(1, 100);
+  AddHeader(3, 200);
+  AddHeader(1, 300);
+
+  HTTP2StreamsContainer::CleanupStats stats = container_.Cleanup(10000, TimePoint(250));
+  EXPECT_EQ(stats.num_expired, 1);
+  EXPECT_EQ(stats.num_evicted, 0);
+  EXPECT_EQ(stats.remaining_bytes, container_.StreamsSize());
+  EXPECT_THAT(StreamIDs(), UnorderedElementsAre(1));
+
+  stats = container_.Cleanup(10000, TimePoint(300));
+  EXPECT_EQ(stats.num_expired, 1);
+  EXPECT_EQ(stats.remaining_bytes, 0);
+  EXPECT_THAT(StreamIDs(), IsEmpty());
+}
+
+TEST_F(HTTP2StreamsContainerTest, EvictsLeastRecentlyActiveOverSizeLimit) {
+  AddHeader(1, 100);
+  AddHeader(3, 200);
+  AddHeader(5, 300);
+  AddHeader(1, 400);
+
+  // Leave room for all but one stream.
+  size_t size_limit_bytes = container_.StreamsSize() - 1;
+  HTTP2StreamsContainer::CleanupStats stats = container_.Cleanup(size_limit_bytes, TimePoint(0));
+  EXPECT_EQ(stats.num_expired, 0);
+  EXPECT_EQ(stats.num_evicted, 1);
+  EXPECT_LE(stats.remaining_bytes, size_limit_bytes);
+  EXPECT_THAT(StreamIDs(), UnorderedElementsAre(1, 5));
+
+  stats = container_.Cleanup(0, TimePoint(0));
+  EXPECT_EQ(stats.num_evicted, 2);
+  EXPECT_THAT(StreamIDs(), IsEmpty());
+}
+
+}  // namespace stirling
+}  // namespace px
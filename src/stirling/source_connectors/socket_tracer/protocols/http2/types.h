@@ -105,6 +105,7 @@ struct HalfStream {
       timestamp_ns = std::min<uint64_t>(timestamp_ns, t);
       bpf_timestamp_ns = std::min<uint64_t>(bpf_timestamp_ns, t);
     }
+    last_bpf_timestamp_ns = std::max<uint64_t>(last_bpf_timestamp_ns, t);
   }
 
   void AddHeader(std::string key, std::string val) {
@@ -164,6 +165,9 @@ struct HalfStream {
   // TODO(yzhao): Remove this after negative latency is not showing anymore.
   uint64_t bpf_timestamp_ns = 0;
 
+  // Timestamp of the latest event, set in the BPF runtime. Used to find idle streams.
+  uint64_t last_bpf_timestamp_ns = 0;
+
  private:
   NVMap headers_;
   std::string data_;
@@ -204,6 +208,10 @@ struct Stream {
 
   size_t ByteSize() const { return send.ByteSize() + recv.ByteSize(); }
 
+  uint64_t last_activity_ns() const {
+    return std::max(send.last_bpf_timestamp_ns, recv.last_bpf_timestamp_ns);
+  }
+
   std::string ToString() const {
     return absl::Substitute("[consumed=$0] [send=$1] [recv=$2]", consumed, send.ToString(),
                             recv.ToString());
@@ -29,10 +29,8 @@ namespace kafka {
 // TODO(chengruizhe): Many of the methods here are shareable with other protocols such as CQL.
 
 template <typename TCharType>
-StatusOr<std::basic_string<TCharType>> PacketDecoder::ExtractBytesCore(int32_t len) {
-  PL_ASSIGN_OR_RETURN(std::basic_string_view<TCharType> tbuf,
-                      binary_decoder_.ExtractString<TCharType>(len));
-  return std::basic_string<TCharType>(tbuf);
+StatusOr<std::basic_string_view<TCharType>> PacketDecoder::ExtractBytesCore(int32_t len) {
+  return binary_decoder_.ExtractString<TCharType>(len);
 }
 
 template <uint8_t TMaxLength>
@@ -88,20 +86,20 @@ StatusOr<int64_t> PacketDecoder::ExtractVarlong() {
   return ExtractVarintCore<kVarlongMaxLength>();
 }
 
-StatusOr<std::string> PacketDecoder::ExtractRegularString() {
+StatusOr<std::string_view> PacketDecoder::ExtractRegularString() {
   PL_ASSIGN_OR_RETURN(int16_t len, ExtractInt16());
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractRegularNullableString() {
+StatusOr<std::string_view> PacketDecoder::ExtractRegularNullableString() {
   PL_ASSIGN_OR_RETURN(int16_t len, ExtractInt16());
   if (len == -1) {
-    return std::string();
+    return std::string_view();
   }
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractCompactString() {
+StatusOr<std::string_view> PacketDecoder::ExtractCompactString() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractUnsignedVarint());
   // length N + 1 is encoded.
   len -= 1;
@@ -111,7 +109,7 @@ StatusOr<std::string> PacketDecoder::ExtractCompactString() {
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractCompactNullableString() {
+StatusOr<std::string_view> PacketDecoder::ExtractCompactNullableString() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractUnsignedVarint());
   // length N + 1 is encoded.
   len -= 1;
@@ -119,39 +117,39 @@ StatusOr<std::string> PacketDecoder::ExtractCompactNullableString() {
     return error::Internal("Compact Nullable String has negative length.");
   }
   if (len == -1) {
-    return std::string();
+    return std::string_view();
   }
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractString() {
+StatusOr<std::string_view> PacketDecoder::ExtractString() {
   if (is_flexible_) {
     return ExtractCompactString();
   }
   return ExtractRegularString();
 }
 
-StatusOr<std::string> PacketDecoder::ExtractNullableString() {
+StatusOr<std::string_view> PacketDecoder::ExtractNullableString() {
   if (is_flexible_) {
     return ExtractCompactNullableString();
   }
   return ExtractRegularNullableString();
 }
 
-StatusOr<std::string> PacketDecoder::ExtractRegularBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractRegularBytes() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractInt16());
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractRegularNullableBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractRegularNullableBytes() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractInt16());
   if (len == -1) {
-    return std::string();
+    return std::string_view();
   }
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractCompactBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractCompactBytes() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractUnsignedVarint());
   // length N + 1 is encoded.
   len -= 1;
@@ -161,7 +159,7 @@ StatusOr<std::string> PacketDecoder::ExtractCompactBytes() {
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractCompactNullableBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractCompactNullableBytes() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractUnsignedVarint());
   // length N + 1 is encoded.
   len -= 1;
@@ -169,32 +167,32 @@ StatusOr<std::string> PacketDecoder::ExtractCompactNullableBytes() {
     return error::Internal("Compact Nullable Bytes has negative length.");
   }
   if (len == -1) {
-    return std::string();
+    return std::string_view();
   }
   return ExtractBytesCore<char>(len);
 }
 
-StatusOr<std::string> PacketDecoder::ExtractBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractBytes() {
   if (is_flexible_) {
     return ExtractCompactBytes();
   }
   return ExtractRegularBytes();
 }
 
-StatusOr<std::string> PacketDecoder::ExtractNullableBytes() {
+StatusOr<std::string_view> PacketDecoder::ExtractNullableBytes() {
   if (is_flexible_) {
     return ExtractCompactNullableBytes();
   }
   return ExtractRegularNullableBytes();
 }
 
-StatusOr<std::string> PacketDecoder::ExtractBytesZigZag() {
+StatusOr<std::string_view> PacketDecoder::ExtractBytesZigZag() {
   PL_ASSIGN_OR_RETURN(int32_t len, ExtractVarint());
   if (len < -1) {
     return error::Internal("Not enough bytes in ExtractBytesZigZag.");
   }
   if (len == 0 || len == -1) {
-    return std::string();
+    return std::string_view();
   }
   return ExtractBytesCore<char>(len);
 }
@@ -21,6 +21,7 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -65,6 +66,9 @@ std::string ToString(T obj) {
   return json_object_builder.GetString();
 }
 
+// Strings and bytes are extracted as views into the decoded buffer, and so are the string fields
+// of the extracted structures, which therefore must not outlive the buffer. They are meant to be
+// rendered to JSON with ToString() while the packet is still around.
 class PacketDecoder {
  public:
   explicit PacketDecoder(std::string_view buf) : marked_bufs_(), binary_decoder_(buf) {}
@@ -92,14 +96,14 @@ class PacketDecoder {
   // https://developers.google.com/protocol-buffers/docs/encoding#varints
   StatusOr<int64_t> ExtractVarlong();
 
-  StatusOr<std::string> ExtractString();
-  StatusOr<std::string> ExtractNullableString();
+  StatusOr<std::string_view> ExtractString();
+  StatusOr<std::string_view> ExtractNullableString();
 
-  StatusOr<std::string> ExtractBytes();
-  StatusOr<std::string> ExtractNullableBytes();
+  StatusOr<std::string_view> ExtractBytes();
+  StatusOr<std::string_view> ExtractNullableBytes();
 
   // Represents bytes whose length is encoded with zigzag varint.
-  StatusOr<std::string> ExtractBytesZigZag();
+  StatusOr<std::string_view> ExtractBytesZigZag();
 
   // TODO(chengruizhe): Use std::function in ExtractArray and ExtractCompactArray.
   // Represents a sequence of objects of a given type T. Type T can be either a primitive
@@ -247,42 +251,42 @@ class PacketDecoder {
  private:
   // Represents a sequence of characters. First the length N is given as an INT16. Then N
   // bytes follow which are the UTF-8 encoding of the character sequence.
-  StatusOr<std::string> ExtractRegularString();
+  StatusOr<std::string_view> ExtractRegularString();
 
   // Represents a sequence of characters or null. For non-null strings, first the
   // length N is given as an INT16. Then N bytes follow which are the UTF-8 encoding of the
   // character sequence. A null value is encoded with length of -1 and there are no following
   // bytes.
-  StatusOr<std::string> ExtractRegularNullableString();
+  StatusOr<std::string_view> ExtractRegularNullableString();
 
   // Represents a sequence of characters. First the length N + 1 is given as an
   // UNSIGNED_VARINT . Then N bytes follow which are the UTF-8 encoding of the character sequence.
-  StatusOr<std::string> ExtractCompactString();
+  StatusOr<std::string_view> ExtractCompactString();
 
   // Represents a sequence of characters. First the length N + 1 is given
   // as an UNSIGNED_VARINT . Then N bytes follow which are the UTF-8 encoding of the character
   // sequence. A null string is represented with a length of 0.
-  StatusOr<std::string> ExtractCompactNullableString();
+  StatusOr<std::string_view> ExtractCompactNullableString();
 
   // Represents a raw sequence of bytes. First the length N is given as an INT32. Then N bytes
   // follow.
-  StatusOr<std::string> ExtractRegularBytes();
+  StatusOr<std::string_view> ExtractRegularBytes();
 
   // Represents a raw sequence of bytes or null. For non-null values, first the length N is given
   // as an INT32. Then N bytes follow. A null value is encoded with length of -1 and there are no
   // following bytes.
-  StatusOr<std::string> ExtractRegularNullableBytes();
+  StatusOr<std::string_view> ExtractRegularNullableBytes();
 
   // Represents a raw sequence of bytes. First the length N+1 is given as an UNSIGNED_VARINT.Then
   // N bytes follow.
-  StatusOr<std::string> ExtractCompactBytes();
+  StatusOr<std::string_view> ExtractCompactBytes();
 
   // Represents a raw sequence of bytes. First the length N+1 is given as an UNSIGNED_VARINT.Then
   // N bytes follow. A null object is represented with a length of 0.
-  StatusOr<std::string> ExtractCompactNullableBytes();
+  StatusOr<std::string_view> ExtractCompactNullableBytes();
 
   template <typename TCharType>
-  StatusOr<std::basic_string<TCharType>> ExtractBytesCore(int32_t len);
+  StatusOr<std::basic_string_view<TCharType>> ExtractBytesCore(int32_t len);
 
   template <uint8_t TMaxLength>
   StatusOr<int64_t> ExtractUnsignedVarintCore();
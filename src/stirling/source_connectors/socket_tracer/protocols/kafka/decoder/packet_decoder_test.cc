@@ -142,6 +142,15 @@ TEST(KafkaPacketDecoderTest, ExtractCompactString) {
   }
 }
 
+// Tests that strings are not copied out of the decoded buffer.
+TEST(KafkaPacketDecoderTest, ExtractStringRefersToBuffer) {
+  const std::string_view msg = CreateStringView<char>("\x00\x05Hello");
+  PacketDecoder decoder(msg);
+  ASSERT_OK_AND_ASSIGN(std::string_view str, decoder.ExtractString());
+  EXPECT_EQ(str, "Hello");
+  EXPECT_EQ(str.data(), msg.data() + 2);
+}
+
 TEST(KafkaPacketDecoderTest, ExtractCompactNullableString) {
   {
     const std::string_view msg = CreateStringView<char>(
@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/opcodes/produce.h"
@@ -50,7 +51,7 @@ struct FetchReqPartition {
 };
 
 struct FetchReqTopic {
-  std::string name;
+  std::string_view name;
   std::vector<FetchReqPartition> partitions;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -60,7 +61,7 @@ struct FetchReqTopic {
 };
 
 struct FetchForgottenTopicsData {
-  std::string name;
+  std::string_view name;
   std::vector<int32_t> partition_indices;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -76,7 +77,7 @@ struct FetchReq {
   int32_t session_epoch = -1;
   std::vector<FetchReqTopic> topics;
   std::vector<FetchForgottenTopicsData> forgotten_topics;
-  std::string rack_id;
+  std::string_view rack_id;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("replica_id", replica_id);
@@ -122,7 +123,7 @@ struct FetchRespPartition {
 };
 
 struct FetchRespTopic {
-  std::string name;
+  std::string_view name;
   std::vector<FetchRespPartition> partitions;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace px {
@@ -30,8 +31,8 @@ namespace protocols {
 namespace kafka {
 
 struct JoinGroupMember {
-  std::string member_id;
-  std::string group_instance_id;
+  std::string_view member_id;
+  std::string_view group_instance_id;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("member_id", member_id);
@@ -40,17 +41,17 @@ struct JoinGroupMember {
 };
 
 struct JoinGroupProtocol {
-  std::string protocol;
+  std::string_view protocol;
   void ToJSON(utils::JSONObjectBuilder* builder) const { builder->WriteKV("protocol", protocol); }
 };
 
 struct JoinGroupReq {
-  std::string group_id;
+  std::string_view group_id;
   int32_t session_timeout_ms = -1;
   int32_t rebalance_timeout_ms = -1;
-  std::string member_id;
-  std::string group_instance_id;
-  std::string protocol_type;
+  std::string_view member_id;
+  std::string_view group_instance_id;
+  std::string_view protocol_type;
   std::vector<JoinGroupProtocol> protocols;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -68,10 +69,10 @@ struct JoinGroupResp {
   int32_t throttle_time_ms = 0;
   int16_t error_code = 0;
   int32_t generation_id = -1;
-  std::string protocol_type;
-  std::string protocol_name;
-  std::string leader;
-  std::string member_id;
+  std::string_view protocol_type;
+  std::string_view protocol_name;
+  std::string_view leader;
+  std::string_view member_id;
   std::vector<JoinGroupMember> members;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
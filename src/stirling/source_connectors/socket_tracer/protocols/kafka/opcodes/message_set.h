@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/common/types.h"
@@ -32,8 +33,8 @@ namespace protocols {
 namespace kafka {
 
 struct RecordMessage {
-  std::string key;
-  std::string value;
+  std::string_view key;
+  std::string_view value;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("key", key);
@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/opcodes/produce.h"
@@ -31,8 +32,8 @@ namespace stirling {
 namespace protocols {
 namespace kafka {
 struct MetadataReqTopic {
-  std::string topic_id;
-  std::string name;
+  std::string_view topic_id;
+  std::string_view name;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("topic_id", topic_id);
@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/common/json/json.h"
@@ -44,7 +45,7 @@ struct ProduceReqPartition {
 };
 
 struct ProduceReqTopic {
-  std::string name;
+  std::string_view name;
   std::vector<ProduceReqPartition> partitions;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -55,7 +56,7 @@ struct ProduceReqTopic {
 
 // Produce Request Message (opcode = 0).
 struct ProduceReq {
-  std::string transactional_id;
+  std::string_view transactional_id;
   int16_t acks = 0;
   int32_t timeout_ms = 0;
   std::vector<ProduceReqTopic> topics;
@@ -70,7 +71,7 @@ struct ProduceReq {
 
 struct RecordError {
   int32_t batch_index = 0;
-  std::string error_message;
+  std::string_view error_message;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("batch_index", batch_index);
@@ -85,7 +86,7 @@ struct ProduceRespPartition {
   int64_t log_append_time_ms = -1;
   int64_t log_start_offset = 0;
   std::vector<RecordError> record_errors;
-  std::string error_message;
+  std::string_view error_message;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("index", index);
@@ -99,7 +100,7 @@ struct ProduceRespPartition {
 };
 
 struct ProduceRespTopic {
-  std::string name;
+  std::string_view name;
   std::vector<ProduceRespPartition> partitions;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -22,6 +22,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace px {
@@ -30,18 +31,18 @@ namespace protocols {
 namespace kafka {
 
 struct SyncGroupAssignment {
-  std::string member_id;
+  std::string_view member_id;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const { builder->WriteKV("member_id", member_id); }
 };
 
 struct SyncGroupReq {
-  std::string group_id;
+  std::string_view group_id;
   int32_t generation_id = -1;
-  std::string member_id;
-  std::string group_instance_id;
-  std::string protocol_type;
-  std::string protocol_name;
+  std::string_view member_id;
+  std::string_view group_instance_id;
+  std::string_view protocol_type;
+  std::string_view protocol_name;
   std::vector<SyncGroupAssignment> assignments;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
@@ -58,8 +59,8 @@ struct SyncGroupReq {
 struct SyncGroupResp {
   int32_t throttle_time_ms;
   int16_t error_code = 0;
-  std::string protocol_type;
-  std::string protocol_name;
+  std::string_view protocol_type;
+  std::string_view protocol_name;
 
   void ToJSON(utils::JSONObjectBuilder* builder) const {
     builder->WriteKV("throttle_time_ms", throttle_time_ms);
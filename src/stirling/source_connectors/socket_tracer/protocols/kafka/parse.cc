@@ -155,6 +155,17 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   return std::string::npos;
 }
 
+size_t PendingFrameSize(message_type_t type, std::string_view buf) {
+  // Until ParseFrame() has the minimum length, it may still find the packet to be invalid.
+  size_t min_length = type == message_type_t::kRequest ? kMinReqPacketLength : kMinRespPacketLength;
+  if (buf.size() < min_length) {
+    return 0;
+  }
+  BinaryDecoder binary_decoder(buf);
+  PL_ASSIGN_OR(int32_t payload_length, binary_decoder.ExtractInt<int32_t>(), return 0);
+  return payload_length > 0 ? kMessageLengthBytes + payload_length : 0;
+}
+
 }  // namespace kafka
 
 template <>
@@ -172,6 +183,13 @@ size_t FindFrameBoundary<kafka::Packet, kafka::StateWrapper>(message_type_t type
   return kafka::FindFrameBoundary(type, buf, start_pos, &state->global);
 }
 
+template <>
+size_t PendingFrameSize<kafka::Packet, kafka::StateWrapper>(message_type_t type,
+                                                            std::string_view buf,
+                                                            kafka::StateWrapper* /*state*/) {
+  return kafka::PendingFrameSize(type, buf);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -32,6 +32,10 @@ namespace kafka {
 ParseState ParseFrame(message_type_t type, std::string_view* buf, Packet* result, State* state);
 
 size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start_pos, State* state);
+
+// Returns the size of the incomplete packet at the start of buf, from its length prefix, or 0 if
+// it isn't known yet.
+size_t PendingFrameSize(message_type_t type, std::string_view buf);
 }  // namespace kafka
 
 template <>
@@ -42,6 +46,10 @@ template <>
 size_t FindFrameBoundary<kafka::Packet>(message_type_t type, std::string_view buf, size_t start_pos,
                                         kafka::StateWrapper* state);
 
+template <>
+size_t PendingFrameSize<kafka::Packet>(message_type_t type, std::string_view buf,
+                                       kafka::StateWrapper* state);
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
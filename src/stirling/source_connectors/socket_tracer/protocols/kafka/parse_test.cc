@@ -196,6 +196,16 @@ TEST(KafkaFindFrameBoundaryTest, FindRespBoundaryUnAligned) {
   EXPECT_EQ(buf.substr(pos), metadata_frame_view);
 }
 
+TEST(KafkaPendingFrameSizeTest, FromLengthPrefix) {
+  auto produce_frame_view =
+      CreateStringView<char>(CharArrayStringView<uint8_t>(testdata::kProduceRequest));
+
+  EXPECT_EQ(PendingFrameSize(message_type_t::kRequest, produce_frame_view.substr(0, 20)),
+            produce_frame_view.size());
+  // Too short to read the length prefix from.
+  EXPECT_EQ(PendingFrameSize(message_type_t::kRequest, produce_frame_view.substr(0, 2)), 0);
+}
+
 // TODO(chengruizhe): This test currently fails. Make the check more robust by maybe limiting the
 // version numbers.
 // TEST(KafkaFindFrameBoundaryTest, FindReqBoundaryWithStartPos) {
@@ -40,8 +40,14 @@ RecordsWithErrorCount<mux::Record> StitchFrames(std::deque<mux::Frame>* reqs,
   std::vector<mux::Record> records;
   int error_count = 0;
 
+  // Responses before this one are all consumed, so searches start here.
+  auto resps_begin = resps->begin();
+
   for (auto& req : *reqs) {
-    for (auto resp_it = resps->begin(); resp_it != resps->end(); resp_it++) {
+    // Requests matched in a previous call are left in the deque until they reach its head.
+    if (req.consumed) continue;
+
+    for (auto resp_it = resps_begin; resp_it != resps->end(); resp_it++) {
       auto& resp = *resp_it;
 
       if (resp.consumed) continue;
@@ -75,6 +81,10 @@ RecordsWithErrorCount<mux::Record> StitchFrames(std::deque<mux::Frame>* reqs,
       records.push_back({std::move(req), std::move(resp)});
       break;
     }
+
+    while (resps_begin != resps->end() && resps_begin->consumed) {
+      ++resps_begin;
+    }
   }
   // TODO(ddelnano): Clean up stale requests once there is a mechanism to do so
   auto it = reqs->begin();
@@ -87,7 +97,7 @@ RecordsWithErrorCount<mux::Record> StitchFrames(std::deque<mux::Frame>* reqs,
   reqs->erase(reqs->begin(), it);
   resps->clear();
 
-  return {records, error_count};
+  return {std::move(records), error_count};
 }
 
 }  // namespace mux
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/stitcher.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/test_data.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/test_utils.h"
+
+using ::px::stirling::protocols::mysql::Command;
+using ::px::stirling::protocols::mysql::Packet;
+using ::px::stirling::protocols::mysql::ProcessMySQLPackets;
+using ::px::stirling::protocols::mysql::State;
+namespace testdata = ::px::stirling::protocols::mysql::testdata;
+namespace testutils = ::px::stirling::protocols::mysql::testutils;
+
+// Creates a burst of queries with result sets. If pipelined is set, all the queries are sent
+// before the first response arrives, otherwise each query is answered before the next one.
+void CreateQueries(int num_queries, bool pipelined, std::deque<Packet>* reqs,
+                   std::deque<Packet>* resps) {
+  Packet req = testutils::GenStringRequest(testdata::kQueryRequest, Command::kQuery);
+  std::deque<Packet> resultset = testutils::GenResultset(testdata::kQueryResultset);
+
+  uint64_t ts = 1;
+  uint64_t resp_ts = pipelined ? num_queries + 1 : 0;
+  for (int i = 0; i < num_queries; ++i) {
+    uint64_t& next_resp_ts = pipelined ? resp_ts : ts;
+    req.timestamp_ns = ts++;
+    reqs->push_back(req);
+    for (Packet resp : resultset) {
+      resp.timestamp_ns = next_resp_ts++;
+      resps->push_back(std::move(resp));
+    }
+  }
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_StitchQueries(benchmark::State& state, bool pipelined) {
+  std::deque<Packet> reqs;
+  std::deque<Packet> resps;
+  CreateQueries(state.range(0), pipelined, &reqs, &resps);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::deque<Packet> reqs_copy = reqs;
+    std::deque<Packet> resps_copy = resps;
+    State mysql_state;
+    state.ResumeTiming();
+
+    auto result = ProcessMySQLPackets(&reqs_copy, &resps_copy, &mysql_state);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+BENCHMARK_CAPTURE(BM_StitchQueries, in_order, /* pipelined */ false)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096);
+// The MySQL stitcher pairs a request with the responses that precede the next request, so it
+// cannot match pipelined queries. This measures how fast it gives up on them.
+BENCHMARK_CAPTURE(BM_StitchQueries, pipelined, /* pipelined */ true)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096);
@@ -32,6 +32,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_search.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/nats/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 
@@ -49,12 +50,21 @@ constexpr std::string_view kMessageFieldDelimiters = " \t";
 
 size_t FindMessageBoundary(std::string_view buf, size_t start_pos) {
   // Based on https://github.com/nats-io/docs/blob/master/nats_protocol/nats-protocol.md.
-  const std::vector<std::string_view> kmessage_type_ts = {kInfo, kConnect, kPub,  kSub, kUnsub,
-                                                          kMsg,  kPing,    kPong, kOK,  kERR};
+  static constexpr std::string_view kMessageTypes[] = {kInfo, kConnect, kPub,  kSub, kUnsub,
+                                                        kMsg,  kPing,    kPong, kOK,  kERR};
+  // The first bytes of all the message types above; positions that don't start with one of these
+  // are skipped without comparing against each message type.
+  constexpr std::string_view kMessageTypeFirstChars = "ICPSUM+-";
   constexpr ssize_t kMinMsgSize = 3;
-  for (ssize_t i = start_pos; i < static_cast<ssize_t>(buf.size()) - kMinMsgSize; ++i) {
+  const ssize_t end = static_cast<ssize_t>(buf.size()) - kMinMsgSize;
+  for (ssize_t i = start_pos; i < end; ++i) {
+    size_t candidate = FindFirstOf(buf, kMessageTypeFirstChars, i);
+    if (candidate == std::string_view::npos || static_cast<ssize_t>(candidate) >= end) {
+      break;
+    }
+    i = candidate;
     auto buf_substr = buf.substr(i);
-    for (auto msg_type : kmessage_type_ts) {
+    for (auto msg_type : kMessageTypes) {
       if (absl::StartsWith(buf_substr, msg_type)) {
         return i;
       }
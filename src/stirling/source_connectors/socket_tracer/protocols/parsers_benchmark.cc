@@ -0,0 +1,249 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Parses and stitches a corpus of captured connections, one per protocol, the same way that
+// ConnTracker does, so that the throughput of each protocol's parser and stitcher can be tracked
+// on realistic traffic. The corpus is in the capture format written with
+// --socket_trace_data_events_output_path, so other captures can be benchmarked as well:
+//
+//   parsers_benchmark --parser_corpus_dir=/tmp/captures --parser_corpus_repeat=10
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <benchmark/benchmark.h>
+#include <magic_enum.hpp>
+
+#include "src/common/base/base.h"
+#include "src/common/testing/test_environment.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/stitchers.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/data_event_capture.h"
+
+DEFINE_string(parser_corpus_dir, "",
+              "Directory of data event captures to benchmark. Defaults to the corpus in "
+              "protocols/testdata/parser_corpus.");
+DEFINE_int32(parser_corpus_repeat, 100,
+             "How many times each capture is replayed back to back within one iteration, so that "
+             "the buffers and the parser state are exercised over a long-lived connection.");
+DEFINE_int32(parser_events_per_poll, 32,
+             "Number of data events added to the buffers between calls to the parser, which "
+             "stands in for the events received in one sampling period.");
+
+using ::benchmark::Counter;
+using ::px::stirling::testing::CapturedDataEvent;
+using ::px::stirling::testing::DataEventCapture;
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace {
+
+constexpr char kCorpusDir[] =
+    "src/stirling/source_connectors/socket_tracer/protocols/testdata/parser_corpus";
+
+// Large enough that no data is dropped by the buffers.
+constexpr size_t kBufferCapacity = 16 * 1024 * 1024;
+
+struct ProtocolStream {
+  std::string name;
+  traffic_protocol_t protocol = kProtocolUnknown;
+  // Events of a single connection, in capture order.
+  std::vector<const CapturedDataEvent*> events;
+  // Bytes sent in each direction, and the capture time spanned, which offset the repetitions.
+  size_t egress_bytes = 0;
+  size_t ingress_bytes = 0;
+  uint64_t duration_ns = 0;
+  uint64_t data_size_bytes = 0;
+};
+
+template <typename TProtocolTraits>
+// NOLINTNEXTLINE(runtime/references)
+void BM_ParseAndStitch(benchmark::State& state, const ProtocolStream* stream) {
+  using TFrameType = typename TProtocolTraits::frame_type;
+  using TRecordType = typename TProtocolTraits::record_type;
+  using TStateType = typename TProtocolTraits::state_type;
+
+  uint64_t num_frames = 0;
+  uint64_t num_records = 0;
+  uint64_t num_errors = 0;
+  for (auto _ : state) {
+    DataStreamBuffer req_buffer(kBufferCapacity, kBufferCapacity, kBufferCapacity);
+    DataStreamBuffer resp_buffer(kBufferCapacity, kBufferCapacity, kBufferCapacity);
+    std::deque<TFrameType> req_frames;
+    std::deque<TFrameType> resp_frames;
+    TStateType protocol_state;
+
+    auto parse_and_stitch = [&]() {
+      ParseResult req_result = ParseFrames(message_type_t::kRequest, &req_buffer, &req_frames,
+                                           /*resync*/ false, &protocol_state);
+      req_buffer.RemovePrefix(req_result.end_position);
+      ParseResult resp_result = ParseFrames(message_type_t::kResponse, &resp_buffer, &resp_frames,
+                                            /*resync*/ false, &protocol_state);
+      resp_buffer.RemovePrefix(resp_result.end_position);
+      num_frames += req_result.frame_positions.size() + resp_result.frame_positions.size();
+
+      auto result = StitchFrames<TRecordType, TFrameType, TStateType>(&req_frames, &resp_frames,
+                                                                      &protocol_state);
+      num_records += result.records.size();
+      num_errors += result.error_count;
+      benchmark::DoNotOptimize(result);
+    };
+
+    int events_in_poll = 0;
+    for (int i = 0; i < FLAGS_parser_corpus_repeat; ++i) {
+      for (const CapturedDataEvent* event : stream->events) {
+        // Requests are sent by clients and received by servers.
+        bool is_req = (event->attr.direction == kEgress) == (event->attr.role == kRoleClient);
+        bool is_egress = event->attr.direction == kEgress;
+        size_t pos =
+            event->attr.pos + i * (is_egress ? stream->egress_bytes : stream->ingress_bytes);
+        uint64_t timestamp_ns = event->attr.timestamp_ns + i * stream->duration_ns;
+        (is_req ? req_buffer : resp_buffer).Add(pos, event->msg, timestamp_ns);
+
+        if (++events_in_poll == FLAGS_parser_events_per_poll) {
+          parse_and_stitch();
+          events_in_poll = 0;
+        }
+      }
+    }
+    parse_and_stitch();
+  }
+
+  state.SetBytesProcessed(stream->data_size_bytes * FLAGS_parser_corpus_repeat *
+                          state.iterations());
+  state.SetItemsProcessed(num_records);
+  state.counters["Frames"] = Counter(num_frames, Counter::kIsRate);
+  state.counters["Records"] = Counter(num_records, Counter::kIsRate);
+  state.counters["Errors"] = Counter(num_errors, Counter::kAvgIterations);
+}
+
+using BenchmarkFn = void (*)(benchmark::State&, const ProtocolStream*);
+
+// PROTOCOL_LIST: Requires update on new protocols.
+// HTTP/2 is traced through uprobes rather than parsed from data events, so it has no entry.
+BenchmarkFn GetBenchmark(traffic_protocol_t protocol) {
+  switch (protocol) {
+    case kProtocolHTTP:
+      return BM_ParseAndStitch<http::ProtocolTraits>;
+    case kProtocolMySQL:
+      return BM_ParseAndStitch<mysql::ProtocolTraits>;
+    case kProtocolCQL:
+      return BM_ParseAndStitch<cass::ProtocolTraits>;
+    case kProtocolPGSQL:
+      return BM_ParseAndStitch<pgsql::ProtocolTraits>;
+    case kProtocolDNS:
+      return BM_ParseAndStitch<dns::ProtocolTraits>;
+    case kProtocolRedis:
+      return BM_ParseAndStitch<redis::ProtocolTraits>;
+    case kProtocolNATS:
+      return BM_ParseAndStitch<nats::ProtocolTraits>;
+    case kProtocolKafka:
+      return BM_ParseAndStitch<kafka::ProtocolTraits>;
+    case kProtocolMux:
+      return BM_ParseAndStitch<mux::ProtocolTraits>;
+    case kProtocolAMQP:
+      return BM_ParseAndStitch<amqp::ProtocolTraits>;
+    default:
+      return nullptr;
+  }
+}
+
+// Returns the events of the first connection in the capture, which is expected to hold only one.
+ProtocolStream ToProtocolStream(std::string name, const DataEventCapture& capture) {
+  ProtocolStream stream;
+  stream.name = std::move(name);
+  if (capture.events.empty()) {
+    return stream;
+  }
+  const auto& first_attr = capture.events.front().attr;
+  stream.protocol = first_attr.protocol;
+  uint64_t end_ns = first_attr.timestamp_ns;
+  for (const CapturedDataEvent& event : capture.events) {
+    if (event.attr.conn_id != first_attr.conn_id) {
+      continue;
+    }
+    stream.events.push_back(&event);
+    size_t end_pos = event.attr.pos + event.msg.size();
+    size_t& dir_bytes =
+        event.attr.direction == kEgress ? stream.egress_bytes : stream.ingress_bytes;
+    dir_bytes = std::max(dir_bytes, end_pos);
+    end_ns = std::max(end_ns, event.attr.timestamp_ns);
+    stream.data_size_bytes += event.msg.size();
+  }
+  // Leave a gap between repetitions, as between any other two events.
+  stream.duration_ns = end_ns - first_attr.timestamp_ns + 1;
+  return stream;
+}
+
+}  // namespace
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  std::filesystem::path corpus_dir = FLAGS_parser_corpus_dir.empty()
+                                         ? px::testing::BazelRunfilePath(
+                                               px::stirling::protocols::kCorpusDir)
+                                         : std::filesystem::path(FLAGS_parser_corpus_dir);
+  if (FLAGS_parser_corpus_repeat <= 0 || FLAGS_parser_events_per_poll <= 0) {
+    LOG(ERROR) << "--parser_corpus_repeat and --parser_events_per_poll must be positive.";
+    return 1;
+  }
+
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(corpus_dir)) {
+    paths.push_back(entry.path());
+  }
+  std::sort(paths.begin(), paths.end());
+
+  // Registered benchmarks refer to these, so they must live until the benchmarks have run.
+  std::deque<DataEventCapture> captures;
+  std::deque<px::stirling::protocols::ProtocolStream> streams;
+  for (const auto& path : paths) {
+    captures.push_back(px::stirling::testing::ReadDataEventCapture(path).ConsumeValueOrDie());
+    streams.push_back(
+        px::stirling::protocols::ToProtocolStream(path.stem().string(), captures.back()));
+    const auto& stream = streams.back();
+    auto benchmark_fn = px::stirling::protocols::GetBenchmark(stream.protocol);
+    if (benchmark_fn == nullptr) {
+      LOG(WARNING) << absl::Substitute("Skipping $0, which has no $1 parser to benchmark.",
+                                       path.string(), magic_enum::enum_name(stream.protocol));
+      continue;
+    }
+    LOG(INFO) << absl::Substitute("Read $0 $1 events from $2.", stream.events.size(),
+                                  magic_enum::enum_name(stream.protocol), path.string());
+    benchmark::RegisterBenchmark(absl::StrCat("BM_ParseAndStitch/", stream.name).c_str(),
+                                 benchmark_fn, &stream)
+        ->Unit(benchmark::kMicrosecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
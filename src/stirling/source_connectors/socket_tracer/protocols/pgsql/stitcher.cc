@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/stitcher.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
@@ -35,10 +36,22 @@ namespace pgsql {
 
 namespace {
 
-void AdvanceIterBeyondTimestamp(MsgDeqIter* start, const MsgDeqIter& end, uint64_t ts) {
-  while (*start != end && (*start)->timestamp_ns < ts) {
-    ++(*start);
+void AddPreparedStatement(std::string_view name, std::shared_ptr<PreparedStatement> stmt,
+                          State* state) {
+  auto& stmts = state->prepared_statements;
+  if (stmts.size() >= State::kMaxPreparedStatements && !stmts.contains(name)) {
+    VLOG(1) << absl::Substitute("Too many prepared statements ($0), dropping one.", stmts.size());
+    stmts.erase(stmts.begin());
   }
+  stmts.insert_or_assign(std::string(name), std::move(stmt));
+}
+
+PreparedStatement* FindPreparedStatement(std::string_view name, State* state) {
+  if (name.empty()) {
+    return state->unnamed_statement.get();
+  }
+  auto iter = state->prepared_statements.find(name);
+  return iter == state->prepared_statements.end() ? nullptr : iter->second.get();
 }
 
 template <typename TElemType>
@@ -204,14 +217,14 @@ Status HandleQuery(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDe
 
 constexpr char kParseCmplText[] = "PARSE COMPLETE";
 
-Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
+Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, RespFinder* finder,
                    ParseReqResp* req_resp, State* state) {
   DCHECK_EQ(msg.tag, Tag::kParse);
   Parse parse;
   PL_RETURN_IF_ERROR(ParseParse(msg, &parse));
 
-  auto iter = std::find_if(*resp_iter, end, TagMatcher({Tag::kParseComplete, Tag::kErrResp}));
-  if (iter == end) {
+  auto iter = finder->Find(*resp_iter);
+  if (iter == finder->end()) {
     return error::NotFound("Did not find CmdComplete or ErrorResponse message");
   }
 
@@ -221,10 +234,12 @@ Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDe
   req_resp->resp.timestamp_ns = iter->timestamp_ns;
 
   if (iter->tag == Tag::kParseComplete) {
+    auto stmt = std::make_shared<PreparedStatement>();
+    stmt->query = std::string(parse.query);
     if (parse.stmt_name.empty()) {
-      state->unnamed_statement = parse.query;
+      state->unnamed_statement = std::move(stmt);
     } else {
-      state->prepared_statements[parse.stmt_name] = parse.query;
+      AddPreparedStatement(parse.stmt_name, std::move(stmt), state);
     }
     req_resp->resp.msg = CmdCmpl{.timestamp_ns = iter->timestamp_ns, .cmd_tag = kParseCmplText};
   }
@@ -238,15 +253,15 @@ Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDe
   return Status::OK();
 }
 
-Status HandleBind(const RegularMessage& bind_msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
+Status HandleBind(const RegularMessage& bind_msg, MsgDeqIter* resp_iter, RespFinder* finder,
                   BindReqResp* req_resp, State* state) {
   DCHECK_EQ(bind_msg.tag, Tag::kBind);
 
   BindRequest bind_req;
   PL_RETURN_IF_ERROR(ParseBindRequest(bind_msg, &bind_req));
 
-  auto iter = std::find_if(*resp_iter, end, TagMatcher({Tag::kBindComplete, Tag::kErrResp}));
-  if (iter == end) {
+  auto iter = finder->Find(*resp_iter);
+  if (iter == finder->end()) {
     return error::InvalidArgument("Could not find bind complete or error response message");
   }
 
@@ -259,13 +274,14 @@ Status HandleBind(const RegularMessage& bind_msg, MsgDeqIter* resp_iter, const M
     if (bind_req.src_prepared_stat_name.empty()) {
       state->bound_statement = state->unnamed_statement;
     } else {
-      if (!state->prepared_statements.contains(bind_req.src_prepared_stat_name)) {
+      auto stmt_iter = state->prepared_statements.find(bind_req.src_prepared_stat_name);
+      if (stmt_iter == state->prepared_statements.end()) {
         // TODO(yzhao): The code should handle the case where the previous Parse message was not
         // seen, i.e., state->prepared_statements does not contain the requested statement name.
         return error::InvalidArgument("Statement [name=$0] is not recorded",
                                       bind_req.src_prepared_stat_name);
       }
-      state->bound_statement = state->prepared_statements[bind_req.src_prepared_stat_name];
+      state->bound_statement = stmt_iter->second;
     }
     state->bound_params = bind_req.params;
     req_resp->resp.msg = CmdCmpl{.timestamp_ns = iter->timestamp_ns, .cmd_tag = "BIND COMPLETE"};
@@ -282,10 +298,10 @@ Status HandleBind(const RegularMessage& bind_msg, MsgDeqIter* resp_iter, const M
   return Status::OK();
 }
 
-Status FillStmtDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqResp::Resp* resp) {
-  auto iter = std::find_if(*resp_iter, end, TagMatcher({Tag::kParamDesc, Tag::kErrResp}));
+Status FillStmtDescResp(MsgDeqIter* resp_iter, RespFinder* finder, DescReqResp::Resp* resp) {
+  auto iter = finder->Find(*resp_iter);
 
-  if (iter == end) {
+  if (iter == finder->end()) {
     return error::InvalidArgument("Could not find kParamDesc or kErrResp message");
   }
 
@@ -300,7 +316,7 @@ Status FillStmtDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqRes
   }
 
   PL_RETURN_IF_ERROR(ParseParamDesc(*iter, &resp->param_desc));
-  if (++iter == end) {
+  if (++iter == finder->end()) {
     return error::InvalidArgument("Should have another message following kParamDesc");
   }
 
@@ -319,10 +335,10 @@ Status FillStmtDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqRes
                                 iter->ToString());
 }
 
-Status FillPortalDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqResp::Resp* resp) {
-  auto iter = std::find_if(*resp_iter, end, TagMatcher({Tag::kParamDesc, Tag::kErrResp}));
+Status FillPortalDescResp(MsgDeqIter* resp_iter, RespFinder* finder, DescReqResp::Resp* resp) {
+  auto iter = finder->Find(*resp_iter);
 
-  if (iter == end) {
+  if (iter == finder->end()) {
     return error::InvalidArgument("Could not find kParamDesc or kErrResp message");
   }
 
@@ -339,21 +355,30 @@ Status FillPortalDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqR
   return Status::OK();
 }
 
-Status HandleDesc(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
-                  DescReqResp* req_resp) {
+Status HandleDesc(const RegularMessage& msg, MsgDeqIter* resp_iter, RespFinder* finder,
+                  DescReqResp* req_resp, State* state) {
   DCHECK_EQ(msg.tag, Tag::kDesc);
 
   PL_RETURN_IF_ERROR(ParseDesc(msg, &req_resp->req));
 
+  PreparedStatement* stmt = nullptr;
   if (req_resp->req.type == Desc::Type::kStatement) {
-    return FillStmtDescResp(resp_iter, end, &req_resp->resp);
+    PL_RETURN_IF_ERROR(FillStmtDescResp(resp_iter, finder, &req_resp->resp));
+    stmt = FindPreparedStatement(req_resp->req.name, state);
+  } else if (req_resp->req.type == Desc::Type::kPortal) {
+    PL_RETURN_IF_ERROR(FillPortalDescResp(resp_iter, finder, &req_resp->resp));
+    stmt = state->bound_statement.get();
+  } else {
+    return error::InvalidArgument("Invalid describe target type, message: $0", msg.ToString());
   }
 
-  if (req_resp->req.type == Desc::Type::kPortal) {
-    return FillPortalDescResp(resp_iter, end, &req_resp->resp);
+  // Remember the result columns, for the executions of the statement that are not described.
+  if (stmt != nullptr && !stmt->described && !req_resp->resp.is_err_resp) {
+    stmt->col_names = absl::StrJoin(req_resp->resp.row_desc.FieldNames(), ",");
+    stmt->described = true;
   }
 
-  return error::InvalidArgument("Invalid describe target type, message: $0", msg.ToString());
+  return Status::OK();
 }
 
 Status HandleExecute(const RegularMessage& msg, MsgDeqIter* resps_begin,
@@ -361,7 +386,10 @@ Status HandleExecute(const RegularMessage& msg, MsgDeqIter* resps_begin,
   DCHECK_EQ(msg.tag, Tag::kExecute);
 
   req_resp->req.timestamp_ns = msg.timestamp_ns;
-  req_resp->req.query = state->bound_statement;
+  if (state->bound_statement != nullptr) {
+    req_resp->req.query = state->bound_statement->query;
+    req_resp->resp.col_names = state->bound_statement->col_names;
+  }
   req_resp->req.params = state->bound_params;
 
   PL_RETURN_IF_ERROR(FillQueryResp(resps_begin, resps_end, &req_resp->resp));
@@ -394,6 +422,7 @@ RecordsWithErrorCount<pgsql::Record> StitchFrames(std::deque<pgsql::RegularMessa
   int error_count = 0;
   auto req_iter = reqs->begin();
   auto resp_iter = resps->begin();
+  RespFinders finders(resps->end());
   // PostgreSQL query mode:
   //   In-order mode: where one query (one regular message) is followed one response (possibly with
   //   multiple regular messages).
@@ -431,16 +460,17 @@ RecordsWithErrorCount<pgsql::Record> StitchFrames(std::deque<pgsql::RegularMessa
       }
       case Tag::kParse: {
         CALL_HANDLER(ParseReqResp,
-                     HandleParse(*cur_iter, &resp_iter, resps->end(), &req_resp, state));
+                     HandleParse(*cur_iter, &resp_iter, &finders.parse, &req_resp, state));
         break;
       }
       case Tag::kBind: {
         CALL_HANDLER(BindReqResp,
-                     HandleBind(*cur_iter, &resp_iter, resps->end(), &req_resp, state));
+                     HandleBind(*cur_iter, &resp_iter, &finders.bind, &req_resp, state));
         break;
       }
       case Tag::kDesc: {
-        CALL_HANDLER(DescReqResp, HandleDesc(*cur_iter, &resp_iter, resps->end(), &req_resp));
+        CALL_HANDLER(DescReqResp,
+                     HandleDesc(*cur_iter, &resp_iter, &finders.desc, &req_resp, state));
         break;
       }
       case Tag::kExecute: {
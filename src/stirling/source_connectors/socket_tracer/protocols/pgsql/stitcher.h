@@ -23,6 +23,7 @@
 
 #include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/timestamp_stitcher.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/types.h"
 
 namespace px {
@@ -30,6 +31,23 @@ namespace stirling {
 namespace protocols {
 namespace pgsql {
 
+using RespFinder = ForwardFinder<MsgDeqIter, TagMatcher>;
+
+/**
+ * Finders for the response messages that complete each kind of request. They are shared by all
+ * the requests of one StitchFrames() call, so that the response messages are scanned only once.
+ */
+struct RespFinders {
+  explicit RespFinders(const MsgDeqIter& end)
+      : parse(end, TagMatcher({Tag::kParseComplete, Tag::kErrResp})),
+        bind(end, TagMatcher({Tag::kBindComplete, Tag::kErrResp})),
+        desc(end, TagMatcher({Tag::kParamDesc, Tag::kErrResp})) {}
+
+  RespFinder parse;
+  RespFinder bind;
+  RespFinder desc;
+};
+
 /**
  * Handle*() functions accept one request message and a list response messages; and find the
  * relevant response messages for the request message (by looking for the tags specified by the
@@ -38,14 +56,13 @@ namespace pgsql {
 Status HandleQuery(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
                    QueryReqResp* req_resp);
 Status FillQueryResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, QueryReqResp::QueryResp* resp);
-Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
+Status HandleParse(const RegularMessage& msg, MsgDeqIter* resp_iter, RespFinder* finder,
                    ParseReqResp* req_resp, State* state);
-Status FillStmtDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end, DescReqResp::Resp* req_resp);
-Status FillPortalDescResp(MsgDeqIter* resp_iter, const MsgDeqIter& end,
-                          DescReqResp::Resp* req_resp);
-Status HandleDesc(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
-                  DescReqResp* req_resp);
-Status HandleBind(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
+Status FillStmtDescResp(MsgDeqIter* resp_iter, RespFinder* finder, DescReqResp::Resp* req_resp);
+Status FillPortalDescResp(MsgDeqIter* resp_iter, RespFinder* finder, DescReqResp::Resp* req_resp);
+Status HandleDesc(const RegularMessage& msg, MsgDeqIter* resp_iter, RespFinder* finder,
+                  DescReqResp* req_resp, State* state);
+Status HandleBind(const RegularMessage& msg, MsgDeqIter* resp_iter, RespFinder* finder,
                   BindReqResp* req_resp, State* state);
 Status HandleExecute(const RegularMessage& msg, MsgDeqIter* resp_iter, const MsgDeqIter& end,
                      ExecReqResp* req_resp, State* state);
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <string_view>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/stitcher.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/test_data.h"
+
+using ::px::stirling::protocols::ParseState;
+using ::px::stirling::protocols::pgsql::kBindCmplData;
+using ::px::stirling::protocols::pgsql::kBindData;
+using ::px::stirling::protocols::pgsql::kCmdCmplData;
+using ::px::stirling::protocols::pgsql::kDataRowData;
+using ::px::stirling::protocols::pgsql::kExecData;
+using ::px::stirling::protocols::pgsql::kParseCmplData;
+using ::px::stirling::protocols::pgsql::kParseData1;
+using ::px::stirling::protocols::pgsql::ParseRegularMessage;
+using ::px::stirling::protocols::pgsql::RegularMessage;
+using ::px::stirling::protocols::pgsql::State;
+using ::px::stirling::protocols::pgsql::StitchFrames;
+
+void AppendMessage(std::string_view data, uint64_t timestamp_ns, std::deque<RegularMessage>* msgs) {
+  RegularMessage msg;
+  CHECK(ParseRegularMessage(&data, &msg) == ParseState::kSuccess);
+  msg.timestamp_ns = timestamp_ns;
+  msgs->push_back(std::move(msg));
+}
+
+// Creates a burst of pipelined extended query protocol requests (Parse, Bind, Execute), all sent
+// before the first response arrives. If drop_parse_cmpl is set, the ParseComplete responses are
+// missing, as if their events were lost.
+void CreatePipeline(int num_queries, bool drop_parse_cmpl, std::deque<RegularMessage>* reqs,
+                    std::deque<RegularMessage>* resps) {
+  uint64_t ts = 1;
+  for (int i = 0; i < num_queries; ++i) {
+    AppendMessage(kParseData1, ts++, reqs);
+    AppendMessage(kBindData, ts++, reqs);
+    AppendMessage(kExecData, ts++, reqs);
+  }
+  for (int i = 0; i < num_queries; ++i) {
+    if (!drop_parse_cmpl) {
+      AppendMessage(kParseCmplData, ts++, resps);
+    }
+    AppendMessage(kBindCmplData, ts++, resps);
+    AppendMessage(kDataRowData, ts++, resps);
+    AppendMessage(kCmdCmplData, ts++, resps);
+  }
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_StitchPipelined(benchmark::State& state, bool drop_parse_cmpl) {
+  std::deque<RegularMessage> reqs;
+  std::deque<RegularMessage> resps;
+  CreatePipeline(state.range(0), drop_parse_cmpl, &reqs, &resps);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::deque<RegularMessage> reqs_copy = reqs;
+    std::deque<RegularMessage> resps_copy = resps;
+    State pgsql_state;
+    state.ResumeTiming();
+
+    auto result = StitchFrames(&reqs_copy, &resps_copy, &pgsql_state);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+BENCHMARK_CAPTURE(BM_StitchPipelined, all_responses, /* drop_parse_cmpl */ false)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096);
+BENCHMARK_CAPTURE(BM_StitchPipelined, lost_parse_cmpl, /* drop_parse_cmpl */ true)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096);
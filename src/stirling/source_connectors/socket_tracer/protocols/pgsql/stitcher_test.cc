@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/stitcher.h"
 
+#include <memory>
 #include <string>
 
 #include "src/common/testing/testing.h"
@@ -159,7 +160,11 @@ TEST_F(StitchFramesTest, VerifySingleOutputMessage) {
                           "type_modifier=-1 fmt_code=kText] "
                           "[name=email table_oid=16384 attr_num=3 type_oid=25 type_size=-1 "
                           "type_modifier=-1 fmt_code=kText]",
-                          "BIND COMPLETE", "Jason,Moiron,jmoiron@jmoiron.net\nSELECT 238",
+                          "BIND COMPLETE",
+                          // The column names come from the Describe of the statement.
+                          "first_name,last_name,email\n"
+                          "Jason,Moiron,jmoiron@jmoiron.net\n"
+                          "SELECT 238",
                           "Name,Owner,Encoding,Collate,Ctype,Access privileges\n"
                           "postgres,postgres,UTF8,en_US.utf8,en_US.utf8,[NULL]\n"
                           "SELECT 238",
@@ -168,6 +173,33 @@ TEST_F(StitchFramesTest, VerifySingleOutputMessage) {
   EXPECT_EQ(0, records_and_err_count.error_count);
 }
 
+TEST_F(StitchFramesTest, RepeatedExecutionsOfDescribedStatement) {
+  ASSERT_OK_AND_ASSIGN(std::deque<RegularMessage> reqs,
+                       ParseRegularMessages(absl::StrCat(kParseData1, kDescData, kBindData,
+                                                         kExecData, kBindData, kExecData)));
+  ASSERT_OK_AND_ASSIGN(
+      std::deque<RegularMessage> resps,
+      ParseRegularMessages(absl::StrCat(kParseCmplData, kParamDescData, kRowDescData,
+                                        kBindCmplData, kDataRowData, kCmdCmplData, kBindCmplData,
+                                        kDataRowData, kCmdCmplData)));
+  for (auto& resp : resps) {
+    resp.timestamp_ns += 10;
+  }
+
+  RecordsWithErrorCount<pgsql::Record> records_and_err_count = StitchFrames(&reqs, &resps, &state_);
+  EXPECT_EQ(0, records_and_err_count.error_count);
+  ASSERT_THAT(records_and_err_count.records, SizeIs(6));
+
+  // The second execution is not described, but reports the column names of the statement.
+  const Record& record = records_and_err_count.records[5];
+  EXPECT_EQ(record.req.tag, Tag::kExecute);
+  EXPECT_EQ(record.req.payload, "query=[SELECT * FROM person WHERE first_name=$1] params=[Jason]");
+  EXPECT_EQ(record.resp.payload,
+            "first_name,last_name,email\n"
+            "Jason,Moiron,jmoiron@jmoiron.net\n"
+            "SELECT 238");
+}
+
 TEST_F(StitchFramesTest, HandleParseErrResp) {
   ASSERT_OK_AND_ASSIGN(std::deque<RegularMessage> reqs, ParseRegularMessages(kParseData1));
   ASSERT_OK_AND_ASSIGN(std::deque<RegularMessage> resps, ParseRegularMessages(kErrRespData));
@@ -176,7 +208,8 @@ TEST_F(StitchFramesTest, HandleParseErrResp) {
   auto resps_begin = resps.begin();
 
   ParseReqResp req_resp;
-  ASSERT_OK(HandleParse(*reqs_begin, &resps_begin, resps.end(), &req_resp, &state_));
+  RespFinders finders(resps.end());
+  ASSERT_OK(HandleParse(*reqs_begin, &resps_begin, &finders.parse, &req_resp, &state_));
   EXPECT_EQ("SELECT * FROM person WHERE first_name=$1", req_resp.req.query);
   EXPECT_EQ(
       "ERROR RESPONSE [Severity=ERROR InternalSeverity=ERROR Code=42P01 "
@@ -202,8 +235,10 @@ class HandleBindTest : public ::testing::TestWithParam<HandleBindTestCase> {
  protected:
   void SetUp() override {
     constexpr char kStmt[] = "select $1, $2 from t";
-    state_.unnamed_statement = kStmt;
-    state_.prepared_statements["foo"] = kStmt;
+    auto stmt = std::make_shared<PreparedStatement>();
+    stmt->query = kStmt;
+    state_.unnamed_statement = stmt;
+    state_.prepared_statements["foo"] = stmt;
   }
 
   State state_;
@@ -217,7 +252,8 @@ TEST_P(HandleBindTest, CheckBoundStatement) {
   auto resp_iter = resps.begin();
   BindReqResp req_resp;
 
-  EXPECT_OK(HandleBind(reqs.front(), &resp_iter, resps.end(), &req_resp, &state_));
+  RespFinders finders(resps.end());
+  EXPECT_OK(HandleBind(reqs.front(), &resp_iter, &finders.bind, &req_resp, &state_));
 
   EXPECT_EQ(resp_iter, resps.end());
 
@@ -226,7 +262,8 @@ TEST_P(HandleBindTest, CheckBoundStatement) {
 
   EXPECT_EQ("BIND COMPLETE", req_resp.resp.ToString());
 
-  EXPECT_EQ(GetParam().expected_bound_statement, state_.bound_statement);
+  ASSERT_NE(state_.bound_statement, nullptr);
+  EXPECT_EQ(GetParam().expected_bound_statement, state_.bound_statement->query);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <deque>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
@@ -442,6 +443,10 @@ struct QueryReqResp {
     CmdCmpl cmd_cmpl;
     ErrResp err_resp;
 
+    // The comma-separated column names, for responses without a row description of their own
+    // (i.e. to an Execute), taken from an earlier Describe of the statement.
+    std::string_view col_names;
+
     std::string ToString() const {
       if (is_err_resp) {
         return err_resp.ToString();
@@ -455,6 +460,8 @@ struct QueryReqResp {
         if (!field_names.empty()) {
           absl::StrAppend(&res, absl::StrJoin(field_names, ","));
           absl::StrAppend(&res, "\n");
+        } else if (!col_names.empty()) {
+          absl::StrAppend(&res, col_names, "\n");
         }
 
         absl::StrAppend(&res, absl::StrJoin(data_rows, "\n", ToStringFormatter<DataRow>()));
@@ -540,16 +547,34 @@ struct Record {
   }
 };
 
+// A statement prepared by a Parse message. Statements are shared between the prepared statements
+// and the bound statement, so that binding one does not copy its query.
+struct PreparedStatement {
+  std::string query;
+
+  // The comma-separated names of the result columns, from the first Describe of the statement or
+  // of a portal bound to it. Empty until then. ORMs usually describe a statement once, and then
+  // bind and execute it many times.
+  std::string col_names;
+  bool described = false;
+};
+
 struct State {
-  absl::flat_hash_map<std::string, std::string> prepared_statements;
+  // The maximum number of named statements kept for a connection. Beyond that, an arbitrary one is
+  // dropped for each new one, so that a client that never closes its statements cannot grow the
+  // state without bound.
+  static constexpr size_t kMaxPreparedStatements = 1024;
+
+  absl::flat_hash_map<std::string, std::shared_ptr<PreparedStatement>> prepared_statements;
 
   // One postgres session can only have at most one unnamed statement.
-  std::string unnamed_statement;
+  std::shared_ptr<PreparedStatement> unnamed_statement;
 
   // The last bound statement of the extended query session, without the parameters substituted. See
   // link for more info on extended query sessions:
   // https://www.postgresql.org/docs/10/protocol-flow.html#PROTOCOL-FLOW-EXT-QUERY
-  std::string bound_statement;
+  // Portals other than the last bound one are not tracked.
+  std::shared_ptr<PreparedStatement> bound_statement;
   // The last set of parameters bound to bound_statement. Everytime a BIND command happens these are
   // invalidated.
   std::vector<Param> bound_params;
@@ -21,6 +21,9 @@
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
 
 #include "src/common/json/json.h"
 
@@ -131,11 +134,34 @@ CmdArgs::CmdArgs(std::initializer_list<const char*> cmd_args) {
 
 namespace {
 
+// Command names are matched case-insensitively. Hashing and comparing them as such, rather than
+// upper-casing each candidate into a new string, keeps lookups free of allocations.
+struct CaseInsensitiveHash {
+  size_t operator()(std::string_view s) const {
+    // FNV-1a.
+    size_t hash = 14695981039346656037ULL;
+    for (char c : s) {
+      hash ^= static_cast<unsigned char>(absl::ascii_toupper(c));
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
+struct CaseInsensitiveEq {
+  bool operator()(std::string_view a, std::string_view b) const {
+    return absl::EqualsIgnoreCase(a, b);
+  }
+};
+
+using CmdArgsMap =
+    absl::flat_hash_map<std::string_view, CmdArgs, CaseInsensitiveHash, CaseInsensitiveEq>;
+
 // This list is produced with by:
 //   //src/stirling/source_connectors/socket_tracer/protocols/redis:redis_cmds_format_generator
 //
 //   Read its help message to get the instructions.
-const absl::flat_hash_map<std::string_view, CmdArgs> kCmdList = {
+const CmdArgsMap kCmdList = {
     {"ACL LOAD", {"ACL LOAD"}},
     {"ACL SAVE", {"ACL SAVE"}},
     {"ACL LIST", {"ACL LIST"}},
@@ -494,6 +520,22 @@ std::optional<const CmdArgs*> GetCmdAndArgs(std::string_view payload) {
   return std::nullopt;
 }
 
+// Returns true if the input is the first word of a double-words command, like ACL in ACL LOAD.
+bool IsDoubleWordsCmdPrefix(std::string_view word) {
+  static const auto* kPrefixes = [] {
+    auto* prefixes =
+        new absl::flat_hash_set<std::string_view, CaseInsensitiveHash, CaseInsensitiveEq>();
+    for (const auto& [name, cmd_args] : kCmdList) {
+      size_t pos = name.find(' ');
+      if (pos != std::string_view::npos) {
+        prefixes->insert(name.substr(0, pos));
+      }
+    }
+    return prefixes;
+  }();
+  return kPrefixes->contains(word);
+}
+
 }  // namespace
 
 std::optional<const CmdArgs*> GetCmdAndArgs(VectorView<std::string>* payloads) {
@@ -501,17 +543,15 @@ std::optional<const CmdArgs*> GetCmdAndArgs(VectorView<std::string>* payloads) {
     return std::nullopt;
   }
   // Search the double-words command first.
-  if (payloads->size() >= 2) {
-    std::string candidate_cmd =
-        absl::AsciiStrToUpper(absl::StrCat((*payloads)[0], " ", (*payloads)[1]));
+  if (payloads->size() >= 2 && IsDoubleWordsCmdPrefix((*payloads)[0])) {
+    std::string candidate_cmd = absl::StrCat((*payloads)[0], " ", (*payloads)[1]);
     auto res_opt = GetCmdAndArgs(candidate_cmd);
     if (res_opt.has_value()) {
       payloads->pop_front(2);
       return res_opt;
     }
   }
-  std::string candidate_cmd = absl::AsciiStrToUpper(payloads->front());
-  auto res_opt = GetCmdAndArgs(candidate_cmd);
+  auto res_opt = GetCmdAndArgs(payloads->front());
   if (res_opt.has_value()) {
     payloads->pop_front(1);
   }
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <string_view>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/redis/parse.h"
+
+using ::px::stirling::protocols::NoState;
+using ::px::stirling::protocols::ParseFrame;
+using ::px::stirling::protocols::ParseState;
+using ::px::stirling::protocols::redis::Message;
+
+std::string BulkString(std::string_view s) {
+  return absl::StrCat("$", s.size(), "\r\n", s, "\r\n");
+}
+
+// Returns the wire format of a command, as an array of bulk strings.
+std::string Command(std::string_view name, int num_args, std::string_view arg_prefix) {
+  std::string cmd = absl::StrCat("*", num_args + 1, "\r\n", BulkString(name));
+  for (int i = 0; i < num_args; ++i) {
+    absl::StrAppend(&cmd, BulkString(absl::StrCat(arg_prefix, i)));
+  }
+  return cmd;
+}
+
+// Creates a buffer of pipelined requests, as sent by a client that batches its commands.
+std::string PipelinedRequests(int num_cmds, int num_keys) {
+  std::string buf;
+  for (int i = 0; i < num_cmds; ++i) {
+    if (i % 2 == 0) {
+      absl::StrAppend(&buf, Command("mget", num_keys, "user:session:"));
+    } else {
+      // Key and value pairs.
+      absl::StrAppend(&buf, Command("MSET", 2 * num_keys, "user:session:"));
+    }
+  }
+  return buf;
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_ParsePipelinedMGetMSet(benchmark::State& state) {
+  constexpr int kNumCmds = 256;
+  const std::string buf = PipelinedRequests(kNumCmds, state.range(0));
+
+  for (auto _ : state) {
+    std::string_view remaining = buf;
+    NoState no_state;
+    int num_msgs = 0;
+    while (!remaining.empty()) {
+      Message msg;
+      ParseState parse_state = ParseFrame(message_type_t::kRequest, &remaining, &msg, &no_state);
+      CHECK(parse_state == ParseState::kSuccess);
+      benchmark::DoNotOptimize(msg);
+      ++num_msgs;
+    }
+    CHECK_EQ(num_msgs, kNumCmds);
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+  state.SetItemsProcessed(state.iterations() * kNumCmds);
+}
+
+BENCHMARK(BM_ParsePipelinedMGetMSet)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
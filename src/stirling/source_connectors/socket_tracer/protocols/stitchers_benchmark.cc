@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Stitches synthetic request and response streams with each protocol's stitcher, so that the
+// per-message costs of the stitchers can be compared. MySQL and PostgreSQL, whose stitchers need
+// real protocol payloads, have their own benchmarks next to their stitchers.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/stitchers.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace {
+
+// Responses are answered out of order, in batches of this size, for protocols that match
+// responses to requests by an ID.
+constexpr int kOutOfOrderBatchSize = 8;
+
+// Returns the request answered by the i-th response, which reverses the order within each batch.
+int OutOfOrderReqIndex(int i, int num_reqs) {
+  int batch_end = std::min(i - i % kOutOfOrderBatchSize + kOutOfOrderBatchSize, num_reqs);
+  return batch_end - 1 - i % kOutOfOrderBatchSize;
+}
+
+template <typename TFrameType>
+using FrameGenerator = void (*)(int num_reqs, std::deque<TFrameType>* reqs,
+                                std::deque<TFrameType>* resps);
+
+void GenHTTPMessages(int num_reqs, std::deque<http::Message>* reqs,
+                     std::deque<http::Message>* resps) {
+  http::Message req;
+  req.type = message_type_t::kRequest;
+  req.req_method = "GET";
+  req.req_path = "/index.html";
+  http::Message resp;
+  resp.type = message_type_t::kResponse;
+  resp.resp_status = 200;
+  resp.body = "<html></html>";
+  for (int i = 0; i < num_reqs; ++i) {
+    req.timestamp_ns = 2 * i + 1;
+    resp.timestamp_ns = 2 * i + 2;
+    reqs->push_back(req);
+    resps->push_back(resp);
+  }
+}
+
+void GenRedisMessages(int num_reqs, std::deque<redis::Message>* reqs,
+                      std::deque<redis::Message>* resps) {
+  redis::Message req;
+  req.payload = R"(["GET", "key"])";
+  req.command = "GET";
+  redis::Message resp;
+  resp.payload = "value";
+  for (int i = 0; i < num_reqs; ++i) {
+    req.timestamp_ns = 2 * i + 1;
+    resp.timestamp_ns = 2 * i + 2;
+    reqs->push_back(req);
+    resps->push_back(resp);
+  }
+}
+
+void GenNATSMessages(int num_reqs, std::deque<nats::Message>* reqs,
+                     std::deque<nats::Message>* resps) {
+  nats::Message req;
+  req.command = nats::kPub;
+  req.options = R"({"subject":"foo","payload":"bar"})";
+  nats::Message resp;
+  resp.command = nats::kOK;
+  for (int i = 0; i < num_reqs; ++i) {
+    req.timestamp_ns = 2 * i + 1;
+    resp.timestamp_ns = 2 * i + 2;
+    reqs->push_back(req);
+    resps->push_back(resp);
+  }
+}
+
+void GenDNSFrames(int num_reqs, std::deque<dns::Frame>* reqs, std::deque<dns::Frame>* resps) {
+  for (int i = 0; i < num_reqs; ++i) {
+    dns::Frame req;
+    req.header.txid = i;
+    req.header.flags = 0x0100;  // Standard query.
+    req.header.num_queries = 1;
+    req.timestamp_ns = i + 1;
+    reqs->push_back(std::move(req));
+  }
+  for (int i = 0; i < num_reqs; ++i) {
+    dns::Frame resp;
+    resp.header.txid = OutOfOrderReqIndex(i, num_reqs);
+    resp.header.flags = 0x8180;  // Standard query response, No error.
+    resp.header.num_queries = 1;
+    resp.header.num_answers = 1;
+    resp.AddRecords({dns::DNSRecord{"pixielabs.ai", "", {}}});
+    resp.timestamp_ns = num_reqs + i + 1;
+    resps->push_back(std::move(resp));
+  }
+}
+
+void GenMuxFrames(int num_reqs, std::deque<mux::Frame>* reqs, std::deque<mux::Frame>* resps) {
+  for (int i = 0; i < num_reqs; ++i) {
+    mux::Frame req;
+    req.type = static_cast<int8_t>(mux::Type::kTdispatch);
+    req.tag = i;
+    req.timestamp_ns = i + 1;
+    reqs->push_back(std::move(req));
+  }
+  for (int i = 0; i < num_reqs; ++i) {
+    mux::Frame resp;
+    resp.type = static_cast<int8_t>(mux::Type::kRdispatch);
+    resp.tag = OutOfOrderReqIndex(i, num_reqs);
+    resp.timestamp_ns = num_reqs + i + 1;
+    resps->push_back(std::move(resp));
+  }
+}
+
+template <typename TRecordType, typename TFrameType, typename TStateType = NoState>
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchFrames(benchmark::State& state, FrameGenerator<TFrameType> gen) {
+  std::deque<TFrameType> reqs;
+  std::deque<TFrameType> resps;
+  gen(state.range(0), &reqs, &resps);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::deque<TFrameType> reqs_copy = reqs;
+    std::deque<TFrameType> resps_copy = resps;
+    TStateType protocol_state;
+    state.ResumeTiming();
+
+    auto result =
+        StitchFrames<TRecordType, TFrameType>(&reqs_copy, &resps_copy, &protocol_state);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * reqs.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchHTTP(benchmark::State& state) {
+  BM_StitchFrames<http::Record, http::Message, http::StateWrapper>(state, GenHTTPMessages);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchRedis(benchmark::State& state) {
+  BM_StitchFrames<redis::Record, redis::Message>(state, GenRedisMessages);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchNATS(benchmark::State& state) {
+  BM_StitchFrames<nats::Record, nats::Message>(state, GenNATSMessages);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchDNS(benchmark::State& state) {
+  BM_StitchFrames<dns::Record, dns::Frame, dns::StateWrapper>(state, GenDNSFrames);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+void BM_StitchMux(benchmark::State& state) {
+  BM_StitchFrames<mux::Record, mux::Frame>(state, GenMuxFrames);
+}
+
+BENCHMARK(BM_StitchHTTP)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_StitchRedis)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_StitchNATS)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_StitchDNS)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_StitchMux)->RangeMultiplier(4)->Range(16, 4096);
+
+}  // namespace
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
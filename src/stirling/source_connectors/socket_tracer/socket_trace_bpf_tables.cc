@@ -43,7 +43,7 @@ namespace px {
 namespace stirling {
 
 ConnInfoMapManager::ConnInfoMapManager(bpf_tools::BCCWrapper* bcc)
-    : conn_info_map_(bcc->GetHashTable<uint64_t, struct conn_info_t>("conn_info_map")),
+    : bcc_(bcc),
       conn_disabled_map_(bcc->GetHashTable<uint64_t, uint64_t>("conn_disabled_map")) {
   // Use address instead of symbol to specify this probe,
   // so that even if debug symbols are stripped, the uprobe can still attach.
@@ -80,7 +80,8 @@ void ConnInfoMapManager::Disable(struct conn_id_t conn_id) {
 void ConnInfoMapManager::CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_mgr) {
   const auto& sysconfig = system::Config::GetInstance();
 
-  for (const auto& [pid_fd, conn_info] : conn_info_map_.get_table_offline()) {
+  const auto conn_infos = bcc_->GetHashTableEntries<uint64_t, struct conn_info_t>("conn_info_map");
+  for (const auto& [pid_fd, conn_info] : conn_infos) {
     uint32_t pid = pid_fd >> 32;
     int32_t fd = pid_fd;
 
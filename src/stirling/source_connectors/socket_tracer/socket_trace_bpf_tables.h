@@ -43,7 +43,7 @@ class ConnInfoMapManager {
   void CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_mgr);
 
  private:
-  ebpf::BPFHashTable<uint64_t, struct conn_info_t> conn_info_map_;
+  bpf_tools::BCCWrapper* bcc_;
   ebpf::BPFHashTable<uint64_t, uint64_t> conn_disabled_map_;
 
   std::vector<struct conn_id_t> pending_release_queue_;
@@ -23,8 +23,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <functional>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/match.h>
@@ -33,6 +36,7 @@
 #include <magic_enum.hpp>
 
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/base/utils.h"
 #include "src/common/json/json.h"
 #include "src/common/system/socket_info.h"
@@ -42,7 +46,9 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
+#include "src/stirling/source_connectors/socket_tracer/metrics.h"
 #include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/grpc.h"
 #include "src/stirling/utils/linux_headers.h"
@@ -58,6 +64,10 @@ DEFINE_uint32(stirling_socket_tracer_stats_logging_ratio,
               std::chrono::minutes(10) / px::stirling::SocketTraceConnector::kSamplingPeriod,
               "Ratio of how frequently summary logging information is displayed.");
 
+DEFINE_int32(stirling_fd_snapshot_min_lookups, 4,
+             "The number of /proc FD lookups of a process within an iteration after which its "
+             "whole FD directory is listed once and shared by the rest of them. Disabled if 0.");
+
 DEFINE_bool(stirling_enable_periodic_bpf_map_cleanup, true,
             "Disable periodic BPF map cleanup (for testing)");
 
@@ -100,6 +110,17 @@ DEFINE_int32(stirling_enable_amqp_tracing, px::stirling::TraceMode::Off,
 DEFINE_bool(stirling_disable_self_tracing, true,
             "If true, stirling will not trace and process syscalls made by itself.");
 
+DEFINE_bool(stirling_enable_http_kernel_filter,
+            gflags::BoolFromEnv("PL_STIRLING_ENABLE_HTTP_KERNEL_FILTER", false),
+            "If true, BPF drops or truncates the data of HTTP requests and responses that match "
+            "the filters of --stirling_http_kernel_filters, before it is sent to user-space.");
+DEFINE_string(stirling_http_kernel_filters,
+              gflags::StringFromEnv("PL_STIRLING_HTTP_KERNEL_FILTERS", ""),
+              "Filters applied in BPF when --stirling_enable_http_kernel_filter is set, as a "
+              "';'-separated list of <action>:<type>=<value>. Actions are drop and truncate. "
+              "Types are pid, port (of the remote endpoint), and request (a method and optional "
+              "first path segment). Example: 'drop:request=GET /healthz;truncate:port=9200'.");
+
 // Assume a moderate default network bandwidth peak of 100MiB/s across socket connections for data.
 DEFINE_uint32(stirling_socket_tracer_target_data_bw_percpu, 100 * 1024 * 1024,
               "Target bytes/sec of data per CPU");
@@ -107,6 +128,24 @@ DEFINE_uint32(stirling_socket_tracer_target_data_bw_percpu, 100 * 1024 * 1024,
 DEFINE_uint32(stirling_socket_tracer_target_control_bw_percpu, 5 * 1024 * 1024,
               "Target bytes/sec of control events per CPU");
 
+DEFINE_bool(stirling_conn_stats_bpf_aggregation,
+            gflags::BoolFromEnv("PL_STIRLING_CONN_STATS_BPF_AGGREGATION", false),
+            "If true, BPF sums up the conn_stats of connections per process, remote endpoint and "
+            "role itself, and user-space reads the sums on each conn_stats transfer, instead of "
+            "BPF sending an event per connection each time it transfers 64KiB.");
+DEFINE_bool(stirling_socket_tracer_use_ringbuf,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_USE_RINGBUF", false),
+            "If true, socket data events are sent through a single BPF ring buffer shared by all "
+            "CPUs, instead of per-CPU perf buffers. Falls back to perf buffers on kernels older "
+            "than 5.8.");
+DEFINE_uint32(stirling_socket_tracer_data_ringbuf_bytes, 64 * 1024 * 1024,
+              "Size of the socket data events ring buffer, when "
+              "--stirling_socket_tracer_use_ringbuf is set. Rounded up to a power of 2 pages.");
+
+DEFINE_uint32(stirling_socket_tracer_min_poll_period_ms, 20,
+              "The shortest period, in milliseconds, at which the perf buffers are polled between "
+              "transfers while socket data events arrive fast. The buffers are only polled with "
+              "each transfer if 0.");
 DEFINE_double(
     stirling_socket_tracer_percpu_bw_scaling_factor, 8,
     "Per CPU scaling factor to apply to perf buffers, with the formula "
@@ -143,6 +182,14 @@ DEFINE_uint32(datastream_buffer_retention_size,
 DEFINE_uint64(max_body_bytes, gflags::Uint64FromEnv("PL_STIRLING_MAX_BODY_BYTES", 512),
               "The maximum number of bytes in the body of protocols like HTTP");
 
+DEFINE_uint32(stirling_socket_tracer_transfer_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_TRANSFER_THREADS", 0),
+              "Number of worker threads used to parse and stitch connection data. "
+              "If 0, all connections are processed on the Stirling thread.");
+DEFINE_uint32(stirling_socket_tracer_transfer_shard_size, 64,
+              "Maximum number of connection trackers handed to a transfer worker at a time, "
+              "when --stirling_socket_tracer_transfer_threads is non-zero.");
+
 BPF_SRC_STRVIEW(socket_trace_bcc_script, socket_trace);
 
 namespace px {
@@ -160,6 +207,10 @@ constexpr size_t kMaxPBStringLen = 64;
 SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
     : SourceConnector(source_name, kTables), conn_stats_(&conn_trackers_mgr_), uprobe_mgr_(this) {
   proc_parser_ = std::make_unique<system::ProcParser>(system::Config::GetInstance());
+  if (FLAGS_stirling_fd_snapshot_min_lookups > 0) {
+    fd_link_snapshots_ = std::make_unique<FDLinkSnapshots>(
+        proc_parser_.get(), FLAGS_stirling_fd_snapshot_min_lookups);
+  }
   InitProtocolTransferSpecs();
 }
 
@@ -242,6 +293,21 @@ void SocketTraceConnector::InitProtocolTransferSpecs() {
     EnableIfNeeded(&transfer_specs_by_protocol[traffic_protocol_t(i)]);
     protocol_transfer_specs_.push_back(transfer_specs_by_protocol[traffic_protocol_t(i)]);
   }
+
+  StirlingMonitor& monitor = *StirlingMonitor::GetInstance();
+  for (uint64_t i = 0; i < kNumProtocols; ++i) {
+    auto protocol = traffic_protocol_t(i);
+    if (!protocol_transfer_specs_[protocol].enabled) {
+      continue;
+    }
+    std::string_view protocol_name = magic_enum::enum_name(protocol);
+    protocol_processing_stats_.push_back(
+        {protocol,
+         monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, name(),
+                                absl::StrCat("parse_ns.", protocol_name)),
+         monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, name(),
+                                absl::StrCat("stitch_ns.", protocol_name))});
+  }
 }
 
 using ProbeType = bpf_tools::BPFProbeAttachType;
@@ -292,9 +358,11 @@ const auto kProbeSpecs = MakeArray<bpf_tools::KProbeSpec>(
 using bpf_tools::PerfBufferSizeCategory;
 
 namespace {
+
+constexpr std::string_view kSocketDataEventsBufferName = "socket_data_events";
+
 // Resize each category of perf buffers such that it doesn't exceed a maximum size across all cpus.
-template <size_t N>
-void ResizePerfBufferSpecs(std::array<bpf_tools::PerfBufferSpec, N>* perf_buffer_specs,
+void ResizePerfBufferSpecs(std::vector<bpf_tools::PerfBufferSpec>* perf_buffer_specs,
                            const std::map<PerfBufferSizeCategory, size_t>& category_maximums) {
   std::map<PerfBufferSizeCategory, size_t> category_sizes;
   for (const auto& spec : *perf_buffer_specs) {
@@ -358,10 +426,13 @@ auto SocketTraceConnector::InitPerfBufferSpecs() {
       {{PerfBufferSizeCategory::kData, kMaxTotalDataSize},
        {PerfBufferSizeCategory::kControl, kMaxTotalControlSize}});
 
-  auto specs = MakeArray<bpf_tools::PerfBufferSpec>({
-      // For data events. The order must be consistent with output tables.
-      {"socket_data_events", HandleDataEvent, HandleDataEventLoss, kTargetDataBufferSize,
-       PerfBufferSizeCategory::kData},
+  std::vector<bpf_tools::PerfBufferSpec> specs;
+  if (!use_data_ringbuf_) {
+    // For data events. The order must be consistent with output tables.
+    specs.push_back({std::string(kSocketDataEventsBufferName), HandleDataEvent,
+                     HandleDataEventLoss, kTargetDataBufferSize, PerfBufferSizeCategory::kData});
+  }
+  specs.insert(specs.end(), {
       // For non-data events. Must not mix with the above perf buffers for data events.
       {"socket_control_events", HandleControlEvent, HandleControlEventLoss,
        kTargetControlBufferSize, PerfBufferSizeCategory::kControl},
@@ -379,6 +450,9 @@ auto SocketTraceConnector::InitPerfBufferSpecs() {
        kTargetDataBufferSize, PerfBufferSizeCategory::kData},
   });
   ResizePerfBufferSpecs(&specs, category_maximums);
+  if (!use_data_ringbuf_) {
+    data_buffer_bytes_ = specs.front().size_bytes;
+  }
   return specs;
 }
 
@@ -397,7 +471,30 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DENABLE_MUX_TRACING=", FLAGS_stirling_enable_mux_tracing),
       absl::StrCat("-DENABLE_AMQP_TRACING=", FLAGS_stirling_enable_amqp_tracing),
       absl::StrCat("-DENABLE_MONGO_TRACING=", "true"),
+      absl::StrCat("-DENABLE_HTTP_KERNEL_FILTER=",
+                   static_cast<int>(FLAGS_stirling_enable_http_kernel_filter)),
+      absl::StrCat("-DENABLE_CONN_STATS_AGGREGATION=",
+                   static_cast<int>(FLAGS_stirling_conn_stats_bpf_aggregation)),
   };
+  conn_stats_bpf_aggregation_ = FLAGS_stirling_conn_stats_bpf_aggregation;
+
+  constexpr uint32_t kLinux5p8VersionCode = 329728;
+  use_data_ringbuf_ = FLAGS_stirling_socket_tracer_use_ringbuf;
+  if (use_data_ringbuf_ && utils::GetCachedKernelVersion().code() < kLinux5p8VersionCode) {
+    LOG(INFO) << "BPF ring buffers are not supported by this kernel. Using perf buffers instead.";
+    use_data_ringbuf_ = false;
+  }
+  if (use_data_ringbuf_) {
+    const int kPageSizeBytes = system::Config::GetInstance().PageSizeBytes();
+    // Ring buffers must be sized to a power of 2 number of pages.
+    int num_pages = IntRoundUpToPow2(
+        IntRoundUpDivide(FLAGS_stirling_socket_tracer_data_ringbuf_bytes, kPageSizeBytes));
+    LOG(INFO) << absl::Substitute("Using ring buffer for socket data events [size=$0]",
+                                  num_pages * kPageSizeBytes);
+    data_buffer_bytes_ = static_cast<int64_t>(num_pages) * kPageSizeBytes;
+    defines.push_back(absl::StrCat("-DSOCKET_DATA_EVENTS_RINGBUF_PAGES=", num_pages));
+  }
+
   PL_RETURN_IF_ERROR(InitBPFProgram(socket_trace_bcc_script, defines));
 
   PL_RETURN_IF_ERROR(AttachKProbes(kProbeSpecs));
@@ -405,18 +502,41 @@ Status SocketTraceConnector::InitBPF() {
   LOG(INFO) << "Probes successfully deployed.";
 
   const auto kPerfBufferSpecs = InitPerfBufferSpecs();
-  PL_RETURN_IF_ERROR(OpenPerfBuffers(kPerfBufferSpecs, this));
+  PL_RETURN_IF_ERROR(OpenPerfBuffers(
+      ArrayView<bpf_tools::PerfBufferSpec>(kPerfBufferSpecs.data(), kPerfBufferSpecs.size()),
+      this));
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", kPerfBufferSpecs.size());
 
+  if (use_data_ringbuf_) {
+    PL_RETURN_IF_ERROR(OpenRingBuffer(
+        bpf_tools::RingBufferSpec{std::string(kSocketDataEventsBufferName), HandleDataEvent},
+        this));
+  }
+
   // Set trace role to BPF probes.
   for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
     if (protocol_transfer_specs_[p].enabled) {
-      uint64_t role_mask = 0;
-      for (auto role : protocol_transfer_specs_[p].trace_roles) {
-        role_mask |= role;
+      PL_RETURN_IF_ERROR(UpdateBPFProtocolTraceRole(p, ConfiguredTraceRoleMask(p)));
+    }
+  }
+
+  if (FLAGS_stirling_enable_http_kernel_filter) {
+    PL_ASSIGN_OR_RETURN(std::vector<HTTPKernelFilter> filters,
+                        ParseHTTPKernelFilters(FLAGS_stirling_http_kernel_filters));
+    for (const auto& filter : filters) {
+      switch (filter.type) {
+        case HTTPKernelFilter::Type::kTGID:
+          PL_RETURN_IF_ERROR(UpdateBPFHTTPFilterTGID(filter.id, filter.action));
+          break;
+        case HTTPKernelFilter::Type::kPort:
+          PL_RETURN_IF_ERROR(UpdateBPFHTTPFilterPort(filter.id, filter.action));
+          break;
+        case HTTPKernelFilter::Type::kRequest:
+          PL_RETURN_IF_ERROR(UpdateBPFHTTPFilterRequest(filter.request, filter.action));
+          break;
       }
-      PL_RETURN_IF_ERROR(UpdateBPFProtocolTraceRole(p, role_mask));
     }
+    LOG(INFO) << absl::Substitute("Number of in-kernel HTTP filters = $0", filters.size());
   }
 
   PL_RETURN_IF_ERROR(TestOnlySetTargetPID());
@@ -449,6 +569,9 @@ Status SocketTraceConnector::InitImpl() {
 
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
+  if (FLAGS_stirling_socket_tracer_min_poll_period_ms > 0) {
+    poll_freq_mgr_.set_period(kSamplingPeriod);
+  }
 
   constexpr uint64_t kNanosPerSecond = 1000 * 1000 * 1000;
   if (kNanosPerSecond % sysconfig_.KernelTicksPerSecond() != 0) {
@@ -474,6 +597,12 @@ Status SocketTraceConnector::InitImpl() {
   uprobe_mgr_.Init(protocol_transfer_specs_[kProtocolHTTP2].enabled,
                    FLAGS_stirling_disable_self_tracing);
 
+  if (FLAGS_stirling_socket_tracer_transfer_threads > 0) {
+    LOG(INFO) << absl::Substitute("Using $0 socket tracer transfer threads.",
+                                  FLAGS_stirling_socket_tracer_transfer_threads);
+    transfer_pool_ = std::make_unique<ThreadPool>(FLAGS_stirling_socket_tracer_transfer_threads);
+  }
+
   return Status::OK();
 }
 
@@ -499,11 +628,13 @@ Status SocketTraceConnector::StopImpl() {
   // otherwise the two threads will cause concurrent accesses to BCC,
   // that will cause races and undefined behavior.
   Close();
+
+  transfer_pool_.reset();
   return Status::OK();
 }
 
 std::thread SocketTraceConnector::RunDeployUProbesThread(
-    const absl::flat_hash_set<md::UPID>& pids) {
+    const md::UPIDSet& pids) {
   // The check that state is not uninitialized is required for socket_trace_connector_test,
   // which would otherwise try to deploy uprobes (for which it does not have permissions).
   // Also, we check that there is no other previous thread still running.
@@ -533,7 +664,7 @@ std::string DumpContext(ConnectorContext* ctx) {
 template <typename TBPFTableKey, typename TBPFTableVal>
 std::string BPFMapInfo(bpf_tools::BCCWrapper* bcc, std::string_view name) {
   auto map = bcc->GetHashTable<TBPFTableKey, TBPFTableVal>(name.data());
-  size_t map_size = map.get_table_offline().size();
+  size_t map_size = bcc->GetHashTableEntries<TBPFTableKey, TBPFTableVal>(name.data()).size();
   if (1.0 * map_size / map.capacity() > 0.9) {
     LOG(WARNING) << absl::Substitute("BPF Table $0 is nearly at capacity [size=$0 capacity=$1]",
                                      map_size, map.capacity());
@@ -576,7 +707,7 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // so raw data will be pushed to connection trackers more aggressively.
   // No data is lost, but this is a side-effect of sorts that affects timing of transfers.
   // It may be worth noting during debug.
-  PollPerfBuffers();
+  DrainPerfBuffers();
 
   // Set-up current state for connection inference purposes.
   if (socket_info_mgr_ != nullptr) {
@@ -590,6 +721,7 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
     thread.detach();
   }
 
+  conn_trackers_mgr_.UpdateHeavyHitterSampling();
   conn_trackers_mgr_.CleanupTrackers();
 
   // Periodically check for leaking conn_info_map entries.
@@ -604,6 +736,45 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   }
 }
 
+std::chrono::milliseconds SocketTraceConnector::NextPollPeriod(
+    std::chrono::milliseconds period, std::chrono::milliseconds elapsed, int64_t polled_bytes,
+    int64_t buffer_bytes, bool lost_events, std::chrono::milliseconds min_period) {
+  const std::chrono::milliseconds max_period =
+      std::max(min_period, std::min<std::chrono::milliseconds>(kSamplingPeriod, 2 * period));
+  if (lost_events) {
+    return min_period;
+  }
+  if (polled_bytes <= 0 || buffer_bytes <= 0) {
+    return max_period;
+  }
+  // The period at which the events of the last poll would have filled kTargetPollFill of the
+  // buffer.
+  auto target = std::chrono::milliseconds(static_cast<int64_t>(
+      elapsed.count() * kTargetPollFill * buffer_bytes / static_cast<double>(polled_bytes)));
+  return std::clamp(target, min_period, max_period);
+}
+
+void SocketTraceConnector::DrainPerfBuffers() {
+  auto now = std::chrono::steady_clock::now();
+  PollPerfBuffers();
+
+  int64_t data_bytes = stats_.Get(StatKey::kPollSocketDataEventSize);
+  int64_t data_losses = stats_.Get(StatKey::kLossSocketDataEvent);
+  if (polls_between_transfers()) {
+    poll_freq_mgr_.set_period(NextPollPeriod(
+        poll_freq_mgr_.period(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - last_drain_time_),
+        data_bytes - last_drain_data_bytes_, data_buffer_bytes_,
+        data_losses > last_drain_data_losses_,
+        std::chrono::milliseconds(FLAGS_stirling_socket_tracer_min_poll_period_ms)));
+  }
+  last_drain_time_ = now;
+  last_drain_data_bytes_ = data_bytes;
+  last_drain_data_losses_ = data_losses;
+}
+
+void SocketTraceConnector::PollImpl() { DrainPerfBuffers(); }
+
 void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
   if (pids_to_trace_.contains(tracker->conn_id().upid.pid)) {
     tracker->SetDebugTrace(2);
@@ -618,9 +789,10 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
   set_iteration_time(now_fn_());
 
   UpdateCommonState(ctx);
+  ApplyTableActivity();
 
   DataTable* conn_stats_table = data_tables[kConnStatsTableNum];
-  if (conn_stats_table != nullptr &&
+  if (conn_stats_table != nullptr && !applied_table_inactive_[kConnStatsTableNum] &&
       sampling_freq_mgr_.count() % FLAGS_stirling_conn_stats_sampling_ratio == 0) {
     TransferConnStats(ctx, conn_stats_table);
   }
@@ -641,6 +813,12 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
 
   std::vector<CIDRBlock> cluster_cidrs = ctx->GetClusterCIDRs();
 
+  // The perf buffers have been drained, so the FD snapshots taken from here on stay current
+  // until the next iteration.
+  if (fd_link_snapshots_ != nullptr) {
+    fd_link_snapshots_->NewIteration();
+  }
+
   for (size_t i = 0; i < data_tables.size(); ++i) {
     DataTable* data_table = data_tables[i];
 
@@ -652,43 +830,120 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
     }
   }
 
-  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables[transfer_spec.table_num];
+  if (transfer_pool_ == nullptr) {
+    for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
+      PrepareTrackerForTransfer(ctx, cluster_cidrs, conn_tracker);
+      TransferTracker(ctx, data_tables, conn_tracker, /* deferred_append */ nullptr);
+      conn_tracker->IterationPostTick();
     }
+  } else {
+    TransferTrackersParallel(ctx, data_tables, cluster_cidrs);
+  }
 
-    UpdateTrackerTraceLevel(conn_tracker);
+  RecordProtocolProcessingStats();
 
-    // Once a known UPID, always a known UPID.
-    if (!conn_tracker->is_tracked_upid()) {
-      md::UPID upid(ctx->GetASID(), conn_tracker->conn_id().upid.pid,
-                    conn_tracker->conn_id().upid.start_time_ticks);
-      if (ctx->GetUPIDs().contains(upid)) {
-        conn_tracker->set_is_tracked_upid();
-      }
+  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
+  pids_to_trace_disable_.clear();
+}
+
+void SocketTraceConnector::RecordProtocolProcessingStats() {
+  for (const auto& stats : protocol_processing_stats_) {
+    SocketTracerMetrics& metrics = SocketTracerMetrics::GetProtocolMetrics(stats.protocol);
+    uint64_t parse_ns = metrics.parse_ns.exchange(0, std::memory_order_relaxed);
+    uint64_t stitch_ns = metrics.stitch_ns.exchange(0, std::memory_order_relaxed);
+    // Protocols without any connections are not reported, so that they don't skew the counts.
+    if (parse_ns == 0 && stitch_ns == 0) {
+      continue;
     }
+    stats.parse->Record(parse_ns);
+    stats.stitch->Record(stitch_ns);
+  }
+}
 
-    conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
-                                   socket_info_mgr_.get());
+void SocketTraceConnector::PrepareTrackerForTransfer(ConnectorContext* ctx,
+                                                     const std::vector<CIDRBlock>& cluster_cidrs,
+                                                     ConnTracker* conn_tracker) {
+  UpdateTrackerTraceLevel(conn_tracker);
 
-    if (transfer_spec.transfer_fn != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
-    } else {
-      // If there's no transfer function, then the tracker should not be holding any data.
-      // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
-      // std::monotstate.
-      ECHECK(conn_tracker->send_data().Empty<protocols::http::Message>());
-      ECHECK(conn_tracker->recv_data().Empty<protocols::http::Message>());
+  // Once a known UPID, always a known UPID.
+  if (!conn_tracker->is_tracked_upid()) {
+    md::UPID upid(ctx->GetASID(), conn_tracker->conn_id().upid.pid,
+                  conn_tracker->conn_id().upid.start_time_ticks);
+    if (ctx->GetUPIDs().contains(upid)) {
+      conn_tracker->set_is_tracked_upid();
     }
+  }
+
+  conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
+                                 socket_info_mgr_.get(), fd_link_snapshots_.get());
+}
 
-    conn_tracker->IterationPostTick();
+void SocketTraceConnector::TransferTracker(ConnectorContext* ctx,
+                                           const std::vector<DataTable*>& data_tables,
+                                           ConnTracker* conn_tracker,
+                                           std::function<void()>* deferred_append) {
+  const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+
+  DataTable* data_table = nullptr;
+  if (transfer_spec.enabled) {
+    data_table = data_tables[transfer_spec.table_num];
   }
 
-  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
-  pids_to_trace_disable_.clear();
+  if (transfer_spec.transfer_fn != nullptr) {
+    transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table, deferred_append);
+  } else {
+    // If there's no transfer function, then the tracker should not be holding any data.
+    // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
+    // std::monotstate.
+    ECHECK(conn_tracker->send_data().Empty<protocols::http::Message>());
+    ECHECK(conn_tracker->recv_data().Empty<protocols::http::Message>());
+  }
+}
+
+void SocketTraceConnector::TransferTrackersParallel(ConnectorContext* ctx,
+                                                    const std::vector<DataTable*>& data_tables,
+                                                    const std::vector<CIDRBlock>& cluster_cidrs) {
+  // IterationPreTick() consults /proc and the SocketInfoManager, neither of which is
+  // thread-safe, so it stays on this thread.
+  std::vector<ConnTracker*> trackers;
+  trackers.reserve(conn_trackers_mgr_.active_trackers().size());
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
+    PrepareTrackerForTransfer(ctx, cluster_cidrs, conn_tracker);
+    trackers.push_back(conn_tracker);
+  }
+
+  // Shard the trackers by protocol, so that each worker runs the same parser and stitcher
+  // back-to-back. Large protocol groups are split further to spread them across workers.
+  const size_t shard_size = std::max<uint32_t>(1, FLAGS_stirling_socket_tracer_transfer_shard_size);
+  std::vector<std::vector<size_t>> shards;
+  std::vector<int> open_shard_by_protocol(kNumProtocols, -1);
+  for (size_t i = 0; i < trackers.size(); ++i) {
+    int& shard_idx = open_shard_by_protocol[trackers[i]->protocol()];
+    if (shard_idx < 0 || shards[shard_idx].size() >= shard_size) {
+      shard_idx = static_cast<int>(shards.size());
+      shards.emplace_back();
+      shards.back().reserve(shard_size);
+    }
+    shards[shard_idx].push_back(i);
+  }
+
+  // Parsing, stitching and cleanup only touch the tracker itself, so they run on the workers.
+  // The resulting records are not appended yet; the DataTables are not thread-safe.
+  std::vector<std::function<void()>> deferred_appends(trackers.size());
+  ParallelFor(transfer_pool_.get(), shards.size(), [&](size_t s) {
+    for (size_t i : shards[s]) {
+      TransferTracker(ctx, data_tables, trackers[i], &deferred_appends[i]);
+    }
+  });
+
+  // Merge in the original tracker order, so that the DataTables are populated exactly as they
+  // would be by a serial transfer.
+  for (size_t i = 0; i < trackers.size(); ++i) {
+    if (deferred_appends[i] != nullptr) {
+      deferred_appends[i]();
+    }
+    trackers[i]->IterationPostTick();
+  }
 }
 
 Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t protocol,
@@ -698,6 +953,81 @@ Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t proto
                                            &control_map_handle);
 }
 
+uint64_t SocketTraceConnector::ConfiguredTraceRoleMask(traffic_protocol_t protocol) const {
+  uint64_t role_mask = 0;
+  for (auto role : protocol_transfer_specs_[protocol].trace_roles) {
+    role_mask |= role;
+  }
+  return role_mask;
+}
+
+void SocketTraceConnector::SetTableActive(std::string_view table_name, bool active) {
+  for (size_t i = 0; i < kTables.size(); ++i) {
+    if (kTables[i].name() == table_name) {
+      table_inactive_[i] = !active;
+    }
+  }
+}
+
+void SocketTraceConnector::ApplyTableActivity() {
+  for (size_t i = 0; i < kTables.size(); ++i) {
+    bool inactive = table_inactive_[i];
+    if (inactive == applied_table_inactive_[i]) {
+      continue;
+    }
+    applied_table_inactive_[i] = inactive;
+    LOG(INFO) << absl::Substitute("Table $0 is now $1.", kTables[i].name(),
+                                  inactive ? "inactive" : "active");
+    for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
+      const TransferSpec& spec = protocol_transfer_specs_[p];
+      if (!spec.enabled || spec.table_num != i) {
+        continue;
+      }
+      Status s = UpdateBPFProtocolTraceRole(p, inactive ? 0 : ConfiguredTraceRoleMask(p));
+      LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to update trace role of $0: $1",
+                                                   magic_enum::enum_name(p), s.msg());
+    }
+  }
+}
+
+namespace {
+
+template <typename TKeyType>
+Status UpdateHTTPFilterMap(ebpf::BPFHashTable<TKeyType, uint32_t>* map, const TKeyType& key,
+                           http_filter_action_t action) {
+  if (action == kHTTPFilterActionNone) {
+    // Removing a filter that does not exist is not an error.
+    map->remove_value(key);
+    return Status::OK();
+  }
+  auto update_res = map->update_value(key, action);
+  if (!update_res.ok()) {
+    return error::Internal("Failed to update HTTP filter, error message: $0", update_res.msg());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status SocketTraceConnector::UpdateBPFHTTPFilterTGID(uint32_t tgid, http_filter_action_t action) {
+  auto map = GetHashTable<uint32_t, uint32_t>(kHTTPFilterTGIDMapName);
+  return UpdateHTTPFilterMap(&map, tgid, action);
+}
+
+Status SocketTraceConnector::UpdateBPFHTTPFilterPort(uint16_t port, http_filter_action_t action) {
+  auto map = GetHashTable<uint16_t, uint32_t>(kHTTPFilterPortMapName);
+  return UpdateHTTPFilterMap(&map, port, action);
+}
+
+Status SocketTraceConnector::UpdateBPFHTTPFilterRequest(std::string_view request,
+                                                        http_filter_action_t action) {
+  PL_RETURN_IF_ERROR(ValidateHTTPFilterRequest(request));
+  struct http_filter_key_t key = {};
+  std::memcpy(key.data, request.data(), request.size());
+  auto map = GetHashTable<struct http_filter_key_t, uint32_t>(kHTTPFilterRequestMapName);
+  return UpdateHTTPFilterMap(&map, key, action);
+}
+
 Status SocketTraceConnector::TestOnlySetTargetPID() {
   int64_t pid = FLAGS_test_only_socket_trace_target_pid;
   if (pid != kTraceAllTGIDs) {
@@ -1111,6 +1441,13 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
     content_type = HTTPContentType::kJSON;
   }
 
+  std::string req_headers;
+  std::string resp_headers;
+  if (FLAGS_stirling_http_record_headers) {
+    req_headers = protocols::http::HeadersJSONString(req_message);
+    resp_headers = protocols::http::HeadersJSONString(resp_message);
+  }
+
   DataTable::RecordBuilder<&kHTTPTable> r(data_table, resp_message.timestamp_ns);
   r.Append<r.ColIndex("time_")>(resp_message.timestamp_ns);
   r.Append<r.ColIndex("upid")>(upid.value());
@@ -1122,12 +1459,12 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("major_version")>(1);
   r.Append<r.ColIndex("minor_version")>(resp_message.minor_version);
   r.Append<r.ColIndex("content_type")>(static_cast<uint64_t>(content_type));
-  r.Append<r.ColIndex("req_headers")>(ToJSONString(req_message.headers), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("req_headers")>(req_headers, kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("req_method")>(std::move(req_message.req_method));
   r.Append<r.ColIndex("req_path")>(std::move(req_message.req_path));
   r.Append<r.ColIndex("req_body_size")>(req_message.body_size);
   r.Append<r.ColIndex("req_body")>(std::move(req_message.body), FLAGS_max_body_bytes);
-  r.Append<r.ColIndex("resp_headers")>(ToJSONString(resp_message.headers), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("resp_headers")>(resp_headers, kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("resp_status")>(resp_message.resp_status);
   r.Append<r.ColIndex("resp_message")>(std::move(resp_message.resp_message));
   r.Append<r.ColIndex("resp_body_size")>(resp_message.body_size);
@@ -1497,8 +1834,10 @@ void SocketTraceConnector::WriteDataEvent(const SocketDataEvent& event) {
 
 template <typename TProtocolTraits>
 void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tracker,
-                                          DataTable* data_table) {
+                                          DataTable* data_table,
+                                          std::function<void()>* deferred_append) {
   using TFrameType = typename TProtocolTraits::frame_type;
+  using TRecordType = typename TProtocolTraits::record_type;
 
   VLOG(3) << absl::StrCat("Connection\n", DebugString<TProtocolTraits>(*tracker, ""));
 
@@ -1510,10 +1849,35 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
     // ProcessToRecords() parses raw events and produces messages in format that are expected by
     // table store. But those messages are not cached inside ConnTracker.
     auto records = tracker->ProcessToRecords<TProtocolTraits>();
+    // Gather the timestamps so they can be converted as one batch. They are mostly in order,
+    // which the batch conversion takes advantage of.
+    std::vector<uint64_t> timestamps;
+    for (auto& record : records) {
+      TProtocolTraits::ConvertTimestamps(&record, [&](uint64_t mono_time) {
+        timestamps.push_back(mono_time);
+        return mono_time;
+      });
+    }
+    ConvertToRealTime(absl::MakeSpan(timestamps));
+    size_t timestamp_idx = 0;
     for (auto& record : records) {
       TProtocolTraits::ConvertTimestamps(
-          &record, [&](uint64_t mono_time) { return ConvertToRealTime(mono_time); });
-      AppendMessage(ctx, *tracker, std::move(record), data_table);
+          &record, [&](uint64_t) { return timestamps[timestamp_idx++]; });
+    }
+    DCHECK_EQ(timestamp_idx, timestamps.size());
+
+    if (deferred_append == nullptr) {
+      for (auto& record : records) {
+        AppendMessage(ctx, *tracker, std::move(record), data_table);
+      }
+    } else if (!records.empty()) {
+      // Hold on to the records until the caller is ready to append them to the table.
+      auto records_ptr = std::make_shared<std::vector<TRecordType>>(std::move(records));
+      *deferred_append = [ctx, tracker, data_table, records_ptr]() {
+        for (auto& record : *records_ptr) {
+          AppendMessage(ctx, *tracker, std::move(record), data_table);
+        }
+      };
     }
   }
 
@@ -1522,18 +1886,27 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
   auto message_expiry_timestamp =
       iteration_time() - std::chrono::seconds(FLAGS_messages_expiry_duration_secs);
 
-  tracker->Cleanup<TProtocolTraits>(FLAGS_messages_size_limit_bytes,
-                                    FLAGS_datastream_buffer_retention_size,
+  uint32_t size_divisor = shed_load_ ? kShedLoadBufferDivisor : 1;
+  tracker->Cleanup<TProtocolTraits>(FLAGS_messages_size_limit_bytes / size_divisor,
+                                    FLAGS_datastream_buffer_retention_size / size_divisor,
                                     message_expiry_timestamp, buffer_expiry_timestamp);
 }
 
 void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* data_table) {
   namespace idx = ::px::stirling::conn_stats_idx;
 
-  absl::flat_hash_set<md::UPID> upids = ctx->GetUPIDs();
+  md::UPIDSet upids = ctx->GetUPIDs();
   uint64_t time = AdjustedSteadyClockNowNS();
 
-  auto& agg_stats = conn_stats_.UpdateStats();
+  ConnStats::BPFAggregates bpf_aggregates;
+  if (conn_stats_bpf_aggregation_) {
+    bpf_aggregates =
+        GetPerCPUHashTable<conn_stats_agg_key_t, conn_stats_agg_value_t>(kConnStatsAggMapName)
+            .get_table_offline();
+  }
+  auto& agg_stats = conn_stats_bpf_aggregation_ ? conn_stats_.UpdateStatsFromBPF(bpf_aggregates)
+                                                : conn_stats_.UpdateStats();
+  md::UPIDSet exited_upids;
 
   auto iter = agg_stats.begin();
   while (iter != agg_stats.end()) {
@@ -1579,6 +1952,7 @@ void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* d
       const auto& sysconfig = system::Config::GetInstance();
       std::filesystem::path pid_file = sysconfig.proc_path() / std::to_string(key.upid.pid);
       if (!fs::Exists(pid_file)) {
+        exited_upids.insert(upid);
         agg_stats.erase(iter++);
         continue;
       }
@@ -1587,6 +1961,18 @@ void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* d
     // This is at the bottom, in order to avoid accidentally forgetting increment the iterator.
     ++iter;
   }
+
+  // Without this, BPF would keep the sums of exited processes forever.
+  if (conn_stats_bpf_aggregation_ && !exited_upids.empty()) {
+    auto agg_map =
+        GetPerCPUHashTable<conn_stats_agg_key_t, conn_stats_agg_value_t>(kConnStatsAggMapName);
+    for (const auto& [bpf_key, per_cpu_values] : bpf_aggregates) {
+      md::UPID upid(ctx->GetASID(), bpf_key.upid.pid, bpf_key.upid.start_time_ticks);
+      if (exited_upids.contains(upid)) {
+        agg_map.remove_value(bpf_key);
+      }
+    }
+  }
 }
 
 }  // namespace stirling
@@ -18,18 +18,23 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/synchronization/mutex.h>
 
+#include "src/common/base/thread_pool.h"
 #include "src/common/grpcutils/service_descriptor_database.h"
 #include "src/common/system/socket_info.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
@@ -42,10 +47,12 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/http_kernel_filter.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
 #include "src/stirling/utils/linux_headers.h"
+#include "src/stirling/utils/monitor.h"
 #include "src/stirling/utils/proc_path_tools.h"
 #include "src/stirling/utils/proc_tracker.h"
 
@@ -64,10 +71,15 @@ DECLARE_int32(stirling_enable_kafka_tracing);
 DECLARE_int32(stirling_enable_mux_tracing);
 DECLARE_int32(stirling_enable_amqp_tracing);
 DECLARE_bool(stirling_disable_self_tracing);
+DECLARE_bool(stirling_enable_http_kernel_filter);
+DECLARE_string(stirling_http_kernel_filters);
 DECLARE_string(stirling_role_to_trace);
 
 DECLARE_uint32(stirling_socket_tracer_target_data_bw_percpu);
 DECLARE_uint32(stirling_socket_tracer_target_control_bw_percpu);
+DECLARE_bool(stirling_socket_tracer_use_ringbuf);
+DECLARE_uint32(stirling_socket_tracer_data_ringbuf_bytes);
+DECLARE_uint32(stirling_socket_tracer_min_poll_period_ms);
 
 DECLARE_uint32(messages_expiry_duration_secs);
 DECLARE_uint32(messages_size_limit_bytes);
@@ -76,6 +88,9 @@ DECLARE_uint32(datastream_buffer_retention_size);
 
 DECLARE_uint64(max_body_bytes);
 
+DECLARE_uint32(stirling_socket_tracer_transfer_threads);
+DECLARE_uint32(stirling_socket_tracer_transfer_shard_size);
+
 namespace px {
 namespace stirling {
 
@@ -108,6 +123,21 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{200};
   // TODO(yzhao): This is not used right now. Eventually use this to control data push frequency.
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
+  // Between transfers, the perf buffers are polled often enough for each poll to find about this
+  // fraction of the socket data events buffer filled.
+  static constexpr double kTargetPollFill = 0.25;
+
+  /**
+   * Returns the period to poll the perf buffers at next, given the bytes of socket data events
+   * read by the last poll, elapsed after the one before it. The period shrinks right away to
+   * keep up with bursts, or if events were lost, and grows at most twofold per poll as the
+   * traffic calms down, up to kSamplingPeriod.
+   */
+  static std::chrono::milliseconds NextPollPeriod(std::chrono::milliseconds period,
+                                                  std::chrono::milliseconds elapsed,
+                                                  int64_t polled_bytes, int64_t buffer_bytes,
+                                                  bool lost_events,
+                                                  std::chrono::milliseconds min_period);
 
   static std::unique_ptr<SourceConnector> Create(std::string_view name) {
     return std::unique_ptr<SourceConnector>(new SocketTraceConnector(name));
@@ -117,6 +147,7 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   Status StopImpl() override;
   void InitContextImpl(ConnectorContext* ctx) override;
   void TransferDataImpl(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables) override;
+  void PollImpl() override;
 
   // Perform actions that are not specifically targeting a table.
   // For example, drain perf buffers, deploy new uprobes, and update socket info manager.
@@ -125,6 +156,10 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // That would then cause performance overheads.
   void UpdateCommonState(ConnectorContext* ctx);
 
+  // Polls the perf buffers, and adapts the period of the polls between transfers to how fast
+  // the socket data events arrive.
+  void DrainPerfBuffers();
+
   // Updates control map value for protocol, which specifies which role(s) to trace for the given
   // protocol's traffic.
   //
@@ -132,6 +167,25 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // data from inside BPF to user-space.
   Status UpdateBPFProtocolTraceRole(traffic_protocol_t protocol, uint64_t role_mask);
 
+  // The role mask that the protocol is traced with while its table is active.
+  uint64_t ConfiguredTraceRoleMask(traffic_protocol_t protocol) const;
+
+  // Turns the BPF tracing of each enabled protocol on or off, where the activity of its table has
+  // changed since the last call.
+  void ApplyTableActivity();
+
+  // Updates the in-kernel HTTP filter tables, which drop or truncate the data of matching HTTP
+  // requests and their responses before they are sent to user-space.
+  // Filters only take effect if --stirling_enable_http_kernel_filter is set.
+  // kHTTPFilterActionNone removes the filter.
+  //
+  // UpdateBPFHTTPFilterPort() matches the port of the remote endpoint.
+  // UpdateBPFHTTPFilterRequest() matches a method and optional first path segment, as accepted by
+  // ValidateHTTPFilterRequest().
+  Status UpdateBPFHTTPFilterTGID(uint32_t tgid, http_filter_action_t action);
+  Status UpdateBPFHTTPFilterPort(uint16_t port, http_filter_action_t action);
+  Status UpdateBPFHTTPFilterRequest(std::string_view request, http_filter_action_t action);
+
   // Instructs Stirling to log detailed debug information about the traced events from the PID
   // specified by --test_only_socket_trace_target_pid.
   Status TestOnlySetTargetPID();
@@ -142,6 +196,15 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
     pids_to_trace_disable_.insert(pid);
   }
 
+  // While shedding load, connection trackers keep kShedLoadBufferDivisor times less unparsed data
+  // and parsed messages between iterations.
+  void SetShedLoad(bool shed_load) override { shed_load_ = shed_load; }
+
+  // The protocols of inactive tables are not traced in BPF; conn_stats is not transferred while
+  // inactive. Takes effect on the next TransferData().
+  void SetTableActive(std::string_view table_name, bool active) override;
+  static constexpr uint32_t kShedLoadBufferDivisor = 4;
+
   /**
    * Gets a pointer to the most recent ConnTracker for the given pid and fd.
    *
@@ -200,10 +263,25 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
       bool outgoing,
       /* OUT */ struct go_grpc_http2_header_event_t* header_event_data_go_style);
 
+  // Transfers the parsed records of a tracker into the data table.
+  // If deferred_append is not null, the records are not appended; instead, deferred_append is
+  // set to a closure that appends them, so the caller can control when the table is mutated.
   template <typename TProtocolTraits>
-  void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
+  void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table,
+                      std::function<void()>* deferred_append);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
 
+  // Per-tracker steps of TransferDataImpl(). See TransferStream() for deferred_append.
+  void PrepareTrackerForTransfer(ConnectorContext* ctx, const std::vector<CIDRBlock>& cluster_cidrs,
+                                 ConnTracker* conn_tracker);
+  void TransferTracker(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables,
+                       ConnTracker* conn_tracker, std::function<void()>* deferred_append);
+
+  // Parses and stitches the active trackers on transfer_pool_, then appends the resulting
+  // records to the data tables in tracker order, on the calling thread.
+  void TransferTrackersParallel(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables,
+                                const std::vector<CIDRBlock>& cluster_cidrs);
+
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
     iteration_time_ = time;
@@ -216,7 +294,7 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                             TRecordType record, DataTable* data_table);
 
-  std::thread RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids);
+  std::thread RunDeployUProbesThread(const md::UPIDSet& pids);
 
   // Setups output file stream object writing to the input file path.
   void SetupOutput(const std::filesystem::path& file);
@@ -230,6 +308,16 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   absl::flat_hash_set<int> pids_to_trace_disable_;
 
+  // Set from other threads by SetShedLoad().
+  std::atomic<bool> shed_load_ = false;
+
+  // Whether BPF aggregates the conn stats, per --stirling_conn_stats_bpf_aggregation.
+  bool conn_stats_bpf_aggregation_ = false;
+
+  // Set from other threads by SetTableActive(), and applied by ApplyTableActivity().
+  std::array<std::atomic<bool>, kTables.size()> table_inactive_ = {};
+  std::array<bool, kTables.size()> applied_table_inactive_ = {};
+
   std::function<std::chrono::steady_clock::time_point()> now_fn_ = std::chrono::steady_clock::now;
 
   struct TransferSpec {
@@ -238,7 +326,8 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
     int32_t trace_mode = TraceMode::Off;
     uint32_t table_num = 0;
     std::vector<endpoint_role_t> trace_roles;
-    std::function<void(SocketTraceConnector&, ConnectorContext*, ConnTracker*, DataTable*)>
+    std::function<void(SocketTraceConnector&, ConnectorContext*, ConnTracker*, DataTable*,
+                       std::function<void()>*)>
         transfer_fn = nullptr;
     bool enabled = false;
   };
@@ -255,6 +344,16 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // The transfer_fn defines which function is called to process the data for transfer.
   std::vector<TransferSpec> protocol_transfer_specs_;
 
+  // Hot path stats of the time spent parsing and stitching each enabled protocol, per
+  // TransferData().
+  struct ProtocolProcessingStats {
+    traffic_protocol_t protocol;
+    HotPathStat* parse;
+    HotPathStat* stitch;
+  };
+  std::vector<ProtocolProcessingStats> protocol_processing_stats_;
+  void RecordProtocolProcessingStats();
+
   // The time at which TransferDataImpl() begin. Used as a universal timestamp for the iteration,
   // to avoid too many calls to std::chrono::steady_clock::now().
   std::chrono::time_point<std::chrono::steady_clock> iteration_time_;
@@ -265,6 +364,18 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   //   Example: data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
   uint64_t perf_buffer_drain_time_ = 0;
 
+  // Whether socket data events are received through a BPF ring buffer instead of perf buffers.
+  // Decided in InitBPF(), based on --stirling_socket_tracer_use_ringbuf and the kernel version.
+  bool use_data_ringbuf_ = false;
+
+  // The bytes that one CPU's socket data events perf buffer, or the ring buffer, holds. Events
+  // aren't spread evenly across CPUs, so the polls are paced as if all of them were on one CPU.
+  int64_t data_buffer_bytes_ = 0;
+  // When DrainPerfBuffers() last polled, and the socket data event stats at the time.
+  std::chrono::steady_clock::time_point last_drain_time_;
+  int64_t last_drain_data_bytes_ = 0;
+  int64_t last_drain_data_losses_ = 0;
+
   // If not a nullptr, writes the events received from perf buffers to this stream.
   std::unique_ptr<std::ofstream> perf_buffer_events_output_stream_;
   enum class OutputFormat {
@@ -277,11 +388,16 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   std::unique_ptr<system::SocketInfoManager> socket_info_mgr_;
 
   std::unique_ptr<system::ProcParser> proc_parser_;
+  // Shares the /proc FD directory reads of the connections of a process within an iteration.
+  std::unique_ptr<FDLinkSnapshots> fd_link_snapshots_;
 
   std::shared_ptr<ConnInfoMapManager> conn_info_map_mgr_;
 
   UProbeManager uprobe_mgr_;
 
+  // Workers for parsing and stitching connection data. Null if transfers are serial.
+  std::unique_ptr<ThreadPool> transfer_pool_;
+
   enum class StatKey {
     kLossSocketDataEvent,
     kLossSocketControlEvent,
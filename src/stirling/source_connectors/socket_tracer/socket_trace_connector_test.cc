@@ -153,7 +153,7 @@ class SocketTraceConnectorTest : public ::testing::Test {
     source_ = dynamic_cast<SocketTraceConnectorFriend*>(connector_.get());
     ASSERT_NE(nullptr, source_);
 
-    absl::flat_hash_set<md::UPID> upids = {md::UPID(kASID, kPID, kPIDStartTimeTicks)};
+    md::UPIDSet upids = {md::UPID(kASID, kPID, kPIDStartTimeTicks)};
     ctx_ = std::make_unique<StandaloneContext>(upids);
 
     // Tell the source to use our injected clock for getting the current time.
@@ -514,6 +514,59 @@ TEST_F(SocketTraceConnectorTest, RequestResponseMatching) {
               ElementsAre("/index.html", "/data.html", "/logs.html"));
 }
 
+TEST_F(SocketTraceConnectorTest, ParallelTransferMatchesSerialTransfer) {
+  constexpr int kNumConns = 16;
+  constexpr int kNumReqsPerConn = 4;
+
+  // Runs the same set of connections through the connector, and returns the request paths in the
+  // order they were appended to the HTTP table.
+  auto run = [&](SocketTraceConnectorFriend* source) {
+    std::vector<std::unique_ptr<testing::EventGenerator>> event_gens;
+    for (int c = 0; c < kNumConns; ++c) {
+      event_gens.push_back(std::make_unique<testing::EventGenerator>(&mock_clock_, kPID, kFD + c));
+      source->AcceptControlEvent(event_gens.back()->InitConn());
+    }
+    for (int r = 0; r < kNumReqsPerConn; ++r) {
+      for (int c = 0; c < kNumConns; ++c) {
+        std::string req = absl::StrCat("GET /conn", c, "/req", r,
+                                       " HTTP/1.1\r\nHost: www.pixielabs.ai\r\n\r\n");
+        source->AcceptDataEvent(event_gens[c]->InitSendEvent<kProtocolHTTP>(req));
+        source->AcceptDataEvent(event_gens[c]->InitRecvEvent<kProtocolHTTP>(kResp0));
+      }
+    }
+    for (int c = 0; c < kNumConns; ++c) {
+      source->AcceptControlEvent(event_gens[c]->InitClose());
+    }
+
+    testing::DataTables data_tables(SocketTraceConnector::kTables);
+    source->TransferData(ctx_.get(), data_tables.tables());
+
+    std::vector<TaggedRecordBatch> tablets = data_tables[kHTTPTableNum]->ConsumeRecords();
+    std::vector<std::string> paths;
+    for (const auto& tablet : tablets) {
+      std::vector<std::string> batch_paths = ToStringVector(tablet.records[kHTTPReqPathIdx]);
+      paths.insert(paths.end(), batch_paths.begin(), batch_paths.end());
+    }
+    return paths;
+  };
+
+  std::vector<std::string> serial_paths = run(source_);
+
+  std::unique_ptr<SourceConnector> parallel_connector =
+      SocketTraceConnectorFriend::Create("parallel_socket_trace_connector");
+  auto* parallel_source = dynamic_cast<SocketTraceConnectorFriend*>(parallel_connector.get());
+  ASSERT_NE(nullptr, parallel_source);
+  parallel_source->test_only_set_now_fn(
+      [this]() { return testing::NanosToTimePoint(mock_clock_.now()); });
+  parallel_source->SetTransferPool(std::make_unique<ThreadPool>(4));
+  PL_SET_FOR_SCOPE(FLAGS_stirling_socket_tracer_transfer_shard_size, 3);
+
+  std::vector<std::string> parallel_paths = run(parallel_source);
+
+  EXPECT_EQ(serial_paths.size(), kNumConns * kNumReqsPerConn);
+  EXPECT_EQ(parallel_paths, serial_paths);
+}
+
 TEST_F(SocketTraceConnectorTest, MissingEventInStream) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> req_event0 = event_gen_.InitSendEvent<kProtocolHTTP>(kReq0);
@@ -934,5 +987,38 @@ TEST_F(SocketTraceConnectorTest, UntrackedUPIDDoesNotTransferData) {
   ASSERT_TRUE(http_table_->ConsumeRecords().empty());
 }
 
+TEST(SocketTraceConnectorPollTest, NextPollPeriod) {
+  using std::chrono::milliseconds;
+  constexpr milliseconds kMinPeriod{20};
+  constexpr int64_t kBufferBytes = 1000;
+
+  // Losses go straight to the shortest period.
+  EXPECT_EQ(kMinPeriod, SocketTraceConnector::NextPollPeriod(
+                            milliseconds(200), milliseconds(200), 10, kBufferBytes,
+                            /* lost_events */ true, kMinPeriod));
+
+  // Idle polls back off twofold, up to the sampling period.
+  EXPECT_EQ(milliseconds(100), SocketTraceConnector::NextPollPeriod(
+                                   milliseconds(50), milliseconds(50), 0, kBufferBytes,
+                                   /* lost_events */ false, kMinPeriod));
+  EXPECT_EQ(SocketTraceConnector::kSamplingPeriod,
+            SocketTraceConnector::NextPollPeriod(milliseconds(150), milliseconds(150), 0,
+                                                 kBufferBytes, /* lost_events */ false,
+                                                 kMinPeriod));
+
+  // A poll that found the buffer full is followed by polls that find it a quarter full.
+  EXPECT_EQ(milliseconds(50), SocketTraceConnector::NextPollPeriod(
+                                  milliseconds(200), milliseconds(200), kBufferBytes,
+                                  kBufferBytes, /* lost_events */ false, kMinPeriod));
+  EXPECT_EQ(kMinPeriod, SocketTraceConnector::NextPollPeriod(
+                            milliseconds(200), milliseconds(200), 100 * kBufferBytes, kBufferBytes,
+                            /* lost_events */ false, kMinPeriod));
+
+  // As the traffic calms down, the period grows at most twofold per poll.
+  EXPECT_EQ(milliseconds(40), SocketTraceConnector::NextPollPeriod(
+                                  kMinPeriod, kMinPeriod, 10, kBufferBytes,
+                                  /* lost_events */ false, kMinPeriod));
+}
+
 }  // namespace stirling
 }  // namespace px
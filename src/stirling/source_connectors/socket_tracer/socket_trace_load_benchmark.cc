@@ -0,0 +1,554 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Drives SocketTraceConnector with synthetic BPF events at a configurable rate, to find the load
+// that the socket tracer sustains on a machine without needing a cluster or BPF. A producer thread
+// stands in for the kernel: it writes socket events into fake perf buffers, which drop what does
+// not fit, like the real ones. The main thread polls them through the connector's perf buffer
+// callbacks every sampling period, then calls TransferData(), like Stirling does.
+//
+//   socket_trace_load_benchmark --load_records_per_sec=50000 --load_conns=200 \
+//       --load_protocol_mix=http:3,mysql:1,pgsql:1
+//
+// A single run exits with 2 if its load was not sustainable. With --load_find_max, the rate is
+// doubled until the load is no longer sustainable, then bisected, and the highest sustainable
+// rate is reported.
+
+#include <gflags/gflags.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/substitute.h>
+#include <absl/synchronization/mutex.h>
+#include <magic_enum.hpp>
+
+#include "src/common/base/base.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/common/perf/tcmalloc.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/benchmark_data_gen/generators.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_trace_connector_friend.h"
+#include "src/stirling/testing/common.h"
+
+DEFINE_double(load_records_per_sec, 10000,
+              "Request/response pairs generated per second, over all connections. The starting "
+              "rate with --load_find_max.");
+DEFINE_int32(load_conns, 100, "Number of connections that the records are spread over.");
+DEFINE_string(load_protocol_mix, "http:1",
+              "Comma separated protocol:weight pairs, for the share of the connections of each "
+              "protocol. Supported protocols are http, mysql, pgsql, cql and nats.");
+DEFINE_uint64(load_record_size, 1024, "Approximate size in bytes of each request/response pair.");
+DEFINE_int32(load_conn_lifetime_records, 0,
+             "Connections are closed and replaced after this many records, to include the cost of "
+             "tracking new connections. Connections are never closed if 0.");
+DEFINE_double(load_duration_secs, 10, "How long each run lasts.");
+DEFINE_uint64(load_perf_buffer_bytes, 0,
+              "Size of the fake data event perf buffer. Defaults to the size of one CPU's buffer, "
+              "as set by --stirling_socket_tracer_target_data_bw_percpu.");
+DEFINE_double(load_max_cpu_fraction, 0.9,
+              "A run is only sustainable if the polling thread is busy for at most this fraction "
+              "of the time, besides not dropping any events.");
+DEFINE_bool(load_find_max, false, "Search for the highest sustainable --load_records_per_sec.");
+DEFINE_int32(load_search_steps, 4, "Number of bisection steps with --load_find_max.");
+
+namespace px {
+namespace stirling {
+namespace {
+
+using ::px::stirling::testing::CQLQueryReqRespGen;
+using ::px::stirling::testing::DataTables;
+using ::px::stirling::testing::HTTP1SingleReqRespGen;
+using ::px::stirling::testing::MySQLExecuteReqRespGen;
+using ::px::stirling::testing::NATSMSGGen;
+using ::px::stirling::testing::PostgresSelectReqRespGen;
+using ::px::stirling::testing::RecordGenerator;
+
+// The kernel's perf ring buffers add a header to each submission.
+constexpr size_t kPerfRecordHeaderBytes = 8;
+constexpr uint32_t kPID = 12345;
+constexpr uint64_t kPIDStartTimeTicks = 1;
+// How often the producer catches up with the target rate.
+constexpr auto kProducerTick = std::chrono::milliseconds{1};
+
+std::chrono::nanoseconds ThreadCPUTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+/**
+ * A bounded buffer of raw events, which drops the submissions that don't fit like a perf buffer.
+ * Polling passes the events and the number of losses to the callbacks that BCC would call.
+ */
+class FakePerfBuffer {
+ public:
+  using EventFn = std::function<void(void* data, int data_size)>;
+  using LossFn = std::function<void(uint64_t lost)>;
+
+  explicit FakePerfBuffer(size_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+  void Submit(std::string event) {
+    size_t bytes = event.size() + kPerfRecordHeaderBytes;
+    absl::MutexLock lock(&lock_);
+    if (bytes_ + bytes > capacity_bytes_) {
+      ++lost_;
+      return;
+    }
+    bytes_ += bytes;
+    events_.push_back(std::move(event));
+  }
+
+  // Returns the number of events passed to event_fn.
+  size_t Poll(const EventFn& event_fn, const LossFn& loss_fn) {
+    std::deque<std::string> events;
+    uint64_t lost = 0;
+    {
+      absl::MutexLock lock(&lock_);
+      events.swap(events_);
+      std::swap(lost, lost_);
+      bytes_ = 0;
+    }
+    if (lost > 0) {
+      loss_fn(lost);
+    }
+    for (auto& event : events) {
+      event_fn(event.data(), event.size());
+    }
+    return events.size();
+  }
+
+ private:
+  const size_t capacity_bytes_;
+  absl::Mutex lock_;
+  std::deque<std::string> events_ ABSL_GUARDED_BY(lock_);
+  size_t bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  uint64_t lost_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+struct ProtocolShare {
+  traffic_protocol_t protocol;
+  int weight;
+};
+
+StatusOr<std::vector<ProtocolShare>> ParseProtocolMix(std::string_view mix) {
+  std::vector<ProtocolShare> shares;
+  for (std::string_view entry : absl::StrSplit(mix, ',', absl::SkipEmpty())) {
+    std::vector<std::string_view> parts = absl::StrSplit(entry, ':');
+    int weight = 1;
+    if (parts.size() > 2 || (parts.size() == 2 && !absl::SimpleAtoi(parts[1], &weight)) ||
+        weight <= 0) {
+      return error::InvalidArgument("Invalid --load_protocol_mix entry '$0'.", entry);
+    }
+    traffic_protocol_t protocol;
+    if (parts[0] == "http") {
+      protocol = kProtocolHTTP;
+    } else if (parts[0] == "mysql") {
+      protocol = kProtocolMySQL;
+    } else if (parts[0] == "pgsql") {
+      protocol = kProtocolPGSQL;
+    } else if (parts[0] == "cql") {
+      protocol = kProtocolCQL;
+    } else if (parts[0] == "nats") {
+      protocol = kProtocolNATS;
+    } else {
+      return error::InvalidArgument("Unsupported protocol '$0' in --load_protocol_mix.", parts[0]);
+    }
+    shares.push_back({protocol, weight});
+  }
+  if (shares.empty()) {
+    return error::InvalidArgument("--load_protocol_mix is empty.");
+  }
+  return shares;
+}
+
+std::unique_ptr<RecordGenerator> CreateRecordGenerator(traffic_protocol_t protocol,
+                                                       size_t record_size) {
+  switch (protocol) {
+    case kProtocolMySQL:
+      return std::make_unique<MySQLExecuteReqRespGen>(record_size);
+    case kProtocolPGSQL:
+      return std::make_unique<PostgresSelectReqRespGen>(record_size);
+    case kProtocolCQL:
+      return std::make_unique<CQLQueryReqRespGen>(record_size);
+    case kProtocolNATS:
+      return std::make_unique<NATSMSGGen>(record_size);
+    default:
+      return std::make_unique<HTTP1SingleReqRespGen>(record_size);
+  }
+}
+
+struct LoadSpec {
+  double records_per_sec;
+  int num_conns;
+  std::vector<ProtocolShare> protocol_mix;
+  size_t record_size;
+  int conn_lifetime_records;
+  std::chrono::milliseconds duration;
+  size_t perf_buffer_bytes;
+};
+
+struct LoadResult {
+  uint64_t records_generated = 0;
+  uint64_t events_submitted = 0;
+  uint64_t events_polled = 0;
+  uint64_t events_dropped = 0;
+  uint64_t records_output = 0;
+  std::chrono::nanoseconds poll_cpu_time{0};
+  std::chrono::nanoseconds wall_time{0};
+  // The longest poll iteration, including TransferData().
+  std::chrono::nanoseconds max_iter_time{0};
+  MemoryStats mem_stats;
+
+  double cpu_fraction() const {
+    return wall_time.count() == 0
+               ? 0
+               : static_cast<double>(poll_cpu_time.count()) / wall_time.count();
+  }
+  bool sustainable() const {
+    return events_dropped == 0 && cpu_fraction() <= FLAGS_load_max_cpu_fraction;
+  }
+};
+
+/**
+ * Generates the events of the connections. Each connection sends the records of one protocol, as
+ * the server side, and is replaced by a new one after conn_lifetime_records records, if set.
+ */
+class EventProducer {
+ public:
+  EventProducer(const LoadSpec& spec, FakePerfBuffer* data_buffer, FakePerfBuffer* control_buffer)
+      : spec_(spec), data_buffer_(data_buffer), control_buffer_(control_buffer) {
+    int total_weight = 0;
+    for (const auto& share : spec_.protocol_mix) {
+      total_weight += share.weight;
+    }
+    // Connections are assigned protocols in proportion to the weights, interleaved.
+    for (int i = 0; i < spec_.num_conns; ++i) {
+      int slot = i % total_weight;
+      auto share = spec_.protocol_mix.begin();
+      while (slot >= share->weight) {
+        slot -= share->weight;
+        ++share;
+      }
+      Conn conn;
+      conn.fd = i + 3;
+      conn.protocol = share->protocol;
+      conn.gen = CreateRecordGenerator(conn.protocol, spec_.record_size);
+      conns_.push_back(std::move(conn));
+    }
+  }
+
+  uint64_t records_generated() const { return records_generated_; }
+  uint64_t events_submitted() const { return events_submitted_; }
+
+  // Opens all the connections, before the clock starts.
+  void OpenAll() {
+    for (auto& conn : conns_) {
+      Open(&conn);
+    }
+  }
+
+  // Generates records at the target rate until stop is set.
+  void Run(const std::atomic<bool>& stop) {
+    auto start = std::chrono::steady_clock::now();
+    size_t next_conn = 0;
+    while (!stop) {
+      std::this_thread::sleep_for(kProducerTick);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      auto target = static_cast<uint64_t>(elapsed.count() * spec_.records_per_sec);
+      while (records_generated_ < target && !stop) {
+        GenerateRecord(&conns_[next_conn]);
+        next_conn = (next_conn + 1) % conns_.size();
+      }
+    }
+  }
+
+ private:
+  struct Conn {
+    int32_t fd = 0;
+    uint64_t tsid = 0;
+    traffic_protocol_t protocol = kProtocolUnknown;
+    std::unique_ptr<RecordGenerator> gen;
+    uint64_t send_pos = 0;
+    uint64_t recv_pos = 0;
+    int records = 0;
+  };
+
+  uint64_t NowNS() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void SubmitControlEvent(const socket_control_event_t& event) {
+    std::string raw(reinterpret_cast<const char*>(&event), sizeof(event));
+    control_buffer_->Submit(std::move(raw));
+  }
+
+  void Open(Conn* conn) {
+    conn->tsid = ++next_tsid_;
+    conn->send_pos = 0;
+    conn->recv_pos = 0;
+    conn->records = 0;
+
+    struct socket_control_event_t event {};
+    event.type = kConnOpen;
+    event.timestamp_ns = NowNS();
+    event.conn_id = ConnID(*conn);
+    event.open.addr.sa.sa_family = AF_INET;
+    event.open.role = kRoleServer;
+    SubmitControlEvent(event);
+  }
+
+  void Close(Conn* conn) {
+    struct socket_control_event_t event {};
+    event.type = kConnClose;
+    event.timestamp_ns = NowNS();
+    event.conn_id = ConnID(*conn);
+    event.close.rd_bytes = conn->recv_pos;
+    event.close.wr_bytes = conn->send_pos;
+    SubmitControlEvent(event);
+  }
+
+  struct conn_id_t ConnID(const Conn& conn) const {
+    struct conn_id_t conn_id {};
+    conn_id.upid.pid = kPID;
+    conn_id.upid.start_time_ticks = kPIDStartTimeTicks;
+    conn_id.fd = conn.fd;
+    conn_id.tsid = conn.tsid;
+    return conn_id;
+  }
+
+  void GenerateRecord(Conn* conn) {
+    auto record = conn->gen->Next(conn->fd);
+    for (const auto& [direction, msg] : record.frames) {
+      uint64_t* pos = direction == kEgress ? &conn->send_pos : &conn->recv_pos;
+      // Messages larger than an event are split over several, as by the BPF probes.
+      for (size_t offset = 0; offset < msg.size(); offset += MAX_MSG_SIZE) {
+        std::string_view chunk = msg.substr(offset, MAX_MSG_SIZE);
+        socket_data_event_t::attr_t attr {};
+        attr.timestamp_ns = NowNS();
+        attr.conn_id = ConnID(*conn);
+        attr.protocol = conn->protocol;
+        attr.role = kRoleServer;
+        attr.direction = direction;
+        attr.source_fn = direction == kEgress ? kSyscallWrite : kSyscallRead;
+        attr.pos = *pos + offset;
+        attr.msg_size = chunk.size();
+        attr.msg_buf_size = chunk.size();
+
+        std::string raw(offsetof(socket_data_event_t, msg) + chunk.size(), '\0');
+        memcpy(raw.data() + offsetof(socket_data_event_t, attr), &attr, sizeof(attr));
+        memcpy(raw.data() + offsetof(socket_data_event_t, msg), chunk.data(), chunk.size());
+        data_buffer_->Submit(std::move(raw));
+        ++events_submitted_;
+      }
+      *pos += msg.size();
+    }
+    ++records_generated_;
+
+    if (spec_.conn_lifetime_records > 0 && ++conn->records >= spec_.conn_lifetime_records) {
+      Close(conn);
+      Open(conn);
+    }
+  }
+
+  const LoadSpec spec_;
+  FakePerfBuffer* data_buffer_;
+  FakePerfBuffer* control_buffer_;
+  std::vector<Conn> conns_;
+  uint64_t next_tsid_ = 0;
+  std::atomic<uint64_t> records_generated_ = 0;
+  std::atomic<uint64_t> events_submitted_ = 0;
+};
+
+uint64_t ConsumeOutputRecords(DataTables* tables) {
+  uint64_t num_records = 0;
+  for (auto tbl : tables->tables()) {
+    for (const auto& tagged_record : tbl->ConsumeRecords()) {
+      if (!tagged_record.records.empty()) {
+        num_records += tagged_record.records[0]->Size();
+      }
+    }
+  }
+  return num_records;
+}
+
+LoadResult RunLoad(const LoadSpec& spec) {
+  LoadResult result;
+  {
+    auto source_connector = SocketTraceConnectorFriend::Create("socket_trace_connector");
+    auto* connector = static_cast<SocketTraceConnectorFriend*>(source_connector.get());
+    SystemWideStandaloneContext ctx;
+    DataTables tables(SocketTraceConnector::kTables);
+
+    FakePerfBuffer data_buffer(spec.perf_buffer_bytes);
+    // Control events are small and rare, so their buffer is not what limits the load.
+    FakePerfBuffer control_buffer(spec.perf_buffer_bytes);
+    auto on_data = [connector](void* data, int data_size) {
+      connector->HandleDataEvent(static_cast<socket_data_event_t*>(data), data_size);
+    };
+    auto on_data_loss = [connector, &result](uint64_t lost) {
+      connector->HandleDataEventLoss(lost);
+      result.events_dropped += lost;
+    };
+    auto on_control = [connector](void* data, int data_size) {
+      connector->HandleControlEvent(static_cast<socket_control_event_t*>(data), data_size);
+    };
+    auto on_control_loss = [connector](uint64_t lost) { connector->HandleControlEventLoss(lost); };
+
+    EventProducer producer(spec, &data_buffer, &control_buffer);
+    producer.OpenAll();
+    control_buffer.Poll(on_control, on_control_loss);
+    source_connector->TransferData(&ctx, tables.tables());
+
+    MemoryTracker mem_tracker(/*enable*/ true);
+    mem_tracker.Start();
+    std::atomic<bool> stop = false;
+    std::thread producer_thread([&]() { producer.Run(stop); });
+
+    auto start = std::chrono::steady_clock::now();
+    auto next_poll = start;
+    // The producer keeps running between polls, so the last iteration drains what is left.
+    bool last_iter = false;
+    while (!last_iter) {
+      next_poll += SocketTraceConnector::kSamplingPeriod;
+      std::this_thread::sleep_until(next_poll);
+      if (std::chrono::steady_clock::now() - start >= spec.duration) {
+        stop = true;
+        producer_thread.join();
+        last_iter = true;
+      }
+
+      auto iter_start = std::chrono::steady_clock::now();
+      auto cpu_start = ThreadCPUTime();
+      control_buffer.Poll(on_control, on_control_loss);
+      result.events_polled += data_buffer.Poll(on_data, on_data_loss);
+      source_connector->TransferData(&ctx, tables.tables());
+      result.records_output += ConsumeOutputRecords(&tables);
+      result.poll_cpu_time += ThreadCPUTime() - cpu_start;
+      result.max_iter_time =
+          std::max<std::chrono::nanoseconds>(result.max_iter_time,
+                                             std::chrono::steady_clock::now() - iter_start);
+    }
+    result.wall_time = std::chrono::steady_clock::now() - start;
+    result.mem_stats = mem_tracker.End();
+    result.records_generated = producer.records_generated();
+    result.events_submitted = producer.events_submitted();
+  }
+  ReleaseFreeMemory();
+  return result;
+}
+
+void Report(const LoadSpec& spec, const LoadResult& result) {
+  double wall_secs = std::chrono::duration<double>(result.wall_time).count();
+  LOG(INFO) << absl::Substitute(
+      "records/s: target=$0 generated=$1 output=$2 | events/s: $3 | dropped events: $4 "
+      "($5%) | poll CPU: $6% of one core, $7 ns/event, longest iteration $8 ms | memory: peak "
+      "$9 KiB above start | $10",
+      spec.records_per_sec, result.records_generated / wall_secs,
+      result.records_output / wall_secs, result.events_submitted / wall_secs,
+      result.events_dropped,
+      result.events_submitted == 0 ? 0 : 100.0 * result.events_dropped / result.events_submitted,
+      100 * result.cpu_fraction(),
+      result.events_polled == 0 ? 0 : result.poll_cpu_time.count() / result.events_polled,
+      std::chrono::duration<double, std::milli>(result.max_iter_time).count(),
+      (result.mem_stats.max.allocated - result.mem_stats.start.allocated) / 1024,
+      result.sustainable() ? "sustainable" : "NOT sustainable");
+}
+
+}  // namespace
+}  // namespace stirling
+}  // namespace px
+
+int main(int argc, char** argv) {
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  auto protocol_mix_or = px::stirling::ParseProtocolMix(FLAGS_load_protocol_mix);
+  if (!protocol_mix_or.ok()) {
+    LOG(ERROR) << protocol_mix_or.msg();
+    return 1;
+  }
+  if (FLAGS_load_records_per_sec <= 0 || FLAGS_load_conns <= 0 || FLAGS_load_duration_secs <= 0) {
+    LOG(ERROR) << "--load_records_per_sec, --load_conns and --load_duration_secs must be positive.";
+    return 1;
+  }
+
+  using px::stirling::SocketTraceConnector;
+  size_t perf_buffer_bytes = FLAGS_load_perf_buffer_bytes;
+  if (perf_buffer_bytes == 0) {
+    perf_buffer_bytes = static_cast<size_t>(
+        FLAGS_stirling_socket_tracer_target_data_bw_percpu *
+        std::chrono::duration<double>(SocketTraceConnector::kSamplingPeriod).count());
+  }
+
+  px::stirling::LoadSpec spec{
+      .records_per_sec = FLAGS_load_records_per_sec,
+      .num_conns = FLAGS_load_conns,
+      .protocol_mix = protocol_mix_or.ConsumeValueOrDie(),
+      .record_size = FLAGS_load_record_size,
+      .conn_lifetime_records = FLAGS_load_conn_lifetime_records,
+      .duration = std::chrono::milliseconds(static_cast<int64_t>(FLAGS_load_duration_secs * 1000)),
+      .perf_buffer_bytes = perf_buffer_bytes,
+  };
+  LOG(INFO) << absl::Substitute("conns=$0 mix=$1 record_size=$2 perf_buffer_bytes=$3",
+                                spec.num_conns, FLAGS_load_protocol_mix, spec.record_size,
+                                spec.perf_buffer_bytes);
+
+  if (!FLAGS_load_find_max) {
+    auto result = px::stirling::RunLoad(spec);
+    px::stirling::Report(spec, result);
+    return result.sustainable() ? 0 : 2;
+  }
+
+  // Double the rate until a run is not sustainable, then bisect between the last two rates.
+  double good_rate = 0;
+  double bad_rate = 0;
+  while (bad_rate == 0) {
+    auto result = px::stirling::RunLoad(spec);
+    px::stirling::Report(spec, result);
+    if (result.sustainable()) {
+      good_rate = spec.records_per_sec;
+      spec.records_per_sec *= 2;
+    } else {
+      bad_rate = spec.records_per_sec;
+    }
+  }
+  for (int i = 0; i < FLAGS_load_search_steps; ++i) {
+    spec.records_per_sec = (good_rate + bad_rate) / 2;
+    auto result = px::stirling::RunLoad(spec);
+    px::stirling::Report(spec, result);
+    (result.sustainable() ? good_rate : bad_rate) = spec.records_per_sec;
+  }
+  LOG(INFO) << absl::Substitute("Maximum sustainable load: $0 records/s", good_rate);
+  return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Replays a capture of data events, as written with --socket_trace_data_events_output_path,
+// through SocketTraceConnector. One benchmark is registered for the whole capture, and one for
+// each protocol in it, so that production CPU regressions can be reproduced offline:
+//
+//   socket_trace_replay_benchmark --replay_input=/tmp/events.bin --replay_speedup=5
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <absl/container/btree_set.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <benchmark/benchmark.h>
+#include <magic_enum.hpp>
+
+#include "src/common/base/base.h"
+#include "src/common/perf/memory_tracker.h"
+#include "src/common/perf/tcmalloc.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/data_event_capture.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_trace_connector_friend.h"
+#include "src/stirling/testing/common.h"
+
+DEFINE_string(replay_input, "", "The data event capture to replay.");
+DEFINE_double(replay_speedup, 1.0,
+              "How much faster than real-time to replay. Each TransferData() call gets "
+              "replay_speedup times the capture time of a real sampling period.");
+
+using ::benchmark::Counter;
+using ::px::MemoryStats;
+using ::px::MemoryTracker;
+using ::px::stirling::SocketTraceConnector;
+using ::px::stirling::SocketTraceConnectorFriend;
+using ::px::stirling::SystemWideStandaloneContext;
+using ::px::stirling::testing::DataEventCapture;
+using ::px::stirling::testing::DataTables;
+using ::px::stirling::testing::ReplayIterations;
+
+namespace {
+
+uint64_t CountOutputRecords(DataTables* tables) {
+  uint64_t num_records = 0;
+  for (auto tbl : tables->tables()) {
+    for (const auto& tagged_record : tbl->ConsumeRecords()) {
+      if (!tagged_record.records.empty()) {
+        num_records += tagged_record.records[0]->Size();
+      }
+    }
+  }
+  return num_records;
+}
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t idx = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+  std::nth_element(values.begin(), values.begin() + idx, values.end());
+  return values[idx];
+}
+
+// NOLINTNEXTLINE: runtime/references.
+void BM_SocketTraceReplay(benchmark::State& state, const ReplayIterations* replay) {
+  SystemWideStandaloneContext ctx;
+  std::vector<double> iter_times_ms;
+  uint64_t total_output_records = 0;
+  MemoryStats mem_stats;
+  bool is_first_iter = true;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto source_connector = SocketTraceConnectorFriend::Create("socket_trace_connector");
+      auto socket_trace_connector =
+          static_cast<SocketTraceConnectorFriend*>(source_connector.get());
+
+      DataTables tables(SocketTraceConnector::kTables);
+      for (auto event : replay->control_events) {
+        socket_trace_connector->AcceptControlEvent(event);
+      }
+      source_connector->TransferData(&ctx, tables.tables());
+
+      MemoryTracker mem_tracker(is_first_iter);
+      if (is_first_iter) {
+        mem_tracker.Start();
+      }
+      state.ResumeTiming();
+
+      for (const auto& iter_events : replay->per_iter_data_events) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto* event : iter_events) {
+          socket_trace_connector->AcceptDataEvent(event->ToSocketDataEvent());
+        }
+        source_connector->TransferData(&ctx, tables.tables());
+        iter_times_ms.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count());
+      }
+
+      state.PauseTiming();
+      if (is_first_iter) {
+        mem_stats = mem_tracker.End();
+      }
+      total_output_records += CountOutputRecords(&tables);
+    }
+    px::ReleaseFreeMemory();
+    is_first_iter = false;
+    state.ResumeTiming();
+  }
+
+#define MEM_COUNTER(x) Counter(x, Counter::kDefaults, Counter::OneK::kIs1024)
+  state.counters["Events"] = Counter(replay->num_events * state.iterations(), Counter::kIsRate);
+  state.counters["Records"] = Counter(total_output_records, Counter::kIsRate);
+  state.counters["PollIters"] = Counter(replay->per_iter_data_events.size());
+  state.counters["IterP50ms"] = Counter(Percentile(iter_times_ms, 0.5));
+  state.counters["IterP99ms"] = Counter(Percentile(iter_times_ms, 0.99));
+  state.counters["AllocPeak"] = MEM_COUNTER(mem_stats.max.allocated - mem_stats.start.allocated);
+  state.counters["AllocEnd"] = MEM_COUNTER(mem_stats.end.allocated - mem_stats.start.allocated);
+  state.SetBytesProcessed(replay->data_size_bytes * state.iterations());
+#undef MEM_COUNTER
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  if (FLAGS_replay_input.empty()) {
+    LOG(ERROR) << "--replay_input must be specified.";
+    return 1;
+  }
+  if (FLAGS_replay_speedup <= 0) {
+    LOG(ERROR) << "--replay_speedup must be positive.";
+    return 1;
+  }
+
+  DataEventCapture capture =
+      px::stirling::testing::ReadDataEventCapture(FLAGS_replay_input).ConsumeValueOrDie();
+  LOG(INFO) << absl::Substitute("Read $0 events from $1.", capture.events.size(),
+                                FLAGS_replay_input);
+
+  const auto iter_duration_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(SocketTraceConnector::kSamplingPeriod)
+          .count() *
+      FLAGS_replay_speedup);
+
+  absl::btree_set<traffic_protocol_t> protocols;
+  for (const auto& event : capture.events) {
+    protocols.insert(event.attr.protocol);
+  }
+
+  // Registered benchmarks refer to these, so they must live until the benchmarks have run.
+  std::vector<ReplayIterations> replays;
+  replays.reserve(protocols.size() + 1);
+  replays.push_back(px::stirling::testing::SplitIntoIterations(capture, iter_duration_ns));
+  benchmark::RegisterBenchmark("BM_SocketTraceReplay/all", BM_SocketTraceReplay, &replays.back())
+      ->Unit(benchmark::kMillisecond);
+  for (traffic_protocol_t protocol : protocols) {
+    replays.push_back(
+        px::stirling::testing::SplitIntoIterations(capture, iter_duration_ns, protocol));
+    benchmark::RegisterBenchmark(
+        absl::StrCat("BM_SocketTraceReplay/", magic_enum::enum_name(protocol)).c_str(),
+        BM_SocketTraceReplay, &replays.back())
+        ->Unit(benchmark::kMillisecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/testing/data_event_capture.h"
+
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
+
+#include "src/common/base/file.h"
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+std::unique_ptr<SocketDataEvent> CapturedDataEvent::ToSocketDataEvent() const {
+  auto event = std::make_unique<SocketDataEvent>();
+  event->attr = attr;
+  event->msg = msg;
+  return event;
+}
+
+namespace {
+
+CapturedDataEvent FromPB(const sockeventpb::SocketDataEvent& pb) {
+  CapturedDataEvent event = {};
+  event.attr.timestamp_ns = pb.attr().timestamp_ns();
+  event.attr.conn_id.upid.pid = pb.attr().conn_id().pid();
+  event.attr.conn_id.upid.start_time_ticks = pb.attr().conn_id().start_time_ns();
+  event.attr.conn_id.fd = pb.attr().conn_id().fd();
+  event.attr.conn_id.tsid = pb.attr().conn_id().generation();
+  event.attr.protocol = static_cast<traffic_protocol_t>(pb.attr().protocol());
+  event.attr.role = static_cast<endpoint_role_t>(pb.attr().role());
+  event.attr.direction = static_cast<traffic_direction_t>(pb.attr().direction());
+  event.attr.pos = pb.attr().pos();
+  event.attr.msg_size = pb.attr().msg_size();
+  event.msg = pb.msg();
+  event.attr.msg_buf_size = event.msg.size();
+  return event;
+}
+
+Status ParseBinary(const std::string& contents, DataEventCapture* capture) {
+  google::protobuf::io::ArrayInputStream input(contents.data(), contents.size());
+  sockeventpb::SocketDataEvent pb;
+  bool clean_eof = false;
+  while (google::protobuf::util::ParseDelimitedFromZeroCopyStream(&pb, &input, &clean_eof)) {
+    capture->events.push_back(FromPB(pb));
+  }
+  if (!clean_eof) {
+    return error::InvalidArgument("Truncated or malformed event after $0 events.",
+                                  capture->events.size());
+  }
+  return Status::OK();
+}
+
+// The text output has no delimiters, but each message starts with its attr field.
+Status ParseText(const std::string& contents, DataEventCapture* capture) {
+  constexpr std::string_view kMessageStart = "attr {";
+
+  std::string message;
+  auto flush = [&]() -> Status {
+    if (message.empty()) {
+      return Status::OK();
+    }
+    sockeventpb::SocketDataEvent pb;
+    if (!google::protobuf::TextFormat::ParseFromString(message, &pb)) {
+      return error::InvalidArgument("Malformed event after $0 events.", capture->events.size());
+    }
+    capture->events.push_back(FromPB(pb));
+    message.clear();
+    return Status::OK();
+  };
+
+  for (std::string_view line : absl::StrSplit(contents, '\n')) {
+    if (line == kMessageStart) {
+      PL_RETURN_IF_ERROR(flush());
+    }
+    message.append(line);
+    message.push_back('\n');
+  }
+  return flush();
+}
+
+}  // namespace
+
+StatusOr<DataEventCapture> ReadDataEventCapture(const std::filesystem::path& path) {
+  PL_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(path));
+
+  DataEventCapture capture;
+  if (absl::EndsWith(path.string(), ".bin")) {
+    PL_RETURN_IF_ERROR(ParseBinary(contents, &capture));
+  } else {
+    PL_RETURN_IF_ERROR(ParseText(contents, &capture));
+  }
+  return capture;
+}
+
+ReplayIterations SplitIntoIterations(const DataEventCapture& capture, uint64_t iter_duration_ns,
+                                     std::optional<traffic_protocol_t> protocol) {
+  DCHECK_GT(iter_duration_ns, 0U);
+
+  ReplayIterations replay;
+  absl::flat_hash_set<conn_id_t> opened_conns;
+  uint64_t iter_end_ns = 0;
+
+  // Events are kept in file order, since that is the order the connector accepted them in.
+  // An iteration ends at the first event past its end, even if later events are older.
+  for (const CapturedDataEvent& event : capture.events) {
+    if (protocol.has_value() && event.attr.protocol != protocol.value()) {
+      continue;
+    }
+
+    if (replay.per_iter_data_events.empty()) {
+      replay.per_iter_data_events.emplace_back();
+      iter_end_ns = event.attr.timestamp_ns + iter_duration_ns;
+    }
+    while (event.attr.timestamp_ns >= iter_end_ns) {
+      replay.per_iter_data_events.emplace_back();
+      iter_end_ns += iter_duration_ns;
+    }
+
+    if (opened_conns.insert(event.attr.conn_id).second) {
+      struct socket_control_event_t conn_event {};
+      conn_event.type = kConnOpen;
+      conn_event.timestamp_ns = event.attr.timestamp_ns;
+      conn_event.conn_id = event.attr.conn_id;
+      conn_event.open.addr.sa.sa_family = AF_INET;
+      conn_event.open.role = event.attr.role;
+      replay.control_events.push_back(conn_event);
+    }
+
+    replay.per_iter_data_events.back().push_back(&event);
+    ++replay.num_events;
+    replay.data_size_bytes += event.msg.size();
+  }
+  return replay;
+}
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
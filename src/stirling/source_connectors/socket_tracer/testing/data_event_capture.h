@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+// A data event read back from a file written with --socket_trace_data_events_output_path.
+struct CapturedDataEvent {
+  socket_data_event_t::attr_t attr;
+  std::string msg;
+
+  // Returns an event that refers to msg, so it must not outlive this CapturedDataEvent.
+  std::unique_ptr<SocketDataEvent> ToSocketDataEvent() const;
+};
+
+struct DataEventCapture {
+  // Events in file order, which is the order in which they were accepted by the connector.
+  std::vector<CapturedDataEvent> events;
+};
+
+/**
+ * Reads a data event capture. Files ending in .bin are expected to hold length delimited
+ * messages, and anything else the text format.
+ */
+StatusOr<DataEventCapture> ReadDataEventCapture(const std::filesystem::path& path);
+
+struct ReplayIterations {
+  // The capture does not record control events, so a connection open event is synthesized for
+  // each connection, from its first data event.
+  std::vector<socket_control_event_t> control_events;
+
+  // Data events to push before each TransferData() call.
+  std::vector<std::vector<const CapturedDataEvent*>> per_iter_data_events;
+
+  uint64_t num_events = 0;
+  // Total size of the messages, not including the attributes.
+  uint64_t data_size_bytes = 0;
+};
+
+/**
+ * Groups the events of a capture into polling iterations, each covering iter_duration_ns of
+ * capture time. Events of other protocols are skipped, if a protocol is specified.
+ */
+ReplayIterations SplitIntoIterations(const DataEventCapture& capture, uint64_t iter_duration_ns,
+                                     std::optional<traffic_protocol_t> protocol = std::nullopt);
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
@@ -54,9 +54,13 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void HandleDataEvent(socket_data_event_t* data, int data_size) {
     SocketTraceConnector::HandleDataEvent(this, data, data_size);
   }
+  void HandleDataEventLoss(uint64_t lost) { SocketTraceConnector::HandleDataEventLoss(this, lost); }
   void HandleControlEvent(socket_control_event_t* data, int data_size) {
     SocketTraceConnector::HandleControlEvent(this, data, data_size);
   }
+  void HandleControlEventLoss(uint64_t lost) {
+    SocketTraceConnector::HandleControlEventLoss(this, lost);
+  }
   void HandleConnStatsEvent(conn_stats_event_t* data, int data_size) {
     SocketTraceConnector::HandleConnStatsEvent(this, data, data_size);
   }
@@ -69,6 +73,9 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void HandleHTTP2Data(go_grpc_data_event_t* data, int data_size) {
     SocketTraceConnector::HandleHTTP2Event(this, data, data_size);
   }
+
+  // Normally created in InitImpl(), which is not called by tests that inject events directly.
+  void SetTransferPool(std::unique_ptr<ThreadPool> pool) { transfer_pool_ = std::move(pool); }
 };
 
 }  // namespace stirling
@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
 
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -33,6 +34,7 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/go_symaddrs_cache.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
 DEFINE_bool(stirling_rescan_for_dlopen, false,
@@ -41,6 +43,11 @@ DEFINE_bool(stirling_rescan_for_dlopen, false,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_uint32(stirling_uprobe_scan_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_UPROBE_SCAN_THREADS", 2),
+              "Number of worker threads used to analyze binaries seen for the first time. "
+              "Each one holds the DWARF information of a binary while it runs. "
+              "If 0, binaries are analyzed on the uprobe deployment thread.");
 
 namespace px {
 namespace stirling {
@@ -55,6 +62,7 @@ UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
 void UProbeManager::Init(bool enable_http2_tracing, bool disable_self_probing) {
   cfg_enable_http2_tracing_ = enable_http2_tracing;
   cfg_disable_self_probing_ = disable_self_probing;
+  proc_tracker_.EnableProcEvents();
 
   openssl_symaddrs_map_ = UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>::Create(
       bcc_, "openssl_symaddrs_map");
@@ -69,6 +77,10 @@ void UProbeManager::Init(bool enable_http2_tracing, bool disable_self_probing) {
           bcc_, "node_tlswrap_symaddrs_map");
   go_goid_map_ = UserSpaceManagedBPFMap<uint32_t, int, ebpf::BPFMapInMapTable<uint32_t>>::Create(
       bcc_, "tgid_goid_map");
+
+  if (FLAGS_stirling_uprobe_scan_threads > 0) {
+    scan_pool_ = std::make_unique<ThreadPool>(FLAGS_stirling_uprobe_scan_threads);
+  }
 }
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) {
@@ -85,12 +97,12 @@ Status UProbeManager::LogAndAttachUProbe(const bpf_tools::UProbeSpec& spec) {
   return s;
 }
 
-StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                              const std::string& binary,
-                                              obj_tools::ElfReader* elf_reader) {
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::ResolveUProbeTmpl(
+    const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+    obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
     bpf_tools::UProbeSpec spec = {binary,
                                   /*symbol*/ {},
@@ -111,8 +123,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PL_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -129,8 +140,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           for (const uint64_t& addr : ret_inst_addrs) {
             spec.attach_type = BPFProbeAttachType::kEntry;
             spec.address = addr;
-            PL_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-            ++uprobe_count;
+            specs.push_back(spec);
           }
           break;
         }
@@ -139,51 +149,66 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
-}
-
-Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_manager,
-                                            std::filesystem::path libcrypto_path, uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs,
-                      OpenSSLSymAddrs(fptr_manager, libcrypto_path, pid));
-
-  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
-
-  return Status::OK();
+  return specs;
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
+StatusOr<int> UProbeManager::AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                               const std::string& binary) {
+  std::vector<bpf_tools::UProbeSpec> binary_specs = specs;
+  for (auto& spec : binary_specs) {
+    spec.binary_path = binary;
   }
 
-  return Status::OK();
-}
-
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
+  // The scan threads are idle while probes are attached, so they are reused for the attaching.
+  std::vector<Status> statuses =
+      bcc_->AttachUProbesParallel(ToArrayView(binary_specs), scan_pool_.get());
+
+  Status first_error;
+  for (size_t i = 0; i < statuses.size(); ++i) {
+    if (!statuses[i].ok()) {
+      monitor_.AppendProbeStatusRecord("socket_tracer", binary_specs[i].probe_fn, statuses[i],
+                                       binary_specs[i].ToJSON());
+      if (first_error.ok()) {
+        first_error = statuses[i];
+      }
+    }
   }
+  PL_RETURN_IF_ERROR(first_error);
+  return specs.size();
+}
 
-  return Status::OK();
+StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
+                                              const std::string& binary,
+                                              obj_tools::ElfReader* elf_reader) {
+  PL_ASSIGN_OR_RETURN(std::vector<bpf_tools::UProbeSpec> specs,
+                      ResolveUProbeTmpl(probe_tmpls, binary, elf_reader));
+  return AttachUProbeSpecs(specs, binary);
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
+StatusOr<UProbeManager::BinaryFileKey> UProbeManager::GetBinaryFileKey(
+    const std::filesystem::path& binary) {
+  PL_ASSIGN_OR_RETURN(struct stat st, fs::Stat(binary));
+  return BinaryFileKey{st.st_ino, st.st_size,
+                       static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 * 1000 * 1000 +
+                           st.st_mtim.tv_nsec};
+}
 
-  for (auto& pid : pids) {
-    go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
+Status UProbeManager::UpdateOpenSSLSymAddrs(const std::filesystem::path& libcrypto_path,
+                                            uint32_t pid) {
+  // Finding the OpenSSL version loads the library, so it is only done once per library.
+  PL_ASSIGN_OR_RETURN(BinaryFileKey key, GetBinaryFileKey(libcrypto_path));
+  auto iter = openssl_symaddrs_cache_.find(key);
+  if (iter == openssl_symaddrs_cache_.end()) {
+    PL_ASSIGN_OR_RETURN(auto reader, ElfReader::Create(libcrypto_path));
+    auto fptr_manager = std::make_unique<obj_tools::RawFptrManager>(
+        reader.get(), proc_parser_.get(), libcrypto_path);
+    PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs,
+                        OpenSSLSymAddrs(fptr_manager.get(), libcrypto_path, pid));
+    iter = openssl_symaddrs_cache_.emplace(key, symaddrs).first;
   }
 
+  openssl_symaddrs_map_->UpdateValue(pid, iter->second);
+
   return Status::OK();
 }
 
@@ -288,11 +313,7 @@ StatusOr<int> UProbeManager::AttachOpenSSLUProbesOnDynamicLib(uint32_t pid) {
     return error::Internal("libcrypto not found [path = $0]", container_libcrypto.string());
   }
 
-  PL_ASSIGN_OR_RETURN(auto reader, ElfReader::Create(container_libcrypto));
-  auto fptr_manager = std::make_unique<obj_tools::RawFptrManager>(reader.get(), proc_parser_.get(),
-                                                                  container_libcrypto);
-
-  PL_RETURN_IF_ERROR(UpdateOpenSSLSymAddrs(fptr_manager.get(), container_libcrypto, pid));
+  PL_RETURN_IF_ERROR(UpdateOpenSSLSymAddrs(container_libcrypto, pid));
 
   // Only try probing .so files that we haven't already set probes on.
   auto result = openssl_probed_binaries_.insert(container_libssl);
@@ -403,42 +424,143 @@ void UProbeManager::SetupGOIDMaps(const std::string& binary, const std::vector<i
   }
 }
 
-StatusOr<int> UProbeManager::AttachGoRuntimeUProbes(const std::string& binary,
-                                                    obj_tools::ElfReader* elf_reader,
-                                                    obj_tools::DwarfReader* /* dwarf_reader */,
-                                                    const std::vector<int32_t>& /* pids */) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  // TODO(oazizi): Implement this piece.
+namespace {
 
-  // Step 2: Deploy uprobes on all new binaries.
+// Resolves the symbol addresses of a Go binary from its DWARF information.
+// Returns error if the binary has no debug symbols.
+StatusOr<GoBinarySymAddrs> ResolveGoBinarySymAddrs(const std::string& binary,
+                                                   ElfReader* elf_reader,
+                                                   bool enable_http2_tracing) {
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::CreateIndexingAll(binary);
+  if (!dwarf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+        "Message = $1",
+        binary, dwarf_reader_status.msg());
+    return dwarf_reader_status.status();
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+
+  GoBinarySymAddrs symaddrs;
+  StatusOr<struct go_common_symaddrs_t> common_symaddrs =
+      GoCommonSymAddrs(elf_reader, dwarf_reader.get());
+  if (!common_symaddrs.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+    return symaddrs;
+  }
+  symaddrs.probeable = true;
+  symaddrs.common_symaddrs = common_symaddrs.ConsumeValueOrDie();
+
+  // A binary without the mandatory symbols doesn't appear to use Go TLS, or HTTP2.
+  // Either way, it is not of interest to probe.
+  StatusOr<struct go_tls_symaddrs_t> tls_symaddrs = GoTLSSymAddrs(elf_reader, dwarf_reader.get());
+  if (tls_symaddrs.ok()) {
+    symaddrs.tls_symaddrs = tls_symaddrs.ConsumeValueOrDie();
+  }
+
+  if (enable_http2_tracing) {
+    symaddrs.http2_resolved = true;
+    StatusOr<struct go_http2_symaddrs_t> http2_symaddrs =
+        GoHTTP2SymAddrs(elf_reader, dwarf_reader.get());
+    if (http2_symaddrs.ok()) {
+      symaddrs.http2_symaddrs = http2_symaddrs.ConsumeValueOrDie();
+    }
+  }
+
+  return symaddrs;
+}
+
+}  // namespace
+
+StatusOr<UProbeManager::GoBinaryScan> UProbeManager::ScanGoBinary(const std::string& binary,
+                                                                   bool enable_http2_tracing) {
+  GoBinaryScan scan;
+
+  // Read binary's symbols.
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary));
+
+  // Avoid going past this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  if (!IsGoExecutable(elf_reader.get())) {
+    return scan;
+  }
+
+  // Replicas of the same binary share the symbol addresses, even across restarts, so they are
+  // only resolved from DWARF once per build.
+  const std::filesystem::path cache_dir = FLAGS_stirling_go_symaddrs_cache_dir;
+  const std::string cache_key =
+      cache_dir.empty() ? std::string() : GoSymAddrsCacheKey(elf_reader.get());
+  std::optional<GoBinarySymAddrs> symaddrs;
+  if (!cache_key.empty()) {
+    symaddrs = LookupGoSymAddrs(cache_dir, cache_key);
+    if (symaddrs.has_value() && enable_http2_tracing && !symaddrs->http2_resolved) {
+      symaddrs.reset();
+    }
+  }
+  if (!symaddrs.has_value()) {
+    PL_ASSIGN_OR(symaddrs, ResolveGoBinarySymAddrs(binary, elf_reader.get(), enable_http2_tracing),
+                 return scan);
+    if (!cache_key.empty()) {
+      Status s = StoreGoSymAddrs(cache_dir, cache_key, symaddrs.value());
+      LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to cache symaddrs of $0: $1", binary,
+                                                   s.ToString());
+    }
+  }
+
+  if (!symaddrs->probeable) {
+    return scan;
+  }
+  scan.probeable = true;
+  scan.common_symaddrs = symaddrs->common_symaddrs;
+  scan.runtime_probes = ResolveUProbeTmpl(kGoRuntimeUProbeTmpls, binary, elf_reader.get());
+
+  if (symaddrs->tls_symaddrs.has_value()) {
+    scan.tls_symaddrs = symaddrs->tls_symaddrs;
+    scan.tls_probes = ResolveUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader.get());
+  }
+
+  if (enable_http2_tracing && symaddrs->http2_symaddrs.has_value()) {
+    scan.http2_symaddrs = symaddrs->http2_symaddrs;
+    scan.http2_probes = ResolveUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader.get());
+  }
+
+  return scan;
+}
+
+StatusOr<int> UProbeManager::AttachGoRuntimeUProbes(const std::string& binary,
+                                                    const GoBinaryScan& scan) {
+  // Deploy uprobes on all new binaries.
   auto result = go_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoRuntimeUProbeTmpls, binary, elf_reader);
+  PL_RETURN_IF_ERROR(scan.runtime_probes.status());
+  return AttachUProbeSpecs(scan.runtime_probes.ValueOrDie(), binary);
 }
 
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const GoBinaryScan& scan,
                                                 const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
-    // Doesn't appear to be a binary with the mandatory symbols.
-    // Might not even be a golang binary.
-    // Either way, not of interest to probe.
+  if (!scan.tls_symaddrs.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symbols_map on all new PIDs.
+  for (auto& pid : pids) {
+    go_tls_symaddrs_map_->UpdateValue(pid, scan.tls_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  PL_RETURN_IF_ERROR(scan.tls_probes.status());
+  return AttachUProbeSpecs(scan.tls_probes.ValueOrDie(), binary);
 }
 
 // TODO(oazizi/yzhao): Should HTTP uprobes use a different set of perf buffers than the kprobes?
@@ -446,29 +568,32 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
 // cleanly. For example, right now, enabling uprobe & kprobe simultaneously can crash Stirling,
 // because of the mixed & duplicate data events from these 2 sources.
 StatusOr<int> UProbeManager::AttachGoHTTP2Probes(const std::string& binary,
-                                                 obj_tools::ElfReader* elf_reader,
-                                                 obj_tools::DwarfReader* dwarf_reader,
+                                                 const GoBinaryScan& scan,
                                                  const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!scan.http2_symaddrs.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symaddrs for this binary.
+  for (auto& pid : pids) {
+    go_http2_symaddrs_map_->UpdateValue(pid, scan.http2_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  PL_RETURN_IF_ERROR(scan.http2_probes.status());
+  return AttachUProbeSpecs(scan.http2_probes.ValueOrDie(), binary);
 }
 
 namespace {
 
 // Convert PID list from list of UPIDs to a map with key=binary name, value=PIDs
 std::map<std::string, std::vector<int32_t>> ConvertPIDsListToMap(
-    const absl::flat_hash_set<md::UPID>& upids, LazyLoadedFPResolver* fp_resolver) {
+    const md::UPIDSet& upids, LazyLoadedFPResolver* fp_resolver) {
   const system::Config& sysconfig = system::Config::GetInstance();
   const system::ProcParser proc_parser(sysconfig);
 
@@ -501,7 +626,7 @@ std::map<std::string, std::vector<int32_t>> ConvertPIDsListToMap(
 
 }  // namespace
 
-std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids) {
+std::thread UProbeManager::RunDeployUProbesThread(const md::UPIDSet& pids) {
   // Increment before starting thread to avoid race in case thread starts late.
   ++num_deploy_uprobes_threads_;
   return std::thread([this, pids]() {
@@ -511,18 +636,22 @@ std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::
   return {};
 }
 
-void UProbeManager::CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_upids) {
+void UProbeManager::CleanupPIDMaps(const md::UPIDSet& deleted_upids) {
+  std::vector<uint32_t> pids;
+  pids.reserve(deleted_upids.size());
   for (const auto& pid : deleted_upids) {
-    openssl_symaddrs_map_->RemoveValue(pid.pid());
-    go_common_symaddrs_map_->RemoveValue(pid.pid());
-    go_tls_symaddrs_map_->RemoveValue(pid.pid());
-    go_http2_symaddrs_map_->RemoveValue(pid.pid());
-    node_tlswrap_symaddrs_map_->RemoveValue(pid.pid());
-    go_goid_map_->RemoveValue(pid.pid());
+    pids.push_back(pid.pid());
   }
+
+  openssl_symaddrs_map_->RemoveValues(pids);
+  go_common_symaddrs_map_->RemoveValues(pids);
+  go_tls_symaddrs_map_->RemoveValues(pids);
+  go_http2_symaddrs_map_->RemoveValues(pids);
+  node_tlswrap_symaddrs_map_->RemoveValues(pids);
+  go_goid_map_->RemoveValues(pids);
 }
 
-int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+int UProbeManager::DeployOpenSSLUProbes(const md::UPIDSet& pids) {
   int uprobe_count = 0;
 
   // TODO(yzhao): Change to use ConvertPIDsListToMap() to avoid processing the same executable
@@ -566,17 +695,20 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
   return uprobe_count;
 }
 
-int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+int UProbeManager::DeployGoUProbes(const md::UPIDSet& pids) {
   int uprobe_count = 0;
 
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids, &fp_resolver_)) {
-    // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
-    if (!scanned_binaries_.insert(binary).second) {
-      continue;
-    }
+  const std::map<std::string, std::vector<int32_t>> binaries =
+      ConvertPIDsListToMap(pids, &fp_resolver_);
 
+  // Find the binaries that have not been seen before, by their contents. Binaries that have been
+  // seen reuse the earlier scan, which also gives their new PIDs the symbol addresses.
+  absl::flat_hash_map<std::string, BinaryFileKey> binary_keys;
+  std::vector<std::pair<BinaryFileKey, std::string>> binaries_to_scan;
+  absl::flat_hash_set<BinaryFileKey> keys_to_scan;
+  for (const auto& [binary, pid_vec] : binaries) {
     if (cfg_disable_self_probing_) {
       // Don't try to attach uprobes to self.
       // This speeds up stirling_wrapper initialization significantly.
@@ -585,40 +717,45 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
+    PL_ASSIGN_OR(BinaryFileKey key, GetBinaryFileKey(binary), continue);
+    binary_keys.emplace(binary, key);
+    if (!go_binary_scans_.contains(key) && keys_to_scan.insert(key).second) {
+      binaries_to_scan.emplace_back(key, binary);
+    }
+  }
+
+  // Parsing ELF and DWARF information dominates the deployment time, so do it in parallel.
+  std::vector<StatusOr<GoBinaryScan>> scans(binaries_to_scan.size());
+  ParallelFor(scan_pool_.get(), binaries_to_scan.size(), [&](size_t i) {
+    scans[i] = ScanGoBinary(binaries_to_scan[i].second, cfg_enable_http2_tracing_);
+  });
+  for (size_t i = 0; i < scans.size(); ++i) {
+    const auto& [key, binary] = binaries_to_scan[i];
+    if (!scans[i].ok()) {
+      // Not cached, since the binary may be readable next time.
       LOG(WARNING) << absl::Substitute(
           "Cannot analyze binary $0 for uprobe deployment. "
           "If file is under /var/lib, container may have terminated. "
           "Message = $1",
-          binary, elf_reader_status.msg());
+          binary, scans[i].msg());
       continue;
     }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+    go_binary_scans_.emplace(key, scans[i].ConsumeValueOrDie());
+  }
 
-    // Avoid going past this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
+  for (const auto& [binary, pid_vec] : binaries) {
+    auto key_iter = binary_keys.find(binary);
+    if (key_iter == binary_keys.end()) {
       continue;
     }
-
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
+    auto scan_iter = go_binary_scans_.find(key_iter->second);
+    if (scan_iter == go_binary_scans_.end() || !scan_iter->second.probeable) {
       continue;
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+    const GoBinaryScan& scan = scan_iter->second;
 
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
-      continue;
+    for (auto& pid : pid_vec) {
+      go_common_symaddrs_map_->UpdateValue(pid, scan.common_symaddrs);
     }
 
     // Setup thread to GOID mapping.
@@ -626,8 +763,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
     // Go Runtime Probes.
     {
-      StatusOr<int> attach_status =
-          AttachGoRuntimeUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoRuntimeUProbes(binary, scan);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoRuntimeUProbes");
@@ -640,8 +776,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
     // GoTLS Probes.
     {
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoTLSUProbes(binary, scan, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoTLSUProbes");
@@ -654,8 +789,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
     // Go HTTP2 Probes.
     if (cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2Probes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+      StatusOr<int> attach_status = AttachGoHTTP2Probes(binary, scan, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoHTTP2Probes");
@@ -670,7 +804,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   return uprobe_count;
 }
 
-absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
+md::UPIDSet UProbeManager::PIDsToRescanForUProbes() {
   // Count number of calls to this function.
   ++rescan_counter_;
 
@@ -680,7 +814,7 @@ absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
   }
   uint32_t asid = proc_tracker_.upids().begin()->asid();
 
-  absl::flat_hash_set<md::UPID> upids_to_rescan;
+  md::UPIDSet upids_to_rescan;
   for (const auto& pid : upids_with_mmap_) {
     md::UPID upid(asid, pid.pid, pid.start_time_ticks);
 
@@ -716,7 +850,7 @@ absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
   return upids_to_rescan;
 }
 
-void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+void UProbeManager::DeployUProbes(const md::UPIDSet& pids) {
   const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
 
   proc_tracker_.Update(pids);
@@ -20,12 +20,14 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
 
+#include "src/common/base/thread_pool.h"
 #include "src/common/system/proc_parser.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
@@ -43,6 +45,7 @@
 
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_uint32(stirling_uprobe_scan_threads);
 
 namespace px {
 namespace stirling {
@@ -86,8 +89,28 @@ class UserSpaceManagedBPFMap {
     }
   }
 
+  // Removes all the keys that are in the map, with a single batch operation for hash tables.
+  void RemoveValues(const std::vector<TKeyType>& keys) {
+    if constexpr (std::is_same_v<TMapType, ebpf::BPFMapInMapTable<TKeyType>>) {
+      for (const auto& key : keys) {
+        RemoveValue(key);
+      }
+    } else {
+      std::vector<TKeyType> present_keys;
+      for (const auto& key : keys) {
+        if (shadow_keys_.erase(key) > 0) {
+          present_keys.push_back(key);
+        }
+      }
+      if (!present_keys.empty()) {
+        bcc_->RemoveHashTableKeys(map_name_, std::move(present_keys));
+      }
+    }
+  }
+
  private:
-  UserSpaceManagedBPFMap(bpf_tools::BCCWrapper* bcc, const std::string& map_name) {
+  UserSpaceManagedBPFMap(bpf_tools::BCCWrapper* bcc, const std::string& map_name)
+      : bcc_(bcc), map_name_(map_name) {
     if constexpr (std::is_same_v<TMapType, ebpf::BPFMapInMapTable<TKeyType>>) {
       map_ = std::make_unique<TMapType>(bcc->GetMapInMapTable<TKeyType>(map_name));
     } else {
@@ -95,6 +118,8 @@ class UserSpaceManagedBPFMap {
     }
   }
 
+  bpf_tools::BCCWrapper* bcc_;
+  std::string map_name_;
   std::unique_ptr<TMapType> map_;
   absl::flat_hash_set<TKeyType> shadow_keys_;
 };
@@ -131,7 +156,7 @@ class UProbeManager {
    *             if they need to be rescanned.
    * @return thread that handles the uprobe deployment work.
    */
-  std::thread RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids);
+  std::thread RunDeployUProbesThread(const md::UPIDSet& pids);
 
   /**
    * Returns true if a previously dispatched thread (via RunDeployUProbesThread is still running).
@@ -374,21 +399,21 @@ class UProbeManager {
    * Deploys all available uprobe types (HTTP2, OpenSSL, etc.) on new processes.
    * @param pids The list of pids to analyze and instrument with uprobes, if appropriate.
    */
-  void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  void DeployUProbes(const md::UPIDSet& pids);
 
   /**
    * Deploys all OpenSSL uprobes on new processes.
    * @param pids The list of pids to analyze and instrument with OpenSSL uprobes, if appropriate.
    * @return Number of uprobes deployed.
    */
-  int DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  int DeployOpenSSLUProbes(const md::UPIDSet& pids);
 
   /**
    * Deploys all Go uprobes on new processes.
    * @param pids The list of pids to analyze and instrument with Go uprobes, if appropriate.
    * @return Number of uprobes deployed.
    */
-  int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  int DeployGoUProbes(const md::UPIDSet& pids);
 
   /**
    * Sets up the BPF maps used for GOID tracking. Required for general Go tracing.
@@ -399,53 +424,88 @@ class UProbeManager {
   void SetupGOIDMaps(const std::string& binary, const std::vector<int32_t>& pids);
 
   /**
-   * Attaches the required probes for general Go tracing to the specified binary, if it is a
-   * compatible Go binary.
+   * Identifies the contents of a binary, independently of the path through which it is seen.
+   * The device is deliberately left out: containers started from the same image see the same
+   * overlayfs lower file under different mounts, and they should share one scan.
+   */
+  struct BinaryFileKey {
+    uint64_t inode;
+    int64_t size;
+    int64_t mtime_ns;
+
+    bool operator==(const BinaryFileKey& other) const {
+      return inode == other.inode && size == other.size && mtime_ns == other.mtime_ns;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const BinaryFileKey& key) {
+      return H::combine(std::move(h), key.inode, key.size, key.mtime_ns);
+    }
+  };
+
+  static StatusOr<BinaryFileKey> GetBinaryFileKey(const std::filesystem::path& binary);
+
+  /**
+   * The outcome of analyzing a Go binary: its symbol addresses, and the probes to attach to it.
+   * Probe specs have an empty binary_path, which is filled in for each path of the binary.
+   */
+  struct GoBinaryScan {
+    // False if this is not a Go binary, or it lacks the symbols required for Go tracing.
+    bool probeable = false;
+
+    struct go_common_symaddrs_t common_symaddrs = {};
+    std::optional<struct go_tls_symaddrs_t> tls_symaddrs;
+    std::optional<struct go_http2_symaddrs_t> http2_symaddrs;
+
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> runtime_probes;
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> tls_probes;
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> http2_probes;
+  };
+
+  /**
+   * Reads the ELF and DWARF information of a binary, and resolves everything needed to deploy Go
+   * probes on it. Touches no UProbeManager state, so it may run on the scan pool.
+   *
+   * @return The scan, or error if the binary could not be read. It is not an error if the binary
+   *         is not a Go binary; instead the scan is not probeable.
+   */
+  static StatusOr<GoBinaryScan> ScanGoBinary(const std::string& binary, bool enable_http2_tracing);
+
+  /**
+   * Attaches the required probes for general Go tracing to the specified binary.
    *
    * @param binary The path to the binary on which to deploy Go probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
-   * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
-   *             addresses.
-   * @return The number of uprobes deployed, or error. It is not an error if the binary
-   *         is not a Go binary; instead the return value will be zero.
+   * @param scan The scan of the binary.
+   * @return The number of uprobes deployed, or error.
    */
-  StatusOr<int> AttachGoRuntimeUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                       obj_tools::DwarfReader* dwarf_reader,
-                                       const std::vector<int32_t>& new_pids);
+  StatusOr<int> AttachGoRuntimeUProbes(const std::string& binary, const GoBinaryScan& scan);
 
   /**
-   * Attaches the required probes for Go HTTP2 tracing to the specified binary, if it is a
-   * compatible Go binary.
+   * Attaches the required probes for Go HTTP2 tracing to the specified binary, if it uses a Go
+   * HTTP2 library.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param scan The scan of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
-   *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
-   *         zero.
+   *         doesn't use a Go HTTP2 library; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                    obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, const GoBinaryScan& scan,
                                     const std::vector<int32_t>& pids);
 
   /**
-   * Attaches the required probes for GoTLS tracing to the specified binary, if it is a compatible
-   * Go binary.
+   * Attaches the required probes for GoTLS tracing to the specified binary, if it uses Go TLS.
    *
-   * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param binary The path to the binary on which to deploy GoTLS probes.
+   * @param scan The scan of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
-   *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
+   *         doesn't use Go TLS; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
-                                   const std::vector<int32_t>& new_pids);
+  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, const GoBinaryScan& scan,
+                                   const std::vector<int32_t>& pids);
 
   /**
    * Attaches the required probes for OpenSSL tracing to the specified PID, if it uses OpenSSL.
@@ -487,26 +547,33 @@ class UProbeManager {
   StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                  const std::string& binary, obj_tools::ElfReader* elf_reader);
 
+  /**
+   * Finds the symbol matches of the probe templates, and returns a spec per probe to attach.
+   * This is the part of AttachUProbeTmpl() that reads the binary.
+   */
+  static StatusOr<std::vector<bpf_tools::UProbeSpec>> ResolveUProbeTmpl(
+      const ArrayView<UProbeTmpl>& probe_tmpls, const std::string& binary,
+      obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches probe specs, as returned by ResolveUProbeTmpl(), to the specified binary.
+   * A probe that fails to attach is logged to the probe status table, and does not stop the others.
+   * @return Number of uprobes deployed, or the first error if any uprobe failed to deploy.
+   */
+  StatusOr<int> AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                  const std::string& binary);
+
   // Returns set of PIDs that have had mmap called on them since the last call.
-  absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
-
-  Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
-                               std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
-                             const std::vector<int32_t>& pids);
+  md::UPIDSet PIDsToRescanForUProbes();
+
+  Status UpdateOpenSSLSymAddrs(const std::filesystem::path& libcrypto_path, uint32_t pid);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
 
   // Clean-up various BPF maps used to communicate symbol addresses per PID.
   // Once the PID has terminated, the information is not required anymore.
   // Note that BPF maps can fill up if this is not done.
-  void CleanupPIDMaps(const absl::flat_hash_set<md::UPID>& deleted_upids);
+  void CleanupPIDMaps(const md::UPIDSet& deleted_upids);
 
   bpf_tools::BCCWrapper* bcc_;
 
@@ -532,18 +599,26 @@ class UProbeManager {
   // Map of UPIDs to the periodicity at which they are allowed to be rescanned.
   // The backoff value starts at 1 (meaning they can be scanned every iteration),
   // and exponentially grows every time nothing new is found.
-  absl::flat_hash_map<md::UPID, int> backoff_map_;
+  md::UPIDMap<int> backoff_map_;
 
   // Records the binaries that have uprobes attached, so we don't try to probe them again.
   // TODO(oazizi): How should these sets be cleaned up of old binaries, once they are deleted?
   //               Without clean-up, these could consume more-and-more memory.
   absl::flat_hash_set<std::string> openssl_probed_binaries_;
-  absl::flat_hash_set<std::string> scanned_binaries_;
   absl::flat_hash_set<std::string> go_probed_binaries_;
   absl::flat_hash_set<std::string> go_http2_probed_binaries_;
   absl::flat_hash_set<std::string> go_tls_probed_binaries_;
   absl::flat_hash_set<std::string> nodejs_binaries_;
 
+  // Results of analyzing binaries, keyed by their contents, so that processes sharing a binary
+  // (even under different paths) have it parsed only once. Entries are small, but are never
+  // removed either, for the same reason as above.
+  absl::flat_hash_map<BinaryFileKey, GoBinaryScan> go_binary_scans_;
+  absl::flat_hash_map<BinaryFileKey, struct openssl_symaddrs_t> openssl_symaddrs_cache_;
+
+  // Runs first-time scans of Go binaries in parallel. May be null or empty.
+  std::unique_ptr<ThreadPool> scan_pool_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>>
       openssl_symaddrs_map_;
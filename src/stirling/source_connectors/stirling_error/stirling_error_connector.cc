@@ -40,7 +40,7 @@ Status StirlingErrorConnector::StopImpl() { return Status::OK(); }
 
 void StirlingErrorConnector::TransferDataImpl(ConnectorContext* ctx,
                                               const std::vector<DataTable*>& data_tables) {
-  DCHECK_EQ(data_tables.size(), 2) << "StirlingErrorConnector has two data tables.";
+  DCHECK_EQ(data_tables.size(), kTables.size()) << "StirlingErrorConnector has three data tables.";
 
   if (data_tables[kStirlingErrorTableNum] != nullptr) {
     TransferStirlingErrorTable(ctx, data_tables[kStirlingErrorTableNum]);
@@ -49,6 +49,10 @@ void StirlingErrorConnector::TransferDataImpl(ConnectorContext* ctx,
   if (data_tables[kProbeStatusTableNum] != nullptr) {
     TransferProbeStatusTable(ctx, data_tables[kProbeStatusTableNum]);
   }
+
+  if (data_tables[kStirlingStatsTableNum] != nullptr) {
+    TransferStirlingStatsTable(ctx, data_tables[kStirlingStatsTableNum]);
+  }
 }
 
 void StirlingErrorConnector::TransferStirlingErrorTable(ConnectorContext* ctx,
@@ -80,5 +84,20 @@ void StirlingErrorConnector::TransferProbeStatusTable(ConnectorContext* ctx,
   }
 }
 
+void StirlingErrorConnector::TransferStirlingStatsTable(ConnectorContext* ctx,
+                                                        DataTable* data_table) {
+  md::UPID upid = md::UPID(ctx->GetASID(), pid_, start_time_);
+  for (auto& record : monitor_.ConsumeHotPathStatRecords()) {
+    DataTable::RecordBuilder<&kStirlingStatsTable> r(data_table, record.timestamp_ns);
+    r.Append<r.ColIndex("time_")>(static_cast<uint64_t>(record.timestamp_ns));
+    r.Append<r.ColIndex("upid")>(upid.value());
+    r.Append<r.ColIndex("source_connector")>(std::move(record.source_connector));
+    r.Append<r.ColIndex("stat")>(std::move(record.stat));
+    r.Append<r.ColIndex("count")>(record.count);
+    r.Append<r.ColIndex("sum")>(record.sum);
+    r.Append<r.ColIndex("max")>(record.max);
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -27,6 +27,7 @@
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/stirling_error/probe_status_table.h"
 #include "src/stirling/source_connectors/stirling_error/stirling_error_table.h"
+#include "src/stirling/source_connectors/stirling_error/stirling_stats_table.h"
 #include "src/stirling/utils/monitor.h"
 
 namespace px {
@@ -37,9 +38,11 @@ class StirlingErrorConnector : public SourceConnector {
   static constexpr std::string_view kName = "stirling_error";
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{1000};
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
-  static constexpr auto kTables = MakeArray(kStirlingErrorTable, kProbeStatusTable);
+  static constexpr auto kTables =
+      MakeArray(kStirlingErrorTable, kProbeStatusTable, kStirlingStatsTable);
   static constexpr uint32_t kStirlingErrorTableNum = TableNum(kTables, kStirlingErrorTable);
   static constexpr uint32_t kProbeStatusTableNum = TableNum(kTables, kProbeStatusTable);
+  static constexpr uint32_t kStirlingStatsTableNum = TableNum(kTables, kStirlingStatsTable);
 
   StirlingErrorConnector() = delete;
   ~StirlingErrorConnector() override = default;
@@ -59,6 +62,7 @@ class StirlingErrorConnector : public SourceConnector {
 
   void TransferStirlingErrorTable(ConnectorContext* ctx, DataTable* data_table);
   void TransferProbeStatusTable(ConnectorContext* ctx, DataTable* data_table);
+  void TransferStirlingStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
   StirlingMonitor& monitor_ = *StirlingMonitor::GetInstance();
   int32_t pid_ = -1;
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/canonical_types.h"
+#include "src/stirling/core/output.h"
+#include "src/stirling/core/source_connector.h"
+
+namespace px {
+namespace stirling {
+
+// clang-format off
+constexpr DataElement kStirlingStatsElements[] = {
+  canonical_data_elements::kTime,
+  canonical_data_elements::kUPID,
+  {"source_connector", "The source connector, or other part of Stirling, that the stat is for",
+   types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL_ENUM},
+  {"stat", "The name of the stat. Stats ending in _ns are durations in nanoseconds",
+   types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL_ENUM},
+  {"count", "The number of values recorded since the previous record of the stat",
+   types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+  {"sum", "The sum of the values recorded since the previous record of the stat",
+   types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+  {"max", "The largest value recorded since the previous record of the stat",
+   types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+};
+
+constexpr DataTableSchema kStirlingStatsTable {
+  "stirling_stats",
+  "This table contains hot path stats of Stirling, such as the time each source connector spends transferring data, and the records and bytes it pushes to each table",
+  kStirlingStatsElements
+};
+
+// clang-format on
+DEFINE_PRINT_TABLE(StirlingStats);
+
+}  // namespace stirling
+}  // namespace px
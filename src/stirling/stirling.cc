@@ -29,10 +29,15 @@
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_split.h>
+#include <absl/synchronization/mutex.h>
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
 #include "src/common/perf/elapsed_timer.h"
+#include "src/common/system/cpu_topology.h"
 #include "src/stirling/utils/system_info.h"
 
 #include "src/stirling/bpf_tools/probe_cleaner.h"
@@ -53,6 +58,8 @@
 #include "src/stirling/source_connectors/proc_exit/proc_exit_connector.h"
 #include "src/stirling/source_connectors/proc_stat/proc_stat_connector.h"
 #include "src/stirling/source_connectors/process_stats/process_stats_connector.h"
+#include "src/stirling/source_connectors/replay/replay_connector.h"
+#include "src/stirling/source_connectors/seq_gen/load_gen_connector.h"
 #include "src/stirling/source_connectors/seq_gen/seq_gen_connector.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
 #include "src/stirling/source_connectors/stirling_error/stirling_error_connector.h"
@@ -63,6 +70,15 @@ DEFINE_string(
     stirling_sources, gflags::StringFromEnv("PL_STIRLING_SOURCES", "kProd"),
     "Choose sources to enable. [kAll|kProd|kMetrics|kTracers|kProfiler] or comma separated list of "
     "sources (find them the header files of source connector classes).");
+DEFINE_string(stirling_source_threads, gflags::StringFromEnv("PL_STIRLING_SOURCE_THREADS", ""),
+              "Sources to run on threads of their own, so that slow sources do not delay the "
+              "others. A semicolon separated list of groups of comma separated source names, "
+              "e.g. 'socket_tracer;perf_profiler,proc_stat', where each group gets a thread. "
+              "Sources that are not listed run on the main Stirling thread.");
+DEFINE_string(stirling_numa_node, gflags::StringFromEnv("PL_STIRLING_NUMA_NODE", "auto"),
+              "The NUMA node whose CPUs run the Stirling threads, which read the perf buffers and "
+              "write the table store. 'auto' picks the first node on multi-node hosts, 'none' "
+              "leaves the threads unpinned, and a number picks that node.");
 
 namespace px {
 namespace stirling {
@@ -77,7 +93,8 @@ const std::vector<SourceRegistry::RegistryElement> kAllSources = {
     REGISTRY_PAIR(SocketTraceConnector),       REGISTRY_PAIR(ProcessStatsConnector),
     REGISTRY_PAIR(NetworkStatsConnector),      REGISTRY_PAIR(PerfProfileConnector),
     REGISTRY_PAIR(PIDCPUUseBPFTraceConnector), REGISTRY_PAIR(proc_exit_tracer::ProcExitConnector),
-    REGISTRY_PAIR(StirlingErrorConnector),
+    REGISTRY_PAIR(StirlingErrorConnector),     REGISTRY_PAIR(ReplayConnector),
+    REGISTRY_PAIR(LoadGenConnector),
 };
 #undef REGISTRY_PAIR
 
@@ -215,6 +232,8 @@ class StirlingImpl final : public Stirling {
   void Stop() override;
   void WaitForThreadJoin() override;
 
+  void SetShedLoad(bool shed_load) override;
+  void SetTableActive(std::string_view table_name, bool active) override;
   void SetDebugLevel(int level);
   void EnablePIDTrace(int pid);
   void DisablePIDTrace(int pid);
@@ -240,6 +259,12 @@ class StirlingImpl final : public Stirling {
   // Main run implementation.
   void RunCore();
 
+  // Samples and pushes the data of the sources on the given thread, until Stirling is stopped.
+  void RunSourceLoop(int source_thread);
+
+  // Returns the thread, as configured by --stirling_source_threads, that runs the source.
+  int SourceThread(const SourceConnector& source) const;
+
   // Wait for Stirling to stop its main loop.
   void WaitForStop();
 
@@ -256,8 +281,15 @@ class StirlingImpl final : public Stirling {
 
   InfoClassManagerVec info_class_mgrs_ ABSL_GUARDED_BY(info_class_mgrs_lock_);
 
-  // Lock to protect both info_class_mgrs_ and sources_.
-  absl::base_internal::SpinLock info_class_mgrs_lock_;
+  // Lock to protect both info_class_mgrs_ and sources_. Source threads only need a reader lock,
+  // since each source is only ever transferred and pushed by its own thread.
+  absl::Mutex info_class_mgrs_lock_;
+
+  // The thread of each source listed in --stirling_source_threads. Thread 0 is the main Stirling
+  // thread, and runs all the other sources.
+  static constexpr int kMainSourceThread = 0;
+  absl::flat_hash_map<std::string, int> source_threads_;
+  int num_source_threads_ = 0;
 
   std::unique_ptr<SourceRegistry> registry_;
 
@@ -269,6 +301,9 @@ class StirlingImpl final : public Stirling {
    */
   DataPushCallback data_push_callback_ = nullptr;
 
+  // Serializes calls to data_push_callback_, which can be made from several source threads.
+  absl::Mutex data_push_lock_;
+
   AgentMetadataCallback agent_metadata_callback_ = nullptr;
   AgentMetadataType agent_metadata_;
 
@@ -402,7 +437,17 @@ Status StirlingImpl::Init() {
     return error::NotFound("Source registry doesn't exist");
   }
 
+  for (std::string_view group : absl::StrSplit(FLAGS_stirling_source_threads, ';',
+                                               absl::SkipWhitespace())) {
+    ++num_source_threads_;
+    for (std::string_view name : absl::StrSplit(group, ',', absl::SkipWhitespace())) {
+      source_threads_[std::string(absl::StripAsciiWhitespace(name))] = num_source_threads_;
+    }
+  }
+
+  absl::flat_hash_set<std::string> registered_sources;
   for (const auto& [name, create_source_fn, _] : registry_->sources()) {
+    registered_sources.insert(name);
     auto source_ptr = create_source_fn(name);
 
     Status s = AddSource(std::move(source_ptr));
@@ -411,6 +456,11 @@ Status StirlingImpl::Init() {
     LOG_IF(WARNING, !s.ok()) << absl::Substitute(
         "Source Connector (registry name=$0) not instantiated, error: $1", name, s.ToString());
   }
+  for (const auto& [name, thread] : source_threads_) {
+    LOG_IF(WARNING, !registered_sources.contains(name)) << absl::Substitute(
+        "Source Connector (registry name=$0) is in --stirling_source_threads, but not registered.",
+        name);
+  }
   LOG(INFO) << "Stirling successfully initialized.";
   return Status::OK();
 }
@@ -439,7 +489,7 @@ Status StirlingImpl::AddSource(std::unique_ptr<SourceConnector> source) {
   // Step 1: Init the source.
   PL_RETURN_IF_ERROR(source->Init());
 
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
 
   std::vector<InfoClassManager*> mgrs;
   mgrs.reserve(source->table_schemas().size());
@@ -463,7 +513,7 @@ Status StirlingImpl::AddSource(std::unique_ptr<SourceConnector> source) {
 }
 
 Status StirlingImpl::RemoveSource(std::string_view source_name) {
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
 
   // Find the source.
   auto source_iter = std::find_if(sources_.begin(), sources_.end(),
@@ -584,7 +634,7 @@ void StirlingImpl::DeployDynamicTraceConnector(
 
   stirlingpb::Publish publication;
   {
-    absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+    absl::MutexLock lock(&info_class_mgrs_lock_);
     PopulatePublishProto(&publication, info_class_mgrs_, output_name);
   }
 
@@ -690,7 +740,7 @@ Status StirlingImpl::RemoveTracepoint(sole::uuid trace_id) {
 }
 
 void StirlingImpl::GetPublishProto(stirlingpb::Publish* publish_pb) {
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
   PopulatePublishProto(publish_pb, info_class_mgrs_);
 }
 
@@ -750,8 +800,7 @@ void StirlingImpl::Run() {
 namespace {
 
 // Helper function: Figure out when to wake up next.
-std::chrono::milliseconds TimeUntilNextTick(
-    const absl::flat_hash_map<SourceConnector*, SourceOutput> source_output_map) {
+std::chrono::milliseconds TimeUntilNextTick(const std::vector<SourceConnector*>& sources) {
   // The amount to sleep depends on when the earliest Source needs to be sampled again.
   // Do this to avoid burning CPU cycles unnecessarily
   auto now = px::chrono::coarse_steady_clock::now();
@@ -760,9 +809,12 @@ std::chrono::milliseconds TimeUntilNextTick(
   // This is important if there are no subscribed info classes, to avoid sleeping eternally.
   constexpr std::chrono::milliseconds kMaxSleepDuration{1000};
   auto wakeup_time = now + kMaxSleepDuration;
-  for (const auto& [source, output] : source_output_map) {
+  for (const SourceConnector* source : sources) {
     wakeup_time = std::min(wakeup_time, source->sampling_freq_mgr().next());
     wakeup_time = std::min(wakeup_time, source->push_freq_mgr().next());
+    if (source->polls_between_transfers()) {
+      wakeup_time = std::min(wakeup_time, source->poll_freq_mgr().next());
+    }
   }
 
   return std::chrono::duration_cast<std::chrono::milliseconds>(wakeup_time - now);
@@ -804,7 +856,7 @@ void StirlingImpl::RunCore() {
 
   // First initialize each info class manager with context.
   {
-    absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+    absl::MutexLock lock(&info_class_mgrs_lock_);
     std::unique_ptr<ConnectorContext> initial_context = GetContext();
     for (const auto& s : sources_) {
       s->InitContext(initial_context.get());
@@ -815,6 +867,37 @@ void StirlingImpl::RunCore() {
   // Indicates completion of initialization, and start of data collection.
   LOG(INFO) << "Stirling is running.";
 
+  std::vector<std::thread> source_threads;
+  for (int i = 1; i <= num_source_threads_; ++i) {
+    source_threads.emplace_back(&StirlingImpl::RunSourceLoop, this, i);
+  }
+  RunSourceLoop(kMainSourceThread);
+  for (auto& t : source_threads) {
+    t.join();
+  }
+
+  running_ = false;
+}
+
+int StirlingImpl::SourceThread(const SourceConnector& source) const {
+  auto iter = source_threads_.find(source.name());
+  return iter == source_threads_.end() ? kMainSourceThread : iter->second;
+}
+
+void StirlingImpl::RunSourceLoop(int source_thread) {
+  const DataPushCallback push_callback =
+      [this](uint32_t table_id, types::TabletID tablet_id,
+             std::unique_ptr<types::ColumnWrapperRecordBatch> record_batch) {
+        absl::MutexLock lock(&data_push_lock_);
+        return data_push_callback_(table_id, tablet_id, std::move(record_batch));
+      };
+
+  // The record batches are allocated on this thread, and usually kept by the table store, so the
+  // node of the thread is also where the table store's data ends up.
+  Status s = system::PinCurrentThreadToNUMANode(FLAGS_stirling_numa_node);
+  LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to pin Stirling source thread $0: $1",
+                                               source_thread, s.msg());
+
   while (run_enable_) {
     auto sleep_duration = std::chrono::milliseconds::zero();
 
@@ -826,29 +909,38 @@ void StirlingImpl::RunCore() {
     std::unique_ptr<ConnectorContext> ctx = GetContext();
 
     {
-      // Acquire spin lock to go through one iteration of sampling and pushing data.
+      // Acquire the lock to go through one iteration of sampling and pushing data.
       // Needed to avoid race with main thread update info_class_mgrs_ on new subscription.
-      absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+      // Other source threads only read the map too, so they are not blocked.
+      absl::ReaderMutexLock lock(&info_class_mgrs_lock_);
 
-      // Run through every SourceConnector and InfoClassManager being managed.
+      // Run through every SourceConnector and InfoClassManager being managed by this thread.
+      std::vector<SourceConnector*> thread_sources;
       for (auto& [source, output] : source_output_map_) {
+        if (SourceThread(*source) != source_thread) {
+          continue;
+        }
+        thread_sources.push_back(source);
+
         // Phase 1: Probe each source for its data.
         if (source->sampling_freq_mgr().Expired()) {
           source->TransferData(ctx.get(), output.data_tables);
+        } else if (source->polls_between_transfers() && source->poll_freq_mgr().Expired()) {
+          // Transfers read the input too, so polls are only needed between them.
+          source->Poll();
         }
         // Phase 2: Push Data upstream.
         if (source->push_freq_mgr().Expired() || DataExceedsThreshold(output.data_tables)) {
-          source->PushData(data_push_callback_, output.data_tables);
+          source->PushData(push_callback, output.data_tables);
         }
       }
 
       // Figure out how long to sleep.
-      sleep_duration = TimeUntilNextTick(source_output_map_);
+      sleep_duration = TimeUntilNextTick(thread_sources);
     }
 
     SleepForDuration(sleep_duration);
   }
-  running_ = false;
 }
 
 bool StirlingImpl::IsRunning() const { return running_; }
@@ -872,7 +964,7 @@ void StirlingImpl::Stop() {
 
   // Stop all sources.
   // This is important to release any BPF resources that were acquired.
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
   for (auto& source : sources_) {
     Status s = source->Stop();
 
@@ -884,21 +976,35 @@ void StirlingImpl::Stop() {
 
 void StirlingImpl::SetDebugLevel(int level) {
   // Lock not really required, but compiler is making sure we're safe.
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
   for (auto& s : sources_) {
     s->SetDebugLevel(level);
   }
 }
 
+void StirlingImpl::SetShedLoad(bool shed_load) {
+  absl::MutexLock lock(&info_class_mgrs_lock_);
+  for (auto& s : sources_) {
+    s->SetShedLoad(shed_load);
+  }
+}
+
+void StirlingImpl::SetTableActive(std::string_view table_name, bool active) {
+  absl::MutexLock lock(&info_class_mgrs_lock_);
+  for (auto& s : sources_) {
+    s->SetTableActive(table_name, active);
+  }
+}
+
 void StirlingImpl::EnablePIDTrace(int pid) {
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
   for (auto& s : sources_) {
     s->EnablePIDTrace(pid);
   }
 }
 
 void StirlingImpl::DisablePIDTrace(int pid) {
-  absl::base_internal::SpinLockHolder lock(&info_class_mgrs_lock_);
+  absl::MutexLock lock(&info_class_mgrs_lock_);
   for (auto& s : sources_) {
     s->DisablePIDTrace(pid);
   }
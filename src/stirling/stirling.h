@@ -34,6 +34,7 @@
 #include "src/stirling/utils/linux_headers.h"
 
 DECLARE_string(stirling_sources);
+DECLARE_string(stirling_source_threads);
 
 namespace px {
 namespace stirling {
@@ -125,6 +126,18 @@ class Stirling : public NotCopyable {
    */
   virtual Status RemoveTracepoint(sole::uuid trace_id) = 0;
 
+  /**
+   * Asks the sources to keep less data buffered while shed_load is set, at the cost of losing
+   * some of it. Used when the node is short on memory.
+   */
+  virtual void SetShedLoad(bool shed_load) = 0;
+
+  /**
+   * Tells the sources whether the given table is read by any query, so that the data of tables
+   * that are not read can stop being collected until they are again. Tables are active by default.
+   */
+  virtual void SetTableActive(std::string_view table_name, bool active) = 0;
+
   /**
    * Populate the Publish Proto object. Agent calls this function to get the Publish
    * proto message. The proto publish message contains information (InfoClassSchema) on
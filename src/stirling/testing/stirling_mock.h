@@ -40,6 +40,8 @@ class MockStirling : public Stirling {
               (override));
   MOCK_METHOD(StatusOr<stirlingpb::Publish>, GetTracepointInfo, (sole::uuid trace_id), (override));
   MOCK_METHOD(Status, RemoveTracepoint, (sole::uuid trace_id), (override));
+  MOCK_METHOD(void, SetShedLoad, (bool shed_load), (override));
+  MOCK_METHOD(void, SetTableActive, (std::string_view table_name, bool active), (override));
   MOCK_METHOD(void, GetPublishProto, (stirlingpb::Publish * publish_pb), (override));
   MOCK_METHOD(void, RegisterDataPushCallback, (DataPushCallback f), (override));
   MOCK_METHOD(void, RegisterAgentMetadataCallback, (AgentMetadataCallback f), (override));
@@ -30,6 +30,7 @@
 #include <vector>
 
 #include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_replace.h>
 
 #include "src/common/base/file.h"
@@ -39,6 +40,12 @@
 #include "src/common/system/config.h"
 #include "src/common/zlib/zlib_wrapper.h"
 
+DEFINE_string(stirling_linux_headers_cache_dir,
+              gflags::StringFromEnv("PL_LINUX_HEADERS_CACHE_DIR", ""),
+              "Directory in which packaged Linux headers are kept once they are patched for the "
+              "host kernel, so that later starts on the same kernel skip installing them again. "
+              "Not used if empty.");
+
 namespace px {
 namespace stirling {
 namespace utils {
@@ -571,6 +578,62 @@ StatusOr<PackagedLinuxHeadersSpec> FindClosestPackagedLinuxHeaders(
   return selected;
 }
 
+std::string PackagedLinuxHeadersCacheKey(KernelVersion headers_version,
+                                         KernelVersion kernel_version,
+                                         std::string_view kernel_config) {
+  // FNV-1a, since the key must be the same in every process that computes it.
+  uint64_t config_hash = 14695981039346656037ULL;
+  for (char c : kernel_config) {
+    config_hash = (config_hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+  }
+  return absl::Substitute("linux-headers-$0.$1.$2-pl-$3-$4", headers_version.version,
+                          headers_version.major_rev, headers_version.minor_rev,
+                          kernel_version.code(), absl::Hex(config_hash, absl::kZeroPad16));
+}
+
+Status CacheLinuxHeaders(const std::filesystem::path& headers,
+                         const std::filesystem::path& cached_headers) {
+  std::filesystem::path tmp_path = cached_headers;
+  tmp_path += ".tmp";
+
+  // Left behind by an earlier copy that did not complete.
+  if (fs::Exists(tmp_path)) {
+    PL_RETURN_IF_ERROR(fs::RemoveAll(tmp_path));
+  }
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(cached_headers.parent_path()));
+  PL_RETURN_IF_ERROR(fs::Copy(headers, tmp_path,
+                              std::filesystem::copy_options::recursive |
+                                  std::filesystem::copy_options::copy_symlinks));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, cached_headers, ec);
+  if (ec) {
+    return error::Internal("Could not move $0 to $1: $2", tmp_path.string(),
+                           cached_headers.string(), ec.message());
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Returns where the packaged headers, once patched for this kernel, are cached,
+// or an empty path if they cannot be.
+std::filesystem::path CachedPackagedHeadersPath(const PackagedLinuxHeadersSpec& packaged_headers,
+                                                KernelVersion kernel_version) {
+  if (FLAGS_stirling_linux_headers_cache_dir.empty()) {
+    return {};
+  }
+  // Without a kernel config, the headers cannot be patched anyways.
+  PL_ASSIGN_OR(std::filesystem::path kernel_config, FindKernelConfig(), return {});
+  PL_ASSIGN_OR(std::string kernel_config_contents, ReadFileToString(kernel_config.string()),
+               return {});
+  return std::filesystem::path(FLAGS_stirling_linux_headers_cache_dir) /
+         PackagedLinuxHeadersCacheKey(packaged_headers.version, kernel_version,
+                                      kernel_config_contents);
+}
+
+}  // namespace
+
 Status InstallPackagedLinuxHeaders(const std::filesystem::path& lib_modules_dir) {
   // This is the directory in our container images that contains packaged linux headers.
   const std::filesystem::path kPackagedHeadersRoot = "/pl";
@@ -584,9 +647,26 @@ Status InstallPackagedLinuxHeaders(const std::filesystem::path& lib_modules_dir)
   PL_ASSIGN_OR_RETURN(PackagedLinuxHeadersSpec packaged_headers,
                       FindClosestPackagedLinuxHeaders(kPackagedHeadersRoot, kernel_version));
   LOG(INFO) << absl::Substitute("Using packaged header: $0", packaged_headers.path.string());
+
+  const std::filesystem::path cached_headers =
+      CachedPackagedHeadersPath(packaged_headers, kernel_version);
+  if (!cached_headers.empty() && fs::Exists(cached_headers)) {
+    PL_RETURN_IF_ERROR(fs::CreateSymlinkIfNotExists(cached_headers, lib_modules_build_dir));
+    LOG(INFO) << absl::Substitute("Installed cached copy of headers from $0 at $1",
+                                  cached_headers.string(), lib_modules_build_dir.string());
+    g_packaged_headers_installed = true;
+    return Status::OK();
+  }
+
   PL_RETURN_IF_ERROR(ExtractPackagedHeaders(&packaged_headers));
   PL_RETURN_IF_ERROR(ModifyKernelVersion(packaged_headers.path, kernel_version.code()));
   PL_RETURN_IF_ERROR(ApplyConfigPatches(packaged_headers.path));
+
+  if (!cached_headers.empty()) {
+    Status s = CacheLinuxHeaders(packaged_headers.path, cached_headers);
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to cache linux headers at $0: $1",
+                                                 cached_headers.string(), s.ToString());
+  }
   PL_RETURN_IF_ERROR(fs::CreateSymlinkIfNotExists(packaged_headers.path, lib_modules_build_dir));
   LOG(INFO) << absl::Substitute("Successfully installed packaged copy of headers at $0",
                                 lib_modules_build_dir.string());
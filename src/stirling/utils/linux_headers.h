@@ -26,6 +26,8 @@
 
 #include "src/common/base/base.h"
 
+DECLARE_string(stirling_linux_headers_cache_dir);
+
 namespace px {
 namespace stirling {
 namespace utils {
@@ -168,6 +170,22 @@ struct PackagedLinuxHeadersSpec {
 StatusOr<PackagedLinuxHeadersSpec> FindClosestPackagedLinuxHeaders(
     const std::filesystem::path& packaged_headers_root, KernelVersion kernel_version);
 
+/**
+ * Returns the name under which packaged headers, once patched for a kernel, are kept in
+ * --stirling_linux_headers_cache_dir. It covers everything that the patched headers depend on:
+ * the packaged headers, and the version and config of the kernel.
+ */
+std::string PackagedLinuxHeadersCacheKey(KernelVersion headers_version,
+                                         KernelVersion kernel_version,
+                                         std::string_view kernel_config);
+
+/**
+ * Copies installed headers into the cache, at cached_headers. The copy only appears at
+ * cached_headers once it is complete, so a partial copy is never used.
+ */
+Status CacheLinuxHeaders(const std::filesystem::path& headers,
+                         const std::filesystem::path& cached_headers);
+
 Status InstallPackagedLinuxHeaders(const std::filesystem::path& lib_modules_dir);
 
 // After headers are installed, this variable is set to true.
@@ -18,6 +18,7 @@
 
 #include <fstream>
 
+#include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/config.h"
 #include "src/common/testing/testing.h"
 #include "src/stirling/utils/linux_headers.h"
@@ -264,6 +265,40 @@ TEST(LinuxHeadersUtils, FindClosestPackagedLinuxHeaders) {
   }
 }
 
+TEST(LinuxHeadersUtils, PackagedLinuxHeadersCacheKey) {
+  const std::string key = PackagedLinuxHeadersCacheKey(KernelVersion{5, 3, 18},
+                                                       KernelVersion{5, 4, 0}, "CONFIG_HZ=250");
+  EXPECT_EQ(key, PackagedLinuxHeadersCacheKey(KernelVersion{5, 3, 18}, KernelVersion{5, 4, 0},
+                                              "CONFIG_HZ=250"));
+  EXPECT_THAT(key, ::testing::StartsWith("linux-headers-5.3.18-pl-"));
+
+  EXPECT_NE(key, PackagedLinuxHeadersCacheKey(KernelVersion{5, 3, 18}, KernelVersion{5, 4, 0},
+                                              "CONFIG_HZ=1000"));
+  EXPECT_NE(key, PackagedLinuxHeadersCacheKey(KernelVersion{5, 3, 18}, KernelVersion{5, 4, 1},
+                                              "CONFIG_HZ=250"));
+  EXPECT_NE(key, PackagedLinuxHeadersCacheKey(KernelVersion{4, 18, 20}, KernelVersion{5, 4, 0},
+                                              "CONFIG_HZ=250"));
+}
+
+TEST(LinuxHeadersUtils, CacheLinuxHeaders) {
+  TempDir tmp_dir;
+  const std::filesystem::path headers = tmp_dir.path() / "usr/src/linux-headers-5.3.18-pl";
+  const std::filesystem::path cached_headers = tmp_dir.path() / "cache/linux-headers-5.3.18-pl-x";
+
+  ASSERT_OK(fs::CreateDirectories(headers / "include/generated"));
+  ASSERT_OK(WriteFileFromString(headers / "include/generated/autoconf.h", "#define CONFIG_HZ 250"));
+  ASSERT_OK(fs::CreateSymlink("include", headers / "include_link"));
+
+  ASSERT_OK(CacheLinuxHeaders(headers, cached_headers));
+  EXPECT_OK_AND_EQ(ReadFileToString(cached_headers / "include/generated/autoconf.h"),
+                   "#define CONFIG_HZ 250");
+  EXPECT_TRUE(std::filesystem::is_symlink(cached_headers / "include_link"));
+
+  std::filesystem::path tmp_path = cached_headers;
+  tmp_path += ".tmp";
+  EXPECT_FALSE(fs::Exists(tmp_path));
+}
+
 }  // namespace utils
 }  // namespace stirling
 }  // namespace px
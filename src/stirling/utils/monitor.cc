@@ -17,6 +17,12 @@
  */
 
 #include "src/stirling/utils/monitor.h"
+
+#include <map>
+#include <string>
+
+#include <prometheus/registry.h>
+
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
 
@@ -28,8 +34,71 @@ namespace stirling {
 
 namespace {
 constexpr char kJavaProcCrashedDuringAttach[] = "java_proc_crashed_during_attach";
+
+// From 10us to 10s, which covers everything from a single connection's parsing, to a slow
+// TransferDataImpl() of a large deployment.
+const prometheus::Histogram::BucketBoundaries kDurationBuckets = {
+    1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 3e-3, 1e-2, 3e-2, 0.1, 0.3, 1, 3, 10};
+}  // namespace
+
+//-----------------------------------------------------------------------------
+// HotPathStat
+//-----------------------------------------------------------------------------
+
+HotPathStat::HotPathStat(Type type, std::string_view source_connector, std::string_view stat)
+    : source_connector_(source_connector), stat_(stat) {
+  const std::map<std::string, std::string> labels = {{"source", source_connector_},
+                                                     {"stat", stat_}};
+  switch (type) {
+    case Type::kDurationNS:
+      histogram_ = &prometheus::BuildHistogram()
+                        .Name("stirling_hot_path_seconds")
+                        .Help("Duration of hot paths in Stirling, such as a source connector's "
+                              "data transfer.")
+                        .Register(GetMetricsRegistry())
+                        .Add(labels, kDurationBuckets);
+      break;
+    case Type::kCount:
+      counter_ = &prometheus::BuildCounter()
+                      .Name("stirling_hot_path_total")
+                      .Help("Counts of hot path work in Stirling, such as the records pushed by a "
+                            "source connector.")
+                      .Register(GetMetricsRegistry())
+                      .Add(labels);
+      break;
+  }
+}
+
+void HotPathStat::Record(uint64_t value) {
+  if (histogram_ != nullptr) {
+    histogram_->Observe(static_cast<double>(value) / 1e9);
+  } else {
+    counter_->Increment(static_cast<double>(value));
+  }
+
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  // On failure, max is updated to the current value, so this stops once value is not larger.
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HotPathStatRecord HotPathStat::Consume() {
+  HotPathStatRecord record;
+  record.timestamp_ns = CurrentTimeNS();
+  record.source_connector = source_connector_;
+  record.stat = stat_;
+  record.count = count_.exchange(0, std::memory_order_relaxed);
+  record.sum = sum_.exchange(0, std::memory_order_relaxed);
+  record.max = max_.exchange(0, std::memory_order_relaxed);
+  return record;
 }
 
+//-----------------------------------------------------------------------------
+// StirlingMonitor
+//-----------------------------------------------------------------------------
+
 StirlingMonitor::StirlingMonitor()
     : java_proc_crashed_during_attach_(
           BuildCounter(kJavaProcCrashedDuringAttach,
@@ -84,5 +153,29 @@ std::vector<ProbeStatusRecord> StirlingMonitor::ConsumeProbeStatusRecords() {
   return std::move(probe_status_records_);
 }
 
+HotPathStat* StirlingMonitor::GetHotPathStat(HotPathStat::Type type,
+                                             std::string_view source_connector,
+                                             std::string_view stat) {
+  absl::base_internal::SpinLockHolder lock(&hot_path_stats_lock_);
+  auto& hot_path_stat =
+      hot_path_stats_[std::make_pair(std::string(source_connector), std::string(stat))];
+  if (hot_path_stat == nullptr) {
+    hot_path_stat = std::make_unique<HotPathStat>(type, source_connector, stat);
+  }
+  return hot_path_stat.get();
+}
+
+std::vector<HotPathStatRecord> StirlingMonitor::ConsumeHotPathStatRecords() {
+  absl::base_internal::SpinLockHolder lock(&hot_path_stats_lock_);
+  std::vector<HotPathStatRecord> records;
+  for (auto& [_, hot_path_stat] : hot_path_stats_) {
+    HotPathStatRecord record = hot_path_stat->Consume();
+    if (record.count > 0) {
+      records.push_back(std::move(record));
+    }
+  }
+  return records;
+}
+
 }  // namespace stirling
 }  // namespace px
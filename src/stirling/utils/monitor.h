@@ -19,9 +19,15 @@
 #pragma once
 
 #include <prometheus/counter.h>
+#include <prometheus/histogram.h>
 
 #include <absl/container/flat_hash_map.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -51,6 +57,57 @@ struct ProbeStatusRecord {
   std::string info = "";
 };
 
+// Aggregate of a hot path statistic over a window, for the stirling_stats table.
+struct HotPathStatRecord {
+  int64_t timestamp_ns = 0;
+  std::string source_connector;
+  std::string stat;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+};
+
+/**
+ * A statistic of one of Stirling's hot paths, such as the duration of a source connector's
+ * TransferDataImpl(), or the records it pushed to a table. Every value is exported to prometheus,
+ * as a histogram for durations and a counter otherwise. Values are also aggregated until the next
+ * call to Consume(), which is how they reach the stirling_stats table.
+ *
+ * Record() is thread-safe, and does not take any locks.
+ */
+class HotPathStat : NotCopyMoveable {
+ public:
+  enum class Type {
+    // Values are durations in nanoseconds.
+    kDurationNS,
+    // Values are counts, such as the records pushed in one call.
+    kCount,
+  };
+
+  HotPathStat(Type type, std::string_view source_connector, std::string_view stat);
+
+  void Record(uint64_t value);
+  void RecordDuration(std::chrono::nanoseconds duration) {
+    Record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+  }
+
+  // Returns the aggregate since the last call, and starts a new one.
+  // Values recorded concurrently may be split across the two.
+  HotPathStatRecord Consume();
+
+ private:
+  const std::string source_connector_;
+  const std::string stat_;
+
+  // Exactly one of these is set, depending on the type.
+  prometheus::Histogram* histogram_ = nullptr;
+  prometheus::Counter* counter_ = nullptr;
+
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
 class StirlingMonitor : NotCopyMoveable {
  public:
   static StirlingMonitor* GetInstance() {
@@ -71,6 +128,14 @@ class StirlingMonitor : NotCopyMoveable {
   std::vector<ProbeStatusRecord> ConsumeProbeStatusRecords();
   std::vector<SourceStatusRecord> ConsumeSourceStatusRecords();
 
+  // Hot path instrumentation.
+  // Returns the stat with the given name for the source connector, creating it on first use.
+  // The stat lives as long as the process, so callers look it up once and keep the pointer.
+  HotPathStat* GetHotPathStat(HotPathStat::Type type, std::string_view source_connector,
+                              std::string_view stat);
+  // Returns the aggregates of all stats that were recorded since the last call.
+  std::vector<HotPathStatRecord> ConsumeHotPathStatRecords();
+
   static constexpr auto kCrashWindow = std::chrono::seconds{5};
 
  private:
@@ -83,9 +148,14 @@ class StirlingMonitor : NotCopyMoveable {
   // Records of Stirling Source Connector status.
   std::vector<SourceStatusRecord> source_status_records_ ABSL_GUARDED_BY(source_status_lock_);
 
+  // Hot path stats, keyed by source connector and stat name.
+  absl::flat_hash_map<std::pair<std::string, std::string>, std::unique_ptr<HotPathStat>>
+      hot_path_stats_ ABSL_GUARDED_BY(hot_path_stats_lock_);
+
   // Lock to protect probe and source records.
   absl::base_internal::SpinLock probe_status_lock_;
   absl::base_internal::SpinLock source_status_lock_;
+  absl::base_internal::SpinLock hot_path_stats_lock_;
 
   prometheus::Counter& java_proc_crashed_during_attach_;
 };
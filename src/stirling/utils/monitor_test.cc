@@ -18,6 +18,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 #include "src/stirling/testing/common.h"
 #include "src/stirling/utils/monitor.h"
@@ -66,5 +69,51 @@ TEST(MonitorTest, DoesNotDisableJavaIfNotInCrashInWindow) {
   EXPECT_TRUE(FLAGS_stirling_profiler_java_symbols);
 }
 
+TEST(MonitorTest, HotPathStats) {
+  StirlingMonitor& monitor = *StirlingMonitor::GetInstance();
+
+  HotPathStat* duration_stat =
+      monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, "test_source", "transfer_data_ns");
+  HotPathStat* count_stat =
+      monitor.GetHotPathStat(HotPathStat::Type::kCount, "test_source", "records_pushed.test");
+  HotPathStat* idle_stat =
+      monitor.GetHotPathStat(HotPathStat::Type::kCount, "test_source", "records_pushed.idle");
+  EXPECT_EQ(
+      monitor.GetHotPathStat(HotPathStat::Type::kDurationNS, "test_source", "transfer_data_ns"),
+      duration_stat);
+  PL_UNUSED(idle_stat);
+
+  // Start from a clean window.
+  monitor.ConsumeHotPathStatRecords();
+
+  duration_stat->RecordDuration(std::chrono::microseconds{3});
+  duration_stat->RecordDuration(std::chrono::microseconds{7});
+  count_stat->Record(5);
+
+  std::vector<HotPathStatRecord> records = monitor.ConsumeHotPathStatRecords();
+  ASSERT_EQ(records.size(), 2U);
+  std::sort(records.begin(), records.end(),
+            [](const auto& a, const auto& b) { return a.stat < b.stat; });
+
+  EXPECT_EQ(records[0].source_connector, "test_source");
+  EXPECT_EQ(records[0].stat, "records_pushed.test");
+  EXPECT_EQ(records[0].count, 1U);
+  EXPECT_EQ(records[0].sum, 5U);
+  EXPECT_EQ(records[0].max, 5U);
+
+  EXPECT_EQ(records[1].stat, "transfer_data_ns");
+  EXPECT_EQ(records[1].count, 2U);
+  EXPECT_EQ(records[1].sum, 10000U);
+  EXPECT_EQ(records[1].max, 7000U);
+
+  // Each window only covers the values recorded since the previous one.
+  EXPECT_THAT(monitor.ConsumeHotPathStatRecords(), ::testing::IsEmpty());
+  count_stat->Record(2);
+  records = monitor.ConsumeHotPathStatRecords();
+  ASSERT_EQ(records.size(), 1U);
+  EXPECT_EQ(records[0].sum, 2U);
+  EXPECT_EQ(records[0].max, 2U);
+}
+
 }  // namespace stirling
 }  // namespace px
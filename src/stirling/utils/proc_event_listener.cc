@@ -0,0 +1,142 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/proc_event_listener.h"
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace px {
+namespace stirling {
+
+StatusOr<std::unique_ptr<ProcEventListener>> ProcEventListener::Create() {
+  auto listener = std::unique_ptr<ProcEventListener>(new ProcEventListener);
+  PL_RETURN_IF_ERROR(listener->Connect());
+  return listener;
+}
+
+ProcEventListener::~ProcEventListener() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+Status ProcEventListener::Connect() {
+  fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+  if (fd_ < 0) {
+    return error::Internal("Could not create NETLINK_CONNECTOR socket. [errno=$0]", errno);
+  }
+
+  struct sockaddr_nl nl_addr = {};
+  nl_addr.nl_family = AF_NETLINK;
+  nl_addr.nl_groups = CN_IDX_PROC;
+  // Leave nl_pid as 0, so that the kernel assigns a unique port to each listener.
+  if (bind(fd_, reinterpret_cast<struct sockaddr*>(&nl_addr), sizeof(nl_addr)) < 0) {
+    return error::Internal("Could not bind to the proc connector. [errno=$0]", errno);
+  }
+
+  constexpr enum proc_cn_mcast_op kOp = PROC_CN_MCAST_LISTEN;
+  alignas(struct nlmsghdr) char req[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(kOp))] = {};
+  auto* hdr = reinterpret_cast<struct nlmsghdr*>(req);
+  hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(kOp));
+  hdr->nlmsg_type = NLMSG_DONE;
+  auto* msg = reinterpret_cast<struct cn_msg*>(NLMSG_DATA(hdr));
+  msg->id.idx = CN_IDX_PROC;
+  msg->id.val = CN_VAL_PROC;
+  msg->len = sizeof(kOp);
+  std::memcpy(msg->data, &kOp, sizeof(kOp));
+  if (send(fd_, req, hdr->nlmsg_len, 0) < 0) {
+    return error::Internal("Could not subscribe to proc events. [errno=$0]", errno);
+  }
+  return Status::OK();
+}
+
+ProcEventListener::Events ProcEventListener::ReadEvents() {
+  Events result;
+
+  alignas(struct nlmsghdr) char buf[8192];
+  while (true) {
+    ssize_t len = recv(fd_, buf, sizeof(buf), 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        // ENOBUFS means the socket buffer overflowed, and events were dropped.
+        LOG_IF(WARNING, errno != ENOBUFS)
+            << absl::Substitute("Failed to read proc events. [errno=$0]", errno);
+        result.lost = true;
+        if (errno == ENOBUFS) {
+          continue;
+        }
+      }
+      break;
+    }
+
+    for (auto* hdr = reinterpret_cast<struct nlmsghdr*>(buf); NLMSG_OK(hdr, len);
+         hdr = NLMSG_NEXT(hdr, len)) {
+      if (hdr->nlmsg_type != NLMSG_DONE) {
+        continue;
+      }
+      const auto* msg = reinterpret_cast<const struct cn_msg*>(NLMSG_DATA(hdr));
+      if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) {
+        continue;
+      }
+      const auto* ev = reinterpret_cast<const struct proc_event*>(msg->data);
+
+      switch (ev->what) {
+        case proc_event::PROC_EVENT_FORK: {
+          const auto& fork = ev->event_data.fork;
+          if (fork.child_pid != fork.child_tgid) {
+            // A new thread.
+            break;
+          }
+          auto start_time_ticks = proc_parser_.GetPIDStartTimeTicks(fork.child_tgid);
+          if (!start_time_ticks.ok()) {
+            // The process already exited.
+            break;
+          }
+          result.events.push_back({ProcEvent::Type::kStart, static_cast<uint32_t>(fork.child_tgid),
+                                   static_cast<uint64_t>(start_time_ticks.ValueOrDie())});
+          break;
+        }
+        case proc_event::PROC_EVENT_EXIT: {
+          const auto& exit = ev->event_data.exit;
+          if (exit.process_pid != exit.process_tgid) {
+            break;
+          }
+          result.events.push_back(
+              {ProcEvent::Type::kExit, static_cast<uint32_t>(exit.process_tgid)});
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace stirling
+}  // namespace px
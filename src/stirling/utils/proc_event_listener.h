@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace stirling {
+
+struct ProcEvent {
+  enum class Type {
+    // A new process was forked. Threads are not reported.
+    kStart,
+    // A process exited.
+    kExit,
+  };
+
+  Type type;
+  uint32_t pid;
+  // Only set for kStart, as read from /proc when the event was received.
+  uint64_t start_time_ticks = 0;
+};
+
+/**
+ * Listens for process events from the kernel's netlink proc connector, so that the set of
+ * processes can be maintained without rescanning /proc. Requires CAP_NET_ADMIN, and only sees
+ * processes of the initial network namespace's kernel, ie. all of them.
+ */
+class ProcEventListener : NotCopyMoveable {
+ public:
+  static StatusOr<std::unique_ptr<ProcEventListener>> Create();
+
+  ~ProcEventListener();
+
+  struct Events {
+    std::vector<ProcEvent> events;
+    // True if events were dropped, eg. because the socket buffer overflowed. The caller should
+    // then fall back to a full rescan.
+    bool lost = false;
+  };
+
+  /**
+   * Returns the events received since the last call, without blocking.
+   */
+  Events ReadEvents();
+
+ private:
+  ProcEventListener() = default;
+
+  Status Connect();
+
+  int fd_ = -1;
+  const system::ProcParser proc_parser_{system::Config::GetInstance()};
+};
+
+}  // namespace stirling
+}  // namespace px
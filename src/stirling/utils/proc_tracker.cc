@@ -22,21 +22,129 @@
 
 #include "src/common/system/proc_parser.h"
 
+DEFINE_bool(stirling_proc_tracker_events,
+            gflags::BoolFromEnv("PL_STIRLING_PROC_TRACKER_EVENTS", true),
+            "If true, process trackers follow the kernel's proc connector events to find new and "
+            "exited processes, instead of diffing all processes on every update.");
+DEFINE_int32(stirling_proc_tracker_reconcile_period, 60,
+             "When following proc events, the number of updates between full diffs of all "
+             "processes, which catch anything the events missed.");
+
 namespace px {
 namespace stirling {
 
-void ProcTracker::Update(absl::flat_hash_set<md::UPID> upids) {
+void ProcTracker::EnableProcEvents() {
+  if (!FLAGS_stirling_proc_tracker_events || proc_event_listener_ != nullptr) {
+    return;
+  }
+  auto listener_or = ProcEventListener::Create();
+  if (!listener_or.ok()) {
+    LOG(WARNING) << absl::Substitute(
+        "Could not listen for proc events, processes will be tracked by rescanning. Message = $0",
+        listener_or.msg());
+    return;
+  }
+  proc_event_listener_ = listener_or.ConsumeValueOrDie();
+  // Start with a full diff, since events only report changes.
+  updates_until_reconcile_ = 0;
+}
+
+void ProcTracker::Update(const md::UPIDSet& upids) {
+  if (proc_event_listener_ == nullptr) {
+    DiffUpdate(upids);
+    return;
+  }
+
+  ProcEventListener::Events events = proc_event_listener_->ReadEvents();
+  if (events.lost || updates_until_reconcile_ <= 0) {
+    DiffUpdate(upids);
+    // Events that the upids don't reflect yet still need to be applied later.
+    ApplyEvents(upids, events.events);
+    updates_until_reconcile_ = FLAGS_stirling_proc_tracker_reconcile_period;
+    return;
+  }
+  --updates_until_reconcile_;
+  UpdateFromEvents(upids, events.events);
+}
+
+void ProcTracker::DiffUpdate(const md::UPIDSet& upids) {
   new_upids_.clear();
+  deleted_upids_.clear();
   for (const auto& upid : upids) {
-    auto iter = upids_.find(upid);
-    if (iter != upids_.end()) {
-      upids_.erase(iter);
+    if (!upids_.contains(upid)) {
+      new_upids_.insert(upid);
+    }
+  }
+  for (const auto& upid : upids_) {
+    if (!upids.contains(upid)) {
+      deleted_upids_.insert(upid);
+    }
+  }
+  upids_ = upids;
+
+  for (const auto& upid : deleted_upids_) {
+    upids_by_pid_.erase(upid.pid());
+  }
+  for (const auto& upid : new_upids_) {
+    upids_by_pid_[upid.pid()] = upid;
+  }
+}
+
+void ProcTracker::UpdateFromEvents(const md::UPIDSet& upids,
+                                   const std::vector<ProcEvent>& events) {
+  new_upids_.clear();
+  deleted_upids_.clear();
+  ApplyEvents(upids, events);
+}
+
+void ProcTracker::ApplyEvents(const md::UPIDSet& upids,
+                              const std::vector<ProcEvent>& events) {
+  for (const auto& event : events) {
+    switch (event.type) {
+      case ProcEvent::Type::kStart:
+        pending_starts_[event.pid] = event.start_time_ticks;
+        break;
+      case ProcEvent::Type::kExit:
+        // A process that exits before it was ever reflected by upids is never reported.
+        pending_starts_.erase(event.pid);
+        pending_exits_.insert(event.pid);
+        break;
+    }
+  }
+
+  for (auto iter = pending_exits_.begin(); iter != pending_exits_.end();) {
+    auto upid_iter = upids_by_pid_.find(*iter);
+    if (upid_iter == upids_by_pid_.end()) {
+      pending_exits_.erase(iter++);
       continue;
     }
-    new_upids_.emplace(upid);
+    if (upids.contains(upid_iter->second)) {
+      ++iter;
+      continue;
+    }
+    upids_.erase(upid_iter->second);
+    deleted_upids_.insert(upid_iter->second);
+    upids_by_pid_.erase(upid_iter);
+    pending_exits_.erase(iter++);
+  }
+
+  // All UPIDs share the same ASID.
+  if (upids.empty()) {
+    return;
+  }
+  const uint32_t asid = upids.begin()->asid();
+  for (auto iter = pending_starts_.begin(); iter != pending_starts_.end();) {
+    md::UPID upid(asid, iter->first, iter->second);
+    if (!upids.contains(upid)) {
+      ++iter;
+      continue;
+    }
+    if (upids_.insert(upid).second) {
+      new_upids_.insert(upid);
+      upids_by_pid_[upid.pid()] = upid;
+    }
+    pending_starts_.erase(iter++);
   }
-  deleted_upids_ = std::move(upids_);
-  upids_ = std::move(upids);
 }
 
 }  // namespace stirling
@@ -18,13 +18,19 @@
 
 #pragma once
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "src/common/system/proc_parser.h"
 #include "src/shared/upid/upid.h"
 #include "src/stirling/bpf_tools/bcc_bpf_intf/upid.h"
+#include "src/stirling/utils/proc_event_listener.h"
+
+DECLARE_bool(stirling_proc_tracker_events);
 
 namespace px {
 namespace stirling {
@@ -32,14 +38,34 @@ namespace stirling {
 /**
  * Keeps a list of UPIDs. Tracks newly-created and terminated processes each time an update is
  * provided, and updates its internal list of UPIDs.
+ *
+ * By default, each update diffs the full set of UPIDs against the previous one. Once proc events
+ * are enabled, updates instead follow the fork and exit events reported by the kernel, so their
+ * cost follows process churn rather than the number of processes. A full diff is still done
+ * periodically, and whenever events were lost, to reconcile.
  */
 class ProcTracker : NotCopyMoveable {
  public:
+  /**
+   * Switches to following proc events, if --stirling_proc_tracker_events is set.
+   * If the proc connector can't be used (eg. for lack of CAP_NET_ADMIN), updates keep diffing.
+   */
+  void EnableProcEvents();
+
   /**
    * Takes the current set of upids, and updates the internal state.
    * @param upids Current set of UPIDs.
    */
-  void Update(absl::flat_hash_set<md::UPID> upids);
+  void Update(const md::UPIDSet& upids);
+
+  /**
+   * Updates the internal state from the given process events, rather than diffing all of upids.
+   * Only the UPIDs named by the events are looked up in `upids`, so that new and deleted UPIDs
+   * agree with it; events it does not reflect yet are retried on later updates.
+   * Used by Update() once proc events are enabled. Public for testing.
+   */
+  void UpdateFromEvents(const md::UPIDSet& upids,
+                        const std::vector<ProcEvent>& events);
 
   /**
    * Returns all current upids, as set by last call to Update().
@@ -57,9 +83,24 @@ class ProcTracker : NotCopyMoveable {
   const auto& deleted_upids() const { return deleted_upids_; }
 
  private:
-  absl::flat_hash_set<md::UPID> upids_;
-  absl::flat_hash_set<md::UPID> new_upids_;
-  absl::flat_hash_set<md::UPID> deleted_upids_;
+  void DiffUpdate(const md::UPIDSet& upids);
+  void ApplyEvents(const md::UPIDSet& upids,
+                   const std::vector<ProcEvent>& events);
+
+  md::UPIDSet upids_;
+  md::UPIDSet new_upids_;
+  md::UPIDSet deleted_upids_;
+
+  // The UPIDs of upids_, by PID, to resolve exit events.
+  absl::flat_hash_map<uint32_t, md::UPID> upids_by_pid_;
+
+  // The members below are only used once proc events are enabled.
+  std::unique_ptr<ProcEventListener> proc_event_listener_;
+  int updates_until_reconcile_ = 0;
+  // Processes that started (with their start time), or exited, but that are not yet reflected
+  // by the upids passed to Update().
+  absl::flat_hash_map<uint32_t, uint64_t> pending_starts_;
+  absl::flat_hash_set<uint32_t> pending_exits_;
 };
 
 /**
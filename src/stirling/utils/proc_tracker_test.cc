@@ -33,7 +33,7 @@ class ProcTrackerTest : public ::testing::Test {
 };
 
 TEST_F(ProcTrackerTest, Basic) {
-  using UPIDSet = absl::flat_hash_set<md::UPID>;
+  using UPIDSet = md::UPIDSet;
 
   const md::UPID kUPID1 = md::UPID(0, 1, 111);
   const md::UPID kUPID2 = md::UPID(0, 2, 222);
@@ -61,5 +61,48 @@ TEST_F(ProcTrackerTest, Basic) {
   EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID3));
 }
 
+TEST_F(ProcTrackerTest, UpdateFromEvents) {
+  using UPIDSet = md::UPIDSet;
+
+  const md::UPID kUPID1 = md::UPID(0, 1, 111);
+  const md::UPID kUPID2 = md::UPID(0, 2, 222);
+  const md::UPID kUPID3 = md::UPID(0, 3, 333);
+  const md::UPID kUPID4 = md::UPID(0, 4, 444);
+
+  proc_tracker_.Update(UPIDSet{kUPID1, kUPID2});
+
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID1, kUPID2, kUPID3},
+                                 {{ProcEvent::Type::kStart, 3, 333}});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID2, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID3));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+
+  // The upids don't reflect the start of kUPID4 or the exit of kUPID2 yet, so both wait.
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID1, kUPID2, kUPID3},
+                                 {{ProcEvent::Type::kStart, 4, 444}, {ProcEvent::Type::kExit, 2}});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID2, kUPID3));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID1, kUPID3, kUPID4}, {});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3, kUPID4));
+  EXPECT_THAT(proc_tracker_.new_upids(), UnorderedElementsAre(kUPID4));
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID2));
+
+  // A process that exits before the upids reflect it is never reported.
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID1, kUPID3, kUPID4},
+                                 {{ProcEvent::Type::kStart, 5, 555},
+                                  {ProcEvent::Type::kExit, 5},
+                                  {ProcEvent::Type::kExit, 1}});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID1, kUPID3, kUPID4));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), IsEmpty());
+
+  proc_tracker_.UpdateFromEvents(UPIDSet{kUPID3, kUPID4}, {});
+  EXPECT_THAT(proc_tracker_.upids(), UnorderedElementsAre(kUPID3, kUPID4));
+  EXPECT_THAT(proc_tracker_.new_upids(), IsEmpty());
+  EXPECT_THAT(proc_tracker_.deleted_upids(), UnorderedElementsAre(kUPID1));
+}
+
 }  // namespace stirling
 }  // namespace px
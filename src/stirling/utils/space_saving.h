@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+/**
+ * SpaceSavingSketch tracks the heaviest keys of a weighted stream with a fixed amount of memory,
+ * using the Space-Saving algorithm (Metwally et al., "Efficient Computation of Frequent and Top-k
+ * Elements in Data Streams").
+ *
+ * At most `capacity` keys are tracked. When a new key arrives and the sketch is full, it replaces
+ * the key with the smallest count, and inherits that count as its error bound. Any key whose true
+ * weight exceeds total()/capacity is guaranteed to be tracked, and the reported count of a key
+ * never underestimates its true weight by more than its error.
+ */
+template <typename TKey>
+class SpaceSavingSketch {
+ public:
+  struct Entry {
+    TKey key;
+    // Upper bound of the weight of the key.
+    uint64_t count;
+    // Maximum overestimation in count.
+    uint64_t error;
+  };
+
+  explicit SpaceSavingSketch(size_t capacity) : capacity_(capacity) { entries_.reserve(capacity); }
+
+  void Add(const TKey& key, uint64_t weight = 1) {
+    total_ += weight;
+
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      entries_[iter->second].count += weight;
+      return;
+    }
+
+    if (entries_.size() < capacity_) {
+      index_[key] = entries_.size();
+      entries_.push_back({key, weight, 0});
+      return;
+    }
+
+    // Linear scan for the minimum. Capacities are expected to be small, and this only happens
+    // for keys that are not yet tracked.
+    auto min_iter = std::min_element(entries_.begin(), entries_.end(),
+                                     [](const Entry& a, const Entry& b) { return a.count < b.count; });
+    index_.erase(min_iter->key);
+    index_[key] = min_iter - entries_.begin();
+    *min_iter = {key, min_iter->count + weight, min_iter->count};
+  }
+
+  /**
+   * Returns up to n tracked entries, ordered by decreasing count.
+   */
+  std::vector<Entry> TopK(size_t n) const {
+    std::vector<Entry> top = entries_;
+    n = std::min(n, top.size());
+    std::partial_sort(top.begin(), top.begin() + n, top.end(),
+                      [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    top.resize(n);
+    return top;
+  }
+
+  /**
+   * The total weight added since the last Reset().
+   */
+  uint64_t total() const { return total_; }
+
+  size_t size() const { return entries_.size(); }
+
+  void Reset() {
+    entries_.clear();
+    index_.clear();
+    total_ = 0;
+  }
+
+ private:
+  const size_t capacity_;
+  std::vector<Entry> entries_;
+  // Index of each tracked key in entries_.
+  absl::flat_hash_map<TKey, size_t> index_;
+  uint64_t total_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+#include "src/stirling/utils/space_saving.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+
+using Sketch = SpaceSavingSketch<std::string>;
+
+TEST(SpaceSavingSketchTest, ExactBelowCapacity) {
+  Sketch sketch(4);
+  sketch.Add("a", 10);
+  sketch.Add("b", 30);
+  sketch.Add("a", 5);
+  sketch.Add("c");
+
+  EXPECT_EQ(sketch.total(), 46);
+  EXPECT_THAT(sketch.TopK(2), ElementsAre(Field(&Sketch::Entry::key, "b"),
+                                          Field(&Sketch::Entry::key, "a")));
+  EXPECT_EQ(sketch.TopK(1)[0].count, 30);
+  EXPECT_EQ(sketch.TopK(1)[0].error, 0);
+  EXPECT_EQ(sketch.TopK(10).size(), 3);
+}
+
+TEST(SpaceSavingSketchTest, ReplacesMinimum) {
+  Sketch sketch(2);
+  sketch.Add("a", 10);
+  sketch.Add("b", 3);
+  sketch.Add("c", 1);
+
+  std::vector<Sketch::Entry> top = sketch.TopK(2);
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].key, "a");
+  // "c" replaced "b", and inherited its count as the error bound.
+  EXPECT_EQ(top[1].key, "c");
+  EXPECT_EQ(top[1].count, 4);
+  EXPECT_EQ(top[1].error, 3);
+}
+
+TEST(SpaceSavingSketchTest, FindsHeavyHitterAmongManyKeys) {
+  Sketch sketch(8);
+  for (int i = 0; i < 1000; ++i) {
+    sketch.Add("heavy", 5);
+    sketch.Add(std::to_string(i), 1);
+  }
+
+  std::vector<Sketch::Entry> top = sketch.TopK(1);
+  ASSERT_EQ(top.size(), 1);
+  EXPECT_EQ(top[0].key, "heavy");
+  EXPECT_GE(top[0].count, 5000);
+  EXPECT_LE(top[0].count - top[0].error, 5000);
+}
+
+TEST(SpaceSavingSketchTest, Reset) {
+  Sketch sketch(2);
+  sketch.Add("a", 10);
+  sketch.Reset();
+
+  EXPECT_EQ(sketch.total(), 0);
+  EXPECT_EQ(sketch.size(), 0);
+  EXPECT_THAT(sketch.TopK(2), IsEmpty());
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/str_format.h>
@@ -159,6 +160,9 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
 }
 
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
+  if (has_selection()) {
+    return error::InvalidArgument("Row batches with a selection must be compacted to serialize.");
+  }
   proto->set_num_rows(num_rows_);
   proto->set_eow(eow_);
   proto->set_eos(eos_);
@@ -176,6 +180,118 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
   return Status::OK();
 }
 
+namespace {
+
+struct StringHolder {
+  std::string str;
+};
+
+// An arrow::Buffer over a string that it owns. The string is a base, so that it is constructed
+// before the arrow::Buffer that points to it.
+class StringBuffer : private StringHolder, public arrow::Buffer {
+ public:
+  explicit StringBuffer(std::string str)
+      : StringHolder{std::move(str)},
+        arrow::Buffer(reinterpret_cast<const uint8_t*>(StringHolder::str.data()),
+                      StringHolder::str.size()) {}
+};
+
+void CopyIntoArrowPB(DataType dt, const arrow::Array& arr,
+                     table_store::schemapb::ArrowColumn* output_column) {
+  output_column->set_data_type(dt);
+  const int64_t n = arr.length();
+  switch (arr.type_id()) {
+    case arrow::Type::STRING: {
+      const auto& strings = static_cast<const arrow::StringArray&>(arr);
+      const int32_t values_start = strings.value_offset(0);
+      auto offsets = output_column->mutable_offsets();
+      offsets->resize((n + 1) * sizeof(int32_t));
+      auto offsets_data = reinterpret_cast<int32_t*>(offsets->data());
+      for (int64_t i = 0; i <= n; ++i) {
+        offsets_data[i] = strings.value_offset(i) - values_start;
+      }
+      if (offsets_data[n] > 0) {
+        output_column->set_values(strings.value_data()->data() + values_start, offsets_data[n]);
+      }
+      return;
+    }
+    case arrow::Type::BOOL: {
+      // Rebuilt, since a sliced array's bits don't have to start at a byte boundary.
+      const auto& bools = static_cast<const arrow::BooleanArray&>(arr);
+      auto bitmap = output_column->mutable_values();
+      bitmap->assign((n + 7) / 8, '\0');
+      for (int64_t i = 0; i < n; ++i) {
+        (*bitmap)[i / 8] |= static_cast<char>(static_cast<uint8_t>(bools.Value(i)) << (i % 8));
+      }
+      return;
+    }
+    default: {
+      const auto& type = static_cast<const arrow::FixedWidthType&>(*arr.type());
+      const int byte_width = type.bit_width() / 8;
+      const auto& data = *arr.data();
+      output_column->set_values(data.buffers[1]->data() + data.offset * byte_width,
+                                n * byte_width);
+      return;
+    }
+  }
+}
+
+// Makes a column out of the buffers of an ArrowColumn.
+StatusOr<std::shared_ptr<arrow::Array>> ArrowPBToArray(DataType dt, int64_t num_rows,
+                                                       std::string values, std::string offsets) {
+  auto arrow_type = types::MakeArrowBuilder(dt, arrow::default_memory_pool())->type();
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers = {nullptr};
+  switch (arrow_type->id()) {
+    case arrow::Type::STRING: {
+      if (offsets.size() != (num_rows + 1) * sizeof(int32_t)) {
+        return error::InvalidArgument("Expected $0 string offsets, got $1 bytes", num_rows + 1,
+                                      offsets.size());
+      }
+      auto offsets_data = reinterpret_cast<const int32_t*>(offsets.data());
+      if (offsets_data[0] != 0 || static_cast<size_t>(offsets_data[num_rows]) != values.size()) {
+        return error::InvalidArgument("String offsets don't span the $0 bytes of values",
+                                      values.size());
+      }
+      buffers.push_back(std::make_shared<StringBuffer>(std::move(offsets)));
+      break;
+    }
+    case arrow::Type::BOOL:
+      if (values.size() != static_cast<size_t>((num_rows + 7) / 8)) {
+        return error::InvalidArgument("Expected a bitmap of $0 rows, got $1 bytes", num_rows,
+                                      values.size());
+      }
+      break;
+    default: {
+      const auto& type = static_cast<const arrow::FixedWidthType&>(*arrow_type);
+      if (values.size() != static_cast<size_t>(num_rows * type.bit_width() / 8)) {
+        return error::InvalidArgument("Expected $0 values of $1 bits, got $2 bytes", num_rows,
+                                      type.bit_width(), values.size());
+      }
+      break;
+    }
+  }
+  buffers.push_back(std::make_shared<StringBuffer>(std::move(values)));
+  auto data = arrow::ArrayData::Make(arrow_type, num_rows, std::move(buffers), /*null_count*/ 0);
+  return arrow::MakeArray(data);
+}
+
+}  // namespace
+
+Status RowBatch::ToArrowProto(table_store::schemapb::RowBatchData* proto) const {
+  if (has_selection()) {
+    return error::InvalidArgument("Row batches with a selection must be compacted to serialize.");
+  }
+  proto->set_num_rows(num_rows_);
+  proto->set_eow(eow_);
+  proto->set_eos(eos_);
+
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    CopyIntoArrowPB(desc_.type(col_idx), *ColumnAt(col_idx),
+                    proto->add_cols()->mutable_arrow_data());
+  }
+  return Status::OK();
+}
+
 // PL_CARNOT_UPDATE_FOR_NEW_TYPES
 StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
   switch (proto.col_data_case()) {
@@ -191,20 +307,52 @@ StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
       return DataType::FLOAT64;
     case table_store::schemapb::Column::kStringData:
       return DataType::STRING;
+    case table_store::schemapb::Column::kArrowData:
+      switch (proto.arrow_data().data_type()) {
+        case DataType::BOOLEAN:
+        case DataType::INT64:
+        case DataType::UINT128:
+        case DataType::TIME64NS:
+        case DataType::FLOAT64:
+        case DataType::STRING:
+          return proto.arrow_data().data_type();
+        default:
+          return error::Internal("Received unknown arrow column data type '$0' in ProtoDataType",
+                                 magic_enum::enum_name(proto.arrow_data().data_type()));
+      }
     default:
       return error::Internal("Received unknown column data type '$0' in ProtoDataType",
                              magic_enum::enum_name(proto.col_data_case()));
   }
 }
 
-StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
-    const table_store::schemapb::RowBatchData& proto) {
+namespace {
+
+// Deserializes the proto. The buffers of ArrowColumns are moved out of mutable_proto if it is
+// set, and copied otherwise.
+StatusOr<std::unique_ptr<RowBatch>> FromProtoImpl(
+    const table_store::schemapb::RowBatchData& proto,
+    table_store::schemapb::RowBatchData* mutable_proto) {
   std::vector<DataType> types(proto.cols_size());
   std::vector<std::shared_ptr<arrow::Array>> data_columns(proto.cols_size());
 
   for (auto i = 0; i < proto.cols_size(); ++i) {
     PL_ASSIGN_OR_RETURN(types[i], ProtoDataType(proto.cols(i)));
-    std::shared_ptr<arrow::Array> output_array;
+    if (proto.cols(i).has_arrow_data()) {
+      std::string values;
+      std::string offsets;
+      if (mutable_proto != nullptr) {
+        auto arrow_data = mutable_proto->mutable_cols(i)->mutable_arrow_data();
+        values = std::move(*arrow_data->mutable_values());
+        offsets = std::move(*arrow_data->mutable_offsets());
+      } else {
+        values = proto.cols(i).arrow_data().values();
+        offsets = proto.cols(i).arrow_data().offsets();
+      }
+      PL_ASSIGN_OR_RETURN(data_columns[i], ArrowPBToArray(types[i], proto.num_rows(),
+                                                          std::move(values), std::move(offsets)));
+      continue;
+    }
 
 #define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(CopyFromInputPB<_dt_>(&data_columns[i], proto.cols(i)));
     PL_SWITCH_FOREACH_DATATYPE(types[i], TYPE_CASE);
@@ -223,6 +371,18 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
   return output_rb;
 }
 
+}  // namespace
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
+    const table_store::schemapb::RowBatchData& proto) {
+  return FromProtoImpl(proto, nullptr);
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProtoAdoptingBuffers(
+    table_store::schemapb::RowBatchData* proto) {
+  return FromProtoImpl(*proto, proto);
+}
+
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromColumnBuilders(
     const RowDescriptor& desc, bool eow, bool eos,
     std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders) {
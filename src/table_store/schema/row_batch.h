@@ -53,6 +53,18 @@ class RowBatch {
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
+  /**
+   * Serializes the columns as ArrowColumns, copying their buffers rather than converting each
+   * value. Only receivers that accept arrow row batches can read these.
+   */
+  Status ToArrowProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
+  /**
+   * Like FromProto, but moves the buffers of ArrowColumns out of the proto and adopts them as the
+   * columns, instead of copying them.
+   */
+  static StatusOr<std::unique_ptr<RowBatch>> FromProtoAdoptingBuffers(
+      table_store::schemapb::RowBatchData* row_batch_proto);
+
   static StatusOr<std::unique_ptr<RowBatch>> FromColumnBuilders(
       const RowDescriptor& desc, bool eow, bool eos,
       std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders);
@@ -110,6 +122,24 @@ class RowBatch {
 
   bool eos() const { return eos_; }
   void set_eos(bool val) { eos_ = val; }
+
+  /**
+   * A selection restricts the rows of the batch to the given increasing row indices, so that a
+   * filter can pass on the arrays it read without copying them. num_rows() remains the length of
+   * the arrays.
+   */
+  bool has_selection() const { return selection_ != nullptr; }
+  const std::shared_ptr<const std::vector<int64_t>>& selection() const { return selection_; }
+  void set_selection(std::shared_ptr<const std::vector<int64_t>> selection) {
+    selection_ = std::move(selection);
+  }
+
+  /**
+   * @ return the number of rows in the selection if there is one, or else num_rows().
+   */
+  int64_t num_selected_rows() const {
+    return has_selection() ? static_cast<int64_t>(selection_->size()) : num_rows_;
+  }
   /**
    * @ return the row descriptor which describes the schema of the row batch.
    */
@@ -126,6 +156,7 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+  std::shared_ptr<const std::vector<int64_t>> selection_;
 };
 
 // Append a scalar value to an arrow::Array.
@@ -179,6 +179,39 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+TEST_F(RowBatchTest, to_from_arrow_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  auto input_rb = RowBatch::FromProto(input_proto).ConsumeValueOrDie();
+
+  // Slices start their buffers at an offset, which the arrow proto drops.
+  std::vector<std::unique_ptr<RowBatch>> rbs;
+  rbs.push_back(input_rb->Slice(1, 2).ConsumeValueOrDie());
+  rbs.push_back(rb_->Slice(1, 2).ConsumeValueOrDie());
+  for (const auto& rb : rbs) {
+    table_store::schemapb::RowBatchData arrow_proto;
+    EXPECT_OK(rb->ToArrowProto(&arrow_proto));
+    ASSERT_EQ(rb->num_columns(), arrow_proto.cols_size());
+    EXPECT_TRUE(arrow_proto.cols(0).has_arrow_data());
+
+    auto copied_rb = RowBatch::FromProto(arrow_proto).ConsumeValueOrDie();
+    auto adopted_rb = RowBatch::FromProtoAdoptingBuffers(&arrow_proto).ConsumeValueOrDie();
+    EXPECT_EQ(rb->desc(), adopted_rb->desc());
+    EXPECT_EQ(rb->DebugString(), copied_rb->DebugString());
+    EXPECT_EQ(rb->DebugString(), adopted_rb->DebugString());
+    EXPECT_TRUE(arrow_proto.cols(0).arrow_data().values().empty());
+  }
+}
+
+TEST_F(RowBatchTest, from_arrow_proto_bad_size) {
+  table_store::schemapb::RowBatchData proto;
+  proto.set_num_rows(2);
+  auto col = proto.add_cols()->mutable_arrow_data();
+  col->set_data_type(types::DataType::INT64);
+  col->set_values(std::string(sizeof(int64_t), '\0'));
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
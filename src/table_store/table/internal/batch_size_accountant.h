@@ -132,8 +132,10 @@ class BatchSizeAccountant {
    * and cold stores.
    * @return Number of rows to remove from the front of the hot store, since those rows were moved
    * into the cold store via CompactedBatchSpec.
+   * @param cold_bytes_saved how many fewer bytes the cold batch takes than the spec's bytes, eg.
+   * because some of its columns were dictionary encoded.
    */
-  uint64_t FinishCompactedBatch();
+  uint64_t FinishCompactedBatch(uint64_t cold_bytes_saved = 0);
   /**
    * @return the number of bytes stored in the hot store.
    */
@@ -0,0 +1,364 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/column_codec.h"
+
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+#include "src/table_store/table/internal/row_selection.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// Packing to more bits than this saves too little to be worth unpacking on reads.
+constexpr int kMaxBitWidth = 48;
+
+// Shorter columns are only dictionary encoded. Packing or deflating them saves a few bytes at best,
+// while costing a decode on every read.
+constexpr int64_t kMinPackedRows = 64;
+
+int BitWidth(uint64_t max_value) {
+  return max_value == 0 ? 0 : 64 - __builtin_clzll(max_value);
+}
+
+uint64_t ZigZag(uint64_t delta) {
+  auto signed_delta = static_cast<int64_t>(delta);
+  return (delta << 1) ^ static_cast<uint64_t>(signed_delta >> 63);
+}
+
+uint64_t UnZigZag(uint64_t value) { return (value >> 1) ^ (~(value & 1) + 1); }
+
+void Pack(int bit_width, int64_t idx, uint64_t value, std::vector<uint64_t>* packed) {
+  uint64_t bit = static_cast<uint64_t>(idx) * bit_width;
+  size_t word = bit / 64;
+  int shift = bit % 64;
+  (*packed)[word] |= value << shift;
+  if (shift + bit_width > 64) {
+    (*packed)[word + 1] |= value >> (64 - shift);
+  }
+}
+
+uint64_t Unpack(const std::vector<uint64_t>& packed, int bit_width, int64_t idx) {
+  if (bit_width == 0) {
+    return 0;
+  }
+  uint64_t bit = static_cast<uint64_t>(idx) * bit_width;
+  size_t word = bit / 64;
+  int shift = bit % 64;
+  uint64_t value = packed[word] >> shift;
+  if (shift + bit_width > 64) {
+    value |= packed[word + 1] << (64 - shift);
+  }
+  return bit_width == 64 ? value : value & ((uint64_t{1} << bit_width) - 1);
+}
+
+template <types::DataType T>
+std::vector<int64_t> GetIntValues(const arrow::Array* arr) {
+  std::vector<int64_t> values(arr->length());
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    values[i] = types::GetValueFromArrowArray<T>(arr, i);
+  }
+  return values;
+}
+
+template <types::DataType T>
+StatusOr<ArrowArrayPtr> MakeIntArray(const std::vector<int64_t>& values,
+                                     arrow::MemoryPool* mem_pool) {
+  auto builder = types::GetArrowBuilder<T>(mem_pool);
+  auto* typed_builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder.get());
+  PL_RETURN_IF_ERROR(typed_builder->AppendValues(values.data(), values.size()));
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(typed_builder->Finish(&arr));
+  return arr;
+}
+
+// The bytes of an array by the same measure as BatchSizeAccountant: the native type size per row,
+// and for strings an int32 offset per row plus the values.
+uint64_t PlainBytes(const arrow::Array& arr) {
+  if (arr.type_id() == arrow::Type::STRING) {
+    const auto& strings = static_cast<const arrow::StringArray&>(arr);
+    return arr.length() * sizeof(int32_t) + strings.value_offset(arr.length()) -
+           strings.value_offset(0);
+  }
+  if (arr.type_id() == arrow::Type::BOOL) {
+    return arr.length() * sizeof(bool);
+  }
+  if (arr.type_id() == arrow::Type::DICTIONARY) {
+    // Only cold columns that were encoded are dictionary arrays, and they know their plain size.
+    return 0;
+  }
+  const auto& type = static_cast<const arrow::FixedWidthType&>(*arr.type());
+  return arr.length() * (type.bit_width() / 8);
+}
+
+}  // namespace
+
+ColdColumn::ColdColumn(ArrowArrayPtr array)
+    : length_(array->length()),
+      plain_bytes_(PlainBytes(*array)),
+      encoded_bytes_(plain_bytes_),
+      array_(std::move(array)) {}
+
+StatusOr<ColdColumn> ColdColumn::Encode(ArrowArrayPtr array, types::DataType type,
+                                        types::PatternType pattern,
+                                        arrow::MemoryPool* mem_pool) {
+  if (array->length() == 0 || array->null_count() != 0) {
+    return ColdColumn(std::move(array));
+  }
+  if (IsZoneMapped(type)) {
+    if (array->length() < kMinPackedRows) {
+      return ColdColumn(std::move(array));
+    }
+    return BitPack(array, type);
+  }
+  if (type != types::DataType::STRING) {
+    return ColdColumn(std::move(array));
+  }
+
+  if (pattern == types::PatternType::GENERAL_ENUM) {
+    PL_ASSIGN_OR_RETURN(auto encoded, DictionaryEncode(array, mem_pool));
+    if (encoded.bytes_saved > 0) {
+      ColdColumn col(array);
+      col.codec_ = ColumnCodec::kDictionary;
+      col.encoded_bytes_ = col.plain_bytes_ - encoded.bytes_saved;
+      col.array_ = std::move(encoded.array);
+      return col;
+    }
+  }
+  if (array->length() < kMinPackedRows) {
+    return ColdColumn(std::move(array));
+  }
+  return Deflate(array);
+}
+
+StatusOr<ColdColumn> ColdColumn::BitPack(const ArrowArrayPtr& array, types::DataType type) {
+  std::vector<int64_t> values = type == types::DataType::TIME64NS
+                                    ? GetIntValues<types::DataType::TIME64NS>(array.get())
+                                    : GetIntValues<types::DataType::INT64>(array.get());
+  const int64_t n = values.size();
+
+  auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+  const int64_t min = *min_it;
+  const int64_t max = *max_it;
+
+  // Differences are taken as unsigned, so that they wrap instead of overflowing, and wrap back
+  // when decoded.
+  auto zigzag_delta = [&values](int64_t i) {
+    return ZigZag(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(values[i - 1]));
+  };
+  int for_width = BitWidth(static_cast<uint64_t>(max) - static_cast<uint64_t>(min));
+  uint64_t max_zigzag = 0;
+  for (int64_t i = 1; i < n; ++i) {
+    max_zigzag = std::max(max_zigzag, zigzag_delta(i));
+  }
+  int delta_width = BitWidth(max_zigzag);
+
+  // Sorted or slowly changing values, like timestamps and counters, pack smaller as deltas.
+  const bool use_delta = delta_width < for_width;
+  const int bit_width = use_delta ? delta_width : for_width;
+  if (bit_width > kMaxBitWidth) {
+    return ColdColumn(array);
+  }
+
+  ColdColumn col(array);
+  col.codec_ = use_delta ? ColumnCodec::kDeltaBitPacked : ColumnCodec::kBitPacked;
+  col.type_ = type;
+  col.base_ = use_delta ? values[0] : min;
+  col.bit_width_ = bit_width;
+  col.interval_ = {min, max};
+  col.packed_.resize((static_cast<uint64_t>(n) * bit_width + 63) / 64);
+  for (int64_t i = 0; i < n; ++i) {
+    uint64_t value = use_delta ? (i == 0 ? 0 : zigzag_delta(i))
+                               : static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(min);
+    if (bit_width > 0) {
+      Pack(bit_width, i, value, &col.packed_);
+    }
+  }
+  col.encoded_bytes_ = col.packed_.size() * sizeof(uint64_t);
+  col.array_ = nullptr;
+  return col;
+}
+
+StatusOr<ColdColumn> ColdColumn::Deflate(const ArrowArrayPtr& array) {
+  const auto& strings = static_cast<const arrow::StringArray&>(*array);
+  const int32_t values_start = strings.value_offset(0);
+  const int32_t values_end = strings.value_offset(strings.length());
+  auto view = strings.GetView(0);
+  std::string_view values(view.data(), values_end - values_start);
+
+  PL_ASSIGN_OR_RETURN(std::string deflated, zlib::Deflate(values));
+  // Inflating decodes the whole batch, for reads of any slice of it, so it has to pay off.
+  if (2 * deflated.size() > values.size()) {
+    return ColdColumn(array);
+  }
+
+  ColdColumn col(array);
+  col.codec_ = ColumnCodec::kDeflate;
+  col.offsets_.resize(strings.length() + 1);
+  for (int64_t i = 0; i <= strings.length(); ++i) {
+    col.offsets_[i] = strings.value_offset(i) - values_start;
+  }
+  col.encoded_bytes_ = strings.length() * sizeof(int32_t) + deflated.size();
+  col.deflated_values_ = std::move(deflated);
+  col.array_ = nullptr;
+  return col;
+}
+
+ValueInterval ColdColumn::GetValueInterval(types::DataType type) const {
+  if (codec_ == ColumnCodec::kBitPacked || codec_ == ColumnCodec::kDeltaBitPacked) {
+    return interval_;
+  }
+  DCHECK(codec_ == ColumnCodec::kPlain);
+  return ArrowArrayValueInterval(array_.get(), type);
+}
+
+Status ColdColumn::AddBloomFilter(const arrow::Array* plain_array, double error_rate) {
+  DCHECK_EQ(plain_array->length(), length_);
+  const auto& strings = static_cast<const arrow::StringArray&>(*plain_array);
+  PL_ASSIGN_OR_RETURN(std::shared_ptr<bloomfilter::XXHash64BloomFilter> filter,
+                      bloomfilter::XXHash64BloomFilter::Create(std::max<int64_t>(length_, 1),
+                                                               error_rate));
+  // Nulls never equal a value, so they're left out.
+  for (int64_t i = 0; i < strings.length(); ++i) {
+    if (!strings.IsNull(i)) {
+      auto view = strings.GetView(i);
+      filter->Insert(std::string_view(view.data(), view.size()));
+    }
+  }
+  encoded_bytes_ += filter->buffer_size_bytes();
+  bloom_filter_ = std::move(filter);
+  return Status::OK();
+}
+
+StatusOr<ArrowArrayPtr> ColdColumn::DecodeSlice(int64_t offset, int64_t length,
+                                                arrow::MemoryPool* mem_pool) const {
+  DCHECK_LE(offset + length, length_);
+  switch (codec_) {
+    case ColumnCodec::kPlain:
+      return array_->Slice(offset, length);
+    case ColumnCodec::kDictionary:
+      return DictionaryDecode(array_->Slice(offset, length), mem_pool);
+    case ColumnCodec::kBitPacked:
+    case ColumnCodec::kDeltaBitPacked:
+      return DecodeBitPackedSlice(offset, length, mem_pool);
+    case ColumnCodec::kDeflate:
+      return DecodeDeflatedSlice(offset, length, mem_pool);
+  }
+  return error::Internal("Unknown column codec $0.", static_cast<int>(codec_));
+}
+
+StatusOr<ArrowArrayPtr> ColdColumn::DecodeRows(const std::vector<int64_t>& rows,
+                                               types::DataType type,
+                                               arrow::MemoryPool* mem_pool) const {
+  if (rows.empty()) {
+    return DecodeSlice(0, 0, mem_pool);
+  }
+  DCHECK(std::is_sorted(rows.begin(), rows.end()));
+  DCHECK_LT(rows.back(), length_);
+  if (codec_ == ColumnCodec::kPlain) {
+    return GatherRows(array_.get(), type, 0, rows, mem_pool);
+  }
+  if (codec_ == ColumnCodec::kDeflate) {
+    // The values are inflated as a whole either way, but only the rows' are copied out.
+    PL_ASSIGN_OR_RETURN(
+        std::string values,
+        zlib::Inflate(deflated_values_, /* output_block_size */ offsets_.back() + 1));
+    int64_t data_bytes = 0;
+    for (int64_t row : rows) {
+      data_bytes += offsets_[row + 1] - offsets_[row];
+    }
+    arrow::StringBuilder builder(mem_pool);
+    PL_RETURN_IF_ERROR(builder.Reserve(rows.size()));
+    PL_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+    for (int64_t row : rows) {
+      PL_RETURN_IF_ERROR(
+          builder.Append(values.data() + offsets_[row], offsets_[row + 1] - offsets_[row]));
+    }
+    std::shared_ptr<arrow::Array> decoded;
+    PL_RETURN_IF_ERROR(builder.Finish(&decoded));
+    return decoded;
+  }
+  // The other codecs decode the span of the rows, which they are picked from.
+  PL_ASSIGN_OR_RETURN(auto span,
+                      DecodeSlice(rows.front(), rows.back() - rows.front() + 1, mem_pool));
+  return GatherRows(span.get(), type, -rows.front(), rows, mem_pool);
+}
+
+StatusOr<ArrowArrayPtr> ColdColumn::DecodeBitPackedSlice(int64_t offset, int64_t length,
+                                                         arrow::MemoryPool* mem_pool) const {
+  std::vector<int64_t> values(length);
+  if (codec_ == ColumnCodec::kBitPacked) {
+    for (int64_t i = 0; i < length; ++i) {
+      values[i] = static_cast<int64_t>(static_cast<uint64_t>(base_) +
+                                       Unpack(packed_, bit_width_, offset + i));
+    }
+  } else {
+    // Deltas have to be summed from the start of the batch.
+    uint64_t value = static_cast<uint64_t>(base_);
+    for (int64_t i = 1; i <= offset; ++i) {
+      value += UnZigZag(Unpack(packed_, bit_width_, i));
+    }
+    for (int64_t i = 0; i < length; ++i) {
+      if (i > 0) {
+        value += UnZigZag(Unpack(packed_, bit_width_, offset + i));
+      }
+      values[i] = static_cast<int64_t>(value);
+    }
+  }
+
+  if (type_ == types::DataType::TIME64NS) {
+    return MakeIntArray<types::DataType::TIME64NS>(values, mem_pool);
+  }
+  return MakeIntArray<types::DataType::INT64>(values, mem_pool);
+}
+
+StatusOr<ArrowArrayPtr> ColdColumn::DecodeDeflatedSlice(int64_t offset, int64_t length,
+                                                        arrow::MemoryPool* mem_pool) const {
+  PL_ASSIGN_OR_RETURN(std::string values,
+                      zlib::Inflate(deflated_values_, /* output_block_size */ offsets_.back() + 1));
+  DCHECK_EQ(values.size(), static_cast<size_t>(offsets_.back()));
+
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  PL_RETURN_IF_ERROR(builder.ReserveData(offsets_[offset + length] - offsets_[offset]));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    PL_RETURN_IF_ERROR(builder.Append(values.data() + offsets_[i], offsets_[i + 1] - offsets_[i]));
+  }
+
+  std::shared_ptr<arrow::Array> decoded;
+  PL_RETURN_IF_ERROR(builder.Finish(&decoded));
+  return decoded;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
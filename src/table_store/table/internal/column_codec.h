@@ -0,0 +1,168 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+enum class ColumnCodec {
+  // A plain arrow array.
+  kPlain,
+  // An arrow::DictionaryArray of strings, see DictionaryEncode().
+  kDictionary,
+  // Integers as bit packed offsets from the minimum value (frame of reference).
+  kBitPacked,
+  // Integers as bit packed zigzag deltas from the previous value.
+  kDeltaBitPacked,
+  // Strings with their values deflated, and the offsets kept as is.
+  kDeflate,
+};
+
+/**
+ * ColdColumn is a column of a cold batch, which is compressed with a codec chosen by its type
+ * when the batch is compacted:
+ *  - INT64 and TIME64NS columns are bit packed, either as offsets from the minimum or as deltas,
+ *    which ever packs smaller. Timestamps, counters and ids mostly need a fraction of 64 bits.
+ *  - Low cardinality (GENERAL_ENUM) STRING columns are dictionary encoded.
+ *  - Other STRING columns have their values deflated.
+ * A codec is only used if it saves enough bytes to be worth the decoding cost on reads, otherwise
+ * the column stays plain. Reads decode the slice they need with DecodeSlice(), so readers only
+ * ever see plain arrow arrays.
+ */
+class ColdColumn {
+ public:
+  // Plain arrays convert implicitly, so that a vector of arrays makes an (uncompressed) ColdBatch.
+  ColdColumn(ArrowArrayPtr array);  // NOLINT(runtime/explicit)
+
+  /**
+   * Encode compresses the given array, which must not have nulls.
+   * @param array the column to compress.
+   * @param type the type of the column.
+   * @param pattern the pattern type of the column, which picks the codec of STRING columns.
+   * @param mem_pool the pool to allocate arrow arrays from.
+   */
+  static StatusOr<ColdColumn> Encode(ArrowArrayPtr array, types::DataType type,
+                                     types::PatternType pattern, arrow::MemoryPool* mem_pool);
+
+  ColumnCodec codec() const { return codec_; }
+  int64_t length() const { return length_; }
+
+  /**
+   * The bytes the column takes uncompressed and compressed, by the same measure as
+   * BatchSizeAccountant.
+   */
+  uint64_t plain_bytes() const { return plain_bytes_; }
+  uint64_t encoded_bytes() const { return encoded_bytes_; }
+
+  /**
+   * array returns the arrow array of a kPlain column.
+   */
+  const ArrowArrayPtr& array() const {
+    DCHECK(codec_ == ColumnCodec::kPlain);
+    return array_;
+  }
+
+  /**
+   * GetValueInterval returns the minimum and maximum value of an INT64 or TIME64NS column,
+   * without decoding it.
+   */
+  ValueInterval GetValueInterval(types::DataType type) const;
+
+  /**
+   * AddBloomFilter builds a bloom filter of the values of a STRING column, so that MayContain()
+   * can rule values out without decoding it. The filter's bytes are counted as encoded bytes.
+   * @param plain_array the column's values, as passed to Encode().
+   * @param error_rate the false positive rate of the filter.
+   */
+  Status AddBloomFilter(const arrow::Array* plain_array, double error_rate);
+
+  /**
+   * MayContain returns false if the column's bloom filter shows that no row has the given value.
+   * Columns without a bloom filter may contain any value.
+   */
+  bool MayContain(std::string_view value) const {
+    return bloom_filter_ == nullptr || bloom_filter_->Contains(value);
+  }
+
+  /**
+   * DecodeSlice returns a plain arrow array of `length` rows starting at `offset`.
+   */
+  StatusOr<ArrowArrayPtr> DecodeSlice(int64_t offset, int64_t length,
+                                      arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * DecodeRows returns a plain arrow array of the given rows, which must be in increasing order.
+   * Only the values of these rows are copied, so reading a few rows of a wide STRING column doesn't
+   * build an array of all of them.
+   */
+  StatusOr<ArrowArrayPtr> DecodeRows(const std::vector<int64_t>& rows, types::DataType type,
+                                     arrow::MemoryPool* mem_pool) const;
+
+ private:
+  ColdColumn() = default;
+
+  static StatusOr<ColdColumn> BitPack(const ArrowArrayPtr& array, types::DataType type);
+  static StatusOr<ColdColumn> Deflate(const ArrowArrayPtr& array);
+
+  StatusOr<ArrowArrayPtr> DecodeBitPackedSlice(int64_t offset, int64_t length,
+                                               arrow::MemoryPool* mem_pool) const;
+  StatusOr<ArrowArrayPtr> DecodeDeflatedSlice(int64_t offset, int64_t length,
+                                              arrow::MemoryPool* mem_pool) const;
+
+  ColumnCodec codec_ = ColumnCodec::kPlain;
+  int64_t length_ = 0;
+  uint64_t plain_bytes_ = 0;
+  uint64_t encoded_bytes_ = 0;
+
+  // kPlain and kDictionary columns.
+  ArrowArrayPtr array_;
+
+  // kBitPacked and kDeltaBitPacked columns.
+  types::DataType type_ = types::DataType::DATA_TYPE_UNKNOWN;
+  std::vector<uint64_t> packed_;
+  int64_t base_ = 0;
+  int bit_width_ = 0;
+  ValueInterval interval_ = {0, 0};
+
+  // kDeflate columns. The offsets have length_ + 1 entries, and start at 0.
+  std::vector<int32_t> offsets_;
+  std::string deflated_values_;
+
+  // Shared, since batches are copied when read from and spilled.
+  std::shared_ptr<const bloomfilter::XXHash64BloomFilter> bloom_filter_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/array.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/column_codec.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class ColdColumnTest : public ::testing::Test {
+ protected:
+  StatusOr<ColdColumn> Encode(const ArrowArrayPtr& arr, types::DataType type,
+                              types::PatternType pattern = types::UNSPECIFIED) {
+    return ColdColumn::Encode(arr, type, pattern, arrow::default_memory_pool());
+  }
+
+  void ExpectDecodesTo(const ColdColumn& col, const ArrowArrayPtr& arr) {
+    ASSERT_OK_AND_ASSIGN(auto decoded, col.DecodeSlice(0, arr->length(), pool_));
+    EXPECT_TRUE(decoded->Equals(arr));
+    ASSERT_OK_AND_ASSIGN(auto decoded_slice, col.DecodeSlice(50, 20, pool_));
+    EXPECT_TRUE(decoded_slice->Equals(arr->Slice(50, 20)));
+
+    std::vector<int64_t> rows = {3, 50, 51, 99};
+    ASSERT_OK_AND_ASSIGN(auto decoded_rows,
+                         col.DecodeRows(rows, types::ArrowToDataType(arr->type_id()), pool_));
+    ASSERT_EQ(decoded_rows->length(), rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      EXPECT_TRUE(decoded_rows->Slice(i, 1)->Equals(arr->Slice(rows[i], 1))) << rows[i];
+    }
+  }
+
+  arrow::MemoryPool* pool_ = arrow::default_memory_pool();
+};
+
+TEST_F(ColdColumnTest, BitPacked) {
+  std::vector<types::Int64Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(1000 + (i * 37) % 256);
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::INT64));
+  EXPECT_EQ(col.codec(), ColumnCodec::kBitPacked);
+  EXPECT_EQ(col.length(), 100);
+  EXPECT_EQ(col.plain_bytes(), 100 * sizeof(int64_t));
+  // 8 bits per value, in 13 words.
+  EXPECT_EQ(col.encoded_bytes(), 13 * sizeof(uint64_t));
+  EXPECT_EQ(col.GetValueInterval(types::DataType::INT64), ValueInterval(1000, 1255));
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, DeltaBitPacked) {
+  std::vector<types::Time64NSValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(1'600'000'000'000'000'000 + i * 1000 + i % 3);
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::TIME64NS));
+  EXPECT_EQ(col.codec(), ColumnCodec::kDeltaBitPacked);
+  // The deltas are about 1000, so zigzag encoded they take 11 bits, in 18 words.
+  EXPECT_EQ(col.encoded_bytes(), 18 * sizeof(uint64_t));
+  EXPECT_EQ(col.GetValueInterval(types::DataType::TIME64NS),
+            ValueInterval(1'600'000'000'000'000'000, 1'600'000'000'000'099'000));
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, DeltaBitPackedNegativeDeltas) {
+  std::vector<types::Int64Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(-5 * i);
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::INT64));
+  EXPECT_EQ(col.codec(), ColumnCodec::kDeltaBitPacked);
+  EXPECT_EQ(col.GetValueInterval(types::DataType::INT64), ValueInterval(-495, 0));
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, ConstantValuesTakeNoBits) {
+  std::vector<types::Int64Value> values(100, 42);
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::INT64));
+  EXPECT_EQ(col.codec(), ColumnCodec::kBitPacked);
+  EXPECT_EQ(col.encoded_bytes(), 0U);
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, WideValuesStayPlain) {
+  // Random values need all 64 bits, both as offsets and as deltas.
+  std::mt19937_64 rng(42);
+  std::vector<types::Int64Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(static_cast<int64_t>(rng()));
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::INT64));
+  EXPECT_EQ(col.codec(), ColumnCodec::kPlain);
+  EXPECT_EQ(col.encoded_bytes(), col.plain_bytes());
+  EXPECT_EQ(col.array(), arr);
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, ShortColumnsStayPlain) {
+  std::vector<types::Int64Value> values = {1, 2, 3, 4};
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::INT64));
+  EXPECT_EQ(col.codec(), ColumnCodec::kPlain);
+  EXPECT_EQ(col.array(), arr);
+}
+
+TEST_F(ColdColumnTest, Deflate) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(absl::Substitute(R"({"id": $0, "status": "ok", "items": []})", i));
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::STRING));
+  EXPECT_EQ(col.codec(), ColumnCodec::kDeflate);
+  EXPECT_LT(2 * col.encoded_bytes(), col.plain_bytes());
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, DictionaryForEnums) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(i % 3 == 0 ? "GET" : "POST");
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::STRING, types::GENERAL_ENUM));
+  EXPECT_EQ(col.codec(), ColumnCodec::kDictionary);
+  EXPECT_LT(col.encoded_bytes(), col.plain_bytes());
+  ExpectDecodesTo(col, arr);
+}
+
+TEST_F(ColdColumnTest, PlainColumn) {
+  std::vector<types::StringValue> values = {"abc", "de", "f"};
+  auto arr = types::ToArrow(values, pool_);
+
+  ColdColumn col(arr);
+  EXPECT_EQ(col.codec(), ColumnCodec::kPlain);
+  EXPECT_EQ(col.length(), 3);
+  EXPECT_EQ(col.plain_bytes(), 3 * sizeof(int32_t) + 6);
+  ASSERT_OK_AND_ASSIGN(auto decoded, col.DecodeSlice(1, 2, pool_));
+  EXPECT_TRUE(decoded->Equals(arr->Slice(1, 2)));
+}
+
+TEST_F(ColdColumnTest, BloomFilter) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(absl::Substitute("trace-$0", i));
+  }
+  auto arr = types::ToArrow(values, pool_);
+
+  ASSERT_OK_AND_ASSIGN(auto col, Encode(arr, types::DataType::STRING));
+  EXPECT_TRUE(col.MayContain("trace-1000"));
+  auto encoded_bytes = col.encoded_bytes();
+
+  ASSERT_OK(col.AddBloomFilter(arr.get(), 0.01));
+  EXPECT_GT(col.encoded_bytes(), encoded_bytes);
+  for (const auto& value : values) {
+    EXPECT_TRUE(col.MayContain(value));
+  }
+  int false_positives = 0;
+  for (int i = 100; i < 1100; ++i) {
+    false_positives += col.MayContain(absl::Substitute("trace-$0", i));
+  }
+  EXPECT_LT(false_positives, 50);
+  ExpectDecodesTo(col, arr);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
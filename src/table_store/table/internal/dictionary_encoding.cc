@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/dictionary_encoding.h"
+
+#include <arrow/builder.h>
+
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+std::string_view GetStringView(const arrow::StringArray& arr, int64_t idx) {
+  auto view = arr.GetView(idx);
+  return std::string_view(view.data(), view.size());
+}
+
+}  // namespace
+
+StatusOr<DictionaryEncodedArray> DictionaryEncode(const ArrowArrayPtr& arr,
+                                                  arrow::MemoryPool* mem_pool) {
+  DCHECK_EQ(arr->type_id(), arrow::Type::STRING);
+  DCHECK_EQ(arr->null_count(), 0);
+  const auto& strings = static_cast<const arrow::StringArray&>(*arr);
+
+  // The views point into `arr`, which outlives the map.
+  absl::flat_hash_map<std::string_view, int32_t> value_indices;
+  std::vector<std::string_view> values;
+  uint64_t dictionary_bytes = 0;
+
+  arrow::Int32Builder indices_builder(mem_pool);
+  PL_RETURN_IF_ERROR(indices_builder.Reserve(strings.length()));
+  for (int64_t i = 0; i < strings.length(); ++i) {
+    std::string_view value = GetStringView(strings, i);
+    auto [it, inserted] = value_indices.try_emplace(value, static_cast<int32_t>(values.size()));
+    if (inserted) {
+      values.push_back(value);
+      // Each dictionary entry also has an offset, like the rows of a string array.
+      dictionary_bytes += value.size() + sizeof(int32_t);
+    }
+    indices_builder.UnsafeAppend(it->second);
+  }
+
+  // The int32 indices cost the same as the offsets of the original rows, so only the values count.
+  const uint64_t value_bytes = strings.value_offset(strings.length()) - strings.value_offset(0);
+  if (2 * dictionary_bytes > value_bytes) {
+    return DictionaryEncodedArray{arr, 0};
+  }
+
+  arrow::StringBuilder dictionary_builder(mem_pool);
+  PL_RETURN_IF_ERROR(dictionary_builder.Reserve(values.size()));
+  PL_RETURN_IF_ERROR(dictionary_builder.ReserveData(dictionary_bytes));
+  for (std::string_view value : values) {
+    PL_RETURN_IF_ERROR(dictionary_builder.Append(value.data(), value.size()));
+  }
+
+  std::shared_ptr<arrow::Array> indices;
+  std::shared_ptr<arrow::Array> dictionary;
+  PL_RETURN_IF_ERROR(indices_builder.Finish(&indices));
+  PL_RETURN_IF_ERROR(dictionary_builder.Finish(&dictionary));
+
+  auto encoded = std::make_shared<arrow::DictionaryArray>(
+      arrow::dictionary(arrow::int32(), arrow::utf8()), indices, dictionary);
+  return DictionaryEncodedArray{std::move(encoded), value_bytes - dictionary_bytes};
+}
+
+StatusOr<ArrowArrayPtr> DictionaryDecode(const ArrowArrayPtr& arr, arrow::MemoryPool* mem_pool) {
+  if (arr->type_id() != arrow::Type::DICTIONARY) {
+    return arr;
+  }
+  const auto& encoded = static_cast<const arrow::DictionaryArray&>(*arr);
+  const auto& indices = static_cast<const arrow::Int32Array&>(*encoded.indices());
+  const auto& dictionary = static_cast<const arrow::StringArray&>(*encoded.dictionary());
+
+  int64_t num_bytes = 0;
+  for (int64_t i = 0; i < indices.length(); ++i) {
+    num_bytes += dictionary.value_length(indices.Value(i));
+  }
+
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(indices.length()));
+  PL_RETURN_IF_ERROR(builder.ReserveData(num_bytes));
+  for (int64_t i = 0; i < indices.length(); ++i) {
+    std::string_view value = GetStringView(dictionary, indices.Value(i));
+    PL_RETURN_IF_ERROR(builder.Append(value.data(), value.size()));
+  }
+
+  std::shared_ptr<arrow::Array> decoded;
+  PL_RETURN_IF_ERROR(builder.Finish(&decoded));
+  return decoded;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
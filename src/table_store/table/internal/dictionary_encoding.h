@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+struct DictionaryEncodedArray {
+  ArrowArrayPtr array;
+  // How many fewer bytes `array` takes than the string array it was encoded from, by the same
+  // measure as BatchSizeAccountant. This is 0 if the input was returned as is.
+  uint64_t bytes_saved = 0;
+};
+
+/**
+ * DictionaryEncode encodes a string array as an arrow::DictionaryArray, with an int32 index per
+ * row into a dictionary of the distinct values. Low cardinality columns, such as HTTP methods or
+ * k8s names, shrink to little more than their indices.
+ * If the dictionary would not take at most half of the bytes of the original values, the
+ * original array is returned instead, since then the decoding cost on reads isn't worth it.
+ * @param arr a string array without nulls.
+ */
+StatusOr<DictionaryEncodedArray> DictionaryEncode(const ArrowArrayPtr& arr,
+                                                  arrow::MemoryPool* mem_pool);
+
+/**
+ * DictionaryDecode inverts DictionaryEncode, returning a plain string array with a value per row
+ * of the (possibly sliced) dictionary array. Any other array is returned as is.
+ */
+StatusOr<ArrowArrayPtr> DictionaryDecode(const ArrowArrayPtr& arr, arrow::MemoryPool* mem_pool);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/disk_batch.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/file.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x54445850;  // "PXDT"
+constexpr size_t kAlignment = 64;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t num_cols;
+  int64_t num_rows;
+};
+
+size_t Align(size_t n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+// A read-only memory map of a whole file, which can also remove the file once unmapped.
+class MappedFile {
+ public:
+  static StatusOr<std::shared_ptr<const MappedFile>> Open(const std::filesystem::path& path,
+                                                          bool remove_file) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return error::Internal("Failed to open $0: $1", path.string(), std::strerror(errno));
+    }
+    DEFER(close(fd));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      return error::Internal("Failed to stat $0: $1", path.string(), std::strerror(errno));
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      return error::Internal("Failed to map $0: $1", path.string(), std::strerror(errno));
+    }
+    return std::shared_ptr<const MappedFile>(new MappedFile(path, addr, st.st_size, remove_file));
+  }
+
+  ~MappedFile() {
+    munmap(addr_, size_);
+    if (!remove_file_) {
+      return;
+    }
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+    LOG_IF(WARNING, ec) << absl::Substitute("Failed to remove $0: $1", path_.string(),
+                                            ec.message());
+  }
+
+  const uint8_t* data() const { return static_cast<const uint8_t*>(addr_); }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(std::filesystem::path path, void* addr, size_t size, bool remove_file)
+      : path_(std::move(path)), addr_(addr), size_(size), remove_file_(remove_file) {}
+
+  const std::filesystem::path path_;
+  void* const addr_;
+  const size_t size_;
+  const bool remove_file_;
+};
+
+// An arrow::Buffer over part of a memory map, that holds a reference to the map.
+class MappedBuffer : public arrow::Buffer {
+ public:
+  MappedBuffer(std::shared_ptr<const MappedFile> file, size_t offset, size_t size)
+      : arrow::Buffer(file->data() + offset, size), file_(std::move(file)) {}
+
+ private:
+  std::shared_ptr<const MappedFile> file_;
+};
+
+void AppendBuffer(const void* data, size_t size, std::string* contents) {
+  contents->append(static_cast<const char*>(data), size);
+  contents->resize(Align(contents->size()), '\0');
+}
+
+// Appends the buffers of the column to the file contents, in the order DiskBatch::Map reads them.
+void AppendColumn(const arrow::Array& arr, std::string* contents) {
+  const int64_t n = arr.length();
+  switch (arr.type_id()) {
+    case arrow::Type::STRING: {
+      const auto& strings = static_cast<const arrow::StringArray&>(arr);
+      const int32_t values_start = strings.value_offset(0);
+      std::vector<int32_t> offsets(n + 1);
+      for (int64_t i = 0; i <= n; ++i) {
+        offsets[i] = strings.value_offset(i) - values_start;
+      }
+      AppendBuffer(offsets.data(), offsets.size() * sizeof(int32_t), contents);
+      auto values = strings.GetView(0);
+      AppendBuffer(values.data(), offsets[n], contents);
+      return;
+    }
+    case arrow::Type::BOOL: {
+      // Rebuilt, since a sliced array's bits don't have to start at a byte boundary.
+      const auto& bools = static_cast<const arrow::BooleanArray&>(arr);
+      std::vector<uint8_t> bitmap((n + 7) / 8, 0);
+      for (int64_t i = 0; i < n; ++i) {
+        bitmap[i / 8] |= static_cast<uint8_t>(bools.Value(i)) << (i % 8);
+      }
+      AppendBuffer(bitmap.data(), bitmap.size(), contents);
+      return;
+    }
+    default: {
+      const auto& type = static_cast<const arrow::FixedWidthType&>(*arr.type());
+      const int byte_width = type.bit_width() / 8;
+      const auto& data = *arr.data();
+      AppendBuffer(data.buffers[1]->data() + data.offset * byte_width, n * byte_width, contents);
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+Status DiskBatch::WriteFile(const std::filesystem::path& path,
+                            const std::vector<ArrowArrayPtr>& columns) {
+  DCHECK(!columns.empty());
+  const int64_t length = columns[0]->length();
+
+  std::string contents;
+  FileHeader header{kMagic, static_cast<uint32_t>(columns.size()), length};
+  AppendBuffer(&header, sizeof(header), &contents);
+  for (const auto& col : columns) {
+    DCHECK_EQ(col->length(), length);
+    DCHECK_EQ(col->null_count(), 0);
+    DCHECK(col->type_id() != arrow::Type::DICTIONARY);
+    AppendColumn(*col, &contents);
+  }
+  return WriteFileFromString(path.string(), contents, std::ios_base::out | std::ios_base::binary);
+}
+
+StatusOr<DiskBatch> DiskBatch::Write(const std::filesystem::path& path,
+                                     const std::vector<ArrowArrayPtr>& columns) {
+  PL_RETURN_IF_ERROR(WriteFile(path, columns));
+  std::vector<std::shared_ptr<arrow::DataType>> types;
+  for (const auto& col : columns) {
+    types.push_back(col->type());
+  }
+  auto batch_or = Map(path, types, /*remove_file*/ true);
+  if (!batch_or.ok()) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+  return batch_or;
+}
+
+StatusOr<DiskBatch> DiskBatch::Open(const std::filesystem::path& path,
+                                    const std::vector<std::shared_ptr<arrow::DataType>>& types) {
+  return Map(path, types, /*remove_file*/ false);
+}
+
+StatusOr<DiskBatch> DiskBatch::Map(const std::filesystem::path& path,
+                                   const std::vector<std::shared_ptr<arrow::DataType>>& types,
+                                   bool remove_file) {
+  PL_ASSIGN_OR_RETURN(std::shared_ptr<const MappedFile> file, MappedFile::Open(path, remove_file));
+  FileHeader header;
+  if (file->size() < sizeof(header)) {
+    return error::InvalidArgument("$0 is too short to be a batch file.", path.string());
+  }
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (header.magic != kMagic || header.num_cols != types.size() || header.num_rows <= 0) {
+    return error::InvalidArgument("$0 is not a batch file of $1 columns.", path.string(),
+                                  types.size());
+  }
+  const int64_t length = header.num_rows;
+
+  // Buffers are laid out one after the other, so each is read from where the last one ended.
+  size_t offset = Align(sizeof(header));
+  auto next_buffer = [&](size_t size) -> StatusOr<std::shared_ptr<arrow::Buffer>> {
+    if (offset + size > file->size()) {
+      return error::InvalidArgument("$0 is truncated.", path.string());
+    }
+    auto buffer = std::make_shared<MappedBuffer>(file, offset, size);
+    offset = Align(offset + size);
+    return std::shared_ptr<arrow::Buffer>(std::move(buffer));
+  };
+
+  DiskBatch batch;
+  batch.length_ = length;
+  batch.file_bytes_ = file->size();
+  for (const auto& type : types) {
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers = {nullptr};
+    switch (type->id()) {
+      case arrow::Type::STRING: {
+        PL_ASSIGN_OR_RETURN(auto offsets, next_buffer((length + 1) * sizeof(int32_t)));
+        const int32_t values_size = reinterpret_cast<const int32_t*>(offsets->data())[length];
+        if (values_size < 0) {
+          return error::InvalidArgument("$0 is not a valid batch file.", path.string());
+        }
+        PL_ASSIGN_OR_RETURN(auto values, next_buffer(values_size));
+        buffers.push_back(std::move(offsets));
+        buffers.push_back(std::move(values));
+        break;
+      }
+      case arrow::Type::BOOL: {
+        PL_ASSIGN_OR_RETURN(auto bitmap, next_buffer((length + 7) / 8));
+        buffers.push_back(std::move(bitmap));
+        break;
+      }
+      default: {
+        const int byte_width = static_cast<const arrow::FixedWidthType&>(*type).bit_width() / 8;
+        PL_ASSIGN_OR_RETURN(auto values, next_buffer(length * byte_width));
+        buffers.push_back(std::move(values));
+        break;
+      }
+    }
+    auto data = arrow::ArrayData::Make(type, length, std::move(buffers), /*null_count*/ 0);
+    batch.columns_.push_back(arrow::MakeArray(data));
+  }
+  return batch;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DiskTierOptions configures the disk tier of a table, which keeps the batches that are expired
+ * from memory in files instead of discarding them.
+ */
+struct DiskTierOptions {
+  // The directory to write the table's batch files to. The disk tier is disabled if empty.
+  std::filesystem::path dir;
+  // The maximum bytes of batch files. The oldest batches are deleted beyond this.
+  int64_t max_bytes = 0;
+  // Batches whose first row is older than this are deleted. Ignored if negative, or if the table
+  // has no time column.
+  int64_t max_retention_ns = -1;
+
+  bool enabled() const { return !dir.empty(); }
+};
+
+/**
+ * DiskBatch is a batch of a table's disk tier. Its columns are written uncompressed to a file at
+ * creation, and are then read back through a read-only memory map, so that the page cache rather
+ * than the table's memory holds them. The file is removed once the batch, and every array sliced
+ * from it, has been destroyed. Table snapshots use the same files, which are instead opened again
+ * after a restart, and kept.
+ *
+ * File layout, with every buffer aligned to 64 bytes (as arrow prefers):
+ *   header: magic, num columns, num rows
+ *   per column: its buffers, without a validity bitmap since table columns have no nulls.
+ *     - fixed width types: the values
+ *     - BOOLEAN: the values as a bitmap
+ *     - STRING: num rows + 1 int32 offsets, starting at 0, then the values
+ */
+class DiskBatch {
+ public:
+  /**
+   * Write writes the given columns, all of the same length and without nulls, to a new file at
+   * `path`, and maps it back in.
+   */
+  static StatusOr<DiskBatch> Write(const std::filesystem::path& path,
+                                   const std::vector<ArrowArrayPtr>& columns);
+
+  /**
+   * WriteFile writes the given columns to a new file at `path`, like Write, without mapping it.
+   */
+  static Status WriteFile(const std::filesystem::path& path,
+                          const std::vector<ArrowArrayPtr>& columns);
+
+  /**
+   * Open maps in a file written by WriteFile, whose columns have the given types. Unlike with
+   * Write, the file is not removed once the batch is destroyed.
+   */
+  static StatusOr<DiskBatch> Open(const std::filesystem::path& path,
+                                  const std::vector<std::shared_ptr<arrow::DataType>>& types);
+
+  int64_t Length() const { return length_; }
+  const std::vector<ArrowArrayPtr>& columns() const { return columns_; }
+  // The size of the batch's file.
+  uint64_t FileBytes() const { return file_bytes_; }
+
+ private:
+  DiskBatch() = default;
+
+  static StatusOr<DiskBatch> Map(const std::filesystem::path& path,
+                                 const std::vector<std::shared_ptr<arrow::DataType>>& types,
+                                 bool remove_file);
+
+  int64_t length_ = 0;
+  uint64_t file_bytes_ = 0;
+  // Arrays over the memory map. Each holds a reference to the map through its buffers.
+  std::vector<ArrowArrayPtr> columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
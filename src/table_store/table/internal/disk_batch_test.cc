@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/array.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/disk_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(DiskBatchTest, RoundTrip) {
+  testing::TempDir tmp_dir;
+  auto path = tmp_dir.path() / "0.pxbatch";
+  auto pool = arrow::default_memory_pool();
+
+  std::vector<types::Time64NSValue> times{1, 2, 3, 4, 5};
+  std::vector<types::Int64Value> ints{10, -20, 30, -40, 50};
+  std::vector<types::BoolValue> bools{true, false, false, true, true};
+  std::vector<types::StringValue> strings{"a", "", "bcd", "efgh", "ijklmnop"};
+  std::vector<ArrowArrayPtr> columns{types::ToArrow(times, pool), types::ToArrow(ints, pool),
+                                     types::ToArrow(bools, pool), types::ToArrow(strings, pool)};
+
+  {
+    ASSERT_OK_AND_ASSIGN(auto batch, DiskBatch::Write(path, columns));
+    EXPECT_EQ(batch.Length(), 5);
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_EQ(batch.FileBytes(), std::filesystem::file_size(path));
+    ASSERT_EQ(batch.columns().size(), columns.size());
+    for (const auto& [i, col] : Enumerate(batch.columns())) {
+      EXPECT_TRUE(col->Equals(columns[i])) << i;
+    }
+  }
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(DiskBatchTest, SlicedColumns) {
+  testing::TempDir tmp_dir;
+  auto path = tmp_dir.path() / "0.pxbatch";
+  auto pool = arrow::default_memory_pool();
+
+  std::vector<types::BoolValue> bools;
+  std::vector<types::StringValue> strings;
+  for (int i = 0; i < 20; ++i) {
+    bools.push_back(i % 3 == 0);
+    strings.push_back(std::string(i, 'a'));
+  }
+  // The offsets are not byte aligned for the bitmap, and do not start at 0 for the strings.
+  std::vector<ArrowArrayPtr> columns{types::ToArrow(bools, pool)->Slice(3, 10),
+                                     types::ToArrow(strings, pool)->Slice(3, 10)};
+
+  ArrowArrayPtr str_col;
+  {
+    ASSERT_OK_AND_ASSIGN(auto batch, DiskBatch::Write(path, columns));
+    EXPECT_EQ(batch.Length(), 10);
+    EXPECT_TRUE(batch.columns()[0]->Equals(columns[0]));
+    EXPECT_TRUE(batch.columns()[1]->Equals(columns[1]));
+    str_col = batch.columns()[1]->Slice(2, 3);
+  }
+  // Arrays sliced from the batch keep the file mapped.
+  EXPECT_TRUE(std::filesystem::exists(path));
+  EXPECT_TRUE(str_col->Equals(columns[1]->Slice(2, 3)));
+  str_col.reset();
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(DiskBatchTest, OpenKeepsFile) {
+  testing::TempDir tmp_dir;
+  auto path = tmp_dir.path() / "0.pxsnap";
+  auto pool = arrow::default_memory_pool();
+
+  std::vector<types::Int64Value> ints{1, 2, 3};
+  std::vector<types::StringValue> strings{"abc", "", "d"};
+  std::vector<ArrowArrayPtr> columns{types::ToArrow(ints, pool), types::ToArrow(strings, pool)};
+  std::vector<std::shared_ptr<arrow::DataType>> types{columns[0]->type(), columns[1]->type()};
+  ASSERT_OK(DiskBatch::WriteFile(path, columns));
+
+  {
+    ASSERT_OK_AND_ASSIGN(auto batch, DiskBatch::Open(path, types));
+    EXPECT_EQ(batch.Length(), 3);
+    EXPECT_EQ(batch.FileBytes(), std::filesystem::file_size(path));
+    EXPECT_TRUE(batch.columns()[0]->Equals(columns[0]));
+    EXPECT_TRUE(batch.columns()[1]->Equals(columns[1]));
+  }
+  EXPECT_TRUE(std::filesystem::exists(path));
+
+  // Files of other columns, or cut short, are rejected.
+  EXPECT_NOT_OK(DiskBatch::Open(path, {types[0]}));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 64);
+  EXPECT_NOT_OK(DiskBatch::Open(path, types));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
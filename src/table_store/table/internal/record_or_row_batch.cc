@@ -16,15 +16,35 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "src/common/base/utils.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/row_selection.h"
 
 namespace px {
 namespace table_store {
 namespace internal {
 
+namespace {
+
+template <types::DataType T>
+ValueInterval ColumnWrapperValueInterval(const types::ColumnWrapper& col, size_t row_offset) {
+  using ValueType = typename types::DataTypeTraits<T>::value_type;
+  ValueInterval interval{std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+  for (size_t i = row_offset; i < col.Size(); ++i) {
+    int64_t val = col.Get<ValueType>(i).val;
+    interval.first = std::min(interval.first, val);
+    interval.second = std::max(interval.second, val);
+  }
+  return interval;
+}
+
+}  // namespace
+
 size_t RecordOrRowBatch::Length() const {
   return std::visit(overloaded{
                         [this](const RecordBatchWithCache& record_batch_w_cache) {
@@ -36,7 +56,7 @@ size_t RecordOrRowBatch::Length() const {
                           return static_cast<size_t>(row_batch.num_rows()) - row_offset_;
                         },
                     },
-                    batch_);
+                    batch_->batch);
 }
 
 int64_t RecordOrRowBatch::FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const {
@@ -58,7 +78,7 @@ int64_t RecordOrRowBatch::FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx,
                                                                                         time);
           },
       },
-      batch_);
+      batch_->batch);
 }
 
 int64_t RecordOrRowBatch::FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const {
@@ -85,7 +105,7 @@ int64_t RecordOrRowBatch::FindTimeFirstGreaterThan(int64_t time_col_idx, Time ti
                    1;
           },
       },
-      batch_);
+      batch_->batch);
 }
 
 Time RecordOrRowBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const {
@@ -100,7 +120,27 @@ Time RecordOrRowBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const
                               row_batch.ColumnAt(time_col_idx).get(), row_idx);
                         },
                     },
-                    batch_);
+                    batch_->batch);
+}
+
+ValueInterval RecordOrRowBatch::GetValueInterval(int64_t col_idx, types::DataType col_type) const {
+  DCHECK(IsZoneMapped(col_type));
+  return std::visit(
+      overloaded{
+          [this, col_idx, col_type](const RecordBatchWithCache& record_batch_w_cache) {
+            const auto& col = *(*record_batch_w_cache.record_batch)[col_idx];
+            if (col_type == types::DataType::TIME64NS) {
+              return ColumnWrapperValueInterval<types::DataType::TIME64NS>(col, row_offset_);
+            }
+            return ColumnWrapperValueInterval<types::DataType::INT64>(col, row_offset_);
+          },
+          [this, col_idx, col_type](const schema::RowBatch& row_batch) {
+            auto length = row_batch.num_rows() - row_offset_;
+            auto arr = row_batch.ColumnAt(col_idx)->Slice(row_offset_, length);
+            return ArrowArrayValueInterval(arr.get(), col_type);
+          },
+      },
+      batch_->batch);
 }
 
 void RecordOrRowBatch::RemovePrefix(size_t num_rows) { row_offset_ += num_rows; }
@@ -111,14 +151,16 @@ Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_
   row_start += row_offset_;
   return std::visit(
       overloaded{
-          [row_start, batch_size, cols,
+          [this, row_start, batch_size, cols,
            output_rb](const RecordBatchWithCache& record_batch_w_cache) {
+            absl::MutexLock cache_lock(&batch_->cache_lock);
             for (auto col_idx : cols) {
               if (!record_batch_w_cache.cache_validity[col_idx]) {
                 // Arrow array wasn't in cache, convert it to arrow and then add
-                // to cache.
-                auto arr = (*record_batch_w_cache.record_batch)[col_idx]->ConvertToArrow(
-                    arrow::default_memory_pool());
+                // to cache. Fixed size columns are shared with arrow rather than copied, since
+                // hot batches are not modified.
+                auto arr = types::ColumnWrapper::ShareAsArrow(
+                    (*record_batch_w_cache.record_batch)[col_idx], arrow::default_memory_pool());
                 record_batch_w_cache.arrow_cache[col_idx] = arr;
                 record_batch_w_cache.cache_validity[col_idx] = true;
               }
@@ -135,7 +177,35 @@ Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_
             return Status::OK();
           },
       },
-      batch_);
+      batch_->batch);
+}
+
+StatusOr<ArrowArrayPtr> RecordOrRowBatch::GatherColumnRows(int64_t col_idx,
+                                                           types::DataType col_type,
+                                                           size_t row_start,
+                                                           const std::vector<int64_t>& rows,
+                                                           arrow::MemoryPool* mem_pool) const {
+  row_start += row_offset_;
+  return std::visit(
+      overloaded{
+          [this, col_idx, col_type, row_start, &rows,
+           mem_pool](const RecordBatchWithCache& record_batch_w_cache) {
+            absl::MutexLock cache_lock(&batch_->cache_lock);
+            // Columns that were already converted to arrow are copied from, and the others are
+            // copied from directly rather than converted whole.
+            if (record_batch_w_cache.cache_validity[col_idx]) {
+              return GatherRows(record_batch_w_cache.arrow_cache[col_idx].get(), col_type,
+                                row_start, rows, mem_pool);
+            }
+            return GatherRows((*record_batch_w_cache.record_batch)[col_idx].get(), col_type,
+                              row_start, rows, mem_pool);
+          },
+          [col_idx, col_type, row_start, &rows, mem_pool](const schema::RowBatch& row_batch) {
+            return GatherRows(row_batch.ColumnAt(col_idx).get(), col_type, row_start, rows,
+                              mem_pool);
+          },
+      },
+      batch_->batch);
 }
 
 void RecordOrRowBatch::UnsafeAppendColumnToBuilder(types::TypeErasedArrowBuilder* builder,
@@ -164,7 +234,7 @@ void RecordOrRowBatch::UnsafeAppendColumnToBuilder(types::TypeErasedArrowBuilder
 #undef TYPE_CASE
           },
       },
-      batch_);
+      batch_->batch);
 }
 
 std::vector<uint64_t> RecordOrRowBatch::GetVariableSizedColumnRowBytes(size_t col_idx) const {
@@ -187,7 +257,7 @@ std::vector<uint64_t> RecordOrRowBatch::GetVariableSizedColumnRowBytes(size_t co
                    }
                  },
              },
-             batch_);
+             batch_->batch);
 
   return rows_bytes;
 }
@@ -18,12 +18,16 @@
 
 #pragma once
 
+#include <memory>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -39,14 +43,20 @@ namespace internal {
  * the start of the batch without reallocating or copying the batch. To do so, it stores a
  * `row_offset_` internally, and each operation on a batch acts as if the batch actually starts at
  * `row_offset_`.
+ *
+ * Copies of a RecordOrRowBatch share the underlying batch, and only have their own `row_offset_`.
+ * That makes a copy a cheap snapshot, that RemovePrefix() on the original does not change, which
+ * is what lets readers keep using a hot batch after releasing the table's locks.
  */
 class RecordOrRowBatch {
  public:
   explicit RecordOrRowBatch(RecordBatchWithCache&& record_batch)
-      : batch_(std::move(record_batch)) {}
-  explicit RecordOrRowBatch(const schema::RowBatch& row_batch) : batch_(row_batch) {}
+      : batch_(std::make_shared<SharedBatch>(std::move(record_batch))) {}
+  explicit RecordOrRowBatch(const schema::RowBatch& row_batch)
+      : batch_(std::make_shared<SharedBatch>(row_batch)) {}
 
   RecordOrRowBatch(RecordOrRowBatch&&) = default;
+  RecordOrRowBatch(const RecordOrRowBatch&) = default;
 
   /**
    * Length returns the number of rows in this record or row batch.
@@ -78,6 +88,13 @@ class RecordOrRowBatch {
    * @return the time value at the given row index.
    */
   Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * GetValueInterval returns the minimum and maximum value of an INT64 or TIME64NS column.
+   * @param col_idx, the index of the column.
+   * @param col_type, the type of the column, which must be zone mapped (see IsZoneMapped()).
+   * @return the minimum and maximum value in the column.
+   */
+  ValueInterval GetValueInterval(int64_t col_idx, types::DataType col_type) const;
   /**
    * RemovePrefix removes the given number of rows from the start of this record or row batch. To
    * avoid reallocations, RecordOrRowBatch stores a `row_offset_` that is incremented by the number
@@ -100,6 +117,20 @@ class RecordOrRowBatch {
                                  const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const;
 
+  /**
+   * GatherColumnRows copies some of the rows of a column of this record or row batch into a new
+   * arrow array, without converting the rest of the column.
+   * @param col_idx, index of the column to copy from.
+   * @param col_type, the DataType of the column.
+   * @param row_start, row index within this batch that the rows are offsets from.
+   * @param rows, offsets of the rows to copy, in the order to copy them.
+   * @param mem_pool, the pool to allocate the array from.
+   * @return the array of the rows' values, or an error Status.
+   */
+  StatusOr<ArrowArrayPtr> GatherColumnRows(int64_t col_idx, types::DataType col_type,
+                                           size_t row_start, const std::vector<int64_t>& rows,
+                                           arrow::MemoryPool* mem_pool) const;
+
   /**
    * UnsafeAppendColumnToBuilder appends a slice of a column of this record or row batch to the
    * given arrow array builder. This method expects that the given builder already has the space
@@ -126,7 +157,17 @@ class RecordOrRowBatch {
   std::vector<uint64_t> GetVariableSizedColumnRowBytes(size_t col_idx) const;
 
  private:
-  std::variant<RecordBatchWithCache, schema::RowBatch> batch_;
+  using Batch = std::variant<RecordBatchWithCache, schema::RowBatch>;
+  struct SharedBatch {
+    explicit SharedBatch(Batch&& batch) : batch(std::move(batch)) {}
+    explicit SharedBatch(const schema::RowBatch& row_batch) : batch(row_batch) {}
+
+    const Batch batch;
+    // Guards the arrow cache of a RecordBatchWithCache, which readers fill in concurrently.
+    absl::Mutex cache_lock;
+  };
+
+  std::shared_ptr<SharedBatch> batch_;
   int64_t row_offset_ = 0;
 };
 
@@ -111,6 +111,15 @@ TEST_P(RecordOrRowBatchTest, RemovePrefix_GetTimeValue) {
   EXPECT_EQ(25, rb_->GetTimeValue(time_col_idx_, 1));
 }
 
+TEST_P(RecordOrRowBatchTest, GetValueInterval) {
+  EXPECT_EQ(ValueInterval(9, 25), rb_->GetValueInterval(time_col_idx_, types::DataType::TIME64NS));
+}
+
+TEST_P(RecordOrRowBatchTest, RemovePrefix_GetValueInterval) {
+  rb_->RemovePrefix(2);
+  EXPECT_EQ(ValueInterval(20, 25), rb_->GetValueInterval(time_col_idx_, types::DataType::TIME64NS));
+}
+
 TEST_P(RecordOrRowBatchTest, AddBatchSliceToRowBatch) {
   schema::RowBatch rb0(schema::RowDescriptor(rel_->col_types()), 2);
   EXPECT_OK(rb_->AddBatchSliceToRowBatch(0, 2, {0, 1, 2}, &rb0));
@@ -157,6 +166,19 @@ TEST_P(RecordOrRowBatchTest, RemovePrefix_AddBatchSliceToRowBatch) {
       rb1.ColumnAt(2)->Equals(types::ToArrow(strings_, arrow::default_memory_pool())->Slice(2, 1)));
 }
 
+TEST_P(RecordOrRowBatchTest, RemovePrefix_GatherColumnRows) {
+  rb_->RemovePrefix(1);
+
+  ASSERT_OK_AND_ASSIGN(auto times, rb_->GatherColumnRows(0, types::DataType::TIME64NS, 1, {0, 1},
+                                                         arrow::default_memory_pool()));
+  EXPECT_TRUE(times->Equals(types::ToArrow(std::vector<types::Time64NSValue>{20, 25},
+                                           arrow::default_memory_pool())));
+  ASSERT_OK_AND_ASSIGN(auto strings, rb_->GatherColumnRows(2, types::DataType::STRING, 0, {0, 2},
+                                                           arrow::default_memory_pool()));
+  std::vector<types::StringValue> expected_strings = {strings_[1], strings_[3]};
+  EXPECT_TRUE(strings->Equals(types::ToArrow(expected_strings, arrow::default_memory_pool())));
+}
+
 TEST_P(RecordOrRowBatchTest, UnsafeAppendColumnToBuilder) {
   auto time_builder =
       types::MakeTypeErasedArrowBuilder(types::DataType::TIME64NS, arrow::default_memory_pool());
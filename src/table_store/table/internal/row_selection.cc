@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/row_selection.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+template <types::DataType T>
+void KeepRowsInRange(const arrow::Array* arr, const ColumnRange& range,
+                     std::vector<int64_t>* rows) {
+  auto out = rows->begin();
+  for (int64_t row : *rows) {
+    int64_t val = types::GetValueFromArrowArray<T>(arr, row);
+    if (val >= range.min && val <= range.max) {
+      *out++ = row;
+    }
+  }
+  rows->erase(out, rows->end());
+}
+
+// Builds an array of `num_rows` values, where get_value(i) returns the i-th one. STRING arrays
+// reserve `data_bytes` for the values up front.
+template <types::DataType T, typename TGetValue>
+StatusOr<ArrowArrayPtr> BuildArray(size_t num_rows, int64_t data_bytes, TGetValue get_value,
+                                   arrow::MemoryPool* mem_pool) {
+  using BuilderType = typename types::DataTypeTraits<T>::arrow_builder_type;
+  auto builder = types::GetArrowBuilder<T>(mem_pool);
+  auto* typed_builder = static_cast<BuilderType*>(builder.get());
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(num_rows));
+  if constexpr (T == types::DataType::STRING) {
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(data_bytes));
+  }
+  for (size_t i = 0; i < num_rows; ++i) {
+    typed_builder->UnsafeAppend(get_value(i));
+  }
+  ArrowArrayPtr out;
+  PL_RETURN_IF_ERROR(typed_builder->Finish(&out));
+  return out;
+}
+
+}  // namespace
+
+std::vector<int64_t> SelectRows(const schema::RowBatch& rb, const std::vector<ColumnRange>& ranges,
+                                const std::vector<ColumnEquals>& equals) {
+  std::vector<int64_t> rows(rb.num_rows());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    rows[i] = i;
+  }
+  // Each predicate only looks at the rows that the ones before it kept.
+  for (const auto& range : ranges) {
+    const arrow::Array* arr = rb.ColumnAt(range.col_idx).get();
+    if (rb.desc().type(range.col_idx) == types::DataType::TIME64NS) {
+      KeepRowsInRange<types::DataType::TIME64NS>(arr, range, &rows);
+    } else {
+      KeepRowsInRange<types::DataType::INT64>(arr, range, &rows);
+    }
+  }
+  for (const auto& eq : equals) {
+    DCHECK_EQ(rb.desc().type(eq.col_idx), types::DataType::STRING);
+    const auto* arr = static_cast<const arrow::StringArray*>(rb.ColumnAt(eq.col_idx).get());
+    auto out = rows.begin();
+    for (int64_t row : rows) {
+      auto view = arr->GetView(row);
+      std::string_view val(view.data(), view.size());
+      if (std::find(eq.values.begin(), eq.values.end(), val) != eq.values.end()) {
+        *out++ = row;
+      }
+    }
+    rows.erase(out, rows.end());
+  }
+  return rows;
+}
+
+StatusOr<ArrowArrayPtr> GatherRows(const arrow::Array* arr, types::DataType type,
+                                   int64_t row_offset, const std::vector<int64_t>& rows,
+                                   arrow::MemoryPool* mem_pool) {
+  int64_t data_bytes = 0;
+  if (type == types::DataType::STRING) {
+    const auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    for (int64_t row : rows) {
+      data_bytes += str_arr->value_length(row_offset + row);
+    }
+  }
+#define TYPE_CASE(_dt_)                                                                         \
+  return BuildArray<_dt_>(                                                                      \
+      rows.size(), data_bytes,                                                                  \
+      [&](size_t i) { return types::GetValueFromArrowArray<_dt_>(arr, row_offset + rows[i]); }, \
+      mem_pool);
+  PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+StatusOr<ArrowArrayPtr> GatherRows(types::ColumnWrapper* col, types::DataType type,
+                                   int64_t row_offset, const std::vector<int64_t>& rows,
+                                   arrow::MemoryPool* mem_pool) {
+  int64_t data_bytes = 0;
+  if (type == types::DataType::STRING) {
+    for (int64_t row : rows) {
+      data_bytes += col->Get<types::StringValue>(row_offset + row).size();
+    }
+  }
+#define TYPE_CASE(_dt_)                                                                         \
+  return BuildArray<_dt_>(                                                                      \
+      rows.size(), data_bytes,                                                                  \
+      [&](size_t i) { return *types::ColumnWrapperIterator<_dt_>(col, row_offset + rows[i]); }, \
+      mem_pool);
+  PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
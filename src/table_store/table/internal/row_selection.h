@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * SelectRows returns the indices of the rows of the row batch that are in all of the ranges, and
+ * have one of the values of each of the equals. The col_idx of the ranges and equals are columns of
+ * `rb`, which must be INT64 or TIME64NS for ranges, and STRING for equals.
+ */
+std::vector<int64_t> SelectRows(const schema::RowBatch& rb, const std::vector<ColumnRange>& ranges,
+                                const std::vector<ColumnEquals>& equals);
+
+/**
+ * GatherRows copies the given rows of a column into a new arrow array, in the given order. The
+ * rows are offsets from `row_offset`.
+ */
+StatusOr<ArrowArrayPtr> GatherRows(const arrow::Array* arr, types::DataType type,
+                                   int64_t row_offset, const std::vector<int64_t>& rows,
+                                   arrow::MemoryPool* mem_pool);
+StatusOr<ArrowArrayPtr> GatherRows(types::ColumnWrapper* col, types::DataType type,
+                                   int64_t row_offset, const std::vector<int64_t>& rows,
+                                   arrow::MemoryPool* mem_pool);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/row_selection.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class RowSelectionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rb_ = std::make_unique<schema::RowBatch>(
+        schema::RowDescriptor({types::DataType::TIME64NS, types::DataType::INT64,
+                               types::DataType::STRING}),
+        5);
+    std::vector<types::Time64NSValue> times = {1, 2, 3, 4, 5};
+    std::vector<types::Int64Value> latencies = {100, 5, 300, 7, 500};
+    std::vector<types::StringValue> services = {"a", "b", "a", "c", "b"};
+    ASSERT_OK(rb_->AddColumn(types::ToArrow(times, pool_)));
+    ASSERT_OK(rb_->AddColumn(types::ToArrow(latencies, pool_)));
+    ASSERT_OK(rb_->AddColumn(types::ToArrow(services, pool_)));
+  }
+
+  arrow::MemoryPool* pool_ = arrow::default_memory_pool();
+  std::unique_ptr<schema::RowBatch> rb_;
+};
+
+TEST_F(RowSelectionTest, SelectRows) {
+  EXPECT_THAT(SelectRows(*rb_, {}, {}), ::testing::ElementsAre(0, 1, 2, 3, 4));
+
+  ColumnRange slow{1};
+  slow.min = 100;
+  EXPECT_THAT(SelectRows(*rb_, {slow}, {}), ::testing::ElementsAre(0, 2, 4));
+
+  ColumnRange early{0};
+  early.max = 3;
+  EXPECT_THAT(SelectRows(*rb_, {slow, early}, {}), ::testing::ElementsAre(0, 2));
+
+  ColumnEquals services{2, {"b", "c"}};
+  EXPECT_THAT(SelectRows(*rb_, {}, {services}), ::testing::ElementsAre(1, 3, 4));
+  EXPECT_THAT(SelectRows(*rb_, {slow}, {services}), ::testing::ElementsAre(4));
+  EXPECT_THAT(SelectRows(*rb_, {early}, {services}), ::testing::ElementsAre(1));
+}
+
+TEST_F(RowSelectionTest, GatherRows) {
+  ASSERT_OK_AND_ASSIGN(
+      auto latencies, GatherRows(rb_->ColumnAt(1).get(), types::DataType::INT64, 1, {0, 2}, pool_));
+  EXPECT_TRUE(latencies->Equals(types::ToArrow(std::vector<types::Int64Value>{5, 7}, pool_)));
+
+  ASSERT_OK_AND_ASSIGN(auto services,
+                       GatherRows(rb_->ColumnAt(2).get(), types::DataType::STRING, 0, {4}, pool_));
+  EXPECT_TRUE(services->Equals(types::ToArrow(std::vector<types::StringValue>{"b"}, pool_)));
+
+  auto col = types::ColumnWrapper::FromArrow(rb_->ColumnAt(2));
+  ASSERT_OK_AND_ASSIGN(auto wrapped_services,
+                       GatherRows(col.get(), types::DataType::STRING, 2, {0, 1}, pool_));
+  EXPECT_TRUE(
+      wrapped_services->Equals(types::ToArrow(std::vector<types::StringValue>{"a", "c"}, pool_)));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
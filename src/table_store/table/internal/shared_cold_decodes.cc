@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/shared_cold_decodes.h"
+
+#include <utility>
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+int64_t ArrayBytes(const arrow::Array& arr) {
+  int64_t bytes = 0;
+  for (const auto& buffer : arr.data()->buffers) {
+    if (buffer != nullptr) {
+      bytes += buffer->size();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+StatusOr<ArrowArrayPtr> SharedColdDecodes::GetOrDecode(
+    const std::shared_ptr<const ColdBatch>& batch, int64_t col_idx) {
+  std::shared_ptr<Entry> entry;
+  {
+    absl::MutexLock lock(&lock_);
+    auto& slot = entries_[{batch.get(), col_idx}];
+    if (slot == nullptr || slot->batch.expired()) {
+      slot = std::make_shared<Entry>();
+      slot->batch = batch;
+    }
+    entry = slot;
+  }
+
+  ArrowArrayPtr column;
+  {
+    absl::MutexLock entry_lock(&entry->lock);
+    column = entry->column.lock();
+    if (column != nullptr) {
+      return column;
+    }
+    const ColdColumn& col = (*batch)[col_idx];
+    PL_ASSIGN_OR_RETURN(column, col.DecodeSlice(0, col.length(), arrow::default_memory_pool()));
+    entry->column = column;
+  }
+  Retain(column);
+  return column;
+}
+
+void SharedColdDecodes::Retain(ArrowArrayPtr column) {
+  const int64_t bytes = ArrayBytes(*column);
+  if (bytes > max_retained_bytes_) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  absl::MutexLock lock(&lock_);
+  retained_.push_back({now, std::move(column), bytes});
+  retained_bytes_ += bytes;
+  ReleaseExpiredLocked(now);
+}
+
+void SharedColdDecodes::ReleaseExpired() {
+  absl::MutexLock lock(&lock_);
+  ReleaseExpiredLocked(std::chrono::steady_clock::now());
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    Entry& entry = *it->second;
+    // An entry that is locked is being decoded, so it is kept.
+    bool unused = false;
+    if (entry.lock.TryLock()) {
+      unused = entry.batch.expired() || entry.column.expired();
+      entry.lock.Unlock();
+    }
+    if (unused) {
+      entries_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SharedColdDecodes::ReleaseExpiredLocked(std::chrono::steady_clock::time_point now) {
+  while (!retained_.empty() && (retained_bytes_ > max_retained_bytes_ ||
+                                now - retained_.front().decoded_at > retention_)) {
+    retained_bytes_ -= retained_.front().bytes;
+    retained_.pop_front();
+  }
+}
+
+int64_t SharedColdDecodes::RetainedBytes() const {
+  absl::MutexLock lock(&lock_);
+  return retained_bytes_;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
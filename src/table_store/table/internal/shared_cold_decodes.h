@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/column_codec.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * SharedColdDecodes lets the cursors of concurrent queries that scan the same cold batches, e.g.
+ * the scripts of a dashboard that all read the last few minutes of a table, share the decoded
+ * columns of each batch rather than each decoding its own copy. A decoded column is shared for as
+ * long as any reader holds it. The most recently decoded columns are also held for a short while,
+ * up to a byte limit, so that queries running a little behind each other still find them. Readers
+ * slice and pick the columns they need from the shared ones themselves.
+ */
+class SharedColdDecodes {
+ public:
+  SharedColdDecodes(int64_t max_retained_bytes, std::chrono::steady_clock::duration retention)
+      : max_retained_bytes_(max_retained_bytes), retention_(retention) {}
+
+  /**
+   * GetOrDecode returns the whole of the given column of the batch, decoded, and only decodes it if
+   * no other reader has it. Concurrent calls for the same column wait for the one decoding it.
+   */
+  StatusOr<ArrowArrayPtr> GetOrDecode(const std::shared_ptr<const ColdBatch>& batch,
+                                      int64_t col_idx);
+
+  /**
+   * ReleaseExpired stops holding the columns that were decoded longer than the retention ago, and
+   * forgets the columns that no reader holds any more. It should be called periodically.
+   */
+  void ReleaseExpired();
+
+  int64_t RetainedBytes() const;
+
+ private:
+  struct Entry {
+    absl::Mutex lock;
+    // Expires with the batch, so that an entry is never matched to a new batch at the same address.
+    std::weak_ptr<const ColdBatch> batch;
+    std::weak_ptr<arrow::Array> column ABSL_GUARDED_BY(lock);
+  };
+  struct RetainedColumn {
+    std::chrono::steady_clock::time_point decoded_at;
+    ArrowArrayPtr column;
+    int64_t bytes;
+  };
+
+  void Retain(ArrowArrayPtr column);
+  void ReleaseExpiredLocked(std::chrono::steady_clock::time_point now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const int64_t max_retained_bytes_;
+  const std::chrono::steady_clock::duration retention_;
+
+  // Ordered before the entries' locks.
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<std::pair<const ColdBatch*, int64_t>, std::shared_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(lock_);
+  std::deque<RetainedColumn> retained_ ABSL_GUARDED_BY(lock_);
+  int64_t retained_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/array.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/column_codec.h"
+#include "src/table_store/table/internal/shared_cold_decodes.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class SharedColdDecodesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<types::Int64Value> values;
+    for (int i = 0; i < 100; ++i) {
+      values.push_back(1000 + (i * 37) % 256);
+    }
+    arr_ = types::ToArrow(values, arrow::default_memory_pool());
+    ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Encode(arr_, types::DataType::INT64,
+                                                      types::UNSPECIFIED,
+                                                      arrow::default_memory_pool()));
+    ASSERT_EQ(col.codec(), ColumnCodec::kBitPacked);
+    batch_ = std::make_shared<const ColdBatch>(ColdBatch{std::move(col)});
+  }
+
+  ArrowArrayPtr arr_;
+  std::shared_ptr<const ColdBatch> batch_;
+};
+
+TEST_F(SharedColdDecodesTest, ReadersShareDecodedColumn) {
+  SharedColdDecodes decodes(/*max_retained_bytes*/ 0, std::chrono::seconds(0));
+  ASSERT_OK_AND_ASSIGN(auto first, decodes.GetOrDecode(batch_, 0));
+  ASSERT_OK_AND_ASSIGN(auto second, decodes.GetOrDecode(batch_, 0));
+  EXPECT_TRUE(first->Equals(arr_));
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(decodes.RetainedBytes(), 0);
+
+  // Once no reader holds it, the column is decoded again.
+  first.reset();
+  second.reset();
+  decodes.ReleaseExpired();
+  ASSERT_OK_AND_ASSIGN(auto third, decodes.GetOrDecode(batch_, 0));
+  EXPECT_TRUE(third->Equals(arr_));
+}
+
+TEST_F(SharedColdDecodesTest, RecentColumnsRetained) {
+  SharedColdDecodes decodes(/*max_retained_bytes*/ 1024 * 1024, std::chrono::milliseconds(1));
+  const arrow::Array* decoded = nullptr;
+  {
+    ASSERT_OK_AND_ASSIGN(auto column, decodes.GetOrDecode(batch_, 0));
+    decoded = column.get();
+  }
+  EXPECT_GE(decodes.RetainedBytes(), 100 * sizeof(int64_t));
+  // A reader right after the first one finds the column, although the first one dropped it.
+  ASSERT_OK_AND_ASSIGN(auto column, decodes.GetOrDecode(batch_, 0));
+  EXPECT_EQ(column.get(), decoded);
+  column.reset();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  decodes.ReleaseExpired();
+  EXPECT_EQ(decodes.RetainedBytes(), 0);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
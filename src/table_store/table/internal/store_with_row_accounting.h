@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -28,7 +30,12 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/column_codec.h"
+#include "src/table_store/table/internal/disk_batch.h"
+#include "src/table_store/table/internal/row_selection.h"
+#include "src/table_store/table/internal/shared_cold_decodes.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -36,6 +43,18 @@ namespace internal {
 
 using HotBatch = RecordOrRowBatch;
 
+/**
+ * DecodedColdBatch holds the decoded columns of the compressed cold batch that a cursor is part way
+ * through, so that a batch read over several row batches is decoded once and then sliced, like its
+ * plain columns are.
+ */
+struct DecodedColdBatch {
+  std::shared_ptr<const ColdBatch> batch;
+  std::vector<ArrowArrayPtr> columns;
+  // If set, columns are decoded through it, so that concurrent readers of the batch share them.
+  SharedColdDecodes* shared = nullptr;
+};
+
 inline bool RowIDIntervalComparator(const RowIDInterval& interval, RowID val) {
   return interval.second < val;
 }
@@ -56,16 +75,26 @@ void constexpr_else_static_assert_false() {
 /**
  * StoreWithRowTimeAccounting stores a deque of batches (hot or cold) and keeps track of the first
  * and last unique RowID's for each batch, as well as the first and last times for each batch (if
- * there is a time column in the table). The template parameter specifies whether this is the Hot or
- * Cold store. Since the logic between the Hot and Cold stores is roughly identical, this class
- * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot or Cold
- * batch methods.
+ * there is a time column in the table). The template parameter specifies whether this is the Hot,
+ * Cold or Disk store. Since the logic between the stores is roughly identical, this class
+ * deduplicates that logic while allowing the explicit batch accesses to use the correct batch
+ * methods.
  *
  * Times are used to find row batch's within a given time
  * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
  * the batches changes when they are compacted from the hot store to the cold store, the unique
  * RowIDs are necessary to ensure that the query doesn't receive duplicate rows if the rows have
  * the same timestamp.
+ *
+ * The time column of cold batches has to be a plain ColdColumn, since it is searched in place.
+ *
+ * A ZoneMap of the INT64 and TIME64NS columns of each batch is kept as well, so that readers can
+ * skip batches by value (e.g. by latency) without reading them.
+ *
+ * Batches are not modified once added to the store, and are held by shared_ptr. Readers take a
+ * reference to a batch with NextBatchSlice() while holding the store's lock, and then read it with
+ * ReadBatchSlice() after releasing the lock. A batch that is removed in the meantime is freed
+ * once its last reader drops it.
  */
 template <StoreType TStoreType>
 class StoreWithRowTimeAccounting {
@@ -73,7 +102,20 @@ class StoreWithRowTimeAccounting {
 
  public:
   StoreWithRowTimeAccounting(const schema::Relation& rel, int64_t time_col_idx)
-      : rel_(rel), time_col_idx_(time_col_idx) {}
+      : rel_(rel), time_col_idx_(time_col_idx), zone_map_(rel) {}
+
+  /**
+   * BatchSlice is the part of a batch that the next row batch of a cursor is made of, see
+   * NextBatchSlice().
+   */
+  struct BatchSlice {
+    // Null if the batches were skipped by value, in which case the slice is read as a zero row
+    // batch.
+    std::shared_ptr<const TBatch> batch;
+    size_t row_offset = 0;
+    size_t num_rows = 0;
+    std::vector<types::DataType> col_types;
+  };
 
   /**
    * GetNextRowBatch returns the next row batch in this store after the given unique row id.
@@ -87,15 +129,41 @@ class StoreWithRowTimeAccounting {
    * @param stop_row_id, an optional unique RowID to stop the batch at. If provided, the batch will
    * be sliced such that no rows are included with `RowID >= stop_row_id.value()`.
    * @param cols, a vector of column indices to include in the outputted row batch.
+   * @param ranges, value ranges that rows of interest fall in. Batches that the zone map shows to
+   * have no such rows are skipped without being read, though returned batches may still contain
+   * rows outside of the ranges.
+   * @param equals, values of STRING columns that rows of interest have. Cold batches whose bloom
+   * filters show that they have no such rows are skipped in the same way.
    * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
-   * match the parameters above. On error returns a Status.
+   * match the parameters above. If all the remaining batches of the store (up to the stop row) are
+   * skipped, a zero row batch is returned. On error returns a Status.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
       RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
-      const std::vector<int64_t>& cols) const {
+      const std::vector<int64_t>& cols, const std::vector<ColumnRange>& ranges = {},
+      const std::vector<ColumnEquals>& equals = {}) const {
+    auto slice = NextBatchSlice(last_read_row_id, hints, stop_row_id, cols, ranges, equals);
+    if (!slice.has_value()) {
+      return std::unique_ptr<schema::RowBatch>(nullptr);
+    }
+    return ReadBatchSlice(slice.value(), cols);
+  }
+
+  /**
+   * NextBatchSlice is the first half of GetNextRowBatch(), that finds the slice of the next row
+   * batch and updates `last_read_row_id` and `hints`, without reading any data. It takes the same
+   * parameters as GetNextRowBatch().
+   * @return the slice to pass to ReadBatchSlice(), or std::nullopt if there are no more rows in
+   * this store.
+   */
+  std::optional<BatchSlice> NextBatchSlice(RowID* last_read_row_id, BatchHints* hints,
+                                           std::optional<RowID> stop_row_id,
+                                           const std::vector<int64_t>& cols,
+                                           const std::vector<ColumnRange>& ranges = {},
+                                           const std::vector<ColumnEquals>& equals = {}) const {
     auto start_row_id = *last_read_row_id + 1;
     if (batches_.empty() || start_row_id < FirstRowID() || start_row_id > LastRowID()) {
-      return std::unique_ptr<schema::RowBatch>(nullptr);
+      return std::nullopt;
     }
     if (DCHECK_IS_ON() && stop_row_id.has_value()) {
       DCHECK_LT(start_row_id, stop_row_id.value());
@@ -108,34 +176,120 @@ class StoreWithRowTimeAccounting {
       batch_id = FindBatchIDFromRowID(start_row_id);
     }
 
-    const auto& batch = GetBatchFromBatchID(batch_id);
+    BatchSlice slice;
+    // Get column types for row descriptor.
+    for (int64_t col_idx : cols) {
+      DCHECK(static_cast<size_t>(col_idx) < rel_.NumColumns());
+      slice.col_types.push_back(rel_.col_types()[col_idx]);
+    }
+
+    // Skip the batches that can't have rows in the ranges, or with the values, without reading
+    // them.
+    while ((!ranges.empty() || !equals.empty()) && !BatchMayMatch(batch_id, ranges, equals)) {
+      RowID batch_last_row_id = BatchLastRowID(batch_id);
+      bool reached_stop = stop_row_id.has_value() && batch_last_row_id >= stop_row_id.value() - 1;
+      *last_read_row_id = reached_stop ? stop_row_id.value() - 1 : batch_last_row_id;
+      if (reached_stop || batch_id == LastBatchID()) {
+        hints->batch_id = batch_id + 1;
+        hints->hint_type = TStoreType;
+        return slice;
+      }
+      ++batch_id;
+      start_row_id = *last_read_row_id + 1;
+    }
+
     RowID batch_first_row_id = BatchFirstRowID(batch_id);
     RowID batch_last_row_id = BatchLastRowID(batch_id);
-    size_t row_offset = start_row_id - batch_first_row_id;
-    size_t batch_size = batch_last_row_id - start_row_id + 1;
+    slice.batch = GetBatchFromBatchID(batch_id);
+    slice.row_offset = start_row_id - batch_first_row_id;
+    slice.num_rows = batch_last_row_id - start_row_id + 1;
     if (stop_row_id.has_value() && batch_last_row_id >= stop_row_id.value()) {
       // Reduce batch size if the batch extends past the given stop row.
-      batch_size -= (batch_last_row_id - stop_row_id.value()) + 1;
-    }
-
-    // Get column types for row descriptor.
-    std::vector<types::DataType> col_types;
-    for (int64_t col_idx : cols) {
-      DCHECK(static_cast<size_t>(col_idx) < rel_.NumColumns());
-      col_types.push_back(rel_.col_types()[col_idx]);
+      slice.num_rows -= (batch_last_row_id - stop_row_id.value()) + 1;
     }
-    auto output_rb =
-        std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
-    PL_RETURN_IF_ERROR(
-        AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, output_rb.get()));
 
     // Update the ptr to the last read row.
-    *last_read_row_id = start_row_id + batch_size - 1;
+    *last_read_row_id = start_row_id + slice.num_rows - 1;
 
     // Set hints to point to the next batch in the current store. It's fine if that batch doesn't
     // exist, as the next call will ignore the hints if that's the case.
     hints->batch_id = batch_id + 1;
     hints->hint_type = TStoreType;
+    return slice;
+  }
+
+  /**
+   * ReadBatchSlice is the second half of GetNextRowBatch(), that reads the given slice into a row
+   * batch. It does not access the store, so it can be called without holding the store's lock.
+   * @param slice, the slice returned by NextBatchSlice().
+   * @param cols, the columns passed to NextBatchSlice().
+   * @param decoded, the reader's decoded columns of the cold batch it last read part of, if any.
+   * Only used by the cold store.
+   * @return a unique_ptr to the RowBatch, or an error Status.
+   */
+  static StatusOr<std::unique_ptr<schema::RowBatch>> ReadBatchSlice(
+      const BatchSlice& slice, const std::vector<int64_t>& cols,
+      DecodedColdBatch* decoded = nullptr) {
+    if (slice.batch == nullptr) {
+      return schema::RowBatch::WithZeroRows(schema::RowDescriptor(slice.col_types),
+                                            /* eow */ false, /* eos */ false);
+    }
+    auto output_rb = std::make_unique<schema::RowBatch>(schema::RowDescriptor(slice.col_types),
+                                                        slice.num_rows);
+    PL_RETURN_IF_ERROR(AddBatchSliceToRowBatch(slice.batch, slice.row_offset, slice.num_rows, cols,
+                                               decoded, output_rb.get()));
+    return output_rb;
+  }
+
+  /**
+   * ReadBatchRows is ReadBatchSlice() for only some of the rows of the slice, e.g. the ones that a
+   * cursor's predicates select. Only the values of these rows are copied, and compressed columns
+   * are not decoded whole for them.
+   * @param slice, a slice returned by NextBatchSlice(), which must not have been skipped.
+   * @param cols, the columns passed to NextBatchSlice().
+   * @param rows, the rows to read, as increasing offsets from the start of the slice.
+   * @param decoded, the reader's decoded columns of the cold batch it last read part of, if any,
+   * which are copied from if they have the columns. Only used by the cold store.
+   * @return a unique_ptr to the RowBatch, or an error Status.
+   */
+  static StatusOr<std::unique_ptr<schema::RowBatch>> ReadBatchRows(
+      const BatchSlice& slice, const std::vector<int64_t>& cols, const std::vector<int64_t>& rows,
+      const DecodedColdBatch* decoded = nullptr) {
+    DCHECK(slice.batch != nullptr);
+    auto output_rb =
+        std::make_unique<schema::RowBatch>(schema::RowDescriptor(slice.col_types), rows.size());
+    const TBatch& batch = *slice.batch;
+    auto* mem_pool = arrow::default_memory_pool();
+    std::vector<int64_t> batch_rows;
+    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      batch_rows = rows;
+      for (auto& row : batch_rows) {
+        row += slice.row_offset;
+      }
+    }
+    for (size_t i = 0; i < cols.size(); ++i) {
+      const int64_t col_idx = cols[i];
+      const types::DataType col_type = slice.col_types[i];
+      ArrowArrayPtr arr;
+      if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+        if (decoded != nullptr && decoded->batch == slice.batch &&
+            decoded->columns[col_idx] != nullptr) {
+          PL_ASSIGN_OR_RETURN(arr, GatherRows(decoded->columns[col_idx].get(), col_type,
+                                              slice.row_offset, rows, mem_pool));
+        } else {
+          PL_ASSIGN_OR_RETURN(arr, batch[col_idx].DecodeRows(batch_rows, col_type, mem_pool));
+        }
+      } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+        PL_ASSIGN_OR_RETURN(arr, GatherRows(batch.columns()[col_idx].get(), col_type,
+                                            slice.row_offset, rows, mem_pool));
+      } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
+        PL_ASSIGN_OR_RETURN(
+            arr, batch.GatherColumnRows(col_idx, col_type, slice.row_offset, rows, mem_pool));
+      } else {
+        constexpr_else_static_assert_false();
+      }
+      PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+    }
     return output_rb;
   }
 
@@ -149,36 +303,60 @@ class StoreWithRowTimeAccounting {
    * front gets a reference to the first batch in the store.
    * @return reference to the first batch in the store.
    */
-  TBatch& front() {
+  const TBatch& front() const {
     DCHECK(!batches_.empty());
-    return batches_.front();
+    return *batches_.front();
+  }
+
+  /**
+   * Batch gets a reference to the batch at the given index, counting from the front of the store.
+   * The reference stays valid after the batch is removed from the store.
+   * @param index, index of the batch, which must be less than Size().
+   * @return shared_ptr to the batch.
+   */
+  std::shared_ptr<const TBatch> Batch(size_t index) const {
+    DCHECK_LT(index, batches_.size());
+    return batches_[index];
+  }
+
+  /**
+   * BatchRowIDs gets the RowIDs of the first and last rows of the batch at the given index,
+   * counting from the front of the store.
+   * @param index, index of the batch, which must be less than Size().
+   * @return interval of the batch's RowIDs.
+   */
+  RowIDInterval BatchRowIDs(size_t index) const {
+    DCHECK_LT(index, batches_.size());
+    return row_ids_[index];
   }
 
   /**
-   * PopFront removes the first batch in the store, and returns an rvalue reference to it.
-   * @return rvalue reference to the removed batch.
+   * PopFront removes the first batch in the store, and returns it.
+   * @return shared_ptr to the removed batch.
    */
-  TBatch&& PopFront() {
+  std::shared_ptr<const TBatch> PopFront() {
     DCHECK(!batches_.empty());
     first_batch_id_++;
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
+    zone_map_.PopFront();
 
-    auto&& front = std::move(batches_.front());
+    auto front = std::move(batches_.front());
     batches_.pop_front();
-    return std::move(front);
+    return front;
   }
 
   /**
    * EmplaceBack creates a batch at the back of the store with the given args, and updates the
    * accounting such that the first RowID of the batch is the given first_row_id.
    * @param first_row_id, unique RowID to use as the first RowID for the emplaced batch.
-   * @return lvalue reference to the emplaced batch.
+   * @return reference to the emplaced batch.
    */
   template <typename... Args>
-  TBatch& EmplaceBack(RowID first_row_id, Args... args) {
-    auto& batch = batches_.emplace_back(std::forward<Args>(args)...);
+  const TBatch& EmplaceBack(RowID first_row_id, Args... args) {
+    const auto& batch =
+        *batches_.emplace_back(std::make_shared<const TBatch>(std::forward<Args>(args)...));
 
     row_ids_.emplace_back(first_row_id, first_row_id + BatchLength(batch) - 1);
     if (time_col_idx_ != -1) {
@@ -186,6 +364,13 @@ class StoreWithRowTimeAccounting {
       auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
       times_.emplace_back(first_time, last_time);
     }
+
+    std::vector<ValueInterval> intervals;
+    intervals.reserve(zone_map_.Columns().size());
+    for (int64_t col_idx : zone_map_.Columns()) {
+      intervals.push_back(GetValueInterval(batch, col_idx));
+    }
+    zone_map_.PushBack(std::move(intervals));
     return batch;
   }
 
@@ -224,7 +409,7 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThanOrEqual(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThanOrEqual(*batches_[batch_index], time);
     return row_ids_[batch_index].first + row_offset;
   }
 
@@ -245,30 +430,35 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThan(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThan(*batches_[batch_index], time);
     return row_ids_[batch_index].first + row_offset;
   }
 
   /**
    * RemovePrefix removes the given number of rows from the first batch in the store. This method is
    * only valid for the `Hot` store, and fails to compile if called on the `Cold` store. Note that
-   * no reallocation or copies occur when removing prefix, instead the HotBatch representation
-   * maintains a row offset internally that is updated when remove prefix is called on it.
+   * the data is not reallocated or copied when removing prefix, instead the HotBatch
+   * representation maintains a row offset internally that is updated when remove prefix is called
+   * on it.
    * @param num_rows, number of rows to remove.
    */
   void RemovePrefix(size_t num_rows) {
     DCHECK(!batches_.empty());
 
     if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      batches_.front().RemovePrefix(num_rows);
+      // Copy on write, since readers may still be reading the batch from before.
+      auto batch = std::make_shared<HotBatch>(*batches_.front());
+      batch->RemovePrefix(num_rows);
+      batches_.front() = std::move(batch);
     } else {
       constexpr_else_static_assert_false();
     }
 
     row_ids_.front().first += num_rows;
     if (time_col_idx_ != -1) {
-      times_.front().first = GetTimeValue(batches_.front(), 0);
+      times_.front().first = GetTimeValue(*batches_.front(), 0);
     }
+    // The zone map interval of the batch is left as is, since it still holds the remaining rows.
   }
 
   /**
@@ -299,16 +489,30 @@ class StoreWithRowTimeAccounting {
     return row_ids_[batch_id - first_batch_id_].second;
   }
 
-  TBatch& GetBatchFromBatchID(BatchID batch_id) {
+  const std::shared_ptr<const TBatch>& GetBatchFromBatchID(BatchID batch_id) const {
     DCHECK_GE(batch_id, first_batch_id_);
     DCHECK_LT(batch_id, first_batch_id_ + batches_.size());
     return batches_[batch_id - first_batch_id_];
   }
 
-  const TBatch& GetBatchFromBatchID(BatchID batch_id) const {
-    DCHECK_GE(batch_id, first_batch_id_);
-    DCHECK_LT(batch_id, first_batch_id_ + batches_.size());
-    return batches_[batch_id - first_batch_id_];
+  bool BatchMayMatch(BatchID batch_id, const std::vector<ColumnRange>& ranges,
+                     const std::vector<ColumnEquals>& equals) const {
+    if (!ranges.empty() && !zone_map_.MayMatch(batch_id - first_batch_id_, ranges)) {
+      return false;
+    }
+    // Only cold batches have bloom filters.
+    if constexpr (TStoreType == StoreType::Cold) {
+      const auto& batch = *GetBatchFromBatchID(batch_id);
+      for (const auto& eq : equals) {
+        DCHECK_LT(static_cast<size_t>(eq.col_idx), batch.size());
+        const auto& col = batch[eq.col_idx];
+        if (std::none_of(eq.values.begin(), eq.values.end(),
+                         [&](const std::string& value) { return col.MayContain(value); })) {
+          return false;
+        }
+      }
+    }
+    return true;
   }
 
   bool BatchHintValid(const BatchHints& hints, RowID row_id) const {
@@ -330,18 +534,29 @@ class StoreWithRowTimeAccounting {
 
   size_t BatchLength(const TBatch& batch) const {
     if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
-    } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
+      return batch[0].length();
+    } else if constexpr (std::is_same_v<HotBatch, TBatch> || std::is_same_v<DiskBatch, TBatch>) {
       return batch.Length();
     } else {
       constexpr_else_static_assert_false();
     }
   }
 
-  size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
+  // The time column of a cold or disk batch.
+  const arrow::Array* TimeArray(const TBatch& batch) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      return batch[time_col_idx_].array().get();
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      return batch.columns()[time_col_idx_].get();
+    } else {
+      constexpr_else_static_assert_false();
+    }
+  }
+
+  size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
+    if constexpr (std::is_same_v<TBatch, ColdBatch> || std::is_same_v<TBatch, DiskBatch>) {
       return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+          TimeArray(batch), time);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
     } else {
@@ -350,9 +565,9 @@ class StoreWithRowTimeAccounting {
   }
 
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
+    if constexpr (std::is_same_v<TBatch, ColdBatch> || std::is_same_v<TBatch, DiskBatch>) {
+      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(TimeArray(batch),
+                                                                               time) +
              1;
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
@@ -362,9 +577,8 @@ class StoreWithRowTimeAccounting {
   }
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
+    if constexpr (std::is_same_v<TBatch, ColdBatch> || std::is_same_v<TBatch, DiskBatch>) {
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(TimeArray(batch), row_idx);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.GetTimeValue(time_col_idx_, row_idx);
     } else {
@@ -372,14 +586,72 @@ class StoreWithRowTimeAccounting {
     }
   }
 
-  Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
-                                 const std::vector<int64_t>& cols,
-                                 schema::RowBatch* output_rb) const {
+  ValueInterval GetValueInterval(const TBatch& batch, int64_t col_idx) const {
+    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      return batch[col_idx].GetValueInterval(rel_.col_types()[col_idx]);
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      return ArrowArrayValueInterval(batch.columns()[col_idx].get(), rel_.col_types()[col_idx]);
+    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
+      return batch.GetValueInterval(col_idx, rel_.col_types()[col_idx]);
+    } else {
+      constexpr_else_static_assert_false();
+    }
+  }
+
+  static Status AddBatchSliceToRowBatch(const std::shared_ptr<const TBatch>& batch_ptr,
+                                        size_t row_offset, size_t batch_size,
+                                        const std::vector<int64_t>& cols,
+                                        DecodedColdBatch* decoded, schema::RowBatch* output_rb) {
+    const TBatch& batch = *batch_ptr;
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      const auto batch_length = static_cast<size_t>(batch.front().length());
+      // Columns are only decoded whole if more of the batch is left to read.
+      bool use_decoded = decoded != nullptr && (row_offset + batch_size < batch_length ||
+                                                decoded->batch == batch_ptr);
+      if (use_decoded && decoded->batch != batch_ptr) {
+        decoded->batch = batch_ptr;
+        decoded->columns.assign(batch.size(), nullptr);
+      }
+      // Whole columns are decoded through the shared decodes, if there are any.
+      auto decode_whole = [&](int64_t col_idx) -> StatusOr<ArrowArrayPtr> {
+        if (decoded != nullptr && decoded->shared != nullptr) {
+          return decoded->shared->GetOrDecode(batch_ptr, col_idx);
+        }
+        const ColdColumn& col = batch[col_idx];
+        return col.DecodeSlice(0, col.length(), arrow::default_memory_pool());
+      };
+      const bool whole_batch = row_offset == 0 && batch_size == batch_length;
       for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
+        // Compressed columns are decoded, so readers only ever see plain arrays. Plain columns are
+        // sliced without copying.
+        const ColdColumn& col = batch[col_idx];
+        ArrowArrayPtr arr;
+        if (use_decoded && col.codec() != ColumnCodec::kPlain) {
+          auto& decoded_col = decoded->columns[col_idx];
+          if (decoded_col == nullptr) {
+            PL_ASSIGN_OR_RETURN(decoded_col, decode_whole(col_idx));
+          }
+          arr = decoded_col->Slice(row_offset, batch_size);
+        } else if (whole_batch && col.codec() != ColumnCodec::kPlain) {
+          PL_ASSIGN_OR_RETURN(arr, decode_whole(col_idx));
+        } else {
+          PL_ASSIGN_OR_RETURN(
+              arr, col.DecodeSlice(row_offset, batch_size, arrow::default_memory_pool()));
+        }
         PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
       }
+      // The decoded columns are dropped once the batch is read to the end, so that an idle cursor
+      // doesn't hold them.
+      if (decoded != nullptr && row_offset + batch_size == batch_length) {
+        decoded->batch.reset();
+        decoded->columns.clear();
+      }
+      return Status::OK();
+    } else if constexpr (std::is_same_v<TBatch, DiskBatch>) {
+      for (auto col_idx : cols) {
+        PL_RETURN_IF_ERROR(
+            output_rb->AddColumn(batch.columns()[col_idx]->Slice(row_offset, batch_size)));
+      }
       return Status::OK();
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
@@ -391,9 +663,10 @@ class StoreWithRowTimeAccounting {
   BatchID first_batch_id_ = 0;
   const schema::Relation& rel_;
   const int64_t time_col_idx_;
-  std::deque<TBatch> batches_;
+  std::deque<std::shared_ptr<const TBatch>> batches_;
   std::deque<RowIDInterval> row_ids_;
   std::deque<TimeInterval> times_;
+  ZoneMap zone_map_;
 };
 
 }  // namespace internal
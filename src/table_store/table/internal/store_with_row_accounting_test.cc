@@ -29,6 +29,8 @@ namespace internal {
 
 class ColdStoreTest : public ::testing::Test {
  protected:
+  using Store = StoreWithRowTimeAccounting<StoreType::Cold>;
+
   void SetUp() override {
     rel_ = std::make_unique<schema::Relation>(
         std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::BOOLEAN,
@@ -47,17 +49,108 @@ class ColdStoreTest : public ::testing::Test {
     return rb;
   }
 
+  // An uncompressed cold batch of the row batch's columns.
+  ColdBatch ToColdBatch(const schema::RowBatch& rb) {
+    auto cols = rb.columns();
+    return ColdBatch(cols.begin(), cols.end());
+  }
+
   std::unique_ptr<schema::Relation> rel_;
   std::unique_ptr<StoreWithRowTimeAccounting<StoreType::Cold>> store_;
 };
 
+TEST_F(ColdStoreTest, SkipBatchesOutsideOfColumnRanges) {
+  auto rb0 = MakeRowBatch({1, 2}, {true, false}, {"a", "b"});
+  auto rb1 = MakeRowBatch({10, 11}, {true, false}, {"c", "d"});
+  auto rb2 = MakeRowBatch({20, 21}, {true, false}, {"e", "f"});
+  store_->EmplaceBack(0, ToColdBatch(rb0));
+  store_->EmplaceBack(2, ToColdBatch(rb1));
+  store_->EmplaceBack(4, ToColdBatch(rb2));
+
+  std::vector<ColumnRange> ranges = {{0, 10, 15}};
+  RowID last_read_row_id = -1;
+  BatchHints hints{};
+  auto rb = store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt, {0, 1}, ranges)
+                .ConsumeValueOrDie();
+  ASSERT_NE(nullptr, rb);
+  EXPECT_EQ(2, rb->num_rows());
+  EXPECT_EQ(3, last_read_row_id);
+
+  // The last batch is skipped as well, which leaves a zero row batch.
+  rb = store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt, {0, 1}, ranges)
+           .ConsumeValueOrDie();
+  ASSERT_NE(nullptr, rb);
+  EXPECT_EQ(0, rb->num_rows());
+  EXPECT_EQ(2, rb->num_columns());
+  EXPECT_EQ(5, last_read_row_id);
+
+  // Skipping stops at the stop row.
+  last_read_row_id = 1;
+  rb = store_->GetNextRowBatch(&last_read_row_id, &hints, 5, {0}, {{0, 20, 30}})
+           .ConsumeValueOrDie();
+  ASSERT_NE(nullptr, rb);
+  EXPECT_EQ(1, rb->num_rows());
+  EXPECT_EQ(4, last_read_row_id);
+
+  // Ranges on columns that are not zone mapped don't skip anything.
+  last_read_row_id = -1;
+  rb = store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt, {0}, {{1, 10, 15}})
+           .ConsumeValueOrDie();
+  ASSERT_NE(nullptr, rb);
+  EXPECT_EQ(2, rb->num_rows());
+  EXPECT_EQ(1, last_read_row_id);
+}
+
+TEST_F(ColdStoreTest, PartialReadsDecodeCompressedColumnsOnce) {
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::BoolValue> bools;
+  std::vector<types::StringValue> strings;
+  for (int i = 0; i < 100; ++i) {
+    times.push_back(i);
+    bools.push_back(i % 2 == 0);
+    strings.push_back("a repetitive string value");
+  }
+  auto rb = MakeRowBatch(times, bools, strings);
+  ColdBatch batch = ToColdBatch(rb);
+  ASSERT_OK_AND_ASSIGN(batch[2], ColdColumn::Encode(rb.ColumnAt(2), types::DataType::STRING,
+                                                    types::PatternType::GENERAL,
+                                                    arrow::default_memory_pool()));
+  ASSERT_EQ(ColumnCodec::kDeflate, batch[2].codec());
+  store_->EmplaceBack(0, std::move(batch));
+
+  RowID last_read_row_id = -1;
+  BatchHints hints{};
+  DecodedColdBatch decoded;
+  auto slice = store_->NextBatchSlice(&last_read_row_id, &hints, 40, {0, 2}, {});
+  ASSERT_TRUE(slice.has_value());
+  ASSERT_OK_AND_ASSIGN(auto out, Store::ReadBatchSlice(*slice, {0, 2}, &decoded));
+  EXPECT_EQ(40, out->num_rows());
+  EXPECT_TRUE(out->ColumnAt(1)->Equals(rb.ColumnAt(2)->Slice(0, 40)));
+  // Only the compressed column is kept decoded. The time column is sliced from the batch.
+  EXPECT_EQ(slice->batch, decoded.batch);
+  EXPECT_EQ(nullptr, decoded.columns[0]);
+  ASSERT_NE(nullptr, decoded.columns[2]);
+  EXPECT_EQ(out->ColumnAt(1)->data()->buffers[2], decoded.columns[2]->data()->buffers[2]);
+
+  slice = store_->NextBatchSlice(&last_read_row_id, &hints, std::nullopt, {0, 2}, {});
+  ASSERT_TRUE(slice.has_value());
+  ASSERT_OK_AND_ASSIGN(out, Store::ReadBatchSlice(*slice, {0, 2}, &decoded));
+  EXPECT_EQ(60, out->num_rows());
+  EXPECT_TRUE(out->ColumnAt(1)->Equals(rb.ColumnAt(2)->Slice(40, 60)));
+  // Reading to the end of the batch drops the decoded columns.
+  EXPECT_EQ(nullptr, decoded.batch);
+  EXPECT_TRUE(decoded.columns.empty());
+}
+
 class HotStoreTest : public RecordOrRowBatchParamTest {
  protected:
+  using HotStore = StoreWithRowTimeAccounting<StoreType::Hot>;
+
   void SetUp() override {
     RecordOrRowBatchParamTest::SetUp();
-    store_ = std::make_unique<StoreWithRowTimeAccounting<StoreType::Hot>>(*rel_, 0);
+    store_ = std::make_unique<HotStore>(*rel_, 0);
   }
-  std::unique_ptr<StoreWithRowTimeAccounting<StoreType::Hot>> store_;
+  std::unique_ptr<HotStore> store_;
 };
 
 TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
@@ -68,7 +161,7 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
 
   EXPECT_EQ(0, store_->Size());
 
-  store_->EmplaceBack(0, rb0.columns());
+  store_->EmplaceBack(0, ToColdBatch(rb0));
   auto next_row_id = 4;
   EXPECT_EQ(1, store_->Size());
 
@@ -93,7 +186,7 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
   strings = {"", "", ""};
   auto rb1 = MakeRowBatch(times, bools, strings);
 
-  store_->EmplaceBack(next_row_id, rb1.columns());
+  store_->EmplaceBack(next_row_id, ToColdBatch(rb1));
   EXPECT_EQ(2, store_->Size());
 
   EXPECT_EQ(0, store_->FirstRowID());
@@ -218,6 +311,32 @@ TEST_P(HotStoreTest, RemovePrefix) {
   EXPECT_EQ(2, optional_row_id.value());
 }
 
+TEST_P(HotStoreTest, BatchSliceOutlivesStoreChanges) {
+  std::vector<types::Time64NSValue> times = {1, 1, 10, 11};
+  std::vector<types::BoolValue> bools = {true, false, true, false};
+  std::vector<types::StringValue> strings = {"ab", "cd", "ef", "gh"};
+  auto [rb0, _] = MakeRecordOrRowBatch(times, bools, strings);
+  store_->EmplaceBack(0, std::move(*rb0));
+
+  RowID last_read_row_id = 0;
+  BatchHints hints{};
+  auto slice = store_->NextBatchSlice(&last_read_row_id, &hints, std::nullopt, {0, 2});
+  ASSERT_TRUE(slice.has_value());
+  EXPECT_EQ(3, last_read_row_id);
+
+  // Neither removing rows from the batch nor removing the batch changes the slice taken before.
+  store_->RemovePrefix(2);
+  store_->PopFront();
+  EXPECT_EQ(0, store_->Size());
+
+  ASSERT_OK_AND_ASSIGN(auto rb, HotStore::ReadBatchSlice(slice.value(), {0, 2}));
+  ASSERT_EQ(3, rb->num_rows());
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Time64NSValue>{1, 10, 11},
+                                                     arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"cd", "ef", "gh"}, arrow::default_memory_pool())));
+}
+
 INSTANTIATE_RECORD_OR_ROW_BATCH_TESTSUITE(HotStore, HotStoreTest, /*include_mixed*/ true);
 
 }  // namespace internal
@@ -53,6 +53,7 @@ struct RecordBatchWithCache {
 enum StoreType {
   Hot,
   Cold,
+  Disk,
 };
 
 struct BatchHints {
@@ -62,7 +63,11 @@ struct BatchHints {
 
 class RecordOrRowBatch;
 
-using ColdBatch = std::vector<ArrowArrayPtr>;
+// A cold batch has a (possibly compressed) ColdColumn per column, see column_codec.h.
+class ColdColumn;
+using ColdBatch = std::vector<ColdColumn>;
+
+class DiskBatch;
 
 template <StoreType type>
 struct StoreTypeTraits {};
@@ -74,6 +79,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Disk> {
+  using batch_type = DiskBatch;
+};
 
 }  // namespace internal
 }  // namespace table_store
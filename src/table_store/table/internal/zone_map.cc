@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/zone_map.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+template <types::DataType T>
+ValueInterval ArrowArrayValueIntervalImpl(const arrow::Array* arr) {
+  ValueInterval interval{std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    int64_t val = types::GetValueFromArrowArray<T>(arr, i);
+    interval.first = std::min(interval.first, val);
+    interval.second = std::max(interval.second, val);
+  }
+  return interval;
+}
+
+}  // namespace
+
+ValueInterval ArrowArrayValueInterval(const arrow::Array* arr, types::DataType type) {
+  DCHECK(IsZoneMapped(type));
+  if (type == types::DataType::TIME64NS) {
+    return ArrowArrayValueIntervalImpl<types::DataType::TIME64NS>(arr);
+  }
+  return ArrowArrayValueIntervalImpl<types::DataType::INT64>(arr);
+}
+
+ZoneMap::ZoneMap(const schema::Relation& rel) : col_positions_(rel.NumColumns(), -1) {
+  for (size_t i = 0; i < rel.NumColumns(); ++i) {
+    if (IsZoneMapped(rel.GetColumnType(i))) {
+      col_positions_[i] = cols_.size();
+      cols_.push_back(i);
+    }
+  }
+}
+
+void ZoneMap::PushBack(std::vector<ValueInterval> intervals) {
+  DCHECK_EQ(intervals.size(), cols_.size());
+  intervals_.push_back(std::move(intervals));
+}
+
+void ZoneMap::PopFront() {
+  DCHECK(!intervals_.empty());
+  intervals_.pop_front();
+}
+
+bool ZoneMap::MayMatch(size_t batch_index, const std::vector<ColumnRange>& ranges) const {
+  DCHECK_LT(batch_index, intervals_.size());
+  const auto& intervals = intervals_[batch_index];
+  for (const auto& range : ranges) {
+    if (range.col_idx < 0 || static_cast<size_t>(range.col_idx) >= col_positions_.size() ||
+        col_positions_[range.col_idx] == -1) {
+      continue;
+    }
+    const auto& [min, max] = intervals[col_positions_[range.col_idx]];
+    if (max < range.min || min > range.max) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
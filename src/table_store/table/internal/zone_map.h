@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <deque>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/relation.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// The minimum and maximum value of a column within a batch.
+using ValueInterval = std::pair<int64_t, int64_t>;
+
+/**
+ * ColumnRange is an inclusive range of values of a column. Batches whose zone map shows that none
+ * of their rows are in the range can be skipped.
+ */
+struct ColumnRange {
+  int64_t col_idx;
+  int64_t min = std::numeric_limits<int64_t>::min();
+  int64_t max = std::numeric_limits<int64_t>::max();
+};
+
+/**
+ * ColumnEquals is a set of values of a STRING column. Cold batches whose bloom filter on the
+ * column shows that none of their rows have any of the values can be skipped, see
+ * ColdColumn::MayContain().
+ */
+struct ColumnEquals {
+  int64_t col_idx;
+  std::vector<std::string> values;
+};
+
+/**
+ * IsZoneMapped returns whether columns of the given type are tracked by ZoneMap.
+ */
+inline bool IsZoneMapped(types::DataType type) {
+  return type == types::DataType::INT64 || type == types::DataType::TIME64NS;
+}
+
+/**
+ * ArrowArrayValueInterval returns the minimum and maximum value of an INT64 or TIME64NS array.
+ */
+ValueInterval ArrowArrayValueInterval(const arrow::Array* arr, types::DataType type);
+
+/**
+ * ZoneMap keeps the minimum and maximum value of every INT64 and TIME64NS column for each batch
+ * of a store, so that batches can be skipped by value without reading them. Intervals are pushed
+ * and popped in the same order as the store's batches.
+ *
+ * An interval only has to contain the values of its batch, so it stays valid when rows are removed
+ * from the front of a batch.
+ */
+class ZoneMap {
+ public:
+  explicit ZoneMap(const schema::Relation& rel);
+
+  /**
+   * Columns returns the indices of the zone mapped columns, in the order that PushBack() expects
+   * their intervals.
+   */
+  const std::vector<int64_t>& Columns() const { return cols_; }
+
+  void PushBack(std::vector<ValueInterval> intervals);
+  void PopFront();
+
+  /**
+   * MayMatch returns false if the batch at the given index has no row in all of the given ranges.
+   * Ranges on columns that are not zone mapped are ignored.
+   */
+  bool MayMatch(size_t batch_index, const std::vector<ColumnRange>& ranges) const;
+
+ private:
+  std::vector<int64_t> cols_;
+  // For each column of the relation, its position in cols_, or -1 if it isn't zone mapped.
+  std::vector<int64_t> col_positions_;
+  std::deque<std::vector<ValueInterval>> intervals_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/array.h>
+
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(ZoneMapTest, MayMatch) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING, types::DataType::INT64},
+                       {"time_", "req_path", "latency"});
+  ZoneMap zone_map(rel);
+  EXPECT_THAT(zone_map.Columns(), ::testing::ElementsAre(0, 2));
+
+  zone_map.PushBack({{1, 10}, {100, 200}});
+  zone_map.PushBack({{11, 20}, {5, 50}});
+
+  EXPECT_TRUE(zone_map.MayMatch(0, {}));
+  EXPECT_TRUE(zone_map.MayMatch(0, {{2, 150}}));
+  EXPECT_FALSE(zone_map.MayMatch(1, {{2, 150}}));
+  EXPECT_TRUE(zone_map.MayMatch(1, {{2, 0, 5}}));
+  EXPECT_FALSE(zone_map.MayMatch(0, {{0, 11}, {2, 150}}));
+  EXPECT_TRUE(zone_map.MayMatch(1, {{0, 11}, {2, 0, 5}}));
+
+  // Ranges on the string column, or on columns that don't exist, are ignored.
+  EXPECT_TRUE(zone_map.MayMatch(1, {{1, 150}, {7, 150}}));
+
+  zone_map.PopFront();
+  EXPECT_FALSE(zone_map.MayMatch(0, {{2, 150}}));
+}
+
+TEST(ZoneMapTest, ArrowArrayValueInterval) {
+  std::vector<types::Int64Value> vals = {5, -3, 12, 7};
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(ValueInterval(-3, 12), ArrowArrayValueInterval(arr.get(), types::DataType::INT64));
+  EXPECT_EQ(ValueInterval(12, 12),
+            ArrowArrayValueInterval(arr->Slice(2, 1).get(), types::DataType::INT64));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
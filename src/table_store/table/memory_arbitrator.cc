@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/memory_arbitrator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace table_store {
+
+namespace {
+// The weight of the latest ingest rate in the moving average.
+constexpr double kIngestRateAlpha = 0.3;
+}  // namespace
+
+void MemoryArbitrator::AddTable(std::shared_ptr<Table> table, RetentionPolicy policy) {
+  int64_t bytes_added = table->GetTableStats().bytes_added;
+  tables_.push_back({std::move(table), policy, bytes_added, std::nullopt});
+}
+
+void MemoryArbitrator::Rebalance(std::chrono::steady_clock::time_point now) {
+  std::optional<double> elapsed_s;
+  if (last_rebalance_.has_value() && now > last_rebalance_.value()) {
+    elapsed_s = std::chrono::duration<double>(now - last_rebalance_.value()).count();
+  }
+  last_rebalance_ = now;
+
+  // Reserve the bytes for each table's minimum window.
+  std::vector<double> reserved(tables_.size(), 0);
+  double total_reserved = 0;
+  for (auto&& [i, t] : Enumerate(tables_)) {
+    int64_t bytes_added = t.table->GetTableStats().bytes_added;
+    if (elapsed_s.has_value()) {
+      double rate = (bytes_added - t.bytes_added) / elapsed_s.value();
+      t.ingest_bytes_per_s = t.ingest_bytes_per_s.has_value()
+                                 ? kIngestRateAlpha * rate +
+                                       (1 - kIngestRateAlpha) * t.ingest_bytes_per_s.value()
+                                 : rate;
+    }
+    t.bytes_added = bytes_added;
+
+    double window_s = std::chrono::duration<double>(t.policy.min_window).count();
+    reserved[i] = t.ingest_bytes_per_s.value_or(0) * window_s;
+    if (t.policy.max_bytes > 0) {
+      reserved[i] = std::min<double>(reserved[i], t.policy.max_bytes);
+    }
+    total_reserved += reserved[i];
+  }
+  if (total_reserved > total_bytes_) {
+    for (auto& r : reserved) {
+      r *= total_bytes_ / total_reserved;
+    }
+    total_reserved = total_bytes_;
+  }
+
+  // Share out the rest by weight. Tables that reach their max_bytes drop out, and the memory they
+  // would have gotten is shared between the others.
+  std::vector<double> budgets = reserved;
+  double remaining = total_bytes_ - total_reserved;
+  std::vector<size_t> open;
+  for (const auto& [i, t] : Enumerate(tables_)) {
+    if (t.policy.weight > 0 && (t.policy.max_bytes == 0 || budgets[i] < t.policy.max_bytes)) {
+      open.push_back(i);
+    }
+  }
+  while (remaining > 0 && !open.empty()) {
+    double total_weight = 0;
+    for (size_t i : open) {
+      total_weight += tables_[i].policy.weight;
+    }
+    std::vector<size_t> still_open;
+    double capped_bytes = 0;
+    for (size_t i : open) {
+      const auto& policy = tables_[i].policy;
+      double share = remaining * policy.weight / total_weight;
+      if (policy.max_bytes > 0 && budgets[i] + share >= policy.max_bytes) {
+        capped_bytes += policy.max_bytes - budgets[i];
+        budgets[i] = policy.max_bytes;
+      } else {
+        still_open.push_back(i);
+      }
+    }
+    if (still_open.size() == open.size()) {
+      for (size_t i : open) {
+        budgets[i] += remaining * tables_[i].policy.weight / total_weight;
+      }
+      break;
+    }
+    remaining -= capped_bytes;
+    open = std::move(still_open);
+  }
+
+  for (const auto& [i, t] : Enumerate(tables_)) {
+    auto budget = std::max(min_table_bytes_, static_cast<int64_t>(budgets[i]));
+    t.table->SetMaxTableSize(budget, std::min(budget, static_cast<int64_t>(reserved[i])));
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * RetentionPolicy is how a MemoryArbitrator decides how much memory a table gets.
+ */
+struct RetentionPolicy {
+  // The table is first given the memory to hold this much history, estimated from how fast it
+  // ingests data, before the rest of the memory is shared out by weight.
+  std::chrono::nanoseconds min_window = std::chrono::nanoseconds(0);
+  // The most memory the table is given. No limit if 0.
+  int64_t max_bytes = 0;
+  // The table's share of the memory left after the reservations, relative to the other tables.
+  double weight = 1.0;
+};
+
+/**
+ * MemoryArbitrator splits a memory budget between tables, and periodically rebalances it as their
+ * ingest rates change, by setting each table's maximum size.
+ *
+ * Each rebalance first reserves for every table the bytes it ingests over its policy's min_window
+ * (scaled down evenly if the reservations don't all fit), so that a burst in one table does not
+ * expire the recent history of another. The remaining memory is then split by weight, without
+ * giving any table more than its max_bytes.
+ *
+ * Not thread-safe. Tables themselves may be written and read while being rebalanced.
+ */
+class MemoryArbitrator : public NotCopyable {
+ public:
+  // No table gets a smaller budget than this, so that it can always hold a batch.
+  static constexpr int64_t kDefaultMinTableBytes = 1024 * 1024;
+
+  explicit MemoryArbitrator(int64_t total_bytes, int64_t min_table_bytes = kDefaultMinTableBytes)
+      : total_bytes_(total_bytes), min_table_bytes_(min_table_bytes) {}
+
+  /**
+   * AddTable adds a table to be given a share of the memory from the next Rebalance().
+   */
+  void AddTable(std::shared_ptr<Table> table, RetentionPolicy policy);
+
+  /**
+   * Rebalance updates the ingest rates of the tables since the last call, and sets their maximum
+   * sizes from them. The first call has no ingest rates yet, so only shares memory by weight.
+   * @param now the current time, for the ingest rates.
+   */
+  void Rebalance(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+  /**
+   * SetTotalBytes changes the memory shared between the tables, from the next Rebalance().
+   */
+  void SetTotalBytes(int64_t total_bytes) { total_bytes_ = total_bytes; }
+
+ private:
+  struct ArbitratedTable {
+    std::shared_ptr<Table> table;
+    RetentionPolicy policy;
+    int64_t bytes_added = 0;
+    // An exponentially weighted moving average, so that a single burst doesn't swing budgets.
+    std::optional<double> ingest_bytes_per_s;
+  };
+
+  int64_t total_bytes_;
+  const int64_t min_table_bytes_;
+  std::vector<ArbitratedTable> tables_;
+  std::optional<std::chrono::steady_clock::time_point> last_rebalance_;
+};
+
+}  // namespace table_store
+}  // namespace px
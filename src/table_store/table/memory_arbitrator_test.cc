@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/memory_arbitrator.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+std::shared_ptr<Table> TestTable() {
+  return Table::Create("test_table", schema::Relation({types::DataType::INT64}, {"col1"}));
+}
+
+// Writes 10 INT64 rows, or 80 bytes.
+void WriteRows(Table* table) {
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::INT64}), 10);
+  std::vector<types::Int64Value> col1(10, 1);
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_OK(table->WriteRowBatch(rb));
+}
+
+}  // namespace
+
+TEST(MemoryArbitratorTest, splits_by_weight) {
+  auto t1 = TestTable();
+  auto t2 = TestTable();
+  MemoryArbitrator arbitrator(1000, /*min_table_bytes*/ 0);
+  arbitrator.AddTable(t1, {.weight = 3});
+  arbitrator.AddTable(t2, {.weight = 1});
+
+  arbitrator.Rebalance();
+  EXPECT_EQ(750, t1->GetTableStats().max_table_size);
+  EXPECT_EQ(250, t2->GetTableStats().max_table_size);
+}
+
+TEST(MemoryArbitratorTest, reserves_min_window_from_ingest_rate) {
+  auto t1 = TestTable();
+  auto t2 = TestTable();
+  MemoryArbitrator arbitrator(1000, /*min_table_bytes*/ 0);
+  arbitrator.AddTable(t1, {.min_window = std::chrono::seconds(5)});
+  arbitrator.AddTable(t2, {});
+
+  auto now = std::chrono::steady_clock::now();
+  arbitrator.Rebalance(now);
+  EXPECT_EQ(500, t1->GetTableStats().max_table_size);
+  EXPECT_EQ(0, t1->GetTableStats().reserved_bytes);
+
+  // 80 bytes/s for 5s are reserved, and the rest is split evenly.
+  WriteRows(t1.get());
+  arbitrator.Rebalance(now + std::chrono::seconds(1));
+  EXPECT_EQ(700, t1->GetTableStats().max_table_size);
+  EXPECT_EQ(400, t1->GetTableStats().reserved_bytes);
+  EXPECT_EQ(300, t2->GetTableStats().max_table_size);
+}
+
+TEST(MemoryArbitratorTest, max_bytes_caps_share) {
+  auto t1 = TestTable();
+  auto t2 = TestTable();
+  MemoryArbitrator arbitrator(1000, /*min_table_bytes*/ 0);
+  arbitrator.AddTable(t1, {});
+  arbitrator.AddTable(t2, {.max_bytes = 200});
+
+  arbitrator.Rebalance();
+  EXPECT_EQ(800, t1->GetTableStats().max_table_size);
+  EXPECT_EQ(200, t2->GetTableStats().max_table_size);
+}
+
+TEST(MemoryArbitratorTest, scales_down_reservations_that_dont_fit) {
+  auto t1 = TestTable();
+  auto t2 = TestTable();
+  MemoryArbitrator arbitrator(1000, /*min_table_bytes*/ 0);
+  arbitrator.AddTable(t1, {.min_window = std::chrono::seconds(100)});
+  arbitrator.AddTable(t2, {.min_window = std::chrono::seconds(100)});
+
+  auto now = std::chrono::steady_clock::now();
+  arbitrator.Rebalance(now);
+  WriteRows(t1.get());
+  WriteRows(t2.get());
+  WriteRows(t2.get());
+  WriteRows(t2.get());
+  arbitrator.Rebalance(now + std::chrono::seconds(1));
+  EXPECT_EQ(250, t1->GetTableStats().max_table_size);
+  EXPECT_EQ(750, t2->GetTableStats().max_table_size);
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/rollup.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+template <typename T>
+void AppendBytes(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T ReadBytes(std::string_view* in) {
+  T value;
+  std::memcpy(&value, in->data(), sizeof(value));
+  in->remove_prefix(sizeof(value));
+  return value;
+}
+
+double GetDouble(const arrow::Array* arr, types::DataType type, int64_t idx) {
+  switch (type) {
+    case types::DataType::INT64:
+      return types::GetValueFromArrowArray<types::DataType::INT64>(arr, idx);
+    case types::DataType::TIME64NS:
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(arr, idx);
+    case types::DataType::FLOAT64:
+      return types::GetValueFromArrowArray<types::DataType::FLOAT64>(arr, idx);
+    default:
+      DCHECK(false) << "Unsupported value column type";
+      return 0;
+  }
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<Rollup>> Rollup::Create(std::shared_ptr<Table> source, RollupSpec spec) {
+  if (spec.interval.count() <= 0) {
+    return error::InvalidArgument("The rollup interval must be positive.");
+  }
+  schema::Relation source_rel = source->GetRelation();
+  if (!source_rel.HasColumn("time_") ||
+      source_rel.GetColumnType("time_") != types::DataType::TIME64NS) {
+    return error::InvalidArgument("Only tables with a time_ column can be rolled up.");
+  }
+
+  auto rollup = std::unique_ptr<Rollup>(new Rollup(std::move(source), std::move(spec)));
+  rollup->source_cols_.push_back(source_rel.GetColumnIndex("time_"));
+  rollup->relation_.AddColumn(types::DataType::TIME64NS, "time_");
+  for (const auto& col_name : rollup->spec_.group_by_cols) {
+    if (!source_rel.HasColumn(col_name)) {
+      return error::InvalidArgument("Table has no column '$0'.", col_name);
+    }
+    auto type = source_rel.GetColumnType(col_name);
+    if (type != types::DataType::STRING && type != types::DataType::INT64 &&
+        type != types::DataType::BOOLEAN && type != types::DataType::UINT128) {
+      return error::InvalidArgument("Rollups can't group by '$0' of type $1.", col_name,
+                                    types::ToString(type));
+    }
+    rollup->source_cols_.push_back(source_rel.GetColumnIndex(col_name));
+    rollup->group_types_.push_back(type);
+    rollup->relation_.AddColumn(type, col_name);
+  }
+  rollup->relation_.AddColumn(types::DataType::INT64, "count");
+  for (const auto& col_name : rollup->spec_.value_cols) {
+    if (!source_rel.HasColumn(col_name)) {
+      return error::InvalidArgument("Table has no column '$0'.", col_name);
+    }
+    auto type = source_rel.GetColumnType(col_name);
+    if (type != types::DataType::INT64 && type != types::DataType::FLOAT64 &&
+        type != types::DataType::TIME64NS) {
+      return error::InvalidArgument("Rollups can't aggregate '$0' of type $1.", col_name,
+                                    types::ToString(type));
+    }
+    rollup->source_cols_.push_back(source_rel.GetColumnIndex(col_name));
+    rollup->value_types_.push_back(type);
+    for (const auto& suffix : {"_sum", "_min", "_max"}) {
+      rollup->relation_.AddColumn(types::DataType::FLOAT64, absl::StrCat(col_name, suffix));
+    }
+  }
+  return rollup;
+}
+
+Status Rollup::Update(Table* rollup_table) {
+  Table::Cursor::StartSpec start;
+  start.type = Table::Cursor::StartSpec::AfterRowID;
+  start.row_id = last_read_row_id_;
+  Table::Cursor cursor(source_.get(), start, Table::Cursor::StopSpec{});
+  while (!cursor.Done()) {
+    PL_ASSIGN_OR_RETURN(auto rb, cursor.GetNextRowBatch(source_cols_));
+    AddRows(*rb);
+  }
+  last_read_row_id_ = std::max(last_read_row_id_, cursor.last_read_row_id());
+
+  // A bucket is complete once a row more than an interval past its end has been seen.
+  const int64_t interval = spec_.interval.count();
+  if (max_time_ < std::numeric_limits<int64_t>::min() + 2 * interval) {
+    return Status::OK();
+  }
+  return WriteBuckets(max_time_ - 2 * interval, rollup_table);
+}
+
+void Rollup::AddRows(const schema::RowBatch& rb) {
+  const int64_t interval = spec_.interval.count();
+  const arrow::Array* times = rb.ColumnAt(0).get();
+  const size_t first_value_col = 1 + group_types_.size();
+  for (int64_t i = 0; i < rb.num_rows(); ++i) {
+    int64_t time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(times, i);
+    int64_t bucket_start = time - ((time % interval) + interval) % interval;
+    if (bucket_start < written_until_) {
+      ++late_rows_;
+      continue;
+    }
+    max_time_ = std::max(max_time_, time);
+
+    Aggregates& aggs = buckets_[bucket_start][EncodeGroup(rb, i)];
+    if (aggs.count == 0) {
+      aggs.sums.assign(value_types_.size(), 0);
+      aggs.mins.assign(value_types_.size(), std::numeric_limits<double>::max());
+      aggs.maxs.assign(value_types_.size(), std::numeric_limits<double>::lowest());
+    }
+    ++aggs.count;
+    for (const auto& [v, type] : Enumerate(value_types_)) {
+      double value = GetDouble(rb.ColumnAt(first_value_col + v).get(), type, i);
+      aggs.sums[v] += value;
+      aggs.mins[v] = std::min(aggs.mins[v], value);
+      aggs.maxs[v] = std::max(aggs.maxs[v], value);
+    }
+  }
+}
+
+std::string Rollup::EncodeGroup(const schema::RowBatch& rb, int64_t row_idx) const {
+  std::string group;
+  for (const auto& [g, type] : Enumerate(group_types_)) {
+    const arrow::Array* arr = rb.ColumnAt(1 + g).get();
+    switch (type) {
+      case types::DataType::STRING: {
+        auto value = types::GetStringViewFromArrowArray(arr, row_idx);
+        AppendBytes<uint32_t>(value.size(), &group);
+        group.append(value);
+        break;
+      }
+      case types::DataType::INT64:
+        AppendBytes(types::GetValueFromArrowArray<types::DataType::INT64>(arr, row_idx), &group);
+        break;
+      case types::DataType::BOOLEAN:
+        AppendBytes(types::GetValueFromArrowArray<types::DataType::BOOLEAN>(arr, row_idx), &group);
+        break;
+      case types::DataType::UINT128: {
+        absl::uint128 value = types::GetValueFromArrowArray<types::DataType::UINT128>(arr, row_idx);
+        AppendBytes(absl::Uint128High64(value), &group);
+        AppendBytes(absl::Uint128Low64(value), &group);
+        break;
+      }
+      default:
+        DCHECK(false) << "Unsupported group by column type";
+    }
+  }
+  return group;
+}
+
+Status Rollup::WriteBuckets(int64_t before, Table* rollup_table) {
+  // Rows of the buckets before this one are late from now on, whether or not the bucket had any.
+  written_until_ = std::max(written_until_, before);
+  auto end = buckets_.lower_bound(before);
+  if (end == buckets_.begin()) {
+    return Status::OK();
+  }
+  size_t num_rows = 0;
+  for (auto it = buckets_.begin(); it != end; ++it) {
+    num_rows += it->second.size();
+  }
+
+  auto record_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  for (const auto& type : relation_.col_types()) {
+    auto col = types::ColumnWrapper::Make(type, 0);
+    col->Reserve(num_rows);
+    record_batch->push_back(std::move(col));
+  }
+  auto& cols = *record_batch;
+  for (auto it = buckets_.begin(); it != end; ++it) {
+    for (const auto& [group, aggs] : it->second) {
+      size_t col_idx = 0;
+      cols[col_idx++]->Append<types::Time64NSValue>(it->first);
+      std::string_view encoded = group;
+      for (const auto& type : group_types_) {
+        auto& col = cols[col_idx++];
+        switch (type) {
+          case types::DataType::STRING: {
+            auto size = ReadBytes<uint32_t>(&encoded);
+            col->Append<types::StringValue>(std::string(encoded.substr(0, size)));
+            encoded.remove_prefix(size);
+            break;
+          }
+          case types::DataType::INT64:
+            col->Append<types::Int64Value>(ReadBytes<int64_t>(&encoded));
+            break;
+          case types::DataType::BOOLEAN:
+            col->Append<types::BoolValue>(ReadBytes<bool>(&encoded));
+            break;
+          case types::DataType::UINT128: {
+            auto high = ReadBytes<uint64_t>(&encoded);
+            auto low = ReadBytes<uint64_t>(&encoded);
+            col->Append<types::UInt128Value>(types::UInt128Value(high, low));
+            break;
+          }
+          default:
+            DCHECK(false) << "Unsupported group by column type";
+        }
+      }
+      cols[col_idx++]->Append<types::Int64Value>(aggs.count);
+      for (size_t v = 0; v < value_types_.size(); ++v) {
+        cols[col_idx++]->Append<types::Float64Value>(aggs.sums[v]);
+        cols[col_idx++]->Append<types::Float64Value>(aggs.mins[v]);
+        cols[col_idx++]->Append<types::Float64Value>(aggs.maxs[v]);
+      }
+    }
+  }
+  buckets_.erase(buckets_.begin(), end);
+  return rollup_table->TransferRecordBatch(std::move(record_batch));
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * RollupSpec configures a Rollup.
+ */
+struct RollupSpec {
+  // The width of the time buckets that rows are aggregated over.
+  std::chrono::nanoseconds interval = std::chrono::seconds(10);
+  // The STRING, INT64, BOOLEAN or UINT128 columns that rows are grouped by within a bucket.
+  std::vector<std::string> group_by_cols;
+  // The INT64, FLOAT64 or TIME64NS columns whose sum, min and max are kept for each group.
+  std::vector<std::string> value_cols;
+};
+
+/**
+ * Rollup continuously aggregates a table into a much smaller rollup table, e.g. the requests of
+ * each process and status code in http_events per 10s, so that dashboards can read the rollup
+ * instead of aggregating the raw rows on every query, and so that the rollup can keep far more
+ * history than the raw table within the same memory.
+ *
+ * Each call to Update() aggregates the rows written to the source table since the last call into
+ * time buckets, and writes the buckets that are complete to the rollup table. A rollup row holds
+ * the bucket's start as time_, the group's values, the number of rows as count, and <col>_sum,
+ * <col>_min and <col>_max for each value column. The rollup table is an ordinary table, with its
+ * own size limit, so queries read it like any other.
+ *
+ * Rows arrive a little out of time order, so a bucket is only written once the source has a row
+ * more than an interval past the bucket's end. Rows of buckets that were already written are
+ * dropped, and counted as late.
+ *
+ * Not thread-safe.
+ */
+class Rollup : public NotCopyable {
+ public:
+  /**
+   * Create checks the spec against the source table's relation.
+   */
+  static StatusOr<std::unique_ptr<Rollup>> Create(std::shared_ptr<Table> source, RollupSpec spec);
+
+  /**
+   * The relation of the rollup table.
+   */
+  const schema::Relation& relation() const { return relation_; }
+
+  /**
+   * Update aggregates the rows written to the source table since the last call, and writes the
+   * buckets that are complete to the rollup table, which must have relation().
+   */
+  Status Update(Table* rollup_table);
+
+  int64_t late_rows() const { return late_rows_; }
+
+ private:
+  Rollup(std::shared_ptr<Table> source, RollupSpec spec) : source_(source), spec_(spec) {}
+
+  struct Aggregates {
+    int64_t count = 0;
+    std::vector<double> sums;
+    std::vector<double> mins;
+    std::vector<double> maxs;
+  };
+  // The aggregates of each group of a bucket, by the group's encoded values.
+  using Bucket = absl::flat_hash_map<std::string, Aggregates>;
+
+  void AddRows(const schema::RowBatch& rb);
+  std::string EncodeGroup(const schema::RowBatch& rb, int64_t row_idx) const;
+  Status WriteBuckets(int64_t before, Table* rollup_table);
+
+  std::shared_ptr<Table> source_;
+  const RollupSpec spec_;
+  schema::Relation relation_;
+  // The source columns read: the time column, then the group by columns, then the value columns.
+  std::vector<int64_t> source_cols_;
+  std::vector<types::DataType> group_types_;
+  std::vector<types::DataType> value_types_;
+
+  internal::RowID last_read_row_id_ = -1;
+  // Open buckets, by their start time.
+  absl::btree_map<int64_t, Bucket> buckets_;
+  // The latest row time seen.
+  int64_t max_time_ = std::numeric_limits<int64_t>::min();
+  // Buckets before this time have been written.
+  int64_t written_until_ = std::numeric_limits<int64_t>::min();
+  int64_t late_rows_ = 0;
+};
+
+}  // namespace table_store
+}  // namespace px
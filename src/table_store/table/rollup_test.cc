@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/rollup.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+struct Row {
+  int64_t time;
+  std::string service;
+  int64_t latency;
+};
+
+Status WriteRows(Table* table, const std::vector<Row>& rows) {
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::StringValue> services;
+  std::vector<types::Int64Value> latencies;
+  for (const auto& row : rows) {
+    times.push_back(row.time);
+    services.push_back(row.service);
+    latencies.push_back(row.latency);
+  }
+  schema::RowBatch rb(schema::RowDescriptor(table->GetRelation().col_types()), rows.size());
+  PL_RETURN_IF_ERROR(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  PL_RETURN_IF_ERROR(rb.AddColumn(types::ToArrow(services, arrow::default_memory_pool())));
+  PL_RETURN_IF_ERROR(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+  return table->WriteRowBatch(rb);
+}
+
+}  // namespace
+
+class RollupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    source_ = Table::Create("source",
+                            schema::Relation({types::DataType::TIME64NS, types::DataType::STRING,
+                                              types::DataType::INT64},
+                                             {"time_", "service", "latency"}));
+    RollupSpec spec;
+    spec.interval = std::chrono::nanoseconds(10);
+    spec.group_by_cols = {"service"};
+    spec.value_cols = {"latency"};
+    ASSERT_OK_AND_ASSIGN(rollup_, Rollup::Create(source_, spec));
+    rollup_table_ = Table::Create("rollup", rollup_->relation());
+  }
+
+  // Reads the rollup table's rows of the given bucket, by service.
+  absl::flat_hash_map<std::string, std::vector<double>> ReadBucket(int64_t bucket_start) {
+    absl::flat_hash_map<std::string, std::vector<double>> rows;
+    Table::Cursor cursor(rollup_table_.get());
+    while (!cursor.Done()) {
+      auto rb = cursor.GetNextRowBatch({0, 1, 2, 3, 4, 5}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        if (types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i) !=
+            bucket_start) {
+          continue;
+        }
+        auto service = types::GetValueFromArrowArray<types::DataType::STRING>(
+            rb->ColumnAt(1).get(), i);
+        rows[service] = {
+            static_cast<double>(
+                types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(2).get(), i)),
+            types::GetValueFromArrowArray<types::DataType::FLOAT64>(rb->ColumnAt(3).get(), i),
+            types::GetValueFromArrowArray<types::DataType::FLOAT64>(rb->ColumnAt(4).get(), i),
+            types::GetValueFromArrowArray<types::DataType::FLOAT64>(rb->ColumnAt(5).get(), i)};
+      }
+    }
+    return rows;
+  }
+
+  std::shared_ptr<Table> source_;
+  std::unique_ptr<Rollup> rollup_;
+  std::shared_ptr<Table> rollup_table_;
+};
+
+TEST_F(RollupTest, relation) {
+  EXPECT_THAT(rollup_->relation().col_names(),
+              ::testing::ElementsAre("time_", "service", "count", "latency_sum", "latency_min",
+                                     "latency_max"));
+}
+
+TEST_F(RollupTest, writes_complete_buckets) {
+  ASSERT_OK(WriteRows(source_.get(), {{1, "a", 5}, {2, "a", 15}, {5, "b", 7}, {12, "a", 1}}));
+  ASSERT_OK(rollup_->Update(rollup_table_.get()));
+  // No row is an interval past the end of the first bucket yet.
+  EXPECT_TRUE(ReadBucket(0).empty());
+
+  ASSERT_OK(WriteRows(source_.get(), {{31, "a", 3}}));
+  ASSERT_OK(rollup_->Update(rollup_table_.get()));
+  auto bucket = ReadBucket(0);
+  ASSERT_EQ(bucket.size(), 2);
+  EXPECT_THAT(bucket["a"], ::testing::ElementsAre(2, 20, 5, 15));
+  EXPECT_THAT(bucket["b"], ::testing::ElementsAre(1, 7, 7, 7));
+  EXPECT_TRUE(ReadBucket(10).empty());
+
+  // Rows of a bucket that was written are dropped.
+  ASSERT_OK(WriteRows(source_.get(), {{3, "a", 100}}));
+  ASSERT_OK(rollup_->Update(rollup_table_.get()));
+  EXPECT_EQ(rollup_->late_rows(), 1);
+  EXPECT_THAT(ReadBucket(0)["a"], ::testing::ElementsAre(2, 20, 5, 15));
+}
+
+TEST_F(RollupTest, rejects_bad_spec) {
+  RollupSpec spec;
+  spec.group_by_cols = {"missing"};
+  EXPECT_NOT_OK(Rollup::Create(source_, spec));
+  spec.group_by_cols = {};
+  spec.value_cols = {"service"};
+  EXPECT_NOT_OK(Rollup::Create(source_, spec));
+}
+
+}  // namespace table_store
+}  // namespace px
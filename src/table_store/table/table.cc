@@ -17,24 +17,35 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <filesystem>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
 #include "internal/store_with_row_accounting.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/huge_page_memory_pool.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/column_codec.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/row_selection.h"
 #include "src/table_store/table/internal/types.h"
 #include "src/table_store/table/table.h"
 
@@ -44,12 +55,108 @@ DEFINE_int32(table_store_table_size_limit,
              gflags::Int32FromEnv("PL_TABLE_STORE_TABLE_SIZE_LIMIT", 1024 * 1024 * 64),
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
+DEFINE_string(table_store_huge_pages, gflags::StringFromEnv("PL_TABLE_STORE_HUGE_PAGES", "none"),
+              "Whether the large buffers of tables are backed by huge pages, to cut the TLB misses "
+              "of scans over them: none, transparent, or explicit (from the pool reserved by "
+              "vm.nr_hugepages, falling back to transparent huge pages).");
 
 namespace px {
 namespace table_store {
 
+namespace {
+
+constexpr std::string_view kDiskBatchFileExtension = ".pxbatch";
+constexpr std::string_view kSnapshotFileExtension = ".pxsnap";
+// Snapshot files are written under this extension, and renamed once complete.
+constexpr std::string_view kSnapshotTmpFileExtension = ".tmp";
+
+using HotStore = internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>;
+using ColdStore = internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>;
+using DiskStore = internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>;
+
+// The memory pools of all tables allocate from a huge page pool, if --table_store_huge_pages is
+// set, and the gauges of how much of it is backed by huge pages.
+struct HugePageArena {
+  std::unique_ptr<types::HugePageMemoryPool> pool;
+  prometheus::Gauge& huge_page_size_gauge;
+  prometheus::Gauge& mapped_bytes_gauge;
+  prometheus::Gauge& huge_page_bytes_gauge;
+  prometheus::Gauge& fallbacks_gauge;
+};
+
+HugePageArena* CreateHugePageArena() {
+  types::HugePageMemoryPool::Mode mode;
+  if (FLAGS_table_store_huge_pages == "transparent") {
+    mode = types::HugePageMemoryPool::Mode::kTransparent;
+  } else if (FLAGS_table_store_huge_pages == "explicit") {
+    mode = types::HugePageMemoryPool::Mode::kExplicit;
+  } else {
+    LOG_IF(ERROR, FLAGS_table_store_huge_pages != "none") << absl::Substitute(
+        "Unknown --table_store_huge_pages=$0, using regular pages", FLAGS_table_store_huge_pages);
+    return nullptr;
+  }
+  if (mode == types::HugePageMemoryPool::Mode::kTransparent &&
+      !types::HugePageMemoryPool::TransparentHugePagesEnabled()) {
+    LOG(WARNING) << "Transparent huge pages are disabled by the kernel, using regular pages";
+    return nullptr;
+  }
+  auto gauge = [](const std::string& name, const std::string& help) -> prometheus::Gauge& {
+    return prometheus::BuildGauge().Name(name).Help(help).Register(GetMetricsRegistry()).Add({});
+  };
+  return new HugePageArena{
+      types::HugePageMemoryPool::Create(mode),
+      gauge("table_store_huge_page_size_bytes", "The size of the huge pages of the table store"),
+      gauge("table_store_mapped_bytes", "Bytes mapped in whole huge pages by the table store"),
+      gauge("table_store_huge_page_bytes",
+            "Bytes mapped by the table store that are backed, or advised to be, by huge pages"),
+      gauge("table_store_huge_page_fallbacks",
+            "Mappings of the table store that didn't get the huge pages asked for"),
+  };
+}
+
+HugePageArena* GetHugePageArena() {
+  static HugePageArena* arena = CreateHugePageArena();
+  return arena;
+}
+
+arrow::MemoryPool* TableParentMemoryPool() {
+  auto* arena = GetHugePageArena();
+  return arena == nullptr ? arrow::default_memory_pool() : arena->pool.get();
+}
+
+void UpdateHugePageGauges() {
+  auto* arena = GetHugePageArena();
+  if (arena == nullptr) {
+    return;
+  }
+  arena->huge_page_size_gauge.Set(arena->pool->huge_page_size());
+  arena->mapped_bytes_gauge.Set(arena->pool->mapped_bytes());
+  arena->huge_page_bytes_gauge.Set(arena->pool->huge_page_bytes());
+  arena->fallbacks_gauge.Set(arena->pool->num_fallbacks());
+}
+
+// Batch files are only readable by the table that wrote them, so those of a previous run are
+// deleted.
+Status PrepareDiskTierDir(const std::filesystem::path& dir) {
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.path().extension() == kDiskBatchFileExtension) {
+      PL_RETURN_IF_ERROR(fs::Remove(entry.path()));
+    }
+  }
+  if (ec) {
+    return error::Internal("Failed to list $0: $1", dir.string(), ec.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
     : table_(table), hints_(internal::BatchHints{}) {
+  table_->last_read_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
+  decoded_cold_batch_.shared = &table_->shared_cold_decodes_;
   AdvanceToStart(start);
   StopStateFromSpec(std::move(stop));
 }
@@ -68,6 +175,13 @@ void Table::Cursor::AdvanceToStart(const StartSpec& start) {
       }
       break;
     }
+    case StartSpec::StartType::AfterRowID: {
+      last_read_row_id_ = start.row_id;
+      if (table_->FirstRowID() != -1) {
+        last_read_row_id_ = std::max(last_read_row_id_, table_->FirstRowID() - 1);
+      }
+      break;
+    }
   }
 }
 
@@ -113,6 +227,14 @@ bool Table::Cursor::Done() {
 
 void Table::Cursor::UpdateStopSpec(Cursor::StopSpec stop) { StopStateFromSpec(std::move(stop)); }
 
+void Table::Cursor::SetColumnRanges(std::vector<ColumnRange> ranges) {
+  column_ranges_ = std::move(ranges);
+}
+
+void Table::Cursor::SetColumnEquals(std::vector<ColumnEquals> equals) {
+  column_equals_ = std::move(equals);
+}
+
 internal::RowID* Table::Cursor::LastReadRowID() { return &last_read_row_id_; }
 
 internal::BatchHints* Table::Cursor::Hints() { return &hints_; }
@@ -124,19 +246,30 @@ std::optional<internal::RowID> Table::Cursor::StopRowID() const {
   return stop_.stop_row_id;
 }
 
+const std::vector<Table::ColumnRange>& Table::Cursor::ColumnRanges() const {
+  return column_ranges_;
+}
+
+const std::vector<Table::ColumnEquals>& Table::Cursor::ColumnEqualsValues() const {
+  return column_equals_;
+}
+
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
     const std::vector<int64_t>& cols) {
   return table_->GetNextRowBatch(this, cols);
 }
 
 Table::Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
-             size_t compacted_batch_size)
+             size_t compacted_batch_size, DiskTierOptions disk_tier)
     : metrics_(&(GetMetricsRegistry()), std::string(table_name)),
       rel_(relation),
       max_table_size_(max_table_size),
       compacted_batch_size_(compacted_batch_size),
-      // TODO(james): move mem_pool into constructor.
-      compactor_(rel_, arrow::default_memory_pool()) {
+      disk_tier_(std::move(disk_tier)),
+      mem_pool_(types::AccountingMemoryPool::Create(/* limit_bytes */ 0, TableParentMemoryPool())),
+      compactor_(rel_, mem_pool_.get()),
+      bloom_filter_cols_(rel_.NumColumns(), false) {
+  absl::MutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
@@ -149,6 +282,18 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_, time_col_idx_);
   cold_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
       rel_, time_col_idx_);
+  cold_column_stats_.resize(rel_.NumColumns());
+
+  if (disk_tier_.enabled()) {
+    auto s = PrepareDiskTierDir(disk_tier_.dir);
+    if (s.ok()) {
+      disk_store_ =
+          std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>>(
+              rel_, time_col_idx_);
+    } else {
+      LOG(ERROR) << absl::Substitute("Disabling the disk tier of $0: $1", table_name, s.msg());
+    }
+  }
 }
 
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
@@ -174,42 +319,123 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
     Cursor* cursor, const std::vector<int64_t>& cols) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  PL_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
-  if (rb == nullptr) {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    PL_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
-    if (rb == nullptr && hot_store_->Size() > 0) {
-      // If the cursor was pointing to an expired row batch, update the cursor to point to the start
-      // of the table, then try to get the next row batch.
-      *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
+  // The next batch is looked up under the locks, but read after releasing them, so that slow reads
+  // (e.g. of compressed cold batches) don't block writes.
+  std::optional<DiskStore::BatchSlice> disk_slice;
+  std::optional<ColdStore::BatchSlice> cold_slice;
+  std::optional<HotStore::BatchSlice> hot_slice;
+  {
+    absl::ReaderMutexLock disk_lock(&disk_lock_);
+    if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+      if (*cursor->LastReadRowID() + 1 < disk_store_->FirstRowID()) {
+        // The rows after the cursor were expired from disk, so continue at the oldest row left.
+        *cursor->LastReadRowID() = disk_store_->FirstRowID() - 1;
+      }
       if (!cursor->Done()) {
-        PL_ASSIGN_OR_RETURN(rb,
-                            hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
+        disk_slice = disk_store_->NextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                 cursor->StopRowID(), cols,
+                                                 cursor->ColumnRanges());
+      }
+    }
+    // If the rest of a store was skipped, move on to the next store. The zero row batch is only
+    // returned if there is nothing after it.
+    auto skipped = [cursor](const auto& slice) {
+      return slice.has_value() && slice->batch == nullptr && !cursor->Done();
+    };
+    if ((!disk_slice.has_value() || skipped(disk_slice)) && !cursor->Done()) {
+      absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+      cold_slice = cold_store_->NextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                               cursor->StopRowID(), cols, cursor->ColumnRanges(),
+                                               cursor->ColumnEqualsValues());
+      if (!cold_slice.has_value() || skipped(cold_slice)) {
+        absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+        hot_slice = hot_store_->NextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                               cursor->StopRowID(), cols, cursor->ColumnRanges());
+        if (!hot_slice.has_value() && hot_store_->Size() > 0) {
+          // If the cursor was pointing to an expired row batch, update the cursor to point to the
+          // start of the table, then try to get the next row batch.
+          *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
+          if (!cursor->Done()) {
+            hot_slice = hot_store_->NextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                   cursor->StopRowID(), cols,
+                                                   cursor->ColumnRanges());
+          }
+        }
       }
     }
   }
-  if (rb == nullptr) {
-    return error::InvalidArgument("Data after Cursor is not in the table.");
+  // Each store is only searched if the ones before it had nothing, or were skipped, so the last
+  // slice found is the one to return.
+  if (hot_slice.has_value()) {
+    return ReadCursorSlice<HotStore>(cursor, hot_slice.value(), cols);
+  }
+  if (cold_slice.has_value()) {
+    return ReadCursorSlice<ColdStore>(cursor, cold_slice.value(), cols);
+  }
+  if (disk_slice.has_value()) {
+    return ReadCursorSlice<DiskStore>(cursor, disk_slice.value(), cols);
+  }
+  return error::InvalidArgument("Data after Cursor is not in the table.");
+}
+
+template <typename TStore>
+StatusOr<std::unique_ptr<schema::RowBatch>> Table::ReadCursorSlice(
+    Cursor* cursor, const typename TStore::BatchSlice& slice,
+    const std::vector<int64_t>& cols) const {
+  internal::DecodedColdBatch* decoded =
+      std::is_same_v<TStore, ColdStore> ? &cursor->decoded_cold_batch_ : nullptr;
+  if (!cursor->filter_rows_ || slice.batch == nullptr ||
+      (cursor->column_ranges_.empty() && cursor->column_equals_.empty())) {
+    return TStore::ReadBatchSlice(slice, cols, decoded);
+  }
+
+  // Read the columns of the ranges and values first, and select the rows with them.
+  typename TStore::BatchSlice pred_slice = slice;
+  pred_slice.col_types.clear();
+  std::vector<int64_t> pred_cols;
+  auto pred_col_position = [&](int64_t col_idx) -> int64_t {
+    auto it = std::find(pred_cols.begin(), pred_cols.end(), col_idx);
+    if (it != pred_cols.end()) {
+      return it - pred_cols.begin();
+    }
+    pred_cols.push_back(col_idx);
+    pred_slice.col_types.push_back(rel_.col_types()[col_idx]);
+    return pred_cols.size() - 1;
+  };
+  std::vector<ColumnRange> ranges;
+  for (const auto& range : cursor->column_ranges_) {
+    ranges.push_back({pred_col_position(range.col_idx), range.min, range.max});
+  }
+  std::vector<ColumnEquals> equals;
+  for (const auto& eq : cursor->column_equals_) {
+    equals.push_back({pred_col_position(eq.col_idx), eq.values});
   }
-  return rb;
+  PL_ASSIGN_OR_RETURN(auto pred_rb, TStore::ReadBatchSlice(pred_slice, pred_cols, decoded));
+  auto rows = internal::SelectRows(*pred_rb, ranges, equals);
+  cursor->rows_filtered_ += slice.num_rows - rows.size();
+
+  if (rows.size() == slice.num_rows) {
+    return TStore::ReadBatchSlice(slice, cols, decoded);
+  }
+  if (rows.empty()) {
+    return schema::RowBatch::WithZeroRows(schema::RowDescriptor(slice.col_types),
+                                          /* eow */ false, /* eos */ false);
+  }
+  return TStore::ReadBatchRows(slice, cols, rows, decoded);
 }
 
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
-  if (row_batch_size > max_table_size_) {
+  int64_t max_table_size = max_table_size_;
+  if (row_batch_size > max_table_size) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
+                                  row_batch_size, max_table_size);
   }
   int64_t bytes;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
   }
-  while (bytes + row_batch_size > max_table_size_) {
+  while (bytes + row_batch_size > max_table_size) {
     PL_RETURN_IF_ERROR(ExpireBatch());
     {
       absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
@@ -242,6 +468,9 @@ Status Table::TransferRecordBatch(
   if (record_batch->empty() || record_batch->at(0)->Size() == 0) {
     return Status::OK();
   }
+  // Batches from Stirling are sorted by time, so the first record is the oldest in the batch.
+  int64_t first_event_time =
+      time_col_idx_ == -1 ? 0 : record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(0).val;
 
   auto record_batch_w_cache = internal::RecordBatchWithCache{
       std::move(record_batch),
@@ -251,6 +480,10 @@ Status Table::TransferRecordBatch(
   internal::RecordOrRowBatch record_or_row_batch(std::move(record_batch_w_cache));
 
   PL_RETURN_IF_ERROR(WriteHot(std::move(record_or_row_batch)));
+  if (time_col_idx_ != -1) {
+    metrics_.ingest_latency_histogram.Observe(
+        std::max<int64_t>(CurrentTimeNS() - first_event_time, 0) / 1e9);
+  }
   return Status::OK();
 }
 
@@ -280,10 +513,39 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
 
   // Make sure locks are released for this call, since they are reacquired inside.
   PL_RETURN_IF_ERROR(UpdateTableMetricGauges());
+  NotifyWriteSubscribers();
   return Status::OK();
 }
 
+Table::WriteSubscriberID Table::SubscribeToWrites(std::function<void()> on_write) {
+  absl::MutexLock lock(&write_subscribers_lock_);
+  WriteSubscriberID id = next_write_subscriber_id_++;
+  write_subscribers_.emplace(id, std::move(on_write));
+  num_write_subscribers_ = write_subscribers_.size();
+  return id;
+}
+
+void Table::UnsubscribeFromWrites(WriteSubscriberID id) {
+  absl::MutexLock lock(&write_subscribers_lock_);
+  write_subscribers_.erase(id);
+  num_write_subscribers_ = write_subscribers_.size();
+}
+
+void Table::NotifyWriteSubscribers() {
+  if (num_write_subscribers_ == 0) {
+    return;
+  }
+  absl::MutexLock lock(&write_subscribers_lock_);
+  for (const auto& [id, on_write] : write_subscribers_) {
+    on_write();
+  }
+}
+
 Table::RowID Table::FirstRowID() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+    return disk_store_->FirstRowID();
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
@@ -296,6 +558,7 @@ Table::RowID Table::FirstRowID() const {
 }
 
 Table::RowID Table::LastRowID() const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() > 0) {
@@ -304,12 +567,23 @@ Table::RowID Table::LastRowID() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+    return disk_store_->LastRowID();
+  }
   return -1;
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  std::optional<RowID> optional_row_id;
+  if (disk_store_ != nullptr) {
+    optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+    if (optional_row_id.has_value()) {
+      return optional_row_id.value();
+    }
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -322,8 +596,16 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
+  absl::ReaderMutexLock disk_lock(&disk_lock_);
+  std::optional<RowID> optional_row_id;
+  if (disk_store_ != nullptr) {
+    optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThan(time);
+    if (optional_row_id.has_value()) {
+      return optional_row_id.value();
+    }
+  }
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -337,6 +619,12 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
 
 schema::Relation Table::GetRelation() const { return rel_; }
 
+void Table::SetMaxTableSize(int64_t max_table_size, int64_t reserved_bytes) {
+  max_table_size_ = max_table_size;
+  absl::base_internal::SpinLockHolder lock(&stats_lock_);
+  reserved_bytes_ = reserved_bytes;
+}
+
 TableStats Table::GetTableStats() const {
   TableStats info;
   int64_t min_time = -1;
@@ -344,8 +632,17 @@ TableStats Table::GetTableStats() const {
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
   {
+    absl::ReaderMutexLock disk_lock(&disk_lock_);
+    if (disk_store_ != nullptr) {
+      info.disk_bytes = disk_bytes_;
+      info.disk_batches = disk_store_->Size();
+      min_time = disk_store_->MinTime();
+    }
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    info.cold_column_stats = cold_column_stats_;
+    if (min_time == -1) {
+      min_time = cold_store_->MinTime();
+    }
     num_batches += cold_store_->Size();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     num_batches += hot_store_->Size();
@@ -366,36 +663,89 @@ TableStats Table::GetTableStats() const {
   info.cold_bytes = cold_bytes;
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
+  info.reserved_bytes = reserved_bytes_;
   info.min_time = min_time;
+  info.memory_pool_bytes = mem_pool_->bytes_allocated();
+  info.memory_pool_peak_bytes = mem_pool_->max_memory();
 
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
-  const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+StatusOr<bool> Table::CompactSingleBatch() {
+  // The hot batches to compact are looked up under hot_lock_, and then copied and encoded without
+  // any locks held. Hot batches aren't modified once written, so the references stay valid even if
+  // the batches are expired meanwhile, in which case the compacted batch is dropped.
+  internal::BatchSizeAccountant::CompactedBatchSpec compaction_spec;
+  std::vector<std::shared_ptr<const internal::HotBatch>> hot_batches;
+  RowID first_row_id = -1;
+  {
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    if (!batch_size_accountant_->CompactedBatchReady()) {
+      return false;
+    }
+    compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+    // Each slice is of a different hot batch, starting at the front of the store.
+    for (size_t i = 0; i < compaction_spec.hot_slices.size(); ++i) {
+      hot_batches.push_back(hot_store_->Batch(i));
+    }
+    first_row_id = hot_store_->FirstRowID() + compaction_spec.hot_slices.front().start_row;
+  }
 
   PL_RETURN_IF_ERROR(
       compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+  for (const auto& [i, hot_slice] : Enumerate(compaction_spec.hot_slices)) {
+    compactor_.UnsafeAppendBatchSlice(*hot_batches[i], hot_slice.start_row, hot_slice.end_row);
+  }
+  PL_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
 
-  RowID first_row_id = -1;
-  for (auto hot_slice : compaction_spec.hot_slices) {
-    if (first_row_id == -1) {
-      first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+  // Columns are compressed by type, so that more history fits in cold. The time column is kept
+  // plain, since the cold store searches it in place.
+  internal::ColdBatch cold_batch;
+  cold_batch.reserve(out_columns.size());
+  uint64_t cold_bytes_saved = 0;
+  for (const auto& [col_idx, col] : Enumerate(out_columns)) {
+    if (static_cast<int64_t>(col_idx) == time_col_idx_) {
+      cold_batch.emplace_back(col);
+    } else {
+      PL_ASSIGN_OR_RETURN(auto cold_col, internal::ColdColumn::Encode(
+                                             col, rel_.col_types()[col_idx],
+                                             rel_.col_pattern_types()[col_idx], mem_pool_.get()));
+      cold_batch.push_back(std::move(cold_col));
     }
-
-    compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row, hot_slice.end_row);
-    if (hot_slice.last_slice_for_batch) {
-      hot_store_->PopFront();
+    auto& cold_col = cold_batch.back();
+    if (bloom_filter_cols_[col_idx]) {
+      PL_RETURN_IF_ERROR(cold_col.AddBloomFilter(col.get(), kBloomFilterErrorRate));
+    }
+    // A bloom filter can make a short column take more than it did plain.
+    if (cold_col.plain_bytes() > cold_col.encoded_bytes()) {
+      cold_bytes_saved += cold_col.plain_bytes() - cold_col.encoded_bytes();
     }
   }
 
-  PL_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
-
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    // Hot batches are only ever expired from the front, so the store starting at the same row
+    // means that none of the compacted ones were.
+    if (hot_store_->Size() == 0 ||
+        hot_store_->FirstRowID() + compaction_spec.hot_slices.front().start_row != first_row_id) {
+      return false;
+    }
+    for (const auto& hot_slice : compaction_spec.hot_slices) {
+      if (hot_slice.last_slice_for_batch) {
+        hot_store_->PopFront();
+      }
+    }
+    for (const auto& [col_idx, cold_col] : Enumerate(cold_batch)) {
+      cold_column_stats_[col_idx].encoded_bytes += cold_col.encoded_bytes();
+      cold_column_stats_[col_idx].plain_bytes += cold_col.plain_bytes();
+    }
+    cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
-  if (num_rows_to_remove > 0) {
-    hot_store_->RemovePrefix(num_rows_to_remove);
+    auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(cold_bytes_saved);
+    if (num_rows_to_remove > 0) {
+      hot_store_->RemovePrefix(num_rows_to_remove);
+    }
   }
 
   {
@@ -403,40 +753,236 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
     compacted_batches_++;
     metrics_.compacted_batches_counter.Increment();
   }
+  return true;
+}
+
+Status Table::CompactHotToCold(std::chrono::steady_clock::time_point deadline) {
+  absl::MutexLock compaction_lock(&compaction_lock_);
+  for (int64_t i = 0;
+       i < kMaxBatchesPerCompactionCall && std::chrono::steady_clock::now() < deadline; ++i) {
+    PL_ASSIGN_OR_RETURN(bool compacted, CompactSingleBatch());
+    if (!compacted) {
+      break;
+    }
+  }
+  shared_cold_decodes_.ReleaseExpired();
+  // Compaction runs periodically, so it also applies the disk tier's retention when no batches are
+  // being spilled.
+  absl::MutexLock disk_lock(&disk_lock_);
+  if (disk_store_ != nullptr) {
+    ExpireDisk();
+  }
   return Status::OK();
 }
 
-Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
-  bool next_ready = false;
+Status Table::WriteSnapshot(const std::filesystem::path& dir) {
+  absl::MutexLock snapshot_lock(&snapshot_lock_);
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+
+  // Cold batches are immutable, so those already in the snapshot don't need to be written again.
+  std::vector<std::pair<RowID, std::shared_ptr<const ColdBatch>>> new_batches;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    for (size_t i = 0; i < cold_store_->Size(); ++i) {
+      RowID first_row_id = cold_store_->BatchRowIDs(i).first;
+      if (!snapshot_files_.contains(first_row_id)) {
+        new_batches.emplace_back(first_row_id, cold_store_->Batch(i));
+      }
+    }
+  }
+  for (const auto& [first_row_id, batch] : new_batches) {
+    PL_ASSIGN_OR_RETURN(auto columns, DecodeColdBatch(*batch));
+    auto path = dir / absl::StrCat(next_snapshot_file_id_++, kSnapshotFileExtension);
+    auto tmp_path = path;
+    tmp_path += kSnapshotTmpFileExtension;
+    PL_RETURN_IF_ERROR(internal::DiskBatch::WriteFile(tmp_path, columns));
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+      return error::Internal("Failed to rename $0: $1", tmp_path.string(), ec.message());
+    }
+    snapshot_files_.emplace(first_row_id, std::move(path));
+  }
+
+  // Batches are only expired from the front of the table, so those before its first row are gone.
+  RowID first_row_id = FirstRowID();
+  snapshot_files_.erase(snapshot_files_.begin(), first_row_id == -1
+                                                     ? snapshot_files_.end()
+                                                     : snapshot_files_.lower_bound(first_row_id));
+  // Removes the files of those batches, along with any others left behind, e.g. by a crash.
+  absl::flat_hash_set<std::string> snapshot_file_names;
+  for (const auto& [row_id, path] : snapshot_files_) {
+    snapshot_file_names.insert(path.filename().string());
+  }
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    auto extension = entry.path().extension();
+    if ((extension == kSnapshotFileExtension || extension == kSnapshotTmpFileExtension) &&
+        !snapshot_file_names.contains(entry.path().filename().string())) {
+      PL_RETURN_IF_ERROR(fs::Remove(entry.path()));
+    }
+  }
+  if (ec) {
+    return error::Internal("Failed to list $0: $1", dir.string(), ec.message());
+  }
+  return Status::OK();
+}
+
+Status Table::RestoreSnapshot(const std::filesystem::path& dir) {
+  absl::MutexLock snapshot_lock(&snapshot_lock_);
+  if (!fs::Exists(dir)) {
+    return Status::OK();
+  }
+  std::vector<std::pair<int64_t, std::filesystem::path>> files;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    int64_t file_id;
+    if (entry.path().extension() == kSnapshotFileExtension &&
+        absl::SimpleAtoi(entry.path().stem().string(), &file_id)) {
+      files.emplace_back(file_id, entry.path());
+    }
+  }
+  if (ec) {
+    return error::Internal("Failed to list $0: $1", dir.string(), ec.message());
+  }
+  // Files are numbered in the order they were written, which is the order of their rows.
+  std::sort(files.begin(), files.end());
+
+  std::vector<std::shared_ptr<arrow::DataType>> col_types;
+  for (const auto& data_type : rel_.col_types()) {
+    col_types.push_back(types::MakeArrowBuilder(data_type, arrow::default_memory_pool())->type());
+  }
+
+  absl::MutexLock disk_lock(&disk_lock_);
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    next_ready = batch_size_accountant_->CompactedBatchReady();
+    if (next_row_id_ != 0) {
+      return error::FailedPrecondition("Snapshots can only be restored into an empty table.");
+    }
   }
-  while (next_ready) {
-    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  RowID row_id = 0;
+  for (const auto& [file_id, path] : files) {
+    next_snapshot_file_id_ = std::max(next_snapshot_file_id_, file_id + 1);
+    auto batch_or = internal::DiskBatch::Open(path, col_types);
+    if (!batch_or.ok()) {
+      // The file is not part of the snapshot from now on, so the next snapshot removes it.
+      LOG(WARNING) << absl::Substitute("Skipping snapshot file $0: $1", path.string(),
+                                       batch_or.status().msg());
+      continue;
+    }
+    if (disk_store_ == nullptr) {
+      disk_store_ = std::make_unique<DiskStore>(rel_, time_col_idx_);
+    }
+    auto batch = batch_or.ConsumeValueOrDie();
+    const int64_t length = batch.Length();
+    disk_bytes_ += batch.FileBytes();
+    disk_store_->EmplaceBack(row_id, std::move(batch));
+    snapshot_files_.emplace(row_id, path);
+    row_id += length;
+  }
+  {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
-    // check.
-    if (!batch_size_accountant_->CompactedBatchReady()) {
-      break;
+    next_row_id_ = row_id;
+  }
+  if (disk_store_ != nullptr) {
+    ExpireDisk();
+  }
+  LOG(INFO) << absl::Substitute("Restored $0 snapshot files with $1 rows from $2.",
+                                snapshot_files_.size(), row_id, dir.string());
+  return Status::OK();
+}
+
+Status Table::SetBloomFilterColumns(const std::vector<std::string>& col_names) {
+  std::vector<bool> bloom_filter_cols(rel_.NumColumns(), false);
+  for (const auto& col_name : col_names) {
+    if (!rel_.HasColumn(col_name)) {
+      return error::InvalidArgument("Table has no column '$0'.", col_name);
+    }
+    auto col_idx = rel_.GetColumnIndex(col_name);
+    if (rel_.GetColumnType(col_idx) != types::DataType::STRING) {
+      return error::InvalidArgument("Bloom filters are only kept of STRING columns, not '$0'.",
+                                    col_name);
     }
-    PL_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
-    next_ready = batch_size_accountant_->CompactedBatchReady();
+    bloom_filter_cols[col_idx] = true;
   }
+  absl::MutexLock compaction_lock(&compaction_lock_);
+  bloom_filter_cols_ = std::move(bloom_filter_cols);
   return Status::OK();
 }
 
 StatusOr<bool> Table::ExpireCold() {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  if (cold_store_->Size() == 0) {
-    return false;
+  absl::MutexLock disk_lock(&disk_lock_);
+  RowID first_row_id = -1;
+  std::shared_ptr<const ColdBatch> spilled_batch;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (cold_store_->Size() == 0) {
+      return false;
+    }
+    for (const auto& [col_idx, cold_col] : Enumerate(cold_store_->front())) {
+      cold_column_stats_[col_idx].encoded_bytes -= cold_col.encoded_bytes();
+      cold_column_stats_[col_idx].plain_bytes -= cold_col.plain_bytes();
+    }
+    first_row_id = cold_store_->FirstRowID();
+    auto expired_batch = cold_store_->PopFront();
+    if (disk_tier_.enabled() && disk_store_ != nullptr) {
+      spilled_batch = std::move(expired_batch);
+    }
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    batch_size_accountant_->ExpireColdBatch();
+  }
+  if (spilled_batch != nullptr) {
+    // The batch is only lost from the disk tier, so writes to the table go on regardless.
+    auto s = SpillToDisk(first_row_id, *spilled_batch);
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to spill a batch to $0: $1",
+                                                 disk_tier_.dir.string(), s.msg());
   }
-  cold_store_->PopFront();
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  batch_size_accountant_->ExpireColdBatch();
   return true;
 }
 
+StatusOr<std::vector<Table::ArrowArrayPtr>> Table::DecodeColdBatch(const ColdBatch& batch) const {
+  std::vector<ArrowArrayPtr> columns;
+  columns.reserve(batch.size());
+  for (const auto& col : batch) {
+    PL_ASSIGN_OR_RETURN(auto arr, col.DecodeSlice(0, col.length(), mem_pool_.get()));
+    columns.push_back(std::move(arr));
+  }
+  return columns;
+}
+
+Status Table::SpillToDisk(RowID first_row_id, const ColdBatch& batch) {
+  PL_ASSIGN_OR_RETURN(auto columns, DecodeColdBatch(batch));
+  auto path = disk_tier_.dir / absl::StrCat(first_row_id, kDiskBatchFileExtension);
+  PL_ASSIGN_OR_RETURN(auto disk_batch, internal::DiskBatch::Write(path, columns));
+  disk_bytes_ += disk_batch.FileBytes();
+  disk_store_->EmplaceBack(first_row_id, std::move(disk_batch));
+  ExpireDisk();
+  return Status::OK();
+}
+
+void Table::ExpireDisk() {
+  // Without a time column, only the size limit applies.
+  int64_t min_time = -1;
+  if (disk_tier_.max_retention_ns >= 0 && time_col_idx_ != -1) {
+    int64_t current_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+    min_time = current_time_ns - disk_tier_.max_retention_ns;
+  }
+  int64_t max_bytes = disk_tier_.max_bytes;
+  if (!disk_tier_.enabled()) {
+    // Then only batches restored from a snapshot are on disk, which the table's size limit applies
+    // to instead.
+    max_bytes = max_table_size_ < 0 ? std::numeric_limits<int64_t>::max() : max_table_size_.load();
+  }
+  // Batches are removed once their first row is past retention.
+  while (disk_store_->Size() > 0 &&
+         (disk_bytes_ > max_bytes || disk_store_->MinTime() < min_time)) {
+    disk_bytes_ -= disk_store_->front().FileBytes();
+    disk_store_->PopFront();
+  }
+}
+
 Status Table::ExpireHot() {
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() == 0) {
@@ -465,6 +1011,8 @@ Status Table::UpdateTableMetricGauges() {
   metrics_.hot_bytes_gauge.Set(stats.hot_bytes);
   metrics_.num_batches_gauge.Set(stats.num_batches);
   metrics_.max_table_size_gauge.Set(stats.max_table_size);
+  metrics_.memory_pool_bytes_gauge.Set(stats.memory_pool_bytes);
+  metrics_.memory_pool_peak_bytes_gauge.Set(stats.memory_pool_peak_bytes);
   // Compute retention gauge
   int64_t current_retention_ns = 0;
   // If min_time is 0, there is no data in the table.
@@ -475,6 +1023,7 @@ Status Table::UpdateTableMetricGauges() {
     current_retention_ns = current_time_ns - stats.min_time;
   }
   metrics_.retention_ns_gauge.Set(current_retention_ns);
+  UpdateHugePageGauges();
   return Status::OK();
 }
 
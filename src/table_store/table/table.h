@@ -22,7 +22,11 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <filesystem>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -32,10 +36,14 @@
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/mutex.h>
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
 #include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/memory_pool.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_batch.h"
@@ -43,7 +51,9 @@
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/disk_batch.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/shared_cold_decodes.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
 #include "src/table_store/table/table_metrics.h"
@@ -55,6 +65,12 @@ namespace table_store {
 
 using RecordBatchSPtr = std::shared_ptr<arrow::RecordBatch>;
 
+struct ColdColumnStats {
+  // The bytes that a column of the cold batches takes compressed, and would take uncompressed.
+  int64_t encoded_bytes = 0;
+  int64_t plain_bytes = 0;
+};
+
 struct TableStats {
   int64_t bytes;
   int64_t hot_bytes;
@@ -66,6 +82,17 @@ struct TableStats {
   int64_t compacted_batches;
   int64_t max_table_size;
   int64_t min_time;
+  // One per column of the relation, for the compression ratio of each column in cold.
+  std::vector<ColdColumnStats> cold_column_stats;
+  // The disk tier, if enabled. Its bytes are not part of `bytes`.
+  int64_t disk_bytes = 0;
+  int64_t disk_batches = 0;
+  // The part of max_table_size that the MemoryArbitrator reserved for the table's minimum
+  // retention window, if any.
+  int64_t reserved_bytes = 0;
+  // The bytes of the cold batches and compaction buffers allocated from the table's memory pool.
+  int64_t memory_pool_bytes = 0;
+  int64_t memory_pool_peak_bytes = 0;
 };
 
 /**
@@ -78,12 +105,20 @@ struct TableStats {
  * and `Time and Row Indexing` below).
  *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks.
+ * The hot and cold partitions are synchronized separately with spinlocks, which are only held to
+ * look up, add or remove batches. Batches are immutable once added, and held by shared_ptr, so
+ * cursors take a reference to their next batch under the locks and read it (e.g. decompress it)
+ * after releasing them. Compaction likewise builds a cold batch from references to hot batches
+ * without holding any locks, and then swaps it in for them, so that neither long reads nor
+ * compaction stall writes. A batch that is expired or compacted while being read is freed by
+ * its last reader.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
  * single row.  The compaction routine should be called periodically but that is not the
- * responsibility of this class.
+ * responsibility of this class. The columns of compacted batches are compressed by type (see
+ * `internal::ColdColumn`), and decompressed as cursors read them. How well each column compresses
+ * is reported in `TableStats::cold_column_stats`.
  *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored in
@@ -100,6 +135,32 @@ struct TableStats {
  * Cursor stores the unique row identifier of the last read row, so
  * that when GetNextRowBatch is called on the cursor it can work out that it needs to return a slice
  * of the batch with the original "second" batch's data.
+ *
+ * Disk Tier:
+ * Optionally (see `DiskTierOptions`), cold batches that are expired to stay within
+ * max_table_size are moved to files on local disk instead of being discarded, which cursors then
+ * read through memory maps. The disk tier has its own size and retention limits. Hot batches that
+ * are expired before being compacted are still discarded.
+ *
+ * Snapshots:
+ * The cold batches can also be written periodically to a snapshot directory, in the disk tier's
+ * file format (see `WriteSnapshot`), so that a restarted table starts out with them mapped in as
+ * disk batches instead of empty (see `RestoreSnapshot`).
+ *
+ * Zone Maps:
+ * Each batch, hot or cold, also keeps the minimum and maximum of its INT64 and TIME64NS columns,
+ * computed when it is written and again when it is compacted. Cursors with column ranges use them
+ * to skip batches without reading them (see `Cursor::SetColumnRanges`).
+ *
+ * Shared Scans:
+ * Cursors decode the compressed columns of cold batches through the table's
+ * `internal::SharedColdDecodes`, so that concurrent queries scanning the same range share one
+ * decoded copy of each column, and each reads the columns it needs from it.
+ *
+ * Bloom Filters:
+ * Cold batches can also keep bloom filters of chosen high cardinality STRING columns (see
+ * `SetBloomFilterColumns`), built when they are compacted, which cursors looking for a value of
+ * one of these columns use to skip batches in the same way (see `Cursor::SetColumnEquals`).
  */
 class Table : public NotCopyable {
   using RecordBatchPtr = internal::RecordBatchPtr;
@@ -111,10 +172,18 @@ class Table : public NotCopyable {
   using RowIDInterval = internal::RowIDInterval;
   using BatchID = internal::BatchID;
 
-  static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
-
  public:
+  static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
   static inline constexpr int64_t kMaxBatchesPerCompactionCall = 256;
+  // About 10 bits per row.
+  static inline constexpr double kBloomFilterErrorRate = 0.01;
+  // How much of the recently decoded cold data is held for concurrent queries to share, and for
+  // how long (see `internal::SharedColdDecodes`).
+  static inline constexpr int64_t kSharedDecodesMaxRetainedBytes = 4 * 1024 * 1024;
+  static inline constexpr std::chrono::seconds kSharedDecodesRetention{5};
+  using ColumnRange = internal::ColumnRange;
+  using ColumnEquals = internal::ColumnEquals;
+  using DiskTierOptions = internal::DiskTierOptions;
   using StopPosition = int64_t;
   static inline std::shared_ptr<Table> Create(std::string_view table_name,
                                               const schema::Relation& relation) {
@@ -132,15 +201,19 @@ class Table : public NotCopyable {
    public:
     /**
      * StartSpec defines where a Cursor should begin within the table. Current options are to start
-     * at a given time, or start at the first row currently in the table.
+     * at a given time, at the first row currently in the table, or right after a given row, e.g.
+     * the last row read by a previous cursor. If that row has expired, the cursor begins at the
+     * first row currently in the table.
      */
     struct StartSpec {
       enum StartType {
         StartAtTime,
         CurrentStartOfTable,
+        AfterRowID,
       };
       StartType type = CurrentStartOfTable;
       Time start_time = -1;
+      RowID row_id = -1;
     };
 
     /**
@@ -177,6 +250,26 @@ class Table : public NotCopyable {
     bool Done();
     // Change the StopSpec of the cursor.
     void UpdateStopSpec(StopSpec stop);
+    // The ID of the last row returned (or skipped) by the cursor, from which a later cursor can
+    // resume with StartSpec::AfterRowID.
+    RowID last_read_row_id() const { return last_read_row_id_; }
+    // Restrict the cursor to rows in the given value ranges of INT64 or TIME64NS columns, e.g.
+    // latency above a threshold. Batches whose zone maps show they have none of these rows are
+    // skipped without being read, but the returned batches may still have rows outside of the
+    // ranges, so callers must still filter them. If all remaining batches are skipped,
+    // GetNextRowBatch returns a zero row batch.
+    void SetColumnRanges(std::vector<ColumnRange> ranges);
+    // Restrict the cursor to rows with the given values of STRING columns, e.g. a trace ID. Cold
+    // batches whose bloom filters show they have none of these rows are skipped, in the same way
+    // as with SetColumnRanges.
+    void SetColumnEquals(std::vector<ColumnEquals> equals);
+    // Also drop the rows outside of the column ranges, or without the column values, from the
+    // returned batches. The columns of the ranges and values are read first, and the others only
+    // for the rows left, so wide columns (e.g. request bodies) aren't copied or decoded for rows
+    // that the caller would filter out anyway.
+    void SetFilterRows(bool filter_rows) { filter_rows_ = filter_rows; }
+    // The number of rows dropped because of SetFilterRows().
+    int64_t rows_filtered() const { return rows_filtered_; }
 
    private:
     void AdvanceToStart(const StartSpec& start);
@@ -186,6 +279,8 @@ class Table : public NotCopyable {
     internal::RowID* LastReadRowID();
     internal::BatchHints* Hints();
     std::optional<internal::RowID> StopRowID() const;
+    const std::vector<ColumnRange>& ColumnRanges() const;
+    const std::vector<ColumnEquals>& ColumnEqualsValues() const;
 
     struct StopState {
       StopSpec spec;
@@ -195,6 +290,11 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    std::vector<ColumnRange> column_ranges_;
+    std::vector<ColumnEquals> column_equals_;
+    bool filter_rows_ = false;
+    int64_t rows_filtered_ = 0;
+    internal::DecodedColdBatch decoded_cold_batch_;
 
     friend class Table;
   };
@@ -211,8 +311,13 @@ class Table : public NotCopyable {
                  size_t max_table_size)
       : Table(table_name, relation, max_table_size, kDefaultColdBatchMinSize) {}
 
+  /**
+   * @param compacted_batch_size the size in bytes to compact hot batches into cold batches of.
+   * @param disk_tier where and how much data expired from memory is kept on disk. The disk tier is
+   * disabled by default.
+   */
   Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
-        size_t compacted_batch_size_);
+        size_t compacted_batch_size_, DiskTierOptions disk_tier = {});
 
   /**
    * Get a RowBatch of data corresponding to the next data after the given cursor.
@@ -279,14 +384,85 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * The last time a Cursor was opened on the table, i.e. the last time a query read it, or the
+   * time the table was created if it was never read.
+   */
+  std::chrono::steady_clock::time_point last_read_time() const {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(last_read_time_.load()));
+  }
+
+  /**
+   * SetMaxTableSize changes the maximum number of bytes that the table can hold. If it shrinks
+   * below the table's size, data is expired down to the new size on the next write.
+   * @param max_table_size the new maximum size.
+   * @param reserved_bytes how much of it is reserved for the table's minimum retention window, as
+   * reported by GetTableStats().
+   */
+  void SetMaxTableSize(int64_t max_table_size, int64_t reserved_bytes = 0);
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
-   * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
+   * Cold batches are allocated from the table's own memory pool.
+   * @param deadline no more cold batches are created after this time. The remaining hot batches
+   * are compacted by later calls.
+   */
+  Status CompactHotToCold(std::chrono::steady_clock::time_point deadline =
+                              std::chrono::steady_clock::time_point::max());
+
+  /**
+   * SetBloomFilterColumns sets the STRING columns that cold batches keep bloom filters of, for
+   * cursors to skip batches by value. It applies to batches compacted from then on.
+   * @param col_names the names of the columns, which replace any set before.
+   */
+  Status SetBloomFilterColumns(const std::vector<std::string>& col_names);
+
+  /**
+   * WriteSnapshot writes the cold batches that were compacted since the last snapshot to files in
+   * `dir`, and removes the files of the batches that have since been expired from the table, so
+   * that the directory holds the table's cold data. Each file is renamed into place once written,
+   * so that a crash leaves no partial files behind. The same directory must be used on every call.
+   */
+  Status WriteSnapshot(const std::filesystem::path& dir);
+
+  /**
+   * RestoreSnapshot adds the batches in a snapshot directory written by WriteSnapshot to the
+   * table, as its oldest rows. It must be called before anything is written to the table. The
+   * files are mapped in rather than read, so that restoring is quick, and their pages are only read
+   * in as queries need them. The restored batches are kept on disk within the disk tier's limits,
+   * or within the table's size limit (separately from its memory) if it has no disk tier. Files
+   * that cannot be read, e.g. because the table's columns changed, are skipped, and removed by the
+   * next WriteSnapshot.
+   */
+  Status RestoreSnapshot(const std::filesystem::path& dir);
+
+  using WriteSubscriberID = int64_t;
+
+  /**
+   * SubscribeToWrites registers a function to call after each batch is written to the table, so
+   * that queries streaming the table can wake up as soon as there is data, instead of polling for
+   * it. The function is called on the writer's thread, so it must be quick and must not write to
+   * the table.
+   * @return the ID to unsubscribe with.
    */
-  Status CompactHotToCold(arrow::MemoryPool* mem_pool);
+  WriteSubscriberID SubscribeToWrites(std::function<void()> on_write);
+
+  /**
+   * UnsubscribeFromWrites removes a function registered with SubscribeToWrites. It is not called
+   * again once this returns, so that whatever it refers to can be destroyed.
+   */
+  void UnsubscribeFromWrites(WriteSubscriberID id);
 
  private:
+  // Reads a slice that GetNextRowBatch() found in the given store for the cursor, applying its
+  // row filtering (see Cursor::SetFilterRows).
+  template <typename TStore>
+  StatusOr<std::unique_ptr<schema::RowBatch>> ReadCursorSlice(
+      Cursor* cursor, const typename TStore::BatchSlice& slice,
+      const std::vector<int64_t>& cols) const;
+
   TableMetrics metrics_;
 
   schema::Relation rel_;
@@ -296,7 +472,12 @@ class Table : public NotCopyable {
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  int64_t reserved_bytes_ ABSL_GUARDED_BY(stats_lock_) = 0;
+  // Atomic, since writers read it without a lock while the MemoryArbitrator may change it.
+  std::atomic<int64_t> max_table_size_ = 0;
+  // Set by each new Cursor, which only holds a const Table*.
+  mutable std::atomic<std::chrono::steady_clock::rep> last_read_time_ =
+      std::chrono::steady_clock::now().time_since_epoch().count();
   const int64_t compacted_batch_size_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
@@ -306,6 +487,17 @@ class Table : public NotCopyable {
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>> cold_store_
       ABSL_GUARDED_BY(cold_lock_);
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
+  std::vector<ColdColumnStats> cold_column_stats_ ABSL_GUARDED_BY(cold_lock_);
+
+  // Ordered before cold_lock_ and hot_lock_. A mutex rather than a spinlock, because it is held
+  // while batch files are written. Readers hold it while looking up their next batch in all the
+  // stores, so that a batch moving from cold to disk is always found in one of them.
+  mutable absl::Mutex disk_lock_;
+  const DiskTierOptions disk_tier_;
+  // Null if the disk tier is disabled and no snapshot was restored.
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>> disk_store_
+      ABSL_PT_GUARDED_BY(disk_lock_);
+  int64_t disk_bytes_ ABSL_GUARDED_BY(disk_lock_) = 0;
 
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
   // accessed on a hot write.
@@ -313,18 +505,50 @@ class Table : public NotCopyable {
   int64_t time_col_idx_ = -1;
 
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
+  void NotifyWriteSubscribers() ABSL_LOCKS_EXCLUDED(write_subscribers_lock_);
 
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
+  StatusOr<std::vector<ArrowArrayPtr>> DecodeColdBatch(const ColdBatch& batch) const;
+  Status SpillToDisk(RowID first_row_id, const ColdBatch& batch)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(disk_lock_);
+  void ExpireDisk() ABSL_EXCLUSIVE_LOCKS_REQUIRED(disk_lock_);
   Status ExpireRowBatches(int64_t row_batch_size);
-  Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  // Returns false if there was no batch ready to compact, or the hot batches it was made from were
+  // expired during compaction.
+  StatusOr<bool> CompactSingleBatch() ABSL_EXCLUSIVE_LOCKS_REQUIRED(compaction_lock_);
   Status UpdateTableMetricGauges();
 
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
-  internal::ArrowArrayCompactor compactor_;
+  // The pool that compaction allocates cold batches from, so that their memory is accounted to the
+  // table.
+  types::AccountingMemoryPool::UPtr mem_pool_;
+
+  // Ordered before all other locks. Serializes compactions, which don't hold the store locks
+  // while building a cold batch.
+  absl::Mutex compaction_lock_;
+  internal::ArrowArrayCompactor compactor_ ABSL_GUARDED_BY(compaction_lock_);
+  // For each column, whether compacted batches keep a bloom filter of it.
+  std::vector<bool> bloom_filter_cols_ ABSL_GUARDED_BY(compaction_lock_);
+
+  // Ordered before all other locks. Serializes writing and restoring snapshots.
+  absl::Mutex snapshot_lock_;
+  // The snapshot file of each batch in the snapshot, by the batch's first RowID.
+  absl::btree_map<RowID, std::filesystem::path> snapshot_files_ ABSL_GUARDED_BY(snapshot_lock_);
+  int64_t next_snapshot_file_id_ ABSL_GUARDED_BY(snapshot_lock_) = 0;
+
+  mutable internal::SharedColdDecodes shared_cold_decodes_{kSharedDecodesMaxRetainedBytes,
+                                                          kSharedDecodesRetention};
+
+  // Held while the write subscribers are called, so that none is called after it unsubscribes.
+  absl::Mutex write_subscribers_lock_;
+  absl::flat_hash_map<WriteSubscriberID, std::function<void()>> write_subscribers_
+      ABSL_GUARDED_BY(write_subscribers_lock_);
+  WriteSubscriberID next_write_subscriber_id_ ABSL_GUARDED_BY(write_subscribers_lock_) = 0;
+  // Lets writes skip the lock when there are no subscribers, which is the common case.
+  std::atomic<int64_t> num_write_subscribers_ = 0;
 
   friend class Cursor;
 };
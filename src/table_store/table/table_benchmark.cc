@@ -16,14 +16,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/base/internal/cycleclock.h>
 #include <absl/synchronization/barrier.h>
+#include <absl/synchronization/mutex.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <numeric>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "src/shared/types/types.h"
 #include "src/table_store/table/table.h"
@@ -77,7 +82,7 @@ static inline int64_t FillTableCold(Table* table, int64_t table_size, int64_t ba
     auto batch = MakeHotBatch(batch_length, &time_counter);
     PL_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
     // Run compaction every time to ensure that all batches get put into cold.
-    PL_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+    PL_CHECK_OK(table->CompactHotToCold());
   }
   return time_counter;
 }
@@ -133,6 +138,33 @@ static void BM_TableReadAllCold(benchmark::State& state) {
   state.SetBytesProcessed(state.iterations() * table_size);
 }
 
+// Reads a table with a column range that only the newest tenth of the cold batches can match.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableReadColdWithColumnRange(benchmark::State& state) {
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  auto table = MakeTable(table_size, compaction_size);
+  auto last_time = FillTableCold(table.get(), table_size, batch_length);
+  CHECK_EQ(table->GetTableStats().bytes, table_size);
+
+  // The time column is used as the zone mapped column, since it is the only INT64 like column.
+  std::vector<Table::ColumnRange> ranges = {{0, last_time - last_time / 10}};
+  Table::Cursor cursor(table.get());
+  cursor.SetColumnRanges(ranges);
+
+  for (auto _ : state) {
+    ReadFullTable(&cursor);
+
+    state.PauseTiming();
+    cursor = Table::Cursor(table.get());
+    cursor.SetColumnRanges(ranges);
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * table_size);
+}
+
 Table::Cursor GetLastBatchCursor(Table* table, int64_t last_time, int64_t batch_length,
                                  const std::vector<int64_t>& cols) {
   Table::Cursor cursor(table,
@@ -247,7 +279,7 @@ static void BM_TableCompaction(benchmark::State& state) {
   FillTableHot(table.get(), table_size, batch_length);
 
   for (auto _ : state) {
-    PL_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+    PL_CHECK_OK(table->CompactHotToCold());
     state.PauseTiming();
     FillTableHot(table.get(), table_size, batch_length);
     state.ResumeTiming();
@@ -278,10 +310,10 @@ static void BM_TableThreaded(benchmark::State& state) {
 
   std::thread compaction_thread([table_ptr, done]() {
     while (!done->WaitForNotificationWithTimeout(absl::Milliseconds(50))) {
-      PL_CHECK_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+      PL_CHECK_OK(table_ptr->CompactHotToCold());
     }
     // Do one last compaction after writer thread has finished writing.
-    PL_CHECK_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+    PL_CHECK_OK(table_ptr->CompactHotToCold());
   });
 
   auto writer_work = [&]() {
@@ -360,13 +392,148 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+namespace {
+
+// Lock waits are reported by abseil's profiling hooks, for contended locks only.
+std::atomic<int64_t> lock_wait_cycles = 0;
+void RecordMutexWait(int64_t wait_cycles) { lock_wait_cycles += wait_cycles; }
+void RecordSpinLockWait(const void*, int64_t wait_cycles) { lock_wait_cycles += wait_cycles; }
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t idx = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+  std::nth_element(values.begin(), values.begin() + idx, values.end());
+  return values[idx];
+}
+
+}  // namespace
+
+// Models a table in production: one Stirling writer at state.range(1) rows/sec, state.range(0)
+// cursors that scan mixed time ranges over and over, and periodic compaction. The table is small
+// enough that writes expire data throughout.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableContention(benchmark::State& state) {
+  const int num_readers = state.range(0);
+  const int64_t rows_per_s = state.range(1);
+  constexpr int64_t kTableSize = 16 * 1024 * 1024;
+  constexpr int64_t kBatchRows = 1024;
+  // Each row is a TIME64NS and a FLOAT64, and the writer's times count up by one per row.
+  constexpr int64_t kRowBytes = sizeof(int64_t) + sizeof(double);
+  constexpr int64_t kTableRows = kTableSize / kRowBytes;
+  constexpr auto kDuration = std::chrono::seconds(2);
+
+  static const bool profilers_registered = []() {
+    absl::RegisterMutexProfiler(&RecordMutexWait);
+    absl::base_internal::RegisterSpinLockProfiler(&RecordSpinLockWait);
+    return true;
+  }();
+  benchmark::DoNotOptimize(profilers_registered);
+
+  std::vector<double> write_latencies_us;
+  int64_t total_rows_read = 0;
+  int64_t total_lock_wait_cycles = 0;
+  for (auto _ : state) {
+    auto table = MakeTable(kTableSize, 64 * 1024);
+    absl::Notification done;
+    std::atomic<int64_t> last_time = 0;
+    std::atomic<int64_t> rows_read = 0;
+    lock_wait_cycles = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread writer([&]() {
+      int64_t time_counter = 0;
+      auto batch_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(static_cast<double>(kBatchRows) / rows_per_s));
+      auto next_write = std::chrono::steady_clock::now();
+      while (!done.HasBeenNotified()) {
+        auto batch = MakeHotBatch(kBatchRows, &time_counter);
+        auto write_start = std::chrono::steady_clock::now();
+        PL_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+        write_latencies_us.push_back(std::chrono::duration<double, std::micro>(
+                                         std::chrono::steady_clock::now() - write_start)
+                                         .count());
+        last_time = time_counter;
+        next_write += batch_period;
+        std::this_thread::sleep_until(next_write);
+      }
+    });
+
+    std::thread compactor([&]() {
+      while (!done.WaitForNotificationWithTimeout(absl::Milliseconds(50))) {
+        PL_CHECK_OK(table->CompactHotToCold());
+      }
+    });
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < num_readers; ++i) {
+      readers.emplace_back([&, i]() {
+        std::mt19937 rng(i);
+        // A third of the scans read the whole table, the others its most recent half or tenth.
+        std::vector<double> span_fractions = {1.0, 0.5, 0.1};
+        std::uniform_int_distribution<size_t> span_dist(0, span_fractions.size() - 1);
+        while (!done.HasBeenNotified()) {
+          auto span = static_cast<int64_t>(span_fractions[span_dist(rng)] * kTableRows);
+          Table::Cursor cursor(
+              table.get(),
+              Table::Cursor::StartSpec{Table::Cursor::StartSpec::StartAtTime,
+                                       std::max<int64_t>(0, last_time - span)},
+              Table::Cursor::StopSpec{});
+          while (!cursor.Done()) {
+            auto rb_or_s = cursor.GetNextRowBatch({0, 1});
+            if (!rb_or_s.ok()) {
+              // The rest of the scan was expired.
+              break;
+            }
+            rows_read += rb_or_s.ValueOrDie()->num_rows();
+          }
+        }
+      });
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    done.Notify();
+    writer.join();
+    compactor.join();
+    for (auto& reader : readers) {
+      reader.join();
+    }
+
+    auto elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    state.SetIterationTime(elapsed_s);
+    total_rows_read += rows_read;
+    total_lock_wait_cycles += lock_wait_cycles;
+  }
+
+  state.counters["WriteP50us"] = benchmark::Counter(Percentile(write_latencies_us, 0.5));
+  state.counters["WriteP99us"] = benchmark::Counter(Percentile(write_latencies_us, 0.99));
+  state.counters["WriteP999us"] = benchmark::Counter(Percentile(write_latencies_us, 0.999));
+  state.counters["ScanRows"] = benchmark::Counter(total_rows_read, benchmark::Counter::kIsRate);
+  state.counters["LockWaitMs"] = benchmark::Counter(
+      1000.0 * total_lock_wait_cycles / absl::base_internal::CycleClock::Frequency(),
+      benchmark::Counter::kAvgIterations);
+  state.SetBytesProcessed(total_rows_read * kRowBytes);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
+BENCHMARK(BM_TableReadColdWithColumnRange);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
 BENCHMARK(BM_TableReadLastBatchAllCold)->Iterations(1000);
 BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableContention)
+    ->ArgNames({"readers", "rows_per_s"})
+    ->Args({1, 100 * 1000})
+    ->Args({4, 100 * 1000})
+    ->Args({16, 100 * 1000})
+    ->Args({4, 1000 * 1000})
+    ->UseManualTime()
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
 
 }  // namespace px::table_store
@@ -20,6 +20,11 @@
 #include <prometheus/counter.h>
 #include <string>
 
+namespace {
+const prometheus::Histogram::BucketBoundaries kIngestLatencyBuckets = {
+    0.01, 0.1, 0.5, 1, 2, 5, 10, 30, 60, 300};
+}  // namespace
+
 TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_name)
     : bytes_added_counter(prometheus::BuildCounter()
                               .Name("table_bytes_added")
@@ -63,8 +68,25 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                                .Help("The cap on the table size")
                                .Register(*registry)
                                .Add({{"name", table_name}})),
+      memory_pool_bytes_gauge(prometheus::BuildGauge()
+                                  .Name("table_memory_pool_bytes")
+                                  .Help("Current bytes allocated from the table's memory pool")
+                                  .Register(*registry)
+                                  .Add({{"name", table_name}})),
+      memory_pool_peak_bytes_gauge(prometheus::BuildGauge()
+                                       .Name("table_memory_pool_peak_bytes")
+                                       .Help("Peak bytes allocated from the table's memory pool")
+                                       .Register(*registry)
+                                       .Add({{"name", table_name}})),
       retention_ns_gauge(prometheus::BuildGauge()
                              .Name("min_time")
                              .Help("The current retention window for data in this table")
                              .Register(*registry)
-                             .Add({{"name", table_name}})) {}
+                             .Add({{"name", table_name}})),
+      ingest_latency_histogram(
+          prometheus::BuildHistogram()
+              .Name("table_ingest_latency_seconds")
+              .Help("Time from the event time of the first record of a sampled batch to the batch "
+                    "being queryable in the table")
+              .Register(*registry)
+              .Add({{"name", table_name}}, kIngestLatencyBuckets)) {}
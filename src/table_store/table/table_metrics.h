@@ -17,6 +17,7 @@
  */
 
 #pragma once
+#include <prometheus/histogram.h>
 #include <prometheus/registry.h>
 #include <string>
 
@@ -33,5 +34,9 @@ struct TableMetrics {
   prometheus::Counter& batches_expired_counter;
   prometheus::Counter& compacted_batches_counter;
   prometheus::Gauge& max_table_size_gauge;
+  prometheus::Gauge& memory_pool_bytes_gauge;
+  prometheus::Gauge& memory_pool_peak_bytes_gauge;
   prometheus::Gauge& retention_ns_gauge;
+  // The time from the event time of a sampled record to the record being queryable in the table.
+  prometheus::Histogram& ingest_latency_histogram;
 };
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <utility>
 #include <vector>
 
@@ -158,12 +159,69 @@ std::vector<uint64_t> TableStore::GetTableIDs() const {
   return ids;
 }
 
-Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
-  for (const auto& it : name_to_table_map_) {
-    PL_RETURN_IF_ERROR(it.second->CompactHotToCold(mem_pool));
+int64_t TableStore::MinTime() const {
+  int64_t min_time = -1;
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    int64_t table_min_time = table->GetTableStats().min_time;
+    if (table_min_time >= 0 && (min_time < 0 || table_min_time < min_time)) {
+      min_time = table_min_time;
+    }
+  }
+  return min_time;
+}
+
+Status TableStore::RunCompaction(const CompactionOptions& opts) {
+  auto deadline = std::chrono::steady_clock::time_point::max();
+  if (opts.time_slice.has_value()) {
+    deadline = std::chrono::steady_clock::now() + opts.time_slice.value();
+  }
+
+  struct TableToCompact {
+    Table* table;
+    double hot_fraction;
+  };
+  std::vector<TableToCompact> tables;
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    auto stats = table->GetTableStats();
+    if (stats.hot_bytes == 0) {
+      continue;
+    }
+    double hot_fraction =
+        static_cast<double>(stats.hot_bytes) / std::max<int64_t>(stats.max_table_size, 1);
+    tables.push_back({table.get(), hot_fraction});
+  }
+  // ParallelFor hands out tables in order, so sorting them sets the order they are started in.
+  std::sort(tables.begin(), tables.end(), [](const TableToCompact& a, const TableToCompact& b) {
+    return a.hot_fraction > b.hot_fraction;
+  });
+
+  std::vector<Status> statuses(tables.size());
+  ParallelFor(opts.pool, tables.size(), [&](size_t i) {
+    statuses[i] = tables[i].table->CompactHotToCold(deadline);
+  });
+  for (const auto& s : statuses) {
+    PL_RETURN_IF_ERROR(s);
   }
   return Status::OK();
 }
 
+std::optional<int64_t> TableStore::GetCursorPosition(std::string_view cursor_name,
+                                                     const std::string& table_name,
+                                                     const types::TabletID& tablet_id) const {
+  absl::MutexLock lock(&cursor_positions_lock_);
+  auto it = cursor_positions_.find({std::string(cursor_name), NameTablet{table_name, tablet_id}});
+  if (it == cursor_positions_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void TableStore::SetCursorPosition(std::string_view cursor_name, const std::string& table_name,
+                                   const types::TabletID& tablet_id, int64_t last_read_row_id) {
+  absl::MutexLock lock(&cursor_positions_lock_);
+  cursor_positions_[{std::string(cursor_name), NameTablet{table_name, tablet_id}}] =
+      last_read_row_id;
+}
+
 }  // namespace table_store
 }  // namespace px
@@ -18,15 +18,21 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <absl/base/thread_annotations.h>
 #include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
@@ -73,6 +79,17 @@ struct TableInfo {
   schema::Relation relation;
 };
 
+/**
+ * CompactionOptions configures TableStore::RunCompaction().
+ */
+struct CompactionOptions {
+  // Tables are compacted in parallel on this pool, or one at a time on the calling thread if null.
+  ThreadPool* pool = nullptr;
+  // If set, compaction stops creating cold batches once it has run for this long. The remaining
+  // hot batches are compacted by later runs.
+  std::optional<std::chrono::milliseconds> time_slice;
+};
+
 /**
  * TableStore keeps track of the tables in our system.
  */
@@ -165,7 +182,36 @@ class TableStore {
     return "";
   }
 
-  Status RunCompaction(arrow::MemoryPool* mem_pool);
+  /**
+   * RunCompaction compacts the hot batches of all tables into cold batches. The tables with the
+   * most hot data relative to their size are compacted first, since they are the closest to
+   * expiring hot data that was never compacted.
+   * @param opts how to parallelize and time slice compaction.
+   * @return Status: the first error of any table's compaction.
+   */
+  Status RunCompaction(const CompactionOptions& opts = {});
+
+  /**
+   * MinTime returns the time of the oldest row of all the tables, or -1 if they are all empty.
+   */
+  int64_t MinTime() const;
+
+  /**
+   * Named cursors let repeated queries, e.g. a periodic export script, resume reading a table
+   * right after the last row read by their previous execution.
+   *
+   * @param cursor_name: the name of the cursor, e.g. the ID of the script.
+   * @return the last row ID read from the table by the named cursor, if it has read any.
+   */
+  std::optional<int64_t> GetCursorPosition(std::string_view cursor_name,
+                                           const std::string& table_name,
+                                           const types::TabletID& tablet_id) const;
+
+  /**
+   * Saves the last row ID read from the table by the named cursor.
+   */
+  void SetCursorPosition(std::string_view cursor_name, const std::string& table_name,
+                         const types::TabletID& tablet_id, int64_t last_read_row_id);
 
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
@@ -197,6 +243,11 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+
+  // The positions of the named cursors, keyed by cursor name and table.
+  mutable absl::Mutex cursor_positions_lock_;
+  absl::flat_hash_map<std::pair<std::string, NameTablet>, int64_t> cursor_positions_
+      ABSL_GUARDED_BY(cursor_positions_lock_);
 };
 
 }  // namespace table_store
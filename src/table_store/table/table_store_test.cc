@@ -20,8 +20,12 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
 #include <vector>
 
+#include "src/common/base/thread_pool.h"
 #include "src/common/testing/testing.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_descriptor.h"
@@ -191,6 +195,34 @@ relation_map {
   }
 }
 )proto";
+TEST_F(TableStoreTest, run_compaction) {
+  // Each batch of MakeRel1ColumnWrapperBatch() has 3 rows of a bool and a float64.
+  int64_t batch_size = 3 * (sizeof(bool) + sizeof(double));
+  auto table_a = std::make_shared<Table>("a", rel1, 100 * batch_size, batch_size);
+  auto table_b = std::make_shared<Table>("b", rel1, 100 * batch_size, batch_size);
+  auto table_store = TableStore();
+  table_store.AddTable(table_a, "a", 1);
+  table_store.AddTable(table_b, "b", 2);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_OK(table_store.AppendData(1, "", MakeRel1ColumnWrapperBatch()));
+    EXPECT_OK(table_store.AppendData(2, "", MakeRel1ColumnWrapperBatch()));
+  }
+
+  // Without any time, nothing is compacted.
+  EXPECT_OK(table_store.RunCompaction({.time_slice = std::chrono::milliseconds(0)}));
+  EXPECT_EQ(table_a->GetTableStats().compacted_batches, 0);
+  EXPECT_EQ(table_b->GetTableStats().compacted_batches, 0);
+
+  ThreadPool pool(2);
+  EXPECT_OK(table_store.RunCompaction({.pool = &pool}));
+  for (const auto& table : {table_a, table_b}) {
+    auto stats = table->GetTableStats();
+    EXPECT_EQ(stats.compacted_batches, 4);
+    EXPECT_EQ(stats.hot_bytes, 0);
+    EXPECT_EQ(stats.cold_bytes, 4 * batch_size);
+  }
+}
+
 TEST_F(TableStoreTest, to_proto) {
   auto table_store = TableStore();
   table_store.AddTable(table1, "a");
@@ -204,6 +236,22 @@ TEST_F(TableStoreTest, to_proto) {
   EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(actual_schema, expected_schema));
 }
 
+TEST_F(TableStoreTest, cursor_positions) {
+  auto table_store = TableStore();
+  EXPECT_FALSE(table_store.GetCursorPosition("export", "a", "").has_value());
+
+  table_store.SetCursorPosition("export", "a", "", 10);
+  table_store.SetCursorPosition("export", "a", "1", 20);
+  table_store.SetCursorPosition("other", "a", "", 30);
+  EXPECT_EQ(10, table_store.GetCursorPosition("export", "a", "").value());
+  EXPECT_EQ(20, table_store.GetCursorPosition("export", "a", "1").value());
+  EXPECT_EQ(30, table_store.GetCursorPosition("other", "a", "").value());
+  EXPECT_FALSE(table_store.GetCursorPosition("export", "b", "").has_value());
+
+  table_store.SetCursorPosition("export", "a", "", 15);
+  EXPECT_EQ(15, table_store.GetCursorPosition("export", "a", "").value());
+}
+
 class TableStoreTabletsTest : public TableStoreTest {
  protected:
   void SetUp() override {
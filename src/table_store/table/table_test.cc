@@ -16,13 +16,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/strings/substitute.h>
 #include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <filesystem>
+#include <iterator>
 #include <random>
+#include <thread>
 #include <vector>
 
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/testing.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/schema/relation.h"
@@ -198,9 +203,93 @@ TEST(TableTest, bytes_test_w_compaction) {
 
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch_1)));
 
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size + rb3_size);
+  // The cold batch is allocated from the table's memory pool.
+  EXPECT_GT(table.GetTableStats().memory_pool_bytes, 0);
+  EXPECT_GE(table.GetTableStats().memory_pool_peak_bytes,
+            table.GetTableStats().memory_pool_bytes);
+}
+
+TEST(TableTest, dictionary_encoded_compaction_test) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"},
+                       {"", ""}, {types::ST_NONE, types::ST_NONE},
+                       {types::UNSPECIFIED, types::GENERAL_ENUM});
+
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), 8);
+  std::vector<types::Int64Value> col1 = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<types::StringValue> col2 = {"kube-system", "default", "kube-system", "default",
+                                          "kube-system", "default", "kube-system", "default"};
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+  int64_t rb_size = 8 * sizeof(int64_t) + 72 * sizeof(char) + 8 * sizeof(uint32_t);
+  // The dictionary holds each of the 2 values once, along with their offsets.
+  int64_t encoded_size = rb_size - 72 * sizeof(char) + 18 * sizeof(char) + 2 * sizeof(uint32_t);
+
+  Table table("test_table", rel, 128 * 1024, rb_size);
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold());
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(stats.compacted_batches, 1);
+  EXPECT_EQ(stats.hot_bytes, 0);
+  EXPECT_EQ(stats.cold_bytes, encoded_size);
+
+  // Readers get back the plain string column.
+  Table::Cursor cursor(&table);
+  auto out_rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(out_rb->ColumnAt(0)->Equals(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_TRUE(out_rb->ColumnAt(1)->Equals(types::ToArrow(col2, arrow::default_memory_pool())));
+}
+
+TEST(TableTest, compressed_compaction_test) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64, types::DataType::STRING},
+                       {"time_", "latency", "body"});
+
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), 100);
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> latencies;
+  std::vector<types::StringValue> bodies;
+  int64_t body_bytes = 0;
+  for (int i = 0; i < 100; ++i) {
+    times.push_back(1000 + i);
+    latencies.push_back(i % 50);
+    bodies.push_back(absl::Substitute(R"({"id": $0, "status": "ok", "items": []})", i));
+    body_bytes += bodies.back().size();
+  }
+  EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(bodies, arrow::default_memory_pool())));
+  int64_t rb_size = 100 * (2 * sizeof(int64_t) + sizeof(uint32_t)) + body_bytes;
+
+  Table table("test_table", rel, 128 * 1024, rb_size);
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold());
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(stats.compacted_batches, 1);
+  ASSERT_EQ(stats.cold_column_stats.size(), 3U);
+  // The time column stays plain, so that it can be searched.
+  EXPECT_EQ(stats.cold_column_stats[0].plain_bytes, 100 * sizeof(int64_t));
+  EXPECT_EQ(stats.cold_column_stats[0].encoded_bytes, 100 * sizeof(int64_t));
+  // Latencies under 50 are packed to 6 bits each.
+  EXPECT_EQ(stats.cold_column_stats[1].plain_bytes, 100 * sizeof(int64_t));
+  EXPECT_EQ(stats.cold_column_stats[1].encoded_bytes, 10 * sizeof(uint64_t));
+  // The bodies are deflated.
+  EXPECT_EQ(stats.cold_column_stats[2].plain_bytes, 100 * sizeof(uint32_t) + body_bytes);
+  EXPECT_LT(stats.cold_column_stats[2].encoded_bytes, stats.cold_column_stats[2].plain_bytes);
+  EXPECT_EQ(stats.cold_bytes, stats.cold_column_stats[0].encoded_bytes +
+                                  stats.cold_column_stats[1].encoded_bytes +
+                                  stats.cold_column_stats[2].encoded_bytes);
+
+  // Readers get back the plain columns.
+  Table::Cursor cursor(&table);
+  auto out_rb = cursor.GetNextRowBatch({0, 1, 2}).ConsumeValueOrDie();
+  EXPECT_TRUE(out_rb->ColumnAt(0)->Equals(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_TRUE(
+      out_rb->ColumnAt(1)->Equals(types::ToArrow(latencies, arrow::default_memory_pool())));
+  EXPECT_TRUE(out_rb->ColumnAt(2)->Equals(types::ToArrow(bodies, arrow::default_memory_pool())));
 }
 
 TEST(TableTest, expiry_test) {
@@ -358,7 +447,7 @@ TEST(TableTest, expiry_test_w_compaction) {
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size);
 
   EXPECT_OK(table.WriteRowBatch(rb2));
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
 
   EXPECT_OK(table.WriteRowBatch(rb3));
@@ -491,13 +580,169 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb1->ColumnAt(0)->Equals(types::ToArrow(col1_in1, arrow::default_memory_pool())));
   EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col2_in1, arrow::default_memory_pool())));
 
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   auto rb2 = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
   EXPECT_TRUE(rb2->ColumnAt(0)->Equals(types::ToArrow(col1_in2, arrow::default_memory_pool())));
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+namespace {
+
+std::unique_ptr<types::ColumnWrapperRecordBatch> TimeAndLatencyRecordBatch(
+    const std::vector<types::Time64NSValue>& times,
+    const std::vector<types::Int64Value>& latencies) {
+  auto record_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  record_batch->push_back(types::ColumnWrapper::FromArrow(
+      types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+  record_batch->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(latencies, arrow::default_memory_pool())));
+  return record_batch;
+}
+
+// Reads the table with a cursor that skips batches without latencies of at least min_latency,
+// and returns the latencies of the rows that were read.
+std::vector<int64_t> ReadLatenciesAtLeast(const Table* table, int64_t min_latency) {
+  Table::Cursor cursor(table);
+  cursor.SetColumnRanges({{1, min_latency}});
+  std::vector<int64_t> latencies;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      latencies.push_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i));
+    }
+  }
+  return latencies;
+}
+
+}  // namespace
+
+TEST(TableTest, cursor_skips_batches_outside_of_column_ranges) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "latency"});
+  Table table("test_table", rel, 128 * 1024, 2 * sizeof(int64_t) * 2);
+
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({1, 2}, {1, 2})));
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({3, 4}, {100, 200})));
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({5, 6}, {3, 4})));
+
+  // Only hot batches.
+  EXPECT_THAT(ReadLatenciesAtLeast(&table, 100), ::testing::ElementsAre(100, 200));
+  EXPECT_THAT(ReadLatenciesAtLeast(&table, 1000), ::testing::IsEmpty());
+
+  // The zone maps are recomputed for cold batches, which may hold more than one hot batch.
+  EXPECT_OK(table.CompactHotToCold());
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({7, 8}, {300, 5})));
+
+  auto latencies = ReadLatenciesAtLeast(&table, 100);
+  EXPECT_THAT(latencies, ::testing::IsSupersetOf({100, 200, 300}));
+  EXPECT_LT(latencies.size(), 8U);
+  EXPECT_THAT(ReadLatenciesAtLeast(&table, 1000), ::testing::IsEmpty());
+}
+
+TEST(TableTest, cursor_skips_cold_batches_without_column_equals) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "trace_id"});
+  // Each hot batch of 100 rows with 11 byte trace IDs is compacted into a cold batch of its own.
+  Table table("test_table", rel, 128 * 1024, 100 * (sizeof(int64_t) + sizeof(int32_t) + 11));
+  EXPECT_NOT_OK(table.SetBloomFilterColumns({"time_"}));
+  EXPECT_NOT_OK(table.SetBloomFilterColumns({"span_id"}));
+  ASSERT_OK(table.SetBloomFilterColumns({"trace_id"}));
+
+  for (int i = 0; i < 4; ++i) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> trace_ids;
+    for (int j = 0; j < 100; ++j) {
+      times.push_back(i * 100 + j);
+      trace_ids.push_back(absl::Substitute("trace-$0-$1", i, 100 + j));
+    }
+    auto record_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    record_batch->push_back(types::ColumnWrapper::FromArrow(
+        types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+    record_batch->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(trace_ids, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(record_batch)));
+  }
+  EXPECT_OK(table.CompactHotToCold());
+  ASSERT_EQ(table.GetTableStats().num_batches, 4);
+
+  auto read_trace_ids = [&table](std::vector<std::string> values) {
+    Table::Cursor cursor(&table);
+    cursor.SetColumnEquals({{1, std::move(values)}});
+    std::vector<std::string> trace_ids;
+    while (!cursor.Done()) {
+      auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        trace_ids.push_back(
+            types::GetValueFromArrowArray<types::DataType::STRING>(rb->ColumnAt(0).get(), i));
+      }
+    }
+    return trace_ids;
+  };
+  // Only the batch with the trace ID is read, barring false positives.
+  auto trace_ids = read_trace_ids({"trace-2-142"});
+  EXPECT_THAT(trace_ids, ::testing::Contains("trace-2-142"));
+  EXPECT_LT(trace_ids.size(), 400U);
+  EXPECT_LT(read_trace_ids({"trace-5-100"}).size(), 400U);
+  // Batches with any of the values are read.
+  trace_ids = read_trace_ids({"trace-0-107", "trace-3-109"});
+  EXPECT_THAT(trace_ids, ::testing::IsSupersetOf({"trace-0-107", "trace-3-109"}));
+  EXPECT_LT(trace_ids.size(), 400U);
+}
+
+TEST(TableTest, cursor_filters_rows_before_reading_other_columns) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64, types::DataType::STRING},
+                       {"time_", "latency", "body"});
+  Table table("test_table", rel, 1024 * 1024, 100 * (2 * sizeof(int64_t) + sizeof(int32_t) + 64));
+  constexpr char kBody[] = R"({"batch": $0, "row": $1, "items": [], "ok": true})";
+
+  auto write_batch = [&table, &kBody](int i) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::Int64Value> latencies;
+    std::vector<types::StringValue> bodies;
+    for (int j = 0; j < 100; ++j) {
+      times.push_back(i * 100 + j);
+      // One in ten requests is slow.
+      latencies.push_back(j % 10 == 0 ? 100 + j : j % 10);
+      bodies.push_back(absl::Substitute(kBody, i, j));
+    }
+    auto record_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    record_batch->push_back(types::ColumnWrapper::FromArrow(
+        types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+    record_batch->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(latencies, arrow::default_memory_pool())));
+    record_batch->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(bodies, arrow::default_memory_pool())));
+    return table.TransferRecordBatch(std::move(record_batch));
+  };
+  // Two batches of compressed cold rows, and one of hot rows.
+  ASSERT_OK(write_batch(0));
+  ASSERT_OK(write_batch(1));
+  ASSERT_OK(table.CompactHotToCold());
+  ASSERT_OK(write_batch(2));
+
+  Table::Cursor cursor(&table);
+  cursor.SetColumnRanges({{1, 100}});
+  cursor.SetFilterRows(true);
+  std::vector<int64_t> times;
+  std::vector<std::string> bodies;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0, 2}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      times.push_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+      bodies.push_back(
+          types::GetValueFromArrowArray<types::DataType::STRING>(rb->ColumnAt(1).get(), i));
+    }
+  }
+  ASSERT_EQ(times.size(), 30);
+  ASSERT_EQ(bodies.size(), 30);
+  for (size_t k = 0; k < times.size(); ++k) {
+    EXPECT_EQ(times[k], static_cast<int64_t>(k * 10));
+    EXPECT_EQ(bodies[k], absl::Substitute(kBody, times[k] / 100, times[k] % 100));
+  }
+  EXPECT_EQ(cursor.rows_filtered(), 270);
+}
+
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
@@ -595,7 +840,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
 
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0));
   EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5));
 
@@ -614,7 +859,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
 
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
   EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6));
 
   EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8));
@@ -642,7 +887,7 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   wrapper_batch->push_back(col_wrapper);
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
   // Run Compaction.
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13));
 
@@ -778,10 +1023,10 @@ TEST(TableTest, threaded) {
 
   std::thread compaction_thread([table_ptr, done]() {
     while (!done->WaitForNotificationWithTimeout(absl::Milliseconds(50))) {
-      EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+      EXPECT_OK(table_ptr->CompactHotToCold());
     }
     // Do one last compaction after writer thread has finished writing.
-    EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+    EXPECT_OK(table_ptr->CompactHotToCold());
   });
 
   // Create the cursor before the write thread starts, to ensure that we get every row of the table.
@@ -882,7 +1127,7 @@ TEST(TableTest, NextBatch_generation_bug) {
   EXPECT_OK(rb1.AddColumn(col2_rb1_arrow));
 
   EXPECT_OK(table.WriteRowBatch(rb1));
-  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_OK(table.CompactHotToCold());
 
   Table::Cursor cursor(&table, Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{});
   // Force cold expiration.
@@ -937,5 +1182,179 @@ TEST(TableTest, GetNextRowBatch_after_expiry) {
   EXPECT_TRUE(rb1->ColumnAt(0)->Equals(types::ToArrow(col1_in2, arrow::default_memory_pool())));
   EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
+
+TEST(TableTest, disk_tier_test) {
+  testing::TempDir tmp_dir;
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"col1", "col2"});
+  auto make_rb = [&](int64_t i) {
+    schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), 10);
+    std::vector<types::Int64Value> col1;
+    std::vector<types::Int64Value> col2;
+    for (int64_t j = 0; j < 10; ++j) {
+      col1.push_back(i * 10 + j);
+      col2.push_back(-(i * 10 + j));
+    }
+    PL_CHECK_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    PL_CHECK_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    return rb;
+  };
+  int64_t rb_size = 10 * 2 * sizeof(int64_t);
+  // A header, and two columns of 80 bytes, each aligned to 64 bytes.
+  int64_t file_size = 64 + 2 * 128;
+
+  Table::DiskTierOptions disk_tier;
+  disk_tier.dir = tmp_dir.path() / "test_table";
+  disk_tier.max_bytes = 2 * file_size;
+  Table table("test_table", rel, 3 * rb_size, rb_size, disk_tier);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_OK(table.WriteRowBatch(make_rb(i)));
+  }
+  EXPECT_OK(table.CompactHotToCold());
+  // Each of these writes expires a cold batch to disk, and the last one also deletes the oldest
+  // batch from disk, to stay within its size limit.
+  for (int64_t i = 3; i < 6; ++i) {
+    EXPECT_OK(table.WriteRowBatch(make_rb(i)));
+  }
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(stats.bytes, 3 * rb_size);
+  EXPECT_EQ(stats.disk_batches, 2);
+  EXPECT_EQ(stats.disk_bytes, 2 * file_size);
+  EXPECT_EQ(std::distance(std::filesystem::directory_iterator(disk_tier.dir),
+                          std::filesystem::directory_iterator()),
+            2);
+
+  // Readers see the batches on disk, followed by the ones in memory.
+  Table::Cursor cursor(&table);
+  for (int64_t i = 1; i < 6; ++i) {
+    ASSERT_FALSE(cursor.Done());
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(make_rb(i).ColumnAt(0))) << i;
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(make_rb(i).ColumnAt(1))) << i;
+  }
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, snapshot_restore_test) {
+  testing::TempDir tmp_dir;
+  auto snapshot_dir = tmp_dir.path() / "test_table";
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"col1", "col2"});
+  auto make_rb = [&](int64_t i) {
+    schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), 10);
+    std::vector<types::Int64Value> col1;
+    std::vector<types::Int64Value> col2;
+    for (int64_t j = 0; j < 10; ++j) {
+      col1.push_back(i * 10 + j);
+      col2.push_back(-(i * 10 + j));
+    }
+    PL_CHECK_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    PL_CHECK_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    return rb;
+  };
+  auto num_files = [&]() {
+    return std::distance(std::filesystem::directory_iterator(snapshot_dir),
+                         std::filesystem::directory_iterator());
+  };
+  auto expect_batches = [&](const Table& table, int64_t first, int64_t last) {
+    Table::Cursor cursor(&table);
+    for (int64_t i = first; i <= last; ++i) {
+      ASSERT_FALSE(cursor.Done());
+      auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+      EXPECT_TRUE(rb->ColumnAt(0)->Equals(make_rb(i).ColumnAt(0))) << i;
+      EXPECT_TRUE(rb->ColumnAt(1)->Equals(make_rb(i).ColumnAt(1))) << i;
+    }
+    EXPECT_TRUE(cursor.Done());
+  };
+  int64_t rb_size = 10 * 2 * sizeof(int64_t);
+
+  Table table("test_table", rel, 3 * rb_size, rb_size);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_OK(table.WriteRowBatch(make_rb(i)));
+  }
+  EXPECT_OK(table.CompactHotToCold());
+  EXPECT_OK(table.WriteSnapshot(snapshot_dir));
+  EXPECT_EQ(num_files(), 3);
+
+  // Without a disk tier, the restored batches are kept within the table's size limit, which is
+  // larger than the one they were written under, since their files are larger than the batches.
+  {
+    Table restored("test_table", rel, 16 * rb_size, rb_size);
+    EXPECT_OK(restored.RestoreSnapshot(snapshot_dir));
+    EXPECT_EQ(restored.GetTableStats().disk_batches, 3);
+    // New rows follow the restored ones.
+    EXPECT_OK(restored.WriteRowBatch(make_rb(3)));
+    expect_batches(restored, 0, 3);
+    EXPECT_NOT_OK(restored.RestoreSnapshot(snapshot_dir));
+  }
+  // Restoring doesn't consume the snapshot.
+  EXPECT_EQ(num_files(), 3);
+
+  // These writes expire the first two cold batches, whose files the next snapshot replaces with
+  // those of the newly compacted batches.
+  for (int64_t i = 3; i < 5; ++i) {
+    EXPECT_OK(table.WriteRowBatch(make_rb(i)));
+  }
+  EXPECT_OK(table.CompactHotToCold());
+  EXPECT_OK(table.WriteSnapshot(snapshot_dir));
+  EXPECT_EQ(num_files(), 3);
+
+  Table restored("test_table", rel, 16 * rb_size, rb_size);
+  EXPECT_OK(restored.RestoreSnapshot(snapshot_dir));
+  expect_batches(restored, 2, 4);
+}
+
+TEST(TableTest, cursor_resumes_after_row_id) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "latency"});
+  Table table("test_table", rel, 128 * 1024, 2 * sizeof(int64_t) * 2);
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({1, 2}, {10, 20})));
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({3, 4}, {30, 40})));
+
+  Table::Cursor first_cursor(&table);
+  while (!first_cursor.Done()) {
+    EXPECT_OK(first_cursor.GetNextRowBatch({1}));
+  }
+  EXPECT_EQ(3, first_cursor.last_read_row_id());
+
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({5, 6}, {50, 60})));
+
+  Table::Cursor::StartSpec start_spec;
+  start_spec.type = Table::Cursor::StartSpec::StartType::AfterRowID;
+  start_spec.row_id = first_cursor.last_read_row_id();
+  Table::Cursor cursor(&table, start_spec, Table::Cursor::StopSpec{});
+  auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{50, 60}, arrow::default_memory_pool())));
+  EXPECT_TRUE(cursor.Done());
+  EXPECT_EQ(5, cursor.last_read_row_id());
+}
+
+TEST(TableTest, last_read_time_set_by_cursor) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  std::shared_ptr<Table> table_ptr = Table::Create("test_table", rel);
+
+  auto created_time = table_ptr->last_read_time();
+  EXPECT_LE(created_time, std::chrono::steady_clock::now());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  Table::Cursor cursor(table_ptr.get());
+  EXPECT_GT(table_ptr->last_read_time(), created_time);
+}
+
+TEST(TableTest, write_subscribers_called_until_unsubscribed) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "latency"});
+  Table table("test_table", rel, 128 * 1024);
+
+  int num_writes = 0;
+  auto id = table.SubscribeToWrites([&num_writes]() { ++num_writes; });
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({1, 2}, {10, 20})));
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({3, 4}, {30, 40})));
+  EXPECT_EQ(2, num_writes);
+
+  table.UnsubscribeFromWrites(id);
+  EXPECT_OK(table.TransferRecordBatch(TimeAndLatencyRecordBatch({5, 6}, {50, 60})));
+  EXPECT_EQ(2, num_writes);
+}
+
 }  // namespace table_store
 }  // namespace px
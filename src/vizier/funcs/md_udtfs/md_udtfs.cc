@@ -23,6 +23,10 @@
 #include "src/vizier/funcs/context/vizier_context.h"
 #include "src/vizier/funcs/md_udtfs/md_udtfs_impl.h"
 
+DEFINE_int64(md_udtf_cache_ttl_ms, gflags::Int64FromEnv("PL_MD_UDTF_CACHE_TTL_MS", 1000),
+             "How long the metadata service responses of polled UDTFs, such as GetAgentStatus and "
+             "GetTables, are reused by later queries. Disabled if 0.");
+
 namespace px {
 namespace vizier {
 namespace funcs {
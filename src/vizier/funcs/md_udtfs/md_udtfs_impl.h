@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -36,6 +37,7 @@
 #include "src/common/base/base.h"
 #include "src/common/uuid/uuid.h"
 #include "src/shared/types/typespb/types.pb.h"
+#include "src/vizier/funcs/md_udtfs/response_cache.h"
 #include "src/vizier/services/agent/manager/manager.h"
 #include "src/vizier/services/metadata/metadatapb/service.grpc.pb.h"
 
@@ -43,32 +45,56 @@ namespace px {
 namespace vizier {
 namespace funcs {
 namespace md {
+
+// Makes a UDTF that calls the metadata service through the stub. The UDTFs that are polled take
+// the factory's response cache as a third argument, so that their instances share responses.
+template <typename TUDTF, typename TStub>
+std::unique_ptr<carnot::udf::AnyUDTF> MakeUDTFWithStub(
+    std::shared_ptr<TStub> stub, std::function<void(grpc::ClientContext*)> add_auth,
+    const std::shared_ptr<ResponseCache>& cache) {
+  if constexpr (std::is_constructible_v<TUDTF, std::shared_ptr<TStub>,
+                                        std::function<void(grpc::ClientContext*)>,
+                                        std::shared_ptr<ResponseCache>>) {
+    return std::make_unique<TUDTF>(std::move(stub), std::move(add_auth), cache);
+  } else {
+    return std::make_unique<TUDTF>(std::move(stub), std::move(add_auth));
+  }
+}
+
 template <typename TUDTF>
 class UDTFWithMDFactory : public carnot::udf::UDTFFactory {
  public:
   UDTFWithMDFactory() = delete;
-  explicit UDTFWithMDFactory(const VizierFuncFactoryContext& ctx) : ctx_(ctx) {}
+  explicit UDTFWithMDFactory(const VizierFuncFactoryContext& ctx)
+      : ctx_(ctx),
+        cache_(std::make_shared<ResponseCache>(
+            std::chrono::milliseconds(FLAGS_md_udtf_cache_ttl_ms))) {}
 
   std::unique_ptr<carnot::udf::AnyUDTF> Make() override {
-    return std::make_unique<TUDTF>(ctx_.mds_stub(), ctx_.add_auth_to_grpc_context_func());
+    return MakeUDTFWithStub<TUDTF>(ctx_.mds_stub(), ctx_.add_auth_to_grpc_context_func(), cache_);
   }
 
  private:
   const VizierFuncFactoryContext& ctx_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 template <typename TUDTF>
 class UDTFWithMDTPFactory : public carnot::udf::UDTFFactory {
  public:
   UDTFWithMDTPFactory() = delete;
-  explicit UDTFWithMDTPFactory(const VizierFuncFactoryContext& ctx) : ctx_(ctx) {}
+  explicit UDTFWithMDTPFactory(const VizierFuncFactoryContext& ctx)
+      : ctx_(ctx),
+        cache_(std::make_shared<ResponseCache>(
+            std::chrono::milliseconds(FLAGS_md_udtf_cache_ttl_ms))) {}
 
   std::unique_ptr<carnot::udf::AnyUDTF> Make() override {
-    return std::make_unique<TUDTF>(ctx_.mdtp_stub(), ctx_.add_auth_to_grpc_context_func());
+    return MakeUDTFWithStub<TUDTF>(ctx_.mdtp_stub(), ctx_.add_auth_to_grpc_context_func(), cache_);
   }
 
  private:
   const VizierFuncFactoryContext& ctx_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 template <typename TUDTF>
@@ -123,8 +149,12 @@ class GetTables final : public carnot::udf::UDTF<GetTables> {
   using SchemaResponse = vizier::services::metadata::SchemaResponse;
   GetTables() = delete;
   GetTables(std::shared_ptr<MDSStub> stub,
-            std::function<void(grpc::ClientContext*)> add_context_authentication)
-      : idx_(0), stub_(stub), add_context_authentication_func_(add_context_authentication) {}
+            std::function<void(grpc::ClientContext*)> add_context_authentication,
+            std::shared_ptr<ResponseCache> cache)
+      : idx_(0),
+        stub_(stub),
+        add_context_authentication_func_(add_context_authentication),
+        cache_(std::move(cache)) {}
 
   static constexpr auto Executor() { return carnot::udfspb::UDTFSourceExecutor::UDTF_ONE_KELVIN; }
 
@@ -137,16 +167,17 @@ class GetTables final : public carnot::udf::UDTF<GetTables> {
 
   Status Init(FunctionContext*) {
     px::vizier::services::metadata::SchemaRequest req;
-    px::vizier::services::metadata::SchemaResponse resp;
-
-    grpc::ClientContext ctx;
-    add_context_authentication_func_(&ctx);
-    auto s = stub_->GetSchemas(&ctx, req, &resp);
-    if (!s.ok()) {
-      return error::Internal("Failed to make RPC call to metadata service");
-    }
+    PL_ASSIGN_OR_RETURN(auto resp, cache_->GetOrFetch<SchemaResponse>(req, [&](SchemaResponse* r) {
+      grpc::ClientContext ctx;
+      add_context_authentication_func_(&ctx);
+      auto s = stub_->GetSchemas(&ctx, req, r);
+      if (!s.ok()) {
+        return error::Internal("Failed to make RPC call to metadata service");
+      }
+      return Status::OK();
+    }));
 
-    for (const auto& [table_name, rel] : resp.schema().relation_map()) {
+    for (const auto& [table_name, rel] : resp->schema().relation_map()) {
       table_info_.emplace_back(table_name, rel.desc());
     }
     return Status::OK();
@@ -176,6 +207,7 @@ class GetTables final : public carnot::udf::UDTF<GetTables> {
   std::vector<TableInfo> table_info_;
   std::shared_ptr<MDSStub> stub_;
   std::function<void(grpc::ClientContext*)> add_context_authentication_func_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 /**
@@ -187,8 +219,12 @@ class GetTableSchemas final : public carnot::udf::UDTF<GetTableSchemas> {
   using SchemaResponse = vizier::services::metadata::SchemaResponse;
   GetTableSchemas() = delete;
   GetTableSchemas(std::shared_ptr<MDSStub> stub,
-                  std::function<void(grpc::ClientContext*)> add_context_authentication)
-      : idx_(0), stub_(stub), add_context_authentication_func_(add_context_authentication) {}
+                  std::function<void(grpc::ClientContext*)> add_context_authentication,
+                  std::shared_ptr<ResponseCache> cache)
+      : idx_(0),
+        stub_(stub),
+        add_context_authentication_func_(add_context_authentication),
+        cache_(std::move(cache)) {}
 
   static constexpr auto Executor() { return carnot::udfspb::UDTFSourceExecutor::UDTF_ONE_KELVIN; }
 
@@ -207,19 +243,20 @@ class GetTableSchemas final : public carnot::udf::UDTF<GetTableSchemas> {
 
   Status Init(FunctionContext*) {
     px::vizier::services::metadata::SchemaRequest req;
-    px::vizier::services::metadata::SchemaResponse resp;
-
-    grpc::ClientContext ctx;
-    add_context_authentication_func_(&ctx);
-    auto s = stub_->GetSchemas(&ctx, req, &resp);
-    if (!s.ok()) {
-      return error::Internal("Failed to make RPC call to metadata service");
-    }
+    PL_ASSIGN_OR_RETURN(auto resp, cache_->GetOrFetch<SchemaResponse>(req, [&](SchemaResponse* r) {
+      grpc::ClientContext ctx;
+      add_context_authentication_func_(&ctx);
+      auto s = stub_->GetSchemas(&ctx, req, r);
+      if (!s.ok()) {
+        return error::Internal("Failed to make RPC call to metadata service");
+      }
+      return Status::OK();
+    }));
 
     // TODO(zasgar): We store the data since it's hard to traverse two maps at once. We should
     // either do that or perhaps have an interface that allows UDTFs to write multiple records in
     // a single invocation.
-    for (const auto& [table_name, rel] : resp.schema().relation_map()) {
+    for (const auto& [table_name, rel] : resp->schema().relation_map()) {
       for (const auto& col : rel.columns()) {
         relation_info_.emplace_back(
             table_name, col.column_name(), std::string(magic_enum::enum_name(col.column_type())),
@@ -265,6 +302,7 @@ class GetTableSchemas final : public carnot::udf::UDTF<GetTableSchemas> {
   std::vector<RelationInfo> relation_info_;
   std::shared_ptr<MDSStub> stub_;
   std::function<void(grpc::ClientContext*)> add_context_authentication_func_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 /**
@@ -275,9 +313,14 @@ class GetAgentStatus final : public carnot::udf::UDTF<GetAgentStatus> {
   using MDSStub = vizier::services::metadata::MetadataService::Stub;
   using SchemaResponse = vizier::services::metadata::SchemaResponse;
   GetAgentStatus() = delete;
+  using AgentInfoResponse = vizier::services::metadata::AgentInfoResponse;
   GetAgentStatus(std::shared_ptr<MDSStub> stub,
-                 std::function<void(grpc::ClientContext*)> add_context_authentication)
-      : idx_(0), stub_(stub), add_context_authentication_func_(add_context_authentication) {}
+                 std::function<void(grpc::ClientContext*)> add_context_authentication,
+                 std::shared_ptr<ResponseCache> cache)
+      : idx_(0),
+        stub_(stub),
+        add_context_authentication_func_(add_context_authentication),
+        cache_(std::move(cache)) {}
 
   static constexpr auto Executor() { return carnot::udfspb::UDTFSourceExecutor::UDTF_ONE_KELVIN; }
 
@@ -300,14 +343,16 @@ class GetAgentStatus final : public carnot::udf::UDTF<GetAgentStatus> {
 
   Status Init(FunctionContext*) {
     px::vizier::services::metadata::AgentInfoRequest req;
-    resp_ = std::make_unique<px::vizier::services::metadata::AgentInfoResponse>();
-
-    grpc::ClientContext ctx;
-    add_context_authentication_func_(&ctx);
-    auto s = stub_->GetAgentInfo(&ctx, req, resp_.get());
-    if (!s.ok()) {
-      return error::Internal("Failed to make RPC call to GetAgentInfo");
-    }
+    PL_ASSIGN_OR_RETURN(resp_,
+                        cache_->GetOrFetch<AgentInfoResponse>(req, [&](AgentInfoResponse* r) {
+                          grpc::ClientContext ctx;
+                          add_context_authentication_func_(&ctx);
+                          auto s = stub_->GetAgentInfo(&ctx, req, r);
+                          if (!s.ok()) {
+                            return error::Internal("Failed to make RPC call to GetAgentInfo");
+                          }
+                          return Status::OK();
+                        }));
     return Status::OK();
   }
 
@@ -337,9 +382,10 @@ class GetAgentStatus final : public carnot::udf::UDTF<GetAgentStatus> {
 
  private:
   int idx_ = 0;
-  std::unique_ptr<px::vizier::services::metadata::AgentInfoResponse> resp_;
+  std::shared_ptr<const AgentInfoResponse> resp_;
   std::shared_ptr<MDSStub> stub_;
   std::function<void(grpc::ClientContext*)> add_context_authentication_func_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 namespace internal {
@@ -632,15 +678,13 @@ class GetDebugMDWithPrefix final : public carnot::udf::UDTF<GetDebugMDWithPrefix
     return Status::OK();
   }
 
-  bool NextRecord(FunctionContext*, RecordWriter* rw) {
-    if (idx_ >= resp_->kvs().size()) {
-      return false;
+  // The values are whole text encoded protos, so this writes batches to keep them to their
+  // byte target.
+  bool NextBatch(FunctionContext*, RecordWriter* rw) {
+    for (; idx_ < resp_->kvs().size() && !rw->BatchFull(); ++idx_) {
+      rw->Append<IndexOf("key")>(resp_->kvs().Get(idx_).key());
+      rw->Append<IndexOf("value")>(resp_->kvs().Get(idx_).value());
     }
-
-    rw->Append<IndexOf("key")>(resp_->kvs().Get(idx_).key());
-    rw->Append<IndexOf("value")>(resp_->kvs().Get(idx_).value());
-    ++idx_;
-
     return idx_ < resp_->kvs().size();
   }
 
@@ -687,7 +731,9 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
                 "The maximum size of this table"),
         ColInfo("min_time", types::DataType::TIME64NS, types::PatternType::GENERAL,
                 "The minimum timestamp currently present in this table. -1 if there is no time_ "
-                "column on the table."));
+                "column on the table."),
+        ColInfo("reserved_size", types::DataType::INT64, types::PatternType::GENERAL,
+                "The part of max_table_size reserved for the table's retention policy"));
   }
   Status Init(FunctionContext*) {
     table_ids_ = table_store_->GetTableIDs();
@@ -715,6 +761,7 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
     rw->Append<IndexOf("cold_size")>(info.cold_bytes);
     rw->Append<IndexOf("max_table_size")>(info.max_table_size);
     rw->Append<IndexOf("min_time")>(info.min_time);
+    rw->Append<IndexOf("reserved_size")>(info.reserved_bytes);
 
     ++current_idx_;
     return static_cast<size_t>(current_idx_) < table_ids_.size();
@@ -734,9 +781,13 @@ class GetTracepointStatus final : public carnot::udf::UDTF<GetTracepointStatus>
   using MDTPStub = vizier::services::metadata::MetadataTracepointService::Stub;
   using TracepointResponse = vizier::services::metadata::GetTracepointInfoResponse;
   GetTracepointStatus() = delete;
-  explicit GetTracepointStatus(std::shared_ptr<MDTPStub> stub,
-                               std::function<void(grpc::ClientContext*)> add_context_authentication)
-      : idx_(0), stub_(stub), add_context_authentication_func_(add_context_authentication) {}
+  GetTracepointStatus(std::shared_ptr<MDTPStub> stub,
+                      std::function<void(grpc::ClientContext*)> add_context_authentication,
+                      std::shared_ptr<ResponseCache> cache)
+      : idx_(0),
+        stub_(stub),
+        add_context_authentication_func_(add_context_authentication),
+        cache_(std::move(cache)) {}
 
   static constexpr auto Executor() { return carnot::udfspb::UDTFSourceExecutor::UDTF_ONE_KELVIN; }
 
@@ -757,15 +808,18 @@ class GetTracepointStatus final : public carnot::udf::UDTF<GetTracepointStatus>
 
   Status Init(FunctionContext*) {
     px::vizier::services::metadata::GetTracepointInfoRequest req;
-    resp_ = std::make_unique<px::vizier::services::metadata::GetTracepointInfoResponse>();
-
-    grpc::ClientContext ctx;
-    add_context_authentication_func_(&ctx);
-    auto s = stub_->GetTracepointInfo(&ctx, req, resp_.get());
-    if (!s.ok()) {
-      return error::Internal("Failed to make RPC call to GetTracepointStatus: $0",
-                             s.error_message());
-    }
+    PL_ASSIGN_OR_RETURN(resp_,
+                        cache_->GetOrFetch<TracepointResponse>(req, [&](TracepointResponse* r) {
+                          grpc::ClientContext ctx;
+                          add_context_authentication_func_(&ctx);
+                          auto s = stub_->GetTracepointInfo(&ctx, req, r);
+                          if (!s.ok()) {
+                            return error::Internal(
+                                "Failed to make RPC call to GetTracepointStatus: $0",
+                                s.error_message());
+                          }
+                          return Status::OK();
+                        }));
     return Status::OK();
   }
 
@@ -842,9 +896,10 @@ class GetTracepointStatus final : public carnot::udf::UDTF<GetTracepointStatus>
 
  private:
   int idx_ = 0;
-  std::unique_ptr<px::vizier::services::metadata::GetTracepointInfoResponse> resp_;
+  std::shared_ptr<const TracepointResponse> resp_;
   std::shared_ptr<MDTPStub> stub_;
   std::function<void(grpc::ClientContext*)> add_context_authentication_func_;
+  std::shared_ptr<ResponseCache> cache_;
 };
 
 class GetCronScriptHistory final : public carnot::udf::UDTF<GetCronScriptHistory> {
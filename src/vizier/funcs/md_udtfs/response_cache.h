@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+#include <absl/synchronization/mutex.h>
+#include <google/protobuf/message.h>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(md_udtf_cache_ttl_ms);
+
+namespace px {
+namespace vizier {
+namespace funcs {
+namespace md {
+
+/**
+ * ResponseCache keeps the responses of the metadata service RPCs that a UDTF makes for a short
+ * TTL, so that the queries polling the UDTF (e.g. from the UI) share a single call. Concurrent
+ * queries that miss the cache for the same request wait for one call, rather than each making
+ * their own. Failed calls aren't cached.
+ */
+class ResponseCache {
+ public:
+  explicit ResponseCache(std::chrono::milliseconds ttl) : ttl_(ttl) {}
+
+  /**
+   * GetOrFetch returns the cached response to the request if it is younger than the TTL, or else
+   * calls fetch to get a new one.
+   */
+  template <typename TResponse>
+  StatusOr<std::shared_ptr<const TResponse>> GetOrFetch(
+      const google::protobuf::Message& req, const std::function<Status(TResponse*)>& fetch) {
+    if (ttl_.count() <= 0) {
+      auto resp = std::make_shared<TResponse>();
+      PL_RETURN_IF_ERROR(fetch(resp.get()));
+      return std::shared_ptr<const TResponse>(std::move(resp));
+    }
+
+    Entry* entry = GetEntry(absl::StrCat(req.GetTypeName(), "/", req.SerializeAsString()));
+    absl::MutexLock lock(&entry->lock);
+    if (entry->resp != nullptr && std::chrono::steady_clock::now() - entry->fetch_time < ttl_) {
+      return std::static_pointer_cast<const TResponse>(entry->resp);
+    }
+    auto resp = std::make_shared<TResponse>();
+    PL_RETURN_IF_ERROR(fetch(resp.get()));
+    entry->resp = resp;
+    entry->fetch_time = std::chrono::steady_clock::now();
+    return std::shared_ptr<const TResponse>(std::move(resp));
+  }
+
+ private:
+  struct Entry {
+    // Held while the response is fetched, so that concurrent misses wait for it.
+    absl::Mutex lock;
+    std::chrono::steady_clock::time_point fetch_time ABSL_GUARDED_BY(lock);
+    std::shared_ptr<const google::protobuf::Message> resp ABSL_GUARDED_BY(lock);
+  };
+
+  Entry* GetEntry(const std::string& key) {
+    absl::MutexLock lock(&entries_lock_);
+    auto& entry = entries_[key];
+    if (entry == nullptr) {
+      entry = std::make_unique<Entry>();
+    }
+    return entry.get();
+  }
+
+  const std::chrono::milliseconds ttl_;
+  absl::Mutex entries_lock_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Entry>> entries_ ABSL_GUARDED_BY(entries_lock_);
+};
+
+}  // namespace md
+}  // namespace funcs
+}  // namespace vizier
+}  // namespace px
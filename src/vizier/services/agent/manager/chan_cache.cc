@@ -24,18 +24,44 @@ namespace px {
 namespace vizier {
 namespace agent {
 
+ChanCacheMetrics::ChanCacheMetrics(prometheus::Registry* registry)
+    : hits(prometheus::BuildCounter()
+               .Name("agent_chan_cache_hits")
+               .Help("Lookups that reused a cached GRPC channel")
+               .Register(*registry)
+               .Add({})),
+      misses(prometheus::BuildCounter()
+                 .Name("agent_chan_cache_misses")
+                 .Help("Lookups that found no cached GRPC channel")
+                 .Register(*registry)
+                 .Add({})),
+      evictions(prometheus::BuildCounter()
+                    .Name("agent_chan_cache_evictions")
+                    .Help("Cached GRPC channels dropped for being idle or failing")
+                    .Register(*registry)
+                    .Add({})),
+      reconnects(prometheus::BuildCounter()
+                     .Name("agent_chan_cache_reconnects")
+                     .Help("Idle cached GRPC channels reconnected to keep them warm")
+                     .Register(*registry)
+                     .Add({})) {}
+
 std::shared_ptr<::grpc::Channel> ChanCache::GetChan(std::string_view remote_addr) {
   absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
   auto it = chan_cache_.find(remote_addr);
   if (it == chan_cache_.end()) {
+    metrics_.misses.Increment();
     return nullptr;
   }
+  metrics_.hits.Increment();
+  it->second.last_used_time = std::chrono::system_clock::now();
   return it->second.chan;
 }
 
 void ChanCache::Add(std::string remote_addr, std::shared_ptr<::grpc::Channel> chan) {
   absl::base_internal::SpinLockHolder lock(&chan_cache_lock_);
-  chan_cache_[remote_addr] = {chan, std::chrono::system_clock::now()};
+  auto time_now = std::chrono::system_clock::now();
+  chan_cache_[remote_addr] = {chan, time_now, time_now};
 }
 
 Status ChanCache::CleanupChans() {
@@ -50,6 +76,15 @@ Status ChanCache::CleanupChans() {
       remote_addrs_to_delete.push_back(remote_addr);
       continue;
     }
+    // Channels that are still in use are reconnected when they go idle, so that the next query
+    // doesn't pay for the connection setup.
+    if (time_now - chan.last_used_time < keep_warm_period_) {
+      if (state == grpc_connectivity_state::GRPC_CHANNEL_IDLE) {
+        chan.chan->GetState(/*try_to_connect*/ true);
+        metrics_.reconnects.Increment();
+      }
+      continue;
+    }
     std::chrono::nanoseconds age = time_now - chan.start_time;
     // If the age of the channel is still warming up, we don't kill it for being idle.
     if (age < warm_up_period_) {
@@ -64,6 +99,7 @@ Status ChanCache::CleanupChans() {
   for (const std::string& remote_addr : remote_addrs_to_delete) {
     chan_cache_.erase(remote_addr);
   }
+  metrics_.evictions.Increment(remote_addrs_to_delete.size());
   return Status::OK();
 }
 
@@ -26,12 +26,27 @@
 
 #include <absl/base/internal/spinlock.h>
 #include <absl/container/flat_hash_map.h>
+#include <prometheus/counter.h>
+#include <prometheus/registry.h>
 #include "src/common/base/base.h"
+#include "src/common/metrics/metrics.h"
 
 namespace px {
 namespace vizier {
 namespace agent {
 
+/**
+ * How often cached channels are reused, and how often they have to be dropped or reconnected.
+ */
+struct ChanCacheMetrics {
+  explicit ChanCacheMetrics(prometheus::Registry* registry);
+
+  prometheus::Counter& hits;
+  prometheus::Counter& misses;
+  prometheus::Counter& evictions;
+  prometheus::Counter& reconnects;
+};
+
 class ChanCache {
  public:
   /**
@@ -41,8 +56,15 @@ class ChanCache {
    * channel to be out of use. This is in place to prevent a race where we add a Chan and
    * CleanupChans() is called before the Connection can be used, meaning the channel will come up
    * idle.
+   * @param keep_warm_period channels that were looked up within this period are kept connected
+   * even if they go idle, so that the next query doesn't have to wait for a new connection.
    */
-  explicit ChanCache(std::chrono::nanoseconds warm_up_period) : warm_up_period_(warm_up_period) {}
+  ChanCache(std::chrono::nanoseconds warm_up_period, std::chrono::nanoseconds keep_warm_period)
+      : warm_up_period_(warm_up_period),
+        keep_warm_period_(keep_warm_period),
+        metrics_(&GetMetricsRegistry()) {}
+  explicit ChanCache(std::chrono::nanoseconds warm_up_period)
+      : ChanCache(warm_up_period, std::chrono::nanoseconds(0)) {}
   // Template to handle other duration types.
   template <typename T>
   explicit ChanCache(std::chrono::duration<int64_t, T> warm_up_period)
@@ -67,7 +89,8 @@ class ChanCache {
   /**
    * @brief Goes through the cached channels and verify whether they are still alive and have been
    * used recently. We consider a connection out of use if it is in a failure state or is idle and
-   * the connection is not in the warm up period.
+   * the connection is not in the warm up period. Idle connections that were looked up within the
+   * keep warm period are reconnected instead.
    *
    * The period where a connection goes from READY to IDLE can be adjusted with the channel
    * argument: GRPC_ARG_CLIENT_IDLE_TIMEOUT_MS. See the test for an example.
@@ -80,6 +103,7 @@ class ChanCache {
   struct Channel {
     std::shared_ptr<::grpc::Channel> chan;
     std::chrono::system_clock::time_point start_time;
+    std::chrono::system_clock::time_point last_used_time;
   };
 
   // The cache of channels (grpc conns) made to other agents.
@@ -87,6 +111,9 @@ class ChanCache {
   absl::base_internal::SpinLock chan_cache_lock_;
   // Connections that are alive for shorter than warm_up_period_ won't be cleared.
   std::chrono::nanoseconds warm_up_period_;
+  // Idle connections that were used more recently than keep_warm_period_ are reconnected.
+  std::chrono::nanoseconds keep_warm_period_;
+  ChanCacheMetrics metrics_;
 };
 }  // namespace agent
 }  // namespace vizier
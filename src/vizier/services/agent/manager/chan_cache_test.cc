@@ -171,6 +171,29 @@ TEST_F(ChanCacheTest, channel_idleness_triggers_gc) {
   EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), nullptr);
 }
 
+TEST_F(ChanCacheTest, recently_used_idle_channel_is_kept_warm) {
+  ChanCache chan_cache(std::chrono::milliseconds(500), std::chrono::minutes(1));
+  grpc::ChannelArguments args;
+  args.SetInt(GRPC_ARG_CLIENT_IDLE_TIMEOUT_MS, 1000);
+  auto channel =
+      ::grpc::CreateCustomChannel(GetServerAddress(), InsecureChannelCredentials(), args);
+  auto stub = BuildStub(channel);
+
+  chan_cache.Add(GetServerAddress(), channel);
+  RunRPC(stub.get());
+  TestSleep(1200);
+  EXPECT_EQ(channel->GetState(false), GRPC_CHANNEL_IDLE);
+
+  // The channel was used recently, so garbage collection reconnects it instead of removing it.
+  EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), channel);
+  EXPECT_OK(chan_cache.CleanupChans());
+  EXPECT_EQ(chan_cache.GetChan(GetServerAddress()), channel);
+  for (int i = 0; i < 100 && channel->GetState(false) == GRPC_CHANNEL_IDLE; ++i) {
+    TestSleep(10);
+  }
+  EXPECT_NE(channel->GetState(false), GRPC_CHANNEL_IDLE);
+}
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
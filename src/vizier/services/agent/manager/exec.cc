@@ -26,15 +26,38 @@
 
 #include "src/common/base/base.h"
 #include "src/common/event/task.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/perf/perf.h"
+#include "src/common/system/cpu_topology.h"
 #include "src/vizier/services/agent/manager/manager.h"
 
+DEFINE_int32(max_running_interactive_queries,
+             gflags::Int32FromEnv("PL_MAX_RUNNING_INTERACTIVE_QUERIES", 0),
+             "The most interactive queries that run on the agent at once. If 0, there is no "
+             "limit.");
+DEFINE_int32(max_running_cron_queries, gflags::Int32FromEnv("PL_MAX_RUNNING_CRON_QUERIES", 2),
+             "The most cron script queries that run on the agent at once. If 0, there is no "
+             "limit.");
+DEFINE_int32(max_running_export_queries, gflags::Int32FromEnv("PL_MAX_RUNNING_EXPORT_QUERIES", 1),
+             "The most export queries that run on the agent at once. If 0, there is no limit.");
+DEFINE_string(query_numa_node,
+              gflags::StringFromEnv("PL_QUERY_NUMA_NODE",
+                                    gflags::StringFromEnv("PL_STIRLING_NUMA_NODE", "auto")),
+              "The NUMA node whose CPUs execute queries. Defaults to the node of the Stirling "
+              "threads, where the table store's data is allocated. 'none' leaves the query "
+              "threads unpinned, and a number picks that node.");
+
 namespace px {
 namespace vizier {
 namespace agent {
 
 using ::px::event::AsyncTask;
 
+namespace {
+const prometheus::Histogram::BucketBoundaries kQueueWaitBuckets = {
+    1e-3, 1e-2, 0.1, 0.3, 1, 3, 10, 30, 100};
+}  // namespace
+
 class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
  public:
   ExecuteQueryTask(ExecuteQueryMessageHandler* h, carnot::Carnot* carnot,
@@ -49,6 +72,11 @@ class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
 
   void Work() override {
     LOG(INFO) << absl::Substitute("Executing query: id=$0", query_id_.str());
+    // Run next to the data the query reads. The worker threads are shared, so this is redone for
+    // every query, but it is only a syscall.
+    auto pin_status = system::PinCurrentThreadToNUMANode(FLAGS_query_numa_node);
+    LOG_IF_EVERY_N(WARNING, !pin_status.ok(), 100)
+        << "Failed to pin query thread: " << pin_status.msg();
     VLOG(1) << absl::Substitute("Query Plan: $0=$1", query_id_.str(), req_.plan().DebugString());
 
     auto s = carnot_->ExecutePlan(req_.plan(), query_id_, req_.analyze());
@@ -79,30 +107,91 @@ ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* di
                                                        Info* agent_info,
                                                        Manager::VizierNATSConnector* nats_conn,
                                                        carnot::Carnot* carnot)
-    : MessageHandler(dispatcher, agent_info, nats_conn), carnot_(carnot) {}
+    : MessageHandler(dispatcher, agent_info, nats_conn), carnot_(carnot) {
+  auto& queue_wait_family = prometheus::BuildHistogram()
+                                .Name("agent_query_queue_wait_seconds")
+                                .Help("Time queries waited for their priority class to have room "
+                                      "before they started running.")
+                                .Register(GetMetricsRegistry());
+  for (int i = messages::QueryPriority_MIN; i <= messages::QueryPriority_MAX; ++i) {
+    auto priority = static_cast<messages::QueryPriority>(i);
+    GetQueryClass(priority)->queue_wait_seconds = &queue_wait_family.Add(
+        {{"priority", messages::QueryPriority_Name(priority)}}, kQueueWaitBuckets);
+  }
+  GetQueryClass(messages::QUERY_PRIORITY_INTERACTIVE)->max_running =
+      FLAGS_max_running_interactive_queries;
+  GetQueryClass(messages::QUERY_PRIORITY_CRON)->max_running = FLAGS_max_running_cron_queries;
+  GetQueryClass(messages::QUERY_PRIORITY_EXPORT)->max_running = FLAGS_max_running_export_queries;
+  GetQueryClass(messages::QUERY_PRIORITY_CRON)->background = true;
+  GetQueryClass(messages::QUERY_PRIORITY_EXPORT)->background = true;
+}
+
+ExecuteQueryMessageHandler::QueryClass* ExecuteQueryMessageHandler::GetQueryClass(
+    messages::QueryPriority priority) {
+  if (!messages::QueryPriority_IsValid(priority)) {
+    priority = messages::QUERY_PRIORITY_INTERACTIVE;
+  }
+  return &query_classes_[priority];
+}
 
 Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
-  // Create a task and run it on the threadpool.
+  auto priority = msg->execute_query_request().priority();
+  // Create a task and queue it to run on the threadpool.
   auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg));
 
   auto query_id = task->query_id();
-  auto runnable = dispatcher()->CreateAsyncTask(std::move(task));
-  auto runnable_ptr = runnable.get();
-  LOG(INFO) << "Queries in flight: " << running_queries_.size();
-  running_queries_[query_id] = std::move(runnable);
-  runnable_ptr->Run();
+  LOG(INFO) << "Queries in flight: " << queries_.size();
+  queries_[query_id] = {dispatcher()->CreateAsyncTask(std::move(task)), priority,
+                        dispatcher()->GetTimeSource().MonotonicTime()};
+
+  auto* query_class = GetQueryClass(priority);
+  query_class->pending.push_back(query_id);
+  StartPendingQueries(query_class);
 
   return Status::OK();
 }
 
+void ExecuteQueryMessageHandler::HoldBackgroundQueries(bool hold) {
+  hold_background_queries_ = hold;
+  if (!hold) {
+    for (auto& query_class : query_classes_) {
+      StartPendingQueries(&query_class);
+    }
+  }
+}
+
+void ExecuteQueryMessageHandler::StartPendingQueries(QueryClass* query_class) {
+  if (hold_background_queries_ && query_class->background) {
+    return;
+  }
+  auto now = dispatcher()->GetTimeSource().MonotonicTime();
+  while (!query_class->pending.empty() &&
+         (query_class->max_running <= 0 || query_class->num_running < query_class->max_running)) {
+    auto it = queries_.find(query_class->pending.front());
+    query_class->pending.pop_front();
+    if (it == queries_.end()) {
+      continue;
+    }
+    ++query_class->num_running;
+    query_class->queue_wait_seconds->Observe(
+        std::chrono::duration<double>(now - it->second.enqueue_time).count());
+    it->second.runnable->Run();
+  }
+}
+
 void ExecuteQueryMessageHandler::HandleQueryExecutionComplete(sole::uuid query_id) {
   // Upon completion of the query, we makr the runnable task for deletion.
-  auto node = running_queries_.extract(query_id);
+  auto node = queries_.extract(query_id);
   if (node.empty()) {
     LOG(ERROR) << "Attempting to delete non-existent query: " << query_id.str();
     return;
   }
-  dispatcher()->DeferredDelete(std::move(node.mapped()));
+  auto* query_class = GetQueryClass(node.mapped().priority);
+  dispatcher()->DeferredDelete(std::move(node.mapped().runnable));
+
+  // The query's slot in its class is now free for the next pending one.
+  --query_class->num_running;
+  StartPendingQueries(query_class);
 }
 
 }  // namespace agent
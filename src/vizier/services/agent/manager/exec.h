@@ -18,9 +18,12 @@
 
 #pragma once
 
+#include <array>
+#include <deque>
 #include <memory>
 
 #include <absl/container/flat_hash_map.h>
+#include <prometheus/histogram.h>
 #include "src/carnot/plan/plan.h"
 #include "src/vizier/services/agent/manager/manager.h"
 
@@ -34,6 +37,9 @@ namespace agent {
  * otherwise only query execution is performed.
  *
  * This class runs all of it's work on a thread pool and tracks pending queries internally.
+ * Queries are scheduled by their priority class: each class may be limited in how many of its
+ * queries run at once, so that exports and cron scripts can't take up the whole thread pool.
+ * Queries over the limit wait in order of arrival.
  */
 class ExecuteQueryMessageHandler : public Manager::MessageHandler {
  public:
@@ -44,6 +50,13 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
 
   Status HandleMessage(std::unique_ptr<messages::VizierMessage> msg) override;
 
+  /**
+   * While held, new cron and export queries are queued instead of started, e.g. while the agent
+   * is short on memory. Queries that are already running are not affected.
+   * Must be called from the dispatcher thread.
+   */
+  void HoldBackgroundQueries(bool hold);
+
  protected:
   /**
    * HandleQueryExecutionComplete can be called by the async task to signal that work has been
@@ -55,10 +68,33 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
   // Forward declare private task class.
   class ExecuteQueryTask;
 
+  struct Query {
+    px::event::RunnableAsyncTaskUPtr runnable;
+    messages::QueryPriority priority;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  struct QueryClass {
+    // The most queries of this class that run at once, or 0 for no limit.
+    int max_running = 0;
+    int num_running = 0;
+    // Whether the class is held by HoldBackgroundQueries().
+    bool background = false;
+    std::deque<sole::uuid> pending;
+    prometheus::Histogram* queue_wait_seconds = nullptr;
+  };
+
+  QueryClass* GetQueryClass(messages::QueryPriority priority);
+  // Starts pending queries of the class until it reaches its limit.
+  void StartPendingQueries(QueryClass* query_class);
+
   carnot::Carnot* carnot_;
 
-  // Map from query_id -> Running query task.
-  absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> running_queries_;
+  // Map from query_id -> Pending or running query task.
+  absl::flat_hash_map<sole::uuid, Query> queries_;
+  // Indexed by messages::QueryPriority.
+  std::array<QueryClass, messages::QueryPriority_ARRAYSIZE> query_classes_;
+  bool hold_background_queries_ = false;
 };
 
 }  // namespace agent
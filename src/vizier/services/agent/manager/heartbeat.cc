@@ -18,7 +18,9 @@
 
 #include "src/vizier/services/agent/manager/heartbeat.h"
 
+#include <cstdlib>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -34,12 +36,14 @@ using ::px::shared::k8s::metadatapb::ResourceUpdate;
 HeartbeatMessageHandler::HeartbeatMessageHandler(Dispatcher* d,
                                                  px::md::AgentMetadataStateManager* mds_manager,
                                                  RelationInfoManager* relation_info_manager,
+                                                 table_store::TableStore* table_store,
                                                  Info* agent_info,
                                                  Manager::VizierNATSConnector* nats_conn)
     : MessageHandler(d, agent_info, nats_conn),
       time_source_(dispatcher()->GetTimeSource()),
       mds_manager_(mds_manager),
       relation_info_manager_(relation_info_manager),
+      table_store_(table_store),
       heartbeat_send_timer_(
           dispatcher()->CreateTimer(std::bind(&HeartbeatMessageHandler::SendHeartbeat, this))),
       heartbeat_watchdog_timer_(
@@ -49,6 +53,9 @@ HeartbeatMessageHandler::HeartbeatMessageHandler(Dispatcher* d,
 
 void HeartbeatMessageHandler::DisableHeartbeats() {
   last_metadata_epoch_id_ = 0;
+  last_table_stats_time_ = {};
+  last_table_stats_sent_time_ = {};
+  last_sent_table_bytes_.clear();
   sent_schema_ = false;
   heartbeat_send_timer_->DisableTimer();
   heartbeat_watchdog_timer_->DisableTimer();
@@ -103,12 +110,28 @@ Status HeartbeatMessageHandler::SendHeartbeatInternal() {
     relation_info_manager_->AddSchemaToUpdateInfo(update_info);
   }
 
-  // We skip sending the metadata update when there have been no changes.
+  // We skip sending the metadata update when there have been no changes, unless the table stats
+  // are due. The data info replaces the previous one as a whole, so both are always sent together.
+  // Table stats that have not changed materially are only sent every kTableStatsRefreshInterval.
+  auto now = time_source_.MonotonicTime();
   auto current_epoch = mds_manager_->metadata_filter()->epoch_id();
-  if (last_metadata_epoch_id_ == 0 || last_metadata_epoch_id_ != current_epoch) {
-    auto metadata_filter = update_info->mutable_data()->mutable_metadata_info();
-    *metadata_filter = mds_manager_->metadata_filter()->ToProto();
+  bool has_table_stats = agent_info()->capabilities.collects_data() && table_store_ != nullptr;
+  bool table_stats_due = false;
+  if (has_table_stats && now - last_table_stats_time_ >= kTableStatsInterval) {
+    last_table_stats_time_ = now;
+    table_stats_due =
+        now - last_table_stats_sent_time_ >= kTableStatsRefreshInterval || TableStatsChanged();
+  }
+  if (last_metadata_epoch_id_ == 0 || last_metadata_epoch_id_ != current_epoch ||
+      table_stats_due) {
+    auto data_info = update_info->mutable_data();
+    *data_info->mutable_metadata_info() = mds_manager_->metadata_filter()->ToProto();
     last_metadata_epoch_id_ = current_epoch;
+    if (has_table_stats) {
+      AddTableStats(time_since_epoch_ns.count(), data_info);
+      last_table_stats_time_ = now;
+      last_table_stats_sent_time_ = now;
+    }
   }
 
   VLOG(1) << "Sending heartbeat message: " << req.DebugString();
@@ -117,6 +140,44 @@ Status HeartbeatMessageHandler::SendHeartbeatInternal() {
   return nats_conn()->Publish(req);
 }
 
+void HeartbeatMessageHandler::AddTableStats(int64_t now_ns, messages::AgentDataInfo* data_info) {
+  last_sent_table_bytes_.clear();
+  for (const auto& [table_name, relation] : *table_store_->GetRelationMap()) {
+    table_store::Table* table = table_store_->GetTable(table_name);
+    if (table == nullptr) {
+      continue;
+    }
+    auto stats = table->GetTableStats();
+    auto& stats_pb = (*data_info->mutable_table_stats())[table_name];
+    stats_pb.set_num_bytes(stats.bytes + stats.disk_bytes);
+    stats_pb.set_min_time(stats.min_time);
+    // Tables are written to continuously, so their data runs up to the present.
+    stats_pb.set_max_time(now_ns);
+    last_sent_table_bytes_[table_name] = stats_pb.num_bytes();
+  }
+}
+
+bool HeartbeatMessageHandler::TableStatsChanged() const {
+  size_t num_tables = 0;
+  for (const auto& [table_name, relation] : *table_store_->GetRelationMap()) {
+    table_store::Table* table = table_store_->GetTable(table_name);
+    if (table == nullptr) {
+      continue;
+    }
+    ++num_tables;
+    auto it = last_sent_table_bytes_.find(table_name);
+    if (it == last_sent_table_bytes_.end()) {
+      return true;
+    }
+    auto stats = table->GetTableStats();
+    int64_t num_bytes = stats.bytes + stats.disk_bytes;
+    if (std::abs(num_bytes - it->second) * 100 > it->second * kTableStatsChangePercent) {
+      return true;
+    }
+  }
+  return num_tables != last_sent_table_bytes_.size();
+}
+
 void HeartbeatMessageHandler::HeartbeatWatchdog() {
   if (heartbeat_info_.last_ackd_seq_num < heartbeat_info_.last_sent_seq_num) {
     auto diff = time_source_.MonotonicTime() - heartbeat_info_.last_heartbeat_send_time_;
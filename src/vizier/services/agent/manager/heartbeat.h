@@ -19,6 +19,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/vizier/services/agent/manager/manager.h"
 
@@ -31,7 +34,8 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
   HeartbeatMessageHandler() = delete;
   HeartbeatMessageHandler(px::event::Dispatcher* dispatcher,
                           px::md::AgentMetadataStateManager* mds_manager,
-                          RelationInfoManager* relation_info_manager, Info* agent_info,
+                          RelationInfoManager* relation_info_manager,
+                          table_store::TableStore* table_store, Info* agent_info,
                           Manager::VizierNATSConnector* nats_conn);
 
   ~HeartbeatMessageHandler() override = default;
@@ -48,6 +52,11 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
   void ProcessPIDTerminatedEvent(const px::md::PIDTerminatedEvent& ev,
                                  messages::AgentUpdateInfo* update_info);
 
+  void AddTableStats(int64_t now_ns, messages::AgentDataInfo* data_info);
+  // Returns true if tables were added or removed, or if any of them changed size by more than
+  // kTableStatsChangePercent, since the table stats were last sent.
+  bool TableStatsChanged() const;
+
   void DoHeartbeats();
 
   void SendHeartbeat();
@@ -64,11 +73,16 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
   std::unique_ptr<px::vizier::messages::VizierMessage> last_sent_hb_;
   int64_t last_metadata_epoch_id_ = 0;
   bool sent_schema_ = false;
+  // The last time the table stats were checked for changes, and the last time they were sent.
+  std::chrono::steady_clock::time_point last_table_stats_time_;
+  std::chrono::steady_clock::time_point last_table_stats_sent_time_;
+  absl::flat_hash_map<std::string, int64_t> last_sent_table_bytes_;
 
   HeartbeatInfo heartbeat_info_;
   const px::event::TimeSource& time_source_;
   px::md::AgentMetadataStateManager* mds_manager_;
   RelationInfoManager* relation_info_manager_;
+  table_store::TableStore* table_store_;
   std::chrono::duration<double> heartbeat_latency_moving_average_{0};
 
   px::event::TimerUPtr heartbeat_send_timer_;
@@ -78,6 +92,11 @@ class HeartbeatMessageHandler : public Manager::MessageHandler {
 
   static constexpr std::chrono::seconds kAgentHeartbeatInterval{5};
   static constexpr int kHeartbeatRetryCount = 5;
+  // How often the table stats are sent. They only steer query planning, so they can be stale.
+  static constexpr std::chrono::seconds kTableStatsInterval{60};
+  // Unchanged table stats are skipped, but still resent this often in case an update was lost.
+  static constexpr std::chrono::seconds kTableStatsRefreshInterval{600};
+  static constexpr int64_t kTableStatsChangePercent = 10;
   // The amount of time to wait for a heartbeat ack.
   static constexpr std::chrono::milliseconds kHeartbeatWaitMillis{5000};
 };
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "src/common/testing/event/simulated_time_system.h"
 #include "src/common/testing/testing.h"
 #include "src/shared/metadatapb/metadata.pb.h"
+#include "src/shared/types/column_wrapper.h"
 #include "src/vizier/messages/messagespb/messages.pb.h"
 #include "src/vizier/services/agent/manager/heartbeat.h"
 #include "src/vizier/services/agent/manager/manager.h"
@@ -128,12 +130,21 @@ class HeartbeatMessageHandlerTest : public ::testing::Test {
       EXPECT_OK(relation_info_manager_->AddRelationInfo(relation_info));
     }
 
+    table_store_ = std::make_unique<table_store::TableStore>();
+    table_store_->AddTable(table_store::Table::Create("relation0", relation0), "relation0", 0);
+
     agent_info_ = agent::Info{};
     agent_info_.capabilities.set_collects_data(true);
 
     heartbeat_handler_ = std::make_unique<HeartbeatMessageHandler>(
-        dispatcher_.get(), mds_manager_.get(), relation_info_manager_.get(), &agent_info_,
-        nats_conn_.get());
+        dispatcher_.get(), mds_manager_.get(), relation_info_manager_.get(), table_store_.get(),
+        &agent_info_, nats_conn_.get());
+  }
+
+  void AckHeartbeat(int64_t sequence_number) {
+    auto hb_ack = std::make_unique<messages::VizierMessage>();
+    hb_ack->mutable_heartbeat_ack()->set_sequence_number(sequence_number);
+    EXPECT_OK(heartbeat_handler_->HandleMessage(std::move(hb_ack)));
   }
 
   void CheckFilterElements(const messages::AgentDataInfo& data_info,
@@ -155,6 +166,7 @@ class HeartbeatMessageHandlerTest : public ::testing::Test {
   std::unique_ptr<event::Dispatcher> dispatcher_;
   std::unique_ptr<FakeAgentMetadataStateManager> mds_manager_;
   std::unique_ptr<RelationInfoManager> relation_info_manager_;
+  std::unique_ptr<table_store::TableStore> table_store_;
   std::unique_ptr<HeartbeatMessageHandler> heartbeat_handler_;
   std::unique_ptr<FakeNATSConnector<px::vizier::messages::VizierMessage>> nats_conn_;
   agent::Info agent_info_;
@@ -304,6 +316,60 @@ TEST_F(HeartbeatMessageHandlerTest, HandleHeartbeatRelationUpdates) {
   EXPECT_EQ(3, hb.update_info().schema().size());
 }
 
+TEST_F(HeartbeatMessageHandlerTest, HandleHeartbeatTableStats) {
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(1, nats_conn_->published_msgs().size());
+  auto hb = nats_conn_->published_msgs()[0].heartbeat();
+  ASSERT_EQ(1, hb.update_info().data().table_stats().count("relation0"));
+  EXPECT_EQ(hb.time(), hb.update_info().data().table_stats().at("relation0").max_time());
+  AckHeartbeat(0);
+
+  // The table stats are only resent once they are due.
+  time_system_->SetMonotonicTime(start_monotonic_time_ + std::chrono::milliseconds(5000 + 1));
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(2, nats_conn_->published_msgs().size());
+  hb = nats_conn_->published_msgs()[1].heartbeat();
+  EXPECT_EQ(0, hb.update_info().data().table_stats().size());
+  AckHeartbeat(1);
+
+  // Unchanged table stats are skipped even once they are due.
+  time_system_->SetMonotonicTime(start_monotonic_time_ + std::chrono::milliseconds(65000 + 1));
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(3, nats_conn_->published_msgs().size());
+  hb = nats_conn_->published_msgs()[2].heartbeat();
+  EXPECT_FALSE(hb.update_info().has_data());
+  AckHeartbeat(2);
+
+  // They are resent once the table grows.
+  auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(0);
+  auto count_col = std::make_shared<types::Int64ValueColumnWrapper>(0);
+  for (int i = 0; i < 100; ++i) {
+    time_col->Append(i);
+    count_col->Append(i);
+  }
+  batch->push_back(time_col);
+  batch->push_back(count_col);
+  EXPECT_OK(table_store_->GetTable("relation0")->TransferRecordBatch(std::move(batch)));
+
+  time_system_->SetMonotonicTime(start_monotonic_time_ + std::chrono::milliseconds(125000 + 1));
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(4, nats_conn_->published_msgs().size());
+  hb = nats_conn_->published_msgs()[3].heartbeat();
+  ASSERT_EQ(1, hb.update_info().data().table_stats().count("relation0"));
+  EXPECT_GT(hb.update_info().data().table_stats().at("relation0").num_bytes(), 0);
+  // The metadata info is sent along with the table stats, since the data info is replaced whole.
+  CheckFilterElements(hb.update_info().data(), {"pl/service"}, {"pl/another_service"});
+  AckHeartbeat(3);
+
+  // Unchanged table stats are still resent periodically.
+  time_system_->SetMonotonicTime(start_monotonic_time_ + std::chrono::milliseconds(725000 + 1));
+  dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+  ASSERT_EQ(5, nats_conn_->published_msgs().size());
+  hb = nats_conn_->published_msgs()[4].heartbeat();
+  EXPECT_EQ(1, hb.update_info().data().table_stats().count("relation0"));
+}
+
 class HeartbeatNackMessageHandlerTest : public ::testing::Test {
  protected:
   void TearDown() override { dispatcher_->Exit(); }
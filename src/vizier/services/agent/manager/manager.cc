@@ -20,6 +20,7 @@
 
 #include <limits.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <random>
@@ -32,6 +33,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
+#include "src/common/metrics/sharded_metrics.h"
 #include "src/common/perf/perf.h"
 #include "src/vizier/funcs/context/vizier_context.h"
 #include "src/vizier/funcs/funcs.h"
@@ -65,6 +67,31 @@ DEFINE_string(vizier_id, gflags::StringFromEnv("PL_VIZIER_ID", ""), "The ID of t
 DEFINE_string(vizier_name, gflags::StringFromEnv("PL_VIZIER_NAME", ""),
               "The name of the cluster according to vizier.");
 
+DEFINE_int32(table_store_compaction_threads,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_THREADS", 2),
+             "The number of threads that compact the table store's tables in parallel. If 0, "
+             "tables are compacted on the agent's event loop.");
+
+DEFINE_int32(table_store_compaction_time_slice_ms,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_TIME_SLICE_MS", 5000),
+             "The longest a compaction run may take. Tables that aren't fully compacted by then "
+             "are continued in the next run.");
+
+DEFINE_bool(agent_control_loop, gflags::BoolFromEnv("PL_AGENT_CONTROL_LOOP", true),
+            "Run the agent's heartbeats and metadata updates on their own event loop, rather than "
+            "on the loop that dispatches queries.");
+
+DEFINE_double(self_profile_cpu_threshold,
+              gflags::DoubleFromEnv("PL_SELF_PROFILE_CPU_THRESHOLD", 4.0),
+              "The CPU use, in cores, at which the agent captures a CPU profile of itself. "
+              "Disabled if 0.");
+DEFINE_string(self_profile_dir, gflags::StringFromEnv("PL_SELF_PROFILE_DIR", "/tmp/px_profiles"),
+              "The directory that the agent's CPU profiles of itself are written to.");
+DEFINE_int32(self_profile_duration_s, gflags::Int32FromEnv("PL_SELF_PROFILE_DURATION_S", 30),
+             "The length of each CPU profile that the agent captures of itself.");
+DEFINE_int32(self_profile_max_files, gflags::Int32FromEnv("PL_SELF_PROFILE_MAX_FILES", 3),
+             "The number of the agent's CPU profiles of itself to keep. Older ones are removed.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -98,7 +125,8 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
     : grpc_channel_creds_(SSL::DefaultGRPCClientCreds()),
       time_system_(std::make_unique<px::event::RealTimeSystem>()),
       api_(std::make_unique<px::event::APIImpl>(time_system_.get())),
-      dispatcher_(api_->AllocateDispatcher("manager")),
+      dispatcher_(api_->AllocateDispatcher(kMainLoop)),
+      loops_(std::make_unique<px::event::LoopGroup>(api_.get(), &GetMetricsRegistry())),
       nats_addr_(nats_url),
       table_store_(std::make_shared<table_store::TableStore>()),
       relation_info_manager_(std::make_unique<RelationInfoManager>()),
@@ -115,6 +143,12 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
     LOG(WARNING) << "--nats_url is empty, skip connecting to NATS.";
   }
 
+  loops_->MonitorLag(kMainLoop, dispatcher_.get());
+  control_dispatcher_ = dispatcher_.get();
+  if (FLAGS_agent_control_loop) {
+    control_dispatcher_ = loops_->AddLoop(kControlLoop).ConsumeValueOrDie();
+  }
+
   // Register Vizier specific and carnot builtin functions.
   auto func_registry = std::make_unique<px::carnot::udf::Registry>("vizier_func_registry");
   ::px::vizier::funcs::RegisterFuncsOrDie(func_context_, func_registry.get());
@@ -144,7 +178,7 @@ Status Manager::Init() {
       agent_metadata_filter_,
       md::AgentMetadataFilter::Create(kMetadataFilterMaxEntries, kMetadataFilterMaxErrorRate,
                                       md::kMetadataFilterEntities));
-  chan_cache_ = std::make_unique<ChanCache>(kChanIdleGracePeriod);
+  chan_cache_ = std::make_unique<ChanCache>(kChanIdleGracePeriod, kChanKeepWarmPeriod);
   auto hostname_or_s = GetHostname();
   if (!hostname_or_s.ok()) {
     return hostname_or_s.status();
@@ -191,6 +225,7 @@ Status Manager::Init() {
 
 Status Manager::Run() {
   running_ = true;
+  loops_->Start();
   dispatcher_->Run(px::event::Dispatcher::RunType::Block);
   running_ = false;
   return Status::OK();
@@ -204,6 +239,7 @@ Status Manager::Stop(std::chrono::milliseconds timeout) {
   stop_called_ = true;
 
   dispatcher_->Stop();
+  loops_->Stop();
   auto s = StopImpl(timeout);
 
   // Wait for a limited amount of time for main thread to stop processing.
@@ -216,35 +252,62 @@ Status Manager::Stop(std::chrono::milliseconds timeout) {
 }
 
 Status Manager::RegisterBackgroundHelpers() {
-  metadata_update_timer_ = dispatcher_->CreateTimer([this]() {
-    VLOG(1) << "State Update";
-    ECHECK_OK(mds_manager_->PerformMetadataStateUpdate());
-    if (metadata_update_timer_) {
-      metadata_update_timer_->EnableTimer(std::chrono::seconds(5));
-    }
+  // Timers have to be created on the loop that runs them.
+  control_dispatcher_->Post([this]() {
+    metadata_update_timer_ = control_dispatcher_->CreateTimer([this]() {
+      VLOG(1) << "State Update";
+      ECHECK_OK(mds_manager_->PerformMetadataStateUpdate());
+      if (metadata_update_timer_) {
+        metadata_update_timer_->EnableTimer(std::chrono::seconds(5));
+      }
+    });
+    metadata_update_timer_->EnableTimer(std::chrono::seconds(5));
+
+    // The profiler samples from the control loop, so that it still runs when the main loop is
+    // busy.
+    SelfProfiler::Config config;
+    config.cpu_threshold_cores = FLAGS_self_profile_cpu_threshold;
+    config.profile_dir = FLAGS_self_profile_dir;
+    config.capture_duration = std::chrono::seconds(FLAGS_self_profile_duration_s);
+    config.max_profiles = FLAGS_self_profile_max_files;
+    const auto& sys_config = px::system::Config::GetInstance();
+    self_profiler_ = std::make_unique<SelfProfiler>(
+        sys_config.proc_path().string(), info_.pid, sys_config.KernelTickTimeNS(), config,
+        &GetMetricsRegistry());
+    self_profiler_timer_ = control_dispatcher_->CreateTimer([this]() {
+      self_profiler_->Sample(time_system_->MonotonicTime());
+      if (self_profiler_timer_) {
+        self_profiler_timer_->EnableTimer(kSelfProfilerSamplePeriod);
+      }
+    });
+    self_profiler_timer_->EnableTimer(kSelfProfilerSamplePeriod);
   });
-  metadata_update_timer_->EnableTimer(std::chrono::seconds(5));
 
   chan_cache_garbage_collect_timer_ = dispatcher_->CreateTimer([this]() {
     VLOG(1) << "GRPC channel cache garbage collection";
     ECHECK_OK(chan_cache_->CleanupChans());
-    if (metadata_update_timer_) {
+    if (chan_cache_garbage_collect_timer_) {
       chan_cache_garbage_collect_timer_->EnableTimer(kChanCacheCleanupChansionPeriod);
     }
   });
   chan_cache_garbage_collect_timer_->EnableTimer(kChanCacheCleanupChansionPeriod);
 
-  // Add Heartbeat and execute query handlers.
-  heartbeat_handler_ = std::make_shared<HeartbeatMessageHandler>(
-      dispatcher_.get(), mds_manager_.get(), relation_info_manager_.get(), &info_,
-      agent_nats_connector_.get());
+  // Add Heartbeat and execute query handlers. The heartbeat handler is created on the control loop,
+  // and then registered back on the main loop.
+  control_dispatcher_->Post([this]() {
+    heartbeat_handler_ = std::make_shared<HeartbeatMessageHandler>(
+        control_dispatcher_, mds_manager_.get(), relation_info_manager_.get(), table_store_.get(),
+        &info_, agent_nats_connector_.get());
+    dispatcher_->Post([this]() {
+      PL_CHECK_OK(RegisterMessageHandler(messages::VizierMessage::MsgCase::kHeartbeatAck,
+                                         heartbeat_handler_));
+    });
+  });
 
   auto heartbeat_nack_handler = std::make_shared<HeartbeatNackMessageHandler>(
       dispatcher_.get(), &info_, agent_nats_connector_.get(),
       std::bind(&Manager::ReregisterHook, this));
 
-  PL_CHECK_OK(
-      RegisterMessageHandler(messages::VizierMessage::MsgCase::kHeartbeatAck, heartbeat_handler_));
   PL_CHECK_OK(RegisterMessageHandler(messages::VizierMessage::MsgCase::kHeartbeatNack,
                                      heartbeat_nack_handler));
 
@@ -283,7 +346,15 @@ void Manager::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
 
   auto c = msg->msg_case();
   auto it = message_handlers_.find(c);
-  if (it != message_handlers_.end()) {
+  if (it != message_handlers_.end() && it->second->dispatcher() != dispatcher_.get()) {
+    // The handler runs on another loop, so the message is passed on to it.
+    std::shared_ptr<MessageHandler> handler = it->second;
+    messages::VizierMessage* m = msg.release();
+    handler->dispatcher()->Post([handler, m, c]() {
+      ECHECK_OK(handler->HandleMessage(std::unique_ptr<messages::VizierMessage>(m)))
+          << "message handler failed... for type: " << c << " ignoring.";
+    });
+  } else if (it != message_handlers_.end()) {
     ECHECK_OK(it->second->HandleMessage(std::move(msg)))
         << "message handler failed... for type: " << c
         << " ignoring. Message: " << msg->DebugString();
@@ -301,6 +372,8 @@ Status Manager::PostRegisterHook(uint32_t asid) {
       info_.hostname, info_.asid, info_.pid, info_.pod_name, info_.agent_id,
       info_.capabilities.collects_data(), px::system::Config::GetInstance(),
       agent_metadata_filter_.get(), sole::rebuild(FLAGS_vizier_id), FLAGS_vizier_name);
+  // Stopped UPIDs can be dropped from the metadata once the data that refers to them expired.
+  mds_manager_->SetOldestDataTimeFn([this]() { return table_store_->MinTime(); });
   // Register the Carnot callback for metadata.
   carnot_->RegisterAgentMetadataCallback(
       std::bind(&px::md::AgentMetadataStateManager::CurrentAgentMetadataState, mds_manager_.get()));
@@ -335,12 +408,24 @@ Status Manager::PostRegisterHook(uint32_t asid) {
     PL_RETURN_IF_ERROR(metrics_nats_connector_->Connect(dispatcher_.get()));
   }
 
+  // Compaction runs on its own pool, so that it doesn't delay the event loop. A run is skipped if
+  // the previous one is still going.
+  tablestore_compaction_pool_ =
+      std::make_unique<ThreadPool>(std::max(FLAGS_table_store_compaction_threads, 0));
   tablestore_compaction_timer_ = dispatcher()->CreateTimer([this]() {
-    // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
-    // will need to figure out how to use the correct memory pool here, but for now we can just use
-    // the default pool.
-    auto status = table_store()->RunCompaction(arrow::default_memory_pool());
-    LOG_IF(ERROR, !status.ok()) << status.msg();
+    if (!tablestore_compaction_running_.exchange(true)) {
+      tablestore_compaction_pool_->Schedule([this]() {
+        table_store::CompactionOptions opts;
+        opts.pool = tablestore_compaction_pool_.get();
+        opts.time_slice = std::chrono::milliseconds(FLAGS_table_store_compaction_time_slice_ms);
+        // TODO(james): when we change ExecState::exec_mem_pool to not return just the default
+        // pool, we will need to figure out how to use the correct memory pool here, but for now
+        // we can just use the default pool.
+        auto status = table_store()->RunCompaction(opts);
+        LOG_IF(ERROR, !status.ok()) << status.msg();
+        tablestore_compaction_running_ = false;
+      });
+    }
     if (tablestore_compaction_timer_) {
       tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
     }
@@ -361,6 +446,7 @@ Status Manager::PostRegisterHook(uint32_t asid) {
       // Returning without calling EnableTimer to prevent future timer calls.
       return;
     }
+    px::metrics::FlushShardedMetrics();
     auto& registry = GetMetricsRegistry();
     auto metrics = registry.Collect();
     int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -390,16 +476,21 @@ Status Manager::PostRegisterHook(uint32_t asid) {
 }
 
 Status Manager::ReregisterHook() {
-  LOG_IF(FATAL, heartbeat_handler_ == nullptr) << "Heartbeat handler is not set up";
-  heartbeat_handler_->DisableHeartbeats();
-  registration_handler_->ReregisterAgent();
+  // The heartbeats are stopped on the control loop before reregistering on the main loop.
+  control_dispatcher_->Post([this]() {
+    LOG_IF(FATAL, heartbeat_handler_ == nullptr) << "Heartbeat handler is not set up";
+    heartbeat_handler_->DisableHeartbeats();
+    dispatcher_->Post([this]() { registration_handler_->ReregisterAgent(); });
+  });
   return Status::OK();
 }
 
 Status Manager::PostReregisterHook(uint32_t asid) {
-  LOG_IF(FATAL, heartbeat_handler_ == nullptr) << "Heartbeat handler is not set up";
   LOG_IF(FATAL, asid != info_.asid) << "Received conflicting ASID after reregistration";
-  heartbeat_handler_->EnableHeartbeats();
+  control_dispatcher_->Post([this]() {
+    LOG_IF(FATAL, heartbeat_handler_ == nullptr) << "Heartbeat handler is not set up";
+    heartbeat_handler_->EnableHeartbeats();
+  });
   return Status::OK();
 }
 
@@ -19,6 +19,7 @@
 #pragma once
 #include <grpcpp/grpcpp.h>
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 
 #include "src/carnot/carnot.h"
 #include "src/common/base/base.h"
+#include "src/common/base/thread_pool.h"
 #include "src/common/event/event.h"
 #include "src/common/event/nats.h"
 #include "src/common/metrics/memory_metrics.h"
@@ -36,6 +38,7 @@
 #include "src/vizier/messages/messagespb/messages.pb.h"
 #include "src/vizier/services/agent/manager/chan_cache.h"
 #include "src/vizier/services/agent/manager/relation_info_manager.h"
+#include "src/vizier/services/agent/manager/self_profiler.h"
 
 #include "src/vizier/services/metadata/metadatapb/service.grpc.pb.h"
 
@@ -59,11 +62,18 @@ constexpr auto kChanCacheCleanupChansionPeriod = std::chrono::minutes(5);
  * documentation in chan_cache.h.
  */
 constexpr auto kChanIdleGracePeriod = std::chrono::minutes(1);
+/**
+ * Channels that were used within this period are reconnected when they go idle, so that short
+ * queries don't have to wait for a new connection.
+ */
+constexpr auto kChanKeepWarmPeriod = std::chrono::minutes(30);
 
 constexpr auto kTableStoreCompactionPeriod = std::chrono::minutes(1);
 
 constexpr auto kMemoryMetricsCollectPeriod = std::chrono::minutes(1);
 
+constexpr auto kSelfProfilerSamplePeriod = std::chrono::seconds(10);
+
 constexpr auto kMetricsPushPeriod = std::chrono::minutes(1);
 
 /**
@@ -186,14 +196,19 @@ class Manager : public px::NotCopyable {
   static constexpr char kK8sSubTopicPattern[] = "K8sUpdates/$0";
   static constexpr char kK8sPubTopic[] = "MissingMetadataRequests";
   static constexpr char kMetricsPubTopic[] = "Metrics";
+  static constexpr char kMainLoop[] = "manager";
+  static constexpr char kControlLoop[] = "control";
 
   // Message handlers are registered per type of Vizier message.
   // same message handler can be used for multiple different types of messages.
   absl::flat_hash_map<MsgCase, std::shared_ptr<MessageHandler>> message_handlers_;
   void HandleMessage(std::unique_ptr<messages::VizierMessage> msg);
 
-  // The timer to manage metadata updates.
+  // The timer to manage metadata updates. It runs on the control loop.
   px::event::TimerUPtr metadata_update_timer_;
+  // Samples the agent's threads and captures profiles of it. It runs on the control loop.
+  std::unique_ptr<SelfProfiler> self_profiler_;
+  px::event::TimerUPtr self_profiler_timer_;
 
   bool stop_called_ = false;
 
@@ -204,7 +219,7 @@ class Manager : public px::NotCopyable {
   // The timer that runs the garbage collection routine.
   px::event::TimerUPtr chan_cache_garbage_collect_timer_;
 
-  // A pointer to the heartbeat handler for reregistration hooks.
+  // A pointer to the heartbeat handler for reregistration hooks. It runs on the control loop.
   std::shared_ptr<HeartbeatMessageHandler> heartbeat_handler_;
   std::shared_ptr<RegistrationHandler> registration_handler_;
 
@@ -216,6 +231,12 @@ class Manager : public px::NotCopyable {
 
   Info info_;
   px::event::DispatcherUPtr dispatcher_;
+  // The loops that run beside the main loop. The control loop runs the heartbeats and metadata
+  // updates, so that they and query dispatch on the main loop don't queue behind each other.
+  // The heartbeats send the metadata filter that the metadata updates write, so the two share a
+  // loop. The control loop is the main loop if --agent_control_loop is false.
+  std::unique_ptr<px::event::LoopGroup> loops_;
+  px::event::Dispatcher* control_dispatcher_ = nullptr;
   const std::string nats_addr_;
   // NATS connector for subscribing to and publishing agent updates.
   std::unique_ptr<VizierNATSConnector> agent_nats_connector_;
@@ -237,6 +258,10 @@ class Manager : public px::NotCopyable {
 
   // Timer to manage table store compaction.
   px::event::TimerUPtr tablestore_compaction_timer_;
+  // Compaction runs on this pool rather than the event loop. Declared after table_store_, so that
+  // it is drained before the table store is destroyed.
+  std::unique_ptr<ThreadPool> tablestore_compaction_pool_;
+  std::atomic<bool> tablestore_compaction_running_ = false;
 
   px::metrics::MemoryMetrics memory_metrics_;
   // Timer to collect MemoryMetrics for this agent.
@@ -274,10 +299,14 @@ class Manager::MessageHandler {
    */
   virtual Status HandleMessage(std::unique_ptr<messages::VizierMessage> msg) = 0;
 
+  /**
+   * The event loop that the handler runs on. Messages for it are posted to this loop.
+   */
+  px::event::Dispatcher* dispatcher() { return dispatcher_; }
+
  protected:
   const Info* agent_info() const { return agent_info_; }
   Manager::VizierNATSConnector* nats_conn() { return nats_conn_; }
-  px::event::Dispatcher* dispatcher() { return dispatcher_; }
 
  private:
   const Info* agent_info_;
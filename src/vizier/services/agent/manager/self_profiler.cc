@@ -0,0 +1,184 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/manager/self_profiler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+
+#include "src/common/perf/profiler.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+SelfProfiler::SelfProfiler(std::string proc_path, int32_t pid, int64_t kernel_tick_time_ns,
+                           Config config, prometheus::Registry* registry)
+    : proc_path_(std::move(proc_path)),
+      pid_(pid),
+      kernel_tick_time_ns_(kernel_tick_time_ns),
+      config_(std::move(config)),
+      proc_parser_(proc_path_),
+      thread_cpu_family_(prometheus::BuildCounter()
+                             .Name("agent_thread_cpu_seconds_total")
+                             .Help("The CPU time used by the agent's threads, by thread name.")
+                             .Register(*registry)),
+      cpu_cores_gauge_(prometheus::BuildGauge()
+                           .Name("agent_cpu_cores")
+                           .Help("The CPU use of the agent, in cores, over the last sample.")
+                           .Register(*registry)
+                           .Add({})),
+      profiles_captured_(prometheus::BuildCounter()
+                             .Name("agent_self_profiles_captured")
+                             .Help("The number of CPU profiles the agent captured of itself.")
+                             .Register(*registry)
+                             .Add({})) {}
+
+SelfProfiler::~SelfProfiler() {
+  if (capturing_) {
+    profiler::CPU::StopProfiler();
+  }
+}
+
+Status SelfProfiler::SampleThreads(absl::flat_hash_map<int32_t, ThreadCPU>* threads) const {
+  auto task_dir = std::filesystem::path(proc_path_) / std::to_string(pid_) / "task";
+  std::error_code ec;
+  auto it = std::filesystem::directory_iterator(task_dir, ec);
+  if (ec) {
+    return error::Internal("Failed to list $0: $1", task_dir.string(), ec.message());
+  }
+  system::ProcParser::ProcessStats stats;
+  for (const auto& entry : it) {
+    int32_t tid;
+    if (!absl::SimpleAtoi(entry.path().filename().string(), &tid)) {
+      continue;
+    }
+    // Threads that exited since the directory was listed are skipped.
+    if (!proc_parser_.ParseProcPIDStat(tid, /*page_size_bytes*/ 1, kernel_tick_time_ns_, &stats)
+             .ok()) {
+      continue;
+    }
+    (*threads)[tid] = ThreadCPU{stats.process_name, stats.utime_ns + stats.ktime_ns};
+  }
+  return Status::OK();
+}
+
+prometheus::Counter* SelfProfiler::ThreadCounter(const std::string& name) {
+  auto it = thread_cpu_counters_.find(name);
+  if (it != thread_cpu_counters_.end()) {
+    return it->second;
+  }
+  if (thread_cpu_counters_.size() >= kMaxThreadNames && name != kOtherThreads) {
+    return ThreadCounter(kOtherThreads);
+  }
+  auto* counter = &thread_cpu_family_.Add({{"thread", name}});
+  thread_cpu_counters_[name] = counter;
+  return counter;
+}
+
+void SelfProfiler::Sample(std::chrono::steady_clock::time_point now) {
+  absl::flat_hash_map<int32_t, ThreadCPU> threads;
+  Status s = SampleThreads(&threads);
+  if (!s.ok()) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to sample agent threads: " << s.msg();
+    return;
+  }
+
+  int64_t total_delta_ns = 0;
+  for (const auto& [tid, thread] : threads) {
+    auto last = last_threads_.find(tid);
+    // A thread that is new since the last sample counts from 0.
+    int64_t delta_ns = thread.cpu_ns - (last == last_threads_.end() ? 0 : last->second.cpu_ns);
+    if (delta_ns <= 0) {
+      continue;
+    }
+    total_delta_ns += delta_ns;
+    ThreadCounter(thread.name)->Increment(delta_ns / 1e9);
+  }
+
+  // The first sample only sets the baseline of the CPU use.
+  if (!last_threads_.empty()) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_sample_time_);
+    cpu_cores_ = elapsed.count() > 0 ? static_cast<double>(total_delta_ns) / elapsed.count() : 0;
+    cpu_cores_gauge_.Set(cpu_cores_);
+  }
+  last_threads_ = std::move(threads);
+  last_sample_time_ = now;
+
+  MaybeCapture(now);
+}
+
+void SelfProfiler::MaybeCapture(std::chrono::steady_clock::time_point now) {
+  if (capturing_) {
+    if (now >= capture_end_time_) {
+      profiler::CPU::StopProfiler();
+      capturing_ = false;
+      profiles_captured_.Increment();
+      RemoveOldProfiles();
+    }
+    return;
+  }
+  if (config_.cpu_threshold_cores <= 0 || cpu_cores_ < config_.cpu_threshold_cores ||
+      now < next_capture_time_) {
+    return;
+  }
+  next_capture_time_ = now + config_.cooldown;
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.profile_dir, ec);
+  auto unix_time = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  std::string path = absl::Substitute("$0/cpu-$1.prof", config_.profile_dir, unix_time.count());
+  if (!profiler::CPU::StartProfiler(path)) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to start the CPU profiler, it may not be available in "
+                               "this build.";
+    return;
+  }
+  LOG(INFO) << absl::Substitute("Agent is using $0 cores, capturing a CPU profile into $1",
+                                cpu_cores_, path);
+  capturing_ = true;
+  capture_end_time_ = now + config_.capture_duration;
+}
+
+void SelfProfiler::RemoveOldProfiles() {
+  std::error_code ec;
+  std::vector<std::filesystem::path> profiles;
+  for (const auto& entry : std::filesystem::directory_iterator(config_.profile_dir, ec)) {
+    if (absl::StartsWith(entry.path().filename().string(), "cpu-")) {
+      profiles.push_back(entry.path());
+    }
+  }
+  if (profiles.size() <= static_cast<size_t>(config_.max_profiles)) {
+    return;
+  }
+  // The names hold the capture time, so the oldest sort first.
+  std::sort(profiles.begin(), profiles.end());
+  for (size_t i = 0; i < profiles.size() - config_.max_profiles; ++i) {
+    std::filesystem::remove(profiles[i], ec);
+  }
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+#include <prometheus/counter.h>
+#include <prometheus/family.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * SelfProfiler samples the CPU time of each of the agent's threads, and exports it by thread
+ * name as agent_thread_cpu_seconds_total. When the agent as a whole uses more than a threshold of
+ * CPU, it captures a CPU profile with the gperftools profiler into a directory, which keeps only
+ * the newest few profiles. Captures are spaced out by a cooldown, so that a busy agent doesn't
+ * spend its time profiling itself.
+ *
+ * Not thread-safe.
+ */
+class SelfProfiler : public NotCopyable {
+ public:
+  struct Config {
+    // The CPU use, in cores, that triggers a capture. Captures are disabled if it is 0.
+    double cpu_threshold_cores = 0;
+    std::string profile_dir;
+    std::chrono::seconds capture_duration{30};
+    std::chrono::seconds cooldown{600};
+    int max_profiles = 3;
+  };
+
+  SelfProfiler(std::string proc_path, int32_t pid, int64_t kernel_tick_time_ns, Config config,
+               prometheus::Registry* registry);
+  ~SelfProfiler();
+
+  /**
+   * Sample the CPU time of the threads, and start or stop a capture.
+   * @param now the current monotonic time.
+   */
+  void Sample(std::chrono::steady_clock::time_point now);
+
+  // The CPU use of the agent, in cores, between the last two samples.
+  double cpu_cores() const { return cpu_cores_; }
+  bool capturing() const { return capturing_; }
+
+ private:
+  struct ThreadCPU {
+    std::string name;
+    int64_t cpu_ns = 0;
+  };
+
+  Status SampleThreads(absl::flat_hash_map<int32_t, ThreadCPU>* threads) const;
+  prometheus::Counter* ThreadCounter(const std::string& name);
+  void MaybeCapture(std::chrono::steady_clock::time_point now);
+  void RemoveOldProfiles();
+
+  // Threads are grouped by name, and names past this many share one series, to bound the number
+  // of series of a process that names its threads after their work.
+  static constexpr size_t kMaxThreadNames = 64;
+  static constexpr char kOtherThreads[] = "other";
+
+  const std::string proc_path_;
+  const int32_t pid_;
+  const int64_t kernel_tick_time_ns_;
+  const Config config_;
+  const system::ProcParser proc_parser_;
+
+  absl::flat_hash_map<int32_t, ThreadCPU> last_threads_;
+  std::chrono::steady_clock::time_point last_sample_time_;
+  double cpu_cores_ = 0;
+
+  bool capturing_ = false;
+  std::chrono::steady_clock::time_point capture_end_time_;
+  std::chrono::steady_clock::time_point next_capture_time_;
+
+  prometheus::Family<prometheus::Counter>& thread_cpu_family_;
+  absl::flat_hash_map<std::string, prometheus::Counter*> thread_cpu_counters_;
+  prometheus::Gauge& cpu_cores_gauge_;
+  prometheus::Counter& profiles_captured_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
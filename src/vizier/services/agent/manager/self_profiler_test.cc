@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/manager/self_profiler.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+constexpr int32_t kPID = 100;
+constexpr int64_t kTickNS = 10 * 1000 * 1000;
+
+class SelfProfilerTest : public ::testing::Test {
+ protected:
+  void WriteThread(int32_t tid, std::string_view name, int64_t utime_ticks, int64_t ktime_ticks) {
+    auto task_dir = temp_dir_.path() / std::to_string(kPID) / "task" / std::to_string(tid);
+    std::filesystem::create_directories(task_dir);
+    auto stat_dir = temp_dir_.path() / std::to_string(tid);
+    std::filesystem::create_directories(stat_dir);
+    // The utime and ktime are the 14th and 15th of the 52 fields.
+    std::string stat = absl::Substitute("$0 ($1) S 1 1 1 0 -1 0 0 0 0 0 $2 $3", tid, name,
+                                        utime_ticks, ktime_ticks);
+    for (int i = 0; i < 37; ++i) {
+      stat += " 0";
+    }
+    ASSERT_OK(WriteFileFromString((stat_dir / "stat").string(), stat + "\n"));
+  }
+
+  double ThreadCPUSeconds(std::string_view name) {
+    for (const auto& family : registry_.Collect()) {
+      if (family.name != "agent_thread_cpu_seconds_total") {
+        continue;
+      }
+      for (const auto& metric : family.metric) {
+        if (metric.label[0].value == name) {
+          return metric.counter.value;
+        }
+      }
+    }
+    return -1;
+  }
+
+  testing::TempDir temp_dir_;
+  prometheus::Registry registry_;
+};
+
+TEST_F(SelfProfilerTest, SamplesThreadCPU) {
+  SelfProfiler::Config config;
+  config.cpu_threshold_cores = 2;
+  config.profile_dir = (temp_dir_.path() / "profiles").string();
+  SelfProfiler profiler(temp_dir_.path().string(), kPID, kTickNS, config, &registry_);
+
+  auto now = std::chrono::steady_clock::now();
+  WriteThread(100, "pem", 100, 50);
+  WriteThread(101, "worker", 10, 0);
+  profiler.Sample(now);
+  EXPECT_DOUBLE_EQ(1.5, ThreadCPUSeconds("pem"));
+  EXPECT_DOUBLE_EQ(0.1, ThreadCPUSeconds("worker"));
+  EXPECT_EQ(0, profiler.cpu_cores());
+
+  // Thread 101 exits and 102 starts, under the same name.
+  WriteThread(100, "pem", 140, 60);
+  std::filesystem::remove_all(temp_dir_.path() / std::to_string(kPID) / "task" / "101");
+  WriteThread(102, "worker", 30, 0);
+  profiler.Sample(now + std::chrono::seconds(1));
+  EXPECT_DOUBLE_EQ(2.0, ThreadCPUSeconds("pem"));
+  EXPECT_DOUBLE_EQ(0.4, ThreadCPUSeconds("worker"));
+  EXPECT_DOUBLE_EQ(0.8, profiler.cpu_cores());
+  // Below the threshold.
+  EXPECT_FALSE(profiler.capturing());
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
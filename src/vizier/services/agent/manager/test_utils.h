@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -89,6 +90,10 @@ class FakeAgentMetadataStateManager : public md::AgentMetadataStateManager {
     pid_status_events_.push(std::move(event));
   }
 
+  void SetOldestDataTimeFn(std::function<int64_t()> fn) override {
+    oldest_data_time_fn_ = std::move(fn);
+  }
+
   std::unique_ptr<md::PIDStatusEvent> GetNextPIDStatusEvent() override {
     if (!pid_status_events_.size()) {
       return nullptr;
@@ -106,6 +111,7 @@ class FakeAgentMetadataStateManager : public md::AgentMetadataStateManager {
   CIDRBlock cidr_;
   std::vector<CIDRBlock> pod_cidr_;
   std::queue<std::unique_ptr<md::PIDStatusEvent>> pid_status_events_;
+  std::function<int64_t()> oldest_data_time_fn_;
 };
 
 }  // namespace agent
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/pem/memory_governor.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <absl/strings/strip.h>
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+StatusOr<double> ParseMemoryPressure(std::string_view contents) {
+  // The lines look like: some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+  for (std::string_view line : absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    std::vector<std::string_view> fields = absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.size() < 2 || fields[0] != "some" || !absl::ConsumePrefix(&fields[1], "avg10=")) {
+      continue;
+    }
+    double pressure_pct;
+    if (!absl::SimpleAtod(fields[1], &pressure_pct)) {
+      return error::InvalidArgument("Malformed memory pressure line: $0", line);
+    }
+    return pressure_pct;
+  }
+  return error::InvalidArgument("Memory pressure contents have no 'some avg10' value");
+}
+
+MemoryGovernor::MemoryGovernor(double threshold_pct, std::vector<Action> actions,
+                               prometheus::Registry* registry)
+    : threshold_pct_(threshold_pct),
+      pressure_gauge_(prometheus::BuildGauge()
+                          .Name("memory_governor_pressure")
+                          .Help("Percent of the last 10 seconds in which some of the agent's tasks "
+                                "were stalled on memory.")
+                          .Register(*registry)
+                          .Add({})) {
+  auto& engaged_family = prometheus::BuildCounter()
+                             .Name("memory_governor_actions_engaged")
+                             .Help("Times a response to memory pressure was engaged.")
+                             .Register(*registry);
+  auto& active_family = prometheus::BuildGauge()
+                            .Name("memory_governor_action_active")
+                            .Help("Whether a response to memory pressure is engaged.")
+                            .Register(*registry);
+  for (auto& action : actions) {
+    std::map<std::string, std::string> labels = {{"action", action.name}};
+    actions_.push_back(
+        {std::move(action), &engaged_family.Add(labels), &active_family.Add(labels)});
+  }
+}
+
+void MemoryGovernor::Update(double pressure_pct) {
+  pressure_gauge_.Set(pressure_pct);
+
+  if (stage_ < actions_.size() && pressure_pct >= threshold_pct_ * (stage_ + 1)) {
+    auto& state = actions_[stage_];
+    LOG(WARNING) << absl::Substitute("Memory pressure is $0%, engaging $1.", pressure_pct,
+                                     state.action.name);
+    state.action.apply(true);
+    state.engaged_count->Increment();
+    state.active->Set(1);
+    ++stage_;
+  } else if (stage_ > 0 && pressure_pct < threshold_pct_ * stage_ / 2) {
+    --stage_;
+    auto& state = actions_[stage_];
+    LOG(INFO) << absl::Substitute("Memory pressure is $0%, releasing $1.", pressure_pct,
+                                  state.action.name);
+    state.action.apply(false);
+    state.active->Set(0);
+  }
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * Parses the contents of a PSI memory pressure file, such as /proc/pressure/memory or a cgroup's
+ * memory.pressure, into the percent of the last 10 seconds in which some tasks were stalled on
+ * memory.
+ */
+StatusOr<double> ParseMemoryPressure(std::string_view contents);
+
+/**
+ * MemoryGovernor applies staged responses to memory pressure, so that the agent gives up memory
+ * before it is OOM killed. Each action is engaged in order once the pressure reaches a further
+ * multiple of the threshold, and released in reverse order once it falls back below half of that.
+ * At most one action is engaged or released per Update(), so that each one gets time to take
+ * effect before the next.
+ *
+ * Not thread-safe.
+ */
+class MemoryGovernor : public NotCopyable {
+ public:
+  struct Action {
+    std::string name;
+    // Called with true when the action is engaged, and false when it is released.
+    std::function<void(bool)> apply;
+  };
+
+  MemoryGovernor(double threshold_pct, std::vector<Action> actions,
+                 prometheus::Registry* registry);
+
+  /**
+   * Update engages or releases the next action for the latest memory pressure.
+   * @param pressure_pct the memory pressure, as returned by ParseMemoryPressure().
+   */
+  void Update(double pressure_pct);
+
+  // The number of actions that are engaged.
+  size_t stage() const { return stage_; }
+
+ private:
+  struct ActionState {
+    Action action;
+    prometheus::Counter* engaged_count;
+    prometheus::Gauge* active;
+  };
+
+  const double threshold_pct_;
+  std::vector<ActionState> actions_;
+  size_t stage_ = 0;
+  prometheus::Gauge& pressure_gauge_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/pem/memory_governor.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::testing::ElementsAre;
+
+TEST(ParseMemoryPressureTest, ParsesSomeAvg10) {
+  constexpr char kPressure[] =
+      "some avg10=12.50 avg60=1.00 avg300=0.20 total=52\n"
+      "full avg10=3.00 avg60=0.10 avg300=0.00 total=7\n";
+  ASSERT_OK_AND_EQ(ParseMemoryPressure(kPressure), 12.5);
+}
+
+TEST(ParseMemoryPressureTest, MissingAvg10) {
+  EXPECT_NOT_OK(ParseMemoryPressure("full avg10=3.00 avg60=0.10 avg300=0.00 total=7\n"));
+  EXPECT_NOT_OK(ParseMemoryPressure("some avg10=abc avg60=0.10 avg300=0.00 total=7\n"));
+}
+
+class MemoryGovernorTest : public ::testing::Test {
+ protected:
+  MemoryGovernor::Action RecordingAction(std::string name) {
+    return {name, [this, name](bool engage) {
+              calls_.push_back(absl::StrCat(engage ? "engage " : "release ", name));
+            }};
+  }
+
+  prometheus::Registry registry_;
+  std::vector<std::string> calls_;
+};
+
+TEST_F(MemoryGovernorTest, EngagesAndReleasesActionsInOrder) {
+  MemoryGovernor governor(
+      10, {RecordingAction("shrink"), RecordingAction("hold"), RecordingAction("shed")},
+      &registry_);
+
+  governor.Update(5);
+  EXPECT_EQ(governor.stage(), 0U);
+
+  // Even a large jump in pressure only engages one action at a time.
+  governor.Update(50);
+  EXPECT_EQ(governor.stage(), 1U);
+  governor.Update(50);
+  governor.Update(50);
+  governor.Update(50);
+  EXPECT_EQ(governor.stage(), 3U);
+
+  // The last action is released once the pressure is below half its threshold.
+  governor.Update(20);
+  EXPECT_EQ(governor.stage(), 3U);
+  governor.Update(14);
+  EXPECT_EQ(governor.stage(), 2U);
+  governor.Update(0);
+  governor.Update(0);
+  governor.Update(0);
+  EXPECT_EQ(governor.stage(), 0U);
+
+  EXPECT_THAT(calls_, ElementsAre("engage shrink", "engage hold", "engage shed", "release shed",
+                                  "release hold", "release shrink"));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
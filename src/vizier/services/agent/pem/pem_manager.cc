@@ -18,6 +18,17 @@
 
 #include "src/vizier/services/agent/pem/pem_manager.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+#include "src/common/base/file.h"
 #include "src/common/system/config.h"
 #include "src/vizier/services/agent/manager/exec.h"
 #include "src/vizier/services/agent/manager/manager.h"
@@ -43,10 +54,150 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_string(table_store_disk_tier_dir, gflags::StringFromEnv("PL_TABLE_STORE_DISK_TIER_DIR", ""),
+              "If set, the tables in --table_store_disk_tier_tables keep the data expired from "
+              "memory on local disk, in a directory per table under this one.");
+
+DEFINE_string(table_store_disk_tier_tables,
+              gflags::StringFromEnv("PL_TABLE_STORE_DISK_TIER_TABLES", "http_events"),
+              "Comma separated list of the tables that use the disk tier.");
+
+DEFINE_int32(table_store_disk_tier_limit_mb,
+             gflags::Int32FromEnv("PL_TABLE_STORE_DISK_TIER_LIMIT_MB", 4 * 1024),
+             "The maximum amount of data to keep on disk for each table that uses the disk tier.");
+
+DEFINE_int32(table_store_disk_tier_retention_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_DISK_TIER_RETENTION_S", 24 * 60 * 60),
+             "Data on disk is deleted once older than this. Disabled if negative.");
+
+DEFINE_string(table_store_snapshot_dir, gflags::StringFromEnv("PL_TABLE_STORE_SNAPSHOT_DIR", ""),
+              "If set, the compacted data of each table is snapshotted to local disk, in a "
+              "directory per table under this one, and mapped back in when the PEM restarts.");
+
+DEFINE_int32(table_store_snapshot_period_s,
+             gflags::Int32FromEnv("PL_TABLE_STORE_SNAPSHOT_PERIOD_S", 60),
+             "How often the tables are snapshotted, if --table_store_snapshot_dir is set. The data "
+             "compacted since the last snapshot is lost on a crash.");
+
+DEFINE_string(table_store_retention_policies,
+              gflags::StringFromEnv("PL_TABLE_STORE_RETENTION_POLICIES", ""),
+              "If set, the table store memory is rebalanced between tables as their ingest rates "
+              "change. Comma separated list of name:min_window_s:max_mb:weight, where the table "
+              "is first given the memory for min_window_s of its data, up to max_mb (0 for no "
+              "limit), and then a weighted share of the rest. Each table's default weight is its "
+              "default percent of --table_store_data_limit.");
+
+DEFINE_string(table_store_bloom_filter_columns,
+              gflags::StringFromEnv("PL_TABLE_STORE_BLOOM_FILTER_COLUMNS", ""),
+              "Comma separated list of table.column STRING columns, e.g. of trace IDs, that cold "
+              "data keeps bloom filters of, so that queries filtering on a value of one skip the "
+              "data without it.");
+
+DEFINE_string(table_store_rollups, gflags::StringFromEnv("PL_TABLE_STORE_ROLLUPS", ""),
+              "Semicolon separated list of rollup tables that the PEM keeps up to date, each "
+              "name=table:interval_s:group_cols:value_cols:max_mb, where group_cols and value_cols "
+              "are comma separated, e.g. "
+              "http_events_10s=http_events:10:upid,resp_status:latency:64. "
+              "Each row of a rollup holds the number of rows of one group in one interval, and the "
+              "sum, min and max of each value column. Rollup tables are limited to max_mb each, in "
+              "addition to --table_store_data_limit.");
+
+DEFINE_double(memory_pressure_threshold,
+              gflags::DoubleFromEnv("PL_MEMORY_PRESSURE_THRESHOLD", 10),
+              "The memory pressure, as the percent of the last 10s in which some tasks were "
+              "stalled on memory, at which the PEM starts shedding memory. At it the table store "
+              "is shrunk, at twice it cron and export queries are held, and at three times it "
+              "Stirling keeps less data buffered. Disabled if 0.");
+
+DEFINE_string(memory_pressure_file,
+              gflags::StringFromEnv("PL_MEMORY_PRESSURE_FILE", "/sys/fs/cgroup/memory.pressure"),
+              "The PSI file to read the PEM's memory pressure from.");
+
+DEFINE_int32(stirling_table_idle_timeout_s,
+             gflags::Int32FromEnv("PL_STIRLING_TABLE_IDLE_TIMEOUT_S", 0),
+             "If positive, Stirling stops collecting the data of a table, where it can, once no "
+             "query or cron script has read the table for this long, and resumes once one does. "
+             "The first query after a resume only sees the data collected since. Disabled if 0.");
+
 namespace px {
 namespace vizier {
 namespace agent {
 
+namespace {
+
+StatusOr<absl::flat_hash_map<std::string, table_store::RetentionPolicy>> ParseRetentionPolicies(
+    std::string_view policies_str) {
+  absl::flat_hash_map<std::string, table_store::RetentionPolicy> policies;
+  for (std::string_view policy_str : absl::StrSplit(policies_str, ',', absl::SkipEmpty())) {
+    std::vector<std::string_view> fields = absl::StrSplit(policy_str, ':');
+    int64_t min_window_s;
+    int64_t max_mb;
+    double weight;
+    if (fields.size() != 4 || !absl::SimpleAtoi(fields[1], &min_window_s) ||
+        !absl::SimpleAtoi(fields[2], &max_mb) || !absl::SimpleAtod(fields[3], &weight)) {
+      return error::InvalidArgument(
+          "Retention policy '$0' is not of the form name:min_window_s:max_mb:weight", policy_str);
+    }
+    policies[fields[0]] = {.min_window = std::chrono::seconds(min_window_s),
+                           .max_bytes = max_mb * 1024 * 1024,
+                           .weight = weight};
+  }
+  return policies;
+}
+
+StatusOr<absl::flat_hash_map<std::string, std::vector<std::string>>> ParseBloomFilterColumns(
+    std::string_view cols_str) {
+  absl::flat_hash_map<std::string, std::vector<std::string>> cols;
+  for (std::string_view col_str : absl::StrSplit(cols_str, ',', absl::SkipEmpty())) {
+    std::vector<std::string_view> fields = absl::StrSplit(col_str, absl::MaxSplits('.', 1));
+    if (fields.size() != 2 || fields[0].empty() || fields[1].empty()) {
+      return error::InvalidArgument("Bloom filter column '$0' is not of the form table.column",
+                                    col_str);
+    }
+    cols[fields[0]].emplace_back(fields[1]);
+  }
+  return cols;
+}
+
+struct RollupConfig {
+  std::string name;
+  std::string source_table;
+  table_store::RollupSpec spec;
+  int64_t max_bytes;
+};
+
+StatusOr<std::vector<RollupConfig>> ParseRollups(std::string_view rollups_str) {
+  std::vector<RollupConfig> rollups;
+  for (std::string_view rollup_str : absl::StrSplit(rollups_str, ';', absl::SkipEmpty())) {
+    std::vector<std::string_view> name_and_fields =
+        absl::StrSplit(rollup_str, absl::MaxSplits('=', 1));
+    std::vector<std::string_view> fields;
+    if (name_and_fields.size() == 2) {
+      fields = absl::StrSplit(name_and_fields[1], ':');
+    }
+    int64_t interval_s;
+    int64_t max_mb;
+    if (fields.size() != 5 || name_and_fields[0].empty() ||
+        !absl::SimpleAtoi(fields[1], &interval_s) || !absl::SimpleAtoi(fields[4], &max_mb) ||
+        max_mb <= 0) {
+      return error::InvalidArgument(
+          "Rollup '$0' is not of the form name=table:interval_s:group_cols:value_cols:max_mb",
+          rollup_str);
+    }
+    RollupConfig rollup;
+    rollup.name = std::string(name_and_fields[0]);
+    rollup.source_table = std::string(fields[0]);
+    rollup.spec.interval = std::chrono::seconds(interval_s);
+    rollup.spec.group_by_cols = absl::StrSplit(fields[2], ',', absl::SkipEmpty());
+    rollup.spec.value_cols = absl::StrSplit(fields[3], ',', absl::SkipEmpty());
+    rollup.max_bytes = max_mb * 1024 * 1024;
+    rollups.push_back(std::move(rollup));
+  }
+  return rollups;
+}
+
+}  // namespace
+
 Status PEMManager::InitImpl() {
   PL_RETURN_IF_ERROR(InitClockConverters());
   StartNodeMemoryCollector();
@@ -68,22 +219,33 @@ Status PEMManager::PostRegisterHookImpl() {
   PL_RETURN_IF_ERROR(InitSchemas());
   PL_RETURN_IF_ERROR(stirling_->RunAsThread());
 
-  auto execute_query_handler = std::make_shared<ExecuteQueryMessageHandler>(
+  execute_query_handler_ = std::make_shared<ExecuteQueryMessageHandler>(
       dispatcher(), info(), agent_nats_connector(), carnot());
   PL_RETURN_IF_ERROR(RegisterMessageHandler(messages::VizierMessage::MsgCase::kExecuteQueryRequest,
-                                            execute_query_handler));
+                                            execute_query_handler_));
 
   tracepoint_manager_ =
       std::make_shared<TracepointManager>(dispatcher(), info(), agent_nats_connector(),
                                           stirling_.get(), table_store(), relation_info_manager());
   PL_RETURN_IF_ERROR(RegisterMessageHandler(messages::VizierMessage::MsgCase::kTracepointMessage,
                                             tracepoint_manager_));
+
+  StartMemoryGovernor();
+  StartTableActivityMonitor();
+  StartTableSnapshots();
+  StartRollups();
   return Status::OK();
 }
 
 Status PEMManager::StopImpl(std::chrono::milliseconds) {
   stirling_->Stop();
   stirling_.reset();
+  if (!FLAGS_table_store_snapshot_dir.empty()) {
+    // Compacts what is left in the hot batches, so that the final snapshot holds all the data.
+    auto s = table_store()->RunCompaction();
+    LOG_IF(ERROR, !s.ok()) << s.msg();
+    WriteTableSnapshots();
+  }
   return Status::OK();
 }
 
@@ -93,6 +255,7 @@ Status PEMManager::InitSchemas() {
   auto relation_info_vec = ConvertPublishPBToRelationInfo(publish_pb);
 
   int64_t memory_limit = FLAGS_table_store_data_limit * 1024 * 1024;
+  table_store_memory_limit_ = memory_limit;
   int64_t num_tables = relation_info_vec.size();
   int64_t http_table_size = (FLAGS_table_store_http_events_percent * memory_limit) / 100;
   int64_t stirling_error_table_size = FLAGS_table_store_stirling_error_limit_bytes / 2;
@@ -102,31 +265,86 @@ Status PEMManager::InitSchemas() {
                               probe_status_table_size - proc_exit_events_table_size) /
                              (num_tables - 4);
 
+  absl::flat_hash_set<std::string> disk_tier_tables;
+  if (!FLAGS_table_store_disk_tier_dir.empty()) {
+    disk_tier_tables = absl::StrSplit(FLAGS_table_store_disk_tier_tables, ',', absl::SkipEmpty());
+  }
+
+  absl::flat_hash_map<std::string, table_store::RetentionPolicy> retention_policies;
+  if (!FLAGS_table_store_retention_policies.empty()) {
+    PL_ASSIGN_OR_RETURN(retention_policies,
+                        ParseRetentionPolicies(FLAGS_table_store_retention_policies));
+    memory_arbitrator_ = std::make_unique<table_store::MemoryArbitrator>(memory_limit);
+  }
+  PL_ASSIGN_OR_RETURN(auto bloom_filter_cols,
+                      ParseBloomFilterColumns(FLAGS_table_store_bloom_filter_columns));
+
   for (const auto& relation_info : relation_info_vec) {
-    std::shared_ptr<table_store::Table> table_ptr;
+    int64_t table_size = other_table_size;
+    size_t compacted_batch_size = table_store::Table::kDefaultColdBatchMinSize;
     if (relation_info.name == "http_events") {
       // Special case to set the max size of the http_events table differently from the other
       // tables. For now, the min cold batch size is set to 256kB to be consistent with previous
       // behaviour.
-      table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       http_table_size, 256 * 1024);
+      table_size = http_table_size;
+      compacted_batch_size = 256 * 1024;
     } else if (relation_info.name == "stirling_error") {
-      table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       stirling_error_table_size);
+      table_size = stirling_error_table_size;
     } else if (relation_info.name == "probe_status") {
-      table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       probe_status_table_size);
+      table_size = probe_status_table_size;
     } else if (relation_info.name == "proc_exit_events") {
-      table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       proc_exit_events_table_size);
-    } else {
-      table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       other_table_size);
+      table_size = proc_exit_events_table_size;
     }
 
+    table_store::Table::DiskTierOptions disk_tier;
+    if (disk_tier_tables.contains(relation_info.name)) {
+      disk_tier.dir = std::filesystem::path(FLAGS_table_store_disk_tier_dir) / relation_info.name;
+      disk_tier.max_bytes = int64_t{FLAGS_table_store_disk_tier_limit_mb} * 1024 * 1024;
+      disk_tier.max_retention_ns =
+          FLAGS_table_store_disk_tier_retention_s < 0
+              ? -1
+              : int64_t{FLAGS_table_store_disk_tier_retention_s} * 1000 * 1000 * 1000;
+    }
+    auto table_ptr = std::make_shared<table_store::Table>(
+        relation_info.name, relation_info.relation, table_size, compacted_batch_size, disk_tier);
+    if (auto it = bloom_filter_cols.find(relation_info.name); it != bloom_filter_cols.end()) {
+      PL_RETURN_IF_ERROR(table_ptr->SetBloomFilterColumns(it->second));
+    }
+    if (!FLAGS_table_store_snapshot_dir.empty()) {
+      // The table just starts out empty if its snapshot can't be restored.
+      auto s = table_ptr->RestoreSnapshot(std::filesystem::path(FLAGS_table_store_snapshot_dir) /
+                                          relation_info.name);
+      LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to restore the snapshot of $0: $1",
+                                                 relation_info.name, s.msg());
+    }
+
+    if (memory_arbitrator_ != nullptr) {
+      table_store::RetentionPolicy policy = {.weight = table_size * 100.0 / memory_limit};
+      auto it = retention_policies.find(relation_info.name);
+      if (it != retention_policies.end()) {
+        policy = it->second;
+      }
+      memory_arbitrator_->AddTable(table_ptr, policy);
+    }
+
+    table_sizes_.emplace_back(table_ptr, table_size);
+    stirling_tables_.emplace_back(relation_info.name, table_ptr);
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
     PL_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
   }
+
+  PL_RETURN_IF_ERROR(InitRollups());
+
+  if (memory_arbitrator_ != nullptr) {
+    memory_arbitrator_->Rebalance();
+    memory_arbitration_timer_ = dispatcher()->CreateTimer([this]() {
+      memory_arbitrator_->Rebalance();
+      if (memory_arbitration_timer_) {
+        memory_arbitration_timer_->EnableTimer(kMemoryArbitrationPeriod);
+      }
+    });
+    memory_arbitration_timer_->EnableTimer(kMemoryArbitrationPeriod);
+  }
   return Status::OK();
 }
 
@@ -160,6 +378,159 @@ void PEMManager::StartNodeMemoryCollector() {
   node_memory_timer_->EnableTimer(kNodeMemoryCollectionPeriod);
 }
 
+void PEMManager::ShrinkTableStore(bool shrink) {
+  double fraction = shrink ? kShrunkTableStoreFraction : 1.0;
+  if (memory_arbitrator_ != nullptr) {
+    memory_arbitrator_->SetTotalBytes(static_cast<int64_t>(table_store_memory_limit_ * fraction));
+    memory_arbitrator_->Rebalance();
+    return;
+  }
+  for (const auto& [table, table_size] : table_sizes_) {
+    table->SetMaxTableSize(static_cast<int64_t>(table_size * fraction));
+  }
+}
+
+void PEMManager::StartMemoryGovernor() {
+  if (FLAGS_memory_pressure_threshold <= 0) {
+    return;
+  }
+  // The actions are engaged in this order as the pressure rises: the table store gives up memory
+  // first, since it only loses the oldest data, and Stirling last, since it loses new data.
+  std::vector<MemoryGovernor::Action> actions = {
+      {"shrink_table_store", [this](bool engage) { ShrinkTableStore(engage); }},
+      {"hold_background_queries",
+       [this](bool engage) { execute_query_handler_->HoldBackgroundQueries(engage); }},
+      {"shed_stirling_load", [this](bool engage) { stirling_->SetShedLoad(engage); }},
+  };
+  memory_governor_ = std::make_unique<MemoryGovernor>(FLAGS_memory_pressure_threshold,
+                                                      std::move(actions), &GetMetricsRegistry());
+
+  memory_governor_timer_ = dispatcher()->CreateTimer([this]() {
+    auto read_pressure = []() -> StatusOr<double> {
+      PL_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(FLAGS_memory_pressure_file));
+      return ParseMemoryPressure(contents);
+    };
+    auto pressure_or = read_pressure();
+    if (pressure_or.ok()) {
+      memory_governor_->Update(pressure_or.ConsumeValueOrDie());
+    } else {
+      LOG_FIRST_N(WARNING, 1) << "Failed to read memory pressure: " << pressure_or.msg();
+    }
+    if (memory_governor_timer_) {
+      memory_governor_timer_->EnableTimer(kMemoryPressureCheckPeriod);
+    }
+  });
+  memory_governor_timer_->EnableTimer(kMemoryPressureCheckPeriod);
+}
+
+void PEMManager::UpdateTableActivity() {
+  auto now = std::chrono::steady_clock::now();
+  auto idle_timeout = std::chrono::seconds(FLAGS_stirling_table_idle_timeout_s);
+  for (const auto& [name, table] : stirling_tables_) {
+    bool idle = now - table->last_read_time() >= idle_timeout;
+    if (idle == inactive_tables_.contains(name)) {
+      continue;
+    }
+    if (idle) {
+      inactive_tables_.insert(name);
+    } else {
+      inactive_tables_.erase(name);
+    }
+    stirling_->SetTableActive(name, !idle);
+  }
+}
+
+void PEMManager::StartTableActivityMonitor() {
+  if (FLAGS_stirling_table_idle_timeout_s <= 0) {
+    return;
+  }
+  table_activity_timer_ = dispatcher()->CreateTimer([this]() {
+    UpdateTableActivity();
+    if (table_activity_timer_) {
+      table_activity_timer_->EnableTimer(kTableActivityCheckPeriod);
+    }
+  });
+  table_activity_timer_->EnableTimer(kTableActivityCheckPeriod);
+}
+
+Status PEMManager::InitRollups() {
+  PL_ASSIGN_OR_RETURN(auto configs, ParseRollups(FLAGS_table_store_rollups));
+  for (auto& config : configs) {
+    auto it = std::find_if(stirling_tables_.begin(), stirling_tables_.end(),
+                           [&](const auto& table) { return table.first == config.source_table; });
+    if (it == stirling_tables_.end()) {
+      return error::InvalidArgument("Rollup $0 is of unknown table $1.", config.name,
+                                    config.source_table);
+    }
+    PL_ASSIGN_OR_RETURN(auto rollup, table_store::Rollup::Create(it->second, config.spec));
+    auto table =
+        std::make_shared<table_store::Table>(config.name, rollup->relation(), config.max_bytes);
+    RelationInfo relation_info(
+        config.name, kRollupTableIDStart + rollups_.size(),
+        absl::Substitute("Rollup of $0 per $1s.", config.source_table,
+                         std::chrono::duration_cast<std::chrono::seconds>(config.spec.interval)
+                             .count()),
+        rollup->relation());
+    table_store()->AddTable(table, relation_info.name, relation_info.id);
+    PL_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
+    rollups_.emplace_back(std::move(rollup), std::move(table));
+  }
+  return Status::OK();
+}
+
+void PEMManager::StartRollups() {
+  if (rollups_.empty()) {
+    return;
+  }
+  // Rollups are updated on their own thread, like snapshots, and skip a run if the last is still
+  // going.
+  rollup_pool_ = std::make_unique<ThreadPool>(1);
+  rollup_timer_ = dispatcher()->CreateTimer([this]() {
+    if (!rollup_running_.exchange(true)) {
+      rollup_pool_->Schedule([this]() {
+        for (const auto& [rollup, table] : rollups_) {
+          auto s = rollup->Update(table.get());
+          LOG_IF(ERROR, !s.ok()) << s.msg();
+        }
+        rollup_running_ = false;
+      });
+    }
+    if (rollup_timer_) {
+      rollup_timer_->EnableTimer(kRollupUpdatePeriod);
+    }
+  });
+  rollup_timer_->EnableTimer(kRollupUpdatePeriod);
+}
+
+void PEMManager::StartTableSnapshots() {
+  if (FLAGS_table_store_snapshot_dir.empty()) {
+    return;
+  }
+  // Snapshots are written on their own thread, so that the file writes don't delay the event loop.
+  // A snapshot is skipped if the previous one is still being written.
+  table_snapshot_pool_ = std::make_unique<ThreadPool>(1);
+  table_snapshot_timer_ = dispatcher()->CreateTimer([this]() {
+    if (!table_snapshot_running_.exchange(true)) {
+      table_snapshot_pool_->Schedule([this]() {
+        WriteTableSnapshots();
+        table_snapshot_running_ = false;
+      });
+    }
+    if (table_snapshot_timer_) {
+      table_snapshot_timer_->EnableTimer(std::chrono::seconds(FLAGS_table_store_snapshot_period_s));
+    }
+  });
+  table_snapshot_timer_->EnableTimer(std::chrono::seconds(FLAGS_table_store_snapshot_period_s));
+}
+
+void PEMManager::WriteTableSnapshots() {
+  const std::filesystem::path snapshot_dir(FLAGS_table_store_snapshot_dir);
+  for (const auto& [table_name, table] : stirling_tables_) {
+    auto s = table->WriteSnapshot(snapshot_dir / table_name);
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to snapshot $0: $1", table_name, s.msg());
+  }
+}
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
@@ -18,16 +18,23 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <absl/container/flat_hash_set.h>
 #include <prometheus/gauge.h>
 
 #include "src/stirling/stirling.h"
+#include "src/table_store/table/memory_arbitrator.h"
+#include "src/table_store/table/rollup.h"
+#include "src/vizier/services/agent/manager/exec.h"
 #include "src/vizier/services/agent/manager/manager.h"
+#include "src/vizier/services/agent/pem/memory_governor.h"
 #include "src/vizier/services/agent/pem/tracepoint_manager.h"
 
 namespace px {
@@ -35,6 +42,15 @@ namespace vizier {
 namespace agent {
 
 constexpr auto kNodeMemoryCollectionPeriod = std::chrono::minutes(1);
+constexpr auto kMemoryArbitrationPeriod = std::chrono::seconds(30);
+constexpr auto kMemoryPressureCheckPeriod = std::chrono::seconds(10);
+// The part of the table store's memory that the tables keep while it is shrunk for memory pressure.
+constexpr double kShrunkTableStoreFraction = 0.5;
+// How long after a query reads an inactive table Stirling resumes collecting its data, at most.
+constexpr auto kTableActivityCheckPeriod = std::chrono::seconds(5);
+constexpr auto kRollupUpdatePeriod = std::chrono::seconds(5);
+// Rollup tables get IDs above those of the Stirling tables, which count up from 0.
+constexpr uint64_t kRollupTableIDStart = uint64_t{1} << 32;
 
 class PEMManager : public Manager {
  public:
@@ -83,6 +99,20 @@ class PEMManager : public Manager {
   Status InitSchemas();
   Status InitClockConverters();
   void StartNodeMemoryCollector();
+  void StartMemoryGovernor();
+  void ShrinkTableStore(bool shrink);
+  // Makes the Stirling tables that have not been read for --stirling_table_idle_timeout_s
+  // inactive, and those read since active again.
+  void StartTableActivityMonitor();
+  void UpdateTableActivity();
+  // Snapshots the tables every --table_store_snapshot_period_s, if --table_store_snapshot_dir is
+  // set.
+  void StartTableSnapshots();
+  // Creates the rollup tables of --table_store_rollups, and updates them every
+  // kRollupUpdatePeriod.
+  Status InitRollups();
+  void StartRollups();
+  void WriteTableSnapshots();
   static services::shared::agent::AgentCapabilities Capabilities() {
     services::shared::agent::AgentCapabilities capabilities;
     capabilities.set_collects_data(true);
@@ -91,11 +121,35 @@ class PEMManager : public Manager {
 
   std::unique_ptr<stirling::Stirling> stirling_;
   std::shared_ptr<TracepointManager> tracepoint_manager_;
+  std::shared_ptr<ExecuteQueryMessageHandler> execute_query_handler_;
 
   // Timer for triggering ClockConverter polls.
   px::event::TimerUPtr clock_converter_timer_;
   // Timer for collecting info about the node's available memory.
   px::event::TimerUPtr node_memory_timer_;
+  // Rebalances the table store memory between tables, if --table_store_retention_policies is set.
+  std::unique_ptr<table_store::MemoryArbitrator> memory_arbitrator_;
+  px::event::TimerUPtr memory_arbitration_timer_;
+  // The memory limit of the table store, and each table's share of it, as configured.
+  int64_t table_store_memory_limit_ = 0;
+  std::vector<std::pair<std::shared_ptr<table_store::Table>, int64_t>> table_sizes_;
+  // Sheds memory when the PEM's memory pressure rises, if --memory_pressure_threshold is set.
+  std::unique_ptr<MemoryGovernor> memory_governor_;
+  px::event::TimerUPtr memory_governor_timer_;
+  std::vector<std::pair<std::string, std::shared_ptr<table_store::Table>>> stirling_tables_;
+  absl::flat_hash_set<std::string> inactive_tables_;
+  px::event::TimerUPtr table_activity_timer_;
+  // Declared after stirling_tables_, so that a snapshot being written finishes before the tables
+  // are released.
+  std::unique_ptr<ThreadPool> table_snapshot_pool_;
+  px::event::TimerUPtr table_snapshot_timer_;
+  std::atomic<bool> table_snapshot_running_ = false;
+  // Each rollup, and its table.
+  std::vector<std::pair<std::unique_ptr<table_store::Rollup>, std::shared_ptr<table_store::Table>>>
+      rollups_;
+  std::unique_ptr<ThreadPool> rollup_pool_;
+  px::event::TimerUPtr rollup_timer_;
+  std::atomic<bool> rollup_running_ = false;
   prometheus::Gauge& node_available_memory_;
   prometheus::Gauge& node_total_memory_;
 };
@@ -120,11 +120,14 @@ func (a *AgentsInfoImpl) UpdateAgentsInfo(update *metadatapb.AgentUpdatesRespons
 
 			if agent.Info.Capabilities == nil || agent.Info.Capabilities.CollectsData {
 				var metadataInfo *distributedpb.MetadataInfo
+				var tableStats map[string]*distributedpb.TableStats
 				if carnotInfo, present := carnotInfoMap[agentUUID]; present {
 					metadataInfo = carnotInfo.MetadataInfo
+					tableStats = carnotInfo.TableStats
 				}
 				// this is a PEM
 				carnotInfoMap[agentUUID] = makeAgentCarnotInfo(agentUUID, agent.ASID, metadataInfo)
+				carnotInfoMap[agentUUID].TableStats = tableStats
 			} else {
 				// this is a Kelvin
 				kelvinGRPCAddress := agent.Info.IPAddress
@@ -146,6 +149,9 @@ func (a *AgentsInfoImpl) UpdateAgentsInfo(update *metadatapb.AgentUpdatesRespons
 			if dataInfo.MetadataInfo != nil {
 				carnotInfo.MetadataInfo = dataInfo.MetadataInfo
 			}
+			if dataInfo.TableStats != nil {
+				carnotInfo.TableStats = dataInfo.TableStats
+			}
 		}
 		// case 3: agent deleted
 		if agentUpdate.GetDeleted() {